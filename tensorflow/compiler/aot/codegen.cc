@@ -669,6 +669,7 @@ class {{CLASS}} final : public tensorflow::XlaCompiledCpuFunction {
       set_static_data_hlo_profile_printer_data(
           data, StaticHloProfilePrinterData());
       set_static_data_use_xla_runtime(data, {{USE_XLA_RUNTIME}});
+      set_static_data_intra_op_parallelism(data, {{INTRA_OP_PARALLELISM}});
 {{ASSIGN_PROFILE_COUNTERS_SIZE}}
       return data;
     }();
@@ -823,6 +824,7 @@ class {{CLASS}} final : public tensorflow::XlaCompiledCpuFunction {
        absl::StrJoin(metadata_result.header_variable_decls, "\n")},
       {"{{ENTRY}}", compile_result.entry_point},
       {"{{USE_XLA_RUNTIME}}", opts.use_xla_runtime ? "true" : "false"},
+      {"{{INTRA_OP_PARALLELISM}}", absl::StrCat(opts.intra_op_parallelism)},
       {"{{HLO_PROFILE_PRINTER_DATA_SHIM_EXPRESSION}}",
        metadata_result.hlo_profile_printer_data_access_shim},
       {"{{INCLUDE_XLA_DATA_PROTO}}", include_xla_data_proto},
@@ -906,6 +908,141 @@ Status GenerateMetadata(const CodegenOpts& opts,
   return absl::OkStatus();
 }
 
+Status GenerateDispatcherHeader(const CodegenOpts& opts,
+                                absl::Span<const int64_t> batch_sizes,
+                                absl::Span<const string> include_headers,
+                                string* header) {
+  TF_RETURN_IF_ERROR(ValidateCppIdent(opts.class_name, "dispatcher class"));
+  if (batch_sizes.empty()) {
+    return errors::InvalidArgument("No batch sizes to dispatch to");
+  }
+  for (int i = 0; i < batch_sizes.size(); ++i) {
+    if (batch_sizes[i] <= 0 ||
+        (i > 0 && batch_sizes[i] <= batch_sizes[i - 1])) {
+      return errors::InvalidArgument(
+          "Batch sizes must be positive and increasing: ",
+          absl::StrJoin(batch_sizes, ","));
+    }
+  }
+
+  string includes;
+  for (const string& include : include_headers) {
+    absl::StrAppend(&includes, "#include \"", include, "\"\n");
+  }
+  string ns_start;
+  for (const string& n : opts.namespaces) {
+    ns_start += absl::StrCat("namespace ", n, " {\n");
+  }
+  ns_start += "\n";
+  string ns_end("\n");
+  for (int i = opts.namespaces.size() - 1; i >= 0; --i) {
+    ns_end += absl::StrCat("}  // end namespace ", opts.namespaces[i], "\n");
+  }
+
+  string cases, members;
+  for (int64_t batch_size : batch_sizes) {
+    const string specialization =
+        absl::StrCat(opts.class_name, "_b", batch_size);
+    absl::StrAppend(&cases, "      case ", batch_size, ":\n",
+                    "        return Get(&b", batch_size, "_);\n");
+    absl::StrAppend(&members, "  std::unique_ptr<", specialization, "> b",
+                    batch_size, "_;\n");
+  }
+
+  *header =
+      R"(// Generated by tfcompile, the TensorFlow graph compiler.  DO NOT EDIT!
+//
+// This header dispatches to one of several ahead-of-time compilations of a
+// TensorFlow graph, each specialized for a fixed batch size.
+//
+// clang-format off
+
+#ifndef TFCOMPILE_GENERATED_{{GUARD}}_H_  // NOLINT(build/header_guard)
+#define TFCOMPILE_GENERATED_{{GUARD}}_H_  // NOLINT(build/header_guard)
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+{{INCLUDES}}
+#include "tensorflow/compiler/tf2xla/xla_compiled_cpu_function.h"
+
+{{NS_START}}
+// {{CLASS}} runs a computation compiled for each of the batch sizes in
+// kBatchSizes. Usage example:
+//
+//   {{CLASS}} computation;
+//   tensorflow::XlaCompiledCpuFunction* specialization =
+//       computation.ForBatchSize(batch_size);
+//   // ...set args, padded to the specialization's batch size
+//   CHECK(specialization->Run());
+//   // ...inspect the first batch_size rows of the results
+//
+// The specializations are created on first use and share the AllocMode of
+// this class. This class is thread-compatible.
+class {{CLASS}} final {
+ public:
+  using AllocMode = tensorflow::XlaCompiledCpuFunction::AllocMode;
+
+  static constexpr size_t kNumBatchSizes = {{NUM_BATCH_SIZES}};
+  static constexpr int64_t kBatchSizes[kNumBatchSizes] = {{{BATCH_SIZES}}};
+
+  explicit {{CLASS}}(AllocMode alloc_mode =
+                         AllocMode::ARGS_VARIABLES_RESULTS_PROFILES_AND_TEMPS)
+      : alloc_mode_(alloc_mode) {}
+
+  {{CLASS}}(const {{CLASS}}&) = delete;
+  {{CLASS}}& operator=(const {{CLASS}}&) = delete;
+
+  // Returns the smallest compiled batch size not smaller than batch_size, or
+  // -1 if batch_size is larger than all of them.
+  static int64_t SpecializationFor(int64_t batch_size) {
+    for (int64_t specialization : kBatchSizes) {
+      if (specialization >= batch_size) return specialization;
+    }
+    return -1;
+  }
+
+  // Returns the computation compiled for SpecializationFor(batch_size), or
+  // nullptr if there is none.
+  tensorflow::XlaCompiledCpuFunction* ForBatchSize(int64_t batch_size) {
+    switch (SpecializationFor(batch_size)) {
+{{CASES}}      default:
+        return nullptr;
+    }
+  }
+
+ private:
+  template <typename T>
+  T* Get(std::unique_ptr<T>* specialization) {
+    if (*specialization == nullptr) {
+      *specialization = std::make_unique<T>(alloc_mode_);
+    }
+    return specialization->get();
+  }
+
+  const AllocMode alloc_mode_;
+{{MEMBERS}}};
+{{NS_END}}
+
+#endif  // TFCOMPILE_GENERATED_{{GUARD}}_H_
+
+// clang-format on
+)";
+  const std::vector<std::pair<string, string>> rewrites = {
+      {"{{BATCH_SIZES}}", absl::StrJoin(batch_sizes, ", ")},
+      {"{{CASES}}", cases},
+      {"{{CLASS}}", opts.class_name},
+      {"{{GUARD}}", CreateUniqueIdentifier(opts, "dispatcher")},
+      {"{{INCLUDES}}\n", includes},
+      {"{{MEMBERS}}", members},
+      {"{{NS_END}}\n", ns_end},
+      {"{{NS_START}}\n", ns_start},
+      {"{{NUM_BATCH_SIZES}}", absl::StrCat(batch_sizes.size())}};
+  absl::StrReplaceAll(rewrites, header);
+  return absl::OkStatus();
+}
+
 Status ParseCppClass(const string& cpp_class, string* class_name,
                      std::vector<string>* namespaces) {
   class_name->clear();
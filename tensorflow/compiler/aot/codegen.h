@@ -20,6 +20,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "tensorflow/compiler/aot/compile.h"
 #include "tensorflow/compiler/tf2xla/tf2xla.pb.h"
 
@@ -51,6 +52,10 @@ struct CodegenOpts {
 
   // If true, sets this executable as an XLA Runtime one.
   bool use_xla_runtime = false;
+
+  // The number of threads the computation was compiled to partition its ops
+  // across.
+  int intra_op_parallelism = 1;
 };
 
 // Describes a generated metadata object file.
@@ -90,6 +95,18 @@ Status GenerateHeader(const CodegenOpts& opts, const tf2xla::Config& config,
                       const CompileResult& compile_result,
                       const MetadataResult& metadata_result, string* header);
 
+// GenerateDispatcherHeader generates a C++ header for a class named by `opts`
+// that runs a graph compiled once per batch size in `batch_sizes`.  The
+// specialization for batch size N is expected to be the class
+// `<class_name>_bN`, in the same namespaces, declared in one of
+// `include_headers`.  The class picks the smallest specialization whose batch
+// size is not smaller than the batch to run, so callers pad their batch up to
+// it.
+Status GenerateDispatcherHeader(const CodegenOpts& opts,
+                                absl::Span<const int64_t> batch_sizes,
+                                absl::Span<const string> include_headers,
+                                string* header);
+
 // ParseCppClass parses `cpp_class` into its `class_name` and `namespaces`
 // components.  The syntax is [[<optional_namespace>::],...]<class_name>.  This
 // mirrors the C++ syntax for referring to a class, where multiple namespaces
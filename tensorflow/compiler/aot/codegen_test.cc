@@ -176,6 +176,28 @@ static void CompareWithGoldenFile(
   EXPECT_EQ(golden_file_contents, expected_contents);
 }
 
+TEST(CodegenTest, DispatcherHeader) {
+  CodegenOpts opts;
+  opts.class_name = "MyClass";
+  opts.namespaces = {"foo"};
+  string header;
+  TF_ASSERT_OK(GenerateDispatcherHeader(opts, {1, 8, 32},
+                                        {"a/my_class_b1.h", "a/my_class_b8.h"},
+                                        &header));
+  EXPECT_TRUE(absl::StrContains(header, "#include \"a/my_class_b8.h\""));
+  EXPECT_TRUE(absl::StrContains(header, "namespace foo {"));
+  EXPECT_TRUE(absl::StrContains(header, "class MyClass final {"));
+  EXPECT_TRUE(
+      absl::StrContains(header, "kBatchSizes[kNumBatchSizes] = {1, 8, 32};"));
+  EXPECT_TRUE(absl::StrContains(header, "std::unique_ptr<MyClass_b32> b32_;"));
+  EXPECT_FALSE(absl::StrContains(header, "{{"));
+
+  ExpectErrorContains(GenerateDispatcherHeader(opts, {}, {}, &header),
+                      "No batch sizes");
+  ExpectErrorContains(GenerateDispatcherHeader(opts, {8, 1}, {}, &header),
+                      "positive and increasing");
+}
+
 #if TF_LLVM_X86_AVAILABLE
 TEST(CodegenTest, Golden) {
   // Normally CpuCompiler::CpuCompiler does this, but in this test we've
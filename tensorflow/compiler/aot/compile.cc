@@ -15,12 +15,17 @@ limitations under the License.
 
 #include "tensorflow/compiler/aot/compile.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/base/call_once.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
 #include "llvm-c/Target.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "tensorflow/compiler/aot/codegen.h"
@@ -160,6 +165,7 @@ Status CompileGraph(GraphDef graph_def, const tf2xla::Config& config,
       flags.entry_point,
       xla::cpu::CpuAotCompilationOptions::RelocationModel::BigPic);
   aot_opts.set_use_mlir_hlo_lowering(use_mlir_hlo_lowering);
+  aot_opts.set_intra_op_parallelism(flags.intra_op_parallelism);
 
   if (flags.sanitize_dataflow) {
     aot_opts.set_sanitize_dataflow(flags.sanitize_dataflow);
@@ -236,15 +242,78 @@ static std::string InterpolateErrorMessage(std::string message) {
   return message;
 }
 
+namespace {
+
+// Sets the leading dimension of `shape` to `batch_size` if it is -1.  Returns
+// true if it did.
+bool SpecializeLeadingDim(int64_t batch_size, TensorShapeProto* shape) {
+  if (shape->dim_size() == 0 || shape->dim(0).size() != -1) return false;
+  shape->mutable_dim(0)->set_size(batch_size);
+  return true;
+}
+
+Status WriteDispatcherHeader(const MainFlags& flags) {
+  std::vector<int64_t> batch_sizes;
+  for (absl::string_view size :
+       absl::StrSplit(flags.dispatch_batch_sizes, ',')) {
+    int64_t batch_size;
+    if (!absl::SimpleAtoi(size, &batch_size)) {
+      return errors::InvalidArgument("Invalid --dispatch_batch_sizes: ",
+                                     flags.dispatch_batch_sizes);
+    }
+    batch_sizes.push_back(batch_size);
+  }
+  const std::vector<string> include_headers = absl::StrSplit(
+      flags.dispatch_headers, ',', absl::SkipEmpty());
+  if (flags.cpp_class.empty()) {
+    return errors::InvalidArgument("Must specify --cpp_class");
+  }
+  CodegenOpts codegen_opts;
+  TF_RETURN_IF_ERROR(ParseCppClass(flags.cpp_class, &codegen_opts.class_name,
+                                   &codegen_opts.namespaces));
+  string header;
+  TF_RETURN_IF_ERROR(GenerateDispatcherHeader(codegen_opts, batch_sizes,
+                                              include_headers, &header));
+  return WriteStringToFile(Env::Default(), flags.out_header, header);
+}
+
+}  // namespace
+
+Status SpecializeBatchSize(int64_t batch_size, tf2xla::Config* config) {
+  if (batch_size <= 0) {
+    return errors::InvalidArgument("Batch size must be positive, got ",
+                                   batch_size);
+  }
+  bool specialized = false;
+  for (tf2xla::Feed& feed : *config->mutable_feed()) {
+    specialized |= SpecializeLeadingDim(batch_size, feed.mutable_shape());
+  }
+  if (!specialized) {
+    return errors::InvalidArgument(
+        "--batch_size is set but no feed has a leading dimension of -1");
+  }
+  for (tf2xla::Fetch& fetch : *config->mutable_fetch()) {
+    SpecializeLeadingDim(batch_size, fetch.mutable_shape());
+  }
+  return OkStatus();
+}
+
 Status Main(const MainFlags& flags) {
   absl::call_once(targets_init, &InitializeTargets);
 
+  if (!flags.dispatch_batch_sizes.empty()) {
+    return WriteDispatcherHeader(flags);
+  }
+
   // Process config.
   tf2xla::Config config;
   if (flags.config.empty()) {
     return errors::InvalidArgument("Must specify --config");
   }
   TF_RETURN_IF_ERROR(ReadProtoFile(flags.config, &config));
+  if (flags.batch_size != 0) {
+    TF_RETURN_IF_ERROR(SpecializeBatchSize(flags.batch_size, &config));
+  }
   TF_RETURN_IF_ERROR(ValidateConfig(config));
   if (flags.dump_fetch_nodes) {
     std::set<string> nodes;
@@ -280,6 +349,7 @@ Status Main(const MainFlags& flags) {
   codegen_opts.gen_name_to_index = flags.gen_name_to_index;
   codegen_opts.gen_program_shape = flags.gen_program_shape;
   codegen_opts.target_triple = flags.target_triple;
+  codegen_opts.intra_op_parallelism = std::max(1, flags.intra_op_parallelism);
   // Set the XLA Runtime bit if this is an HloLowering.
   if (!flags.mlir_components.empty() && flags.mlir_components != "None") {
     for (auto component : absl::StrSplit(flags.mlir_components, ',')) {
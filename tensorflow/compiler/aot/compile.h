@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_AOT_COMPILE_H_
 #define TENSORFLOW_COMPILER_AOT_COMPILE_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -46,6 +47,10 @@ struct CompileResult {
 Status CompileGraph(GraphDef graph_def, const tf2xla::Config& config,
                     const MainFlags& flags, CompileResult* compile_result);
 
+// Replaces the leading dimension of every feed and fetch shape in `config`
+// that is -1 with `batch_size`.  Fails if no feed has such a dimension.
+Status SpecializeBatchSize(int64_t batch_size, tf2xla::Config* config);
+
 // The full compilation method, for reuse in a library setting.
 Status Main(const MainFlags& flags);
 
@@ -55,6 +55,11 @@ void AppendMainFlags(std::vector<Flag>* flag_list, MainFlags* flags) {
        "http://clang.llvm.org/docs/CrossCompilation.html#cpu-fpu-abi"},
       {"target_features", &flags->target_features,
        "Target features, e.g. +avx2, +neon, etc."},
+      {"intra_op_parallelism", &flags->intra_op_parallelism,
+       "If above 1, large ops are partitioned into up to this many tasks that "
+       "run in parallel on the thread pool set with set_thread_pool, which "
+       "the generated class then requires.  The binary must link "
+       "@local_xla//xla/service/cpu:runtime_fork_join."},
       {"entry_point", &flags->entry_point,
        "Name of the generated function.  If multiple generated object files "
        "will be linked into the same binary, each will need a unique entry "
@@ -80,6 +85,18 @@ void AppendMainFlags(std::vector<Flag>* flag_list, MainFlags* flags) {
       {"experimental_quantize", &flags->experimental_quantize,
        "If set, quantization passes will run and dump the result before HLO "
        "code generation."},
+      {"batch_size", &flags->batch_size,
+       "If positive, every feed and fetch whose leading dimension is -1 in "
+       "the config is compiled with this leading dimension instead."},
+      {"dispatch_batch_sizes", &flags->dispatch_batch_sizes,
+       "Comma separated list of the batch sizes of the specializations of "
+       "--cpp_class, each compiled with --batch_size=N and --cpp_class "
+       "suffixed with _bN.  If set, only --out_header is written, with a "
+       "class that dispatches to the smallest specialization that fits a "
+       "batch; --graph and --config are not read."},
+      {"dispatch_headers", &flags->dispatch_headers,
+       "Comma separated list of the headers of the specializations, "
+       "included by the --dispatch_batch_sizes header."},
       {"sanitize_dataflow", &flags->sanitize_dataflow,
        "Enable DataFlow Sanitizer pass."},
       {"sanitize_abilists_dataflow", &flags->sanitize_abilists_dataflow,
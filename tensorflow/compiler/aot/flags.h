@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_AOT_FLAGS_H_
 #define TENSORFLOW_COMPILER_AOT_FLAGS_H_
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -35,6 +36,7 @@ struct MainFlags {
   string target_triple;
   string target_cpu;
   string target_features;
+  int32_t intra_op_parallelism = 0;
   string entry_point;
   string cpp_class;
   string out_function_object;
@@ -44,6 +46,11 @@ struct MainFlags {
   string mlir_components;
   bool experimental_quantize = false;
 
+  // Batch specialization options
+  int64_t batch_size = 0;
+  string dispatch_batch_sizes;
+  string dispatch_headers;
+
   // Sanitizer pass options
   bool sanitize_dataflow = false;
   string sanitize_abilists_dataflow;
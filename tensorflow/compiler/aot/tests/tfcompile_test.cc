@@ -38,6 +38,7 @@ limitations under the License.
 #include "tensorflow/compiler/aot/tests/test_graph_tfgather_mlir_bridge.h"
 #include "tensorflow/compiler/aot/tests/test_graph_tfmatmul_mlir_bridge.h"
 #include "tensorflow/compiler/aot/tests/test_graph_tfmatmulandadd_mlir_bridge.h"
+#include "tensorflow/compiler/aot/tests/test_graph_tfmatmulandadd_parallel_mlir_bridge.h"
 #include "tensorflow/compiler/aot/tests/test_graph_tfmatmulandadd_with_profiling_mlir_bridge.h"
 #include "tensorflow/compiler/aot/tests/test_graph_tfsplits_mlir_bridge.h"
 #include "tensorflow/compiler/aot/tests/test_graph_tftop_k_mlir_bridge.h"
@@ -71,6 +72,7 @@ limitations under the License.
 #include "tensorflow/compiler/aot/tests/test_graph_tfgather.h"
 #include "tensorflow/compiler/aot/tests/test_graph_tfmatmul.h"
 #include "tensorflow/compiler/aot/tests/test_graph_tfmatmulandadd.h"
+#include "tensorflow/compiler/aot/tests/test_graph_tfmatmulandadd_parallel.h"
 #include "tensorflow/compiler/aot/tests/test_graph_tfmatmulandadd_with_profiling.h"
 #include "tensorflow/compiler/aot/tests/test_graph_tfsplits.h"
 #include "tensorflow/compiler/aot/tests/test_graph_tftop_k.h"
@@ -737,6 +739,34 @@ TEST(TFCompileTest, HloProfiling) {
               IsSupersetOf({header, total_cycles_profile_line, dot_profile_line,
                             add_profile_line, tuple_profile_line}));
 }
+
+TEST(TFCompileTest, IntraOpParallelism) {
+  MatMulAndAddCompParallel fn;
+  EXPECT_EQ(fn.intra_op_parallelism(), 4);
+  fn.arg0(0, 0) = 1;
+  fn.arg0(0, 1) = 2;
+  fn.arg0(1, 0) = 3;
+  fn.arg0(1, 1) = 4;
+  fn.arg1(0, 0) = 10;
+  fn.arg1(0, 1) = 20;
+  fn.arg1(1, 0) = 30;
+  fn.arg1(1, 1) = 40;
+
+  // The computation may partition its ops onto the thread pool, so it must not
+  // run without one.
+  EXPECT_FALSE(fn.Run());
+
+  Eigen::ThreadPool tp(4);
+  Eigen::ThreadPoolDevice device(&tp, tp.NumThreads());
+  fn.set_thread_pool(&device);
+  ASSERT_TRUE(fn.Run());
+  const float results0[4] = {70, 100, 150, 220};
+  const float results1[4] = {11, 22, 33, 44};
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(fn.result0_data()[i], results0[i]);
+    EXPECT_EQ(fn.result1_data()[i], results1[i]);
+  }
+}
 #endif
 
 }  // namespace
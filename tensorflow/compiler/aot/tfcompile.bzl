@@ -323,6 +323,7 @@ def _tf_library(
             "@local_xla//xla/service/cpu/runtime:rng_ffi",
             "@local_xla//xla/service/cpu:runtime_conv2d",
             "@local_xla//xla/service/cpu:runtime_custom_call_status",
+            "@local_xla//xla/service/cpu:runtime_fork_join",
             "@local_xla//xla/service/cpu:runtime_key_value_sort",
             "@local_xla//xla/service/cpu:runtime_matmul",
             "@local_xla//xla/service/cpu:runtime_topk",
@@ -465,7 +466,8 @@ def tf_library(
         deps = None,
         tags = [],
         copts = [],
-        xla_flags = None):
+        xla_flags = None,
+        batch_sizes = None):
     """Compiles a TensorFlow graph into an executable with fast math enabled.
 
     Given an invocation of tf_library(name="foo", ...), generates the following
@@ -480,6 +482,13 @@ def tf_library(
                       gen_benchmark=True.
     The output header is called <name>.h.
 
+    If batch_sizes is set, the graph is instead compiled once per batch size N
+    into a tf_library named <name>_bN, with cpp_class <cpp_class>_bN and every
+    leading dimension of -1 in config set to N, and foo is a cc_library whose
+    header declares cpp_class as a class that runs the smallest specialization
+    whose batch size is not smaller than the batch.  The foo_test and
+    foo_benchmark targets are generated per specialization.
+
     Args:
       name: The name of the build rule.
       graph: The TensorFlow GraphDef to compile.  If the file ends in '.pbtxt'
@@ -525,7 +534,38 @@ def tf_library(
         library, added to the standard deps if standard_runtime_deps is True.
       tags: tags to apply to subsidiary build rules.
       copts: list of copts to pass to cc rules.
+      batch_sizes: If set, an increasing list of batch sizes to compile the
+        graph for, with the dynamic (-1) leading dimensions of the feeds in
+        config set to each one.
     """
+    if batch_sizes:
+        _tf_batch_specialized_library(
+            name,
+            graph,
+            config,
+            debug_info,
+            freeze_checkpoint,
+            freeze_saver,
+            cpp_class,
+            gen_test,
+            gen_benchmark,
+            gen_compiler_log,
+            visibility,
+            testonly,
+            tfcompile_flags,
+            tfcompile_tool,
+            include_standard_runtime_deps,
+            enable_xla_hlo_profiling,
+            enable_tracemes,
+            mlir_components,
+            deps,
+            tags,
+            copts,
+            xla_flags,
+            batch_sizes,
+        )
+        return
+
     _tf_library(
         name,
         graph,
@@ -551,6 +591,101 @@ def tf_library(
         xla_flags,
     )
 
+def _tf_batch_specialized_library(
+        name,
+        graph,
+        config,
+        debug_info,
+        freeze_checkpoint,
+        freeze_saver,
+        cpp_class,
+        gen_test,
+        gen_benchmark,
+        gen_compiler_log,
+        visibility,
+        testonly,
+        tfcompile_flags,
+        tfcompile_tool,
+        include_standard_runtime_deps,
+        enable_xla_hlo_profiling,
+        enable_tracemes,
+        mlir_components,
+        deps,
+        tags,
+        copts,
+        xla_flags,
+        batch_sizes):
+    if not cpp_class:
+        fail("cpp_class must be specified")
+
+    specializations = []
+    for batch_size in batch_sizes:
+        specialization = "%s_b%d" % (name, batch_size)
+        batch_flag = "--batch_size=%d" % batch_size
+        if type(tfcompile_flags) == type(""):
+            specialization_flags = tfcompile_flags + " " + batch_flag
+        else:
+            specialization_flags = (tfcompile_flags or []) + [batch_flag]
+        _tf_library(
+            specialization,
+            graph,
+            config,
+            debug_info,
+            freeze_checkpoint,
+            freeze_saver,
+            "%s_b%d" % (cpp_class, batch_size),
+            gen_test,
+            gen_benchmark,
+            gen_compiler_log,
+            visibility,
+            testonly,
+            specialization_flags,
+            tfcompile_tool,
+            include_standard_runtime_deps,
+            enable_xla_hlo_profiling,
+            enable_tracemes,
+            mlir_components,
+            deps,
+            tags,
+            copts,
+            xla_flags,
+        )
+        specializations.append(specialization)
+
+    # Rule that runs tfcompile to produce the header of the class dispatching
+    # to the specializations.
+    header_file = name + ".h"
+    native.genrule(
+        name = "gen_" + name,
+        outs = [header_file],
+        cmd = ("CUDA_VISIBLE_DEVICES='' " +
+               "$(location " + tfcompile_tool + ")" +
+               " --cpp_class=" + cpp_class +
+               " --dispatch_batch_sizes=" +
+               ",".join([str(batch_size) for batch_size in batch_sizes]) +
+               " --dispatch_headers=" + ",".join([
+                   native.package_name() + "/" + specialization + ".h"
+                   for specialization in specializations
+               ]) +
+               " --out_header=$@"),
+        tools = [tfcompile_tool],
+        local = 1,
+        testonly = testonly,
+        tags = tags,
+    )
+
+    native.cc_library(
+        name = name,
+        hdrs = [header_file],
+        visibility = visibility,
+        testonly = testonly,
+        deps = [
+            "//tensorflow/compiler/tf2xla:xla_compiled_cpu_function",
+        ] + [":" + specialization for specialization in specializations],
+        tags = tags,
+        copts = copts,
+    )
+
 def target_llvm_triple():
     """Returns the target LLVM triple to be used for compiling the target."""
 
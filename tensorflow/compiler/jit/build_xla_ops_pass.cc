@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/build_xla_ops_pass.h"
 
 #include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "tensorflow/cc/framework/ops.h"
@@ -29,6 +30,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/device_util.h"
 #include "tensorflow/compiler/jit/encapsulate_subgraphs_pass.h"
 #include "tensorflow/compiler/jit/flags.h"
+#include "tensorflow/compiler/jit/resource_operation_safety_analysis.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
 #include "tensorflow/compiler/tf2xla/cc/ops/xla_jit_ops.h"
 #include "tensorflow/compiler/tf2xla/xla_op_registry.h"
@@ -464,11 +466,24 @@ Status PredicateInt32Inputs(const Scope& root, Node* n,
   return absl::OkStatus();
 }
 
+// Returns true if the cluster `n` has resource inputs and no other node in `g`
+// accesses any of them.
+bool AllResourceInputsAreExclusive(const Graph& g, const Node& n) {
+  int num_resource_inputs;
+  if (!TryGetNodeAttr(n.attrs(), kXlaNumResourceArgsAttr,
+                      &num_resource_inputs) ||
+      num_resource_inputs == 0) {
+    return false;
+  }
+  return ComputeExclusiveResourceInputs(g, n).size() == num_resource_inputs;
+}
+
 Status ReplaceNodeWithXlaCompileAndXlaRun(
     jit::DeviceInfoCache* device_info_cache,
     const GraphOptimizationPassOptions& options,
     const FunctionLibraryDefinition& flib_def, bool lazy_compilation_enabled,
-    const DebuggingOpts& debugging_opts, Graph* g, Node* n) {
+    bool donate_resource_updates, const DebuggingOpts& debugging_opts,
+    Graph* g, Node* n) {
   XlaClusterInfo cluster_info;
   TF_RETURN_IF_ERROR(GetXlaClusterInfo(n, &cluster_info));
 
@@ -503,6 +518,9 @@ Status ReplaceNodeWithXlaCompileAndXlaRun(
   TF_RETURN_IF_ERROR(
       GetNodeAttr(n->attrs(), kXlaHasReferenceVarsAttr, &has_ref_attr));
   xla_compile.operation.node()->AddAttr(kXlaHasReferenceVarsAttr, has_ref_attr);
+  if (donate_resource_updates) {
+    xla_compile.operation.node()->AddAttr(kXlaDonateResourceUpdatesAttr, true);
+  }
   TF_RETURN_IF_ERROR(
       CopyIncomingControlEdges(g, /*from=*/n, /*to=*/xla_compile.key.node()));
 
@@ -605,10 +623,23 @@ Status BuildXlaOpsPass::Run(const GraphOptimizationPassOptions& options) {
   VLOG(1) << "check_input_numerics = " << debugging_opts.check_input_numerics;
   VLOG(1) << "check_output_numerics = " << debugging_opts.check_output_numerics;
 
+  // Find the clusters that may update their resource variables in place
+  // before the rewrite adds consumers to the variable handles.
+  absl::flat_hash_set<const Node*> donating_kernels;
+  if (flags.tf_xla_donate_resource_updates) {
+    for (const Node* n : xla_compiled_kernels) {
+      if (AllResourceInputsAreExclusive(*graph, *n)) {
+        donating_kernels.insert(n);
+      }
+    }
+  }
+
   for (Node* n : xla_compiled_kernels) {
+    const bool donate_resource_updates = donating_kernels.contains(n);
     TF_RETURN_IF_ERROR(ReplaceNodeWithXlaCompileAndXlaRun(
         &device_info_cache, options, *options.flib_def,
-        lazy_compilation_enabled, debugging_opts, graph, n));
+        lazy_compilation_enabled, donate_resource_updates, debugging_opts,
+        graph, n));
   }
 
   if (VLOG_IS_ON(1)) {
@@ -0,0 +1,136 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/cluster_cost_model.h"
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+
+namespace tensorflow {
+namespace {
+
+// Fixed cost of compiling any cluster: building the XLA computation, running
+// the HLO pipeline and emitting code.
+constexpr int64_t kCompileBaseUs = 50000;
+
+// Per-op compile time, by op kind.
+constexpr int64_t kCompileTrivialOpUs = 50;
+constexpr int64_t kCompileFusibleOpUs = 500;
+constexpr int64_t kCompileLibraryOpUs = 2000;
+
+// TensorFlow executor overhead of dispatching one op.
+constexpr int64_t kTfOpOverheadUs = 5;
+
+// Bytes written and read back per microsecond, used to price the intermediate
+// buffers removed by fusion.
+constexpr int64_t kMemoryBytesPerUs = 10000;
+
+enum class OpKind { kTrivial, kFusible, kLibrary };
+
+OpKind GetOpKind(const Node& n) {
+  static const auto* trivial_ops = new absl::flat_hash_set<absl::string_view>{
+      "Const",       "Identity", "IdentityN",    "NoOp",     "Shape",
+      "ShapeN",      "Rank",     "Size",         "Reshape",  "Squeeze",
+      "ExpandDims",  "Snapshot", "StopGradient", "PreventGradient",
+      "ZerosLike",   "OnesLike", "Placeholder",  "PlaceholderWithDefault",
+      "VarHandleOp", "_Arg",     "_Retval"};
+  static const auto* library_ops = new absl::flat_hash_set<absl::string_view>{
+      "MatMul",
+      "BatchMatMul",
+      "BatchMatMulV2",
+      "BatchMatMulV3",
+      "Einsum",
+      "Conv2D",
+      "Conv2DBackpropFilter",
+      "Conv2DBackpropInput",
+      "Conv3D",
+      "Conv3DBackpropFilterV2",
+      "Conv3DBackpropInputV2",
+      "DepthwiseConv2dNative",
+      "DepthwiseConv2dNativeBackpropFilter",
+      "DepthwiseConv2dNativeBackpropInput",
+      "FFT",
+      "IFFT",
+      "RFFT",
+      "IRFFT",
+      "FFT2D",
+      "IFFT2D",
+      "RFFT2D",
+      "IRFFT2D",
+      "FFT3D",
+      "IFFT3D",
+      "RFFT3D",
+      "IRFFT3D"};
+  if (trivial_ops->contains(n.type_string())) return OpKind::kTrivial;
+  if (library_ops->contains(n.type_string())) return OpKind::kLibrary;
+  return OpKind::kFusible;
+}
+
+// Returns the size of the outputs of `n` if they are all statically known,
+// or 0 otherwise.
+int64_t GetStaticOutputBytes(const Node& n) {
+  std::vector<PartialTensorShape> shapes;
+  if (n.attrs().Find("_output_shapes") == nullptr ||
+      !GetNodeAttr(n.attrs(), "_output_shapes", &shapes).ok() ||
+      shapes.size() != n.num_outputs()) {
+    return 0;
+  }
+  int64_t bytes = 0;
+  for (int i = 0; i < shapes.size(); ++i) {
+    if (!shapes[i].IsFullyDefined()) return 0;
+    bytes += shapes[i].num_elements() * DataTypeSize(n.output_type(i));
+  }
+  return bytes;
+}
+
+}  // namespace
+
+int64_t ClusterCostEstimate::SpeedupUs(int64_t steps) const {
+  if (step_saving_us > 0 && steps > 0 &&
+      step_saving_us > std::numeric_limits<int64_t>::max() / steps) {
+    return std::numeric_limits<int64_t>::max();
+  }
+  return step_saving_us * steps - compile_time_us;
+}
+
+ClusterCostEstimate EstimateClusterCost(absl::Span<const Node* const> nodes) {
+  ClusterCostEstimate estimate;
+  estimate.compile_time_us = kCompileBaseUs;
+  for (const Node* n : nodes) {
+    switch (GetOpKind(*n)) {
+      case OpKind::kTrivial:
+        estimate.compile_time_us += kCompileTrivialOpUs;
+        break;
+      case OpKind::kLibrary:
+        estimate.compile_time_us += kCompileLibraryOpUs;
+        break;
+      case OpKind::kFusible:
+        estimate.compile_time_us += kCompileFusibleOpUs;
+        estimate.step_saving_us +=
+            kTfOpOverheadUs + GetStaticOutputBytes(*n) / kMemoryBytesPerUs;
+        break;
+    }
+  }
+  return estimate;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,58 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_CLUSTER_COST_MODEL_H_
+#define TENSORFLOW_COMPILER_JIT_CLUSTER_COST_MODEL_H_
+
+#include <cstdint>
+
+#include "absl/types/span.h"
+#include "tensorflow/core/graph/graph.h"
+
+namespace tensorflow {
+
+// The predicted cost and benefit of compiling an auto-clustering candidate
+// with XLA.
+struct ClusterCostEstimate {
+  // Microseconds spent compiling the cluster.
+  int64_t compile_time_us = 0;
+
+  // Microseconds saved per step by running the cluster with XLA instead of
+  // TensorFlow.
+  int64_t step_saving_us = 0;
+
+  // Returns the net speedup of the cluster over `steps` steps, saturating
+  // instead of overflowing.
+  int64_t SpeedupUs(int64_t steps) const;
+};
+
+// Estimates the cost of compiling `nodes` as one cluster from their op mix and
+// size.  This is a deliberately simple analytical model:
+//
+//  - Elementwise ops and reductions save the TensorFlow per-op dispatch
+//    overhead and, when their output shape is statically known from the
+//    `_output_shapes` attribute, the memory traffic of materializing their
+//    output, since XLA fuses them with their neighbors.
+//  - Ops that XLA lowers to the same library calls as TensorFlow (matmuls,
+//    convolutions, FFTs) save nothing but are comparatively expensive to
+//    compile.
+//  - Constants, identities and shape-manipulating ops are free on both sides.
+//
+// Every cluster also pays a fixed compilation overhead.
+ClusterCostEstimate EstimateClusterCost(absl::Span<const Node* const> nodes);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_CLUSTER_COST_MODEL_H_
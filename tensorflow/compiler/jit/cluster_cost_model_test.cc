@@ -0,0 +1,89 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/cluster_cost_model.h"
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/cc/framework/ops.h"
+#include "tensorflow/cc/framework/scope.h"
+#include "tensorflow/cc/ops/array_ops.h"
+#include "tensorflow/cc/ops/math_ops.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(ClusterCostModelTest, SpeedupUs) {
+  ClusterCostEstimate estimate;
+  estimate.compile_time_us = 1000;
+  estimate.step_saving_us = 10;
+
+  EXPECT_EQ(estimate.SpeedupUs(0), -1000);
+  EXPECT_EQ(estimate.SpeedupUs(100), 0);
+  EXPECT_EQ(estimate.SpeedupUs(1000), 9000);
+  EXPECT_EQ(estimate.SpeedupUs(std::numeric_limits<int64_t>::max()),
+            std::numeric_limits<int64_t>::max());
+}
+
+TEST(ClusterCostModelTest, OpMix) {
+  Scope root = Scope::NewRootScope().ExitOnError();
+  Output a = ops::Placeholder(root.WithOpName("a"), DT_FLOAT);
+  Output b = ops::Placeholder(root.WithOpName("b"), DT_FLOAT);
+  Output add = ops::Add(root.WithOpName("add"), a, b);
+  Output identity = ops::Identity(root.WithOpName("identity"), add);
+  Output matmul = ops::MatMul(root.WithOpName("matmul"), identity, b);
+
+  ClusterCostEstimate fusible = EstimateClusterCost({add.node()});
+  ClusterCostEstimate trivial = EstimateClusterCost({identity.node()});
+  ClusterCostEstimate library = EstimateClusterCost({matmul.node()});
+
+  EXPECT_GT(fusible.step_saving_us, 0);
+  EXPECT_EQ(trivial.step_saving_us, 0);
+  EXPECT_EQ(library.step_saving_us, 0);
+  EXPECT_LT(trivial.compile_time_us, fusible.compile_time_us);
+  EXPECT_LT(fusible.compile_time_us, library.compile_time_us);
+
+  ClusterCostEstimate all =
+      EstimateClusterCost({add.node(), identity.node(), matmul.node()});
+  EXPECT_EQ(all.step_saving_us, fusible.step_saving_us);
+  EXPECT_GT(all.compile_time_us, library.compile_time_us);
+}
+
+TEST(ClusterCostModelTest, StaticOutputShapes) {
+  Scope root = Scope::NewRootScope().ExitOnError();
+  Output a = ops::Placeholder(root.WithOpName("a"), DT_FLOAT);
+  Output small = ops::Neg(root.WithOpName("small"), a);
+  Output large = ops::Neg(root.WithOpName("large"), a);
+  small.node()->AddAttr("_output_shapes",
+                        std::vector<PartialTensorShape>{
+                            PartialTensorShape({8})});
+  large.node()->AddAttr("_output_shapes",
+                        std::vector<PartialTensorShape>{
+                            PartialTensorShape({1024, 1024})});
+
+  EXPECT_GT(EstimateClusterCost({large.node()}).step_saving_us,
+            EstimateClusterCost({small.node()}).step_saving_us);
+  EXPECT_EQ(EstimateClusterCost({small.node()}).step_saving_us,
+            EstimateClusterCost({a.node(), small.node()}).step_saving_us);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,115 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/clustering_profile.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/jit/flags.h"
+#include "tensorflow/compiler/jit/xla_activity.pb.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+ClusteringProfile::ClusteringProfile(const XlaClusteringProfile& profile) {
+  absl::flat_hash_map<std::string, int64_t> tf_time_us;
+  for (const auto& node : profile.nodes()) {
+    tf_time_us[node.name()] += node.tf_time_us();
+  }
+
+  for (const auto& cluster : profile.clusters()) {
+    if (cluster.nodes().empty()) continue;
+    const int index = clusters_.size();
+    Cluster& profiled = clusters_.emplace_back();
+    profiled.speedup_us = -cluster.xla_time_us();
+    for (const std::string& node : cluster.nodes()) {
+      // A node is in at most one cluster of a run.
+      if (!cluster_for_node_.emplace(node, index).second) {
+        LOG(WARNING) << "Ignoring " << node << " in profiled cluster "
+                     << cluster.name() << ": it is in another cluster.";
+        continue;
+      }
+      profiled.nodes.push_back(node);
+      auto it = tf_time_us.find(node);
+      if (it != tf_time_us.end()) profiled.speedup_us += it->second;
+    }
+  }
+}
+
+absl::StatusOr<ClusteringProfile> ClusteringProfile::Load(
+    Env* env, const std::string& path) {
+  XlaClusteringProfile profile;
+  TF_RETURN_IF_ERROR(ReadTextOrBinaryProto(env, path, &profile));
+  return ClusteringProfile(profile);
+}
+
+const ClusteringProfile* ClusteringProfile::Get() {
+  static const ClusteringProfile* profile = []() -> ClusteringProfile* {
+    const std::string& path =
+        GetMarkForCompilationPassFlags()->tf_xla_clustering_profile;
+    if (path.empty()) return nullptr;
+    absl::StatusOr<ClusteringProfile> loaded = Load(Env::Default(), path);
+    if (!loaded.ok()) {
+      LOG(ERROR) << "Ignoring --tf_xla_clustering_profile: "
+                 << loaded.status();
+      return nullptr;
+    }
+    return new ClusteringProfile(*std::move(loaded));
+  }();
+  return profile;
+}
+
+bool ClusteringProfile::InSameProfitableCluster(absl::string_view a,
+                                                absl::string_view b) const {
+  auto it_a = cluster_for_node_.find(a);
+  auto it_b = cluster_for_node_.find(b);
+  return it_a != cluster_for_node_.end() && it_b != cluster_for_node_.end() &&
+         it_a->second == it_b->second &&
+         clusters_[it_a->second].speedup_us > 0;
+}
+
+std::optional<int64_t> ClusteringProfile::EstimateSpeedupUs(
+    const absl::flat_hash_set<std::string>& nodes) const {
+  absl::flat_hash_set<int> candidates;
+  for (const std::string& node : nodes) {
+    auto it = cluster_for_node_.find(node);
+    if (it != cluster_for_node_.end()) candidates.insert(it->second);
+  }
+
+  std::optional<int64_t> speedup_us;
+  for (int index : candidates) {
+    const Cluster& cluster = clusters_[index];
+    bool contained = true;
+    for (const std::string& node : cluster.nodes) {
+      if (!nodes.contains(node)) {
+        contained = false;
+        break;
+      }
+    }
+    if (contained) speedup_us = speedup_us.value_or(0) + cluster.speedup_us;
+  }
+  return speedup_us;
+}
+
+}  // namespace tensorflow
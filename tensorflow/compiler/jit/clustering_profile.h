@@ -0,0 +1,73 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_CLUSTERING_PROFILE_H_
+#define TENSORFLOW_COMPILER_JIT_CLUSTERING_PROFILE_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/jit/xla_activity.pb.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+
+// The measured speedup of the XLA clusters of a prior run, as recorded in an
+// `XlaClusteringProfile`.  The speedup of a profiled cluster is the TensorFlow
+// time of its nodes minus its XLA time; it is negative if the cluster ran
+// slower with XLA.
+class ClusteringProfile {
+ public:
+  explicit ClusteringProfile(const XlaClusteringProfile& profile);
+
+  // Reads an `XlaClusteringProfile` from `path`, in text or binary format.
+  static absl::StatusOr<ClusteringProfile> Load(Env* env,
+                                                const std::string& path);
+
+  // Returns the profile set by --tf_xla_clustering_profile, or nullptr if the
+  // flag is not set or the profile can't be read.
+  static const ClusteringProfile* Get();
+
+  // Returns true if the nodes named `a` and `b` were in the same profiled
+  // cluster and that cluster ran faster with XLA.
+  bool InSameProfitableCluster(absl::string_view a, absl::string_view b) const;
+
+  // Returns the measured speedup, in microseconds per step, of compiling the
+  // nodes named `nodes` as one cluster: the sum of the speedups of the profiled
+  // clusters all of whose nodes are in `nodes`.  Returns std::nullopt if there
+  // is no such profiled cluster.
+  std::optional<int64_t> EstimateSpeedupUs(
+      const absl::flat_hash_set<std::string>& nodes) const;
+
+ private:
+  struct Cluster {
+    std::vector<std::string> nodes;
+    int64_t speedup_us;
+  };
+
+  std::vector<Cluster> clusters_;
+  // Maps a node name to the index of its profiled cluster in `clusters_`.
+  absl::flat_hash_map<std::string, int> cluster_for_node_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_CLUSTERING_PROFILE_H_
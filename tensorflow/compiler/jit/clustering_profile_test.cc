@@ -0,0 +1,94 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/clustering_profile.h"
+
+#include <optional>
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/compiler/jit/xla_activity.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+void AddNode(const std::string& name, int64_t tf_time_us,
+             XlaClusteringProfile* profile) {
+  XlaClusteringProfile::NodeProfile* node = profile->add_nodes();
+  node->set_name(name);
+  node->set_tf_time_us(tf_time_us);
+}
+
+// Returns a profile where cluster_0 = {a, b} ran 15us faster with XLA and
+// cluster_1 = {c, d} ran 10us slower.
+XlaClusteringProfile CreateProfile() {
+  XlaClusteringProfile profile;
+  AddNode("a", 10, &profile);
+  AddNode("b", 10, &profile);
+  AddNode("c", 5, &profile);
+  AddNode("d", 5, &profile);
+
+  XlaClusteringProfile::ClusterProfile* fast = profile.add_clusters();
+  fast->set_name("cluster_0");
+  fast->add_nodes("a");
+  fast->add_nodes("b");
+  fast->set_xla_time_us(5);
+
+  XlaClusteringProfile::ClusterProfile* slow = profile.add_clusters();
+  slow->set_name("cluster_1");
+  slow->add_nodes("c");
+  slow->add_nodes("d");
+  slow->set_xla_time_us(20);
+  return profile;
+}
+
+TEST(ClusteringProfileTest, InSameProfitableCluster) {
+  ClusteringProfile profile(CreateProfile());
+
+  EXPECT_TRUE(profile.InSameProfitableCluster("a", "b"));
+  EXPECT_FALSE(profile.InSameProfitableCluster("c", "d"));
+  EXPECT_FALSE(profile.InSameProfitableCluster("a", "c"));
+  EXPECT_FALSE(profile.InSameProfitableCluster("a", "unknown"));
+}
+
+TEST(ClusteringProfileTest, EstimateSpeedup) {
+  ClusteringProfile profile(CreateProfile());
+
+  EXPECT_EQ(profile.EstimateSpeedupUs({"a", "b"}), 15);
+  EXPECT_EQ(profile.EstimateSpeedupUs({"c", "d", "e"}), -10);
+  EXPECT_EQ(profile.EstimateSpeedupUs({"a", "b", "c", "d"}), 5);
+  // Only part of cluster_0 and cluster_1.
+  EXPECT_EQ(profile.EstimateSpeedupUs({"a", "c"}), std::nullopt);
+  EXPECT_EQ(profile.EstimateSpeedupUs({"e"}), std::nullopt);
+}
+
+TEST(ClusteringProfileTest, Load) {
+  const std::string path =
+      io::JoinPath(testing::TmpDir(), "clustering_profile.pb");
+  TF_ASSERT_OK(WriteBinaryProto(Env::Default(), path, CreateProfile()));
+
+  TF_ASSERT_OK_AND_ASSIGN(ClusteringProfile profile,
+                          ClusteringProfile::Load(Env::Default(), path));
+  EXPECT_TRUE(profile.InSameProfitableCluster("a", "b"));
+}
+
+}  // namespace
+}  // namespace tensorflow
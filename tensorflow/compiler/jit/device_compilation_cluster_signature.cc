@@ -15,9 +15,12 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/device_compilation_cluster_signature.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <string>
 #include <utility>
 #include <variant>
+#include <vector>
 
 namespace tensorflow {
 namespace {
@@ -79,6 +82,62 @@ struct SignatureHashCombiner {
     return h;
   }
 };
+
+std::string ShapeString(absl::Span<const int64_t> dims) {
+  return absl::StrCat("[", absl::StrJoin(dims, ","), "]");
+}
+
+std::string ShapeString(const TensorShape& shape) {
+  return ShapeString(shape.dim_sizes());
+}
+
+// Functor that appends the differences between an arg of two signatures.
+struct SignatureDiffAppender {
+  SignatureDiffAppender(int index, std::vector<Signature::Difference>* dest)
+      : index(index), dest(dest) {}
+  int index;
+  std::vector<Signature::Difference>* dest;
+
+  void Append(absl::string_view kind, absl::string_view from,
+              absl::string_view to) {
+    dest->push_back({index, std::string(kind),
+                     absl::StrCat("arg ", index, " ", kind, ": ", from, " -> ",
+                                  to)});
+  }
+  void AppendTypeAndShape(DataType arg_type, DataType other_type,
+                          const std::string& arg_shape,
+                          const std::string& other_shape) {
+    if (arg_type != other_type) {
+      Append("dtype", DataTypeString(other_type), DataTypeString(arg_type));
+    }
+    if (arg_shape != other_shape) {
+      Append("shape", other_shape, arg_shape);
+    }
+  }
+
+  // `arg` is the arg of the new signature and `other` the one of the
+  // previous signature.
+  void operator()(const Tensor& arg, const Tensor& other) {
+    const std::string arg_shape = ShapeString(arg.shape());
+    const std::string other_shape = ShapeString(other.shape());
+    AppendTypeAndShape(arg.dtype(), other.dtype(), arg_shape, other_shape);
+    if (arg.dtype() == other.dtype() && arg_shape == other_shape &&
+        arg.tensor_data() != other.tensor_data()) {
+      Append("constant_value", other.DebugString(), arg.DebugString());
+    }
+  }
+  void operator()(const TensorTypeAndShape& arg,
+                  const TensorTypeAndShape& other) {
+    AppendTypeAndShape(arg.first, other.first, ShapeString(arg.second),
+                       ShapeString(other.second));
+  }
+  void operator()(const Tensor& arg, const TensorTypeAndShape& other) {
+    Append("arg_kind", "parameter", "constant");
+  }
+  void operator()(const TensorTypeAndShape& arg, const Tensor& other) {
+    Append("arg_kind", "constant", "parameter");
+  }
+};
 }  // namespace
 
 // Compute a string signature which encodes the shapes of the
@@ -102,6 +161,26 @@ bool Signature::operator==(const Signature& other) const {
   return true;
 }
 
+std::vector<Signature::Difference> Signature::Diff(
+    const Signature& previous) const {
+  std::vector<Difference> differences;
+  if (name != previous.name) {
+    differences.push_back(
+        {-1, "attrs", absl::StrCat("attrs: ", previous.name, " -> ", name)});
+  }
+  if (args.size() != previous.args.size()) {
+    differences.push_back({-1, "num_args",
+                           absl::StrCat("num_args: ", previous.args.size(),
+                                        " -> ", args.size())});
+  }
+  for (int i = 0, end = std::min(args.size(), previous.args.size()); i < end;
+       ++i) {
+    std::visit(SignatureDiffAppender(i, &differences), args[i],
+               previous.args[i]);
+  }
+  return differences;
+}
+
 uint64 Signature::Hash::operator()(const Signature& signature) const {
   uint64 h = std::hash<string>()(signature.name);
   for (const auto& arg : signature.args) {
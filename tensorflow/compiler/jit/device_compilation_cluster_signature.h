@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <utility>
 #include <variant>
+#include <vector>
 
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
 
@@ -45,6 +46,25 @@ struct DeviceCompilationClusterSignature {
   // Returns a human-readable description of the signature.
   string HumanString() const;
 
+  // A difference between two signatures, i.e. a reason why a signature needed
+  // its own compilation.
+  struct Difference {
+    // Index of the argument that changed, or -1 if the change is not specific
+    // to one argument.
+    int arg_index;
+    // What changed: "attrs", "num_args", "arg_kind" (an argument became or
+    // stopped being a compile-time constant), "dtype", "shape" or
+    // "constant_value".
+    string kind;
+    // Human-readable description, e.g. "arg 1 shape: [2,3] -> [4,3]".
+    string description;
+  };
+
+  // Returns the differences of this signature from `previous`, a signature of
+  // the same function.
+  std::vector<Difference> Diff(
+      const DeviceCompilationClusterSignature& previous) const;
+
   // Builds the signature for a compilation.
   static absl::StatusOr<DeviceCompilationClusterSignature> Build(
       const NameAttrList& function,
@@ -20,6 +20,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/tf2xla/shape_util.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "xla/client/client_library.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -94,6 +95,47 @@ TEST(DeviceCompilationClusterSignatureTest, SignatureUniqueness) {
   EXPECT_FALSE(s1 == s2);
 }
 
+TEST(DeviceCompilationClusterSignatureTest, Diff) {
+  NameAttrList fn;
+  fn.set_name("afunction");
+  std::vector<XlaCompiler::Argument> args(2);
+  args[0].kind = XlaCompiler::Argument::kConstant;
+  args[0].type = DT_INT32;
+  args[0].constant_value = test::AsTensor<int32>({1, 2});
+  args[1].kind = XlaCompiler::Argument::kParameter;
+  args[1].type = DT_FLOAT;
+  args[1].shape = TensorShape({2, 3});
+  TF_ASSERT_OK_AND_ASSIGN(DeviceCompilationClusterSignature s1,
+                          DeviceCompilationClusterSignature::Build(fn, args));
+  EXPECT_TRUE(s1.Diff(s1).empty());
+
+  args[0].constant_value = test::AsTensor<int32>({1, 3});
+  args[1].type = DT_HALF;
+  args[1].shape = TensorShape({4, 3});
+  TF_ASSERT_OK_AND_ASSIGN(DeviceCompilationClusterSignature s2,
+                          DeviceCompilationClusterSignature::Build(fn, args));
+
+  std::vector<DeviceCompilationClusterSignature::Difference> differences =
+      s2.Diff(s1);
+  ASSERT_EQ(differences.size(), 3);
+  EXPECT_EQ(differences[0].arg_index, 0);
+  EXPECT_EQ(differences[0].kind, "constant_value");
+  EXPECT_EQ(differences[1].arg_index, 1);
+  EXPECT_EQ(differences[1].kind, "dtype");
+  EXPECT_EQ(differences[1].description, "arg 1 dtype: float -> half");
+  EXPECT_EQ(differences[2].arg_index, 1);
+  EXPECT_EQ(differences[2].kind, "shape");
+  EXPECT_EQ(differences[2].description, "arg 1 shape: [2,3] -> [4,3]");
+
+  args.pop_back();
+  TF_ASSERT_OK_AND_ASSIGN(DeviceCompilationClusterSignature s3,
+                          DeviceCompilationClusterSignature::Build(fn, args));
+  differences = s3.Diff(s2);
+  ASSERT_EQ(differences.size(), 1);
+  EXPECT_EQ(differences[0].arg_index, -1);
+  EXPECT_EQ(differences[0].description, "num_args: 2 -> 1");
+}
+
 void BM_BuildSignature(::testing::benchmark::State& state) {
   const int n_args = state.range(0);
 
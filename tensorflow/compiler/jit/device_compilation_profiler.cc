@@ -15,12 +15,16 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/device_compilation_profiler.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "tensorflow/compiler/jit/device_compilation_cluster_signature.h"
 #include "tensorflow/compiler/jit/xla_activity.pb.h"
 #include "tensorflow/compiler/jit/xla_activity_listener.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
@@ -110,6 +114,8 @@ Status DeviceCompilationProfiler::RegisterCompilation(
   const uint64 compile_time_s = compile_time_us / 1.0e6;
   it->second.compile_count++;
   it->second.cumulative_compile_time_us += compile_time_us;
+  it->second.max_compile_time_us =
+      std::max(it->second.max_compile_time_us, compile_time_us);
   VLOG(1) << "Compiled " << function_name << " " << it->second.compile_count
           << " times, compile time: " << compile_time_us
           << " us, cumulative: " << it->second.cumulative_compile_time_us
@@ -127,9 +133,61 @@ Status DeviceCompilationProfiler::RegisterCompilation(
   jit_compilation_activity.set_cumulative_compile_time_us(
       it->second.cumulative_compile_time_us);
   jit_compilation_activity.set_used_persistent_cache(used_persistent_cache);
+  if (it->second.compile_count > 1) {
+    jit_compilation_activity.set_recompilation_cause(
+        it->second.last_recompilation_cause);
+  }
   return BroadcastXlaActivity(std::move(jit_compilation_activity));
 }
 
+void DeviceCompilationProfiler::RegisterCompilationSignature(
+    const NameAttrList& function,
+    const DeviceCompilationClusterSignature& signature) {
+  mutex_lock lock(mu_);
+  auto [last_signature, first_compilation] =
+      last_signatures_.emplace(function.name(), signature);
+  if (first_compilation) return;
+
+  std::vector<DeviceCompilationClusterSignature::Difference> differences =
+      signature.Diff(last_signature->second);
+  last_signature->second = signature;
+  if (differences.empty()) return;
+
+  auto it =
+      cluster_compile_stats_.emplace(function.name(), ClusterCompileStats{})
+          .first;
+  std::vector<std::string> descriptions;
+  for (const auto& difference : differences) {
+    metrics::RecordXlaRecompilation(difference.kind);
+    const std::string cause =
+        difference.arg_index < 0
+            ? difference.kind
+            : absl::StrCat("arg ", difference.arg_index, " ", difference.kind);
+    ++it->second.recompilation_causes[cause];
+    descriptions.push_back(difference.description);
+  }
+  it->second.last_recompilation_cause = absl::StrJoin(descriptions, "; ");
+  VLOG(1) << "Recompiling " << function.name() << " because of "
+          << it->second.last_recompilation_cause;
+}
+
+void DeviceCompilationProfiler::RegisterAsyncCompilation(
+    const NameAttrList& function, int64_t queue_time_us,
+    int64_t time_to_switch_us) {
+  mutex_lock lock(mu_);
+  auto it =
+      cluster_compile_stats_.emplace(function.name(), ClusterCompileStats{})
+          .first;
+  it->second.async_compile_count++;
+  it->second.cumulative_async_queue_time_us += queue_time_us;
+  it->second.cumulative_time_to_switch_us += time_to_switch_us;
+  it->second.max_time_to_switch_us =
+      std::max(it->second.max_time_to_switch_us, time_to_switch_us);
+  VLOG(1) << "Switched " << function.name() << " to its compiled executable "
+          << time_to_switch_us << " us after queueing its compilation, of "
+          << "which " << queue_time_us << " us waiting for a compiler thread";
+}
+
 bool DeviceCompilationProfiler::ShouldCompileCluster(
     const NameAttrList& function, DeviceCompileMode compile_mode,
     int64_t current_request_count) {
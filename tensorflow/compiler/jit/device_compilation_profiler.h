@@ -19,6 +19,8 @@ limitations under the License.
 #include <cstdint>
 #include <string>
 
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/compiler/jit/device_compilation_cluster_signature.h"
 #include "tensorflow/compiler/jit/xla_compile_util.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 
@@ -41,6 +43,28 @@ class DeviceCompilationProfiler : public ResourceBase {
     // Cumulative time spent compiling the cluster.
     int64_t cumulative_compile_time_us = 0;
 
+    // Longest time spent in a single compilation of the cluster.
+    int64_t max_compile_time_us = 0;
+
+    // Number of asynchronous compilations of the cluster that completed.
+    int64_t async_compile_count = 0;
+
+    // Cumulative time asynchronous compilations waited for a compiler thread.
+    int64_t cumulative_async_queue_time_us = 0;
+
+    // Time from queueing an asynchronous compilation to its executable being
+    // available, during which the cluster runs on the fallback path.
+    int64_t cumulative_time_to_switch_us = 0;
+    int64_t max_time_to_switch_us = 0;
+
+    // Number of recompilations caused by each kind of signature change,
+    // keyed by e.g. "arg 1 shape" or "num_args".
+    absl::flat_hash_map<std::string, int64_t> recompilation_causes;
+
+    // Description of the signature change that caused the last
+    // recompilation.
+    std::string last_recompilation_cause;
+
     // True if we have decided that this cluster is too dynamic (i.e. its shapes
     // change too frequently) to profitably JIT compile.  Once a cluster is
     // tagged megamorphic, it stays megamorphic forever.
@@ -51,6 +75,12 @@ class DeviceCompilationProfiler : public ResourceBase {
           "DeviceCompilationProfiler::ClusterCompileStats {compile_count=",
           compile_count, ", execution_count=", execution_count,
           ", cumulative_compile_time_us=", cumulative_compile_time_us,
+          ", max_compile_time_us=", max_compile_time_us,
+          ", async_compile_count=", async_compile_count,
+          ", cumulative_async_queue_time_us=", cumulative_async_queue_time_us,
+          ", cumulative_time_to_switch_us=", cumulative_time_to_switch_us,
+          ", max_time_to_switch_us=", max_time_to_switch_us,
+          ", last_recompilation_cause=\"", last_recompilation_cause, "\"",
           ", is_megamorphic=", is_megamorphic, "}");
     }
   };
@@ -78,6 +108,24 @@ class DeviceCompilationProfiler : public ResourceBase {
                                      int64_t compile_time_us,
                                      bool used_persistent_cache);
 
+  // Registers the signature of a compilation of `function`, before the
+  // corresponding `RegisterCompilation`. If the cluster was compiled before,
+  // records how `signature` differs from the previous one, which explains the
+  // recompilation: the causes are aggregated in the cluster's stats, exported
+  // to the /tensorflow/core/xla_recompilations metric and reported in the next
+  // XlaJitCompilationActivity.
+  void RegisterCompilationSignature(
+      const NameAttrList& function,
+      const DeviceCompilationClusterSignature& signature);
+
+  // Registers the completion of an asynchronous compilation of a cluster that
+  // waited `queue_time_us` for a compiler thread and whose executable became
+  // available `time_to_switch_us` after the compilation was queued. Called in
+  // addition to `RegisterCompilation`.
+  void RegisterAsyncCompilation(const NameAttrList& function,
+                                int64_t queue_time_us,
+                                int64_t time_to_switch_us);
+
   void IncrementOngoingAsyncCompilations();
   void DecrementOngoingAsyncCompilations();
   int64_t GetNumOngoingAsyncCompilations() const;
@@ -90,6 +138,10 @@ class DeviceCompilationProfiler : public ResourceBase {
   absl::flat_hash_map<std::string, ClusterCompileStats> cluster_compile_stats_
       TF_GUARDED_BY(mu_);
 
+  // Maps cluster names to the signature of their last compilation.
+  absl::flat_hash_map<std::string, DeviceCompilationClusterSignature>
+      last_signatures_ TF_GUARDED_BY(mu_);
+
   int64_t num_ongoing_compilations_ TF_GUARDED_BY(mu_) = 0;
 
   DeviceCompilationProfiler(const DeviceCompilationProfiler&) = delete;
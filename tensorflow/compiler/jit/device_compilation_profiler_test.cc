@@ -42,6 +42,44 @@ TEST(DeviceCompilationProfilerTest, RegisterExecution) {
   EXPECT_EQ(stats.execution_count, 5);
 }
 
+TEST(DeviceCompilationProfilerTest, RegisterCompilationSignature) {
+  DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
+  core::ScopedUnref profiler_ref(profiler);
+
+  auto listener = std::make_unique<JitCompilationListener>();
+  auto listener_ptr = listener.get();
+  RegisterXlaActivityListener(std::move(listener));
+
+  NameAttrList function;
+  function.set_name("TestFunc");
+  std::vector<XlaCompiler::Argument> args(1);
+  args[0].kind = XlaCompiler::Argument::kParameter;
+  args[0].type = DT_FLOAT;
+  for (int64_t batch_size : {1, 2, 3}) {
+    args[0].shape = TensorShape({batch_size, 8});
+    TF_ASSERT_OK_AND_ASSIGN(
+        auto signature,
+        DeviceCompilationClusterSignature::Build(function, args));
+    profiler->RegisterCompilationSignature(function, signature);
+    EXPECT_TRUE(profiler->RegisterCompilation(function, 4, false).ok());
+  }
+
+  TF_ASSERT_OK_AND_ASSIGN(auto stats, profiler->GetCompileStats(function));
+  EXPECT_EQ(stats.compile_count, 3);
+  EXPECT_THAT(
+      stats.recompilation_causes,
+      ::testing::UnorderedElementsAre(::testing::Pair("arg 0 shape", 2)));
+  EXPECT_EQ(stats.last_recompilation_cause, "arg 0 shape: [2,8] -> [3,8]");
+
+  const auto& activities = listener_ptr->GetListenerHistory();
+  ASSERT_EQ(activities.size(), 3);
+  EXPECT_EQ(activities[0].recompilation_cause(), "");
+  EXPECT_EQ(activities[1].recompilation_cause(),
+            "arg 0 shape: [1,8] -> [2,8]");
+  EXPECT_EQ(activities[2].recompilation_cause(),
+            "arg 0 shape: [2,8] -> [3,8]");
+}
+
 TEST(DeviceCompilationProfilerTest, RegisterCompilation) {
   DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
   core::ScopedUnref profiler_ref(profiler);
@@ -71,6 +109,7 @@ TEST(DeviceCompilationProfilerTest, RegisterCompilation) {
   TF_ASSERT_OK_AND_ASSIGN(auto stats, profiler->GetCompileStats(function));
   EXPECT_EQ(stats.compile_count, 5);
   EXPECT_EQ(stats.cumulative_compile_time_us, 5 * 4);
+  EXPECT_EQ(stats.max_compile_time_us, 4);
 
   // TODO(b/255826209): Use ::testing::EqualsProto once b/135192747 is fixed.
   const auto& actual_activities = listener_ptr->GetListenerHistory();
@@ -81,6 +120,25 @@ TEST(DeviceCompilationProfilerTest, RegisterCompilation) {
   }
 }
 
+TEST(DeviceCompilationProfilerTest, RegisterAsyncCompilation) {
+  DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
+  core::ScopedUnref profiler_ref(profiler);
+
+  NameAttrList function;
+  function.set_name("TestFunc");
+
+  profiler->RegisterAsyncCompilation(function, /*queue_time_us=*/2,
+                                     /*time_to_switch_us=*/10);
+  profiler->RegisterAsyncCompilation(function, /*queue_time_us=*/3,
+                                     /*time_to_switch_us=*/6);
+
+  TF_ASSERT_OK_AND_ASSIGN(auto stats, profiler->GetCompileStats(function));
+  EXPECT_EQ(stats.async_compile_count, 2);
+  EXPECT_EQ(stats.cumulative_async_queue_time_us, 5);
+  EXPECT_EQ(stats.cumulative_time_to_switch_us, 16);
+  EXPECT_EQ(stats.max_time_to_switch_us, 10);
+}
+
 TEST(DeviceCompilationProfilerTest, OngoingAsyncCompilations) {
   DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
   core::ScopedUnref profiler_ref(profiler);
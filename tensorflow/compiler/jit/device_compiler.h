@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_DEVICE_COMPILER_H_
 #define TENSORFLOW_COMPILER_JIT_DEVICE_COMPILER_H_
 
+#include <algorithm>
+#include <functional>
 #include <memory>
 #include <numeric>
 #include <optional>
@@ -92,7 +94,9 @@ class DeviceCompiler : public ResourceBase {
   // and `out_executable`.  If `compile_mode` is `kStrict` then the compilation
   // cache always attempts the compilation on a cache miss. If compilation mode
   // is 'kAsync' compilation of the cluster happens in the background while the
-  // fallback path executes.
+  // fallback path executes. Pending asynchronous compilations are run on a
+  // bounded pool of threads, most requested signature first, and the compiled
+  // executable is used as soon as it is stored in the cache.
   //
   // The result of compilation is written to `*out_compilation_result`, which
   // must be non-null. If `out_executable` is non-null, also builds an
@@ -160,6 +164,15 @@ class DeviceCompiler : public ResourceBase {
                              OpKernelContext* ctx,
                              DeviceCompilationProfiler* profiler);
 
+  // Bumps the priority of the pending asynchronous compilation of `sig`, if
+  // any, after the fallback path was taken once more for it.
+  void RegisterAsyncCompilationHit(
+      const DeviceCompilationClusterSignature& sig);
+
+  // Runs the pending asynchronous compilation with the highest hit count. Each
+  // task scheduled on `async_compiler_threads_` runs exactly one of them.
+  void RunNextAsyncCompilation();
+
   std::unique_ptr<DeviceExecutablePersistor<ExecutableType, ClientType>>
       persistor_;
   std::unique_ptr<DeviceCompilerClient<ExecutableType, ClientType>>
@@ -169,6 +182,20 @@ class DeviceCompiler : public ResourceBase {
   // Pool of threads for asynchronous compilations.
   std::unique_ptr<thread::ThreadPool> async_compiler_threads_;
 
+  // An asynchronous compilation waiting for a thread of
+  // `async_compiler_threads_`.
+  struct PendingAsyncCompilation {
+    DeviceCompilationClusterSignature signature;
+    // The number of requests for `signature` since the compilation was queued.
+    int64_t hit_count;
+    std::function<void()> compile;
+  };
+
+  mutex pending_async_compilations_mu_;
+  // Ordered by the time the compilations were queued.
+  std::vector<PendingAsyncCompilation> pending_async_compilations_
+      TF_GUARDED_BY(pending_async_compilations_mu_);
+
   mutex cluster_mutexes_mu_;
   absl::flat_hash_map<DeviceCompilationClusterSignature, std::unique_ptr<mutex>,
                       DeviceCompilationClusterSignature::Hash>
@@ -344,6 +371,7 @@ DeviceCompiler<ExecutableType, ClientType>::CompileStrict(
   const uint64 compile_time_us = compile_end_us - compile_start_us;
 
   device_compiler_internal::LogOnceXlaCompiledFirstCluster();
+  profiler->RegisterCompilationSignature(function, sig);
   TF_RETURN_IF_ERROR(profiler->RegisterCompilation(
       function, compile_time_us, loaded_executable.has_value()));
   return cache_value;
@@ -372,9 +400,11 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileAsynchronous(
   // All values are captured by value. Make sure that all pointer values (like
   // entry) do not get freed until the lambda has finished.
   const std::string& function_name = function.name();
-  async_compiler_threads_->Schedule([=] {
+  const uint64 queued_us = Env::Default()->NowMicros();
+  auto compile = [=] {
     VLOG(2) << "Starting asynchronous compilation of cluster " << function_name
             << '.';
+    const uint64 start_us = Env::Default()->NowMicros();
     // We don't need to lock mu, but do it anyway to satisfy thread safety
     // analysis.
     mutex mu;
@@ -384,16 +414,63 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileAsynchronous(
                            cache_value, scope, ctx, profiler, &mu);
     VLOG(2) << "Finished asynchronous compililation of cluster "
             << function_name << '.';
-    profiler->DecrementOngoingAsyncCompilations();
     // Update compilation status in cache.
     if (!s.ok()) {
       cache_->Store(signature, std::nullopt, s.status(), std::nullopt,
                     std::nullopt);
+    } else {
+      // The executable was stored by CompileStrict, so the next request for
+      // the signature switches from the fallback path to it.
+      const uint64 end_us = Env::Default()->NowMicros();
+      profiler->RegisterAsyncCompilation(function, start_us - queued_us,
+                                         end_us - queued_us);
     }
-  });
+    profiler->DecrementOngoingAsyncCompilations();
+  };
+  {
+    mutex_lock lock(pending_async_compilations_mu_);
+    pending_async_compilations_.push_back(
+        {signature, /*hit_count=*/1, std::move(compile)});
+  }
+  async_compiler_threads_->Schedule([this] { RunNextAsyncCompilation(); });
   return absl::OkStatus();
 }
 
+template <typename ExecutableType, typename ClientType>
+void DeviceCompiler<ExecutableType, ClientType>::RegisterAsyncCompilationHit(
+    const DeviceCompilationClusterSignature& sig) {
+  mutex_lock lock(pending_async_compilations_mu_);
+  for (PendingAsyncCompilation& pending : pending_async_compilations_) {
+    if (pending.signature == sig) {
+      ++pending.hit_count;
+      return;
+    }
+  }
+}
+
+template <typename ExecutableType, typename ClientType>
+void DeviceCompiler<ExecutableType, ClientType>::RunNextAsyncCompilation() {
+  std::function<void()> compile;
+  {
+    mutex_lock lock(pending_async_compilations_mu_);
+    if (pending_async_compilations_.empty()) return;
+    // std::max_element returns the first of equal elements, so compilations
+    // with the same hit count run in the order they were queued.
+    auto next = std::max_element(
+        pending_async_compilations_.begin(), pending_async_compilations_.end(),
+        [](const PendingAsyncCompilation& a,
+           const PendingAsyncCompilation& b) {
+          return a.hit_count < b.hit_count;
+        });
+    VLOG(3) << "Running asynchronous compilation with " << next->hit_count
+            << " hits out of " << pending_async_compilations_.size()
+            << " pending.";
+    compile = std::move(next->compile);
+    pending_async_compilations_.erase(next);
+  }
+  compile();
+}
+
 template <typename ExecutableType, typename ClientType>
 Status DeviceCompiler<ExecutableType, ClientType>::CompileImpl(
     const XlaCompiler::CompileOptions& compile_options,
@@ -487,6 +564,7 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileImpl(
   } else if (state == DeviceCompileState::kCompiling) {
     VLOG(2) << "Ongoing asynchronous compilation for signature: "
             << human_signature;
+    RegisterAsyncCompilationHit(signature);
     return absl::OkStatus();
   } else if (state == DeviceCompileState::kCompiled) {
     VLOG(2) << "Already Compiled for signature: " << human_signature;
@@ -16,10 +16,16 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_DEVICE_EXECUTABLE_PERSISTOR_H_
 #define TENSORFLOW_COMPILER_JIT_DEVICE_EXECUTABLE_PERSISTOR_H_
 
+#include <algorithm>
+#include <cstdint>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
 #include "tensorflow/compiler/jit/xla_device_compiler_client.h"
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
@@ -28,6 +34,8 @@ limitations under the License.
 #include "xla/util.h"
 #include "tensorflow/core/framework/device.h"
 #include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
@@ -38,6 +46,12 @@ namespace tensorflow {
 // Offers a way to persist and/or load compiled `ExecutableType`s along with the
 // corresponding HLO (`CompilationResult`) to/from `persistent_cache_directory`
 // (if one was provided during construction) on disk  using `ClientType`.
+//
+// Entries are named after their key, so several processes can share a cache
+// directory: entries are published with an atomic rename and readers never see
+// partially written ones. A `remote_cache_directory` on a shared file system
+// lets a fleet of replicas compile each cluster once: it's read on a local
+// miss and entries found there are copied to the local directory.
 template <typename ExecutableType, typename ClientType>
 class DeviceExecutablePersistor {
  public:
@@ -74,6 +88,21 @@ class DeviceExecutablePersistor {
 
     // Cache is read-only if set to true.
     bool persistent_cache_directory_read_only = false;
+
+    // If non-empty, a directory shared between processes, e.g. on a blob
+    // store file system, that is read on a miss in the local directory and to
+    // which new entries are also published.
+    std::string remote_cache_directory;
+
+    // If positive, the least recently used entries of the local directory are
+    // removed once its entries take more than this many bytes.
+    int64_t max_cache_size_bytes = 0;
+
+    // If set, entries are keyed by these fingerprints of the XLA compiler
+    // flags and of the device, so that they are only loaded by compilations
+    // that would have produced the same executable.
+    uint64 compiler_flags_fingerprint = 0;
+    std::string device_fingerprint;
   };
 
   DeviceExecutablePersistor(const Config& config,
@@ -109,6 +138,9 @@ class DeviceExecutablePersistor {
   const std::string& persistent_cache_directory() const {
     return persistent_cache_directory_;
   }
+  const std::string& remote_cache_directory() const {
+    return remote_cache_directory_;
+  }
 
  private:
   // Returns a cache key proto that identifies an entry in the compilation
@@ -127,16 +159,33 @@ class DeviceExecutablePersistor {
       const ExecutableType& executable,
       DeviceCompilerClient<ExecutableType, ClientType>* compiler_client) const;
 
-  // Saves the cache entry in the file directory supplied during the
-  // construction of this class. Overwrites existing entries.
+  // Saves the cache entry in the local and remote directories supplied during
+  // the construction of this class. Overwrites existing entries.
   Status SaveSerializedEntry(const XlaSerializedCacheEntry& entry) const;
 
-  // Tries to read a cache entry given a `key` by searching the file directory
-  // supplied during the construction of this class. Returns std::nullopt if no
-  // cache entry is found.
+  // Atomically publishes the cache entry in `directory`.
+  Status SaveSerializedEntryToDirectory(const XlaSerializedCacheEntry& entry,
+                                        const std::string& directory) const;
+
+  // Tries to read a cache entry given a `key` by searching the local and then
+  // the remote directory supplied during the construction of this class.
+  // Returns std::nullopt if no cache entry is found.
   absl::StatusOr<std::optional<XlaSerializedCacheEntry>>
   TryToReadSerializedEntry(const XlaSerializedCacheKey& key) const;
 
+  // As above, but only searches `directory`.
+  absl::StatusOr<std::optional<XlaSerializedCacheEntry>>
+  TryToReadSerializedEntryFromDirectory(const XlaSerializedCacheKey& key,
+                                        const std::string& directory) const;
+
+  // Records that the local entry at `file_path` was just used, for the LRU
+  // garbage collection.
+  void MarkUsed(const std::string& file_path) const;
+
+  // Removes the least recently used entries of the local directory until they
+  // take at most `max_cache_size_bytes_`.
+  void CollectGarbage() const;
+
   // Checks if the loaded `entry` matches the expected `key` and `hlo_module`.
   Status VerifyLoadedCacheEntry(const XlaSerializedCacheKey& key,
                                 const xla::HloModuleProto& hlo_module,
@@ -145,6 +194,8 @@ class DeviceExecutablePersistor {
   std::string XlaSerializedCacheKeyToString(
       const XlaSerializedCacheKey& key) const;
   std::string GetFilePath(const XlaSerializedCacheKey& key) const;
+  std::string GetFilePath(const XlaSerializedCacheKey& key,
+                          const std::string& directory) const;
 
   const DeviceType device_type_;
   const bool disable_strict_signature_checks_;
@@ -157,6 +208,11 @@ class DeviceExecutablePersistor {
   // Cache is read-only if set to true.
   const bool persistent_cache_directory_read_only_;
 
+  const std::string remote_cache_directory_;
+  const int64_t max_cache_size_bytes_;
+  const uint64 compiler_flags_fingerprint_;
+  const std::string device_fingerprint_;
+
   DeviceExecutablePersistor(const DeviceExecutablePersistor&) = delete;
   void operator=(const DeviceExecutablePersistor&) = delete;
 };
@@ -170,7 +226,16 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::
       persistence_prefix_(config.persistence_prefix),
       persistent_cache_directory_(config.persistent_cache_directory),
       persistent_cache_directory_read_only_(
-          config.persistent_cache_directory_read_only) {}
+          config.persistent_cache_directory_read_only),
+      remote_cache_directory_(config.remote_cache_directory),
+      max_cache_size_bytes_(config.max_cache_size_bytes),
+      compiler_flags_fingerprint_(config.compiler_flags_fingerprint),
+      device_fingerprint_(config.device_fingerprint) {}
+
+namespace device_executable_persistor_internal {
+// Suffix of the files recording when the entry of the same name was last used.
+inline constexpr char kLastUseSuffix[] = ".last_use";
+}  // namespace device_executable_persistor_internal
 
 template <typename ExecutableType, typename ClientType>
 std::string DeviceExecutablePersistor<ExecutableType, ClientType>::
@@ -183,15 +248,29 @@ std::string DeviceExecutablePersistor<ExecutableType, ClientType>::
       key.device_type(),
       key.compiled_using_pjrt()
           ? absl::StrCat(kXlaSerializedCacheKeySeparator, "pjrt")
+          : "",
+      key.compiler_flags_fingerprint() != 0
+          ? absl::StrCat(kXlaSerializedCacheKeySeparator,
+                         key.compiler_flags_fingerprint())
+          : "",
+      !key.device_fingerprint().empty()
+          ? absl::StrCat(kXlaSerializedCacheKeySeparator,
+                         Fingerprint64(key.device_fingerprint()))
           : "");
 }
 
 template <typename ExecutableType, typename ClientType>
 std::string DeviceExecutablePersistor<ExecutableType, ClientType>::GetFilePath(
     const XlaSerializedCacheKey& key) const {
+  return GetFilePath(key, persistent_cache_directory_);
+}
+
+template <typename ExecutableType, typename ClientType>
+std::string DeviceExecutablePersistor<ExecutableType, ClientType>::GetFilePath(
+    const XlaSerializedCacheKey& key, const std::string& directory) const {
   const std::string file_name =
       absl::StrCat(XlaSerializedCacheKeyToString(key), ".pb");
-  return io::JoinPath(persistent_cache_directory_, file_name);
+  return io::JoinPath(directory, file_name);
 }
 
 template <typename ExecutableType, typename ClientType>
@@ -205,6 +284,8 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::BuildSerializedCacheKey(
   key.set_device_type(device_type().type_string());
   key.set_prefix(persistence_prefix());
   key.set_compiled_using_pjrt(compiled_using_pjrt);
+  key.set_compiler_flags_fingerprint(compiler_flags_fingerprint_);
+  key.set_device_fingerprint(device_fingerprint_);
   return key;
 }
 
@@ -229,17 +310,117 @@ template <typename ExecutableType, typename ClientType>
 absl::StatusOr<std::optional<XlaSerializedCacheEntry>>
 DeviceExecutablePersistor<ExecutableType, ClientType>::TryToReadSerializedEntry(
     const XlaSerializedCacheKey& key) const {
+  if (!persistent_cache_directory_.empty()) {
+    TF_ASSIGN_OR_RETURN(std::optional<XlaSerializedCacheEntry> entry,
+                        TryToReadSerializedEntryFromDirectory(
+                            key, persistent_cache_directory_));
+    if (entry.has_value()) {
+      MarkUsed(GetFilePath(key));
+      return entry;
+    }
+  }
+  if (remote_cache_directory_.empty()) {
+    return absl::StatusOr<std::optional<XlaSerializedCacheEntry>>(std::nullopt);
+  }
+
+  TF_ASSIGN_OR_RETURN(
+      std::optional<XlaSerializedCacheEntry> entry,
+      TryToReadSerializedEntryFromDirectory(key, remote_cache_directory_));
+  // Keep a local copy of entries compiled by other processes.
+  if (entry.has_value() && !persistent_cache_directory_.empty() &&
+      !persistent_cache_directory_read_only_) {
+    Status status =
+        SaveSerializedEntryToDirectory(*entry, persistent_cache_directory_);
+    if (status.ok()) {
+      CollectGarbage();
+    } else {
+      VLOG(1) << "Failed to copy remote cache entry locally: " << status;
+    }
+  }
+  return entry;
+}
+
+template <typename ExecutableType, typename ClientType>
+absl::StatusOr<std::optional<XlaSerializedCacheEntry>>
+DeviceExecutablePersistor<ExecutableType, ClientType>::
+    TryToReadSerializedEntryFromDirectory(const XlaSerializedCacheKey& key,
+                                          const std::string& directory) const {
   Env* env = Env::Default();
-  const std::string file_path = GetFilePath(key);
+  const std::string file_path = GetFilePath(key, directory);
   if (!env->FileExists(file_path).ok()) {
     return absl::StatusOr<std::optional<XlaSerializedCacheEntry>>(std::nullopt);
   }
 
   XlaSerializedCacheEntry entry;
-  TF_RETURN_IF_ERROR(ReadTextOrBinaryProto(env, file_path, &entry));
+  Status status = ReadTextOrBinaryProto(env, file_path, &entry);
+  // The entry may have been garbage collected by another process since.
+  if (absl::IsNotFound(status)) {
+    return absl::StatusOr<std::optional<XlaSerializedCacheEntry>>(std::nullopt);
+  }
+  TF_RETURN_IF_ERROR(status);
   return std::optional<XlaSerializedCacheEntry>(entry);
 }
 
+template <typename ExecutableType, typename ClientType>
+void DeviceExecutablePersistor<ExecutableType, ClientType>::MarkUsed(
+    const std::string& file_path) const {
+  if (max_cache_size_bytes_ <= 0 || persistent_cache_directory_read_only_) {
+    return;
+  }
+  WriteStringToFile(
+      Env::Default(),
+      absl::StrCat(file_path,
+                   device_executable_persistor_internal::kLastUseSuffix),
+      "")
+      .IgnoreError();
+}
+
+template <typename ExecutableType, typename ClientType>
+void DeviceExecutablePersistor<ExecutableType, ClientType>::CollectGarbage()
+    const {
+  using device_executable_persistor_internal::kLastUseSuffix;
+  if (max_cache_size_bytes_ <= 0) return;
+  Env* env = Env::Default();
+  std::vector<std::string> children;
+  if (!env->GetChildren(persistent_cache_directory_, &children).ok()) return;
+
+  struct CachedFile {
+    int64_t last_use_nsec;
+    int64_t size;
+    std::string path;
+  };
+  std::vector<CachedFile> files;
+  int64_t total_size = 0;
+  for (const std::string& child : children) {
+    if (!absl::EndsWith(child, ".pb")) continue;
+    const std::string path = io::JoinPath(persistent_cache_directory_, child);
+    FileStatistics stats;
+    if (!env->Stat(path, &stats).ok()) continue;
+    int64_t last_use_nsec = stats.mtime_nsec;
+    const std::string last_use_path = absl::StrCat(path, kLastUseSuffix);
+    if (FileStatistics last_use; env->Stat(last_use_path, &last_use).ok()) {
+      last_use_nsec = std::max(last_use_nsec, last_use.mtime_nsec);
+    }
+    files.push_back({last_use_nsec, stats.length, path});
+    total_size += stats.length;
+  }
+  if (total_size <= max_cache_size_bytes_) return;
+
+  std::sort(files.begin(), files.end(),
+            [](const CachedFile& a, const CachedFile& b) {
+              return a.last_use_nsec < b.last_use_nsec;
+            });
+  for (const CachedFile& file : files) {
+    if (total_size <= max_cache_size_bytes_) break;
+    VLOG(1) << "Removing least recently used persistent cache entry "
+            << file.path;
+    // Other processes may be collecting garbage concurrently.
+    env->DeleteFile(file.path).IgnoreError();
+    env->DeleteFile(absl::StrCat(file.path, kLastUseSuffix)).IgnoreError();
+    total_size -= file.size;
+  }
+}
+
 template <typename ExecutableType, typename ClientType>
 Status
 DeviceExecutablePersistor<ExecutableType, ClientType>::VerifyLoadedCacheEntry(
@@ -278,20 +459,34 @@ template <typename ExecutableType, typename ClientType>
 Status
 DeviceExecutablePersistor<ExecutableType, ClientType>::SaveSerializedEntry(
     const XlaSerializedCacheEntry& entry) const {
+  if (!persistent_cache_directory_.empty()) {
+    TF_RETURN_IF_ERROR(
+        SaveSerializedEntryToDirectory(entry, persistent_cache_directory_));
+    CollectGarbage();
+  }
+  if (!remote_cache_directory_.empty()) {
+    TF_RETURN_IF_ERROR(
+        SaveSerializedEntryToDirectory(entry, remote_cache_directory_));
+  }
+  return absl::OkStatus();
+}
+
+template <typename ExecutableType, typename ClientType>
+Status DeviceExecutablePersistor<ExecutableType, ClientType>::
+    SaveSerializedEntryToDirectory(const XlaSerializedCacheEntry& entry,
+                                   const std::string& directory) const {
   Env* env = Env::Default();
-  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(persistent_cache_directory_));
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(directory));
 
   // The cache on the filesystem can be read while we're writing out the proto.
   // To prevent reads of partially-written files, we write the proto to a temp
   // file, then move it into place once we're done writing.  And we warn the
   // user if these moves are not known to be atomic.
   bool has_atomic_move = false;
-  env->HasAtomicMove(persistent_cache_directory_, &has_atomic_move)
-      .IgnoreError();
+  env->HasAtomicMove(directory, &has_atomic_move).IgnoreError();
   if (!has_atomic_move) {
     LOG_EVERY_POW_2(WARNING)
-        << "Filesystem for XLA persistent cache at "
-        << persistent_cache_directory_
+        << "Filesystem for XLA persistent cache at " << directory
         << " does not support atomic moves.  Therefore the persistent cache is "
            "racy if you have multiple XLA compilations occurring "
            "simultaneously!  You have been warned. :)";
@@ -299,14 +494,14 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::SaveSerializedEntry(
 
   // Write to temp location, then when that completes, atomically move into the
   // final location.
-  std::string temp_path = io::JoinPath(
-      persistent_cache_directory_, XlaSerializedCacheKeyToString(entry.key()));
+  std::string temp_path =
+      io::JoinPath(directory, XlaSerializedCacheKeyToString(entry.key()));
   if (!env->CreateUniqueFileName(&temp_path, ".pb.tmp")) {
-    return absl::UnavailableError(absl::StrCat(
-        "Could not create a unique file inside ", persistent_cache_directory_));
+    return absl::UnavailableError(
+        absl::StrCat("Could not create a unique file inside ", directory));
   }
   TF_RETURN_IF_ERROR(WriteBinaryProto(env, temp_path, entry));
-  return env->RenameFile(temp_path, GetFilePath(entry.key()));
+  return env->RenameFile(temp_path, GetFilePath(entry.key(), directory));
 }
 
 template <typename ExecutableType, typename ClientType>
@@ -351,7 +546,7 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToLoadExecutable(
     const XlaCompiler::Options& options,
     const XlaCompiler::CompilationResult& compilation_result,
     DeviceCompilerClient<ExecutableType, ClientType>* compiler_client) const {
-  if (persistent_cache_directory_.empty()) {
+  if (persistent_cache_directory_.empty() && remote_cache_directory_.empty()) {
     return std::nullopt;
   }
 
@@ -388,7 +583,8 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToPersistExecutable(
     const XlaCompiler::CompilationResult& compilation_result,
     const ExecutableType& executable,
     DeviceCompilerClient<ExecutableType, ClientType>* client) const {
-  if (persistent_cache_directory_.empty() ||
+  if ((persistent_cache_directory_.empty() &&
+       remote_cache_directory_.empty()) ||
       persistent_cache_directory_read_only_) {
     VLOG(1) << "Not persisting executable. No `persistent_cache_directory` "
                "provided or cache is read-only.";
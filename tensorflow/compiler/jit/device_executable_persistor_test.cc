@@ -631,5 +631,93 @@ TEST_F(DeviceExecutionPersistorTest, PersistPjRtAndXlaExecutables) {
   EXPECT_EQ(entry.executable(), serialized_xla_executable_);
 }
 
+TEST_F(DeviceExecutionPersistorTest, LoadFromRemoteDirectory) {
+  const std::string remote_dir = io::JoinPath(cache_dir_, "remote");
+  const std::string local_dir = io::JoinPath(cache_dir_, "local");
+
+  // Publish an executable from a process without a local directory.
+  XlaDeviceExecutablePersistor::Config publisher_config;
+  publisher_config.persistence_prefix = "xla";
+  publisher_config.remote_cache_directory = remote_dir;
+  XlaDeviceExecutablePersistor publisher(publisher_config,
+                                         DefaultXlaOptions().device_type);
+
+  MockXlaCompilerClient mock_client;
+  EXPECT_CALL(mock_client, SerializeExecutable(_))
+      .WillOnce(Return(serialized_xla_executable_));
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, BuildSampleExecutable());
+  TF_EXPECT_OK(publisher.TryToPersistExecutable(
+      /*signature_hash=*/123, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, *executable, &mock_client));
+
+  // Load it from another process, which keeps a local copy.
+  XlaDeviceExecutablePersistor::Config config(
+      /*persistent_cache_directory=*/local_dir,
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+  config.remote_cache_directory = remote_dir;
+  XlaDeviceExecutablePersistor persistor(config,
+                                         DefaultXlaOptions().device_type);
+
+  EXPECT_CALL(mock_client, LoadExecutable(_, _, serialized_xla_executable_))
+      .WillOnce(Return(ByMove(std::move(executable))));
+  auto loaded_executable = persistor.TryToLoadExecutable(
+      /*signature_hash=*/123, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, &mock_client);
+  ASSERT_TRUE(loaded_executable.has_value());
+  TF_EXPECT_OK(loaded_executable->status());
+
+  auto key =
+      CreateCacheKey(/*signature_hash=*/123, compilation_result_add_,
+                     persistor.device_type(), persistor.persistence_prefix());
+  TF_ASSERT_OK_AND_ASSIGN(auto entry, ReadCacheEntryFromFile(key, local_dir));
+  EXPECT_EQ(entry.executable(), serialized_xla_executable_);
+}
+
+TEST_F(DeviceExecutionPersistorTest, PersistRemovesLeastRecentlyUsed) {
+  const std::string gc_dir = io::JoinPath(cache_dir_, "gc");
+  XlaDeviceExecutablePersistor::Config config(
+      /*persistent_cache_directory=*/gc_dir,
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+
+  MockXlaCompilerClient mock_client;
+  EXPECT_CALL(mock_client, SerializeExecutable(_))
+      .WillRepeatedly(Return(serialized_xla_executable_));
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, BuildSampleExecutable());
+
+  XlaDeviceExecutablePersistor unbounded_persistor(
+      config, DefaultXlaOptions().device_type);
+  TF_EXPECT_OK(unbounded_persistor.TryToPersistExecutable(
+      /*signature_hash=*/1234, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, *executable, &mock_client));
+  auto old_key = CreateCacheKey(
+      /*signature_hash=*/1234, compilation_result_add_,
+      unbounded_persistor.device_type(),
+      unbounded_persistor.persistence_prefix());
+  uint64 entry_size;
+  TF_ASSERT_OK(Env::Default()->GetFileSize(GetFilePath(old_key, gc_dir),
+                                           &entry_size));
+
+  // Make sure the second entry is more recent on file systems with coarse
+  // modification times.
+  Env::Default()->SleepForMicroseconds(1000 * 1000);
+
+  // Only one entry fits in the cache.
+  config.max_cache_size_bytes = entry_size;
+  XlaDeviceExecutablePersistor persistor(config,
+                                         DefaultXlaOptions().device_type);
+  TF_EXPECT_OK(persistor.TryToPersistExecutable(
+      /*signature_hash=*/5678, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, *executable, &mock_client));
+
+  auto new_key =
+      CreateCacheKey(/*signature_hash=*/5678, compilation_result_add_,
+                     persistor.device_type(), persistor.persistence_prefix());
+  TF_EXPECT_OK(ReadCacheEntryFromFile(new_key, gc_dir).status());
+  EXPECT_THAT(ReadCacheEntryFromFile(old_key, gc_dir).status(),
+              testing::StatusIs(error::NOT_FOUND));
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -63,6 +63,7 @@ const char* const kXlaNumResourceArgsAttr = "_XlaNumResourceArgs";
 const char* const kXlaHostTransferSequencerAttr =
     "_xla_host_transfer_sequencer";
 const char* const kXlaHasReferenceVarsAttr = "_XlaHasReferenceVars";
+const char* const kXlaDonateResourceUpdatesAttr = "_XlaDonateResourceUpdates";
 
 namespace {
 
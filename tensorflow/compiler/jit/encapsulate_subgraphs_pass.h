@@ -103,6 +103,10 @@ extern const char* const kXlaNumResourceArgsAttr;
 // Name of the attribute defining whether the cluster has reference variables.
 extern const char* const kXlaHasReferenceVarsAttr;
 
+// Name of the attribute defining whether the cluster may donate the buffers of
+// the resource variables it updates, because nothing else reads them.
+extern const char* const kXlaDonateResourceUpdatesAttr;
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_COMPILER_JIT_ENCAPSULATE_SUBGRAPHS_PASS_H_
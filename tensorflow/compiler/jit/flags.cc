@@ -155,6 +155,19 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
            &mark_for_compilation_flags->tf_xla_deterministic_cluster_names,
            "Causes the function names assigned by auto clustering to be "
            "deterministic from run to run."),
+      Flag("tf_xla_clustering_profile",
+           &mark_for_compilation_flags->tf_xla_clustering_profile,
+           "If non-empty, the path of an XlaClusteringProfile proto with the "
+           "TensorFlow time of ops and the XLA time of clusters in a prior "
+           "run. Clusters that ran faster are kept together and clusters "
+           "that ran slower than TensorFlow are declustered."),
+      Flag("tf_xla_cost_model_expected_steps",
+           &mark_for_compilation_flags->tf_xla_cost_model_expected_steps,
+           "If positive, the number of steps over which the estimated compile "
+           "time of an auto-clustering candidate is amortized. Candidates "
+           "that are not predicted to pay for their compilation over that "
+           "many steps are not compiled. Zero (the default) disables the "
+           "estimate."),
       Flag("tf_xla_persistent_cache_directory",
            &mark_for_compilation_flags->tf_xla_persistent_cache_directory,
            "If non-empty, JIT-compiled executables are saved to and loaded "
@@ -167,6 +180,17 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
       Flag("tf_xla_persistent_cache_read_only",
            &mark_for_compilation_flags->tf_xla_persistent_cache_read_only,
            "If true, the persistent cache will be read-only."),
+      Flag("tf_xla_persistent_cache_remote_directory",
+           &mark_for_compilation_flags->tf_xla_persistent_cache_remote_directory,
+           "If non-empty, a directory shared between processes (e.g. on a "
+           "blob store file system) that is read on a miss in the persistent "
+           "cache directory and to which new executables are also published. "
+           "Only used along with --tf_xla_persistent_cache_directory."),
+      Flag("tf_xla_persistent_cache_max_size_mb",
+           &mark_for_compilation_flags->tf_xla_persistent_cache_max_size_mb,
+           "If positive, the least recently used executables of the persistent "
+           "cache directory are removed once they take more than this many "
+           "megabytes. Unlimited by default."),
       Flag("tf_xla_disable_strict_signature_checks",
            &mark_for_compilation_flags->tf_xla_disable_strict_signature_checks,
            "If true, entires loaded into the XLA compile cache will not have "
@@ -222,6 +246,7 @@ void AllocateAndParseFlags() {
   build_ops_flags->tf_xla_disable_constant_folding = false;
   build_ops_flags->tf_xla_disable_full_embedding_pipelining = false;
   build_ops_flags->tf_xla_embedding_parallel_iterations = 0;
+  build_ops_flags->tf_xla_donate_resource_updates = true;
 
   mark_for_compilation_flags = new MarkForCompilationPassFlags;
   mark_for_compilation_flags->xla_auto_jit_flag.optimization_level_single_gpu =
@@ -239,7 +264,11 @@ void AllocateAndParseFlags() {
   mark_for_compilation_flags
       ->tf_xla_disable_resource_variable_safety_checks_for_debugging = false;
   mark_for_compilation_flags->tf_xla_deterministic_cluster_names = false;
+  mark_for_compilation_flags->tf_xla_clustering_profile = "";
+  mark_for_compilation_flags->tf_xla_cost_model_expected_steps = 0;
   mark_for_compilation_flags->tf_xla_persistent_cache_directory = "";
+  mark_for_compilation_flags->tf_xla_persistent_cache_remote_directory = "";
+  mark_for_compilation_flags->tf_xla_persistent_cache_max_size_mb = 0;
   mark_for_compilation_flags->tf_xla_persistent_cache_device_types = "";
   mark_for_compilation_flags->tf_xla_persistent_cache_read_only = false;
   mark_for_compilation_flags->tf_xla_disable_strict_signature_checks = false;
@@ -263,6 +292,7 @@ void AllocateAndParseFlags() {
   ops_flags = new XlaOpsCommonFlags;
   ops_flags->tf_xla_always_defer_compilation = false;
   ops_flags->tf_xla_async_compilation = false;
+  ops_flags->tf_xla_shape_buckets = "";
   ops_flags->tf_xla_use_device_api.enabled_for_xla_launch_ = true;
   ops_flags->tf_xla_use_device_api.enabled_for_compile_on_demand_ = true;
   ops_flags->tf_xla_use_device_api.enabled_for_compile_and_run_ = true;
@@ -318,6 +348,11 @@ void AllocateAndParseFlags() {
             "If >0 then use this many parallel iterations in "
             "embedding_pipelining and embedding_sequency. By default, use the "
             "parallel_iterations on the original model WhileOp."),
+       Flag("tf_xla_donate_resource_updates",
+            &build_ops_flags->tf_xla_donate_resource_updates,
+            "If true then XLA clusters update the resource variables that no "
+            "other node in the graph accesses in place, instead of writing "
+            "the new values to fresh buffers."),
 
        Flag("tf_xla_compile_on_demand", &device_flags->tf_xla_compile_on_demand,
             "Switch a device into 'on-demand' mode, where instead of "
@@ -335,6 +370,13 @@ void AllocateAndParseFlags() {
             "When lazy compilation is enabled, asynchronous compilation starts "
             "the cluster compilation in the background, and the fallback path "
             "is executed until the compilation has finished."),
+       Flag("tf_xla_shape_buckets", &ops_flags->tf_xla_shape_buckets,
+            "Pads the leading dimension of XLA cluster arguments up to a "
+            "bucket and slices the outputs back, so that clusters fed with a "
+            "dynamic batch size are compiled once per bucket. Either empty "
+            "(disabled), 'pow2' or a comma separated list of increasing "
+            "sizes. Only correct for clusters whose computation is "
+            "independent across the leading dimension."),
        Flag("tf_xla_use_device_api_for_xla_launch",
             &ops_flags->tf_xla_use_device_api.enabled_for_xla_launch_,
             "If true, uses Device API (PjRt) for single device compilation and "
@@ -93,6 +93,17 @@ struct MarkForCompilationPassFlags {
   // so that they remain stable from run to run of auto clusteing.
   bool tf_xla_deterministic_cluster_names;
 
+  // If non-empty, the path of an `XlaClusteringProfile` from a prior run that
+  // guides auto-clustering: clusters that ran faster are kept together and
+  // clusters that ran slower than TensorFlow are declustered.
+  std::string tf_xla_clustering_profile;
+
+  // If positive, the number of steps over which the compile time of an
+  // auto-clustering candidate is amortized.  Candidates whose estimated
+  // per-step saving over that many steps doesn't pay for their estimated
+  // compile time are left to run in TensorFlow.  Zero disables the estimate.
+  int64_t tf_xla_cost_model_expected_steps;
+
   // If non-empty, JIT-compiled executables are saved to and loaded from the
   // specified file system directory path.
   std::string tf_xla_persistent_cache_directory;
@@ -104,6 +115,15 @@ struct MarkForCompilationPassFlags {
 
   bool tf_xla_persistent_cache_read_only;
 
+  // If non-empty, a directory shared between processes (e.g. on a blob store
+  // file system) that is read on a miss in the persistent cache directory and
+  // to which new executables are also published.
+  std::string tf_xla_persistent_cache_remote_directory;
+
+  // If positive, the least recently used executables of the persistent cache
+  // directory are removed once they take more than this many megabytes.
+  int64_t tf_xla_persistent_cache_max_size_mb;
+
   // If true, entries loaded into the XLA compile cache will not have their
   // signatures checked strictly. This should generally not be disabled except
   // for debugging. Defaults to false.
@@ -151,6 +171,11 @@ struct XlaOpsCommonFlags {
   // If true, _XlaCompile compiles the cluster asynchronously with respect to
   // the main execution. The fallback path is taken while compilation happens.
   bool tf_xla_async_compilation;
+  // Buckets the leading dimension of cluster arguments is padded to, so that
+  // a dynamic batch size doesn't cause one compilation per batch size. Either
+  // empty (disabled), "pow2" or a comma separated list of increasing sizes.
+  // See shape_bucketing.h. Defaults to empty.
+  std::string tf_xla_shape_buckets;
 
   class PjRtForSingleDeviceCompilationRollout {
    public:
@@ -280,6 +305,10 @@ struct BuildXlaOpsPassFlags {
   // Force the WhileOps in embedding_pipelining and embedding_sequencing to use
   // this many parallel_iterations
   int tf_xla_embedding_parallel_iterations;
+
+  // If true, clusters update the resource variables that nothing else in the
+  // graph accesses in place, by donating the variable buffers to XLA.
+  bool tf_xla_donate_resource_updates;
 };
 
 // Flags for common MLIR configurations.
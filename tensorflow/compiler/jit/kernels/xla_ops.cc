@@ -35,6 +35,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/encapsulate_subgraphs_pass.h"
 #include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/pjrt_compile_util.h"
+#include "tensorflow/compiler/jit/shape_bucketing.h"
 #include "tensorflow/compiler/jit/variable_info.h"
 #include "tensorflow/compiler/jit/variable_info_util.h"
 #include "tensorflow/compiler/jit/xla_activity_listener.h"
@@ -99,18 +100,27 @@ auto* xla_launch_counter = monitoring::Counter<1>::New(
 // the initial values for the resource variables (and cannot snapshot them again
 // during execution) because otherwise we risk observing a different snapshot
 // with shapes different from what we compiled for.
+//
+// Likewise, inputs padded to a shape bucket when compiling are kept here to be
+// used instead of the inputs of the run op.
 template <typename ExecutableType, typename ClientType>
 class ExecutableClosure {
  public:
   explicit ExecutableClosure(
       ClientType* client, ExecutableType* executable,
       const XlaCompiler::CompilationResult* compilation_result,
-      ResourceVarsSnapshot resource_var_snapshots, int num_constant_args)
+      ResourceVarsSnapshot resource_var_snapshots, int num_constant_args,
+      std::optional<ShapeBucket> bucket = std::nullopt,
+      std::map<int, Tensor> padded_inputs = {},
+      bool donate_resource_updates = false)
       : client_(client),
         executable_(executable),
         compilation_result_(compilation_result),
         resource_var_snapshots_(std::move(resource_var_snapshots)),
-        num_constant_args_(num_constant_args) {}
+        num_constant_args_(num_constant_args),
+        bucket_(std::move(bucket)),
+        padded_inputs_(std::move(padded_inputs)),
+        donate_resource_updates_(donate_resource_updates) {}
 
   ExecutableClosure(ExecutableClosure&&) = default;
   ExecutableClosure& operator=(ExecutableClosure&&) = default;
@@ -123,7 +133,15 @@ class ExecutableClosure {
   const ResourceVarsSnapshot& resource_var_snapshots() const {
     return resource_var_snapshots_;
   }
+  ResourceVarsSnapshot* mutable_resource_var_snapshots() {
+    return &resource_var_snapshots_;
+  }
   int num_constant_args() const { return num_constant_args_; }
+  const std::optional<ShapeBucket>& bucket() const { return bucket_; }
+  const std::map<int, Tensor>& padded_inputs() const { return padded_inputs_; }
+  // Whether the executable was compiled to alias its resource updates with
+  // the variables, which nothing else in the step accesses.
+  bool donate_resource_updates() const { return donate_resource_updates_; }
 
  private:
   ClientType* client_;
@@ -131,6 +149,9 @@ class ExecutableClosure {
   const XlaCompiler::CompilationResult* compilation_result_;
   ResourceVarsSnapshot resource_var_snapshots_;
   int num_constant_args_;
+  std::optional<ShapeBucket> bucket_;
+  std::map<int, Tensor> padded_inputs_;
+  bool donate_resource_updates_;
 
   ExecutableClosure(const ExecutableClosure&) = delete;
   void operator=(const ExecutableClosure&) = delete;
@@ -192,6 +213,50 @@ se::Stream* GetStream(OpKernelContext* ctx) {
                                   : nullptr;
 }
 
+// Pads the leading dimension of the compiler arguments to a shape bucket if
+// --tf_xla_shape_buckets is set. Arguments of XLA devices are never padded
+// since their outputs can't be sliced.
+std::optional<ShapeBucket> MaybeBucketArguments(
+    const XlaPlatformInfo& platform_info,
+    std::vector<XlaCompiler::Argument>* args) {
+  if (platform_info.is_on_xla_device()) return std::nullopt;
+  return BucketArguments(GetShapeBucketingPolicy(), args);
+}
+
+// Returns the `inputs` padded to `bucket`, keyed by argument number.
+absl::StatusOr<std::map<int, Tensor>> PadInputsToBucket(
+    OpKernelContext* ctx, absl::Span<const Tensor* const> inputs,
+    const std::optional<ShapeBucket>& bucket) {
+  std::map<int, Tensor> padded_inputs;
+  if (!bucket.has_value()) return padded_inputs;
+  for (int arg_num : bucket->padded_args) {
+    TF_ASSIGN_OR_RETURN(
+        padded_inputs[arg_num],
+        PadToBucket(ctx, *inputs[arg_num], bucket->bucket_size));
+  }
+  return padded_inputs;
+}
+
+std::map<int, const Tensor*> PaddedInputPtrs(
+    const std::map<int, Tensor>& padded_inputs) {
+  std::map<int, const Tensor*> ptrs;
+  for (const auto& [arg_num, tensor] : padded_inputs) {
+    ptrs.emplace(arg_num, &tensor);
+  }
+  return ptrs;
+}
+
+// Returns `inputs`, which lack the first `missing_ctx_input_prefix` arguments,
+// with the padded ones replaced.
+std::vector<const Tensor*> WithPaddedInputs(
+    std::vector<const Tensor*> inputs,
+    const std::map<int, Tensor>& padded_inputs, int missing_ctx_input_prefix) {
+  for (const auto& [arg_num, tensor] : padded_inputs) {
+    inputs[arg_num - missing_ctx_input_prefix] = &tensor;
+  }
+  return inputs;
+}
+
 XlaComputationLaunchContext GetLaunchContext(
     const XlaPlatformInfo& platform_info, OpKernelContext* ctx,
     xla::LocalClient* client, se::DeviceMemoryAllocator* allocator) {
@@ -526,6 +591,8 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
     OP_REQUIRES_OK_ASYNC(ctx, status_or_xla_compiler_args.status(), done);
     xla_compiler_args = std::move(status_or_xla_compiler_args.value());
   }
+  const std::optional<ShapeBucket> bucket =
+      MaybeBucketArguments(platform_info_, &xla_compiler_args);
 
   bool use_pjrt = GetXlaOpsCommonFlags()
                       ->tf_xla_use_device_api.IsEnabledInXlaLaunchForDevice(
@@ -538,6 +605,9 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
         /*may_alias_resource_update=*/true, &compilation_result, &pjrt_client,
         &pjrt_executable);
     OP_REQUIRES_OK_ASYNC(ctx, status, done);
+    absl::StatusOr<std::map<int, Tensor>> padded_inputs =
+        PadInputsToBucket(ctx, inputs, bucket);
+    OP_REQUIRES_OK_ASYNC(ctx, padded_inputs.status(), done);
 
     VLOG(2) << "Compiled using PJRT: " << status;
     VLOG(2) << "pjrt_executable != nullptr: " << (pjrt_executable != nullptr);
@@ -546,7 +616,8 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
     VLOG(2) << "Executing using PJRT.";
 
     auto run_pjrt_cluster = [ctx, pjrt_client, pjrt_executable,
-                             compilation_result, done, inputs,
+                             compilation_result, done, inputs, bucket,
+                             padded_inputs = *std::move(padded_inputs),
                              resources = resources_]() {
       // Separate scope so that VariableInfo locks are released before done() is
       // called.
@@ -561,9 +632,12 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
                              done);
         OP_REQUIRES_OK_ASYNC(
             ctx,
-            RunPjRtExecutable(inputs, variable_infos, *compilation_result,
-                              pjrt_client, pjrt_executable, ctx),
+            RunPjRtExecutable(WithPaddedInputs(inputs, padded_inputs,
+                                               /*missing_ctx_input_prefix=*/0),
+                              variable_infos, *compilation_result, pjrt_client,
+                              pjrt_executable, ctx),
             done);
+        if (bucket.has_value()) SliceOutputsFromBucket(ctx, *bucket);
       }
       VLOG(2) << "Done executing with PJRT.";
       done();
@@ -579,10 +653,15 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
       /*may_alias_resource_update=*/true, &client, &compilation_result,
       &executable);
   OP_REQUIRES_OK_ASYNC(ctx, status, done);
+  absl::StatusOr<std::map<int, Tensor>> padded_inputs =
+      PadInputsToBucket(ctx, inputs, bucket);
+  OP_REQUIRES_OK_ASYNC(ctx, padded_inputs.status(), done);
 
   // Continuation of the execution, may be run in a different thread.
   auto run_xla_cluster = [ctx, client, executable, compilation_result, done,
-                          inputs, resources = resources_]() {
+                          inputs, bucket,
+                          padded_inputs = *std::move(padded_inputs),
+                          resources = resources_]() {
     // Separate scope so that VariableInfo locks are released before done is
     // called.
     {
@@ -610,7 +689,8 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
       absl::StatusOr<std::vector<xla::ExecutionInput>> execution_inputs =
           launch_context.PopulateInputs(
               ctx, compilation_result, resource_var_ptrs,
-              /*missing_ctx_input_prefix=*/0, input_output_alias);
+              /*missing_ctx_input_prefix=*/0, input_output_alias,
+              PaddedInputPtrs(padded_inputs));
       OP_REQUIRES_OK_ASYNC(ctx, execution_inputs.status(), done);
 
       xla::gpu::GpuExecutableRunOptions gpu_options;
@@ -644,6 +724,7 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
               /*missing_ctx_input_prefix=*/0, absl::MakeSpan(variable_infos),
               input_output_alias, resource_var_ptrs),
           done);
+      if (bucket.has_value()) SliceOutputsFromBucket(ctx, *bucket);
       VLOG(1) << "Done";
     }
     done();
@@ -710,6 +791,13 @@ bool HasRefVars(OpKernelConstruction* ctx) {
   return has_ref_vars;
 }
 
+bool DonateResourceUpdatesAttr(OpKernelConstruction* ctx) {
+  bool donate_resource_updates = false;
+  TryGetNodeAttr(ctx->def(), kXlaDonateResourceUpdatesAttr,
+                 &donate_resource_updates);
+  return donate_resource_updates;
+}
+
 class XlaLaunchV2Op : public XlaLocalLaunchBase {
  public:
   explicit XlaLaunchV2Op(OpKernelConstruction* ctx)
@@ -735,7 +823,8 @@ XlaCompileOp::XlaCompileOp(OpKernelConstruction* ctx)
       function_(FunctionAttr(ctx)),
       platform_info_(XlaPlatformInfoFromDevice(ctx->device())),
       must_compile_(MustCompileAttr(ctx)),
-      has_ref_vars_(HasRefVars(ctx)) {}
+      has_ref_vars_(HasRefVars(ctx)),
+      donate_resource_updates_(DonateResourceUpdatesAttr(ctx)) {}
 
 void XlaCompileOp::Compute(OpKernelContext* ctx) {
   VLOG(3) << "XlaCompileOp " << def().name()
@@ -746,6 +835,7 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
   xla::PjRtClient* pjrt_client = nullptr;
   xla::PjRtLoadedExecutable* pjrt_executable = nullptr;
   ResourceVarsSnapshot variables_snapshot;
+  std::optional<ShapeBucket> bucket;
 
   std::vector<const Tensor*> inputs = InputsFromContext(ctx);
   bool cannot_compile_cluster;
@@ -774,12 +864,15 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
     auto args_and_variables_snapshot = GetXlaCompilerArgsAndSnapshotVariables(
         resources_, constants_, inputs, ctx);
     OP_REQUIRES_OK(ctx, args_and_variables_snapshot.status());
-    const std::vector<XlaCompiler::Argument>& args =
+    std::vector<XlaCompiler::Argument>& args =
         args_and_variables_snapshot->first;
     variables_snapshot = std::move(args_and_variables_snapshot->second);
+    bucket = MaybeBucketArguments(platform_info_, &args);
 
     // Do not alias resource updates as locking variables in XlaCompile and
-    // unlocking them in XlaRun may lead to deadlocks.
+    // unlocking them in XlaRun may lead to deadlocks, unless nothing else
+    // accesses the variables: XlaRun then locks them itself and donates their
+    // buffers.
     Status status;
     if (use_pjrt) {
       VLOG(2) << "Using PJRT for compilation. Function name: "
@@ -791,7 +884,7 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
     } else {
       status = CompileToLocalExecutable(
           ctx, function_, has_ref_vars_, platform_info_, args, compile_mode,
-          /*may_alias_resource_update=*/false, &client, &kernel, &executable);
+          donate_resource_updates_, &client, &kernel, &executable);
     }
     if (compile_mode != DeviceCompileMode::kLazy ||
         status.code() != error::UNIMPLEMENTED) {
@@ -828,6 +921,10 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
     return;
   }
 
+  absl::StatusOr<std::map<int, Tensor>> padded_inputs =
+      PadInputsToBucket(ctx, inputs, bucket);
+  OP_REQUIRES_OK(ctx, padded_inputs.status());
+
   // Each execution of an XlaCompile op creates a new ExecutableClosure, even
   // if it didn't have to compile the cluster because of a compilation-cache
   // hit.  This is because we at least need new snapshots of the resource
@@ -837,14 +934,15 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
     PjRtExecutableClosureStore::KeyT key =
         PjRtExecutableClosureStore::Global()->Produce(PjRtExecutableClosure(
             pjrt_client, pjrt_executable, kernel, std::move(variables_snapshot),
-            constants_.size()));
+            constants_.size(), bucket, *std::move(padded_inputs)));
     compilation_key.flat<tstring>()(0) = key;
     VLOG(2) << "Compiled with PJRT. compilation_key: " << key;
   } else {
     XlaExecutableClosureStore::KeyT key =
         XlaExecutableClosureStore::Global()->Produce(XlaExecutableClosure(
             client, executable, kernel, std::move(variables_snapshot),
-            constants_.size()));
+            constants_.size(), bucket, *std::move(padded_inputs),
+            donate_resource_updates_));
     compilation_key.flat<tstring>()(0) = key;
     VLOG(2) << "Compiled with XLA. compilation_key: " << key;
   }
@@ -894,10 +992,16 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
       OP_REQUIRES_OK(ctx, updated_variables.status());
       OP_REQUIRES_OK(ctx, LockVariables(absl::MakeSpan(*updated_variables)));
       OP_REQUIRES_OK(
-          ctx, RunPjRtExecutable(closure.num_constant_args(), inputs,
-                                 variable_snapshots, *updated_variables,
-                                 *closure.compilation_result(),
-                                 closure.client(), closure.executable(), ctx));
+          ctx, RunPjRtExecutable(
+                   closure.num_constant_args(),
+                   WithPaddedInputs(inputs, closure.padded_inputs(),
+                                    closure.num_constant_args()),
+                   variable_snapshots, *updated_variables,
+                   *closure.compilation_result(), closure.client(),
+                   closure.executable(), ctx));
+      if (closure.bucket().has_value()) {
+        SliceOutputsFromBucket(ctx, *closure.bucket());
+      }
     }
 
     OP_REQUIRES_OK(ctx, absl::OkStatus());
@@ -920,6 +1024,7 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
       closure.executable()->executable()->module().input_output_alias_config();
   absl::StatusOr<std::vector<xla::ExecutionInput>> execution_inputs;
   std::map<int, const Tensor*> snapshot_ptrs;
+  std::vector<VariableInfo> variable_infos;
   {
     tensorflow::profiler::TraceMe hlo_module_activity(
         [&] {
@@ -929,6 +1034,33 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
         },
         tensorflow::profiler::TraceMeLevel::kInfo);
 
+    if (closure.donate_resource_updates()) {
+      // Lock the updated variables for the whole execution and pass them in
+      // place of their snapshots, so that PopulateInputs can donate the
+      // buffers of the ones nothing else holds.
+      absl::StatusOr<std::vector<VariableInfo>> updated_variables =
+          GatherVariableInfo(ctx, *closure.compilation_result(),
+                             closure.num_constant_args());
+      OP_REQUIRES_OK(ctx, updated_variables.status());
+      variable_infos = *std::move(updated_variables);
+      OP_REQUIRES_OK(ctx, LockVariables(absl::MakeSpan(variable_infos)));
+      ResourceVarsSnapshot* snapshots =
+          closure.mutable_resource_var_snapshots();
+      for (const VariableInfo& variable : variable_infos) {
+        const int arg_num = variable.index() + closure.num_constant_args();
+        const Tensor* tensor = variable.var()->tensor();
+        auto it = snapshots->find(arg_num);
+        // The executable was compiled for the dtype and shape of the snapshot.
+        if (it == snapshots->end() || !it->second.has_value() ||
+            it->second->dtype() != tensor->dtype() ||
+            it->second->shape() != tensor->shape()) {
+          continue;
+        }
+        snapshots->erase(it);
+        snapshot_ptrs.emplace(arg_num, tensor);
+      }
+    }
+
     for (const auto& [variable_index, variable_tensor] :
          closure.resource_var_snapshots()) {
       snapshot_ptrs.emplace(variable_index, variable_tensor.has_value()
@@ -938,7 +1070,7 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
     execution_inputs = launch_context.PopulateInputs(
         ctx, closure.compilation_result(), snapshot_ptrs,
         /*missing_ctx_input_prefix=*/closure.num_constant_args(),
-        input_output_alias);
+        input_output_alias, PaddedInputPtrs(closure.padded_inputs()));
     OP_REQUIRES_OK(ctx, execution_inputs.status());
   }
 
@@ -963,16 +1095,23 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
       },
       tensorflow::profiler::TraceMeLevel::kInfo);
 
-  absl::StatusOr<std::vector<VariableInfo>> variable_infos = GatherVariableInfo(
-      ctx, *closure.compilation_result(), closure.num_constant_args());
-  OP_REQUIRES_OK(ctx, variable_infos.status());
-  OP_REQUIRES_OK(ctx, LockVariables(absl::MakeSpan(*variable_infos)));
+  if (!closure.donate_resource_updates()) {
+    absl::StatusOr<std::vector<VariableInfo>> updated_variables =
+        GatherVariableInfo(ctx, *closure.compilation_result(),
+                           closure.num_constant_args());
+    OP_REQUIRES_OK(ctx, updated_variables.status());
+    variable_infos = *std::move(updated_variables);
+    OP_REQUIRES_OK(ctx, LockVariables(absl::MakeSpan(variable_infos)));
+  }
   OP_REQUIRES_OK(
       ctx,
       launch_context.PopulateOutputs(
           ctx, closure.compilation_result(), execution_output->ConsumeResult(),
           /*missing_ctx_input_prefix=*/closure.num_constant_args(),
-          absl::MakeSpan(*variable_infos), input_output_alias, snapshot_ptrs));
+          absl::MakeSpan(variable_infos), input_output_alias, snapshot_ptrs));
+  if (closure.bucket().has_value()) {
+    SliceOutputsFromBucket(ctx, *closure.bucket());
+  }
 }
 
 XlaMergeOp::XlaMergeOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
@@ -108,6 +108,10 @@ class XlaCompileOp : public OpKernel {
   // Whether the graph has TF reference variables.
   const bool has_ref_vars_;
 
+  // Whether nothing but the cluster accesses its resource variables, so their
+  // buffers may be donated to the resource updates.
+  const bool donate_resource_updates_;
+
   // cannot_compile_cluster_ is set to true if XLA returns an Unimplemented
   // error when compiling the cluster this _XlaCompile is supposed to compile.
   // If `cannot_compile_cluster_` is true then we avoid compiling this cluster
@@ -34,6 +34,8 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_join.h"
+#include "tensorflow/compiler/jit/cluster_cost_model.h"
+#include "tensorflow/compiler/jit/clustering_profile.h"
 #include "tensorflow/compiler/jit/compilability_check_util.h"
 #include "tensorflow/compiler/jit/deadness_analysis.h"
 #include "tensorflow/compiler/jit/defs.h"
@@ -123,6 +125,15 @@ class MarkForCompilationPassImpl {
     std::atomic<int64_t>* fuel;
 
     bool dump_graphs;
+
+    // If not null, the execution profile of a prior run.  Nodes that were in
+    // the same profiled cluster, and ran faster with XLA in it, are clustered
+    // together first.
+    const ClusteringProfile* clustering_profile = nullptr;
+
+    // If positive, auto-clustered clusters that the cost model predicts not
+    // to pay for their compilation over this many steps are not compiled.
+    int64_t cost_model_expected_steps = 0;
   };
 
   MarkForCompilationPassImpl(DebugOptions debug_options, Graph* graph,
@@ -475,6 +486,8 @@ class MarkForCompilationPassImpl {
   bool cpu_global_jit_;
   const std::string cluster_name_prefix_;
   absl::flat_hash_map<const Cluster*, bool> should_compile_cluster_cache_;
+  // The cost model estimate for each cluster, if the cost model is enabled.
+  absl::flat_hash_map<const Cluster*, ClusterCostEstimate> cluster_costs_;
   jit::DeviceInfoCache device_info_cache_;
 
   bool initialized_ = false;
@@ -796,6 +809,29 @@ Status MarkForCompilationPassImpl::RunEdgeContractionLoop() {
   // To choose better maximal clusterings we make multiple iterations over the
   // graph in post-order, where each such iteration is called a "phase".
 
+  // Profile-guided phase: if we have an execution profile of a prior run,
+  // first contract the edges inside the clusters that were measured to be
+  // faster with XLA, so that the later phases don't split them.  Since this is
+  // the first phase, every cluster is made of nodes of a single profiled
+  // cluster, and the node representing it in `cycles_graph_` stands for all
+  // of them.
+  if (debug_options_.clustering_profile != nullptr) {
+    VLOG(4) << "Running profile-guided phase";
+    TF_RETURN_IF_ERROR(
+        ForEachEdgeInPostOrder([&](Cluster* from,
+                                   Cluster* to) -> absl::StatusOr<bool> {
+          Node* from_node = graph_->FindNodeId(from->cycles_graph_node_id());
+          Node* to_node = graph_->FindNodeId(to->cycles_graph_node_id());
+          if (from_node == nullptr || to_node == nullptr ||
+              !debug_options_.clustering_profile->InSameProfitableCluster(
+                  from_node->name(), to_node->name())) {
+            return false;
+          }
+
+          return TryToContractEdge(from, to);
+        }).status());
+  }
+
   // Phase 0: contract metadata operations with their producer.
 
   VLOG(4) << "Running phase 0";
@@ -970,6 +1006,18 @@ Status MarkForCompilationPassImpl::CreateClusters() {
     DumpGraphToFile("before_mark_for_compilation", *graph_, flib_def_);
   }
 
+  if (debug_options_.cost_model_expected_steps > 0) {
+    absl::flat_hash_map<const Cluster*, std::vector<const Node*>> nodes;
+    for (Node* n : compilation_candidates_) {
+      if (!declustered_nodes_.contains(n)) {
+        nodes[GetClusterForNode(n)].push_back(n);
+      }
+    }
+    for (const auto& [cluster, cluster_nodes] : nodes) {
+      cluster_costs_[cluster] = EstimateClusterCost(cluster_nodes);
+    }
+  }
+
   // Mark clusters for compilation that:
   // * are placed on a device that requires compilation (an XlaDevice),
   // * are explicitly marked for compilation (_XlaCompile=true), or
@@ -1009,6 +1057,12 @@ Status MarkForCompilationPassImpl::CreateClusters() {
 
       n->AddAttr(kXlaClusterAttr, name);
       n->AddAttr(kXlaAlreadyClustered, true);
+      auto cost = cluster_costs_.find(cluster);
+      if (cost != cluster_costs_.end()) {
+        n->AddAttr(kXlaEstimatedCompileTimeUsAttr,
+                   cost->second.compile_time_us);
+        n->AddAttr(kXlaEstimatedStepSavingUsAttr, cost->second.step_saving_us);
+      }
       VLOG(3) << "Assigning node " << n->name() << " to cluster " << name;
     }
   }
@@ -1834,6 +1888,20 @@ proper command-line flag, not via TF_XLA_FLAGS).)";
     });
   }
 
+  // Clusters that must be compiled, explicitly or because of their device,
+  // are not subject to the cost model.
+  auto cost = cluster_costs_.find(&cluster);
+  if (should_compile && cost != cluster_costs_.end() &&
+      !cluster.is_xla_compile_attr_true() &&
+      policy != XlaOpRegistry::AutoclusteringPolicy::kAlways &&
+      cost->second.SpeedupUs(debug_options_.cost_model_expected_steps) <= 0) {
+    VLOG(2) << "Not compiling cluster with "
+            << cost->second.step_saving_us << "us estimated saving per step "
+            << "and " << cost->second.compile_time_us
+            << "us estimated compile time";
+    should_compile = false;
+  }
+
   VLOG(3) << (should_compile ? "Compiling" : "Not compiling")
           << " cluster with device "
           << device_info_cache_.GetNameFor(chosen_device);
@@ -1924,6 +1992,9 @@ Status MarkForCompilationPass::Run(
   debug_options.min_cluster_size = flags->tf_xla_min_cluster_size;
   debug_options.fuel = GetPointerToFuel(flags->tf_xla_clustering_fuel);
   debug_options.dump_graphs = flags->tf_xla_clustering_debug;
+  debug_options.clustering_profile = ClusteringProfile::Get();
+  debug_options.cost_model_expected_steps =
+      flags->tf_xla_cost_model_expected_steps;
 
   return MarkForCompilation(options, debug_options);
 }
@@ -1943,6 +2014,9 @@ Status MarkForCompilationPass::RunForTest(
   debug_options.min_cluster_size = flags->tf_xla_min_cluster_size;
   debug_options.fuel = GetPointerToFuel(flags->tf_xla_clustering_fuel);
   debug_options.dump_graphs = flags->tf_xla_clustering_debug;
+  debug_options.clustering_profile = ClusteringProfile::Get();
+  debug_options.cost_model_expected_steps =
+      flags->tf_xla_cost_model_expected_steps;
 
   return MarkForCompilation(options, debug_options);
 }
@@ -39,6 +39,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/sendrecv_ops.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/compiler/jit/defs.h"
+#include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/mark_for_compilation_pass_test_helper.h"
 #include "tensorflow/compiler/jit/node_matchers.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
@@ -51,6 +52,7 @@ limitations under the License.
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/test.h"
 
@@ -142,6 +144,43 @@ TEST(XlaCompilationTest, Chains) {
   EXPECT_TRUE(clusters.find("D") == clusters.cend());
 }
 
+TEST(XlaCompilationTest, CostModelSkipsUnprofitableClusters) {
+  auto build_graph = [](std::unique_ptr<Graph>* graph) {
+    graph->reset(new Graph(OpRegistry::Global()));
+    GraphDefBuilder builder(GraphDefBuilder::kFailImmediately);
+    Node* a =
+        ops::SourceOp("UncompilableNullary", builder.opts().WithName("A"));
+    Node* b = ops::UnaryOp("Relu", a, builder.opts().WithName("B"));
+    Node* c = ops::UnaryOp("Relu", b, builder.opts().WithName("C"));
+    Node* d = ops::UnaryOp("Relu", c, builder.opts().WithName("D"));
+    ops::UnaryOp("Relu", d, builder.opts().WithName("E"));
+    TF_EXPECT_OK(GraphDefBuilderToGraph(builder, graph->get()));
+  };
+  MarkForCompilationPassFlags* flags = GetMarkForCompilationPassFlags();
+  const int64_t old_expected_steps = flags->tf_xla_cost_model_expected_steps;
+  auto restore = gtl::MakeCleanup([&] {
+    flags->tf_xla_cost_model_expected_steps = old_expected_steps;
+  });
+
+  std::unique_ptr<Graph> graph;
+  build_graph(&graph);
+  flags->tf_xla_cost_model_expected_steps = 1;
+  TF_ASSERT_OK(MarkForCompilationPassTestHelper::MarkForCompilation(&graph));
+  EXPECT_TRUE(GetClusters(*graph).empty());
+
+  build_graph(&graph);
+  flags->tf_xla_cost_model_expected_steps = 1000000000;
+  TF_ASSERT_OK(MarkForCompilationPassTestHelper::MarkForCompilation(&graph));
+  auto clusters = GetClusters(*graph);
+  EXPECT_EQ(4, clusters.size());
+  Node* b = FindNodeByName(graph.get(), "B");
+  ASSERT_NE(b, nullptr);
+  int64_t step_saving_us;
+  ASSERT_TRUE(TryGetNodeAttr(b->attrs(), kXlaEstimatedStepSavingUsAttr,
+                             &step_saving_us));
+  EXPECT_GT(step_saving_us, 0);
+}
+
 TEST(XlaCompilationTest, UncompilableCycles) {
   std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
   {
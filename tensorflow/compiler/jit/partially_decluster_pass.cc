@@ -15,9 +15,18 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/partially_decluster_pass.h"
 
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <vector>
+
 #include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/jit/clustering_profile.h"
 #include "tensorflow/compiler/jit/device_util.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
 #include "tensorflow/compiler/tf2xla/const_analysis.h"
@@ -400,6 +409,57 @@ Status PartiallyDeclusterGraph(Graph* graph) {
   return absl::OkStatus();
 }
 }  // namespace decluster_root_shape_consumers
+
+namespace decluster_unprofitable_clusters {
+
+// Declusters the clusters that an execution profile of a prior run measured to
+// be slower with XLA than with TensorFlow.  Clusters containing nodes that
+// must be compiled are left alone.
+Status PartiallyDeclusterGraph(Graph* graph,
+                               const ClusteringProfile& clustering_profile) {
+  absl::flat_hash_map<absl::string_view, std::vector<Node*>> cluster_nodes;
+  for (Node* n : graph->op_nodes()) {
+    std::optional<absl::string_view> cluster = GetXlaClusterForNode(*n);
+    if (cluster.has_value()) {
+      cluster_nodes[*cluster].push_back(n);
+    }
+  }
+
+  std::vector<Node*> nodes_to_decluster;
+  for (const auto& [cluster, nodes] : cluster_nodes) {
+    absl::flat_hash_set<std::string> node_names;
+    for (Node* n : nodes) {
+      node_names.insert(n->name());
+    }
+    std::optional<int64_t> speedup_us =
+        clustering_profile.EstimateSpeedupUs(node_names);
+    if (!speedup_us.has_value() || *speedup_us >= 0) {
+      continue;
+    }
+
+    bool must_compile = false;
+    for (Node* n : nodes) {
+      TF_RETURN_IF_ERROR(
+          reduce_recompilation::MustCompileNode(n, &must_compile));
+      if (must_compile) break;
+    }
+    if (must_compile) {
+      continue;
+    }
+
+    VLOG(2) << "Declustering " << cluster << " because it was "
+            << -*speedup_us << "us slower with XLA in the profiled run";
+    absl::c_copy(nodes, std::back_inserter(nodes_to_decluster));
+  }
+
+  // The keys of `cluster_nodes` point into the attributes of the nodes, so
+  // only remove the nodes from their cluster once we are done with it.
+  for (Node* n : nodes_to_decluster) {
+    RemoveFromXlaCluster(n);
+  }
+  return absl::OkStatus();
+}
+}  // namespace decluster_unprofitable_clusters
 }  // namespace
 
 Status PartiallyDeclusterPass::Run(
@@ -430,6 +490,14 @@ Status PartiallyDeclusterPass::Run(
   TF_RETURN_IF_ERROR(
       decluster_root_shape_consumers::PartiallyDeclusterGraph(graph));
 
+  const ClusteringProfile* clustering_profile =
+      clustering_profile_ != nullptr ? clustering_profile_
+                                     : ClusteringProfile::Get();
+  if (clustering_profile != nullptr) {
+    TF_RETURN_IF_ERROR(decluster_unprofitable_clusters::PartiallyDeclusterGraph(
+        graph, *clustering_profile));
+  }
+
   return absl::OkStatus();
 }
 }  // namespace tensorflow
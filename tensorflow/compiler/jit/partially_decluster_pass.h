@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_PARTIALLY_DECLUSTER_PASS_H_
 #define TENSORFLOW_COMPILER_JIT_PARTIALLY_DECLUSTER_PASS_H_
 
+#include "tensorflow/compiler/jit/clustering_profile.h"
 #include "tensorflow/core/common_runtime/optimization_registry.h"
 
 namespace tensorflow {
@@ -25,9 +26,22 @@ namespace tensorflow {
 //
 //  - Reducing device-to-host copies.
 //  - Reducing the number of XLA recompilations.
+//
+// If an execution profile of a prior run is available (see
+// --tf_xla_clustering_profile), clusters that were measured to be slower with
+// XLA are also declustered entirely.
 class PartiallyDeclusterPass : public GraphOptimizationPass {
  public:
+  PartiallyDeclusterPass() = default;
+
+  // Uses `clustering_profile` instead of the profile set by the flag.
+  explicit PartiallyDeclusterPass(const ClusteringProfile* clustering_profile)
+      : clustering_profile_(clustering_profile) {}
+
   Status Run(const GraphOptimizationPassOptions& options) override;
+
+ private:
+  const ClusteringProfile* clustering_profile_ = nullptr;
 };
 
 }  // namespace tensorflow
@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/compiler/jit/defs.h"
 #include "tensorflow/compiler/jit/test_util.h"
+#include "tensorflow/compiler/jit/xla_activity.pb.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
 #include "tensorflow/compiler/tf2xla/cc/ops/xla_ops.h"
 #include "tensorflow/compiler/tf2xla/xla_op_kernel.h"
@@ -82,7 +83,9 @@ REGISTER_KERNEL_BUILDER(
     Name("FakeResourceUpdate").Device(DEVICE_CPU).HostMemory("something_else"),
     FakeResourceUpdateOp);
 
-Status PartiallyDecluster(std::unique_ptr<Graph>* graph) {
+Status PartiallyDecluster(
+    std::unique_ptr<Graph>* graph,
+    const ClusteringProfile* clustering_profile = nullptr) {
   FixupSourceAndSinkEdges(graph->get());
   // Assign all nodes to the CPU device.
   static const char* kCpuDevice = "/job:localhost/replica:0/task:0/cpu:0";
@@ -96,7 +99,7 @@ Status PartiallyDecluster(std::unique_ptr<Graph>* graph) {
   GraphOptimizationPassOptions opt_options =
       wrapper.CreateGraphOptimizationPassOptions(graph);
 
-  PartiallyDeclusterPass pass;
+  PartiallyDeclusterPass pass(clustering_profile);
   return pass.Run(opt_options);
 }
 
@@ -557,5 +560,50 @@ TEST(PartiallyDeclusterPassTest,
   EXPECT_EQ(GetXlaClusterForNode(*n_c), "cluster_0");
 }
 
+TEST(PartiallyDeclusterPassTest, DeclusterClustersSlowerInProfile) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output input = ops::Placeholder(s.WithOpName("input"), DT_FLOAT,
+                                  ops::Placeholder::Attrs{});
+  Output fast_a = ops::Add(s.WithOpName("fast_a"), input, input);
+  Output fast_b = ops::Mul(s.WithOpName("fast_b"), fast_a, fast_a);
+  Output slow_a = ops::Add(s.WithOpName("slow_a"), input, input);
+  Output slow_b = ops::Mul(s.WithOpName("slow_b"), slow_a, slow_a);
+
+  AddToCluster({fast_a.node(), fast_b.node()}, "cluster_0");
+  AddToCluster({slow_a.node(), slow_b.node()}, "cluster_1");
+
+  auto graph = std::make_unique<Graph>(OpRegistry::Global());
+  TF_ASSERT_OK(s.ToGraph(graph.get()));
+
+  XlaClusteringProfile profile;
+  for (const char* name : {"fast_a", "fast_b", "slow_a", "slow_b"}) {
+    XlaClusteringProfile::NodeProfile* node = profile.add_nodes();
+    node->set_name(name);
+    node->set_tf_time_us(10);
+  }
+  XlaClusteringProfile::ClusterProfile* fast = profile.add_clusters();
+  fast->add_nodes("fast_a");
+  fast->add_nodes("fast_b");
+  fast->set_xla_time_us(5);
+  XlaClusteringProfile::ClusterProfile* slow = profile.add_clusters();
+  slow->add_nodes("slow_a");
+  slow->add_nodes("slow_b");
+  slow->set_xla_time_us(50);
+  ClusteringProfile clustering_profile(profile);
+
+  TF_ASSERT_OK(PartiallyDecluster(&graph, &clustering_profile));
+
+  for (const char* name : {"fast_a", "fast_b"}) {
+    Node* n = FindNodeByName(*graph, name);
+    ASSERT_NE(n, nullptr);
+    EXPECT_EQ(GetXlaClusterForNode(*n), "cluster_0");
+  }
+  for (const char* name : {"slow_a", "slow_b"}) {
+    Node* n = FindNodeByName(*graph, name);
+    ASSERT_NE(n, nullptr);
+    EXPECT_EQ(GetXlaClusterForNode(*n), std::nullopt);
+  }
+}
+
 }  // namespace
 }  // namespace tensorflow
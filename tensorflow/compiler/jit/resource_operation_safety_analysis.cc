@@ -80,6 +80,8 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/resource_operation_safety_analysis.h"
 
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/str_join.h"
@@ -87,6 +89,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
 #include "tensorflow/compiler/tf2xla/resource_operation_table.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/tensor_id.h"
 #include "tensorflow/core/lib/hash/hash.h"
@@ -316,4 +319,48 @@ Status ComputeIncompatibleResourceOperationPairs(
 
   return absl::OkStatus();
 }
+
+absl::flat_hash_set<int> ComputeExclusiveResourceInputs(const Graph& g,
+                                                        const Node& n) {
+  // Count the VarHandleOps naming each variable, and give up if a resource
+  // handle may come from anywhere else.
+  absl::flat_hash_map<std::pair<string, string>, int> num_handles;
+  auto variable_name = [](const Node& handle) {
+    string shared_name = GetNodeAttrString(handle.attrs(), "shared_name");
+    if (shared_name.empty()) shared_name = handle.name();
+    return std::make_pair(GetNodeAttrString(handle.attrs(), "container"),
+                          shared_name);
+  };
+  for (const Node* node : g.op_nodes()) {
+    if (node->type_string() == "VarHandleOp") {
+      ++num_handles[variable_name(*node)];
+      continue;
+    }
+    if (node->num_inputs() == 0 &&
+        absl::c_linear_search(node->output_types(), DT_RESOURCE)) {
+      return {};
+    }
+  }
+
+  absl::flat_hash_set<int> result;
+  for (const Edge* e : n.in_edges()) {
+    if (e->IsControlEdge() || n.input_type(e->dst_input()) != DT_RESOURCE) {
+      continue;
+    }
+    const Node* handle = e->src();
+    if (handle->type_string() != "VarHandleOp" ||
+        num_handles[variable_name(*handle)] != 1) {
+      continue;
+    }
+    int num_data_consumers = 0;
+    bool only_consumer = true;
+    for (const Edge* out : handle->out_edges()) {
+      if (out->IsControlEdge()) continue;
+      ++num_data_consumers;
+      only_consumer &= out->dst() == &n;
+    }
+    if (only_consumer && num_data_consumers == 1) result.insert(e->dst_input());
+  }
+  return result;
+}
 }  // namespace tensorflow
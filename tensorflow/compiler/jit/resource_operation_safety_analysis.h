@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_RESOURCE_OPERATION_SAFETY_ANALYSIS_H_
 #define TENSORFLOW_COMPILER_JIT_RESOURCE_OPERATION_SAFETY_ANALYSIS_H_
 
+#include "absl/container/flat_hash_set.h"
 #include "xla/service/graphcycles/graphcycles.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/graph/graph.h"
@@ -63,6 +64,17 @@ Status ComputeIncompatibleResourceOperationPairs(
     const Graph& g, const FunctionLibraryDefinition* flib_def,
     const std::function<Status(const Node&, bool*)>& resource_ops_to_ignore,
     std::vector<std::pair<int, int>>* result);
+
+// Returns the indices of the inputs of `n` that are resource variables no other
+// node in `g` can access: inputs produced by a VarHandleOp whose only consumer
+// is `n` and which no other VarHandleOp in `g` names.  If `n` is an XLA cluster
+// then nothing else in a step reads or writes these variables, so the cluster
+// may donate their buffers to its updates of them.
+//
+// Returns an empty set if `g` has other sources of resource handles, like
+// _Arg nodes, as these may refer to any variable.
+absl::flat_hash_set<int> ComputeExclusiveResourceInputs(const Graph& g,
+                                                        const Node& n);
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_COMPILER_JIT_RESOURCE_OPERATION_SAFETY_ANALYSIS_H_
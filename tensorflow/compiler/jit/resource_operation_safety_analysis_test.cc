@@ -514,6 +514,54 @@ TEST(ResourceOperationSafetyAnalysisTest, Loop) {
   EXPECT_EQ(incompatible_pairs[0], write_read_pair);
 }
 
+TEST(ResourceOperationSafetyAnalysisTest, ExclusiveResourceInput) {
+  Scope root = Scope::NewRootScope().ExitOnError();
+
+  Node* modify = MakeModify(root, "M");
+
+  EXPECT_THAT(ComputeExclusiveResourceInputs(*root.graph(), *modify),
+              ::testing::UnorderedElementsAre(0));
+}
+
+TEST(ResourceOperationSafetyAnalysisTest, ResourceInputWithOtherConsumer) {
+  Scope root = Scope::NewRootScope().ExitOnError();
+
+  Output var_handle =
+      ops::VarHandleOp(root.WithOpName("Var"), DT_FLOAT, TensorShape({}));
+  ops::AssignAddVariableOp modify(root.WithOpName("Increment"), var_handle,
+                                  ops::Const(root.WithOpName("One"), 1.0f));
+  ops::ReadVariableOp(root.WithOpName("Read"), var_handle, DT_FLOAT);
+
+  EXPECT_TRUE(ComputeExclusiveResourceInputs(*root.graph(),
+                                             *modify.operation.node())
+                  .empty());
+}
+
+TEST(ResourceOperationSafetyAnalysisTest, ResourceInputWithAliasedHandle) {
+  Scope root = Scope::NewRootScope().ExitOnError();
+
+  Output var_handle =
+      ops::VarHandleOp(root.WithOpName("VarA"), DT_FLOAT, TensorShape({}),
+                       ops::VarHandleOp::SharedName("v"));
+  ops::AssignAddVariableOp modify(root.WithOpName("Increment"), var_handle,
+                                  ops::Const(root.WithOpName("One"), 1.0f));
+  ops::VarHandleOp(root.WithOpName("VarB"), DT_FLOAT, TensorShape({}),
+                   ops::VarHandleOp::SharedName("v"));
+
+  EXPECT_TRUE(ComputeExclusiveResourceInputs(*root.graph(),
+                                             *modify.operation.node())
+                  .empty());
+}
+
+TEST(ResourceOperationSafetyAnalysisTest, ResourceInputWithResourceArg) {
+  Scope root = Scope::NewRootScope().ExitOnError();
+
+  Node* modify = MakeModify(root, "M");
+  ops::_Arg(root.WithOpName("arg"), DT_RESOURCE, 0);
+
+  EXPECT_TRUE(ComputeExclusiveResourceInputs(*root.graph(), *modify).empty());
+}
+
 bool IsResourceArgDef(const OpDef::ArgDef& arg_def) {
   return arg_def.type() == DT_RESOURCE;
 }
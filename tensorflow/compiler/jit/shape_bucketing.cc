@@ -0,0 +1,163 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/shape_bucketing.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/jit/flags.h"
+#include "xla/stream_executor/device_memory.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/stream_executor_no_cuda.h"
+
+namespace tensorflow {
+namespace {
+
+// Returns true if `arg` is a runtime parameter whose leading dimension can be
+// padded by appending zero bytes to its buffer.
+bool IsBucketable(const XlaArgument& arg) {
+  if (arg.kind != XlaArgument::kParameter) return false;
+  if (!DataTypeCanUseMemcpy(arg.type)) return false;
+  const TensorShape* shape = std::get_if<TensorShape>(&arg.shape);
+  return shape != nullptr && shape->dims() > 0;
+}
+
+}  // namespace
+
+absl::StatusOr<ShapeBucketingPolicy> ShapeBucketingPolicy::Parse(
+    absl::string_view spec) {
+  ShapeBucketingPolicy policy;
+  if (spec.empty()) return policy;
+  if (spec == "pow2") {
+    policy.pow2_ = true;
+    return policy;
+  }
+  for (absl::string_view bucket : absl::StrSplit(spec, ',')) {
+    int64_t size;
+    if (!absl::SimpleAtoi(bucket, &size) || size <= 0) {
+      return errors::InvalidArgument("Invalid shape bucket '", bucket,
+                                     "' in '", spec, "'.");
+    }
+    if (!policy.buckets_.empty() && size <= policy.buckets_.back()) {
+      return errors::InvalidArgument("Shape buckets must be increasing: '",
+                                     spec, "'.");
+    }
+    policy.buckets_.push_back(size);
+  }
+  return policy;
+}
+
+int64_t ShapeBucketingPolicy::Bucket(int64_t size) const {
+  if (size <= 0) return size;
+  if (pow2_) {
+    int64_t bucket = 1;
+    while (bucket < size && bucket <= (INT64_MAX >> 1)) bucket <<= 1;
+    return std::max(bucket, size);
+  }
+  auto it = std::lower_bound(buckets_.begin(), buckets_.end(), size);
+  return it == buckets_.end() ? size : *it;
+}
+
+const ShapeBucketingPolicy& GetShapeBucketingPolicy() {
+  static const ShapeBucketingPolicy* policy = [] {
+    const std::string& spec = GetXlaOpsCommonFlags()->tf_xla_shape_buckets;
+    absl::StatusOr<ShapeBucketingPolicy> parsed =
+        ShapeBucketingPolicy::Parse(spec);
+    if (!parsed.ok()) {
+      LOG(ERROR) << "Ignoring --tf_xla_shape_buckets: " << parsed.status();
+      return new ShapeBucketingPolicy();
+    }
+    return new ShapeBucketingPolicy(*std::move(parsed));
+  }();
+  return *policy;
+}
+
+std::optional<ShapeBucket> BucketArguments(const ShapeBucketingPolicy& policy,
+                                           std::vector<XlaArgument>* args) {
+  if (!policy.enabled()) return std::nullopt;
+  std::optional<ShapeBucket> bucket;
+  for (int i = 0; i < args->size(); ++i) {
+    XlaArgument& arg = (*args)[i];
+    if (!IsBucketable(arg)) continue;
+    TensorShape& shape = std::get<TensorShape>(arg.shape);
+    if (!bucket.has_value()) {
+      const int64_t size = shape.dim_size(0);
+      const int64_t bucket_size = policy.Bucket(size);
+      if (bucket_size == size) return std::nullopt;
+      bucket = ShapeBucket{size, bucket_size, {}};
+    }
+    if (shape.dim_size(0) != bucket->size) continue;
+    shape.set_dim(0, bucket->bucket_size);
+    bucket->padded_args.push_back(i);
+  }
+  return bucket;
+}
+
+absl::StatusOr<Tensor> PadToBucket(OpKernelContext* ctx, const Tensor& input,
+                                   int64_t bucket_size) {
+  TensorShape shape = input.shape();
+  shape.set_dim(0, bucket_size);
+  Tensor padded;
+  TF_RETURN_IF_ERROR(ctx->allocate_temp(input.dtype(), shape, &padded));
+
+  // Padding the leading dimension of a row-major tensor appends zeros to its
+  // buffer.
+  const uint64_t size = input.TotalBytes();
+  const uint64_t tail_size = padded.TotalBytes() - size;
+  se::Stream* stream = ctx->op_device_context() != nullptr
+                           ? ctx->op_device_context()->stream()
+                           : nullptr;
+  if (stream == nullptr) {
+    std::memcpy(padded.data(), input.data(), size);
+    std::memset(static_cast<char*>(padded.data()) + size, 0, tail_size);
+    return padded;
+  }
+  se::DeviceMemoryBase src(const_cast<void*>(input.data()), size);
+  se::DeviceMemoryBase dst(padded.data(), padded.TotalBytes());
+  se::DeviceMemoryBase tail = dst.GetByteSlice(size, tail_size);
+  if (size > 0) TF_RETURN_IF_ERROR(stream->MemcpyD2D(&dst, src, size));
+  TF_RETURN_IF_ERROR(stream->MemZero(&tail, tail_size));
+  return padded;
+}
+
+void SliceOutputsFromBucket(OpKernelContext* ctx, const ShapeBucket& bucket) {
+  for (int i = 0; i < ctx->num_outputs(); ++i) {
+    if (IsRefType(ctx->expected_output_dtype(i))) continue;
+    Tensor* output = ctx->mutable_output(i);
+    if (output == nullptr || output->dims() == 0 ||
+        output->dim_size(0) != bucket.bucket_size) {
+      continue;
+    }
+    Tensor sliced = output->Slice(0, bucket.size);
+    ctx->set_output(i, sliced);
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,90 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_SHAPE_BUCKETING_H_
+#define TENSORFLOW_COMPILER_JIT_SHAPE_BUCKETING_H_
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/tf2xla/xla_argument.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+
+namespace tensorflow {
+
+// Rounds the leading (batch) dimension of XLA cluster arguments up to a fixed
+// set of sizes, so that a cluster fed with a dynamic batch size is compiled
+// once per bucket instead of once per batch size.
+//
+// The arguments are padded with zeros up to the bucket before the launch and
+// the outputs whose leading dimension is the bucket are sliced back to the
+// batch size after it. This is only correct for clusters whose computation is
+// independent across the leading dimension, such as most inference graphs.
+class ShapeBucketingPolicy {
+ public:
+  // Returns a policy that doesn't bucket.
+  ShapeBucketingPolicy() = default;
+
+  // Parses `spec`, which is either empty (no bucketing), "pow2" (round up to
+  // the next power of two) or a comma separated list of increasing bucket
+  // sizes, e.g. "8,32,128".
+  static absl::StatusOr<ShapeBucketingPolicy> Parse(absl::string_view spec);
+
+  bool enabled() const { return pow2_ || !buckets_.empty(); }
+
+  // Returns the smallest bucket not smaller than `size`, or `size` if there is
+  // no such bucket or `size` is not positive.
+  int64_t Bucket(int64_t size) const;
+
+ private:
+  bool pow2_ = false;
+  std::vector<int64_t> buckets_;
+};
+
+// Returns the policy set by the --tf_xla_shape_buckets flag.
+const ShapeBucketingPolicy& GetShapeBucketingPolicy();
+
+// The leading dimension of a set of arguments padded to a bucket.
+struct ShapeBucket {
+  // The leading dimension of the arguments before padding.
+  int64_t size = 0;
+  int64_t bucket_size = 0;
+  // The indices of the padded arguments.
+  std::vector<int> padded_args;
+};
+
+// Pads the leading dimension of the parameters in `args` to its bucket. The
+// batch size is the leading dimension of the first parameter of rank at least
+// one; only parameters with the same leading dimension are padded. Returns
+// std::nullopt and leaves `args` untouched if there is nothing to pad.
+std::optional<ShapeBucket> BucketArguments(const ShapeBucketingPolicy& policy,
+                                           std::vector<XlaArgument>* args);
+
+// Returns a copy of `input` padded with zeros along its leading dimension to
+// `bucket_size` rows. The copy is made on the stream of `ctx`, if any.
+absl::StatusOr<Tensor> PadToBucket(OpKernelContext* ctx, const Tensor& input,
+                                   int64_t bucket_size);
+
+// Slices the outputs of `ctx` whose leading dimension is the bucket back to
+// the batch size of `bucket`.
+void SliceOutputsFromBucket(OpKernelContext* ctx, const ShapeBucket& bucket);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_SHAPE_BUCKETING_H_
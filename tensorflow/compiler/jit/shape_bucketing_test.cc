@@ -0,0 +1,100 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/shape_bucketing.h"
+
+#include <optional>
+#include <variant>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/compiler/tf2xla/xla_argument.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/statusor.h"
+
+namespace tensorflow {
+namespace {
+
+XlaArgument Parameter(const TensorShape& shape) {
+  XlaArgument arg;
+  arg.kind = XlaArgument::kParameter;
+  arg.type = DT_FLOAT;
+  arg.shape = shape;
+  return arg;
+}
+
+TEST(ShapeBucketingTest, ParseDisabled) {
+  TF_ASSERT_OK_AND_ASSIGN(auto policy, ShapeBucketingPolicy::Parse(""));
+  EXPECT_FALSE(policy.enabled());
+  EXPECT_EQ(policy.Bucket(5), 5);
+}
+
+TEST(ShapeBucketingTest, PowersOfTwo) {
+  TF_ASSERT_OK_AND_ASSIGN(auto policy, ShapeBucketingPolicy::Parse("pow2"));
+  EXPECT_TRUE(policy.enabled());
+  EXPECT_EQ(policy.Bucket(1), 1);
+  EXPECT_EQ(policy.Bucket(5), 8);
+  EXPECT_EQ(policy.Bucket(64), 64);
+  EXPECT_EQ(policy.Bucket(0), 0);
+}
+
+TEST(ShapeBucketingTest, ExplicitBuckets) {
+  TF_ASSERT_OK_AND_ASSIGN(auto policy,
+                          ShapeBucketingPolicy::Parse("8,32,128"));
+  EXPECT_EQ(policy.Bucket(3), 8);
+  EXPECT_EQ(policy.Bucket(32), 32);
+  EXPECT_EQ(policy.Bucket(33), 128);
+  // Larger than the largest bucket.
+  EXPECT_EQ(policy.Bucket(200), 200);
+}
+
+TEST(ShapeBucketingTest, ParseInvalid) {
+  EXPECT_FALSE(ShapeBucketingPolicy::Parse("8,x").ok());
+  EXPECT_FALSE(ShapeBucketingPolicy::Parse("32,8").ok());
+  EXPECT_FALSE(ShapeBucketingPolicy::Parse("0").ok());
+}
+
+TEST(ShapeBucketingTest, BucketArguments) {
+  TF_ASSERT_OK_AND_ASSIGN(auto policy, ShapeBucketingPolicy::Parse("pow2"));
+  XlaArgument constant = Parameter(TensorShape({5}));
+  constant.kind = XlaArgument::kConstant;
+  std::vector<XlaArgument> args = {constant, Parameter(TensorShape({5, 3})),
+                                   Parameter(TensorShape({5})),
+                                   Parameter(TensorShape({7, 5})),
+                                   Parameter(TensorShape({}))};
+
+  std::optional<ShapeBucket> bucket = BucketArguments(policy, &args);
+  ASSERT_TRUE(bucket.has_value());
+  EXPECT_EQ(bucket->size, 5);
+  EXPECT_EQ(bucket->bucket_size, 8);
+  EXPECT_THAT(bucket->padded_args, ::testing::ElementsAre(1, 2));
+  EXPECT_EQ(std::get<TensorShape>(args[0].shape), TensorShape({5}));
+  EXPECT_EQ(std::get<TensorShape>(args[1].shape), TensorShape({8, 3}));
+  EXPECT_EQ(std::get<TensorShape>(args[2].shape), TensorShape({8}));
+  EXPECT_EQ(std::get<TensorShape>(args[3].shape), TensorShape({7, 5}));
+  EXPECT_EQ(std::get<TensorShape>(args[4].shape), TensorShape({}));
+}
+
+TEST(ShapeBucketingTest, BucketArgumentsAlreadyInBucket) {
+  TF_ASSERT_OK_AND_ASSIGN(auto policy, ShapeBucketingPolicy::Parse("pow2"));
+  std::vector<XlaArgument> args = {Parameter(TensorShape({8, 3}))};
+  EXPECT_FALSE(BucketArguments(policy, &args).has_value());
+  EXPECT_EQ(std::get<TensorShape>(args[0].shape), TensorShape({8, 3}));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
 
+#include <cstdint>
+#include <optional>
 #include <string>
 #include <unordered_map>
 
@@ -29,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/graph/control_flow.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/strings/proto_serialization.h"
@@ -43,6 +46,8 @@ namespace tensorflow {
 const char* const kXlaClusterAttr = "_XlaCluster";
 const char* const kXlaCompileTimeConstantInputsAttr =
     "_XlaCompileTimeConstantInputs";
+const char* const kXlaEstimatedCompileTimeUsAttr = "_XlaEstimatedCompileTimeUs";
+const char* const kXlaEstimatedStepSavingUsAttr = "_XlaEstimatedStepSavingUs";
 
 namespace {
 // Returns a string describing how an edge from src to dst would
@@ -326,6 +331,10 @@ namespace {
 struct ClusterInfo {
   int size;
 
+  // The cost model estimates for the cluster, if any.
+  std::optional<int64_t> estimated_compile_time_us;
+  std::optional<int64_t> estimated_step_saving_us;
+
   // Maps op names to the number of times they appear in the cluster.
   absl::flat_hash_map<absl::string_view, int> op_histogram;
 };
@@ -351,6 +360,12 @@ void ClusterInfoToProtobuf(XlaAutoClusteringSummary::Cluster* result,
   result->set_size(info.size);
   HistogramMapToRepeatedOpAndCount(result->mutable_op_histogram(),
                                    info.op_histogram);
+  if (info.estimated_compile_time_us.has_value()) {
+    result->set_estimated_compile_time_us(*info.estimated_compile_time_us);
+  }
+  if (info.estimated_step_saving_us.has_value()) {
+    result->set_estimated_step_saving_us(*info.estimated_step_saving_us);
+  }
 }
 }  // namespace
 
@@ -367,6 +382,15 @@ XlaAutoClusteringSummary GetXlaAutoClusteringSummary(const Graph& graph) {
       ClusterInfo* info = &cluster_name_to_info[*cluster_name];
       info->size++;
       info->op_histogram[n->type_string()]++;
+      int64_t estimate;
+      if (TryGetNodeAttr(n->attrs(), kXlaEstimatedCompileTimeUsAttr,
+                         &estimate)) {
+        info->estimated_compile_time_us = estimate;
+      }
+      if (TryGetNodeAttr(n->attrs(), kXlaEstimatedStepSavingUsAttr,
+                         &estimate)) {
+        info->estimated_step_saving_us = estimate;
+      }
     } else {
       result.set_unclustered_node_count(result.unclustered_node_count() + 1);
       unclustered_op_histogram[n->type_string()]++;
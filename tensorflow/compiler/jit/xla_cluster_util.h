@@ -44,6 +44,12 @@ extern const char* const kXlaClusterAttr;
 // the inputs to the node that must be constant.
 extern const char* const kXlaCompileTimeConstantInputsAttr;
 
+// The attributes that record, on the nodes of an auto-clustered cluster, the
+// compile time and per-step saving predicted for the cluster by the cost model
+// (see --tf_xla_cost_model_expected_steps).
+extern const char* const kXlaEstimatedCompileTimeUsAttr;
+extern const char* const kXlaEstimatedStepSavingUsAttr;
+
 using OrderedNodeSet = std::set<Node*, NodeComparatorID>;
 
 // Returns true if `node` has a ref tensor input that it forwards to its output.
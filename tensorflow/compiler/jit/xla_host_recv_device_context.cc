@@ -14,6 +14,11 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/compiler/jit/xla_host_recv_device_context.h"
 
+#include <memory>
+#include <utility>
+
+#include "absl/status/statusor.h"
+#include "tensorflow/compiler/jit/xla_host_transfer_buffer_pool.h"
 #include "tensorflow/compiler/tf2xla/shape_util.h"
 #include "tensorflow/compiler/tf2xla/type_util.h"
 
@@ -22,36 +27,47 @@ namespace tensorflow {
 void XlaHostRecvDeviceContext::CopyDeviceTensorToCPU(
     const Tensor* device_tensor, StringPiece tensor_name, Device* device,
     Tensor* cpu_tensor, StatusCallback done) {
+  auto fail = [&](const Status& status) {
+    done_event_.SetError(status);
+    done(status);
+  };
   DataType dtype = EncodePrimitiveTypeAsDataType(shape_.element_type()).value();
   TensorShape tensor_shape;
   Status status = XLAShapeToTensorShape(shape_, &tensor_shape);
   if (!status.ok()) {
-    done(status);
+    fail(status);
     return;
   }
 
-  *cpu_tensor = Tensor(dtype, tensor_shape);
-
-  status = stream_->Memcpy(cpu_tensor->data(), device_memory_base_,
+  absl::StatusOr<std::unique_ptr<XlaHostTransferBufferPool::Buffer>> buffer =
+      XlaHostTransferBufferPool::Get(stream_->parent())
+          ->Acquire(device_memory_base_.size());
+  if (!buffer.ok()) {
+    fail(buffer.status());
+    return;
+  }
+  status = stream_->Memcpy((*buffer)->data(), device_memory_base_,
                            device_memory_base_.size());
   if (!status.ok()) {
-    done(status);
+    fail(status);
     return;
   }
   status = stream_->RecordEvent(&done_event_.get());
   if (!status.ok()) {
-    done(status);
-    return;
-  }
-  if (auto st = stream_->BlockHostUntilDone(); !st.ok()) {
-    done_event_.SetError(absl::InternalError(absl::StrFormat(
-        "failed to synchronize send operation with a stream: %s",
-        st.ToString())));
+    fail(status);
     return;
   }
-
   done_event_.SetStateConcrete();
-  done(absl::OkStatus());
+
+  // Hand the staging buffer to the receiver once the copy into it is done.
+  status = stream_->DoHostCallback(
+      [dtype, tensor_shape, cpu_tensor, done,
+       buffer = *std::move(buffer)]() mutable {
+        *cpu_tensor = XlaHostTransferBufferPool::MakeTensor(
+            dtype, tensor_shape, std::move(buffer));
+        done(absl::OkStatus());
+      });
+  if (!status.ok()) done(status);
 }
 
 }  // namespace tensorflow
@@ -27,7 +27,11 @@ namespace tensorflow {
 // used to transfer from device->host using Rendezvous. It transfers the
 // content of `device_memory_base` with `shape` using `stream`. Only
 // `CopyDeviceTensorToCPU` method is implemented. The `done_event` is marked as
-// Concrete once transfer is completed.
+// Concrete once the transfer is enqueued on `stream` and recorded in it, so
+// that consumers can make their own streams wait for the event instead of
+// blocking the host. The host tensor is staged in a pinned buffer of the
+// XlaHostTransferBufferPool, and is handed to the receiver without a further
+// copy once the stream reaches it.
 //
 // Example usage:
 //
@@ -14,6 +14,13 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/compiler/jit/xla_host_send_device_context.h"
 
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+
+#include "absl/status/statusor.h"
+#include "tensorflow/compiler/jit/xla_host_transfer_buffer_pool.h"
 #include "tensorflow/compiler/tf2xla/shape_util.h"
 #include "tensorflow/compiler/tf2xla/type_util.h"
 
@@ -22,26 +29,34 @@ namespace tensorflow {
 void XlaHostSendDeviceContext::CopyCPUTensorToDevice(
     const Tensor* cpu_tensor, Device* device, Tensor* device_tensor,
     StatusCallback done, bool sync_dst_compute) const {
-  auto status = stream_->Memcpy(device_memory_base_, cpu_tensor->data(),
-                                device_memory_base_->size());
-  if (!status.ok()) {
+  auto fail = [&](const Status& status) {
+    done_event_.SetError(status);
     done(status);
+  };
+  const uint64_t size = device_memory_base_->size();
+  absl::StatusOr<std::unique_ptr<XlaHostTransferBufferPool::Buffer>> buffer =
+      XlaHostTransferBufferPool::Get(stream_->parent())->Acquire(size);
+  if (!buffer.ok()) {
+    fail(buffer.status());
     return;
   }
-  status = stream_->RecordEvent(&done_event_.get());
+  std::memcpy((*buffer)->data(), cpu_tensor->data(), size);
+  auto status = stream_->Memcpy(device_memory_base_, (*buffer)->data(), size);
   if (!status.ok()) {
-    done(status);
+    fail(status);
     return;
   }
-  if (auto st = stream_->BlockHostUntilDone(); !st.ok()) {
-    done_event_.SetError(absl::InternalError(absl::StrFormat(
-        "failed to synchronize send operation with a stream: %s",
-        st.ToString())));
+  status = stream_->RecordEvent(&done_event_.get());
+  if (!status.ok()) {
+    fail(status);
     return;
   }
-
   done_event_.SetStateConcrete();
-  done(absl::OkStatus());
+
+  // `cpu_tensor` has already been copied out; the staging buffer goes back to
+  // the pool once the stream is done with it.
+  done(stream_->DoHostCallback(
+      [buffer = *std::move(buffer)]() mutable { buffer.reset(); }));
 }
 
 }  // namespace tensorflow
@@ -0,0 +1,139 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/xla_host_transfer_buffer_pool.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "absl/status/statusor.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace {
+
+// Buffers smaller than this are rounded up to it.
+constexpr int kMinSizeClass = 12;
+
+int SizeClass(uint64_t size) {
+  int size_class = kMinSizeClass;
+  while ((uint64_t{1} << size_class) < size) ++size_class;
+  return size_class;
+}
+
+int SizeClassOfAllocation(uint64_t size) {
+  int size_class = 0;
+  while ((uint64_t{1} << (size_class + 1)) <= size) ++size_class;
+  return size_class;
+}
+
+// A tensor buffer backed by a pinned buffer of the pool.
+class PinnedTensorBuffer : public TensorBuffer {
+ public:
+  PinnedTensorBuffer(std::unique_ptr<XlaHostTransferBufferPool::Buffer> buffer,
+                     size_t size)
+      : TensorBuffer(buffer->data()), buffer_(std::move(buffer)), size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("xla_host_transfer");
+  }
+  AllocatorMemoryType GetMemoryType() const override {
+    return AllocatorMemoryType::kHostPinned;
+  }
+
+ private:
+  std::unique_ptr<XlaHostTransferBufferPool::Buffer> buffer_;
+  const size_t size_;
+};
+
+}  // namespace
+
+XlaHostTransferBufferPool::Buffer::~Buffer() {
+  pool_->Release(std::move(allocation_));
+}
+
+/*static*/ XlaHostTransferBufferPool* XlaHostTransferBufferPool::Get(
+    se::StreamExecutor* executor) {
+  static mutex* mu = new mutex;
+  static auto* pools =
+      new absl::flat_hash_map<se::StreamExecutor*,
+                              std::unique_ptr<XlaHostTransferBufferPool>>;
+  mutex_lock lock(*mu);
+  std::unique_ptr<XlaHostTransferBufferPool>& pool = (*pools)[executor];
+  if (pool == nullptr) {
+    pool = std::make_unique<XlaHostTransferBufferPool>(executor);
+  }
+  return pool.get();
+}
+
+absl::StatusOr<std::unique_ptr<XlaHostTransferBufferPool::Buffer>>
+XlaHostTransferBufferPool::Acquire(uint64_t size) {
+  const int size_class = SizeClass(size);
+  {
+    mutex_lock lock(mu_);
+    auto it = free_buffers_.find(size_class);
+    if (it != free_buffers_.end() && !it->second.empty()) {
+      std::unique_ptr<se::MemoryAllocation> allocation =
+          std::move(it->second.back());
+      it->second.pop_back();
+      cached_bytes_ -= allocation->size();
+      return absl::WrapUnique(new Buffer(this, std::move(allocation)));
+    }
+  }
+  auto allocation = executor_->HostMemoryAllocate(uint64_t{1} << size_class);
+  if (!allocation.ok()) return allocation.status();
+  if (*allocation == nullptr || (*allocation)->opaque() == nullptr) {
+    return errors::ResourceExhausted("Failed to allocate ",
+                                     uint64_t{1} << size_class,
+                                     " bytes of pinned host memory.");
+  }
+  return absl::WrapUnique(new Buffer(this, *std::move(allocation)));
+}
+
+/*static*/ Tensor XlaHostTransferBufferPool::MakeTensor(
+    DataType dtype, const TensorShape& shape, std::unique_ptr<Buffer> buffer) {
+  const size_t size = shape.num_elements() * DataTypeSize(dtype);
+  DCHECK_LE(size, buffer->size());
+  return Tensor(dtype, shape,
+                core::RefCountPtr<TensorBuffer>(
+                    new PinnedTensorBuffer(std::move(buffer), size)));
+}
+
+uint64_t XlaHostTransferBufferPool::cached_bytes() const {
+  mutex_lock lock(mu_);
+  return cached_bytes_;
+}
+
+void XlaHostTransferBufferPool::Release(
+    std::unique_ptr<se::MemoryAllocation> allocation) {
+  mutex_lock lock(mu_);
+  if (cached_bytes_ + allocation->size() > max_cached_bytes_) return;
+  cached_bytes_ += allocation->size();
+  free_buffers_[SizeClassOfAllocation(allocation->size())].push_back(
+      std::move(allocation));
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,107 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_XLA_HOST_TRANSFER_BUFFER_POOL_H_
+#define TENSORFLOW_COMPILER_JIT_XLA_HOST_TRANSFER_BUFFER_POOL_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "xla/stream_executor/memory_allocation.h"
+#include "xla/stream_executor/stream_executor.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// A pool of pinned host buffers, registered with a StreamExecutor, used to
+// stage the host side of XLA host send/recv transfers.  Copies between the
+// device and pinned memory are truly asynchronous, so a transfer only has to
+// enqueue its copy and can signal completion from a stream callback instead
+// of blocking the host until the stream is done.
+//
+// Buffers are kept in power-of-two size classes and reused, up to
+// `max_cached_bytes` of free buffers.
+class XlaHostTransferBufferPool {
+ public:
+  // A pinned buffer of at least the requested size.  It is returned to the
+  // pool that allocated it when destroyed.
+  class Buffer {
+   public:
+    ~Buffer();
+
+    void* data() const { return allocation_->opaque(); }
+    uint64_t size() const { return allocation_->size(); }
+
+   private:
+    friend class XlaHostTransferBufferPool;
+
+    Buffer(XlaHostTransferBufferPool* pool,
+           std::unique_ptr<se::MemoryAllocation> allocation)
+        : pool_(pool), allocation_(std::move(allocation)) {}
+
+    XlaHostTransferBufferPool* pool_;  // Not owned.
+    std::unique_ptr<se::MemoryAllocation> allocation_;
+
+    Buffer(const Buffer&) = delete;
+    void operator=(const Buffer&) = delete;
+  };
+
+  static constexpr uint64_t kDefaultMaxCachedBytes = 256ull << 20;
+
+  explicit XlaHostTransferBufferPool(
+      se::StreamExecutor* executor,
+      uint64_t max_cached_bytes = kDefaultMaxCachedBytes)
+      : executor_(executor), max_cached_bytes_(max_cached_bytes) {}
+
+  // Returns the pool for `executor`.  The pool lives as long as the process.
+  static XlaHostTransferBufferPool* Get(se::StreamExecutor* executor);
+
+  // Returns a pinned buffer of at least `size` bytes.
+  absl::StatusOr<std::unique_ptr<Buffer>> Acquire(uint64_t size);
+
+  // Returns a host tensor of `dtype` and `shape` whose storage is `buffer`.
+  // `dtype` must be memcpy-able and `buffer` large enough for the tensor.
+  static Tensor MakeTensor(DataType dtype, const TensorShape& shape,
+                           std::unique_ptr<Buffer> buffer);
+
+  // The total size of the free buffers of the pool.
+  uint64_t cached_bytes() const;
+
+ private:
+  void Release(std::unique_ptr<se::MemoryAllocation> allocation);
+
+  se::StreamExecutor* const executor_;  // Not owned.
+  const uint64_t max_cached_bytes_;
+
+  mutable mutex mu_;
+  // The free buffers, by the log2 of their size.
+  absl::flat_hash_map<int, std::vector<std::unique_ptr<se::MemoryAllocation>>>
+      free_buffers_ TF_GUARDED_BY(mu_);
+  uint64_t cached_bytes_ TF_GUARDED_BY(mu_) = 0;
+
+  XlaHostTransferBufferPool(const XlaHostTransferBufferPool&) = delete;
+  void operator=(const XlaHostTransferBufferPool&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_XLA_HOST_TRANSFER_BUFFER_POOL_H_
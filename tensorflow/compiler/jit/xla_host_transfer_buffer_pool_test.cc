@@ -0,0 +1,85 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/xla_host_transfer_buffer_pool.h"
+
+#include <memory>
+#include <utility>
+
+#include <gtest/gtest.h>
+#include "xla/stream_executor/platform_manager.h"
+#include "xla/stream_executor/stream_executor.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tsl/lib/core/status_test_util.h"
+
+namespace tensorflow {
+namespace {
+
+se::StreamExecutor* GetHostExecutor() {
+  se::Platform* platform =
+      se::PlatformManager::PlatformWithName("Host").value();
+  return platform->ExecutorForDevice(0).value();
+}
+
+TEST(XlaHostTransferBufferPoolTest, ReusesReleasedBuffers) {
+  XlaHostTransferBufferPool pool(GetHostExecutor());
+
+  TF_ASSERT_OK_AND_ASSIGN(auto buffer, pool.Acquire(100));
+  EXPECT_GE(buffer->size(), 100);
+  void* data = buffer->data();
+  buffer.reset();
+  EXPECT_GT(pool.cached_bytes(), 0);
+
+  TF_ASSERT_OK_AND_ASSIGN(buffer, pool.Acquire(200));
+  EXPECT_EQ(buffer->data(), data);
+  EXPECT_EQ(pool.cached_bytes(), 0);
+}
+
+TEST(XlaHostTransferBufferPoolTest, DoesNotCacheBeyondLimit) {
+  XlaHostTransferBufferPool pool(GetHostExecutor(),
+                                 /*max_cached_bytes=*/1 << 16);
+
+  TF_ASSERT_OK_AND_ASSIGN(auto small, pool.Acquire(1 << 16));
+  TF_ASSERT_OK_AND_ASSIGN(auto large, pool.Acquire(1 << 20));
+  small.reset();
+  EXPECT_EQ(pool.cached_bytes(), 1 << 16);
+  large.reset();
+  EXPECT_EQ(pool.cached_bytes(), 1 << 16);
+}
+
+TEST(XlaHostTransferBufferPoolTest, MakeTensor) {
+  XlaHostTransferBufferPool pool(GetHostExecutor());
+
+  TF_ASSERT_OK_AND_ASSIGN(auto buffer, pool.Acquire(4 * sizeof(float)));
+  float* data = static_cast<float*>(buffer->data());
+  data[0] = 1.0;
+  data[1] = 2.0;
+  data[2] = 3.0;
+  data[3] = 4.0;
+  Tensor tensor = XlaHostTransferBufferPool::MakeTensor(
+      DT_FLOAT, TensorShape({2, 2}), std::move(buffer));
+
+  EXPECT_EQ(tensor.data(), data);
+  test::ExpectTensorEqual<float>(
+      tensor, test::AsTensor<float>({1.0, 2.0, 3.0, 4.0}, TensorShape({2, 2})));
+  EXPECT_EQ(pool.cached_bytes(), 0);
+  tensor = Tensor();
+  EXPECT_GT(pool.cached_bytes(), 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/xla_launch_util.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -24,6 +25,7 @@ limitations under the License.
 
 #include "absl/algorithm/container.h"
 #include "absl/cleanup/cleanup.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/types/span.h"
@@ -52,6 +54,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
@@ -86,8 +89,88 @@ absl::flat_hash_map<int, int> CreateVariableLookup(
   return variable_lookup;
 }
 
+std::shared_ptr<const XlaLaunchPlan> BuildXlaLaunchPlan(
+    const XlaCompiler::CompilationResult& compilation_result) {
+  auto plan = std::make_shared<XlaLaunchPlan>();
+  plan->parameters.reserve(compilation_result.xla_input_shapes.size());
+  for (int i = 0; i < compilation_result.xla_input_shapes.size(); ++i) {
+    const int arg_num = compilation_result.input_mapping[i];
+    // XlaCompiler records `arg_num` (instead of kernel parameters) in
+    // `resource_updates`.
+    const bool is_updated_resource = absl::c_any_of(
+        compilation_result.resource_updates,
+        [&](const XlaCompiler::ResourceUpdate& update) {
+          return update.input_index == arg_num && update.modified;
+        });
+    plan->parameters.push_back(
+        {arg_num, is_updated_resource,
+         xla::ShapeTree<xla::MaybeOwningDeviceMemory>(
+             &compilation_result.xla_input_shapes[i])});
+  }
+  plan->has_variant_output =
+      absl::c_any_of(compilation_result.outputs,
+                     [](const XlaOutputDescription& descr) {
+                       return descr.type == DT_VARIANT;
+                     });
+  return plan;
+}
+
+// Caches the launch plans of the compilation results that have been launched.
+// Compilation results are owned by the device compilers and are looked up by
+// address; the computation of a compilation result is tracked as well, so that
+// a compilation result allocated at the address of a destroyed one does not
+// get its plan.
+class XlaLaunchPlanCache {
+ public:
+  static XlaLaunchPlanCache* Global() {
+    static XlaLaunchPlanCache* cache = new XlaLaunchPlanCache();
+    return cache;
+  }
+
+  std::shared_ptr<const XlaLaunchPlan> Get(
+      const XlaCompiler::CompilationResult& compilation_result) {
+    if (compilation_result.computation == nullptr) {
+      return BuildXlaLaunchPlan(compilation_result);
+    }
+
+    mutex_lock lock(mu_);
+    auto it = plans_.find(&compilation_result);
+    if (it != plans_.end() &&
+        it->second.computation.lock() == compilation_result.computation) {
+      return it->second.plan;
+    }
+
+    if (plans_.size() >= 2 * num_plans_after_last_prune_) {
+      absl::erase_if(plans_, [](const auto& entry) {
+        return entry.second.computation.expired();
+      });
+      num_plans_after_last_prune_ = std::max<size_t>(plans_.size(), 16);
+    }
+    std::shared_ptr<const XlaLaunchPlan> plan =
+        BuildXlaLaunchPlan(compilation_result);
+    plans_[&compilation_result] = {compilation_result.computation, plan};
+    return plan;
+  }
+
+ private:
+  struct Entry {
+    std::weak_ptr<xla::XlaComputation> computation;
+    std::shared_ptr<const XlaLaunchPlan> plan;
+  };
+
+  mutex mu_;
+  absl::flat_hash_map<const XlaCompiler::CompilationResult*, Entry> plans_
+      TF_GUARDED_BY(mu_);
+  size_t num_plans_after_last_prune_ TF_GUARDED_BY(mu_) = 16;
+};
+
 }  // anonymous namespace
 
+std::shared_ptr<const XlaLaunchPlan> GetXlaLaunchPlan(
+    const XlaCompiler::CompilationResult& compilation_result) {
+  return XlaLaunchPlanCache::Global()->Get(compilation_result);
+}
+
 std::vector<const Tensor*> InputsFromContext(OpKernelContext* ctx) {
   std::vector<const Tensor*> inputs;
   inputs.reserve(ctx->num_inputs());
@@ -150,32 +233,32 @@ XlaComputationLaunchContext::PopulateInputs(
     const XlaCompiler::CompilationResult* compilation_result,
     const std::map<int, const Tensor*>& resource_vars,
     int missing_ctx_input_prefix,
-    const xla::HloInputOutputAliasConfig& input_output_alias) {
+    const xla::HloInputOutputAliasConfig& input_output_alias,
+    const std::map<int, const Tensor*>& padded_inputs) {
+  std::shared_ptr<const XlaLaunchPlan> plan =
+      GetXlaLaunchPlan(*compilation_result);
   std::vector<xla::ExecutionInput> arguments;
-  arguments.reserve(compilation_result->xla_input_shapes.size());
+  arguments.reserve(plan->parameters.size());
 
-  for (int i = 0; i < compilation_result->xla_input_shapes.size(); ++i) {
-    int arg_num = compilation_result->input_mapping[i];
+  for (int i = 0; i < plan->parameters.size(); ++i) {
+    const XlaLaunchPlan::Parameter& parameter = plan->parameters[i];
+    int arg_num = parameter.arg_num;
     CHECK_GE(arg_num, missing_ctx_input_prefix);
-    const xla::Shape& device_shape = compilation_result->xla_input_shapes[i];
-    const xla::Shape& host_shape =
-        xla::ShapeUtil::DeviceShapeToHostShape(device_shape);
 
     auto resource_var_it = resource_vars.find(arg_num);
     bool is_resource_variable = resource_var_it != resource_vars.end();
     bool is_updated_resource_variable =
-        is_resource_variable &&
-        absl::c_any_of(compilation_result->resource_updates,
-                       [&](const XlaCompiler::ResourceUpdate& update) {
-                         // XlaCompiler records `arg_num` (instead of kernel
-                         // parameters) in `resource_updates`.
-                         return update.input_index == arg_num &&
-                                update.modified;
-                       });
-
-    const Tensor* t = is_resource_variable
-                          ? resource_var_it->second
-                          : &(ctx->input(arg_num - missing_ctx_input_prefix));
+        is_resource_variable && parameter.is_updated_resource;
+
+    const Tensor* t;
+    if (is_resource_variable) {
+      t = resource_var_it->second;
+    } else if (auto it = padded_inputs.find(arg_num);
+               it != padded_inputs.end()) {
+      t = it->second;
+    } else {
+      t = &(ctx->input(arg_num - missing_ctx_input_prefix));
+    }
     CHECK(t);
     bool donate_buffer =
         t->RefCountIsOne() && is_updated_resource_variable &&
@@ -194,7 +277,7 @@ XlaComputationLaunchContext::PopulateInputs(
           ctx->op_device_context()->stream());
     }
 
-    arguments.emplace_back(device_shape, host_shape);
+    arguments.emplace_back(parameter.buffers);
     xla::ExecutionInput& execution_input = arguments.back();
     se::DeviceMemoryBase dmem = XlaTensor::DeviceMemoryFromTensor(*t);
     PopulateExecutionInputBuffer(execution_input, xla::ShapeIndex{}, dmem,
@@ -395,17 +478,17 @@ Status XlaComputationLaunchContext::PopulateOutputs(
     TF_RETURN_IF_ERROR(stream->RecordEvent(definition_event.get()));
   }
 
-  for (const XlaOutputDescription& descr : compilation_result->outputs) {
-    if (descr.type == DT_VARIANT) {
-      return errors::Unimplemented(
-          "Support for TensorList crossing the XLA/TF boundary "
-          "is not implemented");
-    }
+  if (GetXlaLaunchPlan(*compilation_result)->has_variant_output) {
+    return errors::Unimplemented(
+        "Support for TensorList crossing the XLA/TF boundary "
+        "is not implemented");
   }
 
+  // Only dynamic outputs need their shapes to be computed; the others have the
+  // shapes recorded in `compilation_result`.
   std::vector<TensorShape> output_tensor_shapes;
-  output_tensor_shapes.reserve(ctx->num_outputs());
   if (output.on_host_shape().is_dynamic()) {
+    output_tensor_shapes.reserve(ctx->num_outputs());
     const se::Platform* platform = nullptr;
     if (stream != nullptr) {
       platform = stream->parent()->platform();
@@ -430,16 +513,14 @@ Status XlaComputationLaunchContext::PopulateOutputs(
       TF_RETURN_IF_ERROR(XLAShapeToTensorShape(subshape, &shape));
       output_tensor_shapes.push_back(shape);
     }
-  } else {
-    for (int i = 0; i < ctx->num_outputs(); ++i) {
-      output_tensor_shapes.push_back(compilation_result->outputs[i].shape);
-    }
   }
 
   // Copy XLA results to the OpOutputList.
   int output_num = 0;
   for (int i = 0, end = ctx->num_outputs(); i < end; ++i) {
-    const TensorShape& shape = output_tensor_shapes[i];
+    const TensorShape& shape = output_tensor_shapes.empty()
+                                   ? compilation_result->outputs[i].shape
+                                   : output_tensor_shapes[i];
     const DataType& type = compilation_result->outputs[i].type;
     VLOG(2) << "Populating output for retval " << i << " shape "
             << shape.DebugString() << " type " << DataTypeString(type);
@@ -28,7 +28,9 @@ limitations under the License.
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
 #include "xla/client/local_client.h"
 #include "xla/pjrt/pjrt_client.h"
+#include "xla/service/maybe_owning_device_memory.h"
 #include "xla/service/shaped_buffer.h"
+#include "xla/shape_tree.h"
 #include "xla/stream_executor/device_memory_allocator.h"
 #include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -152,6 +154,35 @@ absl::StatusOr<std::vector<std::unique_ptr<xla::PjRtBuffer>>> RunPjRtExecutable(
     xla::PjRtDevice* device, xla::PjRtClient* pjrt_client,
     xla::PjRtLoadedExecutable* executable);
 
+// The parts of launching a compiled cluster that only depend on its
+// compilation result, computed once instead of on every launch.
+struct XlaLaunchPlan {
+  struct Parameter {
+    // The XlaCompiler argument number the XLA parameter is bound to.
+    int arg_num;
+
+    // True if the argument is a resource variable modified by the computation.
+    bool is_updated_resource;
+
+    // An empty buffer table for the device shape of the parameter.  It points
+    // to the shape in the compilation result instead of copying it.
+    xla::ShapeTree<xla::MaybeOwningDeviceMemory> buffers;
+  };
+
+  // One entry per XLA parameter.
+  std::vector<Parameter> parameters;
+
+  // True if an output of the computation is a DT_VARIANT, which can't cross
+  // the XLA/TF boundary.
+  bool has_variant_output = false;
+};
+
+// Returns the launch plan of `compilation_result`, building it the first time
+// `compilation_result` is launched.  `compilation_result` must outlive the
+// uses of the returned plan.
+std::shared_ptr<const XlaLaunchPlan> GetXlaLaunchPlan(
+    const XlaCompiler::CompilationResult& compilation_result);
+
 // Helper class to perform the marshalling of TensorFlow inputs and outputs to
 // ShapedBuffers suitable for passing to an XLA computation.
 class XlaComputationLaunchContext {
@@ -185,12 +216,16 @@ class XlaComputationLaunchContext {
   // missing and adjusts input indices accordingly.  All elements in kernel's
   // input_mapping must be greater than or equal to `missing_ctx_input_prefix`
   // (in other words, no inputs actually required by the kernel can be missing).
+  //
+  // `padded_inputs` maps TensorFlow argument numbers to tensors that are used
+  // instead of the corresponding inputs of `ctx`, see shape_bucketing.h.
   absl::StatusOr<std::vector<xla::ExecutionInput>> PopulateInputs(
       OpKernelContext* ctx,
       const XlaCompiler::CompilationResult* compilation_result,
       const std::map<int, const Tensor*>& resource_vars,
       int missing_ctx_input_prefix,
-      const xla::HloInputOutputAliasConfig& input_output_alias);
+      const xla::HloInputOutputAliasConfig& input_output_alias,
+      const std::map<int, const Tensor*>& padded_inputs = {});
 
   // Given the XLA output in `output`, populate all outputs of `ctx`.  Also
   // writes out the resource variable updates.
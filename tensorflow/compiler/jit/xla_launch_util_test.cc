@@ -523,6 +523,36 @@ TEST(XlaLaunchUtilTest, GetPjRtExecuteOptions) {
   EXPECT_TRUE(options.use_major_to_minor_data_layout_for_callbacks);
 }
 
+TEST(XlaLaunchUtilTest, GetXlaLaunchPlan) {
+  XlaCompiler::CompilationResult compilation_result;
+  compilation_result.computation = std::make_shared<xla::XlaComputation>();
+  compilation_result.input_mapping = {1, 2};
+  compilation_result.xla_input_shapes = {
+      xla::ShapeUtil::MakeShape(xla::F32, {2}),
+      xla::ShapeUtil::MakeShape(xla::F32, {3})};
+  XlaCompiler::ResourceUpdate update;
+  update.input_index = 2;
+  update.modified = true;
+  compilation_result.resource_updates.push_back(update);
+  XlaOutputDescription output;
+  output.type = DT_FLOAT;
+  compilation_result.outputs.push_back(output);
+
+  std::shared_ptr<const XlaLaunchPlan> plan =
+      GetXlaLaunchPlan(compilation_result);
+  ASSERT_EQ(plan->parameters.size(), 2);
+  EXPECT_EQ(plan->parameters[0].arg_num, 1);
+  EXPECT_FALSE(plan->parameters[0].is_updated_resource);
+  EXPECT_EQ(plan->parameters[1].arg_num, 2);
+  EXPECT_TRUE(plan->parameters[1].is_updated_resource);
+  EXPECT_TRUE(xla::ShapeUtil::Equal(plan->parameters[1].buffers.shape(),
+                                    compilation_result.xla_input_shapes[1]));
+  EXPECT_FALSE(plan->has_variant_output);
+
+  // The plan is built once per compilation result.
+  EXPECT_EQ(GetXlaLaunchPlan(compilation_result), plan);
+}
+
 TEST_F(PjRtExecutionUtilTest, RunPjRtExecutable) {
   XlaOpRegistry::RegisterCompilationKernels();
   TF_EXPECT_OK(NodeDefBuilder("AddV2", "AddV2")
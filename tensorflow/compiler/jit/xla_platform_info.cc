@@ -24,6 +24,7 @@ limitations under the License.
 
 #include "absl/algorithm/container.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/compiler/jit/device_executable_persistor.h"
@@ -33,6 +34,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/xla_device_compiler_client.h"
 #include "xla/client/client_library.h"
 #include "xla/client/local_client.h"
+#include "xla/debug_options_flags.h"
 #include "xla/pjrt/pjrt_client.h"
 #include "xla/service/compiler.h"
 #include "xla/stream_executor/platform_manager.h"
@@ -40,6 +42,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/tfrt/common/create_pjrt_client_util.h"
@@ -59,9 +62,48 @@ using XlaDeviceExecutablePersistor =
 using PjRtDeviceExecutablePersistor =
     DeviceExecutablePersistor<xla::PjRtLoadedExecutable, xla::PjRtClient>;
 
+// Returns a fingerprint of the device `local_client` compiles for, so that
+// executables shared through the remote persistent cache directory are only
+// loaded on the same kind of device.
+std::string DeviceFingerprint(xla::LocalClient* local_client) {
+  if (local_client == nullptr) return "";
+  const se::DeviceDescription& description =
+      local_client->backend().default_stream_executor()->GetDeviceDescription();
+  return absl::StrCat(local_client->platform()->Name(), "/", description.name(),
+                      "/", description.platform_version());
+}
+
+std::string DeviceFingerprint(xla::PjRtClient* pjrt_client) {
+  if (pjrt_client == nullptr || pjrt_client->addressable_devices().empty()) {
+    return "";
+  }
+  return absl::StrCat(pjrt_client->platform_name(), "/",
+                      pjrt_client->addressable_devices()[0]->device_kind(), "/",
+                      pjrt_client->platform_version());
+}
+
+// Sets the options of `persistor_config` that make the persistent cache
+// shareable between processes: the remote directory, the size limit and the
+// compiler flags and device fingerprints keying the cache entries.
+template <typename Config>
+void SetSharedPersistentCacheOptions(const std::string& device_fingerprint,
+                                     Config* persistor_config) {
+  const MarkForCompilationPassFlags* flags = GetMarkForCompilationPassFlags();
+  if (persistor_config->persistent_cache_directory.empty()) return;
+  persistor_config->remote_cache_directory =
+      flags->tf_xla_persistent_cache_remote_directory;
+  persistor_config->max_cache_size_bytes =
+      flags->tf_xla_persistent_cache_max_size_mb * 1024 * 1024;
+  persistor_config->compiler_flags_fingerprint =
+      DeterministicProtoHash64(xla::GetDebugOptionsFromFlags());
+  persistor_config->device_fingerprint = device_fingerprint;
+}
+
 XlaDeviceCompiler* CreateXlaDeviceCompiler(
-    const XlaDeviceExecutablePersistor::Config& persistor_config,
+    XlaDeviceExecutablePersistor::Config persistor_config,
     DeviceType compilation_device_type, xla::LocalClient* local_client) {
+  SetSharedPersistentCacheOptions(DeviceFingerprint(local_client),
+                                  &persistor_config);
   return new XlaDeviceCompiler(
       std::make_unique<XlaDeviceExecutablePersistor>(
           std::move(persistor_config), compilation_device_type),
@@ -78,6 +120,8 @@ PjRtDeviceCompiler* CreatePjRtDeviceCompiler(DeviceType compilation_device_type,
       GetMarkForCompilationPassFlags()->tf_xla_disable_strict_signature_checks,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_prefix,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_read_only);
+  SetSharedPersistentCacheOptions(DeviceFingerprint(pjrt_client),
+                                  &persistor_config);
 
   return new PjRtDeviceCompiler(
       std::make_unique<PjRtDeviceExecutablePersistor>(
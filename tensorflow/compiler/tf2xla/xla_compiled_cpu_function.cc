@@ -74,7 +74,8 @@ XlaCompiledCpuFunction::XlaCompiledCpuFunction(const StaticData& static_data,
       result_names_(static_data.result_names_),
       program_shape_(static_data.program_shape_),
       hlo_profile_printer_data_(static_data.hlo_profile_printer_data_),
-      use_xla_runtime_(static_data.use_xla_runtime_) {
+      use_xla_runtime_(static_data.use_xla_runtime_),
+      intra_op_parallelism_(static_data.intra_op_parallelism_) {
   bool allocate_entry_params =
       alloc_mode == AllocMode::ARGS_VARIABLES_RESULTS_PROFILES_AND_TEMPS;
   // Allocate arg and temp buffers.
@@ -162,6 +163,13 @@ bool XlaCompiledCpuFunction::Run() {
     return external_run_function_(cpu_executable_, descriptor_table,
                                   &run_options_);
   }
+  if (intra_op_parallelism_ > 1 &&
+      run_options_.intra_op_thread_pool() == nullptr) {
+    std::cerr << "XLA AOT error: the computation was compiled for "
+              << intra_op_parallelism_
+              << " intra-op threads but no thread pool is set.\n";
+    return false;
+  }
   XlaCustomCallStatus status;
   raw_function_(buffer_table_[result_index_], &run_options_, nullptr,
                 buffer_table_, &status, profile_counters_);
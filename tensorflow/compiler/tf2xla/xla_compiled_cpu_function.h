@@ -141,6 +141,10 @@ class XlaCompiledCpuFunction {
 
     bool use_xla_runtime_ = false;
 
+    // The number of threads the computation was compiled to partition its ops
+    // across.  Values above 1 require a thread pool to run.
+    int32_t intra_op_parallelism_ = 1;
+
     // Only XlaCompiledCpuFunction is allowed to read and write the above
     // fields.
     friend class XlaCompiledCpuFunction;
@@ -166,10 +170,16 @@ class XlaCompiledCpuFunction {
   XlaCompiledCpuFunction& operator=(const XlaCompiledCpuFunction&) = delete;
 
   // Sets the intra-op thread pool used to run individual ops concurrently.
+  // Must be set if intra_op_parallelism() is above 1.
   void set_thread_pool(const Eigen::ThreadPoolDevice* pool) {
     run_options_.set_intra_op_thread_pool(pool);
   }
 
+  // Returns the number of threads the computation was compiled to partition
+  // its ops across; see the --intra_op_parallelism flag of tfcompile.  A
+  // thread pool with this many threads gives the most parallelism.
+  int intra_op_parallelism() const { return intra_op_parallelism_; }
+
   // Runs the computation, with inputs read from arg buffers, and outputs
   // written to result buffers. Returns true on success and false on failure.
   bool Run();
@@ -433,6 +443,11 @@ class XlaCompiledCpuFunction {
     static_data->use_xla_runtime_ = use_xla_runtime;
   }
 
+  static void set_static_data_intra_op_parallelism(
+      StaticData* static_data, int32_t intra_op_parallelism) {
+    static_data->intra_op_parallelism_ = intra_op_parallelism;
+  }
+
  private:
   const RawFunction raw_function_;
 
@@ -490,6 +505,8 @@ class XlaCompiledCpuFunction {
 
   const bool use_xla_runtime_ = false;
 
+  const int32_t intra_op_parallelism_ = 1;
+
   // Creates a descriptor table for XLA Runtime.
   std::vector<xla::cpu::BufferDesc> MakeXlaRuntimeDescriptorTable();
 
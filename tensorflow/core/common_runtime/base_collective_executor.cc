@@ -18,6 +18,7 @@ limitations under the License.
 #include <functional>
 #include <utility>
 
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
 #include "tensorflow/core/common_runtime/copy_tensor.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
@@ -247,6 +248,20 @@ void BaseCollectiveExecutor::StartAbort(const Status& s) {
     status = status_;
   }
   LOG(ERROR) << "BaseCollectiveExecutor::StartAbort " << s;
+  // Reductions waiting in a bucket would otherwise never complete.
+  std::vector<StatusCallback> bucketed;
+  {
+    mutex_lock l(bucket_mu_);
+    for (auto& entry : buckets_) {
+      for (std::optional<BucketMember>& member : entry.second.members) {
+        if (member.has_value()) bucketed.push_back(std::move(member->done));
+      }
+    }
+    buckets_.clear();
+  }
+  for (StatusCallback& done : bucketed) {
+    done(status);
+  }
   cem_->GetParamResolver()->StartAbort(status);
   remote_access_->StartAbort(status);
   if (cem_->GetNcclCommunicator() != nullptr) {
@@ -302,6 +317,11 @@ void BaseCollectiveExecutor::ExecuteAsync(OpKernelContext* ctx,
         });
   }
 
+  if (IsBucketed(*col_params)) {
+    AddToBucket(ctx, col_params, exec_key, std::move(done_safe));
+    return;
+  }
+
   Tensor* output = ctx->mutable_output(0);
   const Tensor* input =
       (col_params->instance.type == REDUCTION_COLLECTIVE ||
@@ -313,10 +333,17 @@ void BaseCollectiveExecutor::ExecuteAsync(OpKernelContext* ctx,
         col_params->is_source))
           ? &ctx->input(0)
           : nullptr;
+  Launch(ctx, col_params, exec_key, input, output, std::move(done_safe));
+}
+
+void BaseCollectiveExecutor::Launch(OpKernelContext* ctx,
+                                    const CollectiveParams* col_params,
+                                    const string& exec_key, const Tensor* input,
+                                    Tensor* output, StatusCallback done) {
   CollectiveImplementationInterface* col_impl = nullptr;
   Status status = CreateCollective(*col_params, &col_impl);
   if (!status.ok()) {
-    done_safe(status);
+    done(status);
     DCHECK_EQ(nullptr, col_impl);
     return;
   }
@@ -326,14 +353,14 @@ void BaseCollectiveExecutor::ExecuteAsync(OpKernelContext* ctx,
       col_params, exec_key, step_id_, input, output);
   status = col_impl->InitializeCollectiveContext(col_ctx);
   if (!status.ok()) {
-    done_safe(status);
+    done(status);
     return;
   }
   // Run on an unbounded work queue that can handle blocking work so as to not
   // starve executor threads.
   col_impl->Ref();
   profiler::TraceMeProducer producer("BaseCollectiveExecutor::ExecuteAsync");
-  RunClosure([col_impl, col_ctx, done_safe, ctx,
+  RunClosure([col_impl, col_ctx, done = std::move(done), ctx,
               context_id = producer.GetContextId()]() {
     core::ScopedUnref unref(col_impl);
     profiler::TraceMeConsumer consumer(
@@ -351,13 +378,230 @@ void BaseCollectiveExecutor::ExecuteAsync(OpKernelContext* ctx,
         },
         context_id);
     col_impl->Ref();
-    col_impl->Run([col_impl, col_ctx, done_safe](const Status& s) {
+    col_impl->Run([col_impl, col_ctx, done](const Status& s) {
       core::ScopedUnref unref(col_impl);
-      done_safe(s);
+      done(s);
     });
   });
 }
 
+/*static*/
+bool BaseCollectiveExecutor::IsBucketed(const CollectiveParams& col_params) {
+  // Only the ring reduction runs on fused buffers: it reduces elementwise,
+  // and its subdivisions are generated again for the size of the buffer.
+  return col_params.instance.type == REDUCTION_COLLECTIVE &&
+         col_params.instance.impl_details.bucket_size > 1 &&
+         col_params.instance.impl_details.collective_name == "RingReduce";
+}
+
+void BaseCollectiveExecutor::AddToBucket(OpKernelContext* ctx,
+                                         const CollectiveParams* col_params,
+                                         const string& exec_key,
+                                         StatusCallback done) {
+  const CollImplDetails& details = col_params->instance.impl_details;
+  const int index = col_params->instance.instance_key - details.bucket_key;
+  if (index < 0 || index >= details.bucket_size) {
+    done(errors::InvalidArgument(
+        "Collective ", col_params->name, " has instance_key ",
+        col_params->instance.instance_key, " outside of its bucket [",
+        details.bucket_key, ", ", details.bucket_key + details.bucket_size,
+        ")"));
+    return;
+  }
+  const BucketId id(col_params->group.group_key, details.bucket_key,
+                    col_params->default_rank, ctx->frame_iter().frame_id,
+                    ctx->frame_iter().iter_id);
+  std::vector<std::vector<BucketMember>> launches;
+  bool conflict = false;
+  {
+    mutex_lock l(bucket_mu_);
+    Bucket& bucket = buckets_[id];
+    if (bucket.members.empty()) {
+      bucket.members.resize(details.bucket_size);
+    }
+    conflict = bucket.members.size() != details.bucket_size ||
+               bucket.members[index].has_value();
+    if (!conflict) {
+      bucket.members[index] =
+          BucketMember{ctx, col_params, exec_key, std::move(done)};
+      TakeReadyRuns(&bucket, details.bucket_bytes, &launches);
+      if (bucket.next_launch == bucket.members.size()) {
+        buckets_.erase(id);
+      }
+    }
+  }
+  if (conflict) {
+    done(errors::InvalidArgument(
+        "Collective ", col_params->name, " does not match the bucket of ",
+        "instance_key ", details.bucket_key, ", or was executed twice"));
+    return;
+  }
+  for (std::vector<BucketMember>& members : launches) {
+    LaunchFused(std::move(members));
+  }
+}
+
+/*static*/
+void BaseCollectiveExecutor::TakeReadyRuns(
+    Bucket* bucket, int64_t bucket_bytes,
+    std::vector<std::vector<BucketMember>>* launches) {
+  const int size = bucket->members.size();
+  while (bucket->next_launch < size &&
+         bucket->members[bucket->next_launch].has_value()) {
+    const CollectiveParams& first =
+        *bucket->members[bucket->next_launch]->col_params;
+    int64_t bytes = 0;
+    int end = -1;
+    for (int i = bucket->next_launch; i < size; ++i) {
+      if (!bucket->members[i].has_value()) break;
+      const CollectiveParams& member = *bucket->members[i]->col_params;
+      // A run only holds members that a single reduction can compute.
+      if (member.instance.data_type != first.instance.data_type ||
+          member.merge_op->type_string() != first.merge_op->type_string() ||
+          member.final_op->type_string() != first.final_op->type_string()) {
+        end = i;
+        break;
+      }
+      bytes += bucket->members[i]->ctx->input(0).TotalBytes();
+      if ((bucket_bytes > 0 && bytes >= bucket_bytes) || i == size - 1) {
+        end = i + 1;
+        break;
+      }
+    }
+    if (end < 0) break;
+    std::vector<BucketMember> run;
+    for (int i = bucket->next_launch; i < end; ++i) {
+      run.push_back(std::move(*bucket->members[i]));
+      bucket->members[i].reset();
+    }
+    bucket->next_launch = end;
+    launches->push_back(std::move(run));
+  }
+}
+
+void BaseCollectiveExecutor::LaunchFused(std::vector<BucketMember> members) {
+  if (members.size() == 1) {
+    BucketMember& member = members[0];
+    Launch(member.ctx, member.col_params, member.exec_key,
+           &member.ctx->input(0), member.ctx->mutable_output(0),
+           std::move(member.done));
+    return;
+  }
+  // The copies block, so they run on the work queue as the reductions do.
+  RunClosure([this, members = std::move(members)]() mutable {
+    auto done_all = [members](const Status& s) {
+      for (const BucketMember& member : members) {
+        member.done(s);
+      }
+    };
+    const BucketMember& first = members[0];
+    OpKernelContext* ctx = first.ctx;
+    int64_t num_elements = 0;
+    for (const BucketMember& member : members) {
+      num_elements += member.ctx->input(0).NumElements();
+    }
+    auto fused = std::make_shared<Tensor>();
+    Status status = ctx->allocate_temp(first.col_params->instance.data_type,
+                                       TensorShape({num_elements}),
+                                       fused.get());
+    if (!status.ok()) {
+      done_all(status);
+      return;
+    }
+
+    // Copies between the members' tensors and their slices of the fused
+    // buffer. All the members run on the same device.
+    auto copy = [ctx](OpKernelContext* member_ctx, bool to_fused,
+                      const Tensor& slice, Tensor* tensor) {
+      Tensor slice_alias = slice;
+      Notification note;
+      Status status;
+      CollectiveRemoteAccessLocal::MemCpyAsync(
+          to_fused ? member_ctx->op_device_context()
+                   : ctx->op_device_context(),
+          to_fused ? ctx->op_device_context()
+                   : member_ctx->op_device_context(),
+          ctx->device(), ctx->device(),
+          to_fused ? member_ctx->input_alloc_attr(0) : AllocatorAttributes(),
+          to_fused ? AllocatorAttributes() : member_ctx->output_alloc_attr(0),
+          to_fused ? tensor : &slice_alias, to_fused ? &slice_alias : tensor,
+          0 /*dev_to_dev_stream_index*/, [&note, &status](const Status& s) {
+            status.Update(s);
+            note.Notify();
+          });
+      note.WaitForNotification();
+      return status;
+    };
+    int64_t offset = 0;
+    for (const BucketMember& member : members) {
+      const int64_t n = member.ctx->input(0).NumElements();
+      Tensor input = member.ctx->input(0);
+      status.Update(copy(member.ctx, /*to_fused=*/true,
+                         fused->Slice(offset, offset + n), &input));
+      offset += n;
+    }
+    if (!status.ok()) {
+      done_all(status);
+      return;
+    }
+
+    auto* col_params = new CollectiveParams();
+    core::ScopedUnref unref(col_params);
+    col_params->group = first.col_params->group;
+    col_params->instance = first.col_params->instance;
+    col_params->instance.step_id = first.col_params->instance.step_id;
+    col_params->instance.impl_details = first.col_params->instance.impl_details;
+    col_params->instance.shape = TensorShape({num_elements});
+    col_params->name = first.col_params->name;
+    col_params->default_rank = first.col_params->default_rank;
+    col_params->merge_op = first.col_params->merge_op;
+    col_params->final_op = first.col_params->final_op;
+    col_params->compress_op = first.col_params->compress_op;
+    col_params->decompress_op = first.col_params->decompress_op;
+    col_params->sub_op = first.col_params->sub_op;
+    col_params->run_group_initialization =
+        first.col_params->run_group_initialization;
+    col_params->is_stateless = first.col_params->is_stateless;
+    // The subdivisions of the first member were generated for its own size.
+    CollImplDetails& details = col_params->instance.impl_details;
+    details.subdiv_offsets.clear();
+    details.subdiv_permutations.clear();
+    details.subdiv_source_rank.clear();
+    CollectiveImplementationInterface* col_impl = nullptr;
+    status = CollectiveRegistry::LookupParamResolverInstance(
+        details.collective_name, &col_impl);
+    if (status.ok()) {
+      status = col_impl->InitializeCollectiveParams(col_params);
+    }
+    if (!status.ok()) {
+      done_all(status);
+      return;
+    }
+
+    // The fused reduction runs under the exec_key of the first member, which
+    // does not run on its own, so the key is the same on all devices.
+    Launch(ctx, col_params, first.exec_key, fused.get(), fused.get(),
+           [this, members, fused, copy, done_all](const Status& s) {
+             if (!s.ok()) {
+               done_all(s);
+               return;
+             }
+             RunClosure([members, fused, copy, done_all]() {
+               Status status;
+               int64_t offset = 0;
+               for (const BucketMember& member : members) {
+                 const int64_t n = member.ctx->input(0).NumElements();
+                 status.Update(copy(member.ctx, /*to_fused=*/false,
+                                    fused->Slice(offset, offset + n),
+                                    member.ctx->mutable_output(0)));
+                 offset += n;
+               }
+               done_all(status);
+             });
+           });
+  });
+}
+
 void BaseCollectiveExecutor::CompleteParamsAsync(
     const DeviceAttributes& device, CollectiveParams* cp,
     CancellationManager* cancel_mgr, StatusCallback done) {
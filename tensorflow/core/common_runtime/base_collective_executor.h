@@ -15,8 +15,12 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_BASE_COLLECTIVE_EXECUTOR_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_BASE_COLLECTIVE_EXECUTOR_H_
 
+#include <map>
 #include <memory>
+#include <optional>
 #include <string>
+#include <tuple>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/buf_rendezvous.h"
 #include "tensorflow/core/framework/collective.h"
@@ -150,14 +154,53 @@ class BaseCollectiveExecutor : public CollectiveExecutor {
   Status status_ TF_GUARDED_BY(status_mu_);
 
  private:
+  // A reduction waiting in a bucket; see CollImplDetails::bucket_size.
+  struct BucketMember {
+    OpKernelContext* ctx;
+    const CollectiveParams* col_params;
+    string exec_key;
+    StatusCallback done;
+  };
+  struct Bucket {
+    // Indexed by instance_key - bucket_key.
+    std::vector<std::optional<BucketMember>> members;
+    // Members before this index have been launched.
+    int next_launch = 0;
+  };
+  // (group_key, bucket_key, default_rank, frame_id, iter_id).
+  using BucketId = std::tuple<int32, int32, int, uint64, int64_t>;
+
   Status CreateCollective(const CollectiveParams& col_params,
                           CollectiveImplementationInterface** col_impl);
+  // Runs col_params on input and output, and invokes done with the result.
+  void Launch(OpKernelContext* ctx, const CollectiveParams* col_params,
+              const string& exec_key, const Tensor* input, Tensor* output,
+              StatusCallback done);
+  // Returns true if col_params is a reduction that may be fused with the
+  // other members of its bucket.
+  static bool IsBucketed(const CollectiveParams& col_params);
+  // Adds a bucketed reduction to its bucket, and launches the fused
+  // reductions that became ready.
+  void AddToBucket(OpKernelContext* ctx, const CollectiveParams* col_params,
+                   const string& exec_key, StatusCallback done)
+      TF_LOCKS_EXCLUDED(bucket_mu_);
+  // Moves the runs of members of bucket that are ready to be fused into
+  // launches. The boundaries of the runs depend only on the input sizes and
+  // types of the members, so that all devices fuse the same way.
+  static void TakeReadyRuns(Bucket* bucket, int64_t bucket_bytes,
+                            std::vector<std::vector<BucketMember>>* launches);
+  // Reduces members as one fused reduction on a contiguous buffer.
+  void LaunchFused(std::vector<BucketMember> members);
+
   // Check if all ops on which this collective depends on have launched.
   bool CheckDependencies(const CollectiveParams& col_params)
       TF_EXCLUSIVE_LOCKS_REQUIRED(launch_mu_);
   // Tries to return the status that is the original error. It returns the
   // aborted status if the collective executor is aborted.
   Status GetStatus(const Status& s) TF_LOCKS_EXCLUDED(status_mu_);
+
+  mutex bucket_mu_;
+  std::map<BucketId, Bucket> buckets_ TF_GUARDED_BY(bucket_mu_);
 };
 
 }  // namespace tensorflow
@@ -68,7 +68,13 @@ const char* GetCollectiveName(const CollectiveParams* cp, bool nccl) {
       return nccl ? "NcclBroadcast" : "HierarchicalTreeBroadcast";
 
     case REDUCTION_COLLECTIVE:
-      return nccl ? "NcclReduce" : "RingReduce";
+      if (nccl) return "NcclReduce";
+      // The hierarchical reduction only pays off across tasks, and requires
+      // them to have the same number of devices.
+      return (cp->instance.impl_details.communication_hint == "hierarchical" &&
+              cp->group.num_tasks > 1 && cp->group.same_num_devices_per_task)
+                 ? "HierarchicalReduce"
+                 : "RingReduce";
 
     case GATHER_COLLECTIVE:
       return nccl ? "NcclGather" : "RingGather";
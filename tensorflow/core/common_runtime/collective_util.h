@@ -53,6 +53,12 @@ Status ComputeBinOp(OpKernelContext* op_ctx, OpKernelContext::Params* params,
                     Device* device, OpKernel* op, Tensor* output,
                     Tensor* input);
 
+// Runs the unary `op`, e.g. a Cast, on `input` with an OpKernelContext based
+// on `op_ctx`, and sets `output` to its result.
+Status ComputeUnaryOp(OpKernelContext* op_ctx, OpKernelContext::Params* params,
+                      Device* device, OpKernel* op, Tensor* input,
+                      Tensor* output);
+
 }  // namespace collective_util
 }  // namespace tensorflow
 
@@ -40,6 +40,12 @@ inline constexpr char kGcuWithSmearCostName[] = "gcu_with_smear";
 inline constexpr char kGcuNoSmearCostName[] = "gcu_no_smear";
 inline constexpr char kGcuNonBatchingCostName[] = "gcu_non_batching";
 
+// Types of per-request metrics that are not durations. They have the same
+// '_with_smear' and '_no_smear' versions as costs.
+//
+// Bytes of the inputs that a request contributes to the batches processing it.
+inline constexpr char kBatchInputBytesMetricName[] = "batch_input_bytes";
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_COMMON_RUNTIME_COST_CONSTANTS_H_
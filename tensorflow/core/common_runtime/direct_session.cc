@@ -63,6 +63,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/core/threadpool_options.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/numbers.h"
@@ -358,6 +359,22 @@ DirectSession::DirectSession(const SessionOptions& options,
         GlobalThreadPool(options, run_in_caller_thread_ ? 1 : 0),
         false /* owned */);
   }
+  if (options_.config.experimental().use_priority_inter_op_scheduling()) {
+    for (const auto& p_and_owned : thread_pools_) {
+      if (p_and_owned.first == nullptr) {
+        inter_op_schedulers_.emplace_back(nullptr, false /* owned */);
+      } else if (p_and_owned.second) {
+        inter_op_schedulers_.emplace_back(
+            new PriorityInterOpScheduler(p_and_owned.first), true /* owned */);
+      } else {
+        // Pools that are not owned are shared with other sessions, and so is
+        // their scheduler.
+        inter_op_schedulers_.emplace_back(
+            PriorityInterOpScheduler::Global(p_and_owned.first),
+            false /* owned */);
+      }
+    }
+  }
   // The default value of sync_on_finish will be flipped soon and this
   // environment variable will be removed as well.
   const Status status =
@@ -405,6 +422,10 @@ DirectSession::~DirectSession() {
   for (const auto& p_and_owned : thread_pools_) {
     if (p_and_owned.second) delete p_and_owned.first;
   }
+  // The pools have run all the closures that refer to the schedulers.
+  for (const auto& s_and_owned : inter_op_schedulers_) {
+    if (s_and_owned.second) delete s_and_owned.first;
+  }
 
   execution_state_.reset(nullptr);
   flib_def_.reset(nullptr);
@@ -518,6 +539,16 @@ Status DirectSession::RunInternal(
   RunState run_state(step_id, &devices_);
   const size_t num_executors = executors_and_keys->items.size();
 
+  // Compact the device allocators when the last running step finishes, so
+  // that the work does not overlap with the execution of a step.
+  num_running_steps_.fetch_add(1, std::memory_order_relaxed);
+  auto running_step_cleanup = gtl::MakeCleanup([this] {
+    if (num_running_steps_.fetch_sub(1, std::memory_order_acq_rel) == 1 &&
+        options_.config.experimental().compact_allocators_between_steps()) {
+      CompactDeviceAllocators();
+    }
+  });
+
   profiler::TraceMeProducer activity(
       // To TraceMeConsumers in ExecutorState::Process/Finish.
       [&] {
@@ -580,6 +611,8 @@ Status DirectSession::RunInternal(
 #endif
 
   thread::ThreadPool* pool;
+  // Orders the closures scheduled on `pool`, if set.
+  PriorityInterOpScheduler* scheduler = nullptr;
   // Use std::unique_ptr to ensure garbage collection
   std::unique_ptr<thread::ThreadPool> threadpool_wrapper;
 
@@ -591,6 +624,9 @@ Status DirectSession::RunInternal(
     // specified.
     if (executors_and_keys->items.size() > 1) {
       pool = thread_pools_[0].first;
+      if (!inter_op_schedulers_.empty()) {
+        scheduler = inter_op_schedulers_[0].first;
+      }
     } else {
       VLOG(1) << "Executing Session::Run() synchronously!";
       pool = nullptr;
@@ -607,7 +643,11 @@ Status DirectSession::RunInternal(
                                      run_options.inter_op_thread_pool());
     }
 
-    pool = thread_pools_[run_options.inter_op_thread_pool()].first;
+    const int pool_index = run_options.inter_op_thread_pool();
+    pool = thread_pools_[pool_index].first;
+    if (!inter_op_schedulers_.empty()) {
+      scheduler = inter_op_schedulers_[pool_index].first;
+    }
   }
 
   const int64_t call_timeout = run_options.timeout_in_ms() > 0
@@ -641,6 +681,12 @@ Status DirectSession::RunInternal(
     default_runner = [handler_ptr](Executor::Args::Closure c) {
       handler_ptr->ScheduleInterOpClosure(std::move(c));
     };
+  } else if (scheduler != nullptr) {
+    const int64_t priority =
+        run_options.experimental().run_handler_pool_options().priority();
+    default_runner = [scheduler, priority](Executor::Args::Closure c) {
+      scheduler->Schedule(priority, std::move(c));
+    };
   } else {
     default_runner = [pool](Executor::Args::Closure c) {
       pool->Schedule(std::move(c));
@@ -841,6 +887,17 @@ Status DirectSession::RunInternal(
   return absl::OkStatus();
 }
 
+void DirectSession::CompactDeviceAllocators() {
+  for (Device* device : devices_) {
+    Allocator* allocator = device->GetAllocator(AllocatorAttributes());
+    const size_t released_bytes = allocator->Compact();
+    if (released_bytes > 0) {
+      VLOG(1) << "Released " << strings::HumanReadableNumBytes(released_bytes)
+              << " from " << allocator->Name() << " of " << device->name();
+    }
+  }
+}
+
 Status DirectSession::Run(const RunOptions& run_options,
                           const NamedTensorList& inputs,
                           const std::vector<string>& output_names,
@@ -1399,15 +1456,35 @@ Status DirectSession::CreateExecutors(
     params.device = device;
     params.session_metadata = session_metadata;
     params.function_library = lib;
+    params.use_step_arena =
+        options_.config.experimental().use_step_arena_allocator();
+    params.use_static_memory_plan =
+        options_.config.experimental().use_static_memory_plan();
+    params.frozen_memory_plan_stable_steps =
+        options_.config.experimental().frozen_memory_plan_stable_steps();
+    params.use_frozen_memory_plan = params.frozen_memory_plan_stable_steps > 0;
     auto opseg = device->op_segment();
+    const bool share_kernels =
+        options_.config.experimental().share_kernels_across_sessions();
+    const string device_key = strings::StrCat(
+        device->name(), "|", device->attributes().physical_device_desc());
     params.create_kernel =
-        [this, lib, opseg](const std::shared_ptr<const NodeProperties>& props,
-                           OpKernel** kernel) {
+        [this, lib, opseg, share_kernels, device_key](
+            const std::shared_ptr<const NodeProperties>& props,
+            OpKernel** kernel) {
           // NOTE(mrry): We must not share function kernels (implemented
           // using `CallOp`) between subgraphs, because `CallOp::handle_`
           // is tied to a particular subgraph. Even if the function itself
           // is stateful, the `CallOp` that invokes it is not.
           if (!OpSegment::ShouldOwnKernel(lib, props->node_def.op())) {
+            if (share_kernels &&
+                OpSegment::ShouldShareKernel(lib, props->node_def)) {
+              return OpSegment::FindOrCreateShared(
+                  device_key, props->node_def, kernel,
+                  [lib, &props](OpKernel** kernel) {
+                    return lib->CreateKernel(props, kernel);
+                  });
+            }
             return lib->CreateKernel(props, kernel);
           }
           auto create_fn = [lib, &props](OpKernel** kernel) {
@@ -1419,9 +1496,11 @@ Status DirectSession::CreateExecutors(
           return opseg->FindOrCreate(session_handle_, props->node_def.name(),
                                      kernel, create_fn);
         };
-    params.delete_kernel = [lib](OpKernel* kernel) {
-      if (kernel && !OpSegment::ShouldOwnKernel(lib, kernel->type_string()))
+    params.delete_kernel = [lib, share_kernels](OpKernel* kernel) {
+      if (kernel && !OpSegment::ShouldOwnKernel(lib, kernel->type_string())) {
+        if (share_kernels && OpSegment::UnrefSharedKernel(kernel)) return;
         delete kernel;
+      }
     };
 
     optimizer.Optimize(lib, options_.env, device, &partition_graph,
@@ -1547,7 +1626,11 @@ Status DirectSession::GetOrCreateExecutors(
         strings::StrCat(sorted_key, ";", handle_name_counter_value);
   }
 
-  // See if we already have the executors for this run.
+  // See if we already have the executors for this run, or if another thread
+  // is creating them. Partial runs need their own copy of the graph, so they
+  // always create their executors.
+  std::shared_ptr<PendingExecutors> pending;
+  bool is_creator = true;
   {
     mutex_lock l(executor_lock_);
     auto it = executors_.find(sorted_key);
@@ -1555,7 +1638,36 @@ Status DirectSession::GetOrCreateExecutors(
       *executors_and_keys = it->second.get();
       return absl::OkStatus();
     }
+    if (!run_state_args->is_partial_run) {
+      std::shared_ptr<PendingExecutors>& entry = pending_executors_[sorted_key];
+      if (entry == nullptr) {
+        entry = std::make_shared<PendingExecutors>();
+      } else {
+        is_creator = false;
+      }
+      pending = entry;
+    }
+  }
+  if (!is_creator) {
+    pending->done.WaitForNotification();
+    TF_RETURN_IF_ERROR(pending->status);
+    mutex_lock l(executor_lock_);
+    auto it = executors_.find(sorted_key);
+    DCHECK(it != executors_.end());
+    executors_.emplace(key, it->second);
+    *executors_and_keys = it->second.get();
+    return absl::OkStatus();
   }
+  // Wakes up the callers waiting for this one, whether or not it succeeds.
+  auto notify_pending = [this, &pending, &sorted_key](const Status& status) {
+    if (pending == nullptr) return;
+    {
+      mutex_lock l(executor_lock_);
+      pending_executors_.erase(sorted_key);
+    }
+    pending->status = status;
+    pending->done.Notify();
+  };
 
   // Nothing found, so create the executors and store in the cache.
   // The executor_lock_ is intentionally released while executors are
@@ -1580,28 +1692,83 @@ Status DirectSession::GetOrCreateExecutors(
       ->set_collective_graph_key(run_state_args->collective_graph_key);
   std::unique_ptr<ExecutorsAndKeys> ek;
   std::unique_ptr<FunctionInfo> func_info;
-  TF_RETURN_IF_ERROR(
-      CreateExecutors(callable_options, &ek, &func_info, run_state_args));
+  Status status =
+      CreateExecutors(callable_options, &ek, &func_info, run_state_args);
+  if (!status.ok()) {
+    notify_pending(status);
+    return status;
+  }
 
-  // Reacquire the lock, try to insert into the map.
-  mutex_lock l(executor_lock_);
+  {
+    // Reacquire the lock, try to insert into the map.
+    mutex_lock l(executor_lock_);
 
-  // Another thread may have created the entry before us, in which case we will
-  // reuse the already created one.
-  auto insert_result = executors_.emplace(
-      sorted_key, std::shared_ptr<ExecutorsAndKeys>(std::move(ek)));
-  if (insert_result.second) {
-    functions_.push_back(std::move(func_info));
-  }
+    // Another thread may have created the entry before us, in which case we
+    // will reuse the already created one.
+    auto insert_result = executors_.emplace(
+        sorted_key, std::shared_ptr<ExecutorsAndKeys>(std::move(ek)));
+    if (insert_result.second) {
+      functions_.push_back(std::move(func_info));
+    }
 
-  // Insert the value under the original key, so the fast path lookup will work
-  // if the user uses the same order of inputs, outputs, and targets again.
-  executors_.emplace(key, insert_result.first->second);
-  *executors_and_keys = insert_result.first->second.get();
+    // Insert the value under the original key, so the fast path lookup will
+    // work if the user uses the same order of inputs, outputs, and targets
+    // again.
+    executors_.emplace(key, insert_result.first->second);
+    *executors_and_keys = insert_result.first->second.get();
+  }
+  notify_pending(absl::OkStatus());
 
   return absl::OkStatus();
 }
 
+void DirectSession::PrebuildExecutorsAsync(std::vector<RunSignature> signatures,
+                                           StatusCallback done) {
+  Status status = CheckNotClosed();
+  if (status.ok()) status = CheckGraphCreated("PrebuildExecutorsAsync()");
+  if (!status.ok() || signatures.empty()) {
+    done(status);
+    return;
+  }
+
+  // Signatures are built in parallel, and `done` is called by the last one.
+  struct PrebuildState {
+    std::vector<RunSignature> signatures;
+    StatusCallback done;
+    std::atomic<int> num_pending;
+    mutex mu;
+    Status status TF_GUARDED_BY(mu);
+  };
+  auto state = std::make_shared<PrebuildState>();
+  state->signatures = std::move(signatures);
+  state->done = std::move(done);
+  state->num_pending = state->signatures.size();
+  thread::ThreadPool* pool = thread_pools_[0].first;
+  for (size_t i = 0; i < state->signatures.size(); ++i) {
+    pool->Schedule([this, state, i]() {
+      const RunSignature& signature = state->signatures[i];
+      DebugOptions debug_options;
+      RunStateArgs run_state_args(debug_options);
+      ExecutorsAndKeys* executors_and_keys;
+      Status s = GetOrCreateExecutors(signature.inputs, signature.outputs,
+                                      signature.target_nodes,
+                                      &executors_and_keys, &run_state_args);
+      if (!s.ok()) {
+        mutex_lock l(state->mu);
+        state->status.Update(s);
+      }
+      if (state->num_pending.fetch_sub(1) == 1) {
+        Status final_status;
+        {
+          mutex_lock l(state->mu);
+          final_status = state->status;
+        }
+        state->done(final_status);
+      }
+    });
+  }
+}
+
 Status DirectSession::CreateGraphs(
     const BuildGraphOptions& subgraph_options,
     std::unordered_map<string, std::unique_ptr<Graph>>* outputs,
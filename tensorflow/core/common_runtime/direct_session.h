@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device_set.h"
 #include "tensorflow/core/common_runtime/executor.h"
 #include "tensorflow/core/common_runtime/graph_execution_state.h"
+#include "tensorflow/core/common_runtime/priority_inter_op_scheduler.h"
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/common_runtime/session_factory.h"
@@ -38,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/framework/session_state.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -135,6 +137,21 @@ class DirectSession : public Session {
 
   ::tensorflow::Status Finalize() override;
 
+  // The feeds, fetches and targets of a `Run()` call.
+  struct RunSignature {
+    std::vector<string> inputs;
+    std::vector<string> outputs;
+    std::vector<string> target_nodes;
+  };
+
+  // Creates and caches the executors for each of `signatures` in the
+  // background, so that the first `Run()` with one of them does not have to
+  // prune, optimize and instantiate the graph. `done` is called once all the
+  // signatures are built, with the first error if any. The session must not
+  // be closed or deleted before `done` is called.
+  void PrebuildExecutorsAsync(std::vector<RunSignature> signatures,
+                              StatusCallback done);
+
   const SessionOptions& options() const { return options_; }
 
  private:
@@ -269,6 +286,9 @@ class DirectSession : public Session {
       RunMetadata* run_metadata,
       const thread::ThreadPoolOptions& threadpool_options);
 
+  // Calls `Allocator::Compact()` on the default allocator of every device.
+  void CompactDeviceAllocators();
+
   // Returns whether inter-op execution uses a global pool or the input
   // `run_options` requests being run on inter_op_thread_pool = 0 in case
   // multiple pools are configured.
@@ -350,6 +370,11 @@ class DirectSession : public Session {
   // is owned.
   std::vector<std::pair<thread::ThreadPool*, bool>> thread_pools_;
 
+  // If the session uses priority inter-op scheduling, the scheduler for each
+  // element of `thread_pools_`, and whether this session owns it.
+  std::vector<std::pair<PriorityInterOpScheduler*, bool>>
+      inter_op_schedulers_;
+
   Status init_error_;  // Set to an error if construction failed.
 
   // If true, blocks until device has finished all queued operations in a step.
@@ -367,6 +392,16 @@ class DirectSession : public Session {
   std::unordered_map<string, std::shared_ptr<ExecutorsAndKeys>> executors_
       TF_GUARDED_BY(executor_lock_);
 
+  // Executors that one call to `GetOrCreateExecutors()` is creating, keyed by
+  // sorted signature. Concurrent calls with the same signature wait for that
+  // call instead of creating their own copy.
+  struct PendingExecutors {
+    Notification done;
+    Status status;
+  };
+  std::unordered_map<string, std::shared_ptr<PendingExecutors>>
+      pending_executors_ TF_GUARDED_BY(executor_lock_);
+
   class RunCallableCallFrame;
   struct Callable {
     std::shared_ptr<ExecutorsAndKeys> executors_and_keys;
@@ -416,6 +451,9 @@ class DirectSession : public Session {
   // For generating step ids that are unique among all sessions.
   static std::atomic_int_fast64_t step_id_counter_;
 
+  // The number of steps currently in `RunInternal()`.
+  std::atomic<int> num_running_steps_{0};
+
   // Global timeout for all blocking operations in this session.
   const int64_t operation_timeout_in_ms_ = 0;
 
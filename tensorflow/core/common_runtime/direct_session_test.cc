@@ -43,6 +43,7 @@ limitations under the License.
 #include "tensorflow/core/graph/testlib.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/core/threadpool.h"
@@ -613,6 +614,43 @@ TEST_F(DirectSessionMinusAXTest, TestConcurrency_Callable) {
   delete tp;
 }
 
+TEST_F(DirectSessionMinusAXTest, PrebuildExecutorsAsync) {
+  Initialize({1, 2, 3, 4});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+  DirectSession* direct_session = static_cast<DirectSession*>(session.get());
+
+  // The same signature twice, so that one build waits for the other.
+  DirectSession::RunSignature signature;
+  signature.outputs = {y_ + ":0"};
+  Notification done;
+  Status prebuild_status;
+  direct_session->PrebuildExecutorsAsync({signature, signature},
+                                         [&](const Status& s) {
+                                           prebuild_status = s;
+                                           done.Notify();
+                                         });
+  done.WaitForNotification();
+  TF_ASSERT_OK(prebuild_status);
+
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->Run({}, {y_ + ":0"}, {}, &outputs));
+  ASSERT_EQ(1, outputs.size());
+  EXPECT_FLOAT_EQ(3.0, outputs[0].matrix<float>()(0, 0));
+
+  DirectSession::RunSignature invalid_signature;
+  invalid_signature.outputs = {"missing:0"};
+  Notification invalid_done;
+  direct_session->PrebuildExecutorsAsync({invalid_signature},
+                                         [&](const Status& s) {
+                                           prebuild_status = s;
+                                           invalid_done.Notify();
+                                         });
+  invalid_done.WaitForNotification();
+  EXPECT_FALSE(prebuild_status.ok());
+}
+
 TEST_F(DirectSessionMinusAXTest, TestPerSessionThreads) {
   Initialize({1, 2, 3, 4});
 
@@ -650,6 +688,44 @@ TEST_F(DirectSessionMinusAXTest, TestPerSessionThreads) {
   delete tp;
 }
 
+TEST_F(DirectSessionMinusAXTest, TestPriorityInterOpScheduling) {
+  Initialize({1, 2, 3, 4});
+
+  SessionOptions options;
+  options.config.set_use_per_session_threads(true);
+  options.config.mutable_experimental()->set_use_priority_inter_op_scheduling(
+      true);
+  (*options.config.mutable_device_count())["CPU"] = 2;
+  std::unique_ptr<Session> session(NewSession(options));
+
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  thread::ThreadPool* tp = new thread::ThreadPool(Env::Default(), "test", 4);
+
+  // Run the graph concurrently with a different priority in each thread.
+  std::vector<string> output_names = {y_ + ":0"};
+  for (int i = 0; i < 4; ++i) {
+    tp->Schedule([&session, output_names, i]() {
+      RunOptions run_options;
+      run_options.mutable_experimental()
+          ->mutable_run_handler_pool_options()
+          ->set_priority(i);
+      for (int j = 0; j < 100; ++j) {
+        std::vector<Tensor> outputs;
+        TF_ASSERT_OK(session->Run(run_options, {}, output_names, {},
+                                  &outputs, nullptr));
+        ASSERT_EQ(1, outputs.size());
+        auto mat = outputs[0].matrix<float>();
+        EXPECT_FLOAT_EQ(3.0, mat(0, 0));
+      }
+    });
+  }
+
+  // Wait for the functions to finish.
+  delete tp;
+}
+
 TEST_F(DirectSessionMinusAXTest, TwoCreateCallsFails) {
   Initialize({1, 2, 3, 4});
   auto session = CreateSession();
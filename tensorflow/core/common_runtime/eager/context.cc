@@ -26,6 +26,7 @@ limitations under the License.
 
 // clang-format off
 // Required for IS_MOBILE_PLATFORM
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "tensorflow/c/eager/immediate_execution_context.h"
@@ -105,6 +106,90 @@ auto* eager_context_created =
     monitoring::Gauge<bool, 0>::New("/tensorflow/core/eager_context_created",
                                     "True if an eager context was created.");
 
+// The kernels a thread recently found in the kernel caches of the contexts,
+// so that eager ops run in a loop get their kernel without taking the lock
+// of the shared cache, whose cache line bounces between the threads running
+// ops. Each entry holds a reference to its kernel; a context drops the
+// entries of its kernels from all threads (see Invalidate()) before removing
+// kernels from its cache, so that they never outlive the context.
+class ThreadKernelCache {
+ public:
+  ThreadKernelCache() {
+    mutex_lock l(*registry_mu());
+    registry()->insert(this);
+  }
+  ~ThreadKernelCache() {
+    mutex_lock l(*registry_mu());
+    registry()->erase(this);
+  }
+
+  // Returns the cache of the calling thread.
+  static ThreadKernelCache* Get() {
+    static thread_local ThreadKernelCache cache;
+    return &cache;
+  }
+
+  core::RefCountPtr<KernelAndDevice> Lookup(const EagerContext* ctx,
+                                            const Fprint128& cache_key) {
+    mutex_lock l(mu_);
+    const Entry& entry = entries_[Index(cache_key)];
+    if (entry.ctx != ctx || !(entry.cache_key == cache_key)) return nullptr;
+    entry.kernel->Ref();
+    return core::RefCountPtr<KernelAndDevice>(entry.kernel.get());
+  }
+
+  // Caches "kernel", found in the cache of "ctx" when its generation was
+  // "expected_generation", unless the cache of "ctx" changed since.
+  void Insert(const EagerContext* ctx, const std::atomic<int64_t>& generation,
+              int64_t expected_generation, const Fprint128& cache_key,
+              KernelAndDevice* kernel) {
+    mutex_lock l(mu_);
+    if (generation.load() != expected_generation) return;
+    Entry& entry = entries_[Index(cache_key)];
+    kernel->Ref();
+    entry.ctx = ctx;
+    entry.cache_key = cache_key;
+    entry.kernel.reset(kernel);
+  }
+
+  // Drops the entries of "ctx" from the caches of all threads.
+  static void Invalidate(const EagerContext* ctx) {
+    mutex_lock registry_lock(*registry_mu());
+    for (ThreadKernelCache* cache : *registry()) {
+      mutex_lock l(cache->mu_);
+      for (Entry& entry : cache->entries_) {
+        if (entry.ctx == ctx) entry = Entry();
+      }
+    }
+  }
+
+ private:
+  static constexpr int kNumEntries = 64;
+
+  struct Entry {
+    const EagerContext* ctx = nullptr;
+    Fprint128 cache_key{0, 0};
+    core::RefCountPtr<KernelAndDevice> kernel;
+  };
+
+  static int Index(const Fprint128& cache_key) {
+    return cache_key.low64 % kNumEntries;
+  }
+
+  static mutex* registry_mu() {
+    static mutex* mu = new mutex();
+    return mu;
+  }
+  static absl::flat_hash_set<ThreadKernelCache*>* registry() {
+    static auto* caches = new absl::flat_hash_set<ThreadKernelCache*>();
+    return caches;
+  }
+
+  // Only contended by Invalidate().
+  mutex mu_;
+  Entry entries_[kNumEntries] TF_GUARDED_BY(mu_);
+};
+
 }  // namespace
 
 const int64_t EagerContext::kGlobalRendezvousId = -1;
@@ -472,6 +557,7 @@ void EagerContext::ClearCachesAndDefaultExecutor() {
     // during this time as well.
     mutex_lock ml(cache_mu_);
     default_executor_.WaitForAllPendingNodes().IgnoreError();
+    InvalidateThreadKernelCaches();
     kernel_cache_.clear();
     for (auto& entry : registered_functions_) {
       entry.second->cached_kernel_keys->clear();
@@ -1131,6 +1217,9 @@ Status EagerContext::RemoveFunction(const string& func) {
     }
     is_last_ref = registered_function->RefCountIsOne();
     if (is_last_ref) {
+      if (!registered_function->cached_kernel_keys->empty()) {
+        InvalidateThreadKernelCaches();
+      }
       for (auto& key : *registered_function->cached_kernel_keys) {
         kernel_cache_.erase(key);
       }
@@ -1215,14 +1304,32 @@ Status EagerContext::SyncExecutors() {
 
 core::RefCountPtr<KernelAndDevice> EagerContext::GetCachedKernel(
     Fprint128 cache_key) {
-  tf_shared_lock l(cache_mu_);
-  auto iter = kernel_cache_.find(cache_key);
-  if (iter == kernel_cache_.end()) {
-    return nullptr;
+  ThreadKernelCache* thread_cache = ThreadKernelCache::Get();
+  core::RefCountPtr<KernelAndDevice> kernel =
+      thread_cache->Lookup(this, cache_key);
+  if (kernel) return kernel;
+
+  const int64_t generation = kernel_cache_generation_.load();
+  {
+    tf_shared_lock l(cache_mu_);
+    auto iter = kernel_cache_.find(cache_key);
+    if (iter == kernel_cache_.end()) {
+      return nullptr;
+    }
+    kernel.reset(iter->second.get());
+    kernel->Ref();
   }
-  core::RefCountPtr<KernelAndDevice> new_ref(iter->second.get());
-  new_ref->Ref();
-  return new_ref;
+  thread_cache->Insert(this, kernel_cache_generation_, generation, cache_key,
+                       kernel.get());
+  return kernel;
+}
+
+void EagerContext::InvalidateThreadKernelCaches() {
+  // Threads check the generation before caching a kernel they found, so those
+  // racing with this call either skip caching it or cache it before the
+  // entries of this context are dropped.
+  kernel_cache_generation_.fetch_add(1);
+  ThreadKernelCache::Invalidate(this);
 }
 
 Device* EagerContext::GetCachedDevice(Fprint128 device_cache_key) {
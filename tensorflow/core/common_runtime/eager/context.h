@@ -290,6 +290,8 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
 
   Status AsyncWait() override { return SyncExecutors(); }
 
+  // Looks up a kernel in the cache of the calling thread first, then in the
+  // kernel cache shared by all threads.
   core::RefCountPtr<KernelAndDevice> GetCachedKernel(Fprint128 cache_key);
   Device* GetCachedDevice(Fprint128 device_cache_key);
 
@@ -689,6 +691,10 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
 
   void ClearResourceContainer(const string& name);
 
+  // Drops the kernels of this context from the kernel caches of all threads.
+  // Must be called before removing kernels from kernel_cache_.
+  void InvalidateThreadKernelCaches() TF_EXCLUSIVE_LOCKS_REQUIRED(cache_mu_);
+
   template <typename T>
   struct OwnedOrUnownedHelper {
    public:
@@ -786,6 +792,8 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
   std::unordered_map<Fprint128, core::RefCountPtr<KernelAndDevice>,
                      Fprint128Hasher>
       kernel_cache_ TF_GUARDED_BY(cache_mu_);
+  // Incremented whenever kernels are removed from kernel_cache_.
+  std::atomic<int64_t> kernel_cache_generation_{0};
   std::unordered_map<string, RegisteredFunction*> registered_functions_
       TF_GUARDED_BY(cache_mu_);
 
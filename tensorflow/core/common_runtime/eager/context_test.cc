@@ -17,11 +17,14 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <vector>
 
 #include "absl/status/status.h"
 #include "absl/types/span.h"
+#include "tensorflow/core/common_runtime/eager/attr_builder.h"
 #include "tensorflow/core/common_runtime/eager/context_distributed_manager.h"
+#include "tensorflow/core/common_runtime/eager/kernel_and_device.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -400,5 +403,36 @@ TEST_F(EagerContextTest, ReuseGlobalRendezvous) {
   TestGlobalRendezvous(context(), true);
 }
 
+TEST_F(EagerContextTest, CachedKernels) {
+  InitContext(SessionOptions(), DEVICE_PLACEMENT_EXPLICIT);
+  const NodeDef ndef(AttrBuilder("Cast")
+                         .Set("SrcT", DT_FLOAT)
+                         .Set("DstT", DT_INT32)
+                         .Set("Truncate", false)
+                         .NumInputs(1)
+                         .BuildNodeDef());
+  core::RefCountPtr<KernelAndDevice> kernel(new KernelAndDeviceOp(
+      nullptr, false, context()->func_lib(context()->HostCPU()), nullptr,
+      nullptr, context()->HostCPU()));
+  TF_ASSERT_OK(kernel->Init(false, ndef, nullptr, std::nullopt));
+  const Fprint128 cache_key{1, 2};
+  EXPECT_EQ(context()->GetCachedKernel(cache_key), nullptr);
+  kernel->Ref();
+  context()->AddKernelToCache(cache_key,
+                              core::RefCountPtr<KernelAndDevice>(kernel.get()));
+
+  // Lookups after the first one are served by the cache of this thread.
+  EXPECT_EQ(context()->GetCachedKernel(cache_key).get(), kernel.get());
+  EXPECT_EQ(context()->GetCachedKernel(cache_key).get(), kernel.get());
+  std::thread([&] {
+    EXPECT_EQ(context()->GetCachedKernel(cache_key).get(), kernel.get());
+  }).join();
+
+  // Clearing the caches drops the references of all threads.
+  context()->ClearCachesAndDefaultExecutor();
+  EXPECT_TRUE(kernel->RefCountIsOne());
+  EXPECT_EQ(context()->GetCachedKernel(cache_key), nullptr);
+}
+
 }  // namespace
 }  // namespace tensorflow
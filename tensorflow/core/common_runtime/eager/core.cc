@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/eager/context.h"
 #include "tensorflow/core/common_runtime/eager/eager_operation.h"
 #include "tensorflow/core/common_runtime/eager/execute.h"
+#include "tensorflow/core/common_runtime/eager/lazy_segment_runner.h"
 #include "tensorflow/core/common_runtime/eager/placement_utils.h"
 #include "tensorflow/core/common_runtime/eager/tensor_handle.h"
 #include "tensorflow/core/platform/errors.h"
@@ -184,6 +185,10 @@ Status EagerOperation::Execute(absl::Span<AbstractTensorHandle*> retvals,
   // physical devices.
   tensorflow::TensorHandle** retval_array =
       reinterpret_cast<tensorflow::TensorHandle**>(retvals.data());
+  if (Executor().Async() && !Executor().HasSegmentRunner() &&
+      LazySegmentsEnabled()) {
+    Executor().SetSegmentRunner(CreateLazySegmentRunner());
+  }
   return EagerExecute(this, retval_array, num_retvals);
 }
 
@@ -15,10 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/eager/eager_executor.h"
 
+#include <algorithm>
 #include <forward_list>
 #include <functional>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
@@ -26,6 +28,9 @@ limitations under the License.
 
 namespace tensorflow {
 namespace {
+// The most nodes the executor passes to EagerNodeSegmentRunner::SegmentLength.
+constexpr int kMaxSegmentCandidates = 64;
+
 bool IsAsyncWaitForRemoteFunctionEnabled() {
   bool enabled = true;
   TF_CHECK_OK(ReadBoolFromEnvVar("TF_ENABLE_ASYNC_WAIT_FOR_REMOTE_FUNCTION",
@@ -160,7 +165,7 @@ Status EagerExecutor::AddOrExecute(std::unique_ptr<EagerNode> node) {
     } else {
       status = status_;
       if (status.ok()) {
-        node_queue_.push(std::move(item));
+        node_queue_.push_back(std::move(item));
         // If there were no previous nodes pending, wake the run thread to
         // start processing requests again.
         if (node_queue_.size() == 1) {
@@ -256,7 +261,7 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
     if (from_queue) {
       // Since this was from the async queue, pop it from the front of the queue
       DCHECK(!node_queue_.empty() && item.get() == node_queue_.front().get());
-      node_queue_.pop();
+      node_queue_.pop_front();
     } else if (async) {
       // If it is an Async node then we will find the node in the unfinished
       // nodes list. However we only notify if we are at the front of the list
@@ -290,7 +295,7 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
       }
       while (!node_queue_.empty()) {
         items_to_destroy.push_front(std::move(node_queue_.front()));
-        node_queue_.pop();
+        node_queue_.pop_front();
       }
       for (auto& it : unfinished_nodes_) {
         items_to_destroy.push_front(std::move(it.second));
@@ -349,6 +354,8 @@ void EagerExecutor::Run() {
       gtl::MakeCleanup([this] { thread_exited_notification_.Notify(); });
   while (true) {
     core::RefCountPtr<NodeItem> curr_item;
+    EagerNodeSegmentRunner* segment_runner = nullptr;
+    std::vector<core::RefCountPtr<NodeItem>> segment_candidates;
     {
       tensorflow::mutex_lock l(node_queue_mutex_);
       while (node_queue_.empty() || !status_.ok()) {
@@ -364,6 +371,29 @@ void EagerExecutor::Run() {
       // and register a notification for its completion.
       curr_item.reset(node_queue_.front().get());
       curr_item->Ref();
+      segment_runner = segment_runner_.get();
+      if (segment_runner != nullptr && node_queue_.size() > 1) {
+        const int num_candidates =
+            std::min<int>(node_queue_.size(), kMaxSegmentCandidates);
+        segment_candidates.reserve(num_candidates);
+        for (int i = 0; i < num_candidates; ++i) {
+          node_queue_[i]->Ref();
+          segment_candidates.emplace_back(node_queue_[i].get());
+        }
+      }
+    }
+    if (!segment_candidates.empty()) {
+      std::vector<EagerNode*> nodes;
+      nodes.reserve(segment_candidates.size());
+      for (const auto& item : segment_candidates) {
+        nodes.push_back(item->node.get());
+      }
+      const int segment_length = segment_runner->SegmentLength(nodes);
+      if (segment_length > 1) {
+        segment_candidates.resize(segment_length);
+        RunSegment(segment_runner, std::move(segment_candidates));
+        continue;
+      }
     }
     Status status = RunItem(std::move(curr_item), /*from_queue=*/true);
     if (!status.ok()) {
@@ -372,6 +402,44 @@ void EagerExecutor::Run() {
   }
 }
 
+void EagerExecutor::RunSegment(
+    EagerNodeSegmentRunner* runner,
+    std::vector<core::RefCountPtr<NodeItem>> items) {
+  std::vector<EagerNode*> nodes;
+  nodes.reserve(items.size());
+  for (const auto& item : items) {
+    nodes.push_back(item->node.get());
+  }
+  Status status = runner->RunSegment(nodes);
+  if (status.ok()) {
+    DVLOG(3) << "Ran nodes [id " << items.front()->id << " to "
+             << items.back()->id << "] as a segment";
+    for (const auto& item : items) {
+      NodeDone(item, status, /*from_queue=*/true);
+    }
+    return;
+  }
+  VLOG(1) << "Running " << items.size()
+          << " nodes one at a time, since running them as a segment failed: "
+          << status;
+  for (auto& item : items) {
+    // An error aborts and drops the remaining nodes.
+    if (!this->status().ok()) return;
+    status = RunItem(std::move(item), /*from_queue=*/true);
+    if (!status.ok()) {
+      VLOG(1) << "Failed to run item: " << status;
+    }
+  }
+}
+
+void EagerExecutor::SetSegmentRunner(
+    std::unique_ptr<EagerNodeSegmentRunner> runner) {
+  mutex_lock l(node_queue_mutex_);
+  if (segment_runner_ != nullptr) return;
+  segment_runner_ = std::move(runner);
+  has_segment_runner_ = true;
+}
+
 Status EagerExecutor::RunItem(core::RefCountPtr<NodeItem> item,
                               bool from_queue) {
   DVLOG(3) << "Running Node: [id " << item->id << "] "
@@ -434,7 +502,7 @@ Status EagerExecutor::MoveToUnfinished(core::RefCountPtr<NodeItem> item,
 
   if (from_queue) {
     DCHECK(!node_queue_.empty() && item.get() == node_queue_.front().get());
-    node_queue_.pop();
+    node_queue_.pop_front();
   }
 
   DVLOG(3) << "Add Node: [id " << item->id << "] to unfinished map.";
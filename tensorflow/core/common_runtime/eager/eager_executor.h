@@ -19,14 +19,15 @@ limitations under the License.
 #include <atomic>
 #include <cstddef>
 #include <functional>
+#include <deque>
 #include <map>
 #include <memory>
-#include <queue>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
@@ -43,6 +44,7 @@ limitations under the License.
 namespace tensorflow {
 
 class AsyncEagerNode;
+class AsyncExecuteNode;
 class AsyncRemoteExecuteNode;
 namespace eager {
 class EagerClient;
@@ -74,6 +76,7 @@ class EagerNode {
   // Returns nullptr iff this Eager node is synchronous.
   virtual AsyncEagerNode* AsAsync() { return nullptr; }
   virtual AsyncRemoteExecuteNode* AsAsyncRemoteExecuteNode() { return nullptr; }
+  virtual AsyncExecuteNode* AsAsyncExecuteNode() { return nullptr; }
 
   virtual string DebugString() const = 0;
 
@@ -105,6 +108,23 @@ class AsyncRemoteExecuteNode : public AsyncEagerNode {
   virtual Status SyncExecutors() = 0;
 };
 
+// Runs runs of consecutive nodes pending in an async EagerExecutor together,
+// e.g. traced into a single function, instead of one at a time. Only called
+// from the thread of the executor.
+class EagerNodeSegmentRunner {
+ public:
+  virtual ~EagerNodeSegmentRunner() = default;
+
+  // Returns how many of "nodes", the first nodes pending in the executor, in
+  // order, to run together. The executor runs the first node alone if it is
+  // less than 2.
+  virtual int SegmentLength(absl::Span<EagerNode* const> nodes) = 0;
+
+  // Runs "nodes" together. On error, must have had no effect, so that the
+  // executor can run them one at a time instead.
+  virtual Status RunSegment(absl::Span<EagerNode* const> nodes) = 0;
+};
+
 // A class for handling async execution (see TFE_ContextSetAsync).
 // Note that this class is thread-safe.
 // TODO(agarwal): TFE_OpAddInput may currently block if it tries to access the
@@ -167,6 +187,11 @@ class EagerExecutor {
   // callbacks are no longer safe to run.
   void RemoveCleanups(intptr_t key);
 
+  // In async mode, makes the executor run runs of pending nodes that `runner`
+  // accepts together. Does nothing if a runner is already set.
+  void SetSegmentRunner(std::unique_ptr<EagerNodeSegmentRunner> runner);
+  bool HasSegmentRunner() const { return has_segment_runner_; }
+
  private:
   // Possible states for this executor.
   // Executor starts in kActive state. When Shutdown() is called, Executor
@@ -211,6 +236,11 @@ class EagerExecutor {
   void Run();
 
   Status RunItem(core::RefCountPtr<NodeItem> item, bool from_queue);
+
+  // Runs `items`, the first items of node_queue_, with `runner`, or one at a
+  // time if it fails.
+  void RunSegment(EagerNodeSegmentRunner* runner,
+                  std::vector<core::RefCountPtr<NodeItem>> items);
   Status MoveToUnfinished(core::RefCountPtr<NodeItem> item, bool from_queue);
 
   // The impl of WaitForAllPendingNodes
@@ -230,7 +260,7 @@ class EagerExecutor {
   condition_variable nodes_done_ TF_GUARDED_BY(node_queue_mutex_);
 
   // Queue of pending NodeItems. Ordered by NodeItem::id.
-  std::queue<core::RefCountPtr<NodeItem>> node_queue_
+  std::deque<core::RefCountPtr<NodeItem>> node_queue_
       TF_GUARDED_BY(node_queue_mutex_);
 
   // Ordered by NodeItem::id.
@@ -277,6 +307,11 @@ class EagerExecutor {
   // async nodes reach this number, enqueuing to the eager async queue is
   // blocked.
   const int64_t in_flight_nodes_limit_;
+
+  // Set at most once, and then kept until destruction.
+  std::unique_ptr<EagerNodeSegmentRunner> segment_runner_
+      TF_GUARDED_BY(node_queue_mutex_);
+  std::atomic<bool> has_segment_runner_{false};
 };
 
 inline bool EagerExecutor::Async() const { return thread_ != nullptr; }
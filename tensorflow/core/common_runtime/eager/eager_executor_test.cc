@@ -16,7 +16,11 @@ limitations under the License.
 
 #include <memory>
 #include <utility>
+#include <vector>
 
+#include "absl/types/span.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/test.h"
@@ -102,6 +106,61 @@ class TestAsyncEagerNode : public AsyncEagerNode {
   Status run_return_status_;
 };
 
+// Blocks the executor until `notification` is notified.
+class BlockingEagerNode : public EagerNode {
+ public:
+  explicit BlockingEagerNode(Notification* notification)
+      : notification_(notification) {}
+
+  Status Run() override {
+    notification_->WaitForNotification();
+    return absl::OkStatus();
+  }
+
+  void Abort(Status status) override {}
+  string DebugString() const override { return "blockingEagerNode"; }
+
+ private:
+  Notification* notification_;
+};
+
+// Runs any run of TestEagerNodes together, by running them one after the
+// other, and records the length of the segments it ran.
+class TestSegmentRunner : public EagerNodeSegmentRunner {
+ public:
+  explicit TestSegmentRunner(Status run_segment_status = absl::OkStatus())
+      : run_segment_status_(run_segment_status) {}
+
+  int SegmentLength(absl::Span<EagerNode* const> nodes) override {
+    int length = 0;
+    while (length < nodes.size() &&
+           nodes[length]->DebugString() == "testEagerNode") {
+      ++length;
+    }
+    return length;
+  }
+
+  Status RunSegment(absl::Span<EagerNode* const> nodes) override {
+    mutex_lock l(mu_);
+    segment_lengths_.push_back(nodes.size());
+    if (!run_segment_status_.ok()) return run_segment_status_;
+    for (EagerNode* node : nodes) {
+      TF_RETURN_IF_ERROR(node->Run());
+    }
+    return absl::OkStatus();
+  }
+
+  std::vector<int> segment_lengths() {
+    mutex_lock l(mu_);
+    return segment_lengths_;
+  }
+
+ private:
+  const Status run_segment_status_;
+  mutex mu_;
+  std::vector<int> segment_lengths_ TF_GUARDED_BY(mu_);
+};
+
 TEST(EagerExecutorTest, TestSyncExecutorWithEagerNode) {
   auto sync_executor = std::make_unique<EagerExecutor>(
       /*async=*/false, /*enable_streaming_enqueue=*/true);
@@ -281,5 +340,60 @@ TEST(EagerExecutorTest, TestAsyncExecutorAddNodesAfterShutdown) {
       async_executor->AddOrExecute(std::move(node)),
       tensorflow::testing::StatusIs(tensorflow::error::FAILED_PRECONDITION));
 }
+
+TEST(EagerExecutorTest, TestAsyncExecutorRunsSegments) {
+  auto async_executor = std::make_unique<EagerExecutor>(
+      /*async=*/true, /*enable_streaming_enqueue=*/true);
+  auto runner = std::make_unique<TestSegmentRunner>();
+  TestSegmentRunner* runner_ptr = runner.get();
+  async_executor->SetSegmentRunner(std::move(runner));
+  ASSERT_TRUE(async_executor->HasSegmentRunner());
+
+  // Hold the executor so that the nodes below queue up behind the blocking
+  // node.
+  Notification notification;
+  TF_ASSERT_OK(async_executor->AddOrExecute(
+      std::make_unique<BlockingEagerNode>(&notification)));
+  std::vector<std::unique_ptr<TestState>> states;
+  for (int i = 0; i < 3; ++i) {
+    states.push_back(std::make_unique<TestState>());
+    TF_ASSERT_OK(async_executor->AddOrExecute(
+        std::make_unique<TestEagerNode>(states.back().get())));
+  }
+  notification.Notify();
+  TF_ASSERT_OK(async_executor->WaitForAllPendingNodes());
+
+  EXPECT_EQ(runner_ptr->segment_lengths(), std::vector<int>({3}));
+  for (const auto& state : states) {
+    EXPECT_EQ(state->read_state(), TestState::State::kSuccess);
+  }
+}
+
+TEST(EagerExecutorTest, TestAsyncExecutorRunsFailedSegmentsNodeByNode) {
+  auto async_executor = std::make_unique<EagerExecutor>(
+      /*async=*/true, /*enable_streaming_enqueue=*/true);
+  auto runner =
+      std::make_unique<TestSegmentRunner>(errors::Unimplemented("test"));
+  TestSegmentRunner* runner_ptr = runner.get();
+  async_executor->SetSegmentRunner(std::move(runner));
+
+  Notification notification;
+  TF_ASSERT_OK(async_executor->AddOrExecute(
+      std::make_unique<BlockingEagerNode>(&notification)));
+  std::vector<std::unique_ptr<TestState>> states;
+  for (int i = 0; i < 3; ++i) {
+    states.push_back(std::make_unique<TestState>());
+    TF_ASSERT_OK(async_executor->AddOrExecute(
+        std::make_unique<TestEagerNode>(states.back().get())));
+  }
+  notification.Notify();
+  TF_ASSERT_OK(async_executor->WaitForAllPendingNodes());
+
+  // After the segment fails, its nodes run one at a time instead.
+  EXPECT_EQ(runner_ptr->segment_lengths(), std::vector<int>({3}));
+  for (const auto& state : states) {
+    EXPECT_EQ(state->read_state(), TestState::State::kSuccess);
+  }
+}
 }  // namespace
 }  // namespace tensorflow
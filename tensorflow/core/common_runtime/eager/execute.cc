@@ -2372,6 +2372,20 @@ Status EagerCopyToDevice(TensorHandle* h, EagerContext* ctx,
   }
 }
 
+Status EagerPrefetchToDevice(TensorHandle* h, EagerContext* ctx,
+                             EagerExecutor* executor, Device* device) {
+  TF_RETURN_IF_ERROR(h->WaitUnknownDevice());
+  if (h->DeviceOrHostCPU(*ctx) == device) return absl::OkStatus();
+  TensorHandle* result = nullptr;
+  TF_RETURN_IF_ERROR(
+      EagerCopyToDevice(h, ctx, executor, device, /*mirror=*/true, &result));
+  // With mirroring, `result` is either `h` itself, which now owns the copy, or
+  // a new handle if a mirror could not be added. Either way the reference
+  // taken for us is not needed.
+  result->Unref();
+  return absl::OkStatus();
+}
+
 namespace {
 // Low-level utility function to execute the kernel specified by `kernel` on
 // `kernel->device()`, with the provided inputs as `op_inputs` in the 'ctx'.
@@ -64,6 +64,15 @@ Status EagerCopyToDevice(TensorHandle* h, EagerContext* ctx,
                          EagerExecutor* executor, Device* device, bool mirror,
                          TensorHandle** result);
 
+// Starts copying `h` to `device` ahead of its consumers, e.g. to bring a
+// remote tensor to local memory while other ops still run. The copy is kept
+// as a mirror of `h`, which ops placed on `device` use instead of copying `h`
+// again. In async mode this does not wait for `h` or for the copy; errors of
+// the copy surface on the consumers of the mirror. Does nothing if `h` is
+// already on, or mirrored to, `device`.
+Status EagerPrefetchToDevice(TensorHandle* h, EagerContext* ctx,
+                             EagerExecutor* executor, Device* device);
+
 // Utility function that executes a fully constructed EagerOperation
 // asynchronously on the local task. This function works differently from
 // EagerExecute in several ways:
@@ -233,6 +233,22 @@ class AsyncExecuteNode : public EagerNode {
     return out;
   }
 
+  AsyncExecuteNode* AsAsyncExecuteNode() override { return this; }
+
+  // For EagerNodeSegmentRunner implementations.
+  EagerContext* ctx() const { return ctx_; }
+  const absl::InlinedVector<TensorHandle*, 4>& inputs() const {
+    return inputs_;
+  }
+  absl::Span<TensorHandle* const> retvals() const { return retvals_; }
+  const core::RefCountPtr<KernelAndDevice>& kernel() const { return kernel_; }
+  // Whether the node runs with function parameters, a graph collector or a
+  // cancellation manager.
+  bool HasRunOptions() const {
+    return eager_func_params_.has_value() || graph_collector_ != nullptr ||
+           cancellation_manager_ != nullptr;
+  }
+
  private:
   EagerContext* ctx_;
   absl::InlinedVector<TensorHandle*, 4> inputs_;
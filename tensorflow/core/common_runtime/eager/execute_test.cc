@@ -18,6 +18,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/framework/full_type.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -428,5 +429,41 @@ TEST(ExecuteTest, MultipleNestedCompiledFunction) {
   ctx->Unref();
 }
 
+TEST(ExecuteTest, PrefetchToDeviceAddsMirror) {
+  SessionOptions options;
+  (*options.config.mutable_device_count())["CPU"] = 2;
+  std::vector<std::unique_ptr<Device>> devices;
+  TF_ASSERT_OK(DeviceFactory::AddDevices(
+      options, "/job:localhost/replica:0/task:0", &devices));
+  StaticDeviceMgr device_mgr(std::move(devices));
+  auto ctx = new EagerContext(
+      SessionOptions(),
+      tensorflow::ContextDevicePlacementPolicy::DEVICE_PLACEMENT_EXPLICIT,
+      false, &device_mgr, false, nullptr, nullptr);
+
+  Device* cpu0 = nullptr;
+  Device* cpu1 = nullptr;
+  TF_ASSERT_OK(device_mgr.LookupDevice(
+      "/job:localhost/replica:0/task:0/device:CPU:0", &cpu0));
+  TF_ASSERT_OK(device_mgr.LookupDevice(
+      "/job:localhost/replica:0/task:0/device:CPU:1", &cpu1));
+  TensorHandle* h = TensorHandle::CreateLocalHandle(
+      test::AsScalar<int64_t>(3), cpu0, cpu0, cpu0, ctx);
+
+  TF_ASSERT_OK(EagerPrefetchToDevice(h, ctx, &ctx->Executor(), cpu1));
+  EXPECT_TRUE(h->HasLocalMirror(cpu1));
+  const Tensor* mirror = nullptr;
+  TF_ASSERT_OK(h->TensorFromDevice(cpu1, &mirror));
+  test::ExpectTensorEqual<int64_t>(*mirror, test::AsScalar<int64_t>(3));
+
+  // Prefetching again, or to the device of the handle, is a no-op.
+  TF_ASSERT_OK(EagerPrefetchToDevice(h, ctx, &ctx->Executor(), cpu1));
+  TF_ASSERT_OK(EagerPrefetchToDevice(h, ctx, &ctx->Executor(), cpu0));
+  EXPECT_FALSE(h->HasLocalMirror(cpu0));
+
+  h->Unref();
+  ctx->Unref();
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -256,6 +256,7 @@ Status KernelAndDeviceFunc::InstantiateFunc(
 
   TF_RETURN_IF_ERROR(
       pflr_->Instantiate(ndef.op(), AttrSlice(ndef), options, &handle_));
+  attrs_ = ndef.attr();
   return pflr_->IsCrossProcess(handle_, &is_cross_process_);
 }
 
@@ -365,6 +365,9 @@ class KernelAndDeviceFunc : public KernelAndDevice {
   int num_outputs() const override { return output_dtypes_.size(); }
   const string& name() const override { return name_; };
 
+  // The attributes the function was instantiated with.
+  const AttrValueMap& attrs() const { return attrs_; }
+
  private:
   std::shared_ptr<FunctionLibraryRuntime::Options> PrepareForRun(
       ScopedStepContainer* step_container, std::vector<EagerKernelRet>* outputs,
@@ -415,6 +418,7 @@ class KernelAndDeviceFunc : public KernelAndDevice {
   DataTypeVector input_dtypes_;
   DataTypeVector output_dtypes_;
   string name_;
+  AttrValueMap attrs_;
 
   Rendezvous::Factory rendezvous_factory_;
   std::function<int64_t()> get_op_id_;
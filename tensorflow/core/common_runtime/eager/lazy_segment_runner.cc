@@ -0,0 +1,330 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/core/common_runtime/eager/lazy_segment_runner.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/eager/context.h"
+#include "tensorflow/core/common_runtime/eager/execute.h"
+#include "tensorflow/core/common_runtime/eager/execute_node.h"
+#include "tensorflow/core/common_runtime/eager/kernel_and_device.h"
+#include "tensorflow/core/common_runtime/eager/tensor_handle.h"
+#include "tensorflow/core/common_runtime/graph_constructor.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/graph_to_functiondef.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/casts.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/util/env_var.h"
+#include "tsl/platform/fingerprint.h"
+
+namespace tensorflow {
+namespace {
+
+// The most ops traced into one segment.
+constexpr int kMaxSegmentLength = 32;
+
+// The prefix of the functions that WrapInCallOp() wraps eager ops in.
+constexpr char kWrappedOpPrefix[] = "__wrapped__";
+
+// Returns the op run by `kernel`, if it is an op kernel or a function that
+// wraps a single op, or nullptr otherwise.
+const OpDef* GetPrimitiveOpDef(EagerContext* ctx, KernelAndDevice* kernel) {
+  string op_name;
+  if (!kernel->IsFunction()) {
+    if (kernel->kernel() == nullptr) return nullptr;
+    op_name = kernel->kernel()->def().op();
+  } else {
+    if (!absl::StartsWith(kernel->name(), kWrappedOpPrefix)) return nullptr;
+    const FunctionDef* fdef = ctx->FuncLibDef()->Find(kernel->name());
+    if (fdef == nullptr || fdef->node_def_size() != 1) return nullptr;
+    op_name = fdef->node_def(0).op();
+  }
+  const OpRegistrationData* op_reg_data = nullptr;
+  if (!OpRegistry::Global()->LookUp(op_name, &op_reg_data).ok()) {
+    return nullptr;
+  }
+  return &op_reg_data->op_def;
+}
+
+// Whether `handle` is a local tensor on `device`, in the canonical form of
+// EagerContext::CanonicalDevice(), that a traced function can take or return.
+bool IsTraceable(const TensorHandle& handle, const Device* device) {
+  return handle.Type() == TensorHandle::LOCAL && handle.device() == device &&
+         handle.dtype != DT_RESOURCE && handle.dtype != DT_VARIANT &&
+         !IsRefType(handle.dtype);
+}
+
+// Whether `node` can be traced into a segment running on its device.
+bool IsTraceable(const AsyncExecuteNode& node) {
+  EagerContext* ctx = node.ctx();
+  KernelAndDevice* kernel = node.kernel().get();
+  if (kernel->IsCrossProcess()) return false;
+  const OpDef* op_def = GetPrimitiveOpDef(ctx, kernel);
+  if (op_def == nullptr || op_def->is_stateful()) return false;
+
+  const Device* device = ctx->CanonicalDevice(kernel->device());
+  if (node.inputs().size() != kernel->num_inputs() ||
+      node.retvals().size() != kernel->num_outputs()) {
+    return false;
+  }
+  for (int i = 0; i < node.inputs().size(); ++i) {
+    if (ctx->CanonicalDevice(kernel->InputDevice(i)) != device ||
+        !IsTraceable(*node.inputs()[i], device)) {
+      return false;
+    }
+  }
+  for (int i = 0; i < node.retvals().size(); ++i) {
+    if (ctx->CanonicalDevice(kernel->OutputDevice(i)) != device ||
+        !IsTraceable(*node.retvals()[i], device)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// A traced segment: the graph of a function that runs the nodes of the
+// segment, with the inputs the nodes take from outside the segment as
+// arguments and all outputs of the nodes as return values.
+struct TracedSegment {
+  GraphDef graph;
+  absl::InlinedVector<TensorHandle*, 4> inputs;
+  std::vector<TensorHandle*> outputs;
+};
+
+TracedSegment TraceSegment(absl::Span<AsyncExecuteNode* const> nodes,
+                           const string& device_name) {
+  TracedSegment segment;
+  // The names of the graph tensors that hold the handles seen so far.
+  absl::flat_hash_map<const TensorHandle*, string> tensor_names;
+  for (int i = 0; i < nodes.size(); ++i) {
+    const AsyncExecuteNode& node = *nodes[i];
+    KernelAndDevice* kernel = node.kernel().get();
+    NodeDef* node_def = segment.graph.add_node();
+    node_def->set_name(absl::StrCat("op", i));
+    node_def->set_device(device_name);
+    if (kernel->IsFunction()) {
+      node_def->set_op(kernel->name());
+      *node_def->mutable_attr() =
+          down_cast<KernelAndDeviceFunc*>(kernel)->attrs();
+    } else {
+      node_def->set_op(kernel->kernel()->def().op());
+      *node_def->mutable_attr() = kernel->kernel()->def().attr();
+    }
+
+    for (TensorHandle* handle : node.inputs()) {
+      auto it = tensor_names.find(handle);
+      if (it == tensor_names.end()) {
+        NodeDef* arg = segment.graph.add_node();
+        arg->set_name(absl::StrCat("arg", segment.inputs.size()));
+        arg->set_op(FunctionLibraryDefinition::kArgOp);
+        arg->set_device(device_name);
+        AddNodeAttr("T", handle->dtype, arg);
+        AddNodeAttr("index", static_cast<int64_t>(segment.inputs.size()), arg);
+        segment.inputs.push_back(handle);
+        it = tensor_names.emplace(handle, arg->name()).first;
+      }
+      node_def->add_input(it->second);
+    }
+
+    for (int o = 0; o < node.retvals().size(); ++o) {
+      TensorHandle* handle = node.retvals()[o];
+      const string tensor_name = absl::StrCat(node_def->name(), ":", o);
+      NodeDef* ret = segment.graph.add_node();
+      ret->set_name(absl::StrCat("ret", segment.outputs.size()));
+      ret->set_op(FunctionLibraryDefinition::kRetOp);
+      ret->set_device(device_name);
+      ret->add_input(tensor_name);
+      AddNodeAttr("T", kernel->output_dtypes()[o], ret);
+      AddNodeAttr("index", static_cast<int64_t>(segment.outputs.size()), ret);
+      segment.outputs.push_back(handle);
+      tensor_names[handle] = tensor_name;
+    }
+  }
+  return segment;
+}
+
+class LazySegmentRunner : public EagerNodeSegmentRunner {
+ public:
+  int SegmentLength(absl::Span<EagerNode* const> nodes) override {
+    EagerContext* ctx = nullptr;
+    Device* device = nullptr;
+    int length = 0;
+    for (EagerNode* node : nodes) {
+      if (length == kMaxSegmentLength) break;
+      AsyncExecuteNode* execute_node = node->AsAsyncExecuteNode();
+      if (execute_node == nullptr || execute_node->HasRunOptions()) break;
+      if (length == 0) {
+        ctx = execute_node->ctx();
+        device = execute_node->kernel()->device();
+        if (device == nullptr) break;
+      } else if (execute_node->ctx() != ctx ||
+                 execute_node->kernel()->device() != device) {
+        break;
+      }
+      if (!IsTraceable(*execute_node)) break;
+      ++length;
+    }
+    return length;
+  }
+
+  Status RunSegment(absl::Span<EagerNode* const> nodes) override {
+    std::vector<AsyncExecuteNode*> execute_nodes;
+    execute_nodes.reserve(nodes.size());
+    for (EagerNode* node : nodes) {
+      execute_nodes.push_back(node->AsAsyncExecuteNode());
+    }
+    EagerContext* ctx = execute_nodes.front()->ctx();
+    Device* device = execute_nodes.front()->kernel()->device();
+    TracedSegment segment = TraceSegment(execute_nodes, device->name());
+
+    string serialized;
+    if (!SerializeToStringDeterministic(segment.graph, &serialized)) {
+      return errors::Internal("Failed to serialize a traced segment");
+    }
+    const Fprint128 cache_key = tsl::FingerprintCat128(
+        Fingerprint128(serialized), Fingerprint128(device->name()));
+    if (failed_segments_.contains(cache_key)) {
+      return errors::Unimplemented("Segment failed to instantiate before");
+    }
+    core::RefCountPtr<KernelAndDevice> kernel = ctx->GetCachedKernel(cache_key);
+    if (kernel == nullptr) {
+      Status status = CreateKernel(ctx, device, cache_key, segment, &kernel);
+      if (!status.ok()) {
+        failed_segments_.insert(cache_key);
+        return status;
+      }
+    }
+    return EagerKernelExecute(ctx, segment.inputs,
+                              /*eager_func_params=*/std::nullopt, kernel,
+                              /*graph_collector=*/nullptr,
+                              /*cancellation_manager=*/nullptr,
+                              absl::MakeSpan(segment.outputs));
+  }
+
+ private:
+  // Instantiates the function of `segment`, and adds its kernel to the kernel
+  // cache of `ctx`.
+  static Status CreateKernel(EagerContext* ctx, Device* device,
+                             const Fprint128& cache_key,
+                             const TracedSegment& segment,
+                             core::RefCountPtr<KernelAndDevice>* kernel) {
+    const string name =
+        absl::StrCat("__lazy_segment_", absl::Hex(cache_key.high64),
+                     "_", absl::Hex(cache_key.low64));
+    if (ctx->FindFunctionDef(name) == nullptr) {
+      Graph graph(ctx->FuncLibDef());
+      GraphConstructorOptions opts;
+      opts.allow_internal_ops = true;
+      TF_RETURN_IF_ERROR(ConvertGraphDefToGraph(opts, segment.graph, &graph));
+      FunctionDef fdef;
+      TF_RETURN_IF_ERROR(GraphToFunctionDef(graph, name, &fdef));
+      TF_RETURN_IF_ERROR(ctx->AddFunctionDef(fdef));
+    }
+
+    FunctionLibraryRuntime* flr = ctx->func_lib(device);
+    if (flr == nullptr) {
+      return errors::NotFound(
+          "Unable to find a FunctionLibraryRuntime corresponding to device ",
+          device->name());
+    }
+    auto runner = flr->runner() != nullptr ? flr->runner() : ctx->runner();
+    std::function<int64_t()> get_op_id = nullptr;
+#if !defined(IS_MOBILE_PLATFORM)
+    get_op_id = [ctx]() { return ctx->RemoteMgr()->NextOpId(); };
+#endif  // IS_MOBILE_PLATFORM
+    core::RefCountPtr<KernelAndDevice> new_kernel(new KernelAndDeviceFunc(
+        flr, ctx->pflr(),
+        std::vector<Device*>(segment.inputs.size(), device),
+        /*composite_devices=*/{}, /*input_resource_dtypes_and_shapes=*/{},
+        runner, ctx->GetCollectiveExecutorHandle(), ctx->HostCPU(), name,
+        /*outputs_on_op_device=*/false,
+        // Segments are small graphs of stateless ops, like the functions
+        // single eager ops are wrapped in.
+        /*allow_small_function_optimizations=*/true,
+        /*allow_control_flow_sync_execution=*/false,
+        /*shape_inference_on_tfe_dialect_import=*/true,
+        /*int_args_and_retvals_on_device=*/false,
+        /*xla_compile_device_type=*/std::nullopt, ctx->AllowSoftPlacement(),
+        ctx->RendezvousFactory(), get_op_id));
+    NodeDef ndef;
+    ndef.set_name(name);
+    ndef.set_op(name);
+    ndef.set_device(device->name());
+    TF_RETURN_IF_ERROR(new_kernel->Init(ctx->LogDevicePlacement(), ndef,
+                                        /*graph_collector=*/nullptr,
+                                        /*eager_func_params=*/std::nullopt));
+
+    // The outputs of the nodes already have their devices, so the function
+    // must place its outputs on them too.
+    if (new_kernel->num_outputs() != segment.outputs.size()) {
+      return errors::Internal(name, " has ", new_kernel->num_outputs(),
+                              " outputs, expected ", segment.outputs.size());
+    }
+    for (int i = 0; i < segment.outputs.size(); ++i) {
+      if (ctx->CanonicalDevice(new_kernel->OutputDevice(i)) !=
+          segment.outputs[i]->device()) {
+        return errors::Unimplemented(name, " places output ", i,
+                                     " on a different device than its op");
+      }
+    }
+    *kernel = ctx->AddKernelToCache(cache_key, std::move(new_kernel));
+    return absl::OkStatus();
+  }
+
+  // The segments that failed to instantiate, which are not retried.
+  absl::flat_hash_set<Fprint128, Fprint128Hasher> failed_segments_;
+};
+
+}  // namespace
+
+bool LazySegmentsEnabled() {
+  static const bool enabled = [] {
+    bool enabled = false;
+    TF_CHECK_OK(
+        ReadBoolFromEnvVar("TF_EAGER_LAZY_SEGMENTS", false, &enabled));
+    return enabled;
+  }();
+  return enabled;
+}
+
+std::unique_ptr<EagerNodeSegmentRunner> CreateLazySegmentRunner() {
+  return std::make_unique<LazySegmentRunner>();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,44 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_LAZY_SEGMENT_RUNNER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_LAZY_SEGMENT_RUNNER_H_
+
+#include <memory>
+
+#include "tensorflow/core/common_runtime/eager/eager_executor.h"
+
+namespace tensorflow {
+
+// Whether async executors should run backlogs of eager ops as segments, see
+// CreateLazySegmentRunner(). Set with the TF_EAGER_LAZY_SEGMENTS environment
+// variable, off by default.
+bool LazySegmentsEnabled();
+
+// Returns a runner that traces sequences of pending async eager ops into a
+// function, and runs them with a single function call instead of one kernel
+// launch per op. The function kernels are cached in the EagerContext, keyed
+// by the traced graph, so repeated sequences are only traced and instantiated
+// once.
+//
+// Only sequences of stateless local ops, placed on the same device, whose
+// inputs and outputs all live on that device, are traced. Ops on resources or
+// variants, and ops run with function parameters or cancellation, are always
+// run one at a time.
+std::unique_ptr<EagerNodeSegmentRunner> CreateLazySegmentRunner();
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_LAZY_SEGMENT_RUNNER_H_
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <deque>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -29,12 +30,14 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/costmodel_manager.h"
 #include "tensorflow/core/common_runtime/entry.h"
 #include "tensorflow/core/common_runtime/executor_factory.h"
+#include "tensorflow/core/common_runtime/frozen_memory_plan.h"
 #include "tensorflow/core/common_runtime/graph_view.h"
 #include "tensorflow/core/common_runtime/immutable_executor_state.h"
 #include "tensorflow/core/common_runtime/pending_counts.h"
 #include "tensorflow/core/common_runtime/propagator_state.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
 #include "tensorflow/core/common_runtime/simple_propagator_state.h"
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
@@ -62,6 +65,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/manual_constructor.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/context.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
@@ -145,13 +149,84 @@ struct KernelTimer {
 typedef gtl::InlinedVector<TensorValue, 4> TensorValueVec;
 typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
 
+// A fixed set of double-ended ready queues used by the work-stealing executor.
+// A worker pushes and pops nodes at the back of its own queue, so that the
+// nodes made ready by a kernel tend to run on the thread that produced their
+// inputs. A worker whose queue is empty steals from the front of the others.
+template <typename T>
+class WorkStealingQueues {
+ public:
+  explicit WorkStealingQueues(int num_queues) : queues_(num_queues) {}
+
+  int num_queues() const { return queues_.size(); }
+
+  void Push(int index, T value) {
+    Queue& queue = queues_[index];
+    mutex_lock l(queue.mu);
+    queue.items.push_back(std::move(value));
+    num_items_.fetch_add(1);
+  }
+
+  // Pops the most recently pushed item of queue `index`, or steals the oldest
+  // item of another queue. Returns nullopt if all queues are empty.
+  absl::optional<T> Pop(int index) {
+    const int n = queues_.size();
+    for (int i = 0; i < n && !Empty(); ++i) {
+      Queue& queue = queues_[(index + i) % n];
+      mutex_lock l(queue.mu);
+      if (queue.items.empty()) continue;
+      absl::optional<T> value;
+      if (i == 0) {
+        value.emplace(std::move(queue.items.back()));
+        queue.items.pop_back();
+      } else {
+        value.emplace(std::move(queue.items.front()));
+        queue.items.pop_front();
+      }
+      num_items_.fetch_sub(1);
+      return value;
+    }
+    return absl::nullopt;
+  }
+
+  bool Empty() const { return num_items_.load() == 0; }
+
+ private:
+  // Aligned to avoid false sharing between the locks of different workers.
+  struct alignas(64) Queue {
+    mutex mu;
+    std::deque<T> items TF_GUARDED_BY(mu);
+  };
+
+  std::vector<Queue> queues_;
+  std::atomic<int64_t> num_items_{0};
+};
+
+// Identifies the work-stealing worker running on the current thread, if any.
+struct WorkStealingWorker {
+  const void* owner = nullptr;
+  int queue = -1;
+};
+thread_local WorkStealingWorker current_work_stealing_worker;
+
 class ExecutorImpl : public Executor {
  public:
-  explicit ExecutorImpl(const LocalExecutorParams& p) : immutable_state_(p) {}
+  // If `work_stealing` is true, nodes made ready by a kernel are queued on a
+  // per-worker deque instead of being handed to the runner one at a time.
+  explicit ExecutorImpl(const LocalExecutorParams& p,
+                        bool work_stealing = false)
+      : immutable_state_(p), work_stealing_(work_stealing) {}
 
   Status Initialize(const Graph& graph) {
     TF_RETURN_IF_ERROR(immutable_state_.Initialize(graph));
-    kernel_stats_.Initialize(immutable_state_.graph_view());
+    kernel_stats_.Initialize(immutable_state_.graph_view(),
+                             immutable_state_.params().cost_profile_steps);
+    const LocalExecutorParams& params = immutable_state_.params();
+    if (params.use_frozen_memory_plan && !params.use_step_arena) {
+      frozen_plan_ = std::make_unique<FrozenMemoryPlan>(
+          params.device->GetAllocator(AllocatorAttributes()),
+          params.frozen_memory_plan_stable_steps);
+    }
     return absl::OkStatus();
   }
 
@@ -166,28 +241,92 @@ class ExecutorImpl : public Executor {
    public:
     KernelStats() = default;
 
-    void Initialize(const GraphView& gview) {
-      is_expensive_.resize(gview.num_nodes());
+    void Initialize(const GraphView& gview, int64_t cost_profile_steps) {
+      num_nodes_ = gview.num_nodes();
+      is_expensive_.resize(num_nodes_);
       cost_estimates_ =
-          std::make_unique<std::atomic_uint_fast64_t[]>(gview.num_nodes());
-      for (int32_t i = 0; i < gview.num_nodes(); ++i) {
+          std::make_unique<std::atomic_uint_fast64_t[]>(num_nodes_);
+      for (int32_t i = 0; i < num_nodes_; ++i) {
         if (gview.node(i)) {
           is_expensive_[i] =
               gview.node(i)->kernel && gview.node(i)->kernel->IsExpensive();
           cost_estimates_[i] = kInitialCostEstimateCycles;
         }
       }
+      if (cost_profile_steps > 0) {
+        cost_profile_steps_ = cost_profile_steps;
+        profile_cycles_ =
+            std::make_unique<std::atomic_uint_fast64_t[]>(num_nodes_);
+        profile_samples_ =
+            std::make_unique<std::atomic_uint_fast32_t[]>(num_nodes_);
+        for (int32_t i = 0; i < num_nodes_; ++i) {
+          profile_cycles_[i] = 0;
+          profile_samples_[i] = 0;
+        }
+        profiling_.store(true, std::memory_order_relaxed);
+      }
     }
 
     // Returns true iff the given node is considered "expensive". The
     // executor uses this flag to optimize graph execution, for example
     // by "inlining" inexpensive kernels.
     bool IsExpensive(const NodeItem& node) const {
+      if (frozen_.load(std::memory_order_acquire)) {
+        return frozen_is_expensive_[node.node_id];
+      }
       return is_expensive_[node.node_id] &&
              (cost_estimates_[node.node_id].load(std::memory_order_relaxed) >
               kOpIsExpensiveThresholdCycles);
     }
 
+    // Returns true while the executor is collecting the per-graph cost
+    // profile, during which every synchronous kernel is timed.
+    bool IsProfiling() const {
+      return profiling_.load(std::memory_order_relaxed);
+    }
+
+    // Adds a timing sample for `node` to the cost profile.
+    void RecordProfileSample(const NodeItem& node, uint64 elapsed_cycles) {
+      profile_cycles_[node.node_id].fetch_add(elapsed_cycles,
+                                              std::memory_order_relaxed);
+      profile_samples_[node.node_id].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Called at the start of every step. After `cost_profile_steps` steps
+    // have started, freezes the inlining decision of every node using the
+    // mean cost measured while profiling. Nodes without samples (e.g.
+    // asynchronous kernels) keep the decision they had at that point.
+    void StartStep() {
+      if (!IsProfiling()) return;
+      if (num_steps_started_.fetch_add(1, std::memory_order_relaxed) !=
+          cost_profile_steps_) {
+        return;
+      }
+      profiling_.store(false, std::memory_order_relaxed);
+      frozen_is_expensive_.resize(num_nodes_);
+      int num_inlined = 0;
+      for (int32_t i = 0; i < num_nodes_; ++i) {
+        const uint64 num_samples =
+            profile_samples_[i].load(std::memory_order_relaxed);
+        if (num_samples > 0) {
+          const uint64 mean_cycles =
+              profile_cycles_[i].load(std::memory_order_relaxed) / num_samples;
+          frozen_is_expensive_[i] =
+              mean_cycles > kOpIsExpensiveThresholdCycles;
+        } else {
+          frozen_is_expensive_[i] =
+              is_expensive_[i] &&
+              cost_estimates_[i].load(std::memory_order_relaxed) >
+                  kOpIsExpensiveThresholdCycles;
+        }
+        if (!frozen_is_expensive_[i]) ++num_inlined;
+      }
+      VLOG(1) << "Froze executor cost profile after " << cost_profile_steps_
+              << " steps: " << num_inlined << " of " << num_nodes_
+              << " nodes will run inline.";
+      frozen_.store(true, std::memory_order_release);
+    }
+
     // Returns the value of kernel->IsExpensive().
     bool HasExpensiveMarker(const NodeItem& node) const {
       return is_expensive_[node.node_id];
@@ -218,13 +357,29 @@ class ExecutorImpl : public Executor {
     static constexpr uint64 kOpIsExpensiveThresholdCycles = 8000;
     static constexpr uint64 kCostDecay = 10;
 
+    int32_t num_nodes_ = 0;
     std::vector<bool> is_expensive_;
     // std::unique_ptr<std::atomic<bool>[]> is_expensive_;
     std::unique_ptr<std::atomic_uint_fast64_t[]> cost_estimates_;
+
+    // Cost profile collected during the first `cost_profile_steps_` steps.
+    int64_t cost_profile_steps_ = 0;
+    std::atomic<int64_t> num_steps_started_{0};
+    std::atomic<bool> profiling_{false};
+    std::unique_ptr<std::atomic_uint_fast64_t[]> profile_cycles_;
+    std::unique_ptr<std::atomic_uint_fast32_t[]> profile_samples_;
+    // Inlining decisions derived from the cost profile. Written once, before
+    // `frozen_` is set, and read-only afterwards.
+    std::vector<bool> frozen_is_expensive_;
+    std::atomic<bool> frozen_{false};
   };
 
   ImmutableExecutorState immutable_state_;
   KernelStats kernel_stats_;
+  // Set iff `LocalExecutorParams::use_frozen_memory_plan` is true and
+  // `LocalExecutorParams::use_step_arena` is false.
+  std::unique_ptr<FrozenMemoryPlan> frozen_plan_;
+  const bool work_stealing_;
 
   ExecutorImpl(const ExecutorImpl&) = delete;
   void operator=(const ExecutorImpl&) = delete;
@@ -284,7 +439,8 @@ class ExecutorState {
  public:
   ExecutorState(const Executor::Args& args,
                 const ImmutableExecutorState& immutable_state_,
-                ExecutorImpl::KernelStats* kernel_stats_);
+                ExecutorImpl::KernelStats* kernel_stats_,
+                FrozenMemoryPlan* frozen_plan, bool work_stealing = false);
   ~ExecutorState();
 
   void RunAsync(Executor::DoneCallback done);
@@ -340,6 +496,22 @@ class ExecutorState {
   // REQUIRES: `!ready->empty()`.
   void ScheduleReady(TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready);
 
+  // Work-stealing variant of `ScheduleReady()`. Inexpensive nodes are moved
+  // into `inline_ready` as usual, while the remaining nodes are pushed onto
+  // the ready queue of the current worker (or spread over all queues when not
+  // called from a worker), waking up idle workers as needed.
+  void ScheduleReadyWorkStealing(TaggedNodeSeq* ready,
+                                 TaggedNodeReadyQueue* inline_ready,
+                                 int64_t scheduled_nsec);
+
+  // Starts up to `num_workers` new workers, without exceeding the number of
+  // work-stealing queues.
+  void MaybeStartWorkers(int num_workers);
+
+  // Runs nodes from the work-stealing queues, starting with `queue`, until all
+  // queues are empty.
+  void WorkerLoop(int queue);
+
   // A wrapper for runner_ to keep track of the pending queue length. Op
   // execution should dispatch work using this function instead of using runner_
   // directly.
@@ -390,17 +562,35 @@ class ExecutorState {
   CallFrameInterface* call_frame_;
   const ImmutableExecutorState& immutable_state_;
   ExecutorImpl::KernelStats* const kernel_stats_;
+  // If not null, the allocations that kernels make with default attributes
+  // are recorded or replayed by `frozen_step_allocator_`. Ended when the step
+  // is deleted.
+  FrozenMemoryPlan* const frozen_plan_;
+  FrozenMemoryPlan::StepAllocator* frozen_step_allocator_ = nullptr;
   CancellationManager* cancellation_manager_;
   tsl::CoordinationServiceAgent* coordination_service_agent_;
   absl::optional<ManagedStackTrace> stack_trace_ = absl::nullopt;
   // If not null, use this device to schedule intra-op operation
   std::unique_ptr<DeviceBase> user_device_;
+  // Set iff `LocalExecutorParams::use_step_arena` is true. Ended when the
+  // step is deleted.
+  StepArenaAllocator* step_arena_ = nullptr;
   Executor::Args::Runner runner_;
   bool sync_on_finish_;
   const bool run_all_kernels_inline_;
 
   PropagatorStateType propagator_;
 
+  // Ready queues of the work-stealing executor, or null if the executor
+  // dispatches every expensive node through `runner_`.
+  typedef std::pair<TaggedNode, int64_t> WorkItem;  // (node, scheduled_nsec)
+  std::unique_ptr<WorkStealingQueues<WorkItem>> work_queues_;
+  // Number of `WorkerLoop()` closures that have been scheduled and not yet
+  // exited. Each live worker also holds one count in `num_outstanding_ops_`,
+  // so that the step cannot finish while a worker still references `this`.
+  std::atomic<int> num_active_workers_{0};
+  std::atomic<uint32> next_worker_queue_{0};
+
   // Invoked when the execution finishes.
   Executor::DoneCallback done_cb_;
 
@@ -419,7 +609,8 @@ class ExecutorState {
 template <class PropagatorStateType>
 ExecutorState<PropagatorStateType>::ExecutorState(
     const Executor::Args& args, const ImmutableExecutorState& immutable_state,
-    ExecutorImpl::KernelStats* kernel_stats)
+    ExecutorImpl::KernelStats* kernel_stats, FrozenMemoryPlan* frozen_plan,
+    bool work_stealing)
     : vlog_(VLOG_IS_ON(1)),
       log_memory_(LogMemory::IsEnabled()),
       step_id_(args.step_id),
@@ -442,6 +633,7 @@ ExecutorState<PropagatorStateType>::ExecutorState(
       call_frame_(args.call_frame),
       immutable_state_(immutable_state),
       kernel_stats_(kernel_stats),
+      frozen_plan_(frozen_plan),
       cancellation_manager_(args.cancellation_manager),
       coordination_service_agent_(args.coordination_service_agent),
       stack_trace_(args.stack_trace),
@@ -455,6 +647,19 @@ ExecutorState<PropagatorStateType>::ExecutorState(
     user_device_ = RenamedDevice::NewRenamedDevice(
         device->name(), device, false, false, args.user_intra_op_threadpool);
   }
+  if (work_stealing && !run_all_kernels_inline_) {
+    work_queues_ = std::make_unique<WorkStealingQueues<WorkItem>>(
+        std::max(1, port::MaxParallelism()));
+  }
+  if (immutable_state.params().use_step_arena) {
+    step_arena_ = StepArenaAllocator::Create(
+        immutable_state.params().device->GetAllocator(AllocatorAttributes()),
+        StepArenaAllocator::Options());
+  }
+  if (frozen_plan_ != nullptr) {
+    // Null if another step is recording the plan.
+    frozen_step_allocator_ = frozen_plan_->StartStep();
+  }
 }
 
 template <class PropagatorStateType>
@@ -463,6 +668,10 @@ ExecutorState<PropagatorStateType>::~ExecutorState() {
     device_context_->Unref();
   }
   delete slice_reader_cache_;
+  if (step_arena_ != nullptr) step_arena_->EndStep();
+  if (frozen_step_allocator_ != nullptr) {
+    frozen_plan_->EndStep(frozen_step_allocator_);
+  }
 }
 
 template <class PropagatorStateType>
@@ -603,6 +812,14 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
         },
         profiler::GetTFTraceMeLevel(is_expensive));
     device->Compute(op_kernel, &ctx);
+  } else if (TF_PREDICT_FALSE(kernel_stats_->IsProfiling())) {
+    KernelTimer timer;
+    device->Compute(op_kernel, &ctx);
+    const uint64 elapsed_cycles = timer.ElapsedCycles();
+    kernel_stats_->RecordProfileSample(item, elapsed_cycles);
+    if (kernel_stats_->HasExpensiveMarker(item)) {
+      kernel_stats_->UpdateCostEstimate(item, elapsed_cycles);
+    }
   } else if (kernel_stats_->HasExpensiveMarker(item)) {
     KernelTimer timer;
     device->Compute(op_kernel, &ctx);
@@ -759,6 +976,11 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
   params->start_time_usecs = start_time_usecs_;
   params->deadline = deadline_;
   params->log_memory = log_memory_;
+  if (step_arena_ != nullptr) {
+    params->step_arena = step_arena_;
+  } else {
+    params->step_arena = frozen_step_allocator_;
+  }
   params->rendezvous = rendezvous_;
   params->collective_executor = collective_executor_;
   params->session_config = session_config_;
@@ -1276,6 +1498,15 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
       profiler::GetTFTraceMeLevel(/*is_expensive=*/false));
   DCHECK(!ready->empty());
 
+  // Start the most critical nodes of the static schedule first.
+  if (immutable_state_.has_scheduling_priorities() && ready->size() > 1) {
+    std::stable_sort(ready->begin(), ready->end(),
+                     [](const TaggedNode& a, const TaggedNode& b) {
+                       return a.node_item->scheduling_priority <
+                              b.node_item->scheduling_priority;
+                     });
+  }
+
   int64_t scheduled_nsec = 0;
   if (stats_collector_) {
     scheduled_nsec = nodestats::NowInNsec();
@@ -1297,6 +1528,8 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
         inline_ready->push_back(tagged_node);
       }
     }
+  } else if (work_queues_ != nullptr) {
+    ScheduleReadyWorkStealing(ready, inline_ready, scheduled_nsec);
   } else {
     const TaggedNode* curr_expensive_node = nullptr;
     TaggedNodeSeq expensive_nodes;
@@ -1374,6 +1607,78 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
   ready->clear();
 }
 
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::ScheduleReadyWorkStealing(
+    TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready,
+    int64_t scheduled_nsec) {
+  const int num_queues = work_queues_->num_queues();
+  const bool on_worker = current_work_stealing_worker.owner == this;
+  int queue = on_worker ? current_work_stealing_worker.queue
+                        : next_worker_queue_.fetch_add(
+                              1, std::memory_order_relaxed) %
+                              num_queues;
+  int num_queued = 0;
+  for (auto& tagged_node : *ready) {
+    if (inline_ready != nullptr &&
+        (tagged_node.get_is_dead() ||
+         !kernel_stats_->IsExpensive(*tagged_node.node_item))) {
+      // Inline this inexpensive node.
+      inline_ready->push_back(tagged_node);
+      continue;
+    }
+    work_queues_->Push(queue, WorkItem(tagged_node, scheduled_nsec));
+    ++num_queued;
+    if (!on_worker) queue = (queue + 1) % num_queues;
+  }
+  // A worker with nothing left to run inline picks up one of the queued nodes
+  // itself when it returns to `WorkerLoop()`.
+  if (on_worker && num_queued > 0 &&
+      (inline_ready == nullptr || inline_ready->empty())) {
+    --num_queued;
+  }
+  MaybeStartWorkers(num_queued);
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::MaybeStartWorkers(int num_workers) {
+  const int num_queues = work_queues_->num_queues();
+  for (int i = 0; i < num_workers; ++i) {
+    int num_active = num_active_workers_.load();
+    do {
+      if (num_active >= num_queues) return;
+    } while (!num_active_workers_.compare_exchange_weak(num_active,
+                                                        num_active + 1));
+    // NOTE: The caller holds a count in `num_outstanding_ops_` (for the node
+    // it is processing, or for the roots), so the count cannot reach zero
+    // here.
+    num_outstanding_ops_.fetch_add(1, std::memory_order_relaxed);
+    const int queue =
+        next_worker_queue_.fetch_add(1, std::memory_order_relaxed) %
+        num_queues;
+    RunTask([this, queue]() { WorkerLoop(queue); });
+  }
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::WorkerLoop(int queue) {
+  profiler::TraceMe activity("ExecutorState::WorkerLoop",
+                             profiler::TraceMeLevel::kVerbose);
+  // Kernels may run nested executors inline, so restore the enclosing worker
+  // (if any) on exit.
+  const WorkStealingWorker enclosing_worker = current_work_stealing_worker;
+  current_work_stealing_worker = {this, queue};
+  while (absl::optional<WorkItem> item = work_queues_->Pop(queue)) {
+    Process(item->first, item->second);
+  }
+  current_work_stealing_worker = enclosing_worker;
+
+  num_active_workers_.fetch_sub(1);
+  // A node may have been queued after the last `Pop()` failed, by a thread
+  // that saw this worker as still active. Make sure that it gets a worker.
+  if (!work_queues_->Empty()) MaybeStartWorkers(1);
+  if (num_outstanding_ops_.fetch_sub(1) == 1) ScheduleFinish();
+}
+
 template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::ScheduleFinish() {
   // Checks condition to decide if needs to invoke Finish(). If there are
@@ -1511,25 +1816,35 @@ void ExecutorState<PropagatorStateType>::Finish() {
 }
 
 void ExecutorImpl::RunAsyncInternal(const Args& args, DoneCallback done) {
-  if (OpOrderDeterminismRequired()) {
+  kernel_stats_.StartStep();
+  if (OpOrderDeterminismRequired() ||
+      immutable_state_.has_scheduling_priorities()) {
     (new ExecutorState<OrderedPropagatorState>(args, immutable_state_,
-                                               &kernel_stats_))
+                                               &kernel_stats_,
+                                               frozen_plan_.get(),
+                                               work_stealing_))
         ->RunAsync(std::move(done));
   } else if (immutable_state_.requires_control_flow_support()) {
-    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_))
+    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_,
+                                        frozen_plan_.get(), work_stealing_))
         ->RunAsync(std::move(done));
   } else {
     (new ExecutorState<SimplePropagatorState>(args, immutable_state_,
-                                              &kernel_stats_))
+                                              &kernel_stats_,
+                                              frozen_plan_.get(),
+                                              work_stealing_))
         ->RunAsync(std::move(done));
   }
 }
 
 }  // namespace
 
-Status NewLocalExecutor(const LocalExecutorParams& params, const Graph& graph,
-                        Executor** executor) {
-  ExecutorImpl* impl = new ExecutorImpl(params);
+namespace {
+
+Status NewLocalExecutorImpl(const LocalExecutorParams& params,
+                            const Graph& graph, bool work_stealing,
+                            Executor** executor) {
+  ExecutorImpl* impl = new ExecutorImpl(params, work_stealing);
   const Status s = impl->Initialize(graph);
   if (s.ok()) {
     *executor = impl;
@@ -1539,6 +1854,14 @@ Status NewLocalExecutor(const LocalExecutorParams& params, const Graph& graph,
   return s;
 }
 
+}  // namespace
+
+Status NewLocalExecutor(const LocalExecutorParams& params, const Graph& graph,
+                        Executor** executor) {
+  return NewLocalExecutorImpl(params, graph, /*work_stealing=*/false,
+                              executor);
+}
+
 Status CreateNonCachedKernel(Device* device, FunctionLibraryRuntime* flib,
                              const std::shared_ptr<const NodeProperties>& props,
                              int graph_def_version, OpKernel** kernel) {
@@ -1574,6 +1897,28 @@ class DefaultExecutorRegistrar {
 };
 static DefaultExecutorRegistrar registrar;
 
+// Registers the "WORK_STEALING" executor type, which runs the same graphs as
+// the default executor but keeps newly ready nodes on per-worker deques.
+class WorkStealingExecutorRegistrar {
+ public:
+  WorkStealingExecutorRegistrar() {
+    ExecutorFactory::Register("WORK_STEALING", new Factory);
+  }
+
+ private:
+  class Factory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      Executor* ret = nullptr;
+      TF_RETURN_IF_ERROR(NewLocalExecutorImpl(params, graph,
+                                              /*work_stealing=*/true, &ret));
+      out_executor->reset(ret);
+      return absl::OkStatus();
+    }
+  };
+};
+static WorkStealingExecutorRegistrar work_stealing_registrar;
+
 }  // namespace
 
 }  // namespace tensorflow
@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/common_runtime/lower_functional_ops.h"
@@ -77,11 +78,15 @@ class ExecutorTest : public ::testing::Test {
     delete exec_;
   }
 
-  // Resets executor_ with a new executor based on a graph 'gdef'.
-  void Create(std::unique_ptr<const Graph> graph) {
+  // Resets executor_ with a new executor based on a graph 'gdef'. If
+  // `executor_type` is non-empty, the executor is created through the
+  // corresponding registered ExecutorFactory.
+  void Create(std::unique_ptr<const Graph> graph,
+              const string& executor_type = "") {
     const int version = graph->versions().producer();
     LocalExecutorParams params;
     params.device = device_.get();
+    params.cost_profile_steps = cost_profile_steps_;
     params.create_kernel =
         [this, version](const std::shared_ptr<const NodeProperties>& props,
                         OpKernel** kernel) {
@@ -93,7 +98,13 @@ class ExecutorTest : public ::testing::Test {
     };
     rendez_ = NewLocalRendezvous();
     delete exec_;
-    TF_CHECK_OK(NewLocalExecutor(params, *graph, &exec_));
+    if (executor_type.empty()) {
+      TF_CHECK_OK(NewLocalExecutor(params, *graph, &exec_));
+    } else {
+      std::unique_ptr<Executor> exec;
+      TF_CHECK_OK(NewExecutor(executor_type, params, *graph, &exec));
+      exec_ = exec.release();
+    }
     runner_ = [this](std::function<void()> fn) { thread_pool_->Schedule(fn); };
   }
 
@@ -106,6 +117,7 @@ class ExecutorTest : public ::testing::Test {
   }
 
   thread::ThreadPool* thread_pool_ = nullptr;
+  int64_t cost_profile_steps_ = 0;
   std::unique_ptr<Device> device_;
   Executor* exec_ = nullptr;
   StepStatsCollector step_stats_collector_;
@@ -266,6 +278,62 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(out));
 }
 
+TEST_F(ExecutorTest, RandomTreeWithCostProfile) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(1024, g.get());
+  cost_profile_steps_ = 2;
+  Create(std::move(g));
+  // Run past the profiling steps, so that later steps use the frozen profile.
+  for (int i = 0; i < 4; ++i) {
+    Rendezvous* rendez = NewLocalRendezvous();
+    Rendezvous::Args args;
+    TF_ASSERT_OK(rendez->Send(Key(ALICE, kIncarnation, BOB, "a"), args,
+                              V(1.0), false));
+    TF_ASSERT_OK(Run(rendez));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(
+        rendez->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+    EXPECT_EQ(1024.0, V(out));
+    rendez->Unref();
+  }
+}
+
+TEST_F(ExecutorTest, WorkStealingSelfAdd) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto v = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  const int N = 10;
+  for (int i = 1; i <= N; ++i) {
+    v = test::graph::Add(g.get(), v, v);
+  }
+  test::graph::Send(g.get(), v, "b", BOB, 1, ALICE);
+  Create(std::move(g), "WORK_STEALING");
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(1024.0, V(out));
+}
+
+TEST_F(ExecutorTest, WorkStealingRandomTree) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  Create(std::move(g), "WORK_STEALING");
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(4096.0, V(out));
+}
+
 void BuildConcurrentAddAssign(Graph* g) {
   auto one = test::graph::Constant(g, V(1.0));
   // A variable holds one float.
@@ -340,6 +408,65 @@ TEST_F(ExecutorTest, SimpleSwitchDead) {
   EXPECT_TRUE(is_dead);
 }
 
+Node* LoopEnter(Graph* g, Node* input, bool is_constant) {
+  Node* ret;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Enter")
+                  .Input(input)
+                  .Attr("frame_name", "loop")
+                  .Attr("is_constant", is_constant)
+                  .Attr("parallel_iterations", 32)
+                  .Finalize(g, &ret));
+  return ret;
+}
+
+TEST_F(ExecutorTest, WhileLoopWithParallelIterations) {
+  // i = x = a
+  // while (i < N) {
+  //   i = i + 1
+  //   x = x + 1
+  // }
+  // b <- x
+  //
+  // The counter `i` runs ahead of `x`, so many iterations are live at once.
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  const int N = 100;
+  auto in = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  auto limit = LoopEnter(g.get(), test::graph::Constant(g.get(), V(N)), true);
+  auto one = LoopEnter(g.get(), test::graph::Constant(g.get(), V(1.0)), true);
+
+  auto i = test::graph::Merge(g.get(), LoopEnter(g.get(), in, false),
+                              {"next_i"});
+  auto x = test::graph::Merge(g.get(), LoopEnter(g.get(), in, false),
+                              {"next_x"});
+  auto cond =
+      test::graph::LoopCond(g.get(), test::graph::Less(g.get(), i, limit));
+  auto switch_i = test::graph::Switch(g.get(), i, cond);
+  auto switch_x = test::graph::Switch(g.get(), x, cond);
+  test::graph::Next(
+      g.get(), "next_i",
+      test::graph::Add(g.get(), test::graph::Identity(g.get(), switch_i, 1),
+                       one));
+  test::graph::Next(
+      g.get(), "next_x",
+      test::graph::Add(g.get(), test::graph::Identity(g.get(), switch_x, 1),
+                       one));
+  test::graph::Exit(g.get(), switch_i);
+  test::graph::Send(g.get(), test::graph::Exit(g.get(), switch_x), "b", BOB, 1,
+                    ALICE);
+  FixupSourceAndSinkEdges(g.get());
+  Create(std::move(g));
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(0.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_FALSE(is_dead);
+  EXPECT_EQ(N, V(out));
+}
+
 TEST_F(ExecutorTest, Abort) {
   // e = a + b + c + d
   auto g = std::make_unique<Graph>(OpRegistry::Global());
@@ -443,7 +570,8 @@ TEST_F(ExecutorTest, NoInputTensors) {
 // Create a graph that is 'depth' deep. At each level, fan-in and fan-out a
 // maximum of 'width' nodes. All nodes are no-ops and all dependencies are
 // control dependencies.
-static void BM_executor(::testing::benchmark::State& state) {
+static void ExecutorBenchmarkHelper(::testing::benchmark::State& state,
+                                    const char* executor_type) {
   const int width = state.range(0);
   const int depth = state.range(1);
 
@@ -477,12 +605,19 @@ static void BM_executor(::testing::benchmark::State& state) {
   }
 
   FixupSourceAndSinkEdges(g);
-  test::Benchmark("cpu", g, /*old_benchmark_api=*/false).Run(state);
+  test::Benchmark("cpu", g, /*options=*/nullptr, /*init=*/nullptr,
+                  /*rendez=*/nullptr, executor_type,
+                  /*old_benchmark_api=*/false)
+      .Run(state);
 
   state.SetLabel(strings::StrCat("Nodes = ", cur));
   state.SetItemsProcessed(cur * static_cast<int64_t>(state.iterations()));
 }
 
+static void BM_executor(::testing::benchmark::State& state) {
+  ExecutorBenchmarkHelper(state, "");
+}
+
 // Tall skinny graphs
 BENCHMARK(BM_executor)->UseRealTime()->ArgPair(16, 1024);
 BENCHMARK(BM_executor)->UseRealTime()->ArgPair(32, 8192);
@@ -494,6 +629,14 @@ BENCHMARK(BM_executor)->UseRealTime()->ArgPair(8192, 32);
 // Tall fat graph
 BENCHMARK(BM_executor)->UseRealTime()->ArgPair(1024, 1024);
 
+static void BM_work_stealing_executor(::testing::benchmark::State& state) {
+  ExecutorBenchmarkHelper(state, "WORK_STEALING");
+}
+
+BENCHMARK(BM_work_stealing_executor)->UseRealTime()->ArgPair(16, 1024);
+BENCHMARK(BM_work_stealing_executor)->UseRealTime()->ArgPair(1024, 16);
+BENCHMARK(BM_work_stealing_executor)->UseRealTime()->ArgPair(1024, 1024);
+
 static void BM_const_identity(::testing::benchmark::State& state) {
   const int width = state.range(0);
   const int outputs_per_const = state.range(1);
@@ -0,0 +1,328 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/frozen_memory_plan.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+size_t RoundUp(size_t value, size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+// Maximum number of unused arenas kept for reuse by later steps.
+constexpr int kMaxPooledArenas = 4;
+
+bool SameAllocations(absl::Span<const PlannedAllocation> a,
+                     absl::Span<const PlannedAllocation> b) {
+  return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                    [](const PlannedAllocation& x, const PlannedAllocation& y) {
+                      return x.size == y.size && x.first_use == y.first_use &&
+                             x.last_use == y.last_use;
+                    });
+}
+
+}  // namespace
+
+size_t ComputeArenaOffsets(absl::Span<const PlannedAllocation> allocations,
+                           size_t alignment, std::vector<int64_t>* offsets) {
+  offsets->assign(allocations.size(), -1);
+  std::vector<size_t> order;
+  order.reserve(allocations.size());
+  for (size_t i = 0; i < allocations.size(); ++i) {
+    if (allocations[i].last_use >= 0 && allocations[i].size > 0) {
+      order.push_back(i);
+    }
+  }
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return allocations[a].size > allocations[b].size;
+  });
+
+  // Indices of the allocations placed so far, sorted by offset.
+  std::vector<size_t> placed;
+  placed.reserve(order.size());
+  size_t arena_size = 0;
+  for (size_t i : order) {
+    const PlannedAllocation& current = allocations[i];
+    size_t offset = 0;
+    for (size_t j : placed) {
+      const PlannedAllocation& other = allocations[j];
+      if (current.first_use > other.last_use ||
+          other.first_use > current.last_use) {
+        // The lifetimes do not overlap, so the memory can be shared.
+        continue;
+      }
+      const size_t other_offset = (*offsets)[j];
+      if (offset + current.size <= other_offset) {
+        // `current` fits in the gap before `other`, and all remaining
+        // allocations start at or after `other`.
+        break;
+      }
+      offset = std::max(offset, RoundUp(other_offset + other.size, alignment));
+    }
+    (*offsets)[i] = offset;
+    arena_size = std::max(arena_size, offset + current.size);
+    auto it = std::upper_bound(
+        placed.begin(), placed.end(), offset,
+        [&](size_t value, size_t j) { return value < (*offsets)[j]; });
+    placed.insert(it, i);
+  }
+  return arena_size;
+}
+
+// The output of one recorded step, shared by all steps that replay it.
+struct FrozenMemoryPlan::Plan {
+  // Indexed by position in the sequence of allocations of the step.
+  std::vector<int64_t> offsets;
+  std::vector<size_t> sizes;
+  size_t arena_size = 0;
+  // The arena, plus the allocations that outlived the recorded step.
+  size_t peak_bytes = 0;
+};
+
+// Arenas that are not used by any step. Shared with the step allocators, which
+// may outlive the FrozenMemoryPlan that created them.
+class FrozenMemoryPlan::ArenaPool {
+ public:
+  explicit ArenaPool(Allocator* base_allocator)
+      : base_allocator_(base_allocator) {}
+
+  ~ArenaPool() {
+    for (const auto& arena : arenas_) {
+      base_allocator_->DeallocateRaw(arena.first);
+    }
+  }
+
+  // Returns an arena of `size` bytes, or nullptr if `size` is zero or the
+  // allocation failed.
+  char* Get(size_t size) {
+    if (size == 0) return nullptr;
+    std::vector<char*> stale;
+    char* result = nullptr;
+    {
+      mutex_lock l(mu_);
+      // Arenas of a different size belong to an outdated plan.
+      for (const auto& arena : arenas_) {
+        if (result == nullptr && arena.second == size) {
+          result = arena.first;
+        } else {
+          stale.push_back(arena.first);
+        }
+      }
+      arenas_.clear();
+    }
+    for (char* arena : stale) {
+      base_allocator_->DeallocateRaw(arena);
+    }
+    if (result != nullptr) return result;
+    return static_cast<char*>(
+        base_allocator_->AllocateRaw(Allocator::kAllocatorAlignment, size));
+  }
+
+  void Put(char* arena, size_t size) {
+    {
+      mutex_lock l(mu_);
+      if (arenas_.size() < kMaxPooledArenas) {
+        arenas_.emplace_back(arena, size);
+        return;
+      }
+    }
+    base_allocator_->DeallocateRaw(arena);
+  }
+
+ private:
+  Allocator* const base_allocator_;
+  mutex mu_;
+  std::vector<std::pair<char*, size_t>> arenas_ TF_GUARDED_BY(mu_);
+};
+
+FrozenMemoryPlan::FrozenMemoryPlan(Allocator* base_allocator,
+                                   int num_stable_steps)
+    : base_allocator_(base_allocator),
+      num_stable_steps_(std::max(1, num_stable_steps)),
+      arena_pool_(std::make_shared<ArenaPool>(base_allocator)) {}
+
+FrozenMemoryPlan::~FrozenMemoryPlan() = default;
+
+FrozenMemoryPlan::StepAllocator* FrozenMemoryPlan::StartStep() {
+  std::shared_ptr<const Plan> plan;
+  {
+    mutex_lock l(mu_);
+    if (plan_ == nullptr) {
+      if (recording_) return nullptr;
+      recording_ = true;
+      return new StepAllocator(base_allocator_, nullptr, arena_pool_);
+    }
+    plan = plan_;
+  }
+  StepAllocator* allocator =
+      new StepAllocator(base_allocator_, plan, arena_pool_);
+  allocator->arena_ = arena_pool_->Get(plan->arena_size);
+  return allocator;
+}
+
+void FrozenMemoryPlan::EndStep(StepAllocator* allocator) {
+  if (allocator->is_recording()) {
+    std::vector<PlannedAllocation> allocations;
+    {
+      mutex_lock l(allocator->mu_);
+      allocator->step_ended_ = true;
+      allocations.swap(allocator->allocations_);
+    }
+    {
+      mutex_lock l(mu_);
+      recording_ = false;
+      if (SameAllocations(allocations, last_recording_)) {
+        ++num_matching_recordings_;
+      } else {
+        num_matching_recordings_ = 1;
+      }
+      if (num_matching_recordings_ < num_stable_steps_) {
+        last_recording_ = std::move(allocations);
+        allocator->Unref();
+        return;
+      }
+      last_recording_.clear();
+      num_matching_recordings_ = 0;
+    }
+    auto plan = std::make_shared<Plan>();
+    plan->arena_size = ComputeArenaOffsets(
+        allocations, Allocator::kAllocatorAlignment, &plan->offsets);
+    plan->peak_bytes = plan->arena_size;
+    plan->sizes.reserve(allocations.size());
+    for (size_t i = 0; i < allocations.size(); ++i) {
+      plan->sizes.push_back(allocations[i].size);
+      if (plan->offsets[i] < 0) plan->peak_bytes += allocations[i].size;
+    }
+    VLOG(1) << "Froze memory plan for " << plan->sizes.size()
+            << " allocations in an arena of " << plan->arena_size
+            << " bytes, with a peak of " << plan->peak_bytes << " bytes.";
+    mutex_lock l(mu_);
+    plan_ = std::move(plan);
+  } else if (allocator->num_mismatches_.load() > 0) {
+    VLOG(1) << "Discarding memory plan after "
+            << allocator->num_mismatches_.load()
+            << " allocations did not match it.";
+    mutex_lock l(mu_);
+    if (plan_ == allocator->plan_) plan_.reset();
+  }
+  allocator->Unref();
+}
+
+bool FrozenMemoryPlan::HasPlan() const {
+  mutex_lock l(mu_);
+  return plan_ != nullptr;
+}
+
+size_t FrozenMemoryPlan::PlannedPeakBytes() const {
+  mutex_lock l(mu_);
+  return plan_ == nullptr ? 0 : plan_->peak_bytes;
+}
+
+FrozenMemoryPlan::StepAllocator::StepAllocator(
+    Allocator* base_allocator, std::shared_ptr<const Plan> plan,
+    std::shared_ptr<ArenaPool> arena_pool)
+    : base_allocator_(base_allocator),
+      plan_(std::move(plan)),
+      arena_pool_(std::move(arena_pool)) {}
+
+FrozenMemoryPlan::StepAllocator::~StepAllocator() {
+  if (arena_ != nullptr) {
+    arena_pool_->Put(arena_, plan_->arena_size);
+  }
+}
+
+void FrozenMemoryPlan::StepAllocator::Unref() {
+  if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) delete this;
+}
+
+void* FrozenMemoryPlan::StepAllocator::AllocateRaw(size_t alignment,
+                                                   size_t num_bytes) {
+  const size_t index = next_allocation_++;
+  if (!is_recording()) {
+    if (index < plan_->offsets.size() && plan_->offsets[index] >= 0 &&
+        arena_ != nullptr) {
+      if (num_bytes <= plan_->sizes[index] &&
+          alignment <= Allocator::kAllocatorAlignment &&
+          TryReserve(plan_->offsets[index], plan_->sizes[index])) {
+        refs_.fetch_add(1, std::memory_order_relaxed);
+        return arena_ + plan_->offsets[index];
+      }
+      ++num_mismatches_;
+    } else if (index >= plan_->offsets.size()) {
+      ++num_mismatches_;
+    }
+  }
+
+  void* ptr = base_allocator_->AllocateRaw(alignment, num_bytes);
+  if (ptr == nullptr) return nullptr;
+  refs_.fetch_add(1, std::memory_order_relaxed);
+  if (is_recording()) {
+    mutex_lock l(mu_);
+    if (!step_ended_) {
+      // Keep the allocation sequence aligned with `next_allocation_`.
+      if (allocations_.size() <= index) allocations_.resize(index + 1);
+      allocations_[index] = {num_bytes, clock_++, -1};
+      live_[ptr] = index;
+    }
+  }
+  return ptr;
+}
+
+bool FrozenMemoryPlan::StepAllocator::TryReserve(size_t offset,
+                                                 size_t size) {
+  const size_t end = offset + size;
+  mutex_lock l(mu_);
+  // Check the live allocation that starts at or after `offset`, and the one
+  // that starts before it.
+  auto next = live_arena_.lower_bound(offset);
+  if (next != live_arena_.end() && next->first < end) return false;
+  if (next != live_arena_.begin() && std::prev(next)->second > offset) {
+    return false;
+  }
+  live_arena_.emplace_hint(next, offset, end);
+  return true;
+}
+
+void FrozenMemoryPlan::StepAllocator::DeallocateRaw(void* ptr) {
+  char* p = static_cast<char*>(ptr);
+  if (arena_ != nullptr && p >= arena_ && p < arena_ + plan_->arena_size) {
+    {
+      mutex_lock l(mu_);
+      live_arena_.erase(p - arena_);
+    }
+    Unref();
+    return;
+  }
+  if (is_recording()) {
+    mutex_lock l(mu_);
+    auto it = live_.find(ptr);
+    if (it != live_.end()) {
+      if (!step_ended_) allocations_[it->second].last_use = clock_++;
+      live_.erase(it);
+    }
+  }
+  base_allocator_->DeallocateRaw(ptr);
+  Unref();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,183 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_FROZEN_MEMORY_PLAN_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_FROZEN_MEMORY_PLAN_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// The size and lifetime of one allocation made during a step. Times are
+// positions in the sequence of allocation and deallocation events of the step.
+struct PlannedAllocation {
+  size_t size = 0;
+  int64_t first_use = 0;
+  // Negative if the allocation was still live at the end of the step.
+  int64_t last_use = -1;
+};
+
+// Assigns an offset in a single arena to each element of `allocations`, such
+// that two allocations whose lifetimes overlap never overlap in memory. Uses
+// the greedy-by-size heuristic of TFLite's ArenaPlanner: the largest
+// allocations are placed first, each at the lowest aligned offset that does
+// not conflict with an already placed allocation.
+//
+// Allocations that outlive the step get offset -1, and must be served by a
+// regular allocator. Returns the size of the arena.
+size_t ComputeArenaOffsets(absl::Span<const PlannedAllocation> allocations,
+                           size_t alignment, std::vector<int64_t>* offsets);
+
+// Supports executors that run a graph with fixed shapes many times, by
+// recording the allocations of one step and then serving the same sequence of
+// allocations from one preplanned arena in subsequent steps.
+//
+// Usage:
+//
+//   FrozenMemoryPlan plan(cpu_allocator());
+//   ...
+//   FrozenMemoryPlan::StepAllocator* allocator = plan.StartStep();
+//   // Run the step, allocating intermediate tensors from `allocator`.
+//   plan.EndStep(allocator);
+//
+// Allocations are matched between steps by their position in the sequence of
+// `AllocateRaw()` calls made to the step allocator, so the caller must make
+// them in a deterministic order (for example, from a single thread, with
+// kernels run in a fixed order). An allocation that does not fit its planned
+// slot is served by the base allocator, and causes the plan to be recomputed
+// from the next step.
+//
+// With `num_stable_steps` > 1, steps are recorded until that many consecutive
+// steps made the same sequence of allocations, with the same lifetimes. This
+// avoids freezing a plan for executors whose allocation order is only
+// deterministic once they have warmed up, and never freezes one when the
+// order varies from step to step.
+//
+// This class is thread-safe. Concurrent steps each get their own arena.
+class FrozenMemoryPlan {
+ public:
+  class StepAllocator;
+
+  // `base_allocator` must outlive this plan and all tensors allocated through
+  // it.
+  explicit FrozenMemoryPlan(Allocator* base_allocator,
+                            int num_stable_steps = 1);
+  ~FrozenMemoryPlan();
+
+  Allocator* base_allocator() const { return base_allocator_; }
+
+  // Returns the allocator to use for the intermediate tensors of one step.
+  // If no plan is available yet, returns an allocator that records the
+  // allocations of the step, or nullptr if another step is already recording;
+  // in that case the caller should use the base allocator.
+  StepAllocator* StartStep();
+
+  // Ends the step started by the `StartStep()` call that returned `allocator`.
+  // Tensors allocated during the step may outlive this call.
+  void EndStep(StepAllocator* allocator);
+
+  // Returns true if subsequent steps will be served from an arena.
+  bool HasPlan() const;
+
+  // Returns the peak memory of the steps that follow the plan: the size of
+  // the arena, plus the tensors that outlive the step. Returns 0 if there is
+  // no plan.
+  size_t PlannedPeakBytes() const;
+
+  FrozenMemoryPlan(const FrozenMemoryPlan&) = delete;
+  void operator=(const FrozenMemoryPlan&) = delete;
+
+ private:
+  struct Plan;
+  class ArenaPool;
+
+  Allocator* const base_allocator_;
+  const int num_stable_steps_;
+  const std::shared_ptr<ArenaPool> arena_pool_;
+
+  mutable mutex mu_;
+  std::shared_ptr<const Plan> plan_ TF_GUARDED_BY(mu_);
+  bool recording_ TF_GUARDED_BY(mu_) = false;
+  // The allocations of the last recorded step, and the number of consecutive
+  // recorded steps that made the same allocations.
+  std::vector<PlannedAllocation> last_recording_ TF_GUARDED_BY(mu_);
+  int num_matching_recordings_ TF_GUARDED_BY(mu_) = 0;
+};
+
+// The allocator used by one step. It deletes itself once the step has ended
+// and all the memory it allocated has been released.
+class FrozenMemoryPlan::StepAllocator : public Allocator {
+ public:
+  std::string Name() override { return "frozen_memory_plan"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+
+ private:
+  friend class FrozenMemoryPlan;
+
+  StepAllocator(Allocator* base_allocator,
+                std::shared_ptr<const Plan> plan,
+                std::shared_ptr<ArenaPool> arena_pool);
+  ~StepAllocator() override;
+
+  bool is_recording() const { return plan_ == nullptr; }
+
+  // Drops one reference, and deletes `this` when none remain.
+  void Unref();
+
+  // Marks `size` bytes at `offset` in the arena as in use. Returns false if
+  // they overlap a live arena allocation.
+  bool TryReserve(size_t offset, size_t size);
+
+  Allocator* const base_allocator_;
+  // Null while recording.
+  const std::shared_ptr<const Plan> plan_;
+  const std::shared_ptr<ArenaPool> arena_pool_;
+  char* arena_ = nullptr;
+
+  // One reference for the step, plus one per live allocation.
+  std::atomic<int64_t> refs_{1};
+
+  std::atomic<size_t> next_allocation_{0};
+  std::atomic<int64_t> num_mismatches_{0};
+
+  mutex mu_;
+  // Replaying state: maps the offset of every live arena allocation to its end
+  // offset. Used to detect when a tensor outlives its planned lifetime, in
+  // which case an overlapping allocation is served by the base allocator.
+  std::map<size_t, size_t> live_arena_ TF_GUARDED_BY(mu_);
+  // Recording state.
+  int64_t clock_ TF_GUARDED_BY(mu_) = 0;
+  bool step_ended_ TF_GUARDED_BY(mu_) = false;
+  std::vector<PlannedAllocation> allocations_ TF_GUARDED_BY(mu_);
+  // Maps each live recorded pointer to its index in `allocations_`.
+  absl::flat_hash_map<void*, size_t> live_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_FROZEN_MEMORY_PLAN_H_
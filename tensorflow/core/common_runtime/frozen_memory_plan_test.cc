@@ -0,0 +1,175 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/frozen_memory_plan.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(ComputeArenaOffsetsTest, DisjointLifetimesShareMemory) {
+  std::vector<PlannedAllocation> allocations = {
+      {/*size=*/128, /*first_use=*/0, /*last_use=*/1},
+      {/*size=*/128, /*first_use=*/2, /*last_use=*/3},
+  };
+  std::vector<int64_t> offsets;
+  EXPECT_EQ(128, ComputeArenaOffsets(allocations, 64, &offsets));
+  EXPECT_EQ(0, offsets[0]);
+  EXPECT_EQ(0, offsets[1]);
+}
+
+TEST(ComputeArenaOffsetsTest, OverlappingLifetimesDoNotOverlap) {
+  std::vector<PlannedAllocation> allocations = {
+      {/*size=*/100, /*first_use=*/0, /*last_use=*/4},
+      {/*size=*/200, /*first_use=*/1, /*last_use=*/2},
+      {/*size=*/50, /*first_use=*/3, /*last_use=*/5},
+  };
+  std::vector<int64_t> offsets;
+  const size_t arena_size = ComputeArenaOffsets(allocations, 64, &offsets);
+  // The largest allocation is placed first, and the others after it.
+  EXPECT_EQ(0, offsets[1]);
+  EXPECT_EQ(256, offsets[0]);
+  // The last allocation only overlaps with the first one in time, so it reuses
+  // the memory of the second one.
+  EXPECT_EQ(0, offsets[2]);
+  EXPECT_EQ(356, arena_size);
+}
+
+TEST(ComputeArenaOffsetsTest, EscapingAllocationsAreNotPlanned) {
+  std::vector<PlannedAllocation> allocations = {
+      {/*size=*/128, /*first_use=*/0, /*last_use=*/-1},
+      {/*size=*/0, /*first_use=*/1, /*last_use=*/2},
+  };
+  std::vector<int64_t> offsets;
+  EXPECT_EQ(0, ComputeArenaOffsets(allocations, 64, &offsets));
+  EXPECT_EQ(-1, offsets[0]);
+  EXPECT_EQ(-1, offsets[1]);
+}
+
+// Allocates the same sequence of tensors as a simple chain of kernels: each
+// step allocates `a` and `b`, frees `a`, allocates `c`, frees `b` and `c`,
+// and returns a newly allocated result.
+Tensor RunStep(Allocator* allocator, std::vector<void*>* buffers) {
+  buffers->clear();
+  Tensor a(allocator, DT_FLOAT, TensorShape({256}));
+  Tensor b(allocator, DT_FLOAT, TensorShape({256}));
+  buffers->push_back(a.data());
+  buffers->push_back(b.data());
+  a = Tensor();
+  Tensor c(allocator, DT_FLOAT, TensorShape({128}));
+  buffers->push_back(c.data());
+  b = Tensor();
+  c = Tensor();
+  return Tensor(allocator, DT_FLOAT, TensorShape({16}));
+}
+
+TEST(FrozenMemoryPlanTest, RecordsAndReplays) {
+  FrozenMemoryPlan plan(cpu_allocator());
+  std::vector<void*> buffers;
+
+  FrozenMemoryPlan::StepAllocator* recording = plan.StartStep();
+  ASSERT_NE(recording, nullptr);
+  // Only one step records at a time.
+  EXPECT_EQ(plan.StartStep(), nullptr);
+  Tensor first_result = RunStep(recording, &buffers);
+  plan.EndStep(recording);
+  EXPECT_TRUE(plan.HasPlan());
+
+  FrozenMemoryPlan::StepAllocator* replay = plan.StartStep();
+  ASSERT_NE(replay, nullptr);
+  Tensor second_result = RunStep(replay, &buffers);
+  plan.EndStep(replay);
+  EXPECT_TRUE(plan.HasPlan());
+  // `b` and `c` were live at the same time, but `a` and `c` were not.
+  char* b = static_cast<char*>(buffers[1]);
+  char* c = static_cast<char*>(buffers[2]);
+  EXPECT_EQ(buffers[0], buffers[2]);
+  EXPECT_TRUE(b >= c + 128 * sizeof(float) || c >= b + 256 * sizeof(float));
+  // The results of the steps outlive them.
+  EXPECT_EQ(16, first_result.NumElements());
+  EXPECT_EQ(16, second_result.NumElements());
+}
+
+TEST(FrozenMemoryPlanTest, WaitsForStableSteps) {
+  FrozenMemoryPlan plan(cpu_allocator(), /*num_stable_steps=*/2);
+  std::vector<void*> buffers;
+  auto record_step = [&](bool run_chain) {
+    FrozenMemoryPlan::StepAllocator* recording = plan.StartStep();
+    ASSERT_NE(recording, nullptr);
+    Tensor result = run_chain
+                        ? RunStep(recording, &buffers)
+                        : Tensor(recording, DT_FLOAT, TensorShape({16}));
+    plan.EndStep(recording);
+  };
+
+  record_step(/*run_chain=*/true);
+  EXPECT_FALSE(plan.HasPlan());
+  // A step with different allocations restarts the count.
+  record_step(/*run_chain=*/false);
+  EXPECT_FALSE(plan.HasPlan());
+  record_step(/*run_chain=*/true);
+  EXPECT_FALSE(plan.HasPlan());
+  EXPECT_EQ(size_t{0}, plan.PlannedPeakBytes());
+  record_step(/*run_chain=*/true);
+  ASSERT_TRUE(plan.HasPlan());
+  // `a` and `c` share memory next to `b`, and the result is not planned.
+  EXPECT_EQ(2 * 256 * sizeof(float) + 16 * sizeof(float),
+            plan.PlannedPeakBytes());
+}
+
+TEST(FrozenMemoryPlanTest, MismatchDiscardsPlan) {
+  FrozenMemoryPlan plan(cpu_allocator());
+  std::vector<void*> buffers;
+
+  FrozenMemoryPlan::StepAllocator* recording = plan.StartStep();
+  RunStep(recording, &buffers);
+  plan.EndStep(recording);
+  ASSERT_TRUE(plan.HasPlan());
+
+  FrozenMemoryPlan::StepAllocator* replay = plan.StartStep();
+  {
+    // Larger than the recorded allocation.
+    Tensor t(replay, DT_FLOAT, TensorShape({1024}));
+    EXPECT_EQ(1024, t.NumElements());
+  }
+  plan.EndStep(replay);
+  EXPECT_FALSE(plan.HasPlan());
+}
+
+TEST(FrozenMemoryPlanTest, LongerLivedTensorIsNotOverwritten) {
+  FrozenMemoryPlan plan(cpu_allocator());
+  std::vector<void*> buffers;
+
+  FrozenMemoryPlan::StepAllocator* recording = plan.StartStep();
+  RunStep(recording, &buffers);
+  plan.EndStep(recording);
+
+  // Keep `a` alive while `c` is allocated, unlike in the recorded step.
+  FrozenMemoryPlan::StepAllocator* replay = plan.StartStep();
+  Tensor a(replay, DT_FLOAT, TensorShape({256}));
+  Tensor b(replay, DT_FLOAT, TensorShape({256}));
+  Tensor c(replay, DT_FLOAT, TensorShape({128}));
+  EXPECT_NE(a.data(), c.data());
+  plan.EndStep(replay);
+  EXPECT_FALSE(plan.HasPlan());
+}
+
+}  // namespace
+}  // namespace tensorflow
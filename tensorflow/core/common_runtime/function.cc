@@ -596,7 +596,7 @@ const FunctionBody* FunctionLibraryRuntimeImpl::GetFunctionBody(Handle h) {
 
 Status FunctionLibraryRuntimeImpl::GetRetTypes(Handle h,
                                                DataTypeVector* ret_types) {
-  if (parent_->IsMultiDevice(h)) {
+  if (parent_->IsMultiDevice(h) || parent_->GetLazyFunctionData(h)) {
     return parent_->GetRetTypes(h, ret_types);
   }
   LocalHandle local_handle = parent_->GetHandleOnDevice(device_name_, h);
@@ -95,6 +95,7 @@ GPUBFCAllocator::GPUBFCAllocator(
           o.garbage_collection = GetGarbageCollectionValue();
         }
         o.fragmentation_fraction = opts.fragmentation_fraction;
+        o.thread_cache_max_bytes = opts.thread_cache_max_bytes;
         return o;
       }()) {}
 
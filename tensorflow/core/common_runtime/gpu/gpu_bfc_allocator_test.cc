@@ -299,6 +299,89 @@ TEST_P(GPUBFCAllocatorTest, AllocationsAndDeallocationsWithGrowth) {
   }
 }
 
+TEST_P(GPUBFCAllocatorTest, ThreadCache) {
+  GPUBFCAllocator::Options options;
+  options.thread_cache_max_bytes = 4096;
+  options.allow_retry_on_failure = false;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 20, "GPU_0_bfc", options);
+
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 64; ++i) {
+    void* raw = a.AllocateRaw(1, 1000);
+    ASSERT_NE(raw, nullptr);
+    ptrs.push_back(raw);
+  }
+  std::sort(ptrs.begin(), ptrs.end());
+  for (size_t i = 1; i < ptrs.size(); ++i) {
+    // Cached chunks are rounded up to their size class.
+    ASSERT_GE(static_cast<char*>(ptrs[i]) - static_cast<char*>(ptrs[i - 1]),
+              1024);
+  }
+  for (void* raw : ptrs) {
+    a.DeallocateRaw(raw);
+  }
+  std::optional<AllocatorStats> stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  const int64_t misses = stats->num_cache_misses;
+  EXPECT_GT(misses, 0);
+  EXPECT_EQ(stats->num_cache_hits + misses, 64);
+
+  // The freed chunks are served again from the cache.
+  ptrs.clear();
+  for (int i = 0; i < 16; ++i) {
+    ptrs.push_back(a.AllocateRaw(1, 1000));
+  }
+  stats = a.GetStats();
+  EXPECT_EQ(stats->num_cache_misses, misses);
+  for (void* raw : ptrs) {
+    a.DeallocateRaw(raw);
+  }
+
+  // Large allocations bypass the cache, and flush it when they would
+  // otherwise run out of memory.
+  void* large = a.AllocateRaw(1, (1 << 20) - 4096);
+  EXPECT_NE(large, nullptr);
+  a.DeallocateRaw(large);
+}
+
+TEST_P(GPUBFCAllocatorTest, Compact) {
+  BFCAllocator::Options options;
+  options.allow_growth = true;
+  options.compaction_threshold = 0.1;
+  BFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", options);
+
+  // Fill a first region, and then a second one.
+  void* p1 = a.AllocateRaw(1, 1 << 20);
+  void* p2 = a.AllocateRaw(1, 1 << 20);
+  void* p3 = a.AllocateRaw(1, 4 << 20);
+  std::optional<AllocatorStats> stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(0.0, *stats->fragmentation);
+  const int64_t pool_bytes = *stats->pool_bytes;
+
+  // Not fragmented enough.
+  a.DeallocateRaw(p3);
+  EXPECT_EQ(size_t{0}, a.Compact());
+
+  // Leaves 1MB free in the first region, and the second region empty.
+  a.DeallocateRaw(p1);
+  stats = a.GetStats();
+  EXPECT_GT(*stats->fragmentation, 0.1);
+  const size_t released_bytes = a.Compact();
+  EXPECT_EQ(size_t{4} << 20, released_bytes);
+  stats = a.GetStats();
+  EXPECT_EQ(pool_bytes - static_cast<int64_t>(released_bytes),
+            *stats->pool_bytes);
+  EXPECT_EQ(0.0, *stats->fragmentation);
+  EXPECT_EQ(1 << 20, stats->largest_free_block_bytes);
+
+  // The released memory can be allocated again.
+  p3 = a.AllocateRaw(1, 8 << 20);
+  EXPECT_NE(p3, nullptr);
+  a.DeallocateRaw(p3);
+  a.DeallocateRaw(p2);
+}
+
 TEST_P(GPUBFCAllocatorTest, DISABLED_AllocatorReceivesZeroMemory) {
   GPUBFCAllocator a(GetParam()(1ul << 62), 1UL << 60, "GPU_0_bfc", {});
   GPUBFCAllocator b(GetParam()(1ul << 62), 1UL << 60, "GPU_0_bfc", {});
@@ -49,8 +49,10 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device/device_event_mgr.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/device_id_utils.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_device.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id_manager.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_managed_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
@@ -572,6 +574,10 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
       options.config.gpu_options().experimental().kernel_tracker_max_pending());
   timestamped_allocator_ =
       options.config.gpu_options().experimental().timestamped_allocator();
+  prefetch_unified_memory_ =
+      options.config.gpu_options().experimental().prefetch_unified_memory() &&
+      (options.config.gpu_options().per_process_gpu_memory_fraction() > 1.0 ||
+       options.config.gpu_options().experimental().use_unified_memory());
   pending_cap_ = tracker_params.max_pending;
   if (timestamped_allocator_ ||
       (tracker_params.max_interval > 0 || tracker_params.max_bytes > 0 ||
@@ -797,6 +803,10 @@ void BaseGPUDevice::Compute(OpKernel* op_kernel, OpKernelContext* context) {
     LogInputs(op_kernel, context);
   }
 
+  if (prefetch_unified_memory_) {
+    PrefetchInputs(context, stream);
+  }
+
   op_kernel->Compute(context);
 
   if (should_log_inputs_and_outputs) {
@@ -883,9 +893,31 @@ void BaseGPUDevice::ComputeAsync(AsyncOpKernel* op_kernel,
   }
 
   ScopedActivateExecutorContext scoped_activation{stream->parent()};
+  if (prefetch_unified_memory_) {
+    PrefetchInputs(context, stream);
+  }
   op_kernel->ComputeAsync(context, std::move(done));
 }
 
+void BaseGPUDevice::PrefetchInputs(OpKernelContext* context,
+                                   se::Stream* stream) {
+  void* gpu_stream = se::gpu::AsGpuStreamValue(stream);
+  for (int i = 0; i < context->num_inputs(); ++i) {
+    if (!context->has_input(i) || context->input_is_ref(i) ||
+        context->input_memory_type(i) != DEVICE_MEMORY) {
+      continue;
+    }
+    const Tensor& input = context->input(i);
+    if (!DMAHelper::CanUseDMA(&input) || input.TotalBytes() == 0) continue;
+    if (!PrefetchManagedMemory(DMAHelper::base(&input), input.TotalBytes(),
+                               accelerator_device_info_->gpu_id,
+                               gpu_stream)) {
+      VLOG(2) << "Could not prefetch input " << i << " of "
+              << context->op_kernel().name();
+    }
+  }
+}
+
 Status BaseGPUDevice::MaybeCopyTensorToGPU(
     const AllocatorAttributes& alloc_attrs, const Tensor& from, Tensor* to,
     StatusCallback done) {
@@ -1001,6 +1033,13 @@ Status BaseGPUDevice::MakeTensorFromProto(const TensorProto& tensor_proto,
                                               n.Notify();
                                             }));
     n.WaitForNotification();
+    if (status.ok() && prefetch_unified_memory_ && !alloc_attrs.on_host() &&
+        tensor->TotalBytes() > 0) {
+      // Constants are never written, so every reader can keep a copy.
+      AdviseManagedMemoryReadMostly(DMAHelper::base(tensor),
+                                    tensor->TotalBytes(),
+                                    accelerator_device_info_->gpu_id);
+    }
     return status;
   }
 }
@@ -206,6 +206,9 @@ class BaseGPUDevice : public LocalDevice {
   std::unique_ptr<GPUKernelTracker> kernel_tracker_;
   int32 pending_cap_ = 0;
   bool timestamped_allocator_ = false;
+  // If true, the device memory is unified memory, and the inputs of every
+  // kernel are prefetched to the device on its stream before it runs.
+  bool prefetch_unified_memory_ = false;
   NodeFileWriter* node_file_writer_ = nullptr;  // not owned
 
   // Initialize scratch buffers used by Eigen.
@@ -217,6 +220,10 @@ class BaseGPUDevice : public LocalDevice {
   std::string ComputeOpKernelDebugString(const OpKernel& op_kernel,
                                          const int& stream_id);
 
+  // Enqueues the migration of the unified memory of the device inputs of
+  // the kernel of `context` to this device on `stream`.
+  void PrefetchInputs(OpKernelContext* context, se::Stream* stream);
+
   // This method returns an initialization status, in addition to
   // calling the "done" StatusCallback, if there is a failure to
   // allocate memory or if the tensor "from" is not DMA-copyable.
@@ -53,4 +53,33 @@ void GpuManagedAllocator::DeallocateRaw(void* ptr) {
 #endif
 }
 
+bool PrefetchManagedMemory(const void* ptr, size_t num_bytes,
+                           int device_ordinal, void* gpu_stream) {
+#if GOOGLE_CUDA
+  return cuMemPrefetchAsync(reinterpret_cast<CUdeviceptr>(ptr), num_bytes,
+                            device_ordinal,
+                            static_cast<CUstream>(gpu_stream)) == CUDA_SUCCESS;
+#elif TENSORFLOW_USE_ROCM
+  return hipMemPrefetchAsync(ptr, num_bytes, device_ordinal,
+                             static_cast<hipStream_t>(gpu_stream)) ==
+         hipSuccess;
+#else
+  return false;
+#endif
+}
+
+bool AdviseManagedMemoryReadMostly(const void* ptr, size_t num_bytes,
+                                   int device_ordinal) {
+#if GOOGLE_CUDA
+  return cuMemAdvise(reinterpret_cast<CUdeviceptr>(ptr), num_bytes,
+                     CU_MEM_ADVISE_SET_READ_MOSTLY,
+                     device_ordinal) == CUDA_SUCCESS;
+#elif TENSORFLOW_USE_ROCM
+  return hipMemAdvise(ptr, num_bytes, hipMemAdviseSetReadMostly,
+                      device_ordinal) == hipSuccess;
+#else
+  return false;
+#endif
+}
+
 }  // namespace tensorflow
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_MANAGED_ALLOCATOR_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_MANAGED_ALLOCATOR_H_
 
+#include <cstddef>
 #include <string>
 
 #include "tsl/framework/allocator.h"
@@ -33,6 +34,20 @@ class GpuManagedAllocator : public tsl::Allocator {
   void DeallocateRaw(void* ptr) override;
 };
 
+// Asynchronously migrates the `num_bytes` of unified memory at `ptr` to the
+// GPU `device_ordinal`, on `gpu_stream` (a CUstream or hipStream_t), so that
+// the kernels enqueued on the stream after it do not fault on its pages one
+// at a time. Returns false if the memory could not be prefetched, e.g.
+// because it is not unified memory.
+bool PrefetchManagedMemory(const void* ptr, size_t num_bytes,
+                           int device_ordinal, void* gpu_stream);
+
+// Advises the driver that the unified memory at `ptr` is mostly read, so
+// that the GPUs reading it keep read-only copies of its pages instead of
+// migrating them back and forth. Returns false if the advice failed.
+bool AdviseManagedMemoryReadMostly(const void* ptr, size_t num_bytes,
+                                   int device_ordinal);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_MANAGED_ALLOCATOR_H_
@@ -21,8 +21,10 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
+#include <limits>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -169,6 +171,8 @@ Allocator* GPUProcessState::GetGPUAllocator(
               !options.experimental().disallow_retry_on_allocation_failure();
           o.fragmentation_fraction =
               options.experimental().internal_fragmentation_fraction();
+          o.thread_cache_max_bytes = std::max<int64_t>(
+              0, options.experimental().bfc_thread_cache_max_bytes());
           return o;
         }());
     Allocator* gpu_allocator = gpu_bfc_allocator.get();
@@ -295,17 +299,8 @@ Allocator* GPUProcessState::GetGpuHostAllocator(const GPUOptions& options,
     // we take a unique lock and populate these vectors.
     tf_shared_lock lock(mu_);
 
-    if (process_state_->ProcessState::FLAGS_brain_gpu_record_mem_types &&
-        !gpu_host_allocators_.empty() &&
-        gpu_host_allocators_[0].recording_allocator != nullptr) {
-      return gpu_host_allocators_[0].recording_allocator.get();
-    }
     if (static_cast<int>(gpu_host_allocators_.size()) > numa_node) {
-#ifdef TF_GPU_USE_PJRT
-      return gpu_host_allocators_[0].allocator_not_owned;
-#else
-      return gpu_host_allocators_[0].allocator.get();
-#endif  // TF_GPU_USE_PJRT
+      return GpuHostAllocatorForNode(numa_node);
     }
   }
 
@@ -357,12 +352,25 @@ Allocator* GPUProcessState::GetGpuHostAllocator(const GPUOptions& options,
         se, numa_node, gpu_host_alloc_visitors_[numa_node],
         gpu_host_free_visitors_[numa_node]);
 
-    tsl::BFCAllocator::Options allocator_opts;
-    allocator_opts.allow_growth =
-        !options.experimental().gpu_host_mem_disallow_growth();
-    tsl::Allocator* allocator =
-        new tsl::BFCAllocator(absl::WrapUnique(sub_allocator), mem_limit_bytes,
-                              /*name=*/"gpu_host_bfc", allocator_opts);
+    tsl::Allocator* allocator;
+    if (options.experimental().gpu_host_use_pool_allocator()) {
+      int64_t watermark_mb =
+          options.experimental().gpu_host_pool_high_watermark_mb();
+      if (watermark_mb <= 0) watermark_mb = 1024;
+      // Buffers are only bounded by the high watermark, not by their count.
+      allocator = new PoolAllocator(
+          /*pool_size_limit=*/std::numeric_limits<size_t>::max(),
+          /*auto_resize=*/false, sub_allocator, new SizeClassRounder,
+          strings::StrCat("gpu_host_pool_", gpu_host_allocators_.size()),
+          /*pooled_bytes_limit=*/watermark_mb * (1LL << 20));
+    } else {
+      tsl::BFCAllocator::Options allocator_opts;
+      allocator_opts.allow_growth =
+          !options.experimental().gpu_host_mem_disallow_growth();
+      allocator = new tsl::BFCAllocator(
+          absl::WrapUnique(sub_allocator), mem_limit_bytes,
+          /*name=*/"gpu_host_bfc", allocator_opts);
+    }
 
     if (LogMemory::IsEnabled() && !allocator->TracksAllocationSizes()) {
       // Wrap the allocator to track allocation ids for better logging
@@ -399,15 +407,19 @@ Allocator* GPUProcessState::GetGpuHostAllocator(const GPUOptions& options,
               md, &mu_);
     }
   }
+  return GpuHostAllocatorForNode(numa_node);
+}
+
+Allocator* GPUProcessState::GpuHostAllocatorForNode(int numa_node) {
+  AllocatorParts& allocator_parts = gpu_host_allocators_[numa_node];
   if (process_state_->ProcessState::FLAGS_brain_gpu_record_mem_types) {
-    return gpu_host_allocators_[0].recording_allocator.get();
-  } else {
+    return allocator_parts.recording_allocator.get();
+  }
 #ifdef TF_GPU_USE_PJRT
-    return gpu_host_allocators_[0].allocator_not_owned;
+  return allocator_parts.allocator_not_owned;
 #else
-    return gpu_host_allocators_[0].allocator.get();
+  return allocator_parts.allocator.get();
 #endif  // TF_GPU_USE_PJRT
-  }
 }
 
 void GPUProcessState::AddGPUAllocVisitor(int bus_id,
@@ -152,6 +152,11 @@ class GPUProcessState {
     return nullptr;
   }
 
+  // Returns the already created GPU host allocator for `numa_node`, so that
+  // devices stage their transfers in pinned memory local to their socket.
+  Allocator* GpuHostAllocatorForNode(int numa_node)
+      TF_SHARED_LOCKS_REQUIRED(mu_);
+
   static GPUProcessState* instance_;
   ProcessState* process_state_;  // Not owned.
   bool gpu_device_enabled_;
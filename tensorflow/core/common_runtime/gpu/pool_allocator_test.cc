@@ -17,9 +17,13 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/pool_allocator.h"
 
+#include <cstring>
+#include <vector>
+
 #include "xla/stream_executor/gpu/gpu_init.h"
 #include "xla/stream_executor/platform_manager.h"
 #include "tensorflow/core/common_runtime/device/device_host_allocator.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/test.h"
 namespace tensorflow {
@@ -242,6 +246,73 @@ TEST(PoolAllocatorTest, Pow2Rounder) {
   EXPECT_EQ(65536, rounder.RoundUp(65536));
 }
 
+TEST(PoolAllocatorTest, SizeClassRounder) {
+  SizeClassRounder rounder;
+  EXPECT_EQ(1, rounder.RoundUp(1));
+  EXPECT_EQ(8, rounder.RoundUp(7));
+  EXPECT_EQ(9, rounder.RoundUp(9));
+  EXPECT_EQ(18, rounder.RoundUp(17));
+  EXPECT_EQ(45056, rounder.RoundUp(41234));
+  EXPECT_EQ(65536, rounder.RoundUp(65535));
+  EXPECT_EQ(65536, rounder.RoundUp(65536));
+  EXPECT_EQ(73728, rounder.RoundUp(65537));
+  // The waste is bounded by an eighth of the request.
+  for (size_t n = 16; n < 100000; n += 7) {
+    EXPECT_LE(rounder.RoundUp(n), n + n / 8) << n;
+  }
+}
+
+TEST(PoolAllocatorTest, PooledBytesLimit) {
+  PoolAllocator pool(
+      100 /*pool_size_limit*/, false /*auto_resize*/,
+      new BasicCPUAllocator(port::kNUMANoAffinity, {}, {}), new NoopRounder,
+      "pool", 4096 /*pooled_bytes_limit*/);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 4; ++i) {
+    ptrs.push_back(pool.AllocateRaw(4, 1024));
+  }
+  for (void* p : ptrs) {
+    pool.DeallocateRaw(p);
+  }
+  // Each buffer holds 1024 bytes plus its ChunkPrefix, so only three of them
+  // fit under the limit.
+  EXPECT_EQ(4, pool.put_count());
+  EXPECT_EQ(1, pool.evicted_count());
+  EXPECT_EQ(3 * (1024 + 2 * sizeof(void*)), pool.pooled_bytes());
+  void* p = pool.AllocateRaw(4, 1024);
+  EXPECT_EQ(1, pool.get_from_pool_count());
+  EXPECT_EQ(2 * (1024 + 2 * sizeof(void*)), pool.pooled_bytes());
+  pool.DeallocateRaw(p);
+  pool.Clear();
+  EXPECT_EQ(size_t{0}, pool.pooled_bytes());
+}
+
+TEST(BasicCPUAllocatorTest, HugePages) {
+  constexpr size_t kHugePageSize = 2 << 20;
+  BasicCPUAllocator allocator(port::kNUMANoAffinity, {}, {},
+                              kHugePageSize /*huge_page_min_bytes*/);
+  size_t bytes_received = 0;
+  void* small = allocator.Alloc(64, 4096, &bytes_received);
+  EXPECT_EQ(size_t{4096}, bytes_received);
+  EXPECT_EQ(size_t{0},
+            allocator.hugetlb_bytes() + allocator.thp_advised_bytes());
+
+  void* large = allocator.Alloc(64, 3 << 20, &bytes_received);
+  ASSERT_NE(nullptr, large);
+#if defined(__linux__)
+  // Rounded up to whole huge pages.
+  EXPECT_EQ(2 * kHugePageSize, bytes_received);
+  EXPECT_EQ(uintptr_t{0}, reinterpret_cast<uintptr_t>(large) % kHugePageSize);
+  EXPECT_EQ(bytes_received,
+            allocator.hugetlb_bytes() + allocator.thp_advised_bytes());
+#endif  // defined(__linux__)
+  memset(large, 1, bytes_received);
+  allocator.Free(large, bytes_received);
+  allocator.Free(small, 4096);
+  EXPECT_EQ(size_t{0},
+            allocator.hugetlb_bytes() + allocator.thp_advised_bytes());
+}
+
 TEST(PoolAllocatorTest, Name) {
   se::Platform* platform =
       se::PlatformManager::PlatformWithName(se::GpuPlatformName()).value();
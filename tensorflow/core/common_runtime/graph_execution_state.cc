@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/optimization_registry.h"
 #include "tensorflow/core/common_runtime/placer.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/cost_graph.pb.h"
 #include "tensorflow/core/framework/device_factory.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/function.pb.h"
@@ -50,6 +51,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/device_name_utils.h"
@@ -57,6 +59,7 @@ limitations under the License.
 
 #ifndef IS_MOBILE_PLATFORM
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
+#include "tensorflow/core/grappler/costs/profiled_op_level_cost_estimator.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/optimizers/meta_optimizer.h"
 #endif  // IS_MOBILE_PLATFORM
@@ -802,7 +805,23 @@ Status GraphExecutionState::OptimizeGraph(
 
     // Construct a virtual cluster and find the cpu_device, which the
     // ConstantFolding optimizer will use for partial evaluation of the graph.
-    grappler::VirtualCluster cluster(device_set_);
+    // With a cost profile, the cluster simulates the graph with the costs
+    // measured for the profiled nodes.
+    std::unique_ptr<grappler::VirtualCluster> cluster;
+    const string& cost_profile_path = session_options_->config.graph_options()
+                                          .rewrite_options()
+                                          .experimental_cost_profile_path();
+    if (cost_profile_path.empty()) {
+      cluster = std::make_unique<grappler::VirtualCluster>(device_set_);
+    } else {
+      CostGraphDef cost_profile;
+      TF_RETURN_IF_ERROR(ReadTextOrBinaryProto(
+          Env::Default(), cost_profile_path, &cost_profile));
+      cluster = std::make_unique<grappler::VirtualCluster>(
+          device_set_,
+          std::make_unique<grappler::ProfiledOpLevelCostEstimator>(
+              cost_profile));
+    }
     Device* cpu_device = nullptr;
     for (const auto& device : device_set_->devices()) {
       if (device->parsed_name().id == 0 &&
@@ -816,7 +835,7 @@ Status GraphExecutionState::OptimizeGraph(
     GraphDef new_graph;
     TF_RETURN_IF_ERROR(
         grappler::RunMetaOptimizer(std::move(item), session_options_->config,
-                                   cpu_device, &cluster, &new_graph));
+                                   cpu_device, cluster.get(), &new_graph));
 
     // Merge optimized graph function library with an original library.
     // Optimized graph might have new functions specialized for it's
@@ -60,6 +60,11 @@ struct NodeItem {
   // The index of this node's item in its GraphView.
   int node_id = -1;
 
+  // The rank of this node in the static schedule computed by Grappler (the
+  // "_scheduling_priority" attr), or 0 if the node has none. When several
+  // nodes are ready, the ones with the lowest rank are run first.
+  int32 scheduling_priority = 0;
+
   // Cached attributes of this node for fast lookup.
   bool kernel_is_async : 1;     // True iff kernel->AsAsync() != nullptr
   bool is_merge : 1;            // True iff IsMerge(node)
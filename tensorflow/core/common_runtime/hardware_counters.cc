@@ -0,0 +1,118 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/hardware_counters.h"
+
+#include <cstdint>
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif  // defined(__linux__)
+
+namespace tensorflow {
+
+#if defined(__linux__)
+namespace {
+
+constexpr int kNumCounters = 3;
+
+int OpenCounter(uint64_t config, int group_fd) {
+  perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.size = sizeof(attr);
+  attr.config = config;
+  attr.read_format = PERF_FORMAT_GROUP;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return syscall(__NR_perf_event_open, &attr, /*pid=*/0, /*cpu=*/-1, group_fd,
+                 /*flags=*/0);
+}
+
+// The counters of one thread, read together as a perf event group whose
+// leader counts cycles.
+class ThreadCounters {
+ public:
+  ThreadCounters() {
+    fds_[0] = OpenCounter(PERF_COUNT_HW_CPU_CYCLES, /*group_fd=*/-1);
+    if (fds_[0] < 0) {
+      VLOG(1) << "Hardware counters are not available: " << strerror(errno);
+      return;
+    }
+    fds_[1] = OpenCounter(PERF_COUNT_HW_INSTRUCTIONS, fds_[0]);
+    fds_[2] = OpenCounter(PERF_COUNT_HW_CACHE_MISSES, fds_[0]);
+    available_ = fds_[1] >= 0 && fds_[2] >= 0;
+  }
+
+  ~ThreadCounters() {
+    for (int fd : fds_) {
+      if (fd >= 0) close(fd);
+    }
+  }
+
+  bool Read(HardwareCounters::Values* values) {
+    if (!available_) return false;
+    // With PERF_FORMAT_GROUP, the leader returns the number of counters
+    // followed by their values in the order they were added to the group.
+    uint64_t buffer[1 + kNumCounters];
+    if (read(fds_[0], buffer, sizeof(buffer)) != sizeof(buffer) ||
+        buffer[0] != kNumCounters) {
+      return false;
+    }
+    values->cycles = buffer[1];
+    values->instructions = buffer[2];
+    values->llc_misses = buffer[3];
+    return true;
+  }
+
+ private:
+  int fds_[kNumCounters] = {-1, -1, -1};
+  bool available_ = false;
+};
+
+}  // namespace
+#endif  // defined(__linux__)
+
+bool HardwareCounters::Enabled() {
+  static const bool enabled = [] {
+    bool enabled = false;
+    Status status =
+        ReadBoolFromEnvVar("TF_COLLECT_HARDWARE_COUNTERS", false, &enabled);
+    if (!status.ok()) {
+      LOG(ERROR) << status.message();
+    }
+    return enabled;
+  }();
+  return enabled;
+}
+
+bool HardwareCounters::ReadForCurrentThread(Values* values) {
+#if defined(__linux__)
+  static thread_local ThreadCounters counters;
+  return counters.Read(values);
+#else
+  return false;
+#endif  // defined(__linux__)
+}
+
+}  // namespace tensorflow
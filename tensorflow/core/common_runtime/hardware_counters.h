@@ -0,0 +1,55 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HARDWARE_COUNTERS_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HARDWARE_COUNTERS_H_
+
+#include <cstdint>
+
+namespace tensorflow {
+
+// Names under which the counters are reported, e.g. in
+// `NodeExecStats.hardware_counters`.
+inline constexpr char kHardwareCounterCycles[] = "cycles";
+inline constexpr char kHardwareCounterInstructions[] = "instructions";
+inline constexpr char kHardwareCounterLlcMisses[] = "llc_misses";
+
+// Reads CPU hardware performance counters of the calling thread.
+//
+// The counters are opened lazily through perf_event_open the first time a
+// thread reads them and count user-space events of that thread only. They are
+// only available on Linux, and only if the kernel allows it (see
+// /proc/sys/kernel/perf_event_paranoid).
+class HardwareCounters {
+ public:
+  struct Values {
+    int64_t cycles = 0;
+    int64_t instructions = 0;
+    // Last level cache misses.
+    int64_t llc_misses = 0;
+  };
+
+  // Returns true if per-op hardware counter collection was requested by
+  // setting the environment variable TF_COLLECT_HARDWARE_COUNTERS=true.
+  static bool Enabled();
+
+  // Reads the current counter values of the calling thread into `values`.
+  // Returns false if the counters are not available on this thread.
+  static bool ReadForCurrentThread(Values* values);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HARDWARE_COUNTERS_H_
@@ -0,0 +1,42 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/hardware_counters.h"
+
+#include <cstdint>
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(HardwareCountersTest, CountersAreMonotonic) {
+  HardwareCounters::Values before;
+  if (!HardwareCounters::ReadForCurrentThread(&before)) {
+    GTEST_SKIP() << "Hardware counters are not available.";
+  }
+  volatile int64_t sum = 0;
+  for (int i = 0; i < 100000; ++i) {
+    sum += i;
+  }
+  HardwareCounters::Values after;
+  ASSERT_TRUE(HardwareCounters::ReadForCurrentThread(&after));
+  EXPECT_GT(after.cycles, before.cycles);
+  EXPECT_GT(after.instructions, before.instructions);
+  EXPECT_GE(after.llc_misses, before.llc_misses);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,312 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_reducer.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+namespace tensorflow {
+namespace {
+
+string HierarchicalReduceBufKey(const string& exec_key, int phase, int step,
+                                int src_rank) {
+  return strings::StrCat("HierarchicalReduce(", exec_key, "):phase(", phase,
+                         "):step(", step, "):srcrank(", src_rank, ")");
+}
+
+// Returns the part of the flat tensor `t` made of chunks [first, last), where
+// every chunk but the trailing ones has `chunk_elts` elements.
+Tensor ChunkRange(const Tensor& t, int64_t chunk_elts, int first, int last) {
+  const int64_t num_elts = t.NumElements();
+  const int64_t start = std::min(num_elts, chunk_elts * first);
+  const int64_t limit = std::min(num_elts, chunk_elts * last);
+  // As in CollectiveAdapter::ChunkAlias, empty chunks alias the front of the
+  // tensor.
+  return start < limit ? t.Slice(start, limit) : t.Slice(0, 0);
+}
+
+int PositionOf(const std::vector<int>& ranks, int rank) {
+  return std::find(ranks.begin(), ranks.end(), rank) - ranks.begin();
+}
+
+}  // namespace
+
+/*static*/
+void HierarchicalReducer::GetRings(const CollectiveParams& cp, int rank,
+                                   std::vector<int>* local_ranks,
+                                   std::vector<int>* cross_ranks) {
+  // The devices of a task are adjacent in the group.
+  std::vector<std::vector<int>> task_ranks;
+  int task = -1;
+  int pos = -1;
+  for (int r = 0; r < cp.group.group_size; ++r) {
+    if (r == 0 || cp.group.members[r].task != cp.group.members[r - 1].task) {
+      task_ranks.emplace_back();
+    }
+    if (r == rank) {
+      task = task_ranks.size() - 1;
+      pos = task_ranks.back().size();
+    }
+    task_ranks.back().push_back(r);
+  }
+  local_ranks->clear();
+  cross_ranks->clear();
+  if (task < 0) return;
+  *local_ranks = task_ranks[task];
+  for (const std::vector<int>& ranks : task_ranks) {
+    if (pos < ranks.size()) cross_ranks->push_back(ranks[pos]);
+  }
+}
+
+Status HierarchicalReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  const CollGroupParams& group = col_params->group;
+  absl::flat_hash_set<string> tasks;
+  std::vector<int> devices_per_task;
+  for (int r = 0; r < group.group_size; ++r) {
+    const string& task = group.members[r].task;
+    if (r == 0 || task != group.members[r - 1].task) {
+      if (!tasks.insert(task).second) {
+        return errors::InvalidArgument(
+            "HierarchicalReduce requires the devices of a task to be adjacent "
+            "in the group, but those of ",
+            task, " are not in collective ", col_params->name);
+      }
+      devices_per_task.push_back(0);
+    }
+    ++devices_per_task.back();
+  }
+  for (int count : devices_per_task) {
+    if (count != devices_per_task[0]) {
+      return errors::InvalidArgument(
+          "HierarchicalReduce requires the same number of devices on every "
+          "task, but collective ",
+          col_params->name, " has tasks with ", devices_per_task[0], " and ",
+          count, " devices");
+    }
+  }
+  return OkStatus();
+}
+
+Status HierarchicalReducer::InitializeCollectiveContext(
+    std::shared_ptr<CollectiveContext> col_ctx) {
+  CHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = col_ctx->col_params.get();
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+void HierarchicalReducer::Run(StatusCallback done) {
+  CHECK(col_ctx_);
+  CHECK(col_params_);
+  col_ctx_->col_exec->UnblockDependencies(*col_params_);
+
+  // Start by copying input to output if they're not already the same.
+  if ((col_ctx_->input != col_ctx_->output) &&
+      (DMAHelper::base(col_ctx_->input) != DMAHelper::base(col_ctx_->output))) {
+    Notification note;
+    Status status;
+    profiler::TraceMe activity("MemCpyAsync", profiler::TraceMeLevel::kInfo);
+    CollectiveRemoteAccessLocal::MemCpyAsync(
+        col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->op_device_context(), col_ctx_->device,
+        col_ctx_->device, col_ctx_->op_ctx->input_alloc_attr(0),
+        col_ctx_->op_ctx->output_alloc_attr(0), col_ctx_->input,
+        col_ctx_->output, 0 /*dev_to_dev_stream_index*/,
+        [&note, &status](const Status& s) {
+          status.Update(s);
+          note.Notify();
+        });
+    note.WaitForNotification();
+    if (!status.ok()) {
+      done(status);
+      return;
+    }
+  }
+
+  std::vector<int> local_ranks;
+  std::vector<int> cross_ranks;
+  GetRings(*col_params_, col_params_->default_rank, &local_ranks,
+           &cross_ranks);
+  const int num_local = local_ranks.size();
+  const int num_cross = cross_ranks.size();
+  const int local_pos = PositionOf(local_ranks, col_params_->default_rank);
+  const int cross_pos = PositionOf(cross_ranks, col_params_->default_rank);
+
+  // The output is cut into num_local parts, one per device of a task, and
+  // each of them into num_cross pieces, one per task.
+  AllocatorAttributes attr = col_ctx_->op_ctx->output_alloc_attr(0);
+  ca_.reset(MakeCollectiveAdapter(col_ctx_->output, num_local * num_cross,
+                                  col_ctx_->device->GetAllocator(attr)));
+  const Tensor& flat = ca_->Value();
+  const int64_t chunk_elts = CollectiveAdapter::AlignedChunkElts(
+      DataTypeSize(flat.dtype()), flat.NumElements(), num_local * num_cross);
+  std::vector<Tensor> local_parts;
+  for (int i = 0; i < num_local; ++i) {
+    local_parts.push_back(
+        ChunkRange(flat, chunk_elts, i * num_cross, (i + 1) * num_cross));
+  }
+  const int part = (local_pos + 1) % num_local;
+  std::vector<Tensor> cross_pieces;
+  for (int i = 0; i < num_cross; ++i) {
+    const int chunk = part * num_cross + i;
+    cross_pieces.push_back(ChunkRange(flat, chunk_elts, chunk, chunk + 1));
+  }
+
+  Status status = RingReduceScatter(0, local_ranks, local_pos, &local_parts);
+  if (status.ok()) {
+    status = RingReduceScatter(1, cross_ranks, cross_pos, &cross_pieces);
+  }
+  if (status.ok()) {
+    // Every piece of the output is now fully reduced on exactly one device.
+    status = Finalize(&cross_pieces[(cross_pos + 1) % num_cross]);
+  }
+  if (status.ok()) {
+    status = RingAllGather(2, cross_ranks, cross_pos, &cross_pieces);
+  }
+  if (status.ok()) {
+    status = RingAllGather(3, local_ranks, local_pos, &local_parts);
+  }
+  ca_->ConsumeFinalValue(col_ctx_->output);
+  ca_.reset();
+  done(status);
+}
+
+Status HierarchicalReducer::RingReduceScatter(int phase,
+                                              const std::vector<int>& ranks,
+                                              int pos,
+                                              std::vector<Tensor>* pieces) {
+  const int n = ranks.size();
+  for (int step = 0; step < n - 1; ++step) {
+    const Tensor& send = (*pieces)[(pos - step + n) % n];
+    Tensor* reduce = &(*pieces)[(pos - step - 1 + n) % n];
+    Tensor tmp(col_ctx_->device->GetAllocator(
+                   col_ctx_->op_ctx->output_alloc_attr(0)),
+               reduce->dtype(), reduce->shape());
+    TF_RETURN_IF_ERROR(SendRecv(phase, step, ranks[(pos + 1) % n], send,
+                                ranks[(pos - 1 + n) % n], &tmp));
+    TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+        col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+        col_params_->merge_op, reduce, &tmp));
+  }
+  return OkStatus();
+}
+
+Status HierarchicalReducer::RingAllGather(int phase,
+                                          const std::vector<int>& ranks,
+                                          int pos,
+                                          std::vector<Tensor>* pieces) {
+  const int n = ranks.size();
+  for (int step = 0; step < n - 1; ++step) {
+    TF_RETURN_IF_ERROR(SendRecv(phase, step, ranks[(pos + 1) % n],
+                                (*pieces)[(pos + 1 - step + n) % n],
+                                ranks[(pos - 1 + n) % n],
+                                &(*pieces)[(pos - step + n) % n]));
+  }
+  return OkStatus();
+}
+
+Status HierarchicalReducer::SendRecv(int phase, int step, int send_to,
+                                     const Tensor& send, int recv_from,
+                                     Tensor* recv) {
+  const CollGroupMember& dst = col_params_->group.members[send_to];
+  const CollGroupMember& src = col_params_->group.members[recv_from];
+  Notification send_note;
+  Notification recv_note;
+  Status send_status;
+  Status recv_status;
+  // A failed transfer aborts the executor, so that the transfers that would
+  // otherwise wait for it complete too.
+  auto abort_on_error = [this](const Status& s) {
+    if (!s.ok()) col_ctx_->col_exec->StartAbort(s);
+  };
+  col_ctx_->col_exec->remote_access()->PostToPeer(
+      dst.device.name(), dst.task,
+      HierarchicalReduceBufKey(col_ctx_->exec_key, phase, step,
+                               col_params_->default_rank),
+      col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+      col_ctx_->op_ctx->output_alloc_attr(0), &send,
+      col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
+      [&](const Status& s) {
+        abort_on_error(s);
+        send_status = s;
+        send_note.Notify();
+      });
+  col_ctx_->col_exec->remote_access()->RecvFromPeer(
+      src.device.name(), src.task, src.is_local,
+      HierarchicalReduceBufKey(col_ctx_->exec_key, phase, step, recv_from),
+      col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+      col_ctx_->op_ctx->output_alloc_attr(0), recv, col_ctx_->device_locality,
+      0 /*dev_to_dev_stream_index*/, col_ctx_->op_ctx->cancellation_manager(),
+      [&](const Status& s) {
+        abort_on_error(s);
+        recv_status = s;
+        recv_note.Notify();
+      });
+  send_note.WaitForNotification();
+  recv_note.WaitForNotification();
+  TF_RETURN_IF_ERROR(send_status);
+  return recv_status;
+}
+
+Status HierarchicalReducer::Finalize(Tensor* chunk) {
+  if (col_params_->final_op == nullptr) return OkStatus();
+  Tensor group_size = ca_->Scalar(col_params_->group.group_size);
+  if (col_params_->group.device_type != "CPU") {
+    Tensor group_size_on_device = ca_->Scalar(
+        col_ctx_->device->GetAllocator(col_ctx_->op_ctx->input_alloc_attr(0)),
+        AllocationAttributes());
+    Notification note;
+    Status status;
+    col_ctx_->op_ctx->op_device_context()->CopyCPUTensorToDevice(
+        &group_size, col_ctx_->device, &group_size_on_device,
+        [&note, &status](const Status& s) {
+          status = s;
+          note.Notify();
+        });
+    note.WaitForNotification();
+    TF_RETURN_IF_ERROR(status);
+    group_size = group_size_on_device;
+  }
+  return collective_util::ComputeBinOp(
+      col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+      col_params_->final_op, chunk, &group_size);
+}
+
+namespace {
+REGISTER_COLLECTIVE(HierarchicalReduce, HierarchicalReducer);
+}  // namespace
+
+}  // namespace tensorflow
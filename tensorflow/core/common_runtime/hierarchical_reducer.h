@@ -0,0 +1,87 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+
+namespace tensorflow {
+
+// Hierarchical implementation of collective all-reduce for groups that span
+// several tasks with the same number of devices each.
+//
+// With L devices per task and T tasks, the reduction runs in three phases:
+//  1. A ring reduce-scatter among the L devices of each task, after which
+//     each device holds 1/L of the task-local sum.
+//  2. A ring all-reduce of that 1/L across the T devices, one per task,
+//     that hold the same part.
+//  3. A ring all-gather among the L devices of each task.
+// Only phase 2 crosses tasks, and it runs as L parallel rings that each
+// carry 1/L of the tensor.
+class HierarchicalReducer : public CollectiveImplementationInterface {
+ public:
+  HierarchicalReducer() = default;
+  ~HierarchicalReducer() override = default;
+
+  // Checks that every task of the group has the same number of devices, and
+  // that the devices of a task are adjacent in the group.
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  // Initializes members of CollectiveContext not yet initialized, i.e. device
+  // and device_locality.  Also saves the CollectiveContext in this object.
+  Status InitializeCollectiveContext(
+      std::shared_ptr<CollectiveContext> col_ctx) override;
+
+  // Begins execution of the hierarchical reduction.
+  // Must be called in a blockable thread.
+  void Run(StatusCallback done) override;
+
+  // Populates `local_ranks` with the ranks of the devices on the task of
+  // `rank`, and `cross_ranks` with the ranks of the devices that have the
+  // same position as `rank` on every task, both in group order.
+  static void GetRings(const CollectiveParams& cp, int rank,
+                       std::vector<int>* local_ranks,
+                       std::vector<int>* cross_ranks);
+
+ private:
+  // Ring reduce-scatter of `pieces` among `ranks`, in which this device is at
+  // `pos`. Afterwards the device holds the reduction of pieces[pos + 1].
+  Status RingReduceScatter(int phase, const std::vector<int>& ranks, int pos,
+                           std::vector<Tensor>* pieces);
+
+  // Ring all-gather of `pieces` among `ranks`, in which the device at `pos`
+  // holds pieces[pos + 1].
+  Status RingAllGather(int phase, const std::vector<int>& ranks, int pos,
+                       std::vector<Tensor>* pieces);
+
+  // Sends `send` to the device at `send_to` and receives `recv` from the
+  // device at `recv_from`, concurrently, and waits for both.
+  Status SendRecv(int phase, int step, int send_to, const Tensor& send,
+                  int recv_from, Tensor* recv);
+
+  // Applies final_op to `chunk`, a part of the reduced output.
+  Status Finalize(Tensor* chunk);
+
+  std::shared_ptr<CollectiveContext> col_ctx_;
+  const CollectiveParams* col_params_;  // Not owned
+  std::unique_ptr<CollectiveAdapter> ca_;
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
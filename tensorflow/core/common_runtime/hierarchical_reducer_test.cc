@@ -0,0 +1,181 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_reducer.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/collective_test_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+std::unique_ptr<OpKernel> GetBinOp(const string& op, DataType dtype,
+                                   const DeviceType& device_type,
+                                   DeviceBase* device) {
+  NodeDef node_def;
+  NodeDefBuilder builder("bin_op", op);
+  TF_CHECK_OK(builder.Attr("T", dtype)
+                  .Input(FakeInput(dtype))
+                  .Input(FakeInput(dtype))
+                  .Finalize(&node_def));
+  Status status;
+  std::unique_ptr<OpKernel> k = CreateOpKernel(
+      device_type, device, device->GetAllocator(AllocatorAttributes()),
+      node_def, TF_GRAPH_DEF_VERSION, &status);
+  TF_CHECK_OK(status);
+  return k;
+}
+
+class HierarchicalReducerTest : public ::testing::Test {
+ protected:
+  struct DeviceInstance {
+    Device* device;
+    Tensor tensor;
+    core::RefCountPtr<CollectiveParams> col_params;
+    std::unique_ptr<OpKernel> merge_op;
+    std::unique_ptr<OpKernel> final_op;
+    Status status;
+  };
+
+  void Init(int num_workers, int num_devices, int tensor_len,
+            int fail_after) {
+    test_env_ = CreateCollectiveTestEnv(num_workers, num_devices, DEVICE_CPU);
+    test_env_->remote_access->set_fail_after(fail_after);
+    expected_.assign(tensor_len, 0);
+    for (int rank = 0; rank < num_workers * num_devices; ++rank) {
+      auto instance = std::make_unique<DeviceInstance>();
+      instance->col_params = CreateCollectiveParams(
+          *test_env_, rank, "HierarchicalReduce", REDUCTION_COLLECTIVE,
+          DT_FLOAT, TensorShape({tensor_len}));
+      const string& dev_name =
+          instance->col_params->group.members[rank].device.name();
+      TF_CHECK_OK(
+          test_env_->device_mgr->LookupDevice(dev_name, &instance->device));
+      instance->merge_op =
+          GetBinOp("Add", DT_FLOAT, DEVICE_CPU, instance->device);
+      instance->final_op =
+          GetBinOp("Div", DT_FLOAT, DEVICE_CPU, instance->device);
+      instance->col_params->merge_op = instance->merge_op.get();
+      instance->col_params->final_op = instance->final_op.get();
+      instance->tensor = Tensor(DT_FLOAT, TensorShape({tensor_len}));
+      for (int i = 0; i < tensor_len; ++i) {
+        const float value = rank * 10 + i;
+        instance->tensor.flat<float>()(i) = value;
+        expected_[i] += value;
+      }
+      instances_.push_back(std::move(instance));
+    }
+    for (float& value : expected_) {
+      value /= instances_.size();
+    }
+  }
+
+  void Reduce() {
+    std::atomic<int> done(0);
+    for (auto& instance : instances_) {
+      SchedClosure([this, &instance, &done] {
+        instance->status =
+            RunCollective(test_env_.get(), instance->col_params.get(),
+                          instance->device, &instance->tensor,
+                          &instance->tensor);
+        ++done;
+      });
+    }
+    while (done < static_cast<int>(instances_.size())) {
+      Env::Default()->SleepForMicroseconds(1000);
+    }
+  }
+
+  void RunTest(int num_workers, int num_devices, int tensor_len) {
+    Init(num_workers, num_devices, tensor_len, /*fail_after=*/0);
+    Reduce();
+    for (const auto& instance : instances_) {
+      TF_EXPECT_OK(instance->status);
+      test::ExpectTensorEqual<float>(test::AsTensor<float>(expected_),
+                                     instance->tensor);
+    }
+  }
+
+  std::unique_ptr<CollectiveTestEnv> test_env_;
+  std::vector<std::unique_ptr<DeviceInstance>> instances_;
+  std::vector<float> expected_;
+};
+
+TEST_F(HierarchicalReducerTest, GetRings) {
+  test_env_ = CreateCollectiveTestEnv(/*num_workers=*/3, /*num_devices=*/2,
+                                      DEVICE_CPU);
+  core::RefCountPtr<CollectiveParams> cp = CreateCollectiveParams(
+      *test_env_, /*rank=*/3, "HierarchicalReduce", REDUCTION_COLLECTIVE,
+      DT_FLOAT, TensorShape({8}));
+  std::vector<int> local_ranks;
+  std::vector<int> cross_ranks;
+  HierarchicalReducer::GetRings(*cp, /*rank=*/3, &local_ranks, &cross_ranks);
+  EXPECT_EQ(local_ranks, std::vector<int>({2, 3}));
+  EXPECT_EQ(cross_ranks, std::vector<int>({1, 3, 5}));
+}
+
+TEST_F(HierarchicalReducerTest, UnevenTasksAreRejected) {
+  test_env_ = CreateCollectiveTestEnv(/*num_workers=*/2, /*num_devices=*/2,
+                                      DEVICE_CPU);
+  core::RefCountPtr<CollectiveParams> cp = CreateCollectiveParams(
+      *test_env_, /*rank=*/0, "HierarchicalReduce", REDUCTION_COLLECTIVE,
+      DT_FLOAT, TensorShape({8}));
+  cp->group.members.pop_back();
+  --cp->group.group_size;
+  core::RefCountPtr<HierarchicalReducer> reducer(new HierarchicalReducer());
+  EXPECT_TRUE(
+      errors::IsInvalidArgument(reducer->InitializeCollectiveParams(cp.get())));
+}
+
+TEST_F(HierarchicalReducerTest, SingleWorker) { RunTest(1, 4, 1001); }
+
+TEST_F(HierarchicalReducerTest, SingleDevicePerWorker) { RunTest(3, 1, 1001); }
+
+TEST_F(HierarchicalReducerTest, MultipleWorkers) { RunTest(2, 4, 4095); }
+
+TEST_F(HierarchicalReducerTest, FewerElementsThanDevices) {
+  RunTest(2, 4, 3);
+}
+
+TEST_F(HierarchicalReducerTest, Abort) {
+  Init(/*num_workers=*/2, /*num_devices=*/2, /*tensor_len=*/1001,
+       /*fail_after=*/3);
+  Reduce();
+  for (const auto& instance : instances_) {
+    EXPECT_NE(instance->status.message().find("Deliberate failure"),
+              string::npos)
+        << instance->status;
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
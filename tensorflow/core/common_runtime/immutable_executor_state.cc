@@ -197,6 +197,13 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
     item->is_next_iteration = IsNextIteration(n);
     item->is_distributed_communication = IsDistributedCommunication(n);
 
+    int64_t scheduling_priority;
+    if (TryGetNodeAttr(n->attrs(), "_scheduling_priority",
+                       &scheduling_priority)) {
+      item->scheduling_priority = static_cast<int32>(scheduling_priority);
+      has_scheduling_priorities_ = true;
+    }
+
     // Compute the maximum values we'll store for this node in the
     // pending counts data structure, and allocate a handle in
     // that frame's pending counts data structure that has enough
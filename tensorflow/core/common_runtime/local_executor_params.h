@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_LOCAL_EXECUTOR_PARAMS_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_LOCAL_EXECUTOR_PARAMS_H_
 
+#include <cstdint>
 #include <functional>
 #include <memory>
 
@@ -50,6 +51,33 @@ struct LocalExecutorParams {
 
   // Whether control flow nodes are allowed to be executed synchronously.
   bool allow_control_flow_sync_execution = false;
+
+  // If positive, the executor times every synchronous kernel during its first
+  // `cost_profile_steps` steps, and then uses the resulting per-node cost
+  // profile to fix which nodes run inline for all later steps, instead of
+  // continuously re-estimating kernel costs.
+  int64_t cost_profile_steps = 0;
+
+  // If true, the executor records the sizes and lifetimes of the tensors that
+  // kernels allocate with default attributes, and once
+  // `frozen_memory_plan_stable_steps` consecutive steps made the same
+  // allocations, serves them from one preplanned arena in later steps (see
+  // FrozenMemoryPlan). Only suitable for graphs whose shapes do not change
+  // between steps. The default executor ignores it if `use_step_arena` is
+  // set.
+  bool use_frozen_memory_plan = false;
+  int frozen_memory_plan_stable_steps = 1;
+
+  // If true, the executor serves the allocations that kernels make with
+  // default attributes from a StepArenaAllocator that is created for each
+  // step. Not supported by the single-threaded executor.
+  bool use_step_arena = false;
+
+  // If true, the single-threaded executor plans the memory of the outputs
+  // whose shapes are known statically when it is created, and serves them
+  // from one arena per step at the planned offsets. Ignored if
+  // `use_frozen_memory_plan` is set, and by other executors.
+  bool use_static_memory_plan = false;
 };
 
 }  // end namespace tensorflow
@@ -125,35 +125,53 @@ class PendingCounts {
       return NodeStateForStruct(Packed(h)->load(std::memory_order_relaxed));
     }
   }
+  // These are only used for debugging, but other threads may concurrently
+  // adjust the counts of a merge node, so they update the counts atomically.
   void mark_started(Handle h) {
     DCHECK_EQ(pending(h), 0);
     if (h.is_large_) {
       std::atomic<LargeCounts>* c_ptr = Large(h);
-      auto c = c_ptr->load(std::memory_order_relaxed);
-      DCHECK_EQ(c.has_started, 0);
-      c.has_started = 1;
-      c_ptr->store(c, std::memory_order_relaxed);
+      auto old_val = c_ptr->load(std::memory_order_relaxed);
+      while (true) {
+        DCHECK_EQ(old_val.has_started, 0);
+        auto new_val = old_val;
+        new_val.has_started = 1;
+        if (TF_PREDICT_TRUE(c_ptr->compare_exchange_weak(old_val, new_val)))
+          return;
+      }
     } else {
       std::atomic<PackedCounts>* c_ptr = Packed(h);
-      auto c = c_ptr->load(std::memory_order_relaxed);
-      DCHECK_EQ(c.has_started, 0);
-      c.has_started = 1;
-      c_ptr->store(c, std::memory_order_relaxed);
+      auto old_val = c_ptr->load(std::memory_order_relaxed);
+      while (true) {
+        DCHECK_EQ(old_val.has_started, 0);
+        auto new_val = old_val;
+        new_val.has_started = 1;
+        if (TF_PREDICT_TRUE(c_ptr->compare_exchange_weak(old_val, new_val)))
+          return;
+      }
     }
   }
   void mark_completed(Handle h) {
     if (h.is_large_) {
       std::atomic<LargeCounts>* c_ptr = Large(h);
-      auto c = c_ptr->load(std::memory_order_relaxed);
-      DCHECK_EQ(c.has_started, 1);
-      c.pending = 1;
-      c_ptr->store(c, std::memory_order_relaxed);
+      auto old_val = c_ptr->load(std::memory_order_relaxed);
+      while (true) {
+        DCHECK_EQ(old_val.has_started, 1);
+        auto new_val = old_val;
+        new_val.pending = 1;
+        if (TF_PREDICT_TRUE(c_ptr->compare_exchange_weak(old_val, new_val)))
+          return;
+      }
     } else {
       std::atomic<PackedCounts>* c_ptr = Packed(h);
-      auto c = c_ptr->load(std::memory_order_relaxed);
-      DCHECK_EQ(c.has_started, 1);
-      c.pending = 1;
-      c_ptr->store(c, std::memory_order_relaxed);
+      auto old_val = c_ptr->load(std::memory_order_relaxed);
+      while (true) {
+        DCHECK_EQ(old_val.has_started, 1);
+        auto new_val = old_val;
+        new_val.pending = 1;
+        if (TF_PREDICT_TRUE(c_ptr->compare_exchange_weak(old_val, new_val)))
+          return;
+      }
     }
   }
   int pending(Handle h) {
@@ -22,6 +22,7 @@ limitations under the License.
 #include <sys/mman.h>  // for munmap
 #endif
 
+#include <algorithm>
 #include <map>
 #include <utility>
 
@@ -37,11 +38,13 @@ namespace tensorflow {
 
 PoolAllocator::PoolAllocator(size_t pool_size_limit, bool auto_resize,
                              SubAllocator* allocator,
-                             RoundUpInterface* size_rounder, string name)
+                             RoundUpInterface* size_rounder, string name,
+                             size_t pooled_bytes_limit)
     : name_(std::move(name)),
       has_size_limit_(pool_size_limit > 0),
       auto_resize_(auto_resize),
       pool_size_limit_(pool_size_limit),
+      pooled_bytes_limit_(pooled_bytes_limit),
       allocator_(allocator),
       size_rounder_(size_rounder) {
   if (auto_resize) {
@@ -120,6 +123,7 @@ void* PoolAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
         pr = iter->second;
         RemoveFromList(pr);
         pool_.erase(iter);
+        pooled_bytes_ -= pr->num_bytes;
         // Fall out of lock scope and do the result without the lock held.
       }
     }
@@ -130,11 +134,27 @@ void* PoolAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
     return PrepareChunk(r, alignment, num_bytes);
   } else {
     size_t bytes_received;
-    void* ptr = allocator_->Alloc(kPoolAlignment, num_bytes, &bytes_received);
+    void* ptr = AllocateChunk(num_bytes, &bytes_received);
+    if (ptr == nullptr) return nullptr;
     return PrepareChunk(ptr, alignment, bytes_received);
   }
 }
 
+void* PoolAllocator::AllocateChunk(size_t num_bytes, size_t* bytes_received) {
+  void* ptr = allocator_->Alloc(kPoolAlignment, num_bytes, bytes_received);
+  if (ptr != nullptr || !has_size_limit_) return ptr;
+  {
+    mutex_lock lock(mutex_);
+    if (lru_tail_ == nullptr) return nullptr;
+    VLOG(1) << name_ << ": releasing " << pooled_bytes_
+            << " pooled bytes after failing to allocate " << num_bytes;
+    while (lru_tail_ != nullptr) {
+      EvictOne();
+    }
+  }
+  return allocator_->Alloc(kPoolAlignment, num_bytes, bytes_received);
+}
+
 void PoolAllocator::DeallocateRaw(void* ptr) {
   if (ptr == nullptr) return;
   ChunkPrefix* cp = FindPrefix(ptr);
@@ -152,6 +172,10 @@ void PoolAllocator::DeallocateRaw(void* ptr) {
     pr->ptr = cp;
     AddToList(pr);
     pool_.insert(std::make_pair(cp->num_bytes, pr));
+    pooled_bytes_ += pr->num_bytes;
+    while (pooled_bytes_limit_ > 0 && pooled_bytes_ > pooled_bytes_limit_) {
+      EvictOne();
+    }
   }
 }
 
@@ -168,6 +192,7 @@ void PoolAllocator::Clear() {
     put_count_ = 0;
     allocated_count_ = 0;
     evicted_count_ = 0;
+    pooled_bytes_ = 0;
     lru_head_ = nullptr;
     lru_tail_ = nullptr;
   }
@@ -214,6 +239,7 @@ void PoolAllocator::EvictOne() {
     DCHECK(iter != pool_.end());
   }
   pool_.erase(iter);
+  pooled_bytes_ -= prec->num_bytes;
   allocator_->Free(prec->ptr, prec->num_bytes);
   delete prec;
   ++evicted_count_;
@@ -259,6 +285,57 @@ void PoolAllocator::EvictOne() {
   }
 }
 
+namespace {
+// The size of a huge page on x86-64 and most aarch64 configurations.
+constexpr size_t kHugePageSize = 2 << 20;
+}  // namespace
+
+void* BasicCPUAllocator::AllocHugePages(size_t alignment, size_t num_bytes,
+                                        size_t* bytes_received) {
+#if defined(__linux__)
+  const size_t size = (num_bytes + kHugePageSize - 1) & ~(kHugePageSize - 1);
+  void* ptr = nullptr;
+  bool hugetlb = false;
+  // Reserved huge pages are aligned to kHugePageSize.
+  if (alignment <= kHugePageSize &&
+      !hugetlb_unavailable_.load(std::memory_order_relaxed)) {
+    ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (ptr == MAP_FAILED) {
+      ptr = nullptr;
+      if (!hugetlb_unavailable_.exchange(true)) {
+        LOG(INFO) << "No reserved huge pages available (" << strerror(errno)
+                  << "), using transparent huge pages for large CPU "
+                  << "allocations instead.";
+      }
+    } else {
+      hugetlb = true;
+    }
+  }
+  if (ptr == nullptr) {
+    // Transparent huge pages only back ranges aligned to kHugePageSize.
+    ptr = port::AlignedMalloc(
+        size, static_cast<int>(std::max(alignment, kHugePageSize)));
+    if (ptr == nullptr) return nullptr;
+    if (madvise(ptr, size, MADV_HUGEPAGE) != 0) {
+      VLOG(1) << "madvise(MADV_HUGEPAGE) failed: " << strerror(errno);
+    }
+  }
+  (hugetlb ? hugetlb_bytes_ : thp_advised_bytes_)
+      .fetch_add(size, std::memory_order_relaxed);
+  {
+    mutex_lock l(mu_);
+    huge_page_allocations_[ptr] = {size, hugetlb};
+  }
+  VLOG(2) << "Allocated " << size << " bytes at " << ptr << " on "
+          << (hugetlb ? "reserved" : "transparent") << " huge pages";
+  *bytes_received = size;
+  return ptr;
+#else
+  return nullptr;
+#endif  // defined(__linux__)
+}
+
 void* BasicCPUAllocator::Alloc(size_t alignment, size_t num_bytes,
                                size_t* bytes_received) {
   tsl::profiler::TraceMe traceme("BasicCPUAllocator::Alloc");
@@ -266,13 +343,19 @@ void* BasicCPUAllocator::Alloc(size_t alignment, size_t num_bytes,
   void* ptr = nullptr;
   *bytes_received = num_bytes;
   if (num_bytes > 0) {
-    if (numa_node_ == port::kNUMANoAffinity) {
-      ptr = port::AlignedMalloc(num_bytes, static_cast<int>(alignment));
-    } else {
-      ptr =
-          port::NUMAMalloc(numa_node_, num_bytes, static_cast<int>(alignment));
+    if (huge_page_min_bytes_ > 0 && num_bytes >= huge_page_min_bytes_ &&
+        numa_node_ == port::kNUMANoAffinity) {
+      ptr = AllocHugePages(alignment, num_bytes, bytes_received);
+    }
+    if (ptr == nullptr) {
+      if (numa_node_ == port::kNUMANoAffinity) {
+        ptr = port::AlignedMalloc(num_bytes, static_cast<int>(alignment));
+      } else {
+        ptr = port::NUMAMalloc(numa_node_, num_bytes,
+                               static_cast<int>(alignment));
+      }
     }
-    VisitAlloc(ptr, numa_node_, num_bytes);
+    VisitAlloc(ptr, numa_node_, *bytes_received);
   }
   return ptr;
 }
@@ -282,6 +365,29 @@ void BasicCPUAllocator::Free(void* ptr, size_t num_bytes) {
 
   if (num_bytes > 0) {
     VisitFree(ptr, numa_node_, num_bytes);
+    if (huge_page_min_bytes_ > 0 && num_bytes >= huge_page_min_bytes_) {
+      std::pair<size_t, bool> allocation = {0, false};
+      {
+        mutex_lock l(mu_);
+        auto it = huge_page_allocations_.find(ptr);
+        if (it != huge_page_allocations_.end()) {
+          allocation = it->second;
+          huge_page_allocations_.erase(it);
+        }
+      }
+      if (allocation.first > 0) {
+        if (allocation.second) {
+          hugetlb_bytes_.fetch_sub(allocation.first,
+                                   std::memory_order_relaxed);
+          munmap(ptr, allocation.first);
+        } else {
+          thp_advised_bytes_.fetch_sub(allocation.first,
+                                       std::memory_order_relaxed);
+          port::AlignedFree(ptr);
+        }
+        return;
+      }
+    }
     if (numa_node_ == port::kNUMANoAffinity) {
       port::AlignedFree(ptr);
     } else {
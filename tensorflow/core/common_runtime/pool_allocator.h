@@ -53,9 +53,11 @@ class PoolAllocator : public Allocator {
   // but will never lower it.
   // "allocator" is the object that performs the underlying memory
   // malloc/free operations.  This object takes ownership of allocator.
+  // If "pooled_bytes_limit" is positive, least recently used buffers are
+  // also evicted whenever the pool holds more than that many bytes.
   PoolAllocator(size_t pool_size_limit, bool auto_resize,
                 SubAllocator* allocator, RoundUpInterface* size_rounder,
-                string name);
+                string name, size_t pooled_bytes_limit = 0);
   ~PoolAllocator() override;
 
   string Name() override { return name_; }
@@ -99,6 +101,10 @@ class PoolAllocator : public Allocator {
   size_t size_limit() const TF_NO_THREAD_SAFETY_ANALYSIS {
     return pool_size_limit_;
   }
+  // Number of bytes held by the returned buffers in the pool.
+  size_t pooled_bytes() const TF_NO_THREAD_SAFETY_ANALYSIS {
+    return pooled_bytes_;
+  }
 
   AllocatorMemoryType GetMemoryType() const override {
     return allocator_->GetMemoryType();
@@ -121,10 +127,15 @@ class PoolAllocator : public Allocator {
   // Delete the least recently used record.
   void EvictOne() TF_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  // Allocate a new chunk from allocator_.  If that fails, release the
+  // pooled buffers and try again.
+  void* AllocateChunk(size_t num_bytes, size_t* bytes_received);
+
   const string name_;
   const bool has_size_limit_;
   const bool auto_resize_;
   size_t pool_size_limit_;
+  const size_t pooled_bytes_limit_;
   std::unique_ptr<SubAllocator> allocator_;
   std::unique_ptr<RoundUpInterface> size_rounder_;
   mutex mutex_;
@@ -135,6 +146,7 @@ class PoolAllocator : public Allocator {
   int64_t put_count_ TF_GUARDED_BY(mutex_) = 0;
   int64_t allocated_count_ TF_GUARDED_BY(mutex_) = 0;
   int64_t evicted_count_ TF_GUARDED_BY(mutex_) = 0;
+  size_t pooled_bytes_ TF_GUARDED_BY(mutex_) = 0;
 };
 
 // Do-nothing rounder. Passes through sizes unchanged.
@@ -151,11 +163,38 @@ class Pow2Rounder : public RoundUpInterface {
   }
 };
 
+// Size class rounder: splits the sizes between consecutive powers of 2
+// into 2^log2_classes evenly spaced classes, and rounds up to the nearest
+// class.  Wastes at most 1/2^log2_classes of the requested size, instead
+// of up to half of it with the Pow2Rounder.
+class SizeClassRounder : public RoundUpInterface {
+ public:
+  explicit SizeClassRounder(int log2_classes = 3)
+      : log2_classes_(log2_classes) {}
+
+  size_t RoundUp(size_t num_bytes) override {
+    const int log2 = Log2Ceiling64(num_bytes);
+    if (log2 <= log2_classes_) return 1uLL << log2;
+    const size_t step = 1uLL << (log2 - 1 - log2_classes_);
+    return (num_bytes + step - 1) & ~(step - 1);
+  }
+
+ private:
+  const int log2_classes_;
+};
+
 class BasicCPUAllocator : public SubAllocator {
  public:
+  // Allocations of at least `huge_page_min_bytes` bytes are backed by huge
+  // pages: explicitly reserved ones (MAP_HUGETLB) if the system has enough,
+  // or else transparent huge pages (madvise(MADV_HUGEPAGE)).  Zero disables
+  // huge pages.  Only supported on Linux, without NUMA affinity.
   BasicCPUAllocator(int numa_node, const std::vector<Visitor>& alloc_visitors,
-                    const std::vector<Visitor>& free_visitors)
-      : SubAllocator(alloc_visitors, free_visitors), numa_node_(numa_node) {}
+                    const std::vector<Visitor>& free_visitors,
+                    size_t huge_page_min_bytes = 0)
+      : SubAllocator(alloc_visitors, free_visitors),
+        numa_node_(numa_node),
+        huge_page_min_bytes_(huge_page_min_bytes) {}
 
   ~BasicCPUAllocator() override {}
 
@@ -170,8 +209,36 @@ class BasicCPUAllocator : public SubAllocator {
     return AllocatorMemoryType::kHostPageable;
   }
 
+  // Bytes currently allocated on reserved huge pages.
+  size_t hugetlb_bytes() const {
+    return hugetlb_bytes_.load(std::memory_order_relaxed);
+  }
+
+  // Bytes currently allocated with a transparent huge page hint.  The kernel
+  // decides whether they are actually backed by huge pages.
+  size_t thp_advised_bytes() const {
+    return thp_advised_bytes_.load(std::memory_order_relaxed);
+  }
+
  private:
+  // Returns memory backed by huge pages, or nullptr.  Sets *bytes_received to
+  // the size rounded up to whole huge pages.
+  void* AllocHugePages(size_t alignment, size_t num_bytes,
+                       size_t* bytes_received);
+
   int numa_node_;
+  const size_t huge_page_min_bytes_;
+
+  mutex mu_;
+  // The size of each huge page allocation, and whether it is on reserved
+  // huge pages.
+  std::map<void*, std::pair<size_t, bool>> huge_page_allocations_
+      TF_GUARDED_BY(mu_);
+  std::atomic<size_t> hugetlb_bytes_{0};
+  std::atomic<size_t> thp_advised_bytes_{0};
+  // Set once MAP_HUGETLB fails, so that later allocations go straight to
+  // transparent huge pages.
+  std::atomic<bool> hugetlb_unavailable_{false};
 
   BasicCPUAllocator(const BasicCPUAllocator&) = delete;
   void operator=(const BasicCPUAllocator&) = delete;
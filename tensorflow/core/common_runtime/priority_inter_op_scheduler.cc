@@ -0,0 +1,60 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/priority_inter_op_scheduler.h"
+
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+PriorityInterOpScheduler* PriorityInterOpScheduler::Global(
+    thread::ThreadPool* pool) {
+  static mutex* mu = new mutex();
+  static auto* schedulers =
+      new absl::flat_hash_map<thread::ThreadPool*, PriorityInterOpScheduler*>;
+  mutex_lock l(*mu);
+  PriorityInterOpScheduler*& scheduler = (*schedulers)[pool];
+  if (scheduler == nullptr) scheduler = new PriorityInterOpScheduler(pool);
+  return scheduler;
+}
+
+void PriorityInterOpScheduler::Schedule(int64_t priority,
+                                        std::function<void()> fn) {
+  {
+    mutex_lock l(mu_);
+    queues_[priority].push_back(std::move(fn));
+  }
+  pool_->Schedule([this]() { RunNext(); });
+}
+
+void PriorityInterOpScheduler::RunNext() {
+  std::function<void()> fn;
+  {
+    mutex_lock l(mu_);
+    // There is one task on the pool per queued closure, so the queues cannot
+    // be empty here.
+    DCHECK(!queues_.empty());
+    auto it = queues_.begin();
+    fn = std::move(it->second.front());
+    it->second.pop_front();
+    if (it->second.empty()) queues_.erase(it);
+  }
+  fn();
+}
+
+}  // namespace tensorflow
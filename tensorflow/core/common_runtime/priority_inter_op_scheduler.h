@@ -0,0 +1,75 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_PRIORITY_INTER_OP_SCHEDULER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_PRIORITY_INTER_OP_SCHEDULER_H_
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+
+// Schedules inter-op closures on a thread pool in priority order.
+//
+// Closures are kept in one FIFO queue per priority level, and every call to
+// `Schedule()` enqueues one task on the underlying pool that runs the oldest
+// closure of the highest priority level when it starts. A closure scheduled
+// by a high-priority step therefore runs before the closures of
+// lower-priority steps that are still queued, no matter which was scheduled
+// first. Closures that have already started are not preempted.
+//
+// All work scheduled on the pool should go through the same scheduler, since
+// tasks scheduled on the pool directly are not ordered with respect to it.
+//
+// This class is thread-safe.
+class PriorityInterOpScheduler {
+ public:
+  // `pool` must outlive this scheduler, and must be deleted (which runs all
+  // its pending tasks) before the scheduler is.
+  explicit PriorityInterOpScheduler(thread::ThreadPool* pool) : pool_(pool) {}
+
+  // Returns the process-wide scheduler for `pool`, for pools that are never
+  // deleted and shared between sessions.
+  static PriorityInterOpScheduler* Global(thread::ThreadPool* pool);
+
+  // Schedules `fn` to run on the pool. Larger values of `priority` run
+  // first.
+  void Schedule(int64_t priority, std::function<void()> fn);
+
+  thread::ThreadPool* pool() const { return pool_; }
+
+  PriorityInterOpScheduler(const PriorityInterOpScheduler&) = delete;
+  void operator=(const PriorityInterOpScheduler&) = delete;
+
+ private:
+  // Runs the next closure in priority order.
+  void RunNext();
+
+  thread::ThreadPool* const pool_;
+
+  mutex mu_;
+  std::map<int64_t, std::deque<std::function<void()>>, std::greater<int64_t>>
+      queues_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_PRIORITY_INTER_OP_SCHEDULER_H_
@@ -0,0 +1,71 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/priority_inter_op_scheduler.h"
+
+#include <vector>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(PriorityInterOpSchedulerTest, HigherPriorityRunsFirst) {
+  std::vector<int> order;
+  {
+    thread::ThreadPool pool(Env::Default(), "test", /*num_threads=*/1);
+    PriorityInterOpScheduler scheduler(&pool);
+    mutex mu;
+    Notification blocked;
+    Notification unblock;
+    // Occupy the only thread, so that the other closures are queued.
+    scheduler.Schedule(0, [&]() {
+      blocked.Notify();
+      unblock.WaitForNotification();
+    });
+    blocked.WaitForNotification();
+    auto record = [&](int value) {
+      return [&mu, &order, value]() {
+        mutex_lock l(mu);
+        order.push_back(value);
+      };
+    };
+    scheduler.Schedule(0, record(1));
+    scheduler.Schedule(0, record(2));
+    scheduler.Schedule(10, record(3));
+    scheduler.Schedule(5, record(4));
+    scheduler.Schedule(10, record(5));
+    unblock.Notify();
+  }
+  // Closures of the same priority run in the order they were scheduled.
+  EXPECT_EQ(order, std::vector<int>({3, 5, 4, 1, 2}));
+}
+
+TEST(PriorityInterOpSchedulerTest, GlobalIsPerPool) {
+  thread::ThreadPool pool1(Env::Default(), "test1", /*num_threads=*/1);
+  thread::ThreadPool pool2(Env::Default(), "test2", /*num_threads=*/1);
+  PriorityInterOpScheduler* scheduler1 =
+      PriorityInterOpScheduler::Global(&pool1);
+  EXPECT_EQ(scheduler1, PriorityInterOpScheduler::Global(&pool1));
+  EXPECT_NE(scheduler1, PriorityInterOpScheduler::Global(&pool2));
+  EXPECT_EQ(&pool1, scheduler1->pool());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -186,6 +186,7 @@ void ProcessFunctionLibraryRuntime::ReceiveTensorsAsync(
 
 Status ProcessFunctionLibraryRuntime::GetRetTypes(
     FunctionLibraryRuntime::Handle h, DataTypeVector* ret_types) {
+  TF_RETURN_IF_ERROR(ResolveLazyHandle(&h));
   FunctionLibraryRuntime* flr = nullptr;
   {
     tf_shared_lock l(mu_);
@@ -824,6 +825,7 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
 Status ProcessFunctionLibraryRuntime::GetOutputDevices(
     FunctionLibraryRuntime::Handle handle,
     std::vector<Device*>* output_devices) const {
+  TF_RETURN_IF_ERROR(ResolveLazyHandle(&handle));
   MultiDeviceFunctionData* data = IsMultiDevice(handle);
   if (data == nullptr) {
     return errors::InvalidArgument(
@@ -1132,6 +1134,10 @@ Status ProcessFunctionLibraryRuntime::Instantiate(
     const FunctionLibraryRuntime::InstantiateOptions& options,
     FunctionLibraryRuntime::Handle* handle) {
   if (options.is_multi_device_function) {
+    if (options.lazy_instantiation) {
+      *handle = AddLazyHandle(function_name, attrs, options);
+      return absl::OkStatus();
+    }
     return InstantiateMultiDevice(function_name, attrs, options, handle);
   }
 
@@ -1152,8 +1158,89 @@ Status ProcessFunctionLibraryRuntime::Instantiate(
   return status;
 }
 
+FunctionLibraryRuntime::Handle ProcessFunctionLibraryRuntime::AddLazyHandle(
+    const string& function_name, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options) {
+  auto data = std::make_shared<LazyFunctionData>();
+  AttrValueMap attr_values(attrs.begin(), attrs.end());
+  FunctionLibraryRuntime::InstantiateOptions options_copy(options);
+  options_copy.lazy_instantiation = false;
+  data->instantiate = [this, function_name,
+                       attr_values = std::move(attr_values),
+                       options_copy = std::move(options_copy)](
+                          FunctionLibraryRuntime::Handle* handle) {
+    return InstantiateMultiDevice(function_name, AttrSlice(&attr_values),
+                                  options_copy, handle);
+  };
+  VLOG(1) << "Deferring instantiation of MultiDevice function \""
+          << function_name << "\" on default device \"" << options.target
+          << "\"";
+  mutex_lock l(mu_);
+  auto h = next_handle_;
+  lazy_data_[h] = std::move(data);
+  next_handle_++;
+  return h;
+}
+
+std::shared_ptr<ProcessFunctionLibraryRuntime::LazyFunctionData>
+ProcessFunctionLibraryRuntime::GetLazyFunctionData(
+    FunctionLibraryRuntime::Handle handle) const {
+  tf_shared_lock l(mu_);
+  auto it = lazy_data_.find(handle);
+  if (it == lazy_data_.end()) return nullptr;
+  return it->second;
+}
+
+Status ProcessFunctionLibraryRuntime::InstantiateLazyFunction(
+    LazyFunctionData* data, FunctionLibraryRuntime::Handle* handle) {
+  bool instantiate;
+  {
+    mutex_lock l(data->mu);
+    instantiate = !data->started;
+    data->started = true;
+  }
+  if (instantiate) {
+    data->status = data->instantiate(&data->handle);
+    data->done.Notify();
+  } else {
+    data->done.WaitForNotification();
+  }
+  if (data->status.ok()) *handle = data->handle;
+  return data->status;
+}
+
+Status ProcessFunctionLibraryRuntime::ResolveLazyHandle(
+    FunctionLibraryRuntime::Handle* handle) const {
+  std::shared_ptr<LazyFunctionData> data = GetLazyFunctionData(*handle);
+  if (data == nullptr) return absl::OkStatus();
+  return InstantiateLazyFunction(data.get(), handle);
+}
+
+void ProcessFunctionLibraryRuntime::InstantiateLazyFunctionsAsync(
+    std::vector<FunctionLibraryRuntime::Handle> handles, StatusCallback done) {
+  auto* refcounted_done = new ReffedStatusCallback(std::move(done));
+  for (FunctionLibraryRuntime::Handle handle : handles) {
+    std::shared_ptr<LazyFunctionData> data = GetLazyFunctionData(handle);
+    if (data == nullptr) continue;
+    refcounted_done->Ref();
+    auto fn = [data = std::move(data), refcounted_done]() {
+      FunctionLibraryRuntime::Handle instantiated_handle;
+      refcounted_done->UpdateStatus(
+          InstantiateLazyFunction(data.get(), &instantiated_handle));
+      refcounted_done->Unref();
+    };
+    if (default_thread_pool_ != nullptr) {
+      default_thread_pool_->Schedule(std::move(fn));
+    } else {
+      fn();
+    }
+  }
+  refcounted_done->Unref();
+}
+
 Status ProcessFunctionLibraryRuntime::IsCrossProcess(
     FunctionLibraryRuntime::Handle handle, bool* is_cross_process) const {
+  TF_RETURN_IF_ERROR(ResolveLazyHandle(&handle));
   tf_shared_lock l(mu_);
   const auto& mdevice_it = mdevice_data_.find(handle);
   if (mdevice_it != mdevice_data_.end()) {
@@ -1260,6 +1347,34 @@ Status ProcessFunctionLibraryRuntime::ReleaseHandle(
   // Return directly if all function handles has already been released.
   if (flr_map_ == nullptr) return absl::OkStatus();
 
+  std::shared_ptr<LazyFunctionData> lazy_data;
+  {
+    mutex_lock l(mu_);
+    auto it = lazy_data_.find(handle);
+    if (it != lazy_data_.end()) {
+      lazy_data = std::move(it->second);
+      lazy_data_.erase(it);
+    }
+  }
+  if (lazy_data != nullptr) {
+    bool started;
+    {
+      mutex_lock l(lazy_data->mu);
+      started = lazy_data->started;
+      lazy_data->started = true;
+    }
+    if (!started) {
+      // The function was never used, so there is nothing to release.
+      lazy_data->status = errors::InvalidArgument(
+          "Function handle ", handle, " was released before being used.");
+      lazy_data->done.Notify();
+      return absl::OkStatus();
+    }
+    lazy_data->done.WaitForNotification();
+    if (!lazy_data->status.ok()) return absl::OkStatus();
+    handle = lazy_data->handle;
+  }
+
   if (IsMultiDevice(handle)) {
     return ReleaseMultiDeviceHandle(handle);
   }
@@ -1377,6 +1492,28 @@ void ProcessFunctionLibraryRuntime::Run(
     FunctionLibraryRuntime::Handle handle, gtl::ArraySlice<Tensor> args,
     std::vector<Tensor>* rets,
     FunctionLibraryRuntime::DoneCallback done) const {
+  std::shared_ptr<LazyFunctionData> lazy_data = GetLazyFunctionData(handle);
+  if (lazy_data != nullptr) {
+    // Instantiate the function off the caller's thread, and then run it.
+    std::vector<Tensor> args_copy(args.begin(), args.end());
+    auto fn = [this, opts, lazy_data, args = std::move(args_copy), rets,
+               done = std::move(done)]() mutable {
+      FunctionLibraryRuntime::Handle instantiated_handle;
+      Status s = InstantiateLazyFunction(lazy_data.get(), &instantiated_handle);
+      if (!s.ok()) {
+        done(s);
+        return;
+      }
+      Run(opts, instantiated_handle, args, rets, std::move(done));
+    };
+    if (default_thread_pool_ != nullptr && !lazy_data->done.HasBeenNotified()) {
+      default_thread_pool_->Schedule(std::move(fn));
+    } else {
+      fn();
+    }
+    return;
+  }
+
   FunctionLibraryRuntime::Options new_opts = opts;
   tsl::core::RefCountPtr<Rendezvous> created_rendezvous = nullptr;
   if (!opts.rendezvous) {
@@ -1561,6 +1698,7 @@ Status ProcessFunctionLibraryRuntime::RunSync(
     const FunctionLibraryRuntime::Options& orig_opts,
     FunctionLibraryRuntime::Handle handle, gtl::ArraySlice<Tensor> args,
     std::vector<Tensor>* rets) const {
+  TF_RETURN_IF_ERROR(ResolveLazyHandle(&handle));
   MultiDeviceFunctionData* multi_device_data = IsMultiDevice(handle);
   if (multi_device_data && multi_device_data->enable_sync_execution) {
     metrics::IncrementTestCounter("pflr_runsync", "sync");
@@ -1613,6 +1751,13 @@ void ProcessFunctionLibraryRuntime::Run(
     FunctionLibraryRuntime::Handle handle, const FunctionArgsInterface& args,
     std::vector<FunctionRet>* rets,
     FunctionLibraryRuntime::DoneCallback done) const {
+  // `args` may not outlive this call, so the function is instantiated on the
+  // caller's thread.
+  Status resolve_status = ResolveLazyHandle(&handle);
+  if (!resolve_status.ok()) {
+    done(resolve_status);
+    return;
+  }
   bool has_remote_outputs = false;
   const MultiDeviceFunctionData* data = IsMultiDevice(handle);
   if (data != nullptr) {
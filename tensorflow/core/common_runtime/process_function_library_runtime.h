@@ -30,6 +30,8 @@ limitations under the License.
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/protobuf/config.pb.h"
@@ -164,6 +166,14 @@ class ProcessFunctionLibraryRuntime {
                      const FunctionLibraryRuntime::InstantiateOptions& options,
                      FunctionLibraryRuntime::Handle* handle);
 
+  // Instantiates the functions with the given `handles`, which were created
+  // with `InstantiateOptions::lazy_instantiation`, on the default thread pool
+  // if any, and calls `done` with the first error once all are instantiated.
+  // Handles of functions that are already instantiated are ignored.
+  void InstantiateLazyFunctionsAsync(
+      std::vector<FunctionLibraryRuntime::Handle> handles,
+      StatusCallback done);
+
   // Returns whether the function represented by the given handle needs to
   // execute cross process.
   Status IsCrossProcess(FunctionLibraryRuntime::Handle handle,
@@ -327,6 +337,22 @@ class ProcessFunctionLibraryRuntime {
     FunctionLibraryRuntime::Handle local_handle;
   };
 
+  // A multi-device function instantiated with
+  // `InstantiateOptions::lazy_instantiation`. Its handle only refers to this
+  // object until the function is instantiated on first use, after which the
+  // handle of the instantiated function is used in its place.
+  struct LazyFunctionData {
+    // Instantiates the function, and returns its handle.
+    std::function<Status(FunctionLibraryRuntime::Handle*)> instantiate;
+
+    mutex mu;
+    bool started TF_GUARDED_BY(mu) = false;
+    // Set before `done` is notified.
+    Status status;
+    FunctionLibraryRuntime::Handle handle = kInvalidHandle;
+    Notification done;
+  };
+
   // If `handle` represents a multi-device function, returns the multi-device
   // data associated with `handle`. Else, nullptr.
   MultiDeviceFunctionData* IsMultiDevice(
@@ -372,6 +398,26 @@ class ProcessFunctionLibraryRuntime {
 
   Status ReleaseMultiDeviceHandle(FunctionLibraryRuntime::Handle handle);
 
+  // Registers a lazily instantiated function, and returns its handle.
+  FunctionLibraryRuntime::Handle AddLazyHandle(
+      const string& function_name, AttrSlice attrs,
+      const FunctionLibraryRuntime::InstantiateOptions& options);
+
+  // Returns the data of a lazily instantiated function, or nullptr if
+  // `handle` does not refer to one.
+  std::shared_ptr<LazyFunctionData> GetLazyFunctionData(
+      FunctionLibraryRuntime::Handle handle) const;
+
+  // Instantiates the function of `data` if no other call did, otherwise
+  // waits for that instantiation. On success, returns the handle of the
+  // instantiated function in `*handle`.
+  static Status InstantiateLazyFunction(LazyFunctionData* data,
+                                        FunctionLibraryRuntime::Handle* handle);
+
+  // Replaces `*handle` with the handle of the instantiated function if it
+  // refers to a lazily instantiated function, instantiating it if needed.
+  Status ResolveLazyHandle(FunctionLibraryRuntime::Handle* handle) const;
+
   Status InstantiateMultiDevice(
       const string& function_name, AttrSlice attrs,
       const FunctionLibraryRuntime::InstantiateOptions& options,
@@ -521,6 +567,11 @@ class ProcessFunctionLibraryRuntime {
                      std::unique_ptr<MultiDeviceFunctionData>>
       mdevice_data_ TF_GUARDED_BY(mu_);
 
+  // Multi-device functions whose instantiation is deferred to first use.
+  std::unordered_map<FunctionLibraryRuntime::Handle,
+                     std::shared_ptr<LazyFunctionData>>
+      lazy_data_ TF_GUARDED_BY(mu_);
+
   std::unique_ptr<
       std::unordered_map<Device*, core::RefCountPtr<FunctionLibraryRuntime>>>
       flr_map_;
@@ -1122,6 +1122,58 @@ TEST_F(ProcessFunctionLibraryRuntimeTest, MultiDevice_CreateKernelsEagerly) {
   EXPECT_TRUE(errors::IsInternal(status));
 }
 
+TEST_F(ProcessFunctionLibraryRuntimeTest, MultiDevice_LazyInstantiation) {
+  Init({test::function::XTimesTwo()});
+  FunctionLibraryRuntime::InstantiateOptions inst_opts =
+      MakeOptions("CPU:0", {"CPU:0"}, {"CPU:0"});
+  const string function_key =
+      Canonicalize("XTimesTwo", test::function::Attrs({{"T", DT_FLOAT}}),
+                   inst_opts);
+  inst_opts.lazy_instantiation = true;
+
+  FunctionLibraryRuntime::Handle handle;
+  TF_CHECK_OK(Instantiate("XTimesTwo", {{"T", DT_FLOAT}}, inst_opts, &handle));
+  // Nothing is instantiated until the function is used.
+  EXPECT_EQ(kInvalidHandle, proc_flr_->GetHandle(function_key));
+
+  FunctionLibraryRuntime::Options opts;
+  auto x = test::AsTensor<float>({1, 2, 3, 4});
+  Tensor y;
+  TF_CHECK_OK(RunInstantiated(handle, opts, {x}, {&y}));
+  test::ExpectTensorEqual<float>(y, test::AsTensor<float>({2, 4, 6, 8}));
+  EXPECT_NE(kInvalidHandle, proc_flr_->GetHandle(function_key));
+
+  TF_CHECK_OK(proc_flr_->ReleaseHandle(handle));
+  EXPECT_EQ(kInvalidHandle, proc_flr_->GetHandle(function_key));
+}
+
+TEST_F(ProcessFunctionLibraryRuntimeTest,
+       MultiDevice_LazyInstantiationWarmUpError) {
+  Init({test::function::XTimesTwo()});
+  FunctionLibraryRuntime::InstantiateOptions inst_opts =
+      MakeOptions("CPU:0", {"CPU:0"}, {"CPU:0"});
+  inst_opts.lazy_instantiation = true;
+
+  // Errors in the function are only reported when it is first used.
+  FunctionLibraryRuntime::Handle handle;
+  TF_CHECK_OK(Instantiate("Missing", {}, inst_opts, &handle));
+  Notification done;
+  Status status;
+  proc_flr_->InstantiateLazyFunctionsAsync({handle},
+                                           [&status, &done](const Status& s) {
+                                             status = s;
+                                             done.Notify();
+                                           });
+  done.WaitForNotification();
+  EXPECT_TRUE(errors::IsInvalidArgument(status))
+      << "Actual status: " << status;
+
+  // Later uses report the same error.
+  DataTypeVector ret_types;
+  EXPECT_EQ(status, proc_flr_->GetRetTypes(handle, &ret_types));
+  TF_CHECK_OK(proc_flr_->ReleaseHandle(handle));
+}
+
 TEST_F(ProcessFunctionLibraryRuntimeTest, MultiDevice_StateHandle) {
   auto T = DT_INT32;
   // The expected sequence of outputs from this function is [6, 4, 0, 1, ...].
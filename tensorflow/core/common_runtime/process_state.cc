@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/process_state.h"
 
+#include <algorithm>
 #include <atomic>
 #include <cstring>
 #include <vector>
@@ -73,21 +74,35 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
   while (cpu_allocators_.size() <= static_cast<size_t>(numa_node)) {
     // If visitors have been defined we need an Allocator built from
     // a SubAllocator.  Prefer BFCAllocator, but fall back to PoolAllocator
-    // depending on env var setting.
+    // depending on env var setting. NUMA-local allocators also default to
+    // BFCAllocator, since each node gets its own allocator.
     const bool alloc_visitors_defined =
         (!cpu_alloc_visitors_.empty() || !cpu_free_visitors_.empty());
+    // Allocations of at least this size are backed by huge pages, which
+    // needs a SubAllocator.
+    int64_t huge_page_min_mb = 0;
+    Status status = ReadInt64FromEnvVar("TF_CPU_ALLOCATOR_HUGE_PAGE_MIN_MB", 0,
+                                        &huge_page_min_mb);
+    if (!status.ok()) {
+      LOG(ERROR) << "GetCPUAllocator: " << status.message();
+    }
+    const bool use_huge_pages = huge_page_min_mb > 0;
     bool use_bfc_allocator = false;
-    Status status = ReadBoolFromEnvVar(
-        "TF_CPU_ALLOCATOR_USE_BFC", alloc_visitors_defined, &use_bfc_allocator);
+    status = ReadBoolFromEnvVar(
+        "TF_CPU_ALLOCATOR_USE_BFC",
+        alloc_visitors_defined || numa_enabled_ || use_huge_pages,
+        &use_bfc_allocator);
     if (!status.ok()) {
       LOG(ERROR) << "GetCPUAllocator: " << status.message();
     }
     Allocator* allocator = nullptr;
     SubAllocator* sub_allocator =
-        (numa_enabled_ || alloc_visitors_defined || use_bfc_allocator)
+        (numa_enabled_ || alloc_visitors_defined || use_bfc_allocator ||
+         use_huge_pages)
             ? new BasicCPUAllocator(
                   numa_enabled_ ? numa_node : port::kNUMANoAffinity,
-                  cpu_alloc_visitors_, cpu_free_visitors_)
+                  cpu_alloc_visitors_, cpu_free_visitors_,
+                  use_huge_pages ? huge_page_min_mb << 20 : 0)
             : nullptr;
     if (use_bfc_allocator) {
       // TODO(reedwm): evaluate whether 64GB by default is the best choice.
@@ -101,8 +116,16 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
       int64_t cpu_mem_limit = cpu_mem_limit_in_mb * (1LL << 20);
       DCHECK(sub_allocator);
 
+      int64_t thread_cache_max_bytes = 0;
+      status = ReadInt64FromEnvVar("TF_CPU_BFC_THREAD_CACHE_MAX_BYTES", 0,
+                                   &thread_cache_max_bytes);
+      if (!status.ok()) {
+        LOG(ERROR) << "GetCPUAllocator: " << status.message();
+      }
       BFCAllocator::Options allocator_opts;
       allocator_opts.allow_growth = true;
+      allocator_opts.thread_cache_max_bytes =
+          std::max<int64_t>(0, thread_cache_max_bytes);
       allocator = new BFCAllocator(
           absl::WrapUnique(sub_allocator), cpu_mem_limit,
           /*name=*/"bfc_cpu_allocator_for_gpu", allocator_opts);
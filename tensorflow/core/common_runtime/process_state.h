@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_PROCESS_STATE_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_PROCESS_STATE_H_
 
+#include <atomic>
 #include <functional>
 #include <map>
 #include <unordered_map>
@@ -55,7 +56,7 @@ class ProcessState : public ProcessStateInterface {
   };
 
   // If NUMA Allocators are desired, call this before calling any
-  // Allocator accessor.
+  // Allocator accessor. Allocators that were already created are not affected.
   void EnableNUMA() { numa_enabled_ = true; }
 
   // Returns what we know about the memory at ptr.
@@ -92,7 +93,7 @@ class ProcessState : public ProcessStateInterface {
   void TestOnlyReset();
 
   static ProcessState* instance_;
-  bool numa_enabled_;
+  std::atomic<bool> numa_enabled_;
 
   mutex mu_;
 
@@ -59,6 +59,7 @@ void PropagatorState::ActivateRoots(gtl::ArraySlice<const NodeItem*> roots,
     DCHECK_EQ(item->num_inputs, 0);
     ready->emplace_back(item, root_frame_, root_iter, false);
   }
+  // The root frame has no inputs, so iteration 0 only waits on the roots.
   root_iter->outstanding_ops = ready->size();
 }
 
@@ -98,6 +99,7 @@ void PropagatorState::PropagateOutputs(const TaggedNode& tagged_node,
         item, is_dead, output_iter, outputs, ready, /*decrement_activation=*/1);
   } else if (item->is_enter) {
     FindOrCreateChildFrame(input_frame, input_iter, *item, &output_frame);
+    bool is_output_frame_done = false;
     {
       mutex_lock l(output_frame->mu);
       output_iter = output_frame->GetIteration(0);
@@ -109,16 +111,25 @@ void PropagatorState::PropagateOutputs(const TaggedNode& tagged_node,
             item, is_dead, output_iter, outputs, ready);
         output_frame->AdjustOutstandingOpsLocked(output_iter, activated, ready);
       }
-      output_frame->num_pending_inputs--;
+      if (--output_frame->num_pending_inputs == 0) {
+        // Iteration 0 no longer waits on the inputs of the frame.
+        is_output_frame_done =
+            output_frame->DecrementOutstandingOpsLocked(output_iter, ready);
+      }
+    }
+    if (is_output_frame_done) {
+      DeleteFrame(output_frame, ready);
+      CleanupFramesIterations(input_frame, input_iter, ready);
     }
     is_frame_done = input_frame->DecrementOutstandingOps(input_iter, ready);
   } else if (item->is_exit) {
     if (is_dead) {
       {
-        tf_shared_lock l(input_frame->mu);
+        // `iteration_count` is only written with `iter_mu` held.
+        mutex_lock l(input_frame->iter_mu);
         // Stop and remember this node if it is a dead exit.
-        if (input_iter->iter_num == input_frame->iteration_count) {
-          mutex_lock l(input_frame->iter_mu);
+        if (input_iter->iter_num ==
+            input_frame->iteration_count.load(std::memory_order_relaxed)) {
           input_frame->dead_exits.push_back(item);
         }
       }
@@ -138,7 +149,12 @@ void PropagatorState::PropagateOutputs(const TaggedNode& tagged_node,
       output_frame = nullptr;
     } else {
       bool need_create_iter = false;
-      {
+      if (input_iter->iter_num <
+          input_frame->iteration_count.load(std::memory_order_acquire)) {
+        // The next iteration exists, and cannot be done before `input_iter`,
+        // so it can be read from the iteration ring without the lock.
+        output_iter = input_frame->GetIteration(input_iter->iter_num + 1);
+      } else {
         tf_shared_lock l(input_frame->mu);
         if (input_iter->iter_num == input_frame->iteration_count) {
           if (input_frame->num_outstanding_iterations ==
@@ -287,7 +303,7 @@ void PropagatorState::FindOrCreateChildFrame(FrameState* frame,
   temp->parent_iter = iter_state;
   temp->InitializeFrameInfo(frame_info);
 
-  // Initialize iteration 0.
+  // Initialize iteration 0, which waits on the inputs of the frame.
   {
     mutex_lock l(temp->mu);
     temp->SetIteration(0, new IterationState(0, temp->pending_counts,
@@ -300,8 +316,8 @@ void PropagatorState::FindOrCreateChildFrame(FrameState* frame,
     if (it != outstanding_frames_.end()) {
       *child = it->second;
     } else {
-      mutex_lock frame_lock(frame->mu);
-      iter_state->outstanding_frame_count++;
+      // `iter_state` is not done until the child frame is deleted.
+      iter_state->outstanding_ops++;
       outstanding_frames_[child_id] = temp;
       *child = temp;
       temp = nullptr;
@@ -331,9 +347,13 @@ void PropagatorState::DeleteFrame(FrameState* frame, TaggedNodeSeq* ready) {
         }
       };
 
+      // Other threads may be activating nodes in the parent iteration without
+      // holding its lock, so the counts must be adjusted atomically.
       auto propagate_to_non_merge = [&](PendingCounts::Handle dst_pending_id) {
-        parent_iter_state->increment_dead_count(dst_pending_id);
-        return parent_iter_state->decrement_pending(dst_pending_id, 1) == 0;
+        const PendingCounts::AdjustResult adjust_result =
+            parent_iter_state->adjust_for_activation_atomic(
+                dst_pending_id, /*increment_dead=*/true);
+        return adjust_result.pending_count == 0;
       };
 
       for (const EdgeInfo& e : item->output_edges()) {
@@ -345,11 +365,11 @@ void PropagatorState::DeleteFrame(FrameState* frame, TaggedNodeSeq* ready) {
         bool dst_ready;
         // We know this is a dead input to dst.
         if (dst_item.is_merge) {
-          parent_iter_state->increment_dead_count(dst_pending_id);
-          const int dead_cnt = parent_iter_state->dead_count(dst_pending_id);
-          dst_dead = (dead_cnt == dst_item.num_inputs);
-          dst_ready =
-              (parent_iter_state->pending(dst_pending_id) == 1) && dst_dead;
+          const PendingCounts::AdjustResult adjust_result =
+              parent_iter_state->adjust_for_increment_dead_atomic(
+                  dst_pending_id);
+          dst_dead = (adjust_result.dead_count == dst_item.num_inputs);
+          dst_ready = (adjust_result.pending_count == 1) && dst_dead;
         } else {
           dst_ready = propagate_to_non_merge(dst_pending_id);
         }
@@ -365,11 +385,12 @@ void PropagatorState::DeleteFrame(FrameState* frame, TaggedNodeSeq* ready) {
         bool dst_ready;
         // We know this is a dead input to dst.
         if (dst_item.is_merge) {
-          parent_iter_state->decrement_pending(dst_pending_id, 2);
-          int count = parent_iter_state->pending(dst_pending_id);
-          int dead_cnt = parent_iter_state->dead_count(dst_pending_id);
-          dst_dead = (dead_cnt == dst_item.num_inputs);
-          dst_ready = (count == 0) || ((count == 1) && dst_dead);
+          const PendingCounts::AdjustResult adjust_result =
+              parent_iter_state->adjust_for_decrement_pending_atomic(
+                  dst_pending_id, /*decrement_pending=*/2);
+          dst_dead = (adjust_result.dead_count == dst_item.num_inputs);
+          dst_ready = (adjust_result.pending_count == 0) ||
+                      ((adjust_result.pending_count == 1) && dst_dead);
         } else {
           dst_dead = true;
           dst_ready = propagate_to_non_merge(dst_pending_id);
@@ -391,12 +412,8 @@ void PropagatorState::DeleteFrame(FrameState* frame, TaggedNodeSeq* ready) {
 void PropagatorState::CleanupFramesIterations(FrameState* frame,
                                               IterationState* iter_state,
                                               TaggedNodeSeq* ready) {
-  bool is_frame_done = false;
-  {
-    mutex_lock frame_lock(frame->mu);
-    iter_state->outstanding_frame_count--;
-    is_frame_done = frame->CleanupIterations(iter_state, ready);
-  }
+  // Release the count that the deleted child frame held on `iter_state`.
+  const bool is_frame_done = frame->DecrementOutstandingOps(iter_state, ready);
   if (is_frame_done) {
     FrameState* parent_frame = frame->parent_frame;
     IterationState* parent_iter = frame->parent_iter;
@@ -409,8 +426,7 @@ void PropagatorState::CleanupFramesIterations(FrameState* frame,
   }
 }
 
-template <bool atomic>
-int PropagatorState::FrameState::ActivateNodesFastPathInternal(
+int PropagatorState::FrameState::ActivateNodesFastPath(
     const NodeItem* item, const bool is_dead, IterationState* iter_state,
     EntryVector* outputs, TaggedNodeSeq* ready) {
   // If we know that none of the item's edge destinations require special
@@ -452,10 +468,8 @@ int PropagatorState::FrameState::ActivateNodesFastPathInternal(
       input_tensors[dst_loc] = (*outputs)[src_slot];
     }
     const PendingCounts::AdjustResult adjust_result =
-        atomic
-            ? iter_state->adjust_for_activation_atomic(dst_pending_id,
-                                                       increment_dead)
-            : iter_state->adjust_for_activation(dst_pending_id, increment_dead);
+        iter_state->adjust_for_activation_atomic(dst_pending_id,
+                                                 increment_dead);
     MAYBE_ADD_TO_READY(dst_id, adjust_result);
   }
 
@@ -464,9 +478,7 @@ int PropagatorState::FrameState::ActivateNodesFastPathInternal(
     const PendingCounts::Handle dst_pending_id =
         immutable_state.pending_ids()[dst_id];
     const PendingCounts::AdjustResult adjust_result =
-        atomic
-            ? iter_state->adjust_for_activation_atomic(dst_pending_id, is_dead)
-            : iter_state->adjust_for_activation(dst_pending_id, is_dead);
+        iter_state->adjust_for_activation_atomic(dst_pending_id, is_dead);
     MAYBE_ADD_TO_READY(dst_id, adjust_result);
   }
 
@@ -474,8 +486,7 @@ int PropagatorState::FrameState::ActivateNodesFastPathInternal(
 #undef MAYBE_ADD_TO_READY
 }
 
-template <bool atomic>
-int PropagatorState::FrameState::ActivateNodesSlowPathInternal(
+int PropagatorState::FrameState::ActivateNodesSlowPath(
     const NodeItem* item, const bool is_dead, IterationState* iter_state,
     EntryVector* outputs, TaggedNodeSeq* ready) {
   // If any of the edge destinations is a merge or a control trigger node,
@@ -528,8 +539,7 @@ int PropagatorState::FrameState::ActivateNodesSlowPathInternal(
         }
 
         const PendingCounts::AdjustResult adjust_result =
-            atomic ? iter_state->adjust_for_mark_live_atomic(dst_pending_id)
-                   : iter_state->adjust_for_mark_live(dst_pending_id);
+            iter_state->adjust_for_mark_live_atomic(dst_pending_id);
 
         // The low bit of count is set if and only if no live input has been
         // used yet (mark_live clears it). The node should be started if and
@@ -543,9 +553,7 @@ int PropagatorState::FrameState::ActivateNodesSlowPathInternal(
         // TODO(yuanbyu): This is a bit hacky, but a good solution for
         // now.
         const PendingCounts::AdjustResult adjust_result =
-            atomic
-                ? iter_state->adjust_for_increment_dead_atomic(dst_pending_id)
-                : iter_state->adjust_for_increment_dead(dst_pending_id);
+            iter_state->adjust_for_increment_dead_atomic(dst_pending_id);
         dst_dead = (adjust_result.dead_count == dst_item->num_inputs) ||
                    item->is_enter;
         dst_ready = (adjust_result.pending_count == 1) && dst_dead;
@@ -566,10 +574,8 @@ int PropagatorState::FrameState::ActivateNodesSlowPathInternal(
       const bool increment_dead =
           (is_dead || ((*outputs)[src_slot].state == Entry::State::NO_VALUE));
       const PendingCounts::AdjustResult adjust_result =
-          atomic ? iter_state->adjust_for_activation_atomic(dst_pending_id,
-                                                            increment_dead)
-                 : iter_state->adjust_for_activation(dst_pending_id,
-                                                     increment_dead);
+          iter_state->adjust_for_activation_atomic(dst_pending_id,
+                                                   increment_dead);
       dst_dead = adjust_result.dead_count > 0;
       dst_ready = !(adjust_result.pending_count > 0);
     }
@@ -591,20 +597,15 @@ int PropagatorState::FrameState::ActivateNodesSlowPathInternal(
       // dead. For Merge, pending's LSB is set iff a live data input has
       // arrived.
       const PendingCounts::AdjustResult adjust_result =
-          atomic ? iter_state->adjust_for_decrement_pending_atomic(
-                       dst_pending_id, /*decrement_pending=*/2)
-                 : iter_state->adjust_for_decrement_pending(
-                       dst_pending_id,
-                       /*decrement_pending=*/2);
+          iter_state->adjust_for_decrement_pending_atomic(
+              dst_pending_id, /*decrement_pending=*/2);
       dst_dead = (adjust_result.dead_count == dst_item->num_inputs);
       dst_ready = (adjust_result.pending_count == 0) ||
                   ((adjust_result.pending_count == 1) && dst_dead);
     } else {
       // Handle all other (non-merge) nodes.
       const PendingCounts::AdjustResult adjust_result =
-          atomic ? iter_state->adjust_for_activation_atomic(dst_pending_id,
-                                                            is_dead)
-                 : iter_state->adjust_for_activation(dst_pending_id, is_dead);
+          iter_state->adjust_for_activation_atomic(dst_pending_id, is_dead);
       dst_dead = adjust_result.dead_count > 0;
       dst_ready = adjust_result.pending_count == 0;
     }
@@ -614,58 +615,19 @@ int PropagatorState::FrameState::ActivateNodesSlowPathInternal(
   return activated;
 }
 
-int PropagatorState::FrameState::ActivateNodesFastPathLocked(
-    const NodeItem* item, const bool is_dead, IterationState* iter_state,
-    EntryVector* outputs, TaggedNodeSeq* ready) {
-  return ActivateNodesFastPathInternal<false>(item, is_dead, iter_state,
-                                              outputs, ready);
-}
-
-int PropagatorState::FrameState::ActivateNodesFastPathShared(
-    const NodeItem* item, const bool is_dead, IterationState* iter_state,
-    EntryVector* outputs, TaggedNodeSeq* ready) {
-  return ActivateNodesFastPathInternal<true>(item, is_dead, iter_state, outputs,
-                                             ready);
-}
-
-int PropagatorState::FrameState::ActivateNodesSlowPathLocked(
-    const NodeItem* item, const bool is_dead, IterationState* iter_state,
-    EntryVector* outputs, TaggedNodeSeq* ready) {
-  return ActivateNodesSlowPathInternal<false>(item, is_dead, iter_state,
-                                              outputs, ready);
-}
-
-int PropagatorState::FrameState::ActivateNodesSlowPathShared(
-    const NodeItem* item, const bool is_dead, IterationState* iter_state,
-    EntryVector* outputs, TaggedNodeSeq* ready) {
-  return ActivateNodesSlowPathInternal<true>(item, is_dead, iter_state, outputs,
-                                             ready);
-}
-
 bool PropagatorState::FrameState::ActivateNodesAndAdjustOutstanding(
     const NodeItem* item, const bool is_dead, IterationState* iter_state,
     EntryVector* outputs, TaggedNodeSeq* ready, int decrement_activation) {
+  int activated;
   if (TF_PREDICT_FALSE(item->is_any_consumer_merge_or_control_trigger)) {
-    tf_shared_lock l(mu);
-    int activated =
-        ActivateNodesSlowPathShared(item, is_dead, iter_state, outputs, ready);
-    bool iter_done = AdjustOutstandingOpsFastPath(
-        iter_state, activated - decrement_activation);
-    if (!iter_done) return false;
+    activated =
+        ActivateNodesSlowPath(item, is_dead, iter_state, outputs, ready);
   } else {
-    tf_shared_lock l(mu);
-    int activated =
-        ActivateNodesFastPathShared(item, is_dead, iter_state, outputs, ready);
-    bool iter_done = AdjustOutstandingOpsFastPath(
-        iter_state, activated - decrement_activation);
-    if (!iter_done) return false;
-  }
-  if (decrement_activation > 0) {
-    mutex_lock l(mu);
-    return CleanupIterations(iter_state, ready);
-  } else {
-    return true;
+    activated =
+        ActivateNodesFastPath(item, is_dead, iter_state, outputs, ready);
   }
+  return AdjustOutstandingOps(iter_state, activated - decrement_activation,
+                              ready);
 }
 
 int PropagatorState::FrameState::ActivateNodesLocked(const NodeItem* item,
@@ -674,11 +636,9 @@ int PropagatorState::FrameState::ActivateNodesLocked(const NodeItem* item,
                                                      EntryVector* outputs,
                                                      TaggedNodeSeq* ready) {
   if (TF_PREDICT_FALSE(item->is_any_consumer_merge_or_control_trigger)) {
-    return ActivateNodesSlowPathLocked(item, is_dead, iter_state, outputs,
-                                       ready);
+    return ActivateNodesSlowPath(item, is_dead, iter_state, outputs, ready);
   } else {
-    return ActivateNodesFastPathLocked(item, is_dead, iter_state, outputs,
-                                       ready);
+    return ActivateNodesFastPath(item, is_dead, iter_state, outputs, ready);
   }
 }
 
@@ -734,31 +694,21 @@ void PropagatorState::FrameState::AddLoopInv(const NodeItem* item,
   }
 }
 
-bool PropagatorState::FrameState::IsIterationDone(IterationState* iter_state) {
-  if (iter_state->outstanding_ops == 0 &&
-      iter_state->outstanding_frame_count == 0) {
-    if (iter_state->iter_num == 0) {
-      // The enclosing frame has no pending input.
-      return num_pending_inputs == 0;
-    } else {
-      // The preceding iteration is deleted (and therefore done).
-      return (GetIteration(iter_state->iter_num - 1) == nullptr);
-    }
-  }
-  return false;
-}
-
 PropagatorState::IterationState*
 PropagatorState::FrameState::IncrementIteration(TaggedNodeSeq* ready) {
-  iteration_count++;
+  const int64_t next_iter_num =
+      iteration_count.load(std::memory_order_relaxed) + 1;
 
-  // Initialize the next iteration.
+  // Initialize the next iteration. It waits on its predecessor, which is
+  // still live or is being cleaned up by the caller.
   IterationState* next_iter =
-      new IterationState(iteration_count, pending_counts, total_input_tensors);
-  SetIteration(iteration_count, next_iter);
+      new IterationState(next_iter_num, pending_counts, total_input_tensors);
+  SetIteration(next_iter_num, next_iter);
   num_outstanding_iterations++;
   {
     mutex_lock l(iter_mu);
+    // Publish the new iteration after it is in the iteration ring.
+    iteration_count.store(next_iter_num, std::memory_order_release);
     dead_exits.clear();
   }
 
@@ -774,7 +724,8 @@ PropagatorState::FrameState::IncrementIteration(TaggedNodeSeq* ready) {
 bool PropagatorState::FrameState::CleanupIterations(IterationState* iter_state,
                                                     TaggedNodeSeq* ready) {
   int64_t curr_iter = iter_state->iter_num;
-  while (curr_iter <= iteration_count && IsIterationDone(iter_state)) {
+  while (true) {
+    DCHECK_EQ(iter_state->outstanding_ops.load(std::memory_order_relaxed), 0);
     delete iter_state;
     SetIteration(curr_iter, nullptr);
     --num_outstanding_iterations;
@@ -791,9 +742,10 @@ bool PropagatorState::FrameState::CleanupIterations(IterationState* iter_state,
       IncrementIteration(ready);
     }
 
-    if (curr_iter <= iteration_count) {
-      iter_state = GetIteration(curr_iter);
-    }
+    if (curr_iter > iteration_count.load(std::memory_order_relaxed)) break;
+    // The next iteration no longer waits on this one.
+    iter_state = GetIteration(curr_iter);
+    if (iter_state->outstanding_ops.fetch_sub(1) != 1) break;
   }
   return IsFrameDone();
 }
@@ -810,10 +762,10 @@ void PropagatorState::FrameState::SetIteration(int64_t iter,
                                                IterationState* state)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu) {
   size_t index = iter % (max_parallel_iterations + 1);
-  DCHECK(state == nullptr || iterations[index] == nullptr);
-  iterations_raw[index] = state;
+  DCHECK(state == nullptr || iterations[index].load() == nullptr);
+  iterations[index].store(state, std::memory_order_release);
   if (index == 0) {
-    iterations_first = state;
+    iterations_first.store(state, std::memory_order_release);
   }
 }
 
@@ -850,23 +802,16 @@ bool PropagatorState::FrameState::AdjustOutstandingOps(
   if (delta == 0) {
     return false;
   }
-  {
-    tf_shared_lock sl(mu);
-    if (TF_PREDICT_TRUE(!AdjustOutstandingOpsFastPath(iter_state, delta))) {
-      return false;
-    }
+  // Only the thread that drops the count to zero cleans up the iteration, so
+  // the lock is not needed until then.
+  auto old_val = iter_state->outstanding_ops.fetch_add(delta);
+  if (TF_PREDICT_TRUE(old_val + delta != 0)) {
+    return false;
   }
   mutex_lock l(mu);
-  DCHECK(IsIterationDone(iter_state));
   return CleanupIterations(iter_state, ready);
 }
 
-bool PropagatorState::FrameState::AdjustOutstandingOpsFastPath(
-    IterationState* iter_state, int delta) {
-  auto old_val = iter_state->outstanding_ops.fetch_add(delta);
-  return (old_val + delta == 0) && IsIterationDone(iter_state);
-}
-
 // Decrement the outstanding op count and clean up the iterations in the
 // frame. Return true iff the execution of the frame is done.
 bool PropagatorState::FrameState::DecrementOutstandingOpsLocked(
@@ -877,14 +822,12 @@ bool PropagatorState::FrameState::DecrementOutstandingOpsLocked(
 
 bool PropagatorState::FrameState::AdjustOutstandingOpsLocked(
     IterationState* iter_state, int delta, TaggedNodeSeq* ready) {
-  // We hold the lock, so we don't need to use an atomic modification.
-  auto cur_val = iter_state->outstanding_ops.load(std::memory_order_relaxed);
+  // Other threads may adjust the count without holding the lock.
+  auto cur_val = iter_state->outstanding_ops.fetch_add(delta);
   DCHECK(delta >= 0 || cur_val >= -delta)
       << "cannot adjust outstanding_ops by " << delta
       << " when current value is " << cur_val;
-  auto new_val = cur_val + delta;
-  iter_state->outstanding_ops.store(new_val, std::memory_order_relaxed);
-  if (new_val != 0) {
+  if (cur_val + delta != 0) {
     return false;
   }
   return CleanupIterations(iter_state, ready);
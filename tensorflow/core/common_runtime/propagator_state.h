@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_PROPAGATOR_STATE_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_PROPAGATOR_STATE_H_
 
+#include <atomic>
+#include <memory>
 #include <queue>
 #include <vector>
 
@@ -130,8 +132,7 @@ class PropagatorState {
                             int total_input_tensors)
         : iter_num(iter_num),
           input_tensors(new Entry[total_input_tensors]),
-          outstanding_ops(0),
-          outstanding_frame_count(0),
+          outstanding_ops(1),
           counts(*pending_counts) {  // Initialize with copy of *pending_counts
     }
 
@@ -148,11 +149,13 @@ class PropagatorState {
     // edge. The latter node is never run concurrently with the former node.
     Entry* input_tensors;
 
-    // The number of outstanding ops for each iteration.
+    // The number of outstanding ops and child frames of this iteration, plus
+    // one while the iteration is waiting on its predecessor (or, for
+    // iteration 0, on the inputs of the frame). The iteration is done when
+    // the count drops to zero, which is observed by exactly one thread, so
+    // it can be updated without holding the frame lock.
     std::atomic<size_t> outstanding_ops;
 
-    // The number of outstanding frames for each iteration.
-    int outstanding_frame_count;
     int pending(PendingCounts::Handle h) { return counts.pending(h); }
     int decrement_pending(PendingCounts::Handle h, int v) {
       return counts.decrement_pending(h, v);
@@ -218,8 +221,8 @@ class PropagatorState {
         : immutable_state(immutable_state),
           max_parallel_iterations(parallel_iters),
           num_outstanding_iterations(1),
-          iterations(parallel_iters + 1),
-          iterations_raw(iterations.data()) {}
+          iterations(new std::atomic<IterationState*>[parallel_iters + 1]()),
+          iterations_first(nullptr) {}
 
     // A new frame is created for each loop. Execution starts at iteration 0.
     // When a value at iteration 0 passes through a NextIteration node,
@@ -276,16 +279,21 @@ class PropagatorState {
     int num_pending_inputs = 0;
 
     // The highest iteration number we have reached so far in this frame.
-    int64_t iteration_count TF_GUARDED_BY(mu) = 0;
+    // Only written with both `mu` and `iter_mu` held. Iterations below this
+    // number are in the iteration ring, so a reader in iteration `i` that
+    // observes `i < iteration_count` may look up iteration `i + 1` without
+    // any lock.
+    std::atomic<int64_t> iteration_count{0};
 
     // The number of outstanding iterations.
     int num_outstanding_iterations TF_GUARDED_BY(mu) = 1;
 
    private:
-    // The active iteration states of this frame.
-    gtl::InlinedVector<IterationState*, 12> iterations;
-    IterationState** const iterations_raw TF_GUARDED_BY(mu);
-    IterationState* iterations_first TF_GUARDED_BY(mu);
+    // The active iteration states of this frame, indexed by the iteration
+    // number modulo `max_parallel_iterations + 1`. Written with `mu` held,
+    // and read without it.
+    const std::unique_ptr<std::atomic<IterationState*>[]> iterations;
+    std::atomic<IterationState*> iterations_first;
 
    public:
     // The NextIteration nodes to enter a new iteration. If the number of
@@ -321,13 +329,14 @@ class PropagatorState {
 
     void InitializeFrameInfo(const ImmutableExecutorState::FrameInfo& finfo);
 
-    inline IterationState* GetIteration(int64_t iter)
-        TF_SHARED_LOCKS_REQUIRED(mu) {
+    // The caller must hold `mu`, or otherwise ensure that iteration `iter`
+    // is live (for example by running a node in iteration `iter - 1`).
+    inline IterationState* GetIteration(int64_t iter) {
       if (TF_PREDICT_TRUE(iter == 0)) {
-        return iterations_first;
+        return iterations_first.load(std::memory_order_acquire);
       } else {
         size_t index = iter % (max_parallel_iterations + 1);
-        return iterations_raw[index];
+        return iterations[index].load(std::memory_order_acquire);
       }
     }
 
@@ -337,7 +346,7 @@ class PropagatorState {
     // the frame if no more ops are oustanding. Return true iff the execution of
     // the frame is done.
     //
-    // Avoids acquiring the lock in the common case that the frame is not done.
+    // Only acquires the lock when the iteration is done.
     bool AdjustOutstandingOps(IterationState* iter_state, int delta,
                               TaggedNodeSeq* ready);
 
@@ -345,9 +354,6 @@ class PropagatorState {
                                     TaggedNodeSeq* ready)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu);
 
-    bool AdjustOutstandingOpsFastPath(IterationState* iter_state, int delta)
-        TF_SHARED_LOCKS_REQUIRED(mu);
-
     // Convenience methods for the above 'Adjust' calls where delta takes the
     // common value of -1.
     bool DecrementOutstandingOps(IterationState* iter_state,
@@ -359,10 +365,6 @@ class PropagatorState {
     // Returns true if the computation in the frame is completed.
     bool IsFrameDone();
 
-    // Returns true if the iteration of the frame is completed.
-    bool IsIterationDone(IterationState* iter_state)
-        TF_SHARED_LOCKS_REQUIRED(mu);
-
     // Increments the iteration id. If this is a new iteration, initialize it.
     //
     // Returns a pointer to the new iteration.
@@ -385,16 +387,17 @@ class PropagatorState {
     // Activate the successors of a node. Contents of *outputs are left in an
     // indeterminate state after returning from this method.
     //
-    // In the case that 'item' is a simple node (no merge/control outputs) this
-    // will acquire a shared lock and can run concurrently with other
-    // invocations.
+    // This does not acquire the lock unless the iteration is done, and can run
+    // concurrently with other invocations.
     //
     // Return true if the frame is done after activation.
     bool ActivateNodesAndAdjustOutstanding(
         const NodeItem* item, const bool is_dead, IterationState* iter_state,
         EntryVector* outputs, TaggedNodeSeq* ready, int decrement_activation);
 
-    // Same as the above, but requires 'mu' already held in exclusive mode.
+    // Same as the above, but requires 'mu' already held in exclusive mode, and
+    // leaves the outstanding op count to the caller. Returns the number of
+    // activated nodes.
     int ActivateNodesLocked(const NodeItem* item, const bool is_dead,
                             IterationState* iter_state, EntryVector* outputs,
                             TaggedNodeSeq* ready)
@@ -406,7 +409,8 @@ class PropagatorState {
 
     void DumpIterationState(PropagatorState* parent) {
       mutex_lock l(mu);
-      for (IterationState* iteration : iterations) {
+      for (int i = 0; i <= max_parallel_iterations; ++i) {
+        IterationState* iteration = iterations[i].load();
         if (iteration) {
           LOG(WARNING) << "  Iteration:";
           parent->DumpIterationState(this, iteration);
@@ -415,49 +419,23 @@ class PropagatorState {
     }
 
     ~FrameState() {
-      for (size_t i = 0; i < iterations.size(); ++i) {
-        delete iterations[i];
-        iterations[i] = nullptr;
+      for (int i = 0; i <= max_parallel_iterations; ++i) {
+        delete iterations[i].load();
       }
     }
 
    private:
+    // Both variants use atomic operations to modify the pending counts, since
+    // other threads may be activating nodes in the same iteration.
+    //
     // REQUIRES: `!item->is_any_consumer_merge_or_control_trigger`.
-    // This variant does not use atomic operations to modify the pending counts
-    // and thus must hold the exclusive lock.
-    int ActivateNodesFastPathLocked(const NodeItem* item, bool is_dead,
-                                    IterationState* iter_state,
-                                    EntryVector* outputs, TaggedNodeSeq* ready)
-        TF_EXCLUSIVE_LOCKS_REQUIRED(mu);
-
-    // REQUIRES: `!item->is_any_consumer_merge_or_control_trigger`.
-    // This variant uses atomic operations to modify the pending counts.
-    int ActivateNodesFastPathShared(const NodeItem* item, bool is_dead,
-                                    IterationState* iter_state,
-                                    EntryVector* outputs, TaggedNodeSeq* ready)
-        TF_SHARED_LOCKS_REQUIRED(mu);
-
-    int ActivateNodesSlowPathLocked(const NodeItem* item, bool is_dead,
-                                    IterationState* iter_state,
-                                    EntryVector* outputs, TaggedNodeSeq* ready)
-        TF_EXCLUSIVE_LOCKS_REQUIRED(mu);
+    int ActivateNodesFastPath(const NodeItem* item, bool is_dead,
+                              IterationState* iter_state, EntryVector* outputs,
+                              TaggedNodeSeq* ready);
 
-    int ActivateNodesSlowPathShared(const NodeItem* item, bool is_dead,
-                                    IterationState* iter_state,
-                                    EntryVector* outputs, TaggedNodeSeq* ready)
-        TF_SHARED_LOCKS_REQUIRED(mu);
-
-    // Implementation templates. Not for public use.
-    template <bool atomic>
-    int ActivateNodesFastPathInternal(const NodeItem* item, bool is_dead,
-                                      IterationState* iter_state,
-                                      EntryVector* outputs,
-                                      TaggedNodeSeq* ready);
-    template <bool atomic>
-    int ActivateNodesSlowPathInternal(const NodeItem* item, bool is_dead,
-                                      IterationState* iter_state,
-                                      EntryVector* outputs,
-                                      TaggedNodeSeq* ready);
+    int ActivateNodesSlowPath(const NodeItem* item, bool is_dead,
+                              IterationState* iter_state, EntryVector* outputs,
+                              TaggedNodeSeq* ready);
   };
 
  public:
@@ -496,7 +474,6 @@ class PropagatorState {
     // TODO(misard) Replace with a finer-grain enabling flag once we add better
     // optional debugging support.
     if (TF_PREDICT_FALSE(vlog_) && VLOG_IS_ON(1)) {
-      mutex_lock l(tagged_node.input_frame->mu);
       tagged_node.input_iter->mark_started(
           immutable_state_.pending_ids()[tagged_node.node_item->node_id]);
     }
@@ -506,7 +483,6 @@ class PropagatorState {
     // TODO(misard) Replace with a finer-grain enabling flag once we add better
     // optional debugging support.
     if (TF_PREDICT_FALSE(vlog_) && VLOG_IS_ON(1)) {
-      mutex_lock l(tagged_node.input_frame->mu);
       tagged_node.input_iter->mark_completed(
           immutable_state_.pending_ids()[tagged_node.node_item->node_id]);
     }
@@ -563,7 +539,9 @@ inline int64_t PropagatorState::TaggedNode::get_iter_num() const {
 // problem: For example, In usecases that are running close to the RAM limit of
 // a device, reordering ops can cause an increase in memory fragmenenation,
 // causing an OOM.
-// This codepath is enabled using TF_DETERMINISTIC_ORDER=1 in executor.cc
+// This codepath is enabled using TF_DETERMINISTIC_ORDER=1 in executor.cc, or
+// when the graph carries the scheduling priorities computed by Grappler, in
+// which case nodes are dequeued by increasing priority rank.
 class OrderedPropagatorState : public PropagatorState {
   using PropagatorState::PropagatorState;
 
@@ -579,6 +557,12 @@ class OrderedPropagatorState : public PropagatorState {
 
    private:
     static bool compare(TaggedNode const& lhs, TaggedNode const& rhs) {
+      // Nodes with a lower scheduling priority rank are dequeued first.
+      if (lhs.node_item->scheduling_priority !=
+          rhs.node_item->scheduling_priority) {
+        return lhs.node_item->scheduling_priority >
+               rhs.node_item->scheduling_priority;
+      }
       std::tuple<int, uint64, int64_t> lhs_prio{lhs.node_item->node_id,
                                                 lhs.input_frame->frame_id,
                                                 lhs.input_iter->iter_num};
@@ -42,6 +42,17 @@ class RequestCost {
   // rpc request, when all the costs have been collected.
   absl::flat_hash_map<std::string, absl::Duration> GetCosts() const;
 
+  // Records metrics that are not durations, e.g. bytes. The inputs should be
+  // pairs of metric name and value. Values of the same metric are summed.
+  // It's thread-safe, and can be called from different threads.
+  void RecordMetrics(
+      const std::vector<std::pair<absl::string_view, double>>& metrics);
+
+  // Gets all the metrics recorded by RecordMetrics.
+  // It's thread-safe. It's expected to be called at the end of processing an
+  // rpc request, when all the metrics have been collected.
+  absl::flat_hash_map<std::string, double> GetMetrics() const;
+
   // Metrics of each batch that processes this rpc request.
   struct BatchMetrics {
     // Size of the batch.
@@ -71,6 +82,9 @@ class RequestCost {
   absl::flat_hash_map<std::string, absl::Duration> cost_map_
       ABSL_GUARDED_BY(mutex_);
 
+  // Query metrics other than costs. Map from metric name to value.
+  absl::flat_hash_map<std::string, double> metric_map_ ABSL_GUARDED_BY(mutex_);
+
   // Metrics of batches that process this rpc request.
   std::vector<BatchMetrics> batch_metrics_ ABSL_GUARDED_BY(mutex_);
 };
@@ -51,6 +51,18 @@ TEST(RequestCostTest, RecordCost) {
                                    Pair("cpu_v2", absl::Milliseconds(44))));
 }
 
+TEST(RequestCostTest, RecordMetrics) {
+  RequestCost request_cost;
+
+  request_cost.RecordMetrics({{"input_bytes", 10}, {"output_bytes", 20}});
+  request_cost.RecordMetrics({{"input_bytes", 5}, {"transferred_bytes", 1}});
+  EXPECT_THAT(request_cost.GetMetrics(),
+              UnorderedElementsAre(Pair("input_bytes", 15),
+                                   Pair("output_bytes", 20),
+                                   Pair("transferred_bytes", 1)));
+  EXPECT_TRUE(request_cost.GetCosts().empty());
+}
+
 TEST(RequestCostTest, RecordBatchMetrics) {
   RequestCost request_cost;
 
@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -341,6 +342,15 @@ void RingAlg::InitRingField(RingField* rf, int chunk_idx, int subdiv_idx,
   rf->action = RF_INIT;
   // Recv from the device with preceding rank within the subdivision.
   int recv_from_rank = (rf->rank + (group_size_ - 1)) % group_size_;
+  const Tensor* send_tensor = &rf->chunk;
+  if (IsCompressed()) {
+    Status s = Compress(rf);
+    if (!s.ok()) {
+      done(s);
+      return;
+    }
+    send_tensor = &rf->wire_chunk;
+  }
   int send_to_rank = (rf->rank + 1) % group_size_;
   rf->recv_dev_idx = col_params_->instance.impl_details
                          .subdiv_permutations[subdiv_idx][recv_from_rank];
@@ -401,6 +411,15 @@ void RingAlg::DispatchSend(RingField* rf, const StatusCallback& done) {
   VLOG(3) << "DispatchSend rank=" << col_params_->default_rank << " send key "
           << send_buf_key << " chunk " << ca_->TBounds(rf->chunk) << " sc_idx "
           << rf->sc_idx;
+  const Tensor* send_tensor = &rf->chunk;
+  if (IsCompressed()) {
+    Status s = Compress(rf);
+    if (!s.ok()) {
+      done(s);
+      return;
+    }
+    send_tensor = &rf->wire_chunk;
+  }
   int send_to_rank = (rf->rank + 1) % group_size_;
   int send_to_dev_idx = col_params_->instance.impl_details
                             .subdiv_permutations[rf->subdiv_idx][send_to_rank];
@@ -408,7 +427,7 @@ void RingAlg::DispatchSend(RingField* rf, const StatusCallback& done) {
       col_params_->group.members[send_to_dev_idx].device.name(),
       col_params_->group.members[send_to_dev_idx].task, send_buf_key,
       col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
-      col_ctx_->op_ctx->output_alloc_attr(0), &rf->chunk,
+      col_ctx_->op_ctx->output_alloc_attr(0), send_tensor,
       col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
       done);
 }
@@ -424,6 +443,13 @@ void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done) {
   Tensor* dst_tensor = (!rf->second_pass && (col_params_->merge_op != nullptr))
                            ? &rf->tmp_chunk
                            : &rf->chunk;
+  if (IsCompressed()) {
+    rf->wire_chunk = Tensor(
+        col_ctx_->device->GetAllocator(col_ctx_->op_ctx->output_alloc_attr(0)),
+        col_params_->instance.impl_details.compression_type,
+        TensorShape({rf->chunk.NumElements()}));
+    dst_tensor = &rf->wire_chunk;
+  }
   col_ctx_->col_exec->remote_access()->RecvFromPeer(
       col_params_->group.members[rf->recv_dev_idx].device.name(),
       col_params_->group.members[rf->recv_dev_idx].task,
@@ -434,6 +460,121 @@ void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done) {
       col_ctx_->op_ctx->cancellation_manager(), done);
 }
 
+namespace {
+// Error feedback state of one subchunk of a compressed reduction: the part of
+// the values sent by the previous execution that the compression dropped.
+class CompressionResidual : public ResourceBase {
+ public:
+  string DebugString() const override { return "CompressionResidual"; }
+
+  mutex mu;
+  Tensor value TF_GUARDED_BY(mu);
+};
+
+constexpr char kCompressionResidualContainer[] = "collective_compression";
+
+// Copies `src` into `dst`, both on `device`, and waits for the copy.
+Status CopyOnDevice(const CollectiveContext& ctx, const Tensor& src,
+                    Tensor* dst) {
+  Notification note;
+  Status status;
+  CollectiveRemoteAccessLocal::MemCpyAsync(
+      ctx.op_ctx->op_device_context(), ctx.op_ctx->op_device_context(),
+      ctx.device, ctx.device, ctx.op_ctx->output_alloc_attr(0),
+      ctx.op_ctx->output_alloc_attr(0), &src, dst,
+      0 /*dev_to_dev_stream_index*/,
+      [&note, &status](const Status& s) {
+        status = s;
+        note.Notify();
+      });
+  note.WaitForNotification();
+  return status;
+}
+}  // namespace
+
+bool RingAlg::IsCompressed() const {
+  return col_params_->instance.type == REDUCTION_COLLECTIVE &&
+         col_params_->instance.impl_details.compression_type != DT_INVALID &&
+         col_params_->compress_op != nullptr &&
+         col_params_->decompress_op != nullptr;
+}
+
+Status RingAlg::Compress(RingField* rf) {
+  const CollImplDetails& impl = col_params_->instance.impl_details;
+  // Error feedback only applies to partial sums, i.e. the first pass of an
+  // Add reduction.
+  const bool error_feedback =
+      impl.compression_error_feedback && !rf->second_pass &&
+      col_params_->sub_op != nullptr &&
+      col_params_->merge_op->type_string() == "Add";
+  if (!error_feedback) {
+    TF_RETURN_IF_ERROR(collective_util::ComputeUnaryOp(
+        col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+        col_params_->compress_op, &rf->chunk, &rf->wire_chunk));
+    if (rf->second_pass && !rf->do_recv) {
+      // The owner of the fully reduced chunk rounds its own copy the way
+      // the other devices will, so that all of them end up with equal values.
+      Tensor rounded;
+      TF_RETURN_IF_ERROR(collective_util::ComputeUnaryOp(
+          col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+          col_params_->decompress_op, &rf->wire_chunk, &rounded));
+      TF_RETURN_IF_ERROR(CopyOnDevice(*col_ctx_, rounded, &rf->chunk));
+    }
+    return absl::OkStatus();
+  }
+
+  ResourceMgr* rm = col_ctx_->device->resource_manager();
+  if (rm == nullptr) {
+    return errors::Internal("Device ", col_ctx_->device_name,
+                            " has no resource manager for error feedback");
+  }
+  CompressionResidual* residual = nullptr;
+  TF_RETURN_IF_ERROR(rm->LookupOrCreate<CompressionResidual>(
+      kCompressionResidualContainer,
+      strings::StrCat(col_params_->group.group_key, ":",
+                      col_params_->instance.instance_key, ":", rf->sc_idx),
+      &residual, [](CompressionResidual** r) {
+        *r = new CompressionResidual;
+        return absl::OkStatus();
+      }));
+  core::ScopedUnref unref(residual);
+  mutex_lock l(residual->mu);
+  if (!residual->value.IsInitialized() ||
+      residual->value.NumElements() != rf->chunk.NumElements()) {
+    residual->value = Tensor(
+        col_ctx_->device->GetAllocator(col_ctx_->op_ctx->output_alloc_attr(0)),
+        rf->chunk.dtype(), rf->chunk.shape());
+    TF_RETURN_IF_ERROR(CopyOnDevice(*col_ctx_, rf->chunk, &residual->value));
+  } else {
+    TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+        col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+        col_params_->merge_op, &residual->value, &rf->chunk));
+  }
+  TF_RETURN_IF_ERROR(collective_util::ComputeUnaryOp(
+      col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+      col_params_->compress_op, &residual->value, &rf->wire_chunk));
+  Tensor sent;
+  TF_RETURN_IF_ERROR(collective_util::ComputeUnaryOp(
+      col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+      col_params_->decompress_op, &rf->wire_chunk, &sent));
+  // What is left is carried over to the next execution.
+  return collective_util::ComputeBinOp(
+      col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+      col_params_->sub_op, &residual->value, &sent);
+}
+
+Status RingAlg::Decompress(RingField* rf) {
+  Tensor decompressed;
+  TF_RETURN_IF_ERROR(collective_util::ComputeUnaryOp(
+      col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+      col_params_->decompress_op, &rf->wire_chunk, &decompressed));
+  if (!rf->second_pass) {
+    rf->tmp_chunk = decompressed;
+    return absl::OkStatus();
+  }
+  return CopyOnDevice(*col_ctx_, decompressed, &rf->chunk);
+}
+
 string RingAlg::FieldState() {
   string s = strings::StrCat(
       "Ring", name_, " ", strings::Hex(reinterpret_cast<uint64>(this)),
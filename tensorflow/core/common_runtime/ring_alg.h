@@ -75,6 +75,7 @@ class RingAlg : public CollectiveImplementationInterface {
     bool is_final = false;  // is the last field in the pass for this rank
     Tensor chunk;           // alias to field values
     Tensor tmp_chunk;
+    Tensor wire_chunk;      // chunk as transferred, when compressed
     Status status;
     string DebugString() const;
   };
@@ -84,6 +85,16 @@ class RingAlg : public CollectiveImplementationInterface {
   void DispatchSend(RingField* rf, const StatusCallback& done);
   void DispatchRecv(RingField* rf, const StatusCallback& done);
 
+  // True if the chunks of this reduction are compressed in transfer, see
+  // CollImplDetails::compression_type.
+  bool IsCompressed() const;
+  // Sets rf->wire_chunk to the compressed value of rf->chunk, adding in the
+  // residual of the previous execution under error feedback.
+  Status Compress(RingField* rf);
+  // Decompresses a received rf->wire_chunk into rf->tmp_chunk in the first
+  // pass and into rf->chunk in the second.
+  Status Decompress(RingField* rf);
+
   // For constructing log messages for debugging.
   string FieldState();
   string TensorDebugString(const Tensor& tensor);
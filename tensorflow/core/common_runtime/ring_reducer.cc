@@ -252,6 +252,13 @@ bool RingReducer::RunAsyncParts() {
           case RF_RECV:
             CHECK_GT(recv_pending_count, 0);
             --recv_pending_count;
+            if (IsCompressed()) {
+              Status s = Decompress(rf);
+              if (!s.ok()) {
+                aborted = true;
+                StartAbort(s);
+              }
+            }
             if (!rf->second_pass) {
               rf->action = RF_REDUCE;
               Status s = collective_util::ComputeBinOp(
@@ -0,0 +1,253 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Microbenchmarks of the hot paths of the runtime: executor scheduling,
+// intra-process rendezvous, the BFC allocator, DirectSession callables and
+// eager op dispatch. The components have narrower benchmarks next to their
+// tests; this target covers all of them, so that one run can be compared
+// across releases.
+//
+// Machine-readable results come from the standard benchmark flags, e.g.
+//   bazel run -c opt //tensorflow/core/common_runtime:runtime_benchmark_test
+//     -- --benchmark_filter=all --benchmark_format=json
+//     --benchmark_out=/tmp/runtime_benchmarks.json
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/cc/framework/scope.h"
+#include "tensorflow/cc/ops/array_ops.h"
+#include "tensorflow/cc/ops/math_ops.h"
+#include "tensorflow/cc/ops/while_loop.h"
+#include "tensorflow/core/common_runtime/bfc_allocator.h"
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/eager/context.h"
+#include "tensorflow/core/common_runtime/eager/eager_operation.h"
+#include "tensorflow/core/common_runtime/eager/execute.h"
+#include "tensorflow/core/common_runtime/eager/tensor_handle.h"
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/common_runtime/pool_allocator.h"
+#include "tensorflow/core/common_runtime/rendezvous_mgr.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/rendezvous.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/platform/numa.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kCpuDevice[] = "/job:localhost/replica:0/task:0/device:CPU:0";
+
+// Executor: a chain of `length` Identity ops, which can only run one at a
+// time.
+void BM_ExecutorChain(::testing::benchmark::State& state) {
+  const int length = state.range(0);
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* node = test::graph::Constant(g, test::AsScalar<float>(1.0));
+  for (int i = 0; i < length; ++i) {
+    node = test::graph::Identity(g, node);
+  }
+  FixupSourceAndSinkEdges(g);
+  test::Benchmark("cpu", g, /*old_benchmark_api=*/false).Run(state);
+  state.SetItemsProcessed(length * static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_ExecutorChain)->UseRealTime()->Arg(16)->Arg(256)->Arg(4096);
+
+// Executor: `width` Identity ops that become ready at the same time.
+void BM_ExecutorFanOut(::testing::benchmark::State& state) {
+  const int width = state.range(0);
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* input = test::graph::Constant(g, test::AsScalar<float>(1.0));
+  for (int i = 0; i < width; ++i) {
+    test::graph::Identity(g, input);
+  }
+  FixupSourceAndSinkEdges(g);
+  test::Benchmark("cpu", g, /*old_benchmark_api=*/false).Run(state);
+  state.SetItemsProcessed(width * static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_ExecutorFanOut)->UseRealTime()->Arg(16)->Arg(256)->Arg(4096);
+
+// Executor: a v1 control flow while loop running `iterations` iterations of
+// `i = i + 1`.
+void BM_ExecutorWhileLoop(::testing::benchmark::State& state) {
+  const int iterations = state.range(0);
+  Scope root = Scope::NewRootScope().ExitOnError();
+  auto i = ops::Const(root, 0);
+  auto n = ops::Const(root, iterations);
+  ops::OutputList outputs;
+  TF_CHECK_OK(ops::BuildWhileLoop(
+      root, {i},
+      [&n](const Scope& s, const std::vector<Output>& inputs, Output* output) {
+        *output = ops::Less(s, inputs[0], n);
+        return s.status();
+      },
+      [](const Scope& s, const std::vector<Output>& inputs,
+         std::vector<Output>* outputs) {
+        outputs->push_back(ops::Add(s, inputs[0], 1));
+        return s.status();
+      },
+      "loop", &outputs));
+  Graph* g = new Graph(OpRegistry::Global());
+  TF_CHECK_OK(root.ToGraph(g));
+  FixupSourceAndSinkEdges(g);
+  test::Benchmark("cpu", g, /*old_benchmark_api=*/false).Run(state);
+  state.SetItemsProcessed(iterations *
+                          static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_ExecutorWhileLoop)->UseRealTime()->Arg(16)->Arg(1024);
+
+// Rendezvous: a send followed by a receive of the same key on an
+// IntraProcessRendezvous.
+void BM_IntraProcessRendezvousSendRecv(::testing::benchmark::State& state) {
+  std::unique_ptr<Device> device =
+      DeviceFactory::NewDevice("CPU", {}, "/job:localhost/replica:0/task:0");
+  StaticDeviceMgr device_mgr(std::move(device));
+  auto* rendezvous = new RefCountedIntraProcessRendezvous(&device_mgr);
+  const string key_str = Rendezvous::CreateKey(kCpuDevice, 1, kCpuDevice,
+                                               "tensor", FrameAndIter(0, 0));
+  Rendezvous::ParsedKey key;
+  TF_CHECK_OK(Rendezvous::ParseKey(key_str, &key));
+  const Tensor value = test::AsScalar<float>(1.0);
+  Rendezvous::Args args;
+  args.device_context = nullptr;
+  args.alloc_attrs.set_on_host(true);
+
+  for (auto s : state) {
+    TF_CHECK_OK(rendezvous->Send(key, args, value, /*is_dead=*/false));
+    rendezvous->RecvAsync(
+        key, args,
+        [](const Status& status, const Rendezvous::Args& /*send_args*/,
+           const Rendezvous::Args& /*recv_args*/, const Tensor& /*tensor*/,
+           bool /*is_dead*/) { TF_CHECK_OK(status); });
+  }
+  rendezvous->Unref();
+}
+BENCHMARK(BM_IntraProcessRendezvousSendRecv);
+
+std::unique_ptr<BFCAllocator> NewCpuBFCAllocator() {
+  BFCAllocator::Options options;
+  options.allow_growth = true;
+  return std::make_unique<BFCAllocator>(
+      std::make_unique<BasicCPUAllocator>(port::kNUMANoAffinity,
+                                          std::vector<SubAllocator::Visitor>(),
+                                          std::vector<SubAllocator::Visitor>()),
+      /*total_memory=*/1LL << 32, "runtime_benchmark_bfc", options);
+}
+
+// BFC allocator: allocating and freeing one buffer of `size` bytes.
+void BM_BFCAllocatorAllocateFree(::testing::benchmark::State& state) {
+  const size_t size = state.range(0);
+  std::unique_ptr<BFCAllocator> allocator = NewCpuBFCAllocator();
+  for (auto s : state) {
+    void* p = allocator->AllocateRaw(Allocator::kAllocatorAlignment, size);
+    tensorflow::testing::DoNotOptimize(p);
+    allocator->DeallocateRaw(p);
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_BFCAllocatorAllocateFree)->Arg(64)->Arg(64 << 10)->Arg(16 << 20);
+
+// BFC allocator: `num_buffers` live buffers of mixed sizes, freed in an order
+// different from the allocation order, which exercises chunk splitting and
+// coalescing like the tensors of a step do.
+void BM_BFCAllocatorMixedSizes(::testing::benchmark::State& state) {
+  const int num_buffers = state.range(0);
+  std::unique_ptr<BFCAllocator> allocator = NewCpuBFCAllocator();
+  std::vector<void*> buffers(num_buffers);
+  for (auto s : state) {
+    for (int i = 0; i < num_buffers; ++i) {
+      const size_t size = 256 << (i % 8);
+      buffers[i] =
+          allocator->AllocateRaw(Allocator::kAllocatorAlignment, size);
+    }
+    for (int i = 0; i < num_buffers; i += 2) {
+      allocator->DeallocateRaw(buffers[i]);
+    }
+    for (int i = 1; i < num_buffers; i += 2) {
+      allocator->DeallocateRaw(buffers[i]);
+    }
+  }
+  state.SetItemsProcessed(num_buffers *
+                          static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_BFCAllocatorMixedSizes)->Arg(16)->Arg(256);
+
+// DirectSession: the overhead of running a callable that feeds and fetches a
+// scalar through one Identity op.
+void BM_DirectSessionRunCallable(::testing::benchmark::State& state) {
+  Scope root = Scope::NewRootScope().ExitOnError();
+  auto x = ops::Placeholder(root.WithOpName("x"), DT_FLOAT);
+  ops::Identity(root.WithOpName("y"), x);
+  GraphDef graph_def;
+  TF_CHECK_OK(root.ToGraphDef(&graph_def));
+
+  std::unique_ptr<Session> session(NewSession(SessionOptions()));
+  TF_CHECK_OK(session->Create(graph_def));
+  CallableOptions callable_options;
+  callable_options.add_feed("x:0");
+  callable_options.add_fetch("y:0");
+  Session::CallableHandle handle;
+  TF_CHECK_OK(session->MakeCallable(callable_options, &handle));
+
+  const std::vector<Tensor> feeds = {test::AsScalar<float>(1.0)};
+  std::vector<Tensor> fetches;
+  for (auto s : state) {
+    TF_CHECK_OK(session->RunCallable(handle, feeds, &fetches, nullptr));
+  }
+  TF_CHECK_OK(session->ReleaseCallable(handle));
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_DirectSessionRunCallable);
+
+// Eager: dispatching one Identity op on a scalar to the local CPU.
+void BM_EagerExecute(::testing::benchmark::State& state) {
+  StaticDeviceMgr device_mgr(
+      DeviceFactory::NewDevice("CPU", {}, "/job:localhost/replica:0/task:0"));
+  auto* ctx = new EagerContext(
+      SessionOptions(),
+      tensorflow::ContextDevicePlacementPolicy::DEVICE_PLACEMENT_SILENT,
+      /*async=*/false, &device_mgr, /*device_mgr_owned=*/false,
+      /*rendezvous=*/nullptr, /*cluster_flr=*/nullptr);
+  Tensor value = test::AsScalar<float>(1.0);
+  core::RefCountPtr<ImmediateExecutionTensorHandle> input(
+      ctx->CreateLocalHandleFromTFTensor(value, ctx->HostCPUName().c_str()));
+
+  for (auto s : state) {
+    EagerOperation op(ctx);
+    TF_CHECK_OK(op.Reset("Identity", kCpuDevice));
+    TF_CHECK_OK(op.AddInput(input.get()));
+    TensorHandle* retval = nullptr;
+    int num_retvals = 1;
+    TF_CHECK_OK(EagerExecute(&op, &retval, &num_retvals));
+    retval->Unref();
+  }
+  input.reset();
+  ctx->Unref();
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_EagerExecute);
+
+}  // namespace
+}  // namespace tensorflow
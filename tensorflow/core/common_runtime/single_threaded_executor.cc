@@ -20,7 +20,9 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/entry.h"
 #include "tensorflow/core/common_runtime/executor.h"
 #include "tensorflow/core/common_runtime/executor_factory.h"
+#include "tensorflow/core/common_runtime/frozen_memory_plan.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -68,6 +70,115 @@ typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
 static const string& kSingleThreadedExecutor =
     *new string("SINGLE_THREADED_EXECUTOR");
 
+// The step allocator that kernels running on the current thread should use
+// instead of the base allocator of `plan`, if any.
+struct CurrentStepAllocator {
+  const FrozenMemoryPlan* plan = nullptr;
+  Allocator* allocator = nullptr;
+};
+thread_local CurrentStepAllocator current_step_allocator;
+
+// Wraps the device of an executor that uses a frozen memory plan, so that the
+// kernels it runs allocate from the step allocator of the plan. Allocations
+// made from other threads (e.g. by intra-op workers) and allocations with
+// attributes that map to a different allocator use the underlying device.
+class FrozenPlanDevice : public Device {
+ public:
+  FrozenPlanDevice(Device* underlying, const FrozenMemoryPlan* plan)
+      : Device(underlying->env(), underlying->attributes()),
+        underlying_device_(underlying),
+        plan_(plan) {}
+
+  const DeviceBase* UnderlyingDevice() const override {
+    return underlying_device_->UnderlyingDevice();
+  }
+  DeviceBase* UnderlyingDevice() override {
+    return underlying_device_->UnderlyingDevice();
+  }
+
+  const CpuWorkerThreads* tensorflow_cpu_worker_threads() const override {
+    return underlying_device_->tensorflow_cpu_worker_threads();
+  }
+
+  const DeviceBase::AcceleratorDeviceInfo* tensorflow_accelerator_device_info()
+      const override {
+    return underlying_device_->tensorflow_accelerator_device_info();
+  }
+
+  Allocator* GetAllocator(AllocatorAttributes attr) override {
+    Allocator* allocator = underlying_device_->GetAllocator(attr);
+    if (current_step_allocator.plan == plan_ &&
+        allocator == plan_->base_allocator()) {
+      return current_step_allocator.allocator;
+    }
+    return allocator;
+  }
+
+  Allocator* GetScopedAllocator(AllocatorAttributes attr,
+                                int64_t step_id) override {
+    return underlying_device_->GetScopedAllocator(attr, step_id);
+  }
+
+  ScopedAllocatorMgr* GetScopedAllocatorMgr() const override {
+    return underlying_device_->GetScopedAllocatorMgr();
+  }
+
+  const Eigen::ThreadPoolDevice* eigen_cpu_device() override {
+    return underlying_device_->eigen_cpu_device();
+  }
+
+  thread::ThreadPool* tensorflow_device_thread_pool() override {
+    return underlying_device_->tensorflow_device_thread_pool();
+  }
+
+  bool has_eigen_cpu_device() const override {
+    return underlying_device_->has_eigen_cpu_device();
+  }
+
+  PerOpGpuDevice* MakeGpuDevice() override {
+    return underlying_device_->MakeGpuDevice();
+  }
+
+  Status ReinitializeGpuDevice(OpKernelContext* context, PerOpGpuDevice* device,
+                               DeviceContext* dc,
+                               Allocator* allocator) override {
+    return underlying_device_->ReinitializeGpuDevice(context, device, dc,
+                                                     allocator);
+  }
+
+  Status MakeTensorFromProto(const TensorProto& tensor_proto,
+                             const AllocatorAttributes alloc_attrs,
+                             Tensor* tensor) override {
+    return underlying_device_->MakeTensorFromProto(tensor_proto, alloc_attrs,
+                                                   tensor);
+  }
+
+  void Compute(OpKernel* op_kernel, OpKernelContext* context) override {
+    underlying_device_->Compute(op_kernel, context);
+  }
+
+  void ComputeAsync(AsyncOpKernel* op_kernel, OpKernelContext* context,
+                    AsyncOpKernel::DoneCallback done) override {
+    underlying_device_->ComputeAsync(op_kernel, context, std::move(done));
+  }
+
+  Status Sync() override { return underlying_device_->Sync(); }
+
+  Status TryGetDeviceContext(DeviceContext** out_context) override {
+    return underlying_device_->TryGetDeviceContext(out_context);
+  }
+
+  ResourceMgr* resource_manager() override {
+    return underlying_device_->resource_manager();
+  }
+
+  bool IsLocal() const override { return underlying_device_->IsLocal(); }
+
+ private:
+  Device* const underlying_device_;
+  const FrozenMemoryPlan* const plan_;
+};
+
 class SingleThreadedExecutorImpl : public Executor {
  public:
   explicit SingleThreadedExecutorImpl(const LocalExecutorParams& params)
@@ -83,6 +194,14 @@ class SingleThreadedExecutorImpl : public Executor {
   }
 
   Status Initialize(const Graph& graph) {
+    if (params_.use_frozen_memory_plan) {
+      frozen_plan_ = std::make_unique<FrozenMemoryPlan>(
+          params_.device->GetAllocator(AllocatorAttributes()),
+          params_.frozen_memory_plan_stable_steps);
+      frozen_plan_device_ = std::make_unique<FrozenPlanDevice>(
+          params_.device, frozen_plan_.get());
+    }
+
     // Topologicially sort `graph` to get a sequence of OpKernels.
     std::vector<Node*> ordered_nodes;
     ordered_nodes.reserve(graph.num_nodes());
@@ -251,10 +370,55 @@ class SingleThreadedExecutorImpl : public Executor {
     } else {
       total_num_inputs_ = 0;
     }
+
+    if (params_.use_static_memory_plan && frozen_plan_ == nullptr) {
+      kernel_node_ids_.reserve(kernels_.size());
+      for (const Node* n : nodes_with_kernels) {
+        kernel_node_ids_.push_back(n->id());
+      }
+      // Only plan the outputs that kernels allocate from the device allocator.
+      auto can_plan_output = [&](const Node& n, int output) {
+        auto it = node_to_index_map.find(const_cast<Node*>(&n));
+        return it != node_to_index_map.end() &&
+               kernels_[it->second].output_alloc_attrs[output].value == 0;
+      };
+      auto plan = std::make_shared<StaticMemoryPlan>();
+      TF_RETURN_IF_ERROR(ComputeStaticMemoryPlan(graph, ordered_nodes,
+                                                 can_plan_output, plan.get()));
+      if (plan->num_planned_outputs > 0) static_plan_ = std::move(plan);
+    }
     return absl::OkStatus();
   }
 
   Status Run(const Args& args) override {
+    // If the executor uses a frozen memory plan, the intermediate tensors of
+    // the kernels are allocated from a step allocator of the plan. The cleanup
+    // is declared before `inputs` below, so that it runs after any tensors left
+    // in `inputs` by an error have been released.
+    Device* device = params_.device;
+    FrozenMemoryPlan::StepAllocator* step_allocator = nullptr;
+    if (frozen_plan_ != nullptr && args.user_intra_op_threadpool == nullptr) {
+      step_allocator = frozen_plan_->StartStep();
+      device = frozen_plan_device_.get();
+    }
+    const CurrentStepAllocator enclosing_step_allocator =
+        current_step_allocator;
+    if (step_allocator != nullptr) {
+      current_step_allocator = {frozen_plan_.get(), step_allocator};
+    }
+    // Likewise, if the executor uses a static memory plan, the planned outputs
+    // are allocated from the arena of a step allocator of the plan.
+    StaticPlanAllocator* static_plan_allocator = nullptr;
+    if (static_plan_ != nullptr) {
+      static_plan_allocator = StaticPlanAllocator::Create(
+          params_.device->GetAllocator(AllocatorAttributes()), static_plan_);
+    }
+    auto step_allocator_cleanup = gtl::MakeCleanup([&] {
+      current_step_allocator = enclosing_step_allocator;
+      if (step_allocator != nullptr) frozen_plan_->EndStep(step_allocator);
+      if (static_plan_allocator != nullptr) static_plan_allocator->EndStep();
+    });
+
     // The inputs to each kernel are stored contiguously in `inputs`.
     //
     // We use `kernels_[i].input_start_index` and `kernels_[i].num_inputs` to
@@ -296,7 +460,6 @@ class SingleThreadedExecutorImpl : public Executor {
     AllocatorAttributeVec input_alloc_attrs;
 
     // Override intra op thread pool if requested.
-    Device* device = params_.device;
     std::unique_ptr<Device> user_device;
     if (args.user_intra_op_threadpool != nullptr) {
       user_device = RenamedDevice::NewRenamedDevice(
@@ -310,6 +473,7 @@ class SingleThreadedExecutorImpl : public Executor {
     params.step_id = args.step_id;
     params.device = device;
     params.log_memory = false;  // TODO(mrry): Too severe?
+    params.step_arena = static_plan_allocator;
     params.rendezvous = args.rendezvous;
     params.session_state = args.session_state;
     params.session_metadata = params_.session_metadata;
@@ -440,6 +604,9 @@ class SingleThreadedExecutorImpl : public Executor {
       params.input_alloc_attrs = input_alloc_attrs;
       params.op_kernel = kernel_state.kernel;
       params.output_attr_array = kernel_state.output_alloc_attrs.data();
+      if (static_plan_allocator != nullptr) {
+        static_plan_allocator->SetCurrentNode(kernel_node_ids_[i]);
+      }
       OpKernelContext ctx(&params, num_outputs);
 
       // Actually execute the kernel.
@@ -499,6 +666,17 @@ class SingleThreadedExecutorImpl : public Executor {
 
   // All following members are read-only after Initialize().
 
+  // Set iff `params_.use_frozen_memory_plan` is true.
+  std::unique_ptr<FrozenMemoryPlan> frozen_plan_;
+  std::unique_ptr<FrozenPlanDevice> frozen_plan_device_;
+
+  // Set iff `params_.use_static_memory_plan` is true, and the plan assigns an
+  // arena offset to at least one output.
+  std::shared_ptr<const StaticMemoryPlan> static_plan_;
+  // The id of the node of each element of `kernels_`, if `static_plan_` is
+  // set.
+  std::vector<int> kernel_node_ids_;
+
   // The sum of the number of inputs for each node in the graph. This determines
   // the length of the flat `inputs` vector. See comment at the beginning of
   // `RunAsync()` for details.
@@ -17,6 +17,7 @@ limitations under the License.
 #include <functional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "tensorflow/core/common_runtime/device.h"
@@ -29,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/rendezvous.h"
+#include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/graph.h"
@@ -90,6 +92,8 @@ class ExecutorTest : public ::testing::Test {
     const int version = graph->versions().producer();
     LocalExecutorParams params;
     params.device = device_.get();
+    params.use_frozen_memory_plan = use_frozen_memory_plan_;
+    params.use_static_memory_plan = use_static_memory_plan_;
     params.create_kernel =
         [this, mock_fn = std::move(mock_fn), version](
             const std::shared_ptr<const NodeProperties>& props,
@@ -151,6 +155,8 @@ class ExecutorTest : public ::testing::Test {
     EXPECT_TRUE(mock_called);
   }
 
+  bool use_frozen_memory_plan_ = false;
+  bool use_static_memory_plan_ = false;
   std::unique_ptr<Device> device_;
   std::unique_ptr<Executor> exec_ = nullptr;
   Executor::Args::Runner runner_;
@@ -325,6 +331,46 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(retvals[0]));
 }
 
+TEST_F(ExecutorTest, RandomTreeWithFrozenMemoryPlan) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  use_frozen_memory_plan_ = true;
+  Create(std::move(g));
+  // The first step records the memory plan, and the later steps replay it.
+  for (int i = 0; i < 3; ++i) {
+    FunctionCallFrame call_frame({DT_FLOAT}, {DT_FLOAT});
+    TF_ASSERT_OK(call_frame.SetArgs({V(i + 1.0)}));
+    TF_ASSERT_OK(Run(&call_frame));
+    std::vector<Tensor> retvals;
+    TF_ASSERT_OK(call_frame.ConsumeRetvals(&retvals, false));
+    EXPECT_EQ(4096.0 * (i + 1), V(retvals[0]));
+  }
+}
+
+TEST_F(ExecutorTest, SelfAddWithStaticMemoryPlan) {
+  // Same as SelfAdd, with a statically known shape for the argument, so that
+  // the intermediate sums are planned in an arena.
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto v = test::graph::Arg(g.get(), 0, DT_FLOAT);
+  v->AddAttr("_output_shapes",
+             std::vector<PartialTensorShape>{PartialTensorShape({})});
+  for (int i = 1; i <= 10; ++i) {
+    v = test::graph::Add(g.get(), v, v);
+  }
+  test::graph::Retval(g.get(), 0, v);
+  FixupSourceAndSinkEdges(g.get());
+  use_static_memory_plan_ = true;
+  Create(std::move(g));
+  for (int i = 0; i < 3; ++i) {
+    FunctionCallFrame call_frame({DT_FLOAT}, {DT_FLOAT});
+    TF_ASSERT_OK(call_frame.SetArgs({V(i + 1.0)}));
+    TF_ASSERT_OK(Run(&call_frame));
+    std::vector<Tensor> retvals;
+    TF_ASSERT_OK(call_frame.ConsumeRetvals(&retvals, false));
+    EXPECT_EQ(1024.0 * (i + 1), V(retvals[0]));
+  }
+}
+
 TEST_F(ExecutorTest, OpError) {
   auto g = std::make_unique<Graph>(OpRegistry::Global());
   auto zero = test::graph::Constant(g.get(), V(0.0));
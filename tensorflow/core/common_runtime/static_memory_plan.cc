@@ -0,0 +1,206 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include "tensorflow/core/common_runtime/frozen_memory_plan.h"
+#include "tensorflow/core/common_runtime/shape_refiner.h"
+#include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Outputs beyond this index are never planned, so that the slots used by a
+// node fit in one bit mask.
+constexpr int kMaxPlannedOutputs = 64;
+
+// Returns the size in bytes of output `index` of `n`, or 0 if it is not known
+// before the graph runs.
+size_t StaticOutputSize(const ShapeRefiner& refiner, const Node& n,
+                        int index) {
+  const DataType dtype = n.output_type(index);
+  if (IsRefType(dtype) || !DataTypeCanUseMemcpy(dtype)) return 0;
+  shape_inference::InferenceContext* c = refiner.GetContext(&n);
+  if (c == nullptr) return 0;
+  shape_inference::ShapeHandle shape = c->output(index);
+  if (!c->FullyDefined(shape)) return 0;
+  const int64_t num_elements = c->Value(c->NumElements(shape));
+  if (num_elements <= 0) return 0;
+  return num_elements * DataTypeSize(dtype);
+}
+
+}  // namespace
+
+Status ComputeStaticMemoryPlan(
+    const Graph& graph, absl::Span<Node* const> order,
+    const std::function<bool(const Node&, int)>& can_plan_output,
+    StaticMemoryPlan* plan) {
+  std::vector<int64_t> position(graph.num_node_ids(), -1);
+  for (size_t i = 0; i < order.size(); ++i) {
+    position[order[i]->id()] = i;
+  }
+
+  ShapeRefiner refiner(graph.versions(), graph.op_registry());
+  refiner.set_require_shape_inference_fns(false);
+
+  struct Candidate {
+    int node_id;
+    int output;
+  };
+  std::vector<Candidate> candidates;
+  std::vector<PlannedAllocation> allocations;
+  for (Node* n : order) {
+    if (n->IsSource() || n->IsSink()) continue;
+    Status s = refiner.AddNode(n);
+    if (!s.ok()) {
+      // The outputs of `n`, and of the nodes that depend on them, have
+      // unknown shapes.
+      VLOG(2) << "Not planning the outputs of " << n->name() << ": " << s;
+      continue;
+    }
+    if (n->IsArg()) continue;
+    const int num_outputs = std::min(n->num_outputs(), kMaxPlannedOutputs);
+    for (int i = 0; i < num_outputs; ++i) {
+      const size_t size = StaticOutputSize(refiner, *n, i);
+      if (size == 0 || !can_plan_output(*n, i)) continue;
+      const int64_t first_use = position[n->id()];
+      int64_t last_use = first_use;
+      for (const Edge* e : n->out_edges()) {
+        if (e->IsControlEdge() || e->src_output() != i) continue;
+        if (e->dst()->IsRetval() || position[e->dst()->id()] < 0) {
+          // The tensor escapes the graph.
+          last_use = -1;
+          break;
+        }
+        last_use = std::max(last_use, position[e->dst()->id()]);
+      }
+      if (last_use < 0) continue;
+      candidates.push_back({n->id(), i});
+      allocations.push_back({size, first_use, last_use});
+    }
+  }
+
+  std::vector<int64_t> offsets;
+  plan->arena_size = ComputeArenaOffsets(
+      allocations, Allocator::kAllocatorAlignment, &offsets);
+  plan->node_outputs.assign(graph.num_node_ids(), {});
+  plan->num_planned_outputs = 0;
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    if (offsets[i] < 0) continue;
+    std::vector<StaticMemoryPlan::Slot>& slots =
+        plan->node_outputs[candidates[i].node_id];
+    if (slots.size() <= static_cast<size_t>(candidates[i].output)) {
+      slots.resize(candidates[i].output + 1);
+    }
+    slots[candidates[i].output] = {offsets[i], allocations[i].size};
+    ++plan->num_planned_outputs;
+  }
+  VLOG(1) << "Planned " << plan->num_planned_outputs << " outputs in an arena"
+          << " of " << plan->arena_size << " bytes.";
+  return absl::OkStatus();
+}
+
+StaticPlanAllocator* StaticPlanAllocator::Create(
+    Allocator* base_allocator, std::shared_ptr<const StaticMemoryPlan> plan) {
+  return new StaticPlanAllocator(base_allocator, std::move(plan));
+}
+
+StaticPlanAllocator::StaticPlanAllocator(
+    Allocator* base_allocator, std::shared_ptr<const StaticMemoryPlan> plan)
+    : base_allocator_(base_allocator), plan_(std::move(plan)) {
+  if (plan_->arena_size > 0) {
+    arena_ = static_cast<char*>(base_allocator_->AllocateRaw(
+        Allocator::kAllocatorAlignment, plan_->arena_size));
+  }
+}
+
+StaticPlanAllocator::~StaticPlanAllocator() {
+  if (arena_ != nullptr) base_allocator_->DeallocateRaw(arena_);
+}
+
+void StaticPlanAllocator::Unref() {
+  if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) delete this;
+}
+
+void StaticPlanAllocator::EndStep() { Unref(); }
+
+void StaticPlanAllocator::SetCurrentNode(int node_id) {
+  mutex_lock l(mu_);
+  current_node_ = node_id;
+  used_slots_ = 0;
+}
+
+int64_t StaticPlanAllocator::num_arena_allocations() const {
+  mutex_lock l(mu_);
+  return num_arena_allocations_;
+}
+
+void* StaticPlanAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  if (arena_ != nullptr && alignment <= Allocator::kAllocatorAlignment) {
+    mutex_lock l(mu_);
+    if (current_node_ >= 0) {
+      const std::vector<StaticMemoryPlan::Slot>& slots =
+          plan_->node_outputs[current_node_];
+      for (size_t i = 0; i < slots.size(); ++i) {
+        const StaticMemoryPlan::Slot& slot = slots[i];
+        if (slot.offset < 0 || slot.size != num_bytes ||
+            (used_slots_ & (uint64_t{1} << i)) != 0) {
+          continue;
+        }
+        if (!TryReserve(slot.offset, slot.size)) break;
+        used_slots_ |= uint64_t{1} << i;
+        ++num_arena_allocations_;
+        refs_.fetch_add(1, std::memory_order_relaxed);
+        return arena_ + slot.offset;
+      }
+    }
+  }
+  void* ptr = base_allocator_->AllocateRaw(alignment, num_bytes);
+  if (ptr != nullptr) refs_.fetch_add(1, std::memory_order_relaxed);
+  return ptr;
+}
+
+bool StaticPlanAllocator::TryReserve(size_t offset, size_t size) {
+  const size_t end = offset + size;
+  // Check the live allocation that starts at or after `offset`, and the one
+  // that starts before it.
+  auto next = live_arena_.lower_bound(offset);
+  if (next != live_arena_.end() && next->first < end) return false;
+  if (next != live_arena_.begin() && std::prev(next)->second > offset) {
+    return false;
+  }
+  live_arena_.emplace_hint(next, offset, end);
+  return true;
+}
+
+void StaticPlanAllocator::DeallocateRaw(void* ptr) {
+  char* p = static_cast<char*>(ptr);
+  if (arena_ != nullptr && p >= arena_ && p < arena_ + plan_->arena_size) {
+    mutex_lock l(mu_);
+    live_arena_.erase(p - arena_);
+  } else {
+    base_allocator_->DeallocateRaw(ptr);
+  }
+  Unref();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,130 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLAN_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLAN_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Offsets in a single arena assigned to the outputs of the nodes of a graph
+// before the graph runs.
+struct StaticMemoryPlan {
+  struct Slot {
+    int64_t offset = -1;
+    size_t size = 0;
+  };
+
+  size_t arena_size = 0;
+  // Indexed by node id, and then by output index. Outputs that are not
+  // planned have an offset of -1.
+  std::vector<std::vector<Slot>> node_outputs;
+  int64_t num_planned_outputs = 0;
+};
+
+// Plans the memory of the outputs of the nodes of `graph`, assuming that they
+// run one at a time in `order`, and that every tensor is released once the
+// last node that consumes it has run. Only plans the outputs whose shapes are
+// fully known after shape inference, that have a fixed-size type, that are
+// not returned from the graph, and for which `can_plan_output` returns true.
+// The offsets are assigned with ComputeArenaOffsets(), i.e. with the
+// greedy-by-size heuristic of TFLite's ArenaPlanner.
+Status ComputeStaticMemoryPlan(
+    const Graph& graph, absl::Span<Node* const> order,
+    const std::function<bool(const Node&, int)>& can_plan_output,
+    StaticMemoryPlan* plan);
+
+// The allocator used by one step of a graph with a StaticMemoryPlan. Before
+// each node runs, the executor calls `SetCurrentNode()`, and an allocation
+// that the node makes with the exact size of one of its planned outputs is
+// placed at the offset of that output. Other allocations, and allocations
+// whose slot overlaps a tensor that outlived its planned lifetime, are served
+// by the base allocator.
+//
+// It deletes itself once the step has ended and all the memory it allocated
+// has been released.
+class StaticPlanAllocator : public Allocator {
+ public:
+  // `base_allocator` must outlive the returned allocator, which is valid
+  // until `EndStep()` is called.
+  static StaticPlanAllocator* Create(
+      Allocator* base_allocator, std::shared_ptr<const StaticMemoryPlan> plan);
+
+  // Sets the node whose planned outputs are served by subsequent allocations.
+  void SetCurrentNode(int node_id);
+
+  // Ends the step. Tensors allocated during the step may outlive this call.
+  void EndStep();
+
+  std::string Name() override { return "static_memory_plan"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+  AllocatorMemoryType GetMemoryType() const override {
+    return base_allocator_->GetMemoryType();
+  }
+
+  // Returns the number of allocations served from the arena.
+  int64_t num_arena_allocations() const;
+
+  StaticPlanAllocator(const StaticPlanAllocator&) = delete;
+  void operator=(const StaticPlanAllocator&) = delete;
+
+ private:
+  StaticPlanAllocator(Allocator* base_allocator,
+                      std::shared_ptr<const StaticMemoryPlan> plan);
+  ~StaticPlanAllocator() override;
+
+  // Drops one reference, and deletes `this` when none remain.
+  void Unref();
+
+  // Marks `size` bytes at `offset` in the arena as in use. Returns false if
+  // they overlap a live arena allocation.
+  bool TryReserve(size_t offset, size_t size)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Allocator* const base_allocator_;
+  const std::shared_ptr<const StaticMemoryPlan> plan_;
+  char* arena_ = nullptr;
+
+  // One reference for the step, plus one per live allocation.
+  std::atomic<int64_t> refs_{1};
+
+  mutable mutex mu_;
+  int current_node_ TF_GUARDED_BY(mu_) = -1;
+  // Bit i is set once output i of the current node has been served.
+  uint64_t used_slots_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_arena_allocations_ TF_GUARDED_BY(mu_) = 0;
+  // Maps the offset of every live arena allocation to its end offset.
+  std::map<size_t, size_t> live_arena_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLAN_H_
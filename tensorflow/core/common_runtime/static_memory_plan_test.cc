@@ -0,0 +1,135 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+bool PlanAll(const Node&, int) { return true; }
+
+// c = Const(); a = Neg(c); b = Neg(a); d = Neg(b); return d.
+class StaticMemoryPlanTest : public ::testing::Test {
+ protected:
+  StaticMemoryPlanTest() : graph_(OpRegistry::Global()) {
+    c_ = test::graph::Constant(&graph_,
+                               test::AsTensor<float>({1, 2, 3, 4}, {4}));
+    a_ = test::graph::Unary(&graph_, "Neg", c_);
+    b_ = test::graph::Unary(&graph_, "Neg", a_);
+    d_ = test::graph::Unary(&graph_, "Neg", b_);
+    test::graph::Retval(&graph_, 0, d_);
+    GetReversePostOrder(graph_, &order_);
+  }
+
+  const StaticMemoryPlan::Slot* SlotFor(const StaticMemoryPlan& plan,
+                                        const Node* n) {
+    const auto& slots = plan.node_outputs[n->id()];
+    if (slots.empty() || slots[0].offset < 0) return nullptr;
+    return &slots[0];
+  }
+
+  Graph graph_;
+  Node* c_;
+  Node* a_;
+  Node* b_;
+  Node* d_;
+  std::vector<Node*> order_;
+};
+
+TEST_F(StaticMemoryPlanTest, DisjointLifetimesShareMemory) {
+  StaticMemoryPlan plan;
+  TF_ASSERT_OK(ComputeStaticMemoryPlan(graph_, order_, PlanAll, &plan));
+  EXPECT_EQ(3, plan.num_planned_outputs);
+  const StaticMemoryPlan::Slot* c = SlotFor(plan, c_);
+  const StaticMemoryPlan::Slot* a = SlotFor(plan, a_);
+  const StaticMemoryPlan::Slot* b = SlotFor(plan, b_);
+  ASSERT_NE(c, nullptr);
+  ASSERT_NE(a, nullptr);
+  ASSERT_NE(b, nullptr);
+  EXPECT_EQ(16, a->size);
+  // `c` dies when `b` is produced, but both overlap with `a`.
+  EXPECT_EQ(c->offset, b->offset);
+  EXPECT_NE(c->offset, a->offset);
+  // The returned tensor is not planned.
+  EXPECT_EQ(nullptr, SlotFor(plan, d_));
+  EXPECT_EQ(Allocator::kAllocatorAlignment + 16, plan.arena_size);
+}
+
+TEST_F(StaticMemoryPlanTest, RespectsFilter) {
+  StaticMemoryPlan plan;
+  TF_ASSERT_OK(ComputeStaticMemoryPlan(
+      graph_, order_, [this](const Node& n, int) { return &n != a_; },
+      &plan));
+  EXPECT_EQ(2, plan.num_planned_outputs);
+  EXPECT_EQ(nullptr, SlotFor(plan, a_));
+}
+
+TEST_F(StaticMemoryPlanTest, AllocatorServesPlannedOutputs) {
+  auto plan = std::make_shared<StaticMemoryPlan>();
+  TF_ASSERT_OK(ComputeStaticMemoryPlan(graph_, order_, PlanAll, plan.get()));
+  StaticPlanAllocator* allocator =
+      StaticPlanAllocator::Create(cpu_allocator(), plan);
+
+  allocator->SetCurrentNode(a_->id());
+  Tensor a(allocator, DT_FLOAT, TensorShape({4}));
+  // Only one allocation of the node can use the slot of each output.
+  Tensor temp(allocator, DT_FLOAT, TensorShape({4}));
+  EXPECT_EQ(1, allocator->num_arena_allocations());
+  EXPECT_NE(a.data(), temp.data());
+
+  allocator->SetCurrentNode(c_->id());
+  {
+    Tensor c(allocator, DT_FLOAT, TensorShape({4}));
+    EXPECT_EQ(2, allocator->num_arena_allocations());
+  }
+  allocator->SetCurrentNode(b_->id());
+  // Allocations of a different size are not planned.
+  Tensor b(allocator, DT_FLOAT, TensorShape({8}));
+  EXPECT_EQ(2, allocator->num_arena_allocations());
+  allocator->EndStep();
+  // The arena stays valid while tensors allocated from it are live.
+  a.flat<float>().setConstant(1.0f);
+  EXPECT_EQ(1.0f, a.flat<float>()(3));
+}
+
+TEST_F(StaticMemoryPlanTest, LiveTensorsAreNotOverwritten) {
+  auto plan = std::make_shared<StaticMemoryPlan>();
+  TF_ASSERT_OK(ComputeStaticMemoryPlan(graph_, order_, PlanAll, plan.get()));
+  StaticPlanAllocator* allocator =
+      StaticPlanAllocator::Create(cpu_allocator(), plan);
+  allocator->SetCurrentNode(c_->id());
+  // `c` outlives its planned lifetime, so `b` cannot reuse its slot.
+  Tensor c(allocator, DT_FLOAT, TensorShape({4}));
+  allocator->SetCurrentNode(b_->id());
+  Tensor b(allocator, DT_FLOAT, TensorShape({4}));
+  EXPECT_EQ(1, allocator->num_arena_allocations());
+  EXPECT_NE(c.data(), b.data());
+  allocator->EndStep();
+}
+
+}  // namespace
+}  // namespace tensorflow
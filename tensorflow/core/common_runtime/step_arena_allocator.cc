@@ -0,0 +1,143 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+size_t RoundUp(size_t value, size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+StepArenaAllocator* StepArenaAllocator::Create(Allocator* base_allocator,
+                                               const Options& options) {
+  return new StepArenaAllocator(base_allocator, options);
+}
+
+StepArenaAllocator::StepArenaAllocator(Allocator* base_allocator,
+                                       const Options& options)
+    : base_allocator_(base_allocator), options_(options) {
+  DCHECK_LE(options_.max_arena_allocation_bytes, options_.slab_bytes);
+}
+
+StepArenaAllocator::~StepArenaAllocator() {
+  for (const auto& slab : slabs_) {
+    DCHECK_EQ(slab.second.live, 0);
+    base_allocator_->DeallocateRaw(slab.first);
+  }
+}
+
+void StepArenaAllocator::EndStep() {
+  {
+    mutex_lock l(mu_);
+    if (current_ != nullptr) {
+      auto it = slabs_.find(current_);
+      DCHECK(it != slabs_.end());
+      if (it->second.live == 0) {
+        base_allocator_->DeallocateRaw(current_);
+        slabs_.erase(it);
+      }
+      current_ = nullptr;
+    }
+  }
+  Unref();
+}
+
+void StepArenaAllocator::Unref() {
+  if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) delete this;
+}
+
+std::string StepArenaAllocator::Name() {
+  return strings::StrCat(base_allocator_->Name(), "_step_arena");
+}
+
+int64_t StepArenaAllocator::num_slabs() const {
+  mutex_lock l(mu_);
+  return slabs_.size();
+}
+
+void* StepArenaAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  if (num_bytes == 0 || num_bytes > options_.max_arena_allocation_bytes ||
+      alignment > Allocator::kAllocatorAlignment) {
+    void* ptr = base_allocator_->AllocateRaw(alignment, num_bytes);
+    if (ptr != nullptr) refs_.fetch_add(1, std::memory_order_relaxed);
+    return ptr;
+  }
+  // Keep every allocation aligned like those of the base allocator.
+  const size_t size = RoundUp(num_bytes, Allocator::kAllocatorAlignment);
+  mutex_lock l(mu_);
+  Slab* slab = nullptr;
+  if (current_ != nullptr) {
+    slab = &slabs_[current_];
+    if (slab->offset + size > slab->size) {
+      if (slab->live == 0) {
+        slab->offset = 0;
+      } else {
+        // The slab is returned once its live allocations are released.
+        slab = nullptr;
+        current_ = nullptr;
+      }
+    }
+  }
+  if (slab == nullptr) {
+    char* base = static_cast<char*>(base_allocator_->AllocateRaw(
+        Allocator::kAllocatorAlignment, options_.slab_bytes));
+    if (base == nullptr) {
+      LOG(WARNING) << "Failed to allocate a slab of " << options_.slab_bytes
+                   << " bytes for " << Name();
+      return nullptr;
+    }
+    current_ = base;
+    slab = &slabs_[base];
+    slab->size = options_.slab_bytes;
+  }
+  char* ptr = current_ + slab->offset;
+  slab->offset += size;
+  ++slab->live;
+  refs_.fetch_add(1, std::memory_order_relaxed);
+  return ptr;
+}
+
+void StepArenaAllocator::DeallocateRaw(void* ptr) {
+  char* p = static_cast<char*>(ptr);
+  bool in_arena = false;
+  {
+    mutex_lock l(mu_);
+    // The slab with the highest address that is not above `p`.
+    auto it = slabs_.lower_bound(p);
+    if (it != slabs_.end() && p < it->first + it->second.size) {
+      in_arena = true;
+      if (--it->second.live == 0) {
+        if (it->first == current_) {
+          it->second.offset = 0;
+        } else {
+          base_allocator_->DeallocateRaw(it->first);
+          slabs_.erase(it);
+        }
+      }
+    }
+  }
+  if (!in_arena) base_allocator_->DeallocateRaw(ptr);
+  Unref();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,110 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Serves the small allocations of one step by bumping a pointer through large
+// slabs obtained from a base allocator, instead of calling the base allocator
+// once per tensor.
+//
+// Usage:
+//
+//   StepArenaAllocator* arena =
+//       StepArenaAllocator::Create(device->GetAllocator({}), {});
+//   // Run the step, allocating intermediate tensors from `arena`.
+//   arena->EndStep();
+//
+// Each slab counts its live allocations. A slab that has no live allocations
+// is rewound and reused while it is the current slab, and otherwise returned
+// to the base allocator, so that memory of tensors that die during the step
+// is recycled. Tensors that escape the step (for example, fetched outputs or
+// tensors stored in resources) only keep their own slab alive: the allocator
+// deletes itself, and releases its last slab, once the step has ended and all
+// the memory it allocated has been released.
+//
+// This class is thread-safe.
+class StepArenaAllocator : public Allocator {
+ public:
+  struct Options {
+    // Size of the slabs requested from the base allocator.
+    size_t slab_bytes = 1 << 20;
+    // Allocations larger than this are forwarded to the base allocator.
+    size_t max_arena_allocation_bytes = 64 << 10;
+  };
+
+  // `base_allocator` must outlive the returned allocator, which is valid
+  // until `EndStep()` is called.
+  static StepArenaAllocator* Create(Allocator* base_allocator,
+                                    const Options& options);
+
+  // Ends the step. Tensors allocated during the step may outlive this call.
+  void EndStep();
+
+  std::string Name() override;
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+  AllocatorMemoryType GetMemoryType() const override {
+    return base_allocator_->GetMemoryType();
+  }
+
+  // Returns the number of slabs currently held from the base allocator.
+  int64_t num_slabs() const;
+
+  StepArenaAllocator(const StepArenaAllocator&) = delete;
+  void operator=(const StepArenaAllocator&) = delete;
+
+ private:
+  struct Slab {
+    size_t size = 0;
+    size_t offset = 0;
+    int64_t live = 0;
+  };
+
+  StepArenaAllocator(Allocator* base_allocator, const Options& options);
+  ~StepArenaAllocator() override;
+
+  // Drops one reference, and deletes `this` when none remain.
+  void Unref();
+
+  Allocator* const base_allocator_;
+  const Options options_;
+
+  // One reference for the step, plus one per live arena allocation.
+  std::atomic<int64_t> refs_{1};
+
+  mutable mutex mu_;
+  // Maps the address of every slab to its state.
+  std::map<char*, Slab, std::greater<char*>> slabs_ TF_GUARDED_BY(mu_);
+  // The slab that allocations are bumped from, or null.
+  char* current_ TF_GUARDED_BY(mu_) = nullptr;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
@@ -0,0 +1,131 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Counts the live allocations made through it.
+class CountingAllocator : public Allocator {
+ public:
+  std::string Name() override { return "counting"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    ++num_allocations_;
+    ++num_live_;
+    return cpu_allocator()->AllocateRaw(alignment, num_bytes);
+  }
+  void DeallocateRaw(void* ptr) override {
+    --num_live_;
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+
+  int num_allocations_ = 0;
+  int num_live_ = 0;
+};
+
+StepArenaAllocator::Options SmallSlabs() {
+  StepArenaAllocator::Options options;
+  options.slab_bytes = 4096;
+  options.max_arena_allocation_bytes = 1024;
+  return options;
+}
+
+TEST(StepArenaAllocatorTest, SmallTensorsShareSlabs) {
+  CountingAllocator base;
+  StepArenaAllocator* arena = StepArenaAllocator::Create(&base, SmallSlabs());
+  std::vector<Tensor> tensors;
+  for (int i = 0; i < 8; ++i) {
+    tensors.emplace_back(arena, DT_FLOAT, TensorShape({100}));
+  }
+  // Each allocation is rounded up to 448 bytes, so nine fit in one slab.
+  EXPECT_EQ(1, base.num_allocations_);
+  EXPECT_EQ(1, arena->num_slabs());
+  for (size_t i = 1; i < tensors.size(); ++i) {
+    EXPECT_GE(tensors[i].tensor_data().data() -
+                  tensors[i - 1].tensor_data().data(),
+              448);
+  }
+  tensors.clear();
+  arena->EndStep();
+  EXPECT_EQ(0, base.num_live_);
+}
+
+TEST(StepArenaAllocatorTest, DeadTensorsAreRecycled) {
+  CountingAllocator base;
+  StepArenaAllocator* arena = StepArenaAllocator::Create(&base, SmallSlabs());
+  for (int i = 0; i < 100; ++i) {
+    Tensor a(arena, DT_FLOAT, TensorShape({200}));
+    Tensor b(arena, DT_FLOAT, TensorShape({200}));
+  }
+  // The current slab is rewound whenever it has no live allocations.
+  EXPECT_EQ(1, base.num_allocations_);
+  arena->EndStep();
+  EXPECT_EQ(0, base.num_live_);
+}
+
+TEST(StepArenaAllocatorTest, FullSlabsAreReleasedWhenEmpty) {
+  CountingAllocator base;
+  StepArenaAllocator* arena = StepArenaAllocator::Create(&base, SmallSlabs());
+  std::vector<Tensor> tensors;
+  for (int i = 0; i < 8; ++i) {
+    tensors.emplace_back(arena, DT_FLOAT, TensorShape({256}));
+  }
+  EXPECT_EQ(2, arena->num_slabs());
+  // Release the tensors of the first slab.
+  tensors.erase(tensors.begin(), tensors.begin() + 4);
+  EXPECT_EQ(1, arena->num_slabs());
+  EXPECT_EQ(1, base.num_live_);
+  tensors.clear();
+  arena->EndStep();
+  EXPECT_EQ(0, base.num_live_);
+}
+
+TEST(StepArenaAllocatorTest, LargeTensorsUseBaseAllocator) {
+  CountingAllocator base;
+  StepArenaAllocator* arena = StepArenaAllocator::Create(&base, SmallSlabs());
+  {
+    Tensor t(arena, DT_FLOAT, TensorShape({1024}));
+    EXPECT_EQ(1, base.num_live_);
+    EXPECT_EQ(0, arena->num_slabs());
+  }
+  EXPECT_EQ(0, base.num_live_);
+  arena->EndStep();
+}
+
+TEST(StepArenaAllocatorTest, TensorsMayOutliveStep) {
+  CountingAllocator base;
+  StepArenaAllocator* arena = StepArenaAllocator::Create(&base, SmallSlabs());
+  Tensor small(arena, DT_FLOAT, TensorShape({16}));
+  Tensor large(arena, DT_FLOAT, TensorShape({1024}));
+  small.flat<float>().setConstant(1.0f);
+  arena->EndStep();
+  // The slab and the large tensor stay alive until the tensors are released.
+  EXPECT_EQ(2, base.num_live_);
+  EXPECT_EQ(1.0f, small.flat<float>()(0));
+  small = Tensor();
+  large = Tensor();
+  EXPECT_EQ(0, base.num_live_);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -122,6 +122,13 @@ void NodeExecStatsWrapper::RecordComputeStarted() {
   stats_->set_op_start_rel_micros(now_nanos / EnvTime::kMicrosToNanos -
                                   stats_->all_start_micros());
   stats_->set_op_start_rel_nanos(now_nanos - stats_->all_start_nanos());
+  if (HardwareCounters::Enabled()) {
+    HardwareCounters::Values counters;
+    if (HardwareCounters::ReadForCurrentThread(&counters)) {
+      compute_start_counters_ = counters;
+      compute_start_thread_id_ = Env::Default()->GetCurrentThreadId();
+    }
+  }
 }
 
 void NodeExecStatsWrapper::RecordComputeEnded() {
@@ -131,6 +138,23 @@ void NodeExecStatsWrapper::RecordComputeEnded() {
   stats_->set_op_end_rel_micros(now_nanos / EnvTime::kMicrosToNanos -
                                 stats_->all_start_micros());
   stats_->set_op_end_rel_nanos(now_nanos - stats_->all_start_nanos());
+  // The counters are per thread, so they are only meaningful if the
+  // computation ended on the thread that started it, as synchronous kernels
+  // do.
+  if (compute_start_counters_.has_value() &&
+      compute_start_thread_id_ == Env::Default()->GetCurrentThreadId()) {
+    HardwareCounters::Values counters;
+    if (HardwareCounters::ReadForCurrentThread(&counters)) {
+      auto& hardware_counters = *stats_->mutable_hardware_counters();
+      hardware_counters[kHardwareCounterCycles] =
+          counters.cycles - compute_start_counters_->cycles;
+      hardware_counters[kHardwareCounterInstructions] =
+          counters.instructions - compute_start_counters_->instructions;
+      hardware_counters[kHardwareCounterLlcMisses] =
+          counters.llc_misses - compute_start_counters_->llc_misses;
+    }
+  }
+  compute_start_counters_.reset();
 }
 
 void NodeExecStatsWrapper::RecordExecutorEnded() {
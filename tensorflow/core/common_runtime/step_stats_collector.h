@@ -16,9 +16,11 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_STEP_STATS_COLLECTOR_H_
 
 #include <memory>
+#include <optional>
 #include <unordered_map>
 #include <vector>
 
+#include "tensorflow/core/common_runtime/hardware_counters.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/framework/tracking_allocator.h"
@@ -127,6 +129,10 @@ class NodeExecStatsWrapper : public NodeExecStatsInterface {
   gtl::InlinedVector<std::pair<AllocatorMemoryUsed*, TrackingAllocator*>, 2>
       allocations_;
   std::unique_ptr<NodeExecStats> stats_;
+  // Hardware counters of the thread that started the computation, if they
+  // are being collected.
+  std::optional<HardwareCounters::Values> compute_start_counters_;
+  int32 compute_start_thread_id_ = 0;
   const NodeDef* const node_;                       // Not owned.
   StepStatsCollector* const step_stats_collector_;  // Not owned.
 };
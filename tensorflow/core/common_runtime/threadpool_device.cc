@@ -26,6 +26,9 @@ info. It does not have any negative impact on performance. */
 #endif
 #endif  // ENABLE_ONEDNN_OPENMP && ENABLE_MKL &&_OPENMP
 
+#include <algorithm>
+#include <vector>
+
 #include "absl/base/call_once.h"
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/common_runtime/local_device.h"
@@ -40,7 +43,12 @@ info. It does not have any negative impact on performance. */
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/types.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/public/session_options.h"
@@ -54,6 +62,45 @@ info. It does not have any negative impact on performance. */
 
 namespace tensorflow {
 
+namespace {
+
+// Returns the inter-op thread pool shared by all the CPU devices on
+// `numa_node`, whose threads are pinned to that node. Returns nullptr if the
+// session runs inter-op work in the caller thread.
+thread::ThreadPool* NumaInterOpThreadPool(const SessionOptions& options,
+                                          int numa_node) {
+  int32_t num_threads = options.config.inter_op_parallelism_threads();
+  if (num_threads < 0) return nullptr;
+  static mutex& mu = *new mutex;
+  static auto& pools TF_GUARDED_BY(mu) = *new std::vector<thread::ThreadPool*>;
+  mutex_lock l(mu);
+  if (static_cast<size_t>(numa_node) >= pools.size()) {
+    pools.resize(numa_node + 1, nullptr);
+  }
+  if (pools[numa_node] == nullptr) {
+    if (num_threads == 0) {
+      num_threads = port::MaxParallelism(numa_node);
+    } else {
+      // Split the session's inter-op threads between the nodes.
+      const int num_numa_nodes = port::NUMANumNodes();
+      num_threads =
+          std::max(1, (num_threads + num_numa_nodes - 1) / num_numa_nodes);
+    }
+    ThreadOptions thread_opts;
+    thread_opts.numa_node = numa_node;
+    pools[numa_node] = new thread::ThreadPool(
+        options.env, thread_opts,
+        strings::StrCat("numa_", numa_node, "_inter_op"), num_threads,
+        !options.config.experimental().disable_thread_spinning(),
+        /*allocator=*/nullptr);
+    VLOG(1) << "Created inter-op thread pool with " << num_threads
+            << " threads for NUMA node " << numa_node;
+  }
+  return pools[numa_node];
+}
+
+}  // namespace
+
 ThreadPoolDevice::ThreadPoolDevice(const SessionOptions& options,
                                    const string& name, Bytes memory_limit,
                                    const DeviceLocality& locality,
@@ -62,6 +109,15 @@ ThreadPoolDevice::ThreadPoolDevice(const SessionOptions& options,
                                name, DEVICE_CPU, memory_limit, locality)),
       allocator_(allocator),
       scoped_allocator_mgr_(new ScopedAllocatorMgr(name)) {
+  if (options.config.experimental().use_numa_affinity() &&
+      locality.numa_node() != port::kNUMANoAffinity &&
+      port::NUMANumNodes() > 1) {
+    // Keep the inter-op work of this device on its NUMA node, like the
+    // intra-op threads and the allocator.
+    set_tensorflow_device_thread_pool(
+        NumaInterOpThreadPool(options, locality.numa_node()));
+  }
+
   auto s = NodeFileWriter::GetNodeFileWriterIfEnabled(name, env());
   if (!s.ok()) {
     LOG(ERROR) << s.status();
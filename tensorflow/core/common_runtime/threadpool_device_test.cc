@@ -15,7 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/threadpool_device.h"
 
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/public/session_options.h"
 
@@ -68,5 +73,35 @@ TEST(ThreadPoolDeviceTest, CopyTensor) {
   device_context->Unref();
 }
 
+TEST(ThreadPoolDeviceTest, OneDevicePerNumaNode) {
+  SessionOptions options;
+  options.config.mutable_experimental()->set_use_numa_affinity(true);
+  std::vector<std::unique_ptr<Device>> devices;
+  TF_ASSERT_OK(DeviceFactory::GetFactory(DEVICE_CPU)->CreateDevices(
+      options, "/job:localhost/replica:0/task:0", &devices));
+  const int num_numa_nodes = port::NUMANumNodes();
+  ASSERT_EQ(num_numa_nodes, devices.size());
+  for (int i = 0; i < num_numa_nodes; ++i) {
+    EXPECT_EQ(i, devices[i]->attributes().locality().numa_node());
+    // Inter-op work is only pinned when there is more than one node.
+    EXPECT_EQ(num_numa_nodes > 1,
+              devices[i]->tensorflow_device_thread_pool() != nullptr);
+  }
+}
+
+TEST(ThreadPoolDeviceTest, DeviceCountOverridesNumaNodes) {
+  SessionOptions options;
+  options.config.mutable_experimental()->set_use_numa_affinity(true);
+  (*options.config.mutable_device_count())["CPU"] = 3;
+  std::vector<std::unique_ptr<Device>> devices;
+  TF_ASSERT_OK(DeviceFactory::GetFactory(DEVICE_CPU)->CreateDevices(
+      options, "/job:localhost/replica:0/task:0", &devices));
+  ASSERT_EQ(3, devices.size());
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(i % port::NUMANumNodes(),
+              devices[i]->attributes().locality().numa_node());
+  }
+}
+
 }  // namespace
 }  // namespace tensorflow
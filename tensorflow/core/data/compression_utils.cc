@@ -14,10 +14,17 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/compression_utils.h"
 
+#include <zlib.h>
+
+#include <cstring>
 #include <limits>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/types.pb.h"
@@ -34,10 +41,195 @@ namespace {
 // Increment this when making changes to the `CompressedElement` proto. The
 // `UncompressElement` function will determine what to read according to the
 // version.
-constexpr int kCompressedElementVersion = 0;
+constexpr int kCompressedElementVersion = 1;
+// The version of elements compressed with snappy, which predate the `codec`
+// field. Snappy elements keep this version so that older binaries read them.
+constexpr int kSnappyCompressedElementVersion = 0;
+
+constexpr char kSnappyCodec[] = "snappy";
+constexpr char kZlibCodec[] = "zlib";
+constexpr char kNoneCodec[] = "none";
+
+class SnappyCodec : public CompressionCodec {
+ public:
+  Status Compress(const struct iovec* iov, size_t num_pieces, size_t num_bytes,
+                  int level, std::string* output) const override {
+    if (num_bytes > kuint32max) {
+      return errors::OutOfRange("Encountered dataset element of size ",
+                                num_bytes, ", exceeding the 4GB Snappy limit.");
+    }
+    if (!port::Snappy_CompressFromIOVec(iov, num_bytes, output)) {
+      return errors::Internal("Failed to compress using snappy.");
+    }
+    return absl::OkStatus();
+  }
+
+  Status Uncompress(absl::string_view input, const struct iovec* iov,
+                    size_t num_pieces, size_t num_bytes) const override {
+    size_t uncompressed_size;
+    if (!port::Snappy_GetUncompressedLength(input.data(), input.size(),
+                                            &uncompressed_size)) {
+      return errors::Internal(
+          "Could not get snappy uncompressed length. Compressed data size: ",
+          input.size());
+    }
+    if (uncompressed_size != num_bytes) {
+      return errors::Internal(
+          "Uncompressed size mismatch. Snappy expects ", uncompressed_size,
+          " whereas the tensor metadata suggests ", num_bytes);
+    }
+    if (!port::Snappy_UncompressToIOVec(input.data(), input.size(), iov,
+                                        num_pieces)) {
+      return errors::Internal("Failed to perform snappy decompression.");
+    }
+    return absl::OkStatus();
+  }
+};
+
+class ZlibCodec : public CompressionCodec {
+ public:
+  Status Compress(const struct iovec* iov, size_t num_pieces, size_t num_bytes,
+                  int level, std::string* output) const override {
+    if (num_bytes > kuint32max) {
+      return errors::OutOfRange("Encountered dataset element of size ",
+                                num_bytes, ", exceeding the 4GB zlib limit.");
+    }
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (deflateInit(&stream, level == -1 ? Z_DEFAULT_COMPRESSION : level) !=
+        Z_OK) {
+      return errors::InvalidArgument("Invalid zlib compression level: ",
+                                     level);
+    }
+    output->resize(deflateBound(&stream, num_bytes));
+    stream.next_out = reinterpret_cast<Bytef*>(&(*output)[0]);
+    stream.avail_out = output->size();
+    int ret = Z_OK;
+    for (size_t i = 0; i < num_pieces && ret == Z_OK; ++i) {
+      // zlib reports an error when it is given no input to make progress on.
+      if (iov[i].iov_len == 0) {
+        continue;
+      }
+      stream.next_in = static_cast<Bytef*>(iov[i].iov_base);
+      stream.avail_in = iov[i].iov_len;
+      ret = deflate(&stream, Z_NO_FLUSH);
+    }
+    if (ret == Z_OK) {
+      ret = deflate(&stream, Z_FINISH);
+    }
+    const size_t compressed_size = stream.total_out;
+    deflateEnd(&stream);
+    if (ret != Z_STREAM_END) {
+      return errors::Internal("Failed to compress using zlib: ", ret);
+    }
+    output->resize(compressed_size);
+    return absl::OkStatus();
+  }
+
+  Status Uncompress(absl::string_view input, const struct iovec* iov,
+                    size_t num_pieces, size_t num_bytes) const override {
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (inflateInit(&stream) != Z_OK) {
+      return errors::Internal("Failed to initialize zlib decompression.");
+    }
+    stream.next_in =
+        reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    stream.avail_in = input.size();
+    int ret = Z_OK;
+    for (size_t i = 0; i < num_pieces && ret == Z_OK; ++i) {
+      stream.next_out = static_cast<Bytef*>(iov[i].iov_base);
+      stream.avail_out = iov[i].iov_len;
+      while (stream.avail_out > 0 && ret == Z_OK) {
+        ret = inflate(&stream, Z_NO_FLUSH);
+      }
+    }
+    if (ret == Z_OK) {
+      // The uncompressed data has been read; the stream must end here.
+      Bytef extra;
+      stream.next_out = &extra;
+      stream.avail_out = 1;
+      ret = inflate(&stream, Z_FINISH);
+      if (stream.avail_out == 0) {
+        ret = Z_DATA_ERROR;
+      }
+    }
+    const size_t uncompressed_size = stream.total_out;
+    inflateEnd(&stream);
+    if (ret != Z_STREAM_END || uncompressed_size != num_bytes) {
+      return errors::Internal("Failed to perform zlib decompression: ", ret,
+                              ". Uncompressed ", uncompressed_size,
+                              " bytes whereas the tensor metadata suggests ",
+                              num_bytes);
+    }
+    return absl::OkStatus();
+  }
+};
+
+// Stores the bytes as they are.
+class NoneCodec : public CompressionCodec {
+ public:
+  Status Compress(const struct iovec* iov, size_t num_pieces, size_t num_bytes,
+                  int level, std::string* output) const override {
+    output->resize(num_bytes);
+    char* pos = &(*output)[0];
+    for (size_t i = 0; i < num_pieces; ++i) {
+      if (iov[i].iov_len > 0) {
+        memcpy(pos, iov[i].iov_base, iov[i].iov_len);
+        pos += iov[i].iov_len;
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  Status Uncompress(absl::string_view input, const struct iovec* iov,
+                    size_t num_pieces, size_t num_bytes) const override {
+    if (input.size() != num_bytes) {
+      return errors::Internal("Uncompressed size mismatch. Found ",
+                              input.size(),
+                              " bytes whereas the tensor metadata suggests ",
+                              num_bytes);
+    }
+    const char* pos = input.data();
+    for (size_t i = 0; i < num_pieces; ++i) {
+      if (iov[i].iov_len > 0) {
+        memcpy(iov[i].iov_base, pos, iov[i].iov_len);
+        pos += iov[i].iov_len;
+      }
+    }
+    return absl::OkStatus();
+  }
+};
+
+using CodecRegistry =
+    absl::flat_hash_map<std::string, std::unique_ptr<CompressionCodec>>;
+
+CodecRegistry& Codecs() {
+  static CodecRegistry* codecs = []() {
+    auto* codecs = new CodecRegistry();
+    (*codecs)[kSnappyCodec] = std::make_unique<SnappyCodec>();
+    (*codecs)[kZlibCodec] = std::make_unique<ZlibCodec>();
+    (*codecs)[kNoneCodec] = std::make_unique<NoneCodec>();
+    return codecs;
+  }();
+  return *codecs;
+}
 
 }  // namespace
 
+void CompressionCodec::Register(const std::string& name,
+                                std::unique_ptr<CompressionCodec> codec) {
+  Codecs()[name] = std::move(codec);
+}
+
+const CompressionCodec* CompressionCodec::Get(const std::string& name) {
+  auto it = Codecs().find(name);
+  if (it == Codecs().end()) {
+    return nullptr;
+  }
+  return it->second.get();
+}
+
 class Iov {
  public:
   explicit Iov(size_t size) : iov_(size), idx_(0), num_bytes_(0) {}
@@ -63,6 +255,12 @@ class Iov {
 
 Status CompressElement(const std::vector<Tensor>& element,
                        CompressedElement* out) {
+  return CompressElement(element, CompressionOptions(), out);
+}
+
+Status CompressElement(const std::vector<Tensor>& element,
+                       const CompressionOptions& options,
+                       CompressedElement* out) {
   // First pass: preprocess the non`memcpy`able tensors.
   size_t num_string_tensors = 0;
   size_t num_string_tensor_strings = 0;
@@ -120,27 +318,44 @@ Status CompressElement(const std::vector<Tensor>& element,
     }
   }
 
-  if (iov.NumBytes() > kuint32max) {
-    return errors::OutOfRange("Encountered dataset element of size ",
-                              iov.NumBytes(),
-                              ", exceeding the 4GB Snappy limit.");
+  std::string codec_name = options.codec.empty() ? kSnappyCodec : options.codec;
+  if (static_cast<int64_t>(iov.NumBytes()) < options.min_compression_bytes) {
+    codec_name = kNoneCodec;
   }
-  if (!port::Snappy_CompressFromIOVec(iov.Data(), iov.NumBytes(),
-                                      out->mutable_data())) {
-    return errors::Internal("Failed to compress using snappy.");
+  const CompressionCodec* codec = CompressionCodec::Get(codec_name);
+  if (codec == nullptr) {
+    return errors::InvalidArgument("Unknown compression codec: ", codec_name);
   }
-  out->set_version(kCompressedElementVersion);
-  VLOG(3) << "Compressed element from " << iov.NumBytes() << " bytes to "
-          << out->data().size() << " bytes";
+  TF_RETURN_IF_ERROR(codec->Compress(iov.Data(), iov.NumPieces(),
+                                     iov.NumBytes(), options.level,
+                                     out->mutable_data()));
+  if (codec_name == kSnappyCodec) {
+    out->set_version(kSnappyCompressedElementVersion);
+  } else {
+    out->set_version(kCompressedElementVersion);
+    out->set_codec(codec_name);
+  }
+  VLOG(3) << "Compressed element with " << codec_name << " from "
+          << iov.NumBytes() << " bytes to " << out->data().size() << " bytes";
   return absl::OkStatus();
 }
 
 Status UncompressElement(const CompressedElement& compressed,
                          std::vector<Tensor>* out) {
-  if (compressed.version() != kCompressedElementVersion) {
+  std::string codec_name;
+  if (compressed.version() == kSnappyCompressedElementVersion) {
+    codec_name = kSnappyCodec;
+  } else if (compressed.version() == kCompressedElementVersion) {
+    codec_name = compressed.codec();
+  } else {
     return errors::Internal("Unsupported compressed element version: ",
                             compressed.version());
   }
+  const CompressionCodec* codec = CompressionCodec::Get(codec_name);
+  if (codec == nullptr) {
+    return errors::Unimplemented("Compressed element uses the codec ",
+                                 codec_name, ", which is not registered.");
+  }
   int num_components = compressed.component_metadata_size();
   out->clear();
   out->reserve(num_components);
@@ -190,24 +405,8 @@ Status UncompressElement(const CompressedElement& compressed,
   }
 
   // Step 2: Uncompress into the iovec.
-  const std::string& compressed_data = compressed.data();
-  size_t uncompressed_size;
-  if (!port::Snappy_GetUncompressedLength(
-          compressed_data.data(), compressed_data.size(), &uncompressed_size)) {
-    return errors::Internal(
-        "Could not get snappy uncompressed length. Compressed data size: ",
-        compressed_data.size());
-  }
-  if (uncompressed_size != static_cast<size_t>(iov.NumBytes())) {
-    return errors::Internal(
-        "Uncompressed size mismatch. Snappy expects ", uncompressed_size,
-        " whereas the tensor metadata suggests ", iov.NumBytes());
-  }
-  if (!port::Snappy_UncompressToIOVec(compressed_data.data(),
-                                      compressed_data.size(), iov.Data(),
-                                      iov.NumPieces())) {
-    return errors::Internal("Failed to perform snappy decompression.");
-  }
+  TF_RETURN_IF_ERROR(codec->Uncompress(compressed.data(), iov.Data(),
+                                       iov.NumPieces(), iov.NumBytes()));
 
   // Third pass: deserialize nonstring, non`memcpy`able tensors.
   nonmemcpyable_pos = nonmemcpyable.mdata();
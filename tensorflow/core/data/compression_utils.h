@@ -15,15 +15,60 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_COMPRESSION_UTILS_H_
 #define TENSORFLOW_CORE_DATA_COMPRESSION_UTILS_H_
 
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <vector>
 
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/framework/dataset.pb.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/snappy.h"
 #include "tensorflow/core/platform/status.h"
 
 namespace tensorflow {
 namespace data {
 
+// A codec that compresses the bytes of dataset elements.
+//
+// The "snappy", "zlib", and "none" codecs are built in. Other codecs are
+// added with `Register`, and must be registered under the same name in the
+// processes that compress and uncompress the elements.
+class CompressionCodec {
+ public:
+  virtual ~CompressionCodec() = default;
+
+  // Compresses the `num_bytes` bytes of the `num_pieces` pieces of `iov` into
+  // `output`. `level` is a codec-specific compression level, or -1 for the
+  // default level of the codec.
+  virtual Status Compress(const struct iovec* iov, size_t num_pieces,
+                          size_t num_bytes, int level,
+                          std::string* output) const = 0;
+
+  // Uncompresses `input`, which must uncompress to exactly `num_bytes` bytes,
+  // into the `num_pieces` pieces of `iov`.
+  virtual Status Uncompress(absl::string_view input, const struct iovec* iov,
+                            size_t num_pieces, size_t num_bytes) const = 0;
+
+  // Registers `codec` under `name`. Not thread-safe with respect to `Get`, so
+  // codecs should be registered during static initialization.
+  static void Register(const std::string& name,
+                       std::unique_ptr<CompressionCodec> codec);
+
+  // Returns the codec registered under `name`, or nullptr if there is none.
+  static const CompressionCodec* Get(const std::string& name);
+};
+
+struct CompressionOptions {
+  // The name of the codec to compress with. Empty for snappy.
+  std::string codec;
+  // The codec-specific compression level, or -1 for the codec's default.
+  int level = -1;
+  // Elements with fewer uncompressed bytes than this are stored with the
+  // "none" codec, which costs no CPU and has no framing overhead.
+  int64_t min_compression_bytes = 0;
+};
+
 // Compresses the components of `element` into the `CompressedElement` proto.
 //
 // In addition to writing the actual compressed bytes, `Compress` fills
@@ -33,6 +78,14 @@ namespace data {
 Status CompressElement(const std::vector<Tensor>& element,
                        CompressedElement* out);
 
+// Like the above, but compresses with the codec chosen by `options`.
+// Elements compressed with snappy can be read by older binaries; elements
+// compressed with other codecs can only be read by binaries that have the
+// codec registered.
+Status CompressElement(const std::vector<Tensor>& element,
+                       const CompressionOptions& options,
+                       CompressedElement* out);
+
 // Uncompresses a `CompressedElement` into a vector of tensor components.
 Status UncompressElement(const CompressedElement& compressed,
                          std::vector<Tensor>* out);
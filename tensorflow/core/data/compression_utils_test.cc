@@ -14,7 +14,10 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/compression_utils.h"
 
+#include <algorithm>
+#include <memory>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include "tensorflow/core/data/dataset_test_base.h"
@@ -98,7 +101,7 @@ TEST_P(ParameterizedCompressionUtilsTest, VersionMismatch) {
   CompressedElement compressed;
   TF_ASSERT_OK(CompressElement(element, &compressed));
 
-  compressed.set_version(1);
+  compressed.set_version(2);
   std::vector<Tensor> round_trip_element;
   EXPECT_THAT(UncompressElement(compressed, &round_trip_element),
               StatusIs(error::INTERNAL));
@@ -107,6 +110,118 @@ TEST_P(ParameterizedCompressionUtilsTest, VersionMismatch) {
 INSTANTIATE_TEST_SUITE_P(Instantiation, ParameterizedCompressionUtilsTest,
                          ::testing::ValuesIn(TestCases()));
 
+class ParameterizedCodecTest
+    : public DatasetOpsTestBase,
+      public ::testing::WithParamInterface<
+          std::tuple<std::vector<Tensor>, std::string>> {};
+
+TEST_P(ParameterizedCodecTest, RoundTrip) {
+  const auto& [element, codec] = GetParam();
+  CompressionOptions options;
+  options.codec = codec;
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(element, options, &compressed));
+  EXPECT_EQ(compressed.version(), codec == "snappy" ? 0 : 1);
+  std::vector<Tensor> round_trip_element;
+  TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+  TF_EXPECT_OK(
+      ExpectEqual(element, round_trip_element, /*compare_order=*/true));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Instantiation, ParameterizedCodecTest,
+    ::testing::Combine(::testing::ValuesIn(TestCases()),
+                       ::testing::Values("snappy", "zlib", "none")));
+
+TEST(CompressionUtilsTest, ZlibLevels) {
+  std::vector<Tensor> element = {
+      CreateTensor<int64_t>(TensorShape{128, 128})};
+  for (int level : {0, 1, 9}) {
+    CompressionOptions options;
+    options.codec = "zlib";
+    options.level = level;
+    CompressedElement compressed;
+    TF_ASSERT_OK(CompressElement(element, options, &compressed));
+    std::vector<Tensor> round_trip_element;
+    TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+    TF_EXPECT_OK(DatasetOpsTestBase::ExpectEqual(element, round_trip_element,
+                                                 /*compare_order=*/true));
+  }
+  CompressionOptions options;
+  options.codec = "zlib";
+  options.level = 10;
+  CompressedElement compressed;
+  EXPECT_THAT(CompressElement(element, options, &compressed),
+              StatusIs(error::INVALID_ARGUMENT));
+}
+
+TEST(CompressionUtilsTest, SmallElementsAreStoredUncompressed) {
+  std::vector<Tensor> element = {
+      CreateTensor<int64_t>(TensorShape{4}, {1, 2, 3, 4})};
+  CompressionOptions options;
+  options.min_compression_bytes = 1024;
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(element, options, &compressed));
+  EXPECT_EQ(compressed.codec(), "none");
+  EXPECT_EQ(compressed.data().size(), 4 * sizeof(int64_t));
+  std::vector<Tensor> round_trip_element;
+  TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+  TF_EXPECT_OK(DatasetOpsTestBase::ExpectEqual(element, round_trip_element,
+                                               /*compare_order=*/true));
+}
+
+TEST(CompressionUtilsTest, UnknownCodec) {
+  std::vector<Tensor> element = {CreateTensor<int64_t>(TensorShape{1}, {1})};
+  CompressionOptions options;
+  options.codec = "unknown";
+  CompressedElement compressed;
+  EXPECT_THAT(CompressElement(element, options, &compressed),
+              StatusIs(error::INVALID_ARGUMENT,
+                       HasSubstr("Unknown compression codec")));
+
+  options.codec = "none";
+  TF_ASSERT_OK(CompressElement(element, options, &compressed));
+  compressed.set_codec("unknown");
+  std::vector<Tensor> round_trip_element;
+  EXPECT_THAT(UncompressElement(compressed, &round_trip_element),
+              StatusIs(error::UNIMPLEMENTED));
+}
+
+// A codec that stores the bytes in reverse order.
+class ReverseCodec : public CompressionCodec {
+ public:
+  Status Compress(const struct iovec* iov, size_t num_pieces, size_t num_bytes,
+                  int level, std::string* output) const override {
+    TF_RETURN_IF_ERROR(CompressionCodec::Get("none")->Compress(
+        iov, num_pieces, num_bytes, level, output));
+    std::reverse(output->begin(), output->end());
+    return absl::OkStatus();
+  }
+
+  Status Uncompress(absl::string_view input, const struct iovec* iov,
+                    size_t num_pieces, size_t num_bytes) const override {
+    std::string reversed(input.rbegin(), input.rend());
+    return CompressionCodec::Get("none")->Uncompress(reversed, iov, num_pieces,
+                                                     num_bytes);
+  }
+};
+
+TEST(CompressionUtilsTest, RegisteredCodec) {
+  CompressionCodec::Register("reverse", std::make_unique<ReverseCodec>());
+  std::vector<Tensor> element = {
+      CreateTensor<tstring>(TensorShape{2}, {"abc", "xyz"}),
+      CreateTensor<int64_t>(TensorShape{2}, {1, 2})};
+  CompressionOptions options;
+  options.codec = "reverse";
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(element, options, &compressed));
+  EXPECT_EQ(compressed.codec(), "reverse");
+  std::vector<Tensor> round_trip_element;
+  TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+  TF_EXPECT_OK(DatasetOpsTestBase::ExpectEqual(element, round_trip_element,
+                                               /*compare_order=*/true));
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
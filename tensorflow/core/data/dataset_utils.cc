@@ -49,6 +49,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/host_info.h"
 #include "tensorflow/core/platform/regexp.h"
 #include "tensorflow/core/platform/status.h"
@@ -108,6 +109,8 @@ constexpr char kSlackPeriodOpt[] = "slack_period";
 constexpr char kMakeDeterministicOpt[] = "make_deterministic";
 constexpr char kFilterParallelizationOpt[] = "filter_parallelization";
 constexpr char kWarmStartOpt[] = "warm_start";
+constexpr char kProfileGuidedPipelineOpt[] = "profile_guided_pipeline";
+constexpr char kModelPathOpt[] = "model_path";
 
 void DefaultOptimizationGraphRewrites(
     const Options& options, absl::flat_hash_set<tstring>* optimization_enabled,
@@ -233,6 +236,9 @@ void DefaultOptimizationGraphRewrites(
       optimization_disabled->insert(kSeqInterleavePrefetchOpt);
     }
   }
+  if (!optimization_options.autotune_model_path().empty()) {
+    optimization_enabled->insert(kProfileGuidedPipelineOpt);
+  }
 }
 
 // Returns whether an op has been allowlisted as stateless. Uses a heuristic to
@@ -622,6 +628,19 @@ Tensor MaybeCopySubSlice(const Tensor& tensor, int64 index) {
   }
 }
 
+bool SpinWait(int64_t max_spin_us, absl::FunctionRef<bool()> done) {
+  // Only read the clock every few polls, since that is the expensive part.
+  constexpr int kPollsPerClockRead = 64;
+  if (done()) return true;
+  const uint64 deadline_us = EnvTime::NowMicros() + max_spin_us;
+  do {
+    for (int i = 0; i < kPollsPerClockRead; ++i) {
+      if (done()) return true;
+    }
+  } while (EnvTime::NowMicros() < deadline_us);
+  return done();
+}
+
 void StripDevicePlacement(FunctionDefLibrary* library) {
   for (auto& function : (*library->mutable_function())) {
     for (auto& node : (*function.mutable_node_def())) {
@@ -909,6 +928,12 @@ absl::flat_hash_set<tstring> CreateGraphRewriteConfigs(const Options& options) {
     configs.insert(
         absl::StrCat(kSlackOpt, ":", kSlackPeriodOpt, ":", num_devices));
   }
+  const string& model_path =
+      options.optimization_options().autotune_model_path();
+  if (!model_path.empty()) {
+    configs.insert(absl::StrCat(kProfileGuidedPipelineOpt, ":", kModelPathOpt,
+                                ":", model_path));
+  }
   return configs;
 }
 
@@ -1026,6 +1051,16 @@ REGISTER_DATASET_EXPERIMENT("reduce_array_record_dataset_memory_usage",
                             RandomJobSamplePercentage<50>, AllTasks);
 REGISTER_DATASET_EXPERIMENT("map_fusion", RandomJobSamplePercentage<50>,
                             AllTasks);
+REGISTER_DATASET_EXPERIMENT("map_vectorization", RandomJobSamplePercentage<0>,
+                            AllTasks);
+REGISTER_DATASET_EXPERIMENT("spin_wait_handoff", RandomJobSamplePercentage<0>,
+                            AllTasks);
+REGISTER_DATASET_EXPERIMENT("shared_worker_pool", RandomJobSamplePercentage<0>,
+                            AllTasks);
+REGISTER_DATASET_EXPERIMENT("shuffle_element_handles",
+                            RandomJobSamplePercentage<0>, AllTasks);
+REGISTER_DATASET_EXPERIMENT("file_readahead", RandomJobSamplePercentage<0>,
+                            AllTasks);
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -23,6 +23,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/functional/function_ref.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/function.h"
@@ -247,6 +248,13 @@ bool MatchesAnyVersion(StringPiece op_prefix, StringPiece op_to_match);
 // the tensor is not aligned, returns a deep copy of the tensor.
 Tensor MaybeCopySubSlice(const Tensor& tensor, int64 index);
 
+// Polls `done` for up to `max_spin_us` microseconds, and returns whether it
+// returned true. A thread that expects the condition it waits for to become
+// true shortly can call this before parking on a condition variable, to save
+// the cost of being put to sleep and woken up again. Must be called without
+// holding the locks needed to make `done` true.
+bool SpinWait(int64_t max_spin_us, absl::FunctionRef<bool()> done);
+
 // Removes device placements from the ops of all functions in `library`.
 void StripDevicePlacement(FunctionDefLibrary* library);
 
@@ -673,6 +673,7 @@ GetOptimizationsTestCase GetOptimizationTestCase4() {
   options.mutable_optimization_options()->set_shuffle_and_repeat_fusion(true);
   options.mutable_optimization_options()->set_inject_prefetch(true);
   options.mutable_optimization_options()->set_seq_interleave_prefetch(true);
+  options.mutable_optimization_options()->set_autotune_model_path("/model");
   options.set_slack(true);
   return {options,
           /*expected_enabled=*/
@@ -680,7 +681,7 @@ GetOptimizationsTestCase GetOptimizationTestCase4() {
            "map_and_batch_fusion", "map_and_filter_fusion", "map_fusion",
            "map_parallelization", "noop_elimination", "parallel_batch",
            "shuffle_and_repeat_fusion", "slack", "inject_prefetch",
-           "seq_interleave_prefetch"},
+           "seq_interleave_prefetch", "profile_guided_pipeline"},
           /*expected_disabled=*/{},
           /*expected_default=*/{}};
 }
@@ -749,6 +750,15 @@ TEST(DatasetUtilsTest, CountBytes) {
   EXPECT_EQ(GetTotalBytes(compressed), compressed_element.ByteSizeLong());
 }
 
+TEST(DatasetUtilsTest, SpinWait) {
+  EXPECT_TRUE(SpinWait(/*max_spin_us=*/0, [] { return true; }));
+  EXPECT_FALSE(SpinWait(/*max_spin_us=*/100, [] { return false; }));
+  int polls = 0;
+  EXPECT_TRUE(SpinWait(/*max_spin_us=*/1000000, [&polls] {
+    return ++polls == 1000;
+  }));
+}
+
 TEST_F(DatasetOpsTestBase, TestVariantEqualityChecking) {
   Tensor scalar_0{DT_VARIANT, TensorShape({})};
   scalar_0.scalar<Variant>()() = TestVariant({CreateTensor<int64_t>({}, {0})});
@@ -0,0 +1,241 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/readahead_scheduler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/stringpiece.h"
+
+namespace tensorflow {
+namespace data {
+
+// A file that serves reads from chunks of the wrapped file, and reads the
+// chunks that follow the position of the last read ahead of time.
+class ReadaheadScheduler::File : public RandomAccessFile {
+ public:
+  File(ReadaheadScheduler* scheduler, std::unique_ptr<RandomAccessFile> file)
+      : scheduler_(scheduler),
+        file_(std::move(file)),
+        state_(std::make_shared<State>()) {}
+
+  Status Name(StringPiece* result) const override {
+    return file_->Name(result);
+  }
+
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    const int64_t chunk_size = scheduler_->options().chunk_size;
+    size_t copied = 0;
+    Status status;
+    while (copied < n) {
+      const uint64 position = offset + copied;
+      const int64_t index = position / chunk_size;
+      std::shared_ptr<Chunk> chunk;
+      bool read_on_demand = false;
+      {
+        mutex_lock l(state_->mu);
+        auto it = state_->chunks.find(index);
+        if (it != state_->chunks.end()) {
+          chunk = it->second;
+        } else {
+          // Chunks read on demand do not count against the budget, so that
+          // readers make progress when it is used up.
+          chunk = std::make_shared<Chunk>(/*scheduler=*/nullptr,
+                                          /*reserved_bytes=*/0);
+          state_->chunks[index] = chunk;
+          read_on_demand = true;
+        }
+        ScheduleReadaheadLocked(index + 1);
+      }
+      if (read_on_demand) {
+        ReadChunk(*file_, index, chunk_size, chunk.get());
+        Publish(state_.get(), index, chunk.get());
+      } else {
+        mutex_lock l(state_->mu);
+        while (!chunk->done) {
+          state_->cond_var.wait(l);
+        }
+      }
+      // The contents of a chunk do not change once it is done.
+      const uint64 chunk_offset = position - index * chunk_size;
+      if (chunk_offset >= chunk->size) {
+        status = chunk->status;
+        break;
+      }
+      const size_t length = std::min<uint64>(n - copied,
+                                             chunk->size - chunk_offset);
+      memcpy(scratch + copied, chunk->data.get() + chunk_offset, length);
+      copied += length;
+    }
+    {
+      // Drop the chunks that precede the position of the reader.
+      mutex_lock l(state_->mu);
+      const int64_t index = (offset + copied) / chunk_size;
+      state_->chunks.erase(state_->chunks.begin(),
+                           state_->chunks.lower_bound(index));
+    }
+    *result = StringPiece(scratch, copied);
+    if (copied == n) {
+      return absl::OkStatus();
+    }
+    return status.ok() ? errors::OutOfRange("EOF reached") : status;
+  }
+
+ private:
+  struct Chunk {
+    Chunk(ReadaheadScheduler* scheduler, int64_t reserved_bytes)
+        : scheduler(scheduler), reserved_bytes(reserved_bytes) {}
+
+    ~Chunk() {
+      if (reserved_bytes > 0) {
+        scheduler->Release(reserved_bytes);
+      }
+    }
+
+    ReadaheadScheduler* const scheduler;
+    const int64_t reserved_bytes;
+    // Written by the reading thread before `done` is set.
+    std::unique_ptr<char[]> data;
+    uint64 size = 0;
+    // `OutOfRange` if the chunk ends the file.
+    Status status;
+    // Guarded by `State::mu`.
+    bool done = false;
+  };
+
+  // The state shared with the in-flight reads, which may outlive the file.
+  struct State {
+    mutex mu;
+    // Signalled when a chunk is done.
+    condition_variable cond_var;
+    std::map<int64_t, std::shared_ptr<Chunk>> chunks TF_GUARDED_BY(mu);
+    // The index of the first chunk past the end of the file, once known.
+    int64_t end_index TF_GUARDED_BY(mu) = std::numeric_limits<int64_t>::max();
+  };
+
+  // Reads the chunk at `index` of `file` into `chunk`.
+  static void ReadChunk(const RandomAccessFile& file, int64_t index,
+                        int64_t chunk_size, Chunk* chunk) {
+    chunk->data = std::make_unique<char[]>(chunk_size);
+    StringPiece result;
+    Status s =
+        file.Read(index * chunk_size, chunk_size, &result, chunk->data.get());
+    if (result.data() != chunk->data.get()) {
+      memmove(chunk->data.get(), result.data(), result.size());
+    }
+    chunk->size = result.size();
+    if (s.ok() && static_cast<int64_t>(result.size()) < chunk_size) {
+      s = errors::OutOfRange("EOF reached");
+    }
+    chunk->status = std::move(s);
+  }
+
+  // Marks `chunk` at `index` as done, and wakes up its readers.
+  static void Publish(State* state, int64_t index, Chunk* chunk) {
+    mutex_lock l(state->mu);
+    chunk->done = true;
+    if (errors::IsOutOfRange(chunk->status)) {
+      state->end_index = std::min(state->end_index, index + 1);
+    } else if (!chunk->status.ok()) {
+      // Forget failed chunks, so that later reads retry them.
+      auto it = state->chunks.find(index);
+      if (it != state->chunks.end() && it->second.get() == chunk) {
+        state->chunks.erase(it);
+      }
+    }
+    state->cond_var.notify_all();
+  }
+
+  // Schedules the reads of the chunks from `first_index` on that are not
+  // buffered yet, as far as the budget allows.
+  void ScheduleReadaheadLocked(int64_t first_index) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(state_->mu) {
+    const int64_t chunk_size = scheduler_->options().chunk_size;
+    const int64_t end_index =
+        std::min(first_index + scheduler_->options().readahead_chunks,
+                 state_->end_index);
+    for (int64_t index = first_index; index < end_index; ++index) {
+      if (state_->chunks.count(index) > 0) {
+        continue;
+      }
+      if (!scheduler_->TryReserve(chunk_size)) {
+        return;
+      }
+      auto chunk = std::make_shared<Chunk>(scheduler_, chunk_size);
+      state_->chunks[index] = chunk;
+      scheduler_->Schedule(
+          [state = state_, file = file_, chunk, index, chunk_size]() {
+            ReadChunk(*file, index, chunk_size, chunk.get());
+            Publish(state.get(), index, chunk.get());
+          });
+    }
+  }
+
+  ReadaheadScheduler* const scheduler_;
+  const std::shared_ptr<const RandomAccessFile> file_;
+  const std::shared_ptr<State> state_;
+};
+
+ReadaheadScheduler::ReadaheadScheduler(Env* env,
+                                       const std::string& thread_name,
+                                       const Options& options)
+    : options_(options),
+      thread_pool_(env, thread_name, options.num_threads) {}
+
+ReadaheadScheduler* ReadaheadScheduler::Get() {
+  static ReadaheadScheduler* scheduler = new ReadaheadScheduler(
+      Env::Default(), "tf_data_readahead", Options());
+  return scheduler;
+}
+
+std::unique_ptr<RandomAccessFile> ReadaheadScheduler::Wrap(
+    std::unique_ptr<RandomAccessFile> file) {
+  return std::make_unique<File>(this, std::move(file));
+}
+
+bool ReadaheadScheduler::TryReserve(int64_t bytes) {
+  int64_t current = inflight_bytes_.load(std::memory_order_relaxed);
+  do {
+    if (current + bytes > options_.max_inflight_bytes) {
+      return false;
+    }
+  } while (!inflight_bytes_.compare_exchange_weak(
+      current, current + bytes, std::memory_order_relaxed));
+  return true;
+}
+
+void ReadaheadScheduler::Release(int64_t bytes) {
+  inflight_bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+void ReadaheadScheduler::Schedule(std::function<void()> fn) {
+  thread_pool_.Schedule(std::move(fn));
+}
+
+}  // namespace data
+}  // namespace tensorflow
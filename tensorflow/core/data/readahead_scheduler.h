@@ -0,0 +1,100 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_READAHEAD_SCHEDULER_H_
+#define TENSORFLOW_CORE_DATA_READAHEAD_SCHEDULER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace data {
+
+// A `ReadaheadScheduler` reads files that are consumed sequentially ahead of
+// their readers, in large chunks issued concurrently on a pool of I/O threads.
+//
+// Files are wrapped with `Wrap()`. Every read of a wrapped file schedules the
+// reads of the next `readahead_chunks` chunks that are not buffered yet, so
+// that the chunks are usually in memory by the time the reader needs them.
+// The chunks read ahead by all the files of a scheduler, whether in flight or
+// buffered, never exceed `max_inflight_bytes`: once the budget is used up,
+// files read the chunks they need on demand until earlier chunks are consumed.
+// This keeps the read bandwidth of many concurrent readers, such as the inputs
+// of an interleave, saturated on filesystems with high per-request latency.
+class ReadaheadScheduler {
+ public:
+  struct Options {
+    // The number of threads that issue the reads.
+    int num_threads = 16;
+    // The size of the reads issued to the wrapped files.
+    int64_t chunk_size = 8 << 20;
+    // The number of chunks read ahead of the position of each reader.
+    int readahead_chunks = 4;
+    // The maximum number of bytes read ahead and not consumed yet, across all
+    // the files of the scheduler.
+    int64_t max_inflight_bytes = 256 << 20;
+  };
+
+  ReadaheadScheduler(Env* env, const std::string& thread_name,
+                     const Options& options);
+
+  // Waits for the in-flight reads to finish.
+  ~ReadaheadScheduler() = default;
+
+  // Returns the process-wide scheduler.
+  static ReadaheadScheduler* Get();
+
+  // Returns a file that reads `file` through this scheduler. The returned file
+  // must be destroyed before the scheduler.
+  std::unique_ptr<RandomAccessFile> Wrap(
+      std::unique_ptr<RandomAccessFile> file);
+
+  // Returns the number of bytes that are read ahead and not consumed yet.
+  int64_t InflightBytes() const {
+    return inflight_bytes_.load(std::memory_order_relaxed);
+  }
+
+  const Options& options() const { return options_; }
+
+ private:
+  class File;
+
+  // Reserves `bytes` of the budget. Returns false, and reserves nothing, if
+  // that would exceed the budget.
+  bool TryReserve(int64_t bytes);
+
+  // Returns `bytes` to the budget.
+  void Release(int64_t bytes);
+
+  // Runs `fn` on one of the I/O threads.
+  void Schedule(std::function<void()> fn);
+
+  const Options options_;
+  std::atomic<int64_t> inflight_bytes_{0};
+  // Destroyed first, so that the in-flight reads can still release their
+  // reservations.
+  thread::ThreadPool thread_pool_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_READAHEAD_SCHEDULER_H_
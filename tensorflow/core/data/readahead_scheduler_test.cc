@@ -0,0 +1,131 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/readahead_scheduler.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Writes a file of `size` bytes, and returns its contents.
+std::string WriteTestFile(const std::string& filename, int size) {
+  std::string contents;
+  contents.reserve(size);
+  for (int i = 0; i < size; ++i) {
+    contents.push_back(static_cast<char>('a' + i % 26));
+  }
+  TF_CHECK_OK(WriteStringToFile(Env::Default(), filename, contents));
+  return contents;
+}
+
+std::unique_ptr<RandomAccessFile> OpenFile(ReadaheadScheduler& scheduler,
+                                           const std::string& filename) {
+  std::unique_ptr<RandomAccessFile> file;
+  TF_CHECK_OK(Env::Default()->NewRandomAccessFile(filename, &file));
+  return scheduler.Wrap(std::move(file));
+}
+
+ReadaheadScheduler::Options TestOptions(int64_t max_inflight_bytes) {
+  ReadaheadScheduler::Options options;
+  options.num_threads = 4;
+  options.chunk_size = 64;
+  options.readahead_chunks = 3;
+  options.max_inflight_bytes = max_inflight_bytes;
+  return options;
+}
+
+class ReadaheadSchedulerTest
+    : public ::testing::TestWithParam<int64_t /*max_inflight_bytes*/> {};
+
+TEST_P(ReadaheadSchedulerTest, SequentialReads) {
+  ReadaheadScheduler scheduler(Env::Default(), "test", TestOptions(GetParam()));
+  const std::string filename =
+      absl::StrCat(testing::TmpDir(), "/readahead_sequential");
+  const std::string contents = WriteTestFile(filename, 1000);
+  std::unique_ptr<RandomAccessFile> file = OpenFile(scheduler, filename);
+  std::string read;
+  std::vector<char> scratch(50);
+  Status s;
+  while (s.ok()) {
+    StringPiece result;
+    s = file->Read(read.size(), scratch.size(), &result, scratch.data());
+    read.append(result.data(), result.size());
+    EXPECT_LE(scheduler.InflightBytes(), GetParam());
+  }
+  EXPECT_TRUE(errors::IsOutOfRange(s)) << s;
+  EXPECT_EQ(read, contents);
+}
+
+TEST_P(ReadaheadSchedulerTest, ReadsAcrossChunks) {
+  ReadaheadScheduler scheduler(Env::Default(), "test", TestOptions(GetParam()));
+  const std::string filename =
+      absl::StrCat(testing::TmpDir(), "/readahead_across_chunks");
+  const std::string contents = WriteTestFile(filename, 1000);
+  std::unique_ptr<RandomAccessFile> file = OpenFile(scheduler, filename);
+  std::vector<char> scratch(300);
+  StringPiece result;
+  TF_ASSERT_OK(file->Read(10, 300, &result, scratch.data()));
+  EXPECT_EQ(result, contents.substr(10, 300));
+  // Reading backwards reads the dropped chunks again.
+  TF_ASSERT_OK(file->Read(0, 20, &result, scratch.data()));
+  EXPECT_EQ(result, contents.substr(0, 20));
+  Status s = file->Read(900, 300, &result, scratch.data());
+  EXPECT_TRUE(errors::IsOutOfRange(s)) << s;
+  EXPECT_EQ(result, contents.substr(900));
+  s = file->Read(2000, 10, &result, scratch.data());
+  EXPECT_TRUE(errors::IsOutOfRange(s)) << s;
+  EXPECT_TRUE(result.empty());
+}
+
+INSTANTIATE_TEST_SUITE_P(Budgets, ReadaheadSchedulerTest,
+                         ::testing::Values(0, 64, 1 << 20));
+
+TEST(ReadaheadSchedulerBudgetTest, SharesBudgetAcrossFiles) {
+  ReadaheadScheduler scheduler(Env::Default(), "test",
+                               TestOptions(/*max_inflight_bytes=*/256));
+  std::vector<std::string> contents;
+  std::vector<std::unique_ptr<RandomAccessFile>> files;
+  for (int i = 0; i < 4; ++i) {
+    const std::string filename =
+        absl::StrCat(testing::TmpDir(), "/readahead_budget_", i);
+    contents.push_back(WriteTestFile(filename, 1000 + i));
+    files.push_back(OpenFile(scheduler, filename));
+  }
+  // Interleave the reads of the files, as the inputs of an interleave do.
+  std::vector<char> scratch(40);
+  for (int offset = 0; offset < 1000; offset += scratch.size()) {
+    for (int i = 0; i < files.size(); ++i) {
+      StringPiece result;
+      Status s = files[i]->Read(offset, scratch.size(), &result,
+                                scratch.data());
+      EXPECT_TRUE(s.ok() || errors::IsOutOfRange(s)) << s;
+      EXPECT_EQ(result, contents[i].substr(offset, scratch.size()));
+      EXPECT_LE(scheduler.InflightBytes(), 256);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
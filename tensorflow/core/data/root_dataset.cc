@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/rewrite_utils.h"
+#include "tensorflow/core/data/shared_worker_pool.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/dataset_options.pb.h"
 #include "tensorflow/core/framework/metrics.h"
@@ -57,6 +58,7 @@ constexpr char kRamBudget[] = "ram_budget_megabytes";
 constexpr char kRamUsage[] = "ram_usage_megabytes";
 constexpr char kMaxBufferBytes[] = "max_buffered_megabytes";
 constexpr char kWarmStart[] = "warm_start";
+constexpr char kSharedWorkerPoolExperiment[] = "shared_worker_pool";
 
 // If value `x` matches `y`, returns default value `z`. Otherwise, return `x`.
 inline int64_t value_or_default(int64_t x, int64_t y, int64_t z) {
@@ -107,6 +109,24 @@ void SetRootDatasetParams(const Options& options, RootDataset::Params* params) {
   params->ram_budget_share = ram_budget_share;
 }
 
+// Returns the total parallelism that autotuning has chosen for the pipeline of
+// `model`, which determines its share of the shared worker pool.
+double TunedParallelism(const model::Model& model) {
+  std::shared_ptr<model::Node> output = model.output();
+  if (output == nullptr) {
+    return 1.0;
+  }
+  double parallelism = 0.0;
+  for (const auto& pair : output->CollectTunableParameters()) {
+    if (pair.second->name != model::kParallelism) {
+      continue;
+    }
+    tf_shared_lock l(*pair.second->state->mu);
+    parallelism += std::max(pair.second->state->value, pair.second->min);
+  }
+  return std::max(parallelism, 1.0);
+}
+
 void AddTraceMetadata(const RootDataset::Params& params, const Options& options,
                       TraceMeMetadata* trace_metadata) {
   if (params.autotune) {
@@ -217,6 +237,17 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
         model_->AddExperiment("autotune_buffer_optimization");
       }
     }
+    // A private threadpool requested through the options takes precedence over
+    // the shared worker pool.
+    if (dataset()->params_.private_threadpool_size < 0 &&
+        GetExperiments().contains(kSharedWorkerPoolExperiment)) {
+      std::function<double()> weight_func = nullptr;
+      if (model_) {
+        weight_func = [model = model_]() { return TunedParallelism(*model); };
+      }
+      worker_pool_client_ =
+          SharedWorkerPool::Get()->NewClient(std::move(weight_func));
+    }
     IteratorContext iter_ctx(CreateParams(ctx));
     if (model_) {
       auto factory = [&iter_ctx, this](model::Node::Args args) {
@@ -331,6 +362,9 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
         pool->Schedule(std::move(c));
       };
       params.runner_threadpool_size = threadpool_size_;
+    } else if (worker_pool_client_) {
+      params.runner = worker_pool_client_->runner();
+      params.runner_threadpool_size = SharedWorkerPool::Get()->NumThreads();
     }
     if (dataset()->params_.max_intra_op_parallelism >= 0) {
       params.runner =
@@ -378,6 +412,10 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
   int64_t max_intra_op_parallelism_;
   int64_t threadpool_size_;
   std::unique_ptr<thread::ThreadPool> thread_pool_;
+  // Schedules the work of the pipeline on the process-wide worker pool, if
+  // enabled. Destroying it waits for the pending work, which must happen after
+  // `input_impl_` is destroyed.
+  std::unique_ptr<SharedWorkerPool::Client> worker_pool_client_;
 
   // The end time of the previous `GetNextInternal` call.
   uint64_t end_time_usec_ TF_GUARDED_BY(mu_) = 0;
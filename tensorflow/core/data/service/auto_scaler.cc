@@ -26,6 +26,7 @@ limitations under the License.
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/log.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/metrics.h"
@@ -36,6 +37,21 @@ namespace tensorflow {
 namespace data {
 
 constexpr double kAutoScalerOutlierSigmas = 1.0;
+// Smoothing factors of the consumption rates and of their trends. Higher
+// values follow the latest reports more closely.
+constexpr double kConsumptionRateSmoothing = 0.5;
+constexpr double kConsumptionTrendSmoothing = 0.3;
+// A consumer that is slowing down does not stop consuming, so predictions do
+// not go below this fraction of its current consumption rate.
+constexpr double kMinPredictedConsumptionFraction = 0.5;
+// How far ahead the recommended number of workers looks, which should cover
+// the time it takes to start a worker.
+constexpr absl::Duration kScalingForecastHorizon = absl::Minutes(1);
+// Changes of less than this fraction of the current number of workers are not
+// recommended.
+constexpr double kScalingHysteresisFraction = 0.1;
+// How long a decrease must be recommended before workers are removed.
+constexpr absl::Duration kScaleDownStabilizationPeriod = absl::Minutes(5);
 
 template <typename T>
 double GetMedian(const absl::flat_hash_map<T, double>& rates) {
@@ -96,11 +112,12 @@ void ReplaceOutliers(const absl::flat_hash_map<T, double>& rates,
   }
 }
 
-std::optional<int64_t> AutoScaler::GetOptimalNumberOfWorkers() const
-    TF_LOCKS_EXCLUDED(mu_) {
-  tsl::mutex_lock l(mu_);
-
-  if (worker_throughputs_.empty() || consumption_rates_.empty())
+// Estimates the number of workers with `worker_throughputs` that keep up with
+// `consumption_rates`.
+std::optional<int64_t> EstimateNumberOfWorkers(
+    const absl::flat_hash_map<int64_t, double>& consumption_rates,
+    const absl::flat_hash_map<std::string, double>& worker_throughputs) {
+  if (worker_throughputs.empty() || consumption_rates.empty())
     return std::nullopt;
 
   std::vector<double> consumption_rates_without_outliers;
@@ -108,21 +125,21 @@ std::optional<int64_t> AutoScaler::GetOptimalNumberOfWorkers() const
   // values are correct.
   // Outliers can make the estimate have an unfeasible value (very high or very
   // low).
-  ReplaceOutliers(consumption_rates_, consumption_rates_without_outliers,
+  ReplaceOutliers(consumption_rates, consumption_rates_without_outliers,
                   kAutoScalerOutlierSigmas);
   double consumption_rates_sum_ =
       std::accumulate(consumption_rates_without_outliers.begin(),
                       consumption_rates_without_outliers.end(), 0.0);
 
   std::vector<double> worker_throughputs_without_outliers;
-  ReplaceOutliers(worker_throughputs_, worker_throughputs_without_outliers,
+  ReplaceOutliers(worker_throughputs, worker_throughputs_without_outliers,
                   kAutoScalerOutlierSigmas);
   double worker_throughputs_sum_ =
       std::accumulate(worker_throughputs_without_outliers.begin(),
                       worker_throughputs_without_outliers.end(), 0.0);
 
   double average_worker_throughput =
-      worker_throughputs_sum_ / static_cast<double>(worker_throughputs_.size());
+      worker_throughputs_sum_ / static_cast<double>(worker_throughputs.size());
 
   int64_t optimal_number_of_workers =
       ceil(consumption_rates_sum_ / average_worker_throughput);
@@ -130,6 +147,43 @@ std::optional<int64_t> AutoScaler::GetOptimalNumberOfWorkers() const
   return std::max(int64_t{1}, optimal_number_of_workers);
 }
 
+// Limits `optimal_number_of_workers` to wait for target processing times to
+// converge to a feasible value. First, it increases exponentially by 4x. Once
+// increases are greater than 500, it scales linearly. The result is
+// at most 100k workers.
+int64_t BoundNumberOfWorkers(int64_t optimal_number_of_workers,
+                             int64_t current_number_of_workers) {
+  int64_t bound_optimal_number_of_workers = optimal_number_of_workers;
+  if (bound_optimal_number_of_workers > current_number_of_workers * 4 ||
+      bound_optimal_number_of_workers > current_number_of_workers + 500) {
+    bound_optimal_number_of_workers = std::min(current_number_of_workers * 4,
+                                               current_number_of_workers + 500);
+  }
+  return std::min(bound_optimal_number_of_workers, int64_t{100000});
+}
+
+std::optional<int64_t> AutoScaler::GetOptimalNumberOfWorkers() const
+    TF_LOCKS_EXCLUDED(mu_) {
+  tsl::mutex_lock l(mu_);
+  return EstimateNumberOfWorkers(consumption_rates_, worker_throughputs_);
+}
+
+std::optional<int64_t> AutoScaler::GetPredictedOptimalNumberOfWorkers(
+    absl::Duration horizon) const TF_LOCKS_EXCLUDED(mu_) {
+  const absl::Time now = absl::FromUnixMicros(env_->NowMicros());
+  tsl::mutex_lock l(mu_);
+  absl::flat_hash_map<int64_t, double> predicted_consumption_rates;
+  for (const auto& [consumer_id, trend] : consumption_trends_) {
+    const double seconds_ahead =
+        absl::ToDoubleSeconds(now - trend.last_report_time + horizon);
+    predicted_consumption_rates[consumer_id] =
+        std::max(trend.rate + trend.rate_per_second * seconds_ahead,
+                 trend.rate * kMinPredictedConsumptionFraction);
+  }
+  return EstimateNumberOfWorkers(predicted_consumption_rates,
+                                 worker_throughputs_);
+}
+
 absl::Status AutoScaler::ReportProcessingTime(const std::string& worker_address,
                                               absl::Duration processing_time)
     TF_LOCKS_EXCLUDED(mu_) {
@@ -157,9 +211,29 @@ absl::Status AutoScaler::ReportTargetProcessingTime(
   }
 
   double consumption_rate = 1.0 / absl::ToDoubleSeconds(target_processing_time);
+  const absl::Time now = absl::FromUnixMicros(env_->NowMicros());
   tsl::mutex_lock l(mu_);
   consumption_rates_[consumer_id] = consumption_rate;
 
+  // Updates the trend with Holt's linear method, scaled by the time between
+  // the reports since consumers do not report at a fixed interval.
+  auto [it, inserted] = consumption_trends_.try_emplace(
+      consumer_id, ConsumptionTrend{consumption_rate, 0.0, now});
+  ConsumptionTrend& trend = it->second;
+  const double elapsed_seconds =
+      absl::ToDoubleSeconds(now - trend.last_report_time);
+  if (!inserted && elapsed_seconds > 0.0) {
+    const double predicted_rate =
+        trend.rate + trend.rate_per_second * elapsed_seconds;
+    const double rate = kConsumptionRateSmoothing * consumption_rate +
+                        (1.0 - kConsumptionRateSmoothing) * predicted_rate;
+    trend.rate_per_second =
+        kConsumptionTrendSmoothing * (rate - trend.rate) / elapsed_seconds +
+        (1.0 - kConsumptionTrendSmoothing) * trend.rate_per_second;
+    trend.rate = rate;
+    trend.last_report_time = now;
+  }
+
   return absl::OkStatus();
 }
 
@@ -183,6 +257,7 @@ absl::Status AutoScaler::RemoveConsumer(int64_t consumer_id)
         absl::StrCat("Consumer with ID ", consumer_id, " not found"));
 
   consumption_rates_.erase(consumer_id);
+  consumption_trends_.erase(consumer_id);
 
   return absl::OkStatus();
 }
@@ -190,7 +265,7 @@ absl::Status AutoScaler::RemoveConsumer(int64_t consumer_id)
 void MultipleIterationsAutoScaler::EnsureIterationIsRegistered(
     int64_t iteration_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   if (!auto_scalers_.contains(iteration_id)) {
-    auto_scalers_[iteration_id] = std::make_unique<AutoScaler>();
+    auto_scalers_[iteration_id] = std::make_unique<AutoScaler>(env_);
   }
 }
 
@@ -221,18 +296,8 @@ absl::Status MultipleIterationsAutoScaler::UpdateOptimalNumberOfWorkersMetric(
   VLOG(3) << "Estimated optimal number of workers: "
           << optimal_number_of_workers.value();
 
-  // Limit the estimate to wait for target processing times to converge to a
-  // feasible value. First, start increasing exponentially by 4x. Once
-  // increases are greater than 500, scale linearly.
-  int64_t bound_optimal_number_of_workers = optimal_number_of_workers.value();
-  if (bound_optimal_number_of_workers > current_number_of_workers * 4 ||
-      bound_optimal_number_of_workers > current_number_of_workers + 500) {
-    bound_optimal_number_of_workers = std::min(current_number_of_workers * 4,
-                                               current_number_of_workers + 500);
-  }
-  // Limit the estimate to at most 100k workers.
-  bound_optimal_number_of_workers =
-      std::min(bound_optimal_number_of_workers, int64_t{100000});
+  int64_t bound_optimal_number_of_workers = BoundNumberOfWorkers(
+      optimal_number_of_workers.value(), current_number_of_workers);
   VLOG(3) << "Bound optimal number of workers: "
           << bound_optimal_number_of_workers;
 
@@ -242,6 +307,44 @@ absl::Status MultipleIterationsAutoScaler::UpdateOptimalNumberOfWorkersMetric(
   return absl::OkStatus();
 }
 
+absl::StatusOr<int64_t> MultipleIterationsAutoScaler::GetRecommendedWorkerDelta(
+    int64_t current_number_of_workers) TF_LOCKS_EXCLUDED(mu_) {
+  if (current_number_of_workers <= 0)
+    return absl::InvalidArgumentError(
+        "The current number of workers must be positive");
+
+  std::optional<int64_t> predicted_number_of_workers =
+      GetPredictedOptimalNumberOfWorkers(kScalingForecastHorizon);
+  if (!predicted_number_of_workers)
+    return absl::UnavailableError(
+        "Cannot recommend a number of workers because there are no reported "
+        "processing and target processing times for at least one iteration");
+
+  const int64_t delta = BoundNumberOfWorkers(*predicted_number_of_workers,
+                                             current_number_of_workers) -
+                        current_number_of_workers;
+  const int64_t tolerance = std::max<int64_t>(
+      1, static_cast<int64_t>(current_number_of_workers *
+                              kScalingHysteresisFraction));
+  const absl::Time now = absl::FromUnixMicros(env_->NowMicros());
+  VLOG(3) << "Predicted number of workers: "
+          << predicted_number_of_workers.value()
+          << ", worker delta: " << delta << ", tolerance: " << tolerance;
+
+  tsl::mutex_lock l(mu_);
+  if (delta >= -tolerance) {
+    scale_down_since_.reset();
+    return delta > tolerance ? delta : 0;
+  }
+  if (!scale_down_since_.has_value()) {
+    scale_down_since_ = now;
+  }
+  if (now - *scale_down_since_ < kScaleDownStabilizationPeriod) {
+    return 0;
+  }
+  return delta;
+}
+
 std::optional<int64_t> MultipleIterationsAutoScaler::GetOptimalNumberOfWorkers()
     const TF_LOCKS_EXCLUDED(mu_) {
   int64_t optimal_number_of_workers = 0;
@@ -263,6 +366,26 @@ std::optional<int64_t> MultipleIterationsAutoScaler::GetOptimalNumberOfWorkers()
     return optimal_number_of_workers;
 }
 
+std::optional<int64_t>
+MultipleIterationsAutoScaler::GetPredictedOptimalNumberOfWorkers(
+    absl::Duration horizon) const TF_LOCKS_EXCLUDED(mu_) {
+  int64_t optimal_number_of_workers = 0;
+  {
+    tsl::tf_shared_lock l(mu_);
+    for (const auto& [iteration_id, auto_scaler] : auto_scalers_) {
+      std::optional<int64_t> current_optimal_number_of_workers =
+          auto_scaler->GetPredictedOptimalNumberOfWorkers(horizon);
+      if (!current_optimal_number_of_workers.has_value()) continue;
+
+      optimal_number_of_workers = std::max(
+          optimal_number_of_workers, current_optimal_number_of_workers.value());
+    }
+  }
+
+  if (optimal_number_of_workers == 0) return std::nullopt;
+  return optimal_number_of_workers;
+}
+
 absl::Status MultipleIterationsAutoScaler::ReportProcessingTime(
     int64_t iteration_id, const std::string& worker_address,
     absl::Duration processing_time) TF_LOCKS_EXCLUDED(mu_) {
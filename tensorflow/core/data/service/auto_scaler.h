@@ -22,7 +22,9 @@ limitations under the License.
 #include <string>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
 #include "absl/time/time.h"
+#include "tsl/platform/env.h"
 #include "tsl/platform/mutex.h"
 #include "tsl/platform/status.h"
 #include "tsl/platform/thread_annotations.h"
@@ -63,16 +65,26 @@ namespace data {
 // follows:
 //  N = (Sum of CRs reported by all consumers) /
 //      (Average of WTs reported by all workers)
+// 3. It also follows the trend of the CR of each consumer, which changes as
+// the trainer step time does, with double exponential smoothing. This lets it
+// predict N a while ahead, so that workers can be added before the consumers
+// start to wait for elements.
 //
 // AutoScaler is thread-safe.
 class AutoScaler {
  public:
-  AutoScaler() = default;
+  // `env` is used to tell the time of the reports.
+  explicit AutoScaler(tsl::Env* env = tsl::Env::Default()) : env_(env) {}
   // Returns the estimated optimal number of workers according to the current
   // observed workload. If there are no previously reported processing and
   // target processing times, returns nullopt.
   std::optional<int64_t> GetOptimalNumberOfWorkers() const
       TF_LOCKS_EXCLUDED(mu_);
+  // Returns the estimated optimal number of workers for the consumption rates
+  // predicted `horizon` from now. If there are no previously reported
+  // processing and target processing times, returns nullopt.
+  std::optional<int64_t> GetPredictedOptimalNumberOfWorkers(
+      absl::Duration horizon) const TF_LOCKS_EXCLUDED(mu_);
   // Reports the latest observed processing time from the worker with
   // `worker_address`. Returns an error if `processing_time` is ZeroDuration or
   // negative.
@@ -96,12 +108,25 @@ class AutoScaler {
   absl::Status RemoveConsumer(int64_t consumer_id) TF_LOCKS_EXCLUDED(mu_);
 
  private:
+  // The smoothed consumption rate of a consumer and its rate of change.
+  struct ConsumptionTrend {
+    // Consumption rate at `last_report_time`, in elements per second.
+    double rate = 0.0;
+    // Change of the consumption rate, in elements per second per second.
+    double rate_per_second = 0.0;
+    absl::Time last_report_time;
+  };
+
+  tsl::Env* const env_;
   mutable tsl::mutex mu_;
   // Map from worker address to worker throughput.
   absl::flat_hash_map<std::string, double> worker_throughputs_
       TF_GUARDED_BY(mu_);
   // Map from consumer id to consumption rate.
   absl::flat_hash_map<int64_t, double> consumption_rates_ TF_GUARDED_BY(mu_);
+  // Map from consumer id to the trend of its consumption rate.
+  absl::flat_hash_map<int64_t, ConsumptionTrend> consumption_trends_
+      TF_GUARDED_BY(mu_);
 };
 
 // Exports a metric (/tensorflow/data/service/optimal_number_of_workers) with
@@ -111,10 +136,16 @@ class AutoScaler {
 // It estimates the number of workers as the maximum of the estimated optimal
 // number of workers for all Iterations running in the tf.data service cluster.
 //
+// It also recommends how many workers to add or remove ahead of the predicted
+// workload, with hysteresis so that orchestration does not flap between
+// sizes: small changes are ignored, and workers are only removed after the
+// workload has stayed low for a while.
+//
 // MultipleIterationsAutoScaler is thread-safe.
 class MultipleIterationsAutoScaler {
  public:
-  MultipleIterationsAutoScaler() = default;
+  explicit MultipleIterationsAutoScaler(tsl::Env* env = tsl::Env::Default())
+      : env_(env) {}
   // Unregisters iteration with `iteration_id`, removing its reported
   // times from consideration of the current workload estimation.
   // Returns an error if the specified iteration does not exist.
@@ -126,11 +157,25 @@ class MultipleIterationsAutoScaler {
   // iteration, or `current_number_of_workers` is not positive.
   absl::Status UpdateOptimalNumberOfWorkersMetric(
       int64_t current_number_of_workers) TF_LOCKS_EXCLUDED(mu_);
+  // Returns the number of workers to add (if positive) or remove (if
+  // negative) to `current_number_of_workers`, according to the workload
+  // predicted for the next minute and bound like the metric. Returns 0 if the
+  // change is within the hysteresis band, or if a decrease has not been
+  // recommended for long enough. Returns an error if there are no previously
+  // reported processing and target processing times for at least one
+  // iteration, or `current_number_of_workers` is not positive.
+  absl::StatusOr<int64_t> GetRecommendedWorkerDelta(
+      int64_t current_number_of_workers) TF_LOCKS_EXCLUDED(mu_);
   // Returns the estimated optimal number of workers according to the current
   // observed workload. If there are no previously reported processing and
   // target processing times for at least one iteration, returns nullopt.
   std::optional<int64_t> GetOptimalNumberOfWorkers() const
       TF_LOCKS_EXCLUDED(mu_);
+  // Returns the estimated optimal number of workers for the workload predicted
+  // `horizon` from now. If there are no previously reported processing and
+  // target processing times for at least one iteration, returns nullopt.
+  std::optional<int64_t> GetPredictedOptimalNumberOfWorkers(
+      absl::Duration horizon) const TF_LOCKS_EXCLUDED(mu_);
   // Reports the latest observed processing time from the worker with
   // `worker_address` for iteration with `iteration_id`. Returns an error if
   // `processing_time` is ZeroDuration or negative.
@@ -167,10 +212,14 @@ class MultipleIterationsAutoScaler {
   // workload estimation.
   void EnsureIterationIsRegistered(int64_t iteration_id)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  tsl::Env* const env_;
   mutable tsl::mutex mu_;
   // Map from iteration id to AutoScaler.
   absl::flat_hash_map<int64_t, std::unique_ptr<AutoScaler>> auto_scalers_
       TF_GUARDED_BY(mu_);
+  // The time since which a decrease of the number of workers has been
+  // recommended without interruption, if one is.
+  std::optional<absl::Time> scale_down_since_ TF_GUARDED_BY(mu_);
 };
 
 }  // namespace data
@@ -20,6 +20,8 @@ limitations under the License.
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/lib/monitoring/cell_reader.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/util/fake_clock_env.h"
 #include "tsl/lib/core/status_test_util.h"
 #include "tsl/platform/status_matchers.h"
 
@@ -27,8 +29,13 @@ namespace tensorflow {
 namespace data {
 namespace {
 
+using ::tsl::testing::IsOkAndHolds;
 using ::tsl::testing::StatusIs;
 
+void AdvanceBy(FakeClockEnv& env, absl::Duration duration) {
+  env.AdvanceByMicroseconds(absl::ToInt64Microseconds(duration));
+}
+
 TEST(AutoScalerTest, GetOptimalNumberOfWorkersInitialState) {
   AutoScaler auto_scaler;
   EXPECT_EQ(auto_scaler.GetOptimalNumberOfWorkers(), std::nullopt);
@@ -308,6 +315,63 @@ TEST(AutoScalerTest, RemoveConsumerAfterNewTPTReported) {
   TF_ASSERT_OK(auto_scaler.RemoveConsumer(0));
 }
 
+// Worker 0:
+//   - Processing time = 0.1 [s] -> Throughput = 10 [elements/s]
+// Consumer 0, every 10 [s]:
+//   - Consumption rates = 10, 20, 40 [elements/s]
+//   - Smoothed consumption rates = 10, 15, 28.25 [elements/s]
+//   - Trends = 0, 0.15, 0.5025 [elements/s^2]
+//
+// Predicted consumption rate now = 28.25 [elements/s] -> 3 workers
+// Predicted consumption rate in 60 [s] = 58.4 [elements/s] -> 6 workers
+TEST(AutoScalerTest, GetPredictedOptimalNumberOfWorkersFollowsTrend) {
+  FakeClockEnv env(Env::Default());
+  AutoScaler auto_scaler(&env);
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime("/worker/task/0:20000",
+                                                absl::Seconds(0.1)));
+  TF_ASSERT_OK(auto_scaler.ReportTargetProcessingTime(0, absl::Seconds(0.1)));
+  AdvanceBy(env, absl::Seconds(10));
+  TF_ASSERT_OK(auto_scaler.ReportTargetProcessingTime(0, absl::Seconds(0.05)));
+  AdvanceBy(env, absl::Seconds(10));
+  TF_ASSERT_OK(auto_scaler.ReportTargetProcessingTime(0, absl::Seconds(0.025)));
+
+  EXPECT_EQ(auto_scaler.GetOptimalNumberOfWorkers(), 4);
+  EXPECT_EQ(auto_scaler.GetPredictedOptimalNumberOfWorkers(
+                absl::ZeroDuration()),
+            3);
+  EXPECT_EQ(auto_scaler.GetPredictedOptimalNumberOfWorkers(absl::Minutes(1)),
+            6);
+}
+
+// Consumer 0, every 10 [s]:
+//   - Consumption rates = 40, 10 [elements/s]
+//   - Smoothed consumption rates = 40, 25 [elements/s]
+//   - Trends = 0, -0.45 [elements/s^2]
+//
+// Predicted consumption rate in 60 [s] = max(-2, 25 / 2) [elements/s]
+TEST(AutoScalerTest, GetPredictedOptimalNumberOfWorkersSlowingConsumer) {
+  FakeClockEnv env(Env::Default());
+  AutoScaler auto_scaler(&env);
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime("/worker/task/0:20000",
+                                                absl::Seconds(0.1)));
+  TF_ASSERT_OK(auto_scaler.ReportTargetProcessingTime(0, absl::Seconds(0.025)));
+  AdvanceBy(env, absl::Seconds(10));
+  TF_ASSERT_OK(auto_scaler.ReportTargetProcessingTime(0, absl::Seconds(0.1)));
+
+  EXPECT_EQ(auto_scaler.GetPredictedOptimalNumberOfWorkers(absl::Minutes(1)),
+            2);
+}
+
+TEST(AutoScalerTest, GetPredictedOptimalNumberOfWorkersRemovedConsumer) {
+  AutoScaler auto_scaler;
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime("/worker/task/0:20000",
+                                                absl::Seconds(0.1)));
+  TF_ASSERT_OK(auto_scaler.ReportTargetProcessingTime(0, absl::Seconds(0.025)));
+  TF_ASSERT_OK(auto_scaler.RemoveConsumer(0));
+  EXPECT_EQ(auto_scaler.GetPredictedOptimalNumberOfWorkers(absl::Minutes(1)),
+            std::nullopt);
+}
+
 TEST(MultipleIterationsAutoScalerTest, UnregisterExistingIteration) {
   MultipleIterationsAutoScaler auto_scaler;
   TF_ASSERT_OK(
@@ -743,6 +807,64 @@ TEST(MultipleIterationsAutoScalerTest, RemoveConsumerAfterNewTPTReported) {
   TF_ASSERT_OK(auto_scaler.RemoveConsumer(0, 0));
 }
 
+TEST(MultipleIterationsAutoScalerTest,
+     GetRecommendedWorkerDeltaNonPositiveWorkers) {
+  MultipleIterationsAutoScaler auto_scaler;
+  EXPECT_THAT(auto_scaler.GetRecommendedWorkerDelta(0),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(MultipleIterationsAutoScalerTest, GetRecommendedWorkerDeltaNoReports) {
+  MultipleIterationsAutoScaler auto_scaler;
+  EXPECT_THAT(auto_scaler.GetRecommendedWorkerDelta(1),
+              StatusIs(absl::StatusCode::kUnavailable));
+}
+
+// Throughput = 10 [elements/s], consumption rate = 40 [elements/s]
+// -> 4 workers.
+TEST(MultipleIterationsAutoScalerTest, GetRecommendedWorkerDeltaScalesUp) {
+  FakeClockEnv env(Env::Default());
+  MultipleIterationsAutoScaler auto_scaler(&env);
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime(0, "/worker/task/0:20000",
+                                                absl::Seconds(0.1)));
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(0, 0, absl::Seconds(0.025)));
+  EXPECT_THAT(auto_scaler.GetRecommendedWorkerDelta(1), IsOkAndHolds(3));
+  EXPECT_THAT(auto_scaler.GetRecommendedWorkerDelta(3), IsOkAndHolds(0));
+  EXPECT_THAT(auto_scaler.GetRecommendedWorkerDelta(4), IsOkAndHolds(0));
+  EXPECT_THAT(auto_scaler.GetRecommendedWorkerDelta(5), IsOkAndHolds(0));
+}
+
+TEST(MultipleIterationsAutoScalerTest,
+     GetRecommendedWorkerDeltaScalesDownAfterStabilization) {
+  FakeClockEnv env(Env::Default());
+  MultipleIterationsAutoScaler auto_scaler(&env);
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime(0, "/worker/task/0:20000",
+                                                absl::Seconds(0.1)));
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(0, 0, absl::Seconds(0.025)));
+  EXPECT_THAT(auto_scaler.GetRecommendedWorkerDelta(10), IsOkAndHolds(0));
+  AdvanceBy(env, absl::Minutes(4));
+  EXPECT_THAT(auto_scaler.GetRecommendedWorkerDelta(10), IsOkAndHolds(0));
+  AdvanceBy(env, absl::Minutes(1));
+  EXPECT_THAT(auto_scaler.GetRecommendedWorkerDelta(10), IsOkAndHolds(-6));
+}
+
+TEST(MultipleIterationsAutoScalerTest,
+     GetRecommendedWorkerDeltaScaleDownInterrupted) {
+  FakeClockEnv env(Env::Default());
+  MultipleIterationsAutoScaler auto_scaler(&env);
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime(0, "/worker/task/0:20000",
+                                                absl::Seconds(0.1)));
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(0, 0, absl::Seconds(0.025)));
+  EXPECT_THAT(auto_scaler.GetRecommendedWorkerDelta(10), IsOkAndHolds(0));
+  AdvanceBy(env, absl::Minutes(4));
+  EXPECT_THAT(auto_scaler.GetRecommendedWorkerDelta(4), IsOkAndHolds(0));
+  AdvanceBy(env, absl::Minutes(1));
+  EXPECT_THAT(auto_scaler.GetRecommendedWorkerDelta(10), IsOkAndHolds(0));
+}
+
 }  // namespace
 
 }  // namespace data
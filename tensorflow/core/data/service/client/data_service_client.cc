@@ -29,6 +29,7 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/log.h"
 #include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
 #include "absl/strings/substitute.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/data/service/client/common.h"
@@ -66,6 +67,29 @@ bool IsColocatedTask(const TaskInfo& task) {
   });
 }
 
+// Returns how far the worker of `task` is from this process: 0 for a local
+// worker, 1 for a worker on the rack of a local worker, 2 for a worker in the
+// zone of a local worker, and 3 otherwise.
+int64_t LocalityRank(const TaskInfo& task) {
+  if (LocalWorkers::Get(task.worker_address()) != nullptr) {
+    return 0;
+  }
+  int64_t rank = 3;
+  for (const auto& local_worker : LocalWorkers::GetAll()) {
+    for (const std::string& tag : local_worker->config().worker_tags()) {
+      if (!absl::c_linear_search(task.worker_tags(), tag)) {
+        continue;
+      }
+      if (absl::StartsWith(tag, kRackWorkerTagPrefix)) {
+        rank = std::min<int64_t>(rank, 1);
+      } else if (absl::StartsWith(tag, kZoneWorkerTagPrefix)) {
+        rank = std::min<int64_t>(rank, 2);
+      }
+    }
+  }
+  return rank;
+}
+
 absl::StatusOr<DataTransferServerInfo> GetTransferServer(
     const std::string& protocol, const TaskInfo& task_info) {
   for (const auto& transfer_server : task_info.transfer_servers()) {
@@ -420,7 +444,10 @@ Status DataServiceClient::AddTask(const TaskInfo& task_info)
   metrics::RecordTFDataServiceDataTransferProtocolUsed(
       worker->GetDataTransferProtocol(),
       /*user_specified=*/!params_.data_transfer_protocol.empty());
-  tasks_.push_back(std::make_shared<Task>(task_info, std::move(worker)));
+  auto task = std::make_shared<Task>(task_info, std::move(worker));
+  task->locality_rank = LocalityRank(task_info);
+  task->worker_processing_time_nsec = task_info.worker_processing_time_nsec();
+  tasks_.push_back(std::move(task));
   worker_thread_cv_.notify_one();
   if (IsCoordinatedRead()) {
     VLOG(1) << "Consumer " << params_.consumer_index.value() << " adding task "
@@ -495,10 +522,13 @@ void DataServiceClient::UpdateTasks(const ClientHeartbeatResponse& resp)
   int index = 0;
   while (index < tasks_.size()) {
     std::shared_ptr<Task> task = tasks_[index];
-    if (task_id_to_task.contains(task->info.task_id())) {
+    auto it = task_id_to_task.find(task->info.task_id());
+    if (it != task_id_to_task.end()) {
+      task->worker_processing_time_nsec =
+          it->second.worker_processing_time_nsec();
       // Remove already-known tasks from `task_id_to_task`, so that at the
       // end of the loop, only new tasks remain.
-      task_id_to_task.erase(task->info.task_id());
+      task_id_to_task.erase(it);
       ++index;
     } else {
       // Task has been removed.
@@ -689,6 +719,9 @@ std::shared_ptr<DataServiceClient::Task> DataServiceClient::GetTaskToProcess()
   if (!ShouldProcessTask()) {
     return nullptr;
   }
+  if (!IsCoordinatedRead()) {
+    return GetPreferredTaskToProcess();
+  }
 
   for (int i = 0; i < tasks_.size(); ++i) {
     std::shared_ptr<Task>& task = tasks_[next_task_index_];
@@ -720,6 +753,50 @@ std::shared_ptr<DataServiceClient::Task> DataServiceClient::GetTaskToProcess()
   return nullptr;
 }
 
+// Visits the tasks in-order like coordinated reads do, but skips over the
+// tasks of workers that are farther away or clearly slower than another
+// available task. Equally good tasks still take turns.
+std::shared_ptr<DataServiceClient::Task>
+DataServiceClient::GetPreferredTaskToProcess()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  std::optional<int64_t> best_index;
+  for (int i = 0; i < tasks_.size(); ++i) {
+    const int64_t index = (next_task_index_ + i) % tasks_.size();
+    const Task& task = *tasks_[index];
+    if (current_round_ < task.info.starting_round() || task.in_use ||
+        task.end_of_sequence || task.removed) {
+      continue;
+    }
+    if (!best_index.has_value() ||
+        IsPreferredTask(task, *tasks_[*best_index])) {
+      best_index = index;
+    }
+  }
+  if (!best_index.has_value()) {
+    VLOG(3) << "No task to process among " << tasks_.size() << " tasks.";
+    return nullptr;
+  }
+  std::shared_ptr<Task> task = tasks_[*best_index];
+  task->round = current_round_;
+  next_task_index_ = *best_index;
+  AdvanceTaskIndex();
+  return task;
+}
+
+bool DataServiceClient::IsPreferredTask(const Task& task,
+                                        const Task& other) const
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  // A worker needs to be this much faster to be read from out of turn, so
+  // that noise in the reported processing times does not starve workers.
+  constexpr double kMinProcessingTimeRatio = 1.5;
+  if (task.locality_rank != other.locality_rank) {
+    return task.locality_rank < other.locality_rank;
+  }
+  return task.worker_processing_time_nsec > 0 &&
+         task.worker_processing_time_nsec * kMinProcessingTimeRatio <
+             other.worker_processing_time_nsec;
+}
+
 // Increments the next task index, starting over if all tasks have been
 // processed.
 void DataServiceClient::AdvanceTaskIndex() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -113,6 +113,14 @@ class DataServiceClient {
     // Number of retries. The more it is retried, the longer it should wait
     // before the next retry.
     int64_t num_retries = 0;
+    // How far the worker is from the client: 0 for a local worker, 1 and 2
+    // for a worker sharing a rack or a zone with a local worker, and 3
+    // otherwise.
+    int64_t locality_rank = 0;
+    // The latest processing time reported by the dispatcher for the worker,
+    // or 0 if unknown.
+    double worker_processing_time_nsec TF_GUARDED_BY(&DataServiceClient::mu_) =
+        0;
   };
 
   struct Result {
@@ -173,6 +181,10 @@ class DataServiceClient {
   // Searches for a task to process, visiting tasks in-order and giving every
   // task a chance to proceed.
   std::shared_ptr<Task> GetTaskToProcess();
+  // Returns the task a non-coordinated read should process next.
+  std::shared_ptr<Task> GetPreferredTaskToProcess();
+  // Returns whether `task` should be read before `other`.
+  bool IsPreferredTask(const Task& task, const Task& other) const;
   void AdvanceTaskIndex();
   Status TryGetElement(const Task& task, GetElementResult& result);
   void ProcessGetElementResponse(bool enqueue_result,
@@ -39,6 +39,12 @@ constexpr int kDataServiceVersion = 9;
 // workers on other TF hosts when the host runs a local tf.data service worker.
 constexpr absl::string_view kColocatedWorkerTag = "COLOCATED";
 
+// Workers may be tagged with the zone and the rack they run in, e.g.
+// "zone:us-east1-b" and "rack:r12". Clients prefer reading from workers that
+// share a locality tag with their local workers.
+constexpr absl::string_view kZoneWorkerTagPrefix = "zone:";
+constexpr absl::string_view kRackWorkerTagPrefix = "rack:";
+
 // Container to hold the result of a `GetNext` call.
 struct GetNextResult final {
   explicit GetNextResult() = default;
@@ -20,10 +20,13 @@ limitations under the License.
 #include <functional>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
 #include "tensorflow/core/data/service/byte_size.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/platform/errors.h"
@@ -46,6 +49,11 @@ namespace data {
 // collected when the cache becomes full. Consequently, trainers read from a
 // sliding window through the dataset and may not read the full dataset.
 //
+// Optionally, elements garbage collected from memory overflow into a
+// `CacheOverflowTier`, such as a directory on local disk. Trainers that fall
+// behind the in-memory window read them from there, so the window covers both
+// budgets and trainers may drift further apart without skipping data.
+//
 // The `CrossTrainerCache` class is thread-safe.
 //
 // Example usage:
@@ -91,6 +99,28 @@ class CachableSequence {
   virtual size_t GetElementSizeBytes(const ElementType&) const = 0;
 };
 
+// A slower, larger tier that holds the elements evicted from the memory of a
+// `CrossTrainerCache`. Implementations must be thread-safe. `Read` may race
+// with `Delete` of the same index, in which case it returns a `NotFound`
+// error.
+template <class ElementType>
+class CacheOverflowTier {
+ public:
+  virtual ~CacheOverflowTier() = default;
+
+  // Returns the maximum number of bytes the tier may hold.
+  virtual size_t MaxSizeBytes() const = 0;
+
+  // Stores `element` at `index`. Returns the number of bytes it takes.
+  virtual StatusOr<size_t> Write(size_t index, const ElementType& element) = 0;
+
+  // Reads the element stored at `index`.
+  virtual StatusOr<ElementType> Read(size_t index) = 0;
+
+  // Deletes the element stored at `index`.
+  virtual Status Delete(size_t index) = 0;
+};
+
 // Sliding-window cache shared across concurrent trainers.
 template <class ElementType>
 class CrossTrainerCache {
@@ -101,6 +131,12 @@ class CrossTrainerCache {
   explicit CrossTrainerCache(
       size_t max_cache_size_bytes,
       std::unique_ptr<CachableSequence<ElementType>> cachable_sequence);
+  // Creates a `CrossTrainerCache` whose evicted elements are kept in
+  // `overflow_tier` until it reaches its own size limit.
+  CrossTrainerCache(
+      size_t max_cache_size_bytes,
+      std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+      std::unique_ptr<CacheOverflowTier<ElementType>> overflow_tier);
   virtual ~CrossTrainerCache() = default;
   CrossTrainerCache(const CrossTrainerCache&) = delete;
   CrossTrainerCache& operator=(const CrossTrainerCache&) = delete;
@@ -124,6 +160,10 @@ class CrossTrainerCache {
   struct CacheQueryResult {
     std::shared_ptr<const ElementType> element;
     bool cache_hit;
+    // Whether the element was read from `overflow_tier_`.
+    bool from_overflow_tier = false;
+    // The number of cached elements newer than `element`.
+    size_t lag = 0;
   };
 
   // Returns the next element and metrics about this query.
@@ -139,9 +179,19 @@ class CrossTrainerCache {
   size_t GetElementIndex(const std::string& trainer_id);
 
   // Returns the next element for `trainer_id`.
+  // REQUIRES: The element is in memory.
   StatusOr<std::shared_ptr<const ElementType>> GetElement(
       const std::string& trainer_id);
 
+  // Reads the element at `element_index` from the overflow tier for
+  // `trainer_id`. Returns nullptr if the element has been deleted from the
+  // tier in the meantime, in which case the trainer moves past it.
+  StatusOr<std::shared_ptr<const ElementType>> ReadFromOverflowTier(
+      const std::string& trainer_id, size_t element_index);
+
+  // Returns the number of cached elements newer than `element_index`.
+  size_t GetLag(size_t element_index) const;
+
   // Reads a new element and writes it into the cache.
   Status ExtendCache();
 
@@ -149,8 +199,13 @@ class CrossTrainerCache {
   // `new_element_size_bytes` is the size of the new element being inserted.
   void FreeSpace(size_t new_element_size_bytes);
 
-  // Records the cache hit rate and cache size.
-  void RecordMetrics(const CacheQueryResult& result);
+  // Writes the elements freed from memory to the overflow tier, and deletes
+  // the oldest elements of the tier to keep it within its size limit.
+  Status SpillFreedElements();
+
+  // Records the cache hit rate, the cache size, and the lag of `trainer_id`.
+  void RecordMetrics(const std::string& trainer_id,
+                     const CacheQueryResult& result);
 
   // Maximum cache size in bytes.
   const size_t max_cache_size_bytes_;
@@ -158,6 +213,9 @@ class CrossTrainerCache {
   // The element sequence over which the sliding window cache operates.
   std::unique_ptr<CachableSequence<ElementType>> cachable_sequence_;
 
+  // Holds the elements freed from memory. May be null.
+  const std::unique_ptr<CacheOverflowTier<ElementType>> overflow_tier_;
+
   mutable mutex mu_;
   mutable condition_variable cv_;
 
@@ -170,12 +228,24 @@ class CrossTrainerCache {
   size_t cache_size_bytes_ TF_GUARDED_BY(mu_) = 0;
   size_t cache_start_index_ TF_GUARDED_BY(mu_) = 0;
 
+  // `spilling_` stores the elements freed from memory that are being written
+  // to the overflow tier. They precede the elements in `cache_`.
+  std::deque<std::shared_ptr<const ElementType>> spilling_ TF_GUARDED_BY(mu_);
+  size_t spill_start_index_ TF_GUARDED_BY(mu_) = 0;
+
+  // The sizes of the elements in the overflow tier, which precede the
+  // elements in `spilling_`. Elements that failed to be written take 0 bytes.
+  std::deque<size_t> overflow_element_sizes_ TF_GUARDED_BY(mu_);
+  size_t overflow_size_bytes_ TF_GUARDED_BY(mu_) = 0;
+  size_t overflow_start_index_ TF_GUARDED_BY(mu_) = 0;
+
   // True if one thread is extending the cache.
   bool extending_cache_ TF_GUARDED_BY(mu_) = false;
 
   // Maps trainer IDs to element indices. The indices are absolute indices
   // within the dataset. The actual index to use with `cache_` would be
-  // `trainer_to_element_index_map_[trainer_id] - cache_start_index_`.
+  // `trainer_to_element_index_map_[trainer_id] - cache_start_index_`. Indices
+  // below `cache_start_index_` refer to `spilling_` and the overflow tier.
   absl::flat_hash_map<std::string, size_t> trainer_to_element_index_map_
       TF_GUARDED_BY(mu_);
 };
@@ -192,6 +262,23 @@ CrossTrainerCache<ElementType>::CrossTrainerCache(
           << ByteSize::Bytes(max_cache_size_bytes) << " of memory.";
 }
 
+template <class ElementType>
+CrossTrainerCache<ElementType>::CrossTrainerCache(
+    size_t max_cache_size_bytes,
+    std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+    std::unique_ptr<CacheOverflowTier<ElementType>> overflow_tier)
+    : max_cache_size_bytes_(max_cache_size_bytes),
+      cachable_sequence_(std::move(cachable_sequence)),
+      overflow_tier_(std::move(overflow_tier)) {
+  DCHECK_GT(max_cache_size_bytes, 0)
+      << "CrossTrainerCache size must be greater than 0.";
+  VLOG(2) << "Initialized tf.data service cross-trainer cache with "
+          << ByteSize::Bytes(max_cache_size_bytes) << " of memory and "
+          << ByteSize::Bytes(overflow_tier_ ? overflow_tier_->MaxSizeBytes()
+                                            : 0)
+          << " of overflow storage.";
+}
+
 template <class ElementType>
 StatusOr<std::shared_ptr<const ElementType>>
 CrossTrainerCache<ElementType>::Get(const std::string& trainer_id)
@@ -202,7 +289,7 @@ CrossTrainerCache<ElementType>::Get(const std::string& trainer_id)
   }
 
   TF_ASSIGN_OR_RETURN(CacheQueryResult result, GetCacheQueryResult(trainer_id));
-  RecordMetrics(result);
+  RecordMetrics(trainer_id, result);
   return result.element;
 }
 
@@ -212,20 +299,25 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
     const std::string& trainer_id) {
   bool should_extend_cache = false;
   while (true) {
+    std::optional<size_t> overflow_index;
     {
       mutex_lock l(mu_);
       TF_RETURN_IF_ERROR(status_);
       if (IsElementReady(trainer_id)) {
-        TF_ASSIGN_OR_RETURN(std::shared_ptr<const ElementType> element,
-                            GetElement(trainer_id));
-        return CacheQueryResult{element,
-                                /*is_cache_hit=*/!should_extend_cache};
-      }
-
-      // Extends the cache or waits for another thread to extend the cache. When
-      // concurrent trainers wait for the next element, only one of them should
-      // extend the cache.
-      if (extending_cache_) {
+        const size_t element_index = GetElementIndex(trainer_id);
+        if (element_index >= spill_start_index_) {
+          TF_ASSIGN_OR_RETURN(std::shared_ptr<const ElementType> element,
+                              GetElement(trainer_id));
+          return CacheQueryResult{element,
+                                  /*is_cache_hit=*/!should_extend_cache,
+                                  /*from_overflow_tier=*/false,
+                                  GetLag(element_index)};
+        }
+        overflow_index = element_index;
+      } else if (extending_cache_) {
+        // Extends the cache or waits for another thread to extend the cache.
+        // When concurrent trainers wait for the next element, only one of
+        // them should extend the cache.
         should_extend_cache = false;
         cv_.wait(l);
       } else {
@@ -234,6 +326,20 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
       }
     }
 
+    // Reads from the overflow tier without holding the lock, so that trainers
+    // reading from memory are not blocked on slow storage.
+    if (overflow_index.has_value()) {
+      TF_ASSIGN_OR_RETURN(std::shared_ptr<const ElementType> element,
+                          ReadFromOverflowTier(trainer_id, *overflow_index));
+      if (element == nullptr) {
+        continue;
+      }
+      mutex_lock l(mu_);
+      return CacheQueryResult{element, /*is_cache_hit=*/!should_extend_cache,
+                              /*from_overflow_tier=*/true,
+                              GetLag(*overflow_index)};
+    }
+
     if (should_extend_cache) {
       Status s = ExtendCache();
       mutex_lock l(mu_);
@@ -262,17 +368,45 @@ CrossTrainerCache<ElementType>::GetElement(const std::string& trainer_id)
   }
 
   std::shared_ptr<const ElementType> result =
-      cache_[element_index - cache_start_index_];
+      element_index < cache_start_index_
+          ? spilling_[element_index - spill_start_index_]
+          : cache_[element_index - cache_start_index_];
   trainer_to_element_index_map_[trainer_id] = element_index + 1;
   return result;
 }
 
+template <class ElementType>
+StatusOr<std::shared_ptr<const ElementType>>
+CrossTrainerCache<ElementType>::ReadFromOverflowTier(
+    const std::string& trainer_id, size_t element_index)
+    TF_LOCKS_EXCLUDED(mu_) {
+  StatusOr<ElementType> element = overflow_tier_->Read(element_index);
+  if (!element.ok() && !errors::IsNotFound(element.status())) {
+    return element.status();
+  }
+  mutex_lock l(mu_);
+  trainer_to_element_index_map_[trainer_id] = element_index + 1;
+  if (!element.ok()) {
+    VLOG(3) << "Skipping tf.data service cross-trainer cache element "
+            << element_index << " for trainer " << trainer_id
+            << ": " << element.status();
+    return std::shared_ptr<const ElementType>(nullptr);
+  }
+  return std::make_shared<const ElementType>(*std::move(element));
+}
+
+template <class ElementType>
+size_t CrossTrainerCache<ElementType>::GetLag(size_t element_index) const
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  return cache_start_index_ + cache_.size() - element_index - 1;
+}
+
 template <class ElementType>
 size_t CrossTrainerCache<ElementType>::GetElementIndex(
     const std::string& trainer_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   size_t element_index = trainer_to_element_index_map_[trainer_id];
-  if (element_index < cache_start_index_) {
-    element_index = cache_start_index_;
+  if (element_index < overflow_start_index_) {
+    element_index = overflow_start_index_;
   }
   return element_index;
 }
@@ -289,12 +423,14 @@ Status CrossTrainerCache<ElementType>::ExtendCache() TF_LOCKS_EXCLUDED(mu_) {
         " and cache size: ", max_cache_size_bytes_);
   }
 
-  mutex_lock l(mu_);
-  TF_RETURN_IF_ERROR(status_);
-  FreeSpace(new_element_size_bytes);
-  cache_.push_back(std::make_shared<ElementType>(std::move(element)));
-  cache_size_bytes_ += new_element_size_bytes;
-  return absl::OkStatus();
+  {
+    mutex_lock l(mu_);
+    TF_RETURN_IF_ERROR(status_);
+    FreeSpace(new_element_size_bytes);
+    cache_.push_back(std::make_shared<ElementType>(std::move(element)));
+    cache_size_bytes_ += new_element_size_bytes;
+  }
+  return SpillFreedElements();
 }
 
 template <class ElementType>
@@ -305,17 +441,85 @@ void CrossTrainerCache<ElementType>::FreeSpace(size_t new_element_size_bytes)
          cache_size_bytes_ + new_element_size_bytes > max_cache_size_bytes_) {
     size_t free_bytes =
         cachable_sequence_->GetElementSizeBytes(*cache_.front());
+    if (overflow_tier_) {
+      spilling_.push_back(std::move(cache_.front()));
+    }
     cache_.pop_front();
     cache_size_bytes_ -= free_bytes;
     ++cache_start_index_;
     ++num_elements_discarded;
   }
+  if (!overflow_tier_) {
+    spill_start_index_ = cache_start_index_;
+    overflow_start_index_ = cache_start_index_;
+  }
 
   VLOG(3) << "Freed " << num_elements_discarded << " element(s) from "
           << "tf.data service cross-trainer cache. Memory usage: "
           << ByteSize::Bytes(cache_size_bytes_) << ".";
 }
 
+template <class ElementType>
+Status CrossTrainerCache<ElementType>::SpillFreedElements()
+    TF_LOCKS_EXCLUDED(mu_) {
+  if (!overflow_tier_) {
+    return absl::OkStatus();
+  }
+  // Only the thread extending the cache modifies `spilling_`, so its elements
+  // stay in place while they are written.
+  std::vector<std::shared_ptr<const ElementType>> elements;
+  size_t first_index = 0;
+  {
+    mutex_lock l(mu_);
+    elements.assign(spilling_.begin(), spilling_.end());
+    first_index = spill_start_index_;
+  }
+  if (elements.empty()) {
+    return absl::OkStatus();
+  }
+
+  std::vector<size_t> element_sizes;
+  element_sizes.reserve(elements.size());
+  for (size_t i = 0; i < elements.size(); ++i) {
+    StatusOr<size_t> size_bytes =
+        overflow_tier_->Write(first_index + i, *elements[i]);
+    if (!size_bytes.ok()) {
+      // Trainers skip the elements missing from the tier.
+      LOG_EVERY_N(WARNING, 100)
+          << "Failed to write element " << first_index + i
+          << " to the tf.data service cross-trainer cache overflow tier: "
+          << size_bytes.status();
+    }
+    element_sizes.push_back(size_bytes.ok() ? *size_bytes : 0);
+  }
+
+  std::vector<size_t> indices_to_delete;
+  {
+    mutex_lock l(mu_);
+    for (size_t size_bytes : element_sizes) {
+      spilling_.pop_front();
+      ++spill_start_index_;
+      overflow_element_sizes_.push_back(size_bytes);
+      overflow_size_bytes_ += size_bytes;
+    }
+    while (!overflow_element_sizes_.empty() &&
+           overflow_size_bytes_ > overflow_tier_->MaxSizeBytes()) {
+      indices_to_delete.push_back(overflow_start_index_);
+      overflow_size_bytes_ -= overflow_element_sizes_.front();
+      overflow_element_sizes_.pop_front();
+      ++overflow_start_index_;
+    }
+  }
+
+  for (size_t index : indices_to_delete) {
+    Status s = overflow_tier_->Delete(index);
+    if (!s.ok() && !errors::IsNotFound(s)) {
+      return s;
+    }
+  }
+  return absl::OkStatus();
+}
+
 template <class ElementType>
 void CrossTrainerCache<ElementType>::Cancel(Status status)
     TF_LOCKS_EXCLUDED(mu_) {
@@ -338,14 +542,24 @@ bool CrossTrainerCache<ElementType>::IsCancelled() const
 
 template <class ElementType>
 void CrossTrainerCache<ElementType>::RecordMetrics(
-    const CacheQueryResult& result) {
+    const std::string& trainer_id, const CacheQueryResult& result) {
   metrics::RecordTFDataServiceCrossTrainerCacheQuery(result.cache_hit);
+  metrics::RecordTFDataServiceCrossTrainerCacheTrainerQuery(
+      trainer_id, result.cache_hit, result.from_overflow_tier);
+  metrics::RecordTFDataServiceCrossTrainerCacheTrainerLag(trainer_id,
+                                                          result.lag);
   size_t cache_size_bytes = 0;
+  size_t overflow_size_bytes = 0;
   {
     mutex_lock l(mu_);
     cache_size_bytes = cache_size_bytes_;
+    overflow_size_bytes = overflow_size_bytes_;
   }
   metrics::RecordTFDataServiceCrossTrainerCacheSizeBytes(cache_size_bytes);
+  if (overflow_tier_) {
+    metrics::RecordTFDataServiceCrossTrainerCacheOverflowSizeBytes(
+        overflow_size_bytes);
+  }
 }
 
 }  // namespace data
@@ -0,0 +1,149 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/cross_trainer_cache_disk_tier.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/log/log.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Converts `element` to the proto written to disk. Compressed elements are
+// stored as they are, other elements as `TensorProto`s.
+GetElementResponse ElementToProto(const GetElementResult& element) {
+  GetElementResponse proto;
+  proto.set_element_index(element.element_index);
+  proto.set_end_of_sequence(element.end_of_sequence);
+  proto.set_skip_task(element.skip);
+  if (element.components.size() == 1 &&
+      element.components[0].dtype() == DT_VARIANT &&
+      TensorShapeUtils::IsScalar(element.components[0].shape())) {
+    const CompressedElement* compressed =
+        element.components[0].scalar<Variant>()().get<CompressedElement>();
+    if (compressed != nullptr) {
+      *proto.mutable_compressed() = *compressed;
+      return proto;
+    }
+  }
+  for (const Tensor& component : element.components) {
+    component.AsProtoTensorContent(
+        proto.mutable_uncompressed()->add_components());
+  }
+  return proto;
+}
+
+absl::StatusOr<GetElementResult> ProtoToElement(GetElementResponse& proto) {
+  GetElementResult element;
+  element.element_index = proto.element_index();
+  element.end_of_sequence = proto.end_of_sequence();
+  element.skip = proto.skip_task();
+  switch (proto.element_case()) {
+    case GetElementResponse::kCompressed: {
+      Tensor tensor(DT_VARIANT, TensorShape{});
+      tensor.scalar<Variant>()() = std::move(*proto.mutable_compressed());
+      element.components.push_back(std::move(tensor));
+      break;
+    }
+    case GetElementResponse::kUncompressed:
+      for (const auto& component : proto.uncompressed().components()) {
+        element.components.emplace_back();
+        if (!element.components.back().FromProto(component)) {
+          return errors::DataLoss(
+              "Failed to parse a tensor of a cross-trainer cache element.");
+        }
+      }
+      break;
+    case GetElementResponse::ELEMENT_NOT_SET:
+      break;
+  }
+  return element;
+}
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<CrossTrainerCacheDiskTier>>
+CrossTrainerCacheDiskTier::Create(Env* env, const std::string& directory,
+                                  size_t max_size_bytes) {
+  if (directory.empty()) {
+    return errors::InvalidArgument(
+        "The cross-trainer cache disk tier requires a directory.");
+  }
+  if (env->FileExists(directory).ok()) {
+    int64_t undeleted_files = 0, undeleted_dirs = 0;
+    TF_RETURN_IF_ERROR(
+        env->DeleteRecursively(directory, &undeleted_files, &undeleted_dirs));
+  }
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(directory));
+  return absl::WrapUnique(
+      new CrossTrainerCacheDiskTier(env, directory, max_size_bytes));
+}
+
+CrossTrainerCacheDiskTier::CrossTrainerCacheDiskTier(
+    Env* env, const std::string& directory, size_t max_size_bytes)
+    : env_(env), directory_(directory), max_size_bytes_(max_size_bytes) {}
+
+CrossTrainerCacheDiskTier::~CrossTrainerCacheDiskTier() {
+  int64_t undeleted_files = 0, undeleted_dirs = 0;
+  Status s =
+      env_->DeleteRecursively(directory_, &undeleted_files, &undeleted_dirs);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to delete the cross-trainer cache directory "
+                 << directory_ << ": " << s;
+  }
+}
+
+StatusOr<size_t> CrossTrainerCacheDiskTier::Write(
+    size_t index, const GetElementResult& element) {
+  GetElementResponse proto = ElementToProto(element);
+  TF_RETURN_IF_ERROR(WriteBinaryProto(env_, ElementPath(index), proto));
+  return proto.ByteSizeLong();
+}
+
+StatusOr<GetElementResult> CrossTrainerCacheDiskTier::Read(size_t index) {
+  GetElementResponse proto;
+  TF_RETURN_IF_ERROR(ReadBinaryProto(env_, ElementPath(index), &proto));
+  return ProtoToElement(proto);
+}
+
+Status CrossTrainerCacheDiskTier::Delete(size_t index) {
+  return env_->DeleteFile(ElementPath(index));
+}
+
+std::string CrossTrainerCacheDiskTier::ElementPath(size_t index) const {
+  return io::JoinPath(directory_, absl::StrCat("element_", index));
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,64 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_DISK_TIER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_DISK_TIER_H_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/data/service/cross_trainer_cache.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+
+namespace tensorflow {
+namespace data {
+
+// Overflow tier of the cross-trainer cache that stores each element in a file
+// under a local directory, usually on NVMe. The directory is owned by the
+// tier: it is cleared on creation and deleted on destruction.
+class CrossTrainerCacheDiskTier : public CacheOverflowTier<GetElementResult> {
+ public:
+  static absl::StatusOr<std::unique_ptr<CrossTrainerCacheDiskTier>> Create(
+      Env* env, const std::string& directory, size_t max_size_bytes);
+  ~CrossTrainerCacheDiskTier() override;
+  CrossTrainerCacheDiskTier(const CrossTrainerCacheDiskTier&) = delete;
+  CrossTrainerCacheDiskTier& operator=(const CrossTrainerCacheDiskTier&) =
+      delete;
+
+  size_t MaxSizeBytes() const override { return max_size_bytes_; }
+  StatusOr<size_t> Write(size_t index,
+                         const GetElementResult& element) override;
+  StatusOr<GetElementResult> Read(size_t index) override;
+  Status Delete(size_t index) override;
+
+ private:
+  CrossTrainerCacheDiskTier(Env* env, const std::string& directory,
+                            size_t max_size_bytes);
+
+  // Returns the path of the file that stores the element at `index`.
+  std::string ElementPath(size_t index) const;
+
+  Env* const env_;
+  const std::string directory_;
+  const size_t max_size_bytes_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_DISK_TIER_H_
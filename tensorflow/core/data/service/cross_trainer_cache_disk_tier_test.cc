@@ -0,0 +1,123 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/cross_trainer_cache_disk_tier.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/data/compression_utils.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+std::string TestDirectory(const std::string& name) {
+  return io::JoinPath(testing::TmpDir(), "cross_trainer_cache", name);
+}
+
+GetElementResult TestElement(int64_t value) {
+  GetElementResult element;
+  element.components.push_back(test::AsScalar<int64_t>(value));
+  element.components.push_back(test::AsTensor<tstring>({"a", "b"}));
+  element.element_index = value;
+  return element;
+}
+
+TEST(CrossTrainerCacheDiskTierTest, WriteAndRead) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<CrossTrainerCacheDiskTier> tier,
+      CrossTrainerCacheDiskTier::Create(Env::Default(),
+                                        TestDirectory("write_and_read"),
+                                        /*max_size_bytes=*/1 << 20));
+  for (int64_t i = 0; i < 3; ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(size_t size_bytes, tier->Write(i, TestElement(i)));
+    EXPECT_GT(size_bytes, 0);
+  }
+  for (int64_t i = 0; i < 3; ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(GetElementResult element, tier->Read(i));
+    ASSERT_EQ(element.components.size(), 2);
+    test::ExpectEqual(element.components[0], test::AsScalar<int64_t>(i));
+    test::ExpectEqual(element.components[1],
+                      test::AsTensor<tstring>({"a", "b"}));
+    EXPECT_EQ(element.element_index, i);
+  }
+}
+
+TEST(CrossTrainerCacheDiskTierTest, CompressedElement) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<CrossTrainerCacheDiskTier> tier,
+      CrossTrainerCacheDiskTier::Create(Env::Default(),
+                                        TestDirectory("compressed"),
+                                        /*max_size_bytes=*/1 << 20));
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement({test::AsTensor<int64_t>({1, 2, 3})},
+                               &compressed));
+  GetElementResult element;
+  element.components.push_back(Tensor(DT_VARIANT, TensorShape{}));
+  element.components[0].scalar<Variant>()() = compressed;
+  TF_ASSERT_OK(tier->Write(0, element).status());
+
+  TF_ASSERT_OK_AND_ASSIGN(GetElementResult read, tier->Read(0));
+  ASSERT_EQ(read.components.size(), 1);
+  const CompressedElement* read_compressed =
+      read.components[0].scalar<Variant>()().get<CompressedElement>();
+  ASSERT_NE(read_compressed, nullptr);
+  std::vector<Tensor> uncompressed;
+  TF_ASSERT_OK(UncompressElement(*read_compressed, &uncompressed));
+  ASSERT_EQ(uncompressed.size(), 1);
+  test::ExpectEqual(uncompressed[0], test::AsTensor<int64_t>({1, 2, 3}));
+}
+
+TEST(CrossTrainerCacheDiskTierTest, Delete) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<CrossTrainerCacheDiskTier> tier,
+      CrossTrainerCacheDiskTier::Create(Env::Default(), TestDirectory("delete"),
+                                        /*max_size_bytes=*/1 << 20));
+  TF_ASSERT_OK(tier->Write(0, TestElement(0)).status());
+  TF_ASSERT_OK(tier->Delete(0));
+  EXPECT_TRUE(errors::IsNotFound(tier->Read(0).status()));
+  EXPECT_TRUE(errors::IsNotFound(tier->Read(1).status()));
+}
+
+TEST(CrossTrainerCacheDiskTierTest, DeletesDirectory) {
+  const std::string directory = TestDirectory("deletes_directory");
+  {
+    TF_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<CrossTrainerCacheDiskTier> tier,
+        CrossTrainerCacheDiskTier::Create(Env::Default(), directory,
+                                          /*max_size_bytes=*/1 << 20));
+    TF_ASSERT_OK(tier->Write(0, TestElement(0)).status());
+  }
+  EXPECT_TRUE(errors::IsNotFound(Env::Default()->FileExists(directory)));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
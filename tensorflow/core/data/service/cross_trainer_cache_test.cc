@@ -21,6 +21,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "absl/time/time.h"
@@ -138,6 +139,48 @@ bool SequenceIsIncreasing(const std::vector<int64_t> sequence) {
   return true;
 }
 
+// Overflow tier that keeps the elements in a map. Fails to write the indices
+// in `failed_indices`.
+class MapOverflowTier : public CacheOverflowTier<int64_t> {
+ public:
+  explicit MapOverflowTier(size_t max_size_bytes,
+                           absl::flat_hash_set<size_t> failed_indices = {})
+      : max_size_bytes_(max_size_bytes),
+        failed_indices_(std::move(failed_indices)) {}
+
+  size_t MaxSizeBytes() const override { return max_size_bytes_; }
+
+  absl::StatusOr<size_t> Write(size_t index, const int64_t& element) override {
+    if (failed_indices_.contains(index)) {
+      return errors::Unavailable("Failed to write element ", index);
+    }
+    mutex_lock l(mu_);
+    elements_[index] = element;
+    return sizeof(element);
+  }
+
+  absl::StatusOr<int64_t> Read(size_t index) override {
+    mutex_lock l(mu_);
+    auto it = elements_.find(index);
+    if (it == elements_.end()) {
+      return errors::NotFound("Element ", index, " not found.");
+    }
+    return it->second;
+  }
+
+  Status Delete(size_t index) override {
+    mutex_lock l(mu_);
+    elements_.erase(index);
+    return absl::OkStatus();
+  }
+
+ private:
+  const size_t max_size_bytes_;
+  const absl::flat_hash_set<size_t> failed_indices_;
+  mutex mu_;
+  absl::flat_hash_map<size_t, int64_t> elements_ TF_GUARDED_BY(mu_);
+};
+
 TEST(CrossTrainerCacheTest, GetFromOneTrainer) {
   const size_t num_elements = 10;
   CrossTrainerCache<int64_t> cache(
@@ -443,6 +486,83 @@ TEST(CrossTrainerCacheTest, TrainerIDMustBeNonEmpty) {
                                       "requires a non-empty trainer ID."));
 }
 
+TEST(CrossTrainerCacheTest, SlowTrainersReadFromOverflowTier) {
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<InfiniteRange>(),
+      std::make_unique<MapOverflowTier>(
+          /*max_size_bytes=*/10 * sizeof(int64_t)));
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(0)));
+  for (int i = 0; i < 15; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+
+  // 5 elements are in memory and the 10 before them overflowed to the tier.
+  for (int i = 1; i < 15; ++i) {
+    EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(i)));
+  }
+}
+
+TEST(CrossTrainerCacheTest, OverflowTierDiscardsOldestElements) {
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<InfiniteRange>(),
+      std::make_unique<MapOverflowTier>(
+          /*max_size_bytes=*/10 * sizeof(int64_t)));
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+
+  // When 99 is cached, 84 must have been discarded from the tier.
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(85)));
+}
+
+TEST(CrossTrainerCacheTest, TrainersSkipElementsFailedToOverflow) {
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/2 * sizeof(int64_t),
+      std::make_unique<InfiniteRange>(),
+      std::make_unique<MapOverflowTier>(
+          /*max_size_bytes=*/10 * sizeof(int64_t),
+          /*failed_indices=*/absl::flat_hash_set<size_t>{1, 2}));
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(0)));
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(3)));
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(4)));
+}
+
+TEST(CrossTrainerCacheTest, TrainerMetrics) {
+  CellReader<int64_t> query_reader(
+      "/tensorflow/data/service/cross_trainer_cache_trainer_queries");
+  CellReader<int64_t> lag_reader(
+      "/tensorflow/data/service/cross_trainer_cache_trainer_lag");
+  CellReader<int64_t> overflow_size_reader(
+      "/tensorflow/data/service/cross_trainer_cache_overflow_size_bytes");
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<InfiniteRange>(),
+      std::make_unique<MapOverflowTier>(
+          /*max_size_bytes=*/10 * sizeof(int64_t)));
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_THAT(cache.Get("Trainer 1"), IsOkAndHolds(Pointee(i)));
+  }
+  EXPECT_EQ(query_reader.Delta("Trainer 1", "miss"), 10);
+  EXPECT_EQ(lag_reader.Read("Trainer 1"), 0);
+  EXPECT_EQ(overflow_size_reader.Read(), 5 * sizeof(int64_t));
+
+  EXPECT_THAT(cache.Get("Trainer 2"), IsOkAndHolds(Pointee(0)));
+  EXPECT_THAT(cache.Get("Trainer 3"), IsOkAndHolds(Pointee(0)));
+  for (int i = 1; i < 10; ++i) {
+    EXPECT_THAT(cache.Get("Trainer 2"), IsOkAndHolds(Pointee(i)));
+  }
+  EXPECT_EQ(query_reader.Delta("Trainer 2", "disk_hit"), 5);
+  EXPECT_EQ(query_reader.Delta("Trainer 2", "memory_hit"), 5);
+  EXPECT_EQ(query_reader.Delta("Trainer 3", "disk_hit"), 1);
+  EXPECT_EQ(lag_reader.Read("Trainer 2"), 0);
+  EXPECT_EQ(lag_reader.Read("Trainer 3"), 9);
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
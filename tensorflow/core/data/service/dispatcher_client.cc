@@ -380,6 +380,20 @@ Status DataServiceDispatcherClient::DisableCompressionAtRuntime(
   return absl::OkStatus();
 }
 
+Status DataServiceDispatcherClient::GetWorkerScalingRecommendation(
+    GetWorkerScalingRecommendationResponse& response) {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  grpc::ClientContext ctx;
+  GetWorkerScalingRecommendationRequest request;
+  grpc::Status s =
+      stub_->GetWorkerScalingRecommendation(&ctx, request, &response);
+  if (!s.ok()) {
+    return grpc_util::WrapError(
+        "Failed to get worker scaling recommendation", s);
+  }
+  return absl::OkStatus();
+}
+
 Status DataServiceDispatcherClient::EnsureInitialized() {
   return grpc_util::Retry([this] { return Initialize(); },
                           "Initialize dispatcher client",
@@ -137,6 +137,10 @@ class DataServiceDispatcherClient : public DataServiceClientBase {
       const std::string& dataset_id, bool disable_compression_at_runtime,
       DisableCompressionAtRuntimeResponse& response);
 
+  // Returns how many workers the dispatcher recommends to add or remove.
+  Status GetWorkerScalingRecommendation(
+      GetWorkerScalingRecommendationResponse& response);
+
  protected:
   Status EnsureInitialized() override;
 
@@ -159,6 +159,15 @@ TEST_F(DispatcherClientTest, GetDataServiceConfig) {
   EXPECT_EQ(config.deployment_mode(), DEPLOYMENT_MODE_COLOCATED);
 }
 
+TEST_F(DispatcherClientTest, GetWorkerScalingRecommendation) {
+  TF_ASSERT_OK(SetUpTfDataService(/*num_workers=*/2));
+  GetWorkerScalingRecommendationResponse response;
+  TF_ASSERT_OK(dispatcher_client_->GetWorkerScalingRecommendation(response));
+  EXPECT_EQ(response.current_number_of_workers(), 2);
+  // No processing times have been reported yet.
+  EXPECT_EQ(response.worker_delta(), 0);
+}
+
 TEST_F(DispatcherClientTest, SnapshotSkeletonWritten) {
   TF_ASSERT_OK(SetUpTfDataService(/*num_workers=*/1));
   TF_ASSERT_OK_AND_ASSIGN(absl::flat_hash_set<std::string> paths,
@@ -90,6 +90,8 @@ using ::tensorflow::protobuf::util::MessageDifferencer;
 // The name of the journal directory inside the dispatcher's working directory.
 // This name is load-bearing; do not change.
 constexpr char kJournalDir[] = "tf_data_dispatcher_journal";
+// The number of journaled updates after which the journal is compacted.
+constexpr int64_t kJournalCompactionUpdates = 100000;
 // The name of the datasets directory inside the dispatcher's working directory.
 constexpr char kDatasetsDir[] = "datasets";
 
@@ -246,6 +248,7 @@ Status DataServiceDispatcherImpl::Start() {
     int64_t start = env_->NowMicros();
     while (!end_of_journal) {
       TF_RETURN_IF_ERROR(ApplyWithoutJournaling(update));
+      ++journal_updates_since_compaction_;
       TF_RETURN_IF_ERROR(reader.Read(update, end_of_journal));
     }
     absl::Duration duration = absl::Microseconds(env_->NowMicros() - start);
@@ -390,12 +393,18 @@ Status DataServiceDispatcherImpl::FindNewTasks(
 void DataServiceDispatcherImpl::ReportProcessingTimesFromActiveTasks(
     const std::vector<ActiveTask>& active_tasks,
     const std::string& worker_address) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  double total_processing_time_nsec = 0;
+  int64_t num_processing_times = 0;
   for (const ActiveTask& active_task : active_tasks) {
     const int64_t task_id = active_task.task_id();
     const double processing_time_nsec = active_task.processing_time_nsec();
     VLOG(3) << "Received processing time from task id " << task_id
             << " in worker with address " << worker_address
             << ". Time in nanoseconds: " << processing_time_nsec;
+    if (processing_time_nsec > 0) {
+      total_processing_time_nsec += processing_time_nsec;
+      ++num_processing_times;
+    }
 
     std::shared_ptr<const Task> task;
     Status s = state_.TaskFromId(task_id, task);
@@ -416,6 +425,10 @@ void DataServiceDispatcherImpl::ReportProcessingTimesFromActiveTasks(
           << " to tf.data service AutoScaler: " << auto_scaler_status;
     }
   }
+  if (num_processing_times > 0) {
+    worker_processing_times_nsec_[worker_address] =
+        total_processing_time_nsec / num_processing_times;
+  }
 }
 
 Status DataServiceDispatcherImpl::WorkerHeartbeat(
@@ -1156,6 +1169,11 @@ Status DataServiceDispatcherImpl::ClientHeartbeat(
     task_info->set_iteration_id(iteration->iteration_id);
     task_info->set_worker_uid(task->worker_uid);
     task_info->set_starting_round(task->starting_round);
+    auto processing_time =
+        worker_processing_times_nsec_.find(task->worker_address);
+    if (processing_time != worker_processing_times_nsec_.end()) {
+      task_info->set_worker_processing_time_nsec(processing_time->second);
+    }
   }
   response->set_iteration_finished(iteration->finished);
   response->set_deployment_mode(config_.deployment_mode());
@@ -1305,6 +1323,30 @@ Status DataServiceDispatcherImpl::DisableCompressionAtRuntime(
   return absl::OkStatus();
 }
 
+Status DataServiceDispatcherImpl::GetWorkerScalingRecommendation(
+    const GetWorkerScalingRecommendationRequest* request,
+    GetWorkerScalingRecommendationResponse* response) {
+  TF_RETURN_IF_ERROR(CheckStarted());
+  int64_t current_number_of_workers;
+  {
+    mutex_lock l(mu_);
+    current_number_of_workers = state_.GetNumberOfRegisteredWorkers();
+  }
+  response->set_current_number_of_workers(current_number_of_workers);
+  if (current_number_of_workers == 0) {
+    return absl::OkStatus();
+  }
+  absl::StatusOr<int64_t> worker_delta =
+      auto_scaler_.GetRecommendedWorkerDelta(current_number_of_workers);
+  if (absl::IsUnavailable(worker_delta.status())) {
+    // No times have been reported yet.
+    return absl::OkStatus();
+  }
+  TF_RETURN_IF_ERROR(worker_delta.status());
+  response->set_worker_delta(*worker_delta);
+  return absl::OkStatus();
+}
+
 Status DataServiceDispatcherImpl::PopulateTaskDef(
     std::shared_ptr<const Task> task, TaskDef* task_def) const
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -1332,6 +1374,9 @@ Status DataServiceDispatcherImpl::PopulateTaskDef(
   std::shared_ptr<const Dataset> dataset;
   TF_RETURN_IF_ERROR(
       state_.DatasetFromId(task->iteration->job->dataset_id, dataset));
+  if (dataset->metadata.has_element_layout()) {
+    *task_def->mutable_element_layout() = dataset->metadata.element_layout();
+  }
   if (config_.work_dir().empty()) {
     std::shared_ptr<const DatasetDef> dataset_def;
     TF_RETURN_IF_ERROR(dataset_store_->Get(dataset->dataset_id, dataset_def));
@@ -1374,46 +1419,75 @@ Status DataServiceDispatcherImpl::Apply(const Update& update)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   if (journal_writer_.has_value()) {
     TF_RETURN_IF_ERROR(journal_writer_.value()->Write(update));
+    ++journal_updates_since_compaction_;
   }
   return state_.Apply(update);
 }
 
+std::optional<int64_t> DataServiceDispatcherImpl::MaybeRotateJournal()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (!journal_writer_.has_value() ||
+      journal_updates_since_compaction_ < kJournalCompactionUpdates) {
+    return std::nullopt;
+  }
+  absl::StatusOr<int64_t> sequence_number = journal_writer_.value()->Rotate();
+  if (!sequence_number.ok()) {
+    LOG(WARNING) << "Error rotating the journal: " << sequence_number.status();
+    return std::nullopt;
+  }
+  journal_updates_since_compaction_ = 0;
+  return *sequence_number;
+}
+
 void DataServiceDispatcherImpl::MaintenanceThread() {
   int64_t next_check_micros = 0;
   while (true) {
-    mutex_lock l(mu_);
-    while (!cancelled_ && env_->NowMicros() < next_check_micros) {
-      int64_t remaining_micros = next_check_micros - env_->NowMicros();
-      maintenance_thread_cv_.wait_for(
-          l, std::chrono::microseconds(remaining_micros));
-    }
-    if (cancelled_) {
-      return;
-    }
+    std::optional<int64_t> journal_to_compact;
     {
-      Status s = ReleaseMissingClients();
-      if (!s.ok()) {
-        LOG(WARNING) << "Error releasing missing clients: " << s;
+      mutex_lock l(mu_);
+      while (!cancelled_ && env_->NowMicros() < next_check_micros) {
+        int64_t remaining_micros = next_check_micros - env_->NowMicros();
+        maintenance_thread_cv_.wait_for(
+            l, std::chrono::microseconds(remaining_micros));
       }
-    }
-    {
-      Status s = auto_scaler_.UpdateOptimalNumberOfWorkersMetric(
-          state_.GetNumberOfRegisteredWorkers());
-      if (!s.ok()) {
-        LOG(WARNING) << "Error updating the optimal number of workers metric "
-                        "in tf.data service AutoScaler: "
-                     << s;
+      if (cancelled_) {
+        return;
       }
+      {
+        Status s = ReleaseMissingClients();
+        if (!s.ok()) {
+          LOG(WARNING) << "Error releasing missing clients: " << s;
+        }
+      }
+      {
+        Status s = auto_scaler_.UpdateOptimalNumberOfWorkersMetric(
+            state_.GetNumberOfRegisteredWorkers());
+        if (!s.ok()) {
+          LOG(WARNING) << "Error updating the optimal number of workers "
+                          "metric in tf.data service AutoScaler: "
+                       << s;
+        }
+      }
+      {
+        Status s = GcOldIterations();
+        if (!s.ok()) {
+          LOG(WARNING) << "Error garbage collecting old iterations: " << s;
+        }
+      }
+      DetectMissingWorkers();
+      journal_to_compact = MaybeRotateJournal();
+      next_check_micros =
+          env_->NowMicros() + (config_.job_gc_check_interval_ms() * 1000);
     }
-    {
-      Status s = GcOldIterations();
+    // Compacts the files that are no longer written without holding `mu_`, so
+    // that the dispatcher keeps serving requests.
+    if (journal_to_compact.has_value()) {
+      Status s = CompactJournal(env_, JournalDir(config_.work_dir()),
+                                *journal_to_compact);
       if (!s.ok()) {
-        LOG(WARNING) << "Error garbage collecting old iterations: " << s;
+        LOG(WARNING) << "Error compacting the journal: " << s;
       }
     }
-    DetectMissingWorkers();
-    next_check_micros =
-        env_->NowMicros() + (config_.job_gc_check_interval_ms() * 1000);
   }
 }
 
@@ -1459,6 +1533,7 @@ Status DataServiceDispatcherImpl::ReleaseMissingClients()
 
 void DataServiceDispatcherImpl::RemoveWorkerFromAutoScaler(
     const std::string& worker_address) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  worker_processing_times_nsec_.erase(worker_address);
   std::vector<std::shared_ptr<const Task>> tasks;
   Status tasks_for_worker_status = state_.TasksForWorker(worker_address, tasks);
   if (tasks_for_worker_status.ok()) {
@@ -188,6 +188,9 @@ class DataServiceDispatcherImpl {
   Status DisableCompressionAtRuntime(
       const DisableCompressionAtRuntimeRequest* request,
       DisableCompressionAtRuntimeResponse* response);
+  Status GetWorkerScalingRecommendation(
+      const GetWorkerScalingRecommendationRequest* request,
+      GetWorkerScalingRecommendationResponse* response);
 
   // Exports the dispatcher state for debugging.
   DispatcherStateExport ExportState() const;
@@ -195,7 +198,11 @@ class DataServiceDispatcherImpl {
  private:
   // A thread which periodically checks for iterations to clean up, clients to
   // release, workers to consider missing, and snapshot streams to reassign.
+  // It also compacts the journal.
   void MaintenanceThread();
+  // Starts a new journal file if enough updates were journaled since the last
+  // compaction. Returns the sequence number of the last file to compact.
+  std::optional<int64_t> MaybeRotateJournal() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   // Restores split providers from the state in `iteration` and stores them in
   // `restored`.
@@ -379,6 +386,10 @@ class DataServiceDispatcherImpl {
   // Map from worker address to the time of the worker's last heartbeat.
   absl::flat_hash_map<std::string, absl::Time> latest_worker_heartbeats_time_
       TF_GUARDED_BY(mu_);
+  // The mean processing time of the active tasks of each worker, as of its
+  // latest heartbeat. Sent to clients, which prefer the faster workers.
+  absl::flat_hash_map<std::string, double> worker_processing_times_nsec_
+      TF_GUARDED_BY(mu_);
 
   // TODO(mpcallanan): Don't recover completed snapshots.
   // TODO(mpcallanan): Garbage collect completed snapshots.
@@ -391,6 +402,9 @@ class DataServiceDispatcherImpl {
 
   std::optional<std::unique_ptr<JournalWriter>> journal_writer_
       TF_GUARDED_BY(mu_);
+  // The number of updates in the journal files written since the last
+  // compaction, including the updates restored on startup.
+  int64_t journal_updates_since_compaction_ TF_GUARDED_BY(mu_) = 0;
   DispatcherState state_ TF_GUARDED_BY(mu_);
   // Condition variable for waking up the gc thread.
   condition_variable maintenance_thread_cv_;
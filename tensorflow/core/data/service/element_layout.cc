@@ -0,0 +1,107 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/element_layout.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/protobuf/data_service.pb.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/statusor.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+absl::Status UnsupportedCast(DataType from, DataType to) {
+  return absl::InvalidArgumentError(absl::StrCat(
+      "tf.data service workers cannot cast elements from ",
+      DataTypeString(from), " to ", DataTypeString(to),
+      ". If the dataset is compressed, consider registering it with "
+      "`compression=None`."));
+}
+
+template <typename From>
+absl::Status CastFrom(const Tensor& input, Tensor& output) {
+  switch (output.dtype()) {
+#define CAST_TO(To)                                             \
+  case DataTypeToEnum<To>::value:                               \
+    output.flat<To>() = input.flat<From>().template cast<To>(); \
+    return absl::OkStatus();
+    TF_CALL_REAL_NUMBER_TYPES(CAST_TO);
+    TF_CALL_bool(CAST_TO);
+#undef CAST_TO
+    default:
+      return UnsupportedCast(input.dtype(), output.dtype());
+  }
+}
+
+absl::StatusOr<Tensor> Cast(const Tensor& input, DataType dtype) {
+  Tensor output(dtype, input.shape());
+  switch (input.dtype()) {
+#define CAST_FROM(From)                                \
+  case DataTypeToEnum<From>::value:                    \
+    TF_RETURN_IF_ERROR(CastFrom<From>(input, output)); \
+    return output;
+    TF_CALL_REAL_NUMBER_TYPES(CAST_FROM);
+    TF_CALL_bool(CAST_FROM);
+#undef CAST_FROM
+    default:
+      return UnsupportedCast(input.dtype(), dtype);
+  }
+}
+
+}  // namespace
+
+DataType ElementLayoutDtype(const ElementLayout& layout, int64_t index,
+                            DataType dtype) {
+  if (index < layout.component_dtypes_size() &&
+      layout.component_dtypes(index) != DT_INVALID) {
+    dtype = layout.component_dtypes(index);
+  }
+  if (layout.float_to_bfloat16() && dtype == DT_FLOAT) {
+    dtype = DT_BFLOAT16;
+  }
+  return dtype;
+}
+
+absl::StatusOr<std::vector<Tensor>> ApplyElementLayout(
+    const ElementLayout& layout, std::vector<Tensor> element) {
+  if (layout.component_dtypes_size() > 0 &&
+      layout.component_dtypes_size() != static_cast<int>(element.size())) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "The tf.data service element layout has ",
+        layout.component_dtypes_size(), " component dtypes, but the element "
+        "has ", element.size(), " components."));
+  }
+  for (int64_t i = 0; i < element.size(); ++i) {
+    const DataType dtype = ElementLayoutDtype(layout, i, element[i].dtype());
+    if (dtype != element[i].dtype()) {
+      TF_ASSIGN_OR_RETURN(element[i], Cast(element[i], dtype));
+    }
+  }
+  return element;
+}
+
+}  // namespace data
+}  // namespace tensorflow
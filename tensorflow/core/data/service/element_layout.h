@@ -0,0 +1,44 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_ELEMENT_LAYOUT_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_ELEMENT_LAYOUT_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/protobuf/data_service.pb.h"
+
+namespace tensorflow {
+namespace data {
+
+// Returns the dtype of a component of dtype `dtype` at `index` after
+// converting it to `layout`.
+DataType ElementLayoutDtype(const ElementLayout& layout, int64_t index,
+                            DataType dtype);
+
+// Converts the components of `element` to `layout`. Components that keep
+// their dtypes are returned as they are. Returns an `InvalidArgument` error if
+// `layout` does not match the number of components, or a component cannot be
+// cast, such as the variant of a compressed element.
+absl::StatusOr<std::vector<Tensor>> ApplyElementLayout(
+    const ElementLayout& layout, std::vector<Tensor> element);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_ELEMENT_LAYOUT_H_
@@ -0,0 +1,104 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/element_layout.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/framework/variant_tensor_data.h"
+#include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/tstring.h"
+#include "tensorflow/core/protobuf/data_service.pb.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tensorflow::testing::StatusIs;
+using ::testing::HasSubstr;
+
+TEST(ElementLayoutTest, CastsComponents) {
+  ElementLayout layout;
+  layout.add_component_dtypes(DT_FLOAT);
+  layout.add_component_dtypes(DT_INVALID);
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::vector<Tensor> element,
+      ApplyElementLayout(layout, {test::AsTensor<int64_t>({1, 2, 3}),
+                                  test::AsScalar<tstring>("keep")}));
+  ASSERT_EQ(element.size(), 2);
+  test::ExpectEqual(element[0], test::AsTensor<float>({1.0, 2.0, 3.0}));
+  test::ExpectEqual(element[1], test::AsScalar<tstring>("keep"));
+}
+
+TEST(ElementLayoutTest, FloatToBfloat16) {
+  ElementLayout layout;
+  layout.set_float_to_bfloat16(true);
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::vector<Tensor> element,
+      ApplyElementLayout(layout, {test::AsTensor<float>({0.5, 2.0}),
+                                  test::AsScalar<int64_t>(7)}));
+  ASSERT_EQ(element.size(), 2);
+  test::ExpectEqual(element[0],
+                    test::AsTensor<bfloat16>(
+                        {bfloat16(0.5), bfloat16(2.0)}));
+  test::ExpectEqual(element[1], test::AsScalar<int64_t>(7));
+}
+
+TEST(ElementLayoutTest, EmptyLayoutKeepsElement) {
+  Tensor component = test::AsTensor<int32_t>({4, 5});
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<Tensor> element,
+                          ApplyElementLayout(ElementLayout(), {component}));
+  ASSERT_EQ(element.size(), 1);
+  EXPECT_TRUE(element[0].SharesBufferWith(component));
+}
+
+TEST(ElementLayoutTest, WrongNumberOfComponents) {
+  ElementLayout layout;
+  layout.add_component_dtypes(DT_FLOAT);
+  layout.add_component_dtypes(DT_FLOAT);
+  EXPECT_THAT(ApplyElementLayout(layout, {test::AsScalar<int64_t>(1)}),
+              StatusIs(error::INVALID_ARGUMENT, HasSubstr("components")));
+}
+
+TEST(ElementLayoutTest, CompressedElement) {
+  Tensor compressed(DT_VARIANT, TensorShape({}));
+  compressed.scalar<Variant>()() = VariantTensorData();
+  ElementLayout layout;
+  layout.add_component_dtypes(DT_FLOAT);
+  EXPECT_THAT(ApplyElementLayout(layout, {compressed}),
+              StatusIs(error::INVALID_ARGUMENT, HasSubstr("compression")));
+}
+
+TEST(ElementLayoutTest, ElementLayoutDtype) {
+  ElementLayout layout;
+  layout.add_component_dtypes(DT_INVALID);
+  layout.add_component_dtypes(DT_HALF);
+  layout.set_float_to_bfloat16(true);
+  EXPECT_EQ(ElementLayoutDtype(layout, 0, DT_FLOAT), DT_BFLOAT16);
+  EXPECT_EQ(ElementLayoutDtype(layout, 0, DT_INT64), DT_INT64);
+  EXPECT_EQ(ElementLayoutDtype(layout, 1, DT_FLOAT), DT_HALF);
+  EXPECT_EQ(ElementLayoutDtype(ElementLayout(), 0, DT_FLOAT), DT_FLOAT);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -69,6 +69,7 @@ HANDLER(Snapshot);
 HANDLER(GetSnapshotSplit);
 HANDLER(GetSnapshotStreams);
 HANDLER(DisableCompressionAtRuntime);
+HANDLER(GetWorkerScalingRecommendation);
 #undef HANDLER
 
 }  // namespace data
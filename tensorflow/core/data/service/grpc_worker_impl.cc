@@ -67,6 +67,7 @@ WorkerStateExport GrpcWorkerImpl::ExportState() const {
   }
 HANDLER(ProcessTask);
 HANDLER(GetElement);
+HANDLER(GetElements);
 HANDLER(GetWorkerTasks);
 HANDLER(GetSnapshotTaskProgresses);
 #undef HANDLER
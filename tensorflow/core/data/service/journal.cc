@@ -16,12 +16,18 @@ limitations under the License.
 #include "tensorflow/core/data/service/journal.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <tuple>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "tensorflow/core/data/service/journal.pb.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/record_writer.h"
@@ -29,12 +35,16 @@ limitations under the License.
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/regexp.h"
+#include "tensorflow/core/platform/statusor.h"
 
 namespace tensorflow {
 namespace data {
 
 namespace {
 constexpr StringPiece kJournal = "journal";
+constexpr StringPiece kSnapshot = "snapshot";
+// The prefix of snapshots being written.
+constexpr StringPiece kTmpSnapshot = "tmp_snapshot";
 
 Status ParseSequenceNumber(const std::string& journal_file,
                            int64_t* sequence_number) {
@@ -44,6 +54,27 @@ Status ParseSequenceNumber(const std::string& journal_file,
   }
   return absl::OkStatus();
 }
+
+// Returns the sequence number of the latest snapshot in `journal_dir`, or -1
+// if there is none.
+absl::StatusOr<int64_t> LatestSnapshot(Env* env,
+                                       const std::string& journal_dir) {
+  std::vector<std::string> files;
+  Status s = env->GetChildren(journal_dir, &files);
+  if (absl::IsNotFound(s)) {
+    return -1;
+  }
+  TF_RETURN_IF_ERROR(s);
+  int64_t latest_snapshot = -1;
+  for (const auto& file : files) {
+    int64_t sequence_number;
+    if (RE2::FullMatch(file, absl::StrCat(kSnapshot, "_(\\d+)"),
+                       &sequence_number)) {
+      latest_snapshot = std::max(latest_snapshot, sequence_number);
+    }
+  }
+  return latest_snapshot;
+}
 }  // namespace
 
 std::string DataServiceJournalFile(const std::string& journal_dir,
@@ -52,6 +83,12 @@ std::string DataServiceJournalFile(const std::string& journal_dir,
                       absl::StrCat(kJournal, "_", sequence_number));
 }
 
+std::string DataServiceJournalSnapshotFile(const std::string& journal_dir,
+                                           int64_t sequence_number) {
+  return io::JoinPath(journal_dir,
+                      absl::StrCat(kSnapshot, "_", sequence_number));
+}
+
 FileJournalWriter::FileJournalWriter(Env* env, const std::string& journal_dir)
     : env_(env), journal_dir_(journal_dir) {}
 
@@ -68,8 +105,9 @@ Status FileJournalWriter::EnsureInitialized() {
     TF_RETURN_IF_ERROR(ParseSequenceNumber(file, &sequence_number));
     latest_sequence_number = std::max(latest_sequence_number, sequence_number);
   }
+  sequence_number_ = latest_sequence_number + 1;
   std::string journal_file =
-      DataServiceJournalFile(journal_dir_, latest_sequence_number + 1);
+      DataServiceJournalFile(journal_dir_, sequence_number_);
   TF_RETURN_IF_ERROR(env_->NewAppendableFile(journal_file, &file_));
   writer_ = std::make_unique<io::RecordWriter>(file_.get());
   VLOG(1) << "Created journal writer to write to " << journal_file;
@@ -92,6 +130,18 @@ Status FileJournalWriter::Write(const Update& update) {
   return absl::OkStatus();
 }
 
+absl::StatusOr<int64_t> FileJournalWriter::Rotate() {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  const int64_t sequence_number = sequence_number_;
+  TF_RETURN_IF_ERROR(writer_->Close());
+  TF_RETURN_IF_ERROR(file_->Close());
+  writer_.reset();
+  file_.reset();
+  // Opens the next file right away, to fail fast if it can't be created.
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  return sequence_number;
+}
+
 FileJournalReader::FileJournalReader(Env* env, StringPiece journal_dir)
     : env_(env), journal_dir_(journal_dir) {}
 
@@ -99,6 +149,13 @@ Status FileJournalReader::EnsureInitialized() {
   if (reader_) {
     return absl::OkStatus();
   }
+  TF_ASSIGN_OR_RETURN(int64_t latest_snapshot,
+                      LatestSnapshot(env_, journal_dir_));
+  if (latest_snapshot >= 0) {
+    sequence_number_ = latest_snapshot;
+    return UpdateFile(
+        DataServiceJournalSnapshotFile(journal_dir_, latest_snapshot));
+  }
   return UpdateFile(DataServiceJournalFile(journal_dir_, 0));
 }
 
@@ -141,5 +198,111 @@ Status FileJournalReader::UpdateFile(const std::string& filename) {
   return absl::OkStatus();
 }
 
+std::vector<Update> CompactUpdates(const std::vector<Update>& updates) {
+  absl::flat_hash_set<int64_t> garbage_collected_iterations;
+  for (const Update& update : updates) {
+    if (update.has_garbage_collect_iteration()) {
+      garbage_collected_iterations.insert(
+          update.garbage_collect_iteration().iteration_id());
+    }
+  }
+  std::vector<Update> compacted;
+  compacted.reserve(updates.size());
+  // Maps the iteration, split provider, and repetition of unfinished splits to
+  // the index of the update they are merged into. Later splits are moved up to
+  // the first split of their repetition, which is safe since split updates
+  // only change the split state of their iteration.
+  absl::flat_hash_map<std::tuple<int64_t, int64_t, int64_t>, size_t>
+      merged_splits;
+  for (const Update& update : updates) {
+    if (!update.has_produce_split()) {
+      compacted.push_back(update);
+      continue;
+    }
+    const ProduceSplitUpdate& produce_split = update.produce_split();
+    if (garbage_collected_iterations.contains(produce_split.iteration_id())) {
+      continue;
+    }
+    if (produce_split.finished()) {
+      compacted.push_back(update);
+      continue;
+    }
+    auto [it, inserted] = merged_splits.try_emplace(
+        std::make_tuple(produce_split.iteration_id(),
+                        produce_split.split_provider_index(),
+                        produce_split.repetition()),
+        compacted.size());
+    if (inserted) {
+      compacted.push_back(update);
+      continue;
+    }
+    ProduceSplitUpdate* merged = compacted[it->second].mutable_produce_split();
+    merged->set_num_splits(std::max<int64_t>(merged->num_splits(), 1) +
+                           std::max<int64_t>(produce_split.num_splits(), 1));
+  }
+  return compacted;
+}
+
+Status CompactJournal(Env* env, const std::string& journal_dir,
+                      int64_t last_sequence_number) {
+  TF_ASSIGN_OR_RETURN(int64_t latest_snapshot,
+                      LatestSnapshot(env, journal_dir));
+  if (latest_snapshot >= last_sequence_number) {
+    return absl::OkStatus();
+  }
+  std::vector<Update> updates;
+  FileJournalReader reader(env, journal_dir);
+  while (true) {
+    Update update;
+    bool end_of_journal = false;
+    Status s = reader.Read(update, end_of_journal);
+    // Stops at the files that may still be written, whose last record may be
+    // incomplete.
+    if (reader.sequence_number() > last_sequence_number) {
+      break;
+    }
+    TF_RETURN_IF_ERROR(s);
+    if (end_of_journal) {
+      break;
+    }
+    updates.push_back(std::move(update));
+  }
+  std::vector<Update> compacted = CompactUpdates(updates);
+
+  const std::string tmp_snapshot_file = io::JoinPath(
+      journal_dir, absl::StrCat(kTmpSnapshot, "_", last_sequence_number));
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_RETURN_IF_ERROR(env->NewWritableFile(tmp_snapshot_file, &file));
+    io::RecordWriter writer(file.get());
+    for (const Update& update : compacted) {
+      TF_RETURN_IF_ERROR(writer.WriteRecord(update.SerializeAsString()));
+    }
+    TF_RETURN_IF_ERROR(writer.Close());
+    TF_RETURN_IF_ERROR(file->Sync());
+    TF_RETURN_IF_ERROR(file->Close());
+  }
+  const std::string snapshot_file =
+      DataServiceJournalSnapshotFile(journal_dir, last_sequence_number);
+  TF_RETURN_IF_ERROR(env->RenameFile(tmp_snapshot_file, snapshot_file));
+  VLOG(1) << "Compacted " << updates.size() << " journal updates into "
+          << compacted.size() << " in " << snapshot_file;
+
+  // The snapshot replaces the files it was made from, so they can go.
+  std::vector<std::string> files;
+  TF_RETURN_IF_ERROR(env->GetChildren(journal_dir, &files));
+  for (const auto& file : files) {
+    const std::string path = io::JoinPath(journal_dir, file);
+    int64_t sequence_number;
+    if (path == snapshot_file ||
+        !ParseSequenceNumber(file, &sequence_number).ok() ||
+        sequence_number > last_sequence_number) {
+      continue;
+    }
+    TF_RETURN_IF_ERROR(env->DeleteFile(path));
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace data
 }  // namespace tensorflow
@@ -15,9 +15,12 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_JOURNAL_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_JOURNAL_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "absl/status/statusor.h"
 #include "tensorflow/core/data/service/journal.pb.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/io/record_reader.h"
@@ -31,6 +34,11 @@ namespace data {
 std::string DataServiceJournalFile(const std::string& journal_dir,
                                    int64_t sequence_number);
 
+// Returns the location of the journal snapshot that replaces the journal files
+// up to `sequence_number` within the journal directory.
+std::string DataServiceJournalSnapshotFile(const std::string& journal_dir,
+                                           int64_t sequence_number);
+
 // Interface for writing to a journal.
 class JournalWriter {
  public:
@@ -39,6 +47,10 @@ class JournalWriter {
   virtual Status Write(const Update& update) = 0;
   // Initializes the writer if it is not yet initialized.
   virtual Status EnsureInitialized() = 0;
+  // Closes the current journal file, so that later updates go to a new file.
+  // Returns the sequence number of the closed file, whose contents no longer
+  // change and can be compacted.
+  virtual absl::StatusOr<int64_t> Rotate() = 0;
 };
 
 // FileJournalWriter is not thread-safe, requiring external synchronization when
@@ -56,7 +68,8 @@ class JournalWriter {
 // journal file name. For example, if the journal directory contains
 // "journal_0", "journal_1", and "journal_2", the writer will write to
 // "journal_3". The writer will flush updates as they are written, so that they
-// can be stored durably in case of machine failure.
+// can be stored durably in case of machine failure. `CompactJournal` may
+// replace the files up to some sequence number N with "snapshot_N".
 class FileJournalWriter : public JournalWriter {
  public:
   // Creates a journal writer to write to the given journal directory.
@@ -68,10 +81,13 @@ class FileJournalWriter : public JournalWriter {
 
   Status Write(const Update& update) override;
   Status EnsureInitialized() override;
+  absl::StatusOr<int64_t> Rotate() override;
 
  private:
   Env* env_;
   const std::string journal_dir_;
+  // Sequence number of current journal file.
+  int64_t sequence_number_ = -1;
   std::unique_ptr<WritableFile> file_;
   std::unique_ptr<io::RecordWriter> writer_;
 };
@@ -89,7 +105,9 @@ class JournalReader {
 // used by multiple threads.
 //
 // The journal reader reads through all journal files in the configured journal
-// directory, in order of their sequence numbers. See FileJournalWriter above.
+// directory, in order of their sequence numbers. If the directory has
+// snapshots, it reads the latest one instead of the files it replaces. See
+// FileJournalWriter above.
 class FileJournalReader : public JournalReader {
  public:
   explicit FileJournalReader(Env* env, StringPiece journal_dir);
@@ -98,6 +116,9 @@ class FileJournalReader : public JournalReader {
 
   Status Read(Update& update, bool& end_of_journal) override;
 
+  // Returns the sequence number of the file the last update was read from.
+  int64_t sequence_number() const { return sequence_number_; }
+
  private:
   // Initializes the reader if it is not yet initialized.
   Status EnsureInitialized();
@@ -112,6 +133,24 @@ class FileJournalReader : public JournalReader {
   std::unique_ptr<io::SequentialRecordReader> reader_;
 };
 
+// Returns updates that bring the dispatcher state to the same state as
+// `updates`, with fewer updates:
+//
+// - The updates of consecutive splits of a split provider are merged into one.
+// - The splits of garbage collected iterations are dropped, since they are no
+//   longer read. Their split providers restart from the beginning when they
+//   are restored.
+std::vector<Update> CompactUpdates(const std::vector<Update>& updates);
+
+// Replaces the journal files in `journal_dir` up to `last_sequence_number`,
+// which must no longer be written, with a snapshot of their compacted updates.
+// The snapshot is written to a temporary file and renamed, so the journal
+// stays readable if the compaction fails at any point. Restoring from the
+// journal then replays a number of updates that is proportional to the
+// dispatcher state rather than to its history.
+Status CompactJournal(Env* env, const std::string& journal_dir,
+                      int64_t last_sequence_number);
+
 }  // namespace data
 }  // namespace tensorflow
 
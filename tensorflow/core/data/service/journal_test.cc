@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/journal.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -25,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/protobuf/data_service.pb.h"
 
@@ -67,6 +69,22 @@ Update MakeRegisterDatasetUpdate() {
   return update;
 }
 
+Update MakeProduceSplitUpdate(int64_t iteration_id, int64_t repetition,
+                              bool finished = false) {
+  Update update;
+  ProduceSplitUpdate* produce_split = update.mutable_produce_split();
+  produce_split->set_iteration_id(iteration_id);
+  produce_split->set_repetition(repetition);
+  produce_split->set_finished(finished);
+  return update;
+}
+
+Update MakeGarbageCollectIterationUpdate(int64_t iteration_id) {
+  Update update;
+  update.mutable_garbage_collect_iteration()->set_iteration_id(iteration_id);
+  return update;
+}
+
 Status CheckJournalContent(StringPiece journal_dir,
                            const std::vector<Update>& expected) {
   FileJournalReader reader(Env::Default(), journal_dir);
@@ -165,5 +183,74 @@ TEST(Journal, InvalidRecordData) {
   EXPECT_THAT(s.message(), HasSubstr("Failed to parse journal record"));
   EXPECT_EQ(s.code(), error::DATA_LOSS);
 }
+
+TEST(Journal, CompactUpdatesMergesSplits) {
+  std::vector<Update> updates = {
+      MakeCreateIterationUpdate(),
+      MakeProduceSplitUpdate(/*iteration_id=*/8, /*repetition=*/0),
+      MakeFinishTaskUpdate(),
+      MakeProduceSplitUpdate(/*iteration_id=*/8, /*repetition=*/0),
+      MakeProduceSplitUpdate(/*iteration_id=*/8, /*repetition=*/0),
+      MakeProduceSplitUpdate(/*iteration_id=*/8, /*repetition=*/0,
+                             /*finished=*/true),
+      MakeProduceSplitUpdate(/*iteration_id=*/8, /*repetition=*/1)};
+  std::vector<Update> compacted = CompactUpdates(updates);
+  ASSERT_EQ(compacted.size(), 5);
+  EXPECT_EQ(compacted[0].SerializeAsString(), updates[0].SerializeAsString());
+  EXPECT_EQ(compacted[1].produce_split().repetition(), 0);
+  EXPECT_EQ(compacted[1].produce_split().num_splits(), 3);
+  EXPECT_EQ(compacted[2].SerializeAsString(), updates[2].SerializeAsString());
+  EXPECT_TRUE(compacted[3].produce_split().finished());
+  EXPECT_EQ(compacted[4].produce_split().repetition(), 1);
+  EXPECT_EQ(compacted[4].produce_split().num_splits(), 0);
+}
+
+TEST(Journal, CompactUpdatesDropsSplitsOfGarbageCollectedIterations) {
+  std::vector<Update> updates = {
+      MakeCreateIterationUpdate(),
+      MakeProduceSplitUpdate(/*iteration_id=*/8, /*repetition=*/0),
+      MakeProduceSplitUpdate(/*iteration_id=*/8, /*repetition=*/0,
+                             /*finished=*/true),
+      MakeGarbageCollectIterationUpdate(/*iteration_id=*/8)};
+  std::vector<Update> compacted = CompactUpdates(updates);
+  ASSERT_EQ(compacted.size(), 2);
+  EXPECT_EQ(compacted[0].SerializeAsString(), updates[0].SerializeAsString());
+  EXPECT_EQ(compacted[1].SerializeAsString(), updates[3].SerializeAsString());
+}
+
+TEST(Journal, CompactJournal) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  FileJournalWriter writer(Env::Default(), journal_dir);
+  TF_ASSERT_OK(writer.Write(MakeCreateIterationUpdate()));
+  TF_ASSERT_OK(writer.Write(MakeProduceSplitUpdate(8, 0)));
+  TF_ASSERT_OK_AND_ASSIGN(int64_t first_sequence_number, writer.Rotate());
+  TF_ASSERT_OK(writer.Write(MakeProduceSplitUpdate(8, 0)));
+  TF_ASSERT_OK_AND_ASSIGN(int64_t last_sequence_number, writer.Rotate());
+  EXPECT_GT(last_sequence_number, first_sequence_number);
+  // Written after the compacted files, so it stays as it is.
+  TF_ASSERT_OK(writer.Write(MakeFinishTaskUpdate()));
+
+  TF_ASSERT_OK(CompactJournal(Env::Default(), journal_dir,
+                              last_sequence_number));
+  EXPECT_TRUE(absl::IsNotFound(Env::Default()->FileExists(
+      DataServiceJournalFile(journal_dir, first_sequence_number))));
+  TF_EXPECT_OK(Env::Default()->FileExists(
+      DataServiceJournalSnapshotFile(journal_dir, last_sequence_number)));
+
+  Update merged_split = MakeProduceSplitUpdate(8, 0);
+  merged_split.mutable_produce_split()->set_num_splits(2);
+  TF_EXPECT_OK(CheckJournalContent(
+      journal_dir,
+      {MakeCreateIterationUpdate(), merged_split, MakeFinishTaskUpdate()}));
+
+  // Later writers continue after the snapshot.
+  FileJournalWriter new_writer(Env::Default(), journal_dir);
+  TF_ASSERT_OK(new_writer.Write(MakeRegisterDatasetUpdate()));
+  TF_EXPECT_OK(CheckJournalContent(
+      journal_dir, {MakeCreateIterationUpdate(), merged_split,
+                    MakeFinishTaskUpdate(), MakeRegisterDatasetUpdate()}));
+}
+
 }  // namespace data
 }  // namespace tensorflow
@@ -237,7 +237,12 @@ Status WorkerGrpcDataServer::StartServiceInternal() {
   DataTransferServerInfo grpc_transfer_server;
   grpc_transfer_server.set_protocol(kGrpcTransferProtocol);
   grpc_transfer_server.set_address(worker_address);
-  std::vector<DataTransferServerInfo> transfer_servers = {grpc_transfer_server};
+  // The batched gRPC protocol is served by the same server.
+  DataTransferServerInfo grpc_bulk_transfer_server;
+  grpc_bulk_transfer_server.set_protocol(kGrpcBulkTransferProtocol);
+  grpc_bulk_transfer_server.set_address(worker_address);
+  std::vector<DataTransferServerInfo> transfer_servers = {
+      grpc_transfer_server, grpc_bulk_transfer_server};
   MaybeStartAlternativeDataTransferServer(transfer_servers);
   TF_RETURN_IF_ERROR(service_->Start(worker_address, transfer_servers));
   return absl::OkStatus();
@@ -0,0 +1,557 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shm_data_transfer.h"
+
+#ifndef PLATFORM_WINDOWS
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif  // PLATFORM_WINDOWS
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/distributed_runtime/shared_memory_tensor.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/status.h"
+
+#ifndef PLATFORM_WINDOWS
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kPortPlaceholder[] = "%port%";
+
+Status SocketError(absl::string_view operation, const std::string& path) {
+  return errors::Unavailable("Failed to ", operation, " socket ", path, ": ",
+                             strerror(errno));
+}
+
+// Writes all of `data` to `fd`.
+Status WriteAll(int fd, const char* data, size_t size) {
+  while (size > 0) {
+    const ssize_t written = send(fd, data, size, MSG_NOSIGNAL);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return errors::Unavailable("Failed to write to data transfer socket: ",
+                                 strerror(errno));
+    }
+    data += written;
+    size -= written;
+  }
+  return absl::OkStatus();
+}
+
+// Reads exactly `size` bytes from `fd` into `data`.
+Status ReadAll(int fd, char* data, size_t size) {
+  while (size > 0) {
+    const ssize_t read = recv(fd, data, size, /*flags=*/0);
+    if (read < 0) {
+      if (errno == EINTR) continue;
+      return errors::Unavailable("Failed to read from data transfer socket: ",
+                                 strerror(errno));
+    }
+    if (read == 0) {
+      return errors::Unavailable("The data transfer socket was closed.");
+    }
+    data += read;
+    size -= read;
+  }
+  return absl::OkStatus();
+}
+
+// Messages are framed by their size. Both ends run on the same host, so the
+// size is written in host byte order.
+Status WriteMessage(int fd, const protobuf::MessageLite& message) {
+  std::string serialized;
+  if (!message.SerializeToString(&serialized)) {
+    return errors::Internal("Failed to serialize ", message.GetTypeName());
+  }
+  const uint64_t size = serialized.size();
+  TF_RETURN_IF_ERROR(
+      WriteAll(fd, reinterpret_cast<const char*>(&size), sizeof(size)));
+  return WriteAll(fd, serialized.data(), serialized.size());
+}
+
+Status ReadMessage(int fd, protobuf::MessageLite& message) {
+  uint64_t size = 0;
+  TF_RETURN_IF_ERROR(ReadAll(fd, reinterpret_cast<char*>(&size), sizeof(size)));
+  std::string serialized(size, '\0');
+  TF_RETURN_IF_ERROR(ReadAll(fd, serialized.data(), size));
+  if (!message.ParseFromString(serialized)) {
+    return errors::DataLoss("Failed to parse ", message.GetTypeName());
+  }
+  return absl::OkStatus();
+}
+
+Status MakeSocketAddress(const std::string& path, sockaddr_un& address) {
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path)) {
+    return errors::InvalidArgument("The socket path ", path, " is longer than ",
+                                   sizeof(address.sun_path) - 1,
+                                   " characters.");
+  }
+  memcpy(address.sun_path, path.data(), path.size());
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+// The state of a client connection, only accessed by the thread that serves
+// it once the connection is accepted.
+struct ShmDataTransferServer::Connection {
+  explicit Connection(int fd) : fd(fd) {}
+  ~Connection() { close(fd); }
+
+  const int fd;
+  // The components placed in shared memory for the client and not released
+  // yet, by offset. Destroying them returns their memory to the allocator.
+  absl::flat_hash_map<int64_t, Tensor> outstanding;
+};
+
+ShmDataTransferServer::ShmDataTransferServer(GetElementT get_element,
+                                             const Options& options)
+    : get_element_(std::move(get_element)), options_(options) {}
+
+ShmDataTransferServer::~ShmDataTransferServer() {
+  std::vector<std::unique_ptr<Thread>> threads;
+  {
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    if (listen_fd_ >= 0) {
+      shutdown(listen_fd_, SHUT_RDWR);
+    }
+    for (const auto& connection : connections_) {
+      shutdown(connection->fd, SHUT_RDWR);
+    }
+  }
+  // Joins the accept thread first, so that no more serving threads start.
+  accept_thread_.reset();
+  {
+    mutex_lock l(mu_);
+    threads = std::move(threads_);
+  }
+  threads.clear();
+  {
+    mutex_lock l(mu_);
+    connections_.clear();
+  }
+  if (listen_fd_ >= 0) {
+    close(listen_fd_);
+    unlink(socket_path_.c_str());
+  }
+  if (allocator_) {
+    allocator_->region()->Unlink().IgnoreError();
+  }
+}
+
+Status ShmDataTransferServer::Start(const experimental::WorkerConfig& config) {
+  if (config.data_transfer_address().empty()) {
+    return errors::InvalidArgument(
+        "The ", kShmTransferProtocol, " data transfer protocol needs the path "
+        "of its socket as data_transfer_address, e.g. \"/tmp/tf_data_",
+        kPortPlaceholder, "\".");
+  }
+  socket_path_ = str_util::StringReplace(config.data_transfer_address(),
+                                         kPortPlaceholder, absl::StrCat(Port()),
+                                         /*replace_all=*/false);
+  sockaddr_un address;
+  TF_RETURN_IF_ERROR(MakeSocketAddress(socket_path_, address));
+
+  static std::atomic<int64_t> region_id(0);
+  core::RefCountPtr<SharedMemoryRegion> region;
+  TF_RETURN_IF_ERROR(SharedMemoryRegion::Create(
+      absl::StrCat("/tf_data_shm_", Port(), "_", region_id++),
+      options_.region_size, &region));
+  allocator_ = std::make_unique<SharedMemoryAllocator>(std::move(region));
+
+  listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (listen_fd_ < 0) {
+    return SocketError("create", socket_path_);
+  }
+  // Removes the socket left behind by a previous worker with the same pid.
+  unlink(socket_path_.c_str());
+  if (bind(listen_fd_, reinterpret_cast<const sockaddr*>(&address),
+           sizeof(address)) != 0) {
+    return SocketError("bind", socket_path_);
+  }
+  if (listen(listen_fd_, SOMAXCONN) != 0) {
+    return SocketError("listen on", socket_path_);
+  }
+  accept_thread_ = absl::WrapUnique(Env::Default()->StartThread(
+      {}, "tf_data_shm_accept", [this]() { AcceptLoop(); }));
+  VLOG(1) << "Started shm data transfer server at " << socket_path_
+          << " with shared memory region " << allocator_->region()->name();
+  return absl::OkStatus();
+}
+
+int ShmDataTransferServer::Port() const { return getpid(); }
+
+absl::StatusOr<std::string> ShmDataTransferServer::GetCompatibilityInfo()
+    const {
+  return port::Hostname();
+}
+
+int64_t ShmDataTransferServer::BytesInUse() const {
+  if (!allocator_) {
+    return 0;
+  }
+  std::optional<AllocatorStats> stats = allocator_->GetStats();
+  return stats ? stats->bytes_in_use : 0;
+}
+
+void ShmDataTransferServer::AcceptLoop() {
+  while (true) {
+    const int fd = accept4(listen_fd_, /*addr=*/nullptr, /*addrlen=*/nullptr,
+                           SOCK_CLOEXEC);
+    if (fd < 0 && errno == EINTR) {
+      continue;
+    }
+    mutex_lock l(mu_);
+    if (cancelled_) {
+      if (fd >= 0) close(fd);
+      return;
+    }
+    if (fd < 0) {
+      LOG(ERROR) << "Failed to accept a connection on " << socket_path_ << ": "
+                 << strerror(errno);
+      return;
+    }
+    auto connection = std::make_shared<Connection>(fd);
+    connections_.push_back(connection);
+    threads_.push_back(absl::WrapUnique(Env::Default()->StartThread(
+        {}, "tf_data_shm_serve",
+        [this, connection]() { Serve(connection); })));
+  }
+}
+
+void ShmDataTransferServer::Serve(std::shared_ptr<Connection> connection) {
+  while (true) {
+    ShmGetElementRequest request;
+    if (!ReadMessage(connection->fd, request).ok()) {
+      break;
+    }
+    ShmGetElementResponse response;
+    HandleRequest(request, *connection, response);
+    if (!WriteMessage(connection->fd, response).ok()) {
+      break;
+    }
+  }
+  // The client is gone, so the memory of its components can be reused.
+  connection->outstanding.clear();
+  mutex_lock l(mu_);
+  if (!cancelled_) {
+    connections_.erase(
+        std::find(connections_.begin(), connections_.end(), connection));
+  }
+}
+
+void ShmDataTransferServer::HandleRequest(const ShmGetElementRequest& request,
+                                          Connection& connection,
+                                          ShmGetElementResponse& response) {
+  for (int64_t offset : request.released_offsets()) {
+    connection.outstanding.erase(offset);
+  }
+  GetElementResult result;
+  Status s = get_element_(&request.request(), &result);
+  response.set_status_code(static_cast<int32_t>(s.code()));
+  if (!s.ok()) {
+    response.set_status_message(std::string(s.message()));
+    return;
+  }
+  response.set_element_index(result.element_index);
+  response.set_end_of_sequence(result.end_of_sequence);
+  response.set_skip_task(result.skip);
+  for (const Tensor& component : result.components) {
+    ShmElementComponent* proto = response.add_components();
+    proto->set_dtype(component.dtype());
+    component.shape().AsProto(proto->mutable_tensor_shape());
+    if (DataTypeCanUseMemcpy(component.dtype()) &&
+        component.TotalBytes() > 0) {
+      // Returns a tensor with no buffer when the region is full.
+      Tensor shared(allocator_.get(), component.dtype(), component.shape());
+      SharedMemoryTensorHandle handle;
+      if (shared.IsInitialized() &&
+          GetSharedMemoryTensorHandle(shared, &handle)) {
+        memcpy(const_cast<char*>(shared.tensor_data().data()),
+               component.tensor_data().data(), component.TotalBytes());
+        connection.outstanding[handle.offset()] = std::move(shared);
+        *proto->mutable_shared_memory() = std::move(handle);
+        continue;
+      }
+    }
+    component.AsProtoTensorContent(proto->mutable_tensor());
+  }
+}
+
+// The state of the connection of a client, shared with the buffers of the
+// tensors it mapped so that it stays open while they are in use.
+struct ShmDataTransferClient::Connection {
+  explicit Connection(int fd) : fd(fd) {}
+  ~Connection() { close(fd); }
+
+  void Release(int64_t offset) {
+    mutex_lock l(released_mu);
+    released_offsets.push_back(offset);
+  }
+
+  const int fd;
+  // Serializes the requests on the connection.
+  mutex io_mu;
+  mutex released_mu;
+  // The offsets of the components destroyed since the last request.
+  std::vector<int64_t> released_offsets TF_GUARDED_BY(released_mu);
+};
+
+namespace {
+
+// The buffer of a component mapped from the shared memory of the worker. Tells
+// the worker that the memory can be reused once it is destroyed.
+class ShmComponentBuffer : public TensorBuffer {
+ public:
+  ShmComponentBuffer(core::RefCountPtr<SharedMemoryRegion> region,
+                     int64_t offset, size_t size,
+                     std::function<void(int64_t)> release)
+      : TensorBuffer(region->base() + offset),
+        region_(std::move(region)),
+        offset_(offset),
+        size_(size),
+        release_(std::move(release)) {}
+
+  ~ShmComponentBuffer() override { release_(offset_); }
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocated_bytes(size_);
+    proto->set_allocator_name(absl::StrCat("shm:", region_->name()));
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const core::RefCountPtr<SharedMemoryRegion> region_;
+  const int64_t offset_;
+  const size_t size_;
+  const std::function<void(int64_t)> release_;
+};
+
+}  // namespace
+
+ShmDataTransferClient::ShmDataTransferClient(const std::string& socket_path)
+    : socket_path_(socket_path) {
+  VLOG(2) << "Create ShmDataTransferClient for worker socket " << socket_path_;
+}
+
+ShmDataTransferClient::~ShmDataTransferClient() = default;
+
+Status ShmDataTransferClient::EnsureConnected() {
+  if (connection_) {
+    return absl::OkStatus();
+  }
+  sockaddr_un address;
+  TF_RETURN_IF_ERROR(MakeSocketAddress(socket_path_, address));
+  const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    return SocketError("create", socket_path_);
+  }
+  if (connect(fd, reinterpret_cast<const sockaddr*>(&address),
+              sizeof(address)) != 0) {
+    Status s = SocketError("connect to", socket_path_);
+    close(fd);
+    return s;
+  }
+  connection_ = std::make_shared<Connection>(fd);
+  return absl::OkStatus();
+}
+
+Status ShmDataTransferClient::GetElement(const GetElementRequest& req,
+                                         GetElementResult& result) {
+  std::shared_ptr<Connection> connection;
+  {
+    mutex_lock l(mu_);
+    if (cancelled_) {
+      return errors::Cancelled("Client was cancelled.");
+    }
+    TF_RETURN_IF_ERROR(EnsureConnected());
+    connection = connection_;
+  }
+  ShmGetElementRequest request;
+  *request.mutable_request() = req;
+  ShmGetElementResponse response;
+  {
+    mutex_lock l(connection->io_mu);
+    {
+      mutex_lock released_lock(connection->released_mu);
+      request.mutable_released_offsets()->Add(
+          connection->released_offsets.begin(),
+          connection->released_offsets.end());
+      connection->released_offsets.clear();
+    }
+    Status s = WriteMessage(connection->fd, request);
+    if (s.ok()) {
+      s = ReadMessage(connection->fd, response);
+    }
+    if (!s.ok()) {
+      mutex_lock l(mu_);
+      if (cancelled_) {
+        return errors::Cancelled("Client was cancelled.");
+      }
+      // Reconnects on the next request. The worker reclaims the memory of the
+      // components of this connection once the last of them is destroyed.
+      if (connection_ == connection) {
+        connection_.reset();
+      }
+      return s;
+    }
+  }
+  if (response.status_code() != 0) {
+    return Status(static_cast<absl::StatusCode>(response.status_code()),
+                  response.status_message());
+  }
+  result.components.clear();
+  result.components.reserve(response.components_size());
+  for (const ShmElementComponent& proto : response.components()) {
+    Tensor component;
+    if (proto.has_tensor()) {
+      if (!component.FromProto(proto.tensor())) {
+        return errors::DataLoss("Failed to parse a component of element ",
+                                response.element_index());
+      }
+      result.components.push_back(std::move(component));
+      continue;
+    }
+    TensorShape shape;
+    TF_RETURN_IF_ERROR(
+        TensorShape::BuildTensorShape(proto.tensor_shape(), &shape));
+    const SharedMemoryTensorHandle& handle = proto.shared_memory();
+    const int64_t num_bytes =
+        shape.num_elements() * DataTypeSize(proto.dtype());
+    if (!DataTypeCanUseMemcpy(proto.dtype()) ||
+        handle.num_bytes() != num_bytes) {
+      return errors::DataLoss("Invalid shared memory component of element ",
+                              response.element_index());
+    }
+    core::RefCountPtr<SharedMemoryRegion> region;
+    TF_RETURN_IF_ERROR(SharedMemoryRegion::Open(handle.region_name(), &region));
+    if (handle.offset() < 0 ||
+        static_cast<uint64_t>(handle.offset()) + num_bytes > region->size()) {
+      return errors::DataLoss("Invalid range [", handle.offset(), ", ",
+                              handle.offset() + num_bytes,
+                              ") in shared memory region ",
+                              handle.region_name(), " of ", region->size(),
+                              " bytes.");
+    }
+    // Holds the connection, so that the worker keeps the memory until the
+    // buffer is released.
+    auto* buffer = new ShmComponentBuffer(
+        std::move(region), handle.offset(), num_bytes,
+        [connection](int64_t offset) { connection->Release(offset); });
+    result.components.push_back(Tensor(proto.dtype(), shape, buffer));
+    buffer->Unref();
+  }
+  result.element_index = response.element_index();
+  result.end_of_sequence = response.end_of_sequence();
+  result.skip = response.skip_task();
+  return absl::OkStatus();
+}
+
+void ShmDataTransferClient::TryCancel() {
+  mutex_lock l(mu_);
+  cancelled_ = true;
+  if (connection_) {
+    // Unblocks the request in progress, if any.
+    shutdown(connection_->fd, SHUT_RDWR);
+  }
+}
+
+absl::StatusOr<std::string> ShmDataTransferClient::GetCompatibilityInfo()
+    const {
+  return port::Hostname();
+}
+
+Status ShmDataTransferClient::CheckCompatibility(
+    const std::string& server_compatibility_info) const {
+  const std::string hostname = port::Hostname();
+  if (server_compatibility_info != hostname) {
+    return errors::FailedPrecondition(
+        "The ", kShmTransferProtocol, " data transfer protocol needs the "
+        "worker and the client on the same host, but the worker runs on ",
+        server_compatibility_info, " and the client on ", hostname, ".");
+  }
+  return absl::OkStatus();
+}
+
+namespace {
+
+class ShmTransferServerRegistrar {
+ public:
+  ShmTransferServerRegistrar() {
+    DataTransferServer::Register(
+        kShmTransferProtocol,
+        [](DataTransferServer::GetElementT get_element,
+           std::shared_ptr<DataTransferServer>* server) {
+          *server = std::make_shared<ShmDataTransferServer>(
+              std::move(get_element), ShmDataTransferServer::Options());
+          return absl::OkStatus();
+        });
+  }
+};
+static ShmTransferServerRegistrar shm_server_registrar;
+
+class ShmTransferClientRegistrar {
+ public:
+  ShmTransferClientRegistrar() {
+    DataTransferClient::Register(
+        kShmTransferProtocol, [](DataTransferClient::Config config,
+                                 std::unique_ptr<DataTransferClient>* out) {
+          *out = std::make_unique<ShmDataTransferClient>(config.address);
+          return absl::OkStatus();
+        });
+  }
+};
+static ShmTransferClientRegistrar shm_client_registrar;
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // PLATFORM_WINDOWS
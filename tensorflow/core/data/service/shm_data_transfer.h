@@ -0,0 +1,132 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/distributed_runtime/shared_memory_tensor.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/service_config.pb.h"
+
+namespace tensorflow {
+namespace data {
+
+// The "shm" data transfer protocol passes elements between a worker and a
+// client on the same host without serializing them. The worker copies the
+// components of every element into a shared memory region once, and the
+// client maps them in place, so neither side pays for protobuf encoding or
+// for pushing the contents through a socket.
+//
+// The worker listens on a Unix domain socket at `data_transfer_address`, in
+// which "%port%" stands for the process id of the worker. Requests and
+// responses on the socket only carry the locations of the components. The
+// client returns the memory of a component to the worker with the next
+// request after its tensor is destroyed, or when it disconnects.
+//
+// Components that cannot be copied with memcpy, such as strings and the
+// variants of compressed elements, are sent inline, so jobs should disable
+// compression to benefit. Clients on other hosts fail the compatibility check
+// and fall back to gRPC.
+constexpr const char kShmTransferProtocol[] = "shm";
+
+class ShmDataTransferServer : public DataTransferServer {
+ public:
+  struct Options {
+    // The size of the shared memory region that holds the components not
+    // released by the clients yet. Components that do not fit are sent
+    // inline.
+    int64_t region_size = 256 << 20;
+  };
+
+  ShmDataTransferServer(GetElementT get_element, const Options& options);
+  ~ShmDataTransferServer() override;
+
+  Status Start(const experimental::WorkerConfig& config) override;
+  int Port() const override;
+  absl::StatusOr<std::string> GetCompatibilityInfo() const override;
+
+  // Returns the path of the socket the server listens on.
+  const std::string& socket_path() const { return socket_path_; }
+
+  // Returns the number of bytes of shared memory in use by the clients.
+  int64_t BytesInUse() const;
+
+ private:
+  struct Connection;
+
+  // Accepts connections until the server is destroyed.
+  void AcceptLoop();
+  // Serves the requests of `connection` until it is closed.
+  void Serve(std::shared_ptr<Connection> connection);
+  // Fills `response` with the next element for `request`, placing its
+  // components in shared memory on behalf of `connection`.
+  void HandleRequest(const ShmGetElementRequest& request,
+                     Connection& connection, ShmGetElementResponse& response);
+
+  const GetElementT get_element_;
+  const Options options_;
+  std::string socket_path_;
+  int listen_fd_ = -1;
+  std::unique_ptr<SharedMemoryAllocator> allocator_;
+  std::unique_ptr<Thread> accept_thread_;
+
+  mutable mutex mu_;
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+  std::vector<std::shared_ptr<Connection>> connections_ TF_GUARDED_BY(mu_);
+  std::vector<std::unique_ptr<Thread>> threads_ TF_GUARDED_BY(mu_);
+};
+
+class ShmDataTransferClient : public DataTransferClient {
+ public:
+  // Connects lazily to the server listening at `socket_path`.
+  explicit ShmDataTransferClient(const std::string& socket_path);
+  ~ShmDataTransferClient() override;
+
+  Status GetElement(const GetElementRequest& req,
+                    GetElementResult& result) override;
+  void TryCancel() override;
+  absl::StatusOr<std::string> GetCompatibilityInfo() const override;
+  Status CheckCompatibility(
+      const std::string& server_compatibility_info) const override;
+
+ private:
+  struct Connection;
+
+  Status EnsureConnected() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const std::string socket_path_;
+
+  mutex mu_;
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+  // Shared with the buffers of the tensors the client returns, which keep the
+  // connection open until the worker is told that they are released.
+  std::shared_ptr<Connection> connection_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
@@ -0,0 +1,182 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shm_data_transfer.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/service_config.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Returns element `task_id` of a range dataset with an int64 and a string
+// component, and ends the sequence at task 3.
+Status GetTestElement(const GetElementRequest* request,
+                      GetElementResult* result) {
+  if (request->task_id() < 0) {
+    return errors::NotFound("Task ", request->task_id(), " not found.");
+  }
+  if (request->task_id() >= 3) {
+    result->end_of_sequence = true;
+    return absl::OkStatus();
+  }
+  result->components.push_back(
+      test::AsTensor<int64_t>({request->task_id(), request->task_id() + 1}));
+  result->components.push_back(
+      test::AsScalar<tstring>(absl::StrCat("element ", request->task_id())));
+  result->element_index = request->task_id();
+  return absl::OkStatus();
+}
+
+std::unique_ptr<ShmDataTransferServer> StartServer(
+    int64_t region_size = 1 << 20) {
+  ShmDataTransferServer::Options options;
+  options.region_size = region_size;
+  auto server = std::make_unique<ShmDataTransferServer>(GetTestElement,
+                                                        options);
+  experimental::WorkerConfig config;
+  config.set_data_transfer_address(
+      absl::StrCat(testing::TmpDir(), "/shm_%port%"));
+  TF_CHECK_OK(server->Start(config));
+  return server;
+}
+
+GetElementRequest MakeRequest(int64_t task_id) {
+  GetElementRequest request;
+  request.set_task_id(task_id);
+  return request;
+}
+
+TEST(ShmDataTransferTest, GetElements) {
+  std::unique_ptr<ShmDataTransferServer> server = StartServer();
+  ShmDataTransferClient client(server->socket_path());
+  for (int64_t i = 0; i < 3; ++i) {
+    GetElementResult result;
+    TF_ASSERT_OK(client.GetElement(MakeRequest(i), result));
+    ASSERT_EQ(result.components.size(), 2);
+    test::ExpectEqual(result.components[0],
+                      test::AsTensor<int64_t>({i, i + 1}));
+    test::ExpectEqual(result.components[1],
+                      test::AsScalar<tstring>(absl::StrCat("element ", i)));
+    EXPECT_EQ(result.element_index, i);
+    EXPECT_FALSE(result.end_of_sequence);
+  }
+  GetElementResult result;
+  TF_ASSERT_OK(client.GetElement(MakeRequest(3), result));
+  EXPECT_TRUE(result.end_of_sequence);
+  EXPECT_TRUE(result.components.empty());
+}
+
+TEST(ShmDataTransferTest, ReleasesComponents) {
+  std::unique_ptr<ShmDataTransferServer> server = StartServer();
+  ShmDataTransferClient client(server->socket_path());
+  EXPECT_EQ(server->BytesInUse(), 0);
+  {
+    GetElementResult result;
+    TF_ASSERT_OK(client.GetElement(MakeRequest(0), result));
+    EXPECT_GT(server->BytesInUse(), 0);
+  }
+  // The next request tells the worker that the first element is released.
+  GetElementResult result;
+  TF_ASSERT_OK(client.GetElement(MakeRequest(3), result));
+  EXPECT_EQ(server->BytesInUse(), 0);
+}
+
+TEST(ShmDataTransferTest, ComponentsOutliveClient) {
+  std::unique_ptr<ShmDataTransferServer> server = StartServer();
+  Tensor component;
+  {
+    ShmDataTransferClient client(server->socket_path());
+    GetElementResult result;
+    TF_ASSERT_OK(client.GetElement(MakeRequest(1), result));
+    component = result.components[0];
+  }
+  test::ExpectEqual(component, test::AsTensor<int64_t>({1, 2}));
+}
+
+TEST(ShmDataTransferTest, SendsInlineWhenRegionIsFull) {
+  // Too small for any component, so they are all sent inline.
+  std::unique_ptr<ShmDataTransferServer> server =
+      StartServer(/*region_size=*/1);
+  ShmDataTransferClient client(server->socket_path());
+  GetElementResult result;
+  TF_ASSERT_OK(client.GetElement(MakeRequest(2), result));
+  test::ExpectEqual(result.components[0], test::AsTensor<int64_t>({2, 3}));
+  EXPECT_EQ(server->BytesInUse(), 0);
+}
+
+TEST(ShmDataTransferTest, PropagatesErrors) {
+  std::unique_ptr<ShmDataTransferServer> server = StartServer();
+  ShmDataTransferClient client(server->socket_path());
+  GetElementResult result;
+  EXPECT_TRUE(errors::IsNotFound(client.GetElement(MakeRequest(-1), result)));
+  TF_EXPECT_OK(client.GetElement(MakeRequest(0), result));
+}
+
+TEST(ShmDataTransferTest, Cancel) {
+  std::unique_ptr<ShmDataTransferServer> server = StartServer();
+  ShmDataTransferClient client(server->socket_path());
+  client.TryCancel();
+  GetElementResult result;
+  EXPECT_TRUE(errors::IsCancelled(client.GetElement(MakeRequest(0), result)));
+}
+
+TEST(ShmDataTransferTest, MissingAddress) {
+  ShmDataTransferServer server(GetTestElement,
+                               ShmDataTransferServer::Options());
+  EXPECT_TRUE(
+      errors::IsInvalidArgument(server.Start(experimental::WorkerConfig())));
+}
+
+TEST(ShmDataTransferTest, CheckCompatibility) {
+  std::unique_ptr<ShmDataTransferServer> server = StartServer();
+  ShmDataTransferClient client(server->socket_path());
+  TF_ASSERT_OK_AND_ASSIGN(std::string compatibility_info,
+                          server->GetCompatibilityInfo());
+  TF_EXPECT_OK(client.CheckCompatibility(compatibility_info));
+  EXPECT_TRUE(errors::IsFailedPrecondition(
+      client.CheckCompatibility(absl::StrCat(port::Hostname(), "-other"))));
+}
+
+TEST(ShmDataTransferTest, Registered) {
+  std::shared_ptr<DataTransferServer> server;
+  TF_EXPECT_OK(
+      DataTransferServer::Build(kShmTransferProtocol, GetTestElement, &server));
+  std::unique_ptr<DataTransferClient> client;
+  TF_EXPECT_OK(DataTransferClient::Build(
+      kShmTransferProtocol,
+      {kShmTransferProtocol, "/tmp/unused", /*allocator=*/nullptr}, &client));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -14,7 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/snapshot/file_utils.h"
 
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -31,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
+#include "tsl/platform/fingerprint.h"
 #include "tsl/platform/protobuf.h"
 #include "tsl/platform/random.h"
 #include "tsl/platform/status_to_from_proto.h"
@@ -41,6 +44,7 @@ namespace data {
 namespace {
 
 constexpr const char kTempFileSuffix[] = ".tmp";
+constexpr size_t kFingerprintBlockSize = 16 << 20;  // 16MB
 
 absl::Status AtomicallyWrite(
     absl::string_view filename, tsl::Env* env,
@@ -117,6 +121,37 @@ absl::Status AtomicallyWriteTFRecords(absl::string_view filename,
   return absl::OkStatus();
 }
 
+absl::Status AtomicallyCopyFile(absl::string_view source,
+                                absl::string_view target, tsl::Env* env) {
+  auto nonatomically_write = [&](const std::string& uncommitted_filename) {
+    return env->CopyFile(std::string(source), uncommitted_filename);
+  };
+  TF_RETURN_WITH_CONTEXT_IF_ERROR(
+      AtomicallyWrite(target, env, nonatomically_write),
+      " Requested to atomically copy file ", source, " to ", target);
+  return absl::OkStatus();
+}
+
+absl::StatusOr<uint64_t> FingerprintFile(absl::string_view filename,
+                                         tsl::Env* env) {
+  std::unique_ptr<tsl::RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(std::string(filename), &file));
+  std::vector<char> scratch(kFingerprintBlockSize);
+  uint64_t fingerprint = 0;
+  for (uint64_t offset = 0;; offset += kFingerprintBlockSize) {
+    absl::string_view block;
+    absl::Status status =
+        file->Read(offset, kFingerprintBlockSize, &block, scratch.data());
+    if (!status.ok() && !absl::IsOutOfRange(status)) {
+      return status;
+    }
+    fingerprint = tsl::FingerprintCat64(fingerprint, tsl::Fingerprint64(block));
+    if (absl::IsOutOfRange(status)) {
+      return fingerprint;
+    }
+  }
+}
+
 absl::StatusOr<std::vector<std::string>> GetChildren(
     absl::string_view directory, tsl::Env* env) {
   std::vector<std::string> files, result;
@@ -53,6 +53,15 @@ absl::Status AtomicallyWriteTFRecords(absl::string_view filename,
                                       absl::string_view compression,
                                       tsl::Env* env);
 
+// Atomically copies `source` to `target`. Overwrites existing contents if
+// `target` already exists.
+absl::Status AtomicallyCopyFile(absl::string_view source,
+                                absl::string_view target, tsl::Env* env);
+
+// Returns a fingerprint of the contents of `filename`.
+absl::StatusOr<uint64_t> FingerprintFile(absl::string_view filename,
+                                         tsl::Env* env);
+
 // Returns the relative paths of the children of `directory`, ignoring temporary
 // files. Returns an empty vector if the directory does not have any children.
 absl::StatusOr<std::vector<std::string>> GetChildren(
@@ -40,6 +40,7 @@ namespace {
 
 using ::testing::ElementsAre;
 using ::testing::IsEmpty;
+using ::testing::UnorderedElementsAre;
 using tsl::testing::IsOkAndHolds;
 using tsl::testing::StatusIs;
 
@@ -110,6 +111,40 @@ TEST(FileUtilsTest, AtomicallyWriteTFRecord) {
   EXPECT_EQ(out.DebugString(), in.front().DebugString());
 }
 
+TEST(FileUtilsTest, AtomicallyCopyFile) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string directory, CreateTestDirectory());
+  std::string source = tsl::io::JoinPath(directory, "source");
+  std::string target = tsl::io::JoinPath(directory, "target");
+  TF_ASSERT_OK(tsl::WriteStringToFile(tsl::Env::Default(), source, "data"));
+  TF_ASSERT_OK(AtomicallyCopyFile(source, target, tsl::Env::Default()));
+
+  std::string data;
+  TF_ASSERT_OK(tsl::ReadFileToString(tsl::Env::Default(), target, &data));
+  EXPECT_EQ(data, "data");
+  EXPECT_THAT(GetChildren(directory, tsl::Env::Default()),
+              IsOkAndHolds(UnorderedElementsAre("source", "target")));
+}
+
+TEST(FileUtilsTest, FingerprintFile) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string directory, CreateTestDirectory());
+  std::string file1 = tsl::io::JoinPath(directory, "file1");
+  std::string file2 = tsl::io::JoinPath(directory, "file2");
+  std::string file3 = tsl::io::JoinPath(directory, "file3");
+  TF_ASSERT_OK(tsl::WriteStringToFile(tsl::Env::Default(), file1, "data"));
+  TF_ASSERT_OK(tsl::WriteStringToFile(tsl::Env::Default(), file2, "data"));
+  TF_ASSERT_OK(tsl::WriteStringToFile(tsl::Env::Default(), file3, "other"));
+
+  TF_ASSERT_OK_AND_ASSIGN(uint64_t fingerprint1,
+                          FingerprintFile(file1, tsl::Env::Default()));
+  EXPECT_THAT(FingerprintFile(file2, tsl::Env::Default()),
+              IsOkAndHolds(fingerprint1));
+  EXPECT_THAT(FingerprintFile(file3, tsl::Env::Default()),
+              IsOkAndHolds(::testing::Ne(fingerprint1)));
+  EXPECT_THAT(FingerprintFile(tsl::io::JoinPath(directory, "missing"),
+                              tsl::Env::Default()),
+              StatusIs(tsl::error::NOT_FOUND));
+}
+
 TEST(FileUtilsTest, GetChildren) {
   TF_ASSERT_OK_AND_ASSIGN(std::string directory, CreateTestDirectory());
   std::string test_file = tsl::io::JoinPath(directory, "test_file");
@@ -0,0 +1,257 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/snapshot/parallel_tfrecord_reader.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/log/log.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tsl/lib/io/record_reader.h"
+#include "tsl/platform/cpu_info.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/threadpool.h"
+#include "tsl/platform/tstring.h"
+#include "tsl/profiler/lib/traceme.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Returns the pool shared by the readers that do not provide their own.
+tsl::thread::ThreadPool* DefaultThreadPool() {
+  static tsl::thread::ThreadPool* thread_pool = new tsl::thread::ThreadPool(
+      tsl::Env::Default(), tsl::ThreadOptions{}, "parse_tfrecord_thread",
+      tsl::port::MaxParallelism());
+  return thread_pool;
+}
+
+}  // namespace
+
+ParallelTFRecordReader::ParallelTFRecordReader(
+    const std::string& filename, const std::string& compression,
+    const DataTypeVector& dtypes, tsl::Env* env, const Options& options,
+    const Position& position)
+    : filename_(filename),
+      compression_(compression),
+      dtypes_(dtypes),
+      env_(env),
+      options_(options),
+      start_position_(position),
+      thread_pool_(options.thread_pool != nullptr ? options.thread_pool
+                                                  : DefaultThreadPool()),
+      position_(position) {}
+
+ParallelTFRecordReader::~ParallelTFRecordReader() {
+  {
+    absl::MutexLock l(&mu_);
+    cancelled_ = true;
+    buffer_space_ready_.SignalAll();
+    element_ready_.SignalAll();
+  }
+  read_thread_.reset();
+  absl::MutexLock l(&mu_);
+  while (num_parsing_ > 0) {
+    element_ready_.Wait(&mu_);
+  }
+}
+
+absl::Status ParallelTFRecordReader::Initialize() {
+  TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(filename_, &file_));
+  auto reader_options =
+      tsl::io::RecordReaderOptions::CreateRecordReaderOptions(compression_);
+#if !defined(IS_SLIM_BUILD)
+  if (options_.output_buffer_size.has_value()) {
+    reader_options.snappy_options.output_buffer_size =
+        *options_.output_buffer_size;
+    reader_options.zlib_options.output_buffer_size =
+        *options_.output_buffer_size;
+  }
+#endif  // IS_SLIM_BUILD
+  record_reader_ =
+      std::make_unique<tsl::io::RecordReader>(file_.get(), reader_options);
+  read_thread_ = absl::WrapUnique(env_->StartThread(
+      tsl::ThreadOptions{}, "read_tfrecord_thread", [this]() {
+        ReadRecords();
+      }));
+  return absl::OkStatus();
+}
+
+absl::StatusOr<ParallelTFRecordReader::Element>
+ParallelTFRecordReader::GetNext() ABSL_LOCKS_EXCLUDED(mu_) {
+  absl::MutexLock l(&mu_);
+  while (true) {
+    std::optional<int64_t> index;
+    if (options_.deterministic) {
+      if (!pending_indices_.empty() &&
+          parsed_.contains(pending_indices_.front())) {
+        index = pending_indices_.front();
+      }
+    } else if (!parsed_.empty()) {
+      index = parsed_.begin()->first;
+    }
+
+    if (index.has_value()) {
+      auto it = parsed_.find(*index);
+      absl::StatusOr<std::vector<Tensor>> tensors = std::move(it->second);
+      parsed_.erase(it);
+      pending_indices_.erase(
+          std::find(pending_indices_.begin(), pending_indices_.end(), *index));
+      buffer_space_ready_.Signal();
+      TF_RETURN_IF_ERROR(tensors.status());
+      UpdatePosition(*index);
+      return Element{*index, *std::move(tensors)};
+    }
+
+    if (cancelled_) {
+      return absl::CancelledError(
+          absl::StrCat("Reading ", filename_, " has been cancelled."));
+    }
+    if (pending_indices_.empty() && (end_of_file_ || !read_status_.ok())) {
+      TF_RETURN_IF_ERROR(read_status_);
+      return absl::OutOfRangeError("EOF reached");
+    }
+    element_ready_.Wait(&mu_);
+  }
+}
+
+ParallelTFRecordReader::Position ParallelTFRecordReader::position() const
+    ABSL_LOCKS_EXCLUDED(mu_) {
+  absl::MutexLock l(&mu_);
+  return position_;
+}
+
+uint64_t ParallelTFRecordReader::BytesRead() const ABSL_LOCKS_EXCLUDED(mu_) {
+  absl::MutexLock l(&mu_);
+  return bytes_read_;
+}
+
+void ParallelTFRecordReader::ReadRecords() ABSL_LOCKS_EXCLUDED(mu_) {
+  const int64_t readahead = std::max<int64_t>(options_.readahead, 1);
+  uint64_t offset = 0;
+  for (int64_t index = 0;; ++index) {
+    {
+      absl::MutexLock l(&mu_);
+      while (!cancelled_ && pending_indices_.size() >= readahead) {
+        buffer_space_ready_.Wait(&mu_);
+      }
+      if (cancelled_) {
+        return;
+      }
+    }
+
+    tsl::profiler::TraceMe activity("ParallelTFRecordReader::ReadRecords",
+                                    tsl::profiler::TraceMeLevel::kInfo);
+    std::vector<tstring> records(dtypes_.size());
+    uint64_t num_bytes = 0;
+    absl::Status status;
+    for (tstring& record : records) {
+      status = record_reader_->ReadRecord(&offset, &record);
+      if (!status.ok()) {
+        break;
+      }
+      num_bytes += record.size();
+    }
+    {
+      absl::MutexLock l(&mu_);
+      bytes_read_ += num_bytes;
+      if (!status.ok()) {
+        if (absl::IsOutOfRange(status)) {
+          end_of_file_ = true;
+        } else {
+          read_status_ = status;
+        }
+        element_ready_.SignalAll();
+        return;
+      }
+      if (WasRead(index)) {
+        continue;
+      }
+      pending_indices_.push_back(index);
+      ++num_parsing_;
+    }
+    thread_pool_->Schedule(
+        [this, index, records = std::move(records)]() mutable {
+          ParseElement(index, std::move(records));
+        });
+  }
+}
+
+void ParallelTFRecordReader::ParseElement(int64_t index,
+                                          std::vector<tstring> records)
+    ABSL_LOCKS_EXCLUDED(mu_) {
+  tsl::profiler::TraceMe activity("ParallelTFRecordReader::ParseElement",
+                                  tsl::profiler::TraceMeLevel::kInfo);
+  std::vector<Tensor> tensors;
+  tensors.reserve(records.size());
+  absl::Status status;
+  for (const tstring& record : records) {
+    TensorProto proto;
+    if (!proto.ParseFromArray(record.data(), record.size())) {
+      status = absl::DataLossError(
+          absl::StrCat("Unable to parse tensor from stored proto in file: ",
+                       filename_, ", element ", index, "."));
+      break;
+    }
+    Tensor tensor;
+    if (!tensor.FromProto(proto)) {
+      status = absl::DataLossError(
+          absl::StrCat("Unable to parse tensor from stored proto in file: ",
+                       filename_, ", element ", index,
+                       ". TensorProto: ", proto.ShortDebugString()));
+      break;
+    }
+    tensors.push_back(std::move(tensor));
+  }
+
+  absl::MutexLock l(&mu_);
+  if (status.ok()) {
+    parsed_.emplace(index, std::move(tensors));
+  } else {
+    parsed_.emplace(index, std::move(status));
+  }
+  --num_parsing_;
+  element_ready_.SignalAll();
+}
+
+bool ParallelTFRecordReader::WasRead(int64_t index) const {
+  return index < start_position_.start_index ||
+         start_position_.read_indices.contains(index);
+}
+
+void ParallelTFRecordReader::UpdatePosition(int64_t index)
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  position_.read_indices.insert(index);
+  while (position_.read_indices.erase(position_.start_index) > 0) {
+    ++position_.start_index;
+  }
+}
+
+}  // namespace data
+}  // namespace tensorflow
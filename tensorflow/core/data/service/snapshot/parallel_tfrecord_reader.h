@@ -0,0 +1,166 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_PARALLEL_TFRECORD_READER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_PARALLEL_TFRECORD_READER_H_
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tsl/lib/io/record_reader.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/threadpool.h"
+
+namespace tensorflow {
+namespace data {
+
+// Reads a TFRecord snapshot file ahead of its consumer. One thread reads and
+// decompresses the records, and the elements are parsed into tensors on a
+// thread pool shared with other readers. It is the read-side counterpart of
+// `ParallelTFRecordWriter`. This class is thread-safe.
+//
+// Usage example:
+//
+// ParallelTFRecordReader reader(
+//     "/path/to/file", tsl::io::compression::kSnappy, {DT_INT64},
+//     tsl::Env::Default(), ParallelTFRecordReader::Options());
+// TF_RETURN_IF_ERROR(reader.Initialize());
+// while (true) {
+//   absl::StatusOr<ParallelTFRecordReader::Element> element =
+//       reader.GetNext();
+//   if (absl::IsOutOfRange(element.status())) {
+//     break;
+//   }
+//   TF_RETURN_IF_ERROR(element.status());
+//   ...
+// }
+class ParallelTFRecordReader {
+ public:
+  struct Options {
+    // The maximum number of elements read ahead of the consumer. At least 1.
+    int64_t readahead = 16;
+    // If false, elements are returned as soon as they are parsed, possibly
+    // out of the order of the file.
+    bool deterministic = true;
+    // The pool that parses the elements. If null, uses a process-wide pool.
+    tsl::thread::ThreadPool* thread_pool = nullptr;
+    // The buffer size of the decompressed records. See
+    // `snapshot_util::TFRecordReaderImpl`.
+    std::optional<int64_t> output_buffer_size;
+  };
+
+  // The progress of a reader through its file: the elements before
+  // `start_index` and the elements in `read_indices` have been returned.
+  // `read_indices` is only non-empty for non-deterministic readers.
+  struct Position {
+    int64_t start_index = 0;
+    absl::flat_hash_set<int64_t> read_indices;
+  };
+
+  struct Element {
+    // The index of the element in the file.
+    int64_t index = 0;
+    std::vector<Tensor> tensors;
+  };
+
+  // Creates a reader of `filename`, whose elements have `dtypes`. The reader
+  // resumes from `position`.
+  ParallelTFRecordReader(const std::string& filename,
+                         const std::string& compression,
+                         const DataTypeVector& dtypes, tsl::Env* env,
+                         const Options& options,
+                         const Position& position = Position());
+  virtual ~ParallelTFRecordReader();
+  ParallelTFRecordReader(const ParallelTFRecordReader&) = delete;
+  ParallelTFRecordReader& operator=(const ParallelTFRecordReader&) = delete;
+
+  // Opens the file and starts reading ahead.
+  absl::Status Initialize();
+
+  // Returns the next element. Returns an `OutOfRange` error at the end of the
+  // file. Blocks until an element is ready.
+  absl::StatusOr<Element> GetNext();
+
+  // Returns the position to resume from after the returned elements.
+  Position position() const;
+
+  // Returns the number of bytes of records read from the file.
+  uint64_t BytesRead() const;
+
+ private:
+  // Run by the read thread to read records until the end of the file.
+  void ReadRecords();
+
+  // Parses the records of the element at `index`, and buffers the result.
+  void ParseElement(int64_t index, std::vector<tstring> records);
+
+  // Returns whether the element at `index` was returned before the reader
+  // resumed at `start_position_`.
+  bool WasRead(int64_t index) const;
+
+  // Records that the element at `index` has been returned.
+  void UpdatePosition(int64_t index) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const std::string filename_;
+  const std::string compression_;
+  const DataTypeVector dtypes_;
+  tsl::Env* const env_;
+  const Options options_;
+  const Position start_position_;
+  tsl::thread::ThreadPool* const thread_pool_;
+
+  std::unique_ptr<tsl::RandomAccessFile> file_;
+  std::unique_ptr<tsl::io::RecordReader> record_reader_;
+
+  mutable absl::Mutex mu_;
+  // Signalled when an element is buffered or the read thread stops.
+  absl::CondVar element_ready_;
+  // Signalled when an element is returned or the reader is cancelled.
+  absl::CondVar buffer_space_ready_;
+
+  bool cancelled_ ABSL_GUARDED_BY(mu_) = false;
+  // Whether the read thread has read the whole file.
+  bool end_of_file_ ABSL_GUARDED_BY(mu_) = false;
+  // The error that stopped the read thread, if any.
+  absl::Status read_status_ ABSL_GUARDED_BY(mu_);
+  // The indices of the elements read from the file and not returned yet, in
+  // file order.
+  std::deque<int64_t> pending_indices_ ABSL_GUARDED_BY(mu_);
+  // The parsed elements that have not been returned.
+  absl::flat_hash_map<int64_t, absl::StatusOr<std::vector<Tensor>>> parsed_
+      ABSL_GUARDED_BY(mu_);
+  // The number of elements being parsed on `thread_pool_`.
+  int64_t num_parsing_ ABSL_GUARDED_BY(mu_) = 0;
+  Position position_ ABSL_GUARDED_BY(mu_);
+  uint64_t bytes_read_ ABSL_GUARDED_BY(mu_) = 0;
+
+  std::unique_ptr<tsl::Thread> read_thread_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_PARALLEL_TFRECORD_READER_H_
@@ -0,0 +1,236 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/snapshot/parallel_tfrecord_reader.h"
+
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/snapshot_utils.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tsl/lib/core/status_test_util.h"
+#include "tsl/lib/io/compression.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/path.h"
+#include "tsl/platform/status_matchers.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/threadpool.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::testing::ElementsAreArray;
+using ::testing::IsEmpty;
+using ::testing::UnorderedElementsAreArray;
+using ::tsl::testing::StatusIs;
+
+// Writes a file of `num_elements` elements, whose components are `i` and
+// "element i".
+absl::StatusOr<std::string> WriteTestFile(const std::string& name,
+                                          const std::string& compression,
+                                          int64_t num_elements) {
+  const std::string filename = tsl::io::JoinPath(tsl::testing::TmpDir(), name);
+  snapshot_util::TFRecordWriter writer(filename, compression);
+  TF_RETURN_IF_ERROR(writer.Initialize(tsl::Env::Default()));
+  for (int64_t i = 0; i < num_elements; ++i) {
+    TF_RETURN_IF_ERROR(writer.WriteTensors(
+        {Tensor(i), Tensor(tstring(absl::StrCat("element ", i)))}));
+  }
+  TF_RETURN_IF_ERROR(writer.Close());
+  return filename;
+}
+
+// Reads `reader` to the end, and returns the first components.
+absl::StatusOr<std::vector<int64_t>> ReadAll(ParallelTFRecordReader& reader) {
+  std::vector<int64_t> result;
+  while (true) {
+    absl::StatusOr<ParallelTFRecordReader::Element> element =
+        reader.GetNext();
+    if (absl::IsOutOfRange(element.status())) {
+      return result;
+    }
+    TF_RETURN_IF_ERROR(element.status());
+    const int64_t value = element->tensors[0].scalar<int64_t>()();
+    EXPECT_EQ(element->index, value);
+    test::ExpectEqual(element->tensors[1],
+                      Tensor(tstring(absl::StrCat("element ", value))));
+    result.push_back(value);
+  }
+}
+
+std::vector<int64_t> Range(int64_t start, int64_t end) {
+  std::vector<int64_t> range;
+  for (int64_t i = start; i < end; ++i) {
+    range.push_back(i);
+  }
+  return range;
+}
+
+const DataTypeVector kDataTypes = {DT_INT64, DT_STRING};
+
+class ParallelTFRecordReaderTest
+    : public ::testing::TestWithParam<std::tuple<std::string, int64_t>> {
+ protected:
+  std::string Compression() const { return std::get<0>(GetParam()); }
+  int64_t Readahead() const { return std::get<1>(GetParam()); }
+};
+
+TEST_P(ParallelTFRecordReaderTest, ReadsInOrder) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      const std::string filename,
+      WriteTestFile(absl::StrCat("in_order_", Readahead()), Compression(),
+                    /*num_elements=*/100));
+  ParallelTFRecordReader::Options options;
+  options.readahead = Readahead();
+  ParallelTFRecordReader reader(filename, Compression(), kDataTypes,
+                                tsl::Env::Default(), options);
+  TF_ASSERT_OK(reader.Initialize());
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<int64_t> result, ReadAll(reader));
+  EXPECT_THAT(result, ElementsAreArray(Range(0, 100)));
+  EXPECT_GT(reader.BytesRead(), 0);
+  EXPECT_EQ(reader.position().start_index, 100);
+  EXPECT_THAT(reader.position().read_indices, IsEmpty());
+}
+
+TEST_P(ParallelTFRecordReaderTest, ReadsOutOfOrder) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      const std::string filename,
+      WriteTestFile(absl::StrCat("out_of_order_", Readahead()), Compression(),
+                    /*num_elements=*/100));
+  ParallelTFRecordReader::Options options;
+  options.readahead = Readahead();
+  options.deterministic = false;
+  ParallelTFRecordReader reader(filename, Compression(), kDataTypes,
+                                tsl::Env::Default(), options);
+  TF_ASSERT_OK(reader.Initialize());
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<int64_t> result, ReadAll(reader));
+  EXPECT_THAT(result, UnorderedElementsAreArray(Range(0, 100)));
+  EXPECT_EQ(reader.position().start_index, 100);
+}
+
+TEST_P(ParallelTFRecordReaderTest, Resumes) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      const std::string filename,
+      WriteTestFile(absl::StrCat("resumes_", Readahead()), Compression(),
+                    /*num_elements=*/10));
+  ParallelTFRecordReader::Position position;
+  position.start_index = 3;
+  position.read_indices = {5, 8};
+  ParallelTFRecordReader::Options options;
+  options.readahead = Readahead();
+  ParallelTFRecordReader reader(filename, Compression(), kDataTypes,
+                                tsl::Env::Default(), options, position);
+  TF_ASSERT_OK(reader.Initialize());
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<int64_t> result, ReadAll(reader));
+  EXPECT_THAT(result, ElementsAreArray({3, 4, 6, 7, 9}));
+  EXPECT_EQ(reader.position().start_index, 10);
+  EXPECT_THAT(reader.position().read_indices, IsEmpty());
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    CompressionAndReadahead, ParallelTFRecordReaderTest,
+    ::testing::Combine(::testing::Values(tsl::io::compression::kNone,
+                                         tsl::io::compression::kSnappy,
+                                         tsl::io::compression::kZlib),
+                       ::testing::Values(1, 4, 64)));
+
+TEST(ParallelTFRecordReaderPositionTest, TracksElementsReadOutOfOrder) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      const std::string filename,
+      WriteTestFile("position", tsl::io::compression::kNone,
+                    /*num_elements=*/10));
+  ParallelTFRecordReader::Options options;
+  options.deterministic = false;
+  ParallelTFRecordReader reader(filename, tsl::io::compression::kNone,
+                                kDataTypes, tsl::Env::Default(), options);
+  TF_ASSERT_OK(reader.Initialize());
+  std::vector<int64_t> read;
+  for (int i = 0; i < 5; ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(ParallelTFRecordReader::Element element,
+                            reader.GetNext());
+    read.push_back(element.index);
+  }
+
+  // Resuming from the position returns exactly the other elements.
+  ParallelTFRecordReader resumed(filename, tsl::io::compression::kNone,
+                                 kDataTypes, tsl::Env::Default(), options,
+                                 reader.position());
+  TF_ASSERT_OK(resumed.Initialize());
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<int64_t> rest, ReadAll(resumed));
+  read.insert(read.end(), rest.begin(), rest.end());
+  EXPECT_THAT(read, UnorderedElementsAreArray(Range(0, 10)));
+}
+
+TEST(ParallelTFRecordReaderThreadTest, UsesGivenThreadPool) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      const std::string filename,
+      WriteTestFile("thread_pool", tsl::io::compression::kNone,
+                    /*num_elements=*/10));
+  tsl::thread::ThreadPool thread_pool(tsl::Env::Default(), "test_pool",
+                                      /*num_threads=*/2);
+  ParallelTFRecordReader::Options options;
+  options.thread_pool = &thread_pool;
+  ParallelTFRecordReader reader(filename, tsl::io::compression::kNone,
+                                kDataTypes, tsl::Env::Default(), options);
+  TF_ASSERT_OK(reader.Initialize());
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<int64_t> result, ReadAll(reader));
+  EXPECT_THAT(result, ElementsAreArray(Range(0, 10)));
+}
+
+TEST(ParallelTFRecordReaderThreadTest, DestroysWhileReading) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      const std::string filename,
+      WriteTestFile("destroy", tsl::io::compression::kNone,
+                    /*num_elements=*/100));
+  ParallelTFRecordReader reader(filename, tsl::io::compression::kNone,
+                                kDataTypes, tsl::Env::Default(),
+                                ParallelTFRecordReader::Options());
+  TF_ASSERT_OK(reader.Initialize());
+  TF_ASSERT_OK(reader.GetNext().status());
+}
+
+TEST(ParallelTFRecordReaderErrorTest, FileNotFound) {
+  ParallelTFRecordReader reader(
+      tsl::io::JoinPath(tsl::testing::TmpDir(), "not_found"),
+      tsl::io::compression::kNone, kDataTypes, tsl::Env::Default(),
+      ParallelTFRecordReader::Options());
+  EXPECT_THAT(reader.Initialize(), StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST(ParallelTFRecordReaderErrorTest, IncompleteElement) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      const std::string filename,
+      WriteTestFile("incomplete_element", tsl::io::compression::kNone,
+                    /*num_elements=*/1));
+  // The file has two records, fewer than the three of an element.
+  ParallelTFRecordReader reader(filename, tsl::io::compression::kNone,
+                                {DT_INT64, DT_STRING, DT_INT64},
+                                tsl::Env::Default(),
+                                ParallelTFRecordReader::Options());
+  TF_ASSERT_OK(reader.Initialize());
+  EXPECT_THAT(reader.GetNext(), StatusIs(absl::StatusCode::kOutOfRange));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
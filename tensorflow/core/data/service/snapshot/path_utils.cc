@@ -233,5 +233,15 @@ std::string UncommittedChunksDirectory(absl::string_view snapshot_path,
   return tsl::io::JoinPath(StreamDirectory(snapshot_path, stream_index),
                            kUncommittedChunksDirectoryName);
 }
+
+std::string ChunkStoreFilePath(absl::string_view chunk_store_path,
+                               uint64_t dataset_fingerprint,
+                               uint64_t content_fingerprint) {
+  return tsl::io::JoinPath(
+      chunk_store_path,
+      absl::StrCat("dataset_",
+                   absl::Hex(dataset_fingerprint, absl::kZeroPad16)),
+      absl::StrCat("chunk_", absl::Hex(content_fingerprint, absl::kZeroPad16)));
+}
 }  // namespace data
 }  // namespace tensorflow
@@ -128,6 +128,13 @@ std::string CommittedChunksDirectory(absl::string_view snapshot_path);
 std::string UncommittedChunksDirectory(absl::string_view snapshot_path,
                                        int64_t stream_index);
 
+// Returns the path of a chunk in the content-addressed chunk store at
+// `chunk_store_path`, for a dataset with `dataset_fingerprint` and a chunk
+// whose contents have `content_fingerprint`.
+std::string ChunkStoreFilePath(absl::string_view chunk_store_path,
+                               uint64_t dataset_fingerprint,
+                               uint64_t content_fingerprint);
+
 }  // namespace data
 }  // namespace tensorflow
 
@@ -260,6 +260,14 @@ TEST(PathUtilsTest, UncommittedChunksDirectory) {
       MatchesRegex("/path/to/snapshot.streams.stream_0.uncommitted_chunks"));
 }
 
+TEST(PathUtilsTest, ChunkStoreFilePath) {
+  EXPECT_THAT(
+      ChunkStoreFilePath("/path/to/store", /*dataset_fingerprint=*/0xabc,
+                         /*content_fingerprint=*/0x12),
+      MatchesRegex("/path/to/store.dataset_0000000000000abc."
+                   "chunk_0000000000000012"));
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -19,9 +19,12 @@ limitations under the License.
 #include <vector>
 
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
-#include "tensorflow/core/data/snapshot_utils.h"
+#include "tensorflow/core/data/service/snapshot/parallel_tfrecord_reader.h"
 #include "tensorflow/core/data/utils.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/metrics.h"
@@ -39,7 +42,10 @@ namespace {
 
 constexpr const char* const kChunkFile = "chunk_file";
 constexpr const char* const kCompression = "compression";
+constexpr const char* const kDeterministic = "deterministic";
 constexpr const char* const kStartIndex = "start_index";
+constexpr const char* const kNumReadIndices = "num_read_indices";
+constexpr const char* const kReadIndex = "read_index";
 constexpr const char* const kOutputTypes = "output_types";
 constexpr const char* const kOutputShapes = "output_shapes";
 constexpr const char* const kSnapshotChunkDataset = "SnapshotChunkDataset";
@@ -66,16 +72,19 @@ class SnapshotChunkDatasetOp : public DatasetOpKernel {
   DataTypeVector output_types_;
   std::vector<PartialTensorShape> output_shapes_;
   std::string compression_;
+  DeterminismPolicy deterministic_;
 };
 
 class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
  public:
   Dataset(DatasetContext&& ctx, const std::string& chunk_file,
-          const std::string& compression, const DataTypeVector& dtypes,
+          const std::string& compression, DeterminismPolicy deterministic,
+          const DataTypeVector& dtypes,
           const std::vector<PartialTensorShape>& shapes)
       : DatasetBase(std::move(ctx)),
         chunk_file_(chunk_file),
         compression_(compression),
+        deterministic_(deterministic),
         dtypes_(dtypes),
         shapes_(shapes) {}
 
@@ -103,13 +112,16 @@ class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
 
     AttrValue compression;
     b->BuildAttrValue(compression_, &compression);
+    AttrValue deterministic;
+    b->BuildAttrValue(deterministic_.String(), &deterministic);
 
     return b->AddDataset(this,
                          /*inputs=*/
                          {std::make_pair(0, chunk_file)},
                          /*list_inputs=*/{},
                          /*attrs=*/
-                         {{kCompression, compression}},
+                         {{kCompression, compression},
+                          {kDeterministic, deterministic}},
                          /*use_dataset_name=*/true, output);
   }
 
@@ -128,10 +140,7 @@ class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
     ~Iterator() override { RecordBytesRead(); }
 
     absl::Status Initialize(IteratorContext* ctx) override {
-      reader_ = std::make_unique<snapshot_util::TFRecordReader>(
-          TranslateFileName(dataset()->chunk_file_), dataset()->compression_,
-          dataset()->dtypes_, kTFRecordReaderOutputBufferSize);
-      return reader_->Initialize(ctx->env());
+      return InitializeReader(ctx, ParallelTFRecordReader::Position());
     }
 
    protected:
@@ -139,57 +148,89 @@ class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
                                  std::vector<Tensor>* out_tensors,
                                  bool* end_of_sequence) override {
       *end_of_sequence = false;
-      absl::Status status = reader_->ReadTensors(out_tensors);
-      if (absl::IsOutOfRange(status)) {
+      absl::StatusOr<ParallelTFRecordReader::Element> element =
+          reader_->GetNext();
+      if (absl::IsOutOfRange(element.status())) {
         *end_of_sequence = true;
         return absl::OkStatus();
       }
       TF_RETURN_WITH_CONTEXT_IF_ERROR(
-          status,
+          element.status(),
           " Failed to read tf.data snapshot file: ", dataset()->chunk_file_);
-      ++start_index_;
-      return status;
+      *out_tensors = std::move(element->tensors);
+      return absl::OkStatus();
     }
 
     absl::Status SaveInternal(SerializationContext* ctx,
                               IteratorStateWriter* writer) override {
+      const ParallelTFRecordReader::Position position = reader_->position();
       TF_RETURN_IF_ERROR(
-          writer->WriteScalar(full_name(kStartIndex), start_index_));
+          writer->WriteScalar(full_name(kStartIndex), position.start_index));
+      // Non-deterministic readers may have returned elements past
+      // `start_index`.
+      if (!position.read_indices.empty()) {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            full_name(kNumReadIndices),
+            static_cast<int64_t>(position.read_indices.size())));
+        int64_t i = 0;
+        for (int64_t index : position.read_indices) {
+          TF_RETURN_IF_ERROR(writer->WriteScalar(
+              full_name(absl::StrCat(kReadIndex, "_", i++)), index));
+        }
+      }
       return absl::OkStatus();
     }
 
     absl::Status RestoreInternal(IteratorContext* ctx,
                                  IteratorStateReader* reader) override {
+      ParallelTFRecordReader::Position position;
       TF_RETURN_IF_ERROR(
-          reader->ReadScalar(full_name(kStartIndex), &start_index_));
-      TF_RETURN_IF_ERROR(Initialize(ctx));
-      return AdvanceToStartIndex(ctx);
+          reader->ReadScalar(full_name(kStartIndex), &position.start_index));
+      if (reader->Contains(full_name(kNumReadIndices))) {
+        int64_t num_read_indices = 0;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kNumReadIndices),
+                                              &num_read_indices));
+        for (int64_t i = 0; i < num_read_indices; ++i) {
+          int64_t index = 0;
+          TF_RETURN_IF_ERROR(reader->ReadScalar(
+              full_name(absl::StrCat(kReadIndex, "_", i)), &index));
+          position.read_indices.insert(index);
+        }
+      }
+      RecordBytesRead();
+      return InitializeReader(ctx, position);
     }
 
    private:
-    // TODO(b/250921378): Optimize this to not parse every single element. We
-    // may consider switching the data format to ArrayRecords so we can use the
-    // index to jump straight to the starting record.
-    absl::Status AdvanceToStartIndex(IteratorContext* ctx) {
-      for (int64_t i = 0; i < start_index_; ++i) {
-        std::vector<Tensor> unused;
-        TF_RETURN_IF_ERROR(reader_->ReadTensors(&unused));
-      }
-      return absl::OkStatus();
+    // Creates a reader that resumes from `position`. The reader skips the
+    // records of the elements that have been read without parsing them.
+    absl::Status InitializeReader(
+        IteratorContext* ctx,
+        const ParallelTFRecordReader::Position& position) {
+      ParallelTFRecordReader::Options options;
+      options.deterministic = !dataset()->deterministic_.IsNondeterministic();
+      options.output_buffer_size = kTFRecordReaderOutputBufferSize;
+      reader_ = std::make_unique<ParallelTFRecordReader>(
+          TranslateFileName(dataset()->chunk_file_), dataset()->compression_,
+          dataset()->dtypes_, ctx->env(), options, position);
+      return reader_->Initialize();
     }
 
     void RecordBytesRead() {
+      if (reader_ == nullptr) {
+        return;
+      }
       uint64_t bytes_read = reader_->BytesRead();
       metrics::GetTFDataBytesReadCounter(kSnapshotChunkDataset)
           ->IncrementBy(bytes_read);
     }
 
-    std::unique_ptr<snapshot_util::TFRecordReader> reader_;
-    int64_t start_index_ = 0;
+    std::unique_ptr<ParallelTFRecordReader> reader_;
   };
 
   const tstring chunk_file_;
   const tstring compression_;
+  const DeterminismPolicy deterministic_;
   const DataTypeVector dtypes_;
   const std::vector<PartialTensorShape> shapes_;
 };
@@ -199,6 +240,10 @@ SnapshotChunkDatasetOp::SnapshotChunkDatasetOp(OpKernelConstruction* ctx)
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kCompression, &compression_));
+  std::string deterministic;
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kDeterministic, &deterministic));
+  OP_REQUIRES_OK(ctx,
+                 DeterminismPolicy::FromString(deterministic, &deterministic_));
 }
 
 void SnapshotChunkDatasetOp::MakeDataset(OpKernelContext* ctx,
@@ -206,9 +251,9 @@ void SnapshotChunkDatasetOp::MakeDataset(OpKernelContext* ctx,
   tstring chunk_file;
   OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, kChunkFile, &chunk_file));
 
-  *output = new SnapshotChunkDatasetOp::Dataset(DatasetContext(ctx), chunk_file,
-                                                compression_, output_types_,
-                                                output_shapes_);
+  *output = new SnapshotChunkDatasetOp::Dataset(
+      DatasetContext(ctx), chunk_file, compression_, deterministic_,
+      output_types_, output_shapes_);
   metrics::RecordTFDataServiceSnapshotOp(
       std::string(GetSnapshotPath(chunk_file)), kSnapshotChunkDataset);
 }
@@ -39,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/protobuf/snapshot.pb.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/path.h"
@@ -89,7 +90,8 @@ absl::Status SnapshotChunkProvider::GetNext(Tensor* split, bool* end_of_splits)
       std::string next_chunk = *chunks_unread_.begin();
       chunks_read_.insert(next_chunk);
       chunks_unread_.erase(next_chunk);
-      *split = ConvertToTensor(AbsPath(snapshot_path_, next_chunk));
+      TF_ASSIGN_OR_RETURN(std::string chunk_file, ChunkFilePath(next_chunk));
+      *split = ConvertToTensor(chunk_file);
       *end_of_splits = false;
       return absl::OkStatus();
     }
@@ -109,6 +111,9 @@ absl::Status SnapshotChunkProvider::UpdateSnapshot()
   TF_ASSIGN_OR_RETURN(snapshot_state_, GetSnapshotState());
   TF_RETURN_IF_ERROR(snapshot_state_.status);
   TF_ASSIGN_OR_RETURN(std::vector<std::string> chunks, GetAvailableChunks());
+  if (!chunks.empty() && !chunk_store_path_.has_value()) {
+    TF_RETURN_IF_ERROR(ReadChunkStorePath());
+  }
   for (const std::string& chunk : chunks) {
     if (!chunks_read_.contains(chunk)) {
       chunks_unread_.insert(std::string(chunk));
@@ -147,6 +152,33 @@ SnapshotChunkProvider::GetAvailableChunks() {
   return status_or_chunks.status();
 }
 
+absl::Status SnapshotChunkProvider::ReadChunkStorePath() {
+  // The metadata is written before any chunk. Snapshots written without it
+  // do not deduplicate their chunks.
+  const std::string metadata_file = SnapshotMetadataFilePath(snapshot_path_);
+  absl::Status status = env_->FileExists(metadata_file);
+  if (absl::IsNotFound(status)) {
+    chunk_store_path_ = "";
+    return absl::OkStatus();
+  }
+  TF_RETURN_IF_ERROR(status);
+  experimental::DistributedSnapshotMetadata metadata;
+  TF_RETURN_IF_ERROR(ReadTextProto(env_, metadata_file, &metadata));
+  chunk_store_path_ = metadata.chunk_store_path();
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::string> SnapshotChunkProvider::ChunkFilePath(
+    absl::string_view chunk) const {
+  std::string chunk_file = AbsPath(snapshot_path_, chunk);
+  if (chunk_store_path_.value_or("").empty()) {
+    return chunk_file;
+  }
+  std::string chunk_store_file;
+  TF_RETURN_IF_ERROR(ReadFileToString(env_, chunk_file, &chunk_store_file));
+  return chunk_store_file;
+}
+
 absl::Status SnapshotChunkProvider::Reset() {
   absl::MutexLock l(&mu_);
   chunks_read_.clear();
@@ -102,6 +102,14 @@ class SnapshotChunkProvider : public SplitProvider {
   // names.
   absl::StatusOr<std::vector<std::string>> GetAvailableChunks();
 
+  // Reads the chunk store path from the snapshot metadata.
+  absl::Status ReadChunkStorePath() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Returns the path of the file that holds the records of `chunk`, which is
+  // in the chunk store if the snapshot deduplicates its chunks.
+  absl::StatusOr<std::string> ChunkFilePath(absl::string_view chunk) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   const std::string snapshot_path_;
   tsl::Env* const env_;
 
@@ -116,6 +124,10 @@ class SnapshotChunkProvider : public SplitProvider {
 
   // State of the snapshot.
   SnapshotState snapshot_state_ ABSL_GUARDED_BY(mu_);
+
+  // The chunk store path of the snapshot, once the metadata is read. Empty if
+  // the snapshot does not deduplicate its chunks.
+  std::optional<std::string> chunk_store_path_ ABSL_GUARDED_BY(mu_);
 };
 
 }  // namespace data
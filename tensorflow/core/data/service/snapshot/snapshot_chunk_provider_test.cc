@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/variant_tensor_data.h"
+#include "tensorflow/core/protobuf/snapshot.pb.h"
 #include "tsl/lib/core/status_test_util.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
@@ -47,6 +48,7 @@ namespace tensorflow {
 namespace data {
 namespace {
 
+using ::testing::ElementsAre;
 using ::testing::ElementsAreArray;
 using ::testing::HasSubstr;
 using ::testing::IsEmpty;
@@ -317,6 +319,24 @@ TEST(SnapshotChunkProviderTest, SnapshotError) {
   reader_thread.reset();
 }
 
+TEST(SnapshotChunkProviderTest, ChunkStore) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string snapshot_path, CreateSnapshotDirectory());
+  experimental::DistributedSnapshotMetadata metadata;
+  metadata.set_chunk_store_path("/path/to/store");
+  TF_ASSERT_OK(AtomicallyWriteTextProto(SnapshotMetadataFilePath(snapshot_path),
+                                        metadata, tsl::Env::Default()));
+  TF_ASSERT_OK(AtomicallyWriteStringToFile(
+      tsl::io::JoinPath(CommittedChunksDirectory(snapshot_path),
+                        "chunk_0_0_0"),
+      "/path/to/store/dataset_1/chunk_2", tsl::Env::Default()));
+  TF_ASSERT_OK(SetDone(snapshot_path));
+
+  SnapshotChunkProvider snapshot_chunk_provider(snapshot_path,
+                                                tsl::Env::Default());
+  EXPECT_THAT(GetAllChunks(snapshot_chunk_provider),
+              IsOkAndHolds(ElementsAre("/path/to/store/dataset_1/chunk_2")));
+}
+
 TEST(SnapshotChunkProviderTest, Cancel) {
   TF_ASSERT_OK_AND_ASSIGN(std::string snapshot_path, CreateSnapshotDirectory());
   SnapshotChunkProvider snapshot_chunk_provider(snapshot_path,
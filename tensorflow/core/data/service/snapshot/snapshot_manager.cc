@@ -34,6 +34,7 @@ limitations under the License.
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
+#include "tensorflow/core/data/hash_utils.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/dispatcher.pb.h"
 #include "tensorflow/core/data/service/snapshot/file_utils.h"
@@ -184,11 +185,17 @@ absl::Status SnapshotManager::Start(const SnapshotRequest& request)
                                  " already exists.");
   }
   tsl::mutex_lock l(mu_);
+  metadata_ = request.metadata();
+  if (!metadata_.chunk_store_path().empty()) {
+    uint64_t dataset_fingerprint = 0;
+    TF_RETURN_IF_ERROR(
+        HashGraph(request.dataset().graph(), &dataset_fingerprint));
+    metadata_.set_dataset_fingerprint(dataset_fingerprint);
+  }
   TF_RETURN_IF_ERROR(WriteOnDiskSkeleton());
   TF_RETURN_IF_ERROR(WriteOnDiskMetadata(request));
   TF_ASSIGN_OR_RETURN(sources_, CreateSources(request.dataset()));
   TF_ASSIGN_OR_RETURN(num_total_splits_, GetSplitsCardinality());
-  metadata_ = request.metadata();
   LOG(INFO) << "Started writing tf.data distributed snapshot at " << path_;
   return absl::OkStatus();
 }
@@ -228,8 +235,8 @@ absl::Status SnapshotManager::WriteOnDiskSkeleton()
 
 absl::Status SnapshotManager::WriteOnDiskMetadata(
     const SnapshotRequest& request) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-  TF_RETURN_IF_ERROR(WriteTextProto(env_, SnapshotMetadataFilePath(path_),
-                                    request.metadata()));
+  TF_RETURN_IF_ERROR(
+      WriteTextProto(env_, SnapshotMetadataFilePath(path_), metadata_));
   TF_RETURN_IF_ERROR(WriteStringToFile(env_, DatasetSpecFilePath(path_),
                                        request.metadata().element_spec()));
   TF_RETURN_IF_ERROR(
@@ -215,6 +215,14 @@ absl::Status SnapshotStreamWriter::WriteRecord(ParallelTFRecordWriter& writer) {
 
 absl::Status SnapshotStreamWriter::Commit(
     const ParallelTFRecordWriter::FileToStatsMap& file_stats) {
+  if (!params_.chunk_store_path.empty()) {
+    // Uncommitted chunks are replaced by their references, so a restarted
+    // worker commits the references like the chunks themselves.
+    for (const auto& [file, stats] : file_stats) {
+      TF_RETURN_IF_ERROR(MoveToChunkStore(file));
+    }
+  }
+
   // Writes the checkpoint before committing the chunks. Once the checkpoint is
   // written, the chunks before the checkpoint are considered done. If the
   // worker restarts before committing the files in `file_stats`, the restarted
@@ -233,6 +241,29 @@ absl::Status SnapshotStreamWriter::Commit(
   return absl::OkStatus();
 }
 
+absl::Status SnapshotStreamWriter::MoveToChunkStore(const std::string& file) {
+  TF_ASSIGN_OR_RETURN(uint64_t content_fingerprint,
+                      FingerprintFile(file, params_.env));
+  const std::string chunk_store_file =
+      ChunkStoreFilePath(params_.chunk_store_path, params_.dataset_fingerprint,
+                         content_fingerprint);
+  absl::Status status = params_.env->FileExists(chunk_store_file);
+  if (absl::IsNotFound(status)) {
+    // Copies rather than renames the chunk, so that the uncommitted chunk
+    // exists until it is replaced by its reference.
+    TF_RETURN_IF_ERROR(params_.env->RecursivelyCreateDir(
+        std::string(tsl::io::Dirname(chunk_store_file))));
+    TF_RETURN_IF_ERROR(
+        AtomicallyCopyFile(file, chunk_store_file, params_.env));
+  } else {
+    TF_RETURN_IF_ERROR(status);
+    uint64_t file_size = 0;
+    TF_RETURN_IF_ERROR(params_.env->GetFileSize(file, &file_size));
+    metrics::RecordTFDataServiceSnapshotBytesDeduplicated(file_size);
+  }
+  return AtomicallyWriteStringToFile(file, chunk_store_file, params_.env);
+}
+
 absl::Status SnapshotStreamWriter::FinalizeStream(absl::Status status) {
   if (status.ok()) {
     status = WriteDoneFile();
@@ -73,6 +73,15 @@ struct SnapshotWriterParams {
   // snapshot. Used only for unit testing.
   bool test_only_keep_temp_files = false;
 
+  // If set, chunks are stored in the content-addressed chunk store at this
+  // path, and the committed chunks refer to them. See
+  // `DistributedSnapshotMetadata.chunk_store_path`.
+  std::string chunk_store_path;
+
+  // The fingerprint of the dataset, which namespaces its chunks in the chunk
+  // store.
+  uint64_t dataset_fingerprint = 0;
+
   std::string StreamDirectory() const {
     return tensorflow::data::StreamDirectory(snapshot_path, stream_index);
   }
@@ -117,6 +126,11 @@ struct SnapshotWriterParams {
 //       - checkpoints
 //         - checkpoint_<chunk_index>_<num_elements>
 //
+// If `chunk_store_path` is set, each chunk file is moved to
+// <chunk_store_path>/dataset_<dataset_fingerprint>/chunk_<content_fingerprint>
+// unless the store already has it, and the committed chunk file only holds
+// the path of the chunk in the store.
+//
 // This class is thread-safe.
 class SnapshotStreamWriter {
  public:
@@ -175,6 +189,10 @@ class SnapshotStreamWriter {
   // Commits the chunks since the last commit.
   absl::Status Commit(const ParallelTFRecordWriter::FileToStatsMap& file_stats);
 
+  // Replaces the uncommitted chunk `file` with a reference to the same chunk
+  // in the chunk store, adding it to the store if it is not there yet.
+  absl::Status MoveToChunkStore(const std::string& file);
+
   // Writes a DONE file when the stream is finished. Writes an ERROR file if it
   // failed.
   absl::Status FinalizeStream(absl::Status status);
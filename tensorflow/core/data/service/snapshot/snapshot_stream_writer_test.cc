@@ -148,6 +148,34 @@ absl::StatusOr<std::string> ReadStringFromFile(const std::string& filename) {
   return data;
 }
 
+// Reads a snapshot whose committed chunks refer to a chunk store.
+absl::StatusOr<std::vector<int64_t>> ReadDeduplicatedSnapshot(
+    const std::string& snapshot_path) {
+  const std::string chunks_directory = CommittedChunksDirectory(snapshot_path);
+  TF_ASSIGN_OR_RETURN(std::vector<std::string> chunks,
+                      GetChildren(chunks_directory, Env::Default()));
+  std::vector<int64_t> result;
+  for (const std::string& chunk : chunks) {
+    TF_ASSIGN_OR_RETURN(
+        std::string chunk_store_file,
+        ReadStringFromFile(tsl::io::JoinPath(chunks_directory, chunk)));
+    snapshot_util::TFRecordReader reader(chunk_store_file,
+                                         tsl::io::compression::kNone,
+                                         DataTypeVector{DT_INT64});
+    TF_RETURN_IF_ERROR(reader.Initialize(Env::Default()));
+    while (true) {
+      std::vector<Tensor> tensors;
+      absl::Status status = reader.ReadTensors(&tensors);
+      if (absl::IsOutOfRange(status)) {
+        break;
+      }
+      TF_RETURN_IF_ERROR(status);
+      result.push_back(tensors[0].unaligned_flat<int64_t>().data()[0]);
+    }
+  }
+  return result;
+}
+
 class SnapshotStreamWriterParameterizedTest
     : public ::testing::TestWithParam<std::string> {
  public:
@@ -301,6 +329,43 @@ TEST(SnapshotStreamWriterTest, EmptyDataset) {
               IsOkAndHolds(IsEmpty()));
 }
 
+TEST(SnapshotStreamWriterTest, DeduplicatesChunks) {
+  CellReader<int64_t> cell_reader(
+      "/tensorflow/data/service/snapshot_bytes_deduplicated");
+  const int64_t range = 10;
+  const uint64_t dataset_fingerprint = 123;
+  TF_ASSERT_OK_AND_ASSIGN(std::string chunk_store_path,
+                          CreateSnapshotDirectory());
+  for (int i = 0; i < 2; ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<StandaloneTaskIterator> iterator,
+                            TestIterator(testing::RangeDataset(range)));
+    TF_ASSERT_OK_AND_ASSIGN(std::string snapshot_path,
+                            CreateSnapshotDirectory());
+    // One element per chunk, so that the chunks of both snapshots match.
+    SnapshotWriterParams writer_params{snapshot_path, /*stream_index=*/0,
+                                       tsl::io::compression::kNone,
+                                       Env::Default(),
+                                       /*max_chunk_size=*/ByteSize::Bytes(1)};
+    writer_params.chunk_store_path = chunk_store_path;
+    writer_params.dataset_fingerprint = dataset_fingerprint;
+    SnapshotStreamWriter snapshot_writer(writer_params, std::move(iterator));
+    EXPECT_THAT(snapshot_writer.Wait(), IsOkAndHolds(true));
+    EXPECT_THAT(
+        ReadDeduplicatedSnapshot(snapshot_path),
+        IsOkAndHolds(UnorderedElementsAre(0, 1, 2, 3, 4, 5, 6, 7, 8, 9)));
+    if (i == 0) {
+      EXPECT_EQ(cell_reader.Delta(), 0);
+    }
+  }
+
+  // The second snapshot stores no chunks of its own.
+  const std::string dataset_directory(tsl::io::Dirname(ChunkStoreFilePath(
+      chunk_store_path, dataset_fingerprint, /*content_fingerprint=*/0)));
+  EXPECT_THAT(GetChildren(dataset_directory, Env::Default()),
+              IsOkAndHolds(SizeIs(range)));
+  EXPECT_GE(cell_reader.Delta(), 80);
+}
+
 TEST(SnapshotStreamWriterTest, Cancel) {
   const int64_t range = 10000;
   TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<StandaloneTaskIterator> iterator,
@@ -20,10 +20,13 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/data/service/byte_size.h"
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/cross_trainer_cache.h"
+#include "tensorflow/core/data/service/cross_trainer_cache_disk_tier.h"
 #include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/element_layout.h"
 #include "tensorflow/core/data/service/thread_safe_buffer.h"
 #include "tensorflow/core/data/service/worker.pb.h"
 #include "tensorflow/core/data/standalone.h"
@@ -36,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -78,10 +82,46 @@ std::shared_ptr<model::Model> StandaloneTaskIterator::model() const {
   return iterator_->model();
 }
 
+ElementLayoutTaskIterator::ElementLayoutTaskIterator(
+    std::unique_ptr<TaskIterator> iterator, const ElementLayout& layout)
+    : iterator_(std::move(iterator)), layout_(layout) {}
+
+Status ElementLayoutTaskIterator::GetNext(std::vector<Tensor>& element,
+                                          bool& end_of_sequence) {
+  TF_RETURN_IF_ERROR(iterator_->GetNext(element, end_of_sequence));
+  if (end_of_sequence) {
+    return absl::OkStatus();
+  }
+  TF_ASSIGN_OR_RETURN(element,
+                      ApplyElementLayout(layout_, std::move(element)));
+  return absl::OkStatus();
+}
+
+int64_t ElementLayoutTaskIterator::Cardinality() const {
+  return iterator_->Cardinality();
+}
+
+StatusOr<std::vector<Tensor>> ElementLayoutTaskIterator::Save() {
+  return iterator_->Save();
+}
+
+Status ElementLayoutTaskIterator::Restore(
+    const std::vector<Tensor>& saved_iterator) {
+  return iterator_->Restore(saved_iterator);
+}
+
+std::shared_ptr<model::Model> ElementLayoutTaskIterator::model() const {
+  return iterator_->model();
+}
+
 Status TaskRunner::Create(const experimental::WorkerConfig& worker_config,
                           const TaskDef& task_def,
                           std::unique_ptr<TaskIterator> iterator,
                           std::unique_ptr<TaskRunner>& out) {
+  if (task_def.has_element_layout()) {
+    iterator = std::make_unique<ElementLayoutTaskIterator>(
+        std::move(iterator), task_def.element_layout());
+  }
   if (task_def.optional_num_consumers_case() == TaskDef::kNumConsumers) {
     int64_t cardinality = iterator->Cardinality();
     if (cardinality != kInfiniteCardinality &&
@@ -100,8 +140,18 @@ Status TaskRunner::Create(const experimental::WorkerConfig& worker_config,
         worker_config.cross_trainer_cache_size_bytes() > 0
             ? worker_config.cross_trainer_cache_size_bytes()
             : kDefaultCrossTrainerCacheSizeBytes;
-    out = std::make_unique<CachingTaskRunner>(std::move(iterator),
-                                              max_cache_size_bytes);
+    std::unique_ptr<CacheOverflowTier<GetElementResult>> overflow_tier;
+    if (worker_config.cross_trainer_cache_disk_size_bytes() > 0) {
+      TF_ASSIGN_OR_RETURN(
+          overflow_tier,
+          CrossTrainerCacheDiskTier::Create(
+              Env::Default(),
+              io::JoinPath(worker_config.cross_trainer_cache_disk_dir(),
+                           absl::StrCat("task_", task_def.task_id())),
+              worker_config.cross_trainer_cache_disk_size_bytes()));
+    }
+    out = std::make_unique<CachingTaskRunner>(
+        std::move(iterator), max_cache_size_bytes, std::move(overflow_tier));
   } else {
     out = std::make_unique<FirstComeFirstServedTaskRunner>(std::move(iterator));
   }
@@ -173,11 +223,13 @@ std::shared_ptr<model::Model> FirstComeFirstServedTaskRunner::model() const {
   return model_;
 }
 
-CachingTaskRunner::CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
-                                     size_t max_cache_size_bytes)
+CachingTaskRunner::CachingTaskRunner(
+    std::unique_ptr<TaskIterator> iterator, size_t max_cache_size_bytes,
+    std::unique_ptr<CacheOverflowTier<GetElementResult>> overflow_tier)
     : fcfs_task_runner_(std::move(iterator)),
       cache_(max_cache_size_bytes,
-             std::make_unique<GetElementResultSequence>(fcfs_task_runner_)) {
+             std::make_unique<GetElementResultSequence>(fcfs_task_runner_),
+             std::move(overflow_tier)) {
   LOG(INFO) << "Initialized tf.data service cross-trainer cache with "
             << ByteSize::Bytes(max_cache_size_bytes) << " of memory.";
 }
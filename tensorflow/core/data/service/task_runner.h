@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/data_service.pb.h"
 #include "tensorflow/core/protobuf/service_config.pb.h"
 
 namespace tensorflow {
@@ -86,6 +87,24 @@ class StandaloneTaskIterator : public TaskIterator {
   std::unique_ptr<standalone::Iterator> iterator_;
 };
 
+// Implementation of TaskIterator that converts the elements of another
+// iterator to an `ElementLayout`. Runs on the threads that prefetch elements,
+// so that the conversion overlaps with serving the previous elements.
+class ElementLayoutTaskIterator : public TaskIterator {
+ public:
+  ElementLayoutTaskIterator(std::unique_ptr<TaskIterator> iterator,
+                            const ElementLayout& layout);
+  Status GetNext(std::vector<Tensor>& element, bool& end_of_sequence) override;
+  int64_t Cardinality() const override;
+  StatusOr<std::vector<Tensor>> Save() override;
+  Status Restore(const std::vector<Tensor>& saved_iterator) override;
+  std::shared_ptr<model::Model> model() const override;
+
+ private:
+  const std::unique_ptr<TaskIterator> iterator_;
+  const ElementLayout layout_;
+};
+
 // Interface for providing elements to task consumers.
 class TaskRunner {
  public:
@@ -149,11 +168,14 @@ class FirstComeFirstServedTaskRunner : public TaskRunner {
 // and caches elements in a sliding-window `CrossTrainerCache`. The cache has a
 // bounded size and progresses when a trainer that has consumed all elements in
 // the cache. Trainers read from a sliding window of the dataset and may not
-// read the full dataset.
+// read the full dataset. If `overflow_tier` is provided, elements evicted from
+// memory remain readable from it until it is full as well.
 class CachingTaskRunner : public TaskRunner {
  public:
-  explicit CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
-                             size_t max_cache_size_bytes);
+  explicit CachingTaskRunner(
+      std::unique_ptr<TaskIterator> iterator, size_t max_cache_size_bytes,
+      std::unique_ptr<CacheOverflowTier<GetElementResult>> overflow_tier =
+          nullptr);
   ~CachingTaskRunner() override;
 
   // Gets the next element from the cross-trainer cache, blocking if the data is
@@ -38,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/tstring.h"
+#include "tensorflow/core/protobuf/data_service.pb.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 
 namespace tensorflow {
@@ -303,6 +304,19 @@ TEST(FirstComeFirstServedTaskRunnerTest, Error) {
               testing::StatusIs(error::ABORTED));
 }
 
+TEST(ElementLayoutTaskIteratorTest, CastsElements) {
+  ElementLayout layout;
+  layout.add_component_dtypes(DT_FLOAT);
+  FirstComeFirstServedTaskRunner runner(
+      std::make_unique<ElementLayoutTaskIterator>(
+          std::make_unique<RangeIterator>(/*range=*/5, /*repeat=*/false),
+          layout));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::vector<float> output,
+      GetTaskRunnerOutput<float>(runner, GetElementRequest()));
+  EXPECT_THAT(output, ElementsAre(0.0, 1.0, 2.0, 3.0, 4.0));
+}
+
 TEST(CachingTaskRunnerTest, GetNext) {
   size_t range = 10;
   CachingTaskRunner runner(std::make_unique<InfiniteRangeIterator>(),
@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/worker_client.h"
 
 #include <cstdint>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <string>
@@ -95,6 +96,35 @@ std::string DataServiceWorkerClient::GetDataTransferProtocol() const {
 
 void DataServiceWorkerClient::TryCancel() { client_->TryCancel(); }
 
+namespace {
+
+// Moves the element of `resp` into `result`.
+Status ResponseToResult(GetElementResponse& resp, GetElementResult& result) {
+  result.end_of_sequence = resp.end_of_sequence();
+  result.skip = resp.skip_task();
+  switch (resp.element_case()) {
+    case GetElementResponse::kCompressed: {
+      Tensor tensor(DT_VARIANT, TensorShape{});
+      tensor.scalar<Variant>()() = std::move(resp.compressed());
+      result.components.push_back(tensor);
+      break;
+    }
+    case GetElementResponse::kUncompressed:
+      for (const auto& component : resp.uncompressed().components()) {
+        result.components.emplace_back();
+        if (!result.components.back().FromProto(component)) {
+          return errors::Internal("Failed to parse tensor.");
+        }
+      }
+      break;
+    case GetElementResponse::ELEMENT_NOT_SET:
+      break;
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
 class GrpcDataTransferClient : public DataTransferClient {
  public:
   GrpcDataTransferClient(std::shared_ptr<grpc::ChannelCredentials> credentials,
@@ -110,66 +140,57 @@ class GrpcDataTransferClient : public DataTransferClient {
                     GetElementResult& result) override {
     VLOG(3) << "GetElement for task " << req.task_id() << " from gRPC worker "
             << "server.";
-    {
-      mutex_lock l(mu_);
-      if (cancelled_) {
-        return errors::Cancelled("Client was cancelled.");
-      }
+    GetElementResponse resp;
+    TF_RETURN_IF_ERROR(Call(
+        [&](grpc::ClientContext* ctx) {
+          return stub_->GetElement(ctx, req, &resp);
+        },
+        "Failed to get element", kGrpcTransferProtocol));
+    return ResponseToResult(resp, result);
+  }
+
+  void TryCancel() override {
+    VLOG(2) << "Cancel GrpcDataTransferClient.";
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    for (const auto& ctx : active_contexts_) {
+      ctx->TryCancel();
     }
+  }
+
+ protected:
+  // Makes the call `rpc` with a context that `TryCancel` can cancel, and
+  // records its duration for `protocol`.
+  Status Call(const std::function<grpc::Status(grpc::ClientContext*)>& rpc,
+              absl::string_view error_message, absl::string_view protocol) {
     grpc::ClientContext ctx;
     gtl::Cleanup<std::function<void()>> cleanup;
     {
       mutex_lock l(mu_);
+      if (cancelled_) {
+        return errors::Cancelled("Client was cancelled.");
+      }
       active_contexts_.insert(&ctx);
       cleanup = gtl::MakeCleanup([this, &ctx] {
         mutex_lock l(mu_);
         active_contexts_.erase(&ctx);
       });
     }
-    GetElementResponse resp;
     int64_t start_time_us = env_->NowMicros();
-    grpc::Status s = stub_->GetElement(&ctx, req, &resp);
+    grpc::Status s = rpc(&ctx);
     int64_t end_time_us = env_->NowMicros();
     if (!s.ok()) {
-      return grpc_util::WrapError("Failed to get element", s);
+      return grpc_util::WrapError(std::string(error_message), s);
     }
-    metrics::RecordTFDataServiceGetElementDuration(kGrpcTransferProtocol,
+    metrics::RecordTFDataServiceGetElementDuration(protocol,
                                                    end_time_us - start_time_us);
-    result.end_of_sequence = resp.end_of_sequence();
-    result.skip = resp.skip_task();
-    switch (resp.element_case()) {
-      case GetElementResponse::kCompressed: {
-        Tensor tensor(DT_VARIANT, TensorShape{});
-        tensor.scalar<Variant>()() = std::move(resp.compressed());
-        result.components.push_back(tensor);
-        break;
-      }
-      case GetElementResponse::kUncompressed:
-        for (const auto& component : resp.uncompressed().components()) {
-          result.components.emplace_back();
-          if (!result.components.back().FromProto(component)) {
-            return errors::Internal("Failed to parse tensor.");
-          }
-        }
-        break;
-      case GetElementResponse::ELEMENT_NOT_SET:
-        break;
-    }
     return absl::OkStatus();
   }
 
-  void TryCancel() override {
-    VLOG(2) << "Cancel GrpcDataTransferClient.";
-    mutex_lock l(mu_);
-    cancelled_ = true;
-    for (const auto& ctx : active_contexts_) {
-      ctx->TryCancel();
-    }
-  }
+  std::unique_ptr<WorkerService::Stub> stub_;
 
  private:
   mutex mu_;
-  std::unique_ptr<WorkerService::Stub> stub_;
   // Set of all currently active clients contexts. Used to support
   // cancellation.
   absl::flat_hash_set<::grpc::ClientContext*> active_contexts_
@@ -196,6 +217,71 @@ class GrpcTransferClientRegistrar {
 };
 static GrpcTransferClientRegistrar gprc_client_registrar;
 
+// A gRPC client that fetches elements in batches with `GetElements`, and
+// serves them from a local buffer. Each call then pays the per-call cost of
+// gRPC once for up to `kMaxBulkElements` elements. Requests that read in
+// rounds or allow skipping are sent one at a time, as with `GetElement`.
+class GrpcBulkDataTransferClient : public GrpcDataTransferClient {
+ public:
+  // The number of elements requested by a call. The buffer is empty when the
+  // client fetches more, so all of them fit.
+  static constexpr int64_t kMaxBulkElements = 16;
+  // The size after which the worker stops adding elements to a batch.
+  static constexpr int64_t kMaxBulkBytes = 64 << 20;
+
+  using GrpcDataTransferClient::GrpcDataTransferClient;
+
+  Status GetElement(const GetElementRequest& req,
+                    GetElementResult& result) override {
+    mutex_lock l(buffer_mu_);
+    if (buffer_.empty()) {
+      GetElementsRequest bulk_req;
+      *bulk_req.mutable_request() = req;
+      bulk_req.set_max_elements(kMaxBulkElements);
+      bulk_req.set_max_bytes(kMaxBulkBytes);
+      GetElementsResponse bulk_resp;
+      TF_RETURN_IF_ERROR(Call(
+          [&](grpc::ClientContext* ctx) {
+            return stub_->GetElements(ctx, bulk_req, &bulk_resp);
+          },
+          "Failed to get elements", kGrpcBulkTransferProtocol));
+      if (bulk_resp.elements().empty()) {
+        return errors::Internal("Worker returned no elements for task ",
+                                req.task_id());
+      }
+      for (GetElementResponse& resp : *bulk_resp.mutable_elements()) {
+        buffer_.push_back(std::move(resp));
+      }
+    }
+    GetElementResponse resp = std::move(buffer_.front());
+    buffer_.pop_front();
+    return ResponseToResult(resp, result);
+  }
+
+ private:
+  mutex buffer_mu_;
+  // The elements fetched and not returned yet.
+  std::deque<GetElementResponse> buffer_ TF_GUARDED_BY(buffer_mu_);
+};
+
+class GrpcBulkTransferClientRegistrar {
+ public:
+  GrpcBulkTransferClientRegistrar() {
+    DataTransferClient::Register(
+        kGrpcBulkTransferProtocol,
+        [](DataTransferClient::Config config,
+           std::unique_ptr<DataTransferClient>* out) {
+          std::shared_ptr<grpc::ChannelCredentials> credentials;
+          TF_RETURN_IF_ERROR(CredentialsFactory::CreateClientCredentials(
+              config.protocol, &credentials));
+          *out = std::make_unique<GrpcBulkDataTransferClient>(credentials,
+                                                              config.address);
+          return absl::OkStatus();
+        });
+  }
+};
+static GrpcBulkTransferClientRegistrar grpc_bulk_client_registrar;
+
 class LocalDataTransferClient : public DataTransferClient {
  public:
   explicit LocalDataTransferClient(absl::string_view worker_address)
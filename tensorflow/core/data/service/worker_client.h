@@ -33,6 +33,8 @@ namespace data {
 
 constexpr const char kLocalTransferProtocol[] = "local";
 constexpr const char kGrpcTransferProtocol[] = "grpc";
+// Fetches elements from the gRPC worker server in batches.
+constexpr const char kGrpcBulkTransferProtocol[] = "grpc_bulk";
 
 // Client for communicating with the tf.data service worker.
 class DataServiceWorkerClient : public DataServiceClientBase {
@@ -200,6 +200,30 @@ TEST_F(WorkerClientTest, GrpcRead) {
                        MatchesRegex("Local worker.*is no longer available.*")));
 }
 
+TEST_F(WorkerClientTest, GrpcBulkRead) {
+  const int64_t range = 20;
+  TF_ASSERT_OK_AND_ASSIGN(const std::string dataset_id, RegisterDataset(range));
+  TF_ASSERT_OK_AND_ASSIGN(const int64_t iteration_client_id,
+                          CreateIteration(dataset_id));
+  TF_ASSERT_OK_AND_ASSIGN(const int64_t task_id,
+                          GetTaskToRead(iteration_client_id));
+  // Reads through gRPC rather than from the local worker.
+  LocalWorkers::Remove(GetWorkerAddress());
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DataServiceWorkerClient> client,
+                          GetWorkerClient(kGrpcBulkTransferProtocol));
+  EXPECT_EQ(client->GetDataTransferProtocol(), kGrpcBulkTransferProtocol);
+  // Spans more than one batch.
+  for (int64_t i = 0; i < range; ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(GetElementResult result,
+                            GetElement(*client, task_id));
+    test::ExpectEqual(result.components[0], Tensor(int64_t{i * i}));
+    EXPECT_FALSE(result.end_of_sequence);
+  }
+  TF_ASSERT_OK_AND_ASSIGN(GetElementResult result,
+                          GetElement(*client, task_id));
+  EXPECT_TRUE(result.end_of_sequence);
+}
+
 TEST_F(WorkerClientTest, LocalServerShutsDown) {
   TF_ASSERT_OK_AND_ASSIGN(const std::string dataset_id,
                           RegisterDataset(/*range=*/5));
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/worker_impl.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -491,6 +492,42 @@ Status DataServiceWorkerImpl::GetElement(const GetElementRequest* request,
   return absl::OkStatus();
 }
 
+Status DataServiceWorkerImpl::GetElements(const GetElementsRequest* request,
+                                          GetElementsResponse* response) {
+  VLOG(3) << "Received GetElements request for task "
+          << request->request().task_id() << " for up to "
+          << request->max_elements() << " elements";
+  // Round-robin reads and skippable reads must stay in lockstep with the
+  // other consumers, so they fetch one element at a time.
+  const GetElementRequest& element_request = request->request();
+  const bool batchable =
+      !element_request.has_consumer_index() &&
+      !element_request.has_round_index() && !element_request.allow_skip();
+  const int64_t max_elements =
+      batchable ? std::max<int64_t>(request->max_elements(), 1) : 1;
+  int64_t num_bytes = 0;
+  while (response->elements_size() < max_elements) {
+    GetElementResponse element;
+    Status s = GetElement(&element_request, &element);
+    if (!s.ok()) {
+      // Returns the elements produced so far, which would be lost otherwise.
+      // The next request reports the error.
+      if (response->elements_size() > 0) {
+        break;
+      }
+      return s;
+    }
+    num_bytes += element.ByteSizeLong();
+    const bool last = element.end_of_sequence() || element.skip_task();
+    *response->add_elements() = std::move(element);
+    if (last ||
+        (request->max_bytes() > 0 && num_bytes >= request->max_bytes())) {
+      break;
+    }
+  }
+  return absl::OkStatus();
+}
+
 Status DataServiceWorkerImpl::GetWorkerTasks(
     const GetWorkerTasksRequest* request, GetWorkerTasksResponse* response) {
   mutex_lock l(mu_);
@@ -743,15 +780,17 @@ Status DataServiceWorkerImpl::UpdateSnapshotWriters(
         &dataset_def));
     TF_ASSIGN_OR_RETURN(std::unique_ptr<StandaloneTaskIterator> iterator,
                         MakeSnapshotTaskIterator(snapshot_task, dataset_def));
+    SnapshotWriterParams params{
+        snapshot_task.base_path(), snapshot_task.stream_index(),
+        snapshot_task.metadata().compression(), Env::Default(),
+        ByteSize::Bytes(config_.snapshot_max_chunk_size_bytes())};
+    params.chunk_store_path = snapshot_task.metadata().chunk_store_path();
+    params.dataset_fingerprint =
+        snapshot_task.metadata().dataset_fingerprint();
     mutex_lock l(mu_);
     snapshot_writers_.emplace(
         snapshot_task_key,
-        std::make_unique<SnapshotStreamWriter>(
-            SnapshotWriterParams{
-                snapshot_task.base_path(), snapshot_task.stream_index(),
-                snapshot_task.metadata().compression(), Env::Default(),
-                ByteSize::Bytes(config_.snapshot_max_chunk_size_bytes())},
-            std::move(iterator)));
+        std::make_unique<SnapshotStreamWriter>(params, std::move(iterator)));
   }
 
   // Cancel writers for snapshots that are no longer assigned by the dispatcher.
@@ -849,6 +888,16 @@ std::shared_ptr<DataServiceWorkerImpl> LocalWorkers::Get(
   return it->second;
 }
 
+std::vector<std::shared_ptr<DataServiceWorkerImpl>> LocalWorkers::GetAll() {
+  tf_shared_lock l(mu_);
+  std::vector<std::shared_ptr<DataServiceWorkerImpl>> workers;
+  workers.reserve(local_workers_->size());
+  for (const auto& [address, worker] : *local_workers_) {
+    workers.push_back(worker);
+  }
+  return workers;
+}
+
 bool LocalWorkers::Empty() {
   tf_shared_lock l(mu_);
   return local_workers_->empty();
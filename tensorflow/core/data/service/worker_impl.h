@@ -80,6 +80,8 @@ class DataServiceWorkerImpl {
   /// Client-facing API.
   Status GetElement(const GetElementRequest* request,
                     GetElementResponse* response);
+  Status GetElements(const GetElementsRequest* request,
+                     GetElementsResponse* response);
   Status GetWorkerTasks(const GetWorkerTasksRequest* request,
                         GetWorkerTasksResponse* response);
   Status GetSnapshotTaskProgresses(
@@ -89,6 +91,8 @@ class DataServiceWorkerImpl {
   // Exports the worker state for debugging.
   WorkerStateExport ExportState() const;
 
+  const experimental::WorkerConfig& config() const { return config_; }
+
  private:
   struct Task {
     explicit Task(TaskDef task_def) : task_def(std::move(task_def)) {}
@@ -230,6 +234,9 @@ class LocalWorkers {
   static std::shared_ptr<DataServiceWorkerImpl> Get(
       absl::string_view worker_address);
 
+  // Gets all the local workers in the process.
+  static std::vector<std::shared_ptr<DataServiceWorkerImpl>> GetAll();
+
   // Returns if there are any local workers in the process.
   static bool Empty();
 
@@ -26,8 +26,10 @@ namespace tensorflow {
 namespace data {
 namespace {
 
+using ::testing::IsEmpty;
 using ::testing::IsNull;
 using ::testing::NotNull;
+using ::testing::SizeIs;
 
 class LocalWorkersTest : public ::testing::Test {
  protected:
@@ -52,18 +54,21 @@ TEST_F(LocalWorkersTest, AddRemoveLocalWorkers) {
   EXPECT_THAT(LocalWorkers::Get(worker_addresses[0]), NotNull());
   EXPECT_THAT(LocalWorkers::Get(worker_addresses[1]), NotNull());
   EXPECT_THAT(LocalWorkers::Get(worker_addresses[2]), NotNull());
+  EXPECT_THAT(LocalWorkers::GetAll(), SizeIs(3));
 
   test_cluster_->StopWorker(0);
   EXPECT_FALSE(LocalWorkers::Empty());
   EXPECT_THAT(LocalWorkers::Get(worker_addresses[0]), IsNull());
   EXPECT_THAT(LocalWorkers::Get(worker_addresses[1]), NotNull());
   EXPECT_THAT(LocalWorkers::Get(worker_addresses[2]), NotNull());
+  EXPECT_THAT(LocalWorkers::GetAll(), SizeIs(2));
 
   test_cluster_->StopWorkers();
   EXPECT_TRUE(LocalWorkers::Empty());
   EXPECT_THAT(LocalWorkers::Get(worker_addresses[0]), IsNull());
   EXPECT_THAT(LocalWorkers::Get(worker_addresses[1]), IsNull());
   EXPECT_THAT(LocalWorkers::Get(worker_addresses[2]), IsNull());
+  EXPECT_THAT(LocalWorkers::GetAll(), IsEmpty());
 }
 
 TEST_F(LocalWorkersTest, NoLocalWorker) {
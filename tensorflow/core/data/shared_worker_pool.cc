@@ -0,0 +1,171 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/shared_worker_pool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// The processing time credited to a client of weight 1 in each of its turns.
+constexpr double kQuantumNanos = 1e6;
+// The minimum time between two evaluations of the weight of a client.
+constexpr int64_t kWeightUpdatePeriodNanos = 100 * 1000 * 1000;
+
+}  // namespace
+
+SharedWorkerPool::SharedWorkerPool(Env* env, const std::string& thread_name,
+                                   int num_threads)
+    : env_(env) {
+  threads_.reserve(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    threads_.push_back(absl::WrapUnique(env->StartThread(
+        ThreadOptions(), thread_name, [this]() { WorkerThread(); })));
+  }
+}
+
+SharedWorkerPool::~SharedWorkerPool() {
+  {
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    work_cond_var_.notify_all();
+  }
+  // Wait for the threads to finish the pending work and exit.
+  threads_.clear();
+}
+
+SharedWorkerPool* SharedWorkerPool::Get() {
+  static SharedWorkerPool* pool = new SharedWorkerPool(
+      Env::Default(), "tf_data_shared_worker", port::MaxParallelism());
+  return pool;
+}
+
+std::unique_ptr<SharedWorkerPool::Client> SharedWorkerPool::NewClient(
+    std::function<double()> weight_func) {
+  return absl::WrapUnique(new Client(this, std::move(weight_func)));
+}
+
+void SharedWorkerPool::Schedule(ClientState* client,
+                                std::function<void()> fn) {
+  // The weight is evaluated without holding `mu_`, as `weight_func` may be
+  // arbitrarily expensive.
+  double weight = -1.0;
+  const int64_t now = env_->NowNanos();
+  if (client->weight_func &&
+      now - client->weight_update_nanos >= kWeightUpdatePeriodNanos) {
+    client->weight_update_nanos = now;
+    weight = std::clamp(client->weight_func(), 1.0,
+                        static_cast<double>(std::max(NumThreads(), 1)));
+  }
+  mutex_lock l(mu_);
+  if (weight > 0.0) {
+    client->weight = weight;
+  }
+  client->functions.push_back(std::move(fn));
+  if (!client->active) {
+    client->active = true;
+    active_clients_.push_back(client);
+  }
+  work_cond_var_.notify_one();
+}
+
+void SharedWorkerPool::RemoveClient(ClientState* client) {
+  mutex_lock l(mu_);
+  while (client->active || client->num_running > 0) {
+    done_cond_var_.wait(l);
+  }
+}
+
+void SharedWorkerPool::WorkerThread() {
+  std::function<void()> fn;
+  while (ClientState* client = NextFunction(&fn)) {
+    const int64_t start_nanos = env_->NowNanos();
+    fn();
+    // Destroy the function, and the state it captures, before the client can
+    // be removed.
+    fn = nullptr;
+    const int64_t elapsed_nanos = env_->NowNanos() - start_nanos;
+    mutex_lock l(mu_);
+    client->deficit_nanos -= elapsed_nanos;
+    --client->num_running;
+    if (!client->active && client->num_running == 0) {
+      done_cond_var_.notify_all();
+    }
+  }
+}
+
+SharedWorkerPool::ClientState* SharedWorkerPool::NextFunction(
+    std::function<void()>* fn) {
+  mutex_lock l(mu_);
+  while (true) {
+    while (!cancelled_ && active_clients_.empty()) {
+      work_cond_var_.wait(l);
+    }
+    if (active_clients_.empty()) {
+      return nullptr;
+    }
+    ClientState* client = active_clients_.front();
+    if (client->deficit_nanos <= 0.0) {
+      // The turn of the client is over. Credit it for its next turn, and move
+      // on to the next client.
+      client->deficit_nanos += kQuantumNanos * client->weight;
+      active_clients_.pop_front();
+      active_clients_.push_back(client);
+      continue;
+    }
+    *fn = std::move(client->functions.front());
+    client->functions.pop_front();
+    ++client->num_running;
+    if (client->functions.empty()) {
+      // Unused credit is not carried over to the next time the client has
+      // pending work, but overruns are.
+      client->active = false;
+      client->deficit_nanos = std::min(client->deficit_nanos, 0.0);
+      active_clients_.pop_front();
+    }
+    return client;
+  }
+}
+
+SharedWorkerPool::Client::Client(SharedWorkerPool* pool,
+                                 std::function<double()> weight_func)
+    : pool_(pool) {
+  state_.weight_func = std::move(weight_func);
+}
+
+SharedWorkerPool::Client::~Client() { pool_->RemoveClient(&state_); }
+
+void SharedWorkerPool::Client::Schedule(std::function<void()> fn) {
+  pool_->Schedule(&state_, std::move(fn));
+}
+
+std::function<void(std::function<void()>)>
+SharedWorkerPool::Client::runner() {
+  return [this](std::function<void()> fn) { Schedule(std::move(fn)); };
+}
+
+}  // namespace data
+}  // namespace tensorflow
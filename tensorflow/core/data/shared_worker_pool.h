@@ -0,0 +1,129 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SHARED_WORKER_POOL_H_
+#define TENSORFLOW_CORE_DATA_SHARED_WORKER_POOL_H_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+// A `SharedWorkerPool` runs the work of many input pipelines on a fixed number
+// of threads, so that the pipelines in a process do not oversubscribe its
+// cores.
+//
+// Each input pipeline schedules its work through its own `Client`. The pool
+// serves the clients with pending work in deficit round robin order: a client
+// is credited with a quantum of processing time proportional to its weight
+// every time its turn comes, and is charged with the measured time of every
+// function it runs. A pipeline thus receives a share of the pool proportional
+// to its weight no matter how much work it schedules.
+class SharedWorkerPool {
+ public:
+  class Client;
+
+  // Creates a pool of `num_threads` threads.
+  SharedWorkerPool(Env* env, const std::string& thread_name, int num_threads);
+
+  // Waits for the pending work of all clients to finish.
+  ~SharedWorkerPool();
+
+  // Returns the process-wide pool, which has one thread per core.
+  static SharedWorkerPool* Get();
+
+  // Returns a new client. The share of the pool of the client is proportional
+  // to the result of `weight_func`, clamped to [1, `NumThreads()`]. The weight
+  // is re-evaluated when the client schedules work, at most every 100ms.
+  // Clients must be destroyed before the pool.
+  std::unique_ptr<Client> NewClient(std::function<double()> weight_func);
+
+  int NumThreads() const { return threads_.size(); }
+
+ private:
+  struct ClientState {
+    std::function<double()> weight_func;
+    // The time at which `weight_func` was last evaluated.
+    std::atomic<int64_t> weight_update_nanos{0};
+    double weight = 1.0;
+    // Processing time, in nanoseconds, that the client can still use in its
+    // current turn. Negative if its last functions overran the turn.
+    double deficit_nanos = 0.0;
+    std::deque<std::function<void()>> functions;
+    int64_t num_running = 0;
+    bool active = false;
+  };
+
+  // Adds `fn` to the work of `client`.
+  void Schedule(ClientState* client, std::function<void()> fn);
+
+  // Waits until `client` has no pending work, and removes it from the pool.
+  void RemoveClient(ClientState* client);
+
+  void WorkerThread();
+
+  // Stores the next function to run in `fn`, and returns the client it belongs
+  // to. Returns `nullptr` once the pool is cancelled and has no pending work.
+  ClientState* NextFunction(std::function<void()>* fn) TF_LOCKS_EXCLUDED(mu_);
+
+  Env* const env_;
+  mutex mu_;
+  // Signalled when work is scheduled, or the pool is cancelled.
+  condition_variable work_cond_var_;
+  // Signalled when a function finishes running.
+  condition_variable done_cond_var_;
+  // Clients with pending work, in the order of their turns. The front
+  // client's turn is in progress.
+  std::deque<ClientState*> active_clients_ TF_GUARDED_BY(mu_);
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+  std::vector<std::unique_ptr<Thread>> threads_;
+};
+
+// A handle through which one input pipeline schedules work on a
+// `SharedWorkerPool`. The destructor waits for the work scheduled through the
+// client to finish.
+class SharedWorkerPool::Client {
+ public:
+  ~Client();
+
+  // Schedules `fn` to run on the pool.
+  void Schedule(std::function<void()> fn);
+
+  // Returns a function that schedules its argument through this client, for
+  // use as the runner of an input pipeline.
+  std::function<void(std::function<void()>)> runner();
+
+ private:
+  friend class SharedWorkerPool;
+
+  Client(SharedWorkerPool* pool, std::function<double()> weight_func);
+
+  SharedWorkerPool* const pool_;
+  ClientState state_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SHARED_WORKER_POOL_H_
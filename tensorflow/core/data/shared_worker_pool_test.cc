@@ -0,0 +1,87 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/shared_worker_pool.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+TEST(SharedWorkerPoolTest, RunsAllFunctions) {
+  SharedWorkerPool pool(Env::Default(), "test", /*num_threads=*/4);
+  std::atomic<int> count1(0);
+  std::atomic<int> count2(0);
+  {
+    auto client1 = pool.NewClient([]() { return 1.0; });
+    auto client2 = pool.NewClient([]() { return 2.0; });
+    auto runner2 = client2->runner();
+    for (int i = 0; i < 100; ++i) {
+      client1->Schedule([&count1]() { ++count1; });
+      runner2([&count2]() { ++count2; });
+    }
+    // Destroying the clients waits for their functions to run.
+  }
+  EXPECT_EQ(count1, 100);
+  EXPECT_EQ(count2, 100);
+}
+
+TEST(SharedWorkerPoolTest, SharesThreadsBetweenClients) {
+  SharedWorkerPool pool(Env::Default(), "test", /*num_threads=*/1);
+  mutex mu;
+  std::vector<int> order;
+  auto record = [&mu, &order](int client) {
+    return [&mu, &order, client]() {
+      Env::Default()->SleepForMicroseconds(200);
+      mutex_lock l(mu);
+      order.push_back(client);
+    };
+  };
+  {
+    auto client1 = pool.NewClient(nullptr);
+    auto client2 = pool.NewClient(nullptr);
+    // Keep the thread busy until the work of both clients is scheduled.
+    Notification scheduled;
+    client1->Schedule([&scheduled]() { scheduled.WaitForNotification(); });
+    for (int i = 0; i < 50; ++i) {
+      client1->Schedule(record(1));
+    }
+    for (int i = 0; i < 10; ++i) {
+      client2->Schedule(record(2));
+    }
+    scheduled.Notify();
+  }
+  ASSERT_EQ(order.size(), 60);
+  // The second client does not wait for the work of the first client, which
+  // was scheduled earlier, to finish.
+  int last_position2 = 0;
+  for (int i = 0; i < order.size(); ++i) {
+    if (order[i] == 2) {
+      last_position2 = i;
+    }
+  }
+  EXPECT_LT(last_position2, 40);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
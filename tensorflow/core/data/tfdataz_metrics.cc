@@ -20,8 +20,10 @@ limitations under the License.
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/model.h"
@@ -138,6 +140,66 @@ std::shared_ptr<model::Model> TfDatazMetricsCollector::GetModel() {
   return model_;
 }
 
+namespace {
+IteratorNodeMetrics GetNodeMetrics(const model::Node& node) {
+  IteratorNodeMetrics metrics;
+  metrics.name = node.long_name();
+  metrics.num_elements = node.num_elements();
+  metrics.self_processing_time_nsec = node.SelfProcessingTime();
+  metrics.buffered_elements = node.buffered_elements();
+  absl::StatusOr<double> parallelism =
+      node.ParameterValue(model::kParallelism);
+  if (parallelism.ok()) {
+    metrics.parallelism = *parallelism;
+  }
+  absl::StatusOr<double> buffer_size = node.ParameterValue(model::kBufferSize);
+  if (buffer_size.ok() && *buffer_size > 0) {
+    metrics.buffer_utilization =
+        static_cast<double>(metrics.buffered_elements) / *buffer_size;
+  }
+  if (metrics.self_processing_time_nsec > 0) {
+    metrics.max_throughput = EnvTime::kSecondsToNanos *
+                             metrics.parallelism.value_or(1.0) /
+                             metrics.self_processing_time_nsec;
+  }
+  return metrics;
+}
+}  // namespace
+
+std::vector<IteratorNodeMetrics>
+TfDatazMetricsCollector::GetIteratorNodeMetrics() {
+  std::vector<IteratorNodeMetrics> metrics;
+  if (model_ == nullptr) {
+    return metrics;
+  }
+  std::shared_ptr<model::Node> output = model_->output();
+  if (output == nullptr) {
+    return metrics;
+  }
+  metrics.push_back(GetNodeMetrics(*output));
+  for (const std::shared_ptr<model::Node>& node : output->CollectNodes(
+           model::TraversalOrder::BFS,
+           [](const std::shared_ptr<model::Node>) { return true; })) {
+    metrics.push_back(GetNodeMetrics(*node));
+  }
+  return metrics;
+}
+
+std::optional<IteratorNodeMetrics>
+TfDatazMetricsCollector::GetBottleneckNode() {
+  std::optional<IteratorNodeMetrics> bottleneck;
+  for (IteratorNodeMetrics& metrics : GetIteratorNodeMetrics()) {
+    if (metrics.max_throughput <= 0) {
+      continue;
+    }
+    if (!bottleneck.has_value() ||
+        metrics.max_throughput < bottleneck->max_throughput) {
+      bottleneck = std::move(metrics);
+    }
+  }
+  return bottleneck;
+}
+
 namespace {
 static mutex* get_tfdataz_metrics_registry_lock() {
   static mutex tfdataz_metrics_registry_lock(LINKER_INITIALIZED);
@@ -19,6 +19,7 @@ limitations under the License.
 #include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/time/time.h"
@@ -88,6 +89,27 @@ class ApproximateLatencyEstimator {
   int64_t latency_count_[kSlots] TF_GUARDED_BY(mu_);
 };
 
+// Point-in-time performance metrics of one node of an iterator's
+// `model::Model`.
+struct IteratorNodeMetrics {
+  // The long name of the node, e.g. "ParallelMapV2(id:3)".
+  std::string name;
+  // The number of elements produced by the node so far.
+  int64_t num_elements = 0;
+  // The average CPU time in nanoseconds spent in this node (excluding its
+  // inputs) to produce an element.
+  double self_processing_time_nsec = 0;
+  // The number of elements per second the node can produce given its self
+  // processing time and parallelism, or 0 if it has not produced any element.
+  double max_throughput = 0;
+  // The number of elements currently buffered in the node.
+  int64_t buffered_elements = 0;
+  // The fraction of the node's buffer that is full, if it has a buffer size.
+  std::optional<double> buffer_utilization;
+  // The (possibly autotuned) parallelism of the node, if it has one.
+  std::optional<double> parallelism;
+};
+
 // Collects and exports the tf.data performance metrics to /tfdataz.
 class TfDatazMetricsCollector {
  public:
@@ -120,6 +142,16 @@ class TfDatazMetricsCollector {
 
   std::shared_ptr<model::Model> GetModel();
 
+  // Returns the current metrics of all nodes of the iterator's model, starting
+  // at the output node in breadth-first order. Returns an empty vector if the
+  // iterator has no model.
+  std::vector<IteratorNodeMetrics> GetIteratorNodeMetrics();
+
+  // Returns the metrics of the node with the lowest `max_throughput`, i.e. the
+  // stage that limits the throughput of the input pipeline. Nodes which have
+  // not produced any element are ignored.
+  std::optional<IteratorNodeMetrics> GetBottleneckNode();
+
  private:
   DatasetBaseIterator* iterator_;  // not owned
   std::shared_ptr<model::Model> model_;
@@ -14,11 +14,15 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/tfdataz_metrics.h"
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <utility>
+#include <vector>
 
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/util/fake_clock_env.h"
@@ -179,6 +183,71 @@ TEST_F(TfDatazMetricsTest, GetAverageLatencyWithZeroGetNextCalls) {
                   0);
 }
 
+// Adds `node` to `model` as an input of `parent`, with `num_elements`
+// produced elements each taking `processing_time_per_element` nanoseconds.
+std::shared_ptr<model::Node> AddNode(model::Model& model,
+                                     std::shared_ptr<model::Node> node,
+                                     std::shared_ptr<model::Node> parent,
+                                     int64_t num_elements,
+                                     int64_t processing_time_per_element) {
+  model.AddNode([&node](model::Node::Args args) { return node; }, node->name(),
+                parent, &node);
+  for (int64_t i = 0; i < num_elements; ++i) {
+    node->add_processing_time(processing_time_per_element);
+    node->record_element();
+  }
+  return node;
+}
+
+TEST_F(TfDatazMetricsTest, GetIteratorNodeMetricsWithoutModel) {
+  EXPECT_TRUE(tfdataz_metrics_->GetIteratorNodeMetrics().empty());
+  EXPECT_FALSE(tfdataz_metrics_->GetBottleneckNode().has_value());
+}
+
+TEST_F(TfDatazMetricsTest, GetIteratorNodeMetrics) {
+  auto model = std::make_shared<model::Model>();
+  auto prefetch = AddNode(
+      *model,
+      model::MakeAsyncKnownRatioNode(
+          {0, "Prefetch", nullptr}, /*ratio=*/1,
+          {model::MakeNonTunableParameter(model::kBufferSize, 4)}),
+      /*parent=*/nullptr, /*num_elements=*/10,
+      /*processing_time_per_element=*/100);
+  prefetch->record_buffer_event(/*bytes_delta=*/64, /*elements_delta=*/2);
+  auto map = AddNode(
+      *model,
+      model::MakeAsyncKnownRatioNode(
+          {1, "ParallelMap", prefetch}, /*ratio=*/1,
+          {model::MakeNonTunableParameter(model::kParallelism, 2)}),
+      prefetch, /*num_elements=*/10, /*processing_time_per_element=*/2000);
+  AddNode(*model, model::MakeSourceNode({2, "Range", map}), map,
+          /*num_elements=*/10, /*processing_time_per_element=*/500);
+  tfdataz_metrics_ = std::make_unique<TfDatazMetricsCollector>(
+      *env_, iterator_.get(), model);
+
+  std::vector<IteratorNodeMetrics> metrics =
+      tfdataz_metrics_->GetIteratorNodeMetrics();
+  ASSERT_EQ(metrics.size(), 3);
+  EXPECT_EQ(metrics[0].name, "Prefetch(id:0)");
+  EXPECT_EQ(metrics[0].num_elements, 10);
+  EXPECT_EQ(metrics[0].buffered_elements, 2);
+  EXPECT_EQ(metrics[0].buffer_utilization, 0.5);
+  EXPECT_FALSE(metrics[0].parallelism.has_value());
+  EXPECT_DOUBLE_EQ(metrics[0].max_throughput, 1e7);
+  EXPECT_EQ(metrics[1].name, "ParallelMap(id:1)");
+  EXPECT_DOUBLE_EQ(metrics[1].self_processing_time_nsec, 2000);
+  EXPECT_EQ(metrics[1].parallelism, 2);
+  EXPECT_FALSE(metrics[1].buffer_utilization.has_value());
+  EXPECT_DOUBLE_EQ(metrics[1].max_throughput, 1e6);
+  EXPECT_EQ(metrics[2].name, "Range(id:2)");
+  EXPECT_DOUBLE_EQ(metrics[2].max_throughput, 2e6);
+
+  std::optional<IteratorNodeMetrics> bottleneck =
+      tfdataz_metrics_->GetBottleneckNode();
+  ASSERT_TRUE(bottleneck.has_value());
+  EXPECT_EQ(bottleneck->name, "ParallelMap(id:1)");
+}
+
 class ScopedTfDataMetricsRegistration {
  public:
   explicit ScopedTfDataMetricsRegistration(
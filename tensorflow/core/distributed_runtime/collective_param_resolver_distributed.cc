@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/collective_param_resolver_distributed.h"
 
 #include "absl/strings/escaping.h"
+#include "absl/strings/str_join.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/distributed_runtime/cancellable_call.h"
@@ -363,6 +364,50 @@ Status CollectiveParamResolverDistributed::UpdateInstanceCache(
   return ir->status;
 }
 
+string CollectiveParamResolverDistributed::InstanceSignature(
+    const CollectiveParams& cp) {
+  return strings::StrCat(
+      cp.group.group_key, ":", cp.instance.type, ":", cp.instance.data_type,
+      ":", cp.instance.shape.DebugString(), ":",
+      absl::StrJoin(cp.instance.impl_details.subdiv_offsets, ","));
+}
+
+bool CollectiveParamResolverDistributed::SignatureIsResolved(
+    const CollectiveParams& cp) {
+  mutex_lock l(signature_mu_);
+  return resolved_signatures_.contains(InstanceSignature(cp));
+}
+
+void CollectiveParamResolverDistributed::ConfirmInstanceAsync(
+    const string& device, CollectiveParams* cp) {
+  // The call outlives the op, so it is not tied to the op's cancellation.
+  CompleteInstanceCall* call = new CompleteInstanceCall(
+      cp->group, cp->instance, cp->name, device, cp->is_source,
+      /*cancel_mgr=*/nullptr, group_leader_, worker_cache_);
+  CancellationToken abortion_token =
+      abortion_cancel_mgr_.get_cancellation_token();
+  bool already_aborted = !abortion_cancel_mgr_.RegisterCallback(
+      abortion_token, [call] { call->Cancel(); });
+  if (already_aborted) {
+    delete call;
+    return;
+  }
+  cp->Ref();
+  call->Start([this, cp, call, abortion_token](Status s) {
+    abortion_cancel_mgr_.DeregisterCallback(abortion_token);
+    if (s.ok()) {
+      s = UpdateInstanceCache(cp, call->resp_);
+    }
+    if (!s.ok()) {
+      LOG(WARNING) << "Group leader failed to resolve collective instance "
+                   << cp->instance.instance_key << " of group "
+                   << cp->group.group_key << ": " << s;
+    }
+    cp->Unref();
+    delete call;
+  });
+}
+
 void CollectiveParamResolverDistributed::CompleteInstanceDistributed(
     const string& device, CollectiveParams* cp, CancellationManager* cancel_mgr,
     const StatusCallback& done) {
@@ -371,6 +416,13 @@ void CollectiveParamResolverDistributed::CompleteInstanceDistributed(
     return CompleteInstanceLocal(device, cp, done);
   } else if (InstanceIsCached(cp->group.group_key, cp->instance)) {
     return CompleteInstanceLocal(device, cp, done);
+  } else if (cp->instance.type != BROADCAST_COLLECTIVE &&
+             SignatureIsResolved(*cp)) {
+    // Only broadcast learns anything from the leader, the source rank. Other
+    // instances with a known signature, e.g. those of eager collectives
+    // that use a new instance key for every step, do not wait for it.
+    ConfirmInstanceAsync(device, cp);
+    return CompleteInstanceLocal(device, cp, done);
   } else {
     CompleteInstanceCall* call = new CompleteInstanceCall(
         cp->group, cp->instance, cp->name, device, cp->is_source, cancel_mgr,
@@ -389,6 +441,10 @@ void CollectiveParamResolverDistributed::CompleteInstanceDistributed(
       if (s.ok()) {
         s = UpdateInstanceCache(cp, call->resp_);
       }
+      if (s.ok() && cp->instance.type != BROADCAST_COLLECTIVE) {
+        mutex_lock l(signature_mu_);
+        resolved_signatures_.insert(InstanceSignature(*cp));
+      }
       if (s.ok()) {
         CompleteInstanceLocal(device, cp, done);
       } else {
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_COLLECTIVE_PARAM_RESOLVER_DISTRIBUTED_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_COLLECTIVE_PARAM_RESOLVER_DISTRIBUTED_H_
 
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/common_runtime/collective_param_resolver_local.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
@@ -87,9 +88,26 @@ class CollectiveParamResolverDistributed : public CollectiveParamResolverLocal {
                                    const StatusCallback& done)
       TF_LOCKS_EXCLUDED(instance_mu_, group_mu_);
 
+  // Returns the parameters of `cp` that the group leader checks when it
+  // resolves an instance of a collective other than broadcast, as a string.
+  static string InstanceSignature(const CollectiveParams& cp);
+
+  // Returns true iff the group leader has already resolved an instance with
+  // the signature of `cp`. Such instances need nothing from the leader, so
+  // they are completed locally without waiting for it.
+  bool SignatureIsResolved(const CollectiveParams& cp)
+      TF_LOCKS_EXCLUDED(signature_mu_);
+
+  // Resolves the instance of `cp`, already completed locally, with the group
+  // leader in the background so that the leader still sees every instance.
+  void ConfirmInstanceAsync(const string& device, CollectiveParams* cp);
+
   WorkerCacheInterface* worker_cache_;  // Not owned
   const string group_leader_;
   CancellationManager abortion_cancel_mgr_;
+  mutex signature_mu_;
+  absl::flat_hash_set<string> resolved_signatures_
+      TF_GUARDED_BY(signature_mu_);
 };
 
 }  // namespace tensorflow
@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/collective_param_resolver_distributed.h"
 
+#include <functional>
+#include <vector>
+
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/test_collective_executor_mgr.h"
@@ -28,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/util/device_name_utils.h"
 
@@ -104,6 +108,50 @@ class FakeNcclCommunicator : public NcclCommunicatorInterface {
   void StartAbort(const Status& s) override {}
 };
 
+// Holds the CompleteInstance calls that it receives while paused.
+class PausableWorker : public Worker {
+ public:
+  explicit PausableWorker(WorkerEnv* env) : Worker(env) {}
+
+  void CompleteInstanceAsync(CallOptions* opts,
+                             const CompleteInstanceRequest* request,
+                             CompleteInstanceResponse* response,
+                             StatusCallback done) override {
+    {
+      mutex_lock l(mu_);
+      if (paused_) {
+        held_.push_back([this, opts, request, response, done]() {
+          Worker::CompleteInstanceAsync(opts, request, response, done);
+        });
+        return;
+      }
+    }
+    Worker::CompleteInstanceAsync(opts, request, response, done);
+  }
+
+  void Pause() {
+    mutex_lock l(mu_);
+    paused_ = true;
+  }
+
+  void Resume() {
+    std::vector<std::function<void()>> held;
+    {
+      mutex_lock l(mu_);
+      paused_ = false;
+      held.swap(held_);
+    }
+    for (auto& call : held) {
+      call();
+    }
+  }
+
+ private:
+  mutex mu_;
+  bool paused_ TF_GUARDED_BY(mu_) = false;
+  std::vector<std::function<void()>> held_ TF_GUARDED_BY(mu_);
+};
+
 class DeviceResDistTest : public ::testing::Test {
  public:
   ~DeviceResDistTest() override {
@@ -154,7 +202,7 @@ class DeviceResDistTest : public ::testing::Test {
     worker_env->collective_executor_mgr =
         std::make_unique<TestCollectiveExecutorMgr>(
             cp_resolvers_[worker_name].get(), /*rma=*/nullptr);
-    workers_[worker_name] = std::make_unique<Worker>(worker_env.get());
+    workers_[worker_name] = std::make_unique<PausableWorker>(worker_env.get());
     worker_envs_[worker_name] = std::move(worker_env);
     wc_.AddWorker(worker_name, workers_[worker_name].get());
   }
@@ -309,7 +357,7 @@ class DeviceResDistTest : public ::testing::Test {
       cp_resolvers_;
   absl::flat_hash_map<string, std::vector<string>> dev_by_task_;
   absl::flat_hash_map<string, std::unique_ptr<WorkerEnv>> worker_envs_;
-  absl::flat_hash_map<string, std::unique_ptr<Worker>> workers_;
+  absl::flat_hash_map<string, std::unique_ptr<PausableWorker>> workers_;
   // Below are keyed by device names;
   absl::flat_hash_map<string, CollectiveParams*> cp_;
   absl::flat_hash_map<string, Status> status_;
@@ -371,6 +419,55 @@ TEST_F(DeviceResDistTest, BroadcastSourceRank3) {
   ValidateCollectiveParams(num_workers, num_devices);
 }
 
+TEST_F(DeviceResDistTest, ResolvedSignatureDoesNotWaitForLeader) {
+  const int num_workers = 2;
+  const int num_devices = 1;
+  DefineWorkers(num_workers, num_devices, "CPU", /*nccl*/ false);
+  DefineCollectiveParams(num_workers, num_devices, "CPU");
+  IssueRequests(num_workers, num_devices);
+  ValidateCollectiveParams(num_workers, num_devices);
+
+  const string leader = "/job:worker/replica:0/task:0";
+  const string task_name = "/job:worker/replica:0/task:1";
+  Device* device = nullptr;
+  TF_ASSERT_OK(device_mgrs_[task_name]->LookupDevice(
+      absl::StrCat(task_name, "/device:CPU:0"), &device));
+  workers_[leader]->Pause();
+
+  // A new instance with the shape of the resolved one completes while the
+  // leader does not answer.
+  core::RefCountPtr<CollectiveParams> same_shape(CreateCollectiveParams(
+      num_workers, num_devices, "CPU", REDUCTION_COLLECTIVE, false));
+  same_shape->instance.instance_key = 4;
+  Notification same_shape_done;
+  Status same_shape_status;
+  cp_resolvers_[task_name]->CompleteParamsAsync(
+      device->attributes(), same_shape.get(), &cm_, [&](const Status& s) {
+        same_shape_status = s;
+        same_shape_done.Notify();
+      });
+  same_shape_done.WaitForNotification();
+  TF_EXPECT_OK(same_shape_status);
+  EXPECT_EQ(same_shape->default_rank, 1);
+
+  // A new shape still waits for the leader.
+  core::RefCountPtr<CollectiveParams> new_shape(CreateCollectiveParams(
+      num_workers, num_devices, "CPU", REDUCTION_COLLECTIVE, false));
+  new_shape->instance.instance_key = 5;
+  new_shape->instance.shape = TensorShape({32});
+  Notification new_shape_done;
+  Status new_shape_status;
+  cp_resolvers_[task_name]->CompleteParamsAsync(
+      device->attributes(), new_shape.get(), &cm_, [&](const Status& s) {
+        new_shape_status = s;
+        new_shape_done.Notify();
+      });
+  EXPECT_FALSE(new_shape_done.WaitForNotificationWithTimeout(100000));
+  workers_[leader]->Resume();
+  new_shape_done.WaitForNotification();
+  TF_EXPECT_OK(new_shape_status);
+}
+
 TEST_F(DeviceResDistTest, Workers4Devices3) {
   const int num_workers = 4;
   const int num_devices = 3;
@@ -318,6 +318,30 @@ Status GraphMgr::Register(const string& handle, const GraphDef& gdef,
   return absl::OkStatus();
 }
 
+Status GraphMgr::RegisterStepTemplate(
+    int64_t id, std::shared_ptr<const StepTemplate> step_template) {
+  mutex_lock l(mu_);
+  if (table_.find(step_template->graph_handle) == table_.end()) {
+    return errors::Aborted("Graph handle is not found: ",
+                           step_template->graph_handle,
+                           ". Possibly, this worker just restarted.");
+  }
+  step_templates_[id] = std::move(step_template);
+  return absl::OkStatus();
+}
+
+Status GraphMgr::LookupStepTemplate(
+    int64_t id, std::shared_ptr<const StepTemplate>* step_template) {
+  mutex_lock l(mu_);
+  auto iter = step_templates_.find(id);
+  if (iter == step_templates_.end()) {
+    return errors::Aborted("Step template is not found: ", id,
+                           ". Possibly, this worker just restarted.");
+  }
+  *step_template = iter->second;
+  return absl::OkStatus();
+}
+
 Status GraphMgr::Deregister(const string& handle) {
   Item* item = nullptr;
   // Removes one item from table_.
@@ -330,6 +354,13 @@ Status GraphMgr::Deregister(const string& handle) {
     }
     item = iter->second;
     table_.erase(iter);
+    for (auto it = step_templates_.begin(); it != step_templates_.end();) {
+      if (it->second->graph_handle == handle) {
+        step_templates_.erase(it++);
+      } else {
+        ++it;
+      }
+    }
   }
   item->Unref();
   return absl::OkStatus();
@@ -344,6 +375,7 @@ Status GraphMgr::DeregisterAll() {
       items.push_back(entry.second);
     }
     table_.clear();
+    step_templates_.clear();
   }
   for (auto item : items) {
     item->Unref();
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_GRAPH_MGR_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_GRAPH_MGR_H_
 
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
@@ -105,6 +106,26 @@ class GraphMgr {
   void RecvOutputsAsync(const int64_t step_id, NamedTensors* out,
                         StatusCallback done);
 
+  // The parts of a RunGraph request that stay the same across the steps of
+  // a registered graph. See `RunGraphRequest.step_template_id`.
+  struct StepTemplate {
+    string graph_handle;
+    ExecutorOpts exec_opts;
+    // The keys the send values of a step are fed to, in order.
+    std::vector<string> send_keys;
+    // The keys the step receives upon finish, each mapped to an empty tensor.
+    NamedTensors recvs;
+  };
+
+  // Records `step_template` under `id`, replacing any earlier template with
+  // the same id. The template is dropped when its graph is deregistered.
+  Status RegisterStepTemplate(
+      int64_t id, std::shared_ptr<const StepTemplate> step_template);
+
+  // Returns the template recorded under `id` in `*step_template`.
+  Status LookupStepTemplate(
+      int64_t id, std::shared_ptr<const StepTemplate>* step_template);
+
   // Deregisters a graph.
   Status Deregister(const string& handle);
 
@@ -172,6 +193,10 @@ class GraphMgr {
   // mechanism to gc these graphs.
   std::unordered_map<string, Item*> table_;
 
+  // Table mapping step template ids to the templates of registered graphs.
+  std::unordered_map<int64_t, std::shared_ptr<const StepTemplate>>
+      step_templates_ TF_GUARDED_BY(mu_);
+
   void StartParallelExecutors(
       const string& handle, int64_t step_id, Item* item, Rendezvous* rendezvous,
       CollectiveExecutor::Handle* ce_handle, StepStatsCollector* collector,
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/master_session.h"
 
 #include <algorithm>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <string>
@@ -90,7 +91,14 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
         worker_cache_(worker_cache),
         should_deregister_(should_deregister),
         collective_graph_key_(
-            client_graph_before_register_->collective_graph_key) {
+            client_graph_before_register_->collective_graph_key),
+        pipeline_steps_(
+            !is_partial &&
+            session_opts.config.experimental().pipeline_partition_steps() &&
+            collective_graph_key_ == BuildGraphOptions::kNoCollectiveGraphKey),
+        use_step_templates_(
+            !is_partial &&
+            session_opts.config.experimental().use_run_graph_step_templates()) {
     VLOG(1) << "Created ReffedClientGraph for node with "
             << client_graph_before_register_->graph.num_node_ids();
 
@@ -222,6 +230,15 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
   // `done` when all cleanup RPCs have completed.
   void CleanupPartitionsAsync(int64_t step_id, StatusCallback done);
 
+  // Runs `fn` once the partitions of step `step_id` that run on after the
+  // step returned are done, or right away if there are none. See
+  // ConfigProto.Experimental.pipeline_partition_steps.
+  void AfterPipelinedTail(int64_t step_id, std::function<void()> fn);
+
+  // Blocks until no partition of an earlier step runs on after its step
+  // returned.
+  void WaitForPipelinedTails();
+
   // Post-processing of any runtime statistics gathered during execution.
   void ProcessStats(int64_t step_id, PerStepState* pss, ProfileHandler* ph,
                     const RunOptions& options, RunMetadata* resp);
@@ -256,6 +273,31 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
   const int64_t collective_graph_key_;
   std::atomic<int64_t> execution_count_ = {0};
 
+  // If true, the partitions that produce no fetches run on after their step
+  // returned, and the RunGraph calls of every partition are issued in step
+  // order, one at a time.
+  const bool pipeline_steps_;
+  struct PartitionQueue {
+    bool running = false;
+    std::deque<std::function<void()>> waiting;
+  };
+  mutex pipeline_mu_;
+  condition_variable pipeline_cv_;
+  std::vector<PartitionQueue> partition_queues_ TF_GUARDED_BY(pipeline_mu_);
+  // Maps the steps whose tail partitions are running to the callbacks to run
+  // once they are done.
+  std::unordered_map<int64_t, std::vector<std::function<void()>>>
+      running_tails_ TF_GUARDED_BY(pipeline_mu_);
+  // The first error of a tail partition, returned by the next step.
+  Status tail_status_ TF_GUARDED_BY(pipeline_mu_);
+
+  // If true, the partitions are run through step templates on the workers.
+  // See ConfigProto.Experimental.use_run_graph_step_templates.
+  const bool use_step_templates_;
+  // The i-th entry is set once the worker of partition i recorded its step
+  // template.
+  std::unique_ptr<std::atomic<bool>[]> step_template_ready_;
+
   // Graph partitioned into per-location subgraphs.
   struct Part {
     // Worker name.
@@ -274,6 +316,10 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
     // this partition on the worker.
     string graph_handle;
 
+    // If non-zero, the id of the step template of this partition on the
+    // worker.
+    int64_t step_template_id = 0;
+
     Part() : feed_key(3), key_fetch(3) {}
   };
 
@@ -336,6 +382,20 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
   // destructor and does not wait for the rpc completion.
   void DeregisterPartitions();
 
+  // Issues `launch`, the RunGraph call of partition `i`, once the calls of
+  // the partition for earlier steps are done. Appends it to `ready` if it
+  // can be issued right away.
+  void EnqueueRunGraphLocked(int i, std::function<void()> launch,
+                             std::vector<std::function<void()>>* ready)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(pipeline_mu_);
+
+  // Issues the next waiting RunGraph call of partition `i`, if any.
+  void RunNextGraph(int i) TF_LOCKS_EXCLUDED(pipeline_mu_);
+
+  // Called when the tail partitions of step `step_id` are done.
+  void FinishPipelinedTail(int64_t step_id, const Status& s)
+      TF_LOCKS_EXCLUDED(pipeline_mu_);
+
   ReffedClientGraph(const ReffedClientGraph&) = delete;
   void operator=(const ReffedClientGraph&) = delete;
 };
@@ -502,6 +562,14 @@ Status MasterSession::ReffedClientGraph::DoRegisterPartitions(
     s.Update(c->status);
     partitions_[i].graph_handle = c->resp.graph_handle();
   }
+  if (s.ok() && use_step_templates_) {
+    step_template_ready_.reset(new std::atomic<bool>[num]);
+    for (int i = 0; i < num; ++i) {
+      step_template_ready_[i] = false;
+      partitions_[i].step_template_id =
+          static_cast<int64_t>(random::New64() >> 1) | 1;
+    }
+  }
   return s;
 }
 
@@ -520,6 +588,8 @@ class RunManyGraphs {
     std::atomic<bool> done{false};
     std::unique_ptr<MutableRunGraphRequestWrapper> req;
     std::unique_ptr<MutableRunGraphResponseWrapper> resp;
+    // If not null, set once the call succeeded.
+    std::atomic<bool>* step_template_ready = nullptr;
   };
   Call* get(int index) { return &calls_[index]; }
 
@@ -540,6 +610,8 @@ class RunManyGraphs {
       mutex_lock l(mu_);
       ReportBadStatus(errors::CreateWithUpdatedMessage(
           s, strings::StrCat("From ", *call->worker_name, ":\n", s.message())));
+    } else if (call->step_template_ready != nullptr) {
+      *call->step_template_ready = true;
     }
     pending_.DecrementCount();
   }
@@ -615,6 +687,17 @@ class RunManyGraphs {
   void operator=(const RunManyGraphs&) = delete;
 };
 
+// The RunGraph calls of the partitions of a pipelined step that produce no
+// fetches, which run on after the step returned.
+struct PipelinedTail {
+  explicit PipelinedTail(int num) : calls(num), pending(num) {}
+
+  RunManyGraphs calls;
+  std::atomic<int> pending;
+  CancellationManager* cm = nullptr;
+  CancellationToken token = CancellationManager::kInvalidToken;
+};
+
 Status AddSendFromClientRequest(const RunStepRequestWrapper& client_req,
                                 MutableRunGraphRequestWrapper* worker_req,
                                 size_t index, const string& send_key) {
@@ -673,11 +756,58 @@ Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
   }
 
   const int num = partitions_.size();
-  RunManyGraphs calls(num);
+  const bool pipelined = pipeline_steps_ && !pss->collect_costs &&
+                         !pss->collect_timeline &&
+                         !pss->collect_partition_graphs;
+  if (pipelined) {
+    mutex_lock l(pipeline_mu_);
+    // A step starts while the tail of at most one earlier step runs.
+    while (running_tails_.size() > 1) {
+      pipeline_cv_.wait(l);
+    }
+    if (!tail_status_.ok()) {
+      Status s = tail_status_;
+      tail_status_ = absl::OkStatus();
+      return errors::CreateWithUpdatedMessage(
+          s, strings::StrCat("A partition of an earlier step failed: ",
+                             s.message()));
+    }
+    if (partition_queues_.empty()) {
+      partition_queues_.resize(num);
+    }
+  }
+
+  // In pipelined mode, only the partitions that produce fetches are waited
+  // for. `call_index[i]` is the index of the call of partition i in `calls`,
+  // or in `tail->calls` if the partition is part of the tail.
+  std::vector<int> call_index(num);
+  std::vector<bool> in_tail(num, false);
+  int num_head = 0;
+  int num_tail = 0;
+  for (int i = 0; i < num; ++i) {
+    in_tail[i] = pipelined && partitions_[i].key_fetch.empty();
+    call_index[i] = in_tail[i] ? num_tail++ : num_head++;
+  }
+  RunManyGraphs calls(num_head);
+  std::shared_ptr<PipelinedTail> tail;
+  if (num_tail > 0) {
+    tail = std::make_shared<PipelinedTail>(num_tail);
+  }
+  auto get_call = [&calls, &tail, &call_index, &in_tail](int i) {
+    return in_tail[i] ? tail->calls.get(call_index[i])
+                      : calls.get(call_index[i]);
+  };
+
+  // Only steps with the default executor options run through step
+  // templates. Once the worker recorded the template of a partition, the
+  // request carries just the template id and the feed values.
+  const bool use_step_template =
+      use_step_templates_ && exec_opts.ByteSizeLong() == 0;
+  static const string* const kNoSendKey = new string;
 
   for (int i = 0; i < num; ++i) {
     const Part& part = partitions_[i];
-    RunManyGraphs::Call* c = calls.get(i);
+    RunManyGraphs::Call* c = get_call(i);
     c->worker_name = &part.name;
     c->req.reset(part.worker->CreateRunGraphRequest());
     c->resp.reset(part.worker->CreateRunGraphResponse());
@@ -685,11 +815,21 @@ Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
       c->req->set_is_partial(is_partial_);
       c->req->set_is_last_partial_run(is_last_partial_run);
     }
+    const bool template_ready =
+        use_step_template && step_template_ready_[i].load();
     c->req->set_session_handle(session_handle_);
     c->req->set_create_worker_session_called(!should_deregister_);
-    c->req->set_graph_handle(part.graph_handle);
+    if (!template_ready) {
+      c->req->set_graph_handle(part.graph_handle);
+      *c->req->mutable_exec_opts() = exec_opts;
+    }
+    if (use_step_template) {
+      c->req->set_step_template_id(part.step_template_id);
+      if (!template_ready) {
+        c->step_template_ready = &step_template_ready_[i];
+      }
+    }
     c->req->set_step_id(step_id);
-    *c->req->mutable_exec_opts() = exec_opts;
     c->req->set_store_errors_in_response_body(true);
     c->req->set_request_id(GetUniqueRequestId());
     // If any feeds are provided, send the feed values together
@@ -728,24 +868,84 @@ Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
           return errors::Internal("No feed index found for feed: ", feed);
         }
         const int64_t feed_index = iter->second;
-        TF_RETURN_IF_ERROR(
-            AddSendFromClientRequest(req, c->req.get(), feed_index, key));
+        TF_RETURN_IF_ERROR(AddSendFromClientRequest(
+            req, c->req.get(), feed_index, template_ready ? *kNoSendKey : key));
       }
-      for (const auto& key_fetch : part.key_fetch) {
-        const string& key = key_fetch.first;
-        c->req->add_recv_key(key);
+      if (!template_ready) {
+        for (const auto& key_fetch : part.key_fetch) {
+          const string& key = key_fetch.first;
+          c->req->add_recv_key(key);
+        }
       }
     }
   }
 
   // Issues RunGraph calls.
-  for (int i = 0; i < num; ++i) {
-    const Part& part = partitions_[i];
-    RunManyGraphs::Call* call = calls.get(i);
-    TRACEPRINTF("Partition %d %s", i, part.name.c_str());
-    part.worker->RunGraphAsync(
-        &call->opts, call->req.get(), call->resp.get(),
-        std::bind(&RunManyGraphs::WhenDone, &calls, i, std::placeholders::_1));
+  if (!pipelined) {
+    for (int i = 0; i < num; ++i) {
+      const Part& part = partitions_[i];
+      RunManyGraphs::Call* call = calls.get(i);
+      TRACEPRINTF("Partition %d %s", i, part.name.c_str());
+      part.worker->RunGraphAsync(
+          &call->opts, call->req.get(), call->resp.get(),
+          std::bind(&RunManyGraphs::WhenDone, &calls, i,
+                    std::placeholders::_1));
+    }
+  } else {
+    if (tail) {
+      // The tail outlives this call, so it holds a reference to the graph.
+      Ref();
+      tail->cm = cm;
+      tail->token = cm->get_cancellation_token();
+      if (!cm->RegisterCallback(tail->token,
+                                [tail]() { tail->calls.StartCancel(); })) {
+        tail->token = CancellationManager::kInvalidToken;
+        tail->calls.StartCancel();
+      }
+    }
+    std::vector<std::function<void()>> ready;
+    {
+      // The calls of a step are enqueued on all partitions at once, so that
+      // all partitions see the steps in the same order.
+      mutex_lock l(pipeline_mu_);
+      if (tail) {
+        running_tails_[step_id];
+      }
+      for (int i = 0; i < num; ++i) {
+        const Part& part = partitions_[i];
+        RunManyGraphs::Call* call = get_call(i);
+        const int index = call_index[i];
+        StatusCallback done;
+        if (in_tail[i]) {
+          done = [this, tail, i, index, step_id](const Status& s) {
+            RunNextGraph(i);
+            tail->calls.WhenDone(index, s);
+            if (--tail->pending == 0) {
+              if (tail->token != CancellationManager::kInvalidToken) {
+                tail->cm->TryDeregisterCallback(tail->token);
+              }
+              FinishPipelinedTail(step_id, tail->calls.status());
+            }
+          };
+        } else {
+          done = [this, &calls, i, index](const Status& s) {
+            RunNextGraph(i);
+            calls.WhenDone(index, s);
+          };
+        }
+        WorkerInterface* worker = part.worker;
+        EnqueueRunGraphLocked(
+            i,
+            [worker, call, done = std::move(done)]() {
+              worker->RunGraphAsync(&call->opts, call->req.get(),
+                                    call->resp.get(), done);
+            },
+            &ready);
+      }
+    }
+    for (auto& launch : ready) {
+      launch();
+    }
   }
 
   // Waits for the RunGraph calls.
@@ -767,13 +967,18 @@ Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
   } else {
     return errors::Cancelled("Step was cancelled");
   }
+  if (tail && !calls.status().ok()) {
+    tail->calls.StartCancel();
+  }
   TF_RETURN_IF_ERROR(calls.status());
 
   // Collects fetches and metadata.
   Status status;
   for (int i = 0; i < num; ++i) {
+    if (in_tail[i]) continue;
     const Part& part = partitions_[i];
-    MutableRunGraphResponseWrapper* run_graph_resp = calls.get(i)->resp.get();
+    MutableRunGraphResponseWrapper* run_graph_resp =
+        calls.get(call_index[i])->resp.get();
     for (size_t j = 0; j < run_graph_resp->num_recvs(); ++j) {
       auto iter = part.key_fetch.find(run_graph_resp->recv_key(j));
       if (iter == part.key_fetch.end()) {
@@ -810,6 +1015,76 @@ Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
   return status;
 }
 
+void MasterSession::ReffedClientGraph::EnqueueRunGraphLocked(
+    int i, std::function<void()> launch,
+    std::vector<std::function<void()>>* ready) {
+  PartitionQueue& queue = partition_queues_[i];
+  if (queue.running) {
+    queue.waiting.push_back(std::move(launch));
+  } else {
+    queue.running = true;
+    ready->push_back(std::move(launch));
+  }
+}
+
+void MasterSession::ReffedClientGraph::RunNextGraph(int i) {
+  std::function<void()> next;
+  {
+    mutex_lock l(pipeline_mu_);
+    PartitionQueue& queue = partition_queues_[i];
+    if (queue.waiting.empty()) {
+      queue.running = false;
+      return;
+    }
+    next = std::move(queue.waiting.front());
+    queue.waiting.pop_front();
+  }
+  next();
+}
+
+void MasterSession::ReffedClientGraph::FinishPipelinedTail(int64_t step_id,
+                                                           const Status& s) {
+  if (!s.ok()) {
+    LOG(WARNING) << "A partition of step " << step_id
+                 << " failed after the step returned: " << s;
+  }
+  std::vector<std::function<void()>> callbacks;
+  {
+    mutex_lock l(pipeline_mu_);
+    if (!s.ok() && tail_status_.ok()) {
+      tail_status_ = s;
+    }
+    auto it = running_tails_.find(step_id);
+    callbacks = std::move(it->second);
+    running_tails_.erase(it);
+    pipeline_cv_.notify_all();
+  }
+  for (auto& callback : callbacks) {
+    callback();
+  }
+  Unref();
+}
+
+void MasterSession::ReffedClientGraph::AfterPipelinedTail(
+    int64_t step_id, std::function<void()> fn) {
+  {
+    mutex_lock l(pipeline_mu_);
+    auto it = running_tails_.find(step_id);
+    if (it != running_tails_.end()) {
+      it->second.push_back(std::move(fn));
+      return;
+    }
+  }
+  fn();
+}
+
+void MasterSession::ReffedClientGraph::WaitForPipelinedTails() {
+  mutex_lock l(pipeline_mu_);
+  while (!running_tails_.empty()) {
+    pipeline_cv_.wait(l);
+  }
+}
+
 Status MasterSession::ReffedClientGraph::RunPartitions(
     const MasterEnv* env, int64_t step_id, int64_t execution_count,
     PerStepState* pss, CallOptions* call_opts, const RunStepRequestWrapper& req,
@@ -1755,6 +2030,7 @@ Status MasterSession::DoPartialRun(CallOptions* opts,
 
   // If this is the first partial run, initialize the PerStepState.
   if (!run_state->step_started) {
+    WaitForOtherPipelinedTails(run_state->rcg);
     run_state->step_started = true;
     PerStepState pss;
 
@@ -1951,17 +2227,42 @@ Status MasterSession::PostRunCleanup(MasterSession::ReffedClientGraph* rcg,
   }
   Ref();
   rcg->Ref();
-  rcg->CleanupPartitionsAsync(step_id, [this, rcg](const Status& s) {
-    if (!s.ok()) {
-      LOG(ERROR) << "Cleanup partition error: " << s;
-    }
-    rcg->Unref();
-    MarkRunCompletion();
-    Unref();
+  // The partitions of a pipelined step may still be running.
+  rcg->AfterPipelinedTail(step_id, [this, rcg, step_id]() {
+    rcg->CleanupPartitionsAsync(step_id, [this, rcg](const Status& s) {
+      if (!s.ok()) {
+        LOG(ERROR) << "Cleanup partition error: " << s;
+      }
+      rcg->Unref();
+      MarkRunCompletion();
+      Unref();
+    });
   });
   return s;
 }
 
+void MasterSession::WaitForOtherPipelinedTails(ReffedClientGraph* rcg) {
+  if (!session_opts_.config.experimental().pipeline_partition_steps()) {
+    return;
+  }
+  std::vector<ReffedClientGraph*> others;
+  {
+    mutex_lock l(mu_);
+    for (const RCGMap* rcg_map : {&run_graphs_, &callables_}) {
+      for (const auto& entry : *rcg_map) {
+        if (entry.second != rcg) {
+          entry.second->Ref();
+          others.push_back(entry.second);
+        }
+      }
+    }
+  }
+  for (ReffedClientGraph* other : others) {
+    other->WaitForPipelinedTails();
+    other->Unref();
+  }
+}
+
 Status MasterSession::DoRunWithLocalExecution(
     CallOptions* opts, const RunStepRequestWrapper& req,
     MutableRunStepResponseWrapper* resp) {
@@ -1979,6 +2280,7 @@ Status MasterSession::DoRunWithLocalExecution(
 
   // Unref "rcg" when out of scope.
   core::ScopedUnref unref(rcg);
+  WaitForOtherPipelinedTails(rcg);
 
   std::unique_ptr<DebuggerStateInterface> debugger_state;
   const DebugOptions& debug_options = req.options().debug_options();
@@ -2061,6 +2363,7 @@ Status MasterSession::DoRunCallable(CallOptions* opts, ReffedClientGraph* rcg,
   auto cleanup = gtl::MakeCleanup([this] { MarkRunCompletion(); });
 
   // Prepare.
+  WaitForOtherPipelinedTails(rcg);
   int64_t count = rcg->get_and_increment_execution_count();
 
   const uint64 step_id = NewStepId(rcg->collective_graph_key());
@@ -247,6 +247,11 @@ class MasterSession : public core::RefCounted {
   void MarkRunCompletion();
   void UpdateLastAccessTime();
 
+  // With ConfigProto.Experimental.pipeline_partition_steps, blocks until the
+  // partitions of the steps of graphs other than `rcg` that run on after
+  // their step returned are done, so that `rcg` sees their updates.
+  void WaitForOtherPipelinedTails(ReffedClientGraph* rcg);
+
   Status BuildAndRegisterPartitions(ReffedClientGraph* rcg);
 
   Status CreateDebuggerState(
@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/graph/testlib.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
@@ -425,4 +426,88 @@ TEST_F(MasterTest, EigenProblem) {
   TF_EXPECT_OK(CloseSession(handle));
 }
 
+TEST_F(MasterTest, PipelinedStepsSeeEarlierUpdates) {
+  // The variable and its update are placed on task 1, whose partition
+  // produces no fetch and therefore runs on after each step returns.
+  const string ps = "/job:localhost/replica:0/task:1/cpu:0";
+  Graph graph(OpRegistry::Global());
+  Node* var = test::graph::Var(&graph, DT_FLOAT, TensorShape({}));
+  Node* zero = test::graph::Constant(&graph, test::AsScalar<float>(0));
+  Node* init = test::graph::Assign(&graph, var, zero);
+  Node* one = test::graph::Constant(&graph, test::AsScalar<float>(1));
+  Node* add;
+  TF_ASSERT_OK(NodeBuilder(graph.NewName("n"), "AssignAdd")
+                   .Input(var)
+                   .Input(one)
+                   .Finalize(&graph, &add));
+  for (Node* n : {var, zero, init, one, add}) {
+    n->set_requested_device(ps);
+  }
+  // Reads the updated value on task 0.
+  Node* read = test::graph::Identity(&graph, add);
+  read->set_requested_device("/job:localhost/replica:0/task:0/cpu:0");
+
+  GraphDef def;
+  test::graph::ToGraphDef(&graph, &def);
+  string handle;
+  {
+    ::grpc::ClientContext ctx;
+    CreateSessionRequest req;
+    *req.mutable_graph_def() = def;
+    req.mutable_config()->mutable_experimental()->set_pipeline_partition_steps(
+        true);
+    CreateSessionResponse resp;
+    TF_ASSERT_OK(FromGrpcStatus(master_->CreateSession(&ctx, req, &resp)));
+    handle = resp.session_handle();
+  }
+
+  Tensor value;
+  TF_ASSERT_OK(RunStep(handle, {}, {{init->name() + ":0", &value}}));
+  for (int step = 1; step <= 10; ++step) {
+    TF_ASSERT_OK(RunStep(handle, {}, {{read->name() + ":0", &value}}));
+    EXPECT_EQ(value.scalar<float>()(), step);
+  }
+  TF_EXPECT_OK(CloseSession(handle));
+}
+
+TEST_F(MasterTest, StepTemplates) {
+  // Feeds and fetches on both tasks, so that every partition has send and
+  // recv keys in its step template.
+  Graph graph(OpRegistry::Global());
+  Node* x = test::graph::Constant(&graph, test::AsScalar<float>(0));
+  x->set_requested_device("/job:localhost/replica:0/task:1/cpu:0");
+  Node* y = test::graph::Add(&graph, x, x);
+  y->set_requested_device("/job:localhost/replica:0/task:1/cpu:0");
+  Node* z = test::graph::Add(&graph, y, x);
+  z->set_requested_device("/job:localhost/replica:0/task:0/cpu:0");
+
+  GraphDef def;
+  test::graph::ToGraphDef(&graph, &def);
+  string handle;
+  {
+    ::grpc::ClientContext ctx;
+    CreateSessionRequest req;
+    *req.mutable_graph_def() = def;
+    req.mutable_config()
+        ->mutable_experimental()
+        ->set_use_run_graph_step_templates(true);
+    CreateSessionResponse resp;
+    TF_ASSERT_OK(FromGrpcStatus(master_->CreateSession(&ctx, req, &resp)));
+    handle = resp.session_handle();
+  }
+
+  // The first step records the templates, the later ones run them.
+  for (int step = 1; step <= 5; ++step) {
+    Tensor x_value = test::AsScalar<float>(step);
+    Tensor y_value;
+    Tensor z_value;
+    TF_ASSERT_OK(RunStep(
+        handle, {{x->name(), &x_value}},
+        {{y->name() + ":0", &y_value}, {z->name() + ":0", &z_value}}));
+    EXPECT_EQ(y_value.scalar<float>()(), 2 * step);
+    EXPECT_EQ(z_value.scalar<float>()(), 3 * step);
+  }
+  TF_EXPECT_OK(CloseSession(handle));
+}
+
 }  // namespace tensorflow
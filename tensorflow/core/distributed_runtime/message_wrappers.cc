@@ -398,6 +398,14 @@ void InMemoryRunGraphRequest::set_request_id(int64_t request_id) {
   request_id_ = request_id;
 }
 
+int64_t InMemoryRunGraphRequest::step_template_id() const {
+  return step_template_id_;
+}
+
+void InMemoryRunGraphRequest::set_step_template_id(int64_t step_template_id) {
+  step_template_id_ = step_template_id;
+}
+
 const RunGraphRequest& InMemoryRunGraphRequest::ToProto() const {
   if (!proto_version_) {
     proto_version_.reset(new RunGraphRequest);
@@ -417,6 +425,7 @@ const RunGraphRequest& InMemoryRunGraphRequest::ToProto() const {
     }
     proto_version_->set_is_partial(is_partial());
     proto_version_->set_is_last_partial_run(is_last_partial_run());
+    proto_version_->set_step_template_id(step_template_id());
   }
   proto_version_->set_store_errors_in_response_body(
       store_errors_in_response_body_);
@@ -546,6 +555,15 @@ void MutableProtoRunGraphRequest::set_request_id(int64_t request_id) {
   request_.set_request_id(request_id);
 }
 
+int64_t MutableProtoRunGraphRequest::step_template_id() const {
+  return request_.step_template_id();
+}
+
+void MutableProtoRunGraphRequest::set_step_template_id(
+    int64_t step_template_id) {
+  request_.set_step_template_id(step_template_id);
+}
+
 const RunGraphRequest& MutableProtoRunGraphRequest::ToProto() const {
   return request_;
 }
@@ -607,6 +625,10 @@ int64_t ProtoRunGraphRequest::request_id() const {
   return request_->request_id();
 }
 
+int64_t ProtoRunGraphRequest::step_template_id() const {
+  return request_->step_template_id();
+}
+
 const RunGraphRequest& ProtoRunGraphRequest::ToProto() const {
   return *request_;
 }
@@ -298,6 +298,10 @@ class RunGraphRequestWrapper {
 
   virtual int64_t request_id() const = 0;
 
+  // If non-zero, the step template this request records or runs. See
+  // `RunGraphRequest.step_template_id` for details.
+  virtual int64_t step_template_id() const = 0;
+
   // Returns the wrapped data as a protocol buffer message.
   virtual const RunGraphRequest& ToProto() const = 0;
 };
@@ -327,6 +331,7 @@ class MutableRunGraphRequestWrapper : public RunGraphRequestWrapper {
   virtual void set_is_last_partial_run(bool is_last_partial_run) = 0;
   virtual void set_store_errors_in_response_body(bool store_errors) = 0;
   virtual void set_request_id(int64_t request_id) = 0;
+  virtual void set_step_template_id(int64_t step_template_id) = 0;
 };
 
 class InMemoryRunGraphRequest : public MutableRunGraphRequestWrapper {
@@ -347,6 +352,7 @@ class InMemoryRunGraphRequest : public MutableRunGraphRequestWrapper {
   const RunGraphRequest& ToProto() const override;
   bool store_errors_in_response_body() const override;
   int64_t request_id() const override;
+  int64_t step_template_id() const override;
 
   // MutableRunGraphRequestWrapper methods.
   void set_session_handle(const string& handle) override;
@@ -365,6 +371,7 @@ class InMemoryRunGraphRequest : public MutableRunGraphRequestWrapper {
   void set_is_last_partial_run(bool is_last_partial_run) override;
   void set_store_errors_in_response_body(bool store_errors) override;
   void set_request_id(int64_t request_id) override;
+  void set_step_template_id(int64_t step_template_id) override;
 
  private:
   string session_handle_;
@@ -378,6 +385,7 @@ class InMemoryRunGraphRequest : public MutableRunGraphRequestWrapper {
   bool is_last_partial_run_ = false;
   bool store_errors_in_response_body_ = false;
   int64_t request_id_ = 0;
+  int64_t step_template_id_ = 0;
 
   // Holds a cached and owned representation of the proto
   // representation of this request, if needed, so that `ToProto()`
@@ -406,6 +414,7 @@ class MutableProtoRunGraphRequest : public MutableRunGraphRequestWrapper {
   bool is_last_partial_run() const override;
   bool store_errors_in_response_body() const override;
   int64_t request_id() const override;
+  int64_t step_template_id() const override;
   const RunGraphRequest& ToProto() const override;
 
   // MutableRunGraphRequestWrapper methods.
@@ -425,6 +434,7 @@ class MutableProtoRunGraphRequest : public MutableRunGraphRequestWrapper {
   void set_is_last_partial_run(bool is_last_partial_run) override;
   void set_store_errors_in_response_body(bool store_errors) override;
   void set_request_id(int64_t request_id) override;
+  void set_step_template_id(int64_t step_template_id) override;
 
  private:
   RunGraphRequest request_;
@@ -449,6 +459,7 @@ class ProtoRunGraphRequest : public RunGraphRequestWrapper {
   bool is_last_partial_run() const override;
   bool store_errors_in_response_body() const override;
   int64_t request_id() const override;
+  int64_t step_template_id() const override;
   const RunGraphRequest& ToProto() const override;
 
  private:
@@ -0,0 +1,75 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/shape_inference.h"
+
+namespace tensorflow {
+namespace {
+
+REGISTER_OP("SaveToPeerMemory")
+    .Input("tensor_names: string")
+    .Input("tensors: T")
+    .Attr("T: list(type)")
+    .Attr("checkpoint_key: string")
+    .SetIsStateful()
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 1, &unused));
+      return absl::OkStatus();
+    })
+    .Doc(R"doc(
+Keeps a copy of `tensors` in the host memory of the task the op runs on.
+
+Placed on a peer task, e.g. from the `save_fn` of a preemption handler, this
+streams the state of a task that is about to be preempted to the peer over the
+worker RPC channel, which is much faster than writing a checkpoint to storage.
+The copy replaces any earlier one saved under `checkpoint_key` on the same
+device, and lives as long as the peer process.
+
+tensor_names: Shape `[N]`. The names of the tensors.
+tensors: `N` tensors to save.
+checkpoint_key: Identifies the checkpoint, e.g. the name of the saving task.
+)doc");
+
+REGISTER_OP("RestoreFromPeerMemory")
+    .Input("tensor_names: string")
+    .Output("tensors: dtypes")
+    .Attr("dtypes: list(type)")
+    .Attr("checkpoint_key: string")
+    .SetIsStateful()
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 1, &unused));
+      for (int i = 0; i < c->num_outputs(); ++i) {
+        c->set_output(i, c->UnknownShape());
+      }
+      return absl::OkStatus();
+    })
+    .Doc(R"doc(
+Returns tensors saved by `SaveToPeerMemory` on the device the op runs on.
+
+Fails with `NotFound` if no checkpoint was saved under `checkpoint_key`, e.g.
+because the peer was restarted as well, in which case the caller should restore
+from storage instead.
+
+tensor_names: Shape `[N]`. The names of the tensors to restore.
+tensors: The restored tensors.
+dtypes: The types of the tensors to restore.
+checkpoint_key: Identifies the checkpoint.
+)doc");
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,149 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/op_requires.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kPeerMemoryCheckpointContainer[] = "peer_memory_checkpoint";
+
+// The tensors saved under one checkpoint key.
+class PeerMemoryCheckpoint : public ResourceBase {
+ public:
+  std::string DebugString() const override {
+    tf_shared_lock l(mu_);
+    return absl::StrCat("PeerMemoryCheckpoint with ", tensors_.size(),
+                        " tensors");
+  }
+
+  void Replace(absl::flat_hash_map<std::string, Tensor> tensors) {
+    mutex_lock l(mu_);
+    tensors_.swap(tensors);
+  }
+
+  Status Lookup(const std::string& name, Tensor* tensor) const {
+    tf_shared_lock l(mu_);
+    auto it = tensors_.find(name);
+    if (it == tensors_.end()) {
+      return errors::NotFound("Tensor ", name,
+                              " is not in the peer memory checkpoint");
+    }
+    *tensor = it->second;
+    return absl::OkStatus();
+  }
+
+ private:
+  mutable mutex mu_;
+  absl::flat_hash_map<std::string, Tensor> tensors_ TF_GUARDED_BY(mu_);
+};
+
+// Kernel that keeps a copy of its inputs in host memory.
+class SaveToPeerMemoryOp : public OpKernel {
+ public:
+  explicit SaveToPeerMemoryOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("checkpoint_key", &checkpoint_key_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& names = ctx->input(0);
+    OpInputList tensors;
+    OP_REQUIRES_OK(ctx, ctx->input_list("tensors", &tensors));
+    OP_REQUIRES(ctx, names.NumElements() == tensors.size(),
+                errors::InvalidArgument("Got ", names.NumElements(),
+                                        " tensor names for ", tensors.size(),
+                                        " tensors"));
+    // The inputs may share their buffers with the saved variables, e.g. when
+    // the op runs on the same task, so they are copied.
+    absl::flat_hash_map<std::string, Tensor> copies;
+    copies.reserve(tensors.size());
+    for (int i = 0; i < tensors.size(); ++i) {
+      copies[std::string(names.flat<tstring>()(i))] =
+          tensor::DeepCopy(tensors[i]);
+    }
+
+    PeerMemoryCheckpoint* checkpoint = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->resource_manager()->LookupOrCreate(
+                            kPeerMemoryCheckpointContainer, checkpoint_key_,
+                            &checkpoint, [](PeerMemoryCheckpoint** ret) {
+                              *ret = new PeerMemoryCheckpoint;
+                              return absl::OkStatus();
+                            }));
+    core::ScopedUnref unref(checkpoint);
+    checkpoint->Replace(std::move(copies));
+  }
+
+ private:
+  std::string checkpoint_key_;
+};
+
+// Kernel that returns the tensors saved by SaveToPeerMemoryOp.
+class RestoreFromPeerMemoryOp : public OpKernel {
+ public:
+  explicit RestoreFromPeerMemoryOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("checkpoint_key", &checkpoint_key_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& names = ctx->input(0);
+    OP_REQUIRES(ctx, names.NumElements() == num_outputs(),
+                errors::InvalidArgument("Got ", names.NumElements(),
+                                        " tensor names for ", num_outputs(),
+                                        " dtypes"));
+    PeerMemoryCheckpoint* checkpoint = nullptr;
+    Status s = ctx->resource_manager()->Lookup(kPeerMemoryCheckpointContainer,
+                                               checkpoint_key_, &checkpoint);
+    if (errors::IsNotFound(s)) {
+      s = errors::NotFound("No peer memory checkpoint ", checkpoint_key_,
+                           " on ", ctx->device()->name());
+    }
+    OP_REQUIRES_OK(ctx, s);
+    core::ScopedUnref unref(checkpoint);
+    for (int i = 0; i < num_outputs(); ++i) {
+      const std::string name(names.flat<tstring>()(i));
+      Tensor tensor;
+      OP_REQUIRES_OK(ctx, checkpoint->Lookup(name, &tensor));
+      OP_REQUIRES(ctx, tensor.dtype() == output_type(i),
+                  errors::InvalidArgument(
+                      "Tensor ", name, " of the peer memory checkpoint is ",
+                      DataTypeString(tensor.dtype()), ", expected ",
+                      DataTypeString(output_type(i))));
+      ctx->set_output(i, tensor);
+    }
+  }
+
+ private:
+  std::string checkpoint_key_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("SaveToPeerMemory").Device(DEVICE_CPU),
+                        SaveToPeerMemoryOp);
+REGISTER_KERNEL_BUILDER(Name("RestoreFromPeerMemory").Device(DEVICE_CPU),
+                        RestoreFromPeerMemoryOp);
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,130 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/batch_recv_tensor_streams.h"
+
+#include <utility>
+
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+
+void BatchRecvTensorStreams::Poll(int64_t step_id, int64_t stream_id,
+                                  const std::vector<string>& keys,
+                                  const StartRecvFn& start_recv,
+                                  PollDoneCallback done) {
+  const StreamId id(step_id, stream_id);
+  PollDoneCallback superseded;
+  std::vector<Result> superseded_results;
+  {
+    mutex_lock l(mu_);
+    Stream& stream = streams_[id];
+    if (stream.poll) {
+      superseded = std::move(stream.poll);
+      superseded_results.swap(stream.ready);
+    }
+    stream.num_outstanding += keys.size();
+    stream.poll = std::move(done);
+  }
+  if (superseded) {
+    superseded(absl::OkStatus(), std::move(superseded_results));
+  }
+
+  // The receives may complete inline, so they are started only once the poll
+  // is registered.
+  for (const string& key : keys) {
+    start_recv(key, [this, id, key](const Tensor& tensor, bool is_dead,
+                                    const Status& status) {
+      Result result;
+      result.key = key;
+      result.tensor = tensor;
+      result.is_dead = is_dead;
+      result.status = status;
+      Deliver(id, std::move(result));
+    });
+  }
+
+  PollDoneCallback poll_done;
+  std::vector<Result> results;
+  {
+    mutex_lock l(mu_);
+    auto it = streams_.find(id);
+    if (it == streams_.end() ||
+        !TakeReadyLocked(id, &it->second, &poll_done, &results)) {
+      return;
+    }
+  }
+  poll_done(absl::OkStatus(), std::move(results));
+}
+
+void BatchRecvTensorStreams::Deliver(const StreamId& id, Result result) {
+  PollDoneCallback poll_done;
+  std::vector<Result> results;
+  {
+    mutex_lock l(mu_);
+    auto it = streams_.find(id);
+    if (it == streams_.end()) {
+      // The step was cleaned up while the value was in flight.
+      return;
+    }
+    Stream& stream = it->second;
+    --stream.num_outstanding;
+    stream.ready.push_back(std::move(result));
+    if (!TakeReadyLocked(id, &stream, &poll_done, &results)) return;
+  }
+  poll_done(absl::OkStatus(), std::move(results));
+}
+
+bool BatchRecvTensorStreams::TakeReadyLocked(const StreamId& id,
+                                             Stream* stream,
+                                             PollDoneCallback* done,
+                                             std::vector<Result>* results) {
+  if (!stream->poll ||
+      (stream->ready.empty() && stream->num_outstanding > 0)) {
+    return false;
+  }
+  *done = std::move(stream->poll);
+  stream->poll = nullptr;
+  results->swap(stream->ready);
+  if (stream->num_outstanding == 0) {
+    streams_.erase(id);
+  }
+  return true;
+}
+
+void BatchRecvTensorStreams::CleanupStep(int64_t step_id) {
+  std::vector<PollDoneCallback> polls;
+  {
+    mutex_lock l(mu_);
+    for (auto it = streams_.begin(); it != streams_.end();) {
+      if (it->first.first == step_id) {
+        if (it->second.poll) polls.push_back(std::move(it->second.poll));
+        streams_.erase(it++);
+      } else {
+        ++it;
+      }
+    }
+  }
+  for (PollDoneCallback& poll : polls) {
+    poll(errors::Aborted("Step ", step_id, " was cleaned up"), {});
+  }
+}
+
+int64_t BatchRecvTensorStreams::size() {
+  mutex_lock l(mu_);
+  return streams_.size();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,100 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_BATCH_RECV_TENSOR_STREAMS_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_BATCH_RECV_TENSOR_STREAMS_H_
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+
+// Serving-side state of the BatchRecvTensor streams; see
+// `BatchRecvTensorRequest` in worker.proto.
+//
+// A stream is identified by (step_id, stream_id). Each poll adds keys to the
+// stream and waits until at least one of the stream's values is ready. Values
+// that become ready while no poll is pending are held for the next poll. A
+// poll that arrives while another one is pending answers the earlier one with
+// whatever is ready, so that new keys never wait behind a slow one. A stream
+// is dropped once a poll has drained it, or when its step is cleaned up.
+class BatchRecvTensorStreams {
+ public:
+  using RecvDoneCallback = std::function<void(
+      const Tensor& tensor, bool is_dead, const Status& status)>;
+
+  // Starts receiving the value of `key`, and invokes `done` once it is ready.
+  using StartRecvFn =
+      std::function<void(const string& key, RecvDoneCallback done)>;
+
+  struct Result {
+    string key;
+    Tensor tensor;
+    bool is_dead = false;
+    Status status;
+  };
+
+  // Invoked with the values that became ready on the stream, or with an
+  // error if the stream was dropped.
+  using PollDoneCallback =
+      std::function<void(const Status& status, std::vector<Result> results)>;
+
+  // Adds `keys` to the stream, starting a receive for each of them with
+  // `start_recv`, and invokes `done` once the stream has a value ready. If the
+  // stream has no outstanding keys, `done` is invoked right away with no
+  // results. A poll already pending on the stream is answered right away with
+  // the values ready so far, possibly none.
+  void Poll(int64_t step_id, int64_t stream_id,
+            const std::vector<string>& keys, const StartRecvFn& start_recv,
+            PollDoneCallback done);
+
+  // Drops the streams of `step_id`. Their pending polls, if any, are failed
+  // with Aborted, and values that become ready later are discarded.
+  void CleanupStep(int64_t step_id);
+
+  // Returns the number of live streams.
+  int64_t size();
+
+ private:
+  using StreamId = std::pair<int64_t, int64_t>;
+
+  struct Stream {
+    int64_t num_outstanding = 0;
+    std::vector<Result> ready;
+    PollDoneCallback poll;
+  };
+
+  void Deliver(const StreamId& id, Result result);
+
+  // If `stream` has a pending poll that can be answered, moves the poll and
+  // the ready values into `*done` and `*results`, and drops the stream if it
+  // is drained. Returns true if the caller must invoke `*done`.
+  bool TakeReadyLocked(const StreamId& id, Stream* stream,
+                       PollDoneCallback* done, std::vector<Result>* results)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  mutex mu_;
+  absl::flat_hash_map<StreamId, Stream> streams_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_BATCH_RECV_TENSOR_STREAMS_H_
@@ -0,0 +1,178 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/batch_recv_tensor_streams.h"
+
+#include <map>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+using Result = BatchRecvTensorStreams::Result;
+
+// Holds the started receives until the test completes them.
+class FakeRendezvous {
+ public:
+  BatchRecvTensorStreams::StartRecvFn StartRecvFn() {
+    return [this](const string& key,
+                  BatchRecvTensorStreams::RecvDoneCallback done) {
+      pending_[key] = std::move(done);
+    };
+  }
+
+  void Send(const string& key, float value) {
+    auto done = std::move(pending_.at(key));
+    pending_.erase(key);
+    done(test::AsScalar<float>(value), /*is_dead=*/false, absl::OkStatus());
+  }
+
+  int num_pending() const { return pending_.size(); }
+
+ private:
+  std::map<string, BatchRecvTensorStreams::RecvDoneCallback> pending_;
+};
+
+// Captures the outcome of one poll.
+struct PollOutcome {
+  bool done = false;
+  Status status;
+  std::vector<Result> results;
+
+  BatchRecvTensorStreams::PollDoneCallback Callback() {
+    return [this](const Status& s, std::vector<Result> r) {
+      done = true;
+      status = s;
+      results = std::move(r);
+    };
+  }
+};
+
+TEST(BatchRecvTensorStreamsTest, PollWaitsForFirstValue) {
+  BatchRecvTensorStreams streams;
+  FakeRendezvous rendezvous;
+  PollOutcome outcome;
+  streams.Poll(/*step_id=*/1, /*stream_id=*/7, {"a", "b"},
+               rendezvous.StartRecvFn(), outcome.Callback());
+  EXPECT_FALSE(outcome.done);
+  EXPECT_EQ(rendezvous.num_pending(), 2);
+
+  rendezvous.Send("b", 2.0f);
+  ASSERT_TRUE(outcome.done);
+  TF_EXPECT_OK(outcome.status);
+  ASSERT_EQ(outcome.results.size(), 1);
+  EXPECT_EQ(outcome.results[0].key, "b");
+  test::ExpectTensorEqual<float>(outcome.results[0].tensor,
+                                 test::AsScalar<float>(2.0f));
+  EXPECT_EQ(streams.size(), 1);
+}
+
+TEST(BatchRecvTensorStreamsTest, ValuesReadyBetweenPollsAreCoalesced) {
+  BatchRecvTensorStreams streams;
+  FakeRendezvous rendezvous;
+  PollOutcome first;
+  streams.Poll(1, 7, {"a", "b", "c"}, rendezvous.StartRecvFn(),
+               first.Callback());
+  rendezvous.Send("a", 1.0f);
+  ASSERT_TRUE(first.done);
+
+  // Both values arrive while no poll is pending.
+  rendezvous.Send("b", 2.0f);
+  rendezvous.Send("c", 3.0f);
+
+  PollOutcome second;
+  streams.Poll(1, 7, {}, rendezvous.StartRecvFn(), second.Callback());
+  ASSERT_TRUE(second.done);
+  TF_EXPECT_OK(second.status);
+  EXPECT_EQ(second.results.size(), 2);
+
+  // The stream is drained.
+  EXPECT_EQ(streams.size(), 0);
+}
+
+TEST(BatchRecvTensorStreamsTest, InlineCompletionAnswersPoll) {
+  BatchRecvTensorStreams streams;
+  PollOutcome outcome;
+  streams.Poll(
+      1, 7, {"a"},
+      [](const string& key, BatchRecvTensorStreams::RecvDoneCallback done) {
+        done(Tensor(), /*is_dead=*/true, absl::OkStatus());
+      },
+      outcome.Callback());
+  ASSERT_TRUE(outcome.done);
+  ASSERT_EQ(outcome.results.size(), 1);
+  EXPECT_TRUE(outcome.results[0].is_dead);
+  EXPECT_EQ(streams.size(), 0);
+}
+
+TEST(BatchRecvTensorStreamsTest, NewPollAnswersPendingOne) {
+  BatchRecvTensorStreams streams;
+  FakeRendezvous rendezvous;
+  PollOutcome first;
+  streams.Poll(1, 7, {"a"}, rendezvous.StartRecvFn(), first.Callback());
+  PollOutcome second;
+  streams.Poll(1, 7, {"b"}, rendezvous.StartRecvFn(), second.Callback());
+
+  // The first poll is let go so that "b" does not wait behind "a".
+  ASSERT_TRUE(first.done);
+  TF_EXPECT_OK(first.status);
+  EXPECT_TRUE(first.results.empty());
+  EXPECT_FALSE(second.done);
+  EXPECT_EQ(rendezvous.num_pending(), 2);
+
+  rendezvous.Send("b", 2.0f);
+  ASSERT_TRUE(second.done);
+  ASSERT_EQ(second.results.size(), 1);
+  EXPECT_EQ(second.results[0].key, "b");
+}
+
+TEST(BatchRecvTensorStreamsTest, StreamsAreIndependent) {
+  BatchRecvTensorStreams streams;
+  FakeRendezvous rendezvous;
+  PollOutcome stream_7;
+  PollOutcome stream_8;
+  streams.Poll(1, 7, {"a"}, rendezvous.StartRecvFn(), stream_7.Callback());
+  streams.Poll(1, 8, {"b"}, rendezvous.StartRecvFn(), stream_8.Callback());
+  rendezvous.Send("b", 2.0f);
+  EXPECT_FALSE(stream_7.done);
+  EXPECT_TRUE(stream_8.done);
+}
+
+TEST(BatchRecvTensorStreamsTest, CleanupStepFailsPendingPoll) {
+  BatchRecvTensorStreams streams;
+  FakeRendezvous rendezvous;
+  PollOutcome step_1;
+  PollOutcome step_2;
+  streams.Poll(1, 7, {"a"}, rendezvous.StartRecvFn(), step_1.Callback());
+  streams.Poll(2, 7, {"b"}, rendezvous.StartRecvFn(), step_2.Callback());
+
+  streams.CleanupStep(1);
+  ASSERT_TRUE(step_1.done);
+  EXPECT_TRUE(errors::IsAborted(step_1.status));
+  EXPECT_FALSE(step_2.done);
+  EXPECT_EQ(streams.size(), 1);
+
+  // A value arriving after the cleanup is dropped.
+  rendezvous.Send("a", 1.0f);
+  EXPECT_EQ(streams.size(), 1);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -66,6 +66,7 @@ class GrpcRemoteWorker : public WorkerInterface {
         instancesource_(Method(GrpcWorkerMethod::kCompleteInstance)),
         getstepsequence_(Method(GrpcWorkerMethod::kGetStepSequence)),
         markrecvfinished_(Method(GrpcWorkerMethod::kMarkRecvFinished)),
+        batchrecvtensor_(Method(GrpcWorkerMethod::kBatchRecvTensor)),
         logger_(logger),
         target_(target) {}
 
@@ -137,6 +138,11 @@ class GrpcRemoteWorker : public WorkerInterface {
 
     auto callback = [this, request, response, done, start_usec,
                      logging_active](Status s) {
+      if (s.ok()) {
+        logger_->RecordTransferLatency(
+            "RecvBuf", target_, start_usec, response->send_start_micros(),
+            Env::Default()->NowMicros(), request->num_bytes());
+      }
       if (logging_active) {
         if (logger_->LoggingActive()) {
           int64_t end_usec = Env::Default()->NowMicros();
@@ -197,6 +203,14 @@ class GrpcRemoteWorker : public WorkerInterface {
     IssueRequest(request, response, getstepsequence_, std::move(done));
   }
 
+  void BatchRecvTensorAsync(CallOptions* call_opts,
+                            const BatchRecvTensorRequest* request,
+                            BatchRecvTensorResponse* response,
+                            StatusCallback done) override {
+    IssueRequest(request, response, batchrecvtensor_, std::move(done),
+                 call_opts);
+  }
+
   void RecvTensorAsync(CallOptions* call_opts, const RecvTensorRequest* request,
                        TensorResponse* response, StatusCallback done) override {
     VLOG(1) << "RecvTensorAsync req: " << request->DebugString();
@@ -206,6 +220,12 @@ class GrpcRemoteWorker : public WorkerInterface {
 
     auto callback = [this, request, response, done, start_usec,
                      logging_active](Status s) {
+      if (s.ok()) {
+        logger_->RecordTransferLatency(
+            "RecvTensor", target_, start_usec,
+            response->metadata().send_start_micros(),
+            Env::Default()->NowMicros(), response->tensor().TotalBytes());
+      }
       if (logging_active) {
         if (logger_->LoggingActive()) {
           int64_t end_usec = Env::Default()->NowMicros();
@@ -333,6 +353,7 @@ class GrpcRemoteWorker : public WorkerInterface {
   const ::grpc::string instancesource_;
   const ::grpc::string getstepsequence_;
   const ::grpc::string markrecvfinished_;
+  const ::grpc::string batchrecvtensor_;
 
   // Support for logging.
   WorkerCacheLogger* logger_;
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/io/proto_encode_helper.h"
+#include "tensorflow/core/platform/coding.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 
@@ -134,6 +135,71 @@ static void EncodeSkeleton(const Tensor& val, io::ProtoEncodeHelper* e) {
 #endif
 }
 
+// Returns a slice that shares `size` bytes at `data`, which lie in the
+// backing store of `val`, and keeps that backing store alive.
+static ::grpc::Slice SharedTensorSlice(const Tensor& val, const char* data,
+                                       size_t size) {
+  const TensorBuffer* buf = DMAHelper::buffer(&val);
+  buf->Ref();
+  return ::grpc::Slice(
+      const_cast<char*>(data), size,
+      [](void* backing) { static_cast<TensorBuffer*>(backing)->Unref(); },
+      const_cast<TensorBuffer*>(buf));
+}
+
+// Encodes a RecvTensorResponse for a DT_STRING tensor "val" into "*result",
+// with "header" holding all of the response except the tensor() field.
+//
+// The elements are hand-encoded as TensorProto::string_val fields, rather
+// than built into a TensorProto and serialized. Strings larger than
+// "large_string_bytes" get slices of their own that share their bytes with
+// "val"; the encoding of everything in between is copied into other slices.
+static void EncodeStringTensorToByteBuffer(const string& header,
+                                           const Tensor& val,
+                                           size_t large_string_bytes,
+                                           ::grpc::ByteBuffer* result) {
+  gtl::InlinedVector<char, 128> skeleton(SkeletonEncodingSizeUpperBound(val));
+  io::ProtoEncodeHelper e_skeleton(skeleton.data(), skeleton.size());
+  EncodeSkeleton(val, &e_skeleton);
+
+  const auto strings = val.flat<tstring>();
+  uint64 overall_tensor_proto_bytesize = e_skeleton.size();
+  for (int64_t i = 0; i < strings.size(); ++i) {
+    overall_tensor_proto_bytesize += VarLengthEncodingSize(
+        TensorProto::kStringValFieldNumber, strings(i).size());
+  }
+  const uint32 kLengthDelimitedWireType = 2;
+
+  std::vector<::grpc::Slice> slices;
+  string pending = header;
+  auto flush_pending = [&slices, &pending]() {
+    if (pending.empty()) return;
+    slices.push_back(::grpc::Slice(pending));
+    pending.clear();
+  };
+  core::PutVarint32(&pending, (RecvTensorResponse::kTensorFieldNumber << 3) |
+                                  kLengthDelimitedWireType);
+  core::PutVarint64(&pending, overall_tensor_proto_bytesize);
+  pending.append(e_skeleton.data(), e_skeleton.size());
+  for (int64_t i = 0; i < strings.size(); ++i) {
+    const tstring& value = strings(i);
+    core::PutVarint32(&pending, (TensorProto::kStringValFieldNumber << 3) |
+                                    kLengthDelimitedWireType);
+    core::PutVarint64(&pending, value.size());
+    // VIEW strings point to memory that "val" does not own.
+    if (value.size() > large_string_bytes && value.type() != tstring::VIEW) {
+      flush_pending();
+      slices.push_back(SharedTensorSlice(val, value.data(), value.size()));
+    } else {
+      pending.append(value.data(), value.size());
+    }
+  }
+  flush_pending();
+
+  ::grpc::ByteBuffer tmp(slices.data(), slices.size());
+  result->Swap(&tmp);
+}
+
 void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
                               ::grpc::ByteBuffer* result) {
   const int kLargeTensorBytes = 1024;
@@ -153,7 +219,11 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
   }
   response.set_require_ack(require_ack);
   response.set_send_start_micros(Env::Default()->NowMicros());
-  if (!DataTypeCanUseMemcpy(val.dtype())) {
+  if (val.dtype() == DT_STRING) {
+    string header;  // All of RecvTensorResponse except the tensor() field
+    response.AppendToString(&header);
+    EncodeStringTensorToByteBuffer(header, val, kLargeTensorBytes, result);
+  } else if (!DataTypeCanUseMemcpy(val.dtype())) {
     // Straightforward but slow path for complicated kinds of tensor data
     // TODO(jeff,sanjay): If this becomes an issue, we could
     // go directly from val -> ByteBuffer, with some effort.
@@ -230,13 +300,7 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
 
     if (share_tensor_slice_memory) {
       // (E) Encode tensor data, but by sharing backing store
-      const TensorBuffer* buf = DMAHelper::buffer(&val);
-      buf->Ref();
-      slices[1] = ::grpc::Slice(
-          const_cast<void*>(static_cast<const void*>(tdata.data())),
-          tdata.size(),
-          [](void* backing) { static_cast<TensorBuffer*>(backing)->Unref(); },
-          const_cast<TensorBuffer*>(buf));
+      slices[1] = SharedTensorSlice(val, tdata.data(), tdata.size());
       num_slices += 1;
     }
     size_t total_bytes = 0;
@@ -17,6 +17,10 @@ limitations under the License.
 
 #include "grpcpp/support/byte_buffer.h"
 #include "grpcpp/support/slice.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
+#include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/framework/device_attributes.pb.h"
+#include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
@@ -26,6 +30,22 @@ limitations under the License.
 
 namespace tensorflow {
 
+class DummyDevice : public DeviceBase {
+ public:
+  explicit DummyDevice(Env* env) : DeviceBase(env) {
+    attr_.set_device_type("CPU");
+  }
+
+  const DeviceAttributes& attributes() const override { return attr_; }
+
+  Allocator* GetAllocator(AllocatorAttributes attr) override {
+    return cpu_allocator();
+  }
+
+ private:
+  DeviceAttributes attr_;
+};
+
 class GrpcTensorCodingTest : public ::testing::Test {
  public:
   void Validate(const Tensor& t, bool is_dead) {
@@ -100,4 +120,44 @@ TEST_F(GrpcTensorCodingTest, Simple) {
 
 TEST_F(GrpcTensorCodingTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(GrpcTensorCodingTest, LargeStringsShareTensorMemory) {
+  Tensor t(DT_STRING, TensorShape({3}));
+  test::FillValues<tstring>(&t, {"small", string(4096, 'x'), "small again"});
+  Validate(t, false);
+
+  ::grpc::ByteBuffer buf;
+  grpc::EncodeTensorToByteBuffer(false, t, false, &buf);
+  std::vector<::grpc::Slice> slices;
+  (void)buf.Dump(&slices);
+  // Header and first string, large string, last string.
+  ASSERT_EQ(slices.size(), 3);
+  EXPECT_EQ(reinterpret_cast<const char*>(slices[1].begin()),
+            t.flat<tstring>()(1).data());
+}
+
+TEST_F(GrpcTensorCodingTest, DecodeSharesReceivedSlices) {
+  Tensor src(DT_FLOAT, TensorShape({1024}));
+  test::FillIota<float>(&src, 0.0f);
+  ::grpc::ByteBuffer buf;
+  grpc::EncodeTensorToByteBuffer(false, src, false, &buf);
+
+  DummyDevice cpu_device(Env::Default());
+  TensorResponse response;
+  response.InitAlloc(&cpu_device, AllocatorAttributes());
+  ASSERT_TRUE(GrpcMaybeParseTensorResponse(&buf, &response));
+  test::ExpectTensorEqual<float>(src, response.tensor());
+  // The sender shared the tensor memory with the slice, and the receiver
+  // shared the slice with the tensor, so no bytes were copied.
+  EXPECT_EQ(response.tensor().tensor_data().data(), src.tensor_data().data());
+
+  // Memory that must be registered with a GPU is not shared.
+  AllocatorAttributes gpu_compatible;
+  gpu_compatible.set_gpu_compatible(true);
+  grpc::EncodeTensorToByteBuffer(false, src, false, &buf);
+  response.InitAlloc(&cpu_device, gpu_compatible);
+  ASSERT_TRUE(GrpcMaybeParseTensorResponse(&buf, &response));
+  test::ExpectTensorEqual<float>(src, response.tensor());
+  EXPECT_NE(response.tensor().tensor_data().data(), src.tensor_data().data());
+}
+
 }  // namespace tensorflow
@@ -15,9 +15,61 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 
+#include <vector>
+
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/tensor.h"
 
 namespace tensorflow {
+namespace {
+
+// Contents smaller than this are copied. Copying them is cheap, and it keeps
+// small slices, whose bytes may be stored inline in the slice object, from
+// being shared.
+constexpr size_t kMinSharedContentsBytes = 1024;
+
+// A TensorBuffer over bytes of a received slice, which it keeps alive.
+class GrpcSliceTensorBuffer : public TensorBuffer {
+ public:
+  GrpcSliceTensorBuffer(::grpc::Slice slice, const uint8_t* data, size_t size)
+      : TensorBuffer(const_cast<uint8_t*>(data)),
+        slice_(std::move(slice)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocated_bytes(size_);
+    proto->set_allocator_name("grpc_slice");
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const ::grpc::Slice slice_;
+  const size_t size_;
+};
+
+}  // namespace
+
+TensorBuffer* GrpcByteSource::ShareContents(int64_t offset, size_t num_bytes) {
+  if (num_bytes < kMinSharedContentsBytes) return nullptr;
+  std::vector<::grpc::Slice> slices;
+  if (!buffer_->Dump(&slices).ok()) return nullptr;
+  for (::grpc::Slice& slice : slices) {
+    if (offset < static_cast<int64_t>(slice.size())) {
+      if (offset + num_bytes > slice.size()) return nullptr;
+      const uint8_t* data = slice.begin() + offset;
+      if (reinterpret_cast<uintptr_t>(data) % EIGEN_MAX_ALIGN_BYTES != 0) {
+        return nullptr;
+      }
+      return new GrpcSliceTensorBuffer(std::move(slice), data, num_bytes);
+    }
+    offset -= slice.size();
+  }
+  return nullptr;
+}
 
 bool GrpcMaybeParseTensorResponse(::grpc::ByteBuffer* src,
                                   TensorResponse* dst) {
@@ -50,6 +50,10 @@ class GrpcByteSource : public TensorResponse::Source {
     return stream_;
   }
 
+  // Shares the bytes if they lie in one received slice and are aligned like
+  // tensor data, keeping that slice alive for as long as the returned buffer.
+  TensorBuffer* ShareContents(int64_t offset, size_t num_bytes) override;
+
  private:
   void DeleteStream() {
     if (stream_) {
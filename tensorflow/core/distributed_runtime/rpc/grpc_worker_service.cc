@@ -148,6 +148,7 @@ class GrpcWorkerServiceThread {
     SETUP_FOR_REQUEST(RunGraph, 100, true);
     SETUP_FOR_REQUEST(CleanupGraph, 100, false);
     SETUP_FOR_REQUEST(MarkRecvFinished, 10, false);
+    SETUP_FOR_REQUEST(BatchRecvTensor, 100, true);
 
     // TODO(ncteisen): Determine a better policy for enqueuing the
     // appropriate number of each request type.
@@ -284,6 +285,25 @@ class GrpcWorkerServiceThread {
     EnqueueRecvTensorRequestRaw();
   }
 
+  void BatchRecvTensorHandler(
+      WorkerCall<BatchRecvTensorRequest, BatchRecvTensorResponse>* call) {
+    Schedule([this, call]() {
+      CallOptions* call_opts = new CallOptions;
+      call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
+      worker_->BatchRecvTensorAsync(
+          call_opts, &call->request, &call->response,
+          [call, call_opts](const Status& s) {
+            call->ClearCancelCallback();
+            delete call_opts;
+            if (!s.ok()) {
+              VLOG(3) << "Bad response from BatchRecvTensor:" << s;
+            }
+            call->SendResponse(ToGrpcStatus(s));
+          });
+    });
+    ENQUEUE_REQUEST(BatchRecvTensor, true);
+  }
+
   void RecvBufHandler(WorkerCall<RecvBufRequest, RecvBufResponse>* call) {
     Schedule([this, call]() {
       CallOptions* call_opts = new CallOptions;
@@ -512,20 +532,31 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
     LOG(WARNING) << "RecvTensor cancelled for " << step_id;
     AbortStep(step_id);
   });
+  RecvLocalOnHostAsync(opts, step_id, key, parsed, src_dev,
+                       std::move(rendezvous_done));
+}
+
+// Receives the value of `parsed` from the local rendezvous of `step_id`, and
+// copies it to host memory if it lives on an accelerator. If `opts` is not
+// null, its cancel callback is cleared as soon as the value is produced.
+void GrpcWorker::RecvLocalOnHostAsync(
+    CallOptions* opts, int64_t step_id, const string& key,
+    const Rendezvous::ParsedKey& parsed, Device* src_dev,
+    std::function<void(const Tensor&, bool, const Status&)> done) {
   env_->rendezvous_mgr->RecvLocalAsync(
       step_id, parsed,
-      [opts, rendezvous_done, src_dev, request](
+      [opts, done = std::move(done), src_dev, step_id, key](
           const Status& status, const Rendezvous::Args& send_args,
           const Rendezvous::Args& recv_args, const Tensor& val,
           const bool is_dead) {
-        opts->ClearCancelCallback();
+        if (opts != nullptr) opts->ClearCancelCallback();
         if (!status.ok()) {
-          return rendezvous_done(val, is_dead, status);
+          return done(val, is_dead, status);
         }
 
         const bool on_host = send_args.alloc_attrs.on_host();
         if (!src_dev->tensorflow_accelerator_device_info() || on_host) {
-          return rendezvous_done(val, is_dead, status);
+          return done(val, is_dead, status);
         }
 
         DeviceContext* send_dev_context = send_args.device_context;
@@ -533,8 +564,8 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
         alloc_attrs.set_gpu_compatible(true);
         alloc_attrs.set_on_host(true);
         profiler::ScopedMemoryDebugAnnotation op_annotation(
-            "GrpcWorker::RecvTensorAsync::consumer_callback",
-            request->step_id(), "dynamic", val.dtype(),
+            "GrpcWorker::RecvTensorAsync::consumer_callback", step_id,
+            "dynamic", val.dtype(),
             [shape = val.shape()]() { return shape.DebugString(); });
         Allocator* alloc = src_dev->GetAllocator(alloc_attrs);
         Tensor* copy = new Tensor(alloc, val.dtype(), val.shape());
@@ -542,18 +573,83 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
             << "send dev name: " << src_dev->name()
             << " gpu_info: " << src_dev->tensorflow_accelerator_device_info();
 
-        StatusCallback copy_ready = [rendezvous_done, copy,
-                                     is_dead](const Status& s) {
+        StatusCallback copy_ready = [done, copy, is_dead](const Status& s) {
           // The value is now ready to be returned on the wire.
-          rendezvous_done(*copy, is_dead, s);
+          done(*copy, is_dead, s);
           delete copy;
         };
 
-        CopyDeviceToHost(&val, alloc, alloc, request->rendezvous_key(), src_dev,
-                         copy, send_dev_context, copy_ready);
+        CopyDeviceToHost(&val, alloc, alloc, key, src_dev, copy,
+                         send_dev_context, copy_ready);
       });
 }
 
+void GrpcWorker::BatchRecvTensorAsync(CallOptions* opts,
+                                      const BatchRecvTensorRequest* request,
+                                      BatchRecvTensorResponse* response,
+                                      StatusCallback done) {
+  const int64_t step_id = request->step_id();
+  const std::vector<string> keys(request->rendezvous_key().begin(),
+                                 request->rendezvous_key().end());
+  TRACEPRINTF("BatchRecvTensor: %lld %d keys", step_id,
+              static_cast<int>(keys.size()));
+
+  // As for RecvTensor, a cancelled poll aborts the step. That fails the
+  // outstanding receives of the stream, which in turn answers the poll.
+  opts->SetCancelCallback([this, step_id]() {
+    LOG(WARNING) << "BatchRecvTensor cancelled for " << step_id;
+    AbortStep(step_id);
+  });
+
+  auto start_recv = [this, step_id](
+                        const string& key,
+                        BatchRecvTensorStreams::RecvDoneCallback recv_done) {
+    Rendezvous::ParsedKey parsed;
+    Status s = Rendezvous::ParseKey(key, &parsed);
+    Device* src_dev = nullptr;
+    if (s.ok()) {
+      s = PrepareRecvTensor(parsed, &src_dev);
+    }
+    if (!s.ok()) {
+      recv_done(Tensor(), false, s);
+      return;
+    }
+    RecvLocalOnHostAsync(/*opts=*/nullptr, step_id, key, parsed, src_dev,
+                         std::move(recv_done));
+  };
+
+  auto poll_done = [this, opts, response, done = std::move(done)](
+                       const Status& status,
+                       std::vector<BatchRecvTensorStreams::Result> results) {
+    opts->ClearCancelCallback();
+    // A failed receive fails the whole poll; the client then fails every
+    // receive still outstanding on the stream, as the step is going down.
+    Status s = status;
+    for (const BatchRecvTensorStreams::Result& result : results) {
+      s.Update(result.status);
+    }
+    if (s.ok()) {
+      const int64_t send_start_micros = env_->env->NowMicros();
+      for (const BatchRecvTensorStreams::Result& result : results) {
+        BatchRecvTensorResponse::Entry* entry = response->add_entry();
+        entry->set_rendezvous_key(result.key);
+        RecvTensorResponse* tensor_response = entry->mutable_response();
+        tensor_response->set_is_dead(result.is_dead);
+        tensor_response->set_send_start_micros(send_start_micros);
+        if (DataTypeCanUseMemcpy(result.tensor.dtype())) {
+          result.tensor.AsProtoTensorContent(tensor_response->mutable_tensor());
+        } else {
+          result.tensor.AsProtoField(tensor_response->mutable_tensor());
+        }
+      }
+    }
+    done(s);
+  };
+
+  batch_recv_streams_.Poll(step_id, request->stream_id(), keys, start_recv,
+                           std::move(poll_done));
+}
+
 namespace {
 // If RecvBufRespExtra.tensor_content is a single large string, then gRPC
 // can stall on the recv side when the string buffer needs to be enlarged,
@@ -736,6 +832,7 @@ void GrpcWorker::CleanupGraphAsync(const CleanupGraphRequest* request,
     // a worker crashes before acking a request.
     response_cache_->CleanEntriesForStep(request->step_id());
   }
+  batch_recv_streams_.CleanupStep(request->step_id());
   Worker::CleanupGraphAsync(request, response, done);
 }
 
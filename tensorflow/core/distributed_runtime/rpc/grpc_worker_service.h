@@ -20,6 +20,7 @@ limitations under the License.
 #include <unordered_map>
 
 #include "grpcpp/server_builder.h"
+#include "tensorflow/core/distributed_runtime/rpc/batch_recv_tensor_streams.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
 #include "tensorflow/core/distributed_runtime/rpc/rpc_response_cache.h"
 #include "tensorflow/core/distributed_runtime/worker.h"
@@ -51,6 +52,11 @@ class GrpcWorker : public Worker {
                                    ::grpc::ByteBuffer* response,
                                    StatusCallback done);
 
+  void BatchRecvTensorAsync(CallOptions* opts,
+                            const BatchRecvTensorRequest* request,
+                            BatchRecvTensorResponse* response,
+                            StatusCallback done) override;
+
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
                     StatusCallback done) override;
 
@@ -68,7 +74,13 @@ class GrpcWorker : public Worker {
   void RemoveCacheEntryForId(int64_t request_id);
 
  private:
+  void RecvLocalOnHostAsync(
+      CallOptions* opts, int64_t step_id, const string& key,
+      const Rendezvous::ParsedKey& parsed, Device* src_dev,
+      std::function<void(const Tensor&, bool, const Status&)> done);
+
   std::unique_ptr<RpcResponseCache> response_cache_;
+  BatchRecvTensorStreams batch_recv_streams_;
   const int32 recv_buf_max_chunk_;
 };
 
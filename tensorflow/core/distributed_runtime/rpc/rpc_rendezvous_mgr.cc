@@ -15,6 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
@@ -25,17 +31,33 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/worker_interface.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
 namespace {
 
+class BatchRecvTensorStream;
+
+// Returns true if remote receives should be coalesced into BatchRecvTensor
+// streams, see `BatchRecvTensorRequest` in worker.proto.
+bool BatchRecvTensorEnabled() {
+  static const bool enabled = []() {
+    bool enabled;
+    TF_CHECK_OK(
+        ReadBoolFromEnvVar("TF_RPC_BATCH_RECV_TENSOR", false, &enabled));
+    return enabled;
+  }();
+  return enabled;
+}
+
 class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  public:
   RpcRemoteRendezvous(const WorkerEnv* env, int64_t step_id)
@@ -47,7 +69,31 @@ class RpcRemoteRendezvous : public BaseRemoteRendezvous {
                            DoneCallback done) override;
 
  private:
-  ~RpcRemoteRendezvous() override {}
+  friend class BatchRecvTensorStream;
+
+  ~RpcRemoteRendezvous() override;
+
+  // Issues one RecvTensor call for `parsed`.
+  void RecvSingleFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
+                                 const Rendezvous::Args& args,
+                                 DoneCallback done);
+
+  // Returns the stream for the receives from `src_worker` that share
+  // `cancellation_manager`, or nullptr if `src_worker` has reported that it
+  // does not serve BatchRecvTensor.
+  BatchRecvTensorStream* GetBatchRecvStream(
+      const string& src_worker, CancellationManager* cancellation_manager);
+
+  void MarkBatchRecvUnsupported(const string& src_worker);
+
+  mutex streams_mu_;
+  // Streams are kept for the lifetime of the step, as a poll in flight holds
+  // a reference on this rendezvous.
+  absl::flat_hash_map<std::pair<string, CancellationManager*>,
+                      std::unique_ptr<BatchRecvTensorStream>>
+      batch_recv_streams_ TF_GUARDED_BY(streams_mu_);
+  absl::flat_hash_set<string> batch_recv_unsupported_
+      TF_GUARDED_BY(streams_mu_);
 
   RpcRemoteRendezvous(const RpcRemoteRendezvous&) = delete;
   void operator=(const RpcRemoteRendezvous&) = delete;
@@ -230,10 +276,293 @@ static RpcRecvTensorFreeList* get_call_freelist() {
   return call_freelist;
 }
 
+// Coalesces the receives of one step from one source worker into
+// long-polled BatchRecvTensor calls. The keys of the receives started in a
+// burst go out together in one poll, and the worker answers a poll with every
+// value that became ready in the meantime. While receives are outstanding
+// there is always a poll in flight; a poll carrying new keys supersedes the
+// one in flight on the worker, so new keys never wait behind a slow one.
+class BatchRecvTensorStream {
+ public:
+  BatchRecvTensorStream(RpcRemoteRendezvous* rendezvous, string src_worker,
+                        CancellationManager* cancellation_manager)
+      : rendezvous_(rendezvous),
+        src_worker_(std::move(src_worker)),
+        stream_id_(GetUniqueRequestId()) {
+    args_.cancellation_manager = cancellation_manager;
+  }
+
+  // Queues the receive of `parsed`, and schedules a poll to send its key.
+  void Recv(const Rendezvous::ParsedKey& parsed, Device* dst_device,
+            const Rendezvous::Args& recv_args,
+            Rendezvous::DoneCallback done) {
+    string key(parsed.FullKey());
+    bool schedule_flush = false;
+    Status s;
+    {
+      mutex_lock l(mu_);
+      s = status_;
+      if (s.ok()) {
+        unsent_keys_.push_back(key);
+        pending_.emplace(std::move(key), PendingRecv{parsed, dst_device,
+                                                     recv_args,
+                                                     std::move(done)});
+        schedule_flush = !flush_scheduled_;
+        flush_scheduled_ = true;
+      }
+    }
+    if (!s.ok()) {
+      done(s, Rendezvous::Args(), recv_args, Tensor(), false);
+      return;
+    }
+    if (schedule_flush) {
+      // Deferring the poll lets the receives started by the same executor
+      // burst share it.
+      rendezvous_->Ref();
+      rendezvous_->env_->compute_pool->Schedule([this]() {
+        RpcRemoteRendezvous* rendezvous = rendezvous_;
+        StartPoll();
+        rendezvous->Unref();
+      });
+    }
+  }
+
+ private:
+  struct PendingRecv {
+    Rendezvous::ParsedKey parsed;
+    Device* dst_device;
+    Rendezvous::Args recv_args;
+    Rendezvous::DoneCallback done;
+  };
+
+  // One BatchRecvTensor call, registered with the rendezvous while in flight
+  // so that it can be aborted.
+  class PollCall : public BaseRecvTensorCall {
+   public:
+    void Start(std::function<void()> recv_done) override {
+      LOG(FATAL) << "PollCall is started by BatchRecvTensorStream.";
+    }
+
+    void StartAbort(const Status& s) override {
+      {
+        mutex_lock l(mu_);
+        status_.Update(s);
+      }
+      opts.StartCancel();
+    }
+
+    Status status() const override {
+      mutex_lock l(mu_);
+      return status_;
+    }
+
+    CallOptions opts;
+    BatchRecvTensorRequest request;
+    BatchRecvTensorResponse response;
+
+   private:
+    mutable mutex mu_;
+    Status status_ TF_GUARDED_BY(mu_);
+  };
+
+  // Sends the unsent keys, if any, in a new poll. Also sends a poll without
+  // keys if receives are outstanding and no poll is in flight.
+  void StartPoll() {
+    PollCall* poll = new PollCall;
+    {
+      mutex_lock l(mu_);
+      flush_scheduled_ = false;
+      if (unsent_keys_.empty() &&
+          (num_polls_in_flight_ > 0 || pending_.empty())) {
+        delete poll;
+        return;
+      }
+      poll->request.set_step_id(rendezvous_->step_id_);
+      poll->request.set_stream_id(stream_id_);
+      for (string& key : unsent_keys_) {
+        poll->request.add_rendezvous_key(std::move(key));
+      }
+      unsent_keys_.clear();
+      ++num_polls_in_flight_;
+    }
+
+    rendezvous_->RegisterCall(poll, args_);
+    std::shared_ptr<WorkerCacheInterface> worker_cache =
+        rendezvous_->session()->GetSharedWorkerCache();
+    WorkerInterface* wi = nullptr;
+    Status s = poll->status();
+    if (s.ok()) {
+      wi = worker_cache->GetOrCreateWorker(src_worker_);
+      if (wi == nullptr) {
+        s = errors::Internal("No worker known as ", src_worker_);
+      }
+    }
+    if (!s.ok()) {
+      FinishPoll(poll, s);
+      return;
+    }
+
+    rendezvous_->Ref();
+    auto abort_checked = std::make_shared<Notification>();
+    wi->BatchRecvTensorAsync(
+        &poll->opts, &poll->request, &poll->response,
+        [this, poll, wi, worker_cache, abort_checked](const Status& s) {
+          // See RpcRecvTensorCall::StartRTCall().
+          abort_checked->WaitForNotification();
+          worker_cache->ReleaseWorker(src_worker_, wi);
+          RpcRemoteRendezvous* rendezvous = rendezvous_;
+          FinishPoll(poll, s);
+          rendezvous->Unref();
+        });
+    // An abort that raced with sending the call could not cancel it yet; see
+    // RpcRecvTensorCall::StartRTCall().
+    if (!poll->status().ok()) {
+      poll->opts.StartCancel();
+    }
+    abort_checked->Notify();
+  }
+
+  // Completes the receives answered by `poll`, and polls again if receives
+  // are still outstanding and no other poll is in flight.
+  void FinishPoll(PollCall* poll, Status s) {
+    rendezvous_->DeregisterCall(poll, args_);
+    // If the poll was aborted, report the abort rather than the cancellation.
+    if (!poll->status().ok()) s = poll->status();
+
+    std::vector<std::function<void()>> callbacks;
+    std::vector<PendingRecv> fallback;
+    bool poll_again;
+    {
+      mutex_lock l(mu_);
+      --num_polls_in_flight_;
+      if (s.ok()) {
+        for (BatchRecvTensorResponse::Entry& entry :
+             *poll->response.mutable_entry()) {
+          auto it = pending_.find(entry.rendezvous_key());
+          if (it == pending_.end()) {
+            LOG(WARNING) << "Unexpected BatchRecvTensor response for "
+                         << entry.rendezvous_key();
+            continue;
+          }
+          PendingRecv recv = std::move(it->second);
+          pending_.erase(it);
+          TensorResponse tensor_response;
+          tensor_response.InitAlloc(recv.dst_device,
+                                    recv.recv_args.alloc_attrs);
+          Status recv_status =
+              tensor_response.InitFrom(entry.mutable_response());
+          callbacks.push_back(
+              [recv = std::move(recv), recv_status,
+               tensor = tensor_response.tensor(),
+               is_dead = tensor_response.metadata().is_dead()]() {
+                recv.done(recv_status, Rendezvous::Args(), recv.recv_args,
+                          tensor, is_dead);
+              });
+        }
+      } else {
+        // Either the source worker does not serve BatchRecvTensor, and the
+        // receives are issued one by one, or the step is going down.
+        const bool unsupported = errors::IsUnimplemented(s);
+        if (!unsupported) status_.Update(s);
+        for (auto& it : pending_) {
+          PendingRecv& recv = it.second;
+          if (unsupported) {
+            fallback.push_back(std::move(recv));
+          } else {
+            callbacks.push_back([recv = std::move(recv), s]() {
+              recv.done(s, Rendezvous::Args(), recv.recv_args, Tensor(),
+                        false);
+            });
+          }
+        }
+        pending_.clear();
+        unsent_keys_.clear();
+      }
+      poll_again = num_polls_in_flight_ == 0 && !pending_.empty();
+    }
+    delete poll;
+
+    if (!fallback.empty()) {
+      VLOG(1) << "Worker " << src_worker_
+              << " does not serve BatchRecvTensor: " << s;
+      rendezvous_->MarkBatchRecvUnsupported(src_worker_);
+      for (PendingRecv& recv : fallback) {
+        rendezvous_->RecvSingleFromRemoteAsync(recv.parsed, recv.recv_args,
+                                               std::move(recv.done));
+      }
+    }
+    for (auto& callback : callbacks) {
+      callback();
+    }
+    if (poll_again) StartPoll();
+  }
+
+  RpcRemoteRendezvous* const rendezvous_;  // Not owned.
+  const string src_worker_;
+  const int64_t stream_id_;
+  Rendezvous::Args args_;
+
+  mutex mu_;
+  Status status_ TF_GUARDED_BY(mu_);
+  bool flush_scheduled_ TF_GUARDED_BY(mu_) = false;
+  int num_polls_in_flight_ TF_GUARDED_BY(mu_) = 0;
+  std::vector<string> unsent_keys_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<string, PendingRecv> pending_ TF_GUARDED_BY(mu_);
+
+  BatchRecvTensorStream(const BatchRecvTensorStream&) = delete;
+  void operator=(const BatchRecvTensorStream&) = delete;
+};
+
+RpcRemoteRendezvous::~RpcRemoteRendezvous() {}
+
+BatchRecvTensorStream* RpcRemoteRendezvous::GetBatchRecvStream(
+    const string& src_worker, CancellationManager* cancellation_manager) {
+  mutex_lock l(streams_mu_);
+  if (batch_recv_unsupported_.contains(src_worker)) return nullptr;
+  std::unique_ptr<BatchRecvTensorStream>& stream =
+      batch_recv_streams_[{src_worker, cancellation_manager}];
+  if (stream == nullptr) {
+    stream = std::make_unique<BatchRecvTensorStream>(this, src_worker,
+                                                     cancellation_manager);
+  }
+  return stream.get();
+}
+
+void RpcRemoteRendezvous::MarkBatchRecvUnsupported(const string& src_worker) {
+  mutex_lock l(streams_mu_);
+  batch_recv_unsupported_.insert(src_worker);
+}
+
 void RpcRemoteRendezvous::RecvFromRemoteAsync(
     const Rendezvous::ParsedKey& parsed, const Rendezvous::Args& recv_args,
     DoneCallback done) {
   CHECK(is_initialized());
+  if (BatchRecvTensorEnabled()) {
+    string src_worker;
+    string src_rel_device;
+    BatchRecvTensorStream* stream = nullptr;
+    if (DeviceNameUtils::SplitDeviceName(parsed.src_device, &src_worker,
+                                         &src_rel_device)) {
+      stream = GetBatchRecvStream(src_worker, recv_args.cancellation_manager);
+    }
+    if (stream != nullptr) {
+      Device* dst_device;
+      Status s = session()->device_mgr()->LookupDevice(parsed.dst_device,
+                                                       &dst_device);
+      if (!s.ok()) {
+        done(s, Args(), recv_args, Tensor{}, false);
+        return;
+      }
+      stream->Recv(parsed, dst_device, recv_args, std::move(done));
+      return;
+    }
+  }
+  RecvSingleFromRemoteAsync(parsed, recv_args, std::move(done));
+}
+
+void RpcRemoteRendezvous::RecvSingleFromRemoteAsync(
+    const Rendezvous::ParsedKey& parsed, const Rendezvous::Args& recv_args,
+    DoneCallback done) {
   Status s;
 
   // Prepare a RecvTensor call that can handle being aborted.
@@ -0,0 +1,356 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/shared_memory_tensor.h"
+
+#ifndef PLATFORM_WINDOWS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // PLATFORM_WINDOWS
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+size_t RoundUp(size_t value, size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+// The regions mapped into this process, by name and by base address. Regions
+// remove themselves when they are destroyed.
+struct RegionRegistry {
+  mutex mu;
+  absl::flat_hash_map<std::string, SharedMemoryRegion*> by_name
+      TF_GUARDED_BY(mu);
+  std::map<const char*, SharedMemoryRegion*> by_base TF_GUARDED_BY(mu);
+};
+
+RegionRegistry* GetRegistry() {
+  static RegionRegistry* registry = new RegionRegistry;
+  return registry;
+}
+
+}  // namespace
+
+SharedMemoryRegion::SharedMemoryRegion(std::string name, char* base,
+                                       size_t size)
+    : name_(std::move(name)), base_(base), size_(size) {
+  RegionRegistry* registry = GetRegistry();
+  mutex_lock l(registry->mu);
+  registry->by_name[name_] = this;
+  registry->by_base[base_] = this;
+}
+
+SharedMemoryRegion::~SharedMemoryRegion() {
+  {
+    RegionRegistry* registry = GetRegistry();
+    mutex_lock l(registry->mu);
+    auto it = registry->by_name.find(name_);
+    if (it != registry->by_name.end() && it->second == this) {
+      registry->by_name.erase(it);
+    }
+    registry->by_base.erase(base_);
+  }
+#ifndef PLATFORM_WINDOWS
+  if (munmap(base_, size_) != 0) {
+    LOG(WARNING) << "Failed to unmap shared memory region " << name_ << ": "
+                 << strerror(errno);
+  }
+#endif  // PLATFORM_WINDOWS
+}
+
+Status SharedMemoryRegion::Create(
+    const std::string& name, size_t size,
+    core::RefCountPtr<SharedMemoryRegion>* region) {
+#ifdef PLATFORM_WINDOWS
+  return errors::Unimplemented("Shared memory regions are not supported.");
+#else
+  if (size == 0) {
+    return errors::InvalidArgument("Shared memory region ", name,
+                                   " must not be empty.");
+  }
+  const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    return errors::IOError(strings::StrCat("Creating ", name), errno);
+  }
+  if (ftruncate(fd, size) != 0) {
+    const int error = errno;
+    close(fd);
+    shm_unlink(name.c_str());
+    return errors::IOError(strings::StrCat("Resizing ", name), error);
+  }
+  void* base =
+      mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, /*offset=*/0);
+  const int error = errno;
+  close(fd);
+  if (base == MAP_FAILED) {
+    shm_unlink(name.c_str());
+    return errors::IOError(strings::StrCat("Mapping ", name), error);
+  }
+  region->reset(
+      new SharedMemoryRegion(name, static_cast<char*>(base), size));
+  return absl::OkStatus();
+#endif  // PLATFORM_WINDOWS
+}
+
+Status SharedMemoryRegion::Open(const std::string& name,
+                                core::RefCountPtr<SharedMemoryRegion>* region) {
+  {
+    RegionRegistry* registry = GetRegistry();
+    mutex_lock l(registry->mu);
+    auto it = registry->by_name.find(name);
+    // The region may be in the process of being destroyed.
+    if (it != registry->by_name.end() && it->second->TryRef()) {
+      region->reset(it->second);
+      return absl::OkStatus();
+    }
+  }
+#ifdef PLATFORM_WINDOWS
+  return errors::Unimplemented("Shared memory regions are not supported.");
+#else
+  const int fd = shm_open(name.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    return errors::IOError(strings::StrCat("Opening ", name), errno);
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    const int error = errno;
+    close(fd);
+    return errors::IOError(strings::StrCat("Reading the size of ", name),
+                           error);
+  }
+  const size_t size = st.st_size;
+  if (size == 0) {
+    close(fd);
+    return errors::FailedPrecondition("Shared memory region ", name,
+                                      " is empty.");
+  }
+  void* base =
+      mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, /*offset=*/0);
+  const int error = errno;
+  close(fd);
+  if (base == MAP_FAILED) {
+    return errors::IOError(strings::StrCat("Mapping ", name), error);
+  }
+  region->reset(
+      new SharedMemoryRegion(name, static_cast<char*>(base), size));
+  return absl::OkStatus();
+#endif  // PLATFORM_WINDOWS
+}
+
+SharedMemoryRegion* SharedMemoryRegion::Find(const void* ptr) {
+  const char* p = static_cast<const char*>(ptr);
+  RegionRegistry* registry = GetRegistry();
+  mutex_lock l(registry->mu);
+  // The region with the highest base address that is not above `p`.
+  auto it = registry->by_base.upper_bound(p);
+  if (it == registry->by_base.begin()) return nullptr;
+  --it;
+  SharedMemoryRegion* region = it->second;
+  return p < region->base_ + region->size_ ? region : nullptr;
+}
+
+Status SharedMemoryRegion::Unlink() {
+#ifdef PLATFORM_WINDOWS
+  return errors::Unimplemented("Shared memory regions are not supported.");
+#else
+  if (shm_unlink(name_.c_str()) != 0) {
+    return errors::IOError(strings::StrCat("Unlinking ", name_), errno);
+  }
+  return absl::OkStatus();
+#endif  // PLATFORM_WINDOWS
+}
+
+SharedMemoryAllocator::SharedMemoryAllocator(
+    core::RefCountPtr<SharedMemoryRegion> region)
+    : region_(std::move(region)) {
+  mutex_lock l(mu_);
+  free_blocks_[0] = region_->size();
+  stats_.bytes_limit = region_->size();
+}
+
+SharedMemoryAllocator::~SharedMemoryAllocator() {
+  mutex_lock l(mu_);
+  if (!allocations_.empty()) {
+    LOG(ERROR) << allocations_.size()
+               << " tensors are still allocated in shared memory region "
+               << region_->name();
+  }
+}
+
+std::string SharedMemoryAllocator::Name() {
+  return strings::StrCat("shared_memory:", region_->name());
+}
+
+void* SharedMemoryAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  alignment = std::max(alignment, Allocator::kAllocatorAlignment);
+  const size_t size = RoundUp(std::max<size_t>(num_bytes, 1),
+                              Allocator::kAllocatorAlignment);
+  mutex_lock l(mu_);
+  for (auto it = free_blocks_.begin(); it != free_blocks_.end(); ++it) {
+    const size_t block_offset = it->first;
+    const size_t block_end = block_offset + it->second;
+    const size_t offset = RoundUp(block_offset, alignment);
+    if (offset + size > block_end) continue;
+    free_blocks_.erase(it);
+    // Keep the parts of the block before and after the allocation free.
+    if (offset > block_offset) {
+      free_blocks_[block_offset] = offset - block_offset;
+    }
+    if (offset + size < block_end) {
+      free_blocks_[offset + size] = block_end - offset - size;
+    }
+    allocations_[offset] = size;
+    ++stats_.num_allocs;
+    stats_.bytes_in_use += size;
+    stats_.peak_bytes_in_use =
+        std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
+    stats_.largest_alloc_size =
+        std::max<int64_t>(stats_.largest_alloc_size, size);
+    return region_->base() + offset;
+  }
+  LOG(WARNING) << "Shared memory region " << region_->name()
+               << " has no free block of " << size << " bytes.";
+  return nullptr;
+}
+
+void SharedMemoryAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) return;
+  const size_t offset = static_cast<char*>(ptr) - region_->base();
+  mutex_lock l(mu_);
+  auto allocation = allocations_.find(offset);
+  CHECK(allocation != allocations_.end())  // Crash OK
+      << "Freeing memory that was not allocated from " << Name();
+  size_t size = allocation->second;
+  allocations_.erase(allocation);
+  stats_.bytes_in_use -= size;
+
+  // Merge the freed memory with the adjacent free blocks.
+  size_t start = offset;
+  auto next = free_blocks_.lower_bound(offset);
+  if (next != free_blocks_.begin()) {
+    auto prev = std::prev(next);
+    if (prev->first + prev->second == offset) {
+      start = prev->first;
+      size += prev->second;
+      free_blocks_.erase(prev);
+    }
+  }
+  if (next != free_blocks_.end() && start + size == next->first) {
+    size += next->second;
+    free_blocks_.erase(next);
+  }
+  free_blocks_[start] = size;
+}
+
+size_t SharedMemoryAllocator::RequestedSize(const void* ptr) const {
+  return AllocatedSize(ptr);
+}
+
+size_t SharedMemoryAllocator::AllocatedSize(const void* ptr) const {
+  const size_t offset = static_cast<const char*>(ptr) - region_->base();
+  mutex_lock l(mu_);
+  auto it = allocations_.find(offset);
+  CHECK(it != allocations_.end())  // Crash OK
+      << "Memory was not allocated from " << region_->name();
+  return it->second;
+}
+
+std::optional<AllocatorStats> SharedMemoryAllocator::GetStats() {
+  mutex_lock l(mu_);
+  AllocatorStats stats = stats_;
+  size_t largest_free_block = 0;
+  for (const auto& block : free_blocks_) {
+    largest_free_block = std::max(largest_free_block, block.second);
+  }
+  stats.largest_free_block_bytes = largest_free_block;
+  return stats;
+}
+
+SharedMemoryTensorBuffer::SharedMemoryTensorBuffer(
+    core::RefCountPtr<SharedMemoryRegion> region, size_t offset, size_t size)
+    : TensorBuffer(region->base() + offset),
+      region_(std::move(region)),
+      size_(size) {}
+
+void SharedMemoryTensorBuffer::FillAllocationDescription(
+    AllocationDescription* proto) const {
+  proto->set_requested_bytes(size_);
+  proto->set_allocated_bytes(size_);
+  proto->set_allocator_name(
+      strings::StrCat("shared_memory:", region_->name()));
+}
+
+bool GetSharedMemoryTensorHandle(const Tensor& tensor,
+                                 SharedMemoryTensorHandle* handle) {
+  if (!DataTypeCanUseMemcpy(tensor.dtype()) || tensor.TotalBytes() == 0) {
+    return false;
+  }
+  const char* data = static_cast<const char*>(DMAHelper::base(&tensor));
+  SharedMemoryRegion* region = SharedMemoryRegion::Find(data);
+  if (region == nullptr) return false;
+  handle->set_region_name(region->name());
+  handle->set_offset(data - region->base());
+  handle->set_num_bytes(tensor.TotalBytes());
+  return true;
+}
+
+Status MapSharedMemoryTensor(const SharedMemoryTensorHandle& handle,
+                             DataType dtype, const TensorShape& shape,
+                             Tensor* tensor) {
+  if (!DataTypeCanUseMemcpy(dtype)) {
+    return errors::InvalidArgument("Cannot map a tensor of type ",
+                                   DataTypeString(dtype),
+                                   " from shared memory.");
+  }
+  const int64_t num_bytes = shape.num_elements() * DataTypeSize(dtype);
+  if (handle.num_bytes() != num_bytes) {
+    return errors::InvalidArgument(
+        "Shared memory tensor of shape ", shape.DebugString(), " and type ",
+        DataTypeString(dtype), " needs ", num_bytes, " bytes, but has ",
+        handle.num_bytes());
+  }
+  core::RefCountPtr<SharedMemoryRegion> region;
+  TF_RETURN_IF_ERROR(SharedMemoryRegion::Open(handle.region_name(), &region));
+  if (handle.offset() < 0 ||
+      static_cast<uint64_t>(handle.offset()) + num_bytes > region->size() ||
+      handle.offset() % Allocator::kAllocatorAlignment != 0) {
+    return errors::InvalidArgument("Invalid range [", handle.offset(), ", ",
+                                   handle.offset() + num_bytes,
+                                   ") in shared memory region ",
+                                   handle.region_name(), " of ",
+                                   region->size(), " bytes.");
+  }
+  auto* buffer = new SharedMemoryTensorBuffer(std::move(region),
+                                              handle.offset(), num_bytes);
+  *tensor = Tensor(dtype, shape, buffer);
+  buffer->Unref();
+  return absl::OkStatus();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,138 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_SHARED_MEMORY_TENSOR_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_SHARED_MEMORY_TENSOR_H_
+
+#include <cstddef>
+#include <map>
+#include <optional>
+#include <string>
+
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
+
+namespace tensorflow {
+
+// A named POSIX shared memory object, mapped into this process. Processes on
+// the same host that map the same object see the same memory, so a tensor
+// allocated in it can be passed between them by a SharedMemoryTensorHandle
+// instead of by copying its contents.
+class SharedMemoryRegion : public core::RefCounted {
+ public:
+  // Creates the shared memory object `name` (e.g. "/tf_images") with `size`
+  // bytes, and maps it. Fails if the object already exists.
+  static Status Create(const std::string& name, size_t size,
+                       core::RefCountPtr<SharedMemoryRegion>* region);
+
+  // Maps the existing shared memory object `name`. Reuses the mapping if this
+  // process already mapped it, so names must not be reused for different
+  // objects while the process runs.
+  static Status Open(const std::string& name,
+                     core::RefCountPtr<SharedMemoryRegion>* region);
+
+  // Returns the mapped region that contains `ptr`, or nullptr. The region
+  // stays valid as long as the memory at `ptr` is in use.
+  static SharedMemoryRegion* Find(const void* ptr);
+
+  // Removes the name of the object, so that no other process can open it.
+  // Existing mappings stay valid.
+  Status Unlink();
+
+  const std::string& name() const { return name_; }
+  char* base() const { return base_; }
+  size_t size() const { return size_; }
+
+ private:
+  SharedMemoryRegion(std::string name, char* base, size_t size);
+  ~SharedMemoryRegion() override;
+
+  const std::string name_;
+  char* const base_;
+  const size_t size_;
+};
+
+// An allocator that carves tensors out of a SharedMemoryRegion, with a
+// first-fit free list. It must outlive the tensors it allocates.
+class SharedMemoryAllocator : public Allocator {
+ public:
+  explicit SharedMemoryAllocator(core::RefCountPtr<SharedMemoryRegion> region);
+  ~SharedMemoryAllocator() override;
+
+  std::string Name() override;
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+  bool TracksAllocationSizes() const override { return true; }
+  size_t RequestedSize(const void* ptr) const override;
+  size_t AllocatedSize(const void* ptr) const override;
+  std::optional<AllocatorStats> GetStats() override;
+  AllocatorMemoryType GetMemoryType() const override {
+    return AllocatorMemoryType::kHostPageable;
+  }
+
+  SharedMemoryRegion* region() const { return region_.get(); }
+
+ private:
+  const core::RefCountPtr<SharedMemoryRegion> region_;
+
+  mutable mutex mu_;
+  // Maps the offset of every free block in the region to its size. Adjacent
+  // free blocks are always merged.
+  std::map<size_t, size_t> free_blocks_ TF_GUARDED_BY(mu_);
+  // Maps the offset of every allocation to its size.
+  std::map<size_t, size_t> allocations_ TF_GUARDED_BY(mu_);
+  AllocatorStats stats_ TF_GUARDED_BY(mu_);
+};
+
+// The buffer of a tensor whose contents live in a SharedMemoryRegion that
+// another process allocated them in. Keeps the region mapped while the
+// tensor is alive, but does not own the memory: the sending process must
+// keep its tensor alive until the receiver is done with it.
+class SharedMemoryTensorBuffer : public TensorBuffer {
+ public:
+  SharedMemoryTensorBuffer(core::RefCountPtr<SharedMemoryRegion> region,
+                           size_t offset, size_t size);
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override;
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const core::RefCountPtr<SharedMemoryRegion> region_;
+  const size_t size_;
+};
+
+// Sets `handle` to the location of the contents of `tensor`, if they live in
+// a SharedMemoryRegion. Returns false otherwise, or if the type of `tensor`
+// cannot be copied with memcpy.
+bool GetSharedMemoryTensorHandle(const Tensor& tensor,
+                                 SharedMemoryTensorHandle* handle);
+
+// Sets `tensor` to a tensor of `dtype` and `shape` that maps the contents
+// located by `handle`, without copying them.
+Status MapSharedMemoryTensor(const SharedMemoryTensorHandle& handle,
+                             DataType dtype, const TensorShape& shape,
+                             Tensor* tensor);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_SHARED_MEMORY_TENSOR_H_
@@ -0,0 +1,127 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/shared_memory_tensor.h"
+
+#include <unistd.h>
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr size_t kRegionSize = 1 << 16;
+
+class SharedMemoryTensorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    name_ = strings::StrCat("/tf_shared_memory_tensor_test_", getpid());
+    TF_ASSERT_OK(SharedMemoryRegion::Create(name_, kRegionSize, &region_));
+  }
+
+  void TearDown() override {
+    if (region_) TF_EXPECT_OK(region_->Unlink());
+  }
+
+  std::string name_;
+  core::RefCountPtr<SharedMemoryRegion> region_;
+};
+
+TEST_F(SharedMemoryTensorTest, CreateFailsIfTheRegionExists) {
+  core::RefCountPtr<SharedMemoryRegion> other;
+  EXPECT_FALSE(SharedMemoryRegion::Create(name_, kRegionSize, &other).ok());
+}
+
+TEST_F(SharedMemoryTensorTest, OpenReusesTheMapping) {
+  core::RefCountPtr<SharedMemoryRegion> opened;
+  TF_ASSERT_OK(SharedMemoryRegion::Open(name_, &opened));
+  EXPECT_EQ(region_.get(), opened.get());
+  EXPECT_EQ(kRegionSize, opened->size());
+}
+
+TEST_F(SharedMemoryTensorTest, FindLocatesTheRegion) {
+  EXPECT_EQ(region_.get(), SharedMemoryRegion::Find(region_->base()));
+  EXPECT_EQ(region_.get(),
+            SharedMemoryRegion::Find(region_->base() + kRegionSize - 1));
+  EXPECT_EQ(nullptr, SharedMemoryRegion::Find(region_->base() + kRegionSize));
+  int on_stack = 0;
+  EXPECT_EQ(nullptr, SharedMemoryRegion::Find(&on_stack));
+}
+
+TEST_F(SharedMemoryTensorTest, AllocatorReusesFreedBlocks) {
+  SharedMemoryAllocator allocator(region_.GetNewRef());
+  void* a = allocator.AllocateRaw(64, 1000);
+  void* b = allocator.AllocateRaw(64, 1000);
+  void* c = allocator.AllocateRaw(64, 1000);
+  ASSERT_NE(nullptr, a);
+  ASSERT_NE(nullptr, b);
+  ASSERT_NE(nullptr, c);
+  EXPECT_EQ(uintptr_t{0}, reinterpret_cast<uintptr_t>(b) % 64);
+  EXPECT_EQ(size_t{1024}, allocator.AllocatedSize(a));
+
+  // Freeing the two first blocks merges them into one that fits 2000 bytes.
+  allocator.DeallocateRaw(b);
+  allocator.DeallocateRaw(a);
+  void* d = allocator.AllocateRaw(64, 2000);
+  EXPECT_EQ(a, d);
+
+  // The region cannot fit more than its size.
+  EXPECT_EQ(nullptr, allocator.AllocateRaw(64, kRegionSize));
+  allocator.DeallocateRaw(c);
+  allocator.DeallocateRaw(d);
+  EXPECT_NE(nullptr, allocator.AllocateRaw(64, kRegionSize));
+  EXPECT_EQ(int64_t{kRegionSize}, allocator.GetStats()->peak_bytes_in_use);
+  allocator.DeallocateRaw(region_->base());
+  EXPECT_EQ(0, allocator.GetStats()->bytes_in_use);
+}
+
+TEST_F(SharedMemoryTensorTest, HandleRoundTrip) {
+  SharedMemoryAllocator allocator(region_.GetNewRef());
+  Tensor unused(&allocator, DT_INT32, TensorShape({3}));
+  Tensor src(&allocator, DT_INT32, TensorShape({2, 2}));
+  test::FillValues<int32>(&src, {1, 2, 3, 4});
+
+  SharedMemoryTensorHandle handle;
+  ASSERT_TRUE(GetSharedMemoryTensorHandle(src, &handle));
+  EXPECT_EQ(name_, handle.region_name());
+  EXPECT_EQ(16, handle.num_bytes());
+  EXPECT_LT(0, handle.offset());
+
+  Tensor mapped;
+  TF_ASSERT_OK(
+      MapSharedMemoryTensor(handle, DT_INT32, TensorShape({4}), &mapped));
+  test::ExpectTensorEqual<int32>(test::AsTensor<int32>({1, 2, 3, 4}), mapped);
+  // Writes by the sender are visible through the mapping.
+  src.flat<int32>()(0) = 5;
+  EXPECT_EQ(5, mapped.flat<int32>()(0));
+
+  EXPECT_FALSE(
+      MapSharedMemoryTensor(handle, DT_INT32, TensorShape({5}), &mapped).ok());
+  EXPECT_FALSE(
+      MapSharedMemoryTensor(handle, DT_STRING, TensorShape({2}), &mapped)
+          .ok());
+  handle.set_offset(kRegionSize - 8);
+  EXPECT_FALSE(
+      MapSharedMemoryTensor(handle, DT_INT32, TensorShape({4}), &mapped).ok());
+
+  Tensor not_shared(DT_INT32, TensorShape({2}));
+  EXPECT_FALSE(GetSharedMemoryTensorHandle(not_shared, &handle));
+}
+
+}  // namespace
+}  // namespace tensorflow
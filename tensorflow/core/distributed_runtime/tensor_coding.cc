@@ -18,8 +18,11 @@ limitations under the License.
 #include "google/protobuf/any.pb.h"
 
 #include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/distributed_runtime/shared_memory_tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
 
 namespace tensorflow {
 
@@ -53,7 +56,11 @@ void TensorResponse::InitAlloc(DeviceBase* d, const AllocatorAttributes& aa) {
 Status TensorResponse::InitFrom(RecvTensorResponse* response) {
   Status s;
   meta_.Swap(response);
-  if (on_host_) {
+  if (meta_.transport_options().Is<SharedMemoryTensorHandle>()) {
+    TensorShape shape;
+    s = TensorShape::BuildTensorShape(meta_.tensor().tensor_shape(), &shape);
+    if (s.ok()) s = MapSharedMemoryTensor(meta_.tensor().dtype(), shape);
+  } else if (on_host_) {
     if (!tensor_.FromProto(allocator_, meta_.tensor())) {
       s = errors::InvalidArgument("Cannot parse tensor from response");
     }
@@ -87,6 +94,10 @@ Status TensorResponse::ParseFrom(Source* source) {
     if (!meta_.ParseFromCodedStream(&input) || !input.ConsumedEntireMessage()) {
       return errors::InvalidArgument("Cannot parse tensor from response");
     }
+    if (meta_.transport_options().Is<SharedMemoryTensorHandle>()) {
+      return errors::Unimplemented(
+          "Shared memory tensors can only be received into host memory.");
+    }
     Status s =
         device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_, &tensor_);
     // Reduce memory usage for big tensors.
@@ -101,10 +112,47 @@ Status TensorResponse::ParseFrom(Source* source) {
     ClearTensor();
   }
   already_used_ = true;
-  if (ParseFast(source)) return absl::OkStatus();
-  meta_.Clear();
-  if (ParseSlow(source)) return absl::OkStatus();
-  return errors::InvalidArgument("Cannot parse tensor from response");
+  bool parsed = ParseFast(source);
+  if (!parsed) {
+    meta_.Clear();
+    parsed = ParseSlow(source);
+  }
+  if (!parsed) {
+    return errors::InvalidArgument("Cannot parse tensor from response");
+  }
+  if (meta_.transport_options().Is<SharedMemoryTensorHandle>()) {
+    return MapSharedMemoryTensor(tensor_.dtype(), tensor_.shape());
+  }
+  return absl::OkStatus();
+}
+
+Status TensorResponse::MapSharedMemoryTensor(DataType dtype,
+                                             const TensorShape& shape) {
+  if (!on_host_) {
+    return errors::Unimplemented(
+        "Shared memory tensors can only be received into host memory.");
+  }
+  SharedMemoryTensorHandle handle;
+  if (!meta_.transport_options().UnpackTo(&handle)) {
+    return errors::InvalidArgument("Cannot parse shared memory tensor handle");
+  }
+  Tensor mapped;
+  TF_RETURN_IF_ERROR(
+      tensorflow::MapSharedMemoryTensor(handle, dtype, shape, &mapped));
+  tensor_ = std::move(mapped);
+  return absl::OkStatus();
+}
+
+bool SetSharedMemoryTensorInResponse(const Tensor& tensor,
+                                     RecvTensorResponse* response) {
+  SharedMemoryTensorHandle handle;
+  if (!GetSharedMemoryTensorHandle(tensor, &handle)) return false;
+  TensorProto* proto = response->mutable_tensor();
+  proto->Clear();
+  proto->set_dtype(tensor.dtype());
+  tensor.shape().AsProto(proto->mutable_tensor_shape());
+  response->mutable_transport_options()->PackFrom(handle);
+  return true;
 }
 
 // Define some helper routines for decoding protocol buffer wire format data
@@ -143,9 +191,37 @@ bool ReadNestedMessage(protobuf::io::CodedInputStream* input,
 
 }  // namespace
 
+bool TensorResponse::ReadTensorContent(Source* source,
+                                       protobuf::io::CodedInputStream* input,
+                                       DataType dtype, const TensorShape& shape,
+                                       int num_bytes) {
+  const size_t expected_bytes = shape.num_elements() * DataTypeSize(dtype);
+  if (static_cast<size_t>(num_bytes) != expected_bytes) return false;
+  // Only plain host memory can be backed by the received bytes; memory that
+  // must be registered with a GPU or NIC is allocated as usual.
+  if (num_bytes > 0 && !alloc_attrs_.gpu_compatible() &&
+      !alloc_attrs_.nic_compatible()) {
+    TensorBuffer* shared =
+        source->ShareContents(input->CurrentPosition(), num_bytes);
+    if (shared != nullptr) {
+      tensor_ = Tensor(dtype, shape, shared);
+      shared->Unref();
+      return input->Skip(num_bytes);
+    }
+  }
+  Tensor t(allocator_, dtype, shape);
+  StringPiece buf = t.tensor_data();
+  if (!input->ReadRaw(const_cast<char*>(buf.data()), num_bytes)) return false;
+  tensor_ = std::move(t);
+  return true;
+}
+
 bool TensorResponse::ParseTensorSubmessage(
-    protobuf::io::CodedInputStream* input, TensorProto* tensor_meta) {
+    Source* source, protobuf::io::CodedInputStream* input,
+    TensorProto* tensor_meta) {
   bool seen_tensor_content = false;
+  // The number of string_val elements read into tensor_ so far.
+  int64_t num_strings = 0;
   while (true) {
     auto p = input->ReadTagWithCutoff(127);
     int tag = GetTagFieldNumber(p.first);
@@ -155,8 +231,14 @@ bool TensorResponse::ParseTensorSubmessage(
       if (ok && !seen_tensor_content) {
         // No tensor content: could be because it's a zero-length tensor
         TensorShape shape(tensor_meta->tensor_shape());
+        if (tensor_meta->dtype() == DT_STRING && shape.num_elements() > 0) {
+          // Strings are either all present, or left to the slow path.
+          return false;
+        }
         Tensor t(allocator_, tensor_meta->dtype(), shape);
         tensor_ = std::move(t);
+      } else if (ok && tensor_meta->dtype() == DT_STRING) {
+        ok = (num_strings == tensor_.NumElements());
       }
       return ok;
     }
@@ -166,7 +248,10 @@ bool TensorResponse::ParseTensorSubmessage(
         if ((wt != WIRETYPE_VARINT) || !input->ReadVarint32(&v)) return false;
         if (seen_tensor_content) return false;
         tensor_meta->set_dtype(static_cast<DataType>(static_cast<int>(v)));
-        if (!DataTypeCanUseMemcpy(tensor_meta->dtype())) return false;
+        if (!DataTypeCanUseMemcpy(tensor_meta->dtype()) &&
+            tensor_meta->dtype() != DT_STRING) {
+          return false;
+        }
         break;
       }
       case TensorProto::kTensorShapeFieldNumber: {
@@ -188,21 +273,63 @@ bool TensorResponse::ParseTensorSubmessage(
         // deal with this in the fast path.
         if (seen_tensor_content) return false;
         if (wt != WIRETYPE_LENGTH_DELIMITED ||
-            !tensor_meta->has_tensor_shape()) {
+            !tensor_meta->has_tensor_shape() ||
+            !DataTypeCanUseMemcpy(tensor_meta->dtype())) {
           return false;
         }
         int num_bytes;
         if (!ReadVarintSizeAsInt(input, &num_bytes)) return false;
         seen_tensor_content = true;
         TensorShape shape(tensor_meta->tensor_shape());
-        Tensor t(allocator_, tensor_meta->dtype(), shape);
-        StringPiece buf = t.tensor_data();
-        if (static_cast<size_t>(num_bytes) != buf.size()) return false;
-        // TODO(jeff,sanjay): Figure out a way to avoid this copy if
-        // the underlying ZeroCopyInputStream data is properly aligned
-        // and compatible with what allocator_ wants.
-        if (!input->ReadRaw(const_cast<char*>(buf.data()), num_bytes))
+        if (!ReadTensorContent(source, input, tensor_meta->dtype(), shape,
+                               num_bytes)) {
+          return false;
+        }
+        break;
+      }
+      case TensorProto::kStringValFieldNumber: {
+        // Decodes each string straight into the tensor, rather than into a
+        // TensorProto that would then be copied into the tensor.
+        if (wt != WIRETYPE_LENGTH_DELIMITED ||
+            tensor_meta->dtype() != DT_STRING ||
+            !tensor_meta->has_tensor_shape()) {
+          return false;
+        }
+        if (!seen_tensor_content) {
+          seen_tensor_content = true;
+          TensorShape shape(tensor_meta->tensor_shape());
+          Tensor t(allocator_, DT_STRING, shape);
+          tensor_ = std::move(t);
+        }
+        int num_bytes;
+        if (!ReadVarintSizeAsInt(input, &num_bytes)) return false;
+        if (num_strings >= tensor_.NumElements()) return false;
+        tstring& value = tensor_.flat<tstring>()(num_strings++);
+        value.resize_uninitialized(num_bytes);
+        if (!input->ReadRaw(value.mdata(), num_bytes)) return false;
+        break;
+      }
+      case TensorProto::kFloatValFieldNumber:
+      case TensorProto::kDoubleValFieldNumber:
+      case TensorProto::kIntValFieldNumber:
+      case TensorProto::kInt64ValFieldNumber:
+      case TensorProto::kBoolValFieldNumber:
+      case TensorProto::kUint32ValFieldNumber:
+      case TensorProto::kUint64ValFieldNumber: {
+        // Decodes packed values straight into the tensor too.
+        if (seen_tensor_content || wt != WIRETYPE_LENGTH_DELIMITED ||
+            tensor_meta->dtype() == DT_INVALID ||
+            !tensor_meta->has_tensor_shape()) {
           return false;
+        }
+        int num_bytes;
+        if (!ReadVarintSizeAsInt(input, &num_bytes)) return false;
+        seen_tensor_content = true;
+        Tensor t(allocator_, tensor_meta->dtype(),
+                 TensorShape(tensor_meta->tensor_shape()));
+        if (!tensor::DecodePackedTensorProtoField(input, tag, num_bytes, &t)) {
+          return false;
+        }
         tensor_ = std::move(t);
         break;
       }
@@ -233,7 +360,7 @@ bool TensorResponse::ParseFast(Source* source) {
         std::pair<protobuf::io::CodedInputStream::Limit, int> p =
             input.IncrementRecursionDepthAndPushLimit(length);
         if (p.second < 0 ||
-            !ParseTensorSubmessage(&input, meta_.mutable_tensor())) {
+            !ParseTensorSubmessage(source, &input, meta_.mutable_tensor())) {
           return false;
         }
         if (!input.DecrementRecursionDepthAndPopLimit(p.first)) {
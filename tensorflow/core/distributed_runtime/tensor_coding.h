@@ -63,6 +63,16 @@ class TensorResponse {
     // Ownership of the returned stream is retained by the Source and
     // should not be deleted by the caller.
     virtual ::tensorflow::protobuf::io::ZeroCopyInputStream* contents() = 0;
+
+    // Returns a buffer that shares the `num_bytes` bytes starting at byte
+    // `offset` of the serialized RecvTensorResponse, so that a tensor can be
+    // built over them without a copy. The caller takes the returned
+    // reference. Returns nullptr if the bytes cannot be shared, e.g. because
+    // they are not contiguous or not suitably aligned, in which case the
+    // caller copies them. The default implementation never shares.
+    virtual TensorBuffer* ShareContents(int64_t offset, size_t num_bytes) {
+      return nullptr;
+    }
   };
 
   // Parse the RecvTensorResponse encoded in the data yielded by
@@ -91,10 +101,20 @@ class TensorResponse {
   DeviceBase* device() const { return device_; }
 
  private:
-  bool ParseTensorSubmessage(protobuf::io::CodedInputStream* input,
+  bool ParseTensorSubmessage(Source* source,
+                             protobuf::io::CodedInputStream* input,
                              TensorProto* tensor_meta);
+  // Reads the `num_bytes` bytes of tensor content at the current position of
+  // `input` into a new tensor of `shape`, sharing them with `source` when
+  // possible.
+  bool ReadTensorContent(Source* source, protobuf::io::CodedInputStream* input,
+                         DataType dtype, const TensorShape& shape,
+                         int num_bytes);
   bool ParseFast(Source* source);
   bool ParseSlow(Source* source);
+  // Sets tensor_ to the tensor of `dtype` and `shape` in shared memory that
+  // the transport options of meta_ locate.
+  Status MapSharedMemoryTensor(DataType dtype, const TensorShape& shape);
 
   bool on_host_ = false;
   DeviceBase* device_ = nullptr;
@@ -105,6 +125,14 @@ class TensorResponse {
   RecvTensorResponse meta_;
 };
 
+// Sets *response to refer to the contents of `tensor` instead of carrying
+// them, if they live in shared memory (see shared_memory_tensor.h). The
+// receiver must be on the same host and the caller must keep `tensor`
+// alive until the receiver acknowledges the response. Returns false, and
+// leaves *response unchanged, if `tensor` is not in shared memory.
+bool SetSharedMemoryTensorInResponse(const Tensor& tensor,
+                                     RecvTensorResponse* response);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_CODING_H_
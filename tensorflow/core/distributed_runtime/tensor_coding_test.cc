@@ -15,10 +15,14 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 
+#include <unistd.h>
+
+#include "tensorflow/core/distributed_runtime/shared_memory_tensor.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
@@ -156,6 +160,35 @@ TEST_F(TensorResponseTest, Simple) {
 
 TEST_F(TensorResponseTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(TensorResponseTest, SharedMemoryTensor) {
+  core::RefCountPtr<SharedMemoryRegion> region;
+  TF_ASSERT_OK(SharedMemoryRegion::Create(
+      strings::StrCat("/tf_tensor_coding_test_", getpid()), 1 << 16, &region));
+  TF_ASSERT_OK(region->Unlink());
+  SharedMemoryAllocator allocator(region.GetNewRef());
+  Tensor src(&allocator, DT_FLOAT, TensorShape({2, 3}));
+  test::FillValues<float>(&src, {1, 2, 3, 4, 5, 6});
+
+  RecvTensorResponse proto;
+  ASSERT_TRUE(SetSharedMemoryTensorInResponse(src, &proto));
+  EXPECT_TRUE(proto.tensor().tensor_content().empty());
+  string encoded;
+  proto.AppendToString(&encoded);
+
+  StringSource source(&encoded, 1024);
+  TensorResponse response;
+  DummyDevice cpu_device(Env::Default());
+  response.InitAlloc(&cpu_device, AllocatorAttributes());
+  TF_ASSERT_OK(response.ParseFrom(&source));
+  const Tensor& result = response.tensor();
+  test::ExpectTensorEqual<float>(src, result);
+  // The contents are mapped rather than copied.
+  EXPECT_EQ(src.tensor_data().data(), result.tensor_data().data());
+
+  Tensor not_shared(DT_FLOAT, TensorShape({2}));
+  EXPECT_FALSE(SetSharedMemoryTensorInResponse(not_shared, &proto));
+}
+
 string MakeFloatTensorTestCase(int num_elems) {
   std::vector<int8> v(num_elems);
   for (int i = 0; i < num_elems; i++) {
@@ -145,6 +145,48 @@ Status Worker::PrepareRunGraph(RunGraphRequestWrapper* req,
   return absl::OkStatus();
 }
 
+Status Worker::PrepareStepTemplate(
+    RunGraphRequestWrapper* req, GraphMgr* graph_mgr,
+    std::shared_ptr<const GraphMgr::StepTemplate>* step_template) {
+  if (req->step_template_id() == 0) {
+    return absl::OkStatus();
+  }
+  if (!req->graph_handle().empty()) {
+    auto new_template = std::make_shared<GraphMgr::StepTemplate>();
+    new_template->graph_handle = req->graph_handle();
+    new_template->exec_opts = req->exec_opts();
+    new_template->send_keys.reserve(req->num_sends());
+    for (size_t i = 0; i < req->num_sends(); ++i) {
+      new_template->send_keys.push_back(req->send_key(i));
+    }
+    for (size_t i = 0; i < req->num_recvs(); ++i) {
+      new_template->recvs.insert({req->recv_key(i), Tensor(DT_FLOAT)});
+    }
+    return graph_mgr->RegisterStepTemplate(req->step_template_id(),
+                                           std::move(new_template));
+  }
+  return graph_mgr->LookupStepTemplate(req->step_template_id(),
+                                       step_template);
+}
+
+Status Worker::PrepareTemplatedRunGraph(
+    RunGraphRequestWrapper* req, const GraphMgr::StepTemplate& step_template,
+    GraphMgr::NamedTensors* in, GraphMgr::NamedTensors* out) {
+  if (req->num_sends() != step_template.send_keys.size()) {
+    return errors::InvalidArgument(
+        "Step template ", req->step_template_id(), " expects ",
+        step_template.send_keys.size(), " send values, but got ",
+        req->num_sends());
+  }
+  Tensor val;
+  for (size_t i = 0; i < req->num_sends(); ++i) {
+    TF_RETURN_IF_ERROR(req->SendValue(i, &val));
+    in->insert({step_template.send_keys[i], val});
+  }
+  *out = step_template.recvs;
+  return absl::OkStatus();
+}
+
 void Worker::RunGraphAsync(CallOptions* opts, RunGraphRequestWrapper* request,
                            MutableRunGraphResponseWrapper* response,
                            StatusCallback done) {
@@ -192,22 +234,33 @@ void Worker::DoRunGraph(CallOptions* opts, RunGraphRequestWrapper* request,
     done(s);
     return;
   }
+  std::shared_ptr<const GraphMgr::StepTemplate> step_template;
+  s = PrepareStepTemplate(request, session->graph_mgr(), &step_template);
+  if (!s.ok()) {
+    done(s);
+    return;
+  }
+  const string& graph_handle =
+      step_template ? step_template->graph_handle : request->graph_handle();
+  const ExecutorOpts& exec_opts =
+      step_template ? step_template->exec_opts : request->exec_opts();
   GraphMgr::NamedTensors in;
   GraphMgr::NamedTensors* out = new GraphMgr::NamedTensors;
-  s = PrepareRunGraph(request, &in, out);
+  s = step_template
+          ? PrepareTemplatedRunGraph(request, *step_template, &in, out)
+          : PrepareRunGraph(request, &in, out);
   if (!s.ok()) {
     delete out;
     done(s);
     return;
   }
   StepStatsCollector* collector = nullptr;
-  if (request->exec_opts().report_tensor_allocations_upon_oom() ||
-      request->exec_opts().record_timeline() ||
-      request->exec_opts().record_costs()) {
+  if (exec_opts.report_tensor_allocations_upon_oom() ||
+      exec_opts.record_timeline() || exec_opts.record_costs()) {
     collector = new StepStatsCollector(response->mutable_step_stats());
   }
   DeviceProfilerSession* device_profiler_session = nullptr;
-  if (collector && request->exec_opts().record_timeline()) {
+  if (collector && exec_opts.record_timeline()) {
     // If timeline was requested, assume we want hardware level tracing.
     device_profiler_session = DeviceProfilerSession::Create().release();
   }
@@ -231,10 +284,10 @@ void Worker::DoRunGraph(CallOptions* opts, RunGraphRequestWrapper* request,
     return;
   }
   session->graph_mgr()->ExecuteAsync(
-      request->graph_handle(), step_id, request->exec_opts(), in, session.get(),
-      collector, response, cm, env_->session_mgr->GetCoordinationServiceAgent(),
-      [this, step_id, response, session, cm, out, token, collector,
-       device_profiler_session, opts, done](const Status& status) {
+      graph_handle, step_id, exec_opts, in, session.get(), collector, response,
+      cm, env_->session_mgr->GetCoordinationServiceAgent(),
+      [this, step_id, response, session, step_template, cm, out, token,
+       collector, device_profiler_session, opts, done](const Status& status) {
         Status s = status;
         if (s.ok()) {
           s = session->graph_mgr()->RecvOutputs(step_id, out);
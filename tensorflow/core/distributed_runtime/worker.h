@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_WORKER_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_WORKER_H_
 
+#include <memory>
 #include <unordered_map>
 
 #include "tensorflow/core/distributed_runtime/graph_mgr.h"
@@ -126,6 +127,18 @@ class Worker : public WorkerInterface {
                          GraphMgr::NamedTensors* in,
                          GraphMgr::NamedTensors* out);
 
+  // If `req` records a step template, records it in `graph_mgr`. If `req`
+  // runs a step template, returns it in `*step_template`.
+  Status PrepareStepTemplate(
+      RunGraphRequestWrapper* req, GraphMgr* graph_mgr,
+      std::shared_ptr<const GraphMgr::StepTemplate>* step_template);
+
+  // Like PrepareRunGraph, for a request that runs `step_template`.
+  Status PrepareTemplatedRunGraph(RunGraphRequestWrapper* req,
+                                  const GraphMgr::StepTemplate& step_template,
+                                  GraphMgr::NamedTensors* in,
+                                  GraphMgr::NamedTensors* out);
+
   void DoRunGraph(CallOptions* opts, RunGraphRequestWrapper* request,
                   MutableRunGraphResponseWrapper* response,
                   StatusCallback done);
@@ -15,9 +15,16 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/worker_cache_logger.h"
 
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/tensor_description.pb.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -29,6 +36,33 @@ namespace {
 // Maximum number of step_ids for which RPC logs can be maintained.
 // TODO(mrry): Make this configurable if necessary.
 const int32_t kWorkerCacheLoggerLimit = 1 << 10;
+
+auto* transfer_queueing_usecs = monitoring::Sampler<2>::New(
+    {"/tensorflow/core/distributed_runtime/transfer_queueing_usecs",
+     "Time from issuing a tensor transfer RPC until the peer started to send "
+     "the response, in microseconds.",
+     "method", "peer"},
+    // Power of 2 with bucket count 25 (> 30 seconds)
+    {monitoring::Buckets::Exponential(1, 2, 25)});
+
+auto* transfer_wire_usecs = monitoring::Sampler<2>::New(
+    {"/tensorflow/core/distributed_runtime/transfer_wire_usecs",
+     "Time from the peer starting to send the response of a tensor transfer "
+     "RPC until it was received, in microseconds.",
+     "method", "peer"},
+    // Power of 2 with bucket count 25 (> 30 seconds)
+    {monitoring::Buckets::Exponential(1, 2, 25)});
+
+auto* transfer_bytes = monitoring::Counter<2>::New(
+    "/tensorflow/core/distributed_runtime/transfer_bytes",
+    "The number of bytes received by tensor transfer RPCs.", "method", "peer");
+
+double Median(std::vector<double> values) {
+  if (values.empty()) return 0;
+  auto middle = values.begin() + values.size() / 2;
+  std::nth_element(values.begin(), middle, values.end());
+  return *middle;
+}
 }  // namespace
 
 void WorkerCacheLogger::SetLogging(bool v) {
@@ -130,4 +164,82 @@ void WorkerCacheLogger::RecordDataTransfer(int64_t step_id, int64_t start_usecs,
   Save(dst_device, step_id, ns);
 }
 
+void WorkerCacheLogger::RecordTransferLatency(const string& method,
+                                              const string& peer,
+                                              int64_t start_usecs,
+                                              int64_t send_start_usecs,
+                                              int64_t end_usecs,
+                                              int64_t bytes) {
+  // Due to clock skew between the peers, the reported send start can be
+  // outside of [start_usecs, end_usecs], so clamp it as RecvTensor logging
+  // does.
+  if (send_start_usecs == 0) {
+    send_start_usecs = start_usecs;
+  }
+  send_start_usecs = std::min(std::max(start_usecs, send_start_usecs),
+                              std::max(start_usecs, end_usecs));
+  const int64_t queueing_usecs = send_start_usecs - start_usecs;
+  const int64_t wire_usecs = std::max<int64_t>(end_usecs - send_start_usecs, 0);
+
+  transfer_queueing_usecs->GetCell(method, peer)->Add(queueing_usecs);
+  transfer_wire_usecs->GetCell(method, peer)->Add(wire_usecs);
+  transfer_bytes->GetCell(method, peer)->IncrementBy(bytes);
+
+  mutex_lock l(transfer_stats_mu_);
+  TransferStats& stats = transfer_stats_[{peer, method}];
+  ++stats.count;
+  stats.bytes += bytes;
+  stats.queueing_usecs += queueing_usecs;
+  stats.wire_usecs += wire_usecs;
+}
+
+std::map<std::pair<string, string>, WorkerCacheLogger::TransferStats>
+WorkerCacheLogger::GetTransferStats() {
+  mutex_lock l(transfer_stats_mu_);
+  return transfer_stats_;
+}
+
+std::vector<WorkerCacheLogger::PeerSummary> WorkerCacheLogger::SummarizePeers(
+    double factor, int64_t min_count) {
+  std::map<string, TransferStats> per_peer;
+  {
+    mutex_lock l(transfer_stats_mu_);
+    for (const auto& [peer_and_method, stats] : transfer_stats_) {
+      TransferStats& peer_stats = per_peer[peer_and_method.first];
+      peer_stats.count += stats.count;
+      peer_stats.bytes += stats.bytes;
+      peer_stats.queueing_usecs += stats.queueing_usecs;
+      peer_stats.wire_usecs += stats.wire_usecs;
+    }
+  }
+
+  std::vector<PeerSummary> summaries;
+  std::vector<double> queueing, wire;
+  for (const auto& [peer, stats] : per_peer) {
+    PeerSummary summary;
+    summary.peer = peer;
+    summary.count = stats.count;
+    summary.mean_queueing_usecs =
+        static_cast<double>(stats.queueing_usecs) / stats.count;
+    if (stats.bytes > 0) {
+      summary.wire_usecs_per_mb =
+          stats.wire_usecs * 1048576.0 / static_cast<double>(stats.bytes);
+    }
+    if (stats.count >= min_count) {
+      queueing.push_back(summary.mean_queueing_usecs);
+      wire.push_back(summary.wire_usecs_per_mb);
+    }
+    summaries.push_back(std::move(summary));
+  }
+
+  const double median_queueing = Median(std::move(queueing));
+  const double median_wire = Median(std::move(wire));
+  for (PeerSummary& summary : summaries) {
+    if (summary.count < min_count) continue;
+    summary.straggler = summary.mean_queueing_usecs > factor * median_queueing;
+    summary.slow_link = summary.wire_usecs_per_mb > factor * median_wire;
+  }
+  return summaries;
+}
+
 }  // namespace tensorflow
@@ -16,8 +16,11 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_WORKER_CACHE_LOGGER_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_WORKER_CACHE_LOGGER_H_
 
+#include <map>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -68,6 +71,50 @@ class WorkerCacheLogger {
                           int64_t bytes, const string& details,
                           const string& transfer_method_name);
 
+  // Cumulative latency breakdown of the transfers received from one peer
+  // with one RPC method.
+  struct TransferStats {
+    int64_t count = 0;
+    int64_t bytes = 0;
+    // Time from issuing the request until the peer started to send the
+    // response, i.e. mostly waiting for the tensor to be produced.
+    int64_t queueing_usecs = 0;
+    // Time from the peer starting to send the response until it was received.
+    int64_t wire_usecs = 0;
+  };
+
+  // Records a completed transfer RPC (`method` is e.g. "RecvTensor", or
+  // "RecvBuf" for collectives) received from the task `peer`, in the
+  // /tensorflow/core/distributed_runtime/transfer_* metrics and in the
+  // per-peer stats. `send_start_usecs` is the time the peer reported it
+  // started sending, or 0 if unknown. Unlike the other Record* methods, this
+  // does not depend on LoggingActive().
+  void RecordTransferLatency(const string& method, const string& peer,
+                             int64_t start_usecs, int64_t send_start_usecs,
+                             int64_t end_usecs, int64_t bytes);
+
+  // Returns the transfer stats recorded so far, keyed by (peer, method).
+  std::map<std::pair<string, string>, TransferStats> GetTransferStats();
+
+  struct PeerSummary {
+    string peer;
+    int64_t count = 0;
+    double mean_queueing_usecs = 0;
+    double wire_usecs_per_mb = 0;
+    // The peer's mean queueing time is more than `factor` times the median
+    // over all peers: it produces its tensors late.
+    bool straggler = false;
+    // The peer's wire time per byte is more than `factor` times the median
+    // over all peers: the link to it is slow.
+    bool slow_link = false;
+  };
+
+  // Summarizes the transfer stats of each peer over all methods, and flags
+  // stragglers and slow links among the peers with at least `min_count`
+  // transfers.
+  std::vector<PeerSummary> SummarizePeers(double factor = 2.0,
+                                          int64_t min_count = 10);
+
  private:
   mutex count_mu_;
   int32 want_logging_count_ TF_GUARDED_BY(count_mu_) = 0;
@@ -80,6 +127,10 @@ class WorkerCacheLogger {
   mutex mu_;
   LogMap log_map_ TF_GUARDED_BY(mu_);
 
+  mutex transfer_stats_mu_;
+  std::map<std::pair<string, string>, TransferStats> transfer_stats_
+      TF_GUARDED_BY(transfer_stats_mu_);
+
   // Records "ns" in log_map_ under the given device and step.
   void Save(const string& device, int64_t step_id, NodeExecStats* ns);
 
@@ -0,0 +1,95 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/worker_cache_logger.h"
+
+#include <map>
+#include <utility>
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(WorkerCacheLoggerTest, RecordTransferLatencySplitsQueueingAndWireTime) {
+  WorkerCacheLogger logger;
+  logger.RecordTransferLatency("RecvTensor", "/job:worker/task:1",
+                               /*start_usecs=*/100, /*send_start_usecs=*/130,
+                               /*end_usecs=*/150, /*bytes=*/64);
+  // Without a reported send start, the whole latency counts as wire time.
+  logger.RecordTransferLatency("RecvTensor", "/job:worker/task:1",
+                               /*start_usecs=*/200, /*send_start_usecs=*/0,
+                               /*end_usecs=*/210, /*bytes=*/16);
+  // A send start outside of the request's lifetime is clamped.
+  logger.RecordTransferLatency("RecvBuf", "/job:worker/task:1",
+                               /*start_usecs=*/300, /*send_start_usecs=*/500,
+                               /*end_usecs=*/340, /*bytes=*/8);
+
+  auto stats = logger.GetTransferStats();
+  ASSERT_EQ(stats.size(), 2);
+  const auto& recv_tensor = stats[{"/job:worker/task:1", "RecvTensor"}];
+  EXPECT_EQ(recv_tensor.count, 2);
+  EXPECT_EQ(recv_tensor.bytes, 80);
+  EXPECT_EQ(recv_tensor.queueing_usecs, 30);
+  EXPECT_EQ(recv_tensor.wire_usecs, 30);
+  const auto& recv_buf = stats[{"/job:worker/task:1", "RecvBuf"}];
+  EXPECT_EQ(recv_buf.count, 1);
+  EXPECT_EQ(recv_buf.queueing_usecs, 40);
+  EXPECT_EQ(recv_buf.wire_usecs, 0);
+}
+
+TEST(WorkerCacheLoggerTest, SummarizePeersFlagsStragglersAndSlowLinks) {
+  WorkerCacheLogger logger;
+  for (int i = 0; i < 10; ++i) {
+    const int64_t start = i * 1000;
+    // Peers 0 and 1 are healthy.
+    logger.RecordTransferLatency("RecvBuf", "/job:worker/task:0", start,
+                                 start + 10, start + 20, 1 << 20);
+    logger.RecordTransferLatency("RecvBuf", "/job:worker/task:1", start,
+                                 start + 12, start + 22, 1 << 20);
+    // Peer 2 produces its tensors late.
+    logger.RecordTransferLatency("RecvBuf", "/job:worker/task:2", start,
+                                 start + 100, start + 110, 1 << 20);
+    // Peer 3 has a slow link.
+    logger.RecordTransferLatency("RecvBuf", "/job:worker/task:3", start,
+                                 start + 10, start + 110, 1 << 20);
+  }
+  // Peer 4 has too few transfers to be judged.
+  logger.RecordTransferLatency("RecvBuf", "/job:worker/task:4", 0, 1000, 2000,
+                               1);
+
+  std::map<string, WorkerCacheLogger::PeerSummary> summaries;
+  for (auto& summary : logger.SummarizePeers(/*factor=*/2.0,
+                                             /*min_count=*/10)) {
+    summaries[summary.peer] = std::move(summary);
+  }
+  ASSERT_EQ(summaries.size(), 5);
+  EXPECT_EQ(summaries["/job:worker/task:0"].count, 10);
+  EXPECT_DOUBLE_EQ(summaries["/job:worker/task:0"].mean_queueing_usecs, 10);
+  EXPECT_DOUBLE_EQ(summaries["/job:worker/task:0"].wire_usecs_per_mb, 10);
+  EXPECT_FALSE(summaries["/job:worker/task:0"].straggler);
+  EXPECT_FALSE(summaries["/job:worker/task:0"].slow_link);
+  EXPECT_FALSE(summaries["/job:worker/task:1"].straggler);
+  EXPECT_FALSE(summaries["/job:worker/task:1"].slow_link);
+  EXPECT_TRUE(summaries["/job:worker/task:2"].straggler);
+  EXPECT_FALSE(summaries["/job:worker/task:2"].slow_link);
+  EXPECT_FALSE(summaries["/job:worker/task:3"].straggler);
+  EXPECT_TRUE(summaries["/job:worker/task:3"].slow_link);
+  EXPECT_FALSE(summaries["/job:worker/task:4"].straggler);
+  EXPECT_FALSE(summaries["/job:worker/task:4"].slow_link);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -20,6 +20,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/call_options.h"
 #include "tensorflow/core/distributed_runtime/message_wrappers.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/types.h"
@@ -106,6 +107,16 @@ class WorkerInterface {
                                TensorResponse* response,
                                StatusCallback done) = 0;
 
+  // Long-polls a batched stream of tensors. See `BatchRecvTensorRequest` in
+  // worker.proto. Transports that do not support it report Unimplemented, and
+  // callers fall back to one `RecvTensorAsync()` per tensor.
+  virtual void BatchRecvTensorAsync(CallOptions* opts,
+                                    const BatchRecvTensorRequest* request,
+                                    BatchRecvTensorResponse* response,
+                                    StatusCallback done) {
+    done(errors::Unimplemented("BatchRecvTensorAsync"));
+  }
+
   virtual void LoggingAsync(const LoggingRequest* request,
                             LoggingResponse* response, StatusCallback done) = 0;
 
@@ -306,6 +306,54 @@ TEST(CPUAllocatorTest, ProfilerReporting) {
   DisableCPUAllocatorStats();
 }
 
+TEST(CPUAllocatorTest, ProfilerReportingWithoutStats) {
+  DisableCPUAllocatorStats();
+  Allocator* a = cpu_allocator();
+
+  // Allocate something before profiling starts. It is not tracked.
+  void* p1 = a->AllocateRaw(1, 16);
+
+  std::unique_ptr<ProfilerSession> profiler =
+      tensorflow::ProfilerSession::Create(
+          tensorflow::ProfilerSession::DefaultOptions());
+
+  void* p2 = a->AllocateRaw(1, 32);
+  a->DeallocateRaw(p1);
+  a->DeallocateRaw(p2);
+
+  tensorflow::profiler::XSpace xspace;
+  EXPECT_EQ(OkStatus(), profiler->CollectData(&xspace));
+
+  const auto plane = ::tsl::profiler::FindPlaneWithName(
+      xspace, ::tensorflow::profiler::kHostThreadsPlaneName);
+  ASSERT_NE(plane, nullptr) << "XSpace: " << xspace.DebugString();
+  ::tensorflow::profiler::XPlaneVisitor xplane(plane);
+
+  std::vector<std::string> event_names;
+  std::vector<std::string> requested_bytes;
+  xplane.ForEachLine([&](const ::tensorflow::profiler::XLineVisitor& line) {
+    line.ForEachEvent([&](const ::tensorflow::profiler::XEventVisitor& event) {
+      if (event.Name() != "MemoryAllocation" &&
+          event.Name() != "MemoryDeallocation") {
+        return;
+      }
+      event_names.push_back(std::string(event.Name()));
+      event.ForEachStat([&](const ::tensorflow::profiler::XStatVisitor& stat) {
+        if (stat.Name() == "requested_bytes") {
+          requested_bytes.push_back(stat.ToString());
+        } else if (stat.Name() == "bytes_allocated" &&
+                   event.Name() == "MemoryDeallocation") {
+          EXPECT_EQ(stat.ToString(), "0");
+        }
+      });
+    });
+  });
+  EXPECT_EQ(event_names, std::vector<std::string>(
+                             {"MemoryAllocation", "MemoryDeallocation"}))
+      << "XSpace: " << xspace.DebugString();
+  EXPECT_EQ(requested_bytes, std::vector<std::string>({"32", "0"}));
+}
+
 namespace {
 
 AllocatorAttributes DeviceAllocatorAttribute() {
@@ -116,6 +116,20 @@ struct CollImplDetails {
                               // e.g. ring or nccl
   float timeout_seconds;      // If non zero, set a completion timeout for the
                               // collective op to detect staleness.
+  // Reductions with bucket_size > 1 belong to a bucket of bucket_size
+  // instances with consecutive instance keys starting at bucket_key. The
+  // executor fuses the members of a bucket into reductions of at least
+  // bucket_bytes input bytes, or of the whole bucket if bucket_bytes <= 0.
+  int32 bucket_key = 0;
+  int bucket_size = 0;
+  int64_t bucket_bytes = 0;
+  // If not DT_INVALID, ring reductions of DT_FLOAT values cast the chunks they
+  // transfer to this type, e.g. DT_BFLOAT16, with the compress_op and
+  // decompress_op of the CollectiveParams.
+  DataType compression_type = DT_INVALID;
+  // If true, the error introduced by the compression of each chunk is added
+  // back to it on the next execution of the same instance.
+  bool compression_error_feedback = false;
 };
 
 // Data common to all members of a collective instance.
@@ -156,6 +170,11 @@ struct CollectiveParams : public core::RefCounted {
   std::vector<int> subdiv_rank;
   OpKernel* merge_op = nullptr;  // reduction only
   OpKernel* final_op = nullptr;  // reduction only
+  // Reduction with compression only: Cast ops to and from
+  // impl_details.compression_type, and Sub for error feedback.
+  OpKernel* compress_op = nullptr;
+  OpKernel* decompress_op = nullptr;
+  OpKernel* sub_op = nullptr;
   string ToString() const;
   bool run_group_initialization = true;
   bool is_stateless = false;
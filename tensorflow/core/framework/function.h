@@ -809,6 +809,15 @@ class FunctionLibraryRuntime : public core::WeakRefCounted {
     // surface errors earlier.
     bool create_kernels_eagerly = false;
 
+    // If true, a multi-device function is only registered at instantiation
+    // time. It is placed, optimized and partitioned the first time it is
+    // used, on the default thread pool of the ProcessFunctionLibraryRuntime
+    // when run asynchronously, or when it is warmed up by
+    // `ProcessFunctionLibraryRuntime::InstantiateLazyFunctionsAsync()`.
+    // Errors in the function body are reported by that first use. Pointers
+    // in these options, such as `lib_def`, must remain valid until then.
+    bool lazy_instantiation = false;
+
     // This interface is EXPERIMENTAL and subject to change.
     //
     // Instantiates the function with the provided config_proto.
@@ -20,14 +20,25 @@ limitations under the License.
 #include <string>
 #include <vector>
 
+#if defined(__linux__) || defined(__APPLE__)
+#include <dlfcn.h>
+#endif
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
 #include "tensorflow/core/protobuf/data_service.pb.h"
 #include "tsl/lib/monitoring/counter.h"
 #include "tsl/lib/monitoring/gauge.h"
 #include "tsl/lib/monitoring/sampler.h"
+#include "tsl/platform/abi.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/threadpool.h"
 #include "tsl/platform/types.h"
+#include "tsl/profiler/lib/traceme.h"
+#include "tsl/profiler/lib/traceme_encode.h"
 #include "tsl/protobuf/error_codes.pb.h"
+#include "tsl/util/env_var.h"
 
 namespace tensorflow {
 namespace metrics {
@@ -225,11 +236,35 @@ auto* tf_data_service_cross_trainer_cache_size_bytes =
         "/tensorflow/data/service/cross_trainer_cache_size_bytes",
         "tf.data service cross-trainer cache memory usage in bytes.");
 
+auto* tf_data_service_cross_trainer_cache_trainer_queries_counter =
+    tsl::monitoring::Counter<2>::New(
+        "/tensorflow/data/service/cross_trainer_cache_trainer_queries",
+        "tf.data service cross-trainer cache queries per trainer. The result "
+        "can be memory_hit, disk_hit, or miss.",
+        "trainer_id", "result");
+
+auto* tf_data_service_cross_trainer_cache_trainer_lag =
+    tsl::monitoring::Gauge<int64_t, 1>::New(
+        "/tensorflow/data/service/cross_trainer_cache_trainer_lag",
+        "Number of tf.data service cross-trainer cache elements newer than the "
+        "element a trainer last read.",
+        "trainer_id");
+
+auto* tf_data_service_cross_trainer_cache_overflow_size_bytes =
+    tsl::monitoring::Gauge<int64_t, 0>::New(
+        "/tensorflow/data/service/cross_trainer_cache_overflow_size_bytes",
+        "tf.data service cross-trainer cache overflow tier usage in bytes.");
+
 auto* tf_data_service_snapshot_bytes_committed =
     tsl::monitoring::Counter<0>::New(
         "/tensorflow/data/service/snapshot_bytes_committed",
         "tf.data service distributed snapshot committed bytes.");
 
+auto* tf_data_service_snapshot_bytes_deduplicated =
+    tsl::monitoring::Counter<0>::New(
+        "/tensorflow/data/service/snapshot_bytes_deduplicated",
+        "tf.data service distributed snapshot bytes found in the chunk store.");
+
 auto* tf_data_service_snapshot_ops_counter = tsl::monitoring::Counter<2>::New(
     "/tensorflow/data/service/snapshot_ops",
     "Number times a tf.data snapshot is saved/loaded.", "path", "op");
@@ -418,6 +453,12 @@ auto* xla_compilation_time_usecs = tsl::monitoring::Counter<0>::New(
     "/tensorflow/core/xla_compilation_time_usecs",
     "The total time spent on compiling XLA graphs in microseconds.");
 
+auto* xla_recompilations = tsl::monitoring::Counter<1>::New(
+    "/tensorflow/core/xla_recompilations",
+    "The number of XLA cluster recompilations, by the kind of signature "
+    "change that caused them.",
+    "cause");
+
 auto* xla_tpu_spmd_cores_per_replica = tsl::monitoring::Counter<1>::New(
     "/tensorflow/tpu/xla_spmd_cores_per_replica",
     "The number of cores used by XLA SPMD-replicated models.", "cores");
@@ -432,6 +473,115 @@ auto* test_counters = tsl::monitoring::Counter<2>::New(
     "/tensorflow/core/test_counters", "Counters used for testing.", "name",
     "label");
 
+auto* thread_pool_task_wait_usecs = tsl::monitoring::Sampler<1>::New(
+    {"/tensorflow/core/thread_pool/task_wait_usecs",
+     "Time closures waited in the queue of a thread pool for a thread.",
+     "pool"},
+    // Power of 2 with bucket count 25 (> 30 seconds)
+    {tsl::monitoring::Buckets::Exponential(1, 2, 25)});
+
+auto* thread_pool_task_run_usecs = tsl::monitoring::Sampler<1>::New(
+    {"/tensorflow/core/thread_pool/task_run_usecs",
+     "Time closures of a thread pool ran.", "pool"},
+    // Power of 2 with bucket count 25 (> 30 seconds)
+    {tsl::monitoring::Buckets::Exponential(1, 2, 25)});
+
+auto* thread_pool_queue_length = tsl::monitoring::Sampler<1>::New(
+    {"/tensorflow/core/thread_pool/queue_length",
+     "The number of closures waiting in the queue of a thread pool when one "
+     "of its closures started.",
+     "pool"},
+    // Power of 2 with bucket count 16 (> 32768 closures)
+    {tsl::monitoring::Buckets::Exponential(1, 2, 16)});
+
+auto* thread_pool_steals = tsl::monitoring::Counter<1>::New(
+    "/tensorflow/core/thread_pool/steals",
+    "The number of closures an idle thread of a work stealing thread pool "
+    "took from the queue of another thread.",
+    "pool");
+
+auto* mutex_contentions = tsl::monitoring::Counter<1>::New(
+    "/tensorflow/core/mutex_contention/count",
+    "The number of mutex acquisitions that had to wait, by the code that "
+    "acquired the mutex.",
+    "call_site");
+
+auto* mutex_contention_wait_nanos = tsl::monitoring::Counter<1>::New(
+    "/tensorflow/core/mutex_contention/wait_nanos",
+    "The time spent waiting to acquire a mutex, by the code that acquired the "
+    "mutex.",
+    "call_site");
+
+class ThreadPoolMetricsListener : public tsl::thread::ThreadPoolTaskListener {
+ public:
+  void OnTaskRun(const std::string& pool_name, int64_t queue_length,
+                 int64_t wait_nanos, int64_t run_nanos) override {
+    thread_pool_task_wait_usecs->GetCell(pool_name)->Add(wait_nanos / 1000.0);
+    thread_pool_task_run_usecs->GetCell(pool_name)->Add(run_nanos / 1000.0);
+    thread_pool_queue_length->GetCell(pool_name)->Add(queue_length);
+  }
+
+  void OnTaskStolen(const std::string& pool_name) override {
+    thread_pool_steals->GetCell(pool_name)->IncrementBy(1);
+  }
+};
+
+// Returns "function+offset" for `call_site` if it can be symbolized, and its
+// address otherwise. Symbolized call sites are cached since the set of call
+// sites that contend is small.
+std::string MutexCallSiteName(const void* call_site) {
+  static absl::Mutex* mu = new absl::Mutex();
+  static auto* names = new absl::flat_hash_map<const void*, std::string>();
+  absl::MutexLock lock(mu);
+  auto [it, inserted] = names->try_emplace(call_site);
+  if (inserted) {
+#if defined(__linux__) || defined(__APPLE__)
+    Dl_info info;
+    if (dladdr(call_site, &info) != 0 && info.dli_sname != nullptr) {
+      it->second = absl::StrCat(
+          tsl::port::MaybeAbiDemangle(info.dli_sname), "+0x",
+          absl::Hex(reinterpret_cast<uintptr_t>(call_site) -
+                    reinterpret_cast<uintptr_t>(info.dli_saddr)));
+    }
+#endif
+    if (it->second.empty()) {
+      it->second = absl::StrCat(
+          "0x", absl::Hex(reinterpret_cast<uintptr_t>(call_site)));
+    }
+  }
+  return it->second;
+}
+
+void RecordMutexContention(int64_t wait_nanos, const void* call_site) {
+  const std::string call_site_name = MutexCallSiteName(call_site);
+  mutex_contentions->GetCell(call_site_name)->IncrementBy(1);
+  mutex_contention_wait_nanos->GetCell(call_site_name)->IncrementBy(wait_nanos);
+  tsl::profiler::TraceMe::InstantActivity([&] {
+    return tsl::profiler::TraceMeEncode(
+        "MutexContention",
+        {{"call_site", call_site_name}, {"wait_nanos", wait_nanos}});
+  });
+}
+
+// Enables the thread pool metrics and the mutex contention profiling at
+// startup if the corresponding environment variables are set.
+const bool kContentionMetricsInitialized = [] {
+  bool enable = false;
+  if (tsl::ReadBoolFromEnvVar("TF_ENABLE_THREAD_POOL_METRICS", false, &enable)
+          .ok() &&
+      enable) {
+    EnableThreadPoolMetrics(true);
+  }
+  enable = false;
+  if (tsl::ReadBoolFromEnvVar("TF_ENABLE_MUTEX_CONTENTION_PROFILING", false,
+                              &enable)
+          .ok() &&
+      enable) {
+    EnableMutexContentionProfiling(true);
+  }
+  return true;
+}();
+
 }  // namespace
 
 auto* tpu_op_error_counter = tsl::monitoring::Counter<2>::New(
@@ -675,10 +825,36 @@ void RecordTFDataServiceCrossTrainerCacheSizeBytes(size_t bytes) {
       static_cast<int64_t>(bytes));
 }
 
+void RecordTFDataServiceCrossTrainerCacheTrainerQuery(
+    const string& trainer_id, bool cache_hit, bool from_overflow_tier) {
+  std::string result = "miss";
+  if (cache_hit) {
+    result = from_overflow_tier ? "disk_hit" : "memory_hit";
+  }
+  tf_data_service_cross_trainer_cache_trainer_queries_counter
+      ->GetCell(trainer_id, result)
+      ->IncrementBy(1);
+}
+
+void RecordTFDataServiceCrossTrainerCacheTrainerLag(const string& trainer_id,
+                                                    size_t num_elements) {
+  tf_data_service_cross_trainer_cache_trainer_lag->GetCell(trainer_id)->Set(
+      static_cast<int64_t>(num_elements));
+}
+
+void RecordTFDataServiceCrossTrainerCacheOverflowSizeBytes(size_t bytes) {
+  tf_data_service_cross_trainer_cache_overflow_size_bytes->GetCell()->Set(
+      static_cast<int64_t>(bytes));
+}
+
 void RecordTFDataServiceSnapshotBytesCommitted(int64_t bytes) {
   tf_data_service_snapshot_bytes_committed->GetCell()->IncrementBy(bytes);
 }
 
+void RecordTFDataServiceSnapshotBytesDeduplicated(int64_t bytes) {
+  tf_data_service_snapshot_bytes_deduplicated->GetCell()->IncrementBy(bytes);
+}
+
 void RecordTFDataServiceSnapshotOp(const std::string& path,
                                    const std::string& op) {
   tf_data_service_snapshot_ops_counter->GetCell(path, op)->IncrementBy(1);
@@ -921,6 +1097,19 @@ void UpdateXlaCompilationTime(const uint64 compilation_time_usecs) {
   }
 }
 
+void RecordXlaRecompilation(const string& cause) {
+  xla_recompilations->GetCell(cause)->IncrementBy(1);
+}
+
+void EnableThreadPoolMetrics(bool enable) {
+  static auto* listener = new ThreadPoolMetricsListener();
+  tsl::thread::SetThreadPoolTaskListener(enable ? listener : nullptr);
+}
+
+void EnableMutexContentionProfiling(bool enable) {
+  tsl::SetMutexContentionHook(enable ? &RecordMutexContention : nullptr);
+}
+
 void RecordUnusedOutput(const string& op_name) {
   graph_unused_outputs->GetCell(op_name)->IncrementBy(1);
 }
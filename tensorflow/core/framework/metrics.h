@@ -182,9 +182,27 @@ void RecordTFDataServiceCrossTrainerCacheQuery(bool cache_hit);
 // Records tf.data service cross-trainer cache memory usage in bytes.
 void RecordTFDataServiceCrossTrainerCacheSizeBytes(size_t bytes);
 
+// Records a tf.data service cross-trainer cache query from `trainer_id`.
+// `from_overflow_tier` indicates whether the element was read from the disk
+// tier rather than from memory.
+void RecordTFDataServiceCrossTrainerCacheTrainerQuery(
+    const string& trainer_id, bool cache_hit, bool from_overflow_tier);
+
+// Records how many cached elements are newer than the element `trainer_id`
+// last read from the tf.data service cross-trainer cache.
+void RecordTFDataServiceCrossTrainerCacheTrainerLag(const string& trainer_id,
+                                                    size_t num_elements);
+
+// Records tf.data service cross-trainer cache overflow tier usage in bytes.
+void RecordTFDataServiceCrossTrainerCacheOverflowSizeBytes(size_t bytes);
+
 // Records tf.data distributed snapshot bytes committed.
 void RecordTFDataServiceSnapshotBytesCommitted(int64_t bytes);
 
+// Records tf.data distributed snapshot bytes not stored again because
+// identical chunks were found in the chunk store.
+void RecordTFDataServiceSnapshotBytesDeduplicated(int64_t bytes);
+
 // Records tf.data distributed snapshot save/load ops.
 void RecordTFDataServiceSnapshotOp(const std::string& path,
                                    const std::string& op);
@@ -520,6 +538,22 @@ void UpdateTpuVariableDistributionTime(const uint64 distribution_time_usecs);
 // Updates the metrics stored about time XLA spents compiling graphs.
 void UpdateXlaCompilationTime(const uint64 compilation_time_usecs);
 
+// Records an XLA recompilation of a cluster caused by a change of `cause`
+// (e.g. "shape" or "dtype") in its signature.
+void RecordXlaRecompilation(const string& cause);
+
+// Records the queue length, wait time and run time of the closures of every
+// thread pool, and the steals of work stealing pools, in the
+// /tensorflow/core/thread_pool/* metrics, labelled by pool name. Also enabled
+// at startup by setting TF_ENABLE_THREAD_POOL_METRICS=true.
+void EnableThreadPoolMetrics(bool enable);
+
+// Records the number and wait time of contended mutex acquisitions in the
+// /tensorflow/core/mutex_contention/* metrics, labelled by the function that
+// acquired the mutex, and as "MutexContention" profiler trace events. Also
+// enabled at startup by setting TF_ENABLE_MUTEX_CONTENTION_PROFILING=true.
+void EnableMutexContentionProfiling(bool enable);
+
 // Increments (by 1) a simple integer counter that is exposed for testing.
 void IncrementTestCounter(const string& name, const string& label);
 
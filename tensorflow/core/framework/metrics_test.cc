@@ -19,11 +19,15 @@ limitations under the License.
 
 #include <gtest/gtest.h>
 #include "tensorflow/core/lib/monitoring/cell_reader.h"
+#include "tensorflow/core/lib/monitoring/test_utils.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace {
 using ::tensorflow::metrics::IncrementPhase2XlaCompilerCounter;
 using ::tensorflow::metrics::Phase2XlaCompilerMetric;
 using ::tensorflow::monitoring::testing::CellReader;
+using ::tensorflow::monitoring::testing::Histogram;
 
 constexpr char kPhase2CompilationStatusStreamzName[] =
     "/tensorflow/core/tf2xla/api/v2/phase2_compilation_status";
@@ -93,4 +97,25 @@ TEST(Metrics, Phase2ComilationStatusUntouchedCounterNotIncremented) {
   ASSERT_EQ(counter.Read(kMlirWithFallbackModeSuccess), 0);
 }
 
+TEST(Metrics, ThreadPoolMetrics) {
+  CellReader<Histogram> wait("/tensorflow/core/thread_pool/task_wait_usecs");
+  CellReader<Histogram> run("/tensorflow/core/thread_pool/task_run_usecs");
+  CellReader<Histogram> queue_length(
+      "/tensorflow/core/thread_pool/queue_length");
+
+  tensorflow::metrics::EnableThreadPoolMetrics(true);
+  {
+    tensorflow::thread::ThreadPool pool(tensorflow::Env::Default(),
+                                        "metrics_test", 2);
+    for (int i = 0; i < 10; ++i) {
+      pool.Schedule([] {});
+    }
+  }
+  tensorflow::metrics::EnableThreadPoolMetrics(false);
+
+  EXPECT_FLOAT_EQ(wait.Delta("tf_metrics_test").num(), 10.0);
+  EXPECT_FLOAT_EQ(run.Delta("tf_metrics_test").num(), 10.0);
+  EXPECT_FLOAT_EQ(queue_length.Delta("tf_metrics_test").num(), 10.0);
+}
+
 }  // namespace
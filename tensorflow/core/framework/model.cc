@@ -18,10 +18,14 @@ limitations under the License.
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
+#include <deque>
 #include <limits>
 #include <memory>
 #include <optional>
 #include <queue>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/time/clock.h"
 #include "tensorflow/core/framework/cancellation.h"
@@ -63,6 +67,15 @@ constexpr double kBufferDownsizeMultipliter = 0.9;
 // Threshold of low buffer watermark before a buffer is a candidate for
 // upsizing.
 constexpr int64_t kBufferLowWatermarkThreshold = 2;
+// The number of the latest processing time observations of a node used by the
+// regression optimization.
+constexpr int kRegressionWindow = 16;
+// In the regression optimization, each observation weighs this much less than
+// the next, more recent one.
+constexpr double kRegressionDecay = 0.7;
+// The regression optimization stops increasing the parallelism of a node once
+// the predicted time of the node improves by less than this fraction.
+constexpr double kRegressionMinImprovement = 0.01;
 
 constexpr char kDataService[] = "DataService";
 constexpr char kFlatMap[] = "FlatMap";
@@ -360,6 +373,43 @@ inline void UpdateStateValues(Node::ModelParameters* parameters) {
   }
 }
 
+// Fits `wall_time = parallel_time / parallelism + serial_time` to `samples` of
+// parallelism and wall time per element with weighted least squares, and
+// returns the pair of parallel and serial times, which are non-negative. If all
+// samples have the same parallelism, the serial time is assumed to be zero.
+std::pair<double, double> FitStageCost(
+    const std::deque<std::pair<double, double>>& samples) {
+  double sum_w = 0.0, sum_x = 0.0, sum_y = 0.0, sum_xx = 0.0, sum_xy = 0.0;
+  double weight = 1.0;
+  for (auto it = samples.rbegin(); it != samples.rend(); ++it) {
+    const double x = 1.0 / it->first;
+    const double y = it->second;
+    sum_w += weight;
+    sum_x += weight * x;
+    sum_y += weight * y;
+    sum_xx += weight * x * x;
+    sum_xy += weight * x * y;
+    weight *= kRegressionDecay;
+  }
+  if (sum_xx <= 0.0) {
+    return {0.0, 0.0};
+  }
+  const double parallel_only = sum_xy / sum_xx;
+  const double determinant = sum_w * sum_xx - sum_x * sum_x;
+  if (determinant <= 1e-9 * sum_w * sum_xx) {
+    return {parallel_only, 0.0};
+  }
+  const double parallel_time = (sum_w * sum_xy - sum_x * sum_y) / determinant;
+  const double serial_time = (sum_y - parallel_time * sum_x) / sum_w;
+  if (parallel_time < 0.0) {
+    return {0.0, sum_y / sum_w};
+  }
+  if (serial_time < 0.0) {
+    return {parallel_only, 0.0};
+  }
+  return {parallel_time, serial_time};
+}
+
 // Recursively produces protos for nodes in a subtree of `output` node and
 // appends them to nodes of the given model.
 Status ModelToProtoHelper(std::shared_ptr<Node> output, ModelProto* model) {
@@ -2385,6 +2435,10 @@ void Model::Optimize(AutotuneAlgorithm algorithm,
       OptimizeStageBased(snapshot, optimization_params, cancellation_manager,
                          ram_budget_manager);
       break;
+    case AutotuneAlgorithm::REGRESSION:
+      OptimizeRegression(snapshot, optimization_params, cancellation_manager,
+                         ram_budget_manager);
+      break;
     default:
       VLOG(2) << "Autotuning algorithm was not recognized. Aborting "
                  "optimization.";
@@ -2556,10 +2610,11 @@ Status Model::OptimizeLoop(AutotuneAlgorithm algorithm,
     int64_t start_ms = EnvTime::NowMicros() / EnvTime::kMillisToMicros;
     double model_input_time = 0.0;
     // Model input time is set to 0 for all optimization algorithms except for
-    // stage-based optimization algorithm for historical reason. In stage-based
-    // optimization algorithm, the model input time is used as a target
+    // stage-based and regression optimization algorithms for historical
+    // reason. In these algorithms, the model input time is used as a target
     // optimization time of all stages in the pipeline.
-    if (algorithm == AutotuneAlgorithm::STAGE_BASED) {
+    if (algorithm == AutotuneAlgorithm::STAGE_BASED ||
+        algorithm == AutotuneAlgorithm::REGRESSION) {
       model_input_time = ComputeTargetTimeNsec();
     }
     Optimize(algorithm, cpu_budget_func, ram_budget_share, fixed_ram_budget,
@@ -3137,6 +3192,188 @@ void Model::OptimizeMaxParallelism(
                           should_stop);
 }
 
+void Model::OptimizeRegression(std::shared_ptr<Node> snapshot,
+                               const OptimizationParams& optimization_params,
+                               CancellationManager* cancellation_manager,
+                               RamBudgetManager& ram_budget_manager) {
+  VLOG(2) << "Starting optimization of tunable parameters with regression.";
+  Node::NodeVector nodes =
+      snapshot->CollectNodes(TraversalOrder::BFS, IsAnyNode);
+  nodes.push_back(snapshot);
+
+  // The fitted cost of a node with a tunable parallelism parameter.
+  struct StageCost {
+    std::string name;
+    Parameter* parallelism;
+    double parallel_time;
+    double serial_time;
+
+    double PredictedTime(double parallelism_value) const {
+      return parallel_time / parallelism_value + serial_time;
+    }
+  };
+  std::vector<StageCost> stages;
+  // Pairs of buffer size parameters and the parallelism parameter of the same
+  // node, if any.
+  std::vector<std::pair<Parameter*, Parameter*>> buffer_sizes;
+  Node::ModelParameters parameters;
+  const bool skip_buffer_sizes =
+      experiments_.contains("autotune_buffer_optimization");
+  // Parallelizing the stages beyond the slowest synchronous node, or beyond the
+  // consumer of the pipeline, does not improve the throughput.
+  double target_time_nsec = optimization_params.model_input_time();
+  {
+    mutex_lock l(mu_);
+    absl::flat_hash_map<std::string, CostObservations> observations;
+    for (const auto& node : nodes) {
+      Node::ModelParameters node_parameters =
+          node->CollectNodeTunableParameters();
+      Parameter* parallelism = nullptr;
+      Parameter* buffer_size = nullptr;
+      for (const auto& pair : node_parameters) {
+        if (pair.second->name == kParallelism) {
+          parallelism = pair.second.get();
+        } else if (pair.second->name == kBufferSize) {
+          buffer_size = pair.second.get();
+        }
+      }
+      parameters.insert(parameters.end(), node_parameters.begin(),
+                        node_parameters.end());
+      if (buffer_size != nullptr && !skip_buffer_sizes) {
+        buffer_sizes.emplace_back(buffer_size, parallelism);
+      }
+      if (parallelism == nullptr) {
+        if (!node->IsAsync()) {
+          target_time_nsec =
+              std::max(target_time_nsec, node->SelfProcessingTime());
+        }
+        continue;
+      }
+
+      CostObservations& node_observations = observations[node->long_name()];
+      auto it = cost_observations_.find(node->long_name());
+      if (it != cost_observations_.end()) {
+        node_observations = std::move(it->second);
+      }
+      const int64_t num_elements = node->num_elements();
+      const int64_t processing_time = node->processing_time();
+      const int64_t delta_elements =
+          num_elements - node_observations.num_elements;
+      const int64_t delta_time =
+          processing_time - node_observations.processing_time;
+      if (delta_elements > 0 && delta_time >= 0) {
+        double parallelism_value;
+        {
+          tf_shared_lock state_lock(*parallelism->state->mu);
+          parallelism_value = parallelism->state->value;
+        }
+        parallelism_value = std::max(parallelism_value, parallelism->min);
+        node_observations.samples.emplace_back(
+            parallelism_value, static_cast<double>(delta_time) /
+                                   delta_elements / parallelism_value);
+        if (node_observations.samples.size() > kRegressionWindow) {
+          node_observations.samples.pop_front();
+        }
+      }
+      node_observations.num_elements = num_elements;
+      node_observations.processing_time = processing_time;
+      if (!node_observations.samples.empty()) {
+        auto [parallel_time, serial_time] =
+            FitStageCost(node_observations.samples);
+        stages.push_back(
+            {node->long_name(), parallelism, parallel_time, serial_time});
+      }
+    }
+    // Drops the observations of nodes that are no longer in the model.
+    cost_observations_ = std::move(observations);
+  }
+  if (parameters.empty()) {
+    VLOG(2) << "There are no tunable parameters.";
+    return;
+  }
+
+  // Initialize the parallelism parameter values to minimal before tuning.
+  double total_parallelism = 0.0;
+  for (auto& pair : parameters) {
+    if (pair.second->name == kParallelism) {
+      pair.second->value = pair.second->min;
+      total_parallelism += pair.second->value;
+    }
+  }
+  while (!stages.empty() && !cancellation_manager->IsCancelled()) {
+    StageCost* slowest = &stages.front();
+    for (StageCost& stage : stages) {
+      if (stage.PredictedTime(stage.parallelism->value) >
+          slowest->PredictedTime(slowest->parallelism->value)) {
+        slowest = &stage;
+      }
+    }
+    Parameter* parallelism = slowest->parallelism;
+    const double time = slowest->PredictedTime(parallelism->value);
+    if (time <= target_time_nsec) {
+      metrics::RecordTFDataAutotuneStoppingCriteria("target_time_reached");
+      break;
+    }
+    if (parallelism->value >= parallelism->max) {
+      // Removes the `<index>` of `[<index>]` to reduce the number of labels.
+      metrics::RecordTFDataAutotuneStoppingCriteria(strings::StrCat(
+          "parameter_max_exceeded:", RemoveArrayIndices(slowest->name)));
+      break;
+    }
+    if (time - slowest->PredictedTime(parallelism->value + 1.0) <
+        kRegressionMinImprovement * time) {
+      metrics::RecordTFDataAutotuneStoppingCriteria(strings::StrCat(
+          "total_time_not_improved:", RemoveArrayIndices(slowest->name)));
+      break;
+    }
+    if (total_parallelism + 1.0 > optimization_params.cpu_budget()) {
+      metrics::RecordTFDataAutotuneStoppingCriteria("cpu_budget_reached");
+      break;
+    }
+    parallelism->value += 1.0;
+    if (TotalMaximumBufferedBytes(snapshot) >
+        optimization_params.ram_budget()) {
+      parallelism->value -= 1.0;
+      metrics::RecordTFDataAutotuneStoppingCriteria("max_buffered_bytes");
+      break;
+    }
+    total_parallelism += 1.0;
+  }
+
+  // Buffers hold as many elements as their node processes in parallel, or as
+  // the largest parallelism for nodes that only buffer, and are shrunk largest
+  // first until they fit in the memory budget.
+  double max_parallelism = 1.0;
+  for (const StageCost& stage : stages) {
+    max_parallelism = std::max(max_parallelism, stage.parallelism->value);
+  }
+  for (auto& [buffer_size, parallelism] : buffer_sizes) {
+    const double value =
+        parallelism != nullptr ? parallelism->value : max_parallelism;
+    buffer_size->value =
+        std::min(buffer_size->max, std::max(buffer_size->min, value));
+  }
+  while (TotalMaximumBufferedBytes(snapshot) >
+         optimization_params.ram_budget()) {
+    Parameter* largest = nullptr;
+    for (auto& pair : buffer_sizes) {
+      Parameter* buffer_size = pair.first;
+      if (buffer_size->value > buffer_size->min &&
+          (largest == nullptr || buffer_size->value > largest->value)) {
+        largest = buffer_size;
+      }
+    }
+    if (largest == nullptr) {
+      break;
+    }
+    largest->value -= 1.0;
+  }
+  if (ram_budget_manager.RequestModelAllocation(
+          TotalMaximumBufferedBytes(snapshot))) {
+    UpdateStateValues(&parameters);
+  }
+}
+
 double Model::OutputTime(std::shared_ptr<Node> node, double model_input_time,
                          Model::ParameterGradients* gradients) {
   // To store the input time for each node.
@@ -1134,6 +1134,20 @@ class Model {
       CancellationManager* cancellation_manager,
       RamBudgetManager& ram_budget_manager);
 
+  // This optimization keeps, for every node with a tunable parallelism
+  // parameter, the per-element processing time observed between consecutive
+  // optimization rounds at the parallelism that was in effect. It fits
+  // `parallel_time / parallelism + serial_time` to these observations and,
+  // starting from the minimal values, repeatedly increases the parallelism of
+  // the node with the longest predicted time until it is faster than both the
+  // target time and the slowest synchronous node, or until the CPU budget is
+  // used up. Buffer sizes then follow the chosen parallelism within the memory
+  // budget.
+  void OptimizeRegression(std::shared_ptr<Node> snapshot,
+                          const OptimizationParams& optimization_params,
+                          CancellationManager* cancellation_manager,
+                          RamBudgetManager& ram_budget_manager);
+
   // Determines if we should stop the gradient descent optimization iterations
   // based on number of increasable parameters, CPU budget, RAM budget and
   // current resource usage.
@@ -1202,6 +1216,21 @@ class Model {
   OptimizationParams optimization_params_ TF_GUARDED_BY(mu_);
   // Stores the model id in the string format
   std::string model_id_;
+
+  // Processing times of a node observed by the `REGRESSION` optimization.
+  struct CostObservations {
+    // The aggregate processing time and number of elements of the node at the
+    // last optimization round.
+    int64_t processing_time = 0;
+    int64_t num_elements = 0;
+    // Pairs of the parallelism in effect and the observed wall time per
+    // element, oldest first.
+    std::deque<std::pair<double, double>> samples;
+  };
+  // Stores the observations of the `REGRESSION` optimization, keyed by the
+  // long name of the node.
+  absl::flat_hash_map<std::string, CostObservations> cost_observations_
+      TF_GUARDED_BY(mu_);
 };
 
 // Class to compute timing information for a model.
@@ -1358,7 +1358,79 @@ TEST_P(OptimizeZeroRamBudgetTest, Model) {
 }
 
 INSTANTIATE_TEST_SUITE_P(Test, OptimizeZeroRamBudgetTest,
-                         ::testing::Values(0, 1, 2, 3));
+                         ::testing::Values(0, 1, 2, 3, 5));
+
+// Adds a parallel node with a tunable parallelism, and a synchronous input
+// whose elements take 300 nanoseconds each, to `model`. Returns the parallel
+// node.
+std::shared_ptr<Node> AddRegressionTestNodes(model::Model& model) {
+  std::shared_ptr<Node> node1 = model::MakeAsyncKnownRatioNode(
+      {1, "1", nullptr}, 1,
+      {model::MakeParameter(
+          "parallelism",
+          std::make_shared<SharedState>(
+              /*value=*/model::kAutotune, std::make_shared<mutex>(),
+              std::make_shared<condition_variable>()),
+          /*min=*/1, /*max=*/16)});
+  std::shared_ptr<Node> node2 = model::MakeKnownRatioNode({2, "2", node1}, 1);
+  node2->add_processing_time(100 * 300);
+  for (int i = 0; i < 100; ++i) {
+    node2->record_element();
+  }
+  model.AddNode([&node1](model::Node::Args args) { return node1; }, "1",
+                nullptr, &node1);
+  model.AddNode([&node2](model::Node::Args args) { return node2; }, "2", node1,
+                &node2);
+  return node1;
+}
+
+// Records `num_elements` elements of `node` that take `self_time` nanoseconds
+// each.
+void RecordElements(Node& node, int64_t num_elements, int64_t self_time) {
+  node.add_processing_time(num_elements * self_time);
+  for (int64_t i = 0; i < num_elements; ++i) {
+    node.record_element();
+  }
+}
+
+TEST(RegressionAutotuneTest, ParallelismFollowsCostFit) {
+  model::Model model;
+  std::shared_ptr<Node> node1 = AddRegressionTestNodes(model);
+  CancellationManager cancellation_manager;
+  RamBudgetManager ram_budget_manager(1000);
+
+  // With a single observation, all of the time of the node is assumed to be
+  // parallelizable: 1000 / 4 is the first time below that of the input.
+  RecordElements(*node1, 100, 1000);
+  model.Optimize(model::AutotuneAlgorithm::REGRESSION, CpuBudgetFunc(40),
+                 /*ram_budget_share=*/1.0, /*fixed_ram_budget=*/0,
+                 /*model_input_time=*/0, ram_budget_manager,
+                 &cancellation_manager);
+  EXPECT_EQ(node1->parameter_value("parallelism"), 4);
+
+  // A processing time of 1600 per element at parallelism 4 fits
+  // `800 / parallelism + 200`, which first drops below 300 at 8.
+  RecordElements(*node1, 100, 1600);
+  model.Optimize(model::AutotuneAlgorithm::REGRESSION, CpuBudgetFunc(40),
+                 /*ram_budget_share=*/1.0, /*fixed_ram_budget=*/0,
+                 /*model_input_time=*/0, ram_budget_manager,
+                 &cancellation_manager);
+  EXPECT_EQ(node1->parameter_value("parallelism"), 8);
+}
+
+TEST(RegressionAutotuneTest, RespectsCpuBudget) {
+  model::Model model;
+  std::shared_ptr<Node> node1 = AddRegressionTestNodes(model);
+  CancellationManager cancellation_manager;
+  RamBudgetManager ram_budget_manager(1000);
+
+  RecordElements(*node1, 100, 1000);
+  model.Optimize(model::AutotuneAlgorithm::REGRESSION, CpuBudgetFunc(2),
+                 /*ram_budget_share=*/1.0, /*fixed_ram_budget=*/0,
+                 /*model_input_time=*/0, ram_budget_manager,
+                 &cancellation_manager);
+  EXPECT_EQ(node1->parameter_value("parallelism"), 2);
+}
 
 TEST(RecordTimeTest, RecordTimeTest) {
   std::shared_ptr<Node> source = model::MakeSourceNode({});
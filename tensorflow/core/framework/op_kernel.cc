@@ -377,6 +377,8 @@ Allocator* OpKernelContext::get_allocator(AllocatorAttributes attr) {
   if (TF_PREDICT_FALSE(attr.scope_id > 0)) {
     allocator = params_->device->GetScopedAllocator(attr, step_id());
     CHECK(allocator);
+  } else if (params_->step_arena != nullptr && attr.value == 0) {
+    allocator = params_->step_arena;
   } else {
     allocator = params_->device->GetAllocator(attr);
   }
@@ -619,6 +619,11 @@ class OpKernelContext {
     bool track_allocations = false;
     bool log_memory = false;
 
+    // If not null, serves the allocations made with default attributes in
+    // place of the device allocator. Used by executors to bump-allocate the
+    // tensors of a step from per-step slabs.
+    Allocator* step_arena = nullptr;
+
     // Array indexed by output number for this node
     const AllocatorAttributes* output_attr_array = nullptr;
 
@@ -15,16 +15,52 @@ limitations under the License.
 
 #include "tensorflow/core/framework/op_segment.h"
 
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
 
+namespace {
+
+// Kernels shared between sessions, keyed by device and NodeDef fingerprint.
+struct SharedKernels {
+  struct Entry {
+    OpKernel* kernel = nullptr;
+    int64_t refs = 0;
+  };
+
+  mutex mu;
+  absl::flat_hash_map<string, Entry> entries TF_GUARDED_BY(mu);
+  absl::flat_hash_map<const OpKernel*, string> keys TF_GUARDED_BY(mu);
+};
+
+SharedKernels* GetSharedKernels() {
+  static SharedKernels* shared_kernels = new SharedKernels;
+  return shared_kernels;
+}
+
+bool HasFunctionAttr(const NodeDef& ndef) {
+  for (const auto& attr : ndef.attr()) {
+    if (attr.second.has_func() || attr.second.list().func_size() > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
 OpSegment::Item::~Item() {
   for (const auto& kv : name_kernel) delete kv.second;
 }
@@ -100,6 +136,67 @@ void OpSegment::RemoveHold(const string& session_handle) {
   delete item;
 }
 
+Status OpSegment::FindOrCreateShared(const string& device_key,
+                                     const NodeDef& ndef, OpKernel** kernel,
+                                     CreateKernelFn create_fn) {
+  string serialized;
+  if (!SerializeToStringDeterministic(ndef, &serialized)) {
+    return errors::Internal("Failed to serialize NodeDef ", ndef.name());
+  }
+  const Fprint128 fp = Fingerprint128(serialized);
+  const string key = strings::StrCat(device_key, "/", fp.high64, "_", fp.low64);
+
+  SharedKernels* shared = GetSharedKernels();
+  {
+    mutex_lock l(shared->mu);
+    auto it = shared->entries.find(key);
+    if (it != shared->entries.end()) {
+      ++it->second.refs;
+      *kernel = it->second.kernel;
+      return OkStatus();
+    }
+  }
+  TF_RETURN_IF_ERROR(create_fn(kernel));
+  {
+    mutex_lock l(shared->mu);
+    SharedKernels::Entry& entry = shared->entries[key];
+    if (entry.kernel == nullptr) {
+      entry.kernel = *kernel;  // Inserts 'kernel' in the map.
+      shared->keys[*kernel] = key;
+    } else {
+      delete *kernel;
+      *kernel = entry.kernel;
+    }
+    ++entry.refs;
+  }
+  return OkStatus();
+}
+
+bool OpSegment::UnrefSharedKernel(OpKernel* kernel) {
+  SharedKernels* shared = GetSharedKernels();
+  {
+    mutex_lock l(shared->mu);
+    auto key_it = shared->keys.find(kernel);
+    if (key_it == shared->keys.end()) return false;
+    auto it = shared->entries.find(key_it->second);
+    DCHECK(it != shared->entries.end());
+    if (--it->second.refs > 0) return true;
+    shared->entries.erase(it);
+    shared->keys.erase(key_it);
+  }
+  delete kernel;
+  return true;
+}
+
+bool OpSegment::ShouldShareKernel(FunctionLibraryRuntime* lib,
+                                  const NodeDef& ndef) {
+  const string& node_op = ndef.op();
+  return !lib->IsStateful(node_op) &&
+         lib->GetFunctionLibraryDefinition()->Find(node_op) == nullptr &&
+         node_op != "PartitionedCall" && node_op != "StatefulPartitionedCall" &&
+         !HasFunctionAttr(ndef);
+}
+
 bool OpSegment::ShouldOwnKernel(FunctionLibraryRuntime* lib,
                                 const string& node_op) {
   // OpSegment should not own kernel if the node is stateless, or a function.
@@ -65,6 +65,29 @@ class OpSegment {
   static bool ShouldOwnKernel(FunctionLibraryRuntime* lib,
                               const std::string& node_op);
 
+  // Process-wide cache of kernels shared between sessions.
+  //
+  // If a kernel for an identical "ndef" has been created for a device
+  // identified by "device_key", returns it in "*kernel". Otherwise, creates
+  // the kernel by calling create_fn() and caches it. Every successful call
+  // must be matched by a call to UnrefSharedKernel(*kernel).
+  //
+  // Only kernels for which ShouldShareKernel() returns true may be shared,
+  // and their constructors must not retain the device they are created for.
+  static Status FindOrCreateShared(const std::string& device_key,
+                                   const NodeDef& ndef, OpKernel** kernel,
+                                   CreateKernelFn create_fn);
+
+  // Releases a kernel returned by FindOrCreateShared(), and deletes it once
+  // no session uses it. Returns false, and does nothing, if "kernel" is not a
+  // shared kernel.
+  static bool UnrefSharedKernel(OpKernel* kernel);
+
+  // Returns true if the kernel for "ndef" can be shared between sessions: it
+  // is stateless, and neither is nor calls a function.
+  static bool ShouldShareKernel(FunctionLibraryRuntime* lib,
+                                const NodeDef& ndef);
+
  private:
   // op name -> OpKernel
   typedef std::unordered_map<string, OpKernel*> KernelMap;
@@ -156,4 +156,45 @@ TEST_F(OpSegmentTest, AddRemoveHolds) {
   opseg.RemoveHold("foo");
 }
 
+TEST_F(OpSegmentTest, SharedKernels) {
+  auto reterr = [](OpKernel** kernel) {
+    return errors::Internal("Should not be called");
+  };
+  const auto& ndef = float_nodedefs_[0];
+  OpKernel* op1;
+  TF_EXPECT_OK(OpSegment::FindOrCreateShared("cpu:0", ndef, &op1,
+                                             GetFn(&ndef)));
+  ValidateOpAndTypes(op1, ndef, DT_FLOAT);
+
+  // An identical NodeDef for the same device gets the same kernel.
+  NodeDef copy = ndef;
+  OpKernel* op2;
+  TF_EXPECT_OK(OpSegment::FindOrCreateShared("cpu:0", copy, &op2, reterr));
+  EXPECT_EQ(op1, op2);
+
+  // A different device or NodeDef gets its own kernel.
+  OpKernel* op3;
+  TF_EXPECT_OK(OpSegment::FindOrCreateShared("cpu:1", ndef, &op3,
+                                             GetFn(&ndef)));
+  EXPECT_NE(op1, op3);
+  const auto& other = int32_nodedefs_[0];
+  OpKernel* op4;
+  TF_EXPECT_OK(OpSegment::FindOrCreateShared("cpu:0", other, &op4,
+                                             GetFn(&other)));
+  ValidateOpAndTypes(op4, other, DT_INT32);
+
+  EXPECT_TRUE(OpSegment::UnrefSharedKernel(op1));
+  // The kernel is kept alive by the second reference.
+  ValidateOpAndTypes(op2, ndef, DT_FLOAT);
+  EXPECT_TRUE(OpSegment::UnrefSharedKernel(op2));
+  EXPECT_TRUE(OpSegment::UnrefSharedKernel(op3));
+  EXPECT_TRUE(OpSegment::UnrefSharedKernel(op4));
+
+  // Unshared kernels are left to the caller.
+  OpKernel* op5;
+  TF_EXPECT_OK(GetFn(&ndef)(&op5));
+  EXPECT_FALSE(OpSegment::UnrefSharedKernel(op5));
+  delete op5;
+}
+
 }  // namespace tensorflow
@@ -20,6 +20,58 @@ limitations under the License.
 
 namespace tensorflow {
 
+std::atomic<int64_t> Var::num_tracking_touched_rows_{0};
+
+Var::~Var() {
+  if (tracks_touched_rows()) {
+    num_tracking_touched_rows_.fetch_sub(1, std::memory_order_relaxed);
+  }
+}
+
+void Var::TrackTouchedRows() {
+  if (!tracks_touched_rows_.exchange(true)) {
+    num_tracking_touched_rows_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+namespace {
+
+template <typename Index>
+void MarkRows(const Tensor& indices, std::vector<bool>* rows) {
+  const auto flat = indices.flat<Index>();
+  for (int64_t i = 0; i < flat.size(); ++i) {
+    const Index row = flat(i);
+    if (row < 0) continue;
+    if (static_cast<size_t>(row) >= rows->size()) rows->resize(row + 1);
+    (*rows)[row] = true;
+  }
+}
+
+}  // namespace
+
+void Var::MarkRowsTouched(const Tensor& indices) {
+  if (!tracks_touched_rows()) return;
+  mutex_lock l(touched_rows_mu_);
+  if (indices.dtype() == DT_INT32) {
+    MarkRows<int32>(indices, &touched_rows_);
+  } else if (indices.dtype() == DT_INT64) {
+    MarkRows<int64_t>(indices, &touched_rows_);
+  }
+}
+
+std::vector<int64_t> Var::TakeTouchedRows() {
+  std::vector<bool> touched_rows;
+  {
+    mutex_lock l(touched_rows_mu_);
+    touched_rows.swap(touched_rows_);
+  }
+  std::vector<int64_t> rows;
+  for (size_t row = 0; row < touched_rows.size(); ++row) {
+    if (touched_rows[row]) rows.push_back(row);
+  }
+  return rows;
+}
+
 Status Var::AsGraphDef(GraphDefBuilder* builder, Node** out) const {
   // Set a shared_name so that the created resource can outlive the graph that
   // created it.
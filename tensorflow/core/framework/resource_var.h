@@ -16,7 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_RESOURCE_VAR_H_
 #define TENSORFLOW_CORE_FRAMEWORK_RESOURCE_VAR_H_
 
+#include <atomic>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/framework/resource_base.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -110,12 +113,40 @@ class Var : public ResourceBase {
   // so desired.
   std::atomic<bool> copy_on_read_mode{false};
 
+  // Starts recording the rows, i.e. indices in the first dimension, that
+  // sparse updates on CPU touch, so that a checkpoint can write only the rows
+  // updated since the previous one (see BundleWriter::AddRowDelta).
+  void TrackTouchedRows();
+  bool tracks_touched_rows() const {
+    return tracks_touched_rows_.load(std::memory_order_relaxed);
+  }
+
+  // Records the rows `indices`, an int32 or int64 tensor of any shape, as
+  // touched if the variable tracks touched rows. Ignores negative indices.
+  void MarkRowsTouched(const Tensor& indices);
+
+  // Returns the rows touched since the previous call, in increasing order.
+  std::vector<int64_t> TakeTouchedRows();
+
+  // Whether any variable tracks touched rows. Kernels can skip looking up
+  // their variables to mark rows when none does.
+  static bool AnyTracksTouchedRows() {
+    return num_tracking_touched_rows_.load(std::memory_order_relaxed) > 0;
+  }
+
  private:
+  static std::atomic<int64_t> num_tracking_touched_rows_;
+
   mutex mu_;
   Tensor tensor_;
   std::string debug_name_;
 
-  ~Var() override {}
+  std::atomic<bool> tracks_touched_rows_{false};
+  mutex touched_rows_mu_;
+  // Indexed by row.
+  std::vector<bool> touched_rows_ TF_GUARDED_BY(touched_rows_mu_);
+
+  ~Var() override;
   Var(const Var&) = delete;
   void operator=(const Var&) = delete;
 };
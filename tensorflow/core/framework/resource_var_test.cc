@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/framework/resource_var.h"
 
+#include <gmock/gmock.h>
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
 
@@ -34,5 +36,26 @@ TEST(ResourceVarTest, Uninitialize) {
   EXPECT_FALSE(var->is_initialized);
   EXPECT_TRUE(var->tensor()->data() == nullptr);
 }
+
+TEST(ResourceVarTest, TouchedRows) {
+  RefCountPtr<Var> var{new Var(DT_FLOAT)};
+  var->MarkRowsTouched(test::AsTensor<int32>({1}));
+  EXPECT_FALSE(var->tracks_touched_rows());
+  EXPECT_TRUE(var->TakeTouchedRows().empty());
+
+  var->TrackTouchedRows();
+  EXPECT_TRUE(var->tracks_touched_rows());
+  EXPECT_TRUE(Var::AnyTracksTouchedRows());
+  var->MarkRowsTouched(test::AsTensor<int32>({7, 2, -1, 7}));
+  var->MarkRowsTouched(test::AsTensor<int64_t>({3, 2}, {2, 1}));
+  EXPECT_THAT(var->TakeTouchedRows(), ::testing::ElementsAre(2, 3, 7));
+  EXPECT_TRUE(var->TakeTouchedRows().empty());
+  var->MarkRowsTouched(test::AsTensor<int64_t>({0}));
+  EXPECT_THAT(var->TakeTouchedRows(), ::testing::ElementsAre(0));
+
+  var.reset();
+  EXPECT_FALSE(Var::AnyTracksTouchedRows());
+}
+
 }  // namespace core
 }  // namespace tensorflow
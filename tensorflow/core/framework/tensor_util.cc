@@ -15,7 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/framework/tensor_util.h"
 
+#include <climits>
 #include <cmath>
+#include <cstring>
+#include <string>
 #include <vector>
 
 #include "tensorflow/core/framework/tensor.h"
@@ -23,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/framework/type_traits.h"
 #include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/tensor_coding.h"
 #include "tensorflow/core/platform/types.h"
@@ -442,5 +446,224 @@ Status MakeShape(const Tensor& shape, TensorShape* out) {
   }
 }
 
+namespace {
+
+// The wire types of the TensorProto fields decoded below.
+constexpr uint32 kWireTypeVarint = 0;
+constexpr uint32 kWireTypeLengthDelimited = 2;
+
+// Repeats the last of the `num_values` values at the start of `tensor` over
+// the rest of its elements, or zeroes them if there are no values.
+template <typename T>
+void FillPackedTail(int64_t num_values, Tensor* tensor) {
+  T* data = tensor->flat<T>().data();
+  const int64_t n = tensor->NumElements();
+  if (num_values >= n) return;
+  const T fill = num_values == 0 ? T() : data[num_values - 1];
+  std::fill_n(data + num_values, n - num_values, fill);
+}
+
+// Decodes `num_bytes` bytes of packed fixed-size values, e.g. float_val, into
+// `tensor`. On little-endian hosts the values have the same layout on the wire
+// as in the tensor, so they are copied in bulk.
+template <typename T>
+bool DecodePackedFixed(protobuf::io::CodedInputStream* input, int num_bytes,
+                       Tensor* tensor) {
+  if (!port::kLittleEndian || num_bytes % sizeof(T) != 0) return false;
+  const int64_t num_values = num_bytes / sizeof(T);
+  const int64_t num_read = std::min(num_values, tensor->NumElements());
+  if (!input->ReadRaw(tensor->flat<T>().data(), num_read * sizeof(T)) ||
+      !input->Skip(num_bytes - num_read * sizeof(T))) {
+    return false;
+  }
+  FillPackedTail<T>(num_values, tensor);
+  return true;
+}
+
+// Decodes `num_bytes` bytes of packed varints, encoding values of the proto
+// field type `ProtoT`, e.g. int32 for int_val, into `tensor`.
+template <typename T, typename ProtoT>
+bool DecodePackedVarints(protobuf::io::CodedInputStream* input, int num_bytes,
+                         Tensor* tensor) {
+  T* data = tensor->flat<T>().data();
+  const int64_t n = tensor->NumElements();
+  int64_t num_values = 0;
+  const auto limit = input->PushLimit(num_bytes);
+  while (input->BytesUntilLimit() > 0) {
+    protobuf_uint64 v;
+    if (!input->ReadVarint64(&v)) return false;
+    if (num_values < n) {
+      data[num_values] = static_cast<T>(static_cast<ProtoT>(v));
+    }
+    ++num_values;
+  }
+  input->PopLimit(limit);
+  FillPackedTail<T>(num_values, tensor);
+  return true;
+}
+
+}  // namespace
+
+bool DecodePackedTensorProtoField(protobuf::io::CodedInputStream* input,
+                                  int field_number, int num_bytes,
+                                  Tensor* tensor) {
+  const DataType dtype = tensor->dtype();
+  switch (field_number) {
+    case TensorProto::kFloatValFieldNumber:
+      return dtype == DT_FLOAT &&
+             DecodePackedFixed<float>(input, num_bytes, tensor);
+    case TensorProto::kDoubleValFieldNumber:
+      return dtype == DT_DOUBLE &&
+             DecodePackedFixed<double>(input, num_bytes, tensor);
+    case TensorProto::kIntValFieldNumber:
+      switch (dtype) {
+        case DT_INT32:
+          return DecodePackedVarints<int32, int32>(input, num_bytes, tensor);
+        case DT_INT16:
+          return DecodePackedVarints<int16, int32>(input, num_bytes, tensor);
+        case DT_INT8:
+          return DecodePackedVarints<int8, int32>(input, num_bytes, tensor);
+        case DT_UINT16:
+          return DecodePackedVarints<uint16, int32>(input, num_bytes, tensor);
+        case DT_UINT8:
+          return DecodePackedVarints<uint8, int32>(input, num_bytes, tensor);
+        default:
+          return false;
+      }
+    case TensorProto::kInt64ValFieldNumber:
+      return dtype == DT_INT64 && DecodePackedVarints<int64_t, int64_t>(
+                                      input, num_bytes, tensor);
+    case TensorProto::kUint32ValFieldNumber:
+      return dtype == DT_UINT32 &&
+             DecodePackedVarints<uint32, uint32>(input, num_bytes, tensor);
+    case TensorProto::kUint64ValFieldNumber:
+      return dtype == DT_UINT64 &&
+             DecodePackedVarints<uint64, uint64>(input, num_bytes, tensor);
+    case TensorProto::kBoolValFieldNumber:
+      return dtype == DT_BOOL &&
+             DecodePackedVarints<bool, bool>(input, num_bytes, tensor);
+    default:
+      return false;
+  }
+}
+
+bool ParseTensorProtoFast(absl::string_view serialized, Allocator* allocator,
+                          Tensor* tensor) {
+  if (serialized.size() > INT_MAX) return false;
+  protobuf::io::CodedInputStream input(
+      reinterpret_cast<const uint8*>(serialized.data()), serialized.size());
+  DataType dtype = DT_INVALID;
+  TensorShapeProto shape;
+  Tensor parsed;
+  // Values need the dtype and shape, so they must come after them, as they do
+  // in serialized protos.
+  bool seen_values = false;
+  int64_t num_strings = 0;
+  const auto allocate = [&]() {
+    if (dtype == DT_INVALID || !TensorShape::IsValid(shape)) return false;
+    parsed = Tensor(allocator, dtype, TensorShape(shape));
+    seen_values = true;
+    return parsed.NumElements() == 0 || parsed.tensor_data().data() != nullptr;
+  };
+  while (true) {
+    const uint32 tag = input.ReadTag();
+    if (tag == 0) break;
+    const int field_number = tag >> 3;
+    const uint32 wire_type = tag & 0x7;
+    uint32 size;
+    switch (field_number) {
+      case TensorProto::kDtypeFieldNumber: {
+        uint32 v;
+        if (wire_type != kWireTypeVarint || !input.ReadVarint32(&v) ||
+            seen_values || !DataType_IsValid(v)) {
+          return false;
+        }
+        dtype = static_cast<DataType>(v);
+        if (!DataTypeCanUseMemcpy(dtype) && dtype != DT_STRING) return false;
+        break;
+      }
+      case TensorProto::kTensorShapeFieldNumber: {
+        std::string bytes;
+        if (wire_type != kWireTypeLengthDelimited || seen_values ||
+            !input.ReadVarint32(&size) || !input.ReadString(&bytes, size) ||
+            !shape.ParseFromString(bytes)) {
+          return false;
+        }
+        break;
+      }
+      case TensorProto::kVersionNumberFieldNumber: {
+        uint32 v;
+        if (wire_type != kWireTypeVarint || !input.ReadVarint32(&v)) {
+          return false;
+        }
+        break;
+      }
+      case TensorProto::kTensorContentFieldNumber: {
+        if (wire_type != kWireTypeLengthDelimited || seen_values ||
+            !DataTypeCanUseMemcpy(dtype) || !input.ReadVarint32(&size) ||
+            !allocate()) {
+          return false;
+        }
+        StringPiece data = parsed.tensor_data();
+        if (size != data.size() ||
+            !input.ReadRaw(const_cast<char*>(data.data()), size)) {
+          return false;
+        }
+        break;
+      }
+      case TensorProto::kStringValFieldNumber: {
+        if (wire_type != kWireTypeLengthDelimited || dtype != DT_STRING ||
+            !input.ReadVarint32(&size) || (!seen_values && !allocate())) {
+          return false;
+        }
+        // Like Tensor::FromProto, ignores values beyond the number of
+        // elements.
+        if (num_strings == parsed.NumElements()) {
+          if (!input.Skip(size)) return false;
+          break;
+        }
+        if (size > serialized.size() - input.CurrentPosition()) return false;
+        tstring& value = parsed.flat<tstring>()(num_strings++);
+        value.resize_uninitialized(size);
+        if (!input.ReadRaw(value.mdata(), size)) return false;
+        break;
+      }
+      case TensorProto::kFloatValFieldNumber:
+      case TensorProto::kDoubleValFieldNumber:
+      case TensorProto::kIntValFieldNumber:
+      case TensorProto::kInt64ValFieldNumber:
+      case TensorProto::kBoolValFieldNumber:
+      case TensorProto::kUint32ValFieldNumber:
+      case TensorProto::kUint64ValFieldNumber: {
+        if (wire_type != kWireTypeLengthDelimited || seen_values ||
+            !input.ReadVarint32(&size) || size > INT_MAX || !allocate() ||
+            !DecodePackedTensorProtoField(&input, field_number, size,
+                                          &parsed)) {
+          return false;
+        }
+        break;
+      }
+      default:
+        // Other fields, and values that are not packed, are left to the
+        // TensorProto parser.
+        return false;
+    }
+  }
+  if (!input.ConsumedEntireMessage()) return false;
+  if (!seen_values) {
+    if (!allocate()) return false;
+    StringPiece data = parsed.tensor_data();
+    if (dtype != DT_STRING && !data.empty()) {
+      memset(const_cast<char*>(data.data()), 0, data.size());
+    }
+  } else if (dtype == DT_STRING && num_strings > 0) {
+    auto strings = parsed.flat<tstring>();
+    std::fill(strings.data() + num_strings, strings.data() + strings.size(),
+              strings(num_strings - 1));
+  }
+  *tensor = std::move(parsed);
+  return true;
+}
+
 }  // namespace tensor
 }  // namespace tensorflow
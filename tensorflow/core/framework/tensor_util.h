@@ -19,6 +19,8 @@ limitations under the License.
 #include <algorithm>
 #include <vector>
 
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -353,6 +355,25 @@ inline bool CompressTensorProtoInPlace(TensorProto* tensor) {
 // 1-dimensional tensor of type int32 or int64.
 Status MakeShape(const Tensor& shape_t, TensorShape* out);
 
+// Decodes the packed repeated field `field_number` of a serialized
+// TensorProto, whose `num_bytes` bytes are at the current position of `input`,
+// straight into `tensor`, which must already have the dtype and shape of the
+// proto. As in Tensor::FromProto, the last value is repeated if there are
+// fewer values than elements. Returns false if the field is malformed or does
+// not hold values of the dtype of `tensor`, e.g. int_val for a DT_INT32 tensor.
+bool DecodePackedTensorProtoField(protobuf::io::CodedInputStream* input,
+                                  int field_number, int num_bytes,
+                                  Tensor* tensor);
+
+// Parses the serialized TensorProto `serialized` into `*tensor`, allocated with
+// `allocator`, like Tensor::FromProto does with the parsed proto but without
+// building it: `tensor_content`, `string_val` and the packed repeated fields
+// are decoded straight into the tensor. Returns false if `serialized` is
+// invalid or uses anything else, e.g. `variant_val`, in which case it should be
+// parsed as a TensorProto instead.
+bool ParseTensorProtoFast(absl::string_view serialized, Allocator* allocator,
+                          Tensor* tensor);
+
 }  // namespace tensor
 }  // namespace tensorflow
 
@@ -15,8 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/framework/tensor_util.h"
 
+#include <string>
 #include <vector>
 
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
@@ -25,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/framework/variant_tensor_data.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 namespace {
@@ -736,5 +739,142 @@ TEST(TensorProtoUtil, CompressTensorProtoNegatizeZero) {
   }
 }
 
+// Checks that ParseTensorProtoFast on the serialized `proto` gives the tensor
+// Tensor::FromProto does.
+void ExpectParsesLikeFromProto(const TensorProto& proto) {
+  Tensor expected;
+  ASSERT_TRUE(expected.FromProto(proto));
+  Tensor parsed;
+  ASSERT_TRUE(tensor::ParseTensorProtoFast(proto.SerializeAsString(),
+                                           cpu_allocator(), &parsed))
+      << proto.DebugString();
+  test::ExpectEqual(expected, parsed, test::Tolerance::kNone);
+}
+
+TEST(TensorProtoUtil, ParseTensorProtoFast) {
+  TensorProto content_proto;
+  test::AsTensor<float>({1.5, -2, 0, 7}, {2, 2})
+      .AsProtoTensorContent(&content_proto);
+  ExpectParsesLikeFromProto(content_proto);
+  for (const char* text : {
+           "dtype: DT_FLOAT tensor_shape { dim { size: 3 } } "
+           "float_val: [1.5, -2, 3]",
+           "dtype: DT_FLOAT tensor_shape { dim { size: 5 } } "
+           "float_val: [1.5, -2]",
+           "dtype: DT_DOUBLE tensor_shape { dim { size: 2 } } "
+           "double_val: 0.25",
+           "dtype: DT_INT32 tensor_shape { dim { size: 3 } } "
+           "int_val: [-1, 2, 2147483647]",
+           "dtype: DT_INT8 tensor_shape { dim { size: 3 } } "
+           "int_val: [-128, 5, 127]",
+           "dtype: DT_UINT8 tensor_shape { dim { size: 2 } } "
+           "int_val: [255, 1]",
+           "dtype: DT_INT64 tensor_shape { dim { size: 2 } } "
+           "int64_val: [-9223372036854775808, 3]",
+           "dtype: DT_UINT64 tensor_shape { dim { size: 1 } } "
+           "uint64_val: 18446744073709551615",
+           "dtype: DT_BOOL tensor_shape { dim { size: 3 } } "
+           "bool_val: [true, false]",
+           "dtype: DT_INT32 tensor_shape { dim { size: 4 } }",
+           "dtype: DT_INT32 tensor_shape { dim { size: 2 } } "
+           "int_val: [1, 2, 3]",
+           "dtype: DT_INT32 tensor_shape { dim { size: 0 } } int_val: 1",
+           "dtype: DT_FLOAT float_val: 3",
+           "dtype: DT_STRING tensor_shape { dim { size: 3 } } "
+           "string_val: ['a', 'a string longer than the inline capacity']",
+           "dtype: DT_STRING tensor_shape { dim { size: 2 } }",
+       }) {
+    TensorProto proto;
+    ASSERT_TRUE(protobuf::TextFormat::ParseFromString(text, &proto)) << text;
+    ExpectParsesLikeFromProto(proto);
+  }
+}
+
+TEST(TensorProtoUtil, ParseTensorProtoFastLeavesOtherProtos) {
+  Tensor parsed;
+  for (const char* text : {
+           "dtype: DT_HALF tensor_shape { dim { size: 1 } } half_val: 1",
+           "dtype: DT_INT64 tensor_shape { dim { size: 1 } } int_val: 1",
+           "dtype: DT_INT32 tensor_shape { dim { size: 2 } } "
+           "tensor_content: 'abc'",
+           "dtype: DT_INT32 tensor_shape { dim { size: -1 } }",
+           "tensor_shape { dim { size: 1 } }",
+           "dtype: DT_VARIANT",
+       }) {
+    TensorProto proto;
+    ASSERT_TRUE(protobuf::TextFormat::ParseFromString(text, &proto)) << text;
+    EXPECT_FALSE(tensor::ParseTensorProtoFast(proto.SerializeAsString(),
+                                              cpu_allocator(), &parsed))
+        << text;
+  }
+  // int_val: 1 without packing.
+  EXPECT_FALSE(tensor::ParseTensorProtoFast(
+      absl::string_view("\x08\x03\x38\x01", 4), cpu_allocator(), &parsed));
+  // A truncated float_val.
+  EXPECT_FALSE(tensor::ParseTensorProtoFast(
+      absl::string_view("\x08\x01\x2a\x08\x00\x00", 6), cpu_allocator(),
+      &parsed));
+}
+
+// Parses a serialized TensorProto of `state.range(0)` float_val values,
+// through ParseTensorProtoFast if `state.range(1)` is 1.
+void BM_ParseTensorProto(::testing::benchmark::State& state) {
+  const int num_elements = state.range(0);
+  const bool fast = state.range(1) == 1;
+  Tensor t(DT_FLOAT, TensorShape({num_elements}));
+  t.flat<float>().setRandom();
+  TensorProto proto;
+  t.AsProtoField(&proto);
+  const std::string serialized = proto.SerializeAsString();
+  for (auto s : state) {
+    Tensor parsed;
+    if (fast) {
+      CHECK(tensor::ParseTensorProtoFast(serialized, cpu_allocator(), &parsed));
+    } else {
+      TensorProto parsed_proto;
+      CHECK(parsed_proto.ParseFromString(serialized));
+      CHECK(parsed.FromProto(cpu_allocator(), parsed_proto));
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * serialized.size());
+}
+BENCHMARK(BM_ParseTensorProto)
+    ->ArgPair(16, 0)
+    ->ArgPair(16, 1)
+    ->ArgPair(1024, 0)
+    ->ArgPair(1024, 1)
+    ->ArgPair(1 << 20, 0)
+    ->ArgPair(1 << 20, 1);
+
+// Same for string_val values of `state.range(2)` bytes each.
+void BM_ParseStringTensorProto(::testing::benchmark::State& state) {
+  const int num_elements = state.range(0);
+  const bool fast = state.range(1) == 1;
+  const int string_size = state.range(2);
+  Tensor t(DT_STRING, TensorShape({num_elements}));
+  for (int i = 0; i < num_elements; ++i) {
+    t.flat<tstring>()(i) = std::string(string_size, 'a' + i % 26);
+  }
+  TensorProto proto;
+  t.AsProtoField(&proto);
+  const std::string serialized = proto.SerializeAsString();
+  for (auto s : state) {
+    Tensor parsed;
+    if (fast) {
+      CHECK(tensor::ParseTensorProtoFast(serialized, cpu_allocator(), &parsed));
+    } else {
+      TensorProto parsed_proto;
+      CHECK(parsed_proto.ParseFromString(serialized));
+      CHECK(parsed.FromProto(cpu_allocator(), parsed_proto));
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * serialized.size());
+}
+BENCHMARK(BM_ParseStringTensorProto)
+    ->Args({1024, 0, 8})
+    ->Args({1024, 1, 8})
+    ->Args({1024, 0, 256})
+    ->Args({1024, 1, 256});
+
 }  // namespace
 }  // namespace tensorflow
@@ -39,6 +39,8 @@ class VirtualCluster : public Cluster {
                  std::unique_ptr<OpLevelCostEstimator> node_estimator,
                  std::unique_ptr<ReadyNodeManager> node_manager);
   explicit VirtualCluster(const DeviceSet* device_set);
+  VirtualCluster(const DeviceSet* device_set,
+                 std::unique_ptr<OpLevelCostEstimator> node_estimator);
 
   ~VirtualCluster() override;
 
@@ -32,19 +32,23 @@ namespace tensorflow {
 namespace grappler {
 
 Status GraphMemory::InferStatically(
-    const std::unordered_map<string, DeviceProperties>& devices) {
+    const std::unordered_map<string, DeviceProperties>& devices,
+    RunMetadata* metadata) {
   VirtualCluster cluster(devices);
   TF_RETURN_IF_ERROR(cluster.Provision());
   TF_RETURN_IF_ERROR(cluster.Initialize(item_));
-  RunMetadata metadata;
-  Status s = cluster.Run(item_, &metadata);
+  RunMetadata local_metadata;
+  if (metadata == nullptr) {
+    metadata = &local_metadata;
+  }
+  Status s = cluster.Run(item_, metadata);
   // The virtual cluster returns the RESOURCE_EXHAUSTED error when it detects
   // that the model would run out of memory. We still get the metadata we need
   // out of the simulation, so we just ignore this error.
   if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
     return s;
   }
-  InferFromTrace(metadata.step_stats());
+  InferFromTrace(metadata->step_stats());
   return absl::OkStatus();
 }
 
@@ -43,8 +43,11 @@ class GraphMemory {
   explicit GraphMemory(const GrapplerItem& item)
       : item_(item), unknown_usage_({-1, {}}) {}
 
+  // If `metadata` is not null, it is populated with the step stats of the
+  // simulated run, which also carry the estimated execution time of every node.
   Status InferStatically(
-      const std::unordered_map<string, DeviceProperties>& devices);
+      const std::unordered_map<string, DeviceProperties>& devices,
+      RunMetadata* metadata = nullptr);
   Status InferDynamically(Cluster* cluster);
 
   // Worst case memory usage in bytes, or -1 if the usage is unknown. If there
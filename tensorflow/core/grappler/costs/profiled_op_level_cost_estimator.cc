@@ -0,0 +1,66 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/profiled_op_level_cost_estimator.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace grappler {
+
+ProfiledOpLevelCostEstimator::ProfiledOpLevelCostEstimator(
+    const CostGraphDef& profile) {
+  for (const CostGraphDef::Node& node : profile.node()) {
+    // A node that was never executed while profiling has no cost, and is
+    // better estimated analytically than assumed to be free.
+    if (node.compute_cost() <= 0) continue;
+    MeasuredCost& cost = measured_costs_[node.name()];
+    cost.compute_cost_us = node.compute_cost();
+    cost.compute_time_us = node.compute_time();
+    cost.memory_time_us = node.memory_time();
+    cost.temporary_memory_size = node.temporary_memory_size();
+    cost.persistent_memory_size = node.persistent_memory_size();
+    cost.inaccurate = node.inaccurate();
+  }
+  VLOG(1) << "Loaded measured costs of " << measured_costs_.size()
+          << " nodes out of " << profile.node_size();
+}
+
+Costs ProfiledOpLevelCostEstimator::PredictCosts(
+    const OpContext& op_context) const {
+  auto it = measured_costs_.find(op_context.name);
+  if (it == measured_costs_.end()) {
+    return OpLevelCostEstimator::PredictCosts(op_context);
+  }
+  const MeasuredCost& measured = it->second;
+  Costs costs = Costs::ZeroCosts(measured.inaccurate);
+  costs.execution_time = Costs::MicroSeconds(measured.compute_cost_us);
+  // Older profiles only record the total cost of the node.
+  costs.compute_time = Costs::MicroSeconds(
+      measured.compute_time_us > 0 ? measured.compute_time_us
+                                   : measured.compute_cost_us);
+  costs.memory_time = Costs::MicroSeconds(measured.memory_time_us);
+  costs.temporary_memory = measured.temporary_memory_size;
+  costs.persistent_memory = measured.persistent_memory_size;
+  costs.max_memory = std::max(measured.temporary_memory_size,
+                              measured.persistent_memory_size);
+  costs.num_ops_total = 1;
+  return costs;
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,62 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_COSTS_PROFILED_OP_LEVEL_COST_ESTIMATOR_H_
+#define TENSORFLOW_CORE_GRAPPLER_COSTS_PROFILED_OP_LEVEL_COST_ESTIMATOR_H_
+
+#include <cstdint>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/cost_graph.pb.h"
+#include "tensorflow/core/grappler/costs/cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Op cost estimator that uses the costs measured in a recorded profile, for
+// example the CostGraphDef collected by the CostModelManager or returned in
+// RunMetadata. Nodes are matched by name. Nodes missing from the profile, or
+// without a measured cost, fall back to the analytical estimate of
+// OpLevelCostEstimator.
+class ProfiledOpLevelCostEstimator : public OpLevelCostEstimator {
+ public:
+  explicit ProfiledOpLevelCostEstimator(const CostGraphDef& profile);
+  ~ProfiledOpLevelCostEstimator() override {}
+
+  Costs PredictCosts(const OpContext& op_context) const override;
+
+  // Returns the number of nodes with a measured cost in the profile.
+  int num_profiled_nodes() const { return measured_costs_.size(); }
+
+ private:
+  struct MeasuredCost {
+    int64_t compute_cost_us;
+    int64_t compute_time_us;
+    int64_t memory_time_us;
+    int64_t temporary_memory_size;
+    int64_t persistent_memory_size;
+    bool inaccurate;
+  };
+
+  absl::flat_hash_map<std::string, MeasuredCost> measured_costs_;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_COSTS_PROFILED_OP_LEVEL_COST_ESTIMATOR_H_
@@ -0,0 +1,85 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/profiled_op_level_cost_estimator.h"
+
+#include "tensorflow/core/framework/cost_graph.pb.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+OpContext DescribeMatMul(const string& name) {
+  OpContext op_context;
+  op_context.name = name;
+  op_context.op_info.set_op("MatMul");
+  DeviceProperties* device = op_context.op_info.mutable_device();
+  device->set_type("CPU");
+  device->set_num_cores(10);
+  device->set_bandwidth(10000000);
+  device->set_frequency(1000);
+  for (int i = 0; i < 2; ++i) {
+    OpInfo::TensorProperties* input = op_context.op_info.add_inputs();
+    input->set_dtype(DT_FLOAT);
+    input->mutable_shape()->add_dim()->set_size(64);
+    input->mutable_shape()->add_dim()->set_size(64);
+  }
+  return op_context;
+}
+
+CostGraphDef MakeProfile() {
+  CostGraphDef profile;
+  CostGraphDef::Node* matmul = profile.add_node();
+  matmul->set_name("matmul");
+  matmul->set_compute_cost(250);
+  matmul->set_compute_time(200);
+  matmul->set_memory_time(50);
+  matmul->set_temporary_memory_size(1024);
+  matmul->set_persistent_memory_size(16);
+  // Never executed while profiling.
+  CostGraphDef::Node* skipped = profile.add_node();
+  skipped->set_name("skipped");
+  return profile;
+}
+
+TEST(ProfiledOpLevelCostEstimatorTest, UsesMeasuredCosts) {
+  ProfiledOpLevelCostEstimator estimator(MakeProfile());
+  EXPECT_EQ(estimator.num_profiled_nodes(), 1);
+
+  Costs costs = estimator.PredictCosts(DescribeMatMul("matmul"));
+  EXPECT_EQ(costs.execution_time, Costs::Duration(250000));
+  EXPECT_EQ(costs.compute_time, Costs::Duration(200000));
+  EXPECT_EQ(costs.memory_time, Costs::Duration(50000));
+  EXPECT_EQ(costs.temporary_memory, 1024);
+  EXPECT_EQ(costs.persistent_memory, 16);
+  EXPECT_FALSE(costs.inaccurate);
+}
+
+TEST(ProfiledOpLevelCostEstimatorTest, FallsBackToAnalyticalCosts) {
+  ProfiledOpLevelCostEstimator estimator(MakeProfile());
+  OpLevelCostEstimator analytical;
+  for (const string& name : {"not_profiled", "skipped"}) {
+    Costs costs = estimator.PredictCosts(DescribeMatMul(name));
+    Costs expected = analytical.PredictCosts(DescribeMatMul(name));
+    EXPECT_EQ(costs.execution_time, expected.execution_time) << name;
+    EXPECT_EQ(costs.compute_time, expected.compute_time) << name;
+  }
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -24,12 +24,14 @@ limitations under the License.
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/ascii.h"
 #include "absl/strings/str_join.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/attr_value_util.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/framework/types.h"
@@ -4290,6 +4292,138 @@ class RemoveCastIntoSegmentReductionStage : public ArithmeticOptimizerStage {
   }
 };
 
+// Reduces the rows of a ragged tensor directly from its flat values, instead
+// of padding it to a dense tensor first:
+//
+//   Sum(RaggedTensorToTensor(shape=-1, values, default_value=0, [splits]),
+//       axis=1)
+//     => RaggedReduceRows(splits, values, reduction="sum")
+//
+// and likewise for Prod, Max and Min. The padding does not change the result
+// when the default value is the identity of the reduction, which
+// RaggedReduceRows also produces for empty rows.
+class FuseRaggedToTensorReductionStage : public ArithmeticOptimizerStage {
+ public:
+  explicit FuseRaggedToTensorReductionStage(
+      const GraphOptimizerContext& ctx,
+      const ArithmeticOptimizerContext& ctx_ext)
+      : ArithmeticOptimizerStage("FuseRaggedToTensorReductionStage", ctx,
+                                 ctx_ext) {}
+  ~FuseRaggedToTensorReductionStage() override = default;
+
+  bool IsSupported(const NodeDef* node) const override {
+    return IsSum(*node) || IsProd(*node) || IsMax(*node) || IsMin(*node);
+  }
+
+  Status TrySimplify(NodeDef* reduction_node,
+                     string* simplified_node_name) override {
+    if (IsInPreserveSet(*reduction_node)) return absl::OkStatus();
+    // RaggedReduceRows only has a CPU kernel.
+    if (!reduction_node->device().empty() && !NodeIsOnCpu(*reduction_node)) {
+      return absl::OkStatus();
+    }
+    bool keep_dims = false;
+    if (TryGetNodeAttr(*reduction_node, "keep_dims", &keep_dims) &&
+        keep_dims) {
+      return absl::OkStatus();
+    }
+    if (!IsConstantScalar(reduction_node->input(1), 1)) {
+      return absl::OkStatus();
+    }
+
+    NodeDef* to_tensor_node = nullptr;
+    TF_RETURN_IF_ERROR(GetInputNode(reduction_node->input(0), &to_tensor_node));
+    if (to_tensor_node->op() != "RaggedTensorToTensor" ||
+        to_tensor_node->device() != reduction_node->device() ||
+        HasControlInputs(*to_tensor_node)) {
+      return absl::OkStatus();
+    }
+    std::vector<string> partition_types;
+    if (!TryGetNodeAttr(*to_tensor_node, "row_partition_types",
+                        &partition_types) ||
+        partition_types != std::vector<string>({"ROW_SPLITS"})) {
+      return absl::OkStatus();
+    }
+    // Input 0 (shape) must leave every dimension unknown, so that the rows
+    // are neither truncated nor padded beyond the longest one.
+    Tensor shape;
+    if (!GetTensorFromConstNode(to_tensor_node->input(0), &shape) ||
+        !AllElementsAre(shape, -1)) {
+      return absl::OkStatus();
+    }
+    // Input 2 (default_value) must be the identity of the reduction.
+    const string reduction = absl::AsciiStrToLower(reduction_node->op());
+    Tensor default_value;
+    if (!GetTensorFromConstNode(to_tensor_node->input(2), &default_value) ||
+        !IsReductionIdentity(default_value, reduction)) {
+      return absl::OkStatus();
+    }
+
+    DataType splits_type;
+    TF_RETURN_IF_ERROR(GetNodeAttr(*to_tensor_node, "Tindex", &splits_type));
+    const string splits = to_tensor_node->input(3);
+    const string values = to_tensor_node->input(1);
+    const string to_tensor = reduction_node->input(0);
+    const string axis = reduction_node->input(1);
+    reduction_node->set_op("RaggedReduceRows");
+    reduction_node->set_input(0, splits);
+    reduction_node->set_input(1, values);
+    ctx().node_map->UpdateInput(reduction_node->name(), to_tensor, splits);
+    ctx().node_map->UpdateInput(reduction_node->name(), axis, values);
+    auto* attr = reduction_node->mutable_attr();
+    attr->erase("keep_dims");
+    attr->erase("Tidx");
+    SetAttrValue(reduction, &(*attr)["reduction"]);
+    SetAttrValue(splits_type, &(*attr)["Tsplits"]);
+    *simplified_node_name = reduction_node->name();
+    return absl::OkStatus();
+  }
+
+ private:
+  bool IsConstantScalar(const string& input, int64_t value) {
+    Tensor tensor;
+    if (!GetTensorFromConstNode(input, &tensor) || tensor.NumElements() != 1) {
+      return false;
+    }
+    return AllElementsAre(tensor, value);
+  }
+
+  static bool AllElementsAre(const Tensor& tensor, int64_t value) {
+    for (int64_t i = 0; i < tensor.NumElements(); ++i) {
+      if (tensor.dtype() == DT_INT32) {
+        if (tensor.flat<int32>()(i) != value) return false;
+      } else if (tensor.dtype() == DT_INT64) {
+        if (tensor.flat<int64_t>()(i) != value) return false;
+      } else {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  template <typename T>
+  static bool IsReductionIdentity(const T value, const string& reduction) {
+    if (reduction == "sum") return value == T(0);
+    if (reduction == "prod") return value == T(1);
+    if (reduction == "max") return value == Eigen::NumTraits<T>::lowest();
+    return value == Eigen::NumTraits<T>::highest();
+  }
+
+  static bool IsReductionIdentity(const Tensor& tensor,
+                                  const string& reduction) {
+    if (tensor.dims() != 0) return false;
+    switch (tensor.dtype()) {
+#define HANDLE_TYPE(T)                                               \
+  case DataTypeToEnum<T>::value:                                     \
+    return IsReductionIdentity<T>(tensor.scalar<T>()(), reduction);
+      TF_CALL_REAL_NUMBER_TYPES(HANDLE_TYPE)
+#undef HANDLE_TYPE
+      default:
+        return false;
+    }
+  }
+};
+
 }  // namespace
 
 Status ArithmeticOptimizer::SimplifyArithmeticOps(bool can_use_shapes) {
@@ -4374,6 +4508,8 @@ Status ArithmeticOptimizer::SimplifyArithmeticOps(bool can_use_shapes) {
     pipeline.AddStage<RemoveCastIntoSegmentReductionStage>(ctx, ctx_ext);
   if (options_.fuse_squared_diff)
     pipeline.AddStage<FuseSquaredDiffStage>(ctx, ctx_ext);
+  if (options_.fuse_ragged_to_tensor_reduction)
+    pipeline.AddStage<FuseRaggedToTensorReductionStage>(ctx, ctx_ext);
 
   VLOG(1) << "Run " << pipeline.NumStages() << " arithmetic optimizer stages: "
           << absl::StrJoin(pipeline.StageNames(), ", ");
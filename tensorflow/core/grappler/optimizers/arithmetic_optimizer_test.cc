@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/resource_variable_ops.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/inputs/trivial_test_graph_input_yielder.h"
@@ -4833,5 +4834,61 @@ TEST_F(ArithmeticOptimizerTest, RemoveCastIntoSegmentReduction) {
   }
 }
 
+TEST_F(ArithmeticOptimizerTest, FuseRaggedToTensorReduction) {
+  for (const string reduction : {"Sum", "Max"}) {
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+    // rt = [[1, 2, 3], [], [4, 5]]
+    ops::Const(s.WithOpName("values"), {1.0f, 2.0f, 3.0f, 4.0f, 5.0f});
+    ops::Const(s.WithOpName("splits"), test::AsTensor<int64_t>({0, 3, 3, 5}));
+    ops::Const(s.WithOpName("shape"), test::AsScalar<int64_t>(-1));
+    ops::Const(s.WithOpName("zero"), 0.0f);
+    ops::Const(s.WithOpName("axis"), 1);
+
+    GrapplerItem item;
+    TF_CHECK_OK(s.ToGraphDef(&item.graph));
+    TF_CHECK_OK(
+        NodeDefBuilder("to_tensor", "RaggedTensorToTensor")
+            .Input("shape", 0, DT_INT64)
+            .Input("values", 0, DT_FLOAT)
+            .Input("zero", 0, DT_FLOAT)
+            .Input(std::vector<NodeDefBuilder::NodeOut>{{"splits", 0,
+                                                         DT_INT64}})
+            .Attr("row_partition_types", {"ROW_SPLITS"})
+            .Finalize(item.graph.add_node()));
+    TF_CHECK_OK(NodeDefBuilder("result", reduction)
+                    .Input("to_tensor", 0, DT_FLOAT)
+                    .Input("axis", 0, DT_INT32)
+                    .Finalize(item.graph.add_node()));
+    TF_CHECK_OK(NodeDefBuilder("id", "Identity")
+                    .Input("result", 0, DT_FLOAT)
+                    .Finalize(item.graph.add_node()));
+    item.fetch = {"id"};
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+    ASSERT_EQ(tensors_expected.size(), 1);
+
+    GraphDef output;
+    ArithmeticOptimizer optimizer;
+    EnableOnlyFuseRaggedToTensorReduction(&optimizer);
+    OptimizeAndPrune(&optimizer, &item, &output);
+
+    // The padding of Max with zeros is not a no-op.
+    const bool fused = reduction == "Sum";
+    for (const auto& node : output.node()) {
+      if (node.name() == "result") {
+        EXPECT_EQ(node.op(), fused ? "RaggedReduceRows" : reduction);
+        if (fused) {
+          EXPECT_EQ(node.input(0), "splits");
+          EXPECT_EQ(node.input(1), "values");
+        }
+      }
+      if (fused) EXPECT_NE(node.op(), "RaggedTensorToTensor");
+    }
+
+    auto tensors = EvaluateNodes(output, item.fetch);
+    ASSERT_EQ(tensors.size(), 1);
+    test::ExpectTensorEqual<float>(tensors[0], tensors_expected[0]);
+  }
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
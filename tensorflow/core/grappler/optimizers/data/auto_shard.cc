@@ -76,8 +76,9 @@ constexpr char kOutputShapes[] = "output_shapes";
 constexpr char kOutputTypes[] = "output_types";
 
 // clang-format off
-constexpr std::array<const char*, 6> kReaderDatasetOps = {
+constexpr std::array<const char*, 7> kReaderDatasetOps = {
     "ArrayRecordDataset",
+    "ColumnarRecordDataset",
     "FixedLengthRecordDataset",
     "RecordIODataset",
     "SSTableDataset",
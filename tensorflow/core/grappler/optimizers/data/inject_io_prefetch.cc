@@ -52,9 +52,10 @@ constexpr char kPrefetch[] = "PrefetchDataset";
 constexpr std::array<const char*, 5> kAsync = {
     "MapAndBatchDataset", "ParallelBatchDataset", "ParallelInterleaveDataset",
     "ParallelMapDataset", "PrefetchDataset"};
-constexpr std::array<const char*, 6> kIo = {
-    "ArrayRecordDataset", "FixedLengthRecordDataset", "RecordIODataset",
-    "SSTableDataset",     "TextLineDataset",          "TFRecordDataset"};
+constexpr std::array<const char*, 7> kIo = {
+    "ArrayRecordDataset", "ColumnarRecordDataset", "FixedLengthRecordDataset",
+    "RecordIODataset",    "SSTableDataset",        "TextLineDataset",
+    "TFRecordDataset"};
 
 bool IsAsync(const NodeDef* node) {
   if (!node) {
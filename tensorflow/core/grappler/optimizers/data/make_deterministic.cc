@@ -61,9 +61,10 @@ constexpr char kPrefetchOp[] = "PrefetchDataset";
 // Ops in this list are allowed to read from files, as we do not make any
 // guarantees on determinism if files are modified while a dataset is running.
 // TODO(reedwm): Expand this list.
-constexpr std::array<const char*, 9> kDeterministicStatefulOps = {
+constexpr std::array<const char*, 10> kDeterministicStatefulOps = {
     "TextLineDataset", "FixedLengthRecordDataset", "TFRecordDataset",
     "TensorSliceDataset", "RangeDataset", "SSTableDataset", "RecordIODataset",
+    "ColumnarRecordDataset",
     // Because Print and Assert are on this list, the order of Print and Assert
     // ops may not be deterministic. This is acceptable, as it doesn't affect
     // model outputs or weights or other numeric values.
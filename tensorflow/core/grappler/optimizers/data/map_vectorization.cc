@@ -0,0 +1,255 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_vectorization.h"
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/function_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/platform/protobuf.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kMapDataset[] = "MapDataset";
+constexpr char kParallelMapDatasetV2[] = "ParallelMapDatasetV2";
+constexpr char kBatchDataset[] = "BatchDataset";
+constexpr char kBatchDatasetV2[] = "BatchDatasetV2";
+constexpr char kMapDefun[] = "MapDefun";
+constexpr char kOutputShapes[] = "output_shapes";
+constexpr char kOutputTypes[] = "output_types";
+constexpr char kPreserveCardinality[] = "preserve_cardinality";
+
+bool IsMapOrParallelMap(const NodeDef& node) {
+  return node.op() == kMapDataset || node.op() == kParallelMapDatasetV2;
+}
+
+bool IsBatch(const NodeDef& node) {
+  return node.op() == kBatchDataset || node.op() == kBatchDatasetV2;
+}
+
+// Returns whether the elements produced by `node` have fully defined shapes.
+bool HasFullyDefinedOutputShapes(const NodeDef& node) {
+  const AttrValue* shapes = gtl::FindOrNull(node.attr(), kOutputShapes);
+  if (shapes == nullptr || shapes->list().shape_size() == 0) return false;
+  for (const TensorShapeProto& shape : shapes->list().shape()) {
+    if (!PartialTensorShape(shape).IsFullyDefined()) return false;
+  }
+  return true;
+}
+
+// Returns whether `map_node` can be moved after the `batch_node` it feeds.
+bool CanVectorize(const NodeDef& map_node, const NodeDef& input_node,
+                  const FunctionLibraryDefinition& function_library,
+                  const MutableGraphView& graph) {
+  if (graph.GetFanouts(map_node, /*include_controlled_nodes=*/true).size() !=
+      1) {
+    VLOG(1) << "The map is not vectorized because its output is not only "
+               "used by the batch.";
+    return false;
+  }
+  // Without `preserve_cardinality`, an `OutOfRange` error in the function
+  // ends the input early, which cannot be reproduced for a whole batch.
+  const AttrValue* preserve_cardinality =
+      gtl::FindOrNull(map_node.attr(), kPreserveCardinality);
+  if (preserve_cardinality == nullptr || !preserve_cardinality->b()) {
+    VLOG(1) << "The map is not vectorized because it does not preserve "
+               "cardinality.";
+    return false;
+  }
+  if (!HasFullyDefinedOutputShapes(input_node)) {
+    VLOG(1) << "The map is not vectorized because the shapes of its input "
+               "elements are not fully defined.";
+    return false;
+  }
+  const FunctionDef* func =
+      function_library.Find(map_node.attr().at("f").func().name());
+  if (func == nullptr) return false;
+  if (function_utils::IsFunctionStateful(function_library, *func)) {
+    VLOG(1) << "The map is not vectorized because its function is stateful.";
+    return false;
+  }
+  return true;
+}
+
+// Adds a function to `library` that applies the function of `map_node` to
+// every slice of its batched arguments, whose types are `input_types`.
+FunctionDef* AddVectorizedFunction(const NodeDef& map_node,
+                                   const DataTypeVector& input_types,
+                                   FunctionDefLibrary* library) {
+  const AttrValue& f = map_node.attr().at("f");
+  FunctionDef* func = library->add_function();
+  graph_utils::SetUniqueGraphFunctionName(
+      absl::StrCat("map_vectorization/", f.func().name()), library, func);
+
+  std::vector<string> inputs;
+  AttrValue arg_types;
+  for (int i = 0; i < input_types.size(); ++i) {
+    inputs.push_back(absl::StrCat("args_", i));
+    function_utils::AddFunctionInput(inputs.back(), func, input_types[i]);
+    arg_types.mutable_list()->add_type(input_types[i]);
+  }
+  const AttrValue& captured_types = map_node.attr().at("Targuments");
+  for (int i = 0; i < captured_types.list().type_size(); ++i) {
+    inputs.push_back(absl::StrCat("captured_", i));
+    function_utils::AddFunctionInput(
+        inputs.back(), func, captured_types.list().type(i));
+  }
+
+  AttrValue max_intra_op_parallelism;
+  max_intra_op_parallelism.set_i(1);
+  const AttrValue& output_types = map_node.attr().at(kOutputTypes);
+  NodeDef* map_defun = function_utils::AddNode(
+      "map_defun", kMapDefun, inputs,
+      {{"Targuments", arg_types},
+       {"Tcaptured", captured_types},
+       {kOutputTypes, output_types},
+       {kOutputShapes, map_node.attr().at(kOutputShapes)},
+       {"f", f},
+       {"max_intra_op_parallelism", max_intra_op_parallelism}},
+      func);
+  for (int i = 0; i < output_types.list().type_size(); ++i) {
+    function_utils::AddFunctionOutputWithUniqueName(
+        "output", absl::StrCat(map_defun->name(), ":output:", i), func,
+        output_types.list().type(i));
+  }
+  return func;
+}
+
+// Returns a batch node like `batch_node`, that batches the elements of
+// `input_node` instead of those of `map_node`.
+NodeDef MakeBatchNode(const NodeDef& batch_node, const NodeDef& map_node,
+                      const NodeDef& input_node,
+                      const DataTypeVector& input_types,
+                      MutableGraphView* graph) {
+  NodeDef new_batch = batch_node;
+  graph_utils::SetUniqueGraphNodeName(
+      absl::StrCat("map_vectorization/", batch_node.name()), graph->graph(),
+      &new_batch);
+  new_batch.set_input(0, map_node.input(0));
+
+  // The batch dimension is the same as that of the original batch.
+  int64_t batch_dim = -1;
+  const AttrValue& batch_shapes = batch_node.attr().at(kOutputShapes);
+  if (batch_shapes.list().shape_size() > 0 &&
+      batch_shapes.list().shape(0).dim_size() > 0) {
+    batch_dim = batch_shapes.list().shape(0).dim(0).size();
+  }
+  AttrValue output_shapes;
+  for (const TensorShapeProto& shape :
+       input_node.attr().at(kOutputShapes).list().shape()) {
+    PartialTensorShape({batch_dim})
+        .Concatenate(PartialTensorShape(shape))
+        .AsProto(output_shapes.mutable_list()->add_shape());
+  }
+  AttrValue output_types;
+  for (DataType type : input_types) {
+    output_types.mutable_list()->add_type(type);
+  }
+  (*new_batch.mutable_attr())[kOutputShapes] = std::move(output_shapes);
+  (*new_batch.mutable_attr())[kOutputTypes] = std::move(output_types);
+  return new_batch;
+}
+
+// Returns a map node like `map_node`, that applies `vectorized_func` to the
+// output of `new_batch` and produces the elements of `batch_node`.
+NodeDef MakeMapNode(const NodeDef& map_node, const NodeDef& batch_node,
+                    const NodeDef& new_batch,
+                    const FunctionDef& vectorized_func,
+                    MutableGraphView* graph) {
+  NodeDef new_map = map_node;
+  graph_utils::SetUniqueGraphNodeName(
+      absl::StrCat("map_vectorization/", map_node.name()), graph->graph(),
+      &new_map);
+  new_map.set_input(0, new_batch.name());
+  AttrValue f;
+  f.mutable_func()->set_name(vectorized_func.signature().name());
+  (*new_map.mutable_attr())["f"] = std::move(f);
+  graph_utils::CopyShapesAndTypesAttrs(batch_node, &new_map);
+  graph_utils::MaybeSetFusedMetadata(map_node, batch_node, &new_map);
+  return new_map;
+}
+
+}  // namespace
+
+Status MapVectorization::OptimizeAndCollectStats(Cluster* cluster,
+                                                 const GrapplerItem& item,
+                                                 GraphDef* output,
+                                                 OptimizationStats* stats) {
+  *output = item.graph;
+  MutableGraphView graph(output);
+  absl::flat_hash_set<string> nodes_to_delete;
+  FunctionLibraryDefinition function_library(OpRegistry::Global(),
+                                             item.graph.library());
+
+  for (const NodeDef& node : item.graph.node()) {
+    if (!IsBatch(node)) continue;
+
+    // Use a more descriptive variable name now that we know the node type.
+    const NodeDef& batch_node = node;
+    NodeDef* map_node = graph_utils::GetInputNode(batch_node, graph);
+    if (map_node == nullptr || !IsMapOrParallelMap(*map_node) ||
+        nodes_to_delete.contains(map_node->name())) {
+      continue;
+    }
+    NodeDef* input_node = graph_utils::GetInputNode(*map_node, graph);
+    if (input_node == nullptr ||
+        !CanVectorize(*map_node, *input_node, function_library, graph)) {
+      continue;
+    }
+    DataTypeVector input_types;
+    if (!graph_utils::GetDatasetOutputTypesAttr(*input_node, &input_types)
+             .ok()) {
+      continue;
+    }
+
+    const FunctionDef* vectorized_func = AddVectorizedFunction(
+        *map_node, input_types, output->mutable_library());
+    TF_RETURN_IF_ERROR(function_library.AddFunctionDef(*vectorized_func));
+
+    NodeDef* new_batch = graph.AddNode(
+        MakeBatchNode(batch_node, *map_node, *input_node, input_types, &graph));
+    NodeDef* new_map = graph.AddNode(MakeMapNode(
+        *map_node, batch_node, *new_batch, *vectorized_func, &graph));
+    TF_RETURN_IF_ERROR(graph.UpdateFanouts(batch_node.name(), new_map->name()));
+
+    nodes_to_delete.insert(map_node->name());
+    nodes_to_delete.insert(batch_node.name());
+    stats->num_changes++;
+  }
+
+  TF_RETURN_IF_ERROR(graph.DeleteNodes(nodes_to_delete));
+  return absl::OkStatus();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(MapVectorization, "map_vectorization");
+
+}  // namespace grappler
+}  // namespace tensorflow
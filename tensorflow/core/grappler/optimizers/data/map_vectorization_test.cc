@@ -0,0 +1,135 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_vectorization.h"
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/function_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using test::function::NDef;
+
+// Returns a range -> map -> batch pipeline whose map applies `map_function`,
+// and whose range produces elements of shape `range_shape`.
+GrapplerItem MakeMapAndBatchItem(const string& map_function,
+                                 const PartialTensorShape& range_shape) {
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("start", "Const", {}, {{"value", 0}, {"dtype", DT_INT64}}),
+       NDef("stop", "Const", {}, {{"value", 10}, {"dtype", DT_INT64}}),
+       NDef("step", "Const", {}, {{"value", 1}, {"dtype", DT_INT64}}),
+       NDef("range", "RangeDataset", {"start", "stop", "step"},
+            {{"output_shapes", gtl::ArraySlice<PartialTensorShape>{
+                                   range_shape}},
+             {"output_types", gtl::ArraySlice<DataType>{DT_INT64}}}),
+       NDef("map", "MapDataset", {"range"},
+            {{"f", FunctionDefHelper::FunctionRef(map_function,
+                                                  {{"T", DT_INT64}})},
+             {"Targuments", gtl::ArraySlice<DataType>{}},
+             {"output_shapes", gtl::ArraySlice<PartialTensorShape>{
+                                   range_shape}},
+             {"output_types", gtl::ArraySlice<DataType>{DT_INT64}},
+             {"preserve_cardinality", true}}),
+       NDef("batch_size", "Const", {}, {{"value", 4}, {"dtype", DT_INT64}}),
+       NDef("drop_remainder", "Const", {},
+            {{"value", true}, {"dtype", DT_BOOL}}),
+       NDef("batch", "BatchDatasetV2", {"map", "batch_size", "drop_remainder"},
+            {{"parallel_copy", false},
+             {"output_shapes", gtl::ArraySlice<PartialTensorShape>{
+                                   PartialTensorShape({4}).Concatenate(
+                                       range_shape)}},
+             {"output_types", gtl::ArraySlice<DataType>{DT_INT64}}}),
+       NDef("Sink", "Identity", {"batch"}, {})},
+      // FunctionLib
+      {test::function::XTimesTwo(), test::function::RandomUniform()});
+  item.fetch.push_back("Sink");
+  return item;
+}
+
+TEST(MapVectorizationTest, MovesMapAfterBatch) {
+  GrapplerItem item = MakeMapAndBatchItem("XTimesTwo", PartialTensorShape({}));
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("batch", output));
+
+  const NodeDef& batch_node = output.node(
+      graph_utils::FindGraphNodeWithOp("BatchDatasetV2", output));
+  EXPECT_EQ(batch_node.input(0), "range");
+  EXPECT_EQ(batch_node.input(1), "batch_size");
+  EXPECT_EQ(batch_node.input(2), "drop_remainder");
+  EXPECT_TRUE(
+      PartialTensorShape(batch_node.attr().at("output_shapes").list().shape(0))
+          .IsIdenticalTo(PartialTensorShape({4})));
+
+  const NodeDef& map_node =
+      output.node(graph_utils::FindGraphNodeWithOp("MapDataset", output));
+  EXPECT_EQ(map_node.input(0), batch_node.name());
+  EXPECT_TRUE(AreAttrValuesEqual(
+      map_node.attr().at("output_shapes"),
+      item.graph.node(graph_utils::FindGraphNodeWithName("batch", item.graph))
+          .attr()
+          .at("output_shapes")));
+  const NodeDef& sink =
+      output.node(graph_utils::FindGraphNodeWithName("Sink", output));
+  EXPECT_EQ(sink.input(0), map_node.name());
+
+  const FunctionDef& vectorized_func =
+      output.library().function(graph_utils::FindGraphFunctionWithName(
+          map_node.attr().at("f").func().name(), output.library()));
+  ASSERT_TRUE(
+      function_utils::ContainsFunctionNodeWithOp("MapDefun", vectorized_func));
+  const NodeDef& map_defun = vectorized_func.node_def(
+      function_utils::FindFunctionNodeWithOp("MapDefun", vectorized_func));
+  EXPECT_EQ(map_defun.attr().at("f").func().name(), "XTimesTwo");
+  EXPECT_EQ(vectorized_func.signature().input_arg_size(), 1);
+  EXPECT_EQ(vectorized_func.signature().output_arg_size(), 1);
+}
+
+TEST(MapVectorizationTest, StatefulFunction) {
+  GrapplerItem item =
+      MakeMapAndBatchItem("RandomUniformFn", PartialTensorShape({}));
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+}
+
+TEST(MapVectorizationTest, UnknownInputShape) {
+  GrapplerItem item =
+      MakeMapAndBatchItem("XTimesTwo", PartialTensorShape({-1}));
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
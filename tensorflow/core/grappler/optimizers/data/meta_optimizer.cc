@@ -39,7 +39,7 @@ using ConfigMap =
 
 // tf.data optimizations, in the order we want to perform them.
 // clang-format off
-constexpr std::array<const char*, 22> kTFDataOptimizations = {
+constexpr std::array<const char*, 24> kTFDataOptimizations = {
     "noop_elimination",
     "disable_intra_op_parallelism",
     "use_private_thread_pool",
@@ -48,6 +48,7 @@ constexpr std::array<const char*, 22> kTFDataOptimizations = {
     "map_fusion",
     "filter_fusion",
     "map_and_filter_fusion",
+    "map_vectorization",
     "map_and_batch_fusion",
     "batch_parallelization",
     "filter_parallelization",
@@ -59,6 +60,7 @@ constexpr std::array<const char*, 22> kTFDataOptimizations = {
     "inject_prefetch",
     "inject_io_prefetch_eligible",
     "inject_io_prefetch",
+    "profile_guided_pipeline",
     "disable_prefetch_legacy_autotune",
     "enable_gradient_descent",
     "make_deterministic"};
@@ -75,8 +77,10 @@ Status ToConfigMap(
   auto& options = found->list().s();
   for (const auto& option_string : options) {
     // The option string has the format
-    // <optimizer_name>:<config_key>:<config_value>
-    std::vector<string> split = absl::StrSplit(option_string, ':');
+    // <optimizer_name>:<config_key>:<config_value>, where only the value may
+    // contain colons (e.g. a file path).
+    std::vector<string> split =
+        absl::StrSplit(option_string, absl::MaxSplits(':', 2));
     if (split.size() != 3) {
       return errors::Internal(
           "Wrong format for optimizer options. Expect <optimizer name>:<config "
@@ -0,0 +1,204 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/profile_guided_pipeline.h"
+
+#include <algorithm>
+#include <array>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/strip.h"
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/protobuf.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using data::model::ModelProto;
+
+constexpr char kPrefetchDataset[] = "PrefetchDataset";
+constexpr absl::string_view kDataset = "Dataset";
+
+// Dataset ops whose last input is an int64 `num_parallel_calls`.
+constexpr std::array<const char*, 4> kLastInputParallelismOps = {
+    "ParallelMapDatasetV2",
+    "ParallelInterleaveDatasetV2",
+    "ParallelInterleaveDatasetV3",
+    "ParallelInterleaveDatasetV4",
+};
+
+// Returns the index of the input of `node` holding the value of the model
+// parameter `parameter`, or -1 if `node` has no such input.
+int TunableInputIndex(const NodeDef& node, const string& parameter) {
+  const int num_inputs = NumNonControlInputs(node);
+  if (parameter == data::model::kBufferSize) {
+    return node.op() == kPrefetchDataset ? 1 : -1;
+  }
+  if (parameter != data::model::kParallelism) return -1;
+  for (const char* op : kLastInputParallelismOps) {
+    if (node.op() == op) return num_inputs - 1;
+  }
+  if (node.op() == "ParallelBatchDataset") return 2;
+  if (node.op() == "MapAndBatchDataset" ||
+      node.op() == "ExperimentalMapAndBatchDataset") {
+    // `num_parallel_calls` is followed by `drop_remainder`.
+    return num_inputs - 2;
+  }
+  return -1;
+}
+
+// Returns the name that the autotuning model gives to the iterator of a
+// dataset op, e.g. "ParallelMapV2" for "ParallelMapDatasetV2".
+string ModelNodeName(absl::string_view op) {
+  absl::ConsumePrefix(&op, "Experimental");
+  const size_t pos = op.find(kDataset);
+  if (pos == absl::string_view::npos) return "";
+  return absl::StrCat(op.substr(0, pos), op.substr(pos + kDataset.size()));
+}
+
+// Returns the snapshot nodes from the output of `model` down its first inputs.
+std::vector<const ModelProto::Node*> ModelChain(const ModelProto& model) {
+  std::vector<const ModelProto::Node*> chain;
+  auto it = model.nodes().find(model.output());
+  while (it != model.nodes().end() &&
+         chain.size() < static_cast<size_t>(model.nodes_size())) {
+    chain.push_back(&it->second);
+    if (it->second.inputs().empty()) break;
+    it = model.nodes().find(it->second.inputs(0));
+  }
+  return chain;
+}
+
+// Returns the average size in bytes of the elements produced by `node`, or 0
+// if the snapshot did not record it.
+int64_t ElementBytes(const ModelProto::Node& node) {
+  if (node.num_elements() <= 0) return 0;
+  return node.bytes_produced() / node.num_elements();
+}
+
+// Returns whether the input `index` of `node` is the constant `AUTOTUNE`.
+bool IsAutotuneInput(const NodeDef& node, int index,
+                     const MutableGraphView& graph) {
+  if (index < 0 || index >= node.input_size()) return false;
+  const NodeDef* input = graph.GetNode(NodeName(node.input(index)));
+  if (input == nullptr || !IsConstant(*input)) return false;
+  const TensorProto& value = input->attr().at("value").tensor();
+  return value.dtype() == DT_INT64 && value.int64_val_size() == 1 &&
+         value.int64_val(0) == data::model::kAutotune;
+}
+
+}  // namespace
+
+Status ProfileGuidedPipeline::Init(
+    const tensorflow::RewriterConfig_CustomGraphOptimizer* config) {
+  if (!config) return absl::OkStatus();
+  auto it = config->parameter_map().find(kModelPath);
+  if (it == config->parameter_map().end() || it->second.s().empty()) {
+    return absl::OkStatus();
+  }
+  TF_RETURN_IF_ERROR(
+      ReadTextOrBinaryProto(Env::Default(), it->second.s(), &model_));
+  has_model_ = true;
+  return absl::OkStatus();
+}
+
+Status ProfileGuidedPipeline::OptimizeAndCollectStats(
+    Cluster* cluster, const GrapplerItem& item, GraphDef* output,
+    OptimizationStats* stats) {
+  *output = item.graph;
+  if (!has_model_) {
+    VLOG(1) << "The optimization profile_guided_pipeline is not applied "
+               "because no model snapshot was provided.";
+    return absl::OkStatus();
+  }
+  MutableGraphView graph(output);
+
+  // If the GrapplerItem is derived from a FunctionDef, we don't optimize it.
+  if (graph_utils::IsItemDerivedFromFunctionDef(item, graph)) {
+    return absl::OkStatus();
+  }
+
+  NodeDef* sink_node;
+  TF_RETURN_IF_ERROR(graph_utils::GetFetchNode(graph, item, &sink_node));
+
+  // Match the dataset ops of the main chain of the pipeline with the snapshot
+  // nodes. Ops without an iterator node in the snapshot (e.g. options) are
+  // skipped.
+  const std::vector<const ModelProto::Node*> model_chain = ModelChain(model_);
+  std::vector<std::pair<NodeDef*, const ModelProto::Node*>> matches;
+  size_t next = 0;
+  for (NodeDef* node = graph_utils::GetInputNode(*sink_node, graph);
+       node != nullptr && next < model_chain.size();
+       node = graph_utils::GetInputNode(*node, graph)) {
+    const string name = ModelNodeName(node->op());
+    if (name.empty()) continue;
+    for (size_t i = next; i < model_chain.size(); ++i) {
+      if (model_chain[i]->name() == name) {
+        matches.emplace_back(node, model_chain[i]);
+        next = i + 1;
+        break;
+      }
+    }
+  }
+
+  int num_buffers = 0;
+  for (const auto& match : matches) {
+    if (match.first->op() == kPrefetchDataset) ++num_buffers;
+  }
+  const int64_t ram_budget = model_.optimization_params().ram_budget();
+
+  for (const auto& [node, model_node] : matches) {
+    for (const auto& parameter : model_node->parameters()) {
+      const int index = TunableInputIndex(*node, parameter.name());
+      if (!IsAutotuneInput(*node, index, graph)) continue;
+
+      int64_t value = static_cast<int64_t>(parameter.state_value());
+      if (parameter.max() > 0) {
+        value = std::min(value, static_cast<int64_t>(parameter.max()));
+      }
+      const int64_t element_bytes = ElementBytes(*model_node);
+      if (parameter.name() == data::model::kBufferSize && ram_budget > 0 &&
+          element_bytes > 0) {
+        value = std::min(value, ram_budget / num_buffers / element_bytes);
+      }
+      value = std::max<int64_t>(value, 1);
+
+      VLOG(2) << "Setting " << parameter.name() << " of " << node->name()
+              << " to " << value;
+      NodeDef* value_node = graph_utils::AddScalarConstNode(value, &graph);
+      TF_RETURN_IF_ERROR(graph.UpdateRegularFaninByPort(
+          node->name(), index, {value_node->name(), 0}));
+      stats->num_changes++;
+    }
+  }
+  return absl::OkStatus();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(ProfileGuidedPipeline, "profile_guided_pipeline");
+
+}  // namespace grappler
+}  // namespace tensorflow
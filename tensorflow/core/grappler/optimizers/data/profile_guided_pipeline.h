@@ -0,0 +1,63 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_PROFILE_GUIDED_PIPELINE_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_PROFILE_GUIDED_PIPELINE_H_
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/model.pb.h"
+#include "tensorflow/core/grappler/optimizers/data/optimizer_base.h"
+
+namespace tensorflow {
+namespace grappler {
+
+constexpr char kModelPath[] = "model_path";
+
+// This optimization replaces the `AUTOTUNE` parallelism and prefetch buffer
+// sizes of an input pipeline with the values autotuning settled on in a prior
+// run, so that the pipeline starts at its tuned configuration instead of
+// rediscovering it.
+//
+// The prior run is described by a `ModelProto` snapshot, as written by
+// `model::Model::Save`, whose path is passed in the `model_path` parameter.
+// Snapshot nodes are matched with the dataset ops of the main chain of the
+// pipeline by walking both from their output. Prefetch buffers are capped so
+// that, given the element sizes measured in the snapshot, they fit in the
+// snapshot's RAM budget.
+class ProfileGuidedPipeline : public TFDataOptimizerBase {
+ public:
+  ProfileGuidedPipeline() = default;
+  ~ProfileGuidedPipeline() override = default;
+
+  string name() const override { return "profile_guided_pipeline"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Init(
+      const tensorflow::RewriterConfig_CustomGraphOptimizer* config) override;
+
+  Status OptimizeAndCollectStats(Cluster* cluster, const GrapplerItem& item,
+                                 GraphDef* output,
+                                 OptimizationStats* stats) override;
+
+ private:
+  bool has_model_ = false;
+  data::model::ModelProto model_;
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_PROFILE_GUIDED_PIPELINE_H_
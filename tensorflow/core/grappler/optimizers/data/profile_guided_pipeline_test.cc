@@ -0,0 +1,159 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/profile_guided_pipeline.h"
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/model.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// Writes a snapshot of the pipeline `range -> map -> prefetch`, as autotuning
+// would have left it, and returns its path.
+string WriteModel(const string& name) {
+  data::model::ModelProto model;
+  model.set_output(1);
+  model.mutable_optimization_params()->set_ram_budget(500);
+
+  data::model::ModelProto::Node& prefetch = (*model.mutable_nodes())[1];
+  prefetch.set_id(1);
+  prefetch.set_name("Prefetch");
+  prefetch.set_bytes_produced(1000);
+  prefetch.set_num_elements(10);
+  prefetch.add_inputs(2);
+  auto* buffer_size = prefetch.add_parameters();
+  buffer_size->set_name("buffer_size");
+  buffer_size->set_state_value(8);
+  buffer_size->set_max(100);
+
+  data::model::ModelProto::Node& map = (*model.mutable_nodes())[2];
+  map.set_id(2);
+  map.set_name("ParallelMapV2");
+  map.add_inputs(3);
+  auto* parallelism = map.add_parameters();
+  parallelism->set_name("parallelism");
+  parallelism->set_state_value(6);
+  parallelism->set_max(16);
+
+  data::model::ModelProto::Node& range = (*model.mutable_nodes())[3];
+  range.set_id(3);
+  range.set_name("Range");
+
+  const string path = io::JoinPath(testing::TmpDir(), name);
+  TF_CHECK_OK(WriteBinaryProto(Env::Default(), path, model));
+  return path;
+}
+
+// Builds `range -> map(parallelism) -> prefetch(buffer_size)`.
+void BuildPipeline(int64_t parallelism, int64_t buffer_size,
+                   GrapplerItem* item) {
+  MutableGraphView graph(&item->graph);
+  NodeDef* start_val = graph_utils::AddScalarConstNode<int64_t>(0, &graph);
+  NodeDef* stop_val = graph_utils::AddScalarConstNode<int64_t>(10, &graph);
+  NodeDef* step_val = graph_utils::AddScalarConstNode<int64_t>(1, &graph);
+  std::vector<std::pair<string, AttrValue>> empty_attrs;
+  NodeDef* range_node = graph_utils::AddNode(
+      "range", "RangeDataset",
+      {start_val->name(), stop_val->name(), step_val->name()}, empty_attrs,
+      &graph);
+
+  AttrValue attr_val;
+  SetAttrValue("value", &attr_val);
+  std::vector<std::pair<string, AttrValue>> map_attrs = {
+      {"f", attr_val},
+      {"Targuments", attr_val},
+      {"output_types", attr_val},
+      {"output_shapes", attr_val}};
+  NodeDef* parallelism_val =
+      graph_utils::AddScalarConstNode<int64_t>(parallelism, &graph);
+  NodeDef* map_node = graph_utils::AddNode(
+      "map", "ParallelMapDatasetV2",
+      {range_node->name(), parallelism_val->name()}, map_attrs, &graph);
+
+  NodeDef* buffer_size_val =
+      graph_utils::AddScalarConstNode<int64_t>(buffer_size, &graph);
+  std::vector<std::pair<string, AttrValue>> prefetch_attrs = {
+      {"output_types", attr_val}, {"output_shapes", attr_val}};
+  graph_utils::AddNode("prefetch", "PrefetchDataset",
+                       {map_node->name(), buffer_size_val->name()},
+                       prefetch_attrs, &graph);
+  graph_utils::AddNode("Sink", "Identity", {"prefetch"}, empty_attrs, &graph);
+  item->fetch.push_back("Sink");
+}
+
+Status OptimizeWithProfileGuidedPipeline(const string& model_path,
+                                         const GrapplerItem& item,
+                                         GraphDef* output) {
+  ProfileGuidedPipeline optimizer;
+  RewriterConfig_CustomGraphOptimizer config;
+  (*config.mutable_parameter_map())[kModelPath].set_s(model_path);
+  TF_RETURN_IF_ERROR(optimizer.Init(&config));
+  return optimizer.Optimize(nullptr, item, output);
+}
+
+int64_t InputValue(const GraphDef& graph, const string& node_name,
+                   int index) {
+  const NodeDef& node =
+      graph.node(graph_utils::FindGraphNodeWithName(node_name, graph));
+  const NodeDef& input =
+      graph.node(graph_utils::FindGraphNodeWithName(node.input(index), graph));
+  return input.attr().at("value").tensor().int64_val(0);
+}
+
+TEST(ProfileGuidedPipelineTest, ReplacesAutotuneWithTunedValues) {
+  GrapplerItem item;
+  BuildPipeline(/*parallelism=*/-1, /*buffer_size=*/-1, &item);
+
+  GraphDef output;
+  TF_ASSERT_OK(OptimizeWithProfileGuidedPipeline(WriteModel("tuned_model"),
+                                                 item, &output));
+  EXPECT_EQ(6, InputValue(output, "map", 1));
+  // 8 elements of 100 bytes don't fit in the 500 bytes RAM budget.
+  EXPECT_EQ(5, InputValue(output, "prefetch", 1));
+}
+
+TEST(ProfileGuidedPipelineTest, KeepsUserValues) {
+  GrapplerItem item;
+  BuildPipeline(/*parallelism=*/2, /*buffer_size=*/3, &item);
+
+  GraphDef output;
+  TF_ASSERT_OK(OptimizeWithProfileGuidedPipeline(WriteModel("user_model"),
+                                                 item, &output));
+  EXPECT_EQ(2, InputValue(output, "map", 1));
+  EXPECT_EQ(3, InputValue(output, "prefetch", 1));
+}
+
+TEST(ProfileGuidedPipelineTest, NoModel) {
+  GrapplerItem item;
+  BuildPipeline(/*parallelism=*/-1, /*buffer_size=*/-1, &item);
+
+  GraphDef output;
+  TF_ASSERT_OK(OptimizeWithProfileGuidedPipeline("", item, &output));
+  EXPECT_EQ(-1, InputValue(output, "map", 1));
+  EXPECT_EQ(-1, InputValue(output, "prefetch", 1));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -43,11 +43,14 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op_def.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/control_flow.h"
 #include "tensorflow/core/graph/graph_node_util.h"
 #include "tensorflow/core/graph/tensor_id.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/graph_view.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
@@ -153,8 +156,8 @@ bool MarkedNoSpecialize(const FunctionDef& fdef) {
   return TryGetNodeAttr(attr, kNoSpecializeAttr, &nospecialize) && nospecialize;
 }
 
-// Specialized function instantiation type parameters, body parameters, and
-// const inputs.
+// Specialized function instantiation type parameters, body parameters, const
+// inputs, and known input shapes.
 struct FunctionSpecializationSignature {
   // Currently we do not support functions with tensor lists as inputs or
   // outputs, so caller node input/output ports always match function
@@ -168,13 +171,16 @@ struct FunctionSpecializationSignature {
   absl::flat_hash_map<string, DataType> type_parameters;
   absl::flat_hash_map<string, AttrValue> body_parameters;
   absl::flat_hash_map<InputPort, string> const_inputs;
+  // Shapes of the non-const inputs with a known rank, in the aggressive mode.
+  absl::flat_hash_map<InputPort, string> input_shapes;
 
   bool operator==(const FunctionSpecializationSignature& other) const {
     bool equals = func_name == other.func_name &&
                   is_in_fetch_set == other.is_in_fetch_set &&
                   active_outputs == other.active_outputs &&
                   type_parameters == other.type_parameters &&
-                  const_inputs == other.const_inputs;
+                  const_inputs == other.const_inputs &&
+                  input_shapes == other.input_shapes;
 
     if (!equals) return false;
 
@@ -203,7 +209,8 @@ struct FunctionSpecializationSignature {
     hashes.reserve(s.active_outputs.size()         //
                    + s.type_parameters.size() * 2  //
                    + s.body_parameters.size() * 2  //
-                   + s.const_inputs.size() * 2);
+                   + s.const_inputs.size() * 2   //
+                   + s.input_shapes.size() * 2);
 
     absl::c_transform(s.active_outputs, std::back_inserter(hashes),
                       hash<OutputPort>());
@@ -228,6 +235,12 @@ struct FunctionSpecializationSignature {
       hashes.push_back(Hash64(const_input.second));
     });
 
+    using InputShape = std::pair<const InputPort, string>;
+    absl::c_for_each(s.input_shapes, [&hashes](const InputShape& input_shape) {
+      hashes.push_back(hash<InputPort>()(input_shape.first));
+      hashes.push_back(Hash64(input_shape.second));
+    });
+
     // Combine all pre-computed hashes in a deterministic order.
     absl::c_sort(hashes);
     return H::combine_contiguous(std::move(base), hashes.data(), hashes.size());
@@ -265,7 +278,11 @@ class FunctionOptimizerContext {
         opt_level_(opt_level),
         function_library_(OpRegistry::Global(), graph.library()),
         truly_const_nodes_(InferTrulyConstNodes(item, graph)),
-        graph_view_(&graph) {}
+        graph_view_(&graph) {
+    if (opt_level == RewriterConfig::AGGRESSIVE) {
+      input_shapes_ = InferFunctionInputShapes(item, graph, function_library_);
+    }
+  }
 
   const GrapplerItem& item() const { return *item_; }
 
@@ -306,6 +323,19 @@ class FunctionOptimizerContext {
     return gtl::FindWithDefault(truly_const_nodes_, name, nullptr);
   }
 
+  // Returns the shape inferred for the input `port` of the function caller
+  // node `func_node`, or nullptr if even its rank is unknown. Input shapes are
+  // only inferred in the aggressive mode.
+  const TensorShapeProto* KnownInputShape(const string& func_node,
+                                          int port) const {
+    auto it = input_shapes_.find(func_node);
+    if (it == input_shapes_.end() || port >= it->second.size()) {
+      return nullptr;
+    }
+    const TensorShapeProto& shape = it->second[port];
+    return shape.unknown_rank() ? nullptr : &shape;
+  }
+
   const FunctionSpecialization* FindFunctionSpecialization(
       const FunctionSpecializationSignature& sig) const {
     return gtl::FindOrNull(specialized_functions_, sig);
@@ -359,6 +389,47 @@ class FunctionOptimizerContext {
     return const_nodes;
   }
 
+  // Infers the shapes of the inputs of every function caller node in `graph`.
+  // Feeds are assumed to be valid, so that the input shapes of a serving
+  // signature propagate into the functions it calls.
+  static absl::flat_hash_map<string, std::vector<TensorShapeProto>>
+  InferFunctionInputShapes(const GrapplerItem& item, const GraphDef& graph,
+                           const FunctionLibraryDefinition& flib) {
+    absl::flat_hash_map<string, std::vector<TensorShapeProto>> input_shapes;
+
+    GrapplerItem shape_item = item.WithGraph(GraphDef(graph));
+    GraphProperties properties(shape_item);
+    Status status = properties.InferStatically(/*assume_valid_feeds=*/true);
+    if (!status.ok()) {
+      VLOG(2) << "Failed to infer function input shapes: " << status.message();
+      return input_shapes;
+    }
+
+    for (const NodeDef& node : graph.node()) {
+      const bool is_func_call = IsPartitionedCall(node) ||
+                                IsStatefulPartitionedCall(node) ||
+                                flib.Find(node.op()) != nullptr;
+      if (!is_func_call) continue;
+
+      std::vector<TensorShapeProto>& shapes = input_shapes[node.name()];
+      for (const auto& input : properties.GetInputProperties(node.name())) {
+        TensorShapeProto& shape = shapes.emplace_back();
+        // The shape of a resource handle is not the shape of the resource.
+        if (input.dtype() == DT_RESOURCE) {
+          shape.set_unknown_rank(true);
+          continue;
+        }
+        shape = input.shape();
+        // Symbolic dimensions are unknown outside of the shape refiner.
+        for (auto& dim : *shape.mutable_dim()) {
+          if (dim.size() < -1) dim.set_size(-1);
+        }
+      }
+    }
+
+    return input_shapes;
+  }
+
   const GrapplerItem* item_;  // must outlive this object
   RewriterConfig::Toggle opt_level_;
 
@@ -367,6 +438,8 @@ class FunctionOptimizerContext {
 
   // Nodes that are Const and not in feed.
   absl::flat_hash_map<string, const NodeDef*> truly_const_nodes_;
+  // Inferred input shapes of the function caller nodes.
+  absl::flat_hash_map<string, std::vector<TensorShapeProto>> input_shapes_;
   // Specialized functions.
   absl::flat_hash_map<FunctionSpecializationSignature,
                       const FunctionSpecialization>
@@ -436,6 +509,15 @@ bool HasTrulyConstInputs(const NodeDef& node,
   return absl::c_any_of(node.input(), is_truly_const);
 }
 
+bool HasKnownInputShapes(const NodeDef& node,
+                         const FunctionOptimizerContext& ctx) {
+  for (int i = 0; i < node.input_size(); ++i) {
+    if (IsControlInput(node.input(i))) break;
+    if (ctx.KnownInputShape(node.name(), i) != nullptr) return true;
+  }
+  return false;
+}
+
 bool HasUnusedOutputs(const NodeDef& func_node, const FunctionDef& func,
                       const FunctionOptimizerContext& ctx) {
   // Functions with tensor list outputs are not supported right now, so the
@@ -498,6 +580,47 @@ Status PushDownConstInputs(const NodeDef& func_node,
   return absl::OkStatus();
 }
 
+// Set the known shapes of the remaining inputs of the function caller node as
+// the `_output_shapes` of the corresponding function arguments, so that shape
+// inference, and the constant folding of shape computations, in the
+// specialized function body can rely on them.
+void PushDownInputShapes(const NodeDef& func_node,
+                         const FunctionOptimizerContext& ctx,
+                         const absl::flat_hash_set<string>& const_inputs,
+                         FunctionDef* specialized_func) {
+  int arg_index = 0;
+  for (int i = 0; i < func_node.input_size(); ++i) {
+    const string& input = func_node.input(i);
+    if (IsControlInput(input)) break;
+    if (const_inputs.contains(input)) continue;
+
+    const int index = arg_index++;
+    const TensorShapeProto* shape = ctx.KnownInputShape(func_node.name(), i);
+    if (shape == nullptr) continue;
+
+    // Refine the shape the argument might already be annotated with.
+    PartialTensorShape arg_shape(*shape);
+    auto* arg_attr =
+        (*specialized_func->mutable_arg_attr())[index].mutable_attr();
+    auto it = arg_attr->find("_output_shapes");
+    if (it != arg_attr->end() && it->second.list().shape_size() == 1) {
+      PartialTensorShape merged;
+      if (!PartialTensorShape(it->second.list().shape(0))
+               .MergeWith(arg_shape, &merged)
+               .ok()) {
+        continue;
+      }
+      arg_shape = merged;
+    }
+
+    VLOG(3) << "Push input shape into function body: input=" << input
+            << " shape=" << arg_shape.DebugString();
+    AttrValue output_shapes;
+    arg_shape.AsProto(output_shapes.mutable_list()->add_shape());
+    (*arg_attr)["_output_shapes"] = output_shapes;
+  }
+}
+
 // Remove inputs that were pushed into the function body, and attach their
 // control dependencies to the function caller node.
 void RemovePushedDownConstInputs(const FunctionSpecialization& specialization,
@@ -664,6 +787,9 @@ Status InitializeFunctionSpecializationSignature(
     if (IsControlInput(input)) break;
     if (ctx.IsTrulyConst(input)) {
       sig->const_inputs.emplace(i, input);
+    } else if (const TensorShapeProto* shape =
+                   ctx.KnownInputShape(func_node.name(), i)) {
+      sig->input_shapes.emplace(i, PartialTensorShape::DebugString(*shape));
     }
   }
 
@@ -746,10 +872,12 @@ Status SpecializeFunction(const NodeDef& func_node, const FunctionDef& func,
     TF_RETURN_IF_ERROR(RemoveFunctionOutputs(remove, &item, &output_mapping));
   }
 
-  // TODO(ezhulenev): Push down known input shapes.
   FunctionDef specialized_func;
   TF_RETURN_IF_ERROR(MakeFunctionDef(item, flib, &specialized_func));
 
+  // Push known input shapes into the function arguments.
+  PushDownInputShapes(func_node, *ctx, const_inputs, &specialized_func);
+
   // Find a name for specialized function.
   const string specialized_func_name =
       SpecializedFunctionName(*ctx, func, func_node);
@@ -1487,7 +1615,8 @@ Status FunctionOptimizer::RunFunctionOptimizerPass(
     // specializing.
     const bool specialization_worthy = IsParametrized(*func) ||
                                        HasTrulyConstInputs(node, ctx) ||
-                                       HasUnusedOutputs(node, *func, ctx);
+                                       HasUnusedOutputs(node, *func, ctx) ||
+                                       HasKnownInputShapes(node, ctx);
 
     // Do not specialize if function has custom gradient or marked nospecialize.
     const string grad_func = ctx.function_library().FindGradient(func_name);
@@ -1496,8 +1625,8 @@ Status FunctionOptimizer::RunFunctionOptimizerPass(
         MarkedNoSpecialize(*func) || MarkedForXlaCompilation(node);
 
     if (specialization_worthy && !no_specialize) {
-      // TODO(ezhulenev): Specialize function call if input has a known shape.
-      // Specialize function body for its instantiation attributes and inputs.
+      // Specialize function body for its instantiation attributes, inputs and
+      // known input shapes.
       Status status = SpecializeFunction(node, *func, &ctx, optimized_graph);
       if (!status.ok() && is_graph_modified()) {
         return status;
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/function_optimizer.h"
 
+#include <map>
 #include <string>
 #include <vector>
 
@@ -1687,6 +1688,62 @@ TEST_F(FunctionOptimizerTest, SpecializeIndirectFunctionPushDownConstInput) {
   test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
 }
 
+TEST_F(FunctionOptimizerTest, SpecializeFunctionForKnownInputShapes) {
+  using test::function::NDef;
+
+  FunctionOptimizer optimizer(RewriterConfig::AGGRESSIVE, true);
+
+  // Mark XTimesTwo as noinline.
+  FunctionDef x_times_two = test::function::XTimesTwo();
+  (*x_times_two.mutable_attr())["_noinline"].set_b(true);
+  std::vector<FunctionDef> function_library = {x_times_two};
+
+  // Tensorflow graph:
+  //   y1 = XTimesTwo[T=float](x1), where x1 has shape [2, 3]
+  //   y2 = XTimesTwo[T=float](x2), where x2 has shape [?, 3]
+  //   y3 = XTimesTwo[T=float](x3), where x3 has shape [2, 3]
+  GrapplerItem item;
+  item.id = "tf_graph";
+  item.graph = test::function::GDef(
+      {NDef("x1", "Placeholder", {},
+            {{"dtype", DT_FLOAT}, {"shape", PartialTensorShape({2, 3})}},
+            kDevice),
+       NDef("x2", "Placeholder", {},
+            {{"dtype", DT_FLOAT}, {"shape", PartialTensorShape({-1, 3})}},
+            kDevice),
+       NDef("x3", "Placeholder", {},
+            {{"dtype", DT_FLOAT}, {"shape", PartialTensorShape({2, 3})}},
+            kDevice),
+       NDef("y1", "XTimesTwo", {"x1"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("y2", "XTimesTwo", {"x2"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("y3", "XTimesTwo", {"x3"}, {{"T", DT_FLOAT}}, kDevice)},
+      function_library);
+
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // Calls with the same input shapes share a specialization, and every
+  // specialization has its input shape attached to the function argument.
+  ASSERT_EQ(2, output.library().function_size());
+  std::map<string, string> arg_shapes;
+  for (const FunctionDef& func : output.library().function()) {
+    const auto& arg_attr = func.arg_attr().at(0).attr();
+    ASSERT_EQ(1, arg_attr.count("_output_shapes"));
+    const AttrValue& shapes = arg_attr.at("_output_shapes");
+    ASSERT_EQ(1, shapes.list().shape_size());
+    arg_shapes[func.signature().name()] =
+        PartialTensorShape::DebugString(shapes.list().shape(0));
+  }
+  EXPECT_EQ("[2,3]", arg_shapes["XTimesTwo_specialized_for_y1_at_tf_graph"]);
+  EXPECT_EQ("[?,3]", arg_shapes["XTimesTwo_specialized_for_y2_at_tf_graph"]);
+
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "y3") {
+      EXPECT_EQ("XTimesTwo_specialized_for_y1_at_tf_graph", node.op());
+    }
+  }
+}
+
 TEST_F(FunctionOptimizerTest, SpecializeFunction_OncePerUniqueContext) {
   using test::function::NDef;
 
@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer_transposer_factory.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/tensor_float_32_utils.h"
+#include "tensorflow/core/util/util.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -456,8 +457,9 @@ Status EraseOutputShapeAttrs(TransposeContext* context) {
 
 // When there is a GPU, the computation graph is converted to NCHW format.
 // When there is only CPU, there will be no conversion by default, unless user
-// chose to convert the graph to a desired format. Currently, NCHW -> NHWC
-// format conversion is available on CPU.
+// chose to convert the graph to a desired format. NCHW -> NHWC format
+// conversion is available on CPU, and NHWC -> NCHW conversion is available for
+// the ops with oneDNN kernels when oneDNN is enabled.
 Status GenericLayoutOptimizer::Optimize(Cluster* cluster,
                                         const GrapplerItem& item,
                                         GraphDef* output) {
@@ -494,12 +496,17 @@ Status GenericLayoutOptimizer::Optimize(Cluster* cluster,
       case RewriterConfig::NCHW_TO_NHWC:
         context.AssignDeviceAndDataFormats(kCPU, kNCHW, kNHWC);
         break;
-      // TODO(intel-tf): Add functionality for NHWC_TO_NCHW layout conversion on
-      // CPU.
+      // The oneDNN kernels run on blocked layouts that derive from NCHW, so
+      // converting chains of them to NCHW leaves transposes only where the
+      // chains start and end.
       case RewriterConfig::NHWC_TO_NCHW:
-        return errors::Aborted(
-            "Conversion from NHWC to NCHW is currently not  available for "
-            "CPU.");
+        if (!IsMKLEnabled()) {
+          return errors::Aborted(
+              "Conversion from NHWC to NCHW is only available for CPU with "
+              "oneDNN enabled.");
+        }
+        context.AssignDeviceAndDataFormats(kCPU, kNHWC, kNCHW);
+        break;
       default:
         *output = item.graph;
         VLOG(2) << "No layout conversion will take place for CPU.";
@@ -31,9 +31,11 @@ limitations under the License.
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/utils/graph_view.h"
 #include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/tensor_float_32_utils.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/util.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -775,6 +777,56 @@ TEST_F(GenericLayoutOptimizerTest, OptimizeSimpleConv3DGraph_CPU) {
 #endif
 }
 
+#if !(GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
+TEST_F(GenericLayoutOptimizerTest, OneDnnChannelsFirstChainOnCPU) {
+  // Conv2D -> Relu -> MaxPool in NHWC on CPU.
+  Scope scope = Scope::NewRootScope().WithDevice("/CPU:0");
+  Tensor input_data(DT_FLOAT, TensorShape({8, 4, 4, 3}));
+  test::FillIota<float>(&input_data, 1.0f);
+  Output input = ops::Const(scope.WithOpName("Input"),
+                            Input::Initializer(input_data));
+  Tensor filter_data(DT_FLOAT, TensorShape({2, 2, 3, 2}));
+  test::FillIota<float>(&filter_data, 1.0f);
+  Output filter = ops::Const(scope.WithOpName("Filter"),
+                             Input::Initializer(filter_data));
+  Output conv = ops::Conv2D(scope.WithOpName("Conv2D"), input, filter,
+                            {1, 1, 1, 1}, "VALID");
+  Output relu = ops::Relu(scope.WithOpName("Relu"), conv);
+  Output pool = ops::MaxPool(scope.WithOpName("MaxPool"), relu, {1, 2, 2, 1},
+                             {1, 1, 1, 1}, "VALID");
+  Output fetch = ops::Identity(scope.WithOpName("Fetch"), pool);
+  GrapplerItem item;
+  TF_ASSERT_OK(scope.ToGraphDef(&item.graph));
+
+  GenericLayoutOptimizer optimizer(RewriterConfig::DEFAULT,
+                                   RewriterConfig::NHWC_TO_NCHW);
+  GraphDef output;
+  Status status = optimizer.Optimize(virtual_cluster_.get(), item, &output);
+  if (!IsMKLEnabled()) {
+    EXPECT_TRUE(errors::IsAborted(status));
+    return;
+  }
+  TF_ASSERT_OK(status);
+
+  utils::GraphView graph_view(&output, &status);
+  TF_ASSERT_OK(status);
+  auto* conv_node = graph_view.GetNode("Conv2D");
+  ASSERT_NE(conv_node, nullptr);
+  VerifyDataFormatAttributeMatch(conv_node, "NCHW");
+  auto* pool_node = graph_view.GetNode("MaxPool");
+  ASSERT_NE(pool_node, nullptr);
+  VerifyDataFormatAttributeMatch(pool_node, "NCHW");
+
+  // The chain runs in NCHW, with transposes only at its boundaries.
+  VerifyRegularFaninMatch(conv_node, 0,
+                          "Conv2D-0-TransposeNHWCToNCHW-LayoutOptimizer", 0);
+  VerifyRegularFaninMatch(graph_view.GetNode("Relu"), 0, "Conv2D", 0);
+  VerifyRegularFaninMatch(pool_node, 0, "Relu", 0);
+  VerifyRegularFaninMatch(graph_view.GetNode("Fetch"), 0,
+                          "MaxPool-0-0-TransposeNCHWToNHWC-LayoutOptimizer", 0);
+}
+#endif  // !(GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
+
 // TODO(yanzha): Add more complex Graph for test.
 
 }  // namespace grappler
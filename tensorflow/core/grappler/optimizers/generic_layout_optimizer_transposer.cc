@@ -20,6 +20,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/strings/ascii.h"
 #include "absl/strings/match.h"
 #include "absl/strings/numbers.h"
@@ -40,6 +41,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/protobuf/device_properties.pb.h"
 #include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/util.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -97,6 +99,33 @@ bool IsNonFloatingConv2D(const utils::MutableNodeView& node) {
   return false;
 }
 
+// Returns true if layout sensitive `node` can run in a channels-first data
+// format on CPU. Only the oneDNN kernels of the convolution, pooling and batch
+// normalization ops, which work on blocked layouts derived from NCHW, support
+// it for the data types they handle, in addition to the bias ops.
+bool IsChannelsFirstSupportedOnCpu(const utils::MutableNodeView& node) {
+  static const absl::flat_hash_set<string>* onednn_ops =
+      new absl::flat_hash_set<string>(
+          {"AvgPool", "AvgPoolGrad", "Conv2D", "Conv2DBackpropFilter",
+           "Conv2DBackpropInput", "Conv3D", "Conv3DBackpropFilterV2",
+           "Conv3DBackpropInputV2", "DepthwiseConv2dNative",
+           "DepthwiseConv2dNativeBackpropFilter",
+           "DepthwiseConv2dNativeBackpropInput", "FusedBatchNorm",
+           "FusedBatchNormV2", "FusedBatchNormV3", "FusedBatchNormGrad",
+           "FusedBatchNormGradV2", "FusedBatchNormGradV3", "MaxPool",
+           "MaxPool3D", "MaxPoolGrad"});
+  const NodeDef& node_def = *node.node();
+  if (IsBiasAddV2(node_def) || IsBiasAddGrad(node_def)) {
+    return true;
+  }
+  if (!IsMKLEnabled() || !onednn_ops->contains(node_def.op())) {
+    return false;
+  }
+  const auto* attr = node.GetAttr(kAttrT);
+  return attr != nullptr &&
+         (attr->type() == DT_FLOAT || attr->type() == DT_BFLOAT16);
+}
+
 bool IsNonFloatingConv3D(const utils::MutableNodeView& node) {
   if (IsConv3D(*node.node())) {
     const auto* attr = node.GetAttr(kAttrT);
@@ -293,8 +322,14 @@ bool Transposer::ShouldProcess(const TransposeContext& context,
   const bool is_integer_conv2d = IsNonFloatingConv2D(node);
   const bool is_integer_conv3d = IsNonFloatingConv3D(node);
 
+  // Channels-first layouts on CPU are limited to the ops that support them.
+  const bool is_unsupported_on_cpu =
+      IsLayoutSensitiveOp(*node_def) && context.target_device == kCPU &&
+      absl::StartsWith(context.dst_format, "NC") &&
+      !IsChannelsFirstSupportedOnCpu(node);
+
   return is_on_target_device && data_format_match && !is_integer_conv2d &&
-         !is_integer_conv3d &&
+         !is_integer_conv3d && !is_unsupported_on_cpu &&
          !context.nodes_to_preserve.contains(node_def->name()) &&
          !(node.NumRegularFanouts() == 0 && node.NumControlledFanouts() == 0);
 }
@@ -440,8 +440,125 @@ void RecomputeSubgraph(
   }
 }
 
+// Returns the subset of `candidates` to recompute so that the estimated peak
+// memory usage of every device of `cluster` fits in `budget_bytes`. The peak
+// usage and the execution time of the nodes are estimated by simulating
+// `graph`. Subgraphs are picked by decreasing number of bytes they release at
+// the peak per microsecond of recomputation, until every device fits; nothing
+// is recomputed if the graph already fits. Tensors that still don't fit are
+// left to the swapping pass. Returns all the candidates if the memory usage
+// can't be inferred.
+std::vector<RecomputedSubGraph> SelectSubgraphsWithinBudget(
+    std::vector<RecomputedSubGraph> candidates, int64_t budget_bytes,
+    Cluster* cluster, const GraphDef& graph, const GrapplerItem& item) {
+  if (candidates.empty()) {
+    return candidates;
+  }
+  GrapplerItem simulated_item = item.WithGraph(GraphDef(graph));
+  GraphMemory memory(simulated_item);
+  RunMetadata metadata;
+  Status s = memory.InferStatically(cluster->GetDevices(), &metadata);
+  if (!s.ok()) {
+    VLOG(1) << "Failed to infer memory usage, recomputing every candidate: "
+            << s.message();
+    return candidates;
+  }
+
+  // Bytes each node keeps alive at the peak of the devices over budget.
+  std::unordered_map<string, int64_t> excess_bytes;
+  std::unordered_map<string, std::unordered_map<string, int64_t>>
+      live_bytes_at_peak;
+  for (const auto& device : cluster->GetDevices()) {
+    const GraphMemory::MemoryUsage& mem_usage =
+        memory.GetPeakMemoryUsage(device.first);
+    if (mem_usage.used_memory <= budget_bytes) {
+      continue;
+    }
+    excess_bytes[device.first] = mem_usage.used_memory - budget_bytes;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      live_bytes_at_peak[live_tensor.node][device.first] +=
+          live_tensor.memory_used;
+    }
+  }
+  if (excess_bytes.empty()) {
+    VLOG(1) << "The graph fits in the memory budget, nothing to recompute";
+    return {};
+  }
+  std::unordered_map<string, int64_t> compute_micros;
+  for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
+    for (const auto& node_stats : dev_stats.node_stats()) {
+      compute_micros[node_stats.node_name()] +=
+          node_stats.op_end_rel_micros() - node_stats.op_start_rel_micros();
+    }
+  }
+
+  struct ScoredSubGraph {
+    int index;
+    std::unordered_map<string, int64_t> released_bytes;
+    double bytes_per_micro;
+  };
+  std::vector<ScoredSubGraph> scored;
+  for (int i = 0; i < candidates.size(); ++i) {
+    ScoredSubGraph subgraph{i, {}, 0.0};
+    int64_t total_released = 0;
+    int64_t cost = 0;
+    for (const NodeDef* node : candidates[i].recomputed_source_nodes) {
+      auto it = live_bytes_at_peak.find(node->name());
+      if (it != live_bytes_at_peak.end()) {
+        for (const auto& released : it->second) {
+          subgraph.released_bytes[released.first] += released.second;
+          total_released += released.second;
+        }
+      }
+      cost += compute_micros[node->name()];
+    }
+    if (total_released == 0) {
+      continue;
+    }
+    subgraph.bytes_per_micro =
+        static_cast<double>(total_released) / std::max<int64_t>(cost, 1);
+    scored.push_back(std::move(subgraph));
+  }
+  std::stable_sort(scored.begin(), scored.end(),
+                   [](const ScoredSubGraph& a, const ScoredSubGraph& b) {
+                     return a.bytes_per_micro > b.bytes_per_micro;
+                   });
+
+  std::vector<RecomputedSubGraph> selected;
+  for (const ScoredSubGraph& subgraph : scored) {
+    if (excess_bytes.empty()) {
+      break;
+    }
+    bool helps = false;
+    for (const auto& released : subgraph.released_bytes) {
+      if (excess_bytes.count(released.first) > 0) {
+        helps = true;
+        break;
+      }
+    }
+    if (!helps) {
+      continue;
+    }
+    for (const auto& released : subgraph.released_bytes) {
+      auto it = excess_bytes.find(released.first);
+      if (it == excess_bytes.end()) {
+        continue;
+      }
+      it->second -= released.second;
+      if (it->second <= 0) {
+        excess_bytes.erase(it);
+      }
+    }
+    selected.push_back(std::move(candidates[subgraph.index]));
+  }
+  VLOG(1) << "Recomputing " << selected.size() << " of " << candidates.size()
+          << " candidate subgraphs to fit in " << budget_bytes << " bytes";
+  return selected;
+}
+
 void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
                                 const string& recomputation_targets_name_scope,
+                                int64_t memory_budget_bytes, Cluster* cluster,
                                 GraphDef* graph, const GrapplerItem& item) {
   // The topological numberings and NodeMap will be stale as soon as we start
   // modifying the graph in RecomputeSubgraph. However, RecomputeSubgraph only
@@ -488,6 +605,11 @@ void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
                   node.attr().count(kRecomputeHint) > 0);
         },
         is_target);
+    if (memory_budget_bytes > 0 && cluster != nullptr) {
+      recomputed_subgraphs = SelectSubgraphsWithinBudget(
+          std::move(recomputed_subgraphs), memory_budget_bytes, cluster,
+          *graph, item);
+    }
   } else if (optimization_level == RewriterConfig::MANUAL) {
     recomputed_subgraphs = GetOpGroupsToRecompute(
         graph, node_map,
@@ -1395,9 +1517,9 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
   RelaxAssignNodes(nodes_to_relax, &optimized_item.graph);
 
   if (run_recomputation_pass) {
-    RecomputationRewritingPass(optimization_level_,
-                               recomputation_targets_name_scope_,
-                               &optimized_item.graph, item);
+    RecomputationRewritingPass(
+        optimization_level_, recomputation_targets_name_scope_,
+        memory_budget_bytes_, cluster, &optimized_item.graph, item);
   }
 
   std::unordered_set<string> skip_list;
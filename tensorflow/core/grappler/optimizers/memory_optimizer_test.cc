@@ -448,6 +448,40 @@ TEST_F(MemoryOptimizerTest, AccumulationRewrites) {
   }
 }
 
+TEST_F(MemoryOptimizerTest, RecomputationWithinBudget) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output a = ops::Variable(s.WithOpName("a").WithDevice("/gpu:0"),
+                           {128, 128}, DT_FLOAT);
+  Output b = ops::AddN(s.WithOpName("b").WithDevice("/gpu:0"), {a});
+  Output c = ops::AddN(s.WithOpName("c").WithDevice("/gpu:0"), {b});
+  Output d = ops::AddN(s.WithOpName("gradients/d").WithDevice("/gpu:0"), {c});
+  Output e =
+      ops::AddN(s.WithOpName("gradients/e").WithDevice("/gpu:0"), {d, b});
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"gradients/e"};
+  NodeMap node_map(&item.graph);
+  (*node_map.GetNode("b")->mutable_attr())["_recompute_hint"].set_i(0);
+
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+
+  // The graph already fits in a large budget, so nothing is recomputed.
+  MemoryOptimizer large_budget(RewriterConfig::RECOMPUTATION_HEURISTICS,
+                               "gradients/", /*memory_budget_bytes=*/1LL << 40);
+  GraphDef output;
+  TF_EXPECT_OK(large_budget.Optimize(cluster.get(), item, &output));
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+
+  // A small budget requires recomputing b.
+  MemoryOptimizer small_budget(RewriterConfig::RECOMPUTATION_HEURISTICS,
+                               "gradients/", /*memory_budget_bytes=*/1);
+  TF_EXPECT_OK(small_budget.Optimize(cluster.get(), item, &output));
+  NodeMap output_map(&output);
+  EXPECT_NE(nullptr, output_map.GetNode("Recomputed/b"));
+  EXPECT_EQ("Recomputed/b", output_map.GetNode("gradients/e")->input(1));
+}
+
 class RelaxAllocatorConstraintsTest : public GrapplerTest {};
 
 TEST_F(RelaxAllocatorConstraintsTest, SameDevice) {
@@ -16,11 +16,14 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/meta_optimizer.h"
 
 #include <algorithm>
+#include <deque>
 #include <functional>
+#include <memory>
 #include <string>
 #include <type_traits>
 #include <utility>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
@@ -50,10 +53,12 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/model_pruner.h"
+#include "tensorflow/core/grappler/optimizers/operator_batching.h"
 #include "tensorflow/core/grappler/optimizers/pin_to_host_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 #include "tensorflow/core/grappler/optimizers/scoped_allocator_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/shape_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/static_schedule.h"
 #include "tensorflow/core/grappler/utils/canonicalizer.h"
 #include "tensorflow/core/grappler/utils/colocation.h"
 #include "tensorflow/core/grappler/utils/functions.h"
@@ -62,7 +67,14 @@ limitations under the License.
 #include "tensorflow/core/grappler/verifiers/structure_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/public/version.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/core/util/util.h"
 #include "tensorflow/core/util/xla_config_registry.h"
@@ -186,6 +198,142 @@ Status GetGraphDevice(const GraphDef& g_def, std::set<std::string>* devices) {
   return absl::OkStatus();
 }
 
+// Process-wide cache of optimized function bodies, see
+// RewriterConfig.experimental_cache_optimized_functions.
+class OptimizedFunctionCache {
+ public:
+  static OptimizedFunctionCache* Global() {
+    static OptimizedFunctionCache* cache = new OptimizedFunctionCache();
+    return cache;
+  }
+
+  // Copies the optimized body cached under `key` to `optimized_graph`, looking
+  // in `cache_dir` if it is not cached in memory. Returns false on a miss.
+  bool Lookup(const string& key, const string& cache_dir,
+              GraphDef* optimized_graph) {
+    {
+      mutex_lock l(mu_);
+      auto it = entries_.find(key);
+      if (it != entries_.end()) {
+        *optimized_graph = *it->second;
+        return true;
+      }
+    }
+    if (cache_dir.empty()) return false;
+    const string path = io::JoinPath(cache_dir, absl::StrCat(key, ".pb"));
+    Env* env = Env::Default();
+    if (!env->FileExists(path).ok()) return false;
+    auto graph = std::make_shared<GraphDef>();
+    Status s = ReadBinaryProto(env, path, graph.get());
+    if (!s.ok()) {
+      VLOG(1) << "Failed to read cached optimized function " << path << ": "
+              << s;
+      return false;
+    }
+    *optimized_graph = *graph;
+    InsertInMemory(key, std::move(graph));
+    return true;
+  }
+
+  // Caches `optimized_graph` under `key`, and writes it to `cache_dir` if it
+  // is not empty.
+  void Insert(const string& key, const string& cache_dir,
+              const GraphDef& optimized_graph) {
+    InsertInMemory(key, std::make_shared<GraphDef>(optimized_graph));
+    if (cache_dir.empty()) return;
+    Env* env = Env::Default();
+    const string path = io::JoinPath(cache_dir, absl::StrCat(key, ".pb"));
+    // Write to a temporary file first so that a concurrent reader never sees
+    // a partially written entry.
+    const string tmp_path = absl::StrCat(path, ".", env->NowMicros(), ".tmp");
+    Status s = env->RecursivelyCreateDir(cache_dir);
+    if (s.ok()) s = WriteBinaryProto(env, tmp_path, optimized_graph);
+    if (s.ok()) s = env->RenameFile(tmp_path, path);
+    if (!s.ok()) {
+      VLOG(1) << "Failed to write cached optimized function " << path << ": "
+              << s;
+    }
+  }
+
+ private:
+  // Maximum number of optimized bodies kept in memory. The oldest entry is
+  // evicted first.
+  static constexpr int kCapacity = 1024;
+
+  void InsertInMemory(const string& key,
+                      std::shared_ptr<const GraphDef> graph) {
+    mutex_lock l(mu_);
+    if (!entries_.emplace(key, std::move(graph)).second) return;
+    insertion_order_.push_back(key);
+    if (insertion_order_.size() > kCapacity) {
+      entries_.erase(insertion_order_.front());
+      insertion_order_.pop_front();
+    }
+  }
+
+  mutex mu_;
+  absl::flat_hash_map<string, std::shared_ptr<const GraphDef>> entries_
+      TF_GUARDED_BY(mu_);
+  std::deque<string> insertion_order_ TF_GUARDED_BY(mu_);
+};
+
+// Returns the key of the optimized body of `func_item` in the
+// OptimizedFunctionCache. It covers everything the result of
+// MetaOptimizer::OptimizeGraph depends on: the function and the functions
+// reachable from it, the optimization options, the graph producer version,
+// the session config and the devices of the cluster.
+string OptimizedFunctionCacheKey(const FunctionDef& func,
+                                 const GrapplerFunctionItem& func_item,
+                                 int producer, const ConfigProto& config_proto,
+                                 bool xla_auto_clustering_on,
+                                 const Cluster* cluster) {
+  string key_material = absl::StrCat(
+      TF_VERSION_STRING, ";", tf_git_version(), ";", producer, ";",
+      func_item.optimization_options().allow_non_differentiable_rewrites, ";",
+      xla_auto_clustering_on, ";");
+  string serialized;
+  auto append = [&](const protobuf::Message& message) {
+    serialized.clear();
+    SerializeToStringDeterministic(message, &serialized);
+    absl::StrAppend(&key_material, serialized.size(), ":", serialized);
+  };
+  append(func);
+  append(config_proto);
+
+  // The library is built from a hash map, so its order is not stable.
+  const FunctionDefLibrary& library = func_item.graph.library();
+  std::vector<const FunctionDef*> functions;
+  for (const FunctionDef& f : library.function()) functions.push_back(&f);
+  std::sort(functions.begin(), functions.end(),
+            [](const FunctionDef* a, const FunctionDef* b) {
+              return a->signature().name() < b->signature().name();
+            });
+  for (const FunctionDef* f : functions) append(*f);
+  std::vector<std::pair<string, string>> gradients;
+  for (const GradientDef& g : library.gradient()) {
+    gradients.emplace_back(g.function_name(), g.gradient_func());
+  }
+  std::sort(gradients.begin(), gradients.end());
+  for (const auto& g : gradients) {
+    absl::StrAppend(&key_material, g.first, "=", g.second, ";");
+  }
+
+  if (cluster != nullptr) {
+    std::vector<std::pair<string, string>> devices;
+    for (const auto& device : cluster->GetDevices()) {
+      devices.emplace_back(device.first, device.second.type());
+    }
+    std::sort(devices.begin(), devices.end());
+    for (const auto& device : devices) {
+      absl::StrAppend(&key_material, device.first, "=", device.second, ";");
+    }
+  }
+
+  const Fprint128 fingerprint = Fingerprint128(key_material);
+  return absl::StrCat(absl::Hex(fingerprint.high64, absl::kZeroPad16),
+                      absl::Hex(fingerprint.low64, absl::kZeroPad16));
+}
+
 }  // namespace
 
 #define MK_OPT(NAME, CONFIG, VALUE)                                    \
@@ -260,6 +408,8 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
                                       cfg_.scoped_allocator_opts()));
   MK_OPT("pin_to_host", "pin_to_host_optimization",
          new PinToHostOptimizer(cfg_.pin_to_host_optimization()));
+  MK_OPT("operator_batching", "experimental_operator_batching",
+         new OperatorBatching());
 
   return std::unique_ptr<GraphOptimizer>();
 }
@@ -421,6 +571,10 @@ Status MetaOptimizer::InitializeOptimizers(
           cfg_.arithmetic_optimization()));
     }
   }
+  if (USER_IS_ON(experimental_operator_batching) &&
+      PLUGIN_NOT_OFF(experimental_operator_batching)) {
+    optimizers->push_back(std::make_unique<OperatorBatching>());
+  }
   if (BOTH_NOT_OFF(layout_optimizer)) {
     if (USER_IS_EXPERIMENTAL_MLIR(layout_optimizer) ||
         USER_IS_EXPERIMENTAL_BOTH(layout_optimizer)) {
@@ -472,15 +626,14 @@ Status MetaOptimizer::InitializeOptimizers(
   if (MemoryOptimizerEnabled(cfg_.memory_optimization(),
                              xla_auto_clustering_on_) &&
       PLUGIN_NOT_OFF(memory_optimization)) {
-    if (cfg_.memory_optimizer_target_node_name_scope().empty()) {
-      optimizers->push_back(
-          // Use the default target node name prefix "gradients/"
-          std::make_unique<MemoryOptimizer>(cfg_.memory_optimization()));
-    } else {
-      optimizers->push_back(std::make_unique<MemoryOptimizer>(
-          cfg_.memory_optimization(),
-          cfg_.memory_optimizer_target_node_name_scope()));
-    }
+    // Use the default target node name prefix "gradients/" if none is set.
+    const string& target_node_name_scope =
+        cfg_.memory_optimizer_target_node_name_scope().empty()
+            ? "gradients/"
+            : cfg_.memory_optimizer_target_node_name_scope();
+    optimizers->push_back(std::make_unique<MemoryOptimizer>(
+        cfg_.memory_optimization(), target_node_name_scope,
+        cfg_.experimental_memory_optimizer_budget_bytes()));
   }
   if (cfg_.auto_parallel().enable() && PLUGIN_IS_ON(auto_parallel)) {
     optimizers->push_back(
@@ -641,6 +794,7 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
     PRINT_CFG(loop_optimization)
     PRINT_CFG(dependency_optimization)
     PRINT_CFG(scoped_allocator_optimization)
+    PRINT_CFG(experimental_operator_batching)
 #undef PRINT_CFG
     user_cfg.toggle_config["auto_mixed_precision"] =
         AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision())
@@ -696,6 +850,7 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
       PRINT_CFG("memory", "memory_optimization")
       PRINT_CFG("autoparallel", "auto_parallel")
       PRINT_CFG("scoped_allocator", "scoped_allocator_optimization")
+      PRINT_CFG("operator_batching", "experimental_operator_batching")
 #undef PRINT_CFG
     }
   }
@@ -888,7 +1043,10 @@ Status MetaOptimizer::OptimizeGraph(
                                    }) != optimization_result.results.end();
 
   // Record graph optimization result.
-  optimization_results_.push_back(optimization_result);
+  {
+    mutex_lock l(optimization_results_mu_);
+    optimization_results_.push_back(optimization_result);
+  }
 
   if (is_optimized) {
     TF_RETURN_IF_ERROR(TopologicalSort(optimized_graph));
@@ -897,6 +1055,19 @@ Status MetaOptimizer::OptimizeGraph(
     DCHECK_EQ(optimized_graph->versions().producer(), original_producer);
   }
 
+  // The schedule is only meaningful for the final graph, so it is computed
+  // after all the optimizers ran.
+  if (cfg_.experimental_static_scheduling() == RewriterConfig::ON &&
+      cluster != nullptr) {
+    GrapplerItem scheduled_item = item.WithGraph(std::move(*optimized_graph));
+    const Status status =
+        AnnotateSchedulingPriorities(cluster, &scheduled_item);
+    if (!status.ok()) {
+      VLOG(1) << "Failed to compute a static schedule: " << status;
+    }
+    *optimized_graph = std::move(scheduled_item.graph);
+  }
+
   return absl::OkStatus();
 }
 
@@ -1055,7 +1226,10 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       {kGrapplerCategory, "*"});
 
   VLOG(1) << "Starting optimization for grappler item: " << item.id;
-  optimization_results_.clear();
+  {
+    mutex_lock l(optimization_results_mu_);
+    optimization_results_.clear();
+  }
 
   // Constructs a FunctionLibraryDefinition with functions that are reachable
   // from the nodes of the graph.
@@ -1164,15 +1338,77 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
   // True if this is a TPU graph using the old bridge.
   bool is_tpu_graph = IsLegacyTPUBridgeGraphDef(*optimized_graph);
 
+  // Optimizes the body of `func` from `func_item` into `optimized_func_graph`.
+  // Must be thread safe, because with
+  // experimental_function_optimization_threads > 1 it runs concurrently for
+  // different functions.
+  const auto optimize_function_body =
+      [&](const FunctionDef& func, GrapplerFunctionItem& func_item,
+          GraphDef* optimized_func_graph) -> Status {
+    if (is_tpu_graph) {
+      // Skip optimizing functions if this is a TPU graph. Currently, Grappler
+      // passes do not handle TPU functions correctly in a variety of ways
+      // (Note that due to the pre-placement TPU graph rewriting passes, the
+      // TPU-related ops are encapsulated away into functions). For example,
+      // TPU graphs contain TPUReplicateMetadata node that carries relevant
+      // TPU metadata and Grappler passes could prune that away. Grappler
+      // passes could also cause issues around shape inference. Since the
+      // desired and existing behavior is to not optimize TPU functions with
+      // Grappler, this check preserves that. The only exception is
+      // implementation selector what is required to swap in some TPU specific
+      // lowering code and is verified the work correctly on TPUs.
+      ImplementationSelector implementation_selector;
+
+      // Implementation selector needs to have access to valid function
+      // signature and attributes, and it doesn't need actual function body.
+      std::unique_ptr<FunctionDefLibrary> func_item_function_library(
+          func_item.graph.release_library());
+      *func_item.graph.mutable_library() =
+          GetFunctionDefLibraryStub(*func_item_function_library);
+
+      return implementation_selector.Optimize(cluster, func_item,
+                                              optimized_func_graph);
+    }
+
+    // Reuse the optimized body of a function that did not change since it
+    // was last optimized with the same configuration.
+    const bool use_cache = cfg_.experimental_cache_optimized_functions();
+    const string& cache_dir = cfg_.experimental_optimized_functions_cache_dir();
+    string cache_key;
+    if (use_cache) {
+      cache_key = OptimizedFunctionCacheKey(func, func_item, producer,
+                                            config_proto_,
+                                            xla_auto_clustering_on_, cluster);
+      if (OptimizedFunctionCache::Global()->Lookup(cache_key, cache_dir,
+                                                   optimized_func_graph)) {
+        VLOG(3) << "Reuse cached optimized function: function="
+                << func.signature().name();
+        return absl::OkStatus();
+      }
+    }
+    GrapplerFunctionItem func_item_copy = func_item;
+    TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(func_item_copy),
+                                     optimized_func_graph));
+    if (use_cache) {
+      OptimizedFunctionCache::Global()->Insert(cache_key, cache_dir,
+                                               *optimized_func_graph);
+    }
+    return absl::OkStatus();
+  };
+
+  // With more than one thread, all the functions of a pass over the library
+  // are optimized concurrently, each against the library as it was at the
+  // start of the pass. Otherwise they are optimized one at a time, each
+  // against the library updated with the functions optimized before it.
+  const int num_threads = cfg_.experimental_function_optimization_threads();
+
   // Optimize each function only once.
   absl::flat_hash_set<string> optimized_funcs;
   while (optimize_function_library) {
     optimize_function_library = false;
 
-    int function_idx = 0;
+    std::vector<const FunctionDef*> funcs;
     for (const FunctionDef& func : optimized_graph->library().function()) {
-      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
-
       const string& func_name = func.signature().name();
 
       // Skip functions that are not reachable from the optimized graph.
@@ -1192,87 +1428,97 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       // and in function instantiation.
       if (data::IsTFDataFunction(func)) continue;
 
-      VLOG(3) << "Optimize function: function=" << func_name << " ["
-              << function_idx++ << " of "
-              << optimized_graph->library().function_size() << "]";
-
       // Function optimization might specialize nested function calls, so we
       // have to reset the flag and do at least one more pass over the library.
       optimize_function_library = true;
       optimized_funcs.insert(func_name);
+      funcs.push_back(&func);
+    }
 
-      // Make a GrapplerItem from a FunctionDef.
-      GrapplerFunctionItem func_item;
-      TF_RETURN_IF_ERROR(
-          MakeGrapplerFunctionItem(func, flib, producer, &func_item));
-
-      // If we need to compute the gradient of optimized function at runtime, we
-      // can't perform non-differentiable rewrites.
-      func_item.optimization_options().allow_non_differentiable_rewrites =
-          !differentiable_functions.contains(func_name);
-
-      // Device set available to the function is defined only by the runtime,
-      // when we instantiate and execute the function. We can't use all devices
-      // available to the main graph, because after partitioning the function
-      // call node might execute on a remote worker.
-      if (!func_item.devices().empty()) {
-        return errors::Internal("GrapplerFunctionItem devices must be empty.");
+    const int num_funcs = funcs.size();
+    const int batch_size = num_threads > 1 ? std::max(num_funcs, 1) : 1;
+    for (int begin = 0; begin < num_funcs; begin += batch_size) {
+      const int end = std::min(begin + batch_size, num_funcs);
+      std::vector<GrapplerFunctionItem> func_items(end - begin);
+      for (int i = begin; i < end; ++i) {
+        GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+
+        const FunctionDef& func = *funcs[i];
+        const string& func_name = func.signature().name();
+        VLOG(3) << "Optimize function: function=" << func_name << " [" << i
+                << " of " << optimized_graph->library().function_size()
+                << "]";
+
+        // Make a GrapplerItem from a FunctionDef.
+        GrapplerFunctionItem& func_item = func_items[i - begin];
+        TF_RETURN_IF_ERROR(
+            MakeGrapplerFunctionItem(func, flib, producer, &func_item));
+
+        // If we need to compute the gradient of optimized function at
+        // runtime, we can't perform non-differentiable rewrites.
+        func_item.optimization_options().allow_non_differentiable_rewrites =
+            !differentiable_functions.contains(func_name);
+
+        // Device set available to the function is defined only by the
+        // runtime, when we instantiate and execute the function. We can't use
+        // all devices available to the main graph, because after partitioning
+        // the function call node might execute on a remote worker.
+        if (!func_item.devices().empty()) {
+          return errors::Internal(
+              "GrapplerFunctionItem devices must be empty.");
+        }
+
+        // We are not allowed to prune certain types of ops from the graph
+        // instantiated by the function definition, because we must guarantee
+        // function execution semantics wrt side effects (see
+        // function_optimizer.cc).
+        func_item.optimization_options()
+            .allow_pruning_stateful_and_dataset_ops = false;
       }
 
-      // We are not allowed to prune certain types of ops from the graph
-      // instantiated by the function definition, because we must guarantee
-      // function execution semantics wrt side effects (see
-      // function_optimizer.cc).
-      func_item.optimization_options().allow_pruning_stateful_and_dataset_ops =
-          false;
-
-      // Optimize function body graph.
-      GraphDef optimized_func_graph;
-      if (is_tpu_graph) {
-        // Skip optimizing functions if this is a TPU graph. Currently, Grappler
-        // passes do not handle TPU functions correctly in a variety of ways
-        // (Note that due to the pre-placement TPU graph rewriting passes, the
-        // TPU-related ops are encapsulated away into functions). For example,
-        // TPU graphs contain TPUReplicateMetadata node that carries relevant
-        // TPU metadata and Grappler passes could prune that away. Grappler
-        // passes could also cause issues around shape inference. Since the
-        // desired and existing behavior is to not optimize TPU functions with
-        // Grappler, this check preserves that. The only exception is
-        // implementation selector what is required to swap in some TPU specific
-        // lowering code and is verified the work correctly on TPUs.
-        ImplementationSelector implementation_selector;
-
-        // Implementation selector needs to have access to valid function
-        // signature and attributes, and it doesn't need actual function body.
-        std::unique_ptr<FunctionDefLibrary> func_item_function_library(
-            func_item.graph.release_library());
-        *func_item.graph.mutable_library() =
-            GetFunctionDefLibraryStub(*func_item_function_library);
-
-        TF_RETURN_IF_ERROR(implementation_selector.Optimize(
-            cluster, func_item, &optimized_func_graph));
+      // Optimize function body graphs.
+      std::vector<GraphDef> optimized_func_graphs(end - begin);
+      std::vector<Status> statuses(end - begin);
+      if (end - begin == 1) {
+        statuses[0] = optimize_function_body(*funcs[begin], func_items[0],
+                                             &optimized_func_graphs[0]);
       } else {
-        GrapplerFunctionItem func_item_copy = func_item;
-        TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(func_item_copy),
-                                         &optimized_func_graph));
+        // The pool waits for the scheduled closures when it is destroyed.
+        thread::ThreadPool pool(Env::Default(), "optimize_functions",
+                                std::min(num_threads, end - begin));
+        for (int i = 0; i < end - begin; ++i) {
+          pool.Schedule([&, i]() {
+            statuses[i] = optimize_function_body(
+                *funcs[begin + i], func_items[i], &optimized_func_graphs[i]);
+          });
+        }
       }
 
-      // Function body optimization might have created new specialized
-      // functions for each instantiation context. Add them to the library.
-      for (const FunctionDef& func_def :
-           optimized_func_graph.library().function()) {
-        if (flib.Find(func_def.signature().name()) == nullptr) {
-          TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
+      // Merge the results in library order, so that the output does not
+      // depend on the order in which the functions finished.
+      for (int i = 0; i < end - begin; ++i) {
+        TF_RETURN_IF_ERROR(statuses[i]);
+        const string& func_name = funcs[begin + i]->signature().name();
+        GrapplerFunctionItem& func_item = func_items[i];
+        GraphDef& optimized_func_graph = optimized_func_graphs[i];
+
+        // Function body optimization might have created new specialized
+        // functions for each instantiation context. Add them to the library.
+        for (const FunctionDef& func_def :
+             optimized_func_graph.library().function()) {
+          if (flib.Find(func_def.signature().name()) == nullptr) {
+            TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
+          }
         }
-      }
 
-      // Convert optimized graph back to FunctionDef.
-      FunctionDef optimized_func;
-      func_item.SwapFunctionBody(std::move(optimized_func_graph));
-      TF_RETURN_IF_ERROR(MakeFunctionDef(func_item, flib, &optimized_func));
+        // Convert optimized graph back to FunctionDef.
+        FunctionDef optimized_func;
+        func_item.SwapFunctionBody(std::move(optimized_func_graph));
+        TF_RETURN_IF_ERROR(MakeFunctionDef(func_item, flib, &optimized_func));
 
-      // Replace optimized function with a new FunctionDef.
-      TF_RETURN_IF_ERROR(flib.ReplaceFunction(func_name, optimized_func));
+        // Replace optimized function with a new FunctionDef.
+        TF_RETURN_IF_ERROR(flib.ReplaceFunction(func_name, optimized_func));
+      }
     }
 
     // If optimized at least one function, update the graph library.
@@ -1321,6 +1567,7 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
 
 string MetaOptimizer::GetResultString() const {
   std::string result_string;
+  mutex_lock l(optimization_results_mu_);
   for (const GraphOptimizationResult& graph_result : optimization_results_) {
     absl::StrAppend(&result_string,
                     "Optimization results for grappler item: ", graph_result.id,
@@ -1357,6 +1604,7 @@ bool MetaOptimizerEnabled(const ConfigProto& cfg) {
          rewrite_cfg.scoped_allocator_optimization() == RewriterConfig::ON ||
 #endif
          rewrite_cfg.pin_to_host_optimization() == RewriterConfig::ON ||
+         rewrite_cfg.experimental_operator_batching() == RewriterConfig::ON ||
          AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision()) ||
          AutoMixedPrecisionEnabled(
              rewrite_cfg.auto_mixed_precision_onednn_bfloat16()) ||
@@ -18,6 +18,7 @@ limitations under the License.
 #include <atomic>
 
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/substitute.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -1412,6 +1413,104 @@ INSTANTIATE_TEST_SUITE_P(
       return test_name;
     });
 
+TEST_F(MetaOptimizerTest, CachesOptimizedFunctions) {
+  using test::function::NDef;
+
+  // Use only custom optimizer which counts its calls.
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("TfDataTestOptimizer");
+  rewriter_config.set_min_graph_nodes(-1);
+  rewriter_config.set_meta_optimizer_iterations(RewriterConfig::ONE);
+  rewriter_config.set_experimental_cache_optimized_functions(true);
+
+  auto make_item = [](const string& op) {
+    FunctionDef func = FunctionDefHelper::Create(
+        "CachedFunc", {"x:float", "y:float"}, {"z:float"}, {},
+        {{{"op"}, op, {"x", "y"}, {{"T", DT_FLOAT}}}},
+        /*ret_def=*/
+        {{"z", "op:z:0"}});
+    GrapplerItem item;
+    item.id = "main";
+    item.graph = test::function::GDef(
+        {NDef("x", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice),
+         NDef("y", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice),
+         NDef("call", "CachedFunc", {"x", "y"}, {}, kDevice)},
+        /*funcs=*/
+        {func});
+    item.fetch = {"call"};
+    return item;
+  };
+
+  // Optimizes the main graph, and the function unless it is cached.
+  auto num_optimized = [&](const GrapplerItem& item) {
+    TfDataTestOptimizer::InitCount();
+    MetaOptimizer optimizer(nullptr, config_proto);
+    GraphDef output;
+    TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+    return TfDataTestOptimizer::GetCount();
+  };
+
+  EXPECT_EQ(num_optimized(make_item("Mul")), 2);
+  EXPECT_EQ(num_optimized(make_item("Mul")), 1);
+  // A changed function body is optimized again.
+  EXPECT_EQ(num_optimized(make_item("Add")), 2);
+  EXPECT_EQ(num_optimized(make_item("Add")), 1);
+}
+
+TEST_F(MetaOptimizerTest, OptimizesFunctionsInParallel) {
+  using test::function::NDef;
+
+  // Tensorflow graph:
+  //
+  //   x = tf.Placeholder(tf.float);
+  //   call_i = Func_i(x, x) for i in [0, 8)
+  std::vector<FunctionDef> funcs;
+  std::vector<NodeDef> nodes = {
+      NDef("x", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice)};
+  GrapplerItem item;
+  item.id = "main";
+  for (int i = 0; i < 8; ++i) {
+    const string name = absl::StrCat("Func", i);
+    funcs.push_back(FunctionDefHelper::Create(
+        name, {"x:float", "y:float"}, {"z:float"}, {},
+        {{{"mul"}, "Mul", {"x", "y"}, {{"T", DT_FLOAT}}},
+         {{"neg"}, "Neg", {"mul:z:0"}, {{"T", DT_FLOAT}}},
+         {{"neg_neg"}, "Neg", {"neg:y:0"}, {{"T", DT_FLOAT}}}},
+        /*ret_def=*/
+        {{"z", "neg_neg:y:0"}}));
+    const string call = absl::StrCat("call_", i);
+    nodes.push_back(NDef(call, name, {"x", "x"}, {}, kDevice));
+    item.fetch.push_back(call);
+  }
+  item.graph = test::function::GDef(nodes, funcs);
+
+  auto optimize = [&](int num_threads) {
+    ConfigProto config_proto;
+    auto& rewriter_config =
+        *config_proto.mutable_graph_options()->mutable_rewrite_options();
+    rewriter_config.set_min_graph_nodes(-1);
+    rewriter_config.set_experimental_function_optimization_threads(
+        num_threads);
+    MetaOptimizer optimizer(nullptr, config_proto);
+    GraphDef output;
+    TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+    return output;
+  };
+
+  const GraphDef sequential = optimize(/*num_threads=*/0);
+  const GraphDef parallel = optimize(/*num_threads=*/4);
+  ASSERT_EQ(parallel.library().function_size(),
+            sequential.library().function_size());
+  FunctionLibraryDefinition flib(OpRegistry::Global(), sequential.library());
+  for (const FunctionDef& func : parallel.library().function()) {
+    const FunctionDef* expected = flib.Find(func.signature().name());
+    ASSERT_NE(expected, nullptr);
+    EXPECT_TRUE(FunctionDefsEqual(func, *expected));
+  }
+}
+
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
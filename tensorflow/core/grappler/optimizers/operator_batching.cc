@@ -0,0 +1,213 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/operator_batching.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/frame.h"
+#include "tensorflow/core/grappler/utils/topological_sort.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kOptimizedPrefix[] = "OperatorBatching";
+
+// Minimum number of ops worth batching together.
+constexpr int kMinBatchSize = 2;
+
+// MatMuls computing more multiply-adds than this are not batched: they already
+// keep a device busy, and packing their inputs adds a copy of each of them.
+constexpr int64_t kMaxMultiplyAdds = 1 << 20;
+
+// Returns the key shared by the MatMuls that can be batched with `node`, or an
+// empty string if `node` can't be batched. MatMuls in while loops are left
+// alone, since batching them could merge ops from different frames.
+string BatchingKey(const NodeDef& node, const GraphProperties& properties,
+                   const FrameView& frames,
+                   const absl::flat_hash_set<string>& feed_nodes) {
+  if (node.op() != "MatMul" || feed_nodes.contains(node.name()) ||
+      frames.IsInFrame(node)) {
+    return "";
+  }
+  for (const string& input : node.input()) {
+    if (IsControlInput(input)) return "";
+  }
+
+  const auto& inputs = properties.GetInputProperties(node.name());
+  if (inputs.size() != 2) return "";
+  const PartialTensorShape a_shape(inputs[0].shape());
+  const PartialTensorShape b_shape(inputs[1].shape());
+  if (!a_shape.IsFullyDefined() || !b_shape.IsFullyDefined() ||
+      a_shape.dims() != 2 || b_shape.dims() != 2) {
+    return "";
+  }
+
+  const AttrSlice attrs(node);
+  const AttrValue* type = attrs.Find("T");
+  if (type == nullptr) return "";
+  const AttrValue* transpose_a_attr = attrs.Find("transpose_a");
+  const AttrValue* transpose_b_attr = attrs.Find("transpose_b");
+  const bool transpose_a = transpose_a_attr != nullptr && transpose_a_attr->b();
+  const bool transpose_b = transpose_b_attr != nullptr && transpose_b_attr->b();
+
+  const int64_t n = b_shape.dim_size(transpose_b ? 0 : 1);
+  if (a_shape.num_elements() * n > kMaxMultiplyAdds) return "";
+
+  return absl::StrCat(node.device(), ";", DataTypeString(type->type()), ";",
+                      transpose_a, ";", transpose_b, ";", a_shape.DebugString(),
+                      ";", b_shape.DebugString());
+}
+
+// Rewrites the MatMuls of `group` into a single BatchMatMulV2.
+void BatchMatMuls(const std::vector<NodeDef*>& group, GraphDef* graph) {
+  const NodeDef& first = *group.front();
+  const string prefix = AddPrefixToNodeName(first.name(), kOptimizedPrefix);
+  const AttrSlice attrs(first);
+  const AttrValue* transpose_a = attrs.Find("transpose_a");
+  const AttrValue* transpose_b = attrs.Find("transpose_b");
+
+  AttrValue num;
+  num.set_i(group.size());
+  AttrValue axis;
+  axis.set_i(0);
+
+  NodeDef* pack_a = graph->add_node();
+  pack_a->set_name(absl::StrCat(prefix, "/PackA"));
+  NodeDef* pack_b = graph->add_node();
+  pack_b->set_name(absl::StrCat(prefix, "/PackB"));
+  for (NodeDef* pack : {pack_a, pack_b}) {
+    pack->set_op("Pack");
+    pack->set_device(first.device());
+    (*pack->mutable_attr())["T"] = first.attr().at("T");
+    (*pack->mutable_attr())["N"] = num;
+    (*pack->mutable_attr())["axis"] = axis;
+  }
+  for (const NodeDef* matmul : group) {
+    pack_a->add_input(matmul->input(0));
+    pack_b->add_input(matmul->input(1));
+  }
+
+  NodeDef* batch_matmul = graph->add_node();
+  batch_matmul->set_name(absl::StrCat(prefix, "/BatchMatMul"));
+  batch_matmul->set_op("BatchMatMulV2");
+  batch_matmul->set_device(first.device());
+  batch_matmul->add_input(pack_a->name());
+  batch_matmul->add_input(pack_b->name());
+  (*batch_matmul->mutable_attr())["T"] = first.attr().at("T");
+  (*batch_matmul->mutable_attr())["adj_x"].set_b(transpose_a != nullptr &&
+                                                 transpose_a->b());
+  (*batch_matmul->mutable_attr())["adj_y"].set_b(transpose_b != nullptr &&
+                                                 transpose_b->b());
+
+  NodeDef* unpack = graph->add_node();
+  unpack->set_name(absl::StrCat(prefix, "/Unpack"));
+  unpack->set_op("Unpack");
+  unpack->set_device(first.device());
+  unpack->add_input(batch_matmul->name());
+  (*unpack->mutable_attr())["T"] = first.attr().at("T");
+  (*unpack->mutable_attr())["num"] = num;
+  (*unpack->mutable_attr())["axis"] = axis;
+
+  for (int i = 0, end = group.size(); i < end; ++i) {
+    NodeDef* matmul = group[i];
+    AttrValue type = matmul->attr().at("T");
+    matmul->set_op("Identity");
+    matmul->clear_input();
+    matmul->add_input(absl::StrCat(unpack->name(), ":", i));
+    matmul->clear_attr();
+    (*matmul->mutable_attr())["T"] = type;
+  }
+}
+
+}  // namespace
+
+Status OperatorBatching::Optimize(Cluster* /*cluster*/,
+                                  const GrapplerItem& item,
+                                  GraphDef* optimized_graph) {
+  int num_matmuls = 0;
+  for (const NodeDef& node : item.graph.node()) {
+    if (node.op() == "MatMul") ++num_matmuls;
+  }
+  if (num_matmuls < kMinBatchSize) {
+    return errors::Aborted("Nothing to do.");
+  }
+
+  GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(properties.InferStatically(/*assume_valid_feeds=*/false));
+
+  absl::flat_hash_set<string> feed_nodes;
+  for (const auto& feed : item.feed) {
+    feed_nodes.insert(NodeName(feed.first));
+  }
+
+  *optimized_graph = item.graph;
+  TF_RETURN_IF_ERROR(TopologicalSort(optimized_graph));
+  FrameView frames;
+  TF_RETURN_IF_ERROR(frames.InferFromGraph(*optimized_graph));
+
+  // The level of a node is the largest number of batchable MatMuls on a path
+  // from a source to it, itself included. A MatMul that depends on another
+  // one has a higher level, so MatMuls that share a level are independent.
+  absl::flat_hash_map<string, int> levels;
+  std::map<std::pair<string, int>, std::vector<NodeDef*>> groups;
+  for (NodeDef& node : *optimized_graph->mutable_node()) {
+    int level = 0;
+    for (const string& input : node.input()) {
+      auto it = levels.find(NodeName(input));
+      if (it != levels.end()) level = std::max(level, it->second);
+    }
+    const string key = BatchingKey(node, properties, frames, feed_nodes);
+    if (!key.empty()) {
+      ++level;
+      groups[{key, level}].push_back(&node);
+    }
+    levels[node.name()] = level;
+  }
+
+  int num_batched = 0;
+  for (const auto& group : groups) {
+    if (group.second.size() < kMinBatchSize) continue;
+    VLOG(2) << "Batching " << group.second.size()
+            << " MatMuls: " << group.first.first;
+    num_batched += group.second.size();
+    BatchMatMuls(group.second, optimized_graph);
+  }
+  if (num_batched == 0) {
+    return errors::Aborted("Nothing to do.");
+  }
+
+  VLOG(1) << "Batched " << num_batched << " MatMuls";
+  return TopologicalSort(optimized_graph);
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,54 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_OPERATOR_BATCHING_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_OPERATOR_BATCHING_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Batches structurally identical, independent ops into a single batched op.
+//
+// Models with many parallel towers (e.g. recommendation models) run hundreds
+// of small MatMuls that neither depend on each other nor differ in shape. Each
+// group of such MatMuls placed on the same device is rewritten into:
+//
+//   Pack(a_0, ..., a_n-1) ---+
+//                            +--> BatchMatMulV2 --> Unpack
+//   Pack(b_0, ..., b_n-1) ---+
+//
+// and every original MatMul is replaced by an Identity of its output of the
+// Unpack, so that its name and its consumers are preserved. Only MatMuls with
+// fully defined input shapes of a bounded size are batched, since packing the
+// inputs of large MatMuls costs more than it saves in kernel launches.
+class OperatorBatching : public GraphOptimizer {
+ public:
+  OperatorBatching() = default;
+  ~OperatorBatching() override = default;
+
+  string name() const override { return "operator_batching"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_OPERATOR_BATCHING_H_
@@ -0,0 +1,110 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/operator_batching.h"
+
+#include <vector>
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class OperatorBatchingTest : public GrapplerTest {};
+
+TEST_F(OperatorBatchingTest, BatchesIndependentMatMuls) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  std::vector<Output> towers;
+  for (int i = 0; i < 3; ++i) {
+    Output a = ops::Const(s.WithOpName(strings::StrCat("a", i)),
+                          GenerateRandomTensor<DT_FLOAT>({2, 3}));
+    Output b = ops::Const(s.WithOpName(strings::StrCat("b", i)),
+                          GenerateRandomTensor<DT_FLOAT>({3, 4}));
+    towers.push_back(
+        ops::MatMul(s.WithOpName(strings::StrCat("matmul", i)), a, b));
+  }
+  // Depends on matmul0, so it can't be batched with it.
+  Output c = ops::Const(s.WithOpName("c"),
+                        GenerateRandomTensor<DT_FLOAT>({3, 4}));
+  Output dependent = ops::MatMul(s.WithOpName("dependent"), c, towers[0],
+                                 ops::MatMul::TransposeB(true));
+  // Different shapes, so it can't be batched with the towers either.
+  Output d = ops::Const(s.WithOpName("d"),
+                        GenerateRandomTensor<DT_FLOAT>({2, 5}));
+  Output other = ops::MatMul(s.WithOpName("other"), towers[1], d,
+                             ops::MatMul::TransposeA(true));
+
+  GrapplerItem item;
+  item.fetch = {"matmul0", "matmul1", "matmul2", "dependent", "other"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  OperatorBatching optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  NodeMap node_map(&output);
+  for (int i = 0; i < 3; ++i) {
+    const NodeDef* tower = node_map.GetNode(strings::StrCat("matmul", i));
+    ASSERT_NE(tower, nullptr);
+    EXPECT_EQ("Identity", tower->op());
+    ASSERT_EQ(1, tower->input_size());
+    EXPECT_EQ(strings::StrCat("OperatorBatching/matmul0/Unpack:", i),
+              tower->input(0));
+  }
+  const NodeDef* batch_matmul =
+      node_map.GetNode("OperatorBatching/matmul0/BatchMatMul");
+  ASSERT_NE(batch_matmul, nullptr);
+  EXPECT_EQ("BatchMatMulV2", batch_matmul->op());
+  EXPECT_EQ("MatMul", node_map.GetNode("dependent")->op());
+  EXPECT_EQ("MatMul", node_map.GetNode("other")->op());
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(tensors_expected.size(), tensors.size());
+  for (int i = 0; i < tensors.size(); ++i) {
+    test::ExpectTensorNear<float>(tensors_expected[i], tensors[i], 1e-5);
+  }
+}
+
+TEST_F(OperatorBatchingTest, NothingToBatch) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output a = ops::Const(s.WithOpName("a"),
+                        GenerateRandomTensor<DT_FLOAT>({2, 3}));
+  Output b = ops::Const(s.WithOpName("b"),
+                        GenerateRandomTensor<DT_FLOAT>({3, 2}));
+  Output first = ops::MatMul(s.WithOpName("first"), a, b);
+  Output second = ops::MatMul(s.WithOpName("second"), first, a);
+
+  GrapplerItem item;
+  item.fetch = {"second"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  OperatorBatching optimizer;
+  GraphDef output;
+  EXPECT_TRUE(errors::IsAborted(optimizer.Optimize(nullptr, item, &output)));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -25,6 +25,9 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_join.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
@@ -32,12 +35,14 @@ limitations under the License.
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
 #include "tensorflow/core/grappler/optimizers/constant_folding.h"
+#include "tensorflow/core/grappler/optimizers/remapper_fusion_registry.h"
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/grappler/utils/graph_view.h"
 #include "tensorflow/core/grappler/utils/pattern_utils.h"
 #include "tensorflow/core/grappler/utils/symbolic_shapes.h"
 #include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 #include "tensorflow/core/util/env_var.h"
@@ -92,6 +97,7 @@ constexpr char kFusedDepthwiseConv2dNative[] = "_FusedDepthwiseConv2dNative";
 constexpr char kFusedBatchNormEx[] = "_FusedBatchNormEx";
 constexpr char kFusedBatchNormGradEx[] = "_FusedBatchNormGradEx";
 constexpr char kTensorToHashBucket[] = "_TensorToHashBucketFast";
+constexpr char kFusedElementwise[] = "_FusedElementwise";
 constexpr char kLeakyRelu[] = "LeakyRelu";
 constexpr char kMklFusedMish[] = "_MklFusedMish";
 constexpr char kRelu[] = "Relu";
@@ -167,6 +173,17 @@ struct TensorToHashBucket {
   int string_to_hash_bucket = kMissingIndex;
 };
 
+// A DAG of cwise ops that can be replaced with a _FusedElementwise, rooted at
+// `root`. Values 0..args.size()-1 are the `args`, and value args.size()+k is
+// the result of `fused_ops[k]`, in evaluation order.
+struct ElementwiseFusion {
+  int root = kMissingIndex;
+  std::vector<int> fused_nodes;
+  std::vector<string> args;
+  std::vector<string> fused_ops;
+  std::vector<int> fused_operands;
+};
+
 // Pad followed by Conv3D/FusedConv3D
 struct PadWithConv3D {
   PadWithConv3D() = default;
@@ -345,7 +362,11 @@ bool IsCpuCompatibleDataType(const NodeDef* contraction,
   if (IsConv2D(*contraction)) {
     return dtype == DT_FLOAT || dtype == DT_DOUBLE;
   } else if (IsMatMul(*contraction)) {
-    return dtype == DT_FLOAT;
+    // The bfloat16 kernel only beats the unfused MatMul on CPUs with
+    // AVX512_BF16.
+    return dtype == DT_FLOAT ||
+           (dtype == DT_BFLOAT16 &&
+            port::TestCPUFeature(port::CPUFeature::AVX512_BF16));
   } else {
     return false;
   }
@@ -385,6 +406,15 @@ bool BlasLtMatmulEnabled() {
   return is_enabled;
 }
 
+// Fusing chains of cwise ops into _FusedElementwise changes the kernels of
+// most CPU graphs, so it is opt-in until it has been benchmarked more widely.
+bool ElementwiseFusionEnabled() {
+  bool is_enabled = false;
+  TF_CHECK_OK(tensorflow::ReadBoolFromEnvVar(
+      "TF_REMAPPER_FUSE_ELEMENTWISE", /*default_val=*/false, &is_enabled));
+  return is_enabled;
+}
+
 bool IsGpuCompatibleDataFormat(const RemapperContext& ctx,
                                const NodeDef* conv2d) {
   DCHECK(IsConv2D(*conv2d)) << "Expected Conv2D op";
@@ -756,6 +786,19 @@ void AddInputShapesAttr(const RemapperContext& ctx, int node_index) {
   }
 }
 
+// Marks a fused MatMul or Conv2D whose filter (right-hand side) is produced by
+// a Const node, so that its CPU kernel can prepack the filter once.
+void AddFilterConstAttr(const RemapperContext& ctx, int contraction_index,
+                        NodeDef* fused_op) {
+  const auto* contraction_view = ctx.graph_view.GetNode(contraction_index);
+  if (contraction_view->NumRegularFanins() < 2) return;
+  const NodeDef* filter =
+      contraction_view->GetRegularFanin(1).node_view()->node();
+  if (IsConstant(*filter)) {
+    SetAttrValue(true, &(*fused_op->mutable_attr())["is_filter_const"]);
+  }
+}
+
 bool FindContractionWithBias(const RemapperContext& ctx, int node_index,
                              ContractionWithBiasAdd* matched,
                              bool check_device_compatible = true) {
@@ -3256,6 +3299,7 @@ Status AddFusedContractionNode(RemapperContext* ctx,
     fused_op.set_op(kFusedConv2D);
     AddInputShapesAttr(*ctx, matched.contraction);
     CopyConv2DAttributes(contraction, &fused_op);
+    AddFilterConstAttr(*ctx, matched.contraction, &fused_op);
   } else if (IsDepthwiseConv2dNative(contraction)) {
     fused_op.set_op(kFusedDepthwiseConv2dNative);
     CopyDepthwiseConv2dNativeAttributes(contraction, &fused_op);
@@ -3263,6 +3307,7 @@ Status AddFusedContractionNode(RemapperContext* ctx,
     fused_op.set_op(kFusedMatMul);
     AddInputShapesAttr(*ctx, matched.contraction);
     CopyMatMulAttributes(contraction, &fused_op);
+    AddFilterConstAttr(*ctx, matched.contraction, &fused_op);
   } else if (IsConv3D(contraction)) {
     fused_op.set_op(kFusedConv3D);
     CopyConv3DAttributes(contraction, &fused_op);
@@ -3361,6 +3406,7 @@ Status AddFusedContractionNode(
     AddInputShapesAttr(*ctx, matched.contraction);
     // leaky relu has a special attribute alpha
     CopyConv2DAttributes(contraction, &fused_op, &activation);
+    AddFilterConstAttr(*ctx, matched.contraction, &fused_op);
   } else if (IsDepthwiseConv2dNative(contraction)) {
     fused_op.set_op(kFusedDepthwiseConv2dNative);
     CopyDepthwiseConv2dNativeAttributes(contraction, &fused_op);
@@ -3368,6 +3414,7 @@ Status AddFusedContractionNode(
     fused_op.set_op(kFusedMatMul);
     AddInputShapesAttr(*ctx, matched.contraction);
     CopyMatMulAttributes(contraction, &fused_op, &activation);
+    AddFilterConstAttr(*ctx, matched.contraction, &fused_op);
   } else if (IsConv3D(contraction)) {
     fused_op.set_op(kFusedConv3D);
     CopyConv3DAttributes(contraction, &fused_op, &activation);
@@ -3467,6 +3514,7 @@ Status AddFusedConv2DNode(RemapperContext* ctx,
 
   AddInputShapesAttr(*ctx, matched.contraction);
   CopyConv2DAttributes(contraction, &fused_conv2d);
+  AddFilterConstAttr(*ctx, matched.contraction, &fused_conv2d);
   SetFusedOpAttributes(&fused_conv2d, {"FusedBatchNorm"},
                        /*num_args=*/4, /*epsilon=*/matched.epsilon);
 
@@ -3511,6 +3559,7 @@ Status AddFusedConv2DNode(RemapperContext* ctx,
 
   AddInputShapesAttr(*ctx, matched.contraction);
   CopyConv2DAttributes(contraction, &fused_conv2d, &activation);
+  AddFilterConstAttr(*ctx, matched.contraction, &fused_conv2d);
   SetFusedOpAttributes(&fused_conv2d, {"FusedBatchNorm", activation.op()},
                        /*num_args=*/4, /*epsilon=*/matched.epsilon);
 
@@ -4270,6 +4319,143 @@ Status AddBatchNormNodes(RemapperContext* ctx, const FusedBatchNorm& matched) {
   return mutation->Apply();
 }
 
+// Returns the number of regular inputs of `node` if it is a cwise op supported
+// by _FusedElementwise, or 0 otherwise.
+// WARN: This should be consistent with the ops in fused_elementwise_op.cc.
+int FusedElementwiseArity(const NodeDef& node) {
+  static const auto* unary_ops = new absl::flat_hash_set<string>(
+      {"Abs", "Exp", "Log", "Neg", "Reciprocal", "Relu", "Rsqrt", "Sigmoid",
+       "Sqrt", "Square", "Tanh"});
+  static const auto* binary_ops = new absl::flat_hash_set<string>(
+      {"Add", "AddV2", "Maximum", "Minimum", "Mul", "RealDiv",
+       "SquaredDifference", "Sub"});
+  if (unary_ops->contains(node.op())) return 1;
+  if (binary_ops->contains(node.op())) return 2;
+  return 0;
+}
+
+// Appends the op of `node_view` and the ops it can absorb to `matched`, and
+// returns the value of its result. Operands that are not fused are recorded as
+// -1 - <index of the arg>, and are renumbered once all args are known.
+// `num_fused_ops` counts the ops claimed so far, including the ones on the
+// current path that are not appended yet.
+int FindElementwiseFusionOps(const RemapperContext& ctx,
+                             const utils::MutableNodeView& node_view,
+                             int max_fused_ops, int* num_fused_ops,
+                             ElementwiseFusion* matched) {
+  const NodeDef* node_def = node_view.node();
+  const NodeDef* root_def = ctx.graph_view.GetNode(matched->root)->node();
+  const int arity = FusedElementwiseArity(*node_def);
+
+  std::vector<int> operands;
+  for (int i = 0; i < arity; ++i) {
+    const utils::MutableNodeView* fanin_view =
+        node_view.GetRegularFanin(i).node_view();
+    const NodeDef* fanin_def = fanin_view->node();
+    // A fanin is fused if its result is only used by `node_def`.
+    const bool fuse_fanin = *num_fused_ops < max_fused_ops &&
+                            FusedElementwiseArity(*fanin_def) > 0 &&
+                            fanin_view->NumRegularFanouts() == 1 &&
+                            !HasControlFaninOrFanout(*fanin_view) &&
+                            !IsInPreserveSet(ctx, fanin_def) &&
+                            HaveSameDataType(fanin_def, root_def) &&
+                            fanin_def->device() == root_def->device();
+    if (fuse_fanin) {
+      ++*num_fused_ops;
+      operands.push_back(FindElementwiseFusionOps(
+          ctx, *fanin_view, max_fused_ops, num_fused_ops, matched));
+      continue;
+    }
+    const string& input = node_def->input(i);
+    auto it = std::find(matched->args.begin(), matched->args.end(), input);
+    if (it == matched->args.end()) {
+      it = matched->args.insert(matched->args.end(), input);
+    }
+    operands.push_back(-1 - static_cast<int>(it - matched->args.begin()));
+  }
+
+  matched->fused_nodes.push_back(node_view.node_index());
+  matched->fused_ops.push_back(node_def->op());
+  matched->fused_operands.insert(matched->fused_operands.end(),
+                                 operands.begin(), operands.end());
+  return matched->fused_ops.size() - 1;
+}
+
+// Returns true if `node_index` is the root of a DAG of cwise CPU ops that can
+// be evaluated in one pass by a _FusedElementwise.
+bool FindElementwiseFusion(const RemapperContext& ctx, int node_index,
+                           ElementwiseFusion* matched) {
+  // Fuse at least two ops, so that at least one intermediate tensor is never
+  // written to memory.
+  constexpr int kMinFusedOps = 2;
+  constexpr int kMaxFusedOps = 16;
+  constexpr int kMaxArgs = 8;
+
+  // XLA fuses cwise ops by itself.
+  if (ctx.xla_auto_clustering_on) return false;
+
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  if (FusedElementwiseArity(*node_def) == 0 || !NodeIsOnCpu(node_def) ||
+      node_view->NumControllingFanins() > 0) {
+    return false;
+  }
+  if (!HasDataType(node_def, DT_FLOAT) && !HasDataType(node_def, DT_DOUBLE)) {
+    return false;
+  }
+
+  ElementwiseFusion fusion;
+  fusion.root = node_index;
+  int num_fused_ops = 1;
+  FindElementwiseFusionOps(ctx, *node_view, kMaxFusedOps, &num_fused_ops,
+                           &fusion);
+  const int num_args = fusion.args.size();
+  if (fusion.fused_ops.size() < kMinFusedOps || num_args > kMaxArgs) {
+    return false;
+  }
+
+  for (int& operand : fusion.fused_operands) {
+    operand = operand < 0 ? -1 - operand : num_args + operand;
+  }
+  *matched = std::move(fusion);
+  return true;
+}
+
+Status AddElementwiseFusionNode(RemapperContext* ctx,
+                                const ElementwiseFusion& matched,
+                                std::vector<bool>* invalidated_nodes,
+                                std::vector<bool>* nodes_to_delete) {
+  const NodeDef& root = *ctx->graph_view.GetNode(matched.root)->node();
+  VLOG(2) << "Fuse " << matched.fused_ops.size()
+          << " cwise ops into _FusedElementwise: root=" << root.name()
+          << " ops=[" << absl::StrJoin(matched.fused_ops, ", ") << "]";
+
+  NodeDef fused_op;
+  fused_op.set_name(root.name());
+  fused_op.set_op(kFusedElementwise);
+  fused_op.set_device(root.device());
+  for (const string& arg : matched.args) fused_op.add_input(arg);
+
+  auto* attr = fused_op.mutable_attr();
+  (*attr)["T"] = root.attr().at("T");
+  SetAttrValue(static_cast<int>(matched.args.size()), &(*attr)["num_args"]);
+  SetAttrValue(matched.fused_ops, &(*attr)["fused_ops"]);
+  SetAttrValue(matched.fused_operands, &(*attr)["fused_operands"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.root] = true;
+  for (int node_index : matched.fused_nodes) {
+    if (node_index != matched.root) (*nodes_to_delete)[node_index] = true;
+  }
+
+  return absl::OkStatus();
+}
+
 Status AddTensorToHashBucketNode(RemapperContext* ctx,
                                  const TensorToHashBucket& matched,
                                  std::vector<bool>* invalidated_nodes,
@@ -4793,6 +4979,120 @@ bool RequiresInferredShapes(const RemapperContext& ctx, int node_index,
          is_matmul_gelu_exact_fusion_candidate() ||
          is_act_biasadd_matmul_candidate();
 }
+
+// Returns true if the subgraph rooted at `node_index` matches the pattern of
+// the registered `fusion` and satisfies its constraints.
+bool FindRegisteredFusion(RemapperContext* ctx, int node_index,
+                          const RemapperFusion& fusion,
+                          std::map<string, int>* matched_nodes_map,
+                          std::set<int>* remove_node_indices) {
+  using utils::MatchingDirection;
+
+  utils::SubGraphMatcher<MatchingDirection::kFollowInputs> graph_matcher(
+      &(ctx->graph_view));
+  matched_nodes_map->clear();
+  remove_node_indices->clear();
+  if (!graph_matcher.GetMatchedNodes(
+          fusion.pattern, ctx->nodes_to_preserve,
+          ctx->graph_view.GetNode(node_index), matched_nodes_map,
+          remove_node_indices)) {
+    return false;
+  }
+
+  for (const RemapperFusion::AttrConstraint& constraint :
+       fusion.attr_constraints) {
+    const NodeDef* node_def =
+        ctx->graph_view.GetNode(matched_nodes_map->at(constraint.label))
+            ->node();
+    const AttrValue* value = AttrSlice(*node_def).Find(constraint.attr);
+    if (value == nullptr) return false;
+    if (std::none_of(constraint.allowed_values.begin(),
+                     constraint.allowed_values.end(),
+                     [value](const AttrValue& allowed) {
+                       return AreAttrValuesEqual(*value, allowed);
+                     })) {
+      return false;
+    }
+  }
+
+  for (const RemapperFusion::Input& input : fusion.inputs) {
+    const NodeDef* node_def =
+        ctx->graph_view.GetNode(matched_nodes_map->at(input.label))->node();
+    if (input.index >= node_def->input_size() ||
+        IsControlInput(node_def->input(input.index))) {
+      return false;
+    }
+  }
+
+  return !fusion.predicate ||
+         fusion.predicate(ctx->graph_view, *matched_nodes_map);
+}
+
+// Replaces the root of a subgraph matched by the registered `fusion` with the
+// fused node.
+Status AddRegisteredFusionNode(RemapperContext* ctx,
+                               const RemapperFusion& fusion,
+                               const std::map<string, int>& matched_nodes_map,
+                               const std::set<int>& remove_node_indices,
+                               std::vector<bool>* invalidated_nodes,
+                               std::vector<bool>* nodes_to_delete) {
+  const int root_index = matched_nodes_map.at(fusion.pattern.label);
+  const NodeDef* root = ctx->graph_view.GetNode(root_index)->node();
+  VLOG(2) << "Apply remapper fusion " << fusion.name << " to " << root->name();
+
+  NodeDef fused_op;
+  fused_op.set_name(root->name());
+  fused_op.set_op(fusion.fused_op);
+  fused_op.set_device(root->device());
+  for (const RemapperFusion::Input& input : fusion.inputs) {
+    const NodeDef* node_def =
+        ctx->graph_view.GetNode(matched_nodes_map.at(input.label))->node();
+    fused_op.add_input(node_def->input(input.index));
+  }
+
+  // Keep the control dependencies of the replaced and removed nodes.
+  std::set<string> control_inputs;
+  std::vector<int> fused_node_indices(remove_node_indices.begin(),
+                                      remove_node_indices.end());
+  fused_node_indices.push_back(root_index);
+  for (int index : fused_node_indices) {
+    for (const auto& fanin :
+         ctx->graph_view.GetNode(index)->GetControllingFanins()) {
+      control_inputs.insert(AsControlDependency(fanin.node_view()->GetName()));
+    }
+  }
+  for (const string& control_input : control_inputs) {
+    fused_op.add_input(control_input);
+  }
+
+  auto* attr = fused_op.mutable_attr();
+  *attr = fusion.fused_attrs;
+  for (const RemapperFusion::CopiedAttr& copied : fusion.copied_attrs) {
+    const NodeDef* node_def =
+        ctx->graph_view.GetNode(matched_nodes_map.at(copied.label))->node();
+    const AttrValue* value = AttrSlice(*node_def).Find(copied.attr);
+    if (value == nullptr) {
+      return errors::InvalidArgument("Remapper fusion ", fusion.name,
+                                     " copies missing attribute ", copied.attr,
+                                     " of ", node_def->name());
+    }
+    (*attr)[copied.fused_attr.empty() ? copied.attr : copied.fused_attr] =
+        *value;
+  }
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[root_index] = true;
+  for (const auto& node_index : remove_node_indices) {
+    (*nodes_to_delete)[node_index] = true;
+  }
+
+  return absl::OkStatus();
+}
 }  // namespace
 
 Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
@@ -4817,6 +5117,7 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
   // not perform rewrite if the graph will be differentiated later.
   bool allow_non_differentiable_rewrites =
       item.optimization_options().allow_non_differentiable_rewrites;
+  const bool fuse_elementwise = ElementwiseFusionEnabled();
 
   for (int i = num_nodes - 1; i >= 0; --i) {
     // Check if node was invalidated by one of the previous remaps.
@@ -5143,6 +5444,31 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       TF_RETURN_IF_ERROR(AddBatchNormNodes(&ctx, fused_batch_norm));
       continue;
     }
+
+    // Remap chains of cwise ops on CPU into the _FusedElementwise.
+    ElementwiseFusion elementwise_fusion;
+    if (allow_non_differentiable_rewrites && fuse_elementwise &&
+        FindElementwiseFusion(ctx, i, &elementwise_fusion)) {
+      TF_RETURN_IF_ERROR(AddElementwiseFusionNode(
+          &ctx, elementwise_fusion, &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
+
+    // Remap the fusions registered with REGISTER_REMAPPER_FUSION, in
+    // registration order.
+    for (const RemapperFusion& fusion :
+         RemapperFusionRegistry::GetRegisteredFusions()) {
+      if (!fusion.differentiable && !allow_non_differentiable_rewrites) {
+        continue;
+      }
+      if (FindRegisteredFusion(&ctx, i, fusion, &matched_nodes_map,
+                               &remove_node_indices)) {
+        TF_RETURN_IF_ERROR(AddRegisteredFusionNode(
+            &ctx, fusion, matched_nodes_map, remove_node_indices,
+            &invalidated_nodes, &nodes_to_delete));
+        break;
+      }
+    }
   }
 
   // Remove invalidated nodes.
@@ -0,0 +1,101 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/remapper_fusion_registry.h"
+
+#include <set>
+#include <utility>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+std::vector<RemapperFusion>* GetFusions() {
+  static std::vector<RemapperFusion>* fusions =
+      new std::vector<RemapperFusion>;
+  return fusions;
+}
+
+void CollectLabels(const utils::OpTypePattern& pattern,
+                   std::set<string>* labels) {
+  labels->insert(pattern.label);
+  for (const utils::OpTypePattern& child : pattern.children) {
+    CollectLabels(child, labels);
+  }
+}
+
+}  // namespace
+
+const std::vector<RemapperFusion>&
+RemapperFusionRegistry::GetRegisteredFusions() {
+  return *GetFusions();
+}
+
+Status RemapperFusionRegistry::RegisterFusion(const string& name,
+                                              RemapperFusion fusion) {
+  for (const RemapperFusion& registered : *GetFusions()) {
+    if (registered.name == name) {
+      return errors::AlreadyExists("Remapper fusion ", name,
+                                   " is already registered");
+    }
+  }
+  if (fusion.pattern.node_status != utils::NodeStatus::kReplace) {
+    return errors::InvalidArgument("The root of remapper fusion ", name,
+                                   " must be replaced");
+  }
+  if (fusion.fused_op.empty()) {
+    return errors::InvalidArgument("Remapper fusion ", name,
+                                   " has no fused op");
+  }
+  std::set<string> labels;
+  CollectLabels(fusion.pattern, &labels);
+  for (const RemapperFusion::Input& input : fusion.inputs) {
+    if (!labels.count(input.label)) {
+      return errors::InvalidArgument("Input of remapper fusion ", name,
+                                     " refers to unknown label ", input.label);
+    }
+  }
+  for (const RemapperFusion::CopiedAttr& attr : fusion.copied_attrs) {
+    if (!labels.count(attr.label)) {
+      return errors::InvalidArgument("Attribute of remapper fusion ", name,
+                                     " refers to unknown label ", attr.label);
+    }
+  }
+  for (const RemapperFusion::AttrConstraint& constraint :
+       fusion.attr_constraints) {
+    if (!labels.count(constraint.label)) {
+      return errors::InvalidArgument("Constraint of remapper fusion ", name,
+                                     " refers to unknown label ",
+                                     constraint.label);
+    }
+  }
+  fusion.name = name;
+  GetFusions()->push_back(std::move(fusion));
+  return absl::OkStatus();
+}
+
+void RemapperFusionRegistry::RegisterFusionOrDie(const string& name,
+                                                 const Creator& creator) {
+  Status s = RegisterFusion(name, creator());
+  if (!s.ok()) {
+    LOG(FATAL) << "Failed to register remapper fusion " << name << ": " << s;
+  }
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
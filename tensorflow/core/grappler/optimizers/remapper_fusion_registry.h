@@ -0,0 +1,127 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_REMAPPER_FUSION_REGISTRY_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_REMAPPER_FUSION_REGISTRY_H_
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/grappler/utils/graph_view.h"
+#include "tensorflow/core/grappler/utils/pattern_utils.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// A fusion that the Remapper applies to every subgraph that matches
+// `pattern`, in addition to the fusions it implements itself. The root of
+// the pattern, which must be NodeStatus::kReplace, is replaced with a node of
+// op `fused_op` with the same name and device, and the pattern nodes marked
+// NodeStatus::kRemove are removed.
+//
+// For example, Neg(Sub(a, b)) can be rewritten to Sub(b, a) with:
+//
+//   RemapperFusion fusion;
+//   fusion.pattern = {"Neg", "neg", NodeStatus::kReplace,
+//                     {{"Sub", "sub", NodeStatus::kRemove,
+//                       {{"*", "a", NodeStatus::kRemain},
+//                        {"*", "b", NodeStatus::kRemain}}}}};
+//   fusion.fused_op = "Sub";
+//   fusion.inputs = {{"sub", 1}, {"sub", 0}};
+//   fusion.copied_attrs = {{"neg", "T"}};
+struct RemapperFusion {
+  // The regular input `index` of the pattern node labeled `label`.
+  struct Input {
+    string label;
+    int index;
+  };
+
+  // Attribute `attr` of the pattern node labeled `label`, copied to the fused
+  // node as `fused_attr`, or as `attr` if `fused_attr` is empty.
+  struct CopiedAttr {
+    string label;
+    string attr;
+    string fused_attr;
+  };
+
+  // Requires attribute `attr` of the pattern node labeled `label` to be equal
+  // to one of `allowed_values`.
+  struct AttrConstraint {
+    string label;
+    string attr;
+    std::vector<AttrValue> allowed_values;
+  };
+
+  // Set by the registry.
+  string name;
+
+  utils::OpTypePattern pattern;
+  std::vector<AttrConstraint> attr_constraints;
+  // Optional check of a match that attribute constraints cannot express.
+  std::function<bool(const utils::MutableGraphView& graph_view,
+                     const std::map<string, int>& matched_nodes_map)>
+      predicate;
+
+  string fused_op;
+  std::vector<Input> inputs;
+  std::vector<CopiedAttr> copied_attrs;
+  // Attributes of the fused node with a fixed value.
+  AttrValueMap fused_attrs;
+
+  // False if `fused_op` has no registered gradient. Such fusions are not
+  // applied to graphs that are differentiated later.
+  bool differentiable = false;
+};
+
+class RemapperFusionRegistry {
+ public:
+  typedef std::function<RemapperFusion()> Creator;
+
+  // Returns the registered fusions, in registration order.
+  static const std::vector<RemapperFusion>& GetRegisteredFusions();
+
+  // Validates `fusion` and registers it under `name`. Fails if a fusion with
+  // the same name is already registered.
+  static Status RegisterFusion(const string& name, RemapperFusion fusion);
+
+  // Registers a fusion during program initialization. This class is not
+  // thread-safe.
+  static void RegisterFusionOrDie(const string& name, const Creator& creator);
+};
+
+class RemapperFusionRegistrar {
+ public:
+  RemapperFusionRegistrar(const string& name,
+                          const RemapperFusionRegistry::Creator& creator) {
+    RemapperFusionRegistry::RegisterFusionOrDie(name, creator);
+  }
+};
+
+// Registers the RemapperFusion returned by `creator` under `name`.
+#define REGISTER_REMAPPER_FUSION(name, creator)           \
+  namespace {                                             \
+  static ::tensorflow::grappler::RemapperFusionRegistrar  \
+      name##_remapper_fusion_registrar(#name, (creator)); \
+  }  // namespace
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_REMAPPER_FUSION_REGISTRY_H_
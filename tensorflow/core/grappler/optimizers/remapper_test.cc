@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/grappler/devices.h"
 #include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/remapper_fusion_registry.h"
 #include "tensorflow/core/grappler/utils/graph_view.h"
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -1767,6 +1768,80 @@ TEST_F(RemapperTensorToHashBucketTest, I32) { RunTest<DT_INT32>(); }
 
 TEST_F(RemapperTensorToHashBucketTest, I64) { RunTest<DT_INT64>(); }
 
+TEST_F(RemapperTest, FuseElementwiseOps) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto x = Placeholder(s.WithOpName("x"), DT_FLOAT,
+                       ops::Placeholder::Shape({8, 16}));
+  auto y = Placeholder(s.WithOpName("y"), DT_FLOAT,
+                       ops::Placeholder::Shape({8, 16}));
+  auto z = Placeholder(s.WithOpName("z"), DT_FLOAT,
+                       ops::Placeholder::Shape({16}));
+
+  // tanh(x * y + z) * x
+  auto mul = ops::Mul(s.WithOpName("mul"), x, y);
+  auto add = ops::AddV2(s.WithOpName("add"), mul, z);
+  auto tanh = ops::Tanh(s.WithOpName("tanh"), add);
+  auto out = ops::Mul(s.WithOpName("out"), tanh, x);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), out);
+
+  auto x_t = GenerateRandomTensor<DT_FLOAT>({8, 16});
+  auto y_t = GenerateRandomTensor<DT_FLOAT>({8, 16});
+  auto z_t = GenerateRandomTensor<DT_FLOAT>({16});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"x", x_t}, {"y", y_t}, {"z", z_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  // The fusion is opt-in.
+  setenv("TF_REMAPPER_FUSE_ELEMENTWISE", "1", 1 /* replace */);
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  unsetenv("TF_REMAPPER_FUSE_ELEMENTWISE");
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "mul");
+    EXPECT_NE(node.name(), "add");
+    EXPECT_NE(node.name(), "tanh");
+    if (node.name() == "out") {
+      EXPECT_EQ(node.op(), "_FusedElementwise");
+      ASSERT_EQ(node.input_size(), 3);
+      EXPECT_EQ(node.input(0), "x");
+      EXPECT_EQ(node.input(1), "y");
+      EXPECT_EQ(node.input(2), "z");
+      EXPECT_EQ(node.attr().at("num_args").i(), 3);
+
+      const auto& fused_ops = node.attr().at("fused_ops").list().s();
+      ASSERT_EQ(fused_ops.size(), 4);
+      EXPECT_EQ(fused_ops[0], "Mul");
+      EXPECT_EQ(fused_ops[1], "AddV2");
+      EXPECT_EQ(fused_ops[2], "Tanh");
+      EXPECT_EQ(fused_ops[3], "Mul");
+
+      const auto& fused_operands = node.attr().at("fused_operands").list().i();
+      EXPECT_EQ(std::vector<int64_t>(fused_operands.begin(),
+                                     fused_operands.end()),
+                std::vector<int64_t>({0, 1, 3, 2, 4, 5, 0}));
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
+}
+
 class RemapperFuseMatMulWithBiasTest : public RemapperTest {
  public:
   template <DataType DTYPE>
@@ -3044,5 +3119,93 @@ TEST_F(RemapperControlDependencyPatternMatcher, BF16) {
   RunTest<DT_BFLOAT16>();
 }
 
+// Rewrites Neg(Sub(a, b)) to Sub(b, a) for float tensors.
+REGISTER_REMAPPER_FUSION(NegSubToSub, []() {
+  using utils::NodeStatus;
+  RemapperFusion fusion;
+  // clang-format off
+  fusion.pattern =
+    {"Neg", "neg", NodeStatus::kReplace,
+      {
+        {"Sub", "sub", NodeStatus::kRemove,
+          {
+            {"*", "a", NodeStatus::kRemain},
+            {"*", "b", NodeStatus::kRemain}
+          }
+        }
+      }
+    };
+  // clang-format on
+  RemapperFusion::AttrConstraint float_only{"neg", "T", {AttrValue()}};
+  float_only.allowed_values[0].set_type(DT_FLOAT);
+  fusion.attr_constraints = {float_only};
+  fusion.fused_op = "Sub";
+  fusion.inputs = {{"sub", 1}, {"sub", 0}};
+  fusion.copied_attrs = {{"neg", "T", ""}};
+  fusion.differentiable = true;
+  return fusion;
+});
+
+TEST_F(RemapperTest, RegisteredFusion) {
+  auto run_test = [this](DataType dtype) {
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+    auto a = ops::Placeholder(s.WithOpName("a"), dtype,
+                              ops::Placeholder::Shape({2, 2}));
+    auto b = ops::Placeholder(s.WithOpName("b"), dtype,
+                              ops::Placeholder::Shape({2, 2}));
+    auto sub = ops::Sub(s.WithOpName("sub"), a, b);
+    auto neg = ops::Neg(s.WithOpName("neg"), sub);
+    auto fetch = ops::Identity(s.WithOpName("fetch"), neg);
+
+    GrapplerItem item;
+    item.fetch = {"fetch"};
+    TF_EXPECT_OK(s.ToGraphDef(&item.graph));
+    if (dtype == DT_FLOAT) {
+      item.feed = {{"a", GenerateRandomTensor<DT_FLOAT>({2, 2})},
+                   {"b", GenerateRandomTensor<DT_FLOAT>({2, 2})}};
+    }
+
+    Remapper optimizer(RewriterConfig::ON);
+    GraphDef output;
+    TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+    if (dtype == DT_FLOAT) {
+      auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+      auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+      EXPECT_EQ(tensors.size(), 1);
+      EXPECT_EQ(tensors_expected.size(), 1);
+      if (tensors.size() == 1 && tensors_expected.size() == 1) {
+        test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
+      }
+    }
+    return output;
+  };
+
+  GraphDef output = run_test(DT_FLOAT);
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "sub");
+    if (node.name() == "neg") {
+      EXPECT_EQ(node.op(), "Sub");
+      ASSERT_EQ(node.input_size(), 2);
+      EXPECT_EQ(node.input(0), "b");
+      EXPECT_EQ(node.input(1), "a");
+      EXPECT_EQ(node.attr().at("T").type(), DT_FLOAT);
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+
+  // The attribute constraint rejects other types.
+  output = run_test(DT_INT32);
+  found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "neg") {
+      EXPECT_EQ(node.op(), "Neg");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
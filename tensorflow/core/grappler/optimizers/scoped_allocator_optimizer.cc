@@ -19,10 +19,12 @@ limitations under the License.
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/grappler/utils/frame.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 
@@ -524,7 +526,8 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
     sa_builder.Attr("id", sa_id);
     sa_builder.Attr("shapes", input_shapes);
     sa_builder.Attr("shape", sa_shape);
-    sa_builder.Attr("expected_call_count", static_cast<int64_t>(ops.size()));
+    sa_builder.Attr("expected_call_count",
+                    static_cast<int64_t>(inputs.size()));
     NodeDef* sa_node = graph->add_node();
     LOG_WARNING_AND_RETURN_IF_ERROR(sa_builder.Finalize(sa_node));
     node_map->AddNode(sa_name, sa_node);
@@ -889,12 +892,223 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
   }
 };
 
+// Rewrites a Concat or ConcatV2 along dimension 0 so that the producers of
+// its inputs allocate their outputs directly in the slices of its output,
+// which turns the concat into a _ScopedAllocatorConcat that copies nothing.
+// Unlike the unary rewrite this applies to every node on its own.
+//
+// The fields of a ScopedAllocator are padded to kAllocatorAlignment, so only
+// concats whose inputs all have a multiple of kAllocatorAlignment bytes are
+// rewritten.  Producers that may output an alias of their input instead of
+// allocating it are not eligible.
+class ConcatRewriter : public UnaryElementwiseRewriter {
+ public:
+  ~ConcatRewriter() override {}
+
+  bool RewritesEachNode() const override { return true; }
+
+  Status Rewrite(ScopedAllocatorOptimizer* sa_opti, int64_t invocation_count,
+                 GraphDef* graph, const string& op_name,
+                 const std::vector<NodeDef*>& ops, bool* applied) override {
+    *applied = false;
+    for (NodeDef* concat : ops) {
+      DataType dtype;
+      std::vector<TensorShape> input_shapes;
+      std::vector<InputDesc> inputs;
+      TensorShape output_shape;
+      Status s = AnalyzeConcat(sa_opti->node_map(), concat, &dtype,
+                               &input_shapes, &inputs, &output_shape);
+      if (!s.ok()) {
+        VLOG(1) << "Not rewriting " << concat->name() << ": " << s;
+        continue;
+      }
+      TF_RETURN_IF_ERROR(RewriteConcat(sa_opti, invocation_count, graph,
+                                       concat, dtype, input_shapes, inputs,
+                                       output_shape));
+      *applied = true;
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  // Returns the index of the axis input of `concat`.
+  static int AxisIndex(const NodeDef& concat, int num_values) {
+    return concat.op() == "ConcatV2" ? num_values : 0;
+  }
+
+  // Returns true if `producer` may output an alias of one of its inputs, or
+  // of memory it does not allocate, rather than allocate its output.
+  static bool MayNotAllocateOutput(const NodeDef& producer) {
+    return IsConstant(producer) || IsArg(producer) || IsPlaceholder(producer) ||
+           IsIdentity(producer) || IsIdentityN(producer) ||
+           IsSnapshot(producer) || IsReshape(producer) ||
+           IsSqueeze(producer) || producer.op() == "ExpandDims" ||
+           IsBitcast(producer) || IsStopGradient(producer) ||
+           IsVariable(producer) || IsReadVariableOp(producer) ||
+           IsRecv(producer) || IsSwitch(producer) || IsMerge(producer) ||
+           ModifiesFrameInfo(producer);
+  }
+
+  // Returns the number of edges from output `slot` of `producer`.
+  static int NumUses(NodeMap* node_map, const NodeDef& producer, int slot) {
+    int num_uses = 0;
+    for (const NodeDef* output : node_map->GetOutputs(producer.name())) {
+      for (const string& input : output->input()) {
+        int position = 0;
+        if (ParseNodeName(input, &position) == producer.name() &&
+            position == slot) {
+          ++num_uses;
+        }
+      }
+    }
+    return num_uses;
+  }
+
+  // Returns non-OK if `concat` cannot be rewritten.  Otherwise gathers the
+  // type and shapes of its inputs, in order, and the shape of its output.
+  Status AnalyzeConcat(NodeMap* node_map, NodeDef* concat, DataType* dtype,
+                       std::vector<TensorShape>* input_shapes,
+                       std::vector<InputDesc>* inputs,
+                       TensorShape* output_shape) {
+    int num_values;
+    TF_RETURN_IF_ERROR(GetNodeAttr(*concat, "N", &num_values));
+    TF_RETURN_IF_ERROR(GetNodeAttr(*concat, "T", dtype));
+    if (!DataTypeCanUseMemcpy(*dtype) ||
+        Allocator::kAllocatorAlignment % DataTypeSize(*dtype) != 0) {
+      return errors::Aborted("Unsupported type ", DataTypeString(*dtype));
+    }
+    if (concat->device().empty()) {
+      return errors::Aborted("No device assigned");
+    }
+    if (!graph_properties_->HasOutputProperties(concat->name())) {
+      return errors::Aborted("No output shape");
+    }
+    const auto& output_props =
+        graph_properties_->GetOutputProperties(concat->name());
+    if (output_props.size() != 1 ||
+        !PartialTensorShape(output_props[0].shape()).IsFullyDefined()) {
+      return errors::Aborted("Output shape not fully known");
+    }
+    *output_shape = TensorShape(output_props[0].shape());
+
+    const int axis_index = AxisIndex(*concat, num_values);
+    if (concat->input_size() <= num_values ||
+        IsControlInput(concat->input(axis_index))) {
+      return errors::Internal("Missing inputs");
+    }
+    const NodeDef* axis_node = node_map->GetNode(concat->input(axis_index));
+    Tensor axis;
+    if (axis_node == nullptr || !IsConstant(*axis_node) ||
+        !axis.FromProto(axis_node->attr().at("value").tensor()) ||
+        axis.NumElements() != 1) {
+      return errors::Aborted("Axis is not a constant scalar");
+    }
+    int64_t axis_value = axis.dtype() == DT_INT64 ? axis.flat<int64_t>()(0)
+                                                  : axis.flat<int32>()(0);
+    if (axis_value < 0) axis_value += output_shape->dims();
+    if (axis_value != 0) {
+      return errors::Aborted("Axis ", axis_value, " is not 0");
+    }
+
+    const int first_value = axis_index == 0 ? 1 : 0;
+    for (int i = first_value; i < first_value + num_values; ++i) {
+      int slot = 0;
+      ParseNodeName(concat->input(i), &slot);
+      NodeDef* producer = node_map->GetNode(concat->input(i));
+      if (producer == nullptr) {
+        return errors::Internal("Did not find node ", concat->input(i));
+      }
+      if (producer->device() != concat->device() ||
+          MayNotAllocateOutput(*producer) ||
+          HasNodeAttr(*producer, kScopedAllocatorAttrName)) {
+        return errors::Aborted("Input ", producer->name(),
+                               " cannot allocate in the output");
+      }
+      if (NumUses(node_map, *producer, slot) != 1) {
+        return errors::Aborted("Input ", concat->input(i),
+                               " has other consumers");
+      }
+      const auto& props = graph_properties_->GetOutputProperties(
+          producer->name());
+      if (slot >= static_cast<int>(props.size()) ||
+          props[slot].dtype() != *dtype ||
+          !PartialTensorShape(props[slot].shape()).IsFullyDefined()) {
+        return errors::Aborted("Shape of input ", concat->input(i),
+                               " not fully known");
+      }
+      TensorShape shape(props[slot].shape());
+      if (shape.num_elements() * DataTypeSize(*dtype) %
+              Allocator::kAllocatorAlignment !=
+          0) {
+        return errors::Aborted("Input ", concat->input(i), " is not a ",
+                               "multiple of ", Allocator::kAllocatorAlignment,
+                               " bytes");
+      }
+      input_shapes->push_back(shape);
+      inputs->emplace_back(producer, slot, concat);
+    }
+    return absl::OkStatus();
+  }
+
+  // Backs the inputs of `concat` by a new ScopedAllocator and replaces it by
+  // a _ScopedAllocatorConcat of the same name.
+  Status RewriteConcat(ScopedAllocatorOptimizer* sa_opti,
+                       int64_t invocation_count, GraphDef* graph,
+                       NodeDef* concat, DataType dtype,
+                       const std::vector<TensorShape>& input_shapes,
+                       const std::vector<InputDesc>& inputs,
+                       const TensorShape& output_shape) {
+    VLOG(1) << "ConcatRewriter::Rewrite " << concat->name();
+    NodeMap* node_map = sa_opti->node_map();
+    const int sa_id = sa_opti->NewScopedAllocatorId(input_shapes.size());
+    const string sa_name =
+        strings::StrCat("scoped_allocator_", sa_id, "_", invocation_count);
+    // Without padding between the fields the backing tensor is exactly the
+    // output of the concat.
+    const TensorShape sa_shape({output_shape.num_elements()});
+    TF_RETURN_IF_ERROR(ConstructScopedAllocatorNode(
+        sa_opti, graph, node_map, {concat}, concat->device(), dtype, sa_id,
+        sa_name, input_shapes, inputs, sa_shape));
+
+    NodeDefBuilder sac_builder(concat->name(), "_ScopedAllocatorConcat");
+    sac_builder.Device(concat->device());
+    sac_builder.Attr("sa_name", sa_name);
+    sac_builder.Attr("id", sa_id);
+    sac_builder.Attr("T", dtype);
+    sac_builder.Attr("shape", output_shape);
+    sac_builder.Attr("reshape", true);
+    sac_builder.Attr("N", static_cast<int>(inputs.size()));
+    sac_builder.Input(NodeDefBuilder::NodeOut(sa_name, 0, dtype));
+    std::vector<NodeDefBuilder::NodeOut> values;
+    for (const InputDesc& input : inputs) {
+      values.emplace_back(input.from_node_def->name(), input.output_slot,
+                          dtype);
+    }
+    sac_builder.Input(values);
+    NodeDef sac_node;
+    LOG_WARNING_AND_RETURN_IF_ERROR(sac_builder.Finalize(&sac_node));
+    // Keep the control inputs of the concat and drop its axis.
+    for (const string& input : concat->input()) {
+      if (IsControlInput(input)) sac_node.add_input(input);
+    }
+    node_map->RemoveOutput(
+        NodeName(concat->input(
+            AxisIndex(*concat, static_cast<int>(inputs.size())))),
+        concat->name());
+    node_map->AddOutput(sa_name, concat->name());
+    concat->Swap(&sac_node);
+    return absl::OkStatus();
+  }
+};
+
 ScopedAllocatorOptimizer::ScopedAllocatorOptimizer(
     RewriterConfig::Toggle opt_level, const ScopedAllocatorOptions& opts)
     : opt_level_(opt_level) {
   VLOG(1) << "ScopedAllocatorOptimizer::ScopedAllocatorOptimizer";
   Rewriter* r = new UnaryElementwiseRewriter();
   to_delete_.push_back(r);
+  Rewriter* concat_rewriter = new ConcatRewriter();
+  to_delete_.push_back(concat_rewriter);
   if (opts.enable_op_size() == 0) {
     // Opts handled by default:
     for (const auto& op_name : {"CollectiveReduce"}) {
@@ -904,7 +1118,9 @@ ScopedAllocatorOptimizer::ScopedAllocatorOptimizer(
   } else {
     for (const auto& op_name : opts.enable_op()) {
       op_name_set_.insert(op_name);
-      rewriters_[op_name] = r;
+      rewriters_[op_name] = (op_name == "Concat" || op_name == "ConcatV2")
+                                ? concat_rewriter
+                                : r;
     }
   }
 }
@@ -1110,6 +1326,15 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
           continue;
         }
         rewriter->SetGraphProperties(graph_properties);
+        if (rewriter->RewritesEachNode()) {
+          bool applied = false;
+          status = rewriter->Rewrite(this, invocation_count, graph, op_name,
+                                     it.second, &applied);
+          if (!status.ok()) {
+            break;
+          }
+          continue;
+        }
         std::unique_ptr<Tree> root(ComputeScopeTree(it.first, it.second));
         // Record outputs that are inputs to multiple Tree nodes.
         absl::flat_hash_set<string> seen_outputs;
@@ -93,6 +93,11 @@ class ScopedAllocatorOptimizer : public GraphOptimizer {
                            const std::vector<NodeDef*>& nodes,
                            bool* applied) = 0;
 
+    // Returns true if Rewrite applies to each node on its own, rather than to
+    // groups of parallel nodes.  Such rewriters get all the nodes of their op
+    // on a device in one call.
+    virtual bool RewritesEachNode() const { return false; }
+
     void SetGraphProperties(const GraphProperties& graph_properties) {
       graph_properties_ = &graph_properties;
       CHECK(graph_properties_);
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/grappler/optimizers/scoped_allocator_optimizer.h"
 
+#include <cmath>
 #include <unordered_set>
 
 #include "tensorflow/cc/ops/array_ops.h"
@@ -267,6 +268,28 @@ class ScopedAllocatorOptimizerTest : public ::testing::Test {
     TF_CHECK_OK(s.ToGraphDef(graph_def));
   }
 
+  // Constructs the following graph, where e1 and e2 are Exp ops of
+  // shapes [rows1, cols] and [rows2, cols] and c concatenates them along
+  // dimension 0.
+  /*
+        a    b
+        |    |
+        e1   e2
+         \  /
+           c
+  */
+  void BuildConcatGraph(GraphDef* graph_def, int rows1, int rows2, int cols) {
+    Scope s = Scope::NewRootScope();
+    s = s.WithDevice("/job:localhost/replica:0/task:0/device:CPU:0");
+
+    Output a = ops::Const<float>(s.WithOpName("a"), 0.0f, {rows1, cols});
+    Output b = ops::Const<float>(s.WithOpName("b"), 1.0f, {rows2, cols});
+    Output e1 = ops::Exp(s.WithOpName("e1"), a);
+    Output e2 = ops::Exp(s.WithOpName("e2"), b);
+    Output c = ops::Concat(s.WithOpName("c"), {e1, e2}, 0);
+    TF_CHECK_OK(s.ToGraphDef(graph_def));
+  }
+
   void SetShapes(GraphDef* graph_def) {
     TensorShapeProto shape_proto;
     shape_proto.add_dim()->set_size(2);
@@ -283,7 +306,8 @@ class ScopedAllocatorOptimizerTest : public ::testing::Test {
   // returns the outputs specified by `output_names` in `outputs`.
   void ExecuteGraph(const GraphDef& graph_def,
                     const std::vector<string>& output_names,
-                    std::vector<Tensor>* outputs) {
+                    std::vector<Tensor>* outputs,
+                    const string& enable_op = "Abs") {
     // Turn off all optimization except the ScopedAllocatorOptimizer
     // to avoid anything that would alter the expected graph input/output,
     // e.g. by constant folding away all calculations.
@@ -297,7 +321,7 @@ class ScopedAllocatorOptimizerTest : public ::testing::Test {
     RewriterConfig* rwcfg = gopt->mutable_rewrite_options();
     rwcfg->clear_optimizers();
     (*rwcfg->add_optimizers()) = "scoped_allocator";
-    rwcfg->mutable_scoped_allocator_opts()->add_enable_op("Abs");
+    rwcfg->mutable_scoped_allocator_opts()->add_enable_op(enable_op);
     std::unique_ptr<Session> session(CreateSession(graph_def, config));
 
     std::vector<std::pair<string, Tensor>> inputs;
@@ -596,6 +620,58 @@ TEST_F(ScopedAllocatorOptimizerTest, ConstInput) {
   }
   EXPECT_EQ(num_identity_ops, 2);
 }
+// Test that the producers of the inputs of a Concat along dimension 0 allocate
+// their outputs in the output of the concat.
+TEST_F(ScopedAllocatorOptimizerTest, ConcatRewrite) {
+  GrapplerItem item;
+  BuildConcatGraph(&item.graph, /*rows1=*/2, /*rows2=*/1, /*cols=*/16);
+
+  ScopedAllocatorOptions opts;
+  opts.add_enable_op("ConcatV2");
+  ScopedAllocatorOptimizer sao(RewriterConfig::ON, opts);
+  GraphDef optimized_graph;
+  TF_ASSERT_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+
+  NodeMap node_map(&optimized_graph);
+  NodeDef* c = nullptr;
+  GetNode(&node_map, "c", &c);
+  EXPECT_EQ("_ScopedAllocatorConcat", c->op());
+  ASSERT_EQ(3, c->input_size());
+  EXPECT_EQ("e1", c->input(1));
+  EXPECT_EQ("e2", c->input(2));
+  NodeDef* sa_node = ValidateSAControlInput(&optimized_graph, &node_map, "e1");
+  EXPECT_EQ(sa_node, ValidateSAControlInput(&optimized_graph, &node_map, "e2"));
+  EXPECT_EQ(c->input(0), sa_node->name());
+
+  std::vector<Tensor> outputs;
+  ExecuteGraph(item.graph, /*output_names=*/{"c:0"}, &outputs,
+               /*enable_op=*/"ConcatV2");
+  ASSERT_EQ(TensorShape({3, 16}), outputs[0].shape());
+  for (int i = 0; i < 32; ++i) {
+    EXPECT_EQ(1.0f, outputs[0].flat<float>()(i));
+  }
+  for (int i = 32; i < 48; ++i) {
+    EXPECT_FLOAT_EQ(std::exp(1.0f), outputs[0].flat<float>()(i));
+  }
+}
+
+// Test that a Concat is not rewritten if its inputs would be padded in the
+// backing tensor.
+TEST_F(ScopedAllocatorOptimizerTest, ConcatOfUnalignedInputs) {
+  GrapplerItem item;
+  // The inputs have 24 and 12 bytes.
+  BuildConcatGraph(&item.graph, /*rows1=*/2, /*rows2=*/1, /*cols=*/3);
+
+  ScopedAllocatorOptions opts;
+  opts.add_enable_op("ConcatV2");
+  ScopedAllocatorOptimizer sao(RewriterConfig::ON, opts);
+  GraphDef optimized_graph;
+  TF_ASSERT_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+  for (const NodeDef& node : optimized_graph.node()) {
+    EXPECT_NE("_ScopedAllocator", node.op());
+    if (node.name() == "c") EXPECT_EQ("ConcatV2", node.op());
+  }
+}
 #endif  // ENABLE_MKL
 
 }  // namespace
@@ -15,7 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/static_schedule.h"
 
+#include <algorithm>
 #include <deque>
+#include <tuple>
+#include <vector>
 
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
@@ -199,5 +202,52 @@ Status EstimateRequiredTimes(
   return absl::OkStatus();
 }
 
+const char kSchedulingPriorityAttr[] = "_scheduling_priority";
+
+Status AnnotateSchedulingPriorities(const Cluster* cluster,
+                                    GrapplerItem* item) {
+  std::unordered_map<const NodeDef*, Costs::NanoSeconds> completion_times;
+  TF_RETURN_IF_ERROR(
+      EstimateEarliestExecutionTimes(*item, cluster, &completion_times));
+
+  // Every node must complete by the time the whole graph does: this makes the
+  // slack of the nodes on the critical path zero.
+  Costs::NanoSeconds makespan(0);
+  for (const auto& completion_time : completion_times) {
+    makespan = std::max(makespan, completion_time.second);
+  }
+  std::unordered_map<const NodeDef*, Costs::NanoSeconds> deadlines;
+  for (const NodeDef& node : item->graph.node()) {
+    deadlines[&node] = makespan;
+  }
+  std::unordered_map<const NodeDef*, Costs::NanoSeconds> required_times;
+  TF_RETURN_IF_ERROR(
+      EstimateRequiredTimes(*item, cluster, deadlines, &required_times));
+
+  // Nodes that are never reached (e.g. in a dead loop body) are ranked last.
+  std::vector<std::tuple<int64_t, int64_t, int>> schedule;
+  schedule.reserve(item->graph.node_size());
+  for (int i = 0; i < item->graph.node_size(); ++i) {
+    const NodeDef* node = &item->graph.node(i);
+    auto completion = completion_times.find(node);
+    if (completion == completion_times.end()) {
+      schedule.emplace_back(Costs::NanoSeconds::max().count(),
+                            Costs::NanoSeconds::max().count(), i);
+      continue;
+    }
+    const int64_t slack =
+        (required_times[node] - completion->second).count();
+    schedule.emplace_back(std::max<int64_t>(slack, 0),
+                          completion->second.count(), i);
+  }
+  std::sort(schedule.begin(), schedule.end());
+
+  for (int rank = 0, end = schedule.size(); rank < end; ++rank) {
+    NodeDef* node = item->graph.mutable_node(std::get<2>(schedule[rank]));
+    (*node->mutable_attr())[kSchedulingPriorityAttr].set_i(rank);
+  }
+  return absl::OkStatus();
+}
+
 }  // end namespace grappler
 }  // end namespace tensorflow
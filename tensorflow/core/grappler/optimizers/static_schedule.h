@@ -44,6 +44,18 @@ Status EstimateRequiredTimes(
         execution_times,
     std::unordered_map<const NodeDef*, Costs::NanoSeconds>* required_times);
 
+// Name of the node attribute holding the rank assigned to each node by
+// AnnotateSchedulingPriorities. The executor reads it to decide which of
+// several ready nodes to run first.
+extern const char kSchedulingPriorityAttr[];
+
+// Annotates every node of `item->graph` with its rank in a static schedule of
+// the graph: nodes on the critical path get the lowest ranks, and other nodes
+// are ranked by how much their execution can be delayed without delaying the
+// whole graph. Ties are broken by earliest completion time.
+Status AnnotateSchedulingPriorities(const Cluster* cluster,
+                                    GrapplerItem* item);
+
 }  // namespace grappler
 }  // end namespace tensorflow
 
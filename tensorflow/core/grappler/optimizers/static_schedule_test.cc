@@ -196,6 +196,34 @@ TEST_F(StaticScheduleTest, RequiredTimes) {
                                       "Sign_2", "Sign_3", "y"}));
 }
 
+TEST_F(StaticScheduleTest, SchedulingPriorities) {
+  // "b" to "d" form the critical path, while "side" can be delayed.
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output a = ops::Const(s.WithOpName("a"), 1.0f, {64, 64});
+  Output b = ops::MatMul(s.WithOpName("b"), a, a);
+  Output c = ops::MatMul(s.WithOpName("c"), b, b);
+  Output d = ops::MatMul(s.WithOpName("d"), c, c);
+  Output side = ops::Identity(s.WithOpName("side"), a);
+  Output e = ops::AddN(s.WithOpName("e"), {d, side});
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+  TF_EXPECT_OK(AnnotateSchedulingPriorities(cluster.get(), &item));
+
+  std::map<string, int64_t> priorities;
+  for (const NodeDef& node : item.graph.node()) {
+    ASSERT_EQ(1, node.attr().count(kSchedulingPriorityAttr)) << node.name();
+    priorities[node.name()] = node.attr().at(kSchedulingPriorityAttr).i();
+  }
+  EXPECT_LT(priorities["a"], priorities["b"]);
+  EXPECT_LT(priorities["b"], priorities["c"]);
+  EXPECT_LT(priorities["c"], priorities["d"]);
+  EXPECT_LT(priorities["d"], priorities["e"]);
+  EXPECT_LT(priorities["e"], priorities["side"]);
+}
+
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
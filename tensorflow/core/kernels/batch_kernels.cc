@@ -124,6 +124,10 @@ static thread::ThreadPool* GetOrCreateBatchThreadsPool() {
     options.num_threads =
         NumBatchThreadsFromEnvironmentWithDefault(kBatchThreadPoolSize);
 
+    const char* work_stealing = std::getenv("TF_BATCH_THREADS_WORK_STEALING");
+    options.enable_work_stealing =
+        work_stealing != nullptr && std::string(work_stealing) == "1";
+
     options.thread_name = std::string("adaptive_batch_threads");
 
     auto status_or_executor = serving::BoundedExecutor::Create(options);
@@ -25,6 +25,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/types/optional.h"
+#include "tensorflow/core/kernels/batching_util/batch_cost_model.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
 #include "tensorflow/core/kernels/batching_util/periodic_function.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -171,6 +172,15 @@ class AdaptiveSharedBatchScheduler
 
     // If true, the padding will not be appended.
     bool disable_padding = false;
+
+    // If non nullptr, the processing time of every batch of the queue is
+    // recorded in `batch_cost_model`, and batches are closed once they reach
+    // `batch_cost_model->ChooseBatchSize(max_batch_size)` rather than
+    // `max_batch_size`. Batches are assumed to be padded to
+    // `batch_cost_model->PaddedBatchSize(batch->size())`, so process batch
+    // callbacks should pad them accordingly. The caller keeps a reference to
+    // inspect the fitted curve.
+    std::shared_ptr<BatchCostModel> batch_cost_model;
   };
 
   using BatchProcessor = std::function<void(std::unique_ptr<Batch<TaskType>>)>;
@@ -346,11 +356,13 @@ template <typename TaskType>
 class ASBSBatch : public Batch<TaskType> {
  public:
   ASBSBatch(ASBSQueue<TaskType>* queue, int64_t creation_time_micros,
-            int64_t batch_timeout_micros, uint64 traceme_context_id)
+            int64_t batch_timeout_micros, uint64 traceme_context_id,
+            std::shared_ptr<BatchCostModel> cost_model = nullptr)
       : queue_(queue),
         creation_time_micros_(creation_time_micros),
         schedulable_time_micros_(creation_time_micros + batch_timeout_micros),
-        traceme_context_id_(traceme_context_id) {}
+        traceme_context_id_(traceme_context_id),
+        cost_model_(std::move(cost_model)) {}
 
   ~ASBSBatch() override {}
 
@@ -362,11 +374,18 @@ class ASBSBatch : public Batch<TaskType> {
 
   uint64 traceme_context_id() const { return traceme_context_id_; }
 
+  // The model that learns the processing time of the batch, if any. Unlike
+  // `queue()`, it outlives the release of the batch.
+  const std::shared_ptr<BatchCostModel>& cost_model() const {
+    return cost_model_;
+  }
+
  private:
   ASBSQueue<TaskType>* queue_;
   const int64_t creation_time_micros_;
   const int64_t schedulable_time_micros_;
   const uint64 traceme_context_id_;
+  const std::shared_ptr<BatchCostModel> cost_model_;
   ASBSBatch(const ASBSBatch&) = delete;
   void operator=(const ASBSBatch&) = delete;
 };
@@ -642,9 +661,16 @@ void AdaptiveSharedBatchScheduler<TaskType>::CallbackWrapper(
       profiler::ContextType::kAdaptiveSharedBatchScheduler,
       batch->traceme_context_id());
   const int64_t start_time = batch->creation_time_micros();
+  const int batch_size = batch->size();
+  const std::shared_ptr<BatchCostModel> cost_model = batch->cost_model();
+  const int64_t processing_start_time = GetEnv()->NowMicros();
   callback(std::unique_ptr<Batch<TaskType>>(
       const_cast<internal::ASBSBatch<TaskType>*>(batch)));
   int64_t end_time = GetEnv()->NowMicros();
+  if (cost_model != nullptr) {
+    cost_model->RecordBatch(batch_size, cost_model->PaddedBatchSize(batch_size),
+                            end_time - processing_start_time);
+  }
   mutex_lock l(mu_);
   if (is_express) {
     in_flight_express_batches_--;
@@ -744,6 +770,13 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
                                    options_.max_input_task_size.value());
   }
 
+  // The size at which batches are closed, which the cost model may lower to
+  // meet its latency target or to improve goodput.
+  const int max_batch_size =
+      options_.batch_cost_model == nullptr
+          ? options_.max_batch_size
+          : options_.batch_cost_model->ChooseBatchSize(options_.max_batch_size);
+
   std::vector<std::unique_ptr<TaskType>> tasks_to_schedule;
   std::vector<ASBSBatch<TaskType>*> new_batches;
   bool closed_batch = false;
@@ -752,11 +785,18 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
     if (size > SchedulingCapacityLocked()) {
       return errors::Unavailable("The batch scheduling queue is full");
     }
+    // The cost model may have lowered the size since the current batch was
+    // started.
+    if (current_batch_ && current_batch_->size() >= max_batch_size) {
+      current_batch_->Close();
+      closed_batch = true;
+      current_batch_ = nullptr;
+    }
 
     int remaining_batch_size =
         current_batch_ == nullptr
-            ? options_.max_batch_size
-            : options_.max_batch_size - current_batch_->size();
+            ? max_batch_size
+            : max_batch_size - current_batch_->size();
     if (options_.split_input_task_func == nullptr ||
         size <= remaining_batch_size) {
       // Either we don't allow task splitting or task fits within the current
@@ -767,13 +807,12 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
       // Beyond this point Schedule should not fail, as the caller has been
       // promised that all of the split tasks will be scheduled.
       TF_RETURN_IF_ERROR(options_.split_input_task_func(
-          task, remaining_batch_size, options_.max_batch_size,
-          &tasks_to_schedule));
+          task, remaining_batch_size, max_batch_size, &tasks_to_schedule));
     }
     for (auto& task : tasks_to_schedule) {
       // Can't fit within current batch, close it off and try to create another.
       if (current_batch_ &&
-          current_batch_->size() + task->size() > options_.max_batch_size) {
+          current_batch_->size() + task->size() > max_batch_size) {
         current_batch_->Close();
         closed_batch = true;
         current_batch_ = nullptr;
@@ -786,7 +825,8 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
         // are processed in the same batch and should share traceme_context_id.
         current_batch_ = new ASBSBatch<TaskType>(
             this, scheduler_->GetEnv()->NowMicros(),
-            options_.batch_timeout_micros, NewTraceMeContextIdForBatch());
+            options_.batch_timeout_micros, NewTraceMeContextIdForBatch(),
+            options_.batch_cost_model);
         new_batches.push_back(current_batch_);
       }
 
@@ -806,8 +846,7 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
       bool reached_max_tasks =
           (options_.max_tasks_per_batch.has_value() &&
            current_batch_->num_tasks() >= options_.max_tasks_per_batch.value());
-      if (current_batch_->size() == options_.max_batch_size ||
-          reached_max_tasks) {
+      if (current_batch_->size() >= max_batch_size || reached_max_tasks) {
         current_batch_->Close();
         closed_batch = true;
         current_batch_ = nullptr;
@@ -15,6 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/batching_util/adaptive_shared_batch_scheduler.h"
 
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/kernels/batching_util/batch_cost_model.h"
 #include "tensorflow/core/kernels/batching_util/fake_clock_env.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -517,6 +521,48 @@ TEST(AdaptiveSharedBatchSchedulerTest, MaxTasksPerBatch) {
     if (processed_batches == 3) break;
   }
 }
+
+TEST(AdaptiveSharedBatchSchedulerTest, BatchCostModel) {
+  auto cost_model = std::make_shared<BatchCostModel>([] {
+    BatchCostModel::Options options;
+    options.allowed_batch_sizes = {2, 4, 8};
+    options.latency_target_micros = 1000;
+    return options;
+  }());
+  // Batches of size 4 have the most goodput under the latency target.
+  cost_model->RecordBatch(2, 2, 400);
+  cost_model->RecordBatch(4, 4, 600);
+  cost_model->RecordBatch(8, 8, 1400);
+
+  mutex mu;
+  std::vector<int> batch_sizes;
+  auto queue_callback = [&mu,
+                         &batch_sizes](std::unique_ptr<Batch<FakeTask>> batch) {
+    ASSERT_TRUE(batch->IsClosed());
+    mutex_lock l(mu);
+    batch_sizes.push_back(batch->size());
+  };
+  std::shared_ptr<AdaptiveSharedBatchScheduler<FakeTask>> scheduler;
+  TF_ASSERT_OK(AdaptiveSharedBatchScheduler<FakeTask>::Create({}, &scheduler));
+  AdaptiveSharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+  queue_options.max_batch_size = 10;
+  // Batches are only processed once they are closed.
+  queue_options.batch_timeout_micros = 1000 * 1000 * 1000;
+  queue_options.batch_cost_model = cost_model;
+  {
+    std::unique_ptr<BatchScheduler<FakeTask>> queue;
+    TF_ASSERT_OK(scheduler->AddQueue(queue_options, queue_callback, &queue));
+    for (int i = 0; i < 8; ++i) {
+      TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    }
+  }
+  // Waits for the batches to be processed.
+  scheduler.reset();
+  mutex_lock l(mu);
+  EXPECT_EQ(batch_sizes, std::vector<int>({4, 4}));
+  EXPECT_EQ(cost_model->Curve()[1].num_observations, 3);
+}
+
 }  // namespace anonymous
 }  // namespace serving
 }  // namespace tensorflow
@@ -0,0 +1,198 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/batch_cost_model.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace serving {
+
+BatchCostModel::BatchCostModel(const Options& options) : options_(options) {
+  DCHECK(std::is_sorted(options_.allowed_batch_sizes.begin(),
+                        options_.allowed_batch_sizes.end()));
+  DCHECK_GT(options_.smoothing, 0);
+  DCHECK_LE(options_.smoothing, 1);
+}
+
+void BatchCostModel::RecordBatch(int batch_size, int padded_batch_size,
+                                 int64_t processing_micros) {
+  if (batch_size <= 0 || padded_batch_size < batch_size ||
+      processing_micros < 0) {
+    return;
+  }
+  mutex_lock l(mu_);
+  Observation& observation = observations_[padded_batch_size];
+  if (observation.count == 0) {
+    observation.latency_micros = processing_micros;
+  } else {
+    observation.latency_micros =
+        options_.smoothing * processing_micros +
+        (1 - options_.smoothing) * observation.latency_micros;
+  }
+  ++observation.count;
+  Refit();
+}
+
+void BatchCostModel::Refit() {
+  const double n = observations_.size();
+  double sum_size = 0, sum_latency = 0, sum_size_squared = 0,
+         sum_size_latency = 0;
+  for (const auto& [size, observation] : observations_) {
+    sum_size += size;
+    sum_latency += observation.latency_micros;
+    sum_size_squared += static_cast<double>(size) * size;
+    sum_size_latency += size * observation.latency_micros;
+  }
+  const double denominator = n * sum_size_squared - sum_size * sum_size;
+  if (observations_.size() < 2 || denominator == 0) {
+    intercept_micros_.reset();
+    slope_micros_ = 0;
+    return;
+  }
+  slope_micros_ = (n * sum_size_latency - sum_size * sum_latency) / denominator;
+  intercept_micros_ = (sum_latency - slope_micros_ * sum_size) / n;
+}
+
+std::optional<double> BatchCostModel::PredictLatencyMicros(
+    int padded_batch_size) const {
+  tf_shared_lock l(mu_);
+  return PredictLatencyMicrosLocked(padded_batch_size);
+}
+
+std::optional<double> BatchCostModel::PredictLatencyMicrosLocked(
+    int padded_batch_size) const {
+  auto it = observations_.find(padded_batch_size);
+  if (it != observations_.end()) {
+    return it->second.latency_micros;
+  }
+  if (!intercept_micros_.has_value()) {
+    return std::nullopt;
+  }
+  return std::max(0.0, *intercept_micros_ + slope_micros_ * padded_batch_size);
+}
+
+int BatchCostModel::PaddedBatchSize(int batch_size) const {
+  tf_shared_lock l(mu_);
+  return PaddedBatchSizeLocked(batch_size);
+}
+
+int BatchCostModel::PaddedBatchSizeLocked(int batch_size) const {
+  auto it = std::lower_bound(options_.allowed_batch_sizes.begin(),
+                             options_.allowed_batch_sizes.end(), batch_size);
+  if (it == options_.allowed_batch_sizes.end()) {
+    return batch_size;
+  }
+  int best_size = *it;
+  std::optional<double> best_latency = PredictLatencyMicrosLocked(best_size);
+  if (!best_latency.has_value()) {
+    return best_size;
+  }
+  // Larger buckets are only worth padding to if they are faster, e.g. because
+  // the model is better optimized for them.
+  for (++it; it != options_.allowed_batch_sizes.end(); ++it) {
+    std::optional<double> latency = PredictLatencyMicrosLocked(*it);
+    if (latency.has_value() && *latency < *best_latency) {
+      best_size = *it;
+      best_latency = latency;
+    }
+  }
+  return best_size;
+}
+
+int BatchCostModel::ChooseBatchSize(int max_batch_size) const {
+  tf_shared_lock l(mu_);
+  if (!intercept_micros_.has_value()) {
+    return max_batch_size;
+  }
+  std::set<int> candidates = {max_batch_size};
+  if (options_.allowed_batch_sizes.empty()) {
+    for (const auto& [size, observation] : observations_) {
+      if (size <= max_batch_size) candidates.insert(size);
+    }
+  } else {
+    for (int size : options_.allowed_batch_sizes) {
+      if (size <= max_batch_size) candidates.insert(size);
+    }
+  }
+
+  std::optional<int> best_size;
+  double best_goodput = 0;
+  for (int size : candidates) {
+    std::optional<double> latency =
+        PredictLatencyMicrosLocked(PaddedBatchSizeLocked(size));
+    if (!latency.has_value()) continue;
+    if (options_.latency_target_micros > 0 &&
+        *latency > options_.latency_target_micros) {
+      continue;
+    }
+    const double goodput = size / std::max(*latency, 1.0);
+    if (!best_size.has_value() || goodput > best_goodput) {
+      best_size = size;
+      best_goodput = goodput;
+    }
+  }
+  return best_size.value_or(*candidates.begin());
+}
+
+std::vector<BatchCostModel::CurvePoint> BatchCostModel::Curve() const {
+  tf_shared_lock l(mu_);
+  std::set<int> sizes(options_.allowed_batch_sizes.begin(),
+                      options_.allowed_batch_sizes.end());
+  for (const auto& [size, observation] : observations_) {
+    sizes.insert(size);
+  }
+  std::vector<CurvePoint> curve;
+  for (int size : sizes) {
+    std::optional<double> latency = PredictLatencyMicrosLocked(size);
+    if (!latency.has_value()) continue;
+    CurvePoint point;
+    point.padded_batch_size = size;
+    point.latency_micros = *latency;
+    auto it = observations_.find(size);
+    point.num_observations =
+        it == observations_.end() ? 0 : it->second.count;
+    curve.push_back(point);
+  }
+  return curve;
+}
+
+std::string BatchCostModel::DebugString() const {
+  std::string result;
+  for (const CurvePoint& point : Curve()) {
+    absl::StrAppendFormat(&result, "padded_batch_size=%d latency=%.1fus",
+                          point.padded_batch_size, point.latency_micros);
+    if (point.num_observations == 0) {
+      absl::StrAppend(&result, " (extrapolated)\n");
+    } else {
+      absl::StrAppendFormat(&result, " (%d observations)\n",
+                            point.num_observations);
+    }
+  }
+  return result;
+}
+
+}  // namespace serving
+}  // namespace tensorflow
@@ -0,0 +1,132 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_COST_MODEL_H_
+#define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_COST_MODEL_H_
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace serving {
+
+// Learns how long a model takes to process a batch, as a function of the size
+// the batch is padded to, from the batches it observes. The cost of a batch is
+// dominated by its padded size, since padding elements are computed like real
+// ones; the number of real elements determines how much of that work is
+// useful.
+//
+// The latency of each padded size is an exponential moving average of its
+// observed processing times. Padded sizes that were not observed yet are
+// predicted with a least squares line through the observed ones.
+//
+// The model chooses the batch size with the highest goodput (real elements
+// processed per second) whose predicted latency meets the latency target, and
+// the bucket of `allowed_batch_sizes` to pad a batch to.
+//
+// BatchCostModel is thread-safe.
+class BatchCostModel {
+ public:
+  struct Options {
+    // The batch sizes batches are padded to. If empty, batches are not padded.
+    // Must be sorted in increasing order.
+    std::vector<int32> allowed_batch_sizes;
+
+    // The maximum processing latency of a batch, in microseconds. If zero, the
+    // latency is not bounded.
+    int64_t latency_target_micros = 0;
+
+    // The weight of the latest observation in the moving average of the
+    // latency of a padded size, in (0, 1].
+    double smoothing = 0.2;
+  };
+
+  // A point of the fitted latency curve.
+  struct CurvePoint {
+    int padded_batch_size = 0;
+    // Predicted processing latency of a batch of `padded_batch_size`.
+    double latency_micros = 0;
+    // The number of batches of `padded_batch_size` that were observed. When
+    // zero, `latency_micros` is extrapolated from other sizes.
+    int64_t num_observations = 0;
+  };
+
+  explicit BatchCostModel(const Options& options);
+
+  // Records that a batch of `batch_size` real elements, padded to
+  // `padded_batch_size`, took `processing_micros` to process.
+  void RecordBatch(int batch_size, int padded_batch_size,
+                   int64_t processing_micros) TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the predicted latency of a batch padded to `padded_batch_size`, or
+  // nullopt if there are not enough observations to predict it.
+  std::optional<double> PredictLatencyMicros(int padded_batch_size) const
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the size to pad a batch of `batch_size` to: the allowed batch size
+  // of at least `batch_size` with the lowest predicted latency, which is the
+  // smallest one unless the model has learned otherwise. Returns `batch_size`
+  // if no allowed batch size is large enough.
+  int PaddedBatchSize(int batch_size) const TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the batch size up to `max_batch_size` with the highest predicted
+  // goodput among those predicted to meet the latency target. Only allowed
+  // batch sizes are considered, so that full batches need no padding. Returns
+  // `max_batch_size` until the model can predict latencies, and the smallest
+  // candidate if none meets the target.
+  int ChooseBatchSize(int max_batch_size) const TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the fitted curve at the allowed batch sizes and the observed padded
+  // sizes, in increasing order of padded size.
+  std::vector<CurvePoint> Curve() const TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns a human-readable description of `Curve()`.
+  std::string DebugString() const TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  struct Observation {
+    double latency_micros = 0;
+    int64_t count = 0;
+  };
+
+  std::optional<double> PredictLatencyMicrosLocked(int padded_batch_size) const
+      TF_SHARED_LOCKS_REQUIRED(mu_);
+  int PaddedBatchSizeLocked(int batch_size) const
+      TF_SHARED_LOCKS_REQUIRED(mu_);
+  // Refits `intercept_micros_` and `slope_micros_` to `observations_`.
+  void Refit() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const Options options_;
+
+  mutable mutex mu_;
+  // Map from padded batch size to its observed latency.
+  std::map<int, Observation> observations_ TF_GUARDED_BY(mu_);
+  // The least squares line through `observations_`, if there are at least two
+  // observed sizes.
+  std::optional<double> intercept_micros_ TF_GUARDED_BY(mu_);
+  double slope_micros_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_COST_MODEL_H_
@@ -0,0 +1,118 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/batch_cost_model.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+using ::testing::DoubleNear;
+using ::testing::HasSubstr;
+using ::testing::Optional;
+
+BatchCostModel::Options TestOptions(int64_t latency_target_micros = 0) {
+  BatchCostModel::Options options;
+  options.allowed_batch_sizes = {2, 4, 8};
+  options.latency_target_micros = latency_target_micros;
+  return options;
+}
+
+TEST(BatchCostModelTest, NoObservations) {
+  BatchCostModel model(TestOptions());
+  EXPECT_EQ(model.PredictLatencyMicros(4), std::nullopt);
+  EXPECT_EQ(model.ChooseBatchSize(16), 16);
+  EXPECT_EQ(model.PaddedBatchSize(3), 4);
+  EXPECT_EQ(model.PaddedBatchSize(9), 9);
+  EXPECT_TRUE(model.Curve().empty());
+}
+
+TEST(BatchCostModelTest, FitsLine) {
+  BatchCostModel model(TestOptions());
+  model.RecordBatch(/*batch_size=*/1, /*padded_batch_size=*/2, 300);
+  model.RecordBatch(/*batch_size=*/3, /*padded_batch_size=*/4, 500);
+  EXPECT_THAT(model.PredictLatencyMicros(2), Optional(300));
+  EXPECT_THAT(model.PredictLatencyMicros(8), Optional(DoubleNear(900, 1e-6)));
+
+  std::vector<BatchCostModel::CurvePoint> curve = model.Curve();
+  ASSERT_EQ(curve.size(), 3);
+  EXPECT_EQ(curve[0].padded_batch_size, 2);
+  EXPECT_EQ(curve[0].num_observations, 1);
+  EXPECT_EQ(curve[2].padded_batch_size, 8);
+  EXPECT_EQ(curve[2].num_observations, 0);
+  EXPECT_THAT(model.DebugString(),
+              HasSubstr("padded_batch_size=8 latency=900.0us (extrapolated)"));
+}
+
+TEST(BatchCostModelTest, SmoothsObservations) {
+  BatchCostModel::Options options = TestOptions();
+  options.smoothing = 0.5;
+  BatchCostModel model(options);
+  model.RecordBatch(2, 2, 100);
+  model.RecordBatch(2, 2, 200);
+  EXPECT_THAT(model.PredictLatencyMicros(2), Optional(150));
+}
+
+TEST(BatchCostModelTest, ChoosesBatchSizeUnderLatencyTarget) {
+  BatchCostModel model(TestOptions(/*latency_target_micros=*/1000));
+  model.RecordBatch(2, 2, 400);
+  model.RecordBatch(4, 4, 600);
+  model.RecordBatch(8, 8, 1400);
+  // Batches of 8 and 10 are too slow, and 4 has more goodput than 2.
+  EXPECT_EQ(model.ChooseBatchSize(10), 4);
+  EXPECT_EQ(model.ChooseBatchSize(3), 2);
+}
+
+TEST(BatchCostModelTest, ChoosesBatchSizeWithoutLatencyTarget) {
+  BatchCostModel model(TestOptions());
+  model.RecordBatch(2, 2, 400);
+  model.RecordBatch(4, 4, 600);
+  model.RecordBatch(8, 8, 1400);
+  EXPECT_EQ(model.ChooseBatchSize(10), 10);
+}
+
+TEST(BatchCostModelTest, NoBatchSizeMeetsLatencyTarget) {
+  BatchCostModel model(TestOptions(/*latency_target_micros=*/100));
+  model.RecordBatch(2, 2, 400);
+  model.RecordBatch(4, 4, 600);
+  EXPECT_EQ(model.ChooseBatchSize(8), 2);
+}
+
+TEST(BatchCostModelTest, PadsToFasterBucket) {
+  BatchCostModel model(TestOptions());
+  model.RecordBatch(4, 4, 900);
+  model.RecordBatch(8, 8, 500);
+  EXPECT_EQ(model.PaddedBatchSize(3), 8);
+  EXPECT_EQ(model.PaddedBatchSize(1), 8);
+}
+
+TEST(BatchCostModelTest, IgnoresInvalidObservations) {
+  BatchCostModel model(TestOptions());
+  model.RecordBatch(0, 2, 100);
+  model.RecordBatch(4, 2, 100);
+  model.RecordBatch(2, 2, -1);
+  EXPECT_TRUE(model.Curve().empty());
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
@@ -0,0 +1,176 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/batch_input_staging.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/batch_util.h"
+
+namespace tensorflow {
+namespace serving {
+
+bool BatchInputStaging::Buffer::IsCompatible(
+    absl::Span<const Tensor> inputs) const {
+  if (inputs.size() != tensors_.size()) {
+    return false;
+  }
+  for (int i = 0; i < inputs.size(); ++i) {
+    if (inputs[i].dtype() != tensors_[i].dtype() ||
+        inputs[i].dims() != tensors_[i].dims()) {
+      return false;
+    }
+    for (int dim = 1; dim < inputs[i].dims(); ++dim) {
+      if (inputs[i].dim_size(dim) != tensors_[i].dim_size(dim)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+BatchInputStaging::BatchInputStaging(Allocator* allocator, int64_t capacity)
+    : allocator_(allocator), capacity_(capacity) {
+  DCHECK(allocator_ != nullptr);
+  DCHECK_GT(capacity_, 0);
+}
+
+std::optional<BatchInputStaging::Slot> BatchInputStaging::Stage(
+    absl::Span<const Tensor> inputs) {
+  if (inputs.empty() || inputs[0].dims() == 0) {
+    return std::nullopt;
+  }
+  const int64_t size = inputs[0].dim_size(0);
+  if (size <= 0 || size > capacity_) {
+    return std::nullopt;
+  }
+  for (const Tensor& input : inputs) {
+    if (!DataTypeCanUseMemcpy(input.dtype()) || input.dims() == 0 ||
+        input.dim_size(0) != size) {
+      return std::nullopt;
+    }
+  }
+
+  Slot slot;
+  slot.size = size;
+  {
+    mutex_lock l(mu_);
+    if (buffer_ != nullptr && buffer_->IsCompatible(inputs)) {
+      mutex_lock buffer_lock(buffer_->mu_);
+      if (buffer_->next_row_ + size <= buffer_->capacity_) {
+        slot.buffer = buffer_;
+        slot.offset = buffer_->next_row_;
+        buffer_->next_row_ += size;
+      }
+    }
+    if (slot.buffer == nullptr) {
+      std::vector<Tensor> tensors;
+      tensors.reserve(inputs.size());
+      for (const Tensor& input : inputs) {
+        TensorShape shape = input.shape();
+        shape.set_dim(0, capacity_);
+        Tensor tensor(allocator_, input.dtype(), shape);
+        if (!tensor.IsInitialized()) {
+          return std::nullopt;
+        }
+        tensors.push_back(std::move(tensor));
+      }
+      buffer_ = std::make_shared<Buffer>(std::move(tensors), capacity_);
+      mutex_lock buffer_lock(buffer_->mu_);
+      buffer_->next_row_ = size;
+      slot.buffer = buffer_;
+    }
+  }
+
+  // The rows are reserved, so the copies can run concurrently with other
+  // tasks being staged.
+  for (int i = 0; i < inputs.size(); ++i) {
+    Tensor staged = slot.buffer->tensors_[i];
+    if (!batch_util::CopyContiguousSlices(inputs[i], /*src_offset=*/0,
+                                          slot.offset, size, &staged)
+             .ok()) {
+      return std::nullopt;
+    }
+  }
+  return slot;
+}
+
+/*static*/ bool BatchInputStaging::Assemble(
+    absl::Span<const Slot* const> slots, int64_t padded_batch_size,
+    std::vector<Tensor>* batch) {
+  if (slots.empty() || slots[0] == nullptr) {
+    return false;
+  }
+  const std::shared_ptr<Buffer>& buffer = slots[0]->buffer;
+  const int64_t begin = slots[0]->offset;
+  int64_t end = begin;
+  for (const Slot* slot : slots) {
+    if (slot == nullptr || slot->buffer != buffer || slot->offset != end) {
+      return false;
+    }
+    end += slot->size;
+  }
+  const int64_t padded_end = begin + padded_batch_size;
+  if (padded_end < end || padded_end > buffer->capacity_) {
+    return false;
+  }
+
+  std::vector<Tensor> slices;
+  slices.reserve(buffer->tensors_.size());
+  for (const Tensor& tensor : buffer->tensors_) {
+    Tensor slice = tensor.Slice(begin, padded_end);
+    // Kernels may require aligned inputs, so unaligned slices are
+    // concatenated instead.
+    if (!slice.IsAligned()) {
+      return false;
+    }
+    slices.push_back(std::move(slice));
+  }
+
+  if (padded_end > end) {
+    // Padding rows are only free if no task was staged after the batch.
+    mutex_lock l(buffer->mu_);
+    if (buffer->next_row_ != end) {
+      return false;
+    }
+    buffer->next_row_ = padded_end;
+  }
+  for (int i = 0; i < buffer->tensors_.size(); ++i) {
+    Tensor tensor = buffer->tensors_[i];
+    for (int64_t row = end; row < padded_end; ++row) {
+      if (!batch_util::CopyContiguousSlices(tensor, begin, row,
+                                            /*num_slices=*/1, &tensor)
+               .ok()) {
+        return false;
+      }
+    }
+  }
+  *batch = std::move(slices);
+  return true;
+}
+
+}  // namespace serving
+}  // namespace tensorflow
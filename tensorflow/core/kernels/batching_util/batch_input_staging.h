@@ -0,0 +1,108 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_INPUT_STAGING_H_
+#define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_INPUT_STAGING_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace serving {
+
+// Assembles batches in place: the inputs of each task are copied into
+// preallocated staging tensors when the task is enqueued, so that a closed
+// batch whose tasks were staged back to back is a slice of the staging tensors
+// instead of a concatenation of its tasks.
+//
+// Rows are handed out in enqueue order from a staging buffer of `capacity`
+// rows, and a new buffer is allocated once a task does not fit in the current
+// one. Batches that do not occupy contiguous rows of a single buffer, e.g.
+// because tasks were reordered by priority or split, are not assembled and
+// must be concatenated by the caller. So are batches that would start at a
+// row that is not aligned for Eigen, which is never the case for rows whose
+// size is a multiple of the alignment, e.g. 16 floats.
+//
+// BatchInputStaging is thread-safe.
+class BatchInputStaging {
+ public:
+  class Buffer;
+
+  // The rows of a staging buffer that hold the inputs of one task.
+  struct Slot {
+    std::shared_ptr<Buffer> buffer;
+    int64_t offset = 0;
+    int64_t size = 0;
+  };
+
+  // `allocator` allocates the staging tensors, e.g. in pinned host memory so
+  // that batches can be copied to devices directly. It must outlive this
+  // object.
+  BatchInputStaging(Allocator* allocator, int64_t capacity);
+
+  // Copies `inputs`, which must all have the same 0th-dimension size, into the
+  // next rows of the staging buffer. Returns nullopt if the inputs cannot be
+  // staged, e.g. because they are larger than the capacity or their dtypes
+  // cannot be copied with memcpy.
+  std::optional<Slot> Stage(absl::Span<const Tensor> inputs)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the inputs of a batch made of the tasks staged in `slots`, in
+  // order, padded to `padded_batch_size` rows with copies of the first row.
+  // Returns false if the slots are not contiguous rows of one buffer, or the
+  // rows needed for padding are already used by other tasks.
+  static bool Assemble(absl::Span<const Slot* const> slots,
+                       int64_t padded_batch_size, std::vector<Tensor>* batch);
+
+ private:
+  Allocator* const allocator_;
+  const int64_t capacity_;
+
+  mutex mu_;
+  std::shared_ptr<Buffer> buffer_ TF_GUARDED_BY(mu_);
+};
+
+class BatchInputStaging::Buffer {
+ public:
+  Buffer(std::vector<Tensor> tensors, int64_t capacity)
+      : tensors_(std::move(tensors)), capacity_(capacity) {}
+
+  // Returns true if inputs shaped like `inputs` can be staged in this buffer.
+  bool IsCompatible(absl::Span<const Tensor> inputs) const;
+
+ private:
+  friend class BatchInputStaging;
+
+  const std::vector<Tensor> tensors_;
+  const int64_t capacity_;
+
+  mutex mu_;
+  // The first row that is not used by a task or by padding.
+  int64_t next_row_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_INPUT_STAGING_H_
@@ -0,0 +1,159 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/batch_input_staging.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+// Rows of 16 floats, so that every row is aligned.
+constexpr int64_t kRowSize = 16;
+
+// Returns a tensor of `rows` rows, where row `i` is filled with `first + i`.
+Tensor MakeInput(int64_t rows, float first) {
+  std::vector<float> values;
+  for (int64_t row = 0; row < rows; ++row) {
+    values.insert(values.end(), kRowSize, first + row);
+  }
+  return test::AsTensor<float>(values, TensorShape({rows, kRowSize}));
+}
+
+TEST(BatchInputStagingTest, AssemblesContiguousTasks) {
+  BatchInputStaging staging(cpu_allocator(), /*capacity=*/8);
+  std::optional<BatchInputStaging::Slot> first =
+      staging.Stage({MakeInput(2, 1)});
+  std::optional<BatchInputStaging::Slot> second =
+      staging.Stage({MakeInput(1, 3)});
+  ASSERT_TRUE(first.has_value());
+  ASSERT_TRUE(second.has_value());
+  EXPECT_EQ(first->offset, 0);
+  EXPECT_EQ(second->offset, 2);
+
+  std::vector<Tensor> batch;
+  ASSERT_TRUE(BatchInputStaging::Assemble({&*first, &*second},
+                                          /*padded_batch_size=*/3, &batch));
+  ASSERT_EQ(batch.size(), 1);
+  test::ExpectEqual(batch[0], MakeInput(3, 1));
+}
+
+TEST(BatchInputStagingTest, PadsWithFirstRow) {
+  BatchInputStaging staging(cpu_allocator(), /*capacity=*/8);
+  std::optional<BatchInputStaging::Slot> slot =
+      staging.Stage({MakeInput(2, 5)});
+  ASSERT_TRUE(slot.has_value());
+
+  std::vector<Tensor> batch;
+  ASSERT_TRUE(BatchInputStaging::Assemble({&*slot}, /*padded_batch_size=*/4,
+                                          &batch));
+  std::vector<float> expected;
+  for (float value : {5, 6, 5, 5}) {
+    expected.insert(expected.end(), kRowSize, value);
+  }
+  test::ExpectEqual(
+      batch[0], test::AsTensor<float>(expected, TensorShape({4, kRowSize})));
+
+  // The padding rows are not handed out to later tasks.
+  std::optional<BatchInputStaging::Slot> next =
+      staging.Stage({MakeInput(1, 9)});
+  ASSERT_TRUE(next.has_value());
+  EXPECT_EQ(next->offset, 4);
+}
+
+TEST(BatchInputStagingTest, DoesNotPadOverLaterTasks) {
+  BatchInputStaging staging(cpu_allocator(), /*capacity=*/8);
+  std::optional<BatchInputStaging::Slot> first =
+      staging.Stage({MakeInput(1, 1)});
+  std::optional<BatchInputStaging::Slot> second =
+      staging.Stage({MakeInput(1, 2)});
+  ASSERT_TRUE(first.has_value());
+  ASSERT_TRUE(second.has_value());
+
+  std::vector<Tensor> batch;
+  EXPECT_FALSE(BatchInputStaging::Assemble({&*first}, /*padded_batch_size=*/2,
+                                           &batch));
+  ASSERT_TRUE(BatchInputStaging::Assemble({&*first}, /*padded_batch_size=*/1,
+                                          &batch));
+  test::ExpectEqual(batch[0], MakeInput(1, 1));
+}
+
+TEST(BatchInputStagingTest, DoesNotAssembleOutOfOrderTasks) {
+  BatchInputStaging staging(cpu_allocator(), /*capacity=*/8);
+  std::optional<BatchInputStaging::Slot> first =
+      staging.Stage({MakeInput(1, 1)});
+  std::optional<BatchInputStaging::Slot> second =
+      staging.Stage({MakeInput(1, 2)});
+  ASSERT_TRUE(first.has_value());
+  ASSERT_TRUE(second.has_value());
+
+  std::vector<Tensor> batch;
+  EXPECT_FALSE(BatchInputStaging::Assemble({&*second, &*first},
+                                           /*padded_batch_size=*/2, &batch));
+  EXPECT_FALSE(BatchInputStaging::Assemble({}, /*padded_batch_size=*/0,
+                                           &batch));
+}
+
+TEST(BatchInputStagingTest, StartsNewBufferWhenFull) {
+  BatchInputStaging staging(cpu_allocator(), /*capacity=*/4);
+  std::optional<BatchInputStaging::Slot> first =
+      staging.Stage({MakeInput(3, 1)});
+  std::optional<BatchInputStaging::Slot> second =
+      staging.Stage({MakeInput(2, 4)});
+  ASSERT_TRUE(first.has_value());
+  ASSERT_TRUE(second.has_value());
+  EXPECT_NE(first->buffer, second->buffer);
+  EXPECT_EQ(second->offset, 0);
+
+  std::vector<Tensor> batch;
+  EXPECT_FALSE(BatchInputStaging::Assemble({&*first, &*second},
+                                           /*padded_batch_size=*/5, &batch));
+  ASSERT_TRUE(BatchInputStaging::Assemble({&*second}, /*padded_batch_size=*/2,
+                                          &batch));
+  test::ExpectEqual(batch[0], MakeInput(2, 4));
+}
+
+TEST(BatchInputStagingTest, StartsNewBufferForOtherShapes) {
+  BatchInputStaging staging(cpu_allocator(), /*capacity=*/8);
+  std::optional<BatchInputStaging::Slot> first =
+      staging.Stage({MakeInput(1, 1)});
+  std::optional<BatchInputStaging::Slot> second =
+      staging.Stage({test::AsTensor<float>({1, 2}, TensorShape({1, 2}))});
+  ASSERT_TRUE(first.has_value());
+  ASSERT_TRUE(second.has_value());
+  EXPECT_NE(first->buffer, second->buffer);
+}
+
+TEST(BatchInputStagingTest, DoesNotStageUnsupportedInputs) {
+  BatchInputStaging staging(cpu_allocator(), /*capacity=*/2);
+  EXPECT_FALSE(staging.Stage({}).has_value());
+  EXPECT_FALSE(staging.Stage({MakeInput(3, 1)}).has_value());
+  EXPECT_FALSE(staging.Stage({test::AsTensor<tstring>({"a"})}).has_value());
+  EXPECT_FALSE(staging.Stage({MakeInput(1, 1), MakeInput(2, 1)}).has_value());
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
@@ -27,6 +27,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/fixed_array.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/functional/bind_front.h"
@@ -51,9 +52,12 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/kernels/batching_util/batch_input_staging.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
+#include "tensorflow/core/kernels/batching_util/batch_size_profile.h"
 #include "tensorflow/core/kernels/batching_util/concat_split_util.h"
 #include "tensorflow/core/kernels/batching_util/input_split_metadata.h"
+#include "tensorflow/core/kernels/batching_util/ragged_batch_layout.h"
 #include "tensorflow/core/kernels/batching_util/threadsafe_status.h"
 #include "tensorflow/core/kernels/batching_util/warmup.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
@@ -79,6 +83,10 @@ namespace tensorflow {
 namespace serving {
 namespace {
 
+// The number of maximally sized batches a staging buffer holds, so that
+// batches closed before they are full mostly do not straddle two buffers.
+constexpr int64_t kInputStagingBatchesPerBuffer = 4;
+
 // TODO(b/181883417): Replace with RecordPaddingSizeV2.
 void RecordPaddingSize(int32_t padding_size, const string& model_name,
                        int32_t execution_batch_size, const string& op_name) {
@@ -212,6 +220,37 @@ void RecordBatchDelayUsV2(int64_t batch_delay_us, const string& model_name,
       ->Add(static_cast<double>(batch_delay_us));
 }
 
+// Returns the label of the priority of the tasks in the metrics by priority.
+const char* PriorityLabel(bool is_low_priority) {
+  return is_low_priority ? "low" : "high";
+}
+
+void RecordBatchSizeByPriority(int32_t batch_size, const string& model_name,
+                               const string& op_name, bool is_low_priority) {
+  static auto* cell = tensorflow::monitoring::Sampler<3>::New(
+      {"/tensorflow/serving/batching/batch_size_by_priority",
+       "Tracks the number of inputs of each priority in processed batches by "
+       "model_name (if available).",
+       "model_name", "op_name", "priority"},
+      monitoring::Buckets::Exponential(1, 1.5, 20));
+  cell->GetCell(model_name, op_name, PriorityLabel(is_low_priority))
+      ->Add(static_cast<double>(batch_size));
+}
+
+void RecordBatchDelayUsByPriority(int64_t batch_delay_us,
+                                  const string& model_name,
+                                  const string& op_name,
+                                  bool is_low_priority) {
+  static auto* cell = tensorflow::monitoring::Sampler<3>::New(
+      {"/tensorflow/serving/batching/batch_delay_us_by_priority",
+       "Tracks the batching delay (in microseconds) for inputs of each "
+       "priority by model_name (if available).",
+       "model_name", "op_name", "priority"},
+      monitoring::Buckets::Exponential(1, 2, 27));
+  cell->GetCell(model_name, op_name, PriorityLabel(is_low_priority))
+      ->Add(static_cast<double>(batch_delay_us));
+}
+
 void RecordBatchParamBatchTimeoutMicros(int64_t batch_timeout_micros,
                                         const string& model_name,
                                         const string& op_name) {
@@ -306,6 +345,7 @@ BatchResourceBase::BatchTask::CreateSplitTask(
   task->start_time = this->start_time;
   task->request_cost = this->request_cost;
   task->forced_warmup_batch_size = this->forced_warmup_batch_size;
+  task->split_output_gatherer = this->split_output_gatherer;
 
   return task;
 }
@@ -339,16 +379,30 @@ Status BatchResourceBase::RegisterWarmupInputs(
     (*batch_task)->status = shared_status;
     return batch_task;
   };
+  std::vector<int32> warmup_batch_sizes = allowed_batch_sizes_;
+  const WarmupStateRegistry::PerModelData* warmup_state =
+      LookupWarmupState(context);
+  if (warmup_state != nullptr) {
+    const int64_t max_batch_size =
+        batcher_ ? batcher_queue_options_.max_execution_batch_size
+                 : adaptive_batcher_queue_options_.max_batch_size;
+    for (int32 batch_size : warmup_state->profiled_batch_sizes) {
+      if (batch_size > 0 && batch_size <= max_batch_size &&
+          !absl::c_linear_search(warmup_batch_sizes, batch_size)) {
+        warmup_batch_sizes.push_back(batch_size);
+      }
+    }
+  }
   auto warmup_counter =
-      std::make_shared<absl::BlockingCounter>(allowed_batch_sizes_.size());
+      std::make_shared<absl::BlockingCounter>(warmup_batch_sizes.size());
   // Enqueue warmup batches.
-  for (int i = 0; i < allowed_batch_sizes_.size(); ++i) {
+  for (int i = 0; i < warmup_batch_sizes.size(); ++i) {
     Status status = RegisterInput(
         guid, context, batcher_queue_name, create_batch_task_fn_share_status,
         [warmup_counter = warmup_counter.get()]() {
           warmup_counter->DecrementCount();
         },
-        allowed_batch_sizes_[i]);
+        warmup_batch_sizes[i]);
     if (!status.ok()) return status;
   }
   // Enqueue real batch if the other batches were enqueued successfully.
@@ -472,6 +526,11 @@ Status BatchResourceBase::RegisterInput(
   BatcherQueueT* batcher_queue;
   TF_RETURN_IF_ERROR(
       LookupOrCreateBatcherQueue(batcher_queue_name, &batcher_queue));
+  if (enable_input_staging_ && forced_warmup_batch_size == 0) {
+    batch_components->staged_inputs =
+        LookupOrCreateInputStaging(batcher_queue_name, context)
+            ->Stage(batch_components->inputs);
+  }
 
   if (!session_metadata().name().empty()) {
     absl::MutexLock lock(&outstanding_batch_mu_);
@@ -513,7 +572,8 @@ BatchResourceBase::GetBatcherQueueOptions(
     int32_t low_priority_max_batch_size,
     int32_t low_priority_batch_timeout_micros,
     int32_t low_priority_max_enqueued_batches,
-    const std::vector<int32>& low_priority_allowed_batch_sizes) {
+    const std::vector<int32>& low_priority_allowed_batch_sizes,
+    MixedPriorityBatchingPolicy mixed_priority_batching_policy) {
   BatcherT::QueueOptions batcher_queue_options;
   batcher_queue_options.input_batch_size_limit = max_batch_size;
   batcher_queue_options.max_enqueued_batches = max_enqueued_batches;
@@ -542,6 +602,10 @@ BatchResourceBase::GetBatcherQueueOptions(
   }
   batcher_queue_options.low_priority_queue_options.allowed_batch_sizes =
       low_priority_allowed_batch_sizes;
+  batcher_queue_options.mixed_priority_batching_policy =
+      mixed_priority_batching_policy;
+  // The queue pads batches with low priority tasks up to allowed batch sizes.
+  batcher_queue_options.allowed_batch_sizes = allowed_batch_sizes;
   batcher_queue_options.enable_large_batch_splitting =
       enable_large_batch_splitting;
   if (enable_large_batch_splitting) {
@@ -635,7 +699,8 @@ int BatchResourceBase::RoundToLowestAllowedBatchSize(
                                   .allowed_batch_sizes
                             : allowed_batch_sizes_;
 
-  if (batcher_queue_options_.disable_padding || allowed_batch_sizes.empty()) {
+  if (batcher_queue_options_.disable_padding || IsRaggedBatching() ||
+      allowed_batch_sizes.empty()) {
     return batch_size;
   }
   for (int allowed_size : allowed_batch_sizes) {
@@ -688,10 +753,43 @@ Status BatchResourceBase::ConcatInputTensors(
                              context->op_kernel().name());
   RecordBatchSize(batch.size(), GetModelName(context),
                   context->op_kernel().name());
+  // Unbatched tasks are the low priority tasks that took padding slots.
+  const bool is_low_priority_batch = IsLowPriorityBatch(batch);
+  const int low_priority_size =
+      (is_low_priority_batch ? batch.size() : 0) + unbatched_tasks_size;
+  const int high_priority_size = is_low_priority_batch ? 0 : batch.size();
+  if (high_priority_size > 0) {
+    RecordBatchSizeByPriority(high_priority_size, GetModelName(context),
+                              context->op_kernel().name(),
+                              /*is_low_priority=*/false);
+  }
+  if (low_priority_size > 0) {
+    RecordBatchSizeByPriority(low_priority_size, GetModelName(context),
+                              context->op_kernel().name(),
+                              /*is_low_priority=*/true);
+  }
+
+  // Tasks staged back to back already form the batch in a staging tensor.
+  if (!just_for_warmup && unbatched_tasks.empty() && !IsRaggedBatching()) {
+    std::vector<const BatchInputStaging::Slot*> staged_slots;
+    staged_slots.reserve(batch.num_tasks());
+    for (int task_idx = 0; task_idx < batch.num_tasks(); ++task_idx) {
+      const auto& staged_inputs = batch.task(task_idx).staged_inputs;
+      if (!staged_inputs.has_value()) break;
+      staged_slots.push_back(&*staged_inputs);
+    }
+    if (staged_slots.size() == batch.num_tasks() &&
+        BatchInputStaging::Assemble(staged_slots, padded_batch_size,
+                                    concatenated_tensors)) {
+      return absl::OkStatus();
+    }
+  }
 
   // All tasks should have the same number of input edges.
   const int num_inputs = batch.task(0).inputs.size();
   concatenated_tensors->reserve(num_inputs);
+  // In ragged batching mode, the row splits of each input follow the values.
+  std::vector<Tensor> row_splits;
 
   // Process each input one at a time (the typical case has just one). When
   // `just_for_warmup` is true, the real data is not added. Otherwise, the real
@@ -733,12 +831,26 @@ Status BatchResourceBase::ConcatInputTensors(
       }
     }
 
+    if (IsRaggedBatching()) {
+      RaggedBatchLayout layout;
+      for (Tensor& component : to_concatenate) {
+        TF_RETURN_IF_ERROR(layout.Add(component.shape()));
+        Tensor values;
+        TF_RETURN_IF_ERROR(RaggedBatchLayout::Flatten(component, &values));
+        component = std::move(values);
+      }
+      row_splits.push_back(layout.RowSplits());
+    }
+
     Tensor concatenated_tensor;
     Status concat_status =
         Concat(context, to_concatenate, &concatenated_tensor);
     TF_RETURN_IF_ERROR(concat_status);
     concatenated_tensors->push_back(concatenated_tensor);
   }
+  concatenated_tensors->insert(concatenated_tensors->end(),
+                               std::make_move_iterator(row_splits.begin()),
+                               std::make_move_iterator(row_splits.end()));
   return absl::OkStatus();
 }
 
@@ -752,15 +864,44 @@ Status BatchResourceBase::ConcatInputTensors(
 
   std::shared_ptr<ThreadSafeStatus> shared_status = input_task.status;
 
+  const internal::InputSplitMetadata input_split_metadata(
+      input_task_size, open_batch_remaining_slot, max_batch_size);
+
+  const absl::FixedArray<int>& task_sizes = input_split_metadata.task_sizes();
+  const int num_batches = task_sizes.size();
+  std::vector<int64_t> output_task_sizes;
+  output_task_sizes.resize(num_batches);
+  for (int i = 0; i < num_batches; i++) {
+    output_task_sizes[i] = task_sizes[i];
+  }
+
+  // Splits gather their outputs into the kernel outputs in place. Warm-up
+  // tasks do not propagate outputs.
+  if (input_task.forced_warmup_batch_size == 0) {
+    OpKernelContext* context = input_task.context;
+    input_task.split_output_gatherer = std::make_shared<SplitOutputGatherer>(
+        context->num_outputs(), output_task_sizes,
+        [context](int output_index, const TensorShape& shape,
+                  Tensor** output) {
+          return context->allocate_output(output_index, shape, output);
+        });
+  }
+
   // `split_task_done_callback` runs only after all splitted tasks are
   // complete.
   std::function<void()> split_task_done_callback =
       [done_callback = input_task.done_callback, output = input_task.output,
        forced_warmup_batch_size = input_task.forced_warmup_batch_size,
        op_kernel_context = input_task.context,
+       split_output_gatherer = input_task.split_output_gatherer,
        status = shared_status]() mutable {
         const int num_output = op_kernel_context->num_outputs();
         for (int i = 0; i < num_output; ++i) {
+          if (split_output_gatherer != nullptr &&
+              split_output_gatherer->IsGathered(i)) {
+            // The splits were already copied into the kernel output.
+            continue;
+          }
           Tensor output_tensor;
 
           // Concat would memcpy each input tensor to one output tensor.
@@ -785,17 +926,6 @@ Status BatchResourceBase::ConcatInputTensors(
       };
   IncrementalBarrier barrier(split_task_done_callback);
 
-  const internal::InputSplitMetadata input_split_metadata(
-      input_task_size, open_batch_remaining_slot, max_batch_size);
-
-  const absl::FixedArray<int>& task_sizes = input_split_metadata.task_sizes();
-  const int num_batches = task_sizes.size();
-  std::vector<int64_t> output_task_sizes;
-  output_task_sizes.resize(num_batches);
-  for (int i = 0; i < num_batches; i++) {
-    output_task_sizes[i] = task_sizes[i];
-  }
-
   input_task.output->resize(num_batches);
   for (int i = 0; i < num_batches; ++i) {
     (*input_task.output)[i].resize(input_task.context->num_outputs());
@@ -874,6 +1004,20 @@ Status BatchResourceBase::SplitOutputTensors(
     return errors::Internal("Wrong number of batched output tensors");
   }
 
+  // In ragged batching mode, outputs are laid out like the first input.
+  std::optional<RaggedBatchLayout> ragged_layout;
+  if (IsRaggedBatching()) {
+    ragged_layout.emplace();
+    for (int i = 0; i < batch->num_tasks(); ++i) {
+      TF_RETURN_IF_ERROR(
+          ragged_layout->Add(batch->task(i).inputs.at(0).shape()));
+    }
+    for (int i = 0; i < unbatched_tasks.size(); ++i) {
+      TF_RETURN_IF_ERROR(
+          ragged_layout->Add(unbatched_tasks[i]->inputs.at(0).shape()));
+    }
+  }
+
   // Split each element of `combined_outputs` according to task sizes
   // within the batch, and use this to populate context outputs.
   for (int i = 0, iter_limit = combined_outputs.size(); i < iter_limit; ++i) {
@@ -882,21 +1026,24 @@ Status BatchResourceBase::SplitOutputTensors(
       return errors::FailedPrecondition(
           "Batched output tensor has 0 dimensions");
     }
-    if (output_tensor.shape().dim_size(0) !=
-        static_cast<int64_t>(batch->size() + unbatched_tasks_size +
-                             padding_size)) {
-      return errors::FailedPrecondition(
-          "Batched output tensor's 0th dimension does not equal the sum of "
-          "the 0th dimension sizes of the input tensors");
-    }
-
     std::vector<Tensor> split_tensor;
-    const Status split_status = tensor::Split(
-        output_tensor, task_sizes_plus_optional_padding, &split_tensor);
-    DCHECK(split_status.ok()) << split_status;
-    if (!split_status.ok()) {
-      return errors::Internal("Tensor split operation failed: ",
-                              split_status.message());
+    if (ragged_layout.has_value()) {
+      TF_RETURN_IF_ERROR(ragged_layout->Split(output_tensor, &split_tensor));
+    } else {
+      if (output_tensor.shape().dim_size(0) !=
+          static_cast<int64_t>(batch->size() + unbatched_tasks_size +
+                               padding_size)) {
+        return errors::FailedPrecondition(
+            "Batched output tensor's 0th dimension does not equal the sum of "
+            "the 0th dimension sizes of the input tensors");
+      }
+      const Status split_status = tensor::Split(
+          output_tensor, task_sizes_plus_optional_padding, &split_tensor);
+      DCHECK(split_status.ok()) << split_status;
+      if (!split_status.ok()) {
+        return errors::Internal("Tensor split operation failed: ",
+                                split_status.message());
+      }
     }
     DCHECK_EQ(split_tensor.size(), task_sizes_plus_optional_padding.size());
     if (split_tensor.size() != task_sizes_plus_optional_padding.size()) {
@@ -909,7 +1056,11 @@ Status BatchResourceBase::SplitOutputTensors(
     // Ignore a possible final split_tensors entry containing the padding.
     for (int j = 0; j < batch->num_tasks(); ++j) {
       BatchTask& task = *(batch->mutable_task(j));
-      if (task.is_partial) {
+      if (task.is_partial && task.split_output_gatherer != nullptr &&
+          !ragged_layout.has_value()) {
+        TF_RETURN_IF_ERROR(task.split_output_gatherer->Gather(
+            task.split_index, i, split_tensor[j]));
+      } else if (task.is_partial) {
         std::vector<Tensor>& tensor_vector = (*task.output)[task.split_index];
         tensor_vector[i] = std::move(split_tensor[j]);
       } else {
@@ -1022,12 +1173,35 @@ void BatchResourceBase::ProcessFuncBatch(
     RecordBatchDelayUsV2((current_time - batch->task(i).start_time) * 1e-3,
                          model_name, last_task_context->op_kernel().name(),
                          processed_size);
+    RecordBatchDelayUsByPriority(
+        (current_time - batch->task(i).start_time) * 1e-3, model_name,
+        last_task_context->op_kernel().name(), IsLowPriorityBatch(*batch));
+  }
+  for (const auto& unbatched_task : unbatched_tasks) {
+    RecordBatchDelayUsByPriority(
+        (current_time - unbatched_task->start_time) * 1e-3, model_name,
+        last_task_context->op_kernel().name(), /*is_low_priority=*/true);
+  }
+  // Warm-up batches profile the latency of the batch function.
+  std::shared_ptr<BatchSizeProfile> batch_size_profile;
+  if (last_task.forced_warmup_batch_size > 0) {
+    const WarmupStateRegistry::PerModelData* warmup_state =
+        LookupWarmupState(last_task_context);
+    if (warmup_state != nullptr) {
+      batch_size_profile = warmup_state->batch_size_profile;
+    }
   }
   // Releases the cleanup method here, because the callback of the function
   // library runtime will handle it now.
   finally.release();
   ProcessFuncBatchImpl(
       last_task, args, &combined_outputs, [&](const Status& run_status) {
+        if (batch_size_profile != nullptr && run_status.ok()) {
+          batch_size_profile->RecordLatency(
+              last_task_context->op_kernel().name(),
+              last_task.forced_warmup_batch_size,
+              absl::Nanoseconds(EnvTime::NowNanos() - current_time));
+        }
         Status final_status;
         auto run_finally = gtl::MakeCleanup([&]() {
           // We do the cleanup here as an optimization, so that
@@ -1204,6 +1378,24 @@ Status BatchResourceBase::LookupOrCreateBatcherQueue(const string& queue_name,
   return absl::OkStatus();
 }
 
+BatchInputStaging* BatchResourceBase::LookupOrCreateInputStaging(
+    const string& queue_name, OpKernelContext* context) {
+  mutex_lock l(batcher_queues_mu_);
+  std::unique_ptr<BatchInputStaging>& staging = input_stagings_[queue_name];
+  if (staging == nullptr) {
+    const int64_t max_batch_size =
+        batcher_ ? batcher_queue_options_.max_execution_batch_size
+                 : adaptive_batcher_queue_options_.max_batch_size;
+    AllocatorAttributes pinned_host;
+    pinned_host.set_on_host(true);
+    pinned_host.set_gpu_compatible(true);
+    staging = std::make_unique<BatchInputStaging>(
+        context->get_allocator(pinned_host),
+        kInputStagingBatchesPerBuffer * max_batch_size);
+  }
+  return staging.get();
+}
+
 void BatchResourceBase::SplitBatchCostsAndRecordMetrics(
     const std::string& model_name,
     const std::vector<std::unique_ptr<CostMeasurement>>&
@@ -1265,6 +1457,22 @@ void BatchResourceBase::SplitBatchCostsAndRecordMetrics(
     // Skip recording the metrics if the request_cost is null.
     if (!request_cost) continue;
 
+    // Input bytes are attributed exactly. The bytes of the paddings are
+    // assigned to the tasks in proportion to their sizes.
+    int64_t input_bytes = 0;
+    for (const Tensor& input : batch.task(i).inputs) {
+      input_bytes += input.TotalBytes();
+    }
+    const double input_bytes_with_smear =
+        batch.size() > 0 ? static_cast<double>(input_bytes) * processed_size /
+                               batch.size()
+                         : input_bytes;
+    request_cost->RecordMetrics(
+        {{absl::StrCat(kBatchInputBytesMetricName, kWithSmearSuffix),
+          input_bytes_with_smear},
+         {absl::StrCat(kBatchInputBytesMetricName, kNoSmearSuffix),
+          static_cast<double>(input_bytes)}});
+
     request_cost->RecordBatchMetrics(RequestCost::BatchMetrics{
         processed_size, static_cast<int64_t>(batch.task(i).size()),
         padding_size, batch_costs});
@@ -20,6 +20,7 @@ limitations under the License.
 #include <functional>
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -33,8 +34,11 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/kernels/batching_util/adaptive_shared_batch_scheduler.h"
+#include "tensorflow/core/kernels/batching_util/batch_input_staging.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
+#include "tensorflow/core/kernels/batching_util/ragged_batch_layout.h"
 #include "tensorflow/core/kernels/batching_util/shared_batch_scheduler.h"
+#include "tensorflow/core/kernels/batching_util/split_output_gatherer.h"
 #include "tensorflow/core/kernels/batching_util/threadsafe_status.h"
 #include "tensorflow/core/platform/context.h"
 #include "tensorflow/core/platform/status.h"
@@ -124,6 +128,17 @@ class BatchResourceBase : public ResourceBase {
     // batch is processed, but is not propagated to the kernel outputs.
     int forced_warmup_batch_size = 0;
 
+    // The rows of a staging buffer that `inputs` were copied into when this
+    // task was enqueued, if input staging is enabled. Split tasks are not
+    // staged.
+    std::optional<BatchInputStaging::Slot> staged_inputs;
+
+    // If set, the outputs of this split task are copied into the outputs of
+    // `context` as soon as its batch is processed, instead of being stored in
+    // `output` and concatenated once all splits are done. Shared by the splits
+    // of a task.
+    std::shared_ptr<SplitOutputGatherer> split_output_gatherer;
+
    protected:
     virtual std::unique_ptr<BatchTask> CreateDerivedTask() {
       return std::make_unique<BatchTask>();
@@ -169,6 +184,27 @@ class BatchResourceBase : public ResourceBase {
 
   const SessionMetadata& session_metadata() const { return session_metadata_; }
 
+  // If true, the inputs of each task are copied into a preallocated staging
+  // tensor of its queue, in pinned host memory, when the task is enqueued.
+  // Batches whose tasks were staged back to back are then slices of the
+  // staging tensor rather than concatenations of their tasks, which takes
+  // the copy off the batch processing path. Must be set before any input is
+  // registered.
+  void set_enable_input_staging(bool enable_input_staging) {
+    enable_input_staging_ = enable_input_staging;
+  }
+
+  // If true, each batch concatenates the inputs of its tasks along their
+  // first non-batch axis, so that requests of different lengths are batched
+  // without padding (see `RaggedBatchLayout`). The batch function receives
+  // the flattened values of each input, followed by one int64 row splits
+  // tensor per input. Batches are not padded to allowed batch sizes. Every
+  // output must be laid out like the values of the first input, and is split
+  // back by its row splits. Only supported with a batch function.
+  void set_enable_ragged_batching(bool enable_ragged_batching) {
+    enable_ragged_batching_ = enable_ragged_batching;
+  }
+
   using CreateBatchTaskFn =
       std::function<StatusOr<std::unique_ptr<BatchTask>>()>;
 
@@ -202,7 +238,9 @@ class BatchResourceBase : public ResourceBase {
       int32_t low_priority_max_batch_size,
       int32_t low_priority_batch_timeout_micros,
       int32_t low_priority_max_enqueued_batches,
-      const std::vector<int32>& low_priority_allowed_batch_sizes);
+      const std::vector<int32>& low_priority_allowed_batch_sizes,
+      MixedPriorityBatchingPolicy mixed_priority_batching_policy =
+          MixedPriorityBatchingPolicy::kLowPriorityPaddingWithMaxBatchSize);
 
   static AdaptiveBatcherT::QueueOptions GetAdaptiveBatcherQueueOptions(
       int32_t max_batch_size, int32_t batch_timeout_micros,
@@ -266,6 +304,11 @@ class BatchResourceBase : public ResourceBase {
   // Assumes the batch is non-empty.
   static Status ValidateBatch(const BatchT& batch);
 
+  // Returns true if batches are concatenated along their first non-batch axis.
+  bool IsRaggedBatching() const {
+    return enable_ragged_batching_ && has_process_batch_function_;
+  }
+
   // Returns a boolean indicating whether a batch is formed from low priority
   // tasks only or not.
   bool IsLowPriorityBatch(const BatchT& batch) const;
@@ -322,6 +365,11 @@ class BatchResourceBase : public ResourceBase {
   Status LookupOrCreateBatcherQueue(const string& queue_name,
                                     BatcherQueueT** queue);
 
+  // Looks up the input staging of 'queue_name', creating it with an allocator
+  // of 'context' if it didn't previously exist.
+  BatchInputStaging* LookupOrCreateInputStaging(const string& queue_name,
+                                                OpKernelContext* context);
+
   SessionMetadata session_metadata_;
 
   absl::Mutex outstanding_batch_mu_;
@@ -344,6 +392,12 @@ class BatchResourceBase : public ResourceBase {
   std::map<string, std::unique_ptr<BatcherQueueT>> batcher_queues_
       TF_GUARDED_BY(batcher_queues_mu_);
 
+  bool enable_input_staging_ = false;
+  bool enable_ragged_batching_ = false;
+  // The input staging of each batcher queue, keyed on queue name.
+  std::map<string, std::unique_ptr<BatchInputStaging>> input_stagings_
+      TF_GUARDED_BY(batcher_queues_mu_);
+
   std::vector<int32> allowed_batch_sizes_;
   // A concatenated string of <allowed_batch_sizes_>, separated by ",". This is
   // used to record batching parameter.
@@ -257,6 +257,26 @@ TEST(SplitBatchCostsAndRecordMetricsTest, SplitMultiCostTypes) {
                                Pair("test_gcu", absl::Milliseconds(200))))));
 }
 
+TEST(SplitBatchCostsAndRecordMetricsTest, SplitInputBytes) {
+  BatchResourceBase::BatchT batch;
+  RequestCost cost1, cost2;
+  batch.AddTask(MakeBatchTask(/*task_size=*/1, &cost1));
+  batch.AddTask(MakeBatchTask(/*task_size=*/9, &cost2));
+  batch.Close();
+
+  std::vector<std::unique_ptr<CostMeasurement>> batch_cost_measurements;
+  BatchResourceBase::SplitBatchCostsAndRecordMetrics(
+      "model_name", batch_cost_measurements, /*processed_size=*/20, batch);
+
+  // Each input row is a double, and half of the processed batch is padding.
+  EXPECT_THAT(batch.task(0).request_cost->GetMetrics(),
+              UnorderedElementsAre(Pair("batch_input_bytes_with_smear", 16),
+                                   Pair("batch_input_bytes_no_smear", 8)));
+  EXPECT_THAT(batch.task(1).request_cost->GetMetrics(),
+              UnorderedElementsAre(Pair("batch_input_bytes_with_smear", 144),
+                                   Pair("batch_input_bytes_no_smear", 72)));
+}
+
 TEST(SplitBatchCostsAndRecordMetricsTest, SplitOnlyNonZeroCostTypes) {
   BatchResourceBase::BatchT batch;
   RequestCost cost1, cost2;
@@ -51,6 +51,20 @@ limitations under the License.
 namespace tensorflow {
 namespace serving {
 
+// How the low priority tasks of a queue with a priority queue are mixed into
+// the batches of its high priority tasks.
+enum class MixedPriorityBatchingPolicy {
+  // Low priority tasks fill each batch up to the max execution batch size.
+  kLowPriorityPaddingWithMaxBatchSize,
+  // Low priority tasks only take the slots the batch would otherwise be padded
+  // with, up to the next allowed batch size, so that they never make the
+  // batch larger.
+  kLowPriorityPaddingWithNextAllowedBatchSize,
+  // Low priority tasks are never mixed into high priority batches, and are
+  // only processed in batches of their own.
+  kPriorityIsolation,
+};
+
 // The abstract superclass for a unit of work to be done as part of a batch.
 //
 // An implementing subclass typically contains (or points to):
@@ -75,6 +89,13 @@ class BatchTask {
   virtual tsl::criticality::Criticality criticality() const {
     return tsl::criticality::Criticality::kCritical;
   }
+
+  // Returns the time by which the task must be done processing, in the
+  // microseconds of the scheduler's Env::NowMicros(). It defaults to no
+  // deadline.
+  virtual std::optional<uint64> deadline_micros() const {
+    return std::nullopt;
+  }
 };
 
 // A thread-safe collection of BatchTasks. Tasks can be either added or removed
@@ -0,0 +1,266 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/batch_size_profile.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace serving {
+
+namespace {
+
+constexpr absl::string_view kLatencyRecord = "latency";
+constexpr absl::string_view kAllowedBatchSizesRecord = "allowed_batch_sizes";
+
+}  // namespace
+
+void BatchSizeProfile::RecordLatency(absl::string_view op_name,
+                                     int batch_size, absl::Duration latency) {
+  absl::MutexLock l(&mu_);
+  auto it = ops_.find(op_name);
+  if (it == ops_.end()) {
+    it = ops_.emplace(std::string(op_name), OpProfile()).first;
+  }
+  LatencyStats& stats = it->second.latencies[batch_size];
+  stats.total_latency_us += absl::ToDoubleMicroseconds(latency);
+  ++stats.num_batches;
+}
+
+std::map<int, absl::Duration> BatchSizeProfile::GetLatencies(
+    absl::string_view op_name) const {
+  absl::MutexLock l(&mu_);
+  std::map<int, absl::Duration> latencies;
+  auto it = ops_.find(op_name);
+  if (it == ops_.end()) return latencies;
+  for (const auto& [batch_size, stats] : it->second.latencies) {
+    latencies[batch_size] =
+        absl::Microseconds(stats.total_latency_us / stats.num_batches);
+  }
+  return latencies;
+}
+
+void BatchSizeProfile::SetAllowedBatchSizes(
+    absl::string_view op_name, std::vector<int32> allowed_batch_sizes) {
+  absl::MutexLock l(&mu_);
+  auto it = ops_.find(op_name);
+  if (it == ops_.end()) {
+    it = ops_.emplace(std::string(op_name), OpProfile()).first;
+  }
+  it->second.allowed_batch_sizes = std::move(allowed_batch_sizes);
+}
+
+std::optional<std::vector<int32>> BatchSizeProfile::GetAllowedBatchSizes(
+    absl::string_view op_name) const {
+  absl::MutexLock l(&mu_);
+  auto it = ops_.find(op_name);
+  if (it == ops_.end()) return std::nullopt;
+  return it->second.allowed_batch_sizes;
+}
+
+std::vector<std::string> BatchSizeProfile::GetOpNames() const {
+  absl::MutexLock l(&mu_);
+  std::vector<std::string> op_names;
+  op_names.reserve(ops_.size());
+  for (const auto& [op_name, op_profile] : ops_) {
+    op_names.push_back(op_name);
+  }
+  return op_names;
+}
+
+std::string BatchSizeProfile::SerializeAsString() const {
+  absl::MutexLock l(&mu_);
+  std::string serialized;
+  for (const auto& [op_name, op_profile] : ops_) {
+    for (const auto& [batch_size, stats] : op_profile.latencies) {
+      absl::StrAppend(&serialized, kLatencyRecord, "\t", op_name, "\t",
+                      batch_size, "\t", stats.total_latency_us, "\t",
+                      stats.num_batches, "\n");
+    }
+    if (op_profile.allowed_batch_sizes.has_value()) {
+      absl::StrAppend(&serialized, kAllowedBatchSizesRecord, "\t", op_name,
+                      "\t", absl::StrJoin(*op_profile.allowed_batch_sizes, ","),
+                      "\n");
+    }
+  }
+  return serialized;
+}
+
+/*static*/ absl::StatusOr<std::unique_ptr<BatchSizeProfile>>
+BatchSizeProfile::Parse(absl::string_view serialized) {
+  auto profile = std::make_unique<BatchSizeProfile>();
+  absl::MutexLock l(&profile->mu_);
+  for (absl::string_view line :
+       absl::StrSplit(serialized, '\n', absl::SkipEmpty())) {
+    std::vector<absl::string_view> fields = absl::StrSplit(line, '\t');
+    if (fields.size() == 5 && fields[0] == kLatencyRecord) {
+      int batch_size;
+      LatencyStats stats;
+      if (!absl::SimpleAtoi(fields[2], &batch_size) ||
+          !absl::SimpleAtod(fields[3], &stats.total_latency_us) ||
+          !absl::SimpleAtoi(fields[4], &stats.num_batches) ||
+          stats.num_batches <= 0) {
+        return errors::InvalidArgument("Malformed batch size profile line: ",
+                                       line);
+      }
+      profile->ops_[std::string(fields[1])].latencies[batch_size] = stats;
+    } else if (fields.size() == 3 && fields[0] == kAllowedBatchSizesRecord) {
+      std::vector<int32> allowed_batch_sizes;
+      for (absl::string_view field :
+           absl::StrSplit(fields[2], ',', absl::SkipEmpty())) {
+        int32 batch_size;
+        if (!absl::SimpleAtoi(field, &batch_size)) {
+          return errors::InvalidArgument(
+              "Malformed batch size profile line: ", line);
+        }
+        allowed_batch_sizes.push_back(batch_size);
+      }
+      profile->ops_[std::string(fields[1])].allowed_batch_sizes =
+          std::move(allowed_batch_sizes);
+    } else {
+      return errors::InvalidArgument("Malformed batch size profile line: ",
+                                     line);
+    }
+  }
+  return profile;
+}
+
+Status BatchSizeProfile::WriteToFile(Env* env, const std::string& path) const {
+  return WriteStringToFile(env, path, SerializeAsString());
+}
+
+/*static*/ absl::StatusOr<std::unique_ptr<BatchSizeProfile>>
+BatchSizeProfile::ReadFromFile(Env* env, const std::string& path) {
+  std::string serialized;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, path, &serialized));
+  return Parse(serialized);
+}
+
+absl::StatusOr<std::vector<int32>> ChooseAllowedBatchSizes(
+    const std::map<int, absl::Duration>& latencies,
+    absl::Span<const RequestSizeFrequency> request_sizes,
+    int max_num_batch_sizes, absl::Duration padding_cost_per_row) {
+  if (latencies.empty()) {
+    return errors::InvalidArgument("No batch size was profiled.");
+  }
+  if (max_num_batch_sizes <= 0) {
+    return errors::InvalidArgument(
+        "max_num_batch_sizes must be positive; was ", max_num_batch_sizes);
+  }
+  std::vector<int> candidates;
+  std::vector<double> candidate_latencies_us;
+  for (const auto& [batch_size, latency] : latencies) {
+    candidates.push_back(batch_size);
+    candidate_latencies_us.push_back(absl::ToDoubleMicroseconds(latency));
+  }
+  for (const RequestSizeFrequency& request_size : request_sizes) {
+    if (request_size.size <= 0 || request_size.frequency < 0) {
+      return errors::InvalidArgument("Invalid request size ", request_size.size,
+                                     " with frequency ",
+                                     request_size.frequency);
+    }
+    if (request_size.size > candidates.back()) {
+      return errors::InvalidArgument(
+          "Request size ", request_size.size,
+          " is larger than the largest profiled batch size ",
+          candidates.back());
+    }
+  }
+  const double padding_cost_per_row_us =
+      absl::ToDoubleMicroseconds(padding_cost_per_row);
+
+  // Returns the expected cost of the requests larger than candidate `lower`
+  // (or of all of them if `lower` is negative) and no larger than candidate
+  // `upper`, padded to candidate `upper`.
+  auto range_cost = [&](int lower, int upper) {
+    const int lower_size = lower < 0 ? 0 : candidates[lower];
+    double cost = 0;
+    for (const RequestSizeFrequency& request_size : request_sizes) {
+      if (request_size.size > lower_size &&
+          request_size.size <= candidates[upper]) {
+        cost += request_size.frequency *
+                (candidate_latencies_us[upper] +
+                 padding_cost_per_row_us *
+                     (candidates[upper] - request_size.size));
+      }
+    }
+    return cost;
+  };
+
+  // cost[k][j] is the expected cost of the requests no larger than candidate
+  // `j` with `k + 1` allowed batch sizes, the largest of which is candidate
+  // `j`; previous[k][j] is the candidate of the next smaller allowed batch
+  // size.
+  const int num_candidates = candidates.size();
+  const int max_num_sizes = std::min(max_num_batch_sizes, num_candidates);
+  constexpr double kInfinity = std::numeric_limits<double>::infinity();
+  std::vector<std::vector<double>> cost(
+      max_num_sizes, std::vector<double>(num_candidates, kInfinity));
+  std::vector<std::vector<int>> previous(
+      max_num_sizes, std::vector<int>(num_candidates, -1));
+  for (int j = 0; j < num_candidates; ++j) {
+    cost[0][j] = range_cost(-1, j);
+  }
+  for (int k = 1; k < max_num_sizes; ++k) {
+    for (int j = k; j < num_candidates; ++j) {
+      for (int i = k - 1; i < j; ++i) {
+        const double candidate_cost = cost[k - 1][i] + range_cost(i, j);
+        if (candidate_cost < cost[k][j]) {
+          cost[k][j] = candidate_cost;
+          previous[k][j] = i;
+        }
+      }
+    }
+  }
+
+  // Prefers fewer allowed batch sizes on ties.
+  int best_k = 0;
+  for (int k = 1; k < max_num_sizes; ++k) {
+    if (cost[k][num_candidates - 1] < cost[best_k][num_candidates - 1]) {
+      best_k = k;
+    }
+  }
+  std::vector<int32> allowed_batch_sizes;
+  for (int k = best_k, j = num_candidates - 1; k >= 0; --k) {
+    allowed_batch_sizes.push_back(candidates[j]);
+    j = previous[k][j];
+  }
+  std::reverse(allowed_batch_sizes.begin(), allowed_batch_sizes.end());
+  return allowed_batch_sizes;
+}
+
+}  // namespace serving
+}  // namespace tensorflow
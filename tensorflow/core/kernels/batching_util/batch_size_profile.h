@@ -0,0 +1,115 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_SIZE_PROFILE_H_
+#define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_SIZE_PROFILE_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace serving {
+
+// The latency of the batch function of each batch op across batch sizes, as
+// measured by warm-up batches, along with the allowed batch sizes chosen from
+// it. Profiles can be written to a file and read back on the next load of the
+// model, so that the warm-up does not need to profile again.
+//
+// The file is text, with one tab-separated record per line:
+//   latency <op name> <batch size> <total latency in us> <number of batches>
+//   allowed_batch_sizes <op name> <comma-separated batch sizes>
+//
+// BatchSizeProfile is thread-safe.
+class BatchSizeProfile {
+ public:
+  // Records that a batch of `batch_size` of the batch op `op_name` took
+  // `latency` to process.
+  void RecordLatency(absl::string_view op_name, int batch_size,
+                     absl::Duration latency);
+
+  // Returns the mean latency per batch size of the batch op `op_name`.
+  std::map<int, absl::Duration> GetLatencies(absl::string_view op_name) const;
+
+  void SetAllowedBatchSizes(absl::string_view op_name,
+                            std::vector<int32> allowed_batch_sizes);
+
+  // Returns the allowed batch sizes set for `op_name`, if any.
+  std::optional<std::vector<int32>> GetAllowedBatchSizes(
+      absl::string_view op_name) const;
+
+  // Returns the names of the batch ops in the profile, in order.
+  std::vector<std::string> GetOpNames() const;
+
+  std::string SerializeAsString() const;
+  static absl::StatusOr<std::unique_ptr<BatchSizeProfile>> Parse(
+      absl::string_view serialized);
+
+  Status WriteToFile(Env* env, const std::string& path) const;
+  static absl::StatusOr<std::unique_ptr<BatchSizeProfile>> ReadFromFile(
+      Env* env, const std::string& path);
+
+ private:
+  struct LatencyStats {
+    double total_latency_us = 0;
+    int64_t num_batches = 0;
+  };
+
+  struct OpProfile {
+    std::map<int, LatencyStats> latencies;
+    std::optional<std::vector<int32>> allowed_batch_sizes;
+  };
+
+  mutable absl::Mutex mu_;
+  std::map<std::string, OpProfile, std::less<>> ops_ ABSL_GUARDED_BY(mu_);
+};
+
+// The share of the requests of a batch op that have `size` rows.
+struct RequestSizeFrequency {
+  int size;
+  double frequency;
+};
+
+// Chooses at most `max_num_batch_sizes` allowed batch sizes among the batch
+// sizes of `latencies`, minimizing the expected cost of a request over the
+// distribution `request_sizes`.
+//
+// A request of `s` rows is padded to the smallest allowed batch size `b` that
+// is at least `s`, and costs the latency of `b` plus `padding_cost_per_row`
+// for each of the `b - s` padding rows. The largest profiled batch size is
+// always allowed, so that every request fits; returns an `InvalidArgument`
+// error if a request is larger than it.
+absl::StatusOr<std::vector<int32>> ChooseAllowedBatchSizes(
+    const std::map<int, absl::Duration>& latencies,
+    absl::Span<const RequestSizeFrequency> request_sizes,
+    int max_num_batch_sizes, absl::Duration padding_cost_per_row);
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_SIZE_PROFILE_H_
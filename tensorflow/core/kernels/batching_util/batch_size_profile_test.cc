@@ -0,0 +1,131 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/batch_size_profile.h"
+
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/time/time.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Optional;
+using ::testing::Pair;
+using ::tsl::testing::IsOkAndHolds;
+
+TEST(BatchSizeProfileTest, RecordsMeanLatency) {
+  BatchSizeProfile profile;
+  profile.RecordLatency("op", 4, absl::Microseconds(10));
+  profile.RecordLatency("op", 4, absl::Microseconds(30));
+  profile.RecordLatency("op", 8, absl::Microseconds(50));
+  profile.RecordLatency("other_op", 2, absl::Microseconds(5));
+  EXPECT_THAT(profile.GetLatencies("op"),
+              ElementsAre(Pair(4, absl::Microseconds(20)),
+                          Pair(8, absl::Microseconds(50))));
+  EXPECT_TRUE(profile.GetLatencies("missing_op").empty());
+  EXPECT_THAT(profile.GetOpNames(), ElementsAre("op", "other_op"));
+}
+
+TEST(BatchSizeProfileTest, RoundTripsThroughFile) {
+  BatchSizeProfile profile;
+  profile.RecordLatency("op", 4, absl::Microseconds(10));
+  profile.RecordLatency("op", 8, absl::Microseconds(50));
+  profile.SetAllowedBatchSizes("op", {4, 8});
+  const std::string path =
+      io::JoinPath(testing::TmpDir(), "batch_size_profile");
+  TF_ASSERT_OK(profile.WriteToFile(Env::Default(), path));
+
+  auto read_profile = BatchSizeProfile::ReadFromFile(Env::Default(), path);
+  TF_ASSERT_OK(read_profile.status());
+  EXPECT_EQ((*read_profile)->SerializeAsString(), profile.SerializeAsString());
+  EXPECT_THAT((*read_profile)->GetAllowedBatchSizes("op"),
+              Optional(ElementsAre(4, 8)));
+  EXPECT_EQ((*read_profile)->GetAllowedBatchSizes("missing_op"),
+            std::nullopt);
+}
+
+TEST(BatchSizeProfileTest, RejectsMalformedProfiles) {
+  EXPECT_FALSE(BatchSizeProfile::Parse("latency\top\t4\n").ok());
+  EXPECT_FALSE(BatchSizeProfile::Parse("latency\top\tfour\t10\t1\n").ok());
+  EXPECT_FALSE(BatchSizeProfile::Parse("latency\top\t4\t10\t0\n").ok());
+  EXPECT_FALSE(BatchSizeProfile::Parse("allowed_batch_sizes\top\t4,x\n").ok());
+  EXPECT_FALSE(BatchSizeProfile::Parse("unknown\top\n").ok());
+  TF_EXPECT_OK(BatchSizeProfile::Parse("").status());
+}
+
+TEST(ChooseAllowedBatchSizesTest, CoversRequestSizes) {
+  const std::map<int, absl::Duration> latencies = {
+      {2, absl::Microseconds(10)},
+      {4, absl::Microseconds(20)},
+      {8, absl::Microseconds(40)}};
+  const std::vector<RequestSizeFrequency> request_sizes = {{2, 0.5},
+                                                           {8, 0.5}};
+  EXPECT_THAT(
+      ChooseAllowedBatchSizes(latencies, request_sizes,
+                              /*max_num_batch_sizes=*/2, absl::ZeroDuration()),
+      IsOkAndHolds(ElementsAre(2, 8)));
+  EXPECT_THAT(
+      ChooseAllowedBatchSizes(latencies, request_sizes,
+                              /*max_num_batch_sizes=*/1, absl::ZeroDuration()),
+      IsOkAndHolds(ElementsAre(8)));
+}
+
+TEST(ChooseAllowedBatchSizesTest, TradesLatencyForPadding) {
+  // Padding 3 to 4 or to 8 costs the same latency; only the cost of padding
+  // favors 4.
+  const std::map<int, absl::Duration> latencies = {
+      {4, absl::Microseconds(10)}, {8, absl::Microseconds(10)}};
+  const std::vector<RequestSizeFrequency> request_sizes = {{3, 1.0}};
+  EXPECT_THAT(
+      ChooseAllowedBatchSizes(latencies, request_sizes,
+                              /*max_num_batch_sizes=*/2, absl::ZeroDuration()),
+      IsOkAndHolds(ElementsAre(8)));
+  EXPECT_THAT(ChooseAllowedBatchSizes(latencies, request_sizes,
+                                      /*max_num_batch_sizes=*/2,
+                                      absl::Microseconds(1)),
+              IsOkAndHolds(ElementsAre(4, 8)));
+}
+
+TEST(ChooseAllowedBatchSizesTest, RejectsInvalidArguments) {
+  const std::map<int, absl::Duration> latencies = {
+      {4, absl::Microseconds(10)}};
+  EXPECT_FALSE(ChooseAllowedBatchSizes({}, {{1, 1.0}}, 1,
+                                       absl::ZeroDuration())
+                   .ok());
+  EXPECT_FALSE(ChooseAllowedBatchSizes(latencies, {{1, 1.0}}, 0,
+                                       absl::ZeroDuration())
+                   .ok());
+  EXPECT_FALSE(ChooseAllowedBatchSizes(latencies, {{5, 1.0}}, 1,
+                                       absl::ZeroDuration())
+                   .ok());
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
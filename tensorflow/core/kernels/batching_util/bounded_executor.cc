@@ -15,6 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/batching_util/bounded_executor.h"
 
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
 #include <algorithm>
 #include <atomic>
 
@@ -25,6 +29,21 @@ limitations under the License.
 
 namespace tensorflow {
 namespace serving {
+namespace {
+
+// Identifies the executor thread running on the current OS thread, if any.
+struct CurrentWorker {
+  const BoundedExecutor* executor = nullptr;
+  int thread_id = -1;
+};
+
+CurrentWorker& GetCurrentWorker() {
+  static thread_local CurrentWorker current_worker;
+  return current_worker;
+}
+
+}  // namespace
+
 StatusOr<std::unique_ptr<BoundedExecutor>> BoundedExecutor::Create(
     const Options& options) {
   if (options.env == nullptr) {
@@ -33,6 +52,12 @@ StatusOr<std::unique_ptr<BoundedExecutor>> BoundedExecutor::Create(
   if (options.num_threads <= 0) {
     return errors::InvalidArgument("options.num_threads must be positive");
   }
+  for (int cpu : options.cpu_affinity) {
+    if (cpu < 0) {
+      return errors::InvalidArgument(
+          "options.cpu_affinity must not contain negative CPU ids");
+    }
+  }
   return absl::WrapUnique(new BoundedExecutor(options));
 }
 
@@ -41,15 +66,30 @@ BoundedExecutor::BoundedExecutor(const Options& options) : options_(options) {
 }
 
 void BoundedExecutor::InitWorker() {
+  if (options_.enable_work_stealing) {
+    for (int i = 0; i < options_.num_threads; i++) {
+      worker_queues_.push_back(std::make_unique<WorkerQueue>());
+    }
+  }
   for (int i = 0; i < options_.num_threads; i++) {
     std::unique_ptr<Thread> thread = absl::WrapUnique(
         options_.env->StartThread(options_.thread_options, options_.thread_name,
-                                  [this]() { this->Run(); }));
+                                  [this, i]() { this->Run(i); }));
     threads_.push_back(std::move(thread));
   }
 }
 
 BoundedExecutor::~BoundedExecutor() {
+  if (options_.enable_work_stealing) {
+    {
+      mutex_lock l(work_queue_mu_);
+      stopping_ = true;
+    }
+    work_queue_cv_.notify_all();
+    // Threads drain all queues before they exit.
+    threads_.clear();
+    return;
+  }
   {
     mutex_lock l(work_queue_mu_);
     // Enqueue an empty task (nullptr) to signal exit.
@@ -67,18 +107,72 @@ BoundedExecutor::~BoundedExecutor() {
 void BoundedExecutor::Schedule(std::function<void()> func) {
   // use DCHECK so as not to introduce CHECK in prod code.
   DCHECK(func != nullptr) << "func is nullptr";
+  func = WrapForTaskListener(std::move(func));
+  if (options_.enable_work_stealing) {
+    const CurrentWorker& current_worker = GetCurrentWorker();
+    const int thread_id =
+        current_worker.executor == this
+            ? current_worker.thread_id
+            : next_queue_.fetch_add(1, std::memory_order_relaxed) %
+                  options_.num_threads;
+    PushToWorkerQueue(thread_id, std::move(func));
+    return;
+  }
   mutex_lock l(work_queue_mu_);
 
   work_queue_.push_back(std::move(func));
+  num_queued_.fetch_add(1, std::memory_order_relaxed);
 
   work_queue_cv_.notify_one();
 }
 
+void BoundedExecutor::ScheduleWithHint(std::function<void()> func, int start,
+                                       int limit) {
+  DCHECK(func != nullptr) << "func is nullptr";
+  if (!options_.enable_work_stealing || start < 0) {
+    Schedule(std::move(func));
+    return;
+  }
+  PushToWorkerQueue(start % options_.num_threads,
+                    WrapForTaskListener(std::move(func)));
+}
+
 int BoundedExecutor::NumThreads() const { return options_.num_threads; }
 
-int BoundedExecutor::CurrentThreadId() const { return -1; }
+int BoundedExecutor::CurrentThreadId() const {
+  const CurrentWorker& current_worker = GetCurrentWorker();
+  return current_worker.executor == this ? current_worker.thread_id : -1;
+}
+
+void BoundedExecutor::PinCurrentThread(int thread_id) {
+  if (options_.cpu_affinity.empty()) return;
+  const int cpu =
+      options_.cpu_affinity[thread_id % options_.cpu_affinity.size()];
+#if defined(__linux__)
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(cpu, &cpu_set);
+  if (sched_setaffinity(0, sizeof(cpu_set), &cpu_set) != 0) {
+    LOG(WARNING) << "Failed to pin thread " << thread_id << " of "
+                 << options_.thread_name << " to CPU " << cpu;
+  }
+#else
+  LOG(WARNING) << "CPU affinity is not supported on this platform; thread "
+               << thread_id << " of " << options_.thread_name
+               << " is not pinned to CPU " << cpu;
+#endif
+}
+
+void BoundedExecutor::Run(int thread_id) {
+  CurrentWorker& current_worker = GetCurrentWorker();
+  current_worker.executor = this;
+  current_worker.thread_id = thread_id;
+  PinCurrentThread(thread_id);
+  if (options_.enable_work_stealing) {
+    RunWorkStealing(thread_id);
+    return;
+  }
 
-void BoundedExecutor::Run() {
   while (true) {
     std::function<void()> func = nullptr;
     {
@@ -90,6 +184,9 @@ void BoundedExecutor::Run() {
 
       func = std::move(work_queue_.front());
       work_queue_.pop_front();
+      if (func != nullptr) {
+        num_queued_.fetch_sub(1, std::memory_order_relaxed);
+      }
     }
 
     // Exit run-loop when func is nullptr.
@@ -100,5 +197,78 @@ void BoundedExecutor::Run() {
     }
   }
 }
+
+void BoundedExecutor::PushToWorkerQueue(int thread_id,
+                                        std::function<void()> func) {
+  WorkerQueue& queue = *worker_queues_[thread_id];
+  {
+    mutex_lock l(queue.mu);
+    queue.tasks.push_back(std::move(func));
+  }
+  // Pairs with the increment of `num_idle_` in RunWorkStealing(): either this
+  // thread sees the idle worker, or the worker sees the queued task.
+  num_queued_.fetch_add(1);
+  if (num_idle_.load() > 0) {
+    mutex_lock l(work_queue_mu_);
+    work_queue_cv_.notify_one();
+  }
+}
+
+std::function<void()> BoundedExecutor::PopOrSteal(int thread_id) {
+  const int num_threads = options_.num_threads;
+  for (int i = 0; i < num_threads; ++i) {
+    WorkerQueue& queue = *worker_queues_[(thread_id + i) % num_threads];
+    mutex_lock l(queue.mu);
+    if (!queue.tasks.empty()) {
+      std::function<void()> func = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+      num_queued_.fetch_sub(1);
+      if (i > 0) {
+        if (auto* listener = thread::GetThreadPoolTaskListener()) {
+          listener->OnTaskStolen(options_.thread_name);
+        }
+      }
+      return func;
+    }
+  }
+  return nullptr;
+}
+
+std::function<void()> BoundedExecutor::WrapForTaskListener(
+    std::function<void()> func) {
+  thread::ThreadPoolTaskListener* listener =
+      thread::GetThreadPoolTaskListener();
+  if (listener == nullptr) return func;
+  const uint64 enqueue_nanos = options_.env->NowNanos();
+  return [this, listener, enqueue_nanos, func = std::move(func)]() {
+    const int64_t queue_length =
+        std::max<int64_t>(num_queued_.load(std::memory_order_relaxed), 0);
+    const uint64 start_nanos = options_.env->NowNanos();
+    func();
+    listener->OnTaskRun(options_.thread_name, queue_length,
+                        start_nanos - enqueue_nanos,
+                        options_.env->NowNanos() - start_nanos);
+  };
+}
+
+void BoundedExecutor::RunWorkStealing(int thread_id) {
+  while (true) {
+    std::function<void()> func = PopOrSteal(thread_id);
+    if (func != nullptr) {
+      func();
+      continue;
+    }
+
+    // `num_queued_` is briefly negative when a task is stolen before its push
+    // is counted, so treat any non-positive count as empty.
+    mutex_lock l(work_queue_mu_);
+    num_idle_.fetch_add(1);
+    while (num_queued_.load() <= 0 && !stopping_) {
+      work_queue_cv_.wait(l);
+    }
+    num_idle_.fetch_sub(1);
+    if (num_queued_.load() <= 0 && stopping_) break;
+  }
+}
 }  // namespace serving
 }  // namespace tensorflow
@@ -16,7 +16,11 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BOUNDED_EXECUTOR_H_
 #define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BOUNDED_EXECUTOR_H_
 
+#include <atomic>
+#include <deque>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
@@ -28,6 +32,11 @@ namespace tensorflow {
 namespace serving {
 // BoundedExecutor has a bounded number of threads and unlimited queue length,
 // scheduled tasks are executed in a FIFO way.
+//
+// With `enable_work_stealing`, every thread owns a queue instead. Tasks
+// scheduled from one of the executor's threads are queued on that thread, so
+// follow-up work stays on the core that produced it, and idle threads steal
+// from the others. Tasks scheduled from other threads are spread round-robin.
 class BoundedExecutor : public thread::ThreadPoolInterface {
  public:
   struct Options {
@@ -35,6 +44,14 @@ class BoundedExecutor : public thread::ThreadPoolInterface {
     ThreadOptions thread_options;
     std::string thread_name;
     int num_threads = -1;
+
+    // If true, use per-thread queues with work stealing instead of the shared
+    // FIFO queue.
+    bool enable_work_stealing = false;
+
+    // If non-empty, thread `i` is pinned to CPU `cpu_affinity[i % size]`.
+    // Only supported on Linux; ignored with a warning elsewhere.
+    std::vector<int> cpu_affinity;
   };
 
   static StatusOr<std::unique_ptr<BoundedExecutor>> Create(
@@ -48,26 +65,63 @@ class BoundedExecutor : public thread::ThreadPoolInterface {
   // Callers are responsible to guarantee `func` is not nullptr.
   void Schedule(std::function<void()> func) override;
 
+  // With work stealing, queues `func` on thread `start % NumThreads()`.
+  // Otherwise the same as Schedule().
+  void ScheduleWithHint(std::function<void()> func, int start,
+                        int limit) override;
+
   // Returns the number of threads.
   int NumThreads() const override;
 
+  // Returns the index of the calling thread in [0, NumThreads()) if it
+  // belongs to this executor, and -1 otherwise.
   int CurrentThreadId() const override;
 
  private:
+  // The queue owned by one thread in work stealing mode.
+  struct WorkerQueue {
+    mutex mu;
+    std::deque<std::function<void()>> tasks TF_GUARDED_BY(mu);
+  };
+
   explicit BoundedExecutor(const Options& options);
 
   // Starts N workers (N == num_threads), polling tasks from `work_queue_`.
   void InitWorker();
 
   // A loop to fetch task from `work_queue_` and execute task.
-  void Run();
+  void Run(int thread_id);
+
+  // The work stealing counterparts of Schedule() and Run().
+  void PushToWorkerQueue(int thread_id, std::function<void()> func);
+  void RunWorkStealing(int thread_id);
 
-  const Options& options_;
+  // Pops the oldest task of `thread_id`'s own queue, or steals the oldest
+  // task of another queue. Returns nullptr if all queues are empty.
+  std::function<void()> PopOrSteal(int thread_id);
+
+  // Pins the calling thread according to `options_.cpu_affinity`.
+  void PinCurrentThread(int thread_id);
+
+  // If a thread::ThreadPoolTaskListener is set, wraps `func` to report its
+  // queueing and run time to it.
+  std::function<void()> WrapForTaskListener(std::function<void()> func);
+
+  const Options options_;
 
   mutex work_queue_mu_;
   std::deque<std::function<void()>> work_queue_ TF_GUARDED_BY(work_queue_mu_);
   condition_variable work_queue_cv_ TF_GUARDED_BY(work_queue_mu_);
 
+  // The number of queued tasks, in either mode.
+  std::atomic<int64_t> num_queued_{0};
+
+  // Work stealing state. Idle threads sleep on `work_queue_cv_`.
+  std::vector<std::unique_ptr<WorkerQueue>> worker_queues_;
+  std::atomic<int> num_idle_{0};
+  std::atomic<uint32_t> next_queue_{0};
+  bool stopping_ TF_GUARDED_BY(work_queue_mu_) = false;
+
   // A fixed number of threads.
   std::vector<std::unique_ptr<Thread>> threads_;
   BoundedExecutor(const BoundedExecutor&) = delete;
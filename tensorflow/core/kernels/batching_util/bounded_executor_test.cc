@@ -15,12 +15,16 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/batching_util/bounded_executor.h"
 
+#include <atomic>
+#include <string>
+
 #include "absl/functional/bind_front.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/threadpool_interface.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 
@@ -149,6 +153,157 @@ TEST(BoundedExecutorTest, MaxInflightLimit) {
   EXPECT_EQ(task_tracker.running_count(), 0);
 }
 
+TEST(BoundedExecutorTest, InvalidCpuAffinity) {
+  BoundedExecutor::Options options;
+  options.num_threads = 2;
+  options.cpu_affinity = {0, -1};
+  EXPECT_THAT(BoundedExecutor::Create(options),
+              ::tensorflow::testing::StatusIs(
+                  error::INVALID_ARGUMENT,
+                  "options.cpu_affinity must not contain negative CPU ids"));
+}
+
+TEST(BoundedExecutorTest, WorkStealingMaxInflightLimit) {
+  BoundedExecutor::Options options;
+  options.num_threads = 5;
+  options.enable_work_stealing = true;
+  TF_ASSERT_OK_AND_ASSIGN(auto executor, BoundedExecutor::Create(options));
+
+  const int num_tasks = 100;
+  TaskTracker task_tracker;
+  for (int i = 0; i < num_tasks; i++) {
+    executor->Schedule(task_tracker.MakeTask(i, absl::Milliseconds(10)));
+  }
+  executor.reset();
+
+  EXPECT_EQ(task_tracker.task_count(), num_tasks);
+  EXPECT_LE(task_tracker.max_running_count(), options.num_threads);
+  EXPECT_EQ(task_tracker.running_count(), 0);
+}
+
+TEST(BoundedExecutorTest, WorkStealingKeepsNestedTasksOnSameThread) {
+  BoundedExecutor::Options options;
+  options.num_threads = 1;
+  options.enable_work_stealing = true;
+  TF_ASSERT_OK_AND_ASSIGN(auto executor, BoundedExecutor::Create(options));
+
+  Notification done;
+  int outer_thread_id = -2;
+  int inner_thread_id = -2;
+  executor->Schedule([&] {
+    outer_thread_id = executor->CurrentThreadId();
+    executor->Schedule([&] {
+      inner_thread_id = executor->CurrentThreadId();
+      done.Notify();
+    });
+  });
+  done.WaitForNotification();
+
+  EXPECT_EQ(outer_thread_id, 0);
+  EXPECT_EQ(inner_thread_id, 0);
+  EXPECT_EQ(executor->CurrentThreadId(), -1);
+}
+
+TEST(BoundedExecutorTest, WorkStealingIdleThreadsSteal) {
+  BoundedExecutor::Options options;
+  options.num_threads = 4;
+  options.enable_work_stealing = true;
+  TF_ASSERT_OK_AND_ASSIGN(auto executor, BoundedExecutor::Create(options));
+
+  // Queue every task on thread 0. The others must steal for the tasks to run
+  // concurrently.
+  const int num_tasks = 8;
+  TaskTracker task_tracker;
+  for (int i = 0; i < num_tasks; i++) {
+    executor->ScheduleWithHint(task_tracker.MakeTask(i, absl::Seconds(1)),
+                               /*start=*/0, /*limit=*/1);
+  }
+  executor.reset();
+
+  EXPECT_EQ(task_tracker.task_count(), num_tasks);
+  EXPECT_EQ(task_tracker.max_running_count(), options.num_threads);
+}
+
+// Counts the closures run and stolen by the pool named `pool_name`.
+class CountingTaskListener : public thread::ThreadPoolTaskListener {
+ public:
+  explicit CountingTaskListener(const std::string& pool_name)
+      : pool_name_(pool_name) {}
+
+  void OnTaskRun(const std::string& pool_name, int64_t queue_length,
+                 int64_t wait_nanos, int64_t run_nanos) override {
+    if (pool_name == pool_name_) num_tasks_++;
+  }
+
+  void OnTaskStolen(const std::string& pool_name) override {
+    if (pool_name == pool_name_) num_steals_++;
+  }
+
+  int num_tasks() const { return num_tasks_; }
+  int num_steals() const { return num_steals_; }
+
+ private:
+  const std::string pool_name_;
+  std::atomic<int> num_tasks_{0};
+  std::atomic<int> num_steals_{0};
+};
+
+TEST(BoundedExecutorTest, ReportsToTaskListener) {
+  CountingTaskListener listener("listener_test");
+  thread::SetThreadPoolTaskListener(&listener);
+
+  BoundedExecutor::Options options;
+  options.thread_name = "listener_test";
+  options.num_threads = 2;
+  TF_ASSERT_OK_AND_ASSIGN(auto executor, BoundedExecutor::Create(options));
+  const int num_tasks = 10;
+  TaskTracker task_tracker;
+  for (int i = 0; i < num_tasks; i++) {
+    executor->Schedule(task_tracker.MakeTask(i, absl::Milliseconds(1)));
+  }
+  executor.reset();
+
+  thread::SetThreadPoolTaskListener(nullptr);
+  EXPECT_EQ(listener.num_tasks(), num_tasks);
+  EXPECT_EQ(listener.num_steals(), 0);
+}
+
+TEST(BoundedExecutorTest, WorkStealingReportsSteals) {
+  CountingTaskListener listener("steal_test");
+  thread::SetThreadPoolTaskListener(&listener);
+
+  BoundedExecutor::Options options;
+  options.thread_name = "steal_test";
+  options.num_threads = 4;
+  options.enable_work_stealing = true;
+  TF_ASSERT_OK_AND_ASSIGN(auto executor, BoundedExecutor::Create(options));
+  // Queue every task on thread 0, so that the other threads steal them.
+  const int num_tasks = 8;
+  TaskTracker task_tracker;
+  for (int i = 0; i < num_tasks; i++) {
+    executor->ScheduleWithHint(
+        task_tracker.MakeTask(i, absl::Milliseconds(100)),
+        /*start=*/0, /*limit=*/1);
+  }
+  executor.reset();
+
+  thread::SetThreadPoolTaskListener(nullptr);
+  EXPECT_EQ(listener.num_tasks(), num_tasks);
+  EXPECT_GT(listener.num_steals(), 0);
+}
+
+TEST(BoundedExecutorTest, WorkStealingWithCpuAffinity) {
+  BoundedExecutor::Options options;
+  options.num_threads = 2;
+  options.enable_work_stealing = true;
+  options.cpu_affinity = {0};
+  TF_ASSERT_OK_AND_ASSIGN(auto executor, BoundedExecutor::Create(options));
+
+  Notification done;
+  executor->Schedule([&done] { done.Notify(); });
+  done.WaitForNotification();
+}
+
 }  // namespace
 }  // namespace serving
 }  // namespace tensorflow
@@ -0,0 +1,420 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_CONTINUOUS_BATCH_SCHEDULER_H_
+#define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_CONTINUOUS_BATCH_SCHEDULER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
+#include "tensorflow/core/kernels/batching_util/shared_batch_scheduler.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace serving {
+
+// EXPERIMENTAL: API MAY BE SUBJECTED TO SUDDEN CHANGES.
+//
+// A scheduler for iteration-level ("continuous") batching of autoregressive
+// models. Every task is one sequence that runs for a data-dependent number of
+// decode steps. Instead of running a fixed batch until its longest sequence is
+// done, the scheduler runs the model one step at a time over the set of active
+// sequences, and between two steps it retires finished sequences and admits
+// new ones. Short sequences thus never wait for long ones.
+//
+// New tasks are batched by a SharedBatchScheduler queue, which provides the
+// usual admission timeout and queue capacity limit. Admitted sequences wait
+// until there is room in the active set.
+//
+// The per-sequence state of the model (e.g. a KV cache) is assumed to live in
+// a pool of fixed-size pages, each of which holds the state of `page_size`
+// steps. The scheduler owns the page table of every sequence and grows it as
+// the sequence runs. When the pool is exhausted, the most recently admitted
+// sequence is preempted: its pages are released and it is requeued to start
+// over, so that older sequences can make progress.
+//
+// Type parameter TaskType must be a subclass of BatchTask.
+template <typename TaskType>
+class ContinuousBatchScheduler : public BatchScheduler<TaskType> {
+ public:
+  // A sequence in the active set.
+  struct Sequence {
+    std::unique_ptr<TaskType> task;
+
+    // The number of decode steps already run for this sequence. Zero means
+    // the sequence is new, or was preempted, and its state must be built
+    // from scratch in the next step.
+    int64_t num_steps = 0;
+
+    // Ids of the pages of the state pool that hold this sequence's state, in
+    // order. Before every step, holds enough pages for `num_steps + 1` steps.
+    std::vector<int> pages;
+  };
+
+  struct Options {
+    // The name of the thread that runs decode steps, and of the admission
+    // batch thread.
+    string thread_pool_name = {"continuous_batch_threads"};
+
+    // The maximum number of sequences in one decode step.
+    int max_active_sequences = 32;
+
+    // The number of pages in the state pool, and the number of decode steps
+    // whose state fits in one page.
+    int num_pages = 1024;
+    int page_size = 16;
+
+    // Options of the admission queue; see SharedBatchScheduler::QueueOptions.
+    int64_t batch_timeout_micros = 0;
+    int max_enqueued_batches = 10;
+
+    // The environment to use.
+    // (Typically only overridden by test code.)
+    Env* env = Env::Default();
+  };
+
+  // Runs one decode step for every sequence of `sequences`, and sets
+  // `(*finished)[i]` to true if `sequences[i]` is done. `finished` is sized
+  // and set to false by the caller. On error, all sequences of the step fail.
+  using StepCallback = std::function<Status(
+      const std::vector<Sequence*>& sequences, std::vector<bool>* finished)>;
+
+  // Called exactly once per task, when its sequence is done or has failed.
+  using DoneCallback =
+      std::function<void(std::unique_ptr<TaskType> task, const Status& status)>;
+
+  static Status Create(const Options& options, StepCallback step_callback,
+                       DoneCallback done_callback,
+                       std::unique_ptr<ContinuousBatchScheduler>* scheduler);
+
+  // Blocks until every scheduled task is done.
+  ~ContinuousBatchScheduler() override;
+
+  Status Schedule(std::unique_ptr<TaskType>* task) override;
+
+  // The number of tasks that are not in the active set yet.
+  size_t NumEnqueuedTasks() const override;
+
+  size_t SchedulingCapacity() const override;
+
+  size_t max_task_size() const override {
+    return admission_queue_->max_task_size();
+  }
+
+  // The number of sequences in the active set.
+  int num_active_sequences() const { return num_active_sequences_.load(); }
+
+  // The number of unused pages of the state pool.
+  int num_free_pages() const { return num_free_pages_.load(); }
+
+ private:
+  explicit ContinuousBatchScheduler(const Options& options,
+                                    StepCallback step_callback,
+                                    DoneCallback done_callback);
+
+  // Called on the admission batch thread. Hands the tasks of `batch` to the
+  // decode thread, and blocks until they have all entered the active set, so
+  // that the admission queue keeps exerting backpressure.
+  void AdmitBatch(std::unique_ptr<Batch<TaskType>> batch);
+
+  // The loop of `decode_thread_`.
+  void DecodeLoop();
+
+  // Moves pending sequences into the active set while there is room and
+  // pages, and gives every active sequence the pages for its next step,
+  // preempting sequences if needed.
+  void PrepareStep();
+
+  // Finishes `active_[i]` with `status`, and releases its pages.
+  void Retire(size_t i, const Status& status);
+
+  // Releases the pages of `sequence`.
+  void FreePages(Sequence* sequence);
+
+  const Options options_;
+  const StepCallback step_callback_;
+  const DoneCallback done_callback_;
+
+  std::unique_ptr<BatchScheduler<TaskType>> admission_queue_;
+
+  mutable mutex mu_;
+  condition_variable cv_;
+
+  // Admitted sequences that are not in the active set yet. Preempted
+  // sequences are requeued at the front.
+  std::deque<std::unique_ptr<Sequence>> pending_ TF_GUARDED_BY(mu_);
+  bool stopping_ TF_GUARDED_BY(mu_) = false;
+
+  // Only accessed by the decode thread.
+  std::vector<std::unique_ptr<Sequence>> active_;
+  std::vector<int> free_pages_;
+
+  std::atomic<int> num_active_sequences_{0};
+  std::atomic<int> num_free_pages_{0};
+
+  std::unique_ptr<Thread> decode_thread_;
+
+  ContinuousBatchScheduler(const ContinuousBatchScheduler&) = delete;
+  void operator=(const ContinuousBatchScheduler&) = delete;
+};
+
+//////////
+// Implementation details follow. API users need not read.
+
+template <typename TaskType>
+Status ContinuousBatchScheduler<TaskType>::Create(
+    const Options& options, StepCallback step_callback,
+    DoneCallback done_callback,
+    std::unique_ptr<ContinuousBatchScheduler>* scheduler) {
+  if (options.max_active_sequences <= 0) {
+    return errors::InvalidArgument(
+        "max_active_sequences must be positive; was ",
+        options.max_active_sequences);
+  }
+  if (options.page_size <= 0) {
+    return errors::InvalidArgument("page_size must be positive; was ",
+                                   options.page_size);
+  }
+  if (options.num_pages <= 0) {
+    return errors::InvalidArgument("num_pages must be positive; was ",
+                                   options.num_pages);
+  }
+  if (options.env == nullptr) {
+    return errors::InvalidArgument("env must not be null");
+  }
+  if (step_callback == nullptr || done_callback == nullptr) {
+    return errors::InvalidArgument("callbacks must not be null");
+  }
+
+  std::unique_ptr<ContinuousBatchScheduler> new_scheduler(
+      new ContinuousBatchScheduler(options, std::move(step_callback),
+                                   std::move(done_callback)));
+
+  // A single admission thread keeps at most one admission batch pending.
+  typename SharedBatchScheduler<TaskType>::Options shared_scheduler_options;
+  shared_scheduler_options.thread_pool_name = options.thread_pool_name;
+  shared_scheduler_options.num_batch_threads = 1;
+  shared_scheduler_options.env = options.env;
+  std::shared_ptr<SharedBatchScheduler<TaskType>> shared_scheduler;
+  TF_RETURN_IF_ERROR(SharedBatchScheduler<TaskType>::Create(
+      shared_scheduler_options, &shared_scheduler));
+
+  typename SharedBatchScheduler<TaskType>::QueueOptions queue_options;
+  queue_options.input_batch_size_limit = options.max_active_sequences;
+  queue_options.max_execution_batch_size = options.max_active_sequences;
+  queue_options.batch_timeout_micros = options.batch_timeout_micros;
+  queue_options.max_enqueued_batches = options.max_enqueued_batches;
+  ContinuousBatchScheduler* raw_scheduler = new_scheduler.get();
+  std::function<void(std::unique_ptr<Batch<TaskType>>)> admit_batch =
+      [raw_scheduler](std::unique_ptr<Batch<TaskType>> batch) {
+        raw_scheduler->AdmitBatch(std::move(batch));
+      };
+  TF_RETURN_IF_ERROR(shared_scheduler->AddQueue(
+      queue_options, admit_batch, &new_scheduler->admission_queue_));
+
+  new_scheduler->decode_thread_.reset(options.env->StartThread(
+      {}, options.thread_pool_name,
+      [raw_scheduler] { raw_scheduler->DecodeLoop(); }));
+  *scheduler = std::move(new_scheduler);
+  return absl::OkStatus();
+}
+
+template <typename TaskType>
+ContinuousBatchScheduler<TaskType>::ContinuousBatchScheduler(
+    const Options& options, StepCallback step_callback,
+    DoneCallback done_callback)
+    : options_(options),
+      step_callback_(std::move(step_callback)),
+      done_callback_(std::move(done_callback)) {
+  free_pages_.reserve(options_.num_pages);
+  for (int page = options_.num_pages - 1; page >= 0; --page) {
+    free_pages_.push_back(page);
+  }
+  num_free_pages_.store(options_.num_pages);
+}
+
+template <typename TaskType>
+ContinuousBatchScheduler<TaskType>::~ContinuousBatchScheduler() {
+  // Flushes the admission queue while the decode thread still runs.
+  admission_queue_.reset();
+  {
+    mutex_lock l(mu_);
+    stopping_ = true;
+  }
+  cv_.notify_all();
+  // Joins the decode thread once every sequence is done.
+  decode_thread_.reset();
+}
+
+template <typename TaskType>
+Status ContinuousBatchScheduler<TaskType>::Schedule(
+    std::unique_ptr<TaskType>* task) {
+  return admission_queue_->Schedule(task);
+}
+
+template <typename TaskType>
+size_t ContinuousBatchScheduler<TaskType>::NumEnqueuedTasks() const {
+  mutex_lock l(mu_);
+  return admission_queue_->NumEnqueuedTasks() + pending_.size();
+}
+
+template <typename TaskType>
+size_t ContinuousBatchScheduler<TaskType>::SchedulingCapacity() const {
+  return admission_queue_->SchedulingCapacity();
+}
+
+template <typename TaskType>
+void ContinuousBatchScheduler<TaskType>::AdmitBatch(
+    std::unique_ptr<Batch<TaskType>> batch) {
+  std::vector<std::unique_ptr<TaskType>> tasks = batch->RemoveAllTasks();
+  mutex_lock l(mu_);
+  for (auto& task : tasks) {
+    auto sequence = std::make_unique<Sequence>();
+    sequence->task = std::move(task);
+    pending_.push_back(std::move(sequence));
+  }
+  cv_.notify_all();
+  while (!pending_.empty()) {
+    cv_.wait(l);
+  }
+}
+
+template <typename TaskType>
+void ContinuousBatchScheduler<TaskType>::FreePages(Sequence* sequence) {
+  for (int page : sequence->pages) {
+    free_pages_.push_back(page);
+  }
+  sequence->pages.clear();
+  num_free_pages_.store(free_pages_.size());
+}
+
+template <typename TaskType>
+void ContinuousBatchScheduler<TaskType>::Retire(size_t i,
+                                                const Status& status) {
+  FreePages(active_[i].get());
+  done_callback_(std::move(active_[i]->task), status);
+  active_[i] = nullptr;
+}
+
+template <typename TaskType>
+void ContinuousBatchScheduler<TaskType>::PrepareStep() {
+  {
+    mutex_lock l(mu_);
+    // Every sequence needs a page for its first step.
+    const size_t max_active_sequences = options_.max_active_sequences;
+    while (!pending_.empty() && active_.size() < max_active_sequences &&
+           !free_pages_.empty()) {
+      std::unique_ptr<Sequence> sequence = std::move(pending_.front());
+      pending_.pop_front();
+      sequence->pages.push_back(free_pages_.back());
+      free_pages_.pop_back();
+      active_.push_back(std::move(sequence));
+    }
+    if (pending_.empty()) cv_.notify_all();
+  }
+
+  // Sequences are kept in admission order, so preempting from the back
+  // favors the sequences that have been running longest.
+  for (size_t i = 0; i < active_.size(); ++i) {
+    Sequence* sequence = active_[i].get();
+    const size_t pages_needed = sequence->num_steps / options_.page_size + 1;
+    while (sequence->pages.size() < pages_needed) {
+      if (!free_pages_.empty()) {
+        sequence->pages.push_back(free_pages_.back());
+        free_pages_.pop_back();
+        continue;
+      }
+      std::unique_ptr<Sequence> victim = std::move(active_.back());
+      active_.pop_back();
+      FreePages(victim.get());
+      victim->num_steps = 0;
+      {
+        mutex_lock l(mu_);
+        pending_.push_front(std::move(victim));
+      }
+      if (i >= active_.size()) break;
+    }
+  }
+  num_free_pages_.store(free_pages_.size());
+  num_active_sequences_.store(active_.size());
+}
+
+template <typename TaskType>
+void ContinuousBatchScheduler<TaskType>::DecodeLoop() {
+  while (true) {
+    {
+      mutex_lock l(mu_);
+      while (active_.empty() && pending_.empty() && !stopping_) {
+        cv_.wait(l);
+      }
+      if (active_.empty() && pending_.empty() && stopping_) break;
+    }
+
+    PrepareStep();
+    if (active_.empty()) {
+      // A lone sequence that outgrows the whole pool preempts itself, and
+      // cannot make progress.
+      std::unique_ptr<Sequence> sequence;
+      {
+        mutex_lock l(mu_);
+        sequence = std::move(pending_.front());
+        pending_.pop_front();
+        if (pending_.empty()) cv_.notify_all();
+      }
+      done_callback_(
+          std::move(sequence->task),
+          errors::ResourceExhausted("Sequence does not fit in ",
+                                    options_.num_pages, " pages of ",
+                                    options_.page_size, " steps"));
+      continue;
+    }
+
+    std::vector<Sequence*> sequences;
+    sequences.reserve(active_.size());
+    for (const auto& sequence : active_) {
+      sequences.push_back(sequence.get());
+    }
+    std::vector<bool> finished(sequences.size(), false);
+    const Status status = step_callback_(sequences, &finished);
+    for (size_t i = 0; i < active_.size(); ++i) {
+      ++active_[i]->num_steps;
+      if (!status.ok()) {
+        Retire(i, status);
+      } else if (finished[i]) {
+        Retire(i, absl::OkStatus());
+      }
+    }
+    active_.erase(std::remove(active_.begin(), active_.end(), nullptr),
+                  active_.end());
+    num_active_sequences_.store(active_.size());
+  }
+}
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_CONTINUOUS_BATCH_SCHEDULER_H_
@@ -0,0 +1,241 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/continuous_batch_scheduler.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+// A sequence that is done after `length` decode steps.
+class FakeSequenceTask : public BatchTask {
+ public:
+  FakeSequenceTask(int id, int length) : id_(id), length_(length) {}
+
+  size_t size() const override { return 1; }
+
+  int id() const { return id_; }
+  int length() const { return length_; }
+
+ private:
+  const int id_;
+  const int length_;
+};
+
+using Scheduler = ContinuousBatchScheduler<FakeSequenceTask>;
+
+// Records the sequences of every step and the outcome of every task.
+class Recorder {
+ public:
+  Status Step(const std::vector<Scheduler::Sequence*>& sequences,
+              std::vector<bool>* finished) {
+    mutex_lock l(mu_);
+    std::vector<int> ids;
+    for (int i = 0; i < sequences.size(); ++i) {
+      const Scheduler::Sequence& sequence = *sequences[i];
+      ids.push_back(sequence.task->id());
+      max_pages_ = std::max<int>(max_pages_, sequence.pages.size());
+      (*finished)[i] = sequence.num_steps + 1 >= sequence.task->length();
+    }
+    steps_.push_back(ids);
+    return absl::OkStatus();
+  }
+
+  void Done(std::unique_ptr<FakeSequenceTask> task, const Status& status) {
+    mutex_lock l(mu_);
+    done_ids_.push_back(task->id());
+    statuses_.push_back(status);
+  }
+
+  std::vector<std::vector<int>> steps() {
+    mutex_lock l(mu_);
+    return steps_;
+  }
+  std::vector<int> done_ids() {
+    mutex_lock l(mu_);
+    return done_ids_;
+  }
+  std::vector<Status> statuses() {
+    mutex_lock l(mu_);
+    return statuses_;
+  }
+  int max_pages() {
+    mutex_lock l(mu_);
+    return max_pages_;
+  }
+
+ private:
+  mutex mu_;
+  std::vector<std::vector<int>> steps_ TF_GUARDED_BY(mu_);
+  std::vector<int> done_ids_ TF_GUARDED_BY(mu_);
+  std::vector<Status> statuses_ TF_GUARDED_BY(mu_);
+  int max_pages_ TF_GUARDED_BY(mu_) = 0;
+};
+
+Status CreateScheduler(const Scheduler::Options& options, Recorder* recorder,
+                       std::unique_ptr<Scheduler>* scheduler) {
+  return Scheduler::Create(
+      options,
+      [recorder](const std::vector<Scheduler::Sequence*>& sequences,
+                 std::vector<bool>* finished) {
+        return recorder->Step(sequences, finished);
+      },
+      [recorder](std::unique_ptr<FakeSequenceTask> task, const Status& status) {
+        recorder->Done(std::move(task), status);
+      },
+      scheduler);
+}
+
+Status ScheduleSequence(int id, int length, Scheduler* scheduler) {
+  auto task = std::make_unique<FakeSequenceTask>(id, length);
+  return scheduler->Schedule(&task);
+}
+
+TEST(ContinuousBatchSchedulerTest, InvalidOptions) {
+  Recorder recorder;
+  std::unique_ptr<Scheduler> scheduler;
+  Scheduler::Options options;
+  options.max_active_sequences = 0;
+  EXPECT_FALSE(CreateScheduler(options, &recorder, &scheduler).ok());
+
+  options = Scheduler::Options();
+  options.page_size = 0;
+  EXPECT_FALSE(CreateScheduler(options, &recorder, &scheduler).ok());
+
+  options = Scheduler::Options();
+  options.num_pages = 0;
+  EXPECT_FALSE(CreateScheduler(options, &recorder, &scheduler).ok());
+}
+
+TEST(ContinuousBatchSchedulerTest, ShortSequencesDoNotWaitForLongOnes) {
+  Recorder recorder;
+  {
+    Scheduler::Options options;
+    options.max_active_sequences = 2;
+    std::unique_ptr<Scheduler> scheduler;
+    TF_ASSERT_OK(CreateScheduler(options, &recorder, &scheduler));
+    TF_ASSERT_OK(ScheduleSequence(/*id=*/0, /*length=*/20, scheduler.get()));
+    TF_ASSERT_OK(ScheduleSequence(/*id=*/1, /*length=*/1, scheduler.get()));
+    TF_ASSERT_OK(ScheduleSequence(/*id=*/2, /*length=*/1, scheduler.get()));
+    TF_ASSERT_OK(ScheduleSequence(/*id=*/3, /*length=*/1, scheduler.get()));
+  }
+
+  // The short sequences all finish before the long one, each taking the slot
+  // freed by the previous one.
+  const std::vector<int> done_ids = recorder.done_ids();
+  ASSERT_EQ(done_ids.size(), 4);
+  EXPECT_EQ(done_ids.back(), 0);
+  for (const Status& status : recorder.statuses()) {
+    TF_EXPECT_OK(status);
+  }
+  int steps_with_sequence_0 = 0;
+  for (const std::vector<int>& ids : recorder.steps()) {
+    EXPECT_LE(ids.size(), 2);
+    steps_with_sequence_0 += std::count(ids.begin(), ids.end(), 0);
+  }
+  EXPECT_EQ(steps_with_sequence_0, 20);
+}
+
+TEST(ContinuousBatchSchedulerTest, GrowsPagesAndReleasesThem) {
+  Recorder recorder;
+  Scheduler::Options options;
+  options.max_active_sequences = 4;
+  options.num_pages = 8;
+  options.page_size = 4;
+  std::unique_ptr<Scheduler> scheduler;
+  TF_ASSERT_OK(CreateScheduler(options, &recorder, &scheduler));
+  TF_ASSERT_OK(ScheduleSequence(/*id=*/0, /*length=*/10, scheduler.get()));
+  scheduler.reset();
+
+  // Ten steps of four steps per page.
+  EXPECT_EQ(recorder.max_pages(), 3);
+  ASSERT_EQ(recorder.statuses().size(), 1);
+  TF_EXPECT_OK(recorder.statuses()[0]);
+}
+
+TEST(ContinuousBatchSchedulerTest, PreemptsNewestSequenceWhenOutOfPages) {
+  Recorder recorder;
+  {
+    Scheduler::Options options;
+    options.max_active_sequences = 2;
+    options.num_pages = 3;
+    options.page_size = 2;
+    std::unique_ptr<Scheduler> scheduler;
+    TF_ASSERT_OK(CreateScheduler(options, &recorder, &scheduler));
+    TF_ASSERT_OK(ScheduleSequence(/*id=*/0, /*length=*/6, scheduler.get()));
+    TF_ASSERT_OK(ScheduleSequence(/*id=*/1, /*length=*/6, scheduler.get()));
+  }
+
+  // Both sequences need three pages, so they cannot run side by side to the
+  // end. Both still complete.
+  const std::vector<int> done_ids = recorder.done_ids();
+  ASSERT_EQ(done_ids.size(), 2);
+  for (const Status& status : recorder.statuses()) {
+    TF_EXPECT_OK(status);
+  }
+}
+
+TEST(ContinuousBatchSchedulerTest, SequenceLargerThanPoolFails) {
+  Recorder recorder;
+  {
+    Scheduler::Options options;
+    options.num_pages = 2;
+    options.page_size = 2;
+    std::unique_ptr<Scheduler> scheduler;
+    TF_ASSERT_OK(CreateScheduler(options, &recorder, &scheduler));
+    TF_ASSERT_OK(ScheduleSequence(/*id=*/0, /*length=*/5, scheduler.get()));
+  }
+
+  const std::vector<Status> statuses = recorder.statuses();
+  ASSERT_EQ(statuses.size(), 1);
+  EXPECT_TRUE(errors::IsResourceExhausted(statuses[0]));
+}
+
+TEST(ContinuousBatchSchedulerTest, StepErrorFailsActiveSequences) {
+  std::vector<Status> statuses;
+  mutex mu;
+  {
+    std::unique_ptr<Scheduler> scheduler;
+    TF_ASSERT_OK(Scheduler::Create(
+        Scheduler::Options(),
+        [](const std::vector<Scheduler::Sequence*>& sequences,
+           std::vector<bool>* finished) {
+          return errors::Internal("step failed");
+        },
+        [&](std::unique_ptr<FakeSequenceTask> task, const Status& status) {
+          mutex_lock l(mu);
+          statuses.push_back(status);
+        },
+        &scheduler));
+    TF_ASSERT_OK(ScheduleSequence(/*id=*/0, /*length=*/5, scheduler.get()));
+  }
+
+  ASSERT_EQ(statuses.size(), 1);
+  EXPECT_TRUE(errors::IsInternal(statuses[0]));
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
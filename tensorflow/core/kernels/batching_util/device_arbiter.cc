@@ -0,0 +1,423 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/device_arbiter.h"
+
+#ifndef PLATFORM_WINDOWS
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#endif  // PLATFORM_WINDOWS
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "absl/memory/memory.h"
+#include "absl/status/statusor.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_scheduling_metrics_storage.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+
+namespace tensorflow {
+namespace serving {
+
+#ifndef PLATFORM_WINDOWS
+
+namespace internal {
+
+// Identifies an initialized segment.
+constexpr uint32_t kDeviceArbiterMagic = 0x54464441;
+constexpr int kMaxDeviceArbiterParticipants = 64;
+
+struct DeviceArbiterParticipant {
+  // The process of the participant, or 0 if the slot is free.
+  int64_t pid = 0;
+  double weight = 0;
+  double virtual_time_ns = 0;
+  // The number of threads waiting for a time slice.
+  int64_t num_waiting = 0;
+  // The number of time slices granted to the participant.
+  int64_t num_in_flight = 0;
+  // The last GPU load published by the participant.
+  int64_t load_ns = 0;
+};
+
+// The layout of the shared memory segment of an arbiter. All fields but
+// `magic` are guarded by `mu`.
+struct DeviceArbiterSegment {
+  std::atomic<uint32_t> magic;
+  pthread_mutex_t mu;
+  pthread_cond_t cv;
+  int64_t max_in_flight;
+  int64_t num_in_flight;
+  DeviceArbiterParticipant participants[kMaxDeviceArbiterParticipants];
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "The segment magic must be usable across processes.");
+
+}  // namespace internal
+
+namespace {
+
+using internal::DeviceArbiterParticipant;
+using internal::DeviceArbiterSegment;
+
+// How long a waiting participant sleeps before checking for dead processes.
+constexpr absl::Duration kWaitTimeout = absl::Milliseconds(10);
+// How long to wait for the creator of a segment to initialize it.
+constexpr absl::Duration kInitializationTimeout = absl::Seconds(10);
+constexpr int64_t kInitializationPollMicros = 1000;
+
+bool IsAlive(int64_t pid) { return kill(pid, 0) == 0 || errno == EPERM; }
+
+// Locks the mutex of a segment, recovering it if its owner died.
+class SegmentLock {
+ public:
+  explicit SegmentLock(DeviceArbiterSegment* segment) : segment_(segment) {
+    if (pthread_mutex_lock(&segment_->mu) == EOWNERDEAD) {
+      pthread_mutex_consistent(&segment_->mu);
+    }
+  }
+  ~SegmentLock() { pthread_mutex_unlock(&segment_->mu); }
+
+  // Waits for `segment->cv` for at most `timeout`.
+  void WaitFor(absl::Duration timeout) {
+    const timespec deadline = absl::ToTimespec(absl::Now() + timeout);
+    if (pthread_cond_timedwait(&segment_->cv, &segment_->mu, &deadline) ==
+        EOWNERDEAD) {
+      pthread_mutex_consistent(&segment_->mu);
+    }
+  }
+
+ private:
+  DeviceArbiterSegment* const segment_;
+
+  SegmentLock(const SegmentLock&) = delete;
+  void operator=(const SegmentLock&) = delete;
+};
+
+// Frees the slots of dead processes, and returns their time slices. Requires
+// the segment to be locked.
+void ReapDeadParticipants(DeviceArbiterSegment* segment) {
+  for (DeviceArbiterParticipant& participant : segment->participants) {
+    if (participant.pid != 0 && !IsAlive(participant.pid)) {
+      segment->num_in_flight -= participant.num_in_flight;
+      participant = DeviceArbiterParticipant();
+    }
+  }
+}
+
+// Returns the earliest virtual time of the participants other than `slot`,
+// only considering active ones if `active_only`. Requires the segment to be
+// locked.
+std::optional<double> MinVirtualTimeNs(const DeviceArbiterSegment& segment,
+                                       int slot, bool active_only) {
+  std::optional<double> min_virtual_time_ns;
+  for (int i = 0; i < internal::kMaxDeviceArbiterParticipants; ++i) {
+    const DeviceArbiterParticipant& participant = segment.participants[i];
+    if (i == slot || participant.pid == 0) continue;
+    if (active_only && participant.num_waiting == 0 &&
+        participant.num_in_flight == 0) {
+      continue;
+    }
+    if (!min_virtual_time_ns.has_value() ||
+        participant.virtual_time_ns < *min_virtual_time_ns) {
+      min_virtual_time_ns = participant.virtual_time_ns;
+    }
+  }
+  return min_virtual_time_ns;
+}
+
+// Returns true if `slot` has the earliest virtual time of the waiting
+// participants. Requires the segment to be locked.
+bool IsNextInLine(const DeviceArbiterSegment& segment, int slot) {
+  const double virtual_time_ns = segment.participants[slot].virtual_time_ns;
+  for (int i = 0; i < internal::kMaxDeviceArbiterParticipants; ++i) {
+    const DeviceArbiterParticipant& participant = segment.participants[i];
+    if (i == slot || participant.pid == 0 || participant.num_waiting == 0) {
+      continue;
+    }
+    if (participant.virtual_time_ns < virtual_time_ns ||
+        (participant.virtual_time_ns == virtual_time_ns && i < slot)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void InitializeSegment(DeviceArbiterSegment* segment, int64_t max_in_flight) {
+  pthread_mutexattr_t mutex_attr;
+  pthread_mutexattr_init(&mutex_attr);
+  pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+  pthread_mutexattr_setrobust(&mutex_attr, PTHREAD_MUTEX_ROBUST);
+  pthread_mutex_init(&segment->mu, &mutex_attr);
+  pthread_mutexattr_destroy(&mutex_attr);
+
+  pthread_condattr_t cond_attr;
+  pthread_condattr_init(&cond_attr);
+  pthread_condattr_setpshared(&cond_attr, PTHREAD_PROCESS_SHARED);
+  pthread_cond_init(&segment->cv, &cond_attr);
+  pthread_condattr_destroy(&cond_attr);
+
+  segment->max_in_flight = max_in_flight;
+  segment->num_in_flight = 0;
+  segment->magic.store(internal::kDeviceArbiterMagic,
+                       std::memory_order_release);
+}
+
+// Maps the segment `name`, creating and initializing it if it does not exist.
+absl::StatusOr<DeviceArbiterSegment*> OpenSegment(const std::string& name,
+                                                  int64_t max_in_flight) {
+  bool created = true;
+  int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (fd < 0 && errno == EEXIST) {
+    created = false;
+    fd = shm_open(name.c_str(), O_RDWR, 0600);
+  }
+  if (fd < 0) {
+    return errors::Internal("Failed to open shared memory segment ", name,
+                            ": ", std::strerror(errno));
+  }
+  const size_t size = sizeof(DeviceArbiterSegment);
+  const absl::Time deadline = absl::Now() + kInitializationTimeout;
+  if (created) {
+    // The new segment is zero-filled.
+    if (ftruncate(fd, size) != 0) {
+      const int error = errno;
+      close(fd);
+      return errors::Internal("Failed to resize shared memory segment ", name,
+                              ": ", std::strerror(error));
+    }
+  } else {
+    struct stat file_stat;
+    while (fstat(fd, &file_stat) == 0 &&
+           static_cast<size_t>(file_stat.st_size) < size) {
+      if (absl::Now() > deadline) {
+        close(fd);
+        return errors::FailedPrecondition("Shared memory segment ", name,
+                                          " was not initialized in time.");
+      }
+      Env::Default()->SleepForMicroseconds(kInitializationPollMicros);
+    }
+  }
+  void* address =
+      mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (address == MAP_FAILED) {
+    return errors::Internal("Failed to map shared memory segment ", name, ": ",
+                            std::strerror(errno));
+  }
+
+  auto* segment = static_cast<DeviceArbiterSegment*>(address);
+  if (created) {
+    InitializeSegment(segment, max_in_flight);
+    return segment;
+  }
+  while (segment->magic.load(std::memory_order_acquire) !=
+         internal::kDeviceArbiterMagic) {
+    if (absl::Now() > deadline) {
+      munmap(segment, size);
+      return errors::FailedPrecondition("Shared memory segment ", name,
+                                        " was not initialized in time.");
+    }
+    Env::Default()->SleepForMicroseconds(kInitializationPollMicros);
+  }
+  return segment;
+}
+
+int64_t GetProcessGpuLoadNs() {
+  return GpuSchedulingMetricsStorage::GetGlobalStorage()
+      .TotalGpuLoadNs()
+      .Get();
+}
+
+}  // namespace
+
+/*static*/ absl::StatusOr<std::unique_ptr<DeviceArbiter>>
+DeviceArbiter::Create(const Options& options) {
+  if (options.name.empty() || options.name[0] != '/') {
+    return errors::InvalidArgument(
+        "DeviceArbiter name must start with a '/'; got '", options.name, "'.");
+  }
+  if (options.weight <= 0) {
+    return errors::InvalidArgument("DeviceArbiter weight must be positive.");
+  }
+  if (options.max_in_flight <= 0) {
+    return errors::InvalidArgument(
+        "DeviceArbiter max_in_flight must be positive.");
+  }
+  TF_ASSIGN_OR_RETURN(DeviceArbiterSegment * segment,
+                      OpenSegment(options.name, options.max_in_flight));
+
+  int slot = -1;
+  {
+    SegmentLock l(segment);
+    ReapDeadParticipants(segment);
+    for (int i = 0; i < internal::kMaxDeviceArbiterParticipants; ++i) {
+      if (segment->participants[i].pid == 0) {
+        slot = i;
+        break;
+      }
+    }
+    if (slot >= 0) {
+      DeviceArbiterParticipant& participant = segment->participants[slot];
+      participant.pid = getpid();
+      participant.weight = options.weight;
+      // New participants start level with the others.
+      participant.virtual_time_ns =
+          MinVirtualTimeNs(*segment, slot, /*active_only=*/false)
+              .value_or(0.0);
+      participant.load_ns = GetProcessGpuLoadNs();
+    }
+  }
+  if (slot < 0) {
+    munmap(segment, sizeof(DeviceArbiterSegment));
+    return errors::ResourceExhausted("Device ", options.name, " has ",
+                                     internal::kMaxDeviceArbiterParticipants,
+                                     " participants already.");
+  }
+  return absl::WrapUnique(new DeviceArbiter(options, segment, slot));
+}
+
+DeviceArbiter::DeviceArbiter(const Options& options,
+                             internal::DeviceArbiterSegment* segment,
+                             int slot)
+    : options_(options), segment_(segment), slot_(slot) {}
+
+DeviceArbiter::~DeviceArbiter() {
+  {
+    SegmentLock l(segment_);
+    DeviceArbiterParticipant& participant = segment_->participants[slot_];
+    if (participant.pid == getpid()) {
+      segment_->num_in_flight -= participant.num_in_flight;
+      participant = DeviceArbiterParticipant();
+    }
+    pthread_cond_broadcast(&segment_->cv);
+  }
+  munmap(segment_, sizeof(DeviceArbiterSegment));
+}
+
+Status DeviceArbiter::Acquire() {
+  SegmentLock l(segment_);
+  DeviceArbiterParticipant& participant = segment_->participants[slot_];
+  if (participant.pid != getpid()) {
+    return errors::Internal("The slot of this participant of ", options_.name,
+                            " was reclaimed.");
+  }
+  if (participant.num_waiting == 0 && participant.num_in_flight == 0) {
+    // An idle participant does not get credit for the time it was idle.
+    std::optional<double> min_virtual_time_ns =
+        MinVirtualTimeNs(*segment_, slot_, /*active_only=*/true);
+    if (min_virtual_time_ns.has_value() &&
+        *min_virtual_time_ns > participant.virtual_time_ns) {
+      participant.virtual_time_ns = *min_virtual_time_ns;
+    }
+  }
+  ++participant.num_waiting;
+  while (segment_->num_in_flight >= segment_->max_in_flight ||
+         !IsNextInLine(*segment_, slot_)) {
+    l.WaitFor(kWaitTimeout);
+    ReapDeadParticipants(segment_);
+  }
+  --participant.num_waiting;
+  ++participant.num_in_flight;
+  ++segment_->num_in_flight;
+  participant.load_ns = GetProcessGpuLoadNs();
+  return absl::OkStatus();
+}
+
+void DeviceArbiter::Release(absl::Duration device_time) {
+  SegmentLock l(segment_);
+  DeviceArbiterParticipant& participant = segment_->participants[slot_];
+  if (participant.pid == getpid() && participant.num_in_flight > 0) {
+    --participant.num_in_flight;
+    --segment_->num_in_flight;
+    participant.virtual_time_ns +=
+        absl::ToDoubleNanoseconds(device_time) / options_.weight;
+    participant.load_ns = GetProcessGpuLoadNs();
+  }
+  pthread_cond_broadcast(&segment_->cv);
+}
+
+int64_t DeviceArbiter::NumInFlight() const {
+  SegmentLock l(segment_);
+  return segment_->num_in_flight;
+}
+
+int64_t DeviceArbiter::TotalLoadNs() const {
+  SegmentLock l(segment_);
+  int64_t total_load_ns = 0;
+  for (const DeviceArbiterParticipant& participant : segment_->participants) {
+    if (participant.pid != 0) {
+      total_load_ns += participant.load_ns;
+    }
+  }
+  return total_load_ns;
+}
+
+double DeviceArbiter::VirtualTimeNs() const {
+  SegmentLock l(segment_);
+  return segment_->participants[slot_].virtual_time_ns;
+}
+
+#else  // PLATFORM_WINDOWS
+
+namespace internal {
+struct DeviceArbiterSegment {};
+}  // namespace internal
+
+/*static*/ absl::StatusOr<std::unique_ptr<DeviceArbiter>>
+DeviceArbiter::Create(const Options& options) {
+  return errors::Unimplemented("DeviceArbiter is not supported on Windows.");
+}
+
+DeviceArbiter::DeviceArbiter(const Options& options,
+                             internal::DeviceArbiterSegment* segment,
+                             int slot)
+    : options_(options), segment_(segment), slot_(slot) {}
+
+DeviceArbiter::~DeviceArbiter() = default;
+
+Status DeviceArbiter::Acquire() {
+  return errors::Unimplemented("DeviceArbiter is not supported on Windows.");
+}
+
+void DeviceArbiter::Release(absl::Duration device_time) {}
+
+int64_t DeviceArbiter::NumInFlight() const { return 0; }
+
+int64_t DeviceArbiter::TotalLoadNs() const { return 0; }
+
+double DeviceArbiter::VirtualTimeNs() const { return 0; }
+
+#endif  // PLATFORM_WINDOWS
+
+}  // namespace serving
+}  // namespace tensorflow
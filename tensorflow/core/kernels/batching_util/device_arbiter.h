@@ -0,0 +1,113 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_DEVICE_ARBITER_H_
+#define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_DEVICE_ARBITER_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace serving {
+
+namespace internal {
+struct DeviceArbiterSegment;
+}  // namespace internal
+
+// EXPERIMENTAL: API MAY BE SUBJECTED TO SUDDEN CHANGES.
+//
+// Arbitrates a serial device (e.g. a GPU) among the batch schedulers of the
+// processes that share it, so that model servers running on the same device
+// take turns instead of contending for it.
+//
+// The participants of a device register in a POSIX shared memory segment
+// named after the device. Before processing a batch, a participant acquires a
+// time slice of the device; at most `max_in_flight` slices are granted at a
+// time across all processes. Slices are granted by weighted fair queueing:
+// each participant has a virtual time, which advances by the device time it
+// used divided by its weight, and the waiting participant with the earliest
+// virtual time is served first. A participant that was idle is moved forward
+// to the earliest virtual time of the active participants, so that it cannot
+// save up time slices while idle.
+//
+// Participants also publish the GPU load reported by their process's
+// `GpuSchedulingMetricsStorage`, so that each of them can observe the total
+// load of the device. Slots of processes that died are reclaimed, which
+// requires the participants to share a PID namespace.
+//
+// DeviceArbiter is thread-safe. Only supported on POSIX platforms.
+class DeviceArbiter {
+ public:
+  struct Options {
+    // The name of the shared memory segment, which identifies the device,
+    // e.g. "/tensorflow_gpu0_arbiter". Must start with a '/'.
+    std::string name;
+    // The share of the device this participant is entitled to, relative to
+    // the weights of the other participants. Must be positive.
+    double weight = 1.0;
+    // The maximum number of time slices granted at a time across all
+    // participants. Only the participant that creates the segment sets it.
+    int64_t max_in_flight = 1;
+  };
+
+  // Registers with the arbiter of `options.name`, creating its segment if it
+  // does not exist. Returns `ResourceExhausted` if the device has too many
+  // participants.
+  static absl::StatusOr<std::unique_ptr<DeviceArbiter>> Create(
+      const Options& options);
+
+  // Unregisters from the arbiter. The segment outlives its participants.
+  ~DeviceArbiter();
+
+  // Blocks until a time slice of the device is granted to this participant.
+  // Every successful call must be followed by a call to `Release`.
+  Status Acquire();
+
+  // Returns a time slice, charging `device_time` to this participant.
+  void Release(absl::Duration device_time);
+
+  // Returns the number of time slices currently granted across all
+  // participants.
+  int64_t NumInFlight() const;
+
+  // Returns the sum of the GPU loads last published by the participants, in
+  // nanoseconds.
+  int64_t TotalLoadNs() const;
+
+  // Returns the virtual time of this participant, in nanoseconds.
+  double VirtualTimeNs() const;
+
+ private:
+  DeviceArbiter(const Options& options, internal::DeviceArbiterSegment* segment,
+                int slot);
+
+  const Options options_;
+  internal::DeviceArbiterSegment* const segment_;
+  // The index of this participant in the segment.
+  const int slot_;
+
+  DeviceArbiter(const DeviceArbiter&) = delete;
+  void operator=(const DeviceArbiter&) = delete;
+};
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_DEVICE_ARBITER_H_
@@ -0,0 +1,157 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/device_arbiter.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "absl/time/time.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/strcat.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+// Creates a participant of the arbiter `name`, which must not fail.
+std::unique_ptr<DeviceArbiter> CreateArbiter(const std::string& name,
+                                             double weight = 1.0,
+                                             int64_t max_in_flight = 1) {
+  DeviceArbiter::Options options;
+  options.name = name;
+  options.weight = weight;
+  options.max_in_flight = max_in_flight;
+  auto arbiter = DeviceArbiter::Create(options);
+  TF_CHECK_OK(arbiter.status());
+  return std::move(arbiter).value();
+}
+
+class DeviceArbiterTest : public ::testing::Test {
+ protected:
+  DeviceArbiterTest()
+      : name_(strings::StrCat(
+            "/tf_device_arbiter_test_", getpid(), "_",
+            ::testing::UnitTest::GetInstance()->current_test_info()->name())) {
+  }
+  ~DeviceArbiterTest() override { shm_unlink(name_.c_str()); }
+
+  const std::string name_;
+};
+
+TEST_F(DeviceArbiterTest, InvalidOptions) {
+  DeviceArbiter::Options options;
+  options.name = "no_leading_slash";
+  EXPECT_FALSE(DeviceArbiter::Create(options).ok());
+  options.name = name_;
+  options.weight = 0;
+  EXPECT_FALSE(DeviceArbiter::Create(options).ok());
+  options.weight = 1;
+  options.max_in_flight = 0;
+  EXPECT_FALSE(DeviceArbiter::Create(options).ok());
+}
+
+TEST_F(DeviceArbiterTest, AcquireRelease) {
+  std::unique_ptr<DeviceArbiter> first = CreateArbiter(name_, 1.0, 2);
+  std::unique_ptr<DeviceArbiter> second = CreateArbiter(name_);
+  TF_ASSERT_OK(first->Acquire());
+  TF_ASSERT_OK(second->Acquire());
+  EXPECT_EQ(first->NumInFlight(), 2);
+  EXPECT_EQ(second->NumInFlight(), 2);
+  first->Release(absl::Milliseconds(1));
+  second->Release(absl::Milliseconds(1));
+  EXPECT_EQ(first->NumInFlight(), 0);
+}
+
+TEST_F(DeviceArbiterTest, ChargesDeviceTimeByWeight) {
+  std::unique_ptr<DeviceArbiter> arbiter = CreateArbiter(name_, 2.0);
+  const double initial_virtual_time_ns = arbiter->VirtualTimeNs();
+  TF_ASSERT_OK(arbiter->Acquire());
+  arbiter->Release(absl::Milliseconds(2));
+  EXPECT_DOUBLE_EQ(arbiter->VirtualTimeNs(), initial_virtual_time_ns + 1e6);
+}
+
+TEST_F(DeviceArbiterTest, LimitsInFlightTimeSlices) {
+  std::unique_ptr<DeviceArbiter> first = CreateArbiter(name_);
+  std::unique_ptr<DeviceArbiter> second = CreateArbiter(name_);
+  TF_ASSERT_OK(first->Acquire());
+
+  Notification acquired;
+  std::unique_ptr<Thread> thread(
+      Env::Default()->StartThread({}, "acquire", [&] {
+        TF_ASSERT_OK(second->Acquire());
+        acquired.Notify();
+      }));
+  EXPECT_FALSE(
+      acquired.WaitForNotificationWithTimeout(/*timeout_in_us=*/100000));
+  first->Release(absl::Milliseconds(1));
+  acquired.WaitForNotification();
+  EXPECT_EQ(second->NumInFlight(), 1);
+  second->Release(absl::Milliseconds(1));
+}
+
+TEST_F(DeviceArbiterTest, ServesEarliestVirtualTimeFirst) {
+  std::unique_ptr<DeviceArbiter> holder = CreateArbiter(name_);
+  std::unique_ptr<DeviceArbiter> busy = CreateArbiter(name_);
+  std::unique_ptr<DeviceArbiter> light = CreateArbiter(name_);
+  TF_ASSERT_OK(busy->Acquire());
+  busy->Release(absl::Milliseconds(10));
+  TF_ASSERT_OK(holder->Acquire());
+
+  mutex mu;
+  std::vector<std::string> order;
+  auto acquire = [&](DeviceArbiter* arbiter, const std::string& name) {
+    TF_ASSERT_OK(arbiter->Acquire());
+    {
+      mutex_lock l(mu);
+      order.push_back(name);
+    }
+    arbiter->Release(absl::ZeroDuration());
+  };
+  {
+    std::unique_ptr<Thread> busy_thread(Env::Default()->StartThread(
+        {}, "busy", [&] { acquire(busy.get(), "busy"); }));
+    std::unique_ptr<Thread> light_thread(Env::Default()->StartThread(
+        {}, "light", [&] { acquire(light.get(), "light"); }));
+    // Wait for both participants to queue up before releasing the device.
+    Env::Default()->SleepForMicroseconds(100000);
+    holder->Release(absl::Milliseconds(1));
+  }
+  EXPECT_EQ(order, std::vector<std::string>({"light", "busy"}));
+}
+
+TEST_F(DeviceArbiterTest, ReclaimsSlotsOfDestroyedParticipants) {
+  std::unique_ptr<DeviceArbiter> first = CreateArbiter(name_);
+  TF_ASSERT_OK(first->Acquire());
+  first.reset();
+  std::unique_ptr<DeviceArbiter> second = CreateArbiter(name_);
+  EXPECT_EQ(second->NumInFlight(), 0);
+  TF_ASSERT_OK(second->Acquire());
+  second->Release(absl::Milliseconds(1));
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
@@ -0,0 +1,112 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/ragged_batch_layout.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace serving {
+
+Status RaggedBatchLayout::Add(const TensorShape& shape) {
+  if (shape.dims() < 2) {
+    return errors::InvalidArgument(
+        "Ragged batching inputs must have at least two dimensions; got shape ",
+        shape.DebugString(), ".");
+  }
+  components_.push_back({shape.dim_size(0), shape.dim_size(1)});
+  num_rows_ += shape.dim_size(0);
+  num_values_ += shape.dim_size(0) * shape.dim_size(1);
+  return absl::OkStatus();
+}
+
+/*static*/ Status RaggedBatchLayout::Flatten(const Tensor& component,
+                                             Tensor* values) {
+  if (component.dims() < 2) {
+    return errors::InvalidArgument(
+        "Ragged batching inputs must have at least two dimensions; got shape ",
+        component.shape().DebugString(), ".");
+  }
+  TensorShape shape({component.dim_size(0) * component.dim_size(1)});
+  for (int dim = 2; dim < component.dims(); ++dim) {
+    shape.AddDim(component.dim_size(dim));
+  }
+  if (!values->CopyFrom(component, shape)) {
+    return errors::Internal("Could not flatten tensor of shape ",
+                            component.shape().DebugString(), ".");
+  }
+  return absl::OkStatus();
+}
+
+Tensor RaggedBatchLayout::RowSplits() const {
+  Tensor row_splits(DT_INT64, TensorShape({num_rows_ + 1}));
+  auto splits = row_splits.vec<int64_t>();
+  int64_t row = 0;
+  int64_t offset = 0;
+  splits(row) = offset;
+  for (const Component& component : components_) {
+    for (int64_t i = 0; i < component.num_rows; ++i) {
+      offset += component.row_length;
+      splits(++row) = offset;
+    }
+  }
+  return row_splits;
+}
+
+Status RaggedBatchLayout::Split(const Tensor& values,
+                                std::vector<Tensor>* components) const {
+  if (values.dims() == 0 || values.dim_size(0) != num_values_) {
+    return errors::FailedPrecondition(
+        "Ragged batched output tensor's 0th dimension does not equal the "
+        "number of values of the batch (",
+        num_values_, "); got shape ", values.shape().DebugString(), ".");
+  }
+  std::vector<int64_t> sizes;
+  sizes.reserve(components_.size());
+  for (const Component& component : components_) {
+    sizes.push_back(component.num_rows * component.row_length);
+  }
+  std::vector<Tensor> pieces;
+  TF_RETURN_IF_ERROR(tensor::Split(values, sizes, &pieces));
+
+  components->clear();
+  components->reserve(components_.size());
+  for (int i = 0; i < components_.size(); ++i) {
+    TensorShape shape({components_[i].num_rows, components_[i].row_length});
+    for (int dim = 1; dim < values.dims(); ++dim) {
+      shape.AddDim(values.dim_size(dim));
+    }
+    Tensor component;
+    if (!component.CopyFrom(pieces[i], shape)) {
+      return errors::Internal("Could not reshape tensor of shape ",
+                              pieces[i].shape().DebugString(), " to ",
+                              shape.DebugString(), ".");
+    }
+    components->push_back(std::move(component));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace serving
+}  // namespace tensorflow
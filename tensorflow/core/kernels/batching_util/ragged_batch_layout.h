@@ -0,0 +1,72 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_RAGGED_BATCH_LAYOUT_H_
+#define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_RAGGED_BATCH_LAYOUT_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace serving {
+
+// RaggedBatchLayout describes a batch of variable-length components that are
+// concatenated along their first non-batch axis instead of being padded to a
+// common shape.
+//
+// A component of shape [num_rows, row_length, ...] contributes `num_rows` rows
+// of `row_length` values each. The batch is the values of a ragged tensor:
+// the components flattened to [num_rows * row_length, ...] and concatenated,
+// with row splits that give the range of values of each row.
+class RaggedBatchLayout {
+ public:
+  // Appends a component of shape `shape` to the layout. Returns an
+  // `InvalidArgument` error if it has fewer than two dimensions.
+  Status Add(const TensorShape& shape);
+
+  // Returns `component` flattened to [num_rows * row_length, ...], sharing its
+  // buffer.
+  static Status Flatten(const Tensor& component, Tensor* values);
+
+  int64_t num_rows() const { return num_rows_; }
+  int64_t num_values() const { return num_values_; }
+
+  // Returns the int64 row splits of the batch, of shape [num_rows() + 1]: the
+  // values of row `r` are [row_splits[r], row_splits[r + 1]).
+  Tensor RowSplits() const;
+
+  // Splits `values`, laid out like the batch, back into one tensor of shape
+  // [num_rows, row_length, ...] per component, in order.
+  Status Split(const Tensor& values, std::vector<Tensor>* components) const;
+
+ private:
+  struct Component {
+    int64_t num_rows;
+    int64_t row_length;
+  };
+
+  std::vector<Component> components_;
+  int64_t num_rows_ = 0;
+  int64_t num_values_ = 0;
+};
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_RAGGED_BATCH_LAYOUT_H_
@@ -0,0 +1,86 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/ragged_batch_layout.h"
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+TEST(RaggedBatchLayoutTest, RowSplits) {
+  RaggedBatchLayout layout;
+  TF_ASSERT_OK(layout.Add(TensorShape({2, 3})));
+  TF_ASSERT_OK(layout.Add(TensorShape({1, 0})));
+  TF_ASSERT_OK(layout.Add(TensorShape({1, 5, 4})));
+  EXPECT_EQ(layout.num_rows(), 4);
+  EXPECT_EQ(layout.num_values(), 11);
+  test::ExpectEqual(layout.RowSplits(),
+                    test::AsTensor<int64_t>({0, 3, 6, 6, 11}));
+}
+
+TEST(RaggedBatchLayoutTest, RejectsRankOneComponents) {
+  RaggedBatchLayout layout;
+  EXPECT_TRUE(errors::IsInvalidArgument(layout.Add(TensorShape({2}))));
+  Tensor values;
+  EXPECT_TRUE(errors::IsInvalidArgument(RaggedBatchLayout::Flatten(
+      test::AsTensor<float>({1, 2}), &values)));
+}
+
+TEST(RaggedBatchLayoutTest, Flatten) {
+  Tensor component = test::AsTensor<float>({1, 2, 3, 4, 5, 6, 7, 8},
+                                           TensorShape({2, 2, 2}));
+  Tensor values;
+  TF_ASSERT_OK(RaggedBatchLayout::Flatten(component, &values));
+  test::ExpectEqual(values, test::AsTensor<float>({1, 2, 3, 4, 5, 6, 7, 8},
+                                                  TensorShape({4, 2})));
+  EXPECT_TRUE(values.SharesBufferWith(component));
+}
+
+TEST(RaggedBatchLayoutTest, Split) {
+  RaggedBatchLayout layout;
+  TF_ASSERT_OK(layout.Add(TensorShape({1, 2})));
+  TF_ASSERT_OK(layout.Add(TensorShape({2, 1})));
+  std::vector<Tensor> components;
+  TF_ASSERT_OK(layout.Split(
+      test::AsTensor<float>({1, 10, 2, 20, 3, 30, 4, 40}, TensorShape({4, 2})),
+      &components));
+  ASSERT_EQ(components.size(), 2);
+  test::ExpectEqual(components[0], test::AsTensor<float>(
+                                       {1, 10, 2, 20}, TensorShape({1, 2, 2})));
+  test::ExpectEqual(components[1], test::AsTensor<float>(
+                                       {3, 30, 4, 40}, TensorShape({2, 1, 2})));
+}
+
+TEST(RaggedBatchLayoutTest, SplitRejectsWrongNumberOfValues) {
+  RaggedBatchLayout layout;
+  TF_ASSERT_OK(layout.Add(TensorShape({1, 2})));
+  std::vector<Tensor> components;
+  EXPECT_TRUE(errors::IsFailedPrecondition(
+      layout.Split(test::AsTensor<float>({1, 2, 3}), &components)));
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
@@ -22,12 +22,15 @@ limitations under the License.
 #include <unordered_map>
 #include <vector>
 
+#include "absl/time/time.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
+#include "tensorflow/core/kernels/batching_util/device_arbiter.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
 
@@ -95,6 +98,10 @@ class SerialDeviceBatchScheduler : public std::enable_shared_from_this<
     // in_flight_batches_limit.  Larger numbers will reduce noise, but will be
     // less responsive to sudden changes in workload.
     int64_t batches_to_average_over = 1000;
+    // If set, each batch is processed during a time slice of the serial device
+    // granted by this arbiter, which shares the device with the schedulers of
+    // other processes.
+    std::shared_ptr<DeviceArbiter> device_arbiter;
   };
 
   // Ownership is shared between the caller of Create() and any queues created
@@ -408,10 +415,24 @@ void SerialDeviceBatchScheduler<TaskType>::ProcessBatches() {
     batch->queue()->ReleaseBatch(batch);
     auto callback = queues_and_callbacks_[batch->queue()];
     mu_.unlock();
+    bool device_acquired = false;
+    if (options_.device_arbiter != nullptr) {
+      const Status status = options_.device_arbiter->Acquire();
+      if (status.ok()) {
+        device_acquired = true;
+      } else {
+        LOG(WARNING) << "Processing batch without a device time slice: "
+                     << status;
+      }
+    }
     int64_t start_time = env()->NowMicros();
     callback(std::unique_ptr<Batch<TaskType>>(
         const_cast<internal::SDBSBatch<TaskType>*>(batch)));
     int64_t end_time = env()->NowMicros();
+    if (device_acquired) {
+      options_.device_arbiter->Release(
+          absl::Microseconds(end_time - start_time));
+    }
     mu_.lock();
     batch_count_++;
     batch_latency_sum_ += end_time - start_time;
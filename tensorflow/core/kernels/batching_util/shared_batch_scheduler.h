@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <stddef.h>
 
+#include <algorithm>
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
@@ -25,6 +26,7 @@ limitations under the License.
 #include <functional>
 #include <list>
 #include <memory>
+#include <optional>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -263,6 +265,24 @@ class SharedBatchScheduler
     PriorityQueueOptions high_priority_queue_options;
     // A subset of queue options for low priority input.
     PriorityQueueOptions low_priority_queue_options;
+    // How low priority tasks are added to high priority batches.
+    // Use iff `enable_priority_queue` is true.
+    MixedPriorityBatchingPolicy mixed_priority_batching_policy =
+        MixedPriorityBatchingPolicy::kLowPriorityPaddingWithMaxBatchSize;
+
+    // If set, returns the predicted time (in microseconds) it takes to process
+    // a batch of the given size, and makes the queue honor the deadlines of
+    // the tasks (see `BatchTask::deadline_micros()`):
+    //  - The open batch is closed as soon as the slack of its task with the
+    //    earliest deadline is no more than the predicted processing time of
+    //    the batch, even before `batch_timeout_micros`.
+    //  - Tasks that would miss their deadline even if processed alone right
+    //    away are rejected by Schedule() with a DEADLINE_EXCEEDED error,
+    //    rather than taking room in a batch.
+    //
+    // Tasks that are not derived from `BatchTask`, or have no deadline, are
+    // batched as usual.
+    std::function<int64_t(int batch_size)> predict_batch_processing_micros;
   };
   Status AddQueue(const QueueOptions& options,
                   ProcessBatchCallback process_batch_callback,
@@ -409,6 +429,10 @@ class Queue {
   // enable_priority_queue is false.
   std::vector<std::unique_ptr<TaskType>> GetLowPriorityTasks(size_t size);
 
+  // Returns the number of low priority task elements that may be added to a
+  // batch of `batch_size`, per `mixed_priority_batching_policy`.
+  size_t GetLowPriorityTaskPaddingSize(size_t batch_size) const;
+
   // Processes a batch that has been returned earlier by ScheduleBatch().
   void ProcessBatch(std::unique_ptr<Batch<TaskType>> batch,
                     std::vector<std::unique_ptr<TaskType>> padding_task);
@@ -445,6 +469,23 @@ class Queue {
   // Returns true iff the task is a low priority task based on the queue option.
   bool IsLowPriorityTask(std::unique_ptr<TaskType>* task);
 
+  // Returns the deadline of `task`, if it has one and the queue honors
+  // deadlines.
+  std::optional<uint64> TaskDeadlineMicros(const TaskType& task) const;
+
+  // Returns a DEADLINE_EXCEEDED error if `task` is predicted to miss its
+  // deadline.
+  Status ValidateTaskDeadline(const TaskType& task) const;
+
+  // Records that a task with `deadline_micros` was added to the open batch.
+  void UpdateOpenBatchDeadline(std::optional<uint64> deadline_micros)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Returns true iff the open batch, of `open_batch_size`, has to be processed
+  // now for its earliest task deadline to be met.
+  bool IsOpenBatchOutOfSlack(size_t open_batch_size) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // Implementation of ScheduleWithoutOrEagerSplit above. Enqueues `task` as it
   // is or split it inline (eagerly) to form batches to be processed by
   // `Queue<TaskType>::ProcessBatch`
@@ -579,6 +620,11 @@ class Queue {
   // task.
   uint64 open_batch_start_time_micros_ TF_GUARDED_BY(mu_);
 
+  // The earliest deadline of the tasks in the open (back-most) batch, if any
+  // of them has one.
+  std::optional<uint64> open_batch_earliest_deadline_micros_
+      TF_GUARDED_BY(mu_);
+
   // Whether this queue contains a batch that is eligible to be scheduled.
   // Used to keep track of when to call 'schedulable_batch_callback_'.
   bool schedulable_batch_ TF_GUARDED_BY(mu_) = false;
@@ -854,10 +900,9 @@ void SharedBatchScheduler<TaskType>::ThreadLogic() {
         std::move(absl::get<BatchTaskUniqueptr>(batch_to_process));
   }
 
-  // TODO(b/316379576): Make the policy determine between padding up to the max
-  // batch size and up to the next smallest allowed batch size.
   size_t low_priority_task_padding_size =
-      queue_for_batch->max_execution_batch_size() - batch_to_schedule->size();
+      queue_for_batch->GetLowPriorityTaskPaddingSize(
+          batch_to_schedule->size());
   queue_for_batch->ProcessBatch(
       std::move(batch_to_schedule),
       queue_for_batch->GetLowPriorityTasks(low_priority_task_padding_size));
@@ -904,6 +949,7 @@ Queue<TaskType>::~Queue() {
 
 template <typename TaskType>
 Status Queue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
+  TF_RETURN_IF_ERROR(ValidateTaskDeadline(**task));
   if (options_.enable_lazy_split) {
     return ScheduleWithLazySplit(std::move(task));
   }
@@ -930,6 +976,7 @@ Status Queue<TaskType>::ScheduleWithLazySplit(std::unique_ptr<TaskType>* task) {
 
     const int64 open_batch_capacity =
         max_execution_batch_size - this->tail_batch_task_size();
+    const std::optional<uint64> deadline_micros = TaskDeadlineMicros(**task);
 
     auto input_batch = std::make_shared<BatchInputTask<TaskType>>(
         std::move(*task), open_batch_capacity, max_execution_batch_size,
@@ -945,7 +992,9 @@ Status Queue<TaskType>::ScheduleWithLazySplit(std::unique_ptr<TaskType>* task) {
       }
       if (task_handle_batches_.back()->empty()) {
         open_batch_start_time_micros_ = env_->NowMicros();
+        open_batch_earliest_deadline_micros_.reset();
       }
+      UpdateOpenBatchDeadline(deadline_micros);
       profiler::TraceMeProducer trace_me(
           [&task_handles, i] {
             return profiler::TraceMeEncode("ScheduleOutputTask",
@@ -994,6 +1043,62 @@ bool Queue<TaskType>::IsLowPriorityTask(std::unique_ptr<TaskType>* task) {
   return false;
 }
 
+template <typename TaskType>
+std::optional<uint64> Queue<TaskType>::TaskDeadlineMicros(
+    const TaskType& task) const {
+  if (!options_.predict_batch_processing_micros) {
+    return std::nullopt;
+  }
+  // The deadline is defined only when the task is a derived class of
+  // BatchTask.
+  if constexpr (std::is_base_of_v<BatchTask, TaskType>) {
+    return task.deadline_micros();
+  }
+  return std::nullopt;
+}
+
+template <typename TaskType>
+Status Queue<TaskType>::ValidateTaskDeadline(const TaskType& task) const {
+  const std::optional<uint64> deadline_micros = TaskDeadlineMicros(task);
+  if (!deadline_micros.has_value()) {
+    return absl::OkStatus();
+  }
+  const int64_t processing_micros = options_.predict_batch_processing_micros(
+      std::min(task.size(), max_execution_batch_size()));
+  const uint64 now_micros = env_->NowMicros();
+  if (now_micros + processing_micros > *deadline_micros) {
+    return absl::DeadlineExceededError(absl::StrFormat(
+        "The task is predicted to miss its deadline: processing it takes %d "
+        "microseconds, and its deadline is in %d microseconds",
+        processing_micros,
+        static_cast<int64_t>(*deadline_micros) -
+            static_cast<int64_t>(now_micros)));
+  }
+  return absl::OkStatus();
+}
+
+template <typename TaskType>
+void Queue<TaskType>::UpdateOpenBatchDeadline(
+    std::optional<uint64> deadline_micros) {
+  if (!deadline_micros.has_value()) {
+    return;
+  }
+  if (!open_batch_earliest_deadline_micros_.has_value() ||
+      *deadline_micros < *open_batch_earliest_deadline_micros_) {
+    open_batch_earliest_deadline_micros_ = deadline_micros;
+  }
+}
+
+template <typename TaskType>
+bool Queue<TaskType>::IsOpenBatchOutOfSlack(size_t open_batch_size) const {
+  if (!open_batch_earliest_deadline_micros_.has_value()) {
+    return false;
+  }
+  return env_->NowMicros() +
+             options_.predict_batch_processing_micros(open_batch_size) >=
+         *open_batch_earliest_deadline_micros_;
+}
+
 template <typename TaskType>
 Status Queue<TaskType>::ScheduleWithoutOrEagerSplitImpl(
     std::unique_ptr<TaskType>* task) {
@@ -1008,6 +1113,7 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplitImpl(
       max_execution_batch_size() - batches.back()->size();
 
   const int64_t input_task_size = (*task)->size();
+  const std::optional<uint64> deadline_micros = TaskDeadlineMicros(**task);
 
   std::vector<std::unique_ptr<TaskType>> output_tasks;
 
@@ -1026,7 +1132,9 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplitImpl(
     }
     if (batches.back()->empty()) {
       open_batch_start_time_micros_ = env_->NowMicros();
+      open_batch_earliest_deadline_micros_.reset();
     }
+    UpdateOpenBatchDeadline(deadline_micros);
     profiler::TraceMeProducer trace_me(
         [&output_tasks, i] {
           return profiler::TraceMeEncode("ScheduleOutputTask",
@@ -1289,6 +1397,27 @@ std::vector<std::unique_ptr<TaskType>> Queue<TaskType>::GetLowPriorityTasks(
   return low_priority_tasks_to_pad;
 }
 
+template <typename TaskType>
+size_t Queue<TaskType>::GetLowPriorityTaskPaddingSize(
+    size_t batch_size) const {
+  switch (options_.mixed_priority_batching_policy) {
+    case MixedPriorityBatchingPolicy::kLowPriorityPaddingWithMaxBatchSize:
+      return max_execution_batch_size() - batch_size;
+    case MixedPriorityBatchingPolicy::
+        kLowPriorityPaddingWithNextAllowedBatchSize:
+      if (options_.disable_padding) return 0;
+      for (int32 allowed_batch_size : options_.allowed_batch_sizes) {
+        if (static_cast<size_t>(allowed_batch_size) >= batch_size) {
+          return allowed_batch_size - batch_size;
+        }
+      }
+      return 0;
+    case MixedPriorityBatchingPolicy::kPriorityIsolation:
+      return 0;
+  }
+  return 0;
+}
+
 template <typename TaskType>
 void Queue<TaskType>::ProcessBatch(
     std::unique_ptr<Batch<TaskType>> batch,
@@ -1386,7 +1515,8 @@ bool Queue<TaskType>::IsOpenBatchSchedulableAfterEagerSplit() const {
   }
   return closed_ || open_batch->size() >= max_execution_batch_size() ||
          env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+             open_batch_start_time_micros_ + options_.batch_timeout_micros ||
+         IsOpenBatchOutOfSlack(open_batch->size());
 }
 
 template <typename TaskType>
@@ -1401,7 +1531,8 @@ bool Queue<TaskType>::IsOpenBatchSchedulable() const {
   }
   return closed_ || open_batch->size() >= max_execution_batch_size() ||
          env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+             open_batch_start_time_micros_ + options_.batch_timeout_micros ||
+         IsOpenBatchOutOfSlack(open_batch->size());
 }
 
 template <typename TaskType>
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <cstddef>
 #include <memory>
+#include <optional>
 #include <string>
 #include <thread>  // NOLINT(build/c++11)
 #include <tuple>
@@ -46,6 +47,7 @@ namespace tensorflow {
 namespace serving {
 namespace {
 
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
 
 class FakeTask : public BatchTask {
@@ -62,9 +64,18 @@ class FakeTask : public BatchTask {
     return criticality_;
   }
 
+  std::optional<uint64> deadline_micros() const override {
+    return deadline_micros_;
+  }
+
+  void set_deadline_micros(uint64 deadline_micros) {
+    deadline_micros_ = deadline_micros;
+  }
+
  private:
   const size_t size_;
   const tsl::criticality::Criticality criticality_;
+  std::optional<uint64> deadline_micros_;
 
   FakeTask(const FakeTask&) = delete;
   void operator=(const FakeTask&) = delete;
@@ -108,6 +119,19 @@ Status ScheduleTask(size_t task_size, BatchScheduler<FakeTask>* scheduler,
   return status;
 }
 
+// Creates a FakeTask of size 'task_size' that must be processed by
+// 'deadline_micros', and calls 'scheduler->Schedule()' on that task. Returns
+// the resulting status.
+Status ScheduleTaskWithDeadline(size_t task_size, uint64 deadline_micros,
+                                BatchScheduler<FakeTask>* scheduler) {
+  auto task = std::make_unique<FakeTask>(task_size);
+  task->set_deadline_micros(deadline_micros);
+  Status status = scheduler->Schedule(&task);
+  // Schedule() should have consumed 'task' iff it returned Status::OK.
+  CHECK_EQ(status.ok(), task == nullptr);
+  return status;
+}
+
 // Helper function similar to the function above. Creates a FakeTask of size
 // 'task_size' and calls 'scheduler->Schedule()' on that task. Returns the
 // resulting status.
@@ -645,6 +669,82 @@ TEST_P(SharedBatchSchedulerTest, ObeysTimeout) {
   stop_teardown.Notify();
 }
 
+TEST_P(SharedBatchSchedulerTest, ClosesBatchWhenDeadlineSlackRunsOut) {
+  // Set up a fake clock, which only advances when we explicitly tell it to.
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    Notification batch_processed;
+    auto callback = [&batch_processed](std::unique_ptr<Batch<FakeTask>> batch) {
+      ASSERT_TRUE(batch->IsClosed());
+      EXPECT_EQ(batch->size(), 2);
+      batch_processed.Notify();
+    };
+
+    auto scheduler = CreateSharedBatchScheduler(1, &env);
+    QueueOptions options = CreateQueueOptions(
+        /*max_execution_batch_size=*/10, /*input_batch_size_limit=*/10,
+        /*batch_timeout_micros=*/1000, /*max_enqueued_batches=*/2);
+    // Processing a batch takes 5 microseconds plus one per element.
+    options.predict_batch_processing_micros = [](int batch_size) {
+      return int64_t{5} + batch_size;
+    };
+    auto queue = CreateQueue(scheduler, options, callback);
+
+    // The batch of size 2 has to start by 30 - 7 = 23 microseconds to meet the
+    // earliest deadline, long before the timeout.
+    TF_ASSERT_OK(ScheduleTaskWithDeadline(1, /*deadline_micros=*/50,
+                                          queue.get()));
+    TF_ASSERT_OK(ScheduleTaskWithDeadline(1, /*deadline_micros=*/30,
+                                          queue.get()));
+    env.AdvanceByMicroseconds(22);
+    Env::Default()->SleepForMicroseconds(10 * 1000 /* 10 milliseconds */);
+    EXPECT_FALSE(batch_processed.HasBeenNotified());
+    env.AdvanceByMicroseconds(1);
+    batch_processed.WaitForNotification();
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
+TEST_P(SharedBatchSchedulerTest, RejectsTaskPredictedToMissDeadline) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    auto callback = [](std::unique_ptr<Batch<FakeTask>> batch) {
+      ASSERT_TRUE(batch->IsClosed());
+    };
+    auto scheduler = CreateSharedBatchScheduler(1, &env);
+    QueueOptions options = CreateQueueOptions(
+        /*max_execution_batch_size=*/10, /*input_batch_size_limit=*/10,
+        /*batch_timeout_micros=*/0, /*max_enqueued_batches=*/2);
+    options.predict_batch_processing_micros = [](int /*batch_size*/) {
+      return int64_t{100};
+    };
+    auto queue = CreateQueue(scheduler, options, callback);
+
+    env.AdvanceByMicroseconds(1000);
+    Status status =
+        ScheduleTaskWithDeadline(1, /*deadline_micros=*/1050, queue.get());
+    EXPECT_TRUE(errors::IsDeadlineExceeded(status)) << status;
+    EXPECT_EQ(queue->NumEnqueuedTasks(), 0);
+    TF_EXPECT_OK(
+        ScheduleTaskWithDeadline(1, /*deadline_micros=*/1100, queue.get()));
+    // Tasks without a deadline are not rejected.
+    TF_EXPECT_OK(ScheduleTask(1, queue.get()));
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
 TEST_P(SharedBatchSchedulerTest, ObeysTimeoutWithRealClock) {
   Notification first_batch_processed, second_batch_processed;
   auto callback = [&first_batch_processed, &second_batch_processed](
@@ -1317,6 +1417,91 @@ TEST_P(SharedBatchSchedulerPriorityTest,
 
 // Lazy split is to be removed. The mixed priority batching is only supported
 // when the lazy split is not enabled.
+// Returns the number of low priority padding tasks of each batch processed by a
+// queue created with `mixed_priority_batching_policy` and allowed batch sizes
+// {2, 6, 10}, given high priority tasks of sizes 1 and 3 and low priority
+// tasks of size 2 and 2.
+std::vector<size_t> GetNumPaddingTasksPerBatch(
+    std::shared_ptr<Scheduler> scheduler, QueueOptions queue_options,
+    MixedPriorityBatchingPolicy mixed_priority_batching_policy) {
+  mutex mu;
+  std::vector<size_t> num_padding_tasks;
+  auto queue_callback = [&mu, &num_padding_tasks](
+                            std::unique_ptr<Batch<FakeTask>> batch,
+                            std::vector<std::unique_ptr<FakeTask>> tasks) {
+    mutex_lock l(mu);
+    num_padding_tasks.push_back(tasks.size());
+  };
+  queue_options.allowed_batch_sizes = {2, 6, 10};
+  queue_options.low_priority_queue_options.max_execution_batch_size = 10;
+  // Low priority tasks left after the high priority batch are processed soon.
+  queue_options.low_priority_queue_options.batch_timeout_micros = 1000;
+  queue_options.low_priority_queue_options.input_batch_size_limit = 10;
+  queue_options.low_priority_queue_options.max_enqueued_batches = 2;
+  queue_options.mixed_priority_batching_policy =
+      mixed_priority_batching_policy;
+  {
+    std::unique_ptr<Queue> queue =
+        CreateQueue(scheduler, queue_options, queue_callback);
+    TF_CHECK_OK(ScheduleTask(1, queue.get(),
+                             tsl::criticality::Criticality::kCriticalPlus));
+    TF_CHECK_OK(ScheduleTask(3, queue.get(),
+                             tsl::criticality::Criticality::kCriticalPlus));
+    TF_CHECK_OK(ScheduleTask(2, queue.get(),
+                             tsl::criticality::Criticality::kSheddable));
+    TF_CHECK_OK(ScheduleTask(2, queue.get(),
+                             tsl::criticality::Criticality::kSheddable));
+  }
+  mutex_lock l(mu);
+  return num_padding_tasks;
+}
+
+TEST_P(SharedBatchSchedulerPriorityTest, LowPriorityPaddingWithMaxBatchSize) {
+  std::shared_ptr<Scheduler> scheduler =
+      CreateSharedBatchScheduler(/*num_batch_threads=*/1);
+  QueueOptions queue_options = CreateQueueOptions(
+      /*max_execution_batch_size=*/10, /*input_batch_size_limit=*/10,
+      /*batch_timeout_micros=*/1 * 1000 * 1000, /*max_enqueued_batches=*/2,
+      /*enable_priority_queue=*/true);
+  // Both low priority tasks fit in the batch of size 4.
+  EXPECT_THAT(GetNumPaddingTasksPerBatch(
+                  scheduler, queue_options,
+                  MixedPriorityBatchingPolicy::
+                      kLowPriorityPaddingWithMaxBatchSize),
+              ElementsAre(2));
+}
+
+TEST_P(SharedBatchSchedulerPriorityTest,
+       LowPriorityPaddingWithNextAllowedBatchSize) {
+  std::shared_ptr<Scheduler> scheduler =
+      CreateSharedBatchScheduler(/*num_batch_threads=*/1);
+  QueueOptions queue_options = CreateQueueOptions(
+      /*max_execution_batch_size=*/10, /*input_batch_size_limit=*/10,
+      /*batch_timeout_micros=*/1 * 1000 * 1000, /*max_enqueued_batches=*/2,
+      /*enable_priority_queue=*/true);
+  // Only one low priority task fits in the padding of the batch of size 4 up
+  // to 6. The other one is processed in a batch of its own.
+  EXPECT_THAT(GetNumPaddingTasksPerBatch(
+                  scheduler, queue_options,
+                  MixedPriorityBatchingPolicy::
+                      kLowPriorityPaddingWithNextAllowedBatchSize),
+              ElementsAre(1, 0));
+}
+
+TEST_P(SharedBatchSchedulerPriorityTest, PriorityIsolation) {
+  std::shared_ptr<Scheduler> scheduler =
+      CreateSharedBatchScheduler(/*num_batch_threads=*/1);
+  QueueOptions queue_options = CreateQueueOptions(
+      /*max_execution_batch_size=*/10, /*input_batch_size_limit=*/10,
+      /*batch_timeout_micros=*/1 * 1000 * 1000, /*max_enqueued_batches=*/2,
+      /*enable_priority_queue=*/true);
+  EXPECT_THAT(
+      GetNumPaddingTasksPerBatch(
+          scheduler, queue_options,
+          MixedPriorityBatchingPolicy::kPriorityIsolation),
+      ElementsAre(0, 0));
+}
+
 INSTANTIATE_TEST_SUITE_P(
     Parameter, SharedBatchSchedulerPriorityTest,
     ::testing::Values(std::make_tuple(/*enable_input_batch_split=*/true,
@@ -0,0 +1,95 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/split_output_gatherer.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/util/batch_util.h"
+
+namespace tensorflow {
+namespace serving {
+
+SplitOutputGatherer::SplitOutputGatherer(int num_outputs,
+                                         std::vector<int64_t> split_sizes,
+                                         AllocateOutputFn allocate_output)
+    : allocate_output_(std::move(allocate_output)),
+      split_sizes_(std::move(split_sizes)),
+      outputs_(num_outputs, nullptr) {
+  split_offsets_.reserve(split_sizes_.size());
+  for (int64_t split_size : split_sizes_) {
+    split_offsets_.push_back(num_rows_);
+    num_rows_ += split_size;
+  }
+}
+
+Status SplitOutputGatherer::Gather(int split_index, int output_index,
+                                   const Tensor& output) {
+  if (split_index < 0 || split_index >= split_sizes_.size() ||
+      output_index < 0 || output_index >= outputs_.size()) {
+    return errors::Internal("Invalid split ", split_index, " or output ",
+                            output_index, " to gather");
+  }
+  if (output.dims() == 0 ||
+      output.dim_size(0) != split_sizes_[split_index]) {
+    return errors::FailedPrecondition(
+        "Output ", output_index, " of split ", split_index, " has shape ",
+        output.shape().DebugString(), "; expected ", split_sizes_[split_index],
+        " rows");
+  }
+
+  Tensor* task_output;
+  {
+    mutex_lock l(mu_);
+    if (outputs_[output_index] == nullptr) {
+      TensorShape shape = output.shape();
+      shape.set_dim(0, num_rows_);
+      TF_RETURN_IF_ERROR(
+          allocate_output_(output_index, shape, &outputs_[output_index]));
+    }
+    task_output = outputs_[output_index];
+  }
+  TensorShape expected_shape = task_output->shape();
+  expected_shape.set_dim(0, split_sizes_[split_index]);
+  if (output.dtype() != task_output->dtype() ||
+      output.shape() != expected_shape) {
+    return errors::FailedPrecondition(
+        "Output ", output_index, " of split ", split_index, " has type ",
+        DataTypeString(output.dtype()), " and shape ",
+        output.shape().DebugString(), "; expected type ",
+        DataTypeString(task_output->dtype()), " and shape ",
+        expected_shape.DebugString(), " like the other splits");
+  }
+  // Splits write disjoint rows, so they can be copied concurrently.
+  return batch_util::CopyContiguousSlices(
+      output, /*src_offset=*/0, split_offsets_[split_index],
+      split_sizes_[split_index], task_output);
+}
+
+bool SplitOutputGatherer::IsGathered(int output_index) const {
+  mutex_lock l(mu_);
+  return outputs_[output_index] != nullptr;
+}
+
+}  // namespace serving
+}  // namespace tensorflow
@@ -0,0 +1,78 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_SPLIT_OUTPUT_GATHERER_H_
+#define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_SPLIT_OUTPUT_GATHERER_H_
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace serving {
+
+// SplitOutputGatherer copies the outputs of the splits of a large task
+// directly into the outputs of the task, as each split is processed.
+//
+// Without it, the outputs of all splits are kept until the last split is
+// processed, and then concatenated by the thread that processed it. With it,
+// each batch thread copies the rows of its split as soon as its batch is done,
+// so that the copies of concurrent splits overlap and the last split only
+// copies its own rows.
+//
+// SplitOutputGatherer is thread-safe.
+class SplitOutputGatherer {
+ public:
+  // Allocates output `output_index` of the task, of shape `shape`.
+  using AllocateOutputFn = std::function<Status(
+      int output_index, const TensorShape& shape, Tensor** output)>;
+
+  // `split_sizes` gives the number of rows of each split, in order.
+  SplitOutputGatherer(int num_outputs, std::vector<int64_t> split_sizes,
+                      AllocateOutputFn allocate_output);
+
+  // Copies `output`, the output `output_index` of split `split_index`, into
+  // its rows of the task output, which is allocated from the shape of the
+  // first split to be gathered.
+  Status Gather(int split_index, int output_index, const Tensor& output);
+
+  // Returns true if a split of output `output_index` was gathered.
+  bool IsGathered(int output_index) const;
+
+ private:
+  const AllocateOutputFn allocate_output_;
+  // The first row of each split in the task output.
+  std::vector<int64_t> split_offsets_;
+  std::vector<int64_t> split_sizes_;
+  int64_t num_rows_ = 0;
+
+  mutable mutex mu_;
+  // The task outputs, or nullptr if not allocated yet.
+  std::vector<Tensor*> outputs_ TF_GUARDED_BY(mu_);
+
+  SplitOutputGatherer(const SplitOutputGatherer&) = delete;
+  void operator=(const SplitOutputGatherer&) = delete;
+};
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_SPLIT_OUTPUT_GATHERER_H_
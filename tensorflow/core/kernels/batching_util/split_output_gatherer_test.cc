@@ -0,0 +1,112 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/split_output_gatherer.h"
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+class SplitOutputGathererTest : public ::testing::Test {
+ protected:
+  SplitOutputGatherer::AllocateOutputFn AllocateOutputFn() {
+    return [this](int output_index, const TensorShape& shape,
+                  Tensor** output) {
+      outputs_[output_index] = Tensor(DT_FLOAT, shape);
+      ++num_allocations_;
+      *output = &outputs_[output_index];
+      return absl::OkStatus();
+    };
+  }
+
+  Tensor outputs_[2];
+  int num_allocations_ = 0;
+};
+
+TEST_F(SplitOutputGathererTest, GathersSplitsInPlace) {
+  SplitOutputGatherer gatherer(/*num_outputs=*/2, /*split_sizes=*/{1, 2},
+                               AllocateOutputFn());
+  EXPECT_FALSE(gatherer.IsGathered(0));
+  // Splits may be processed in any order.
+  TF_ASSERT_OK(gatherer.Gather(
+      1, 0, test::AsTensor<float>({3, 4, 5, 6}, TensorShape({2, 2}))));
+  TF_ASSERT_OK(gatherer.Gather(
+      0, 0, test::AsTensor<float>({1, 2}, TensorShape({1, 2}))));
+  EXPECT_TRUE(gatherer.IsGathered(0));
+  EXPECT_FALSE(gatherer.IsGathered(1));
+  EXPECT_EQ(num_allocations_, 1);
+  test::ExpectEqual(outputs_[0], test::AsTensor<float>({1, 2, 3, 4, 5, 6},
+                                                       TensorShape({3, 2})));
+}
+
+TEST_F(SplitOutputGathererTest, GathersConcurrentSplits) {
+  constexpr int kNumSplits = 8;
+  SplitOutputGatherer gatherer(/*num_outputs=*/1,
+                               std::vector<int64_t>(kNumSplits, 1),
+                               AllocateOutputFn());
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int i = 0; i < kNumSplits; ++i) {
+      threads.emplace_back(Env::Default()->StartThread({}, "gather", [&, i] {
+        TF_ASSERT_OK(gatherer.Gather(
+            i, 0, test::AsTensor<float>({static_cast<float>(i)})));
+      }));
+    }
+  }
+  EXPECT_EQ(num_allocations_, 1);
+  test::ExpectEqual(outputs_[0],
+                    test::AsTensor<float>({0, 1, 2, 3, 4, 5, 6, 7}));
+}
+
+TEST_F(SplitOutputGathererTest, RejectsMismatchedSplits) {
+  SplitOutputGatherer gatherer(/*num_outputs=*/1, /*split_sizes=*/{1, 2},
+                               AllocateOutputFn());
+  EXPECT_FALSE(gatherer.Gather(0, 0, test::AsTensor<float>({1, 2})).ok());
+  EXPECT_FALSE(gatherer.Gather(2, 0, test::AsTensor<float>({1})).ok());
+  EXPECT_FALSE(gatherer.Gather(0, 1, test::AsTensor<float>({1})).ok());
+  TF_ASSERT_OK(gatherer.Gather(
+      0, 0, test::AsTensor<float>({1, 2}, TensorShape({1, 2}))));
+  EXPECT_FALSE(gatherer.Gather(1, 0, test::AsTensor<float>({1, 2})).ok());
+  EXPECT_FALSE(gatherer.Gather(1, 0,
+                               test::AsTensor<int32>({1, 2, 3, 4},
+                                                     TensorShape({2, 2})))
+                   .ok());
+}
+
+TEST_F(SplitOutputGathererTest, PropagatesAllocationErrors) {
+  SplitOutputGatherer gatherer(
+      /*num_outputs=*/1, /*split_sizes=*/{1},
+      [](int output_index, const TensorShape& shape, Tensor** output) {
+        return errors::ResourceExhausted("Out of memory");
+      });
+  EXPECT_FALSE(gatherer.Gather(0, 0, test::AsTensor<float>({1})).ok());
+  EXPECT_FALSE(gatherer.IsGathered(0));
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
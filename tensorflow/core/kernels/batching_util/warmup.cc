@@ -14,14 +14,21 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/batching_util/warmup.h"
 
+#include <algorithm>
 #include <memory>
 #include <optional>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tsl/platform/logging.h"
 
 namespace tensorflow {
@@ -69,13 +76,89 @@ WarmupStateRegistry& GetGlobalWarmupStateRegistry() {
 }
 
 bool ShouldWarmupAllBatchSizes(const OpKernelContext* c) {
+  auto per_model_data = LookupWarmupState(c);
+  return per_model_data && per_model_data->warmup_all_batch_sizes;
+}
+
+const WarmupStateRegistry::PerModelData* LookupWarmupState(
+    const OpKernelContext* c) {
   auto metadata = c->session_metadata();
   if (metadata == nullptr || metadata->name().empty()) {
-    return false;
+    return nullptr;
   }
   serving::WarmupStateRegistry::Key key(metadata->name(), metadata->version());
-  auto per_model_data = serving::GetGlobalWarmupStateRegistry().Lookup(key);
-  return per_model_data && per_model_data->warmup_all_batch_sizes;
+  return serving::GetGlobalWarmupStateRegistry().Lookup(key);
+}
+
+namespace {
+
+// Runs each of `requests` `num_runs` times on `num_threads` threads, and
+// stores the total latency of request `i` in `(*latencies)[i]`. Stops
+// scheduling runs after the first error, which is returned.
+absl::Status RunRequests(absl::Span<const WarmupRequest> requests,
+                         int num_runs, int num_threads, Env* env,
+                         std::vector<absl::Duration>* latencies) {
+  latencies->assign(requests.size(), absl::ZeroDuration());
+  absl::Mutex mu;
+  absl::Status status;
+  {
+    thread::ThreadPool pool(env, "warmup", std::max(num_threads, 1));
+    for (size_t i = 0; i < requests.size(); ++i) {
+      pool.Schedule([&, i] {
+        for (int run = 0; run < num_runs; ++run) {
+          {
+            absl::MutexLock l(&mu);
+            if (!status.ok()) return;
+          }
+          const absl::Time start = absl::Now();
+          absl::Status s = requests[i].run();
+          (*latencies)[i] += absl::Now() - start;
+          if (!s.ok()) {
+            absl::MutexLock l(&mu);
+            status.Update(s);
+            return;
+          }
+        }
+      });
+    }
+    // The destructor of `pool` waits for all runs.
+  }
+  return status;
+}
+
+}  // namespace
+
+absl::StatusOr<absl::flat_hash_map<std::string, SignatureWarmupLatency>>
+RunWarmupRequests(absl::Span<const WarmupRequest> requests,
+                  const WarmupOptions& options, Env* env) {
+  std::vector<absl::Duration> first_run_latencies;
+  TF_RETURN_IF_ERROR(RunRequests(requests, /*num_runs=*/1,
+                                 options.num_threads, env,
+                                 &first_run_latencies));
+  std::vector<absl::Duration> steady_run_latencies;
+  const int num_steady_runs = std::max(options.num_steady_runs, 0);
+  TF_RETURN_IF_ERROR(RunRequests(requests, num_steady_runs,
+                                 options.num_threads, env,
+                                 &steady_run_latencies));
+
+  absl::flat_hash_map<std::string, SignatureWarmupLatency> result;
+  for (size_t i = 0; i < requests.size(); ++i) {
+    SignatureWarmupLatency& latency = result[requests[i].signature_name];
+    ++latency.num_requests;
+    latency.first_run_latency += first_run_latencies[i];
+    latency.steady_run_latency += steady_run_latencies[i];
+  }
+  for (auto& [signature_name, latency] : result) {
+    latency.first_run_latency /= latency.num_requests;
+    latency.steady_run_latency /=
+        latency.num_requests * std::max(num_steady_runs, 1);
+    LOG(INFO) << "Warm-up of signature " << signature_name << ": "
+              << latency.num_requests << " requests, first run "
+              << absl::FormatDuration(latency.first_run_latency)
+              << ", steady run "
+              << absl::FormatDuration(latency.steady_run_latency);
+  }
+  return result;
 }
 
 }  // namespace serving
@@ -16,16 +16,24 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_WARMUP_H_
 #define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_WARMUP_H_
 
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/hash/hash.h"
 #include "absl/status/statusor.h"
+#include "absl/status/status.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/kernels/batching_util/batch_size_profile.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tsl/platform/logging.h"
 
@@ -59,6 +67,14 @@ class WarmupStateRegistry {
     // for all `allowed_batch_sizes` of that batch op. This removes the
     // need to issue separate warmup requests for each batch size.
     bool warmup_all_batch_sizes = false;
+    // Batch sizes to also run dummy batches for when `warmup_all_batch_sizes`
+    // is true, e.g. candidates for `allowed_batch_sizes`. Sizes larger than
+    // the maximum batch size of a batch op are skipped.
+    std::vector<int32> profiled_batch_sizes;
+    // If set, supported batch ops record the latency of their dummy batches
+    // here, from which `allowed_batch_sizes` can be chosen for the next load
+    // of the model (see `ChooseAllowedBatchSizes`).
+    std::shared_ptr<BatchSizeProfile> batch_size_profile;
   };
 
   // RAII handle for registered models.
@@ -126,6 +142,46 @@ WarmupStateRegistry& GetGlobalWarmupStateRegistry();
 // based on the state of WarmupStateRegistry.
 bool ShouldWarmupAllBatchSizes(const OpKernelContext* c);
 
+// Returns the warm-up data of the model of `c`, or nullptr if the model is not
+// in a warm-up state.
+const WarmupStateRegistry::PerModelData* LookupWarmupState(
+    const OpKernelContext* c);
+
+// A warm-up request of a model, e.g. one record of its warm-up assets.
+struct WarmupRequest {
+  std::string signature_name;
+  // Runs the request once.
+  std::function<absl::Status()> run;
+};
+
+// Latency of the warm-up requests of one signature.
+struct SignatureWarmupLatency {
+  int64_t num_requests = 0;
+  // Mean latency of the first run of the requests, which includes one-time
+  // work such as Grappler optimization and XLA compilation for their shapes.
+  absl::Duration first_run_latency;
+  // Mean latency of the later runs of the requests.
+  absl::Duration steady_run_latency;
+};
+
+struct WarmupOptions {
+  // Number of requests run concurrently.
+  int num_threads = 1;
+  // Number of times each request runs after its first run.
+  int num_steady_runs = 1;
+};
+
+// Runs `requests` on `options.num_threads` threads. Every request first runs
+// once, with requests of different signatures and batch sizes running
+// concurrently, so that their one-time graph optimization and compilation
+// overlap instead of adding up. Once all of them are done, each request runs
+// `options.num_steady_runs` more times.
+//
+// Returns the latencies of each signature, or the first error of a request.
+absl::StatusOr<absl::flat_hash_map<std::string, SignatureWarmupLatency>>
+RunWarmupRequests(absl::Span<const WarmupRequest> requests,
+                  const WarmupOptions& options, Env* env = Env::Default());
+
 }  // namespace serving
 }  // namespace tensorflow
 
@@ -0,0 +1,102 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/core/kernels/batching_util/warmup.h"
+
+#include <atomic>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/synchronization/barrier.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+using ::tsl::testing::StatusIs;
+
+TEST(RunWarmupRequestsTest, RunsEveryRequest) {
+  std::atomic<int> runs_a = 0;
+  std::atomic<int> runs_b = 0;
+  auto run_a = [&] {
+    ++runs_a;
+    return absl::OkStatus();
+  };
+  auto run_b = [&] {
+    ++runs_b;
+    return absl::OkStatus();
+  };
+  std::vector<WarmupRequest> requests = {{"a", run_a}, {"a", run_a},
+                                         {"b", run_b}};
+  WarmupOptions options;
+  options.num_threads = 2;
+  options.num_steady_runs = 3;
+  auto latencies = RunWarmupRequests(requests, options);
+  TF_ASSERT_OK(latencies.status());
+  EXPECT_EQ(runs_a, 8);
+  EXPECT_EQ(runs_b, 4);
+  ASSERT_EQ(latencies->size(), 2);
+  EXPECT_EQ(latencies->at("a").num_requests, 2);
+  EXPECT_EQ(latencies->at("b").num_requests, 1);
+}
+
+TEST(RunWarmupRequestsTest, RunsFirstRunsConcurrently) {
+  // Each first run waits for the other one, so this only finishes if they
+  // run concurrently.
+  absl::Barrier* barrier = new absl::Barrier(2);
+  std::atomic<int> runs = 0;
+  auto run = [&] {
+    if (runs++ < 2 && barrier->Block()) delete barrier;
+    return absl::OkStatus();
+  };
+  std::vector<WarmupRequest> requests = {{"a", run}, {"b", run}};
+  WarmupOptions options;
+  options.num_threads = 2;
+  options.num_steady_runs = 0;
+  TF_EXPECT_OK(RunWarmupRequests(requests, options).status());
+  EXPECT_EQ(runs, 2);
+}
+
+TEST(RunWarmupRequestsTest, ReturnsError) {
+  std::atomic<int> runs = 0;
+  std::vector<WarmupRequest> requests = {
+      {"a",
+       [&] {
+         ++runs;
+         return absl::OkStatus();
+       }},
+      {"b",
+       [&] {
+         ++runs;
+         return absl::InternalError("failed");
+       }},
+  };
+  WarmupOptions options;
+  options.num_steady_runs = 5;
+  EXPECT_THAT(RunWarmupRequests(requests, options),
+              StatusIs(absl::StatusCode::kInternal, "failed"));
+  // No steady runs after a failed first run.
+  EXPECT_EQ(runs, 2);
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
@@ -26,6 +26,7 @@ limitations under the License.
 #include "tsl/platform/status.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/kernels/cast_op.h"
+#include "tensorflow/core/kernels/low_precision_cast_cpu.h"
 
 namespace tensorflow {
 
@@ -99,6 +100,35 @@ CAST_FUNCTORS(Eigen::ThreadPoolDevice);
     };                                                                    \
   }
 
+// Runs the vectorized LowPrecisionCast from IN to OUT over blocks of the
+// flattened input in parallel.
+template <typename IN, typename OUT>
+void ParallelLowPrecisionCast(const Eigen::ThreadPoolDevice& d, const IN* in,
+                              OUT* out, int64_t n) {
+  d.parallelFor(n, Eigen::TensorOpCost(sizeof(IN), sizeof(OUT), 1),
+                [in, out](Eigen::Index begin, Eigen::Index end) {
+                  LowPrecisionCast(in + begin, out + begin, end - begin);
+                });
+}
+
+// Like CAST_CASE on CPU, for the pairs of types that LowPrecisionCast
+// supports. Truncating casts keep using the Eigen functors.
+#define LOW_PRECISION_CAST_CASE(IN, OUT)                                \
+  if (DataTypeToEnum<OUT>::value == dst_dtype) {                        \
+    return [](OpKernelContext* ctx, const Tensor& inp, Tensor* out,     \
+              bool truncate) {                                          \
+      const auto& d = ctx->eigen_device<Eigen::ThreadPoolDevice>();     \
+      if (truncate) {                                                   \
+        functor::CastFunctor<Eigen::ThreadPoolDevice, OUT, IN> func;    \
+        func(d, out->flat<OUT>(), inp.flat<IN>(), truncate);            \
+      } else {                                                          \
+        ParallelLowPrecisionCast(d, inp.flat<IN>().data(),              \
+                                 out->flat<OUT>().data(),               \
+                                 inp.NumElements());                    \
+      }                                                                 \
+    };                                                                  \
+  }
+
 // The functions below are implemented in the cast_op_impl_*.cc files.
 CastFunctorType GetCpuCastFromBool(DataType dst_dtype);
 
@@ -23,6 +23,7 @@ typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
 CastFunctorType GetCpuCastFromBfloat(DataType dst_dtype) {
+  LOW_PRECISION_CAST_CASE(bfloat16, float);
   CURRY_TYPES3(CAST_CASE, CPUDevice, bfloat16);
   CAST_CASE(CPUDevice, bfloat16, float8_e5m2);
   CAST_CASE(CPUDevice, bfloat16, float8_e4m3fn);
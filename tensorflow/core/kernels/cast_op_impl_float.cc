@@ -23,9 +23,11 @@ typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
 CastFunctorType GetCpuCastFromFloat(DataType dst_dtype) {
+  LOW_PRECISION_CAST_CASE(float, bfloat16);
+  LOW_PRECISION_CAST_CASE(float, Eigen::half);
+  LOW_PRECISION_CAST_CASE(float, float8_e5m2);
+  LOW_PRECISION_CAST_CASE(float, float8_e4m3fn);
   CURRY_TYPES3(CAST_CASE, CPUDevice, float);
-  CAST_CASE(CPUDevice, float, float8_e5m2);
-  CAST_CASE(CPUDevice, float, float8_e4m3fn);
   return nullptr;
 }
 
@@ -23,6 +23,7 @@ typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
 CastFunctorType GetCpuCastFromFloat8e5m2(DataType dst_dtype) {
+  LOW_PRECISION_CAST_CASE(float8_e5m2, float);
   CURRY_TYPES3(CAST_CASE, CPUDevice, float8_e5m2);
   CAST_CASE(CPUDevice, float8_e5m2, float8_e5m2);
   CAST_CASE(CPUDevice, float8_e5m2, float8_e4m3fn);
@@ -30,6 +31,7 @@ CastFunctorType GetCpuCastFromFloat8e5m2(DataType dst_dtype) {
 }
 
 CastFunctorType GetCpuCastFromFloat8e4m3fn(DataType dst_dtype) {
+  LOW_PRECISION_CAST_CASE(float8_e4m3fn, float);
   CURRY_TYPES3(CAST_CASE, CPUDevice, float8_e4m3fn);
   CAST_CASE(CPUDevice, float8_e4m3fn, float8_e5m2);
   CAST_CASE(CPUDevice, float8_e4m3fn, float8_e4m3fn);
@@ -21,6 +21,7 @@ typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
 CastFunctorType GetCpuCastFromHalf(DataType dst_dtype) {
+  LOW_PRECISION_CAST_CASE(Eigen::half, float);
   CURRY_TYPES3(CAST_CASE, CPUDevice, Eigen::half);
   CAST_CASE(CPUDevice, Eigen::half, float8_e5m2);
   CAST_CASE(CPUDevice, Eigen::half, float8_e4m3fn);
@@ -44,6 +44,19 @@ static Graph* Cast(int num) {
   return g;
 }
 
+// Like Cast, for source types that Eigen cannot generate random values of.
+template <typename Src, typename Dst>
+static Graph* CastFromRandomFloats(int num) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor floats(DT_FLOAT, TensorShape({64, 64, num / (64 * 64)}));
+  floats.flat<float>().setRandom();
+  Tensor data(DataTypeToEnum<Src>::value, floats.shape());
+  data.flat<Src>() = floats.flat<float>().cast<Src>();
+  test::graph::Cast(g, test::graph::Constant(g, data),
+                    DataTypeToEnum<Dst>::value);
+  return g;
+}
+
 class CastOpTest : public OpsTestBase {
  protected:
   void MakeOp(DataType src, DataType dst, bool trunc) {
@@ -253,6 +266,62 @@ static void BM_cpu_half_float(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_cpu_half_float)->UseRealTime()->Arg(64 << 10)->Arg(32 << 20);
 
+static void BM_cpu_float_float8_e4m3fn(::testing::benchmark::State& state) {
+  const int num = state.range(0);
+  test::Benchmark("cpu", Cast<float, float8_e4m3fn>(num),
+                  /*old_benchmark_api=*/false)
+      .Run(state);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * num);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * num *
+                          (sizeof(float) + sizeof(float8_e4m3fn)));
+}
+BENCHMARK(BM_cpu_float_float8_e4m3fn)
+    ->UseRealTime()
+    ->Arg(64 << 10)
+    ->Arg(32 << 20);
+
+static void BM_cpu_float8_e4m3fn_float(::testing::benchmark::State& state) {
+  const int num = state.range(0);
+  test::Benchmark("cpu", CastFromRandomFloats<float8_e4m3fn, float>(num),
+                  /*old_benchmark_api=*/false)
+      .Run(state);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * num);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * num *
+                          (sizeof(float) + sizeof(float8_e4m3fn)));
+}
+BENCHMARK(BM_cpu_float8_e4m3fn_float)
+    ->UseRealTime()
+    ->Arg(64 << 10)
+    ->Arg(32 << 20);
+
+static void BM_cpu_float_float8_e5m2(::testing::benchmark::State& state) {
+  const int num = state.range(0);
+  test::Benchmark("cpu", Cast<float, float8_e5m2>(num),
+                  /*old_benchmark_api=*/false)
+      .Run(state);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * num);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * num *
+                          (sizeof(float) + sizeof(float8_e5m2)));
+}
+BENCHMARK(BM_cpu_float_float8_e5m2)
+    ->UseRealTime()
+    ->Arg(64 << 10)
+    ->Arg(32 << 20);
+
+static void BM_cpu_float8_e5m2_float(::testing::benchmark::State& state) {
+  const int num = state.range(0);
+  test::Benchmark("cpu", CastFromRandomFloats<float8_e5m2, float>(num),
+                  /*old_benchmark_api=*/false)
+      .Run(state);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * num);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * num *
+                          (sizeof(float) + sizeof(float8_e5m2)));
+}
+BENCHMARK(BM_cpu_float8_e5m2_float)
+    ->UseRealTime()
+    ->Arg(64 << 10)
+    ->Arg(32 << 20);
+
 static void BM_gpu_float_half(::testing::benchmark::State& state) {
   const int num = state.range(0);
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -69,6 +69,19 @@ static std::unique_ptr<OpKernel> BuildOpKernel(OpKernelConstruction* c,
   return k;
 }
 
+// Builds a Cast kernel from `src_type` to `dst_type` on the device of `c`.
+static std::unique_ptr<OpKernel> BuildCastKernel(OpKernelConstruction* c,
+                                                 DataType src_type,
+                                                 DataType dst_type) {
+  NodeDef cast_node;
+  cast_node.add_input(c->def().input(0));
+  cast_node.set_device(c->def().device());
+  SetAttrValue(src_type, &(*cast_node.mutable_attr())["SrcT"]);
+  SetAttrValue(dst_type, &(*cast_node.mutable_attr())["DstT"]);
+  SetAttrValue(false, &(*cast_node.mutable_attr())["Truncate"]);
+  return BuildOpKernel(c, "Cast", &cast_node);
+}
+
 class CollectiveOpV1Kernel : public AsyncOpKernel {
  public:
   explicit CollectiveOpV1Kernel(OpKernelConstruction* c)
@@ -775,6 +788,20 @@ class CollectiveReduceV2OpKernel : public CollectiveOpV2Kernel {
     OP_REQUIRES_OK(c, c->GetAttr("final_op", &final_op_name));
     OP_REQUIRES_OK(
         c, c->GetAttr("max_subdivs_per_device", &max_subdivs_per_device_));
+    OP_REQUIRES_OK(c, c->GetAttr("bucket_key", &bucket_key_));
+    OP_REQUIRES_OK(c, c->GetAttr("bucket_size", &bucket_size_));
+    OP_REQUIRES_OK(c, c->GetAttr("bucket_bytes", &bucket_bytes_));
+    string compression;
+    OP_REQUIRES_OK(c, c->GetAttr("compression", &compression));
+    OP_REQUIRES_OK(c, c->GetAttr("compression_error_feedback",
+                                 &compression_error_feedback_));
+    // Only float32 values are compressed; other types ignore the attribute.
+    compression_type_ = DT_INVALID;
+    if (data_type_ == DT_FLOAT && compression == "bf16") {
+      compression_type_ = DT_BFLOAT16;
+    } else if (data_type_ == DT_FLOAT && compression == "fp16") {
+      compression_type_ = DT_HALF;
+    }
     // Prepare OpKernels for reduction and final operations.
     // The merge_op takes two inputs
     NodeDef sub_node;
@@ -784,6 +811,13 @@ class CollectiveReduceV2OpKernel : public CollectiveOpV2Kernel {
     SetAttrValue(data_type_, &(*sub_node.mutable_attr())["T"]);
     merge_op_ = BuildOpKernel(c, merge_op_name, &sub_node);
     final_op_ = BuildOpKernel(c, final_op_name, &sub_node);
+    if (compression_type_ != DT_INVALID) {
+      compress_op_ = BuildCastKernel(c, data_type_, compression_type_);
+      decompress_op_ = BuildCastKernel(c, compression_type_, data_type_);
+      if (compression_error_feedback_) {
+        sub_op_ = BuildOpKernel(c, "Sub", &sub_node);
+      }
+    }
     name_ = strings::StrCat(c->def().name(), ": ReduceV2(", merge_op_name, ",",
                             final_op_name, ")");
     VLOG(2) << "CollectiveReduceV2 " << this << " name " << name_
@@ -805,9 +839,18 @@ class CollectiveReduceV2OpKernel : public CollectiveOpV2Kernel {
         done_with_cleanup);
     col_params->instance.impl_details.max_subdivs_per_device =
         max_subdivs_per_device_;
+    col_params->instance.impl_details.bucket_key = bucket_key_;
+    col_params->instance.impl_details.bucket_size = bucket_size_;
+    col_params->instance.impl_details.bucket_bytes = bucket_bytes_;
+    col_params->instance.impl_details.compression_type = compression_type_;
+    col_params->instance.impl_details.compression_error_feedback =
+        compression_error_feedback_;
     col_params->instance.shape = c->input(0).shape();
     col_params->merge_op = merge_op_.get();
     col_params->final_op = final_op_.get();
+    col_params->compress_op = compress_op_.get();
+    col_params->decompress_op = decompress_op_.get();
+    col_params->sub_op = sub_op_.get();
     VLOG(1) << "CollectiveReduceV2 group_size " << col_params->group.group_size
             << " group_key " << col_params->group.group_key << " instance_key "
             << col_params->instance.instance_key << " step id "
@@ -825,8 +868,16 @@ class CollectiveReduceV2OpKernel : public CollectiveOpV2Kernel {
 
  private:
   int max_subdivs_per_device_;
+  int bucket_key_;
+  int bucket_size_;
+  int64_t bucket_bytes_;
+  DataType compression_type_;
+  bool compression_error_feedback_;
   std::unique_ptr<OpKernel> merge_op_;
   std::unique_ptr<OpKernel> final_op_;
+  std::unique_ptr<OpKernel> compress_op_;
+  std::unique_ptr<OpKernel> decompress_op_;
+  std::unique_ptr<OpKernel> sub_op_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("CollectiveReduceV2").Device(DEVICE_CPU),
@@ -1433,6 +1484,20 @@ class CollectiveReduceScatterV2OpKernel : public CollectiveOpV2Kernel {
     OP_REQUIRES_OK(c, c->GetAttr("final_op", &final_op_name));
     OP_REQUIRES_OK(
         c, c->GetAttr("max_subdivs_per_device", &max_subdivs_per_device_));
+    OP_REQUIRES_OK(c, c->GetAttr("bucket_key", &bucket_key_));
+    OP_REQUIRES_OK(c, c->GetAttr("bucket_size", &bucket_size_));
+    OP_REQUIRES_OK(c, c->GetAttr("bucket_bytes", &bucket_bytes_));
+    string compression;
+    OP_REQUIRES_OK(c, c->GetAttr("compression", &compression));
+    OP_REQUIRES_OK(c, c->GetAttr("compression_error_feedback",
+                                 &compression_error_feedback_));
+    // Only float32 values are compressed; other types ignore the attribute.
+    compression_type_ = DT_INVALID;
+    if (data_type_ == DT_FLOAT && compression == "bf16") {
+      compression_type_ = DT_BFLOAT16;
+    } else if (data_type_ == DT_FLOAT && compression == "fp16") {
+      compression_type_ = DT_HALF;
+    }
     // Prepare OpKernels for reduction and final operations.
     // The merge_op takes two inputs
     NodeDef sub_node;
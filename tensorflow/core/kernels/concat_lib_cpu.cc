@@ -17,10 +17,12 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/concat_lib_cpu.h"
 
+#include <type_traits>
 #include <vector>
 
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/kernels/concat_lib.h"
+#include "tensorflow/core/kernels/nontemporal_store.h"
 
 namespace tensorflow {
 
@@ -37,6 +39,24 @@ struct MemCpyCopier {
     }
   }
 };
+
+// Copies with non-temporal stores, for outputs too large to stay in cache.
+// Each copied segment is fenced, so only segments large enough to amortize the
+// fence use non-temporal stores.
+template <typename T>
+struct NonTemporalCopier {
+  inline void Copy(T* dst, const T* src, int input_index, size_t n) {
+    constexpr size_t kMinNonTemporalBytes = 4096;
+    const size_t bytes = n * sizeof(T);
+    if (bytes < kMinNonTemporalBytes) {
+      memcpy(dst, src, bytes);
+      return;
+    }
+    internal::CopyNonTemporal(dst, src, bytes);
+    internal::NonTemporalStoreFence();
+  }
+};
+
 template <>
 struct MemCpyCopier<ResourceHandle> {
   inline void Copy(ResourceHandle* dst, const ResourceHandle* src,
@@ -104,6 +124,14 @@ void ConcatCPU(
         inputs,
     typename TTypes<T, 2>::Matrix* output) {
   int64_t cost_per_unit = EstimateBytesPerElement<T>(inputs);
+  if constexpr (std::is_trivially_copyable_v<T>) {
+    if (DataTypeCanUseMemcpy(DataTypeToEnum<T>::v()) &&
+        internal::UseNonTemporalStores(output->size() * sizeof(T))) {
+      ConcatCPUImpl<T>(d, inputs, cost_per_unit, NonTemporalCopier<T>(),
+                       output);
+      return;
+    }
+  }
   ConcatCPUImpl<T>(d, inputs, cost_per_unit, MemCpyCopier<T>(), output);
 }
 
@@ -192,6 +192,40 @@ void BM_ConcatManyDim1bfloat16(::testing::benchmark::State& state) {
 
 BENCHMARK(BM_ConcatManyDim1bfloat16)->UseRealTime()->Arg(18)->Arg(34)->Arg(60);
 
+// Concatenates two NHWC activations of `channels` channels each along the
+// channel dimension, as in the ConcatV2 of an inception block. The larger
+// sizes do not fit in the last level cache.
+static void BM_ConcatV2ChannelsFloat(::testing::benchmark::State& state) {
+  const int batch = state.range(0);
+  const int channels = state.range(1);
+  Graph* g = new Graph(OpRegistry::Global());
+
+  Tensor axis(DT_INT32, TensorShape({}));
+  axis.scalar<int32>()() = 3;
+  Tensor in0(DT_FLOAT, TensorShape({batch, 28, 28, channels}));
+  Tensor in1(DT_FLOAT, TensorShape({batch, 28, 28, channels}));
+  in0.flat<float>().setRandom();
+  in1.flat<float>().setRandom();
+
+  Node* node;
+  TF_CHECK_OK(
+      NodeBuilder(g->NewName("n"), "ConcatV2")
+          .Input({test::graph::Constant(g, in0), test::graph::Constant(g, in1)})
+          .Input(test::graph::Constant(g, axis))
+          .Attr("N", 2)
+          .Attr("T", DT_FLOAT)
+          .Finalize(g, &node));
+  test::Benchmark("cpu", g, /*old_benchmark_api=*/false).Run(state);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          (in0.TotalBytes() + in1.TotalBytes()));
+}
+
+BENCHMARK(BM_ConcatV2ChannelsFloat)
+    ->UseRealTime()
+    ->ArgPair(1, 64)
+    ->ArgPair(32, 64)
+    ->ArgPair(32, 256);
+
 void MemcpyAlternativeHelper(::testing::benchmark::State& state, int dim2) {
   const int kDim1 = 100;
   std::vector<float> data1(kDim1 * dim2, 1.0f);
@@ -38,6 +38,8 @@ limitations under the License.
 #define EIGEN_USE_GPU
 #endif  // GOOGLE_CUDA
 
+#include <algorithm>
+#include <memory>
 #include <string>
 #include <type_traits>
 #include <utility>
@@ -51,7 +53,9 @@ limitations under the License.
 #include "tensorflow/core/kernels/conv_2d.h"
 #include "tensorflow/core/kernels/conv_ops.h"
 #include "tensorflow/core/kernels/fused_eigen_output_kernels.h"
+#include "tensorflow/core/kernels/low_precision_gemm_cpu.h"
 #include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/kernels/packed_weight_cache.h"
 #include "tensorflow/core/profiler/lib/scoped_annotation.h"
 #include "tensorflow/core/util/tensor_format.h"
 #include "tensorflow/core/util/use_cudnn.h"
@@ -89,6 +93,9 @@ struct LaunchFusedConv2DOp {
 //   (1) MatMul for the case of 1x1 convolution.
 //   (2) MatMul for the case when filter size equals to the input size.
 //   (3) General spatial 2D convolution for all other cases.
+//
+// In the MatMul cases a float filter that was packed for F32Gemm ahead of time
+// is multiplied without repacking it.
 template <typename T>
 class LaunchFusedConv2DWithOutputKernel {
  public:
@@ -103,6 +110,18 @@ class LaunchFusedConv2DWithOutputKernel {
         padding_(padding),
         explicit_paddings_(explicit_paddings) {}
 
+  // Returns true if the convolution of `input` and `filter` is computed as a
+  // MatMul with the filter reshaped to [k, out_depth].
+  bool IsMatMul(const Tensor& input, const Tensor& filter) const {
+    return IsOneByOne(filter) || IsFullFilter(input, filter);
+  }
+
+  // Uses `packed_filter`, the reshaped filter packed for F32Gemm, in the MatMul
+  // cases. It must outlive the calls to this launcher.
+  void SetPackedFilter(const F32Gemm::PackedRhs* packed_filter) {
+    packed_filter_ = packed_filter;
+  }
+
   template <typename OutputKernel>
   void operator()(const OutputKernel& output_kernel, OpKernelContext* ctx,
                   const Tensor& input, const Tensor& filter, Tensor* output) {
@@ -116,12 +135,15 @@ class LaunchFusedConv2DWithOutputKernel {
           output_kernel(output_mapper, params, i, j, num_rows, num_cols);
         });
 
-    if (filter.dim_size(0) == 1 && filter.dim_size(1) == 1 &&
-        row_stride_ == 1 && col_stride_ == 1 && padding_ != EXPLICIT) {
+    if (IsOneByOne(filter)) {
       int conv_width = 1;  // Width for the convolution step.
       for (int i = 0; i < 3; ++i) {
         conv_width *= output->dim_size(i);
       }
+      if (packed_filter_ != nullptr) {
+        MatMulWithPackedFilter(output_kernel, ctx, input, conv_width, output);
+        return;
+      }
 
       Eigen::array<Eigen::IndexPair<Eigen::DenseIndex>, 1> dim_pair;
       dim_pair[0] = Eigen::IndexPair<Eigen::DenseIndex>(1, 0);
@@ -132,13 +154,16 @@ class LaunchFusedConv2DWithOutputKernel {
           filter.shaped<T, 2>({filter.dim_size(2), filter.dim_size(3)}),
           dim_pair, std::move(output_kernel_wrapper));
 
-    } else if (filter.dim_size(0) == input.dim_size(1) &&
-               filter.dim_size(1) == input.dim_size(2) && row_dilation_ == 1 &&
-               col_dilation_ == 1 && padding_ == VALID) {
+    } else if (IsFullFilter(input, filter)) {
       // If the input data and filter have the same height/width,
       // reduce the 2D convolution to matrix multiplication.
       const auto k =  // Length of reduction dimension.
           filter.dim_size(0) * filter.dim_size(1) * filter.dim_size(2);
+      if (packed_filter_ != nullptr) {
+        MatMulWithPackedFilter(output_kernel, ctx, input, input.dim_size(0),
+                               output);
+        return;
+      }
 
       Eigen::array<Eigen::IndexPair<Eigen::DenseIndex>, 1> dim_pair;
       dim_pair[0] = Eigen::IndexPair<Eigen::DenseIndex>(1, 0);
@@ -172,6 +197,45 @@ class LaunchFusedConv2DWithOutputKernel {
   }
 
  private:
+  bool IsOneByOne(const Tensor& filter) const {
+    return filter.dim_size(0) == 1 && filter.dim_size(1) == 1 &&
+           row_stride_ == 1 && col_stride_ == 1 && padding_ != EXPLICIT;
+  }
+
+  bool IsFullFilter(const Tensor& input, const Tensor& filter) const {
+    return filter.dim_size(0) == input.dim_size(1) &&
+           filter.dim_size(1) == input.dim_size(2) && row_dilation_ == 1 &&
+           col_dilation_ == 1 && padding_ == VALID;
+  }
+
+  // Computes the [m, out_depth] output as the product of the [m, k] input and
+  // the packed filter, with `output_kernel` applied to blocks of results.
+  template <typename OutputKernel>
+  void MatMulWithPackedFilter(const OutputKernel& output_kernel,
+                              OpKernelContext* ctx, const Tensor& input,
+                              int64_t m, Tensor* output) {
+    if constexpr (std::is_same_v<T, float>) {
+      float* out = output->flat<float>().data();
+      const int64_t n = packed_filter_->n;
+      F32Gemm::Run(
+          ctx->eigen_device<CPUDevice>(), input.flat<float>().data(), m,
+          /*transpose_a=*/false, *packed_filter_,
+          [&](float* block, int64_t ld, int64_t row, int64_t col,
+              int64_t rows, int64_t cols) {
+            // Blocks are row-major, which is how the output kernels see the
+            // output of a contraction with swapped arguments.
+            const ContractionOutputMapper<float, Eigen::Index> output_mapper(
+                block, ld);
+            Eigen::TensorContractionParams params;
+            params.swapped_arguments = true;
+            output_kernel(output_mapper, params, col, row, cols, rows);
+            for (int64_t r = 0; r < rows; ++r) {
+              std::copy_n(block + r * ld, cols, out + (row + r) * n + col);
+            }
+          });
+    }
+  }
+
   // Wrap output_kernel into type erased struct to reduce the number of unique
   // template instantiations for Eigen Tensor contraction expressions.
   //
@@ -202,10 +266,15 @@ class LaunchFusedConv2DWithOutputKernel {
   int col_dilation_;
   const Padding padding_;
   const std::vector<int64_t>& explicit_paddings_;
+  const F32Gemm::PackedRhs* packed_filter_ = nullptr;
 };
 
 template <typename T>
 struct LaunchFusedConv2DOp<CPUDevice, T> {
+  // If set, the filter is constant, and float filters of convolutions that are
+  // computed as a MatMul are packed once into this cache.
+  PackedWeightCache<F32Gemm::PackedRhs>* packed_filter_cache = nullptr;
+
   void operator()(OpKernelContext* context, bool use_cudnn,
                   bool cudnn_use_autotune, const Tensor& input,
                   const Tensor& filter, const FusedComputationType fusion,
@@ -251,6 +320,23 @@ struct LaunchFusedConv2DOp<CPUDevice, T> {
         dimensions.dilation_rows, dimensions.dilation_cols, params.padding,
         params.explicit_paddings);
 
+    std::shared_ptr<const F32Gemm::PackedRhs> packed_filter;
+    if constexpr (std::is_same_v<T, float>) {
+      if (packed_filter_cache != nullptr && F32Gemm::IsAccelerated() &&
+          conv2d.IsMatMul(input, filter)) {
+        packed_filter =
+            packed_filter_cache->Get(filter, /*is_const=*/true, [&]() {
+              auto packed = std::make_shared<F32Gemm::PackedRhs>();
+              F32Gemm::PackRhs(filter.flat<float>().data(),
+                               filter.NumElements() / filter.dim_size(3),
+                               filter.dim_size(3), /*transpose=*/false,
+                               packed.get());
+              return packed;
+            });
+        conv2d.SetPackedFilter(packed_filter.get());
+      }
+    }
+
     switch (fusion) {
       case FusedComputationType::kUndefined:
         OP_REQUIRES_OK(context, errors::Internal("Fusion type is undefined"));
@@ -748,6 +834,8 @@ class FusedConv2DOp : public OpKernel {
     OP_REQUIRES_OK(context, InitializeFusedComputation(
                                 context, "Conv2D", patterns,
                                 &fused_computation_, &fused_computation_args_));
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("is_filter_const", &is_filter_const_));
   }
 
   void Compute(OpKernelContext* context) override {
@@ -791,16 +879,24 @@ class FusedConv2DOp : public OpKernel {
       return;
     }
 
-    LaunchFusedConv2DOp<Device, T>()(context, use_cudnn_, cudnn_use_autotune_,
-                                     input, filter, fused_computation_,
-                                     fused_computation_args_, params_,
-                                     dimensions, output);
+    LaunchFusedConv2DOp<Device, T> launch;
+    if constexpr (std::is_same_v<Device, CPUDevice> &&
+                  std::is_same_v<T, float>) {
+      if (is_filter_const_) launch.packed_filter_cache = &packed_filter_cache_;
+    }
+    launch(context, use_cudnn_, cudnn_use_autotune_, input, filter,
+           fused_computation_, fused_computation_args_, params_, dimensions,
+           output);
   }
 
  private:
   Conv2DParameters params_;
   bool use_cudnn_;
   bool cudnn_use_autotune_;
+  bool is_filter_const_ = false;
+
+  // The packed constant filter of float convolutions on CPU.
+  PackedWeightCache<F32Gemm::PackedRhs> packed_filter_cache_;
 
   FusedComputationType fused_computation_ = FusedComputationType::kUndefined;
   FusedComputationArgs fused_computation_args_;
@@ -726,7 +726,7 @@ class FusedConv2DOpTest : public OpsTestBase {
                         const std::string& padding,
                         const std::vector<int>& explicit_paddings,
                         Tensor* output, bool allow_gpu_device = false,
-                        int stride = 1) {
+                        int stride = 1, bool is_filter_const = false) {
     Scope root = tensorflow::Scope::NewRootScope();
 
     DataType dtype = DataTypeToEnum<T>::v();
@@ -863,6 +863,7 @@ class FusedConv2DOpTest : public OpsTestBase {
                      .Attr("padding", padding)
                      .Attr("explicit_paddings", explicit_paddings)
                      .Attr("fused_ops", fused_ops)
+                     .Attr("is_filter_const", is_filter_const)
                      .Finalize(&fused_conv2d));
 
     RunAndFetch(root, fused_conv2d.name(), output, allow_gpu_device,
@@ -1361,5 +1362,43 @@ using FusedBatchNormDataTypes = ::testing::Types<float>;
 INSTANTIATE_TYPED_TEST_SUITE_P(Test, FusedConv2DWithBatchNormOpTest,
                                FusedBatchNormDataTypes);
 
+// A constant float filter is packed ahead of time on CPU when the convolution
+// is computed as a MatMul.
+class FusedConv2DWithConstFilterOpTest : public FusedConv2DOpTest<float> {
+ protected:
+  void VerifyConv2DWithBias(int filter_size, const std::string& padding) {
+    const BiasAddGraphRunner run_default =
+        [&](const Tensor& input_data, const Tensor& filter_data,
+            const Tensor& bias_data, Tensor* out) {
+          RunConv2DWithBias(input_data, filter_data, bias_data, padding, {},
+                            out);
+        };
+
+    const BiasAddGraphRunner run_fused =
+        [&](const Tensor& input_data, const Tensor& filter_data,
+            const Tensor& bias_data, Tensor* out) {
+          RunFusedConv2DOp(input_data, filter_data, {bias_data}, {"BiasAdd"},
+                           padding, {}, out, /*allow_gpu_device=*/false,
+                           /*stride=*/1, /*is_filter_const=*/true);
+        };
+
+    VerifyBiasAddTensorsNear(kDepth, kImageWidth, kImageHeight,
+                             kImageBatchCount, filter_size,
+                             /*filter_count=*/12, run_default, run_fused);
+  }
+};
+
+TEST_F(FusedConv2DWithConstFilterOpTest, OneByOneConvolution) {
+  VerifyConv2DWithBias(/*filter_size=*/1, "SAME");
+}
+
+TEST_F(FusedConv2DWithConstFilterOpTest, ImageSizeConvolution) {
+  VerifyConv2DWithBias(/*filter_size=*/kImageWidth, "VALID");
+}
+
+TEST_F(FusedConv2DWithConstFilterOpTest, SpatialConvolution) {
+  VerifyConv2DWithBias(/*filter_size=*/3, "SAME");
+}
+
 #endif  // TENSORFLOW_USE_ROCM
 }  // namespace tensorflow
@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/naming.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
@@ -68,6 +69,9 @@ constexpr char kCacheCompleted[] = "cache_completed";
 constexpr char kIndex[] = "index";
 constexpr char kImpl[] = "Impl";
 constexpr char kCacheDataset[] = "CacheDataset";
+// If set, the elements of a memory cache that do not fit in the RAM budget of
+// the input pipeline are spilled to files in this directory.
+constexpr char kMemoryCacheSpillDirEnvVar[] = "TF_DATA_MEMORY_CACHE_SPILL_DIR";
 constexpr char kIncompleteCacheErrorMessage[] =
     "The calling iterator did not fully read the dataset being cached. In "
     "order to avoid unexpected truncation of the dataset, the partially cached "
@@ -859,9 +863,17 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
           LOG(WARNING) << kIncompleteCacheErrorMessage;
           cache_->Reset();
         }
+        if (ram_budget_manager_ != nullptr && reserved_bytes_ > 0) {
+          ram_budget_manager_->RequestLegacyPrefetchBytes(-reserved_bytes_);
+        }
       }
 
       Status Initialize(IteratorContext* ctx) override {
+        {
+          mutex_lock l(mu_);
+          TF_RETURN_IF_ERROR(ReadStringFromEnvVar(kMemoryCacheSpillDirEnvVar,
+                                                  "", &spill_dir_));
+        }
         return dataset()->input_->MakeIterator(ctx, this, prefix(),
                                                &input_impl_);
       }
@@ -875,16 +887,15 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
         if (*end_of_sequence) {
           if (!cache_->IsCompleted()) {
             VLOG(2) << "Finalizing the cache because EOF has been reached.";
-            cache_->Complete(std::move(temp_cache_));
+            TF_RETURN_IF_ERROR(CompleteCache());
           }
           return absl::OkStatus();
         }
-        RecordBufferEnqueue(ctx, *out_tensors);
-        temp_cache_.emplace_back(*out_tensors);
+        TF_RETURN_IF_ERROR(AddToCache(ctx, *out_tensors));
         if (temp_cache_.size() == dataset()->input_->Cardinality()) {
           VLOG(2) << "Finalizing the cache because its size matches the "
                      "expected input cardinality.";
-          cache_->Complete(std::move(temp_cache_));
+          TF_RETURN_IF_ERROR(CompleteCache());
         }
         return absl::OkStatus();
       }
@@ -900,8 +911,16 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
                           IteratorStateWriter* writer) override {
         mutex_lock l(mu_);
         if (!cache_->IsCompleted()) {
-          TF_RETURN_IF_ERROR(
-              WriteElementsToCheckpoint(writer, prefix(), temp_cache_));
+          if (spill_file_ != nullptr) {
+            // Checkpoint the spilled elements along with the others.
+            std::vector<std::vector<Tensor>> elements = temp_cache_;
+            TF_RETURN_IF_ERROR(spill_file_->Map(&elements));
+            TF_RETURN_IF_ERROR(
+                WriteElementsToCheckpoint(writer, prefix(), elements));
+          } else {
+            TF_RETURN_IF_ERROR(
+                WriteElementsToCheckpoint(writer, prefix(), temp_cache_));
+          }
         }
         return SaveInput(ctx, writer, input_impl_);
       }
@@ -917,10 +936,66 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
       }
 
      private:
+      // Adds `element` to the cache. If `spill_dir_` is set, keeps it in
+      // memory only if the RAM budget of the input pipeline allows it, and
+      // spills it to `spill_file_` otherwise.
+      Status AddToCache(IteratorContext* ctx,
+                        const std::vector<Tensor>& element)
+          TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (!spill_dir_.empty() && ctx->ram_budget_manager() != nullptr) {
+          int64_t num_bytes = 0;
+          for (const Tensor& t : element) {
+            num_bytes += t.TotalBytes();
+          }
+          if (ctx->ram_budget_manager()->RequestLegacyPrefetchBytes(
+                  num_bytes)) {
+            ram_budget_manager_ = ctx->ram_budget_manager();
+            reserved_bytes_ += num_bytes;
+          } else if (CacheSpillFile::CanSpill(element)) {
+            if (spill_file_ == nullptr) {
+              TF_RETURN_IF_ERROR(
+                  CacheSpillFile::Create(ctx->env(), spill_dir_, &spill_file_));
+              VLOG(1) << "Spilling the memory cache to " << spill_dir_
+                      << " after " << reserved_bytes_ << " bytes.";
+            }
+            TF_RETURN_IF_ERROR(
+                spill_file_->Append(temp_cache_.size(), element));
+            // The element is read back from the file once the cache is done.
+            temp_cache_.emplace_back();
+            return absl::OkStatus();
+          }
+        }
+        RecordBufferEnqueue(ctx, element);
+        temp_cache_.emplace_back(element);
+        return absl::OkStatus();
+      }
+
+      // Completes the cache with the elements in `temp_cache_`, mapping the
+      // spilled ones from their file.
+      Status CompleteCache() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (spill_file_ != nullptr) {
+          TF_RETURN_IF_ERROR(spill_file_->Map(&temp_cache_));
+          VLOG(1) << "Mapped " << spill_file_->size()
+                  << " bytes of spilled cache elements.";
+          // The mapping stays valid after the file is deleted.
+          spill_file_.reset();
+        }
+        cache_->Complete(std::move(temp_cache_), std::move(ram_budget_manager_),
+                         reserved_bytes_);
+        reserved_bytes_ = 0;
+        return absl::OkStatus();
+      }
+
       mutex mu_;
       std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
       MemoryCache* const cache_ TF_GUARDED_BY(mu_);  // not owned.
       std::vector<std::vector<Tensor>> temp_cache_ TF_GUARDED_BY(mu_);
+      std::string spill_dir_ TF_GUARDED_BY(mu_);
+      std::unique_ptr<CacheSpillFile> spill_file_ TF_GUARDED_BY(mu_);
+      // The part of the RAM budget that the elements in `temp_cache_` use.
+      std::shared_ptr<model::RamBudgetManager> ram_budget_manager_
+          TF_GUARDED_BY(mu_);
+      int64_t reserved_bytes_ TF_GUARDED_BY(mu_) = 0;
     };  // MemoryWriterIterator
 
     class MemoryReaderIterator : public DatasetIterator<MemoryDatasetBase> {
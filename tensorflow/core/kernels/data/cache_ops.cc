@@ -14,7 +14,11 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/cache_ops.h"
 
+#include <utility>
+
 #include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_mgr.h"
@@ -22,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/platform/path.h"
 
 namespace tensorflow {
 namespace data {
@@ -29,15 +34,54 @@ namespace {
 
 constexpr char kMemoryCache[] = "MemoryCache";
 
+// The buffer of a cache element that was spilled to a CacheSpillFile. Keeps
+// the mapping of the file alive while the tensor is.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                     int64_t offset, size_t size)
+      : TensorBuffer(const_cast<char*>(
+                         static_cast<const char*>(region->data()) + offset)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("CacheSpillFile");
+  }
+  // The mapping is read-only, so kernels must not forward it as an output.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+
 }  // namespace
 
 string MemoryCacheManager::DebugString() const { return kMemoryCache; }
 
+MemoryCache::~MemoryCache() { Reset(); }
+
 void MemoryCache::Complete(std::vector<std::vector<Tensor>>&& cache) {
+  Complete(std::move(cache), /*ram_budget_manager=*/nullptr,
+           /*reserved_bytes=*/0);
+}
+
+void MemoryCache::Complete(
+    std::vector<std::vector<Tensor>>&& cache,
+    std::shared_ptr<model::RamBudgetManager> ram_budget_manager,
+    int64_t reserved_bytes) {
   mutex_lock l(mu_);
   if (!completed_) {
     cache_ = std::move(cache);
     completed_ = true;
+    ram_budget_manager_ = std::move(ram_budget_manager);
+    reserved_bytes_ = reserved_bytes;
+  } else if (ram_budget_manager != nullptr && reserved_bytes > 0) {
+    ram_budget_manager->RequestLegacyPrefetchBytes(-reserved_bytes);
   }
 }
 
@@ -50,6 +94,11 @@ void MemoryCache::Reset() {
   mutex_lock l(mu_);
   completed_ = false;
   cache_.clear();
+  if (ram_budget_manager_ != nullptr && reserved_bytes_ > 0) {
+    ram_budget_manager_->RequestLegacyPrefetchBytes(-reserved_bytes_);
+  }
+  ram_budget_manager_.reset();
+  reserved_bytes_ = 0;
 }
 
 const std::vector<Tensor>& MemoryCache::at(int64_t index) {
@@ -68,6 +117,101 @@ const std::vector<std::vector<Tensor>>& MemoryCache::data() {
   return cache_;
 }
 
+bool CacheSpillFile::CanSpill(const std::vector<Tensor>& element) {
+  for (const Tensor& t : element) {
+    if (!DataTypeCanUseMemcpy(t.dtype())) return false;
+  }
+  return true;
+}
+
+Status CacheSpillFile::Create(Env* env, const std::string& dir,
+                              std::unique_ptr<CacheSpillFile>* file) {
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(dir));
+  std::string filename = io::JoinPath(dir, "tf_data_cache_spill");
+  if (!env->CreateUniqueFileName(&filename, ".bin")) {
+    return errors::Internal("Failed to create a unique file name in ", dir);
+  }
+  std::unique_ptr<WritableFile> writable_file;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(filename, &writable_file));
+  file->reset(new CacheSpillFile(env, std::move(filename),
+                                 std::move(writable_file)));
+  return absl::OkStatus();
+}
+
+CacheSpillFile::CacheSpillFile(Env* env, std::string filename,
+                               std::unique_ptr<WritableFile> file)
+    : env_(env), filename_(std::move(filename)), file_(std::move(file)) {}
+
+CacheSpillFile::~CacheSpillFile() {
+  Status s = file_->Close();
+  if (s.ok()) s = env_->DeleteFile(filename_);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to delete cache spill file " << filename_ << ": "
+                 << s;
+  }
+}
+
+Status CacheSpillFile::Append(int64_t index,
+                              const std::vector<Tensor>& element) {
+  std::vector<TensorLocation> locations;
+  locations.reserve(element.size());
+  for (const Tensor& t : element) {
+    if (!DataTypeCanUseMemcpy(t.dtype())) {
+      return errors::InvalidArgument("Cannot spill a tensor of type ",
+                                     DataTypeString(t.dtype()));
+    }
+    // Align every tensor like an allocator would.
+    const int64_t alignment = Allocator::kAllocatorAlignment;
+    const int64_t padding = (alignment - size_ % alignment) % alignment;
+    if (padding > 0) {
+      TF_RETURN_IF_ERROR(file_->Append(std::string(padding, '\0')));
+      size_ += padding;
+    }
+    locations.push_back({t.dtype(), t.shape(), size_});
+    const StringPiece data = t.tensor_data();
+    TF_RETURN_IF_ERROR(file_->Append(data));
+    size_ += data.size();
+  }
+  elements_.emplace_back(index, std::move(locations));
+  return absl::OkStatus();
+}
+
+Status CacheSpillFile::Map(std::vector<std::vector<Tensor>>* cache) {
+  std::shared_ptr<ReadOnlyMemoryRegion> region;
+  if (size_ > 0) {
+    TF_RETURN_IF_ERROR(file_->Flush());
+    std::unique_ptr<ReadOnlyMemoryRegion> mapped;
+    TF_RETURN_IF_ERROR(
+        env_->NewReadOnlyMemoryRegionFromFile(filename_, &mapped));
+    if (mapped->length() < static_cast<uint64>(size_)) {
+      return errors::DataLoss("Cache spill file ", filename_, " has ",
+                              mapped->length(), " bytes, expected ", size_);
+    }
+    region = std::move(mapped);
+  }
+  for (const auto& element : elements_) {
+    if (element.first >= static_cast<int64_t>(cache->size())) {
+      return errors::Internal("Spilled element ", element.first,
+                              " is not in the cache");
+    }
+    std::vector<Tensor>& tensors = (*cache)[element.first];
+    tensors.clear();
+    tensors.reserve(element.second.size());
+    for (const TensorLocation& location : element.second) {
+      const size_t num_bytes =
+          location.shape.num_elements() * DataTypeSize(location.dtype);
+      if (num_bytes == 0) {
+        tensors.emplace_back(location.dtype, location.shape);
+        continue;
+      }
+      auto* buffer = new MappedTensorBuffer(region, location.offset, num_bytes);
+      tensors.emplace_back(location.dtype, location.shape, buffer);
+      buffer->Unref();
+    }
+  }
+  return absl::OkStatus();
+}
+
 AnonymousMemoryCacheHandleOp::AnonymousMemoryCacheHandleOp(
     OpKernelConstruction* ctx)
     : AnonymousResourceOp<MemoryCacheManager>(ctx,
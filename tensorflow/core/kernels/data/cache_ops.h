@@ -16,8 +16,15 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DATA_CACHE_OPS_H_
 #define TENSORFLOW_CORE_KERNELS_DATA_CACHE_OPS_H_
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
 
 namespace tensorflow {
 namespace data {
@@ -30,10 +37,18 @@ namespace data {
 class MemoryCache {
  public:
   MemoryCache() = default;
+  ~MemoryCache();
 
   // Marks the cache as completed.
   void Complete(std::vector<std::vector<Tensor>>&& cache);
 
+  // Marks the cache as completed, and makes it return `reserved_bytes` to
+  // `ram_budget_manager` when it is reset or destroyed. If the cache is
+  // already completed, returns them right away.
+  void Complete(std::vector<std::vector<Tensor>>&& cache,
+                std::shared_ptr<model::RamBudgetManager> ram_budget_manager,
+                int64_t reserved_bytes);
+
   // Returns whether the cache is completed.
   bool IsCompleted();
 
@@ -55,6 +70,52 @@ class MemoryCache {
   // Determines whether all elements of the dataset have been cached.
   bool completed_ TF_GUARDED_BY(mu_) = false;
   std::vector<std::vector<Tensor>> cache_ TF_GUARDED_BY(mu_);
+  std::shared_ptr<model::RamBudgetManager> ram_budget_manager_
+      TF_GUARDED_BY(mu_);
+  int64_t reserved_bytes_ TF_GUARDED_BY(mu_) = 0;
+};
+
+// A file that holds the cache elements that do not fit in the RAM budget of
+// the input pipeline. Once the cache is complete the file is memory mapped,
+// and the spilled elements become tensors that point into the mapping, so
+// that later epochs read them without copying or deserializing them. The
+// file is deleted when this object is destroyed.
+class CacheSpillFile {
+ public:
+  // Returns whether all tensors of `element` can be spilled.
+  static bool CanSpill(const std::vector<Tensor>& element);
+
+  // Creates a new spill file in `dir`.
+  static Status Create(Env* env, const std::string& dir,
+                       std::unique_ptr<CacheSpillFile>* file);
+
+  ~CacheSpillFile();
+
+  // Appends `element`, which is element `index` of the cache.
+  Status Append(int64_t index, const std::vector<Tensor>& element);
+
+  // Sets the spilled elements of `cache` to tensors that map this file.
+  Status Map(std::vector<std::vector<Tensor>>* cache);
+
+  // The number of bytes written to the file.
+  int64_t size() const { return size_; }
+
+ private:
+  struct TensorLocation {
+    DataType dtype;
+    TensorShape shape;
+    int64_t offset;
+  };
+
+  CacheSpillFile(Env* env, std::string filename,
+                 std::unique_ptr<WritableFile> file);
+
+  Env* const env_;
+  const std::string filename_;
+  std::unique_ptr<WritableFile> file_;
+  int64_t size_ = 0;
+  // The cache index and tensor locations of every spilled element.
+  std::vector<std::pair<int64_t, std::vector<TensorLocation>>> elements_;
 };
 
 // A resource wrapping a shared instance of a memory cache.
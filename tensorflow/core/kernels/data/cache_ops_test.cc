@@ -0,0 +1,90 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/cache_ops.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+std::string SpillDir() {
+  return io::JoinPath(testing::TmpDir(), "cache_ops_test");
+}
+
+TEST(CacheSpillFileTest, MapsSpilledElements) {
+  std::unique_ptr<CacheSpillFile> file;
+  TF_ASSERT_OK(CacheSpillFile::Create(Env::Default(), SpillDir(), &file));
+
+  std::vector<std::vector<Tensor>> cache(3);
+  cache[0] = {test::AsTensor<int64_t>({1, 2, 3})};
+  std::vector<Tensor> spilled1 = {test::AsTensor<float>({1.5, 2.5}, {2, 1}),
+                                  Tensor(DT_INT32, TensorShape({0}))};
+  std::vector<Tensor> spilled2 = {test::AsTensor<uint8>({7, 8, 9})};
+  TF_ASSERT_OK(file->Append(1, spilled1));
+  TF_ASSERT_OK(file->Append(2, spilled2));
+  EXPECT_GT(file->size(), 0);
+
+  TF_ASSERT_OK(file->Map(&cache));
+  test::ExpectTensorEqual<int64_t>(cache[0][0],
+                                   test::AsTensor<int64_t>({1, 2, 3}));
+  ASSERT_EQ(cache[1].size(), 2);
+  test::ExpectTensorEqual<float>(cache[1][0], spilled1[0]);
+  EXPECT_EQ(cache[1][1].shape(), TensorShape({0}));
+  ASSERT_EQ(cache[2].size(), 1);
+  test::ExpectTensorEqual<uint8>(cache[2][0], spilled2[0]);
+
+  // The mapping outlives the file.
+  file.reset();
+  test::ExpectTensorEqual<uint8>(cache[2][0],
+                                 test::AsTensor<uint8>({7, 8, 9}));
+}
+
+TEST(CacheSpillFileTest, CanSpill) {
+  EXPECT_TRUE(CacheSpillFile::CanSpill({test::AsTensor<int32>({1})}));
+  EXPECT_FALSE(CacheSpillFile::CanSpill(
+      {test::AsTensor<int32>({1}), test::AsTensor<tstring>({"a"})}));
+}
+
+TEST(MemoryCacheTest, ReturnsReservedBytes) {
+  auto ram_budget_manager = std::make_shared<model::RamBudgetManager>(100);
+  ASSERT_TRUE(ram_budget_manager->RequestLegacyPrefetchBytes(40));
+  ASSERT_TRUE(ram_budget_manager->RequestLegacyPrefetchBytes(40));
+
+  MemoryCache cache;
+  cache.Complete({{test::AsTensor<int32>({1})}}, ram_budget_manager, 40);
+  EXPECT_EQ(ram_budget_manager->AvailableModelRam(), 20);
+  // Completing the cache again returns the new reservation right away.
+  cache.Complete({}, ram_budget_manager, 40);
+  EXPECT_EQ(ram_budget_manager->AvailableModelRam(), 60);
+  EXPECT_EQ(cache.size(), 1);
+
+  cache.Reset();
+  EXPECT_EQ(ram_budget_manager->AvailableModelRam(), 100);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
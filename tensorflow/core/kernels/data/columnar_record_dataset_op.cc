@@ -0,0 +1,596 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/columnar_record_dataset_op.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/utils.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mem.h"
+
+namespace tensorflow {
+namespace data {
+
+// See documentation in ../../ops/dataset_ops.cc for a high-level
+// description of the following op.
+
+/* static */ constexpr const char* const ColumnarRecordDatasetOp::kDatasetType;
+/* static */ constexpr const char* const ColumnarRecordDatasetOp::kFileNames;
+/* static */ constexpr const char* const ColumnarRecordDatasetOp::kOutputTypes;
+/* static */ constexpr const char* const ColumnarRecordDatasetOp::kOutputShapes;
+
+namespace {
+
+constexpr char kCurrentFileIndex[] = "current_file_index";
+constexpr char kOffset[] = "offset";
+
+// "TFCR" in little-endian order.
+constexpr uint32_t kMagic = 0x52434654;
+// Records, and the data of their columns, start at multiples of this.
+constexpr uint64_t kAlignment = Allocator::kAllocatorAlignment;
+// The size of the magic, `num_columns`, `record_size` and `num_rows` fields.
+constexpr uint64_t kRecordHeaderSize = 24;
+// The size of the fields of a column other than its dimensions.
+constexpr uint64_t kColumnHeaderSize = 24;
+
+uint64_t AlignUp(uint64_t n) {
+  return (n + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+// A column of a record.
+struct Column {
+  DataType dtype;
+  TensorShape shape;
+  // Offset of the data of the column from the start of the record.
+  uint64_t offset;
+  uint64_t size;
+};
+
+// A tensor buffer that aliases a region of a memory mapped file, and keeps the
+// mapping alive for as long as the tensor is referenced.
+class MappedRecordBuffer : public TensorBuffer {
+ public:
+  MappedRecordBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                     const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name(ColumnarRecordDatasetOp::kDatasetType);
+  }
+  // The mapping is read-only, so kernels must not forward it as an output.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+
+// The contents of a file whose file system does not support memory mapping.
+class FileContents : public ReadOnlyMemoryRegion {
+ public:
+  static Status Read(Env* env, const string& filename,
+                     std::unique_ptr<ReadOnlyMemoryRegion>* region) {
+    uint64_t size;
+    TF_RETURN_IF_ERROR(env->GetFileSize(filename, &size));
+    std::unique_ptr<RandomAccessFile> file;
+    TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+    auto contents = absl::WrapUnique(new FileContents(size));
+    StringPiece result;
+    TF_RETURN_IF_ERROR(file->Read(0, size, &result, contents->data_));
+    if (result.size() != size) {
+      return errors::DataLoss("Read ", result.size(), " bytes of ", filename,
+                              " instead of ", size);
+    }
+    if (result.data() != contents->data_) {
+      std::memcpy(contents->data_, result.data(), size);
+    }
+    *region = std::move(contents);
+    return absl::OkStatus();
+  }
+
+  ~FileContents() override { port::AlignedFree(data_); }
+
+  const void* data() override { return data_; }
+  uint64 length() override { return length_; }
+
+ private:
+  explicit FileContents(uint64_t length)
+      : data_(static_cast<char*>(port::AlignedMalloc(
+            std::max<uint64_t>(length, 1), kAlignment))),
+        length_(length) {}
+
+  char* const data_;
+  const uint64_t length_;
+};
+
+// Memory maps `filename`, or reads it into memory if its file system does not
+// support memory mapping. Empty files, which cannot be mapped, are read too.
+Status MapFile(Env* env, const string& filename,
+               std::shared_ptr<ReadOnlyMemoryRegion>* region) {
+  uint64_t size;
+  TF_RETURN_IF_ERROR(env->GetFileSize(filename, &size));
+  std::unique_ptr<ReadOnlyMemoryRegion> mapped;
+  Status s = size == 0
+                 ? errors::Unimplemented("Empty files cannot be mapped.")
+                 : env->NewReadOnlyMemoryRegionFromFile(filename, &mapped);
+  if (errors::IsUnimplemented(s)) {
+    VLOG(2) << "Reading " << filename << " into memory as its file system "
+            << "does not support memory mapping.";
+    s = FileContents::Read(env, filename, &mapped);
+  }
+  TF_RETURN_IF_ERROR(s);
+  *region = std::move(mapped);
+  return absl::OkStatus();
+}
+
+// Parses the header of the record at `offset` of `region`, which holds the
+// contents of `filename`.
+Status ParseRecord(ReadOnlyMemoryRegion* region, const string& filename,
+                   uint64_t offset, std::vector<Column>* columns,
+                   uint64_t* record_size) {
+  auto corrupted = [&filename, offset](auto... args) {
+    return errors::DataLoss("Corrupted columnar record at offset ", offset,
+                            " of ", filename, ": ", args...);
+  };
+  if (offset % kAlignment != 0 || offset > region->length() ||
+      region->length() - offset < kRecordHeaderSize) {
+    return corrupted("the record is truncated.");
+  }
+  const char* record = static_cast<const char*>(region->data()) + offset;
+  const uint64_t available = region->length() - offset;
+  if (core::DecodeFixed32(record) != kMagic) {
+    return corrupted("the record does not start with the expected magic.");
+  }
+  const uint32_t num_columns = core::DecodeFixed32(record + 4);
+  *record_size = core::DecodeFixed64(record + 8);
+  const uint64_t num_rows = core::DecodeFixed64(record + 16);
+  if (*record_size > available || *record_size % kAlignment != 0 ||
+      *record_size < kRecordHeaderSize) {
+    return corrupted("the record size ", *record_size, " is invalid.");
+  }
+  if (num_columns > (*record_size - kRecordHeaderSize) / kColumnHeaderSize) {
+    return corrupted("the number of columns ", num_columns, " is invalid.");
+  }
+  uint64_t position = kRecordHeaderSize;
+  columns->clear();
+  columns->reserve(num_columns);
+  for (uint32_t i = 0; i < num_columns; ++i) {
+    if (*record_size - position < kColumnHeaderSize) {
+      return corrupted("the header of column ", i, " is truncated.");
+    }
+    const uint32_t dtype = core::DecodeFixed32(record + position);
+    const uint32_t rank = core::DecodeFixed32(record + position + 4);
+    position += 8;
+    if (!DataType_IsValid(dtype) ||
+        !DataTypeCanUseMemcpy(static_cast<DataType>(dtype))) {
+      return corrupted("column ", i, " has unsupported type ", dtype, ".");
+    }
+    if (rank >= TensorShape::MaxDimensions() ||
+        (*record_size - position - 16) / sizeof(uint64_t) < rank) {
+      return corrupted("column ", i, " has invalid rank ", rank, ".");
+    }
+    std::vector<int64_t> dims = {static_cast<int64_t>(num_rows)};
+    for (uint32_t j = 0; j < rank; ++j) {
+      dims.push_back(core::DecodeFixed64(record + position));
+      position += sizeof(uint64_t);
+    }
+    Column column;
+    column.dtype = static_cast<DataType>(dtype);
+    Status s = TensorShape::BuildTensorShape(dims, &column.shape);
+    if (!s.ok()) {
+      return corrupted("column ", i, " has an invalid shape: ", s.message());
+    }
+    column.offset = core::DecodeFixed64(record + position);
+    column.size = core::DecodeFixed64(record + position + 8);
+    position += 16;
+    if (column.offset % kAlignment != 0 || column.offset > *record_size ||
+        *record_size - column.offset < column.size) {
+      return corrupted("the data of column ", i, " is out of bounds.");
+    }
+    if (column.size != static_cast<uint64_t>(column.shape.num_elements()) *
+                           DataTypeSize(column.dtype)) {
+      return corrupted("the data size of column ", i,
+                       " does not match its shape ",
+                       column.shape.DebugString(), ".");
+    }
+    columns->push_back(std::move(column));
+  }
+  return absl::OkStatus();
+}
+
+// Returns a tensor holding `column` of the record at `offset` of `region`.
+// The tensor aliases `region` unless its data is not sufficiently aligned.
+Tensor ColumnTensor(IteratorContext* ctx,
+                    const std::shared_ptr<ReadOnlyMemoryRegion>& region,
+                    uint64_t offset, const Column& column) {
+  const char* data =
+      static_cast<const char*>(region->data()) + offset + column.offset;
+  if (column.size == 0 ||
+      reinterpret_cast<uintptr_t>(data) % EIGEN_MAX_ALIGN_BYTES != 0) {
+    Tensor tensor(ctx->allocator({}), column.dtype, column.shape);
+    if (column.size > 0) {
+      std::memcpy(tensor.data(), data, column.size);
+    }
+    return tensor;
+  }
+  auto* buffer = new MappedRecordBuffer(region, data, column.size);
+  Tensor tensor(column.dtype, column.shape, buffer);
+  buffer->Unref();
+  return tensor;
+}
+
+}  // namespace
+
+class ColumnarRecordDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, std::vector<string> filenames,
+          const DataTypeVector& output_types,
+          const std::vector<PartialTensorShape>& output_shapes)
+      : DatasetBase(DatasetContext(ctx)),
+        filenames_(std::move(filenames)),
+        output_types_(output_types),
+        output_shapes_(output_shapes) {}
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return std::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return output_types_;
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    return absl::OkStatus();
+  }
+
+  Status CheckExternalState() const override { return absl::OkStatus(); }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* filenames = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(filenames_, &filenames));
+    TF_RETURN_IF_ERROR(b->AddDataset(this, {filenames}, output));
+    return absl::OkStatus();
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    bool SymbolicCheckpointCompatible() const override { return true; }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      std::vector<Column> columns;
+      uint64_t record_size;
+      bool end_of_files;
+      TF_RETURN_IF_ERROR(
+          NextRecordLocked(ctx, &columns, &record_size, &end_of_files));
+      if (end_of_files) {
+        *end_of_sequence = true;
+        return absl::OkStatus();
+      }
+      out_tensors->reserve(columns.size());
+      for (const Column& column : columns) {
+        out_tensors->push_back(ColumnTensor(ctx, region_, offset_, column));
+      }
+      offset_ += record_size;
+      static monitoring::CounterCell* bytes_counter =
+          metrics::GetTFDataBytesReadCounter(kDatasetType);
+      bytes_counter->IncrementBy(record_size);
+      *end_of_sequence = false;
+      return absl::OkStatus();
+    }
+
+    Status SkipInternal(IteratorContext* ctx, int num_to_skip,
+                        bool* end_of_sequence, int* num_skipped) override {
+      *num_skipped = 0;
+      mutex_lock l(mu_);
+      while (*num_skipped < num_to_skip) {
+        std::vector<Column> columns;
+        uint64_t record_size;
+        bool end_of_files;
+        TF_RETURN_IF_ERROR(
+            NextRecordLocked(ctx, &columns, &record_size, &end_of_files));
+        if (end_of_files) {
+          *end_of_sequence = true;
+          return absl::OkStatus();
+        }
+        offset_ += record_size;
+        ++*num_skipped;
+      }
+      *end_of_sequence = false;
+      return absl::OkStatus();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeSourceNode(std::move(args));
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kCurrentFileIndex,
+                                             current_file_index_));
+      if (region_) {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            prefix(), kOffset, static_cast<int64_t>(offset_)));
+      }
+      return absl::OkStatus();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      region_.reset();
+      int64_t current_file_index;
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(prefix(), kCurrentFileIndex, &current_file_index));
+      current_file_index_ = size_t(current_file_index);
+      if (reader->Contains(prefix(), kOffset)) {
+        int64_t offset;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kOffset, &offset));
+        TF_RETURN_IF_ERROR(SetupFileLocked(ctx->env()));
+        offset_ = offset;
+      }
+      return absl::OkStatus();
+    }
+
+   private:
+    // Parses the header of the next record, moving on to the next files as
+    // needed. Sets `end_of_files` if there are no more records.
+    Status NextRecordLocked(IteratorContext* ctx, std::vector<Column>* columns,
+                            uint64_t* record_size, bool* end_of_files)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      while (true) {
+        if (region_) {
+          if (offset_ < region_->length()) {
+            Status s =
+                ParseRecord(region_.get(),
+                            dataset()->filenames_[current_file_index_],
+                            offset_, columns, record_size);
+            if (s.ok()) {
+              s = CheckColumns(*columns);
+            }
+            if (!s.ok()) {
+              // Move on to the next file so that the error can be ignored
+              // without repeating the same file.
+              region_.reset();
+              ++current_file_index_;
+              return s;
+            }
+            *end_of_files = false;
+            return absl::OkStatus();
+          }
+          region_.reset();
+          ++current_file_index_;
+        }
+        if (current_file_index_ == dataset()->filenames_.size()) {
+          *end_of_files = true;
+          return absl::OkStatus();
+        }
+        TF_RETURN_IF_ERROR(SetupFileLocked(ctx->env()));
+      }
+    }
+
+    // Checks that `columns` match the output signature of the dataset.
+    Status CheckColumns(const std::vector<Column>& columns) const
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const string& filename = dataset()->filenames_[current_file_index_];
+      if (columns.size() != dataset()->output_types_.size()) {
+        return errors::InvalidArgument(
+            "The record at offset ", offset_, " of ", filename, " has ",
+            columns.size(), " columns, but the dataset expects ",
+            dataset()->output_types_.size(), ".");
+      }
+      for (int i = 0; i < columns.size(); ++i) {
+        if (columns[i].dtype != dataset()->output_types_[i]) {
+          return errors::InvalidArgument(
+              "Column ", i, " of the record at offset ", offset_, " of ",
+              filename, " has type ", DataTypeString(columns[i].dtype),
+              ", but the dataset expects ",
+              DataTypeString(dataset()->output_types_[i]), ".");
+        }
+        if (!dataset()->output_shapes_[i].IsCompatibleWith(
+                columns[i].shape)) {
+          return errors::InvalidArgument(
+              "Column ", i, " of the record at offset ", offset_, " of ",
+              filename, " has shape ", columns[i].shape.DebugString(),
+              ", which is not compatible with the expected shape ",
+              dataset()->output_shapes_[i].DebugString(), ".");
+        }
+      }
+      return absl::OkStatus();
+    }
+
+    // Maps the file at `current_file_index_`.
+    Status SetupFileLocked(Env* env) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (current_file_index_ >= dataset()->filenames_.size()) {
+        return errors::InvalidArgument(
+            "current_file_index_:", current_file_index_,
+            " >= filenames_.size():", dataset()->filenames_.size());
+      }
+      TF_RETURN_IF_ERROR(MapFile(
+          env, TranslateFileName(dataset()->filenames_[current_file_index_]),
+          &region_));
+      offset_ = 0;
+      return absl::OkStatus();
+    }
+
+    mutex mu_;
+    size_t current_file_index_ TF_GUARDED_BY(mu_) = 0;
+    // The contents of the current file. Tensors produced from the file hold
+    // references to it.
+    std::shared_ptr<ReadOnlyMemoryRegion> region_ TF_GUARDED_BY(mu_);
+    // The offset of the next record in the current file.
+    uint64_t offset_ TF_GUARDED_BY(mu_) = 0;
+  };
+
+  const std::vector<string> filenames_;
+  const DataTypeVector output_types_;
+  const std::vector<PartialTensorShape> output_shapes_;
+};
+
+ColumnarRecordDatasetOp::ColumnarRecordDatasetOp(OpKernelConstruction* ctx)
+    : DatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
+  for (DataType dtype : output_types_) {
+    OP_REQUIRES(ctx, DataTypeCanUseMemcpy(dtype),
+                errors::InvalidArgument(
+                    "`ColumnarRecordDataset` does not support columns of type ",
+                    DataTypeString(dtype), "."));
+  }
+}
+
+void ColumnarRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                          DatasetBase** output) {
+  const Tensor* filenames_tensor;
+  OP_REQUIRES_OK(ctx, ctx->input(kFileNames, &filenames_tensor));
+  OP_REQUIRES(
+      ctx, filenames_tensor->dims() <= 1,
+      errors::InvalidArgument("`filenames` must be a scalar or a vector."));
+
+  std::vector<string> filenames;
+  filenames.reserve(filenames_tensor->NumElements());
+  for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
+    VLOG(2) << "Reading file: " << filenames_tensor->flat<tstring>()(i);
+    filenames.push_back(filenames_tensor->flat<tstring>()(i));
+    metrics::RecordTFDataFilename(kDatasetType, filenames[i]);
+  }
+  LogFilenames(filenames);
+
+  *output =
+      new Dataset(ctx, std::move(filenames), output_types_, output_shapes_);
+}
+
+Status WriteColumnarRecord(const std::vector<Tensor>& columns,
+                           WritableFile* file) {
+  if (columns.empty()) {
+    return errors::InvalidArgument("A columnar record must have a column.");
+  }
+  if (columns[0].dims() == 0) {
+    return errors::InvalidArgument("The columns of a record must not be "
+                                   "scalars.");
+  }
+  const int64_t num_rows = columns[0].dim_size(0);
+  uint64_t header_size = kRecordHeaderSize;
+  for (const Tensor& column : columns) {
+    if (!DataTypeCanUseMemcpy(column.dtype())) {
+      return errors::InvalidArgument("Columns of type ",
+                                     DataTypeString(column.dtype()),
+                                     " are not supported.");
+    }
+    if (column.dims() == 0 || column.dim_size(0) != num_rows) {
+      return errors::InvalidArgument(
+          "The columns of a record must have the same first dimension, got ",
+          column.shape().DebugString(), " and ",
+          columns[0].shape().DebugString(), ".");
+    }
+    header_size += kColumnHeaderSize + (column.dims() - 1) * sizeof(uint64_t);
+  }
+  int64_t position;
+  TF_RETURN_IF_ERROR(file->Tell(&position));
+  if (position % kAlignment != 0) {
+    return errors::FailedPrecondition(
+        "Columnar records must start at a multiple of ", kAlignment,
+        " bytes, but the file is at offset ", position, ".");
+  }
+
+  std::vector<uint64_t> offsets;
+  uint64_t record_size = AlignUp(header_size);
+  for (const Tensor& column : columns) {
+    offsets.push_back(record_size);
+    record_size = AlignUp(record_size + column.TotalBytes());
+  }
+  std::string header;
+  core::PutFixed32(&header, kMagic);
+  core::PutFixed32(&header, columns.size());
+  core::PutFixed64(&header, record_size);
+  core::PutFixed64(&header, num_rows);
+  for (int i = 0; i < columns.size(); ++i) {
+    core::PutFixed32(&header, columns[i].dtype());
+    core::PutFixed32(&header, columns[i].dims() - 1);
+    for (int j = 1; j < columns[i].dims(); ++j) {
+      core::PutFixed64(&header, columns[i].dim_size(j));
+    }
+    core::PutFixed64(&header, offsets[i]);
+    core::PutFixed64(&header, columns[i].TotalBytes());
+  }
+  uint64_t written = 0;
+  auto append_padding = [&written, file](uint64_t end) -> Status {
+    if (end > written) {
+      TF_RETURN_IF_ERROR(file->Append(std::string(end - written, '\0')));
+      written = end;
+    }
+    return absl::OkStatus();
+  };
+  TF_RETURN_IF_ERROR(file->Append(header));
+  written = header.size();
+  for (int i = 0; i < columns.size(); ++i) {
+    TF_RETURN_IF_ERROR(append_padding(offsets[i]));
+    StringPiece data = columns[i].tensor_data();
+    TF_RETURN_IF_ERROR(file->Append(data));
+    written += data.size();
+  }
+  return append_padding(record_size);
+}
+
+namespace {
+REGISTER_KERNEL_BUILDER(Name("ColumnarRecordDataset").Device(DEVICE_CPU),
+                        ColumnarRecordDatasetOp);
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,79 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_COLUMNAR_RECORD_DATASET_OP_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_COLUMNAR_RECORD_DATASET_OP_H_
+
+#include <vector>
+
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/file_system.h"
+
+namespace tensorflow {
+namespace data {
+
+// Reads files of pre-batched records in a columnar format. Each record holds
+// a batch of examples as one column per component, and produces one element
+// with a tensor per column. The files are memory mapped, and the tensors alias
+// the mapped pages, so no per-record decoding or copying is done.
+//
+// A file is a sequence of records, each of which starts at a multiple of 64
+// bytes. A record consists of, with integers in little-endian order:
+//
+//   fixed32 magic, fixed32 num_columns, fixed64 record_size, fixed64 num_rows
+//   for each column:
+//     fixed32 dtype, fixed32 rank, fixed64 dims[rank],
+//     fixed64 data_offset, fixed64 data_size
+//   the data of each column
+//
+// where `record_size` is a multiple of 64 bytes that includes the padding
+// after the last column, `dims` is the shape of a row of the column, and
+// `data_offset` is the offset of the data of the column from the start of the
+// record, which is a multiple of 64 bytes. The data of a column is the
+// `[num_rows] + dims` tensor in row-major order and in the byte order of the
+// host, which must be able to copy its type with `memcpy`.
+//
+// The records carry no checksums, as verifying them would require reading
+// every mapped page.
+class ColumnarRecordDatasetOp : public DatasetOpKernel {
+ public:
+  static constexpr const char* const kDatasetType = "ColumnarRecord";
+  static constexpr const char* const kFileNames = "filenames";
+  static constexpr const char* const kOutputTypes = "output_types";
+  static constexpr const char* const kOutputShapes = "output_shapes";
+
+  explicit ColumnarRecordDatasetOp(OpKernelConstruction* ctx);
+
+ protected:
+  void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override;
+
+ private:
+  class Dataset;
+
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+};
+
+// Appends a record holding `columns` to `file`, in the format read by
+// `ColumnarRecordDataset`. The columns must have types that can be copied with
+// `memcpy`, and must have the same first dimension, which is the number of
+// rows of the record.
+Status WriteColumnarRecord(const std::vector<Tensor>& columns,
+                           WritableFile* file);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_COLUMNAR_RECORD_DATASET_OP_H_
@@ -0,0 +1,264 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/columnar_record_dataset_op.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/framework/tensor_description.pb.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kNodeName[] = "columnar_record_dataset";
+
+class ColumnarRecordDatasetParams : public DatasetParams {
+ public:
+  ColumnarRecordDatasetParams(std::vector<tstring> filenames,
+                              DataTypeVector output_dtypes,
+                              std::vector<PartialTensorShape> output_shapes,
+                              string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        filenames_(std::move(filenames)) {}
+
+  std::vector<Tensor> GetInputTensors() const override {
+    int num_files = filenames_.size();
+    return {CreateTensor<tstring>(TensorShape({num_files}), filenames_)};
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {ColumnarRecordDatasetOp::kFileNames};
+    return absl::OkStatus();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {{"output_types", output_dtypes_},
+                    {"output_shapes", output_shapes_},
+                    {"metadata", ""}};
+    return absl::OkStatus();
+  }
+
+  string dataset_type() const override {
+    return ColumnarRecordDatasetOp::kDatasetType;
+  }
+
+ private:
+  std::vector<tstring> filenames_;
+};
+
+class ColumnarRecordDatasetOpTest : public DatasetOpsTestBase {};
+
+// Writes a file for each element of `records`, which holds the columns of the
+// records of the file.
+Status CreateTestFiles(const std::vector<tstring>& filenames,
+                       const std::vector<std::vector<std::vector<Tensor>>>&
+                           records) {
+  for (int i = 0; i < filenames.size(); ++i) {
+    std::unique_ptr<WritableFile> file;
+    TF_RETURN_IF_ERROR(Env::Default()->NewWritableFile(filenames[i], &file));
+    for (const std::vector<Tensor>& columns : records[i]) {
+      TF_RETURN_IF_ERROR(WriteColumnarRecord(columns, file.get()));
+    }
+    TF_RETURN_IF_ERROR(file->Close());
+  }
+  return absl::OkStatus();
+}
+
+std::vector<Tensor> Record(std::vector<int64_t> ids,
+                           std::vector<float> features) {
+  const int64_t num_rows = ids.size();
+  return {CreateTensor<int64_t>(TensorShape({num_rows}), ids),
+          CreateTensor<float>(TensorShape({num_rows, 2}), features)};
+}
+
+// Test case 1: two files with records of different numbers of rows.
+ColumnarRecordDatasetParams ColumnarRecordDatasetParams1() {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/columnar_record_1"),
+      absl::StrCat(testing::TmpDir(), "/columnar_record_2")};
+  TF_CHECK_OK(CreateTestFiles(
+      filenames, {{Record({1, 2}, {1.0, 1.5, 2.0, 2.5}), Record({3}, {3, 3.5})},
+                  {Record({4, 5, 6}, {4, 4.5, 5, 5.5, 6, 6.5})}}));
+  return ColumnarRecordDatasetParams(
+      filenames, {DT_INT64, DT_FLOAT},
+      {PartialTensorShape({-1}), PartialTensorShape({-1, 2})}, kNodeName);
+}
+
+// Test case 2: an empty file.
+ColumnarRecordDatasetParams EmptyFileParams() {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/columnar_record_empty")};
+  TF_CHECK_OK(CreateTestFiles(filenames, {{}}));
+  return ColumnarRecordDatasetParams(
+      filenames, {DT_INT64, DT_FLOAT},
+      {PartialTensorShape({-1}), PartialTensorShape({-1, 2})}, kNodeName);
+}
+
+std::vector<Tensor> ExpectedOutputs() {
+  std::vector<Tensor> outputs;
+  for (auto& record : {Record({1, 2}, {1.0, 1.5, 2.0, 2.5}),
+                       Record({3}, {3, 3.5}),
+                       Record({4, 5, 6}, {4, 4.5, 5, 5.5, 6, 6.5})}) {
+    outputs.insert(outputs.end(), record.begin(), record.end());
+  }
+  return outputs;
+}
+
+std::vector<GetNextTestCase<ColumnarRecordDatasetParams>> GetNextTestCases() {
+  return {{/*dataset_params=*/ColumnarRecordDatasetParams1(),
+           /*expected_outputs=*/ExpectedOutputs()},
+          {/*dataset_params=*/EmptyFileParams(),
+           /*expected_outputs=*/{}}};
+}
+
+ITERATOR_GET_NEXT_TEST_P(ColumnarRecordDatasetOpTest,
+                         ColumnarRecordDatasetParams, GetNextTestCases())
+
+std::vector<SkipTestCase<ColumnarRecordDatasetParams>> SkipTestCases() {
+  return {{/*dataset_params=*/ColumnarRecordDatasetParams1(),
+           /*num_to_skip*/ 2, /*expected_num_skipped*/ 2, /*get_next*/ true,
+           /*expected_outputs=*/Record({4, 5, 6}, {4, 4.5, 5, 5.5, 6, 6.5})},
+          {/*dataset_params=*/ColumnarRecordDatasetParams1(),
+           /*num_to_skip*/ 4, /*expected_num_skipped*/ 3}};
+}
+
+ITERATOR_SKIP_TEST_P(ColumnarRecordDatasetOpTest, ColumnarRecordDatasetParams,
+                     SkipTestCases())
+
+TEST_F(ColumnarRecordDatasetOpTest, DatasetNodeName) {
+  auto dataset_params = ColumnarRecordDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetNodeName(dataset_params.node_name()));
+}
+
+TEST_F(ColumnarRecordDatasetOpTest, DatasetTypeString) {
+  auto dataset_params = ColumnarRecordDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetTypeString(
+      name_utils::OpName(ColumnarRecordDatasetOp::kDatasetType)));
+}
+
+TEST_F(ColumnarRecordDatasetOpTest, DatasetOutputDtypes) {
+  auto dataset_params = ColumnarRecordDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetOutputDtypes({DT_INT64, DT_FLOAT}));
+}
+
+TEST_F(ColumnarRecordDatasetOpTest, DatasetOutputShapes) {
+  auto dataset_params = ColumnarRecordDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetOutputShapes(
+      {PartialTensorShape({-1}), PartialTensorShape({-1, 2})}));
+}
+
+TEST_F(ColumnarRecordDatasetOpTest, Cardinality) {
+  auto dataset_params = ColumnarRecordDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetCardinality(kUnknownCardinality));
+}
+
+TEST_F(ColumnarRecordDatasetOpTest, IteratorPrefix) {
+  auto dataset_params = ColumnarRecordDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckIteratorPrefix(
+      name_utils::IteratorPrefix(ColumnarRecordDatasetOp::kDatasetType,
+                                 dataset_params.iterator_prefix())));
+}
+
+TEST_F(ColumnarRecordDatasetOpTest, OutputsAliasMappedFile) {
+  auto dataset_params = ColumnarRecordDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  TF_ASSERT_OK(
+      iterator_->GetNext(iterator_ctx_.get(), &out_tensors, &end_of_sequence));
+  ASSERT_EQ(out_tensors.size(), 2);
+  for (const Tensor& tensor : out_tensors) {
+    TensorDescription description;
+    tensor.FillDescription(&description);
+    EXPECT_EQ(description.allocation_description().allocator_name(),
+              ColumnarRecordDatasetOp::kDatasetType);
+  }
+}
+
+TEST_F(ColumnarRecordDatasetOpTest, MismatchedType) {
+  std::string filename =
+      absl::StrCat(testing::TmpDir(), "/columnar_record_mismatched");
+  TF_ASSERT_OK(CreateTestFiles({filename}, {{Record({1}, {1.0, 1.5})}}));
+  auto dataset_params = ColumnarRecordDatasetParams(
+      {filename}, {DT_INT32, DT_FLOAT},
+      {PartialTensorShape({-1}), PartialTensorShape({-1, 2})}, kNodeName);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  EXPECT_EQ(
+      iterator_->GetNext(iterator_ctx_.get(), &out_tensors, &end_of_sequence)
+          .code(),
+      absl::StatusCode::kInvalidArgument);
+}
+
+TEST_F(ColumnarRecordDatasetOpTest, CorruptedRecord) {
+  std::string filename =
+      absl::StrCat(testing::TmpDir(), "/columnar_record_corrupted");
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename,
+                                 std::string(64, 'x')));
+  auto dataset_params = ColumnarRecordDatasetParams(
+      {filename}, {DT_INT64}, {PartialTensorShape({-1})}, kNodeName);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  EXPECT_EQ(
+      iterator_->GetNext(iterator_ctx_.get(), &out_tensors, &end_of_sequence)
+          .code(),
+      absl::StatusCode::kDataLoss);
+}
+
+TEST(WriteColumnarRecordTest, MismatchedRows) {
+  std::unique_ptr<WritableFile> file;
+  TF_ASSERT_OK(Env::Default()->NewWritableFile(
+      absl::StrCat(testing::TmpDir(), "/columnar_record_invalid"), &file));
+  EXPECT_EQ(
+      WriteColumnarRecord({CreateTensor<int64_t>(TensorShape({2}), {1, 2}),
+                           CreateTensor<int64_t>(TensorShape({1}), {3})},
+                          file.get())
+          .code(),
+      absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(WriteColumnarRecord(
+                {CreateTensor<tstring>(TensorShape({1}), {"a"})}, file.get())
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+std::vector<IteratorSaveAndRestoreTestCase<ColumnarRecordDatasetParams>>
+IteratorSaveAndRestoreTestCases() {
+  return {{/*dataset_params=*/ColumnarRecordDatasetParams1(),
+           /*breakpoints=*/{0, 2, 4},
+           /*expected_outputs=*/ExpectedOutputs()}};
+}
+
+ITERATOR_SAVE_AND_RESTORE_TEST_P(ColumnarRecordDatasetOpTest,
+                                 ColumnarRecordDatasetParams,
+                                 IteratorSaveAndRestoreTestCases())
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -25,7 +25,24 @@ namespace data {
 namespace experimental {
 
 CompressElementOp::CompressElementOp(OpKernelConstruction* ctx)
-    : OpKernel(ctx) {}
+    : OpKernel(ctx) {
+  // Graphs that predate the codec attributes compress with snappy.
+  if (ctx->HasAttr(kCodec)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kCodec, &options_.codec));
+  }
+  if (ctx->HasAttr(kCodecLevel)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kCodecLevel, &options_.level));
+  }
+  if (ctx->HasAttr(kMinCompressionBytes)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kMinCompressionBytes,
+                                     &options_.min_compression_bytes));
+  }
+  OP_REQUIRES(ctx,
+              options_.codec.empty() ||
+                  CompressionCodec::Get(options_.codec) != nullptr,
+              errors::InvalidArgument("Unknown compression codec: ",
+                                      options_.codec));
+}
 
 void CompressElementOp::Compute(OpKernelContext* ctx) {
   std::vector<Tensor> components;
@@ -33,7 +50,7 @@ void CompressElementOp::Compute(OpKernelContext* ctx) {
     components.push_back(ctx->input(i));
   }
   CompressedElement compressed;
-  OP_REQUIRES_OK(ctx, CompressElement(components, &compressed));
+  OP_REQUIRES_OK(ctx, CompressElement(components, options_, &compressed));
 
   Tensor* output;
   OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &output));
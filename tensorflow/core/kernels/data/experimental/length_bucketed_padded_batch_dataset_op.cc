@@ -0,0 +1,528 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/length_bucketed_padded_batch_dataset_op.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/serialization_utils.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/kernels/data/padded_batch_dataset_op.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stringprintf.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// Constants declared in length_bucketed_padded_batch_dataset_op.h and used both
+// here and in test cases.
+/* static */ constexpr const char* const
+    LengthBucketedPaddedBatchDatasetOp::kDatasetType;
+/* static */ constexpr const char* const
+    LengthBucketedPaddedBatchDatasetOp::kInputDataset;
+/* static */ constexpr const char* const
+    LengthBucketedPaddedBatchDatasetOp::kBufferSize;
+/* static */ constexpr const char* const
+    LengthBucketedPaddedBatchDatasetOp::kMaxBatchSize;
+/* static */ constexpr const char* const
+    LengthBucketedPaddedBatchDatasetOp::kMaxBatchTokens;
+/* static */ constexpr const char* const
+    LengthBucketedPaddedBatchDatasetOp::kMaxPaddingRatio;
+/* static */ constexpr const char* const
+    LengthBucketedPaddedBatchDatasetOp::kPaddedShapes;
+/* static */ constexpr const char* const
+    LengthBucketedPaddedBatchDatasetOp::kPaddingValues;
+/* static */ constexpr const char* const
+    LengthBucketedPaddedBatchDatasetOp::kToutputTypes;
+/* static */ constexpr const char* const
+    LengthBucketedPaddedBatchDatasetOp::kOutputShapes;
+/* static */ constexpr const char* const
+    LengthBucketedPaddedBatchDatasetOp::kNumPaddedShapes;
+
+namespace {
+
+constexpr char kExhausted[] = "exhausted";
+constexpr char kStaged[] = "staged";
+constexpr char kTotalLength[] = "total_length";
+constexpr char kNumLengths[] = "num_lengths";
+
+// With an autotuned buffer size, the number of batches of the largest size
+// that the staging buffer holds.
+constexpr int64_t kAutotuneStagedBatches = 16;
+
+}  // namespace
+
+class LengthBucketedPaddedBatchDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, int64_t buffer_size, int64_t max_batch_size,
+          int64_t max_batch_tokens, float max_padding_ratio,
+          std::vector<PartialTensorShape> padded_shapes,
+          std::vector<Tensor> padding_values, const DatasetBase* input)
+      : DatasetBase(DatasetContext(ctx)),
+        buffer_size_(buffer_size),
+        max_batch_size_(max_batch_size),
+        max_batch_tokens_(max_batch_tokens),
+        max_padding_ratio_(max_padding_ratio),
+        padded_shapes_(std::move(padded_shapes)),
+        padding_values_(std::move(padding_values)),
+        input_(input),
+        traceme_metadata_(
+            {{"buffer_size",
+              buffer_size == model::kAutotune
+                  ? "autotune"
+                  : strings::Printf("%lld",
+                                    static_cast<long long>(buffer_size))},
+             {"max_batch_size",
+              strings::Printf("%lld", static_cast<long long>(max_batch_size))},
+             {"max_batch_tokens",
+              strings::Printf("%lld",
+                              static_cast<long long>(max_batch_tokens))},
+             {"max_padding_ratio",
+              strings::Printf("%f", max_padding_ratio)}}) {
+    input_->Ref();
+    output_shapes_.reserve(padded_shapes_.size());
+    for (const PartialTensorShape& padded_shape : padded_shapes_) {
+      output_shapes_.push_back(
+          PartialTensorShape({-1}).Concatenate(padded_shape));
+    }
+  }
+
+  ~Dataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return std::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return input_->output_dtypes();
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  string DebugString() const override {
+    name_utils::DatasetDebugStringParams params;
+    params.set_args(buffer_size_, max_batch_size_, max_batch_tokens_,
+                    max_padding_ratio_);
+    return name_utils::DatasetDebugString(kDatasetType, params);
+  }
+
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    // The number of batches depends on the lengths of the elements.
+    int64_t n = input_->Cardinality(options);
+    if (n == kInfiniteCardinality || n == 0) {
+      return n;
+    }
+    return kUnknownCardinality;
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    inputs->push_back(input_);
+    return absl::OkStatus();
+  }
+
+  Status CheckExternalState() const override {
+    return input_->CheckExternalState();
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_graph_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+    Node* buffer_size = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(buffer_size_, &buffer_size));
+    Node* max_batch_size = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(max_batch_size_, &max_batch_size));
+    Node* max_batch_tokens = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(max_batch_tokens_, &max_batch_tokens));
+    Node* max_padding_ratio = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(max_padding_ratio_, &max_padding_ratio));
+
+    std::vector<Node*> padded_shapes;
+    padded_shapes.reserve(padded_shapes_.size());
+    for (const PartialTensorShape& padded_shape : padded_shapes_) {
+      Node* node;
+      Tensor t(DT_INT64, TensorShape({padded_shape.dims()}));
+      for (int i = 0; i < padded_shape.dims(); ++i) {
+        t.vec<int64_t>()(i) = padded_shape.dim_size(i);
+      }
+      TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+      padded_shapes.emplace_back(node);
+    }
+
+    std::vector<Node*> padding_values;
+    padding_values.reserve(padding_values_.size());
+    for (const Tensor& t : padding_values_) {
+      Node* node;
+      TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+      padding_values.emplace_back(node);
+    }
+
+    AttrValue output_types;
+    b->BuildAttrValue(output_dtypes(), &output_types);
+    AttrValue N;
+    b->BuildAttrValue<int64_t>(padded_shapes_.size(), &N);
+
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this,
+        {{0, input_graph_node},
+         {1, buffer_size},
+         {2, max_batch_size},
+         {3, max_batch_tokens},
+         {4, max_padding_ratio}},
+        {{5, padded_shapes}, {6, padding_values}},
+        {{kToutputTypes, output_types}, {kNumPaddedShapes, N}}, output));
+    return absl::OkStatus();
+  }
+
+ private:
+  // Stages up to `buffer_size` input elements, sorts them by length, and cuts
+  // the sorted elements into batches. A batch grows until it reaches
+  // `max_batch_size` elements, until padding it to its longest element would
+  // exceed `max_batch_tokens`, or until more than `max_padding_ratio` of it
+  // would be padding. The staging buffer is refilled once all of its batches
+  // are produced.
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    Status Initialize(IteratorContext* ctx) override {
+      return dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_);
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      std::vector<std::vector<Tensor>> batch_elements;
+      {
+        mutex_lock l(mu_);
+        if (next_staged_ == staged_.size()) {
+          TF_RETURN_IF_ERROR(FillStagingBuffer(ctx));
+        }
+        if (staged_.empty()) {
+          *end_of_sequence = true;
+          return absl::OkStatus();
+        }
+        const size_t batch_end = BatchEnd();
+        batch_elements.reserve(batch_end - next_staged_);
+        for (; next_staged_ < batch_end; ++next_staged_) {
+          RecordBufferDequeue(ctx, staged_[next_staged_]);
+          batch_elements.push_back(std::move(staged_[next_staged_]));
+        }
+      }
+      TF_RETURN_IF_ERROR(CopyPaddedBatch(
+          ctx, dataset()->output_dtypes(), dataset()->padded_shapes_,
+          dataset()->padding_values_, /*parallel_copy=*/false, batch_elements,
+          out_tensors));
+      *end_of_sequence = false;
+      return absl::OkStatus();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeUnknownRatioNode(std::move(args));
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(writer->WriteScalar(
+          prefix(), kExhausted, static_cast<int64_t>(!input_impl_)));
+      if (input_impl_) {
+        TF_RETURN_IF_ERROR(SaveInput(ctx, writer, input_impl_));
+      }
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(prefix(), kTotalLength, total_length_));
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(prefix(), kNumLengths, num_lengths_));
+      // Drop the elements that were already produced, so that only the
+      // remaining ones, which stay in sorted order, are written.
+      staged_.erase(staged_.begin(), staged_.begin() + next_staged_);
+      lengths_.erase(lengths_.begin(), lengths_.begin() + next_staged_);
+      next_staged_ = 0;
+      return WriteElementsToCheckpoint(
+          writer, absl::StrCat(prefix(), kColon, kStaged), staged_);
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      int64_t input_exhausted;
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(prefix(), kExhausted, &input_exhausted));
+      if (static_cast<bool>(input_exhausted)) {
+        input_impl_.reset();
+      } else {
+        TF_RETURN_IF_ERROR(
+            dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_));
+        TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
+      }
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(prefix(), kTotalLength, &total_length_));
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(prefix(), kNumLengths, &num_lengths_));
+      staged_.clear();
+      TF_RETURN_IF_ERROR(ReadElementsFromCheckpoint(
+          ctx, reader, absl::StrCat(prefix(), kColon, kStaged), &staged_));
+      lengths_.clear();
+      lengths_.reserve(staged_.size());
+      for (const std::vector<Tensor>& element : staged_) {
+        lengths_.push_back(ElementLength(element));
+        RecordBufferEnqueue(ctx, element);
+      }
+      next_staged_ = 0;
+      return absl::OkStatus();
+    }
+
+    TraceMeMetadata GetTraceMeMetadata() const override {
+      return dataset()->traceme_metadata_;
+    }
+
+   private:
+    // Returns the length of `element`, which is the largest size of the first
+    // dimension of the components that are padded in that dimension.
+    int64_t ElementLength(const std::vector<Tensor>& element) const {
+      int64_t length = 0;
+      for (size_t i = 0; i < element.size(); ++i) {
+        const PartialTensorShape& padded_shape = dataset()->padded_shapes_[i];
+        if (padded_shape.dims() > 0 && padded_shape.dim_size(0) == -1 &&
+            element[i].dims() > 0) {
+          length = std::max(length, element[i].dim_size(0));
+        }
+      }
+      return length;
+    }
+
+    // Returns the number of elements to stage. With an autotuned buffer size,
+    // enough elements of the mean length seen so far are staged to produce
+    // `kAutotuneStagedBatches` full batches.
+    int64_t StagingBufferSize() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (dataset()->buffer_size_ != model::kAutotune) {
+        return dataset()->buffer_size_;
+      }
+      int64_t batch_size = dataset()->max_batch_size_;
+      if (dataset()->max_batch_tokens_ > 0 && total_length_ > 0) {
+        const int64_t mean_length =
+            std::max<int64_t>(total_length_ / num_lengths_, 1);
+        batch_size = std::clamp<int64_t>(
+            dataset()->max_batch_tokens_ / mean_length, 1, batch_size);
+      }
+      return kAutotuneStagedBatches * batch_size;
+    }
+
+    // Refills the staging buffer from the input, and sorts it by length.
+    Status FillStagingBuffer(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      staged_.clear();
+      lengths_.clear();
+      next_staged_ = 0;
+      const int64_t buffer_size = StagingBufferSize();
+      std::vector<std::vector<Tensor>> elements;
+      std::vector<int64_t> lengths;
+      while (input_impl_ &&
+             static_cast<int64_t>(elements.size()) < buffer_size) {
+        std::vector<Tensor> element;
+        bool end_of_input = false;
+        TF_RETURN_IF_ERROR(input_impl_->GetNext(ctx, &element, &end_of_input));
+        if (end_of_input) {
+          input_impl_.reset();
+          break;
+        }
+        RecordBufferEnqueue(ctx, element);
+        lengths.push_back(ElementLength(element));
+        total_length_ += lengths.back();
+        ++num_lengths_;
+        elements.push_back(std::move(element));
+      }
+      // Sort stably so that elements of the same length keep their order.
+      std::vector<size_t> order(elements.size());
+      std::iota(order.begin(), order.end(), 0);
+      std::stable_sort(order.begin(), order.end(), [&lengths](size_t a,
+                                                              size_t b) {
+        return lengths[a] < lengths[b];
+      });
+      staged_.reserve(elements.size());
+      lengths_.reserve(elements.size());
+      for (size_t i : order) {
+        staged_.push_back(std::move(elements[i]));
+        lengths_.push_back(lengths[i]);
+      }
+      return absl::OkStatus();
+    }
+
+    // Returns the end of the batch that starts at `next_staged_`.
+    size_t BatchEnd() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      size_t end = next_staged_;
+      int64_t total_length = 0;
+      while (end < staged_.size() &&
+             static_cast<int64_t>(end - next_staged_) <
+                 dataset()->max_batch_size_) {
+        // As the elements are sorted, the batch is padded to the length of
+        // the last element.
+        const int64_t length = lengths_[end];
+        const int64_t batch_size = end - next_staged_ + 1;
+        const int64_t padded_length = batch_size * length;
+        if (batch_size > 1) {
+          if (dataset()->max_batch_tokens_ > 0 &&
+              padded_length > dataset()->max_batch_tokens_) {
+            break;
+          }
+          if (padded_length > 0 &&
+              1.0 - static_cast<double>(total_length + length) /
+                        padded_length >
+                  dataset()->max_padding_ratio_) {
+            break;
+          }
+        }
+        total_length += length;
+        ++end;
+      }
+      return end;
+    }
+
+    mutex mu_;
+    std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+    // The staged elements sorted by length, and their lengths. The elements
+    // before `next_staged_` were already produced.
+    std::vector<std::vector<Tensor>> staged_ TF_GUARDED_BY(mu_);
+    std::vector<int64_t> lengths_ TF_GUARDED_BY(mu_);
+    size_t next_staged_ TF_GUARDED_BY(mu_) = 0;
+    // The sum and the number of the lengths of the input elements seen so far.
+    int64_t total_length_ TF_GUARDED_BY(mu_) = 0;
+    int64_t num_lengths_ TF_GUARDED_BY(mu_) = 0;
+  };
+
+  const int64_t buffer_size_;
+  const int64_t max_batch_size_;
+  const int64_t max_batch_tokens_;
+  const float max_padding_ratio_;
+  const std::vector<PartialTensorShape> padded_shapes_;
+  const std::vector<Tensor> padding_values_;
+  const DatasetBase* const input_;
+  std::vector<PartialTensorShape> output_shapes_;
+  const TraceMeMetadata traceme_metadata_;
+};
+
+LengthBucketedPaddedBatchDatasetOp::LengthBucketedPaddedBatchDatasetOp(
+    OpKernelConstruction* ctx)
+    : UnaryDatasetOpKernel(ctx) {}
+
+void LengthBucketedPaddedBatchDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                                     DatasetBase* input,
+                                                     DatasetBase** output) {
+  int64_t buffer_size;
+  OP_REQUIRES_OK(ctx,
+                 ParseScalarArgument<int64_t>(ctx, kBufferSize, &buffer_size));
+  OP_REQUIRES(
+      ctx, buffer_size > 0 || buffer_size == model::kAutotune,
+      errors::InvalidArgument("Buffer size must be greater than zero or ",
+                              model::kAutotune, " to autotune it."));
+  int64_t max_batch_size;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64_t>(ctx, kMaxBatchSize,
+                                                   &max_batch_size));
+  OP_REQUIRES(ctx, max_batch_size > 0,
+              errors::InvalidArgument(
+                  "Maximum batch size must be greater than zero."));
+  int64_t max_batch_tokens;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64_t>(ctx, kMaxBatchTokens,
+                                                   &max_batch_tokens));
+  OP_REQUIRES(ctx, max_batch_tokens > 0 || max_batch_tokens == -1,
+              errors::InvalidArgument("Maximum batch tokens must be greater "
+                                      "than zero, or -1 for no limit."));
+  float max_padding_ratio;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<float>(ctx, kMaxPaddingRatio,
+                                                 &max_padding_ratio));
+  OP_REQUIRES(ctx, max_padding_ratio >= 0.0 && max_padding_ratio <= 1.0,
+              errors::InvalidArgument(
+                  "Maximum padding ratio must be between 0 and 1, but got ",
+                  max_padding_ratio));
+
+  OpInputList padded_shape_tensors;
+  OP_REQUIRES_OK(ctx, ctx->input_list(kPaddedShapes, &padded_shape_tensors));
+  OP_REQUIRES(ctx, padded_shape_tensors.size() == input->output_shapes().size(),
+              errors::InvalidArgument("Number of padded shapes (",
+                                      padded_shape_tensors.size(),
+                                      ") must match the number of components "
+                                      "in the input dataset's elements (",
+                                      input->output_shapes().size(), ")"));
+  std::vector<PartialTensorShape> padded_shapes;
+  padded_shapes.reserve(padded_shape_tensors.size());
+  for (const Tensor& padded_shape_t : padded_shape_tensors) {
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(padded_shape_t.shape()),
+                errors::InvalidArgument("All padded shapes must be vectors"));
+    PartialTensorShape padded_shape;
+    OP_REQUIRES_OK(ctx, PartialTensorShape::MakePartialShape(
+                            padded_shape_t.vec<int64_t>().data(),
+                            padded_shape_t.NumElements(), &padded_shape));
+    padded_shapes.push_back(std::move(padded_shape));
+  }
+
+  OpInputList padding_values_list;
+  OP_REQUIRES_OK(ctx, ctx->input_list(kPaddingValues, &padding_values_list));
+  OP_REQUIRES(ctx, padding_values_list.size() == input->output_shapes().size(),
+              errors::InvalidArgument(
+                  "Number of padding values (", padding_values_list.size(),
+                  ") must match the number of components in the input "
+                  "dataset's elements (",
+                  input->output_shapes().size(), ")"));
+  std::vector<Tensor> padding_values;
+  padding_values.reserve(padding_values_list.size());
+  for (int i = 0; i < padding_values_list.size(); ++i) {
+    const Tensor& padding_value_t = padding_values_list[i];
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(padding_value_t.shape()),
+                errors::InvalidArgument("All padding values must be scalars"));
+    OP_REQUIRES(ctx, padding_value_t.dtype() == input->output_dtypes()[i],
+                errors::InvalidArgument(
+                    "Mismatched type between padding value ", i,
+                    " and input dataset's component ", i, ": ",
+                    DataTypeString(padding_value_t.dtype()), " vs. ",
+                    DataTypeString(input->output_dtypes()[i])));
+    padding_values.push_back(tensor::DeepCopy(padding_value_t));
+  }
+
+  *output = new Dataset(ctx, buffer_size, max_batch_size, max_batch_tokens,
+                        max_padding_ratio, std::move(padded_shapes),
+                        std::move(padding_values), input);
+}
+
+namespace {
+REGISTER_KERNEL_BUILDER(
+    Name("LengthBucketedPaddedBatchDataset").Device(DEVICE_CPU),
+    LengthBucketedPaddedBatchDatasetOp);
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
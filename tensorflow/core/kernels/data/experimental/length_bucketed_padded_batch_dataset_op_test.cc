@@ -0,0 +1,316 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/length_bucketed_padded_batch_dataset_op.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/data/dataset_test_base.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "length_bucketed_padded_batch_dataset";
+
+class LengthBucketedPaddedBatchDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  LengthBucketedPaddedBatchDatasetParams(
+      T input_dataset_params, int64_t buffer_size, int64_t max_batch_size,
+      int64_t max_batch_tokens, float max_padding_ratio,
+      std::vector<Tensor> padded_shapes, std::vector<Tensor> padded_values,
+      DataTypeVector output_dtypes,
+      std::vector<PartialTensorShape> output_shapes, string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        buffer_size_(buffer_size),
+        max_batch_size_(max_batch_size),
+        max_batch_tokens_(max_batch_tokens),
+        max_padding_ratio_(max_padding_ratio),
+        padded_shapes_(std::move(padded_shapes)),
+        padded_values_(std::move(padded_values)) {
+    input_dataset_params_.push_back(std::make_unique<T>(input_dataset_params));
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    std::vector<Tensor> input_tensors = {
+        CreateTensor<int64_t>(TensorShape({}), {buffer_size_}),
+        CreateTensor<int64_t>(TensorShape({}), {max_batch_size_}),
+        CreateTensor<int64_t>(TensorShape({}), {max_batch_tokens_}),
+        CreateTensor<float>(TensorShape({}), {max_padding_ratio_})};
+    for (auto& padded_shape : padded_shapes_) {
+      input_tensors.emplace_back(padded_shape);
+    }
+    for (auto& padded_value : padded_values_) {
+      input_tensors.emplace_back(padded_value);
+    }
+    return input_tensors;
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {LengthBucketedPaddedBatchDatasetOp::kInputDataset,
+                    LengthBucketedPaddedBatchDatasetOp::kBufferSize,
+                    LengthBucketedPaddedBatchDatasetOp::kMaxBatchSize,
+                    LengthBucketedPaddedBatchDatasetOp::kMaxBatchTokens,
+                    LengthBucketedPaddedBatchDatasetOp::kMaxPaddingRatio};
+    for (int i = 0; i < padded_shapes_.size(); ++i) {
+      input_names->emplace_back(strings::StrCat(
+          LengthBucketedPaddedBatchDatasetOp::kPaddedShapes, "_", i));
+    }
+    for (int j = 0; j < padded_values_.size(); ++j) {
+      input_names->emplace_back(strings::StrCat(
+          LengthBucketedPaddedBatchDatasetOp::kPaddingValues, "_", j));
+    }
+    return absl::OkStatus();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {{"Toutput_types", output_dtypes_},
+                    {"output_shapes", output_shapes_},
+                    {"N", static_cast<int64_t>(padded_shapes_.size())},
+                    {"metadata", ""}};
+    return absl::OkStatus();
+  }
+
+  string dataset_type() const override {
+    return LengthBucketedPaddedBatchDatasetOp::kDatasetType;
+  }
+
+ private:
+  int64_t buffer_size_;
+  int64_t max_batch_size_;
+  int64_t max_batch_tokens_;
+  float max_padding_ratio_;
+  std::vector<Tensor> padded_shapes_;
+  std::vector<Tensor> padded_values_;
+};
+
+class LengthBucketedPaddedBatchDatasetOpTest : public DatasetOpsTestBase {};
+
+// Creates a dataset of three elements of length 2 followed by four elements
+// of length 1.
+ConcatenateDatasetParams MixedLengthDatasetParams() {
+  auto tensor_slice_dataset_params_0 = TensorSliceDatasetParams(
+      /*components=*/CreateTensors<int64_t>(TensorShape{3, 2},
+                                            {{0, 1, 2, 3, 4, 5}}),
+      /*node_name=*/"tensor_slice_0");
+  auto tensor_slice_dataset_params_1 = TensorSliceDatasetParams(
+      /*components=*/CreateTensors<int64_t>(TensorShape{4, 1}, {{6, 7, 8, 9}}),
+      /*node_name=*/"tensor_slice_1");
+  return ConcatenateDatasetParams(std::move(tensor_slice_dataset_params_0),
+                                  std::move(tensor_slice_dataset_params_1),
+                                  /*output_dtypes=*/{DT_INT64},
+                                  /*output_shapes=*/{PartialTensorShape({-1})},
+                                  /*node_name=*/"concatenate");
+}
+
+LengthBucketedPaddedBatchDatasetParams MakeParams(int64_t buffer_size,
+                                                  int64_t max_batch_size,
+                                                  int64_t max_batch_tokens,
+                                                  float max_padding_ratio) {
+  return LengthBucketedPaddedBatchDatasetParams(
+      MixedLengthDatasetParams(), buffer_size, max_batch_size,
+      max_batch_tokens, max_padding_ratio,
+      /*padded_shapes=*/{CreateTensor<int64_t>(TensorShape{1}, {-1})},
+      /*padded_values=*/{CreateTensor<int64_t>(TensorShape{}, {-1})},
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1, -1})},
+      /*node_name=*/kNodeName);
+}
+
+// Test case 1: the whole input is staged, and batches are only limited by
+// their size.
+LengthBucketedPaddedBatchDatasetParams MaxBatchSizeParams() {
+  return MakeParams(/*buffer_size=*/7, /*max_batch_size=*/3,
+                    /*max_batch_tokens=*/-1, /*max_padding_ratio=*/1.0);
+}
+
+// Test case 2: batches must not contain any padding.
+LengthBucketedPaddedBatchDatasetParams NoPaddingParams() {
+  return MakeParams(/*buffer_size=*/7, /*max_batch_size=*/3,
+                    /*max_batch_tokens=*/-1, /*max_padding_ratio=*/0.0);
+}
+
+// Test case 3: batches are limited by their number of padded entries.
+LengthBucketedPaddedBatchDatasetParams MaxBatchTokensParams() {
+  return MakeParams(/*buffer_size=*/7, /*max_batch_size=*/8,
+                    /*max_batch_tokens=*/4, /*max_padding_ratio=*/1.0);
+}
+
+// Test case 4: the staging buffer is smaller than the input.
+LengthBucketedPaddedBatchDatasetParams SmallBufferParams() {
+  return MakeParams(/*buffer_size=*/3, /*max_batch_size=*/2,
+                    /*max_batch_tokens=*/-1, /*max_padding_ratio=*/1.0);
+}
+
+// Test case 5: the staging buffer is autotuned.
+LengthBucketedPaddedBatchDatasetParams AutotuneParams() {
+  return MakeParams(/*buffer_size=*/model::kAutotune, /*max_batch_size=*/8,
+                    /*max_batch_tokens=*/4, /*max_padding_ratio=*/1.0);
+}
+
+LengthBucketedPaddedBatchDatasetParams InvalidBufferSizeParams() {
+  return MakeParams(/*buffer_size=*/0, /*max_batch_size=*/2,
+                    /*max_batch_tokens=*/-1, /*max_padding_ratio=*/1.0);
+}
+
+LengthBucketedPaddedBatchDatasetParams InvalidMaxBatchSizeParams() {
+  return MakeParams(/*buffer_size=*/3, /*max_batch_size=*/0,
+                    /*max_batch_tokens=*/-1, /*max_padding_ratio=*/1.0);
+}
+
+LengthBucketedPaddedBatchDatasetParams InvalidMaxBatchTokensParams() {
+  return MakeParams(/*buffer_size=*/3, /*max_batch_size=*/2,
+                    /*max_batch_tokens=*/0, /*max_padding_ratio=*/1.0);
+}
+
+LengthBucketedPaddedBatchDatasetParams InvalidMaxPaddingRatioParams() {
+  return MakeParams(/*buffer_size=*/3, /*max_batch_size=*/2,
+                    /*max_batch_tokens=*/-1, /*max_padding_ratio=*/1.5);
+}
+
+std::vector<Tensor> SmallBufferOutputs() {
+  return {CreateTensor<int64_t>(TensorShape{2, 2}, {0, 1, 2, 3}),
+          CreateTensor<int64_t>(TensorShape{1, 2}, {4, 5}),
+          CreateTensor<int64_t>(TensorShape{2, 1}, {6, 7}),
+          CreateTensor<int64_t>(TensorShape{1, 1}, {8}),
+          CreateTensor<int64_t>(TensorShape{1, 1}, {9})};
+}
+
+std::vector<Tensor> MaxBatchTokensOutputs() {
+  return {CreateTensor<int64_t>(TensorShape{4, 1}, {6, 7, 8, 9}),
+          CreateTensor<int64_t>(TensorShape{2, 2}, {0, 1, 2, 3}),
+          CreateTensor<int64_t>(TensorShape{1, 2}, {4, 5})};
+}
+
+std::vector<GetNextTestCase<LengthBucketedPaddedBatchDatasetParams>>
+GetNextTestCases() {
+  return {
+      {/*dataset_params=*/MaxBatchSizeParams(),
+       /*expected_outputs=*/
+       {CreateTensor<int64_t>(TensorShape{3, 1}, {6, 7, 8}),
+        CreateTensor<int64_t>(TensorShape{3, 2}, {9, -1, 0, 1, 2, 3}),
+        CreateTensor<int64_t>(TensorShape{1, 2}, {4, 5})}},
+      {/*dataset_params=*/NoPaddingParams(),
+       /*expected_outputs=*/
+       {CreateTensor<int64_t>(TensorShape{3, 1}, {6, 7, 8}),
+        CreateTensor<int64_t>(TensorShape{1, 1}, {9}),
+        CreateTensor<int64_t>(TensorShape{3, 2}, {0, 1, 2, 3, 4, 5})}},
+      {/*dataset_params=*/MaxBatchTokensParams(),
+       /*expected_outputs=*/MaxBatchTokensOutputs()},
+      {/*dataset_params=*/SmallBufferParams(),
+       /*expected_outputs=*/SmallBufferOutputs()},
+      {/*dataset_params=*/AutotuneParams(),
+       /*expected_outputs=*/MaxBatchTokensOutputs()}};
+}
+
+ITERATOR_GET_NEXT_TEST_P(LengthBucketedPaddedBatchDatasetOpTest,
+                         LengthBucketedPaddedBatchDatasetParams,
+                         GetNextTestCases())
+
+TEST_F(LengthBucketedPaddedBatchDatasetOpTest, DatasetNodeName) {
+  auto dataset_params = SmallBufferParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetNodeName(dataset_params.node_name()));
+}
+
+TEST_F(LengthBucketedPaddedBatchDatasetOpTest, DatasetTypeString) {
+  auto dataset_params = SmallBufferParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetTypeString(
+      name_utils::OpName(LengthBucketedPaddedBatchDatasetOp::kDatasetType)));
+}
+
+TEST_F(LengthBucketedPaddedBatchDatasetOpTest, DatasetOutputDtypes) {
+  auto dataset_params = SmallBufferParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetOutputDtypes({DT_INT64}));
+}
+
+TEST_F(LengthBucketedPaddedBatchDatasetOpTest, DatasetOutputShapes) {
+  auto dataset_params = SmallBufferParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetOutputShapes({PartialTensorShape({-1, -1})}));
+}
+
+TEST_F(LengthBucketedPaddedBatchDatasetOpTest, Cardinality) {
+  auto dataset_params = SmallBufferParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetCardinality(kUnknownCardinality));
+}
+
+TEST_F(LengthBucketedPaddedBatchDatasetOpTest, IteratorOutputDtypes) {
+  auto dataset_params = SmallBufferParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckIteratorOutputDtypes({DT_INT64}));
+}
+
+TEST_F(LengthBucketedPaddedBatchDatasetOpTest, IteratorOutputShapes) {
+  auto dataset_params = SmallBufferParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckIteratorOutputShapes({PartialTensorShape({-1, -1})}));
+}
+
+TEST_F(LengthBucketedPaddedBatchDatasetOpTest, IteratorPrefix) {
+  auto dataset_params = SmallBufferParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckIteratorPrefix(name_utils::IteratorPrefix(
+      LengthBucketedPaddedBatchDatasetOp::kDatasetType,
+      dataset_params.iterator_prefix())));
+}
+
+std::vector<
+    IteratorSaveAndRestoreTestCase<LengthBucketedPaddedBatchDatasetParams>>
+IteratorSaveAndRestoreTestCases() {
+  return {{/*dataset_params=*/SmallBufferParams(),
+           /*breakpoints=*/{0, 1, 3, 5},
+           /*expected_outputs=*/SmallBufferOutputs()},
+          {/*dataset_params=*/MaxBatchTokensParams(),
+           /*breakpoints=*/{0, 1, 2, 3},
+           /*expected_outputs=*/MaxBatchTokensOutputs()}};
+}
+
+ITERATOR_SAVE_AND_RESTORE_TEST_P(LengthBucketedPaddedBatchDatasetOpTest,
+                                 LengthBucketedPaddedBatchDatasetParams,
+                                 IteratorSaveAndRestoreTestCases())
+
+class ParameterizedInvalidArgumentTest
+    : public LengthBucketedPaddedBatchDatasetOpTest,
+      public ::testing::WithParamInterface<
+          LengthBucketedPaddedBatchDatasetParams> {};
+
+TEST_P(ParameterizedInvalidArgumentTest, InvalidArguments) {
+  auto dataset_params = GetParam();
+  EXPECT_EQ(Initialize(dataset_params).code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    LengthBucketedPaddedBatchDatasetOpTest, ParameterizedInvalidArgumentTest,
+    ::testing::ValuesIn({InvalidBufferSizeParams(), InvalidMaxBatchSizeParams(),
+                         InvalidMaxBatchTokensParams(),
+                         InvalidMaxPaddingRatioParams()}));
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
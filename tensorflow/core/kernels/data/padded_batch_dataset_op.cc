@@ -47,6 +47,136 @@ namespace data {
 
 constexpr char kExhausted[] = "exhausted";
 
+// NOTE(mrry): If the input or output sizes are statically known, we could
+// potentially read the input values in-place into their respective slice
+// locations. This would require a different GetNext() overload that
+// supports zero-copy, and might make sense in an optimization pass.
+Status CopyPaddedBatch(IteratorContext* ctx,
+                       const DataTypeVector& output_dtypes,
+                       const std::vector<PartialTensorShape>& padded_shapes,
+                       const std::vector<Tensor>& padding_values,
+                       bool parallel_copy,
+                       const std::vector<std::vector<Tensor>>& batch_elements,
+                       std::vector<Tensor>* out_tensors) {
+  const size_t num_tuple_components = batch_elements[0].size();
+  const int64_t num_batch_elements = batch_elements.size();
+  for (size_t component_index = 0; component_index < num_tuple_components;
+       ++component_index) {
+    // 1. Determine the shape of the padded tensor.
+    TensorShape batch_component_shape({num_batch_elements});
+    const PartialTensorShape& padded_shape = padded_shapes[component_index];
+
+    for (int dim = 0; dim < padded_shape.dims(); ++dim) {
+      if (padded_shape.dim_size(dim) == -1) {
+        TF_RETURN_IF_ERROR(batch_component_shape.AddDimWithStatus(0));
+      } else {
+        TF_RETURN_IF_ERROR(batch_component_shape.AddDimWithStatus(
+            padded_shape.dim_size(dim)));
+      }
+    }
+
+    for (int64_t i = 0; i < num_batch_elements; ++i) {
+      const TensorShape& element_shape =
+          batch_elements[i][component_index].shape();
+      // TODO(mrry): Perform this check in the shape function if
+      // enough static information is available to do so.
+      if (element_shape.dims() != padded_shape.dims()) {
+        return errors::InvalidArgument(
+            "All elements in a batch must have the same rank as the "
+            "padded shape for component",
+            component_index, ": expected rank ", padded_shape.dims(),
+            " but got element with rank ", element_shape.dims());
+      }
+      for (int dim = 0; dim < padded_shape.dims(); ++dim) {
+        if (padded_shape.dim_size(dim) == -1) {
+          // Take the max of all batch elements in this dimension.
+          if (batch_elements[i][component_index].shape().dim_size(dim) >
+              batch_component_shape.dim_size(dim + 1)) {
+            batch_component_shape.set_dim(
+                dim + 1,
+                batch_elements[i][component_index].shape().dim_size(dim));
+          }
+        } else {
+          if (batch_elements[i][component_index].shape().dim_size(dim) >
+              batch_component_shape.dim_size(dim + 1)) {
+            return errors::DataLoss(
+                "Attempted to pad to a smaller size than the input "
+                "element.");
+          }
+        }
+      }
+    }
+
+    // 2. Copy each batch element to the appropriate location in
+    // the output component tensor.
+    out_tensors->emplace_back(ctx->allocator({}),
+                              output_dtypes[component_index],
+                              batch_component_shape);
+    Tensor& batch_component = out_tensors->back();
+    TF_RETURN_IF_ERROR(batch_util::SetElementZero(
+        &batch_component, padding_values[component_index]));
+
+    // Build the output tuple component by copying one slice from each input
+    // element in the batch.
+    TensorShape component_shape({});
+    for (int i = 1; i < batch_component_shape.dims(); ++i) {
+      TF_RETURN_IF_ERROR(component_shape.AddDimWithStatus(
+          batch_component_shape.dim_size(i)));
+    }
+    auto copy_element_fn = [component_index, &batch_elements,
+                            &batch_component, &component_shape](int index) {
+      // Take the fast path if possible.
+      if (batch_elements[index][component_index].shape() ==
+          component_shape) {
+        TF_RETURN_IF_ERROR(batch_util::CopyElementToSlice(
+            batch_elements[index][component_index], &batch_component,
+            index));
+      } else {
+        TF_RETURN_IF_ERROR(batch_util::CopyElementToLargerSlice(
+            batch_elements[index][component_index], &batch_component,
+            index));
+      }
+      return absl::OkStatus();
+    };
+
+    if (parallel_copy && (batch_component.AllocatedBytes() /
+                                      num_batch_elements) >= (1 << 15)) {
+      BlockingCounter counter(num_batch_elements);
+      Status status;
+      mutex status_mu;
+      const auto num_threads = ctx->runner_threadpool_size();
+      const auto slice_size = num_batch_elements / num_threads;
+      int64_t offset = 0;
+      for (size_t i = 0; i < num_threads; ++i) {
+        int64_t length = slice_size;
+        // When the number of threads does not divide the number of elements
+        // evenly, the size of some slices is incremented to guarantee their
+        // sizes add up to the total number of elements.
+        if (i < num_batch_elements % num_threads) ++length;
+        (*ctx->runner())([offset, length, &status, &status_mu, &counter,
+                          &copy_element_fn]() {
+          for (size_t j = offset; j < offset + length; ++j) {
+            {
+              Status s = copy_element_fn(j);
+              mutex_lock l(status_mu);
+              status.Update(s);
+            }
+            counter.DecrementCount();
+          }
+        });
+        offset += length;
+      }
+      counter.Wait();
+      TF_RETURN_IF_ERROR(status);
+    } else {
+      for (size_t i = 0; i < num_batch_elements; ++i) {
+        TF_RETURN_IF_ERROR(copy_element_fn(i));
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
 class PaddedBatchDatasetOp::Dataset : public DatasetBase {
  public:
   Dataset(OpKernelContext* ctx, int64_t batch_size, bool drop_remainder,
@@ -233,7 +363,10 @@ class PaddedBatchDatasetOp::Dataset : public DatasetBase {
         return absl::OkStatus();
       }
 
-      TF_RETURN_IF_ERROR(CopyBatch(ctx, batch_elements, out_tensors));
+      TF_RETURN_IF_ERROR(CopyPaddedBatch(
+          ctx, output_dtypes(), dataset()->padded_shapes_,
+          dataset()->padding_values_, dataset()->parallel_copy_,
+          batch_elements, out_tensors));
       *end_of_sequence = false;
       return absl::OkStatus();
     }
@@ -276,136 +409,6 @@ class PaddedBatchDatasetOp::Dataset : public DatasetBase {
     }
 
    private:
-    // Copies the retrieved batch elements into one output tensor per tuple
-    // component.
-    //
-    // NOTE(mrry): If the input or output sizes are statically known, we could
-    // potentially read the input values in-place into their respective slice
-    // locations. This would require a different GetNext() overload that
-    // supports zero-copy, and might make sense in an optimization pass.
-    Status CopyBatch(IteratorContext* ctx,
-                     const std::vector<std::vector<Tensor>>& batch_elements,
-                     std::vector<Tensor>* out_tensors) {
-      const size_t num_tuple_components = batch_elements[0].size();
-      const int64_t num_batch_elements = batch_elements.size();
-      for (size_t component_index = 0; component_index < num_tuple_components;
-           ++component_index) {
-        // 1. Determine the shape of the padded tensor.
-        TensorShape batch_component_shape({num_batch_elements});
-        const PartialTensorShape& padded_shape =
-            dataset()->padded_shapes_[component_index];
-
-        for (int dim = 0; dim < padded_shape.dims(); ++dim) {
-          if (padded_shape.dim_size(dim) == -1) {
-            TF_RETURN_IF_ERROR(batch_component_shape.AddDimWithStatus(0));
-          } else {
-            TF_RETURN_IF_ERROR(batch_component_shape.AddDimWithStatus(
-                padded_shape.dim_size(dim)));
-          }
-        }
-
-        for (int64_t i = 0; i < num_batch_elements; ++i) {
-          const TensorShape& element_shape =
-              batch_elements[i][component_index].shape();
-          // TODO(mrry): Perform this check in the shape function if
-          // enough static information is available to do so.
-          if (element_shape.dims() != padded_shape.dims()) {
-            return errors::InvalidArgument(
-                "All elements in a batch must have the same rank as the "
-                "padded shape for component",
-                component_index, ": expected rank ", padded_shape.dims(),
-                " but got element with rank ", element_shape.dims());
-          }
-          for (int dim = 0; dim < padded_shape.dims(); ++dim) {
-            if (padded_shape.dim_size(dim) == -1) {
-              // Take the max of all batch elements in this dimension.
-              if (batch_elements[i][component_index].shape().dim_size(dim) >
-                  batch_component_shape.dim_size(dim + 1)) {
-                batch_component_shape.set_dim(
-                    dim + 1,
-                    batch_elements[i][component_index].shape().dim_size(dim));
-              }
-            } else {
-              if (batch_elements[i][component_index].shape().dim_size(dim) >
-                  batch_component_shape.dim_size(dim + 1)) {
-                return errors::DataLoss(
-                    "Attempted to pad to a smaller size than the input "
-                    "element.");
-              }
-            }
-          }
-        }
-
-        // 2. Copy each batch element to the appropriate location in
-        // the output component tensor.
-        out_tensors->emplace_back(ctx->allocator({}),
-                                  output_dtypes()[component_index],
-                                  batch_component_shape);
-        Tensor& batch_component = out_tensors->back();
-        TF_RETURN_IF_ERROR(batch_util::SetElementZero(
-            &batch_component, dataset()->padding_values_[component_index]));
-
-        // Build the output tuple component by copying one slice from each input
-        // element in the batch.
-        TensorShape component_shape({});
-        for (int i = 1; i < batch_component_shape.dims(); ++i) {
-          TF_RETURN_IF_ERROR(component_shape.AddDimWithStatus(
-              batch_component_shape.dim_size(i)));
-        }
-        auto copy_element_fn = [component_index, &batch_elements,
-                                &batch_component, &component_shape](int index) {
-          // Take the fast path if possible.
-          if (batch_elements[index][component_index].shape() ==
-              component_shape) {
-            TF_RETURN_IF_ERROR(batch_util::CopyElementToSlice(
-                batch_elements[index][component_index], &batch_component,
-                index));
-          } else {
-            TF_RETURN_IF_ERROR(batch_util::CopyElementToLargerSlice(
-                batch_elements[index][component_index], &batch_component,
-                index));
-          }
-          return absl::OkStatus();
-        };
-
-        if (dataset()->parallel_copy_ && (batch_component.AllocatedBytes() /
-                                          num_batch_elements) >= (1 << 15)) {
-          BlockingCounter counter(num_batch_elements);
-          Status status;
-          mutex status_mu;
-          const auto num_threads = ctx->runner_threadpool_size();
-          const auto slice_size = num_batch_elements / num_threads;
-          int64_t offset = 0;
-          for (size_t i = 0; i < num_threads; ++i) {
-            int64_t length = slice_size;
-            // When the number of threads does not divide the number of elements
-            // evenly, the size of some slices is incremented to guarantee their
-            // sizes add up to the total number of elements.
-            if (i < num_batch_elements % num_threads) ++length;
-            (*ctx->runner())([offset, length, &status, &status_mu, &counter,
-                              &copy_element_fn]() {
-              for (size_t j = offset; j < offset + length; ++j) {
-                {
-                  Status s = copy_element_fn(j);
-                  mutex_lock l(status_mu);
-                  status.Update(s);
-                }
-                counter.DecrementCount();
-              }
-            });
-            offset += length;
-          }
-          counter.Wait();
-          TF_RETURN_IF_ERROR(status);
-        } else {
-          for (size_t i = 0; i < num_batch_elements; ++i) {
-            TF_RETURN_IF_ERROR(copy_element_fn(i));
-          }
-        }
-      }
-      return absl::OkStatus();
-    }
-
     mutex mu_;
     std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
   };
@@ -15,7 +15,11 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DATA_PADDED_BATCH_DATASET_OP_H_
 #define TENSORFLOW_CORE_KERNELS_DATA_PADDED_BATCH_DATASET_OP_H_
 
+#include <vector>
+
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
 
 namespace tensorflow {
 namespace data {
@@ -45,6 +49,19 @@ class PaddedBatchDatasetOp : public UnaryDatasetOpKernel {
   bool parallel_copy_ = false;
 };
 
+// Copies `batch_elements` into one output tensor per tuple component. Each
+// component is padded to the corresponding `padded_shapes`, whose unknown
+// dimensions are padded to the largest size in the batch, with the
+// corresponding scalar `padding_values`. If `parallel_copy` is set, the
+// elements of large components are copied in parallel.
+Status CopyPaddedBatch(IteratorContext* ctx,
+                       const DataTypeVector& output_dtypes,
+                       const std::vector<PartialTensorShape>& padded_shapes,
+                       const std::vector<Tensor>& padding_values,
+                       bool parallel_copy,
+                       const std::vector<std::vector<Tensor>>& batch_elements,
+                       std::vector<Tensor>* out_tensors);
+
 }  // namespace data
 }  // namespace tensorflow
 
@@ -75,6 +75,10 @@ constexpr char kErrorMessage[] = "error_message";
 
 // Period between reporting dataset statistics.
 constexpr int kStatsReportingPeriodMillis = 1000;
+// With the experiment, `GetNext` spins for up to `kSpinWaitHandoffUs` before
+// blocking on the result of a call.
+constexpr char kSpinWaitHandoffExperiment[] = "spin_wait_handoff";
+constexpr int64_t kSpinWaitHandoffUs = 50;
 
 }  // namespace
 
@@ -264,6 +268,9 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
     Status Initialize(IteratorContext* ctx) override {
       mutex_lock l(*mu_);
       interleave_depth_ = ctx->interleave_depth();
+      if (GetExperiments().contains(kSpinWaitHandoffExperiment)) {
+        spin_wait_us_ = kSpinWaitHandoffUs;
+      }
 
       if (num_parallel_calls_->value == model::kAutotune) {
         num_parallel_calls_->value = GetAutotuneDefaultParallelism(ctx);
@@ -303,6 +310,13 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
         }
       }
       RecordStop(ctx);
+      if (spin_wait_us_ > 0) {
+        // The call is likely close to done, so avoid parking on the
+        // notification if it completes within the spin time.
+        SpinWait(spin_wait_us_, [&result]() {
+          return result->notification.HasBeenNotified();
+        });
+      }
       result->notification.WaitForNotification();
       RecordStart(ctx);
       profiler::TraceMe traceme([&] {
@@ -724,6 +738,9 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
     const bool autotune_;
     // Counts the number of outstanding calls.
     int64_t num_calls_ TF_GUARDED_BY(*mu_) = 0;
+    // If positive, how long `GetNext` spins on the result of a call before
+    // waiting for it to be notified. Only set in `Initialize`.
+    int64_t spin_wait_us_ = 0;
     // Controls cancellation of `input_impl_`. Must be ordered before
     // `input_impl_` so that `input_impl_` is destroyed first.
     std::unique_ptr<CancellationManager> cancellation_manager_;
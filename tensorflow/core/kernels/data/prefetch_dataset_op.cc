@@ -15,10 +15,12 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/prefetch_dataset_op.h"
 
 #include <algorithm>
+#include <atomic>
 #include <deque>
 #include <limits>
 #include <string>
 
+#include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
@@ -64,6 +66,10 @@ constexpr char kStatus[] = "status";
 constexpr char kSizeSuffix[] = ".size";
 constexpr char kCodeSuffix[] = ".code";
 constexpr char kErrorMessageSuffix[] = ".error_message";
+// With the experiment, `GetNext` and the prefetch thread spin for up to
+// `kSpinWaitHandoffUs` before parking on the condition variable.
+constexpr char kSpinWaitHandoffExperiment[] = "spin_wait_handoff";
+constexpr int64_t kSpinWaitHandoffUs = 50;
 
 }  // namespace
 
@@ -181,6 +187,9 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
           dataset()->buffer_size_, dataset()->buffer_size_min_,
           ctx->ram_budget_manager());
       interleave_depth_ = ctx->interleave_depth();
+      if (GetExperiments().contains(kSpinWaitHandoffExperiment)) {
+        spin_wait_us_ = kSpinWaitHandoffUs;
+      }
 
       if (buffer_size_->value == model::kAutotune) {
         buffer_size_->value = buffer_size_min_;
@@ -210,6 +219,7 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
         TF_RETURN_IF_ERROR(EnsureThreadsStarted(ctx));
         // Wait until the next element in the buffer has been
         // produced, or we are shutting down.
+        bool spun = false;
         while (buffer_.empty() && !prefetch_thread_finished_ &&
                buffer_limit() != 0) {
           if (legacy_autotune_) {
@@ -217,7 +227,14 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
             buffer_size_->value = auto_tuner_->buffer_limit();
           }
           RecordStop(ctx);
-          cond_var_->wait(l);
+          if (spin_wait_us_ > 0 && !spun) {
+            spun = true;
+            SpinWithoutLock([this]() {
+              return num_buffered_.load(std::memory_order_acquire) > 0;
+            });
+          } else {
+            cond_var_->wait(l);
+          }
           RecordStart(ctx);
         }
 
@@ -408,6 +425,7 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
         }
         RecordBufferEnqueue(ctx, buffer_element.value);
       }
+      num_buffered_.store(buffer_.size(), std::memory_order_release);
       return absl::OkStatus();
     }
 
@@ -418,6 +436,15 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
       return buffer_size_->value;
     }
 
+    // Releases `mu_` while spinning until `done` returns true or
+    // `spin_wait_us_` elapses, and then reacquires it.
+    void SpinWithoutLock(absl::FunctionRef<bool()> done)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(*mu_) {
+      mu_->unlock();
+      SpinWait(spin_wait_us_, done);
+      mu_->lock();
+    }
+
     void CancelThreads() TF_LOCKS_EXCLUDED(mu_) {
       cancellation_manager_->StartCancel();
       mutex_lock l(*mu_);
@@ -488,6 +515,7 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
         buffer_size_->value = auto_tuner_->buffer_limit();
       }
       buffer_.pop_front();
+      num_buffered_.store(buffer_.size(), std::memory_order_release);
       *end_of_sequence = false;
 
       // Wake the prefetch thread, in case it has been waiting for space
@@ -522,9 +550,18 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
         // 1. Wait for a slot in the buffer.
         {
           mutex_lock l(*mu_);
+          bool spun = false;
           while (!cancelled_ && buffer_.size() >= buffer_limit()) {
             RecordStop(ctx.get());
-            cond_var_->wait(l);
+            if (spin_wait_us_ > 0 && !spun) {
+              spun = true;
+              const int64_t limit = buffer_limit();
+              SpinWithoutLock([this, limit]() {
+                return num_buffered_.load(std::memory_order_acquire) < limit;
+              });
+            } else {
+              cond_var_->wait(l);
+            }
             RecordStart(ctx.get());
           }
 
@@ -575,6 +612,7 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
           RecordBufferEnqueue(ctx.get(), buffer_element.value);
           buffer_element.created_us = EnvTime::NowMicros();
           buffer_.push_back(std::move(buffer_element));
+          num_buffered_.store(buffer_.size(), std::memory_order_release);
           cond_var_->notify_all();
         }
         ++num_produced;
@@ -636,6 +674,11 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
     const int64_t buffer_size_min_;
     std::unique_ptr<PrefetchAutotuner> auto_tuner_ TF_GUARDED_BY(*mu_);
     std::deque<BufferElement> buffer_ TF_GUARDED_BY(*mu_);
+    // The size of `buffer_`, which threads can poll without holding `mu_`.
+    std::atomic<int64_t> num_buffered_{0};
+    // If positive, how long threads spin before waiting on `cond_var_`. Only
+    // set before the prefetch thread starts.
+    int64_t spin_wait_us_ = 0;
     bool cancelled_ TF_GUARDED_BY(*mu_) = false;
     bool prefetch_thread_finished_ TF_GUARDED_BY(*mu_) = false;
     const bool legacy_autotune_;
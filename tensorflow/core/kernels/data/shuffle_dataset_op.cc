@@ -75,6 +75,8 @@ constexpr char kSlicesEnd[] = "slices_end";
 constexpr char kSlicesReachedEndOfSequence[] = "slices_reached_end_of_sequence";
 constexpr char kSeedGenerator[] = "SeedGenerator";
 constexpr char kEpochNumRandomSamples[] = "epoch_num_random_samples";
+constexpr char kNextInputIndex[] = "next_input_index";
+constexpr char kShuffleElementHandlesExperiment[] = "shuffle_element_handles";
 constexpr char kShuffleDatasetV1[] = "ShuffleDataset";
 constexpr char kShuffleDatasetV2[] = "ShuffleDatasetV2";
 constexpr char kShuffleDatasetV3[] = "ShuffleDatasetV3";
@@ -203,6 +205,7 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
 
     Status Initialize(IteratorContext* ctx) override {
       mutex_lock l(mu_);
+      use_element_handles_ = ShouldUseElementHandles(ctx);
       seed_generator_->GenerateSeeds(&seed_, &seed2_);
       ResetRngs();
       // Initialize checkpoint_indices_ to the entire buffer.
@@ -241,6 +244,14 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       checkpoint_indices_.insert(slices_.front()->start % buffer_->size());
       slices_.front()->start++;
       num_elements_--;
+      if (use_element_handles_) {
+        // The buffer holds the indices of the input elements, so fetch the
+        // chosen element.
+        const int64_t input_index = (*out_tensors)[0].scalar<int64_t>()();
+        out_tensors->clear();
+        TF_RETURN_IF_ERROR(dataset()->input_->Get(AnyContext(ctx), input_index,
+                                                  out_tensors));
+      }
       return absl::OkStatus();
     }
 
@@ -278,6 +289,10 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       if (input_impl_) {
         TF_RETURN_IF_ERROR(this->SaveInput(ctx, writer, input_impl_));
       }
+      if (use_element_handles_) {
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(prefix(), kNextInputIndex, next_input_index_));
+      }
 
       // Save the epoch counter, buffer, and buffer slices.
       TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kEpoch, epoch_));
@@ -345,6 +360,21 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       } else {
         input_impl_.reset();
       }
+      if (reader->Contains(prefix(), kNextInputIndex) !=
+          use_element_handles_) {
+        return errors::FailedPrecondition(
+            "The shuffle buffer in the checkpoint holds ",
+            use_element_handles_ ? "elements" : "element indices",
+            ", but the iterator buffers ",
+            use_element_handles_ ? "element indices" : "elements",
+            ". Restore the checkpoint with the `",
+            kShuffleElementHandlesExperiment, "` experiment ",
+            use_element_handles_ ? "disabled." : "enabled.");
+      }
+      if (use_element_handles_) {
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(prefix(), kNextInputIndex, &next_input_index_));
+      }
 
       // Restore the epoch counter, buffer, and buffer slices.
       TF_RETURN_IF_ERROR(reader->ReadScalar(this->prefix(), kEpoch, &epoch_));
@@ -439,6 +469,39 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       return dataset()->buffer_size_ == kUnknownCardinality;
     }
 
+    // Returns whether to buffer the indices of the input elements instead of
+    // the elements, and fetch the chosen elements with random access. This
+    // bounds the memory of the buffer by the number of elements instead of
+    // their size, so large buffers of large elements are affordable.
+    bool ShouldUseElementHandles(IteratorContext* ctx) {
+      if (!GetExperiments().contains(kShuffleElementHandlesExperiment) ||
+          !ctx->split_providers().empty() || ctx->index_mapper() != nullptr) {
+        return false;
+      }
+      const DatasetBase* input = dataset()->input_;
+      return input->RandomIndexingCompatible().ok() &&
+             input->Cardinality() >= 0;
+    }
+
+    // Gets the next element of the input, or with element handles the index
+    // of the next element.
+    Status GetNextInput(IteratorContext* ctx, std::vector<Tensor>* element,
+                        bool* end_of_sequence)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (!use_element_handles_) {
+        return input_impl_->GetNext(ctx, element, end_of_sequence);
+      }
+      if (next_input_index_ == dataset()->input_->Cardinality()) {
+        *end_of_sequence = true;
+        return absl::OkStatus();
+      }
+      Tensor index(DT_INT64, TensorShape({}));
+      index.scalar<int64_t>()() = next_input_index_++;
+      element->push_back(std::move(index));
+      *end_of_sequence = false;
+      return absl::OkStatus();
+    }
+
     // Fills the shuffle buffer, preparing the buffer for sampling.
     Status FillBuffer(IteratorContext* ctx) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       int64_t start_micros = EnvTime::NowMicros();
@@ -458,7 +521,7 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
         std::vector<Tensor> input_element;
         bool end_of_input_sequence = false;
         TF_RETURN_IF_ERROR(
-            input_impl_->GetNext(ctx, &input_element, &end_of_input_sequence));
+            GetNextInput(ctx, &input_element, &end_of_input_sequence));
         if (end_of_input_sequence) {
           slices_.back()->reached_end_of_sequence = true;
         }
@@ -516,6 +579,7 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       }
       TF_RETURN_IF_ERROR(this->dataset()->input_->MakeIterator(
           ctx, this, this->prefix(), &input_impl_));
+      next_input_index_ = 0;
       epoch_++;
       return absl::OkStatus();
     }
@@ -579,6 +643,12 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
         TF_GUARDED_BY(mu_);
     int64_t num_random_samples_ TF_GUARDED_BY(mu_) = 0;
     bool data_produced_ TF_GUARDED_BY(mu_) = false;
+    // Whether `buffer_` holds the indices of the input elements instead of the
+    // elements, see `ShouldUseElementHandles`.
+    bool use_element_handles_ TF_GUARDED_BY(mu_) = false;
+    // The index of the next input element of the epoch to add to `buffer_`
+    // when `use_element_handles_` is set.
+    int64_t next_input_index_ TF_GUARDED_BY(mu_) = 0;
   };
 
   const DatasetBase* const input_;
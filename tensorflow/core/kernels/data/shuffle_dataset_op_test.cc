@@ -583,6 +583,68 @@ INSTANTIATE_TEST_CASE_P(ShuffleDatasetOpTest,
                         ParameterizedIteratorSaveAndRestoreTest,
                         ::testing::ValuesIn(IteratorSaveAndRestoreTestCases()));
 
+// Shuffles the element indices of a random access input, and fetches the
+// chosen elements.
+TEST_F(ShuffleDatasetOpTest, ElementHandles) {
+  setenv("TF_JOB_NAME", "test_job", /*overwrite=*/1);
+  setenv("TF_TASK_ID", "0", /*overwrite=*/1);
+  setenv("TF_DATA_EXPERIMENT_OPT_IN", "shuffle_element_handles",
+         /*overwrite=*/1);
+  for (int64_t count : {1, 2}) {
+    auto dataset_params =
+        ShuffleDatasetParams(RangeDatasetParams(10, 20, 1),
+                             /*buffer_size=*/count == 1 ? 3 : 10,
+                             /*seed=*/1,
+                             /*seed2=*/2,
+                             /*count=*/count,
+                             /*reshuffle_each_iteration=*/false,
+                             /*output_dtypes=*/{DT_INT64},
+                             /*output_shapes=*/{PartialTensorShape({})},
+                             /*node_name=*/
+                             count == 1 ? kShuffleNodeName
+                                        : kShuffleAndRepeatNodeName);
+    TF_ASSERT_OK(Initialize(dataset_params));
+    std::unique_ptr<SerializationContext> serialization_ctx;
+    TF_ASSERT_OK(CreateSerializationContext(&serialization_ctx));
+    bool end_of_sequence = false;
+    std::vector<Tensor> out_tensors;
+    while (!end_of_sequence) {
+      // Restore the iterator after each element, which checkpoints the
+      // buffered indices.
+      VariantTensorDataWriter writer;
+      TF_EXPECT_OK(iterator_->Save(serialization_ctx.get(), &writer));
+      std::vector<const VariantTensorData*> data;
+      writer.GetData(&data);
+      VariantTensorDataReader reader(data);
+      TF_EXPECT_OK(RestoreIterator(iterator_ctx_.get(), &reader,
+                                   dataset_params.iterator_prefix(),
+                                   *dataset_, &iterator_));
+      std::vector<Tensor> next;
+      TF_EXPECT_OK(
+          iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+      out_tensors.insert(out_tensors.end(), next.begin(), next.end());
+    }
+    // The same order as for the elements of `range(10)` in
+    // `ShuffleDatasetParams1` and `ShuffleDatasetParams7`.
+    std::vector<std::vector<int64_t>> expected_outputs =
+        count == 1 ? std::vector<std::vector<int64_t>>{{12}, {13}, {10},
+                                                       {15}, {16}, {14},
+                                                       {17}, {18}, {19},
+                                                       {11}}
+                   : std::vector<std::vector<int64_t>>{
+                         {19}, {10}, {18}, {16}, {11}, {13}, {17},
+                         {12}, {14}, {15}, {19}, {10}, {18}, {16},
+                         {11}, {13}, {17}, {12}, {14}, {15}};
+    TF_EXPECT_OK(ExpectEqual(
+        out_tensors,
+        CreateTensors<int64_t>(TensorShape({}), expected_outputs),
+        /*compare_order=*/true));
+  }
+  unsetenv("TF_JOB_NAME");
+  unsetenv("TF_TASK_ID");
+  unsetenv("TF_DATA_EXPERIMENT_OPT_IN");
+}
+
 TEST_F(ShuffleDatasetOpTest, InvalidArguments) {
   std::vector<ShuffleDatasetParams> dataset_params_vec(
       {ShuffleDatasetParamsWithInvalidBufferSize(),
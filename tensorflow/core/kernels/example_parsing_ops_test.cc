@@ -66,6 +66,21 @@ class Int64Filler {
   DataType dtype = DT_INT64;
 };
 
+// Ids of a small vocabulary, which are encoded as single-byte varints.
+class IdInt64Filler {
+ public:
+  IdInt64Filler() {}
+  void operator()(Feature* f, int feature_size) const {
+    for (int i = 0; i < feature_size; ++i) {
+      f->mutable_int64_list()->add_value(i % 100);
+    }
+  }
+  Tensor make_dense_default(int feature_size) {
+    return Tensor(dtype, TensorShape({feature_size}));
+  }
+  DataType dtype = DT_INT64;
+};
+
 class FloatFiller {
  public:
   FloatFiller() {}
@@ -107,6 +122,7 @@ struct ExampleStore {
       AddExample(&serialized_example, 10, 1, 100000);
       AddExample(&serialized_example, 100, 1, 10000);
       AddExample(&serialized_example, 1000, 1, 1000);
+      AddExample(&serialized_example, 10, 32, 1000);
     });
     return serialized_example;
   }
@@ -139,6 +155,7 @@ absl::once_flag ExampleStore<T>::flags_init;
 
 template struct ExampleStore<BytesFiller>;
 template struct ExampleStore<Int64Filler>;
+template struct ExampleStore<IdInt64Filler>;
 template struct ExampleStore<FloatFiller>;
 
 enum BenchmarkType { kDense, kSparse, kVarLenDense, kRagged };
@@ -340,6 +357,10 @@ typedef BenchmarkOptions<ExampleStore<Int64Filler>, kDense> DenseInt64;
 typedef BenchmarkOptions<ExampleStore<Int64Filler>, kVarLenDense>
     VarLenDenseInt64;
 typedef BenchmarkOptions<ExampleStore<Int64Filler>, kRagged> RaggedInt64;
+typedef BenchmarkOptions<ExampleStore<IdInt64Filler>, kSparse> SparseIdInt64;
+typedef BenchmarkOptions<ExampleStore<IdInt64Filler>, kDense> DenseIdInt64;
+typedef BenchmarkOptions<ExampleStore<IdInt64Filler>, kVarLenDense>
+    VarLenDenseIdInt64;
 typedef BenchmarkOptions<ExampleStore<FloatFiller>, kSparse> SparseFloat;
 typedef BenchmarkOptions<ExampleStore<FloatFiller>, kDense> DenseFloat;
 typedef BenchmarkOptions<ExampleStore<FloatFiller>, kVarLenDense>
@@ -382,6 +403,20 @@ BM_AllParseExample(SparseFloat);
 BM_AllParseExample(DenseFloat);
 BM_AllParseExample(VarLenDenseFloat);
 
+// Batches of examples with large numeric lists, as for embeddings, dense
+// feature vectors and lists of ids.
+#define BM_LargeListParseExample(Type) BM_ParseExample(Type, 32, 10, 1000);
+
+BM_LargeListParseExample(SparseInt64);
+BM_LargeListParseExample(DenseInt64);
+BM_LargeListParseExample(VarLenDenseInt64);
+BM_LargeListParseExample(SparseIdInt64);
+BM_LargeListParseExample(DenseIdInt64);
+BM_LargeListParseExample(VarLenDenseIdInt64);
+BM_LargeListParseExample(SparseFloat);
+BM_LargeListParseExample(DenseFloat);
+BM_LargeListParseExample(VarLenDenseFloat);
+
 // B == batch_size, K == num_keys. F == feature_size.
 // K must be one of 10, 100, 1000
 // B=0 indicates that a scalar input should be used (instead of a vector).
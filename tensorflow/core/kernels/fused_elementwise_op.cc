@@ -0,0 +1,336 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/math_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_join.h"
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/broadcast_to_op.h"
+#include "tensorflow/core/kernels/cwise_ops.h"
+#include "tensorflow/core/util/bcast.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+namespace {
+
+// The number of elements that every op of the fused expression evaluates at a
+// time. The intermediate values of a block stay in L1/L2 cache, so the fused
+// expression makes a single pass over memory.
+constexpr int64_t kBlockSize = 512;
+
+template <typename T>
+using ConstBlock = Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>>;
+template <typename T>
+using Block = Eigen::Map<Eigen::Array<T, Eigen::Dynamic, 1>>;
+
+template <typename T>
+struct ComputeFn {
+  using UnaryFn = void (*)(const ConstBlock<T>&, Block<T>*);
+  using BinaryFn = void (*)(const ConstBlock<T>&, const ConstBlock<T>&,
+                            Block<T>*);
+
+  // Exactly one of `unary` and `binary` is set.
+  UnaryFn unary = nullptr;
+  BinaryFn binary = nullptr;
+  int cost = 0;
+};
+
+template <typename T, typename Functor>
+void ComputeUnary(const ConstBlock<T>& in, Block<T>* out) {
+  *out = in.unaryExpr(typename Functor::func());
+}
+
+template <typename T, typename Functor>
+void ComputeBinary(const ConstBlock<T>& x, const ConstBlock<T>& y,
+                   Block<T>* out) {
+  *out = x.binaryExpr(y, typename Functor::func());
+}
+
+template <typename T>
+void ComputeRelu(const ConstBlock<T>& in, Block<T>* out) {
+  *out = in.max(T(0));
+}
+
+template <typename Functor>
+constexpr int Cost() {
+  return Eigen::internal::functor_traits<typename Functor::func>::Cost;
+}
+
+// Returns the compute functions of the ops supported by _FusedElementwise.
+// WARN: This should be consistent with the Remapper fusion in remapper.cc.
+template <typename T>
+const absl::flat_hash_map<string, ComputeFn<T>>& GetComputeFns() {
+  static const auto* fns = [] {
+    auto* fns = new absl::flat_hash_map<string, ComputeFn<T>>;
+#define REGISTER_UNARY(name, functor) \
+  (*fns)[name] = {ComputeUnary<T, functor<T>>, nullptr, Cost<functor<T>>()};
+#define REGISTER_BINARY(name, functor) \
+  (*fns)[name] = {nullptr, ComputeBinary<T, functor<T>>, Cost<functor<T>>()};
+
+    REGISTER_UNARY("Abs", functor::abs);
+    REGISTER_UNARY("Exp", functor::exp);
+    REGISTER_UNARY("Log", functor::log);
+    REGISTER_UNARY("Neg", functor::neg);
+    REGISTER_UNARY("Reciprocal", functor::inverse);
+    REGISTER_UNARY("Rsqrt", functor::rsqrt);
+    REGISTER_UNARY("Sigmoid", functor::sigmoid);
+    REGISTER_UNARY("Sqrt", functor::sqrt);
+    REGISTER_UNARY("Square", functor::square);
+    REGISTER_UNARY("Tanh", functor::tanh);
+    (*fns)["Relu"] = {ComputeRelu<T>, nullptr,
+                      Eigen::internal::functor_traits<
+                          Eigen::internal::scalar_max_op<T>>::Cost};
+
+    REGISTER_BINARY("Add", functor::add);
+    REGISTER_BINARY("AddV2", functor::add);
+    REGISTER_BINARY("Sub", functor::sub);
+    REGISTER_BINARY("Mul", functor::mul);
+    REGISTER_BINARY("RealDiv", functor::div);
+    REGISTER_BINARY("Maximum", functor::maximum);
+    REGISTER_BINARY("Minimum", functor::minimum);
+    REGISTER_BINARY("SquaredDifference", functor::squared_difference);
+
+#undef REGISTER_UNARY
+#undef REGISTER_BINARY
+    return fns;
+  }();
+  return *fns;
+}
+
+// Returns true if `arg` is `out_shape` broadcast from its trailing
+// dimensions, so that its elements repeat with a period of its size in the
+// flattened output.
+bool IsTrailingBroadcast(const TensorShape& arg, const TensorShape& out_shape) {
+  int first = 0;
+  while (first < arg.dims() && arg.dim_size(first) == 1) ++first;
+  const int num_dims = arg.dims() - first;
+  if (num_dims > out_shape.dims()) return false;
+  for (int i = 0; i < num_dims; ++i) {
+    if (arg.dim_size(first + i) !=
+        out_shape.dim_size(out_shape.dims() - num_dims + i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+template <typename T>
+class FusedElementwiseOp : public OpKernel {
+ public:
+  explicit FusedElementwiseOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    int num_args;
+    std::vector<string> fused_ops;
+    std::vector<int> fused_operands;
+    OP_REQUIRES_OK(context, context->GetAttr("num_args", &num_args));
+    OP_REQUIRES_OK(context, context->GetAttr("fused_ops", &fused_ops));
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("fused_operands", &fused_operands));
+    OP_REQUIRES(context, !fused_ops.empty(),
+                errors::InvalidArgument(
+                    "Fused elementwise op must have at least one op"));
+
+    const auto& compute_fns = GetComputeFns<T>();
+    int operand = 0;
+    for (int i = 0; i < fused_ops.size(); ++i) {
+      auto it = compute_fns.find(fused_ops[i]);
+      OP_REQUIRES(context, it != compute_fns.end(),
+                  errors::InvalidArgument(
+                      "Do not have a compute function registered for op: ",
+                      fused_ops[i]));
+      Instruction instruction;
+      instruction.fn = it->second;
+      const int arity = instruction.fn.unary != nullptr ? 1 : 2;
+      for (int j = 0; j < arity; ++j, ++operand) {
+        OP_REQUIRES(context, operand < fused_operands.size(),
+                    errors::InvalidArgument("Missing operands for op ", i,
+                                            " (", fused_ops[i], ")"));
+        const int value = fused_operands[operand];
+        OP_REQUIRES(context, value >= 0 && value < num_args + i,
+                    errors::InvalidArgument("Operand ", value, " of op ", i,
+                                            " (", fused_ops[i],
+                                            ") is out of range"));
+        instruction.operands[j] = value;
+      }
+      cost_ += instruction.fn.cost;
+      instructions_.push_back(instruction);
+    }
+    OP_REQUIRES(context, operand == fused_operands.size(),
+                errors::InvalidArgument("Expected ", operand,
+                                        " fused operands, got ",
+                                        fused_operands.size()));
+
+    VLOG(2) << "Fused elementwise op: [" << absl::StrJoin(fused_ops, ", ")
+            << "]; cost=" << cost_;
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    OpInputList args;
+    OP_REQUIRES_OK(ctx, ctx->input_list("args", &args));
+    const int num_args = args.size();
+
+    BCast::Vec out_dims = BCast::FromShape(args[0].shape());
+    for (int i = 1; i < num_args; ++i) {
+      BCast bcast(out_dims, BCast::FromShape(args[i].shape()),
+                  /*fewer_dims_optimization=*/false);
+      OP_REQUIRES(ctx, bcast.IsValid(),
+                  errors::InvalidArgument(
+                      "Incompatible shapes: ",
+                      BCast::ToShape(out_dims).DebugString(), " vs. ",
+                      args[i].shape().DebugString()));
+      out_dims = bcast.output_shape();
+    }
+    const TensorShape out_shape = BCast::ToShape(out_dims);
+    const int64_t num_elements = out_shape.num_elements();
+
+    // Every argument is read either in place, if it has the output shape, or
+    // with a period of its size if it is broadcast from the trailing
+    // dimensions. Other broadcasts are materialized first.
+    std::vector<const T*> arg_data(num_args);
+    std::vector<int64_t> arg_period(num_args);
+    std::vector<Tensor> broadcast_args;
+    broadcast_args.reserve(num_args);
+    std::vector<int> forwardable_args;
+    for (int i = 0; i < num_args; ++i) {
+      const Tensor& arg = args[i];
+      if (arg.shape() == out_shape) {
+        forwardable_args.push_back(i);
+        arg_data[i] = arg.flat<T>().data();
+        arg_period[i] = num_elements;
+      } else if (IsTrailingBroadcast(arg.shape(), out_shape)) {
+        arg_data[i] = arg.flat<T>().data();
+        arg_period[i] = std::max<int64_t>(arg.NumElements(), 1);
+      } else {
+        BCast bcast(BCast::FromShape(arg.shape()), out_dims,
+                    /*fewer_dims_optimization=*/true);
+        Tensor& broadcast = broadcast_args.emplace_back();
+        OP_REQUIRES_OK(ctx, ctx->allocate_temp(DataTypeToEnum<T>::value,
+                                               out_shape, &broadcast));
+        if (num_elements > 0) {
+          functor::BroadcastTo<CPUDevice, T>()(
+              ctx->eigen_device<CPUDevice>(), ctx, broadcast, out_shape, arg,
+              arg.shape(), bcast);
+          if (!ctx->status().ok()) return;
+        }
+        arg_data[i] = broadcast.flat<T>().data();
+        arg_period[i] = num_elements;
+      }
+    }
+
+    Tensor* out = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->forward_input_or_allocate_output(
+                            forwardable_args, 0, out_shape, &out));
+    if (num_elements == 0) return;
+    T* out_data = out->flat<T>().data();
+
+    const int num_instructions = instructions_.size();
+    auto compute_fn = [&](int64_t begin, int64_t end) {
+      // Scratch space for the broadcast arguments and the intermediate values
+      // of a block.
+      std::unique_ptr<T[]> scratch(
+          new T[(num_args + num_instructions) * kBlockSize]);
+      std::vector<const T*> values(num_args + num_instructions);
+
+      for (int64_t block = begin; block < end; block += kBlockSize) {
+        const int64_t len = std::min(kBlockSize, end - block);
+        for (int i = 0; i < num_args; ++i) {
+          if (arg_period[i] == num_elements) {
+            values[i] = arg_data[i] + block;
+            continue;
+          }
+          T* buffer = scratch.get() + i * kBlockSize;
+          const int64_t period = arg_period[i];
+          int64_t index = block % period;
+          for (int64_t j = 0; j < len; ++j) {
+            buffer[j] = arg_data[i][index];
+            if (++index == period) index = 0;
+          }
+          values[i] = buffer;
+        }
+
+        for (int k = 0; k < num_instructions; ++k) {
+          const Instruction& instruction = instructions_[k];
+          T* result = k == num_instructions - 1
+                          ? out_data + block
+                          : scratch.get() + (num_args + k) * kBlockSize;
+          Block<T> result_block(result, len);
+          ConstBlock<T> x(values[instruction.operands[0]], len);
+          if (instruction.fn.unary != nullptr) {
+            instruction.fn.unary(x, &result_block);
+          } else {
+            ConstBlock<T> y(values[instruction.operands[1]], len);
+            instruction.fn.binary(x, y, &result_block);
+          }
+          values[num_args + k] = result;
+        }
+      }
+    };
+
+    const CPUDevice& device = ctx->eigen_device<CPUDevice>();
+    const int kOverheadCycles = num_instructions * 10;
+    Eigen::TensorOpCost cost(/*bytes_loaded=*/sizeof(T) * num_args,
+                             /*bytes_stored=*/sizeof(T),
+                             kOverheadCycles + cost_);
+    device.parallelFor(num_elements, cost, AlignBlockSize,
+                       std::move(compute_fn));
+  }
+
+ private:
+  struct Instruction {
+    ComputeFn<T> fn;
+    // Indices of the operands: the arguments of the op come first, followed
+    // by the results of the previous instructions.
+    int operands[2] = {0, 0};
+  };
+
+  static inline int64_t AlignBlockSize(int64_t block_size) {
+    // Shard at multiples of kBlockSize, so that only the last block of the
+    // last shard is partial.
+    if (block_size >= kBlockSize) {
+      return (block_size + kBlockSize - 1) & ~(kBlockSize - 1);
+    }
+    return block_size;
+  }
+
+  std::vector<Instruction> instructions_;
+  int cost_ = 0;
+};
+
+#define REGISTER_CPU(T)                                                    \
+  REGISTER_KERNEL_BUILDER(                                                 \
+      Name("_FusedElementwise").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedElementwiseOp<T>);
+
+REGISTER_CPU(float);
+REGISTER_CPU(double);
+
+#undef REGISTER_CPU
+
+}  // namespace tensorflow
@@ -0,0 +1,205 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedElementwiseOpTest : public OpsTestBase {
+ protected:
+  Status MakeOp(DataType dtype, int num_args,
+                const std::vector<string>& fused_ops,
+                const std::vector<int>& fused_operands) {
+    TF_RETURN_IF_ERROR(NodeDefBuilder("fused_elementwise", "_FusedElementwise")
+                           .Input(FakeInput(num_args, dtype))
+                           .Attr("T", dtype)
+                           .Attr("num_args", num_args)
+                           .Attr("fused_ops", fused_ops)
+                           .Attr("fused_operands", fused_operands)
+                           .Finalize(node_def()));
+    return InitOp();
+  }
+};
+
+// tanh(x * y + z) * x
+TEST_F(FusedElementwiseOpTest, MulAddTanhMul) {
+  TF_ASSERT_OK(MakeOp(DT_FLOAT, 3, {"Mul", "AddV2", "Tanh", "Mul"},
+                      {0, 1, 3, 2, 4, 5, 0}));
+  AddInputFromArray<float>(TensorShape({4}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({4}), {0.1, 0.2, 0.3, 0.4});
+  AddInputFromArray<float>(TensorShape({4}), {-1, 0, 1, 2});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({4}));
+  test::FillValues<float>(
+      &expected, {1 * std::tanh(0.1f - 1), 2 * std::tanh(0.4f + 0),
+                  3 * std::tanh(0.9f + 1), 4 * std::tanh(1.6f + 2)});
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseOpTest, BroadcastTrailingDimsAndScalar) {
+  // relu(x - y) * 2, with y a row vector and 2 a scalar.
+  TF_ASSERT_OK(MakeOp(DT_DOUBLE, 3, {"Sub", "Relu", "Mul"}, {0, 1, 3, 4, 2}));
+  AddInputFromArray<double>(TensorShape({2, 3}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<double>(TensorShape({3}), {2, 2, 2});
+  AddInputFromArray<double>(TensorShape({}), {2});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_DOUBLE, TensorShape({2, 3}));
+  test::FillValues<double>(&expected, {0, 0, 2, 4, 6, 8});
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseOpTest, BroadcastLeadingDims) {
+  // (x + y)^2, with y a column vector that is broadcast across the rows.
+  TF_ASSERT_OK(MakeOp(DT_FLOAT, 2, {"Add", "Square"}, {0, 1, 2}));
+  AddInputFromArray<float>(TensorShape({1, 3}), {1, 2, 3});
+  AddInputFromArray<float>(TensorShape({2, 1}), {10, 20});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 3}));
+  test::FillValues<float>(&expected, {121, 144, 169, 441, 484, 529});
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseOpTest, SpansManyBlocks) {
+  TF_ASSERT_OK(MakeOp(DT_FLOAT, 2, {"Maximum", "Neg"}, {0, 1, 2}));
+  const int kSize = 5000;
+  std::vector<float> x(kSize), y(kSize), z(kSize);
+  for (int i = 0; i < kSize; ++i) {
+    x[i] = i;
+    y[i] = kSize - i;
+    z[i] = -std::max(x[i], y[i]);
+  }
+  AddInputFromArray<float>(TensorShape({kSize}), x);
+  AddInputFromArray<float>(TensorShape({kSize}), y);
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({kSize}));
+  test::FillValues<float>(&expected, z);
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseOpTest, IncompatibleShapes) {
+  TF_ASSERT_OK(MakeOp(DT_FLOAT, 2, {"Mul"}, {0, 1}));
+  AddInputFromArray<float>(TensorShape({2}), {1, 2});
+  AddInputFromArray<float>(TensorShape({3}), {1, 2, 3});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(absl::StrContains(s.message(), "Incompatible shapes")) << s;
+}
+
+TEST_F(FusedElementwiseOpTest, InvalidAttrs) {
+  Status s = MakeOp(DT_FLOAT, 1, {"Sin"}, {0});
+  EXPECT_TRUE(absl::StrContains(s.message(), "Sin")) << s;
+
+  s = MakeOp(DT_FLOAT, 1, {"Mul"}, {0});
+  EXPECT_TRUE(absl::StrContains(s.message(), "Missing operands")) << s;
+
+  s = MakeOp(DT_FLOAT, 1, {"Neg"}, {1});
+  EXPECT_TRUE(absl::StrContains(s.message(), "out of range")) << s;
+
+  s = MakeOp(DT_FLOAT, 1, {"Neg"}, {0, 0});
+  EXPECT_TRUE(absl::StrContains(s.message(), "Expected 1 fused operands"))
+      << s;
+}
+
+// Returns the graph of `repeat_graph` independent copies of
+//   tanh(x * y + z) * x
+// either as separate cwise nodes or as one _FusedElementwise node each.
+static Graph* MulAddTanhMul(int tensor_size, int repeat_graph, bool fused) {
+  Graph* g = new Graph(OpRegistry::Global());
+
+  Tensor t(DT_FLOAT, TensorShape({tensor_size}));
+  t.flat<float>() = t.flat<float>().setRandom();
+
+  for (int i = 0; i < repeat_graph; ++i) {
+    Node* x = test::graph::Constant(g, t);
+    Node* y = test::graph::Constant(g, t);
+    Node* z = test::graph::Constant(g, t);
+    if (fused) {
+      const std::vector<string> fused_ops = {"Mul", "AddV2", "Tanh", "Mul"};
+      const std::vector<int> fused_operands = {0, 1, 3, 2, 4, 5, 0};
+      TF_CHECK_OK(NodeBuilder(g->NewName("n"), "_FusedElementwise")
+                      .Input({x, y, z})
+                      .Attr("T", DT_FLOAT)
+                      .Attr("num_args", 3)
+                      .Attr("fused_ops", fused_ops)
+                      .Attr("fused_operands", fused_operands)
+                      .Finalize(g, nullptr));
+      continue;
+    }
+    Node* node;
+    TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Mul")
+                    .Input(x)
+                    .Input(y)
+                    .Attr("T", DT_FLOAT)
+                    .Finalize(g, &node));
+    TF_CHECK_OK(NodeBuilder(g->NewName("n"), "AddV2")
+                    .Input(node)
+                    .Input(z)
+                    .Attr("T", DT_FLOAT)
+                    .Finalize(g, &node));
+    TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Tanh")
+                    .Input(node)
+                    .Attr("T", DT_FLOAT)
+                    .Finalize(g, &node));
+    TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Mul")
+                    .Input(node)
+                    .Input(x)
+                    .Attr("T", DT_FLOAT)
+                    .Finalize(g, &node));
+  }
+
+  return g;
+}
+
+#define BM_MulAddTanhMul(N, R, FUSED, type)                                   \
+  static void BM_MulAddTanhMul##_##type##_##N##_##R##_##FUSED(                \
+      ::testing::benchmark::State& state) {                                   \
+    test::Benchmark(#type, MulAddTanhMul(N, R, FUSED),                        \
+                    /*old_benchmark_api*/ false)                              \
+        .Run(state);                                                          \
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * N * R); \
+  }                                                                           \
+  BENCHMARK(BM_MulAddTanhMul##_##type##_##N##_##R##_##FUSED);
+
+// BenchmarkName(tensor_size, repeat_graph, fused, type)
+
+BM_MulAddTanhMul(1000, 25, false, cpu);
+BM_MulAddTanhMul(1000, 25, true, cpu);
+
+BM_MulAddTanhMul(100000, 25, false, cpu);
+BM_MulAddTanhMul(100000, 25, true, cpu);
+
+BM_MulAddTanhMul(1000000, 25, false, cpu);
+BM_MulAddTanhMul(1000000, 25, true, cpu);
+
+}  // namespace
+}  // namespace tensorflow
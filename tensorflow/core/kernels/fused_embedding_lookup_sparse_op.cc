@@ -0,0 +1,262 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/math_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include "tensorflow/core/kernels/fused_embedding_lookup_sparse_op.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/base/prefetch.h"
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "tensorflow/core/framework/bounds_check.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/op_requires.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+using CPUDevice = Eigen::ThreadPoolDevice;
+using GPUDevice = Eigen::GpuDevice;
+
+namespace functor {
+
+template <typename T, typename Index, typename SegmentId>
+struct FusedEmbeddingLookupSparseFunctor<CPUDevice, T, Index, SegmentId> {
+  // How many ids ahead of the current one the rows of params are prefetched.
+  static constexpr int64_t kPrefetchDistance = 4;
+  // Prefetching the start of a row lets the hardware prefetcher stream the
+  // rest of it.
+  static constexpr int64_t kPrefetchBytes = 256;
+
+  Status operator()(OpKernelContext* context,
+                    typename TTypes<T, 2>::ConstTensor params,
+                    typename TTypes<Index>::ConstVec ids,
+                    typename TTypes<SegmentId>::ConstVec segment_ids,
+                    const float* weights, EmbeddingCombiner combiner,
+                    float max_norm, typename TTypes<T, 2>::Tensor output) {
+    const int64_t num_rows = params.dimension(0);
+    const int64_t dim = params.dimension(1);
+    const int64_t num_segments = output.dimension(0);
+    const int64_t num_ids = ids.size();
+    SegmentId previous_segment = 0;
+    for (int64_t j = 0; j < num_ids; ++j) {
+      const Index id = ids(j);
+      if (id < 0 || id >= num_rows) {
+        return errors::InvalidArgument("ids[", j, "] = ", id,
+                                       " is not in [0, ", num_rows, ")");
+      }
+      const SegmentId segment = segment_ids(j);
+      if (segment < previous_segment || segment >= num_segments) {
+        return errors::InvalidArgument(
+            "segment_ids must be sorted and in [0, ", num_segments,
+            "), got segment_ids[", j, "] = ", segment);
+      }
+      previous_segment = segment;
+    }
+
+    const T* params_data = params.data();
+    const SegmentId* segment_ids_data = segment_ids.data();
+    auto work = [&](int64_t begin, int64_t end) {
+      std::vector<float> sum(dim);
+      int64_t j = std::lower_bound(segment_ids_data,
+                                   segment_ids_data + num_ids, begin) -
+                  segment_ids_data;
+      for (int64_t s = begin; s < end; ++s) {
+        std::fill(sum.begin(), sum.end(), 0.0f);
+        float weight_sum = 0.0f;
+        for (; j < num_ids && segment_ids_data[j] == s; ++j) {
+          if (j + kPrefetchDistance < num_ids) {
+            const char* next = reinterpret_cast<const char*>(
+                params_data + ids(j + kPrefetchDistance) * dim);
+            for (int64_t b = 0; b < std::min<int64_t>(dim * sizeof(T),
+                                                      kPrefetchBytes);
+                 b += ABSL_CACHELINE_SIZE) {
+              absl::PrefetchToLocalCache(next + b);
+            }
+          }
+          const Index id = internal::SubtleMustCopy(ids(j));
+          if (!FastBoundsCheck(id, num_rows)) continue;
+          const T* row = params_data + id * dim;
+          const float weight = weights == nullptr ? 1.0f : weights[j];
+          weight_sum +=
+              combiner == EmbeddingCombiner::kSqrtN ? weight * weight : weight;
+          float scale = weight;
+          if (max_norm > 0) {
+            float squared_norm = 0.0f;
+            for (int64_t d = 0; d < dim; ++d) {
+              const float x = static_cast<float>(row[d]);
+              squared_norm += x * x;
+            }
+            const float norm = std::sqrt(squared_norm);
+            if (norm > max_norm) scale *= max_norm / norm;
+          }
+          for (int64_t d = 0; d < dim; ++d) {
+            sum[d] += scale * static_cast<float>(row[d]);
+          }
+        }
+        float divisor = 1.0f;
+        if (combiner == EmbeddingCombiner::kMean) {
+          divisor = weight_sum;
+        } else if (combiner == EmbeddingCombiner::kSqrtN) {
+          divisor = std::sqrt(weight_sum);
+        }
+        T* out = &output(s, 0);
+        for (int64_t d = 0; d < dim; ++d) {
+          out[d] = static_cast<T>(divisor == 0.0f ? 0.0f : sum[d] / divisor);
+        }
+      }
+    };
+    const int64_t cost_per_segment =
+        (num_ids / std::max<int64_t>(num_segments, 1) + 1) * dim *
+        (max_norm > 0 ? 4 : 2);
+    auto* worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_segments,
+          cost_per_segment, work);
+    return absl::OkStatus();
+  }
+};
+
+}  // namespace functor
+
+// Gathers rows of `params` by `ids`, scales them by `weights`, and combines
+// the rows of each segment, in one pass over the ids instead of Unique,
+// Gather, Mul and SegmentSum.
+template <typename Device, typename T, typename Index, typename SegmentId>
+class FusedEmbeddingLookupSparseOp : public OpKernel {
+ public:
+  explicit FusedEmbeddingLookupSparseOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    std::string combiner;
+    OP_REQUIRES_OK(context, context->GetAttr("combiner", &combiner));
+    if (combiner == "sum") {
+      combiner_ = functor::EmbeddingCombiner::kSum;
+    } else if (combiner == "mean") {
+      combiner_ = functor::EmbeddingCombiner::kMean;
+    } else {
+      combiner_ = functor::EmbeddingCombiner::kSqrtN;
+    }
+    OP_REQUIRES_OK(context, context->GetAttr("max_norm", &max_norm_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& params = context->input(0);
+    const Tensor& ids = context->input(1);
+    const Tensor& segment_ids = context->input(2);
+    const Tensor& num_segments = context->input(3);
+    const Tensor& weights = context->input(4);
+    OP_REQUIRES(context, TensorShapeUtils::IsVectorOrHigher(params.shape()),
+                errors::InvalidArgument("params must be at least 1-D, got ",
+                                        params.shape().DebugString()));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(ids.shape()),
+                errors::InvalidArgument("ids must be a vector, got ",
+                                        ids.shape().DebugString()));
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(segment_ids.shape()) &&
+                    segment_ids.NumElements() == ids.NumElements(),
+                errors::InvalidArgument(
+                    "segment_ids must be a vector of the same size as ids, "
+                    "got ",
+                    segment_ids.shape().DebugString(), " and ",
+                    ids.shape().DebugString()));
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(num_segments.shape()),
+                errors::InvalidArgument("num_segments must be a scalar, got ",
+                                        num_segments.shape().DebugString()));
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(weights.shape()) &&
+                    (weights.NumElements() == 0 ||
+                     weights.NumElements() == ids.NumElements()),
+                errors::InvalidArgument(
+                    "weights must be empty or a vector of the same size as "
+                    "ids, got ",
+                    weights.shape().DebugString(), " and ",
+                    ids.shape().DebugString()));
+    const int64_t output_rows =
+        num_segments.dtype() == DT_INT32
+            ? internal::SubtleMustCopy(num_segments.scalar<int32>()())
+            : internal::SubtleMustCopy(num_segments.scalar<int64_t>()());
+    OP_REQUIRES(context, output_rows >= 0,
+                errors::InvalidArgument("num_segments must be non-negative, "
+                                        "got ",
+                                        output_rows));
+
+    TensorShape output_shape = params.shape();
+    OP_REQUIRES_OK(context, output_shape.SetDimWithStatus(0, output_rows));
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, output_shape, &output));
+    if (output->NumElements() == 0) return;
+
+    OP_REQUIRES_OK(
+        context,
+        (functor::FusedEmbeddingLookupSparseFunctor<Device, T, Index,
+                                                    SegmentId>()(
+            context, params.flat_outer_dims<T>(), ids.vec<Index>(),
+            segment_ids.vec<SegmentId>(),
+            weights.NumElements() == 0 ? nullptr : weights.vec<float>().data(),
+            combiner_, max_norm_, output->flat_outer_dims<T>())));
+  }
+
+ private:
+  functor::EmbeddingCombiner combiner_;
+  float max_norm_;
+};
+
+#define REGISTER_KERNEL(device, type, index_type, segment_ids_type)      \
+  REGISTER_KERNEL_BUILDER(                                               \
+      Name("FusedEmbeddingLookupSparse")                                 \
+          .Device(DEVICE_##device)                                       \
+          .HostMemory("num_segments")                                    \
+          .TypeConstraint<type>("T")                                     \
+          .TypeConstraint<index_type>("Tidx")                            \
+          .TypeConstraint<segment_ids_type>("Tsegmentids"),              \
+      FusedEmbeddingLookupSparseOp<device##Device, type, index_type,     \
+                                   segment_ids_type>)
+#define REGISTER_KERNELS_FOR_INDEX_TYPES(device, type) \
+  REGISTER_KERNEL(device, type, int32, int32);         \
+  REGISTER_KERNEL(device, type, int32, int64_t);       \
+  REGISTER_KERNEL(device, type, int64_t, int32);       \
+  REGISTER_KERNEL(device, type, int64_t, int64_t);
+#define REGISTER_CPU_KERNELS(type) REGISTER_KERNELS_FOR_INDEX_TYPES(CPU, type)
+
+REGISTER_CPU_KERNELS(bfloat16);
+REGISTER_CPU_KERNELS(Eigen::half);
+REGISTER_CPU_KERNELS(float);
+#undef REGISTER_CPU_KERNELS
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#define REGISTER_GPU_KERNELS(type) REGISTER_KERNELS_FOR_INDEX_TYPES(GPU, type)
+
+REGISTER_GPU_KERNELS(bfloat16);
+REGISTER_GPU_KERNELS(Eigen::half);
+REGISTER_GPU_KERNELS(float);
+#undef REGISTER_GPU_KERNELS
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#undef REGISTER_KERNELS_FOR_INDEX_TYPES
+#undef REGISTER_KERNEL
+
+}  // namespace tensorflow
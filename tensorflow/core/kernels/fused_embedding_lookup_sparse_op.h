@@ -0,0 +1,58 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_FUSED_EMBEDDING_LOOKUP_SPARSE_OP_H_
+#define TENSORFLOW_CORE_KERNELS_FUSED_EMBEDDING_LOOKUP_SPARSE_OP_H_
+
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/framework/types.h"
+
+namespace tensorflow {
+namespace functor {
+
+// How the weighted embeddings of a segment are combined into its output row:
+// their sum, or the sum divided by the sum of the weights (kMean) or by the
+// square root of the sum of the squared weights (kSqrtN). Segments whose
+// divisor is zero are zero.
+enum class EmbeddingCombiner { kSum, kMean, kSqrtN };
+
+// Computes, for every segment s,
+//
+//   output[s, :] = combine(weights[j] * clip(params[ids[j], :]))
+//
+// over the j with segment_ids[j] == s, without materializing the gathered
+// rows. `segment_ids` must be sorted. `weights` is null if all weights are
+// 1. If `max_norm` is positive, clip() scales every row with an l2-norm above
+// `max_norm` down to that norm; otherwise it is the identity.
+//
+// The CPU version returns InvalidArgument for ids or segment ids out of range
+// and for unsorted segment ids. Like Gather, the GPU version treats ids out of
+// range as rows of zeros instead.
+template <typename Device, typename T, typename Index, typename SegmentId>
+struct FusedEmbeddingLookupSparseFunctor {
+  Status operator()(OpKernelContext* context,
+                    typename TTypes<T, 2>::ConstTensor params,
+                    typename TTypes<Index>::ConstVec ids,
+                    typename TTypes<SegmentId>::ConstVec segment_ids,
+                    const float* weights, EmbeddingCombiner combiner,
+                    float max_norm, typename TTypes<T, 2>::Tensor output);
+};
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_FUSED_EMBEDDING_LOOKUP_SPARSE_OP_H_
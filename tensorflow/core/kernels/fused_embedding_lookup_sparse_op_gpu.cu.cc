@@ -0,0 +1,161 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#define EIGEN_USE_GPU
+
+#include <algorithm>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/fused_embedding_lookup_sparse_op.h"
+#include "tensorflow/core/util/gpu_kernel_helper.h"
+
+namespace tensorflow {
+
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace {
+
+constexpr int kWarpSize = 32;
+// Each lane accumulates up to this many columns of its segment in registers,
+// so that a warp covers rows of up to 32 * kColumnsPerLane columns in one pass.
+constexpr int kColumnsPerLane = 4;
+
+__device__ float WarpSum(float value) {
+  for (int offset = kWarpSize / 2; offset > 0; offset /= 2) {
+    value += GpuShuffleXorSync(kGpuWarpAll, value, offset);
+  }
+  return value;
+}
+
+// One warp per segment: the lanes of a warp split the columns of the rows of
+// the segment, so that every row is read with coalesced loads, and the
+// segment is combined in registers without atomics.
+template <typename T, typename Index, typename SegmentId>
+__global__ void FusedEmbeddingLookupSparseKernel(
+    const T* __restrict__ params, int64 num_rows, int64 dim,
+    const Index* __restrict__ ids, const SegmentId* __restrict__ segment_ids,
+    int64 num_ids, const float* __restrict__ weights,
+    functor::EmbeddingCombiner combiner, float max_norm, int64 num_segments,
+    T* __restrict__ output) {
+  const int lane = threadIdx.x % kWarpSize;
+  const int64 num_warps =
+      static_cast<int64>(gridDim.x) * blockDim.x / kWarpSize;
+  for (int64 s = (static_cast<int64>(blockIdx.x) * blockDim.x + threadIdx.x) /
+                 kWarpSize;
+       s < num_segments; s += num_warps) {
+    const int64 begin = gpu_helper::lower_bound<SegmentId, int64>(
+        segment_ids, num_ids, static_cast<SegmentId>(s));
+    const int64 end = begin + gpu_helper::lower_bound<SegmentId, int64>(
+                                  segment_ids + begin, num_ids - begin,
+                                  static_cast<SegmentId>(s + 1));
+    for (int64 d0 = 0; d0 < dim; d0 += kWarpSize * kColumnsPerLane) {
+      float sum[kColumnsPerLane] = {};
+      float weight_sum = 0.0f;
+      for (int64 j = begin; j < end; ++j) {
+        const Index id = ids[j];
+        const float weight = weights == nullptr ? 1.0f : weights[j];
+        weight_sum += combiner == functor::EmbeddingCombiner::kSqrtN
+                          ? weight * weight
+                          : weight;
+        if (id < 0 || id >= num_rows) continue;
+        const T* row = params + id * dim;
+        float scale = weight;
+        if (max_norm > 0) {
+          float squared_norm = 0.0f;
+          for (int64 d = lane; d < dim; d += kWarpSize) {
+            const float x = static_cast<float>(row[d]);
+            squared_norm += x * x;
+          }
+          const float norm = sqrtf(WarpSum(squared_norm));
+          if (norm > max_norm) scale *= max_norm / norm;
+        }
+#pragma unroll
+        for (int k = 0; k < kColumnsPerLane; ++k) {
+          const int64 d = d0 + k * kWarpSize + lane;
+          if (d < dim) sum[k] += scale * static_cast<float>(row[d]);
+        }
+      }
+      float divisor = 1.0f;
+      if (combiner == functor::EmbeddingCombiner::kMean) {
+        divisor = weight_sum;
+      } else if (combiner == functor::EmbeddingCombiner::kSqrtN) {
+        divisor = sqrtf(weight_sum);
+      }
+#pragma unroll
+      for (int k = 0; k < kColumnsPerLane; ++k) {
+        const int64 d = d0 + k * kWarpSize + lane;
+        if (d < dim) {
+          output[s * dim + d] =
+              static_cast<T>(divisor == 0.0f ? 0.0f : sum[k] / divisor);
+        }
+      }
+    }
+  }
+}
+
+}  // namespace
+
+namespace functor {
+
+template <typename T, typename Index, typename SegmentId>
+struct FusedEmbeddingLookupSparseFunctor<GPUDevice, T, Index, SegmentId> {
+  Status operator()(OpKernelContext* context,
+                    typename TTypes<T, 2>::ConstTensor params,
+                    typename TTypes<Index>::ConstVec ids,
+                    typename TTypes<SegmentId>::ConstVec segment_ids,
+                    const float* weights, EmbeddingCombiner combiner,
+                    float max_norm, typename TTypes<T, 2>::Tensor output) {
+    const GPUDevice& d = context->eigen_gpu_device();
+    const int64 num_segments = output.dimension(0);
+    // Whole warps per block, so that no warp spans two segments.
+    constexpr int kThreadsPerBlock = 256;
+    const int64 max_blocks = d.getNumGpuMultiProcessors() *
+                             (d.maxGpuThreadsPerMultiProcessor() /
+                              kThreadsPerBlock);
+    const int64 num_blocks = std::min(
+        max_blocks, Eigen::divup<int64>(num_segments * kWarpSize,
+                                        kThreadsPerBlock));
+    return GpuLaunchKernel(
+        FusedEmbeddingLookupSparseKernel<T, Index, SegmentId>,
+        num_blocks, kThreadsPerBlock, 0, d.stream(),
+        params.data(), params.dimension(0), params.dimension(1), ids.data(),
+        segment_ids.data(), static_cast<int64>(ids.size()), weights, combiner,
+        max_norm, num_segments, output.data());
+  }
+};
+
+#define DEFINE_GPU_SPECS(T)                                              \
+  template struct FusedEmbeddingLookupSparseFunctor<GPUDevice, T, int32, \
+                                                    int32>;              \
+  template struct FusedEmbeddingLookupSparseFunctor<GPUDevice, T, int32, \
+                                                    int64>;              \
+  template struct FusedEmbeddingLookupSparseFunctor<GPUDevice, T, int64, \
+                                                    int32>;              \
+  template struct FusedEmbeddingLookupSparseFunctor<GPUDevice, T, int64, \
+                                                    int64>;
+
+DEFINE_GPU_SPECS(bfloat16);
+DEFINE_GPU_SPECS(Eigen::half);
+DEFINE_GPU_SPECS(float);
+
+#undef DEFINE_GPU_SPECS
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
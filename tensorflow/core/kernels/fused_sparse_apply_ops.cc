@@ -0,0 +1,415 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/training_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/bounds_check.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/type_index.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/tiered_embedding_var.h"
+#include "tensorflow/core/kernels/training_op_helpers.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+namespace {
+
+// The distinct indices of a sparse gradient, in increasing order, and the
+// gradient rows that belong to each of them.
+struct DedupedIndices {
+  std::vector<int64_t> ids;
+  // The gradient rows of ids[i] are positions[starts[i]:starts[i + 1]].
+  std::vector<int64_t> starts;
+  std::vector<int64_t> positions;
+};
+
+template <typename Index>
+Status DedupeIndices(const Tensor& indices, int64_t num_rows,
+                     DedupedIndices* deduped) {
+  const auto indices_flat = indices.flat<Index>();
+  const int64_t n = indices_flat.size();
+  std::vector<std::pair<int64_t, int64_t>> sorted(n);
+  for (int64_t i = 0; i < n; ++i) {
+    const Index id = internal::SubtleMustCopy(indices_flat(i));
+    if (!FastBoundsCheck(id, num_rows)) {
+      return errors::InvalidArgument("indices[", i, "] = ", id,
+                                     " is not in [0, ", num_rows, ")");
+    }
+    sorted[i] = {id, i};
+  }
+  // Ties are broken by position, so that the gradients of a row are always
+  // summed in the same order.
+  std::sort(sorted.begin(), sorted.end());
+  deduped->ids.clear();
+  deduped->starts.clear();
+  deduped->positions.resize(n);
+  for (int64_t i = 0; i < n; ++i) {
+    if (i == 0 || sorted[i].first != sorted[i - 1].first) {
+      deduped->ids.push_back(sorted[i].first);
+      deduped->starts.push_back(i);
+    }
+    deduped->positions[i] = sorted[i].second;
+  }
+  deduped->starts.push_back(n);
+  return absl::OkStatus();
+}
+
+// The variable and optimizer slots that a fused kernel updates: either all
+// resource variables, or all tiered embedding variables. The inputs stay
+// locked for the lifetime of this object.
+template <typename T>
+class FusedSparseApplyInputs {
+ public:
+  // Locks and looks up the resources of `inputs`, which must all have the
+  // same shape, of at least one dimension.
+  Status Acquire(OpKernelContext* ctx, const std::vector<int>& inputs,
+                 bool use_exclusive_lock) TF_NO_THREAD_SAFETY_ANALYSIS {
+    inputs_ = inputs;
+    if (HandleFromInput(ctx, inputs[0]).hash_code() ==
+        TypeIndex::Make<TieredEmbeddingVar>().hash_code()) {
+      TF_RETURN_IF_ERROR(AcquireTiered(ctx));
+    } else {
+      variable_locks_.emplace(MaybeLockVariableInputMutexesInOrder<
+                              CPUDevice, T>(ctx, use_exclusive_lock,
+                                            /*sparse=*/true, inputs));
+      for (int input : inputs) {
+        Tensor tensor;
+        TF_RETURN_IF_ERROR(GetInputTensorFromVariable<CPUDevice, T>(
+            ctx, input, use_exclusive_lock, /*sparse=*/true, &tensor));
+        if (!tensor.IsInitialized()) {
+          return errors::FailedPrecondition(
+              "Attempting to use uninitialized variables: ",
+              ctx->op_kernel().requested_input(input));
+        }
+        tensors_.push_back(std::move(tensor));
+      }
+      shape_ = tensors_[0].shape();
+    }
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      const TensorShape& shape =
+          tiered_.empty() ? tensors_[i].shape() : tiered_[i]->shape();
+      if (shape != shape_) {
+        return errors::InvalidArgument(
+            ctx->op_kernel().requested_input(inputs[0]), " and ",
+            ctx->op_kernel().requested_input(inputs[i]),
+            " do not have the same shape: ", shape_.DebugString(), " vs. ",
+            shape.DebugString());
+      }
+    }
+    if (!TensorShapeUtils::IsVectorOrHigher(shape_)) {
+      return errors::InvalidArgument("var must be at least 1 dimensional");
+    }
+    return absl::OkStatus();
+  }
+
+  // The shape of every input.
+  const TensorShape& shape() const { return shape_; }
+
+  // Returns, for every input, a pointer to each of the rows of `ids`, which
+  // must be distinct. The rows of tiered embedding variables are brought
+  // into their host cache and marked as modified.
+  Status GetRows(OpKernelContext* ctx, absl::Span<const int64_t> ids,
+                 std::vector<std::vector<T*>>* rows)
+      TF_NO_THREAD_SAFETY_ANALYSIS {
+    const int64_t row_size = shape_.num_elements() / shape_.dim_size(0);
+    rows->assign(inputs_.size(), std::vector<T*>(ids.size()));
+    for (size_t i = 0; i < inputs_.size(); ++i) {
+      std::vector<T*>& input_rows = (*rows)[i];
+      if (tiered_.empty()) {
+        T* base = tensors_[i].flat<T>().data();
+        for (size_t j = 0; j < ids.size(); ++j) {
+          input_rows[j] = base + ids[j] * row_size;
+        }
+        continue;
+      }
+      TieredEmbeddingVar* var = tiered_[i].get();
+      LfuRowCache::Plan plan;
+      Tensor* cache = nullptr;
+      TF_RETURN_IF_ERROR(var->AdmitOnHost(ctx, ids, &plan, &cache));
+      T* base = cache->flat<T>().data();
+      for (size_t j = 0; j < ids.size(); ++j) {
+        input_rows[j] = base + plan.slots[j] * row_size;
+        var->cache_index()->MarkDirty(plan.slots[j]);
+      }
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  Status AcquireTiered(OpKernelContext* ctx) TF_NO_THREAD_SAFETY_ANALYSIS {
+    for (int input : inputs_) {
+      core::RefCountPtr<TieredEmbeddingVar> var;
+      TF_RETURN_IF_ERROR(
+          LookupResource(ctx, HandleFromInput(ctx, input), &var));
+      tiered_.push_back(std::move(var));
+    }
+    // Serving a batch can change which rows are cached, so the variables are
+    // locked exclusively, in address order, and only once each.
+    std::vector<mutex*> mutexes;
+    for (const auto& var : tiered_) mutexes.push_back(var->mu());
+    std::sort(mutexes.begin(), mutexes.end());
+    mutexes.erase(std::unique(mutexes.begin(), mutexes.end()),
+                  mutexes.end());
+    tiered_locks_.reserve(mutexes.size());
+    for (mutex* mu : mutexes) tiered_locks_.emplace_back(*mu);
+
+    for (size_t i = 0; i < inputs_.size(); ++i) {
+      TieredEmbeddingVar* var = tiered_[i].get();
+      if (!var->is_initialized()) {
+        return errors::FailedPrecondition(
+            "Attempting to use an uninitialized tiered embedding variable: ",
+            ctx->op_kernel().requested_input(inputs_[i]));
+      }
+      if (var->dtype() != DataTypeToEnum<T>::v()) {
+        return errors::InvalidArgument(
+            "Trying to update a tiered embedding variable of type ",
+            DataTypeString(var->dtype()), " as ",
+            DataTypeString(DataTypeToEnum<T>::v()));
+      }
+    }
+    shape_ = tiered_[0]->shape();
+    return absl::OkStatus();
+  }
+
+  std::vector<int> inputs_;
+  TensorShape shape_;
+  std::optional<VariableInputLockHolder> variable_locks_;
+  std::vector<Tensor> tensors_;
+  std::vector<core::RefCountPtr<TieredEmbeddingVar>> tiered_;
+  std::vector<mutex_lock> tiered_locks_;
+};
+
+// Checks the gradient against the variable shape, deduplicates its indices,
+// and returns the rows to update in `rows`.
+template <typename T, typename Index>
+Status PrepareFusedSparseApply(OpKernelContext* ctx,
+                               FusedSparseApplyInputs<T>* inputs,
+                               const Tensor& grad, const Tensor& indices,
+                               DedupedIndices* deduped,
+                               std::vector<std::vector<T*>>* rows) {
+  if (!TensorShapeUtils::IsVector(indices.shape())) {
+    return errors::InvalidArgument("indices must be one-dimensional");
+  }
+  const TensorShape& shape = inputs->shape();
+  TensorShape expected_grad_shape = indices.shape();
+  for (int d = 1; d < shape.dims(); ++d) {
+    TF_RETURN_IF_ERROR(expected_grad_shape.AddDimWithStatus(shape.dim_size(d)));
+  }
+  if (grad.shape() != expected_grad_shape) {
+    return errors::InvalidArgument(
+        "grad must have shape indices.shape + var.shape[1:] = ",
+        expected_grad_shape.DebugString(), ", got ",
+        grad.shape().DebugString());
+  }
+  TF_RETURN_IF_ERROR(
+      DedupeIndices<Index>(indices, shape.dim_size(0), deduped));
+  return inputs->GetRows(ctx, deduped->ids, rows);
+}
+
+// Calls `update(i, g)` for every distinct index i, in parallel over ranges of
+// distinct indices, where g is the sum of the gradient rows of that index.
+// Each call updates one row of the variable and of all of its slots, which
+// no other call touches.
+template <typename T, typename Update>
+void ForEachDedupedRow(OpKernelContext* ctx, const DedupedIndices& deduped,
+                       const Tensor& grad, int64_t row_size, int num_inputs,
+                       int cycles_per_element, const Update& update) {
+  const int64_t num_ids = deduped.ids.size();
+  if (num_ids == 0 || row_size == 0) return;
+  const T* grad_base = grad.flat<T>().data();
+  const int64_t row_bytes = row_size * sizeof(T);
+  const Eigen::TensorOpCost cost(row_bytes * (num_inputs + 1),
+                                 row_bytes * num_inputs,
+                                 row_size * cycles_per_element);
+  const auto shard = [&](int64_t begin, int64_t end) {
+    std::vector<T> sum(row_size);
+    for (int64_t i = begin; i < end; ++i) {
+      const int64_t start = deduped.starts[i];
+      const int64_t limit = deduped.starts[i + 1];
+      const T* g = grad_base + deduped.positions[start] * row_size;
+      if (limit - start > 1) {
+        std::copy(g, g + row_size, sum.begin());
+        for (int64_t k = start + 1; k < limit; ++k) {
+          const T* other = grad_base + deduped.positions[k] * row_size;
+          for (int64_t j = 0; j < row_size; ++j) sum[j] += other[j];
+        }
+        g = sum.data();
+      }
+      update(i, g);
+    }
+  };
+  ctx->eigen_device<CPUDevice>().parallelFor(num_ids, cost, shard);
+}
+
+Status CheckScalar(const Tensor& tensor, const char* name) {
+  if (!TensorShapeUtils::IsScalar(tensor.shape())) {
+    return errors::InvalidArgument(name, " is not a scalar: ",
+                                   tensor.shape().DebugString());
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+template <typename T, typename Index>
+class FusedSparseApplyAdagradOp : public OpKernel {
+ public:
+  explicit FusedSparseApplyAdagradOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("update_slots", &update_slots_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& lr = ctx->input(2);
+    const Tensor& epsilon = ctx->input(3);
+    const Tensor& grad = ctx->input(4);
+    const Tensor& indices = ctx->input(5);
+    OP_REQUIRES_OK(ctx, CheckScalar(lr, "lr"));
+    OP_REQUIRES_OK(ctx, CheckScalar(epsilon, "epsilon"));
+
+    FusedSparseApplyInputs<T> inputs;
+    OP_REQUIRES_OK(ctx, inputs.Acquire(ctx, {0, 1}, use_exclusive_lock_));
+    DedupedIndices deduped;
+    std::vector<std::vector<T*>> rows;
+    OP_REQUIRES_OK(ctx, (PrepareFusedSparseApply<T, Index>(
+                            ctx, &inputs, grad, indices, &deduped, &rows)));
+
+    const T lr_scalar = lr.scalar<T>()();
+    const T epsilon_scalar = epsilon.scalar<T>()();
+    const int64_t row_size =
+        inputs.shape().num_elements() / inputs.shape().dim_size(0);
+    const bool update_slots = update_slots_;
+    ForEachDedupedRow<T>(
+        ctx, deduped, grad, row_size, /*num_inputs=*/2,
+        Eigen::TensorOpCost::AddCost<T>() * 3 +
+            Eigen::TensorOpCost::MulCost<T>() * 2 +
+            Eigen::TensorOpCost::DivCost<T>(),
+        [&](int64_t i, const T* g) {
+          T* var = rows[0][i];
+          T* accum = rows[1][i];
+          for (int64_t j = 0; j < row_size; ++j) {
+            if (update_slots) accum[j] += g[j] * g[j];
+            var[j] -= lr_scalar * g[j] /
+                      (Eigen::numext::sqrt(accum[j]) + epsilon_scalar);
+          }
+        });
+  }
+
+ private:
+  bool use_exclusive_lock_;
+  bool update_slots_;
+};
+
+template <typename T, typename Index>
+class FusedSparseApplyAdamOp : public OpKernel {
+ public:
+  explicit FusedSparseApplyAdamOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& beta1_power = ctx->input(3);
+    const Tensor& beta2_power = ctx->input(4);
+    const Tensor& lr = ctx->input(5);
+    const Tensor& beta1 = ctx->input(6);
+    const Tensor& beta2 = ctx->input(7);
+    const Tensor& epsilon = ctx->input(8);
+    const Tensor& grad = ctx->input(9);
+    const Tensor& indices = ctx->input(10);
+    OP_REQUIRES_OK(ctx, CheckScalar(beta1_power, "beta1_power"));
+    OP_REQUIRES_OK(ctx, CheckScalar(beta2_power, "beta2_power"));
+    OP_REQUIRES_OK(ctx, CheckScalar(lr, "lr"));
+    OP_REQUIRES_OK(ctx, CheckScalar(beta1, "beta1"));
+    OP_REQUIRES_OK(ctx, CheckScalar(beta2, "beta2"));
+    OP_REQUIRES_OK(ctx, CheckScalar(epsilon, "epsilon"));
+
+    FusedSparseApplyInputs<T> inputs;
+    OP_REQUIRES_OK(ctx, inputs.Acquire(ctx, {0, 1, 2}, use_exclusive_lock_));
+    DedupedIndices deduped;
+    std::vector<std::vector<T*>> rows;
+    OP_REQUIRES_OK(ctx, (PrepareFusedSparseApply<T, Index>(
+                            ctx, &inputs, grad, indices, &deduped, &rows)));
+
+    const T one(1);
+    const T alpha =
+        lr.scalar<T>()() *
+        Eigen::numext::sqrt(one - beta2_power.scalar<T>()()) /
+        (one - beta1_power.scalar<T>()());
+    const T one_minus_beta1 = one - beta1.scalar<T>()();
+    const T one_minus_beta2 = one - beta2.scalar<T>()();
+    const T epsilon_scalar = epsilon.scalar<T>()();
+    const int64_t row_size =
+        inputs.shape().num_elements() / inputs.shape().dim_size(0);
+    ForEachDedupedRow<T>(
+        ctx, deduped, grad, row_size, /*num_inputs=*/3,
+        Eigen::TensorOpCost::AddCost<T>() * 5 +
+            Eigen::TensorOpCost::MulCost<T>() * 4 +
+            Eigen::TensorOpCost::DivCost<T>(),
+        [&](int64_t i, const T* g) {
+          T* var = rows[0][i];
+          T* m = rows[1][i];
+          T* v = rows[2][i];
+          for (int64_t j = 0; j < row_size; ++j) {
+            m[j] += (g[j] - m[j]) * one_minus_beta1;
+            v[j] += (g[j] * g[j] - v[j]) * one_minus_beta2;
+            var[j] -= alpha * m[j] / (Eigen::numext::sqrt(v[j]) +
+                                      epsilon_scalar);
+          }
+        });
+  }
+
+ private:
+  bool use_exclusive_lock_;
+};
+
+#define REGISTER_KERNELS(T, Tindices)                                   \
+  REGISTER_KERNEL_BUILDER(Name("ResourceFusedSparseApplyAdagrad")       \
+                              .Device(DEVICE_CPU)                       \
+                              .TypeConstraint<T>("T")                   \
+                              .TypeConstraint<Tindices>("Tindices"),    \
+                          FusedSparseApplyAdagradOp<T, Tindices>);      \
+  REGISTER_KERNEL_BUILDER(Name("ResourceFusedSparseApplyAdam")          \
+                              .Device(DEVICE_CPU)                       \
+                              .TypeConstraint<T>("T")                   \
+                              .TypeConstraint<Tindices>("Tindices"),    \
+                          FusedSparseApplyAdamOp<T, Tindices>);
+#define REGISTER_CPU_KERNELS(T) \
+  REGISTER_KERNELS(T, int32);   \
+  REGISTER_KERNELS(T, int64_t);
+
+TF_CALL_FLOAT_TYPES(REGISTER_CPU_KERNELS);
+
+#undef REGISTER_CPU_KERNELS
+#undef REGISTER_KERNELS
+
+}  // namespace tensorflow
@@ -0,0 +1,285 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/image_ops.cc
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/op_requires.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/stringpiece.h"
+#include "tensorflow/core/platform/tstring.h"
+#include "tensorflow/core/util/image_resizer_state.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace {
+
+// Decoding dominates the cost of an image, so that every image is worth a
+// shard of its own.
+constexpr int64_t kCostPerImage = 1 << 20;
+
+// Returns the largest ratio, at most `max_ratio`, by which libjpeg can scale
+// a `height` x `width` image down while keeping it at least `out_height` x
+// `out_width`. libjpeg rounds the scaled sizes up.
+int ChooseRatio(int height, int width, int64_t out_height, int64_t out_width,
+                int max_ratio) {
+  int ratio = max_ratio;
+  while (ratio > 1 && ((height + ratio - 1) / ratio < out_height ||
+                       (width + ratio - 1) / ratio < out_width)) {
+    ratio /= 2;
+  }
+  return ratio;
+}
+
+struct Interpolation {
+  int64_t lower;
+  int64_t upper;
+  float lerp;
+};
+
+template <typename Scaler>
+std::vector<Interpolation> ComputeInterpolation(const Scaler& scaler,
+                                                int64_t out_size,
+                                                int64_t in_size, float scale,
+                                                int64_t stride) {
+  std::vector<Interpolation> result(out_size);
+  for (int64_t i = 0; i < out_size; ++i) {
+    const float in = scaler(i, scale);
+    const float in_f = std::floor(in);
+    result[i].lower =
+        std::max(static_cast<int64_t>(in_f), static_cast<int64_t>(0)) *
+        stride;
+    result[i].upper =
+        std::min(static_cast<int64_t>(std::ceil(in)), in_size - 1) * stride;
+    result[i].lerp = in - in_f;
+  }
+  return result;
+}
+
+// Resizes the `in_height` x `in_width` x `channels` image `input` into
+// `output` like ResizeBilinear, with the same arithmetic in the same order.
+// Each input row is interpolated horizontally at most once, and the vertical
+// interpolation runs over whole contiguous rows so that it vectorizes.
+void ResizeBilinear(const uint8* input, int64_t in_height, int64_t in_width,
+                    int channels, int64_t out_height, int64_t out_width,
+                    bool align_corners, bool half_pixel_centers,
+                    float* output) {
+  const int64_t row_size = out_width * channels;
+  if (in_height == out_height && in_width == out_width) {
+    std::copy_n(input, out_height * row_size, output);
+    return;
+  }
+  const float height_scale =
+      CalculateResizeScale(in_height, out_height, align_corners);
+  const float width_scale =
+      CalculateResizeScale(in_width, out_width, align_corners);
+  std::vector<Interpolation> ys, xs;
+  if (half_pixel_centers) {
+    ys = ComputeInterpolation(HalfPixelScaler(), out_height, in_height,
+                              height_scale, in_width * channels);
+    xs = ComputeInterpolation(HalfPixelScaler(), out_width, in_width,
+                              width_scale, channels);
+  } else {
+    ys = ComputeInterpolation(LegacyScaler(), out_height, in_height,
+                              height_scale, in_width * channels);
+    xs = ComputeInterpolation(LegacyScaler(), out_width, in_width,
+                              width_scale, channels);
+  }
+
+  // Horizontally interpolated input rows, and the offsets of the input rows
+  // they hold.
+  std::vector<float> top(row_size), bottom(row_size);
+  int64_t top_row = -1, bottom_row = -1;
+  auto interpolate_row = [&](int64_t row, float* out) {
+    const uint8* in = input + row;
+    for (int64_t x = 0; x < out_width; ++x) {
+      const uint8* left = in + xs[x].lower;
+      const uint8* right = in + xs[x].upper;
+      const float lerp = xs[x].lerp;
+      for (int c = 0; c < channels; ++c) {
+        const float l = left[c];
+        *out++ = l + (static_cast<float>(right[c]) - l) * lerp;
+      }
+    }
+  };
+  for (int64_t y = 0; y < out_height; ++y) {
+    if (ys[y].lower != top_row) {
+      if (ys[y].lower == bottom_row) {
+        std::swap(top, bottom);
+        std::swap(top_row, bottom_row);
+      } else {
+        interpolate_row(ys[y].lower, top.data());
+        top_row = ys[y].lower;
+      }
+    }
+    if (ys[y].upper != bottom_row) {
+      if (ys[y].upper == top_row) {
+        bottom = top;
+      } else {
+        interpolate_row(ys[y].upper, bottom.data());
+      }
+      bottom_row = ys[y].upper;
+    }
+    const float lerp = ys[y].lerp;
+    const float* t = top.data();
+    const float* b = bottom.data();
+    float* out = output + y * row_size;
+    for (int64_t i = 0; i < row_size; ++i) {
+      out[i] = t[i] + (b[i] - t[i]) * lerp;
+    }
+  }
+}
+
+}  // namespace
+
+// Decodes a batch of JPEG images, scaling the DCT where possible, and resizes
+// them to a common size in a single pass per image.
+class DecodeAndResizeJpegOp : public OpKernel {
+ public:
+  explicit DecodeAndResizeJpegOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("channels", &channels_));
+    OP_REQUIRES(context, channels_ == 1 || channels_ == 3,
+                errors::InvalidArgument("channels must be 1 or 3, got ",
+                                        channels_));
+    OP_REQUIRES_OK(context, context->GetAttr("max_ratio", &max_ratio_));
+    OP_REQUIRES(context,
+                max_ratio_ == 1 || max_ratio_ == 2 || max_ratio_ == 4 ||
+                    max_ratio_ == 8,
+                errors::InvalidArgument(
+                    "max_ratio must be 1, 2, 4, or 8, got ", max_ratio_));
+    OP_REQUIRES_OK(context, context->GetAttr("fancy_upscaling",
+                                             &flags_.fancy_upscaling));
+    string dct_method;
+    OP_REQUIRES_OK(context, context->GetAttr("dct_method", &dct_method));
+    OP_REQUIRES(
+        context,
+        (dct_method.empty() || dct_method == "INTEGER_FAST" ||
+         dct_method == "INTEGER_ACCURATE"),
+        errors::InvalidArgument("dct_method must be one of "
+                                "{'', 'INTEGER_FAST', 'INTEGER_ACCURATE'}"));
+    // Like DecodeJpeg, default to IFAST.
+    flags_.dct_method =
+        dct_method == "INTEGER_ACCURATE" ? JDCT_ISLOW : JDCT_IFAST;
+    flags_.components = channels_;
+    OP_REQUIRES_OK(context, context->GetAttr("align_corners", &align_corners_));
+    OP_REQUIRES_OK(
+        context, context->GetAttr("half_pixel_centers", &half_pixel_centers_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& contents = context->input(0);
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(contents.shape()),
+                errors::InvalidArgument("contents must be 1-D, got shape ",
+                                        contents.shape().DebugString()));
+    const Tensor& size = context->input(1);
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(size.shape()) &&
+                    size.NumElements() == 2,
+                errors::InvalidArgument("size must be 1-D with 2 elements, "
+                                        "got shape ",
+                                        size.shape().DebugString()));
+    const int64_t out_height = size.vec<int32>()(0);
+    const int64_t out_width = size.vec<int32>()(1);
+    OP_REQUIRES(context, out_height > 0 && out_width > 0,
+                errors::InvalidArgument("size must be positive, got [",
+                                        out_height, ", ", out_width, "]"));
+
+    const int64_t batch_size = contents.dim_size(0);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0,
+                       TensorShape({batch_size, out_height, out_width,
+                                    static_cast<int64_t>(channels_)}),
+                       &output));
+    if (batch_size == 0) return;
+
+    const auto inputs = contents.vec<tstring>();
+    float* const output_data = output->flat<float>().data();
+    const int64_t image_size = out_height * out_width * channels_;
+    std::vector<Status> statuses(batch_size);
+    auto work = [&](int64_t begin, int64_t end) {
+      std::vector<uint8> decoded;
+      for (int64_t i = begin; i < end; ++i) {
+        statuses[i] = DecodeAndResize(inputs(i), out_height, out_width,
+                                      &decoded, output_data + i * image_size);
+      }
+    };
+    auto* worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, batch_size,
+          kCostPerImage, work);
+    for (int64_t i = 0; i < batch_size; ++i) {
+      OP_REQUIRES_OK(context, statuses[i]);
+    }
+  }
+
+ private:
+  Status DecodeAndResize(StringPiece input, int64_t out_height,
+                         int64_t out_width, std::vector<uint8>* decoded,
+                         float* output) const {
+    if (input.size() > std::numeric_limits<int>::max()) {
+      return errors::InvalidArgument("JPEG contents are too large for int: ",
+                                     input.size());
+    }
+    int height, width;
+    if (!jpeg::GetImageInfo(input.data(), input.size(), &width, &height,
+                            /*components=*/nullptr)) {
+      return errors::InvalidArgument("Invalid JPEG data, size ", input.size());
+    }
+    jpeg::UncompressFlags flags = flags_;
+    flags.ratio =
+        ChooseRatio(height, width, out_height, out_width, max_ratio_);
+    int decoded_height = 0, decoded_width = 0;
+    const uint8* data = jpeg::Uncompress(
+        input.data(), input.size(), flags, /*nwarn=*/nullptr,
+        [&](int w, int h, int c) -> uint8* {
+          decoded_height = h;
+          decoded_width = w;
+          decoded->resize(static_cast<size_t>(h) * w * c);
+          return decoded->data();
+        });
+    if (data == nullptr) {
+      return errors::InvalidArgument(
+          "jpeg::Uncompress failed. Invalid JPEG data.");
+    }
+    ResizeBilinear(data, decoded_height, decoded_width, channels_, out_height,
+                   out_width, align_corners_, half_pixel_centers_, output);
+    return absl::OkStatus();
+  }
+
+  int channels_;
+  int max_ratio_;
+  jpeg::UncompressFlags flags_;
+  bool align_corners_;
+  bool half_pixel_centers_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("DecodeAndResizeJpeg").Device(DEVICE_CPU),
+                        DecodeAndResizeJpegOp);
+
+}  // namespace tensorflow
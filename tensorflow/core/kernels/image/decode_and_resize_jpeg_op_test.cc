@@ -0,0 +1,154 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/image_resizer_state.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int kWidth = 64;
+constexpr int kHeight = 48;
+
+class DecodeAndResizeJpegOpTest : public OpsTestBase {
+ protected:
+  void SetUp() override {
+    std::vector<uint8> pixels(kHeight * kWidth * 3);
+    for (int y = 0; y < kHeight; ++y) {
+      for (int x = 0; x < kWidth; ++x) {
+        uint8* pixel = &pixels[(y * kWidth + x) * 3];
+        pixel[0] = x * 4;
+        pixel[1] = y * 5;
+        pixel[2] = (x * y) % 256;
+      }
+    }
+    jpeg::CompressFlags flags;
+    flags.format = jpeg::FORMAT_RGB;
+    jpeg_ = jpeg::Compress(pixels.data(), kWidth, kHeight, flags);
+    ASSERT_FALSE(jpeg_.empty());
+  }
+
+  void MakeOp(int max_ratio) {
+    TF_EXPECT_OK(NodeDefBuilder("decode_and_resize", "DecodeAndResizeJpeg")
+                     .Input(FakeInput(DT_STRING))
+                     .Input(FakeInput(DT_INT32))
+                     .Attr("max_ratio", max_ratio)
+                     .Attr("half_pixel_centers", true)
+                     .Finalize(node_def()));
+    TF_EXPECT_OK(InitOp());
+  }
+
+  // Decodes the test image at `ratio` and resizes it to `out_height` x
+  // `out_width` the straightforward way.
+  Tensor Expected(int ratio, int out_height, int out_width) {
+    jpeg::UncompressFlags flags;
+    flags.ratio = ratio;
+    flags.components = 3;
+    flags.dct_method = JDCT_IFAST;
+    int height, width, channels;
+    std::unique_ptr<uint8[]> image(jpeg::Uncompress(
+        jpeg_.data(), jpeg_.size(), flags, &width, &height, &channels,
+        /*nwarn=*/nullptr));
+    EXPECT_NE(image, nullptr);
+    auto pixel = [&](int y, int x, int c) -> float {
+      return image[(y * width + x) * 3 + c];
+    };
+    const float height_scale = CalculateResizeScale(height, out_height, false);
+    const float width_scale = CalculateResizeScale(width, out_width, false);
+    Tensor expected(DT_FLOAT, TensorShape({1, out_height, out_width, 3}));
+    auto out = expected.tensor<float, 4>();
+    for (int y = 0; y < out_height; ++y) {
+      const float in_y = HalfPixelScaler()(y, height_scale);
+      const int top = std::max(static_cast<int>(std::floor(in_y)), 0);
+      const int bottom =
+          std::min(static_cast<int>(std::ceil(in_y)), height - 1);
+      const float y_lerp = in_y - std::floor(in_y);
+      for (int x = 0; x < out_width; ++x) {
+        const float in_x = HalfPixelScaler()(x, width_scale);
+        const int left = std::max(static_cast<int>(std::floor(in_x)), 0);
+        const int right =
+            std::min(static_cast<int>(std::ceil(in_x)), width - 1);
+        const float x_lerp = in_x - std::floor(in_x);
+        for (int c = 0; c < 3; ++c) {
+          const float t = pixel(top, left, c) +
+                          (pixel(top, right, c) - pixel(top, left, c)) * x_lerp;
+          const float b =
+              pixel(bottom, left, c) +
+              (pixel(bottom, right, c) - pixel(bottom, left, c)) * x_lerp;
+          out(0, y, x, c) = t + (b - t) * y_lerp;
+        }
+      }
+    }
+    return expected;
+  }
+
+  tstring jpeg_;
+};
+
+TEST_F(DecodeAndResizeJpegOpTest, MatchesDecodeThenResize) {
+  MakeOp(/*max_ratio=*/1);
+  AddInputFromArray<tstring>(TensorShape({1}), {jpeg_});
+  AddInputFromArray<int32>(TensorShape({2}), {20, 30});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorNear<float>(Expected(1, 20, 30), *GetOutput(0), 1e-4);
+}
+
+TEST_F(DecodeAndResizeJpegOpTest, ScalesDct) {
+  MakeOp(/*max_ratio=*/8);
+  AddInputFromArray<tstring>(TensorShape({1}), {jpeg_});
+  // 1/4 of the image is exactly the requested size, 1/8 is too small.
+  AddInputFromArray<int32>(TensorShape({2}), {kHeight / 4, kWidth / 4});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<float>(Expected(4, kHeight / 4, kWidth / 4),
+                                 *GetOutput(0));
+}
+
+TEST_F(DecodeAndResizeJpegOpTest, DecodesBatch) {
+  MakeOp(/*max_ratio=*/8);
+  AddInputFromArray<tstring>(TensorShape({3}), {jpeg_, jpeg_, jpeg_});
+  AddInputFromArray<int32>(TensorShape({2}), {10, 15});
+  TF_ASSERT_OK(RunOpKernel());
+  const Tensor& output = *GetOutput(0);
+  ASSERT_EQ(output.shape(), TensorShape({3, 10, 15, 3}));
+  const Tensor expected = Expected(4, 10, 15);
+  for (int i = 0; i < 3; ++i) {
+    test::ExpectTensorNear<float>(expected.Slice(0, 1), output.Slice(i, i + 1),
+                                  1e-4);
+  }
+}
+
+TEST_F(DecodeAndResizeJpegOpTest, RejectsInvalidJpeg) {
+  MakeOp(/*max_ratio=*/8);
+  AddInputFromArray<tstring>(TensorShape({2}), {jpeg_, "not a jpeg"});
+  AddInputFromArray<int32>(TensorShape({2}), {10, 15});
+  const Status status = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(status)) << status;
+}
+
+}  // namespace
+}  // namespace tensorflow
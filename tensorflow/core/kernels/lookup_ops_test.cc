@@ -15,11 +15,13 @@ limitations under the License.
 
 // Tests kernels of lookup ops.
 
+#include "absl/strings/match.h"
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/lookup_interface.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/shape_inference_testutil.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
@@ -62,7 +64,29 @@ REGISTER_KERNEL_BUILDER(
     AnonymousLookupTableOp<MockHashTable<key_dtype, value_dtype>, key_dtype,
                            value_dtype>);
 
-class LookupOpsTest : public OpsTestBase {};
+REGISTER_KERNEL_BUILDER(Name("MockAnonymousHashTable")
+                            .Device(DEVICE_CPU)
+                            .TypeConstraint<int64_t>("key_dtype")
+                            .TypeConstraint<int64_t>("value_dtype"),
+                        AnonymousLookupTableOp<MockHashTable<int64_t, int64_t>,
+                                               int64_t, int64_t>);
+
+class LookupOpsTest : public OpsTestBase {
+ protected:
+  // Creates an int64 -> int64 hash table, whose large imports are inserted in
+  // parallel on the worker threads of the test device.
+  lookup::LookupInterface* MakeInt64HashTable() {
+    TF_CHECK_OK(
+        NodeDefBuilder("mock_anonymous_hash_table", "MockAnonymousHashTable")
+            .Attr("key_dtype", DT_INT64)
+            .Attr("value_dtype", DT_INT64)
+            .Finalize(node_def()));
+    TF_CHECK_OK(InitOp());
+    TF_CHECK_OK(RunOpKernel());
+    const ResourceHandle& handle = GetOutput(0)->scalar<ResourceHandle>()();
+    return handle.GetResource<lookup::LookupInterface>().value();
+  }
+};
 
 TEST_F(LookupOpsTest, AnonymousHashTable_RefCounting) {
   TF_ASSERT_OK(
@@ -100,5 +124,50 @@ TEST_F(LookupOpsTest, AnonymousHashTable_RefCounting) {
   EXPECT_FALSE(alive);
 }
 
+TEST_F(LookupOpsTest, HashTable_LargeImport) {
+  lookup::LookupInterface* table = MakeInt64HashTable();
+  // Enough keys for the table to be partitioned and filled in parallel.
+  const int64_t kNumKeys = 1 << 20;
+  Tensor keys(DT_INT64, TensorShape({kNumKeys}));
+  Tensor values(DT_INT64, TensorShape({kNumKeys}));
+  for (int64_t i = 0; i < kNumKeys; ++i) {
+    keys.flat<int64_t>()(i) = i * 7919;
+    values.flat<int64_t>()(i) = i;
+  }
+  TF_ASSERT_OK(table->ImportValues(context_.get(), keys, values));
+  EXPECT_EQ(table->size(), kNumKeys);
+
+  // Looks up every key, followed by a missing one.
+  Tensor lookup_keys(DT_INT64, TensorShape({kNumKeys + 1}));
+  for (int64_t i = 0; i < kNumKeys; ++i) {
+    lookup_keys.flat<int64_t>()(i) = keys.flat<int64_t>()(i);
+  }
+  lookup_keys.flat<int64_t>()(kNumKeys) = 1;
+  Tensor found(DT_INT64, TensorShape({kNumKeys + 1}));
+  TF_ASSERT_OK(table->Find(context_.get(), lookup_keys, &found,
+                           test::AsScalar<int64_t>(-1)));
+  for (int64_t i = 0; i < kNumKeys; ++i) {
+    ASSERT_EQ(found.flat<int64_t>()(i), i);
+  }
+  EXPECT_EQ(found.flat<int64_t>()(kNumKeys), -1);
+}
+
+TEST_F(LookupOpsTest, HashTable_LargeImportReportsFirstConflict) {
+  lookup::LookupInterface* table = MakeInt64HashTable();
+  const int64_t kNumKeys = 1 << 20;
+  Tensor keys(DT_INT64, TensorShape({kNumKeys}));
+  Tensor values(DT_INT64, TensorShape({kNumKeys}));
+  for (int64_t i = 0; i < kNumKeys; ++i) {
+    keys.flat<int64_t>()(i) = i;
+    values.flat<int64_t>()(i) = i;
+  }
+  // Two keys repeated with different values; the earlier one is reported.
+  keys.flat<int64_t>()(kNumKeys - 2) = 5;
+  keys.flat<int64_t>()(kNumKeys - 1) = 3;
+  const Status status = table->ImportValues(context_.get(), keys, values);
+  EXPECT_TRUE(errors::IsFailedPrecondition(status));
+  EXPECT_TRUE(absl::StrContains(status.message(), "Key 5 has 5")) << status;
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -149,6 +149,7 @@ class InitializeTableFromTextFileOp : public OpKernel {
         ctx, lookup::InitializeTableFromTextFile(
                  vocab_filename, vocab_size_, delimiter_, key_index_,
                  value_index_, offset_, ctx->env(),
+                 ctx->device()->tensorflow_cpu_worker_threads(),
                  MakeInitializerSerializer(vocab_filename_tensor), table));
     if (ctx->track_allocations()) {
       ctx->record_persistent_memory_allocation(table->MemoryUsed() -
@@ -16,10 +16,19 @@ limitations under the License.
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant.h"
@@ -27,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace lookup {
@@ -36,12 +46,20 @@ std::string UniqueNodeName(const std::string& base) {
   return strings::StrCat(base, "/", counter.fetch_add(1), "/", random::New64());
 }
 
-// Lookup table that wraps an unordered_map, where the key and value data type
-// is specified. Each individual value must be a scalar. If vector values are
-// required, use MutableHashTableOfTensors.
+// Lookup table of scalar keys and values. If vector values are required, use
+// MutableHashTableOfTensors.
 //
 // This table is mutable and thread safe - Insert can be called at any time.
 //
+// The entries are split by the top bits of the hash of their key across
+// kNumPartitions open-addressing hash maps (absl::flat_hash_map, which probes
+// groups of slots with SIMD), each behind its own lock. Concurrent lookups and
+// inserts thus rarely contend, and a growing map only blocks its own partition
+// while it rehashes 1/kNumPartitions of the entries. Every batch of keys is
+// grouped by partition, so that each partition is locked once per batch and
+// the buckets of upcoming keys are prefetched, and the partitions of large
+// batches are processed in parallel.
+//
 // Sample use case:
 //
 // MutableHashTableOfScalars<int64, int64> table;  // int64 -> int64.
@@ -56,8 +74,12 @@ class MutableHashTableOfScalars final : public LookupInterface {
   MutableHashTableOfScalars(OpKernelContext* ctx, OpKernel* kernel) {}
 
   size_t size() const override {
-    tf_shared_lock l(mu_);
-    return table_.size();
+    size_t size = 0;
+    for (const Partition& partition : partitions_) {
+      tf_shared_lock l(partition.mu);
+      size += partition.table.size();
+    }
+    return size;
   }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
@@ -70,69 +92,91 @@ class MutableHashTableOfScalars final : public LookupInterface {
     int64_t default_total = default_flat.size();
     bool is_full_size_default = (total == default_total);
 
-    tf_shared_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      // is_full_size_default is true:
-      //   Each key has an independent default value, key_values(i)
-      //   corresponding uses default_flat(i) as its default value.
-      //
-      // is_full_size_default is false:
-      //   All keys will share the default_flat(0) as default value.
-      value_values(i) = gtl::FindWithDefault(
-          table_, SubtleMustCopyIfIntegral(key_values(i)),
-          is_full_size_default ? default_flat(i) : default_flat(0));
-    }
+    const Batch batch(key_values);
+    ForEachPartition(ctx, batch, [&](int p, absl::Span<const int64_t> order) {
+      const Partition& partition = partitions_[p];
+      tf_shared_lock l(partition.mu);
+      for (size_t j = 0; j < order.size(); ++j) {
+        if (j + kPrefetchDistance < order.size()) {
+          partition.table.prefetch(key_values(order[j + kPrefetchDistance]));
+        }
+        const int64_t i = order[j];
+        // is_full_size_default is true:
+        //   Each key has an independent default value, key_values(i)
+        //   corresponding uses default_flat(i) as its default value.
+        //
+        // is_full_size_default is false:
+        //   All keys will share the default_flat(0) as default value.
+        const auto it =
+            partition.table.find(SubtleMustCopyIfIntegral(key_values(i)));
+        value_values(i) = it != partition.table.end()
+                              ? it->second
+                              : (is_full_size_default ? default_flat(i)
+                                                      : default_flat(0));
+      }
+    });
 
     return absl::OkStatus();
   }
 
-  Status DoInsert(bool clear, const Tensor& keys, const Tensor& values) {
+  Status Insert(OpKernelContext* ctx, const Tensor& keys,
+                const Tensor& values) override {
     const auto key_values = keys.flat<K>();
     const auto value_values = values.flat<V>();
 
-    mutex_lock l(mu_);
-    if (clear) {
-      table_.clear();
-    }
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
-                          SubtleMustCopyIfIntegral(value_values(i)));
-    }
+    const Batch batch(key_values);
+    ForEachPartition(ctx, batch, [&](int p, absl::Span<const int64_t> order) {
+      Partition& partition = partitions_[p];
+      mutex_lock l(partition.mu);
+      InsertLocked(&partition, order, key_values, value_values);
+    });
     return absl::OkStatus();
   }
 
-  Status Insert(OpKernelContext* ctx, const Tensor& keys,
-                const Tensor& values) override {
-    return DoInsert(false, keys, values);
-  }
-
   Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
     const auto key_values = keys.flat<K>();
 
-    mutex_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      table_.erase(SubtleMustCopyIfIntegral(key_values(i)));
-    }
+    const Batch batch(key_values);
+    ForEachPartition(ctx, batch, [&](int p, absl::Span<const int64_t> order) {
+      Partition& partition = partitions_[p];
+      mutex_lock l(partition.mu);
+      for (const int64_t i : order) {
+        partition.table.erase(SubtleMustCopyIfIntegral(key_values(i)));
+      }
+    });
     return absl::OkStatus();
   }
 
+  // Replaces the contents of all partitions at once, so that no lookup sees a
+  // mix of the old and new contents.
   Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
-                      const Tensor& values) override {
-    return DoInsert(true, keys, values);
+                      const Tensor& values) override
+      TF_NO_THREAD_SAFETY_ANALYSIS {
+    const auto key_values = keys.flat<K>();
+    const auto value_values = values.flat<V>();
+
+    const Batch batch(key_values);
+    for (Partition& partition : partitions_) partition.mu.lock();
+    for (int p = 0; p < kNumPartitions; ++p) {
+      partitions_[p].table.clear();
+      InsertLocked(&partitions_[p], batch.keys_of(p), key_values,
+                   value_values);
+    }
+    for (int p = kNumPartitions - 1; p >= 0; --p) partitions_[p].mu.unlock();
+    return absl::OkStatus();
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-
-    Tensor* keys;
-    Tensor* values;
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("keys", TensorShape({size}), &keys));
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("values", TensorShape({size}), &values));
-    ExportKeysAndValues(keys, values);
-    return absl::OkStatus();
+    return WithAllPartitionsShared([&](int64_t size) -> Status {
+      Tensor* keys;
+      Tensor* values;
+      TF_RETURN_IF_ERROR(
+          ctx->allocate_output("keys", TensorShape({size}), &keys));
+      TF_RETURN_IF_ERROR(
+          ctx->allocate_output("values", TensorShape({size}), &values));
+      ExportKeysAndValues(keys, values);
+      return absl::OkStatus();
+    });
   }
 
   DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
@@ -145,24 +189,22 @@ class MutableHashTableOfScalars final : public LookupInterface {
 
   int64_t MemoryUsed() const override {
     int64_t ret = 0;
-    tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
-      }
+    for (const Partition& partition : partitions_) {
+      tf_shared_lock l(partition.mu);
+      // Each slot holds an entry and a control byte.
+      ret += partition.table.capacity() * (sizeof(std::pair<K, V>) + 1);
     }
     return sizeof(MutableHashTableOfScalars) + ret;
   }
 
   Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-    Tensor keys(key_dtype(), TensorShape({size}));
-    Tensor values(value_dtype(), TensorShape({size}));
-    ExportKeysAndValues(&keys, &values);
+    Tensor keys, values;
+    WithAllPartitionsShared([&](int64_t size) {
+      keys = Tensor(key_dtype(), TensorShape({size}));
+      values = Tensor(value_dtype(), TensorShape({size}));
+      ExportKeysAndValues(&keys, &values);
+      return absl::OkStatus();
+    }).IgnoreError();
 
     // We set use_node_name_sharing with a unique node name so that the resource
     // can outlive the MutableHashTableV2 kernel. This means that the lifetime
@@ -195,21 +237,125 @@ class MutableHashTableOfScalars final : public LookupInterface {
   }
 
  private:
-  // Writes all keys and values into `keys` and `values`. `keys` and `values`
-  // must point to tensors of size `table_.size()`.
+  static constexpr int kLogNumPartitions = 6;
+  static constexpr int kNumPartitions = 1 << kLogNumPartitions;
+  // How many keys ahead of the current one lookups prefetch buckets.
+  static constexpr size_t kPrefetchDistance = 8;
+  // Batches with fewer keys are processed on the calling thread.
+  static constexpr int64_t kMinParallelBatchSize = 1 << 14;
+  static constexpr int64_t kCostPerKey = 100;
+
+  // Aligned to a cache line so that the locks of different partitions do not
+  // share one.
+  struct alignas(64) Partition {
+    mutable mutex mu;
+    absl::flat_hash_map<K, V, ScalarKeyHash<K>> table TF_GUARDED_BY(mu);
+  };
+
+  static int PartitionOf(const K& key) {
+    return ScalarKeyHash<K>()(key) >>
+           (std::numeric_limits<size_t>::digits - kLogNumPartitions);
+  }
+
+  // The indices of a batch of keys, grouped by the partition of their key and
+  // in their original order within each partition.
+  class Batch {
+   public:
+    explicit Batch(typename TTypes<K>::ConstFlat keys) : order_(keys.size()) {
+      std::vector<uint8_t> partitions(keys.size());
+      std::array<int64_t, kNumPartitions> counts = {};
+      for (int64_t i = 0; i < keys.size(); ++i) {
+        partitions[i] = PartitionOf(SubtleMustCopyIfIntegral(keys(i)));
+        ++counts[partitions[i]];
+      }
+      offsets_[0] = 0;
+      for (int p = 0; p < kNumPartitions; ++p) {
+        offsets_[p + 1] = offsets_[p] + counts[p];
+      }
+      std::array<int64_t, kNumPartitions> next;
+      std::copy_n(offsets_.begin(), kNumPartitions, next.begin());
+      for (int64_t i = 0; i < keys.size(); ++i) {
+        order_[next[partitions[i]]++] = i;
+      }
+    }
+
+    int64_t size() const { return order_.size(); }
+
+    absl::Span<const int64_t> keys_of(int p) const {
+      return absl::MakeConstSpan(order_).subspan(offsets_[p],
+                                                 offsets_[p + 1] - offsets_[p]);
+    }
+
+   private:
+    std::vector<int64_t> order_;
+    std::array<int64_t, kNumPartitions + 1> offsets_;
+  };
+
+  // Calls `fn(p, batch.keys_of(p))` for every partition p with keys in
+  // `batch`, in parallel if the batch is large.
+  template <typename Fn>
+  static void ForEachPartition(OpKernelContext* ctx, const Batch& batch,
+                               Fn fn) {
+    auto work = [&](int64_t begin, int64_t end) {
+      for (int64_t p = begin; p < end; ++p) {
+        const absl::Span<const int64_t> order = batch.keys_of(p);
+        if (!order.empty()) fn(p, order);
+      }
+    };
+    if (ctx == nullptr || batch.size() < kMinParallelBatchSize) {
+      work(0, kNumPartitions);
+      return;
+    }
+    auto* worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, kNumPartitions,
+          kCostPerKey * batch.size() / kNumPartitions, work);
+  }
+
+  static void InsertLocked(Partition* partition,
+                           absl::Span<const int64_t> order,
+                           typename TTypes<K>::ConstFlat keys,
+                           typename TTypes<V>::ConstFlat values)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(partition->mu) {
+    partition->table.reserve(partition->table.size() + order.size());
+    for (const int64_t i : order) {
+      partition->table.insert_or_assign(SubtleMustCopyIfIntegral(keys(i)),
+                                        SubtleMustCopyIfIntegral(values(i)));
+    }
+  }
+
+  // Calls `fn(size)` with every partition locked for reading, where `size` is
+  // the number of entries in the table.
+  template <typename Fn>
+  Status WithAllPartitionsShared(Fn fn) const TF_NO_THREAD_SAFETY_ANALYSIS {
+    int64_t size = 0;
+    for (const Partition& partition : partitions_) {
+      partition.mu.lock_shared();
+      size += partition.table.size();
+    }
+    Status status = fn(size);
+    for (int p = kNumPartitions - 1; p >= 0; --p) {
+      partitions_[p].mu.unlock_shared();
+    }
+    return status;
+  }
+
+  // Writes all keys and values into `keys` and `values`, which must have room
+  // for all entries. All partitions must be locked.
   void ExportKeysAndValues(Tensor* keys, Tensor* values) const
-      TF_SHARED_LOCKS_REQUIRED(mu_) {
+      TF_NO_THREAD_SAFETY_ANALYSIS {
     auto keys_data = keys->flat<K>();
     auto values_data = values->flat<V>();
     int64_t i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      keys_data(i) = it->first;
-      values_data(i) = it->second;
+    for (const Partition& partition : partitions_) {
+      for (const auto& entry : partition.table) {
+        keys_data(i) = entry.first;
+        values_data(i) = entry.second;
+        ++i;
+      }
     }
   }
 
-  mutable mutex mu_;
-  std::unordered_map<K, V> table_ TF_GUARDED_BY(mu_);
+  std::array<Partition, kNumPartitions> partitions_;
 };
 
 // Lookup table that wraps an unordered_map. Behaves identical to
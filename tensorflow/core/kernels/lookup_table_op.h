@@ -16,7 +16,15 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_LOOKUP_TABLE_OP_H_
 #define TENSORFLOW_CORE_KERNELS_LOOKUP_TABLE_OP_H_
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <vector>
+
 #include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/lookup_interface.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -31,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -202,6 +211,20 @@ inline const ResourceHandle& SubtleMustCopyIfIntegral(
 // Returns a unique node name starting with "base".
 std::string UniqueNodeName(const std::string& base);
 
+// absl::Hash has no overload for tstring, so its contents are hashed as a
+// string_view.
+template <class K>
+struct ScalarKeyHash {
+  size_t operator()(const K& key) const { return absl::Hash<K>()(key); }
+};
+
+template <>
+struct ScalarKeyHash<tstring> {
+  size_t operator()(const tstring& key) const {
+    return absl::Hash<absl::string_view>()(absl::string_view(key));
+  }
+};
+
 // Lookup table that wraps an flat_hash_map, where the key and value data type
 // is specified.
 //
@@ -219,7 +242,11 @@ std::string UniqueNodeName(const std::string& base);
 template <class K, class V>
 class HashTable : public InitializableLookupTable {
  public:
-  HashTable(OpKernelContext* ctx, OpKernel* kernel) {}
+  HashTable(OpKernelContext* ctx, OpKernel* kernel)
+      : worker_threads_(ctx == nullptr
+                            ? nullptr
+                            : ctx->device()->tensorflow_cpu_worker_threads()),
+        partitions_(1) {}
 
   Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
     // We set use_node_name_sharing with a unique node name so that the resource
@@ -234,7 +261,7 @@ class HashTable : public InitializableLookupTable {
                            .WithAttr("key_dtype", key_dtype())
                            .WithAttr("value_dtype", value_dtype())
                            .WithAttr("use_node_name_sharing", true));
-    if (table_.empty()) {
+    if (NumEntries() == 0) {
       *out = hash_table_node;
       return absl::OkStatus();
     }
@@ -258,7 +285,7 @@ class HashTable : public InitializableLookupTable {
     if (!is_initialized())
       return 0;
     else
-      return table_.size();
+      return NumEntries();
   }
 
   Status ExportValues(OpKernelContext* context) override {
@@ -266,7 +293,7 @@ class HashTable : public InitializableLookupTable {
       return errors::Aborted("HashTable is not initialized.");
     }
 
-    const int64_t size = table_.size();
+    const int64_t size = NumEntries();
 
     Tensor* keys;
     Tensor* values;
@@ -278,9 +305,11 @@ class HashTable : public InitializableLookupTable {
     auto keys_data = keys->flat<K>();
     auto values_data = values->flat<V>();
     int64_t i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      keys_data(i) = it->first;
-      values_data(i) = it->second;
+    for (const Table& table : partitions_) {
+      for (auto it = table.begin(); it != table.end(); ++it, ++i) {
+        keys_data(i) = it->first;
+        values_data(i) = it->second;
+      }
     }
     return absl::OkStatus();
   }
@@ -294,8 +323,16 @@ class HashTable : public InitializableLookupTable {
     if (is_initialized()) {
       return errors::Aborted("HashTable already initialized.");
     }
-    if (size > 0) {
-      table_.reserve(size);
+    const int64_t expected_size = static_cast<int64_t>(size);
+    if (expected_size >= kMinPartitionedSize && log_num_partitions_ == 0 &&
+        partitions_[0].empty()) {
+      log_num_partitions_ = kLogNumPartitions;
+      partitions_.resize(1 << kLogNumPartitions);
+    }
+    if (expected_size > 0) {
+      for (Table& table : partitions_) {
+        table.reserve(expected_size >> log_num_partitions_);
+      }
     }
     return absl::OkStatus();
   };
@@ -307,17 +344,63 @@ class HashTable : public InitializableLookupTable {
   Status DoInsert(const Tensor& keys, const Tensor& values) override {
     const auto key_values = keys.flat<K>();
     const auto value_values = values.flat<V>();
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      auto&& key = SubtleMustCopyIfIntegral(key_values(i));
-      auto&& value = SubtleMustCopyIfIntegral(value_values(i));
-      auto result = table_.try_emplace(key, value);
-      if (!result.second && result.first->second != value) {
-        return errors::FailedPrecondition(
-            "HashTable has different value for same key. Key ", key, " has ",
-            result.first->second, " and trying to add value ", value);
+    const int64_t num_keys = key_values.size();
+    if (log_num_partitions_ == 0 || worker_threads_ == nullptr ||
+        num_keys < kMinParallelBatchSize) {
+      for (int64_t i = 0; i < num_keys; ++i) {
+        auto&& key = SubtleMustCopyIfIntegral(key_values(i));
+        TF_RETURN_IF_ERROR(
+            InsertEntry(&partitions_[PartitionOf(key)], key,
+                        SubtleMustCopyIfIntegral(value_values(i))));
       }
+      return absl::OkStatus();
     }
-    return absl::OkStatus();
+
+    // Groups the keys by partition, hashing them in parallel.
+    const int num_partitions = partitions_.size();
+    std::vector<uint8_t> key_partitions(num_keys);
+    Shard(worker_threads_->num_threads, worker_threads_->workers, num_keys,
+          kCostPerKey, [&](int64_t begin, int64_t end) {
+            for (int64_t i = begin; i < end; ++i) {
+              key_partitions[i] =
+                  PartitionOf(SubtleMustCopyIfIntegral(key_values(i)));
+            }
+          });
+    std::vector<int64_t> offsets(num_partitions + 1, 0);
+    for (const uint8_t p : key_partitions) ++offsets[p + 1];
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    std::vector<int64_t> next(offsets.begin(), offsets.end() - 1);
+    std::vector<int64_t> order(num_keys);
+    for (int64_t i = 0; i < num_keys; ++i) {
+      order[next[key_partitions[i]]++] = i;
+    }
+
+    // Fills the partitions in parallel, each with its keys in their order in
+    // `keys`, and reports the first conflicting key in `keys`, like the
+    // sequential insertion above.
+    std::vector<int64_t> first_conflict(num_partitions, num_keys);
+    std::vector<Status> statuses(num_partitions);
+    Shard(worker_threads_->num_threads, worker_threads_->workers,
+          num_partitions, kCostPerKey * num_keys / num_partitions,
+          [&](int64_t begin, int64_t end) {
+            for (int64_t p = begin; p < end; ++p) {
+              for (int64_t j = offsets[p]; j < offsets[p + 1]; ++j) {
+                const int64_t i = order[j];
+                Status s = InsertEntry(
+                    &partitions_[p], SubtleMustCopyIfIntegral(key_values(i)),
+                    SubtleMustCopyIfIntegral(value_values(i)));
+                if (!s.ok()) {
+                  first_conflict[p] = i;
+                  statuses[p] = s;
+                  break;
+                }
+              }
+            }
+          });
+    const int64_t p = std::min_element(first_conflict.begin(),
+                                       first_conflict.end()) -
+                      first_conflict.begin();
+    return statuses[p];
   }
 
   Status DoFind(const Tensor& key, Tensor* value,
@@ -327,8 +410,9 @@ class HashTable : public InitializableLookupTable {
     auto value_values = value->flat<V>();
 
     for (int64_t i = 0; i < key_values.size(); ++i) {
+      auto&& key_value = SubtleMustCopyIfIntegral(key_values(i));
       value_values(i) = gtl::FindWithDefault(
-          table_, SubtleMustCopyIfIntegral(key_values(i)), default_val);
+          partitions_[PartitionOf(key_value)], key_value, default_val);
     }
     return absl::OkStatus();
   }
@@ -337,12 +421,48 @@ class HashTable : public InitializableLookupTable {
     if (!is_initialized()) {
       return 0;
     }
-    const int64_t num_elements = table_.size();
+    const int64_t num_elements = NumEntries();
     return num_elements * (sizeof(K) + sizeof(V));
   }
 
  private:
-  absl::flat_hash_map<K, V> table_;
+  using Table = absl::flat_hash_map<K, V, ScalarKeyHash<K>>;
+
+  // Tables expected to hold at least this many entries are split across
+  // 1 << kLogNumPartitions maps by the top bits of the hash of their key, so
+  // that large batches of keys are inserted into the maps in parallel.
+  static constexpr int64_t kMinPartitionedSize = 1 << 20;
+  static constexpr int kLogNumPartitions = 6;
+  // Batches with fewer keys are inserted on the calling thread.
+  static constexpr int64_t kMinParallelBatchSize = 1 << 14;
+  static constexpr int64_t kCostPerKey = 100;
+
+  int PartitionOf(const K& key) const {
+    if (log_num_partitions_ == 0) return 0;
+    return ScalarKeyHash<K>()(key) >>
+           (std::numeric_limits<size_t>::digits - log_num_partitions_);
+  }
+
+  static Status InsertEntry(Table* table, const K& key, const V& value) {
+    auto result = table->try_emplace(key, value);
+    if (!result.second && result.first->second != value) {
+      return errors::FailedPrecondition(
+          "HashTable has different value for same key. Key ", key, " has ",
+          result.first->second, " and trying to add value ", value);
+    }
+    return absl::OkStatus();
+  }
+
+  int64_t NumEntries() const {
+    int64_t num_entries = 0;
+    for (const Table& table : partitions_) num_entries += table.size();
+    return num_entries;
+  }
+
+  // Not owned; used to insert large batches of keys in parallel.
+  const DeviceBase::CpuWorkerThreads* const worker_threads_;
+  int log_num_partitions_ = 0;
+  std::vector<Table> partitions_;
 };
 
 }  // namespace lookup
@@ -15,6 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/lookup_util.h"
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 #include "absl/status/status.h"
 #include "tensorflow/core/framework/function_handle_cache.h"
 #include "tensorflow/core/framework/lookup_interface.h"
@@ -25,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace lookup {
@@ -42,24 +47,32 @@ Status GetNumLinesInTextFile(Env* env, const string& vocab_file,
   std::unique_ptr<RandomAccessFile> file;
   TF_RETURN_IF_ERROR(env->NewRandomAccessFile(vocab_file, &file));
 
-  io::InputBuffer input_buffer(file.get(), kInputBufferSize);
-  string line;
-  Status s = input_buffer.ReadLine(&line);
-  int64_t next_id = 0;
-  while (s.ok()) {
-    next_id++;
-    s = input_buffer.ReadLine(&line);
-  }
-  if (!absl::IsOutOfRange(s)) {
-    return s;
+  // Counts the line breaks chunk by chunk rather than reading the lines one
+  // by one. A last line without a line break counts as a line too.
+  std::unique_ptr<char[]> scratch(new char[kInputBufferSize]);
+  uint64 offset = 0;
+  int64_t num_line_breaks = 0;
+  char last_char = '\n';
+  while (true) {
+    StringPiece chunk;
+    Status s = file->Read(offset, kInputBufferSize, &chunk, scratch.get());
+    if (!s.ok() && !absl::IsOutOfRange(s)) {
+      return s;
+    }
+    num_line_breaks += std::count(chunk.begin(), chunk.end(), '\n');
+    if (!chunk.empty()) last_char = chunk.back();
+    offset += chunk.size();
+    if (!s.ok() || chunk.empty()) break;
   }
-  *num_lines = next_id;
+  *num_lines = num_line_breaks + (last_char == '\n' ? 0 : 1);
   return absl::OkStatus();
 }
 
-// Iterator that reads a text file. Each iteration process one line, it parses
-// the line and populates the keys and values tensors used for initialization
-// with a single key and corresponding value.
+// Iterator that reads a text file. Each iteration processes a batch of up to
+// kLinesPerBatch lines: it parses the lines and populates the keys and values
+// tensors used for initialization with a vector of keys and corresponding
+// values. The lines are read sequentially, but when CPU worker threads are
+// given, the lines of a batch are parsed in parallel.
 //
 // What information of the line to populate the key or values is specified by
 // providing key_index and value_index.
@@ -81,17 +94,21 @@ class TextFileLineIterator
   // - Index -1 means the line number stored in int64.
   // - Index >= 0 represent index (starting at zero) of the split line based on
   //   delimiter.
+  //
+  // 'worker_threads', if not null, are used to parse the lines of a batch.
   Status Init(const string& filename, int64_t vocab_size, char delimiter,
               DataType key_dtype, int64_t key_index, DataType value_dtype,
-              int64_t value_index, int64_t offset, Env* env) {
+              int64_t value_index, int64_t offset, Env* env,
+              const DeviceBase::CpuWorkerThreads* worker_threads) {
     filename_ = filename;
     vocab_size_ = vocab_size;
     delimiter_ = delimiter;
-    key_ = Tensor(key_dtype, TensorShape({}));
-    value_ = Tensor(value_dtype, TensorShape({}));
+    key_dtype_ = key_dtype;
+    value_dtype_ = value_dtype;
     key_index_ = key_index;
     value_index_ = value_index;
     env_ = env;
+    worker_threads_ = worker_threads;
 
     status_ = env->NewRandomAccessFile(filename_, &file_);
     if (!status_.ok()) return status_;
@@ -107,63 +124,65 @@ class TextFileLineIterator
 
   void Next() override {
     if (!valid_) return;
-
-    string line;
-    status_ = input_buffer_->ReadLine(&line);
-    if (!status_.ok()) {
-      if (absl::IsOutOfRange(status_) && vocab_size_ != -1 &&
-          next_id_ != vocab_size_) {
-        status_ = errors::InvalidArgument("Invalid vocab_size in ", filename_,
-                                          ": expected ", vocab_size_,
-                                          " but got ", next_id_);
-      }
-      valid_ = false;
+    if (!pending_status_.ok()) {
+      Finish(pending_status_);
       return;
     }
-    if (vocab_size_ != -1 && next_id_ >= vocab_size_) {
-      LOG(WARNING) << "Truncated " << filename_ << " before its end at "
-                   << vocab_size_ << " records.";
-      LOG(WARNING) << "next_id_  : " << next_id_;
-      status_ = errors::OutOfRange("Finished reading ", vocab_size_,
-                                   " of lines from ", filename_);
-      valid_ = false;
-      return;
+
+    // Reads the lines of the batch. Reading stops at the end of the file, at
+    // the end of the vocabulary, or at an empty line; that status is reported
+    // once the lines read before it are processed.
+    lines_.clear();
+    while (lines_.size() < kLinesPerBatch) {
+      string line;
+      pending_status_ = input_buffer_->ReadLine(&line);
+      if (!pending_status_.ok()) break;
+      const int64_t line_id = next_id_ + lines_.size();
+      if (vocab_size_ != -1 && line_id >= vocab_size_) {
+        LOG(WARNING) << "Truncated " << filename_ << " before its end at "
+                     << vocab_size_ << " records.";
+        LOG(WARNING) << "next_id_  : " << line_id;
+        pending_status_ = errors::OutOfRange(
+            "Finished reading ", vocab_size_, " of lines from ", filename_);
+        break;
+      }
+      if (line.empty()) {
+        pending_status_ = errors::InvalidArgument(
+            "Invalid content in ", filename_, ": empty line found at position ",
+            input_buffer_->Tell(), ".");
+        break;
+      }
+      lines_.push_back(std::move(line));
     }
-    if (line.empty()) {
-      status_ = errors::InvalidArgument("Invalid content in ", filename_,
-                                        ": empty line found at position ",
-                                        input_buffer_->Tell(), ".");
-      valid_ = false;
+    if (lines_.empty()) {
+      Finish(pending_status_);
       return;
     }
 
-    std::vector<string> tokens;
-    if (!ignore_split_) {
-      tokens = str_util::Split(line, delimiter_);
-      const auto expected_size =
-          static_cast<size_t>(std::max(key_index_, value_index_) + 1);
-      if (tokens.size() < expected_size) {
-        status_ = errors::InvalidArgument(
-            "Invalid number of columns in ", filename_, " line ", next_id_,
-            " (", line, ") : expected at least ", expected_size, " got ",
-            tokens.size());
+    const int64_t num_lines = lines_.size();
+    key_ = Tensor(key_dtype_, TensorShape({num_lines}));
+    value_ = Tensor(value_dtype_, TensorShape({num_lines}));
+    std::vector<Status> line_statuses(num_lines);
+    auto parse_lines = [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        line_statuses[i] = ParseLine(i);
+      }
+    };
+    if (worker_threads_ == nullptr) {
+      parse_lines(0, num_lines);
+    } else {
+      Shard(worker_threads_->num_threads, worker_threads_->workers, num_lines,
+            kCostPerLine, parse_lines);
+    }
+    // Reports the error of the first invalid line, if any.
+    for (const Status& line_status : line_statuses) {
+      if (!line_status.ok()) {
+        status_ = line_status;
         valid_ = false;
         return;
       }
     }
-
-    status_ = SetValue(line, tokens, key_index_, &key_);
-    if (!status_.ok()) {
-      valid_ = false;
-      return;
-    }
-    status_ = SetValue(line, tokens, value_index_, &value_);
-    if (!status_.ok()) {
-      valid_ = false;
-      return;
-    }
-
-    next_id_++;
+    next_id_ += num_lines;
   }
 
   bool Valid() const override { return valid_; }
@@ -188,28 +207,70 @@ class TextFileLineIterator
   }
 
  private:
+  static constexpr size_t kLinesPerBatch = 1 << 16;
+  static constexpr int64_t kCostPerLine = 1000;
+
   Tensor key_;
   Tensor value_;
+  DataType key_dtype_;
+  DataType value_dtype_;
   bool valid_;  // true if the iterator points to an existing range.
   int64_t key_index_;
   int64_t value_index_;
   Env* env_;
+  const DeviceBase::CpuWorkerThreads* worker_threads_;
   int64_t next_id_;
   int64_t offset_;
   int64_t vocab_size_;
   string filename_;
   char delimiter_;
   Status status_;
+  // The status that ended the reading of the last batch of lines.
+  Status pending_status_;
   bool ignore_split_;
+  std::vector<string> lines_;
   std::unique_ptr<RandomAccessFile> file_;  // must outlive input_buffer_
   std::unique_ptr<io::InputBuffer> input_buffer_;
 
+  // Ends the iteration with the status that ended the reading of the file.
+  void Finish(const Status& status) {
+    status_ = status;
+    if (absl::IsOutOfRange(status_) && vocab_size_ != -1 &&
+        next_id_ != vocab_size_) {
+      status_ = errors::InvalidArgument("Invalid vocab_size in ", filename_,
+                                        ": expected ", vocab_size_,
+                                        " but got ", next_id_);
+    }
+    valid_ = false;
+  }
+
+  // Parses the i-th line of the batch into the i-th key and value.
+  Status ParseLine(int64_t i) {
+    const string& line = lines_[i];
+    const int64_t line_id = next_id_ + i;
+    std::vector<string> tokens;
+    if (!ignore_split_) {
+      tokens = str_util::Split(line, delimiter_);
+      const auto expected_size =
+          static_cast<size_t>(std::max(key_index_, value_index_) + 1);
+      if (tokens.size() < expected_size) {
+        return errors::InvalidArgument(
+            "Invalid number of columns in ", filename_, " line ", line_id,
+            " (", line, ") : expected at least ", expected_size, " got ",
+            tokens.size());
+      }
+    }
+    TF_RETURN_IF_ERROR(SetValue(line, tokens, key_index_, line_id, i, &key_));
+    return SetValue(line, tokens, value_index_, line_id, i, &value_);
+  }
+
   // Set the corresponding value from line or tokens based on 'index' into the
-  // tensor 't'. The value is transformed to the given data type 'dtype'.
+  // i-th element of the tensor 't'. The value is transformed to the given data
+  // type 'dtype'.
   Status SetValue(const string& line, const std::vector<string>& tokens,
-                  int64_t index, Tensor* tensor) {
+                  int64_t index, int64_t line_id, int64_t i, Tensor* tensor) {
     if (index == kLineNumber) {
-      tensor->flat<int64_t>()(0) = next_id_ + offset_;
+      tensor->flat<int64_t>()(i) = line_id + offset_;
       return absl::OkStatus();
     }
     const string& token = (index == kWholeLine) ? line : tokens[index];
@@ -218,44 +279,39 @@ class TextFileLineIterator
       case DT_INT32: {
         int32_t value;
         if (!strings::safe_strto32(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
+          return errors::InvalidArgument("Field ", token, " in line ", line_id,
                                          " is not a valid int32.");
         }
-        tensor->flat<int32>()(0) = value + offset_;
+        tensor->flat<int32>()(i) = value + offset_;
       } break;
       case DT_INT64: {
         int64_t value;
         if (!strings::safe_strto64(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
+          return errors::InvalidArgument("Field ", token, " in line ", line_id,
                                          " is not a valid int64.");
         }
-        tensor->flat<int64_t>()(0) = value;
+        tensor->flat<int64_t>()(i) = value;
       } break;
       case DT_FLOAT: {
         float value;
         if (!strings::safe_strtof(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
+          return errors::InvalidArgument("Field ", token, " in line ", line_id,
                                          " is not a valid float.");
         }
-        tensor->flat<float>()(0) = value;
+        tensor->flat<float>()(i) = value;
       } break;
       case DT_DOUBLE: {
         double value;
         if (!strings::safe_strtod(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
+          return errors::InvalidArgument("Field ", token, " in line ", line_id,
                                          " is not a valid double.");
         }
-        tensor->flat<double>()(0) = value;
+        tensor->flat<double>()(i) = value;
       } break;
       case DT_STRING:
-        tensor->flat<tstring>()(0) = token;
+        tensor->flat<tstring>()(i) = token;
         break;
       default:
-        valid_ = false;
         return errors::InvalidArgument("Data type ", DataTypeString(dtype),
                                        " not supported.");
     }
@@ -375,6 +431,18 @@ Status InitializeTableFromTextFile(
     int32_t key_index, int32_t value_index, int64_t offset, Env* env,
     std::unique_ptr<InitializableLookupTable::InitializerSerializer> serializer,
     InitializableLookupTable* table) {
+  return InitializeTableFromTextFile(filename, vocab_size, delimiter, key_index,
+                                     value_index, offset, env,
+                                     /*worker_threads=*/nullptr,
+                                     std::move(serializer), table);
+}
+
+Status InitializeTableFromTextFile(
+    const string& filename, int64_t vocab_size, char delimiter,
+    int32_t key_index, int32_t value_index, int64_t offset, Env* env,
+    const DeviceBase::CpuWorkerThreads* worker_threads,
+    std::unique_ptr<InitializableLookupTable::InitializerSerializer> serializer,
+    InitializableLookupTable* table) {
   if (key_index == kLineNumber && table->key_dtype() != DT_INT64) {
     return errors::InvalidArgument(
         "Key index for line number requires table key dtype of int64, got ",
@@ -404,7 +472,7 @@ Status InitializeTableFromTextFile(
   TextFileLineIterator iter;
   TF_RETURN_IF_ERROR(iter.Init(filename, vocab_size, delimiter, key_dtype,
                                key_index, value_dtype, value_index, offset,
-                               env));
+                               env, worker_threads));
   // For initialization from files, ignore if the table is already
   // initialized. The table shared name should contain the filename to
   // avoid trying to initialize the same table from the same file at the same
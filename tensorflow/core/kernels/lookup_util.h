@@ -65,6 +65,15 @@ Status InitializeTableFromTextFile(
     std::unique_ptr<InitializableLookupTable::InitializerSerializer> serializer,
     InitializableLookupTable* table);
 
+// Same as above, but if `worker_threads` is not null, the lines of the file
+// are parsed in parallel on them, batch by batch.
+Status InitializeTableFromTextFile(
+    const string& filename, int64_t vocab_size, char delimiter,
+    int32_t key_index, int32_t value_index, int64_t offset, Env* env,
+    const DeviceBase::CpuWorkerThreads* worker_threads,
+    std::unique_ptr<InitializableLookupTable::InitializerSerializer> serializer,
+    InitializableLookupTable* table);
+
 }  // namespace lookup
 }  // namespace tensorflow
 
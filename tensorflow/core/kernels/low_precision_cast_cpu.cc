@@ -0,0 +1,436 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/low_precision_cast_cpu.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "tensorflow/core/platform/cpu_info.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define TF_LOW_PRECISION_CAST_X86 1
+#endif
+
+namespace tensorflow {
+namespace {
+
+static_assert(sizeof(bfloat16) == 2 && sizeof(Eigen::half) == 2,
+              "16-bit types must be stored in two bytes");
+static_assert(sizeof(float8_e4m3fn) == 1 && sizeof(float8_e5m2) == 1,
+              "float8 types must be stored in one byte");
+
+inline uint32_t FloatToBits(float f) {
+  uint32_t u;
+  std::memcpy(&u, &f, sizeof(u));
+  return u;
+}
+
+inline float BitsToFloat(uint32_t u) {
+  float f;
+  std::memcpy(&f, &u, sizeof(f));
+  return f;
+}
+
+// The float8 formats. Codes are the 7 bits below the sign bit.
+struct E4m3fn {
+  static constexpr int kMantissaBits = 3;
+  static constexpr int kBias = 7;
+  static constexpr uint32_t kMaxCode = 0x7e;  // 448
+  // There is no infinity, and values that overflow become NaN.
+  static constexpr uint32_t kOverflowCode = 0x7f;
+  static constexpr uint32_t kNanCode = 0x7f;
+  static constexpr bool kHasInfinity = false;
+};
+
+struct E5m2 {
+  static constexpr int kMantissaBits = 2;
+  static constexpr int kBias = 15;
+  static constexpr uint32_t kMaxCode = 0x7b;  // 57344
+  static constexpr uint32_t kOverflowCode = 0x7c;  // Infinity.
+  static constexpr uint32_t kNanCode = 0x7e;
+  static constexpr bool kHasInfinity = true;
+};
+
+template <typename F>
+struct Float8 {
+  // The number of mantissa bits that are dropped from a float.
+  static constexpr int kShift = 23 - F::kMantissaBits;
+  // The difference between float and float8 codes of normal numbers.
+  static constexpr uint32_t kRebias = (127 - F::kBias) << F::kMantissaBits;
+  // The bits of the smallest normal and of the largest finite float8, as
+  // floats.
+  static constexpr uint32_t kMinNormalBits = (128u - F::kBias) << 23;
+  static constexpr uint32_t kMaxBits = (F::kMaxCode + kRebias) << kShift;
+  // A float with a biased exponent e >= 1 and a 24-bit mantissa m is a
+  // subnormal float8 with the code m >> (kSubnormalShift - e), rounded.
+  static constexpr uint32_t kSubnormalShift = 151 - F::kBias - F::kMantissaBits;
+  // The value of the subnormal code 1.
+  static constexpr uint32_t kSubnormalUnitBits =
+      (128u - F::kBias - F::kMantissaBits) << 23;
+
+  // Returns the code of the float with the bits `a`, which has no sign.
+  static uint32_t Encode(uint32_t a) {
+    if (a > 0x7f800000u) return F::kNanCode;
+    if (a >= kMinNormalBits) {
+      // Rounding the bits to nearest even rounds the value, and carries into
+      // the exponent if needed.
+      const uint32_t code =
+          ((a + (1u << (kShift - 1)) - 1 + ((a >> kShift) & 1)) >> kShift) -
+          kRebias;
+      return code > F::kMaxCode ? F::kOverflowCode : code;
+    }
+    const uint32_t exponent = std::max(a >> 23, 1u);
+    const uint32_t mantissa = (a >> 23) ? (a & 0x7fffff) | 0x800000 : a;
+    const uint32_t shift = kSubnormalShift - exponent;
+    if (shift >= 32) return 0;
+    return (mantissa + (1u << (shift - 1)) - 1 + ((mantissa >> shift) & 1)) >>
+           shift;
+  }
+
+  // Returns the bits of the float with the code `code`.
+  static uint32_t Decode(uint32_t code) {
+    if (code > F::kMaxCode) {
+      return F::kHasInfinity && code == F::kOverflowCode ? 0x7f800000u
+                                                         : 0x7fc00000u;
+    }
+    if (code < (1u << F::kMantissaBits)) {
+      return FloatToBits(static_cast<float>(code) *
+                         BitsToFloat(kSubnormalUnitBits));
+    }
+    return (code + kRebias) << kShift;
+  }
+
+  static uint8_t FromFloat(float f, bool saturate) {
+    const uint32_t u = FloatToBits(f);
+    uint32_t a = u & 0x7fffffff;
+    if (saturate && a <= 0x7f800000u) a = std::min(a, kMaxBits);
+    return ((u >> 24) & 0x80) | Encode(a);
+  }
+
+  // The floats of all codes, sign included.
+  static const float* Table() {
+    static const float* table = [] {
+      float* table = new float[256];
+      for (uint32_t i = 0; i < 256; ++i) {
+        table[i] = BitsToFloat(((i & 0x80) << 24) | Decode(i & 0x7f));
+      }
+      return table;
+    }();
+    return table;
+  }
+};
+
+template <typename F>
+void FloatToFloat8Portable(const float* in, float scale, bool saturate,
+                           uint8_t* out, int64_t n) {
+  for (int64_t i = 0; i < n; ++i) {
+    out[i] = Float8<F>::FromFloat(in[i] * scale, saturate);
+  }
+}
+
+template <typename F>
+void Float8ToFloatPortable(const uint8_t* in, float* out, int64_t n) {
+  const float* table = Float8<F>::Table();
+  for (int64_t i = 0; i < n; ++i) out[i] = table[in[i]];
+}
+
+#if defined(TF_LOW_PRECISION_CAST_X86)
+
+// The AVX512 loops convert 16 elements at a time and leave the remaining
+// elements to the portable loops.
+
+__attribute__((target("avx512f"))) int64_t FloatToBfloat16Avx512(
+    const float* in, uint16_t* out, int64_t n) {
+  const __m512i one = _mm512_set1_epi32(1);
+  const __m512i rounding = _mm512_set1_epi32(0x7fff);
+  const __m512i sign = _mm512_set1_epi32(0x8000);
+  const __m512i nan = _mm512_set1_epi32(0x7fc0);
+  int64_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m512 x = _mm512_loadu_ps(in + i);
+    const __m512i u = _mm512_castps_si512(x);
+    const __m512i high = _mm512_srli_epi32(u, 16);
+    __m512i r = _mm512_srli_epi32(
+        _mm512_add_epi32(_mm512_add_epi32(u, rounding),
+                         _mm512_and_si512(high, one)),
+        16);
+    const __mmask16 is_nan = _mm512_cmp_ps_mask(x, x, _CMP_UNORD_Q);
+    r = _mm512_mask_mov_epi32(
+        r, is_nan, _mm512_or_si512(_mm512_and_si512(high, sign), nan));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+                        _mm512_cvtepi32_epi16(r));
+  }
+  return i;
+}
+
+__attribute__((target("avx512f"))) int64_t Bfloat16ToFloatAvx512(
+    const uint16_t* in, float* out, int64_t n) {
+  int64_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m512i u = _mm512_cvtepu16_epi32(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i)));
+    _mm512_storeu_si512(out + i, _mm512_slli_epi32(u, 16));
+  }
+  return i;
+}
+
+__attribute__((target("avx,f16c"))) int64_t FloatToHalfF16c(const float* in,
+                                                            uint16_t* out,
+                                                            int64_t n) {
+  int64_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(out + i),
+        _mm256_cvtps_ph(_mm256_loadu_ps(in + i),
+                        _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+  }
+  return i;
+}
+
+__attribute__((target("avx,f16c"))) int64_t HalfToFloatF16c(
+    const uint16_t* in, float* out, int64_t n) {
+  int64_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    _mm256_storeu_ps(out + i,
+                     _mm256_cvtph_ps(_mm_loadu_si128(
+                         reinterpret_cast<const __m128i*>(in + i))));
+  }
+  return i;
+}
+
+// Vector versions of Float8<F>::FromFloat and Float8<F>::Decode.
+template <typename F>
+__attribute__((target("avx512f"))) int64_t FloatToFloat8Avx512(
+    const float* in, float scale, bool saturate, uint8_t* out, int64_t n) {
+  using T = Float8<F>;
+  const __m512i one = _mm512_set1_epi32(1);
+  const __m512i magnitude = _mm512_set1_epi32(0x7fffffff);
+  const __m512i infinity = _mm512_set1_epi32(0x7f800000);
+  const __m512i max_bits = _mm512_set1_epi32(T::kMaxBits);
+  const __m512i min_normal_bits = _mm512_set1_epi32(T::kMinNormalBits);
+  const __m512i rounding = _mm512_set1_epi32((1u << (T::kShift - 1)) - 1);
+  const __m512i rebias = _mm512_set1_epi32(T::kRebias);
+  const __m512i max_code = _mm512_set1_epi32(F::kMaxCode);
+  const __m512i overflow_code = _mm512_set1_epi32(F::kOverflowCode);
+  const __m512i nan_code = _mm512_set1_epi32(F::kNanCode);
+  const __m512i implicit_bit = _mm512_set1_epi32(0x800000);
+  const __m512i mantissa_mask = _mm512_set1_epi32(0x7fffff);
+  const __m512i subnormal_shift = _mm512_set1_epi32(T::kSubnormalShift);
+  const __m512i sign_bit = _mm512_set1_epi32(0x80);
+  const __m512 scale_v = _mm512_set1_ps(scale);
+  int64_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m512i u =
+        _mm512_castps_si512(_mm512_mul_ps(_mm512_loadu_ps(in + i), scale_v));
+    __m512i a = _mm512_and_si512(u, magnitude);
+    const __mmask16 is_nan = _mm512_cmpgt_epu32_mask(a, infinity);
+    if (saturate) a = _mm512_mask_min_epu32(a, ~is_nan, a, max_bits);
+
+    __m512i normal = _mm512_add_epi32(
+        _mm512_add_epi32(a, rounding),
+        _mm512_and_si512(_mm512_srli_epi32(a, T::kShift), one));
+    normal = _mm512_sub_epi32(_mm512_srli_epi32(normal, T::kShift), rebias);
+    normal = _mm512_mask_mov_epi32(
+        normal, _mm512_cmpgt_epu32_mask(normal, max_code), overflow_code);
+
+    // Variable shifts by 32 or more produce zero, as needed for the tiny
+    // values whose shift is that large.
+    const __m512i exponent = _mm512_srli_epi32(a, 23);
+    const __mmask16 is_float_subnormal =
+        _mm512_cmpeq_epi32_mask(exponent, _mm512_setzero_si512());
+    const __m512i mantissa = _mm512_mask_mov_epi32(
+        _mm512_or_si512(_mm512_and_si512(a, mantissa_mask), implicit_bit),
+        is_float_subnormal, a);
+    const __m512i shift =
+        _mm512_sub_epi32(subnormal_shift, _mm512_max_epu32(exponent, one));
+    __m512i subnormal = _mm512_add_epi32(
+        _mm512_add_epi32(
+            mantissa,
+            _mm512_sub_epi32(
+                _mm512_sllv_epi32(one, _mm512_sub_epi32(shift, one)), one)),
+        _mm512_and_si512(_mm512_srlv_epi32(mantissa, shift), one));
+    subnormal = _mm512_srlv_epi32(subnormal, shift);
+
+    __m512i code = _mm512_mask_mov_epi32(
+        subnormal, _mm512_cmpge_epu32_mask(a, min_normal_bits), normal);
+    code = _mm512_mask_mov_epi32(code, is_nan, nan_code);
+    code = _mm512_or_si512(
+        code, _mm512_and_si512(_mm512_srli_epi32(u, 24), sign_bit));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+                     _mm512_cvtepi32_epi8(code));
+  }
+  return i;
+}
+
+template <typename F>
+__attribute__((target("avx512f"))) int64_t Float8ToFloatAvx512(
+    const uint8_t* in, float* out, int64_t n) {
+  using T = Float8<F>;
+  const __m512i code_mask = _mm512_set1_epi32(0x7f);
+  const __m512i sign_bit = _mm512_set1_epi32(0x80);
+  const __m512i rebias = _mm512_set1_epi32(T::kRebias);
+  const __m512i min_normal_code = _mm512_set1_epi32(1u << F::kMantissaBits);
+  const __m512i max_code = _mm512_set1_epi32(F::kMaxCode);
+  const __m512i overflow_code = _mm512_set1_epi32(F::kOverflowCode);
+  const __m512i nan = _mm512_set1_epi32(0x7fc00000);
+  const __m512i infinity = _mm512_set1_epi32(0x7f800000);
+  const __m512 subnormal_unit =
+      _mm512_set1_ps(BitsToFloat(T::kSubnormalUnitBits));
+  int64_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m512i v = _mm512_cvtepu8_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)));
+    const __m512i code = _mm512_and_si512(v, code_mask);
+    __m512i bits =
+        _mm512_slli_epi32(_mm512_add_epi32(code, rebias), T::kShift);
+    bits = _mm512_mask_mov_epi32(
+        bits, _mm512_cmplt_epu32_mask(code, min_normal_code),
+        _mm512_castps_si512(
+            _mm512_mul_ps(_mm512_cvtepi32_ps(code), subnormal_unit)));
+    bits = _mm512_mask_mov_epi32(
+        bits, _mm512_cmpgt_epu32_mask(code, max_code), nan);
+    if (F::kHasInfinity) {
+      bits = _mm512_mask_mov_epi32(
+          bits, _mm512_cmpeq_epi32_mask(code, overflow_code), infinity);
+    }
+    bits = _mm512_or_si512(
+        bits, _mm512_slli_epi32(_mm512_and_si512(v, sign_bit), 24));
+    _mm512_storeu_si512(out + i, bits);
+  }
+  return i;
+}
+
+#endif  // TF_LOW_PRECISION_CAST_X86
+
+bool HasAvx512() {
+  static const bool has_avx512 =
+      port::TestCPUFeature(port::CPUFeature::AVX512F);
+  return has_avx512;
+}
+
+bool HasF16c() {
+  static const bool has_f16c = port::TestCPUFeature(port::CPUFeature::AVX) &&
+                               port::TestCPUFeature(port::CPUFeature::F16C);
+  return has_f16c;
+}
+
+template <typename F>
+void FloatToFloat8(const float* in, float scale, bool saturate, uint8_t* out,
+                   int64_t n) {
+  int64_t i = 0;
+#if defined(TF_LOW_PRECISION_CAST_X86)
+  if (HasAvx512()) i = FloatToFloat8Avx512<F>(in, scale, saturate, out, n);
+#endif
+  FloatToFloat8Portable<F>(in + i, scale, saturate, out + i, n - i);
+}
+
+template <typename F>
+void Float8ToFloat(const uint8_t* in, float* out, int64_t n) {
+  int64_t i = 0;
+#if defined(TF_LOW_PRECISION_CAST_X86)
+  if (HasAvx512()) i = Float8ToFloatAvx512<F>(in, out, n);
+#endif
+  Float8ToFloatPortable<F>(in + i, out + i, n - i);
+}
+
+template <typename T>
+uint8_t* Bytes(T* x) {
+  return reinterpret_cast<uint8_t*>(x);
+}
+
+template <typename T>
+const uint8_t* Bytes(const T* x) {
+  return reinterpret_cast<const uint8_t*>(x);
+}
+
+}  // namespace
+
+void LowPrecisionCast(const float* in, bfloat16* out, int64_t n) {
+  int64_t i = 0;
+#if defined(TF_LOW_PRECISION_CAST_X86)
+  if (HasAvx512()) {
+    i = FloatToBfloat16Avx512(in, reinterpret_cast<uint16_t*>(out), n);
+  }
+#endif
+  for (; i < n; ++i) out[i] = static_cast<bfloat16>(in[i]);
+}
+
+void LowPrecisionCast(const bfloat16* in, float* out, int64_t n) {
+  int64_t i = 0;
+#if defined(TF_LOW_PRECISION_CAST_X86)
+  if (HasAvx512()) {
+    i = Bfloat16ToFloatAvx512(reinterpret_cast<const uint16_t*>(in), out, n);
+  }
+#endif
+  for (; i < n; ++i) out[i] = static_cast<float>(in[i]);
+}
+
+void LowPrecisionCast(const float* in, Eigen::half* out, int64_t n) {
+  int64_t i = 0;
+#if defined(TF_LOW_PRECISION_CAST_X86)
+  if (HasF16c()) i = FloatToHalfF16c(in, reinterpret_cast<uint16_t*>(out), n);
+#endif
+  for (; i < n; ++i) out[i] = static_cast<Eigen::half>(in[i]);
+}
+
+void LowPrecisionCast(const Eigen::half* in, float* out, int64_t n) {
+  int64_t i = 0;
+#if defined(TF_LOW_PRECISION_CAST_X86)
+  if (HasF16c()) {
+    i = HalfToFloatF16c(reinterpret_cast<const uint16_t*>(in), out, n);
+  }
+#endif
+  for (; i < n; ++i) out[i] = static_cast<float>(in[i]);
+}
+
+void LowPrecisionCast(const float* in, float8_e4m3fn* out, int64_t n) {
+  FloatToFloat8<E4m3fn>(in, 1.0f, /*saturate=*/false, Bytes(out), n);
+}
+
+void LowPrecisionCast(const float8_e4m3fn* in, float* out, int64_t n) {
+  Float8ToFloat<E4m3fn>(Bytes(in), out, n);
+}
+
+void LowPrecisionCast(const float* in, float8_e5m2* out, int64_t n) {
+  FloatToFloat8<E5m2>(in, 1.0f, /*saturate=*/false, Bytes(out), n);
+}
+
+void LowPrecisionCast(const float8_e5m2* in, float* out, int64_t n) {
+  Float8ToFloat<E5m2>(Bytes(in), out, n);
+}
+
+void ScaleAndCast(const float* in, float scale, float8_e4m3fn* out,
+                  int64_t n) {
+  FloatToFloat8<E4m3fn>(in, scale, /*saturate=*/true, Bytes(out), n);
+}
+
+void ScaleAndCast(const float* in, float scale, float8_e5m2* out, int64_t n) {
+  FloatToFloat8<E5m2>(in, scale, /*saturate=*/true, Bytes(out), n);
+}
+
+void ScaleAndCast(const float* in, float scale, int4* out, int64_t n) {
+  for (int64_t i = 0; i < n; ++i) {
+    float x = in[i] * scale;
+    if (std::isnan(x)) x = 0.0f;
+    x = std::min(std::max(x, -8.0f), 7.0f);
+    out[i] = static_cast<int4>(static_cast<int8_t>(std::nearbyint(x)));
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,61 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_LOW_PRECISION_CAST_CPU_H_
+#define TENSORFLOW_CORE_KERNELS_LOW_PRECISION_CAST_CPU_H_
+
+// Conversions between float and the narrow types used for low-precision
+// storage and quantization on CPU.
+//
+// Eigen converts to and from float8 one element at a time, and only uses F16C
+// for half when TensorFlow is compiled for it. The loops below are selected at
+// runtime from the features of the CPU:
+//
+//   * half uses F16C (VCVTPS2PH, VCVTPH2PS),
+//   * bfloat16 and float8 use AVX512F integer arithmetic,
+//
+// and portable loops otherwise, which compilers vectorize for NEON. All of
+// them round to nearest even and return the same values as the conversions
+// of the types themselves; only the payloads of NaNs may differ.
+
+#include <cstdint>
+
+#include "Eigen/Core"  // from @eigen_archive
+#include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+void LowPrecisionCast(const float* in, bfloat16* out, int64_t n);
+void LowPrecisionCast(const bfloat16* in, float* out, int64_t n);
+void LowPrecisionCast(const float* in, Eigen::half* out, int64_t n);
+void LowPrecisionCast(const Eigen::half* in, float* out, int64_t n);
+void LowPrecisionCast(const float* in, float8_e4m3fn* out, int64_t n);
+void LowPrecisionCast(const float8_e4m3fn* in, float* out, int64_t n);
+void LowPrecisionCast(const float* in, float8_e5m2* out, int64_t n);
+void LowPrecisionCast(const float8_e5m2* in, float* out, int64_t n);
+
+// Quantizes `in` with `scale`: out[i] = in[i] * scale, rounded to nearest even
+// and saturated to the finite range of the output type, instead of
+// overflowing to infinity or NaN. NaNs stay NaNs for float8 and become zero
+// for int4.
+void ScaleAndCast(const float* in, float scale, float8_e4m3fn* out,
+                  int64_t n);
+void ScaleAndCast(const float* in, float scale, float8_e5m2* out, int64_t n);
+void ScaleAndCast(const float* in, float scale, int4* out, int64_t n);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_LOW_PRECISION_CAST_CPU_H_
@@ -0,0 +1,130 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/low_precision_cast_cpu.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+float FromBits(uint32_t bits) {
+  float f;
+  std::memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+template <typename T>
+bool SameValue(T a, T b) {
+  if (Eigen::numext::isnan(a)) return Eigen::numext::isnan(b);
+  return std::memcmp(&a, &b, sizeof(T)) == 0;
+}
+
+// Floats of all magnitudes, special values, and the float8 rounding
+// boundaries, in an odd number so that the vector loops have remainders.
+std::vector<float> TestFloats() {
+  std::vector<float> floats = {0.0f,
+                               -0.0f,
+                               std::numeric_limits<float>::infinity(),
+                               -std::numeric_limits<float>::infinity(),
+                               std::numeric_limits<float>::quiet_NaN(),
+                               std::numeric_limits<float>::denorm_min(),
+                               448.0f,
+                               464.0f,
+                               465.0f,
+                               57344.0f,
+                               61440.0f,
+                               -61441.0f};
+  for (int code = 0; code < 256; ++code) {
+    for (float offset : {-0.5f, 0.0f, 0.5f}) {
+      floats.push_back(std::ldexp(1.0f + offset / 8, code - 140));
+      floats.push_back(std::ldexp(static_cast<float>(code) + offset, -9));
+      floats.push_back(std::ldexp(static_cast<float>(code) + offset, -16));
+    }
+  }
+  std::mt19937 gen(42);
+  for (int i = 0; i < 100001; ++i) floats.push_back(FromBits(gen()));
+  return floats;
+}
+
+template <typename T>
+void CheckRoundTrip() {
+  const std::vector<float> floats = TestFloats();
+  const int64_t n = floats.size();
+  std::vector<T> narrow(n);
+  LowPrecisionCast(floats.data(), narrow.data(), n);
+  for (int64_t i = 0; i < n; ++i) {
+    ASSERT_TRUE(SameValue(narrow[i], static_cast<T>(floats[i])))
+        << floats[i] << " " << static_cast<float>(narrow[i]);
+  }
+  std::vector<float> wide(n);
+  LowPrecisionCast(narrow.data(), wide.data(), n);
+  for (int64_t i = 0; i < n; ++i) {
+    ASSERT_TRUE(SameValue(wide[i], static_cast<float>(narrow[i])))
+        << static_cast<float>(narrow[i]) << " " << wide[i];
+  }
+}
+
+TEST(LowPrecisionCastTest, Bfloat16) { CheckRoundTrip<bfloat16>(); }
+
+TEST(LowPrecisionCastTest, Half) { CheckRoundTrip<Eigen::half>(); }
+
+TEST(LowPrecisionCastTest, Float8e4m3fn) { CheckRoundTrip<float8_e4m3fn>(); }
+
+TEST(LowPrecisionCastTest, Float8e5m2) { CheckRoundTrip<float8_e5m2>(); }
+
+template <typename T>
+void CheckScaleAndCast(float scale) {
+  const std::vector<float> floats = TestFloats();
+  const int64_t n = floats.size();
+  std::vector<T> narrow(n);
+  ScaleAndCast(floats.data(), scale, narrow.data(), n);
+  const float max = static_cast<float>(std::numeric_limits<T>::max());
+  for (int64_t i = 0; i < n; ++i) {
+    float x = floats[i] * scale;
+    if (!std::isnan(x)) x = std::min(std::max(x, -max), max);
+    ASSERT_TRUE(SameValue(narrow[i], static_cast<T>(x))) << floats[i];
+  }
+}
+
+TEST(LowPrecisionCastTest, ScaleAndCastFloat8) {
+  for (float scale : {1.0f, 0.25f, 1000.0f}) {
+    CheckScaleAndCast<float8_e4m3fn>(scale);
+    CheckScaleAndCast<float8_e5m2>(scale);
+  }
+}
+
+TEST(LowPrecisionCastTest, ScaleAndCastInt4) {
+  const std::vector<float> floats = {0.0f,  0.2f,  0.3f,  0.5f,  0.7f,
+                                     -0.7f, 1.2f,  3.4f,  3.6f,  -4.0f,
+                                     -4.1f, 10.0f, -9.0f, std::nanf("")};
+  const std::vector<int> expected = {0, 0, 1, 1, 1, -1, 2, 7, 7, -8, -8, 7,
+                                     -8, 0};
+  std::vector<int4> narrow(floats.size());
+  ScaleAndCast(floats.data(), 2.0f, narrow.data(), floats.size());
+  for (size_t i = 0; i < floats.size(); ++i) {
+    EXPECT_EQ(static_cast<int>(narrow[i]), expected[i]) << floats[i];
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
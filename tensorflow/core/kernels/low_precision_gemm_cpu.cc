@@ -0,0 +1,581 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/low_precision_gemm_cpu.h"
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+#include "tensorflow/core/platform/cpu_info.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define TF_LOW_PRECISION_GEMM_X86 1
+#endif
+
+namespace tensorflow {
+namespace {
+
+// Every micro-kernel call computes a tile of kMr rows and kNr columns. The
+// packed right-hand side is split into strips of kNr columns.
+constexpr int64_t kMr = 6;
+constexpr int64_t kNr = 32;
+// Rows of the left-hand side are packed in blocks of kMb rows, and results are
+// passed to the output callback in blocks of kMb x kNc.
+constexpr int64_t kMb = 8 * kMr;
+constexpr int64_t kNc = 4 * kNr;
+
+int64_t CeilDiv(int64_t a, int64_t b) { return (a + b - 1) / b; }
+
+// Computes the `rows` x kNr tile `c` (with leading dimension `ldc`) of the
+// product of `rows` <= kMr packed rows of `a` (with leading dimension `lda`)
+// and a strip of the packed right-hand side `b`, with an inner dimension of
+// `depth` groups of 1 float, 2 bfloat16 values or 4 bytes.
+using F32Kernel = void (*)(const float* a, int64_t lda, int64_t rows,
+                           const float* b, int64_t depth, float* c,
+                           int64_t ldc);
+using Bf16Kernel = void (*)(const bfloat16* a, int64_t lda, int64_t rows,
+                            const bfloat16* b, int64_t depth, float* c,
+                            int64_t ldc);
+using Int8Kernel = void (*)(const uint8* a, int64_t lda, int64_t rows,
+                            const int8* b, int64_t depth, int32* c,
+                            int64_t ldc);
+
+void F32KernelScalar(const float* a, int64_t lda, int64_t rows,
+                     const float* b, int64_t depth, float* c, int64_t ldc) {
+  for (int64_t r = 0; r < rows; ++r) {
+    for (int64_t j = 0; j < kNr; ++j) {
+      float sum = 0;
+      for (int64_t p = 0; p < depth; ++p) {
+        sum += a[r * lda + p] * b[p * kNr + j];
+      }
+      c[r * ldc + j] = sum;
+    }
+  }
+}
+
+void Bf16KernelScalar(const bfloat16* a, int64_t lda, int64_t rows,
+                      const bfloat16* b, int64_t depth, float* c,
+                      int64_t ldc) {
+  for (int64_t r = 0; r < rows; ++r) {
+    for (int64_t j = 0; j < kNr; ++j) {
+      float sum = 0;
+      for (int64_t p = 0; p < depth; ++p) {
+        const bfloat16* bp = b + (p * kNr + j) * 2;
+        sum += static_cast<float>(a[r * lda + 2 * p]) *
+                   static_cast<float>(bp[0]) +
+               static_cast<float>(a[r * lda + 2 * p + 1]) *
+                   static_cast<float>(bp[1]);
+      }
+      c[r * ldc + j] = sum;
+    }
+  }
+}
+
+void Int8KernelScalar(const uint8* a, int64_t lda, int64_t rows,
+                      const int8* b, int64_t depth, int32* c, int64_t ldc) {
+  for (int64_t r = 0; r < rows; ++r) {
+    for (int64_t j = 0; j < kNr; ++j) {
+      int32 sum = 0;
+      for (int64_t q = 0; q < depth; ++q) {
+        for (int h = 0; h < 4; ++h) {
+          sum += static_cast<int32>(a[r * lda + 4 * q + h]) *
+                 static_cast<int32>(b[(q * kNr + j) * 4 + h]);
+        }
+      }
+      c[r * ldc + j] = sum;
+    }
+  }
+}
+
+#if defined(TF_LOW_PRECISION_GEMM_X86)
+
+// Each group of the packed right-hand side is two vectors of 16 columns: the
+// kernels broadcast a group of `a` to all lanes and accumulate products of 1
+// float, or dot products of 2 bfloat16 values (4 bytes), per lane into
+// kRows x 2 accumulators. The number of rows is a template argument so that
+// the accumulators stay in registers, and tiles with fewer than kMr rows
+// (e.g. the single row of a batch of 1) do not pay for padding rows. Short
+// tiles accumulate alternating groups into kSets sets of accumulators, which
+// are summed at the end, so that there are always enough independent chains
+// to hide the latency of the multiply-adds.
+
+template <int kRows>
+constexpr int NumAccumulatorSets() {
+  return kRows < 3 ? 4 / kRows : 1;
+}
+
+template <int kRows>
+__attribute__((target("avx512f"))) void F32TileAvx512(
+    const float* a, int64_t lda, const float* b, int64_t depth, float* c,
+    int64_t ldc) {
+  constexpr int kSets = NumAccumulatorSets<kRows>();
+  __m512 acc[kSets][kRows][2];
+  for (int s = 0; s < kSets; ++s) {
+    for (int r = 0; r < kRows; ++r) {
+      acc[s][r][0] = _mm512_setzero_ps();
+      acc[s][r][1] = _mm512_setzero_ps();
+    }
+  }
+  for (int64_t p0 = 0; p0 < depth; p0 += kSets) {
+    for (int s = 0; s < kSets && p0 + s < depth; ++s) {
+      const int64_t p = p0 + s;
+      const __m512 b0 = _mm512_loadu_ps(b + p * kNr);
+      const __m512 b1 = _mm512_loadu_ps(b + p * kNr + 16);
+      for (int r = 0; r < kRows; ++r) {
+        const __m512 ar = _mm512_set1_ps(a[r * lda + p]);
+        acc[s][r][0] = _mm512_fmadd_ps(ar, b0, acc[s][r][0]);
+        acc[s][r][1] = _mm512_fmadd_ps(ar, b1, acc[s][r][1]);
+      }
+    }
+  }
+  for (int r = 0; r < kRows; ++r) {
+    for (int s = 1; s < kSets; ++s) {
+      acc[0][r][0] = _mm512_add_ps(acc[0][r][0], acc[s][r][0]);
+      acc[0][r][1] = _mm512_add_ps(acc[0][r][1], acc[s][r][1]);
+    }
+    _mm512_storeu_ps(c + r * ldc, acc[0][r][0]);
+    _mm512_storeu_ps(c + r * ldc + 16, acc[0][r][1]);
+  }
+}
+
+template <int kRows>
+__attribute__((target("avx512f,avx512bw,avx512bf16"))) void Bf16TileAvx512(
+    const bfloat16* a, int64_t lda, const bfloat16* b, int64_t depth,
+    float* c, int64_t ldc) {
+  constexpr int kSets = NumAccumulatorSets<kRows>();
+  __m512 acc[kSets][kRows][2];
+  for (int s = 0; s < kSets; ++s) {
+    for (int r = 0; r < kRows; ++r) {
+      acc[s][r][0] = _mm512_setzero_ps();
+      acc[s][r][1] = _mm512_setzero_ps();
+    }
+  }
+  for (int64_t p0 = 0; p0 < depth; p0 += kSets) {
+    for (int s = 0; s < kSets && p0 + s < depth; ++s) {
+      const int64_t p = p0 + s;
+      const __m512bh b0 = (__m512bh)_mm512_loadu_si512(b + p * 2 * kNr);
+      const __m512bh b1 =
+          (__m512bh)_mm512_loadu_si512(b + p * 2 * kNr + kNr);
+      for (int r = 0; r < kRows; ++r) {
+        int32_t pair;
+        std::memcpy(&pair, a + r * lda + 2 * p, sizeof(pair));
+        const __m512bh ar = (__m512bh)_mm512_set1_epi32(pair);
+        acc[s][r][0] = _mm512_dpbf16_ps(acc[s][r][0], ar, b0);
+        acc[s][r][1] = _mm512_dpbf16_ps(acc[s][r][1], ar, b1);
+      }
+    }
+  }
+  for (int r = 0; r < kRows; ++r) {
+    for (int s = 1; s < kSets; ++s) {
+      acc[0][r][0] = _mm512_add_ps(acc[0][r][0], acc[s][r][0]);
+      acc[0][r][1] = _mm512_add_ps(acc[0][r][1], acc[s][r][1]);
+    }
+    _mm512_storeu_ps(c + r * ldc, acc[0][r][0]);
+    _mm512_storeu_ps(c + r * ldc + 16, acc[0][r][1]);
+  }
+}
+
+template <int kRows>
+__attribute__((target("avx512f,avx512bw,avx512vnni"))) void Int8TileAvx512(
+    const uint8* a, int64_t lda, const int8* b, int64_t depth, int32* c,
+    int64_t ldc) {
+  constexpr int kSets = NumAccumulatorSets<kRows>();
+  __m512i acc[kSets][kRows][2];
+  for (int s = 0; s < kSets; ++s) {
+    for (int r = 0; r < kRows; ++r) {
+      acc[s][r][0] = _mm512_setzero_si512();
+      acc[s][r][1] = _mm512_setzero_si512();
+    }
+  }
+  for (int64_t q0 = 0; q0 < depth; q0 += kSets) {
+    for (int s = 0; s < kSets && q0 + s < depth; ++s) {
+      const int64_t q = q0 + s;
+      const __m512i b0 = _mm512_loadu_si512(b + q * 4 * kNr);
+      const __m512i b1 = _mm512_loadu_si512(b + q * 4 * kNr + 2 * kNr);
+      for (int r = 0; r < kRows; ++r) {
+        int32_t quad;
+        std::memcpy(&quad, a + r * lda + 4 * q, sizeof(quad));
+        const __m512i ar = _mm512_set1_epi32(quad);
+        acc[s][r][0] = _mm512_dpbusd_epi32(acc[s][r][0], ar, b0);
+        acc[s][r][1] = _mm512_dpbusd_epi32(acc[s][r][1], ar, b1);
+      }
+    }
+  }
+  for (int r = 0; r < kRows; ++r) {
+    for (int s = 1; s < kSets; ++s) {
+      acc[0][r][0] = _mm512_add_epi32(acc[0][r][0], acc[s][r][0]);
+      acc[0][r][1] = _mm512_add_epi32(acc[0][r][1], acc[s][r][1]);
+    }
+    _mm512_storeu_si512(c + r * ldc, acc[0][r][0]);
+    _mm512_storeu_si512(c + r * ldc + 16, acc[0][r][1]);
+  }
+}
+
+// Calls TILE<rows>(args...) for 1 <= rows <= kMr.
+static_assert(kMr == 6);
+#define TF_GEMM_DISPATCH_ROWS(TILE, rows, ...) \
+  switch (rows) {                              \
+    case 1:                                    \
+      return TILE<1>(__VA_ARGS__);             \
+    case 2:                                    \
+      return TILE<2>(__VA_ARGS__);             \
+    case 3:                                    \
+      return TILE<3>(__VA_ARGS__);             \
+    case 4:                                    \
+      return TILE<4>(__VA_ARGS__);             \
+    case 5:                                    \
+      return TILE<5>(__VA_ARGS__);             \
+    default:                                   \
+      return TILE<kMr>(__VA_ARGS__);           \
+  }
+
+void F32KernelAvx512(const float* a, int64_t lda, int64_t rows,
+                     const float* b, int64_t depth, float* c, int64_t ldc) {
+  TF_GEMM_DISPATCH_ROWS(F32TileAvx512, rows, a, lda, b, depth, c, ldc);
+}
+
+void Bf16KernelAvx512(const bfloat16* a, int64_t lda, int64_t rows,
+                      const bfloat16* b, int64_t depth, float* c,
+                      int64_t ldc) {
+  TF_GEMM_DISPATCH_ROWS(Bf16TileAvx512, rows, a, lda, b, depth, c, ldc);
+}
+
+void Int8KernelAvx512(const uint8* a, int64_t lda, int64_t rows,
+                      const int8* b, int64_t depth, int32* c, int64_t ldc) {
+  TF_GEMM_DISPATCH_ROWS(Int8TileAvx512, rows, a, lda, b, depth, c, ldc);
+}
+
+#undef TF_GEMM_DISPATCH_ROWS
+
+#endif  // TF_LOW_PRECISION_GEMM_X86
+
+bool HasAvx512() {
+  static const bool has_avx512 =
+      port::TestCPUFeature(port::CPUFeature::AVX512F);
+  return has_avx512;
+}
+
+bool HasAvx512Bf16() {
+  static const bool has_avx512_bf16 =
+      port::TestCPUFeature(port::CPUFeature::AVX512F) &&
+      port::TestCPUFeature(port::CPUFeature::AVX512BW) &&
+      port::TestCPUFeature(port::CPUFeature::AVX512_BF16);
+  return has_avx512_bf16;
+}
+
+bool HasAvx512Vnni() {
+  static const bool has_avx512_vnni =
+      port::TestCPUFeature(port::CPUFeature::AVX512F) &&
+      port::TestCPUFeature(port::CPUFeature::AVX512BW) &&
+      port::TestCPUFeature(port::CPUFeature::AVX512_VNNI);
+  return has_avx512_vnni;
+}
+
+F32Kernel GetF32Kernel() {
+#if defined(TF_LOW_PRECISION_GEMM_X86)
+  if (HasAvx512()) return F32KernelAvx512;
+#endif
+  return F32KernelScalar;
+}
+
+Bf16Kernel GetBf16Kernel() {
+#if defined(TF_LOW_PRECISION_GEMM_X86)
+  if (HasAvx512Bf16()) return Bf16KernelAvx512;
+#endif
+  return Bf16KernelScalar;
+}
+
+Int8Kernel GetInt8Kernel() {
+#if defined(TF_LOW_PRECISION_GEMM_X86)
+  if (HasAvx512Vnni()) return Int8KernelAvx512;
+#endif
+  return Int8KernelScalar;
+}
+
+// Packs the [k, n] matrix `b` (or the transpose of the [n, k] matrix `b`)
+// into strips of kNr columns, with groups of kGroup consecutive values of
+// every column. `convert` maps input values to packed values; padding is
+// zero.
+template <int kGroup, typename Tin, typename Tout, typename Convert>
+void PackStrips(const Tin* b, int64_t k, int64_t n, bool transpose,
+                Convert convert, std::vector<Tout>* packed) {
+  const int64_t depth = CeilDiv(k, kGroup);
+  const int64_t num_strips = CeilDiv(n, kNr);
+  packed->assign(num_strips * depth * kNr * kGroup, Tout());
+  Tout* out = packed->data();
+  for (int64_t s = 0; s < num_strips; ++s) {
+    const int64_t cols = std::min(kNr, n - s * kNr);
+    for (int64_t p = 0; p < depth; ++p) {
+      const int64_t group = std::min<int64_t>(kGroup, k - p * kGroup);
+      Tout* dst = out + (s * depth + p) * kNr * kGroup;
+      for (int64_t j = 0; j < cols; ++j) {
+        const int64_t col = s * kNr + j;
+        for (int64_t h = 0; h < group; ++h) {
+          const int64_t row = p * kGroup + h;
+          dst[j * kGroup + h] =
+              convert(transpose ? b[col * k + row] : b[row * n + col]);
+        }
+      }
+    }
+  }
+}
+
+// Packs `rows` rows of the [m, k] matrix `a` (or of the transpose of the
+// [k, m] matrix `a`) starting at `row` into `packed`, with a leading dimension
+// of `lda` and zero padding.
+template <typename Tin, typename Tout, typename Convert>
+void PackRows(const Tin* a, int64_t m, int64_t k, bool transpose, int64_t row,
+              int64_t rows, int64_t lda, Convert convert, Tout* packed) {
+  std::fill(packed, packed + rows * lda, Tout());
+  for (int64_t r = 0; r < rows; ++r) {
+    Tout* dst = packed + r * lda;
+    if (transpose) {
+      for (int64_t i = 0; i < k; ++i) dst[i] = convert(a[i * m + row + r]);
+    } else {
+      const Tin* src = a + (row + r) * k;
+      for (int64_t i = 0; i < k; ++i) dst[i] = convert(src[i]);
+    }
+  }
+}
+
+// Multiplies an [m, k] left-hand side with a packed right-hand side of `n`
+// columns, whose strips are `depth` groups of kNr columns. Rows of the
+// left-hand side are packed with a leading dimension of `lda`.
+//
+// Every task packs a block of up to kMb rows with `pack_rows(row, rows,
+// packed)`, multiplies it with the strips in blocks of kNc columns, and calls
+// `fixup(block, ld, packed, row, col, rows, cols)` and then `output` on every
+// block of results. When there are fewer
+// row blocks than threads, the columns are split between tasks too.
+template <typename PackedA, typename PackedB, typename AccT,
+          typename PackRowsFn, typename FixupFn>
+void RunBlocked(const Eigen::ThreadPoolDevice& d, int64_t m, int64_t n,
+                int64_t depth, int64_t lda,
+                void (*kernel)(const PackedA*, int64_t, int64_t,
+                               const PackedB*, int64_t, AccT*, int64_t),
+                const PackedB* b, int64_t group, PackRowsFn pack_rows,
+                FixupFn fixup, const GemmOutputFn<AccT>& output) {
+  const int64_t strip_size = depth * kNr * group;
+  const int64_t num_row_blocks = CeilDiv(m, kMb);
+  const int64_t num_col_blocks = CeilDiv(n, kNc);
+  const int64_t num_col_splits =
+      std::min(num_col_blocks, CeilDiv(d.numThreads(), num_row_blocks));
+  const int64_t col_blocks_per_split = CeilDiv(num_col_blocks, num_col_splits);
+
+  const int64_t task_cols = col_blocks_per_split * kNc;
+  const Eigen::TensorOpCost cost(
+      (kMb + task_cols) * depth * group * sizeof(PackedB),
+      kMb * task_cols * sizeof(AccT), kMb * task_cols * depth * group / 16.0);
+  d.parallelFor(
+      num_row_blocks * num_col_splits, cost, [&](int64_t begin, int64_t end) {
+        std::vector<PackedA> packed_rows(kMb * lda);
+        std::vector<AccT> block(kMb * kNc);
+        for (int64_t task = begin; task < end; ++task) {
+          const int64_t row = task / num_col_splits * kMb;
+          const int64_t rows = std::min(kMb, m - row);
+          pack_rows(row, rows, packed_rows.data());
+
+          const int64_t first_block = task % num_col_splits *
+                                      col_blocks_per_split;
+          const int64_t last_block =
+              std::min(num_col_blocks, first_block + col_blocks_per_split);
+          for (int64_t cb = first_block; cb < last_block; ++cb) {
+            const int64_t col = cb * kNc;
+            const int64_t cols = std::min(kNc, n - col);
+            for (int64_t j = 0; j < cols; j += kNr) {
+              const PackedB* strip = b + (col + j) / kNr * strip_size;
+              for (int64_t r = 0; r < rows; r += kMr) {
+                kernel(packed_rows.data() + r * lda, lda,
+                       std::min(kMr, rows - r), strip, depth,
+                       block.data() + r * kNc + j, kNc);
+              }
+            }
+            fixup(block.data(), kNc, packed_rows.data(), row, col, rows,
+                  cols);
+            output(block.data(), kNc, row, col, rows, cols);
+          }
+        }
+      });
+}
+
+}  // namespace
+
+bool F32Gemm::IsAccelerated() {
+#if defined(TF_LOW_PRECISION_GEMM_X86)
+  return HasAvx512();
+#else
+  return false;
+#endif
+}
+
+void F32Gemm::PackRhs(const float* b, int64_t k, int64_t n, bool transpose,
+                      PackedRhs* packed) {
+  packed->k = k;
+  packed->n = n;
+  PackStrips</*kGroup=*/1>(
+      b, k, n, transpose, [](float v) { return v; }, &packed->data);
+}
+
+void F32Gemm::Run(const Eigen::ThreadPoolDevice& d, const float* a, int64_t m,
+                  bool transpose_a, const PackedRhs& b,
+                  const GemmOutputFn<float>& output) {
+  static const F32Kernel kernel = GetF32Kernel();
+  const int64_t k = b.k;
+  RunBlocked(
+      d, m, b.n, /*depth=*/k, /*lda=*/k, kernel, b.data.data(), /*group=*/1,
+      [&](int64_t row, int64_t rows, float* packed) {
+        PackRows(a, m, k, transpose_a, row, rows, /*lda=*/k,
+                 [](float v) { return v; }, packed);
+      },
+      [](float*, int64_t, const float*, int64_t, int64_t, int64_t, int64_t) {},
+      output);
+}
+
+bool Bf16Gemm::IsAccelerated() {
+#if defined(TF_LOW_PRECISION_GEMM_X86)
+  return HasAvx512Bf16();
+#else
+  return false;
+#endif
+}
+
+void Bf16Gemm::PackRhs(const bfloat16* b, int64_t k, int64_t n,
+                       bool transpose, PackedRhs* packed) {
+  packed->k = k;
+  packed->n = n;
+  PackStrips</*kGroup=*/2>(
+      b, k, n, transpose, [](bfloat16 v) { return v; }, &packed->data);
+}
+
+void Bf16Gemm::Run(const Eigen::ThreadPoolDevice& d, const bfloat16* a,
+                   int64_t m, bool transpose_a, const PackedRhs& b,
+                   const GemmOutputFn<float>& output) {
+  static const Bf16Kernel kernel = GetBf16Kernel();
+  const int64_t k = b.k;
+  const int64_t depth = CeilDiv(k, 2);
+  const int64_t lda = depth * 2;
+  RunBlocked(
+      d, m, b.n, depth, lda, kernel, b.data.data(), /*group=*/2,
+      [&](int64_t row, int64_t rows, bfloat16* packed) {
+        PackRows(a, m, k, transpose_a, row, rows, lda,
+                 [](bfloat16 v) { return v; }, packed);
+      },
+      [](float*, int64_t, const bfloat16*, int64_t, int64_t, int64_t,
+         int64_t) {},
+      output);
+}
+
+bool Int8Gemm::IsAccelerated() {
+#if defined(TF_LOW_PRECISION_GEMM_X86)
+  return HasAvx512Vnni();
+#else
+  return false;
+#endif
+}
+
+// The kernels multiply unsigned bytes of the left-hand side with signed bytes
+// of the right-hand side. Other combinations are shifted by 128 into these
+// ranges, and the result is corrected with
+//
+//   sum(a * b) = sum(a' * b') + 128 * ub * sum(a') - 128 * sa * sum(b')
+//                - 128 * 128 * sa * ub * k
+//
+// where a' = a + 128 * sa, b' = b - 128 * ub, and sa (ub) is 1 if the
+// left-hand (right-hand) side is signed (unsigned).
+
+template <typename Tb>
+void Int8Gemm::PackRhs(const Tb* b, int64_t k, int64_t n, bool transpose,
+                       PackedRhs* packed) {
+  static_assert(std::is_same_v<Tb, int8> || std::is_same_v<Tb, uint8>);
+  packed->k = k;
+  packed->n = n;
+  packed->is_unsigned = std::is_same_v<Tb, uint8>;
+  PackStrips</*kGroup=*/4>(
+      b, k, n, transpose,
+      [](Tb v) { return static_cast<int8>(static_cast<int32>(v) -
+                                          (std::is_same_v<Tb, uint8> ? 128
+                                                                     : 0)); },
+      &packed->data);
+
+  const int64_t depth = CeilDiv(k, 4);
+  const int64_t num_strips = CeilDiv(n, kNr);
+  packed->col_sums.assign(num_strips * kNr, 0);
+  for (int64_t s = 0; s < num_strips; ++s) {
+    const int8* strip = packed->data.data() + s * depth * kNr * 4;
+    for (int64_t p = 0; p < depth; ++p) {
+      for (int64_t j = 0; j < kNr; ++j) {
+        for (int h = 0; h < 4; ++h) {
+          packed->col_sums[s * kNr + j] += strip[(p * kNr + j) * 4 + h];
+        }
+      }
+    }
+  }
+}
+
+template <typename Ta>
+void Int8Gemm::Run(const Eigen::ThreadPoolDevice& d, const Ta* a, int64_t m,
+                   bool transpose_a, const PackedRhs& b,
+                   const GemmOutputFn<int32>& output) {
+  static_assert(std::is_same_v<Ta, int8> || std::is_same_v<Ta, uint8>);
+  static const Int8Kernel kernel = GetInt8Kernel();
+  constexpr bool kSignedLhs = std::is_same_v<Ta, int8>;
+  const int64_t k = b.k;
+  const int64_t depth = CeilDiv(k, 4);
+  const int64_t lda = depth * 4;
+  const int32 constant_term =
+      kSignedLhs && b.is_unsigned ? -128 * 128 * static_cast<int32>(k) : 0;
+  const auto to_unsigned = [](Ta v) {
+    return static_cast<uint8>(static_cast<int32>(v) + (kSignedLhs ? 128 : 0));
+  };
+  RunBlocked(
+      d, m, b.n, depth, lda, kernel, b.data.data(), /*group=*/4,
+      [&](int64_t row, int64_t rows, uint8* packed) {
+        PackRows(a, m, k, transpose_a, row, rows, lda, to_unsigned, packed);
+      },
+      [&](int32* block, int64_t ld, const uint8* packed, int64_t row,
+          int64_t col, int64_t rows, int64_t cols) {
+        for (int64_t r = 0; r < rows; ++r) {
+          int32 row_term = constant_term;
+          if (b.is_unsigned) {
+            const uint8* packed_row = packed + r * lda;
+            int32 row_sum = 0;
+            for (int64_t i = 0; i < k; ++i) row_sum += packed_row[i];
+            row_term += 128 * row_sum;
+          }
+          int32* out = block + r * ld;
+          for (int64_t j = 0; j < cols; ++j) {
+            out[j] += row_term;
+            if (kSignedLhs) out[j] -= 128 * b.col_sums[col + j];
+          }
+        }
+      },
+      output);
+}
+
+template void Int8Gemm::PackRhs<int8>(const int8*, int64_t, int64_t, bool,
+                                      PackedRhs*);
+template void Int8Gemm::PackRhs<uint8>(const uint8*, int64_t, int64_t, bool,
+                                       PackedRhs*);
+template void Int8Gemm::Run<int8>(const Eigen::ThreadPoolDevice&, const int8*,
+                                  int64_t, bool, const PackedRhs&,
+                                  const GemmOutputFn<int32>&);
+template void Int8Gemm::Run<uint8>(const Eigen::ThreadPoolDevice&,
+                                   const uint8*, int64_t, bool,
+                                   const PackedRhs&,
+                                   const GemmOutputFn<int32>&);
+
+}  // namespace tensorflow
@@ -0,0 +1,150 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_LOW_PRECISION_GEMM_CPU_H_
+#define TENSORFLOW_CORE_KERNELS_LOW_PRECISION_GEMM_CPU_H_
+
+// Matrix multiplication of bfloat16 and 8-bit integer matrices on CPU, and of
+// float matrices with a prepacked right-hand side.
+//
+// Without oneDNN, bfloat16 matrix products are computed by converting both
+// operands to float, and 8-bit integer products by converting them to int32,
+// before calling Eigen. The GEMMs below consume the narrow types directly,
+// with micro-kernels that are selected at runtime from the features of the
+// CPU:
+//
+//   * bfloat16 x bfloat16 -> float uses AVX512_BF16 (VDPBF16PS),
+//   * [u]int8 x [u]int8 -> int32 uses AVX512_VNNI (VPDPBUSD),
+//   * float x float -> float uses AVX512F (VFMADD231PS),
+//
+// and portable scalar kernels otherwise. Callers should only prefer these
+// GEMMs over Eigen when IsAccelerated() returns true.
+//
+// The right-hand side is packed into a kernel-specific layout once, so that
+// products with a constant right-hand side can reuse it. Eigen packs both
+// operands on every contraction, which for the small left-hand sides of
+// inference workloads costs as much as the multiplication itself; this is the
+// only reason to use the float GEMM. Results are handed to an output callback
+// in row-major blocks, which lets the caller fuse bias additions and
+// activations into the conversion to the output type.
+
+#define EIGEN_USE_THREADS
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Receives the `rows` x `cols` block of results that starts at (`row`, `col`)
+// of the output matrix. The block is row-major with a leading dimension of
+// `ld`, and may be modified in place.
+template <typename AccT>
+using GemmOutputFn = std::function<void(AccT* block, int64_t ld, int64_t row,
+                                        int64_t col, int64_t rows,
+                                        int64_t cols)>;
+
+// bfloat16 x bfloat16 products, accumulated in float.
+class Bf16Gemm {
+ public:
+  // The right-hand side [k, n] of a product, packed for the micro-kernels.
+  struct PackedRhs {
+    int64_t k = 0;
+    int64_t n = 0;
+    std::vector<bfloat16> data;
+  };
+
+  // Returns true if the CPU has an accelerated kernel for this GEMM.
+  static bool IsAccelerated();
+
+  // Packs the [k, n] matrix `b`, or the transpose of the [n, k] matrix `b` if
+  // `transpose` is true.
+  static void PackRhs(const bfloat16* b, int64_t k, int64_t n, bool transpose,
+                      PackedRhs* packed);
+
+  // Computes the product of the [m, k] matrix `a` (the transpose of the
+  // [k, m] matrix `a` if `transpose_a` is true) and `b`, and passes it to
+  // `output`.
+  static void Run(const Eigen::ThreadPoolDevice& d, const bfloat16* a,
+                  int64_t m, bool transpose_a, const PackedRhs& b,
+                  const GemmOutputFn<float>& output);
+};
+
+// float x float products of a right-hand side that is reused across calls.
+class F32Gemm {
+ public:
+  // The right-hand side [k, n] of a product, packed for the micro-kernels.
+  struct PackedRhs {
+    int64_t k = 0;
+    int64_t n = 0;
+    std::vector<float> data;
+  };
+
+  // Returns true if the CPU has an accelerated kernel for this GEMM.
+  static bool IsAccelerated();
+
+  // Packs the [k, n] matrix `b`, or the transpose of the [n, k] matrix `b` if
+  // `transpose` is true.
+  static void PackRhs(const float* b, int64_t k, int64_t n, bool transpose,
+                      PackedRhs* packed);
+
+  // Computes the product of the [m, k] matrix `a` (the transpose of the
+  // [k, m] matrix `a` if `transpose_a` is true) and `b`, and passes it to
+  // `output`.
+  static void Run(const Eigen::ThreadPoolDevice& d, const float* a, int64_t m,
+                  bool transpose_a, const PackedRhs& b,
+                  const GemmOutputFn<float>& output);
+};
+
+// 8-bit integer products, accumulated in int32. Either operand may be signed
+// or unsigned.
+class Int8Gemm {
+ public:
+  // The right-hand side [k, n] of a product, packed for the micro-kernels.
+  struct PackedRhs {
+    int64_t k = 0;
+    int64_t n = 0;
+    bool is_unsigned = false;
+    // Packed values, shifted into the int8 range if `is_unsigned`.
+    std::vector<int8> data;
+    // Column sums of the packed values.
+    std::vector<int32> col_sums;
+  };
+
+  // Returns true if the CPU has an accelerated kernel for this GEMM.
+  static bool IsAccelerated();
+
+  // Packs the [k, n] matrix `b`, or the transpose of the [n, k] matrix `b` if
+  // `transpose` is true. `Tb` is int8 or uint8.
+  template <typename Tb>
+  static void PackRhs(const Tb* b, int64_t k, int64_t n, bool transpose,
+                      PackedRhs* packed);
+
+  // Computes the product of the [m, k] matrix `a` (the transpose of the
+  // [k, m] matrix `a` if `transpose_a` is true) and `b`, and passes it to
+  // `output`. `Ta` is int8 or uint8.
+  template <typename Ta>
+  static void Run(const Eigen::ThreadPoolDevice& d, const Ta* a, int64_t m,
+                  bool transpose_a, const PackedRhs& b,
+                  const GemmOutputFn<int32>& output);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_LOW_PRECISION_GEMM_CPU_H_
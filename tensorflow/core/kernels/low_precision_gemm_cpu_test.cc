@@ -0,0 +1,266 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#define EIGEN_USE_THREADS
+
+#include "tensorflow/core/kernels/low_precision_gemm_cpu.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+struct Shape {
+  int64_t m;
+  int64_t k;
+  int64_t n;
+};
+
+// Covers single elements, partial micro-kernel tiles and blocks, and depths
+// that are not a multiple of the packing groups.
+const Shape kShapes[] = {
+    {1, 1, 1}, {7, 5, 33}, {50, 130, 300}, {3, 1000, 70}, {97, 64, 129}};
+
+class LowPrecisionGemmTest : public ::testing::Test {
+ protected:
+  LowPrecisionGemmTest() : pool_(4), device_(&pool_, 4) {}
+
+  // Returns element (i, j) of the [rows, cols] matrix `x`, or of the
+  // transpose of the [cols, rows] matrix `x` if `transpose` is true.
+  template <typename T>
+  static T At(const std::vector<T>& x, int64_t rows, int64_t cols,
+              bool transpose, int64_t i, int64_t j) {
+    return transpose ? x[j * rows + i] : x[i * cols + j];
+  }
+
+  // Copies the blocks passed to a GemmOutputFn into the row-major `c`.
+  template <typename AccT>
+  static GemmOutputFn<AccT> CopyTo(std::vector<AccT>* c, int64_t n) {
+    return [c, n](AccT* block, int64_t ld, int64_t row, int64_t col,
+                  int64_t rows, int64_t cols) {
+      for (int64_t r = 0; r < rows; ++r) {
+        for (int64_t j = 0; j < cols; ++j) {
+          (*c)[(row + r) * n + col + j] = block[r * ld + j];
+        }
+      }
+    };
+  }
+
+  template <typename Ta, typename Tb>
+  void TestInt8(const Shape& s, bool transpose_a, bool transpose_b) {
+    std::mt19937 gen(1);
+    std::vector<Ta> a(s.m * s.k);
+    std::vector<Tb> b(s.k * s.n);
+    for (auto& v : a) v = static_cast<Ta>(gen());
+    for (auto& v : b) v = static_cast<Tb>(gen());
+
+    Int8Gemm::PackedRhs packed;
+    Int8Gemm::PackRhs(b.data(), s.k, s.n, transpose_b, &packed);
+    std::vector<int32> c(s.m * s.n, -1);
+    Int8Gemm::Run(device_, a.data(), s.m, transpose_a, packed,
+                  CopyTo(&c, s.n));
+
+    for (int64_t i = 0; i < s.m; ++i) {
+      for (int64_t j = 0; j < s.n; ++j) {
+        int32 expected = 0;
+        for (int64_t x = 0; x < s.k; ++x) {
+          expected += int32{At(a, s.m, s.k, transpose_a, i, x)} *
+                      int32{At(b, s.k, s.n, transpose_b, x, j)};
+        }
+        ASSERT_EQ(c[i * s.n + j], expected)
+            << s.m << "x" << s.k << "x" << s.n << " at (" << i << ", " << j
+            << ")";
+      }
+    }
+  }
+
+  void TestBf16(const Shape& s, bool transpose_a, bool transpose_b) {
+    std::mt19937 gen(2);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<bfloat16> a(s.m * s.k);
+    std::vector<bfloat16> b(s.k * s.n);
+    for (auto& v : a) v = bfloat16(dist(gen));
+    for (auto& v : b) v = bfloat16(dist(gen));
+
+    Bf16Gemm::PackedRhs packed;
+    Bf16Gemm::PackRhs(b.data(), s.k, s.n, transpose_b, &packed);
+    std::vector<float> c(s.m * s.n);
+    Bf16Gemm::Run(device_, a.data(), s.m, transpose_a, packed,
+                  CopyTo(&c, s.n));
+
+    for (int64_t i = 0; i < s.m; ++i) {
+      for (int64_t j = 0; j < s.n; ++j) {
+        double expected = 0;
+        for (int64_t x = 0; x < s.k; ++x) {
+          expected +=
+              static_cast<double>(At(a, s.m, s.k, transpose_a, i, x)) *
+              static_cast<double>(At(b, s.k, s.n, transpose_b, x, j));
+        }
+        // The products of bfloat16 values are exact in float, so only the
+        // float accumulation contributes to the error.
+        ASSERT_NEAR(c[i * s.n + j], expected, 1e-5 * s.k)
+            << s.m << "x" << s.k << "x" << s.n << " at (" << i << ", " << j
+            << ")";
+      }
+    }
+  }
+
+  void TestF32(const Shape& s, bool transpose_a, bool transpose_b) {
+    std::mt19937 gen(3);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float> a(s.m * s.k);
+    std::vector<float> b(s.k * s.n);
+    for (auto& v : a) v = dist(gen);
+    for (auto& v : b) v = dist(gen);
+
+    F32Gemm::PackedRhs packed;
+    F32Gemm::PackRhs(b.data(), s.k, s.n, transpose_b, &packed);
+    std::vector<float> c(s.m * s.n);
+    F32Gemm::Run(device_, a.data(), s.m, transpose_a, packed,
+                 CopyTo(&c, s.n));
+
+    for (int64_t i = 0; i < s.m; ++i) {
+      for (int64_t j = 0; j < s.n; ++j) {
+        double expected = 0;
+        for (int64_t x = 0; x < s.k; ++x) {
+          expected +=
+              static_cast<double>(At(a, s.m, s.k, transpose_a, i, x)) *
+              static_cast<double>(At(b, s.k, s.n, transpose_b, x, j));
+        }
+        ASSERT_NEAR(c[i * s.n + j], expected, 1e-5 * s.k)
+            << s.m << "x" << s.k << "x" << s.n << " at (" << i << ", " << j
+            << ")";
+      }
+    }
+  }
+
+  Eigen::ThreadPool pool_;
+  Eigen::ThreadPoolDevice device_;
+};
+
+TEST_F(LowPrecisionGemmTest, Int8) {
+  for (const Shape& s : kShapes) {
+    for (bool transpose_a : {false, true}) {
+      for (bool transpose_b : {false, true}) {
+        TestInt8<int8, int8>(s, transpose_a, transpose_b);
+        TestInt8<uint8, int8>(s, transpose_a, transpose_b);
+        TestInt8<int8, uint8>(s, transpose_a, transpose_b);
+        TestInt8<uint8, uint8>(s, transpose_a, transpose_b);
+      }
+    }
+  }
+}
+
+TEST_F(LowPrecisionGemmTest, Int8Extremes) {
+  // The sign shift of unsigned operands must not overflow for the largest
+  // magnitudes.
+  const Shape s = {9, 513, 40};
+  std::vector<uint8> a(s.m * s.k, 255);
+  std::vector<int8> b(s.k * s.n, -128);
+  Int8Gemm::PackedRhs packed;
+  Int8Gemm::PackRhs(b.data(), s.k, s.n, /*transpose=*/false, &packed);
+  std::vector<int32> c(s.m * s.n);
+  Int8Gemm::Run(device_, a.data(), s.m, /*transpose_a=*/false, packed,
+                CopyTo(&c, s.n));
+  for (int32 v : c) ASSERT_EQ(v, 255 * -128 * s.k);
+}
+
+TEST_F(LowPrecisionGemmTest, Bf16) {
+  for (const Shape& s : kShapes) {
+    for (bool transpose_a : {false, true}) {
+      for (bool transpose_b : {false, true}) {
+        TestBf16(s, transpose_a, transpose_b);
+      }
+    }
+  }
+}
+
+TEST_F(LowPrecisionGemmTest, F32) {
+  for (const Shape& s : kShapes) {
+    for (bool transpose_a : {false, true}) {
+      for (bool transpose_b : {false, true}) {
+        TestF32(s, transpose_a, transpose_b);
+      }
+    }
+  }
+}
+
+TEST_F(LowPrecisionGemmTest, PackedRhsIsReusable) {
+  const Shape s = {20, 64, 48};
+  std::vector<bfloat16> a(s.m * s.k, bfloat16(0.5f));
+  std::vector<bfloat16> b(s.k * s.n, bfloat16(0.25f));
+  Bf16Gemm::PackedRhs packed;
+  Bf16Gemm::PackRhs(b.data(), s.k, s.n, /*transpose=*/false, &packed);
+  EXPECT_EQ(packed.k, s.k);
+  EXPECT_EQ(packed.n, s.n);
+  for (int iter = 0; iter < 2; ++iter) {
+    std::vector<float> c(s.m * s.n);
+    Bf16Gemm::Run(device_, a.data(), s.m, /*transpose_a=*/false, packed,
+                  CopyTo(&c, s.n));
+    for (float v : c) ASSERT_EQ(v, 0.125f * s.k);
+  }
+}
+
+template <typename T>
+void BM_LowPrecisionGemm(::testing::benchmark::State& state) {
+  const int64_t m = state.range(0);
+  const int64_t k = state.range(1);
+  const int64_t n = state.range(2);
+  Eigen::ThreadPool pool(port::MaxParallelism());
+  Eigen::ThreadPoolDevice device(&pool, pool.NumThreads());
+
+  using Gemm =
+      std::conditional_t<std::is_same_v<T, bfloat16>, Bf16Gemm, Int8Gemm>;
+  using AccT = std::conditional_t<std::is_same_v<T, bfloat16>, float, int32>;
+  std::vector<T> a(m * k, T(1));
+  std::vector<T> b(k * n, T(1));
+  typename Gemm::PackedRhs packed;
+  Gemm::PackRhs(b.data(), k, n, /*transpose=*/false, &packed);
+  std::vector<AccT> c(m * n);
+  const GemmOutputFn<AccT> output = [&](AccT* block, int64_t ld, int64_t row,
+                                        int64_t col, int64_t rows,
+                                        int64_t cols) {
+    for (int64_t r = 0; r < rows; ++r) {
+      std::copy_n(block + r * ld, cols, c.data() + (row + r) * n + col);
+    }
+  };
+  for (auto s : state) {
+    Gemm::Run(device, a.data(), m, /*transpose_a=*/false, packed, output);
+  }
+  state.SetItemsProcessed(state.iterations() * 2 * m * k * n);
+}
+
+BENCHMARK_TEMPLATE(BM_LowPrecisionGemm, bfloat16)
+    ->UseRealTime()
+    ->Args({1, 1024, 1024})
+    ->Args({128, 1024, 1024})
+    ->Args({512, 1024, 1024});
+BENCHMARK_TEMPLATE(BM_LowPrecisionGemm, int8)
+    ->UseRealTime()
+    ->Args({1, 1024, 1024})
+    ->Args({128, 1024, 1024})
+    ->Args({512, 1024, 1024});
+
+}  // namespace
+}  // namespace tensorflow
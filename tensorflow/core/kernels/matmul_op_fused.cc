@@ -33,6 +33,7 @@ limitations under the License.
 #endif  // GOOGLE_CUDA
 
 #include <functional>
+#include <memory>
 #include <string>
 #include <type_traits>
 #include <utility>
@@ -48,6 +49,8 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/kernels/fused_eigen_output_kernels.h"
+#include "tensorflow/core/kernels/low_precision_gemm_cpu.h"
+#include "tensorflow/core/kernels/packed_weight_cache.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/util/matmul_autotune.h"
 #include "tensorflow/core/util/tensor_format.h"
@@ -90,10 +93,12 @@ struct LaunchFusedMatMulOp {
 
 template <typename T>
 struct LaunchFusedMatMulOp<CPUDevice, T> {
-  // Use F32 compute for F16 inputs on CPU to preserve precision and reduce
-  // excessive casting during intermediate computations.
+  // Use F32 compute for F16 and BF16 inputs on CPU to preserve precision and
+  // reduce excessive casting during intermediate computations.
   using ComputeType =
-      std::conditional_t<DataTypeToEnum<T>::value == DT_HALF, float, T>;
+      std::conditional_t<DataTypeToEnum<T>::value == DT_HALF ||
+                             DataTypeToEnum<T>::value == DT_BFLOAT16,
+                         float, T>;
 
   void operator()(
       OpKernelContext* context, const Tensor& a, const Tensor& b,
@@ -128,6 +133,58 @@ struct LaunchFusedMatMulOp<CPUDevice, T> {
       }
     };
 
+    ExecuteFusedComputation(context, fusion, fusion_args,
+                            executeWithOutputKernel);
+  }
+
+  // Computes the product of `a` and a right-hand side packed for Bf16Gemm or
+  // F32Gemm, with the fused computation applied to float blocks of results
+  // before they are converted to T.
+  template <typename PackedRhs>
+  void operator()(OpKernelContext* context, const Tensor& a,
+                  const PackedRhs& packed_b, bool transpose_a,
+                  FusedComputationType fusion,
+                  const FusedComputationArgs& fusion_args, Tensor* output) {
+    using Gemm =
+        std::conditional_t<std::is_same_v<PackedRhs, Bf16Gemm::PackedRhs>,
+                           Bf16Gemm, F32Gemm>;
+    static_assert(std::is_same_v<PackedRhs, typename Gemm::PackedRhs>);
+    static_assert(std::is_same_v<ComputeType, float>);
+    T* out = output->flat<T>().data();
+    const int64_t n = output->dim_size(1);
+
+    auto executeWithOutputKernel = [&](auto output_kernel) {
+      Gemm::Run(
+          context->eigen_device<CPUDevice>(), a.flat<T>().data(),
+          output->dim_size(0), transpose_a, packed_b,
+          [&](float* block, int64_t ld, int64_t row, int64_t col,
+              int64_t rows, int64_t cols) {
+            // Blocks are row-major, which is how the output kernels see the
+            // output of a contraction with swapped arguments.
+            const ContractionOutputMapper<float, Eigen::Index> output_mapper(
+                block, ld);
+            Eigen::TensorContractionParams params;
+            params.swapped_arguments = true;
+            output_kernel(output_mapper, params, col, row, cols, rows);
+            for (int64_t r = 0; r < rows; ++r) {
+              Eigen::Map<Eigen::Array<T, Eigen::Dynamic, 1>>(
+                  out + (row + r) * n + col, cols) =
+                  Eigen::Map<const Eigen::ArrayXf>(block + r * ld, cols)
+                      .template cast<T>();
+            }
+          });
+    };
+    ExecuteFusedComputation(context, fusion, fusion_args,
+                            executeWithOutputKernel);
+  }
+
+ private:
+  // Calls `execute` with the output kernel of the fused computation.
+  template <typename Execute>
+  static void ExecuteFusedComputation(OpKernelContext* context,
+                                      FusedComputationType fusion,
+                                      const FusedComputationArgs& fusion_args,
+                                      Execute&& executeWithOutputKernel) {
     BiasAddArgs<T> bias_add_args;
     if (BiasAddArgs<T>::IsSupported(fusion)) {
       if (fusion == FusedComputationType::kBiasAddWithLeakyRelu) {
@@ -169,7 +226,6 @@ struct LaunchFusedMatMulOp<CPUDevice, T> {
     }
   }
 
- private:
   // Wrap output_kernel into type erased struct to reduce the number of unique
   // template instantiations for Eigen Tensor contraction expressions.
   //
@@ -664,6 +720,8 @@ class FusedMatMulOp : public OpKernel {
                       "only DT_HALF data type."));
     }
     use_autotune_ = MatmulAutotuneEnable();
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("is_filter_const", &is_filter_const_));
   }
 
   void Compute(OpKernelContext* ctx) override {
@@ -715,14 +773,47 @@ class FusedMatMulOp : public OpKernel {
     }
 
     auto launch = LaunchFusedMatMulOp<Device, T>();
+    if constexpr (std::is_same_v<Device, CPUDevice> &&
+                  (std::is_same_v<T, bfloat16> || std::is_same_v<T, float>)) {
+      // bfloat16 products always use Bf16Gemm when it is accelerated. Eigen is
+      // as fast as F32Gemm, except that it packs `b` on every call, so float
+      // products only use F32Gemm when `b` can be packed once.
+      const bool use_packed_gemm =
+          PackedGemm::IsAccelerated() &&
+          BiasAddArgs<T>::IsSupported(fused_computation_) &&
+          (std::is_same_v<T, bfloat16> || is_filter_const_);
+      if (use_packed_gemm) {
+        std::shared_ptr<const typename PackedGemm::PackedRhs> packed_b =
+            packed_b_cache_.Get(b, is_filter_const_, [&]() {
+              auto packed =
+                  std::make_shared<typename PackedGemm::PackedRhs>();
+              PackedGemm::PackRhs(b.flat<T>().data(),
+                                  b.dim_size(transpose_b_ ? 1 : 0),
+                                  b.dim_size(transpose_b_ ? 0 : 1),
+                                  transpose_b_, packed.get());
+              return packed;
+            });
+        launch(ctx, a, *packed_b, transpose_a_, fused_computation_,
+               fused_computation_args_, out);
+        return;
+      }
+    }
     launch(ctx, a, b, dim_pair, fused_computation_, fused_computation_args_,
            out, use_autotune_);
   }
 
  private:
+  // The GEMM that multiplies with a packed `b` on CPU.
+  using PackedGemm =
+      std::conditional_t<std::is_same_v<T, bfloat16>, Bf16Gemm, F32Gemm>;
+
   bool transpose_a_;
   bool transpose_b_;
   bool use_autotune_;
+  bool is_filter_const_ = false;
+
+  // The packed constant `b` of products on CPU.
+  PackedWeightCache<typename PackedGemm::PackedRhs> packed_b_cache_;
 
   FusedComputationType fused_computation_ = FusedComputationType::kUndefined;
   FusedComputationArgs fused_computation_args_;
@@ -739,6 +830,7 @@ class FusedMatMulOp : public OpKernel {
 
 TF_CALL_float(REGISTER_FUSED_CPU_MATMUL);
 TF_CALL_half(REGISTER_FUSED_CPU_MATMUL);
+TF_CALL_bfloat16(REGISTER_FUSED_CPU_MATMUL);
 
 #undef REGISTER_FUSED_CPU_MATMUL
 
@@ -37,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/framework/type_traits.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/fill_functor.h"
+#include "tensorflow/core/kernels/low_precision_gemm_cpu.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/platform/bfloat16.h"
@@ -886,6 +887,69 @@ inline void FastConvertFromFloat<bfloat16>(const float* src, bfloat16* dst,
   FloatToBFloat16(src, dst, size);
 }
 
+// Computes bfloat16 and 8-bit integer products with Bf16Gemm and Int8Gemm if
+// the CPU has accelerated kernels for them. Returns false if the product
+// should be computed with Eigen instead.
+template <typename Ta, typename Tb, typename Tout>
+bool LaunchLowPrecisionBatchMatMul(OpKernelContext* context,
+                                   const Tensor& in_x, const Tensor& in_y,
+                                   bool trans_x, bool trans_y,
+                                   const MatMulBCast& bcast, Tensor* out) {
+  constexpr bool kIsBf16 = std::is_same_v<Ta, bfloat16> &&
+                           std::is_same_v<Tb, bfloat16> &&
+                           std::is_same_v<Tout, bfloat16>;
+  constexpr bool kIsInt8 =
+      (std::is_same_v<Ta, int8> || std::is_same_v<Ta, uint8>) &&
+      (std::is_same_v<Tb, int8> || std::is_same_v<Tb, uint8>) &&
+      std::is_same_v<Tout, int32>;
+  if constexpr (!kIsBf16 && !kIsInt8) {
+    return false;
+  } else {
+    using Gemm = std::conditional_t<kIsBf16, Bf16Gemm, Int8Gemm>;
+    if (!Gemm::IsAccelerated()) return false;
+
+    const int64_t batch_size = bcast.output_batch_size();
+    const int64_t m = out->dim_size(1);
+    const int64_t n = out->dim_size(2);
+    const int64_t k = in_x.dim_size(trans_x ? 1 : 2);
+    // Packing does not pay off for small products.
+    const int64_t kMinLowPrecisionGemmCost = 64 * 64 * 64;
+    if (m * n * k < kMinLowPrecisionGemmCost) return false;
+
+    const bool should_bcast = bcast.IsBroadcastingRequired();
+    const auto& x_batch_indices = bcast.x_batch_indices();
+    const auto& y_batch_indices = bcast.y_batch_indices();
+    const Ta* x = in_x.flat<Ta>().data();
+    const Tb* y = in_y.flat<Tb>().data();
+    typename Gemm::PackedRhs packed_y;
+    int64_t packed_y_index = -1;
+    for (int64_t i = 0; i < batch_size; ++i) {
+      const int64_t x_index = should_bcast ? x_batch_indices[i] : i;
+      const int64_t y_index = should_bcast ? y_batch_indices[i] : i;
+      // A broadcast right-hand side is only packed once.
+      if (y_index != packed_y_index) {
+        Gemm::PackRhs(y + y_index * k * n, k, n, trans_y, &packed_y);
+        packed_y_index = y_index;
+      }
+      Tout* z = out->flat<Tout>().data() + i * m * n;
+      Gemm::Run(context->eigen_cpu_device(), x + x_index * m * k, m, trans_x,
+                packed_y,
+                [z, n](auto* block, int64_t ld, int64_t row, int64_t col,
+                       int64_t rows, int64_t cols) {
+                  for (int64_t r = 0; r < rows; ++r) {
+                    Tout* dst = z + (row + r) * n + col;
+                    if constexpr (kIsBf16) {
+                      FastConvertFromFloat(block + r * ld, dst, cols);
+                    } else {
+                      std::copy_n(block + r * ld, cols, dst);
+                    }
+                  }
+                });
+    }
+    return true;
+  }
+}
+
 template <typename Device, typename Ta, typename Tb, typename Tout>
 class BaseBatchMatMulOp : public OpKernel {
  public:
@@ -979,6 +1043,13 @@ class BaseBatchMatMulOp : public OpKernel {
                     in1_reshaped.data() != nullptr &&
                     out_reshaped.data() != nullptr,
                 absl::InternalError("Null data pointer encountered."));
+    if constexpr (std::is_same_v<Device, CPUDevice>) {
+      if (LaunchLowPrecisionBatchMatMul<Ta, Tb, Tout>(
+              ctx, in0_reshaped, in1_reshaped, adj_x_ || trans_x_,
+              adj_y_ || trans_y_, bcast, &out_reshaped)) {
+        return;
+      }
+    }
     if constexpr (std::is_same_v<Device, CPUDevice> && std::is_same_v<Ta, Tb> &&
                   (std::is_same_v<Ta, bfloat16> ||
                    std::is_same_v<Ta, Eigen::half>)) {
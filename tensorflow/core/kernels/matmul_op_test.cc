@@ -178,7 +178,8 @@ class FusedMatMulOpTest : public OpsTestBase {
                         const std::vector<string>& fused_ops, bool transpose_a,
                         bool transpose_b, Tensor* output,
                         bool allow_gpu_device = false,
-                        bool* test_skipped = nullptr) {
+                        bool* test_skipped = nullptr,
+                        bool is_filter_const = false) {
     Scope root = tensorflow::Scope::NewRootScope();
 
     DataType dtype = DataTypeToEnum<T>::v();
@@ -206,6 +207,7 @@ class FusedMatMulOpTest : public OpsTestBase {
                      .Attr("fused_ops", fused_ops)
                      .Attr("transpose_a", transpose_a)
                      .Attr("transpose_b", transpose_b)
+                     .Attr("is_filter_const", is_filter_const)
                      .Finalize(&fused_matmul));
 
     absl::Status last_status;
@@ -265,7 +267,7 @@ class FusedMatMulOpTest : public OpsTestBase {
   // Verifies that computing MatMul+BiasAdd in a graph is identical to
   // FusedMatMul.
   void VerifyMatMulWithBias(int m, int k, int n, bool transpose_a,
-                            bool transpose_b) {
+                            bool transpose_b, bool is_filter_const = false) {
     VLOG(2) << "=== VerifyMatMulWithBias (" << m << ", " << k << ", " << n
             << ", " << (int)transpose_a << ", " << (int)transpose_b << ") ===";
 
@@ -283,7 +285,8 @@ class FusedMatMulOpTest : public OpsTestBase {
           bool skipped = false;
           RunFusedMatMulOp(input_data, filter_data, {bias_data}, {"BiasAdd"},
                            transpose_a, transpose_b, out,
-                           /*allow_gpu_device=*/true, &skipped);
+                           /*allow_gpu_device=*/true, &skipped,
+                           is_filter_const);
           return skipped;
         };
 
@@ -359,6 +362,18 @@ TYPED_TEST_P(FusedMatMulWithBiasOpTest, MatMul1x256x1) {
   this->VerifyMatMulWithBias(1, 256, 1, false, false);
 }
 
+// A constant filter is packed ahead of time on CPU.
+TYPED_TEST_P(FusedMatMulWithBiasOpTest, MatMulWithConstFilter) {
+  for (bool transpose_a : {false, true}) {
+    for (bool transpose_b : {false, true}) {
+      this->VerifyMatMulWithBias(1, 256, 256, transpose_a, transpose_b,
+                                 /*is_filter_const=*/true);
+      this->VerifyMatMulWithBias(37, 100, 70, transpose_a, transpose_b,
+                                 /*is_filter_const=*/true);
+    }
+  }
+}
+
 static auto GetActivations(DataType dtype) {
   // "GeluExact", "Tanh", "Sigmoid" fusions are only supported for half-float
   // datatype
@@ -410,6 +425,7 @@ REGISTER_TYPED_TEST_SUITE_P(FusedMatMulWithBiasOpTest,       //
                             MatMul1x256x256,                 //
                             MatMul256x256x1,                 //
                             MatMul1x256x1,                   //
+                            MatMulWithConstFilter,           //
                             MatMul256x128x64WithActivation,  //
                             MatMul1x256x256WithActivation,   //
                             MatMul256x256x1WithActivation,   //
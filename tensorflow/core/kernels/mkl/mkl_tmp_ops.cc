@@ -58,11 +58,4 @@ TF_CALL_bfloat16(REGISTER_CPU_CONV_3D);
 TF_CALL_half(REGISTER_CPU_CONV_3D);
 #undef REGISTER_CPU_CONV_3D
 
-#define REGISTER_CPU_MATMUL(T)                                        \
-  REGISTER_KERNEL_BUILDER(                                            \
-      Name("_FusedMatMul").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
-      RaiseError<T>);
-TF_CALL_bfloat16(REGISTER_CPU_MATMUL);
-#undef REGISTER_CPU_MATMUL
-
 }  // namespace tensorflow
@@ -0,0 +1,97 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_NONTEMPORAL_STORE_H_
+#define TENSORFLOW_CORE_KERNELS_NONTEMPORAL_STORE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+
+// Helpers for memory-bound CPU kernels whose outputs are too large to stay in
+// cache. Writing such outputs with non-temporal (streaming) stores avoids
+// reading every destination cache line before it is overwritten, and keeps the
+// output from evicting the inputs.
+
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_nontemporal_store)
+#define TF_HAS_NONTEMPORAL_STORE 1
+#endif
+#endif
+
+namespace tensorflow {
+namespace internal {
+
+// Returns true if an output of `bytes` should be written with non-temporal
+// stores: it is larger than the last level cache, so it would be evicted before
+// it is read again anyway.
+inline bool UseNonTemporalStores(int64_t bytes) {
+#if defined(TF_HAS_NONTEMPORAL_STORE)
+  static const int64_t threshold =
+      std::max<int64_t>(Eigen::l3CacheSize(), 4 << 20);
+  return bytes >= threshold;
+#else
+  return false;
+#endif
+}
+
+// Stores `value` to `dst` bypassing the cache, if the compiler supports it.
+template <typename T>
+inline void StoreNonTemporal(T* dst, const T& value) {
+#if defined(TF_HAS_NONTEMPORAL_STORE)
+  __builtin_nontemporal_store(value, dst);
+#else
+  *dst = value;
+#endif
+}
+
+// Copies `n` bytes from `src` to `dst` with non-temporal stores.
+inline void CopyNonTemporal(void* dst, const void* src, size_t n) {
+#if defined(TF_HAS_NONTEMPORAL_STORE)
+  char* d = static_cast<char*>(dst);
+  const char* s = static_cast<const char*>(src);
+  // Copy the head until `d` is aligned for 8-byte stores.
+  const size_t head =
+      std::min(n, (8 - reinterpret_cast<uintptr_t>(d) % 8) % 8);
+  std::memcpy(d, s, head);
+  d += head;
+  s += head;
+  n -= head;
+  for (; n >= 8; n -= 8, d += 8, s += 8) {
+    uint64_t word;
+    std::memcpy(&word, s, 8);
+    __builtin_nontemporal_store(word, reinterpret_cast<uint64_t*>(d));
+  }
+  std::memcpy(d, s, n);
+#else
+  std::memcpy(dst, src, n);
+#endif
+}
+
+// Non-temporal stores are weakly ordered: they must be fenced before the
+// output is handed to another thread.
+inline void NonTemporalStoreFence() {
+#if defined(TF_HAS_NONTEMPORAL_STORE)
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+#endif
+}
+
+}  // namespace internal
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_NONTEMPORAL_STORE_H_
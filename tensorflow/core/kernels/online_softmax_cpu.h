@@ -0,0 +1,246 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_ONLINE_SOFTMAX_CPU_H_
+#define TENSORFLOW_CORE_KERNELS_ONLINE_SOFTMAX_CPU_H_
+
+// CPU implementation of the float and double Softmax, LogSoftmax and
+// SoftmaxCrossEntropyWithLogits kernels using online normalization.
+//
+// The Eigen implementations read the logits three times: once for the row
+// maximum, once for the sum of exponentials and once to normalize. Here the
+// maximum and the sum are computed in a single pass: each row is processed in
+// cache-sized blocks, and the running sum is rescaled whenever a block raises
+// the running maximum. A second pass writes the output. For the cross entropy
+// the loss is accumulated during the first pass and the backprop is written
+// directly, so the softmax itself is never materialized.
+//
+// Since (max, sum) pairs of disjoint parts of a row can be merged, rows with
+// many classes are split into shards that are processed in parallel, which
+// keeps the thread pool busy for small batches of large vocabularies.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+
+namespace tensorflow {
+namespace functor {
+
+template <typename T>
+constexpr bool IsOnlineSoftmaxType() {
+  return std::is_same_v<T, float> || std::is_same_v<T, double>;
+}
+
+template <typename T>
+class OnlineSoftmaxCpu {
+ public:
+  // Computes the softmax (or log softmax) of each row of the row-major
+  // [rows, cols] `logits` into `out`, which may alias `logits`.
+  static void Softmax(const Eigen::ThreadPoolDevice& d, const T* logits,
+                      int64_t rows, int64_t cols, T* out, bool log) {
+    Sharding sharding(d, rows, cols);
+    std::vector<Partial> partials(rows * sharding.num_shards);
+    sharding.ForEachShard(
+        d, kStatsCost, [&](int64_t i, int64_t offset, int64_t size) {
+          AccumulateShard</*kWithLabels=*/false>(logits + offset, nullptr,
+                                                 size, &partials[i]);
+        });
+    const std::vector<Partial> row_stats = MergeShards(sharding, partials);
+    sharding.ForEachShard(
+        d, kNormalizeCost, [&](int64_t i, int64_t offset, int64_t size) {
+          const Partial& stats = row_stats[i / sharding.num_shards];
+          ConstArray x(logits + offset, size);
+          Array y(out + offset, size);
+          if (log) {
+            y = x - (stats.max + std::log(stats.sum));
+          } else {
+            y = (x - stats.max).exp() * (T(1) / stats.sum);
+          }
+        });
+  }
+
+  // Computes the cross entropy loss of each row of the row-major
+  // [rows, cols] `logits` and `labels` into `loss`, and its gradient into
+  // `backprop`, which may alias `logits`.
+  static void Xent(const Eigen::ThreadPoolDevice& d, const T* logits,
+                   const T* labels, int64_t rows, int64_t cols, T* loss,
+                   T* backprop) {
+    Sharding sharding(d, rows, cols);
+    std::vector<Partial> partials(rows * sharding.num_shards);
+    sharding.ForEachShard(
+        d, kStatsCost, [&](int64_t i, int64_t offset, int64_t size) {
+          AccumulateShard</*kWithLabels=*/true>(logits + offset,
+                                                labels + offset, size,
+                                                &partials[i]);
+        });
+    const std::vector<Partial> row_stats = MergeShards(sharding, partials);
+    for (int64_t r = 0; r < rows; ++r) {
+      // sum(labels * (log(sum(exp(logits - max))) - (logits - max)))
+      const Partial& stats = row_stats[r];
+      loss[r] = stats.labels_sum * std::log(stats.sum) - stats.labels_dot;
+    }
+    sharding.ForEachShard(
+        d, kNormalizeCost, [&](int64_t i, int64_t offset, int64_t size) {
+          const Partial& stats = row_stats[i / sharding.num_shards];
+          ConstArray x(logits + offset, size);
+          ConstArray l(labels + offset, size);
+          Array y(backprop + offset, size);
+          y = (x - stats.max).exp() * (T(1) / stats.sum) - l;
+        });
+  }
+
+ private:
+  using Array = Eigen::Map<Eigen::Array<T, Eigen::Dynamic, 1>>;
+  using ConstArray = Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>>;
+
+  // Blocks are small enough to still be in L1 when they are read the second
+  // time, for the sum of exponentials.
+  static constexpr int64_t kBlockSize = 2048;
+  // Rows are only split into shards of at least this many elements.
+  static constexpr int64_t kMinShardSize = 16 * kBlockSize;
+  // Approximate per-element cost of the two passes, in cycles.
+  static constexpr int kStatsCost = 8;
+  static constexpr int kNormalizeCost = 6;
+
+  // Running statistics of a part of a row. `labels_dot` is only used for the
+  // cross entropy.
+  struct Partial {
+    // Maximum of the logits.
+    T max = -std::numeric_limits<T>::infinity();
+    // sum(exp(logits - max)).
+    T sum = T(0);
+    // sum(labels).
+    T labels_sum = T(0);
+    // sum(labels * (logits - max)).
+    T labels_dot = T(0);
+  };
+
+  // Re-expresses `p` relative to a larger maximum.
+  static void Rebase(Partial* p, T new_max) {
+    if (!(new_max > p->max)) return;
+    p->sum *= std::exp(p->max - new_max);
+    if (p->labels_sum != T(0)) {
+      p->labels_dot += (p->max - new_max) * p->labels_sum;
+    }
+    p->max = new_max;
+  }
+
+  template <bool kWithLabels>
+  static void AccumulateShard(const T* logits, const T* labels, int64_t size,
+                              Partial* p) {
+    for (int64_t begin = 0; begin < size; begin += kBlockSize) {
+      const int64_t n = std::min(kBlockSize, size - begin);
+      ConstArray x(logits + begin, n);
+      const T block_max = x.maxCoeff();
+      if (block_max == -std::numeric_limits<T>::infinity()) {
+        // The block adds nothing to the sum, and cannot be expressed relative
+        // to its maximum. Only the labels can contribute, to an infinite loss.
+        if (kWithLabels) {
+          ConstArray l(labels + begin, n);
+          p->labels_sum += l.sum();
+          p->labels_dot += (l * x).sum();
+        }
+        continue;
+      }
+      Rebase(p, block_max);
+      p->sum += (x - p->max).exp().sum();
+      if (kWithLabels) {
+        ConstArray l(labels + begin, n);
+        p->labels_sum += l.sum();
+        p->labels_dot += (l * (x - p->max)).sum();
+      }
+    }
+  }
+
+  // Splits rows of `cols` elements into `num_shards` shards of `shard_size`
+  // elements.
+  struct Sharding {
+    Sharding(const Eigen::ThreadPoolDevice& d, int64_t rows, int64_t cols)
+        : rows(rows), cols(cols) {
+      const int64_t num_threads = d.numThreads();
+      int64_t wanted = 1;
+      if (rows < num_threads) {
+        wanted = std::min((num_threads + rows - 1) / rows,
+                          std::max<int64_t>(1, cols / kMinShardSize));
+      }
+      shard_size = (cols + wanted - 1) / wanted;
+      // Keep the shards aligned to blocks.
+      shard_size = (shard_size + kBlockSize - 1) / kBlockSize * kBlockSize;
+      num_shards = std::max<int64_t>(1, (cols + shard_size - 1) / shard_size);
+    }
+
+    // Calls `fn(shard_index, offset, size)` for every non-empty shard in
+    // parallel.
+    template <typename Fn>
+    void ForEachShard(const Eigen::ThreadPoolDevice& d, int cost_per_element,
+                      Fn&& fn) const {
+      const int64_t rows = this->rows;
+      const int64_t cols = this->cols;
+      const int64_t num_shards = this->num_shards;
+      const int64_t shard_size = this->shard_size;
+      const Eigen::TensorOpCost cost(shard_size * sizeof(T),
+                                     shard_size * sizeof(T),
+                                     shard_size * cost_per_element);
+      d.parallelFor(rows * num_shards, cost, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          const int64_t c0 = i % num_shards * shard_size;
+          const int64_t c1 = std::min(c0 + shard_size, cols);
+          if (c0 < c1) fn(i, i / num_shards * cols + c0, c1 - c0);
+        }
+      });
+    }
+
+    int64_t rows;
+    int64_t cols;
+    int64_t shard_size;
+    int64_t num_shards;
+  };
+
+  // Merges the partial statistics of the shards of each row.
+  static std::vector<Partial> MergeShards(const Sharding& sharding,
+                                          const std::vector<Partial>& shards) {
+    std::vector<Partial> rows(sharding.rows);
+    for (int64_t r = 0; r < sharding.rows; ++r) {
+      Partial& row = rows[r];
+      if (sharding.num_shards == 1) {
+        row = shards[r];
+        continue;
+      }
+      for (int64_t s = 0; s < sharding.num_shards; ++s) {
+        row.max = std::max(row.max, shards[r * sharding.num_shards + s].max);
+      }
+      for (int64_t s = 0; s < sharding.num_shards; ++s) {
+        Partial shard = shards[r * sharding.num_shards + s];
+        Rebase(&shard, row.max);
+        row.sum += shard.sum;
+        row.labels_sum += shard.labels_sum;
+        row.labels_dot += shard.labels_dot;
+      }
+    }
+    return rows;
+  }
+};
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_ONLINE_SOFTMAX_CPU_H_
@@ -0,0 +1,77 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_PACKED_WEIGHT_CACHE_H_
+#define TENSORFLOW_CORE_KERNELS_PACKED_WEIGHT_CACHE_H_
+
+#include <memory>
+#include <utility>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Caches the form of a constant weight tensor (e.g. the filter of a MatMul or
+// a convolution) that a GEMM consumes, so that a kernel only packs it once.
+//
+// The cached value is keyed on the buffer and the shape of the weights. This
+// is only sound when the weights are known to be constant: the buffer of a
+// Const node lives as long as the graph and is never written to, whereas the
+// buffer of any other tensor may be reused for different values. Kernels
+// learn that their weights are constant from an `is_filter_const` attribute
+// set by Grappler.
+//
+// The packed value is handed out as a shared pointer, so that it stays valid
+// for concurrent executions even if it is replaced in the meantime.
+template <typename Packed>
+class PackedWeightCache {
+ public:
+  // Returns `weights` packed by `pack()`, which returns a
+  // std::shared_ptr<Packed>. If `is_const` is false the weights are packed on
+  // every call.
+  template <typename PackFn>
+  std::shared_ptr<const Packed> Get(const Tensor& weights, bool is_const,
+                                    PackFn&& pack) {
+    if (!is_const) return pack();
+
+    const char* data = weights.tensor_data().data();
+    {
+      tf_shared_lock l(mu_);
+      if (packed_ != nullptr && data_ == data && shape_ == weights.shape()) {
+        return packed_;
+      }
+    }
+    std::shared_ptr<const Packed> packed = pack();
+    mutex_lock l(mu_);
+    packed_ = packed;
+    data_ = data;
+    shape_ = weights.shape();
+    return packed;
+  }
+
+ private:
+  mutex mu_;
+  std::shared_ptr<const Packed> packed_ TF_GUARDED_BY(mu_);
+  // The buffer and the shape of the weights `packed_` was packed from.
+  const char* data_ TF_GUARDED_BY(mu_) = nullptr;
+  TensorShape shape_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_PACKED_WEIGHT_CACHE_H_
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/util/tensor_bundle/byte_swap_tensor.h"
 
 namespace tensorflow {
@@ -44,15 +45,21 @@ class ParseTensorOp : public OpKernel {
 
     auto serialized_t = serialized.scalar<tstring>();
 
-    TensorProto proto;
-    OP_REQUIRES(ctx, ParseProtoUnlimited(&proto, serialized_t()),
-                errors::InvalidArgument(
-                    "Could not parse `serialized` as TensorProto, base64: ",
-                    absl::Base64Escape(serialized_t())));
-
+    // Decodes the values straight into the output when possible, instead of
+    // into a TensorProto first.
     Tensor output;
-    OP_REQUIRES_OK(ctx, ctx->device()->MakeTensorFromProto(
-                            proto, ctx->output_alloc_attr(0), &output));
+    if (!port::kLittleEndian ||
+        !tensor::ParseTensorProtoFast(
+            serialized_t(),
+            ctx->device()->GetAllocator(ctx->output_alloc_attr(0)), &output)) {
+      TensorProto proto;
+      OP_REQUIRES(ctx, ParseProtoUnlimited(&proto, serialized_t()),
+                  errors::InvalidArgument(
+                      "Could not parse `serialized` as TensorProto, base64: ",
+                      absl::Base64Escape(serialized_t())));
+      OP_REQUIRES_OK(ctx, ctx->device()->MakeTensorFromProto(
+                              proto, ctx->output_alloc_attr(0), &output));
+    }
 
     OP_REQUIRES(
         ctx, out_type_ == output.dtype(),
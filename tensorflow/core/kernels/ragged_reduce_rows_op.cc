@@ -0,0 +1,150 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/ragged_utils.h"
+#include "tensorflow/core/util/work_sharder.h"
+#include "tsl/platform/errors.h"
+
+namespace tensorflow {
+
+namespace {
+
+// The reductions of RaggedReduceRows. The identities match those of the
+// unsorted segment reductions, which tf.ragged reductions are built on.
+template <typename T>
+struct SumReducer {
+  static T Identity() { return T(0); }
+  static T Reduce(T a, T b) { return a + b; }
+};
+
+template <typename T>
+struct ProdReducer {
+  static T Identity() { return T(1); }
+  static T Reduce(T a, T b) { return a * b; }
+};
+
+template <typename T>
+struct MaxReducer {
+  static T Identity() { return Eigen::NumTraits<T>::lowest(); }
+  static T Reduce(T a, T b) { return b > a ? b : a; }
+};
+
+template <typename T>
+struct MinReducer {
+  static T Identity() { return Eigen::NumTraits<T>::highest(); }
+  static T Reduce(T a, T b) { return b < a ? b : a; }
+};
+
+}  // namespace
+
+// Reduces each row of a ragged tensor with one ragged dimension, reading the
+// rows directly from its flat values. Rows are contiguous in the values, so
+// they are reduced independently, in parallel.
+template <typename T, typename SPLITS_TYPE>
+class RaggedReduceRowsOp : public OpKernel {
+ public:
+  explicit RaggedReduceRowsOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("reduction", &reduction_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& splits_in = context->input(0);
+    const Tensor& values_in = context->input(1);
+    OP_REQUIRES(context, TensorShapeUtils::IsVectorOrHigher(values_in.shape()),
+                errors::InvalidArgument(
+                    "rt_dense_values must be at least 1-D, got ",
+                    values_in.shape().DebugString()));
+    OP_REQUIRES_OK(context,
+                   RaggedTensorVerifySplits<SPLITS_TYPE>(
+                       splits_in, /*check_last_element=*/true,
+                       values_in.dim_size(0)));
+
+    const int64_t nrows = splits_in.NumElements() - 1;
+    TensorShape output_shape = values_in.shape();
+    output_shape.set_dim(0, nrows);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+
+    if (reduction_ == "sum") {
+      ReduceRows<SumReducer<T>>(context, splits_in, values_in, output);
+    } else if (reduction_ == "prod") {
+      ReduceRows<ProdReducer<T>>(context, splits_in, values_in, output);
+    } else if (reduction_ == "max") {
+      ReduceRows<MaxReducer<T>>(context, splits_in, values_in, output);
+    } else {
+      ReduceRows<MinReducer<T>>(context, splits_in, values_in, output);
+    }
+  }
+
+ private:
+  template <typename Reducer>
+  static void ReduceRows(OpKernelContext* context, const Tensor& splits_in,
+                         const Tensor& values_in, Tensor* output) {
+    const auto splits = splits_in.flat<SPLITS_TYPE>();
+    const int64_t nrows = splits.size() - 1;
+    const int64_t num_values = values_in.dim_size(0);
+    TensorShape inner_shape = values_in.shape();
+    inner_shape.RemoveDim(0);
+    const int64_t inner_size = inner_shape.num_elements();
+    const T* values = values_in.flat<T>().data();
+    T* out = output->flat<T>().data();
+
+    auto reduce_rows = [&](int64_t begin, int64_t end) {
+      for (int64_t row = begin; row < end; ++row) {
+        T* out_row = out + row * inner_size;
+        std::fill(out_row, out_row + inner_size, Reducer::Identity());
+        for (int64_t i = splits(row); i < splits(row + 1); ++i) {
+          const T* value = values + i * inner_size;
+          for (int64_t k = 0; k < inner_size; ++k) {
+            out_row[k] = Reducer::Reduce(out_row[k], value[k]);
+          }
+        }
+      }
+    };
+
+    auto* worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    const int64_t cost_per_row =
+        (num_values / std::max<int64_t>(nrows, 1) + 1) * inner_size;
+    Shard(worker_threads->num_threads, worker_threads->workers, nrows,
+          cost_per_row, reduce_rows);
+  }
+
+  std::string reduction_;
+};
+
+#define REGISTER_CPU_KERNEL(TYPE)                                  \
+  REGISTER_KERNEL_BUILDER(Name("RaggedReduceRows")                 \
+                              .Device(DEVICE_CPU)                  \
+                              .TypeConstraint<TYPE>("T")           \
+                              .TypeConstraint<int32>("Tsplits"),   \
+                          RaggedReduceRowsOp<TYPE, int32>);        \
+  REGISTER_KERNEL_BUILDER(Name("RaggedReduceRows")                 \
+                              .Device(DEVICE_CPU)                  \
+                              .TypeConstraint<TYPE>("T")           \
+                              .TypeConstraint<int64_t>("Tsplits"), \
+                          RaggedReduceRowsOp<TYPE, int64>);
+TF_CALL_REAL_NUMBER_TYPES(REGISTER_CPU_KERNEL);
+#undef REGISTER_CPU_KERNEL
+
+}  // namespace tensorflow
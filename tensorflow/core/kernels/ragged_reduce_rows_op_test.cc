@@ -0,0 +1,102 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class RaggedReduceRowsOpTest : public ::tensorflow::OpsTestBase {
+ protected:
+  // Builds the tensorflow test graph for RaggedReduceRows.
+  template <typename T>
+  void BuildRaggedReduceRowsGraph(const std::string& reduction,
+                                  const std::vector<int64_t>& splits,
+                                  const TensorShape& values_shape,
+                                  const std::vector<T>& values) {
+    TF_ASSERT_OK(NodeDefBuilder("tested_op", "RaggedReduceRows")
+                     .Input(FakeInput(DT_INT64))
+                     .Input(FakeInput(DataTypeToEnum<T>::v()))
+                     .Attr("reduction", reduction)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    AddInputFromArray<int64_t>(TensorShape({static_cast<int64_t>(
+                                   splits.size())}),
+                               splits);
+    AddInputFromArray<T>(values_shape, values);
+  }
+};
+
+TEST_F(RaggedReduceRowsOpTest, Sum) {
+  // rt = [[1, 2, 3], [], [4, 5]]
+  BuildRaggedReduceRowsGraph<float>("sum", {0, 3, 3, 5}, TensorShape({5}),
+                                    {1, 2, 3, 4, 5});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<float>(*GetOutput(0),
+                                 test::AsTensor<float>({6, 0, 9}));
+}
+
+TEST_F(RaggedReduceRowsOpTest, ProdWithInnerDims) {
+  // rt = [[[1, 2], [3, 4]], [], [[5, 6]]]
+  BuildRaggedReduceRowsGraph<int32>("prod", {0, 2, 2, 3}, TensorShape({3, 2}),
+                                    {1, 2, 3, 4, 5, 6});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<int32>(
+      *GetOutput(0), test::AsTensor<int32>({3, 8, 1, 1, 5, 6}, {3, 2}));
+}
+
+TEST_F(RaggedReduceRowsOpTest, MaxAndMinOfEmptyRows) {
+  BuildRaggedReduceRowsGraph<int32>("max", {0, 2, 2}, TensorShape({2}),
+                                    {-3, -1});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<int32>(
+      *GetOutput(0),
+      test::AsTensor<int32>({-1, std::numeric_limits<int32>::lowest()}));
+}
+
+TEST_F(RaggedReduceRowsOpTest, Min) {
+  BuildRaggedReduceRowsGraph<double>("min", {0, 0, 3}, TensorShape({3}),
+                                     {2.5, -1.5, 7});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<double>(
+      *GetOutput(0),
+      test::AsTensor<double>({std::numeric_limits<double>::max(), -1.5}));
+}
+
+TEST_F(RaggedReduceRowsOpTest, InvalidSplits) {
+  BuildRaggedReduceRowsGraph<float>("sum", {0, 3, 2}, TensorShape({2}),
+                                    {1, 2});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+TEST_F(RaggedReduceRowsOpTest, SplitsDoNotMatchValues) {
+  BuildRaggedReduceRowsGraph<float>("sum", {0, 1, 3}, TensorShape({4}),
+                                    {1, 2, 3, 4});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/reduction_ops.h"
+#include "tensorflow/core/kernels/reduction_ops_cpu.h"
 #include "tensorflow/core/kernels/transpose_functor.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
@@ -270,7 +271,19 @@ struct ReduceFunctorBase {
 
 template <typename Reducer>
 struct ReduceFunctor<CPUDevice, Reducer>
-    : ReduceFunctorBase<CPUDevice, Reducer> {};
+    : ReduceFunctorBase<CPUDevice, Reducer> {
+  template <typename OUT_T, typename IN_T, typename ReductionAxes>
+  static void Reduce(OpKernelContext* ctx, OUT_T out, IN_T in,
+                     const ReductionAxes& reduction_axes,
+                     const Reducer& reducer) {
+    if (ReduceOnCpu<Reducer>(ctx->eigen_device<CPUDevice>(), out, in,
+                             reduction_axes)) {
+      return;
+    }
+    ReduceFunctorBase<CPUDevice, Reducer>::Reduce(ctx, out, in,
+                                                  reduction_axes, reducer);
+  }
+};
 
 }  // namespace functor
 }  // namespace tensorflow
@@ -0,0 +1,366 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_REDUCTION_OPS_CPU_H_
+#define TENSORFLOW_CORE_KERNELS_REDUCTION_OPS_CPU_H_
+
+// CPU implementation of the float and double Sum, Mean, Max, Min and Prod
+// reductions of the canonical shapes produced by ReductionHelper:
+//
+//   * [rows, cols] reduced along cols (also a full reduction, with rows = 1),
+//   * [outer, rows, cols] reduced along rows (a column reduction, with
+//     outer = 1 for a matrix).
+//
+// Contiguous runs are reduced with several SIMD accumulators, and partial
+// results are combined pairwise, so the rounding error of a sum of n elements
+// grows with O(log n) rather than O(n). The work is split into rows, blocks of
+// columns, or - when there are too few of those to occupy the thread pool -
+// chunks of the reduced dimension whose partial results are combined in a
+// second pass.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "tensorflow/core/kernels/reduction_ops.h"
+
+namespace tensorflow {
+namespace functor {
+
+// Describes the reducers supported by CpuReduction. `BaseReducer` is the
+// Eigen reducer that computes the reduction; a mean is a sum followed by a
+// division.
+template <typename Reducer>
+struct CpuReductionTraits {
+  static constexpr bool kSupported = false;
+};
+
+template <typename T>
+constexpr bool IsCpuReductionType() {
+  return std::is_same_v<T, float> || std::is_same_v<T, double>;
+}
+
+template <typename T>
+struct CpuReductionTraits<Eigen::internal::SumReducer<T>> {
+  static constexpr bool kSupported = IsCpuReductionType<T>();
+  static constexpr bool kIsMean = false;
+  using Scalar = T;
+  using BaseReducer = Eigen::internal::SumReducer<T>;
+};
+
+template <typename T>
+struct CpuReductionTraits<MeanReducer<T>> {
+  static constexpr bool kSupported = IsCpuReductionType<T>();
+  static constexpr bool kIsMean = true;
+  using Scalar = T;
+  using BaseReducer = Eigen::internal::SumReducer<T>;
+};
+
+template <typename T>
+struct CpuReductionTraits<Eigen::internal::MaxReducer<T, Eigen::PropagateNaN>> {
+  static constexpr bool kSupported = IsCpuReductionType<T>();
+  static constexpr bool kIsMean = false;
+  using Scalar = T;
+  using BaseReducer = Eigen::internal::MaxReducer<T, Eigen::PropagateNaN>;
+};
+
+template <typename T>
+struct CpuReductionTraits<Eigen::internal::MinReducer<T, Eigen::PropagateNaN>> {
+  static constexpr bool kSupported = IsCpuReductionType<T>();
+  static constexpr bool kIsMean = false;
+  using Scalar = T;
+  using BaseReducer = Eigen::internal::MinReducer<T, Eigen::PropagateNaN>;
+};
+
+template <typename T>
+struct CpuReductionTraits<Eigen::internal::ProdReducer<T>> {
+  static constexpr bool kSupported = IsCpuReductionType<T>();
+  static constexpr bool kIsMean = false;
+  using Scalar = T;
+  using BaseReducer = Eigen::internal::ProdReducer<T>;
+};
+
+template <typename T, typename Reducer>
+class CpuReduction {
+ public:
+  using Packet = typename Eigen::internal::packet_traits<T>::type;
+  static constexpr int64_t kPacketSize =
+      Eigen::internal::unpacket_traits<Packet>::size;
+
+  // Contiguous runs of up to this many elements are reduced directly with
+  // kNumAccumulators packet accumulators.
+  static constexpr int64_t kLeafSize = 256;
+  static constexpr int kNumAccumulators = 4;
+  // Column reductions accumulate blocks of this many columns, over up to
+  // kRowLeafSize rows at a time.
+  static constexpr int64_t kColumnBlock = 32 * kPacketSize;
+  static constexpr int64_t kRowLeafSize = 32;
+  // Chunks of the reduced dimension of the two-pass strategy are at least
+  // this large, so that the second pass is cheap.
+  static constexpr int64_t kMinChunkSize = 4096;
+
+  // Reduces each row of the row-major [rows, cols] `in` into `out`.
+  static void ReduceRows(const Eigen::ThreadPoolDevice& d, const T* in,
+                         int64_t rows, int64_t cols, T* out) {
+    const Eigen::TensorOpCost row_cost(cols * sizeof(T), sizeof(T),
+                                       cols * ReduceCost());
+    const int64_t num_chunks =
+        NumChunks(d, /*num_units=*/rows, /*reduced_size=*/cols);
+    if (num_chunks == 1) {
+      // Row-parallel.
+      d.parallelFor(rows, row_cost, [=](int64_t begin, int64_t end) {
+        for (int64_t r = begin; r < end; ++r) {
+          out[r] = ReduceContiguous(in + r * cols, cols);
+        }
+      });
+      return;
+    }
+
+    // Two passes: reduce chunks of every row, then combine them.
+    const int64_t chunk_size = AlignedChunkSize(cols, num_chunks);
+    std::vector<T> partials(rows * num_chunks);
+    T* partial = partials.data();
+    const Eigen::TensorOpCost chunk_cost(chunk_size * sizeof(T), sizeof(T),
+                                         chunk_size * ReduceCost());
+    d.parallelFor(rows * num_chunks, chunk_cost,
+                  [=](int64_t begin, int64_t end) {
+                    for (int64_t i = begin; i < end; ++i) {
+                      const int64_t r = i / num_chunks;
+                      const int64_t c0 = i % num_chunks * chunk_size;
+                      const int64_t c1 = std::min(c0 + chunk_size, cols);
+                      partial[i] = c0 < c1 ? ReduceContiguous(
+                                                 in + r * cols + c0, c1 - c0)
+                                           : Reducer().initialize();
+                    }
+                  });
+    for (int64_t r = 0; r < rows; ++r) {
+      out[r] = CombinePairwise(partial + r * num_chunks, num_chunks);
+    }
+  }
+
+  // Reduces the row-major [outer, rows, cols] `in` along `rows` into the
+  // [outer, cols] `out`.
+  static void ReduceColumns(const Eigen::ThreadPoolDevice& d, const T* in,
+                            int64_t outer, int64_t rows, int64_t cols,
+                            T* out) {
+    const int64_t col_blocks = (cols + kColumnBlock - 1) / kColumnBlock;
+    const int64_t num_units = outer * col_blocks;
+    const int64_t num_chunks = NumChunks(d, num_units, rows);
+    const int64_t chunk_rows = (rows + num_chunks - 1) / num_chunks;
+
+    // Every unit reduces `chunk_rows` rows of one block of columns of one
+    // outer index into `dst` + <outer index> * cols.
+    auto reduce_units = [=](T* dst) {
+      return [=](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          const int64_t chunk = i / num_units;
+          const int64_t o = i % num_units / col_blocks;
+          const int64_t c0 = i % col_blocks * kColumnBlock;
+          const int64_t width = std::min(kColumnBlock, cols - c0);
+          const int64_t r0 = chunk * chunk_rows;
+          const int64_t r1 = std::min(r0 + chunk_rows, rows);
+          T* block_out = dst + (chunk * outer + o) * cols + c0;
+          if (r0 >= r1) {
+            std::fill_n(block_out, width, Reducer().initialize());
+            continue;
+          }
+          ReduceColumnBlock(in + (o * rows + r0) * cols + c0, r1 - r0, cols,
+                            width, block_out);
+        }
+      };
+    };
+    const double unit_elements =
+        static_cast<double>(chunk_rows) * std::min(kColumnBlock, cols);
+    const Eigen::TensorOpCost unit_cost(unit_elements * sizeof(T),
+                                        kColumnBlock * sizeof(T),
+                                        unit_elements * ReduceCost());
+
+    if (num_chunks == 1) {
+      // Column-parallel.
+      d.parallelFor(num_units, unit_cost, reduce_units(out));
+      return;
+    }
+
+    // Two passes: reduce chunks of rows, then combine them.
+    std::vector<T> partials(num_chunks * outer * cols);
+    d.parallelFor(num_chunks * num_units, unit_cost,
+                  reduce_units(partials.data()));
+    const T* partial = partials.data();
+    const int64_t size = outer * cols;
+    const Eigen::TensorOpCost combine_cost(num_chunks * sizeof(T), sizeof(T),
+                                           num_chunks * ReduceCost());
+    d.parallelFor(size, combine_cost, [=](int64_t begin, int64_t end) {
+      const Reducer reducer;
+      for (int64_t j = begin; j < end; ++j) {
+        T accum = partial[j];
+        for (int64_t chunk = 1; chunk < num_chunks; ++chunk) {
+          reducer.reduce(partial[chunk * size + j], &accum);
+        }
+        out[j] = accum;
+      }
+    });
+  }
+
+ private:
+  static double ReduceCost() {
+    return Eigen::internal::functor_traits<Reducer>::Cost;
+  }
+
+  // Returns the number of chunks to split the reduced dimension of `reduced`
+  // elements into, so that there are enough units of work for every thread.
+  static int64_t NumChunks(const Eigen::ThreadPoolDevice& d, int64_t num_units,
+                           int64_t reduced_size) {
+    const int64_t target_units = 4 * d.numThreads();
+    if (num_units >= target_units || reduced_size < 2 * kMinChunkSize) {
+      return 1;
+    }
+    return std::min((target_units + num_units - 1) / num_units,
+                    reduced_size / kMinChunkSize);
+  }
+
+  // Returns the size of `num_chunks` chunks covering `size` elements, rounded
+  // up to whole leaves so that chunks start at aligned offsets.
+  static int64_t AlignedChunkSize(int64_t size, int64_t num_chunks) {
+    const int64_t chunk_size = (size + num_chunks - 1) / num_chunks;
+    return (chunk_size + kLeafSize - 1) / kLeafSize * kLeafSize;
+  }
+
+  static T ReduceLeaf(const T* in, int64_t n) {
+    const Reducer reducer;
+    Packet accum[kNumAccumulators];
+    for (int k = 0; k < kNumAccumulators; ++k) {
+      accum[k] = reducer.template initializePacket<Packet>();
+    }
+    int64_t i = 0;
+    for (; i + kNumAccumulators * kPacketSize <= n;
+         i += kNumAccumulators * kPacketSize) {
+      for (int k = 0; k < kNumAccumulators; ++k) {
+        reducer.reducePacket(
+            Eigen::internal::ploadu<Packet>(in + i + k * kPacketSize),
+            &accum[k]);
+      }
+    }
+    for (; i + kPacketSize <= n; i += kPacketSize) {
+      reducer.reducePacket(Eigen::internal::ploadu<Packet>(in + i), &accum[0]);
+    }
+    for (int k = 1; k < kNumAccumulators; ++k) {
+      reducer.reducePacket(accum[k], &accum[0]);
+    }
+    T scalar_accum = reducer.initialize();
+    for (; i < n; ++i) reducer.reduce(in[i], &scalar_accum);
+    return reducer.finalizeBoth(scalar_accum, accum[0]);
+  }
+
+  // Reduces `n` contiguous elements by recursive halving.
+  static T ReduceContiguous(const T* in, int64_t n) {
+    if (n <= kLeafSize) return ReduceLeaf(in, n);
+    const int64_t half = (n / 2 + kLeafSize - 1) / kLeafSize * kLeafSize;
+    T accum = ReduceContiguous(in, half);
+    Reducer().reduce(ReduceContiguous(in + half, n - half), &accum);
+    return accum;
+  }
+
+  static T CombinePairwise(const T* values, int64_t n) {
+    if (n == 1) return values[0];
+    const int64_t half = n / 2;
+    T accum = CombinePairwise(values, half);
+    Reducer().reduce(CombinePairwise(values + half, n - half), &accum);
+    return accum;
+  }
+
+  // Reduces `rows` rows of `width` <= kColumnBlock columns, `stride` elements
+  // apart, into `out`, by recursive halving of the rows.
+  static void ReduceColumnBlock(const T* in, int64_t rows, int64_t stride,
+                                int64_t width, T* out) {
+    const Reducer reducer;
+    if (rows <= kRowLeafSize) {
+      int64_t j = 0;
+      for (; j + kPacketSize <= width; j += kPacketSize) {
+        Packet accum = reducer.template initializePacket<Packet>();
+        for (int64_t r = 0; r < rows; ++r) {
+          reducer.reducePacket(
+              Eigen::internal::ploadu<Packet>(in + r * stride + j), &accum);
+        }
+        Eigen::internal::pstoreu(out + j, accum);
+      }
+      for (; j < width; ++j) {
+        T accum = reducer.initialize();
+        for (int64_t r = 0; r < rows; ++r) {
+          reducer.reduce(in[r * stride + j], &accum);
+        }
+        out[j] = accum;
+      }
+      return;
+    }
+    const int64_t half = rows / 2;
+    T bottom[kColumnBlock];
+    ReduceColumnBlock(in, half, stride, width, out);
+    ReduceColumnBlock(in + half * stride, rows - half, stride, width, bottom);
+    for (int64_t j = 0; j < width; ++j) reducer.reduce(bottom[j], &out[j]);
+  }
+};
+
+// Reduces `in` along `reduction_axes` into `out` with CpuReduction. Returns
+// false, without touching `out`, if the reducer, the type or the shape of the
+// reduction is not supported.
+template <typename Reducer, typename OUT_T, typename IN_T,
+          typename ReductionAxes>
+bool ReduceOnCpu(const Eigen::ThreadPoolDevice& d, OUT_T out, IN_T in,
+                 const ReductionAxes& reduction_axes) {
+  using Traits = CpuReductionTraits<Reducer>;
+  if constexpr (!Traits::kSupported) {
+    return false;
+  } else {
+    using T = typename Traits::Scalar;
+    using Engine = CpuReduction<T, typename Traits::BaseReducer>;
+    using Axes = std::decay_t<ReductionAxes>;
+    using Zero = Eigen::IndexList<Eigen::type2index<0>>;
+    using One = Eigen::IndexList<Eigen::type2index<1>>;
+    constexpr int kInDims = IN_T::NumDimensions;
+    if constexpr (!std::is_same_v<typename OUT_T::Scalar, T>) {
+      return false;
+    } else {
+      if (in.size() == 0 || out.size() == 0) return false;
+      const T* x = in.data();
+      T* y = out.data();
+      if constexpr (kInDims == 1 && std::is_same_v<Axes, Zero>) {
+        Engine::ReduceRows(d, x, 1, in.dimension(0), y);
+      } else if constexpr (kInDims == 2 && std::is_same_v<Axes, One>) {
+        Engine::ReduceRows(d, x, in.dimension(0), in.dimension(1), y);
+      } else if constexpr (kInDims == 2 && std::is_same_v<Axes, Zero>) {
+        Engine::ReduceColumns(d, x, 1, in.dimension(0), in.dimension(1), y);
+      } else if constexpr (kInDims == 3 && std::is_same_v<Axes, One>) {
+        Engine::ReduceColumns(d, x, in.dimension(0), in.dimension(1),
+                              in.dimension(2), y);
+      } else {
+        return false;
+      }
+      if constexpr (Traits::kIsMean) {
+        const T count = static_cast<T>(in.size() / out.size());
+        for (int64_t i = 0; i < out.size(); ++i) y[i] /= count;
+      }
+      return true;
+    }
+  }
+}
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_REDUCTION_OPS_CPU_H_
@@ -13,14 +13,115 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/reduction_ops_cpu.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 
+class CpuReductionTest : public ::testing::Test {
+ protected:
+  CpuReductionTest()
+      : pool_(Env::Default(), "reduction", 4),
+        device_(pool_.AsEigenThreadPool(), 4) {}
+
+  static std::vector<float> Iota(int64_t n) {
+    std::vector<float> values(n);
+    for (int64_t i = 0; i < n; ++i) values[i] = (i % 1000) * 0.001f - 0.25f;
+    return values;
+  }
+
+  thread::ThreadPool pool_;
+  Eigen::ThreadPoolDevice device_;
+};
+
+using SumEngine =
+    functor::CpuReduction<float, Eigen::internal::SumReducer<float>>;
+using MaxEngine = functor::CpuReduction<
+    float, Eigen::internal::MaxReducer<float, Eigen::PropagateNaN>>;
+
+TEST_F(CpuReductionTest, ReduceRows) {
+  // Row-parallel, and two-pass for the few long rows.
+  for (const auto& [rows, cols] : std::vector<std::pair<int64_t, int64_t>>{
+           {1, 1}, {1, 7}, {1000, 37}, {3, 100000}, {1, 1000003}}) {
+    const std::vector<float> in = Iota(rows * cols);
+    std::vector<float> sums(rows), maxes(rows);
+    SumEngine::ReduceRows(device_, in.data(), rows, cols, sums.data());
+    MaxEngine::ReduceRows(device_, in.data(), rows, cols, maxes.data());
+    for (int64_t r = 0; r < rows; ++r) {
+      double sum = 0;
+      float max = -std::numeric_limits<float>::infinity();
+      for (int64_t c = 0; c < cols; ++c) {
+        sum += in[r * cols + c];
+        max = std::max(max, in[r * cols + c]);
+      }
+      EXPECT_NEAR(sums[r], sum, 1e-5 * cols) << rows << "x" << cols;
+      EXPECT_EQ(maxes[r], max) << rows << "x" << cols;
+    }
+  }
+}
+
+TEST_F(CpuReductionTest, ReduceColumns) {
+  // Column-parallel, and two-pass for the few long columns.
+  for (const auto& [outer, rows, cols] :
+       std::vector<std::tuple<int64_t, int64_t, int64_t>>{
+           {1, 1, 1}, {1, 5, 7}, {4, 100, 1000}, {1, 100000, 3}}) {
+    const std::vector<float> in = Iota(outer * rows * cols);
+    std::vector<float> sums(outer * cols), maxes(outer * cols);
+    SumEngine::ReduceColumns(device_, in.data(), outer, rows, cols,
+                             sums.data());
+    MaxEngine::ReduceColumns(device_, in.data(), outer, rows, cols,
+                             maxes.data());
+    for (int64_t o = 0; o < outer; ++o) {
+      for (int64_t c = 0; c < cols; ++c) {
+        double sum = 0;
+        float max = -std::numeric_limits<float>::infinity();
+        for (int64_t r = 0; r < rows; ++r) {
+          sum += in[(o * rows + r) * cols + c];
+          max = std::max(max, in[(o * rows + r) * cols + c]);
+        }
+        EXPECT_NEAR(sums[o * cols + c], sum, 1e-5 * rows);
+        EXPECT_EQ(maxes[o * cols + c], max);
+      }
+    }
+  }
+}
+
+TEST_F(CpuReductionTest, PairwiseSumIsAccurate) {
+  // Summing 0.1 sequentially into a single float drifts by several percent at
+  // this size.
+  const int64_t n = 1 << 22;
+  std::vector<float> in(n, 0.1f);
+  float sum;
+  SumEngine::ReduceRows(device_, in.data(), 1, n, &sum);
+  EXPECT_NEAR(sum, 0.1 * n, 1e-5 * 0.1 * n);
+}
+
+TEST_F(CpuReductionTest, MaxPropagatesNaN) {
+  std::vector<float> in = Iota(10000);
+  in[5000] = std::numeric_limits<float>::quiet_NaN();
+  float max;
+  MaxEngine::ReduceRows(device_, in.data(), 1, in.size(), &max);
+  EXPECT_TRUE(std::isnan(max));
+  MaxEngine::ReduceColumns(device_, in.data(), 1, in.size(), 1, &max);
+  EXPECT_TRUE(std::isnan(max));
+}
+
 // Creates a Graph which "reduce"s a 3D float tensor of "num" elements
 // into a scalar.
 template <typename T>
@@ -248,6 +349,64 @@ static void BM_Bool2DToScalarGPU(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_Bool2DToScalarGPU)->RangePair(2048, 8192, 2048, 8192);
 
+// Sweeps the shapes handled by the row-parallel, column-parallel and two-pass
+// strategies of the CPU reductions.
+static void BM_Sum2DToScalarCPU(::testing::benchmark::State& state) {
+  const int num_x = state.range(0);
+  const int num_y = state.range(1);
+
+  ReduceToScalar<float>(state, "cpu", "Sum", num_x, num_y);
+}
+BENCHMARK(BM_Sum2DToScalarCPU)->RangePair(1, 8192, 1, 8192);
+
+static void BM_Sum2DRowReduceCPU(::testing::benchmark::State& state) {
+  const int num_x = state.range(0);
+  const int num_y = state.range(1);
+
+  DoRowReduce(state, "cpu", "Sum", num_x, num_y);
+}
+BENCHMARK(BM_Sum2DRowReduceCPU)->RangePair(1, 8192, 1, 8192);
+
+static void BM_Sum2DColumnReduceCPU(::testing::benchmark::State& state) {
+  const int num_x = state.range(0);
+  const int num_y = state.range(1);
+
+  DoColReduce(state, "cpu", "Sum", num_x, num_y);
+}
+BENCHMARK(BM_Sum2DColumnReduceCPU)->RangePair(1, 8192, 1, 8192);
+
+static void BM_Sum3DYReduceCPU(::testing::benchmark::State& state) {
+  const int num_x = state.range(0);
+  const int num_y = state.range(1);
+
+  Do3DYReduce(state, "cpu", "Sum", num_x, num_y);
+}
+BENCHMARK(BM_Sum3DYReduceCPU)->RangePair(64, 4096, 64, 4096);
+
+static void BM_Mean2DRowReduceCPU(::testing::benchmark::State& state) {
+  const int num_x = state.range(0);
+  const int num_y = state.range(1);
+
+  DoRowReduce(state, "cpu", "Mean", num_x, num_y);
+}
+BENCHMARK(BM_Mean2DRowReduceCPU)->RangePair(1, 8192, 1, 8192);
+
+static void BM_Max2DColumnReduceCPU(::testing::benchmark::State& state) {
+  const int num_x = state.range(0);
+  const int num_y = state.range(1);
+
+  DoColReduce(state, "cpu", "Max", num_x, num_y);
+}
+BENCHMARK(BM_Max2DColumnReduceCPU)->RangePair(1, 8192, 1, 8192);
+
+static void BM_Prod2DToScalarCPU(::testing::benchmark::State& state) {
+  const int num_x = state.range(0);
+  const int num_y = state.range(1);
+
+  ReduceToScalar<float>(state, "cpu", "Prod", num_x, num_y);
+}
+BENCHMARK(BM_Prod2DToScalarCPU)->RangePair(2048, 8192, 2048, 8192);
+
 static void BM_Mean2DToScalarCPUBF16(::testing::benchmark::State& state) {
   const int num_x = state.range(0);
   const int num_y = state.range(1);
@@ -0,0 +1,122 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/regex_fast_path.h"
+
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+
+#include "absl/strings/match.h"
+#include "absl/strings/string_view.h"
+
+namespace tensorflow {
+namespace {
+
+// Characters that have a special meaning in RE2 outside of character classes.
+constexpr absl::string_view kMetaCharacters = "\\.^$|?*+()[]{}";
+
+// Returns true if `text` cannot affect a match of ".*": it contains no
+// newline, which "." does not match, and no byte outside of ASCII, for which
+// the result would depend on how RE2 decodes UTF-8.
+bool IsPlainAscii(absl::string_view text) {
+  // Eight bytes at a time: a byte is special if its high bit is set, or if it
+  // becomes zero when xor'ed with a newline.
+  constexpr uint64_t kOnes = 0x0101010101010101ull;
+  constexpr uint64_t kHighBits = 0x8080808080808080ull;
+  constexpr uint64_t kNewlines = kOnes * '\n';
+  const char* p = text.data();
+  const char* end = p + text.size();
+  for (; end - p >= 8; p += 8) {
+    uint64_t word;
+    std::memcpy(&word, p, sizeof(word));
+    const uint64_t x = word ^ kNewlines;
+    if ((word | ((x - kOnes) & ~x)) & kHighBits) return false;
+  }
+  for (; p < end; ++p) {
+    if ((static_cast<unsigned char>(*p) & 0x80) || *p == '\n') return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+std::optional<LiteralRegex> LiteralRegex::Parse(absl::string_view pattern) {
+  bool leading_any = false;
+  bool trailing_any = false;
+  std::string literal;
+  for (size_t i = 0; i < pattern.size(); ++i) {
+    const char c = pattern[i];
+    if (c == '.' && i + 1 < pattern.size() && pattern[i + 1] == '*') {
+      if (i == 0) {
+        leading_any = true;
+      } else if (i + 2 == pattern.size()) {
+        trailing_any = true;
+      } else {
+        return std::nullopt;
+      }
+      ++i;
+    } else if (c == '\\') {
+      // Only escaped metacharacters are literals; other escapes denote
+      // character classes, anchors or special characters.
+      if (i + 1 == pattern.size() ||
+          kMetaCharacters.find(pattern[i + 1]) == absl::string_view::npos) {
+        return std::nullopt;
+      }
+      literal.push_back(pattern[++i]);
+    } else if (kMetaCharacters.find(c) != absl::string_view::npos ||
+               c == '\0' || (static_cast<unsigned char>(c) & 0x80)) {
+      return std::nullopt;
+    } else {
+      literal.push_back(c);
+    }
+  }
+  Kind kind = Kind::kExact;
+  if (leading_any && trailing_any) {
+    kind = Kind::kContains;
+  } else if (leading_any) {
+    kind = Kind::kSuffix;
+  } else if (trailing_any) {
+    kind = Kind::kPrefix;
+  }
+  return LiteralRegex(kind, std::move(literal));
+}
+
+std::optional<bool> LiteralRegex::FullMatch(absl::string_view input) const {
+  switch (kind_) {
+    case Kind::kExact:
+      return input == literal_;
+    case Kind::kPrefix:
+      if (!absl::StartsWith(input, literal_)) return false;
+      input.remove_prefix(literal_.size());
+      break;
+    case Kind::kSuffix:
+      if (!absl::EndsWith(input, literal_)) return false;
+      input.remove_suffix(literal_.size());
+      break;
+    case Kind::kContains:
+      // The literal may occur several times, and which occurrence the ".*"
+      // may surround depends on the newlines in the input.
+      if (!IsPlainAscii(input)) return std::nullopt;
+      return absl::StrContains(input, literal_);
+  }
+  // `input` is now the part that ".*" has to match.
+  if (IsPlainAscii(input)) return true;
+  if (input.find('\n') != absl::string_view::npos) return false;
+  return std::nullopt;
+}
+
+}  // namespace tensorflow
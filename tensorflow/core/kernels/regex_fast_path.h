@@ -0,0 +1,102 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_REGEX_FAST_PATH_H_
+#define TENSORFLOW_CORE_KERNELS_REGEX_FAST_PATH_H_
+
+// Regular expressions that reduce to comparisons of literal strings.
+//
+// RE2 runs an automaton over every input, even when the pattern is a plain
+// literal such as "foo", or a literal with a leading or trailing ".*".
+// Preprocessing graphs use such patterns a lot, and for them a byte
+// comparison or a memchr-based search is much cheaper. The fast paths below
+// reproduce the results of RE2 with its default options exactly, and report
+// when they cannot decide so that the caller falls back to RE2.
+
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+
+namespace tensorflow {
+
+class LiteralRegex {
+ public:
+  enum class Kind {
+    kExact,     // "literal"
+    kPrefix,    // "literal.*"
+    kSuffix,    // ".*literal"
+    kContains,  // ".*literal.*"
+  };
+
+  // Returns the literal form of `pattern`, or nullopt if it has none.
+  static std::optional<LiteralRegex> Parse(absl::string_view pattern);
+
+  Kind kind() const { return kind_; }
+  const std::string& literal() const { return literal_; }
+
+  // Returns RE2::FullMatch(input, pattern), or nullopt if the result depends
+  // on how RE2 treats non-ASCII input.
+  std::optional<bool> FullMatch(absl::string_view input) const;
+
+  // Replaces the first (or, if `global`, every non-overlapping) occurrence of
+  // the literal in `*str` by `rewrite`, like RE2::Replace and
+  // RE2::GlobalReplace. Returns false without modifying `*str` if that is not
+  // equivalent to RE2: when the pattern is not exact, the literal is empty or
+  // `rewrite` contains backslash escapes. `*str` is left alone, and not
+  // copied, if the literal does not occur in it.
+  template <typename String>
+  bool Replace(String* str, absl::string_view rewrite, bool global) const;
+
+ private:
+  LiteralRegex(Kind kind, std::string literal)
+      : kind_(kind), literal_(std::move(literal)) {}
+
+  Kind kind_;
+  std::string literal_;
+};
+
+// Implementation details follow.
+
+template <typename String>
+bool LiteralRegex::Replace(String* str, absl::string_view rewrite,
+                           bool global) const {
+  if (kind_ != Kind::kExact || literal_.empty() ||
+      rewrite.find('\\') != absl::string_view::npos) {
+    return false;
+  }
+  const String& in = *str;
+  const absl::string_view text(in.data(), in.size());
+  size_t pos = text.find(literal_);
+  if (pos == absl::string_view::npos) return true;
+
+  std::string out;
+  out.reserve(text.size());
+  size_t begin = 0;
+  do {
+    out.append(text.data() + begin, pos - begin);
+    out.append(rewrite.data(), rewrite.size());
+    begin = pos + literal_.size();
+    pos = global ? text.find(literal_, begin) : absl::string_view::npos;
+  } while (pos != absl::string_view::npos);
+  out.append(text.data() + begin, text.size() - begin);
+  *str = std::move(out);
+  return true;
+}
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_REGEX_FAST_PATH_H_
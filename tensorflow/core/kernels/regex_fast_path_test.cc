@@ -0,0 +1,122 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/regex_fast_path.h"
+
+#include <optional>
+#include <string>
+
+#include "re2/re2.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(LiteralRegexTest, Parse) {
+  struct Case {
+    const char* pattern;
+    LiteralRegex::Kind kind;
+    const char* literal;
+  };
+  const Case cases[] = {
+      {"", LiteralRegex::Kind::kExact, ""},
+      {"foo", LiteralRegex::Kind::kExact, "foo"},
+      {"a\\.b\\*", LiteralRegex::Kind::kExact, "a.b*"},
+      {"foo.*", LiteralRegex::Kind::kPrefix, "foo"},
+      {".*foo", LiteralRegex::Kind::kSuffix, "foo"},
+      {".*foo.*", LiteralRegex::Kind::kContains, "foo"},
+      {".*", LiteralRegex::Kind::kSuffix, ""},
+      {"http://x-y", LiteralRegex::Kind::kExact, "http://x-y"},
+  };
+  for (const Case& c : cases) {
+    std::optional<LiteralRegex> literal = LiteralRegex::Parse(c.pattern);
+    ASSERT_TRUE(literal.has_value()) << c.pattern;
+    EXPECT_EQ(literal->kind(), c.kind) << c.pattern;
+    EXPECT_EQ(literal->literal(), c.literal) << c.pattern;
+  }
+  for (const char* pattern :
+       {"a.b", "a*", "a.*b", "a\\.*", "^a", "a$", "a|b", "(a)", "[a]", "a{2}",
+        "\\d", "\\n", ".*?", "a.*?", "(?i)a", "\xc3\xa9", ".+"}) {
+    EXPECT_FALSE(LiteralRegex::Parse(pattern).has_value()) << pattern;
+  }
+}
+
+TEST(LiteralRegexTest, FullMatchAgreesWithRE2) {
+  const char* patterns[] = {"",       "foo",     "foo.*", ".*foo",
+                            ".*foo.*", ".*",     "a\\.b", ".*\n.*"};
+  const std::string inputs[] = {"",
+                                "foo",
+                                "fo",
+                                "foobar",
+                                "barfoo",
+                                "barfoobar",
+                                "a.b",
+                                "axb",
+                                "foo\nbar",
+                                "bar\nfoo",
+                                "\n",
+                                "foo\xc3\xa9",
+                                "\xc3\xa9" "foo",
+                                "foo\xff",
+                                std::string("foo\0bar", 7)};
+  for (const char* pattern : patterns) {
+    RE2 regex(pattern);
+    ASSERT_TRUE(regex.ok()) << pattern;
+    std::optional<LiteralRegex> literal = LiteralRegex::Parse(pattern);
+    ASSERT_TRUE(literal.has_value()) << pattern;
+    for (const std::string& input : inputs) {
+      std::optional<bool> match = literal->FullMatch(input);
+      if (match.has_value()) {
+        EXPECT_EQ(*match, RE2::FullMatch(input, regex))
+            << "pattern: " << pattern << " input: " << input;
+      }
+    }
+  }
+}
+
+TEST(LiteralRegexTest, ReplaceAgreesWithRE2) {
+  const char* patterns[] = {"a", "ab", "aa", "a\\.b"};
+  const std::string inputs[] = {"", "a", "b", "aaa", "abab", "xaby", "a.ba.b"};
+  for (const char* pattern : patterns) {
+    RE2 regex(pattern);
+    std::optional<LiteralRegex> literal = LiteralRegex::Parse(pattern);
+    ASSERT_TRUE(literal.has_value()) << pattern;
+    for (const std::string& input : inputs) {
+      for (bool global : {false, true}) {
+        std::string expected = input;
+        if (global) {
+          RE2::GlobalReplace(&expected, regex, "<>");
+        } else {
+          RE2::Replace(&expected, regex, "<>");
+        }
+        std::string actual = input;
+        ASSERT_TRUE(literal->Replace(&actual, "<>", global));
+        EXPECT_EQ(actual, expected)
+            << "pattern: " << pattern << " input: " << input;
+      }
+    }
+  }
+}
+
+TEST(LiteralRegexTest, ReplaceDefersToRE2) {
+  std::string str = "abc";
+  EXPECT_FALSE(LiteralRegex::Parse("b")->Replace(&str, "\\0\\0", true));
+  EXPECT_FALSE(LiteralRegex::Parse("")->Replace(&str, "x", true));
+  EXPECT_FALSE(LiteralRegex::Parse("b.*")->Replace(&str, "x", true));
+  EXPECT_EQ(str, "abc");
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -13,17 +13,36 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <optional>
 #include <string>
 
 #include "re2/re2.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/regex_fast_path.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
+namespace {
+
+// Matches every element of `input` against `regex`, preferring the literal
+// form of the pattern where it exists.
+void FullMatch(const RE2& regex, const std::optional<LiteralRegex>& literal,
+               const Tensor& input, Tensor* output) {
+  const auto& input_flat = input.flat<tstring>();
+  auto output_flat = output->flat<bool>();
+  for (size_t i = 0; i < input_flat.size(); ++i) {
+    std::optional<bool> match;
+    if (literal.has_value()) match = literal->FullMatch(input_flat(i));
+    output_flat(i) =
+        match.has_value() ? *match : RE2::FullMatch(input_flat(i), regex);
+  }
+}
+
+}  // namespace
 
 class RegexFullMatchOp : public OpKernel {
  public:
@@ -34,7 +53,6 @@ class RegexFullMatchOp : public OpKernel {
   void Compute(OpKernelContext* ctx) override {
     const Tensor* input_tensor;
     OP_REQUIRES_OK(ctx, ctx->input("input", &input_tensor));
-    const auto& input_flat = input_tensor->flat<tstring>();
 
     const Tensor* pattern_tensor;
     OP_REQUIRES_OK(ctx, ctx->input("pattern", &pattern_tensor));
@@ -50,10 +68,8 @@ class RegexFullMatchOp : public OpKernel {
     Tensor* output_tensor = nullptr;
     OP_REQUIRES_OK(ctx, ctx->allocate_output("output", input_tensor->shape(),
                                              &output_tensor));
-    auto output_flat = output_tensor->flat<bool>();
-    for (size_t i = 0; i < input_flat.size(); ++i) {
-      output_flat(i) = RE2::FullMatch(input_flat(i), *regex);
-    }
+    FullMatch(*regex, LiteralRegex::Parse(pattern), *input_tensor,
+              output_tensor);
   }
 
  private:
@@ -94,24 +110,22 @@ class StaticRegexFullMatchOp : public OpKernel {
     OP_REQUIRES(ctx, re_->ok(),
                 errors::InvalidArgument("Invalid pattern: ", pattern,
                                         ", error: ", re_->error()));
+    literal_ = LiteralRegex::Parse(pattern);
   }
 
   void Compute(OpKernelContext* ctx) override {
     const Tensor* input_tensor;
     OP_REQUIRES_OK(ctx, ctx->input("input", &input_tensor));
-    const auto& input_flat = input_tensor->flat<tstring>();
 
     Tensor* output_tensor = nullptr;
     OP_REQUIRES_OK(ctx, ctx->allocate_output("output", input_tensor->shape(),
                                              &output_tensor));
-    auto output_flat = output_tensor->flat<bool>();
-    for (size_t i = 0; i < input_flat.size(); ++i) {
-      output_flat(i) = RE2::FullMatch(input_flat(i), *re_);
-    }
+    FullMatch(*re_, literal_, *input_tensor, output_tensor);
   }
 
  private:
   std::unique_ptr<RE2> re_;
+  std::optional<LiteralRegex> literal_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("StaticRegexFullMatch").Device(DEVICE_CPU),
@@ -13,11 +13,13 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <optional>
 #include <string>
 
 #include "re2/re2.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/regex_fast_path.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -26,12 +28,15 @@ limitations under the License.
 namespace tensorflow {
 namespace {
 
-// Execute the specified regex using the given context.
+// Execute the specified regex using the given context. `literal` is the
+// literal form of the regex, if it has one.
 // Context requirements:
 //  - "input" string Tensor at input_index=0
 //  - "output" string Tensor at output_index=0
-Status InternalCompute(const RE2& regex, const string& rewrite,
-                       const bool replace_global, OpKernelContext* ctx) {
+Status InternalCompute(const RE2& regex,
+                       const std::optional<LiteralRegex>& literal,
+                       const string& rewrite, const bool replace_global,
+                       OpKernelContext* ctx) {
   const Tensor* input_tensor;
   TF_RETURN_IF_ERROR(ctx->input("input", &input_tensor));
   Tensor* output_tensor;
@@ -49,6 +54,12 @@ Status InternalCompute(const RE2& regex, const string& rewrite,
   }
   auto output_flat = output_tensor->flat<tstring>();
   for (size_t i = 0; i < output_flat.size(); ++i) {
+    // Literal patterns are replaced in place, and elements that do not
+    // contain them are not copied at all.
+    if (literal.has_value() &&
+        literal->Replace(&output_flat(i), rewrite, replace_global)) {
+      continue;
+    }
     // TODO(dero): Mitigate copy; Global and GlobalReplace below currently only
     // accept std::string.
     string buf = output_flat(i);
@@ -89,7 +100,8 @@ class RegexReplaceOp : public OpKernel {
                 errors::InvalidArgument("Rewrite must be scalar, but received ",
                                         rewrite_tensor->shape().DebugString()));
     const string& rewrite = rewrite_tensor->scalar<tstring>()();
-    OP_REQUIRES_OK(ctx, InternalCompute(*regex, rewrite, replace_global_, ctx));
+    OP_REQUIRES_OK(ctx, InternalCompute(*regex, LiteralRegex::Parse(pattern),
+                                        rewrite, replace_global_, ctx));
   }
 
  private:
@@ -131,17 +143,19 @@ class StaticRegexReplaceOp : public OpKernel {
     OP_REQUIRES(ctx, re_->ok(),
                 errors::InvalidArgument("Invalid pattern: ", pattern,
                                         ", error: ", re_->error()));
+    literal_ = LiteralRegex::Parse(pattern);
     OP_REQUIRES_OK(ctx, ctx->GetAttr("rewrite", &rewrite_str_));
     OP_REQUIRES_OK(ctx, ctx->GetAttr("replace_global", &replace_global_));
   }
 
   void Compute(OpKernelContext* ctx) override {
-    OP_REQUIRES_OK(ctx,
-                   InternalCompute(*re_, rewrite_str_, replace_global_, ctx));
+    OP_REQUIRES_OK(ctx, InternalCompute(*re_, literal_, rewrite_str_,
+                                        replace_global_, ctx));
   }
 
  private:
   std::unique_ptr<RE2> re_;
+  std::optional<LiteralRegex> literal_;
   string rewrite_str_;
   bool replace_global_;
 };
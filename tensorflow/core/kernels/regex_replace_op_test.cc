@@ -56,6 +56,8 @@ const char* lines[] = {
 
 const char kRegExPattern[] = "\\p{P}";
 const char kRewrite[] = " ";
+// Literal patterns are replaced without RE2.
+const char kLiteralPattern[] = "TensorFlow";
 
 Tensor GetTestTensor(int batch) {
   const int sz = TF_ARRAYSIZE(lines);
@@ -103,6 +105,25 @@ BENCHMARK(BM_RegexReplace)
     ->Arg(128)
     ->Arg(256);
 
+static void BM_RegexReplaceLiteral(::testing::benchmark::State& state) {
+  const int batch_size = state.range(0);
+
+  Tensor input = GetTestTensor(batch_size);
+  Graph* g = SetupRegexReplaceGraph(input, kLiteralPattern, kRewrite);
+  test::Benchmark("cpu", g, /*old_benchmark_api*/ false).Run(state);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_RegexReplaceLiteral)
+    ->UseRealTime()
+    ->Arg(1)
+    ->Arg(8)
+    ->Arg(16)
+    ->Arg(32)
+    ->Arg(64)
+    ->Arg(128)
+    ->Arg(256);
+
 Graph* SetupStaticGraph(const Tensor& input, const string& input_pattern,
                         const string& rewrite) {
   Graph* g = new Graph(OpRegistry::Global());
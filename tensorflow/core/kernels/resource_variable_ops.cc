@@ -57,6 +57,7 @@ limitations under the License.
 #include "tensorflow/core/platform/stream_executor.h"
 #endif
 
+#include <limits>
 #include <memory>
 #include <type_traits>
 #include <vector>
@@ -1049,8 +1050,11 @@ template <typename Device, typename T, typename Index, scatter_op::UpdateOp op>
 Status DoScatter(OpKernelContext* c, Tensor* params, const Tensor& indices,
                  const Tensor& updates, Index num_indices) {
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  // The GPU scatter functors are deterministic, except for more indices than
+  // their sort-based implementation supports.
   if (std::is_same<Device, GPUDevice>::value &&
-      tensorflow::OpDeterminismRequired() && !DisableScatterOpDeterminism()) {
+      tensorflow::OpDeterminismRequired() && !DisableScatterOpDeterminism() &&
+      num_indices > std::numeric_limits<int>::max()) {
     return DoScatterOnCpu<T, Index, op>(c, params, indices, updates,
                                         num_indices);
   }
@@ -1135,6 +1139,9 @@ class ResourceScatterUpdateOp : public OpKernel {
       tf_shared_lock ml(*v->mu());
       DoCompute(c);
     }
+    if (isCPUDevice<Device>() && c->status().ok()) {
+      v->MarkRowsTouched(c->input(1));
+    }
   }
 
  private:
@@ -405,15 +405,64 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
     return errors::InvalidArgument(error_msg);
   }
 
-  // Split restore ops into two groups: large and small. We schedule
-  // large ops first, to prevent them from waiting on the small op.
+  const int num_threads =
+      context->session_config() != nullptr &&
+              context->session_config()->intra_op_parallelism_threads() > 0
+          ? context->session_config()->intra_op_parallelism_threads()
+          : 8;
+
+  // Full tensors are mapped from the data files if requested, or else
+  // restored together, with large reads issued concurrently.
+  const bool mmap_restored_variables =
+      context->session_config() != nullptr &&
+      context->session_config()->experimental().mmap_restored_variables();
+  std::vector<string> batch_keys;
+  std::vector<Tensor*> batch_tensors;
+  std::vector<RestoreOp*> sliced_restore_ops;
+  int num_mapped = 0;
+  for (RestoreOp& restore_op : restore_ops) {
+    if (!restore_op.shape_and_slice.empty()) {
+      sliced_restore_ops.push_back(&restore_op);
+      continue;
+    }
+    if (mmap_restored_variables) {
+      Tensor restored_tensor;
+      bool is_mapped;
+      TF_RETURN_IF_ERROR(default_reader.LookupMapped(
+          restore_op.tensor_name, &restored_tensor, &is_mapped));
+      context->set_output(restore_op.idx, restored_tensor);
+      if (is_mapped) ++num_mapped;
+      continue;
+    }
+    TensorShape restored_full_shape;
+    TF_RETURN_IF_ERROR(default_reader.LookupTensorShape(
+        restore_op.tensor_name, &restored_full_shape));
+    Tensor* restored_tensor;
+    TF_RETURN_IF_ERROR(context->allocate_output(
+        restore_op.idx, restored_full_shape, &restored_tensor));
+    batch_keys.push_back(restore_op.tensor_name);
+    batch_tensors.push_back(restored_tensor);
+  }
+  if (mmap_restored_variables) {
+    VLOG(1) << "Mapped " << num_mapped << " restored tensors";
+  }
+  if (!batch_keys.empty()) {
+    VLOG(1) << "Restoring " << batch_keys.size() << " full tensors";
+    BundleReader::LookupBatchOptions options;
+    options.num_threads = num_threads;
+    TF_RETURN_IF_ERROR(
+        default_reader.LookupBatch(batch_keys, batch_tensors, options));
+  }
+
+  // Split the sliced restore ops into two groups: large and small. We
+  // schedule large ops first, to prevent them from waiting on the small op.
   std::vector<RestoreOp*> large_restore_ops;
   std::vector<RestoreOp*> small_restore_ops;
-  for (RestoreOp& restore_op : restore_ops) {
-    if (restore_op.is_large_shape(&default_reader)) {
-      large_restore_ops.push_back(&restore_op);
+  for (RestoreOp* restore_op : sliced_restore_ops) {
+    if (restore_op->is_large_shape(&default_reader)) {
+      large_restore_ops.push_back(restore_op);
     } else {
-      small_restore_ops.push_back(&restore_op);
+      small_restore_ops.push_back(restore_op);
     }
   }
 
@@ -20,9 +20,16 @@ limitations under the License.
 
 #define EIGEN_USE_GPU
 
+#include <limits>
+#include <type_traits>
+
 #include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/kernels/gpu_prim_helpers.h"
 #include "tensorflow/core/kernels/scatter_functor.h"
+#include "tensorflow/core/kernels/scatter_nd_util.h"
+#include "tensorflow/core/kernels/segment_reduction_ops_gpu.cu.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/determinism.h"
 #include "tensorflow/core/util/gpu_kernel_helper.h"
 
 namespace tensorflow {
@@ -124,6 +131,222 @@ __global__ void ScatterScalarOpCustomKernel(T* __restrict__ params,
   }
 }
 
+// The sort-based implementation below groups the updates by index. The updates
+// of each index are reduced in their original order, and each element of
+// params is then updated by a single thread, so the result is deterministic.
+
+// The reduction that combines the updates of an index, and its identity.
+template <typename T, scatter_op::UpdateOp op>
+struct SortedScatterReduction;
+
+template <typename T>
+struct SortedScatterReduction<T, scatter_op::UpdateOp::ADD> {
+  using ReduceOp = functor::Sum;
+  static T Identity() { return T(0); }
+};
+
+template <typename T>
+struct SortedScatterReduction<T, scatter_op::UpdateOp::SUB>
+    : SortedScatterReduction<T, scatter_op::UpdateOp::ADD> {};
+
+template <typename T>
+struct SortedScatterReduction<T, scatter_op::UpdateOp::MUL> {
+  using ReduceOp = functor::Prod;
+  static T Identity() { return T(1); }
+};
+
+template <typename T>
+struct SortedScatterReduction<T, scatter_op::UpdateOp::DIV>
+    : SortedScatterReduction<T, scatter_op::UpdateOp::MUL> {};
+
+template <typename T>
+struct SortedScatterReduction<T, scatter_op::UpdateOp::MIN> {
+  using ReduceOp = functor::Min;
+  static T Identity() { return functor::Highest<T>()(); }
+};
+
+template <typename T>
+struct SortedScatterReduction<T, scatter_op::UpdateOp::MAX> {
+  using ReduceOp = functor::Max;
+  static T Identity() { return functor::Lowest<T>()(); }
+};
+
+// Applies the reduced updates of an index to an element of params.
+template <typename T, scatter_op::UpdateOp op>
+struct SortedScatterApply;
+
+template <typename T>
+struct SortedScatterApply<T, scatter_op::UpdateOp::ADD> {
+  __device__ T operator()(T param, T update) const { return param + update; }
+};
+
+template <typename T>
+struct SortedScatterApply<T, scatter_op::UpdateOp::SUB> {
+  __device__ T operator()(T param, T update) const { return param - update; }
+};
+
+template <typename T>
+struct SortedScatterApply<T, scatter_op::UpdateOp::MUL> {
+  __device__ T operator()(T param, T update) const { return param * update; }
+};
+
+template <typename T>
+struct SortedScatterApply<T, scatter_op::UpdateOp::DIV> {
+  __device__ T operator()(T param, T update) const { return param / update; }
+};
+
+template <typename T>
+struct SortedScatterApply<T, scatter_op::UpdateOp::MIN> {
+  __device__ T operator()(T param, T update) const {
+    return functor::Min()(param, update);
+  }
+};
+
+template <typename T>
+struct SortedScatterApply<T, scatter_op::UpdateOp::MAX> {
+  __device__ T operator()(T param, T update) const {
+    return functor::Max()(param, update);
+  }
+};
+
+// Applies `reduced[run_ids[i]]` to params at the first position `i` of each
+// run of equal `sorted_indices`.
+template <typename T, typename Index, scatter_op::UpdateOp op>
+__global__ void ScatterReducedRunsKernel(
+    T* __restrict__ params, const T* __restrict__ reduced,
+    const Index* __restrict__ sorted_indices,
+    const Index* __restrict__ run_ids, Index first_dim_size,
+    Index indices_size, Index update_block) {
+  SortedScatterApply<T, op> apply;
+  GPU_1D_KERNEL_LOOP(i, indices_size * update_block) {
+    const Index row = i / update_block;
+    const Index index = sorted_indices[row];
+    if (row > 0 && sorted_indices[row - 1] == index) continue;
+    if (!(index >= 0 && index < first_dim_size)) {
+      // Ignore indices that are out of range.
+      continue;
+    }
+    const Index col = i % update_block;
+    const int64 params_i = static_cast<int64>(index) * update_block + col;
+    params[params_i] = apply(
+        params[params_i],
+        ldg(reduced + static_cast<int64>(run_ids[row]) * update_block + col));
+  }
+}
+
+// Assigns the last update of each run of equal `sorted_indices`, which is the
+// last one in the original order since the sort is stable.
+template <typename T, typename Index>
+__global__ void ScatterAssignLastKernel(
+    T* __restrict__ params, const T* __restrict__ updates,
+    const Index* __restrict__ sorted_indices,
+    const Index* __restrict__ permutation, Index first_dim_size,
+    Index indices_size, Index update_block) {
+  GPU_1D_KERNEL_LOOP(i, indices_size * update_block) {
+    const Index row = i / update_block;
+    const Index index = sorted_indices[row];
+    if (row + 1 < indices_size && sorted_indices[row + 1] == index) continue;
+    if (!(index >= 0 && index < first_dim_size)) {
+      // Ignore indices that are out of range.
+      continue;
+    }
+    const Index col = i % update_block;
+    params[static_cast<int64>(index) * update_block + col] = ldg(
+        updates + static_cast<int64>(permutation[row]) * update_block + col);
+  }
+}
+
+// Atomic updates of the same element of params are serialized, so when many
+// updates go to each row the sort-based implementation is also faster.
+constexpr int64 kMinUpdatesPerRowForSortedScatter = 32;
+
+template <scatter_op::UpdateOp op>
+bool UseSortedScatter(int64 indices_size, int64 first_dim_size) {
+  if (indices_size < 2 || indices_size > std::numeric_limits<int>::max()) {
+    return false;
+  }
+  if (OpDeterminismRequired() && !DisableScatterOpDeterminism()) return true;
+  // Assignments are plain stores, which do not contend.
+  return op != scatter_op::UpdateOp::ASSIGN &&
+         indices_size >= kMinUpdatesPerRowForSortedScatter * first_dim_size;
+}
+
+template <typename T, typename Index, scatter_op::UpdateOp op>
+Status SortedScatter(OpKernelContext* c, const GPUDevice& d, T* params,
+                     const T* updates, const Index* indices,
+                     Index first_dim_size, Index indices_size,
+                     Index update_block) {
+  // Sort the indices, keeping the permutation of the updates. The radix sort
+  // is stable.
+  Tensor sorted_indices;
+  TF_RETURN_IF_ERROR(c->allocate_temp(DataTypeToEnum<Index>::value,
+                                      TensorShape({indices_size}),
+                                      &sorted_indices));
+  Tensor permutation;
+  TF_RETURN_IF_ERROR(c->allocate_temp(DataTypeToEnum<Index>::value,
+                                      TensorShape({indices_size}),
+                                      &permutation));
+  Index* sorted_indices_ptr = sorted_indices.flat<Index>().data();
+  Index* permutation_ptr = permutation.flat<Index>().data();
+  // Note: We must sort using all bits because indices may be negative.
+  TF_RETURN_IF_ERROR(GpuRadixSort(c, static_cast<int>(indices_size),
+                                  /*keys_in=*/indices,
+                                  /*keys_out=*/sorted_indices_ptr,
+                                  /*indices_in=*/static_cast<const Index*>(
+                                      nullptr),
+                                  /*indices_out=*/permutation_ptr));
+
+  const Index update_size = indices_size * update_block;
+  GpuLaunchConfig config = GetGpuLaunchConfig(update_size, d);
+  if constexpr (op == scatter_op::UpdateOp::ASSIGN) {
+    return GpuLaunchKernel(ScatterAssignLastKernel<T, Index>,
+                           config.block_count, config.thread_per_block, 0,
+                           d.stream(), params, updates, sorted_indices_ptr,
+                           permutation_ptr, first_dim_size, indices_size,
+                           update_block);
+  } else {
+    // Number the runs of equal indices, and reduce the updates of each run.
+    using CountIter = gpuprim::CountingInputIterator<Index>;
+    using EdgeIndicatorIter = gpuprim::TransformInputIterator<
+        Index, functor::EdgeIndicatorFunctor<Index>, CountIter>;
+    EdgeIndicatorIter edge_indicator(
+        CountIter(0), functor::EdgeIndicatorFunctor<Index>(sorted_indices_ptr));
+    Tensor run_ids;
+    TF_RETURN_IF_ERROR(c->allocate_temp(DataTypeToEnum<Index>::value,
+                                        TensorShape({indices_size}),
+                                        &run_ids));
+    Index* run_ids_ptr = run_ids.flat<Index>().data();
+    TF_RETURN_IF_ERROR(GpuInclusivePrefixSum(c, static_cast<int>(indices_size),
+                                             edge_indicator, run_ids_ptr));
+
+    // The number of runs is only known on the device, so `reduced` has room
+    // for as many runs as there are updates.
+    Tensor reduced;
+    TF_RETURN_IF_ERROR(c->allocate_temp(
+        DataTypeToEnum<T>::value, TensorShape({indices_size, update_block}),
+        &reduced));
+    T* reduced_ptr = reduced.flat<T>().data();
+    using Reduction = SortedScatterReduction<T, op>;
+    using ReduceOp = typename Reduction::ReduceOp;
+    using Treduce = typename ReduceType<ReduceOp, T>::type;
+    using Tweights = typename RealTypeIfComplex<T>::type;
+    TF_RETURN_IF_ERROR(SegmentReduceGPU<Treduce>(
+        c, /*nouter=*/indices_size, /*ninner=*/update_block,
+        /*nsegments=*/indices_size, ReduceOp(),
+        /*initial_value=*/Reduction::Identity(),
+        /*empty_segment_value=*/Reduction::Identity(), /*is_mean=*/false,
+        /*is_sqrtn=*/false, /*input=*/updates, /*segment_ids=*/run_ids_ptr,
+        /*indices=*/permutation_ptr,
+        /*weights=*/static_cast<Tweights*>(nullptr), reduced_ptr));
+
+    return GpuLaunchKernel(ScatterReducedRunsKernel<T, Index, op>,
+                           config.block_count, config.thread_per_block, 0,
+                           d.stream(), params, reduced_ptr, sorted_indices_ptr,
+                           run_ids_ptr, first_dim_size, indices_size,
+                           update_block);
+  }
+}
+
 }  // namespace scatter_op_gpu
 
 namespace functor {
@@ -140,6 +363,13 @@ struct ScatterFunctor<GPUDevice, T, Index, op> {
     const Index first_dim_size = params.dimension(0);
     const Index indices_size = indices.size();
     const Index updates_size = updates.size();
+    if (scatter_op_gpu::UseSortedScatter<op>(indices_size, first_dim_size)) {
+      Status s = scatter_op_gpu::SortedScatter<T, Index, op>(
+          c, d, params.data(), updates.data(), indices.data(), first_dim_size,
+          indices_size, updates_size / indices_size);
+      if (!s.ok()) c->SetStatus(s);
+      return -1;
+    }
     GpuLaunchConfig config = GetGpuLaunchConfig(updates_size, d);
     TF_CHECK_OK(GpuLaunchKernel(
         scatter_op_gpu::ScatterOpCustomKernel<T, Index, op>, config.block_count,
@@ -859,8 +859,27 @@ struct UnsortedSegmentFunctor<GPUDevice, T, Index, InitialValueF, ReductionF> {
       return;
     }
 
+    // Launch kernel(s) to compute unsorted segment reduction.
+    // Notes:
+    // *) 'data_size' is the total number of elements to process.
+    // *) 'segment_ids.shape' is a prefix of data's shape.
+    // *) 'input_outer_dim_size' is the total number of segments to process.
+    const Index input_outer_dim_size = unsorted_segment_ids.dimension(0);
+    const Index input_inner_dim_size = data.dimension(1);
+    const Index output_outer_dim_size = output.dimension(0);
+    const Index num_segments = output.size() / input_inner_dim_size;
+
+    // Atomic updates of the same output element are serialized, so when many
+    // rows go to each segment the sort-based kernels are faster as well as
+    // deterministic. The radix sort is limited to int32 sizes.
+    static constexpr int64_t kMinRowsPerSegmentForSort = 32;
+    const bool high_collision =
+        static_cast<int64_t>(input_outer_dim_size) >=
+            kMinRowsPerSegmentForSort * static_cast<int64_t>(num_segments) &&
+        input_outer_dim_size <= std::numeric_limits<int>::max();
+
     bool use_deterministic_kernels =
-        UseDeterministicSegmentReductions() ||
+        UseDeterministicSegmentReductions() || high_collision ||
         (!ReduceOpIsAssociative<ReductionF, T>::value &&
          OpDeterminismRequired());
 
@@ -875,16 +894,6 @@ struct UnsortedSegmentFunctor<GPUDevice, T, Index, InitialValueF, ReductionF> {
             "Deterministic GPU implementation of unsorted segment reduction op"
             " not available."));
 
-    // Launch kernel(s) to compute unsorted segment reduction.
-    // Notes:
-    // *) 'data_size' is the total number of elements to process.
-    // *) 'segment_ids.shape' is a prefix of data's shape.
-    // *) 'input_outer_dim_size' is the total number of segments to process.
-    const Index input_outer_dim_size = unsorted_segment_ids.dimension(0);
-    const Index input_inner_dim_size = data.dimension(1);
-    const Index output_outer_dim_size = output.dimension(0);
-    const Index num_segments = output.size() / input_inner_dim_size;
-
     // TODO(benbarsdell): If there are no performance concerns with the new
     // deterministic kernels, remove this runtime check and the old
     // non-deterministic kernels.
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/online_softmax_cpu.h"
 #include "tensorflow/core/kernels/softmax_op_functor.h"
 
 namespace tensorflow {
@@ -30,8 +31,9 @@ namespace tensorflow {
 typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
-// Partial specialization for a CPUDevice, that uses the Eigen implementation
-// from SoftmaxEigenImpl.
+// Partial specialization for a CPUDevice, that uses the single-pass
+// OnlineSoftmaxCpu for float and double and the Eigen implementation from
+// SoftmaxEigenImpl otherwise.
 namespace functor {
 template <typename Device, typename T>
 struct SoftmaxFunctorBase {
@@ -41,7 +43,17 @@ struct SoftmaxFunctorBase {
   }
 };
 template <typename T>
-struct SoftmaxFunctor<CPUDevice, T> : SoftmaxFunctorBase<CPUDevice, T> {};
+struct SoftmaxFunctor<CPUDevice, T> : SoftmaxFunctorBase<CPUDevice, T> {
+  void operator()(const CPUDevice& d, typename TTypes<T>::ConstMatrix logits,
+                  typename TTypes<T>::Matrix softmax, const bool log) {
+    if constexpr (IsOnlineSoftmaxType<T>()) {
+      OnlineSoftmaxCpu<T>::Softmax(d, logits.data(), logits.dimension(0),
+                                   logits.dimension(1), softmax.data(), log);
+    } else {
+      SoftmaxFunctorBase<CPUDevice, T>::operator()(d, logits, softmax, log);
+    }
+  }
+};
 
 }  // namespace functor
 
@@ -0,0 +1,219 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/framework/lookup_interface.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/graph_def_builder.h"
+#include "tensorflow/core/kernels/lookup_table_op.h"
+#include "tensorflow/core/kernels/sorted_lookup_table_file.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace lookup {
+
+// Immutable lookup table backed by a SortedLookupTableFile. The file is
+// memory-mapped rather than copied into the heap, so processes serving the
+// same table share its pages, and creating the table does not read its
+// entries. Lookups binary search the sorted keys.
+template <class K, class V>
+class SortedFileLookupTable final : public LookupInterface {
+ public:
+  SortedFileLookupTable(OpKernelContext* ctx, OpKernel* kernel) {
+    const Tensor& filename = ctx->input(0);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(filename.shape()),
+                errors::InvalidArgument("filename must be a scalar, got ",
+                                        filename.shape().DebugString()));
+    filename_ = filename.scalar<tstring>()();
+    OP_REQUIRES_OK(ctx,
+                   SortedLookupTableFile::Open(ctx->env(), filename_, &file_));
+    OP_REQUIRES(
+        ctx,
+        file_->key_dtype() == key_dtype() &&
+            file_->value_dtype() == value_dtype(),
+        errors::InvalidArgument(
+            "The table in ", filename_, " maps ",
+            DataTypeString(file_->key_dtype()), " keys to ",
+            DataTypeString(file_->value_dtype()), " values, expected ",
+            DataTypeString(key_dtype()), " keys and ",
+            DataTypeString(value_dtype()), " values."));
+  }
+
+  size_t size() const override {
+    return file_ == nullptr ? 0 : file_->size();
+  }
+
+  Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
+              const Tensor& default_value) override {
+    const auto key_values = key.flat<K>();
+    auto value_values = value->flat<V>();
+    const auto default_flat = default_value.flat<V>();
+    const bool is_full_size_default =
+        value_values.size() == default_flat.size();
+
+    auto find = [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        const int64_t index = FindKey(SubtleMustCopyIfIntegral(key_values(i)));
+        if (index < 0) {
+          value_values(i) = default_flat(is_full_size_default ? i : 0);
+        } else {
+          GetValue(index, &value_values(i));
+        }
+      }
+    };
+    if (ctx == nullptr) {
+      find(0, key_values.size());
+      return absl::OkStatus();
+    }
+    auto* worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          key_values.size(), kCostPerKey, find);
+    return absl::OkStatus();
+  }
+
+  Status Insert(OpKernelContext* ctx, const Tensor& keys,
+                const Tensor& values) override {
+    return errors::Unimplemented("SortedFileLookupTable is immutable.");
+  }
+
+  Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
+    return errors::Unimplemented("SortedFileLookupTable is immutable.");
+  }
+
+  Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
+                      const Tensor& values) override {
+    return errors::Unimplemented("SortedFileLookupTable is immutable.");
+  }
+
+  Status ExportValues(OpKernelContext* ctx) override {
+    const int64_t size = file_->size();
+    Tensor* keys;
+    Tensor* values;
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_output("keys", TensorShape({size}), &keys));
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_output("values", TensorShape({size}), &values));
+    auto keys_data = keys->flat<K>();
+    auto values_data = values->flat<V>();
+    for (int64_t i = 0; i < size; ++i) {
+      GetKey(i, &keys_data(i));
+      GetValue(i, &values_data(i));
+    }
+    return absl::OkStatus();
+  }
+
+  Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
+    Node* filename = ops::SourceOp(
+        "Const", builder->opts()
+                     .WithAttr("dtype", DT_STRING)
+                     .WithAttr("value", Tensor(tstring(filename_))));
+    *out = ops::UnaryOp(
+        "SortedFileLookupTable", filename,
+        builder->opts()
+            .WithName(UniqueNodeName("SortedFileLookupTableFromGraphDef"))
+            .WithAttr("key_dtype", key_dtype())
+            .WithAttr("value_dtype", value_dtype())
+            .WithAttr("use_node_name_sharing", true));
+    return absl::OkStatus();
+  }
+
+  DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
+
+  DataType value_dtype() const override { return DataTypeToEnum<V>::v(); }
+
+  TensorShape key_shape() const override { return TensorShape(); }
+
+  TensorShape value_shape() const override { return TensorShape(); }
+
+  // Mapped pages are not counted, as they are shared with other processes
+  // and evictable.
+  int64_t MemoryUsed() const override {
+    return file_ == nullptr ? 0 : file_->heap_bytes();
+  }
+
+ private:
+  // A binary search takes about a cache miss per level.
+  static constexpr int64_t kCostPerKey = 1000;
+
+  int64_t FindKey(int64_t key) const { return file_->FindInt64(key); }
+  int64_t FindKey(const tstring& key) const {
+    return file_->FindString(absl::string_view(key));
+  }
+
+  void GetKey(int64_t i, int64_t* key) const { *key = file_->Int64KeyAt(i); }
+  void GetKey(int64_t i, tstring* key) const {
+    const absl::string_view k = file_->StringKeyAt(i);
+    key->assign(k.data(), k.size());
+  }
+
+  void GetValue(int64_t i, int64_t* value) const {
+    *value = file_->Int64ValueAt(i);
+  }
+  void GetValue(int64_t i, tstring* value) const {
+    const absl::string_view v = file_->StringValueAt(i);
+    value->assign(v.data(), v.size());
+  }
+
+  std::string filename_;
+  std::unique_ptr<SortedLookupTableFile> file_;
+};
+
+}  // namespace lookup
+
+// Writes the pairs of `keys` and `values` to a file that SortedFileLookupTable
+// maps.
+class WriteSortedLookupTableFileOp : public OpKernel {
+ public:
+  explicit WriteSortedLookupTableFileOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& filename = ctx->input(0);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(filename.shape()),
+                errors::InvalidArgument("filename must be a scalar, got ",
+                                        filename.shape().DebugString()));
+    OP_REQUIRES_OK(ctx, lookup::SortedLookupTableFile::Write(
+                            ctx->env(), filename.scalar<tstring>()(),
+                            ctx->input(1), ctx->input(2)));
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("WriteSortedLookupTableFile").Device(DEVICE_CPU),
+                        WriteSortedLookupTableFileOp);
+
+#define REGISTER_KERNEL(key_dtype, value_dtype)                            \
+  REGISTER_KERNEL_BUILDER(                                                 \
+      Name("SortedFileLookupTable")                                        \
+          .Device(DEVICE_CPU)                                              \
+          .TypeConstraint<key_dtype>("key_dtype")                          \
+          .TypeConstraint<value_dtype>("value_dtype"),                     \
+      LookupTableOp<lookup::SortedFileLookupTable<key_dtype, value_dtype>, \
+                    key_dtype, value_dtype>)
+
+REGISTER_KERNEL(int64_t, int64_t);
+REGISTER_KERNEL(int64_t, tstring);
+REGISTER_KERNEL(tstring, int64_t);
+REGISTER_KERNEL(tstring, tstring);
+
+#undef REGISTER_KERNEL
+
+}  // namespace tensorflow
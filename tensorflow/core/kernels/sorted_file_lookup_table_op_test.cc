@@ -0,0 +1,164 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/lookup_interface.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/kernels/sorted_lookup_table_file.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+std::string TableFilename(const std::string& name) {
+  return io::JoinPath(testing::TmpDir(), name);
+}
+
+TEST(SortedLookupTableFileTest, WriteAndFind) {
+  const std::string filename = TableFilename("string_to_int64");
+  TF_ASSERT_OK(lookup::SortedLookupTableFile::Write(
+      Env::Default(), filename,
+      test::AsTensor<tstring>({"pear", "apple", "fig", ""}),
+      test::AsTensor<int64_t>({3, 1, 2, 0})));
+
+  std::unique_ptr<lookup::SortedLookupTableFile> file;
+  TF_ASSERT_OK(
+      lookup::SortedLookupTableFile::Open(Env::Default(), filename, &file));
+  EXPECT_EQ(file->key_dtype(), DT_STRING);
+  EXPECT_EQ(file->value_dtype(), DT_INT64);
+  EXPECT_EQ(file->size(), 4);
+  EXPECT_EQ(file->heap_bytes(), 0);
+  // The keys are sorted.
+  EXPECT_EQ(file->StringKeyAt(0), "");
+  EXPECT_EQ(file->StringKeyAt(1), "apple");
+  EXPECT_EQ(file->StringKeyAt(3), "pear");
+  EXPECT_EQ(file->Int64ValueAt(file->FindString("fig")), 2);
+  EXPECT_EQ(file->Int64ValueAt(file->FindString("pear")), 3);
+  EXPECT_EQ(file->Int64ValueAt(file->FindString("")), 0);
+  EXPECT_EQ(file->FindString("grape"), -1);
+  EXPECT_EQ(file->FindString("zucchini"), -1);
+}
+
+TEST(SortedLookupTableFileTest, WriteEmptyTable) {
+  const std::string filename = TableFilename("empty");
+  TF_ASSERT_OK(lookup::SortedLookupTableFile::Write(
+      Env::Default(), filename, Tensor(DT_INT64, TensorShape({0})),
+      Tensor(DT_STRING, TensorShape({0}))));
+  std::unique_ptr<lookup::SortedLookupTableFile> file;
+  TF_ASSERT_OK(
+      lookup::SortedLookupTableFile::Open(Env::Default(), filename, &file));
+  EXPECT_EQ(file->size(), 0);
+  EXPECT_EQ(file->FindInt64(1), -1);
+}
+
+TEST(SortedLookupTableFileTest, DuplicateKeys) {
+  EXPECT_TRUE(errors::IsInvalidArgument(lookup::SortedLookupTableFile::Write(
+      Env::Default(), TableFilename("duplicates"),
+      test::AsTensor<int64_t>({4, 2, 4}), test::AsTensor<int64_t>({1, 2, 3}))));
+}
+
+TEST(SortedLookupTableFileTest, NotATableFile) {
+  const std::string filename = TableFilename("not_a_table");
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename,
+                                 std::string(64, 'x')));
+  std::unique_ptr<lookup::SortedLookupTableFile> file;
+  EXPECT_TRUE(errors::IsDataLoss(
+      lookup::SortedLookupTableFile::Open(Env::Default(), filename, &file)));
+}
+
+TEST(SortedLookupTableFileTest, TruncatedFile) {
+  const std::string filename = TableFilename("truncated");
+  TF_ASSERT_OK(lookup::SortedLookupTableFile::Write(
+      Env::Default(), filename, test::AsTensor<int64_t>({1, 2, 3}),
+      test::AsTensor<int64_t>({4, 5, 6})));
+  std::string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filename, &contents));
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename,
+                                 contents.substr(0, contents.size() - 8)));
+  std::unique_ptr<lookup::SortedLookupTableFile> file;
+  EXPECT_TRUE(errors::IsDataLoss(
+      lookup::SortedLookupTableFile::Open(Env::Default(), filename, &file)));
+}
+
+class SortedFileLookupTableOpTest : public OpsTestBase {
+ protected:
+  // Runs SortedFileLookupTable on `filename` and returns the table it creates.
+  core::RefCountPtr<lookup::LookupInterface> MakeTable(
+      const std::string& filename, DataType key_dtype, DataType value_dtype) {
+    TF_CHECK_OK(NodeDefBuilder("table", "SortedFileLookupTable")
+                    .Input(FakeInput(DT_STRING))
+                    .Attr("key_dtype", key_dtype)
+                    .Attr("value_dtype", value_dtype)
+                    .Finalize(node_def()));
+    TF_CHECK_OK(InitOp());
+    AddInputFromArray<tstring>(TensorShape({}), {filename});
+    TF_CHECK_OK(RunOpKernel());
+    const ResourceHandle& handle = GetOutput(0)->scalar<ResourceHandle>()();
+    lookup::LookupInterface* table = nullptr;
+    TF_CHECK_OK(device_->resource_manager()->Lookup(handle.container(),
+                                                    handle.name(), &table));
+    return core::RefCountPtr<lookup::LookupInterface>(table);
+  }
+};
+
+TEST_F(SortedFileLookupTableOpTest, Find) {
+  const std::string filename = TableFilename("int64_to_string");
+  TF_ASSERT_OK(lookup::SortedLookupTableFile::Write(
+      Env::Default(), filename, test::AsTensor<int64_t>({30, -10, 20}),
+      test::AsTensor<tstring>({"c", "a", "b"})));
+  core::RefCountPtr<lookup::LookupInterface> table =
+      MakeTable(filename, DT_INT64, DT_STRING);
+  EXPECT_EQ(table->size(), 3);
+  EXPECT_EQ(table->MemoryUsed(), 0);
+
+  Tensor values(DT_STRING, TensorShape({2, 2}));
+  TF_ASSERT_OK(table->Find(context_.get(),
+                           test::AsTensor<int64_t>({20, 25, -10, 30}, {2, 2}),
+                           &values, test::AsScalar<tstring>("?")));
+  test::ExpectTensorEqual<tstring>(
+      values, test::AsTensor<tstring>({"b", "?", "a", "c"}, {2, 2}));
+
+  EXPECT_TRUE(errors::IsUnimplemented(
+      table->Insert(context_.get(), test::AsTensor<int64_t>({1}),
+                    test::AsTensor<tstring>({"d"}))));
+}
+
+TEST_F(SortedFileLookupTableOpTest, MismatchedDataTypes) {
+  const std::string filename = TableFilename("int64_to_int64");
+  TF_ASSERT_OK(lookup::SortedLookupTableFile::Write(
+      Env::Default(), filename, test::AsTensor<int64_t>({1}),
+      test::AsTensor<int64_t>({2})));
+  TF_ASSERT_OK(NodeDefBuilder("table", "SortedFileLookupTable")
+                   .Input(FakeInput(DT_STRING))
+                   .Attr("key_dtype", DT_STRING)
+                   .Attr("value_dtype", DT_INT64)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  AddInputFromArray<tstring>(TensorShape({}), {filename});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+}  // namespace
+}  // namespace tensorflow
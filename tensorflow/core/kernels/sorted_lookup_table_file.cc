@@ -0,0 +1,314 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/sorted_lookup_table_file.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/byte_order.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/strcat.h"
+
+namespace tensorflow {
+namespace lookup {
+
+namespace {
+
+constexpr char kMagic[8] = {'T', 'F', 'S', 'L', 'T', 'B', 'L', '1'};
+constexpr size_t kWriteBufferSize = 1 << 20;
+
+struct FileHeader {
+  char magic[8];
+  uint32_t key_dtype;
+  uint32_t value_dtype;
+  uint64_t size;
+  uint64_t keys_size;
+  uint64_t values_size;
+};
+static_assert(sizeof(FileHeader) == 40, "FileHeader must not be padded");
+
+bool IsSupportedDataType(DataType dtype) {
+  return dtype == DT_INT64 || dtype == DT_STRING;
+}
+
+uint64_t RoundUpTo8(uint64_t n) { return (n + 7) & ~uint64_t{7}; }
+
+// Returns the index of `key` in the increasing keys returned by `key_at`, or
+// -1 if it is not one of them.
+template <typename T, typename KeyAt>
+int64_t BinarySearch(int64_t size, const T& key, KeyAt key_at) {
+  int64_t begin = 0;
+  int64_t end = size;
+  while (begin < end) {
+    const int64_t mid = begin + (end - begin) / 2;
+    if (key_at(mid) < key) {
+      begin = mid + 1;
+    } else {
+      end = mid;
+    }
+  }
+  return begin < size && key_at(begin) == key ? begin : -1;
+}
+
+// Returns the size in bytes of the section that holds the elements of `t`.
+uint64_t SectionSize(const Tensor& t) {
+  const int64_t n = t.NumElements();
+  if (t.dtype() == DT_INT64) return n * sizeof(int64_t);
+  uint64_t bytes_size = 0;
+  const auto strings = t.flat<tstring>();
+  for (int64_t i = 0; i < n; ++i) bytes_size += strings(i).size();
+  return (n + 1) * sizeof(uint64_t) + RoundUpTo8(bytes_size);
+}
+
+// Appends the section that holds the elements of `t`, in `order`, to `out`.
+Status AppendSection(const Tensor& t, const std::vector<int64_t>& order,
+                     WritableFile* out) {
+  std::string buffer;
+  buffer.reserve(kWriteBufferSize);
+  auto append = [&](const void* data, size_t size) -> Status {
+    buffer.append(static_cast<const char*>(data), size);
+    if (buffer.size() >= kWriteBufferSize) {
+      TF_RETURN_IF_ERROR(out->Append(buffer));
+      buffer.clear();
+    }
+    return absl::OkStatus();
+  };
+  if (t.dtype() == DT_INT64) {
+    const auto ints = t.flat<int64_t>();
+    for (const int64_t i : order) {
+      TF_RETURN_IF_ERROR(append(&ints(i), sizeof(int64_t)));
+    }
+  } else {
+    const auto strings = t.flat<tstring>();
+    uint64_t offset = 0;
+    TF_RETURN_IF_ERROR(append(&offset, sizeof(offset)));
+    for (const int64_t i : order) {
+      offset += strings(i).size();
+      TF_RETURN_IF_ERROR(append(&offset, sizeof(offset)));
+    }
+    for (const int64_t i : order) {
+      TF_RETURN_IF_ERROR(append(strings(i).data(), strings(i).size()));
+    }
+    const char padding[8] = {};
+    TF_RETURN_IF_ERROR(append(padding, RoundUpTo8(offset) - offset));
+  }
+  return out->Append(buffer);
+}
+
+// Sorts the indices of `keys` by key, and fails if two keys are equal.
+template <typename T, typename Key>
+Status SortKeys(const Tensor& keys, Key key, std::vector<int64_t>* order) {
+  const auto flat_keys = keys.flat<T>();
+  std::sort(order->begin(), order->end(), [&](int64_t a, int64_t b) {
+    return key(flat_keys(a)) < key(flat_keys(b));
+  });
+  for (size_t i = 1; i < order->size(); ++i) {
+    if (key(flat_keys((*order)[i - 1])) == key(flat_keys((*order)[i]))) {
+      return errors::InvalidArgument("Duplicate key ",
+                                     flat_keys((*order)[i]), " in keys.");
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::string_view SortedLookupTableFile::Section::StringAt(int64_t i) const {
+  const uint64_t end = std::min(offsets[i + 1], bytes_size);
+  const uint64_t begin = std::min(offsets[i], end);
+  return absl::string_view(bytes + begin, end - begin);
+}
+
+Status SortedLookupTableFile::Open(
+    Env* env, const std::string& filename,
+    std::unique_ptr<SortedLookupTableFile>* file) {
+  if (!port::kLittleEndian) {
+    return errors::Unimplemented(
+        "Sorted lookup table files are only supported on little endian "
+        "hosts.");
+  }
+  std::unique_ptr<SortedLookupTableFile> table(new SortedLookupTableFile());
+  uint64_t file_size = 0;
+  Status s = env->NewReadOnlyMemoryRegionFromFile(filename, &table->region_);
+  if (s.ok()) {
+    table->data_ = static_cast<const char*>(table->region_->data());
+    file_size = table->region_->length();
+  } else if (errors::IsUnimplemented(s)) {
+    // The file system cannot map files; the file is read into a buffer that is
+    // aligned like a mapped file.
+    TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+    std::unique_ptr<RandomAccessFile> input;
+    TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &input));
+    table->buffer_.reset(new uint64_t[file_size / sizeof(uint64_t) + 1]);
+    char* scratch = reinterpret_cast<char*>(table->buffer_.get());
+    StringPiece contents;
+    TF_RETURN_IF_ERROR(input->Read(0, file_size, &contents, scratch));
+    if (contents.size() != file_size) {
+      return errors::DataLoss("Read ", contents.size(), " of ", file_size,
+                              " bytes of ", filename);
+    }
+    if (contents.data() != scratch) {
+      std::memmove(scratch, contents.data(), file_size);
+    }
+    table->data_ = scratch;
+    table->heap_bytes_ = file_size;
+  } else {
+    return s;
+  }
+  TF_RETURN_IF_ERROR(table->Parse(filename, file_size));
+  *file = std::move(table);
+  return absl::OkStatus();
+}
+
+Status SortedLookupTableFile::Parse(const std::string& filename,
+                                    uint64_t file_size) {
+  if (file_size < sizeof(FileHeader)) {
+    return errors::DataLoss(filename,
+                            " is too short to be a sorted lookup table file.");
+  }
+  FileHeader header;
+  std::memcpy(&header, data_, sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+    return errors::DataLoss(filename, " is not a sorted lookup table file.");
+  }
+  const uint64_t sections_size = file_size - sizeof(FileHeader);
+  // Every entry takes at least 8 bytes, which also keeps the sizes of the
+  // sections computed from the number of entries from overflowing.
+  if (header.size > sections_size / sizeof(uint64_t) ||
+      header.keys_size > sections_size ||
+      header.values_size != sections_size - header.keys_size) {
+    return errors::DataLoss("The sizes in the header of ", filename,
+                            " do not match its size of ", file_size,
+                            " bytes.");
+  }
+  key_dtype_ = static_cast<DataType>(header.key_dtype);
+  value_dtype_ = static_cast<DataType>(header.value_dtype);
+  size_ = header.size;
+  TF_RETURN_IF_ERROR(ParseSection(filename, key_dtype_, sizeof(FileHeader),
+                                  header.keys_size, &keys_));
+  return ParseSection(filename, value_dtype_,
+                      sizeof(FileHeader) + header.keys_size,
+                      header.values_size, &values_);
+}
+
+Status SortedLookupTableFile::ParseSection(const std::string& filename,
+                                           DataType dtype, uint64_t begin,
+                                           uint64_t size, Section* section) {
+  if (begin % sizeof(uint64_t) != 0) {
+    return errors::DataLoss("Misaligned section at ", begin, " in ", filename);
+  }
+  const char* data = data_ + begin;
+  const uint64_t n = size_;
+  switch (dtype) {
+    case DT_INT64:
+      if (size != n * sizeof(int64_t)) {
+        return errors::DataLoss("Expected ", n * sizeof(int64_t),
+                                " bytes of int64 in ", filename, ", got ",
+                                size);
+      }
+      section->ints = reinterpret_cast<const int64_t*>(data);
+      return absl::OkStatus();
+    case DT_STRING: {
+      const uint64_t offsets_size = (n + 1) * sizeof(uint64_t);
+      if (size < offsets_size) {
+        return errors::DataLoss("Expected at least ", offsets_size,
+                                " bytes of string offsets in ", filename,
+                                ", got ", size);
+      }
+      section->offsets = reinterpret_cast<const uint64_t*>(data);
+      section->bytes = data + offsets_size;
+      section->bytes_size = size - offsets_size;
+      return absl::OkStatus();
+    }
+    default:
+      return errors::DataLoss("Unsupported data type ", DataTypeString(dtype),
+                              " in ", filename);
+  }
+}
+
+int64_t SortedLookupTableFile::FindInt64(int64_t key) const {
+  return BinarySearch(size_, key,
+                      [this](int64_t i) { return keys_.Int64At(i); });
+}
+
+int64_t SortedLookupTableFile::FindString(absl::string_view key) const {
+  return BinarySearch(size_, key,
+                      [this](int64_t i) { return keys_.StringAt(i); });
+}
+
+Status SortedLookupTableFile::Write(Env* env, const std::string& filename,
+                                    const Tensor& keys, const Tensor& values) {
+  if (!port::kLittleEndian) {
+    return errors::Unimplemented(
+        "Sorted lookup table files are only supported on little endian "
+        "hosts.");
+  }
+  if (!IsSupportedDataType(keys.dtype()) ||
+      !IsSupportedDataType(values.dtype())) {
+    return errors::InvalidArgument(
+        "Sorted lookup tables support int64 and string keys and values, got ",
+        DataTypeString(keys.dtype()), " keys and ",
+        DataTypeString(values.dtype()), " values.");
+  }
+  if (!keys.shape().IsSameSize(values.shape())) {
+    return errors::InvalidArgument(
+        "keys and values must have the same shape, got ",
+        keys.shape().DebugString(), " and ", values.shape().DebugString());
+  }
+
+  std::vector<int64_t> order(keys.NumElements());
+  std::iota(order.begin(), order.end(), 0);
+  if (keys.dtype() == DT_INT64) {
+    TF_RETURN_IF_ERROR(SortKeys<int64_t>(
+        keys, [](int64_t key) { return key; }, &order));
+  } else {
+    TF_RETURN_IF_ERROR(SortKeys<tstring>(
+        keys, [](const tstring& key) { return absl::string_view(key); },
+        &order));
+  }
+
+  FileHeader header;
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.key_dtype = keys.dtype();
+  header.value_dtype = values.dtype();
+  header.size = order.size();
+  header.keys_size = SectionSize(keys);
+  header.values_size = SectionSize(values);
+
+  // The table is written to a temporary file that is then renamed, so that
+  // readers never map a partially written table.
+  const std::string tmp_filename =
+      strings::StrCat(filename, ".tempstate", random::New64());
+  std::unique_ptr<WritableFile> out;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(tmp_filename, &out));
+  Status s = out->Append(StringPiece(reinterpret_cast<const char*>(&header),
+                                     sizeof(header)));
+  if (s.ok()) s = AppendSection(keys, order, out.get());
+  if (s.ok()) s = AppendSection(values, order, out.get());
+  if (s.ok()) s = out->Close();
+  if (s.ok()) s = env->RenameFile(tmp_filename, filename);
+  if (!s.ok()) {
+    env->DeleteFile(tmp_filename).IgnoreError();
+  }
+  return s;
+}
+
+}  // namespace lookup
+}  // namespace tensorflow
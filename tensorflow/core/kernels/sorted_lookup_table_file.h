@@ -0,0 +1,122 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_SORTED_LOOKUP_TABLE_FILE_H_
+#define TENSORFLOW_CORE_KERNELS_SORTED_LOOKUP_TABLE_FILE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace lookup {
+
+// An immutable table of key-value pairs stored in a file, sorted by key, so
+// that the file can be memory-mapped and searched in place. Every process
+// mapping the same file shares its pages, and opening the file does not read
+// its entries.
+//
+// Keys and values are int64 or string scalars. The file is written in little
+// endian byte order and has the following layout, where every section starts
+// at a multiple of 8 bytes:
+//
+//   header:  the magic "TFSLTBL1", the key and value DataType as uint32, then
+//            the number of entries n, and the sizes in bytes of the keys and
+//            values sections as uint64.
+//   keys:    the n keys in increasing order.
+//   values:  the n values, in the order of their keys.
+//
+// An int64 section holds the n int64 values. A string section holds n + 1
+// uint64 offsets into the bytes that follow them, where the i-th string spans
+// [offsets[i], offsets[i + 1]), and the bytes, padded to a multiple of 8.
+// Strings are ordered by their bytes, like absl::string_view.
+class SortedLookupTableFile {
+ public:
+  // Opens the table in `filename`, memory-mapping it if the file system of
+  // `env` supports it and reading it into memory otherwise. The file is only
+  // checked to be consistent with its header; the entries of a corrupt file
+  // may be wrong, but are never read out of bounds.
+  static Status Open(Env* env, const std::string& filename,
+                     std::unique_ptr<SortedLookupTableFile>* file);
+
+  // Writes the pairs of `keys` and `values`, which must have the same shape,
+  // to a new table in `filename`. Keys must be unique.
+  static Status Write(Env* env, const std::string& filename,
+                      const Tensor& keys, const Tensor& values);
+
+  DataType key_dtype() const { return key_dtype_; }
+  DataType value_dtype() const { return value_dtype_; }
+  int64_t size() const { return size_; }
+
+  // Returns the index of the entry of `key`, or -1 if there is none.
+  int64_t FindInt64(int64_t key) const;
+  int64_t FindString(absl::string_view key) const;
+
+  int64_t Int64KeyAt(int64_t i) const { return keys_.Int64At(i); }
+  absl::string_view StringKeyAt(int64_t i) const { return keys_.StringAt(i); }
+  int64_t Int64ValueAt(int64_t i) const { return values_.Int64At(i); }
+  absl::string_view StringValueAt(int64_t i) const {
+    return values_.StringAt(i);
+  }
+
+  // The number of bytes of the table held in the heap, which is zero when the
+  // file is memory-mapped.
+  int64_t heap_bytes() const { return heap_bytes_; }
+
+ private:
+  // A keys or values section of the file.
+  struct Section {
+    // Set for int64 sections.
+    const int64_t* ints = nullptr;
+    // Set for string sections.
+    const uint64_t* offsets = nullptr;
+    const char* bytes = nullptr;
+    uint64_t bytes_size = 0;
+
+    int64_t Int64At(int64_t i) const { return ints[i]; }
+    absl::string_view StringAt(int64_t i) const;
+  };
+
+  SortedLookupTableFile() = default;
+
+  // Checks the header and locates the sections in `data_`.
+  Status Parse(const std::string& filename, uint64_t file_size);
+
+  Status ParseSection(const std::string& filename, DataType dtype,
+                      uint64_t begin, uint64_t size, Section* section);
+
+  // Exactly one of `region_` and `buffer_` holds the contents of the file.
+  std::unique_ptr<ReadOnlyMemoryRegion> region_;
+  std::unique_ptr<uint64_t[]> buffer_;
+  const char* data_ = nullptr;
+  int64_t heap_bytes_ = 0;
+
+  DataType key_dtype_ = DT_INVALID;
+  DataType value_dtype_ = DT_INVALID;
+  int64_t size_ = 0;
+  Section keys_;
+  Section values_;
+};
+
+}  // namespace lookup
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_SORTED_LOOKUP_TABLE_FILE_H_
@@ -46,10 +46,10 @@ namespace tensorflow {
 
 // TODO(anudhyan): These constants may be tuned based on the performance of
 // 'benchmark_sparse_matrix_mat_vec_mul'. We would like to find constants
-// which work across hardware platforms for typical matrix sizes. It should be
-// possible to observe at least 30-50% improvement as we increase the number
-// of threads by 1. If not, then it may we worth increasing kMaxShards and
-// kNumShardsPerThread. However, once we have too many shards, latency may be
+// which work across hardware platforms for typical matrix sizes. Shards are
+// balanced by their number of nonzeros (see BalancedRowShards), so more
+// shards per thread mostly help when a single row holds a large fraction of
+// the nonzeros. However, once we have too many shards, latency may be
 // dominated by per-shard overhead.
 //
 // Maximum number of shards into which to divide the computation for each CSR
@@ -155,10 +155,13 @@ class CSRMatMulOp : public OpKernel {
 
 // CPU Kernel to compute sparse-dense matrix multiplication.
 //
-// Uses Eigen SparseMatrix to compute the sparse-dense multiplication between
-// a CSR SparseMatrix `a` and dense Tensor `b`. If intra-op parallelism is
-// available, the implementation parallelizes the computation across each row
-// of the sparse matrix.
+// Computes the sparse-dense multiplication between a CSR SparseMatrix `a` and
+// dense Tensor `b` row by row, accumulating each output row from the rows of
+// `b` selected by the nonzeros of `a`. If intra-op parallelism is available,
+// the implementation parallelizes the computation across shards of rows of
+// the sparse matrix that hold roughly the same number of nonzeros, so that
+// matrices with very uneven rows (e.g. power-law graphs) still keep all
+// threads busy.
 template <typename T>
 class CSRMatMulCPUOp : public CSRMatMulOp<CPUDevice, T> {
   using SparseMatrix = Eigen::SparseMatrix<T, Eigen::RowMajor>;
@@ -291,6 +294,83 @@ class CSRMatMulCPUOp : public CSRMatMulOp<CPUDevice, T> {
         csr_matrix.values_vec<T>(batch_index).data() + row_offset);
   }
 
+  // Splits the rows of all batches of `csr_matrix`, numbered batch-major, into
+  // contiguous shards of roughly equal work. A row costs its number of
+  // nonzeros, plus one for writing it out. Returns the shard boundaries, from
+  // 0 to batch_size * num_rows.
+  std::vector<int64_t> BalancedRowShards(const CSRSparseMatrix& csr_matrix,
+                                         const int64_t batch_size,
+                                         const int64_t num_rows,
+                                         const int32_t num_threads) {
+    const int64_t total_rows = batch_size * num_rows;
+    int64_t total_nnz = 0;
+    for (int64_t batch_idx = 0; batch_idx < batch_size; ++batch_idx) {
+      total_nnz += csr_matrix.row_pointers_vec(batch_idx)(num_rows);
+    }
+    const int64_t total_cost = total_nnz + total_rows;
+    const int64_t num_shards = std::max<int64_t>(
+        1, std::min<int64_t>(
+               total_rows,
+               std::max(kMaxShards, kNumShardsPerThread * num_threads)));
+
+    std::vector<int64_t> bounds = {0};
+    bounds.reserve(num_shards + 1);
+    int64_t cost = 0;
+    int64_t next_shard = 1;
+    for (int64_t batch_idx = 0; batch_idx < batch_size; ++batch_idx) {
+      const auto row_ptrs = csr_matrix.row_pointers_vec(batch_idx);
+      for (int64_t row = 0; row < num_rows; ++row) {
+        cost += row_ptrs(row + 1) - row_ptrs(row) + 1;
+        // Ends a shard once it reaches its share of the total cost. A row
+        // worth several shares ends all of them at once.
+        const int64_t row_end = batch_idx * num_rows + row + 1;
+        if (next_shard < num_shards &&
+            cost * num_shards >= next_shard * total_cost) {
+          bounds.push_back(row_end);
+          while (next_shard < num_shards &&
+                 cost * num_shards >= next_shard * total_cost) {
+            ++next_shard;
+          }
+        }
+      }
+    }
+    if (bounds.back() != total_rows) bounds.push_back(total_rows);
+    return bounds;
+  }
+
+  // Computes the rows [row_begin, row_end) of the product of the CSR matrix
+  // at `batch_idx` of `lhs` and `rhs` into `output`, which holds just those
+  // rows. Each output row is the sum of the rows of `rhs` selected by the
+  // nonzeros of the same row of `lhs`, scaled by their values; Eigen
+  // vectorizes these row updates. A single column turns them into a sparse
+  // dot product per row.
+  void MultiplyRows(const CSRSparseMatrix& lhs, const int64_t batch_idx,
+                    const int64_t row_begin, const int64_t row_end,
+                    const ConstMatrixMap& rhs, MatrixMap output) {
+    const auto row_ptrs = lhs.row_pointers_vec(batch_idx);
+    const int32* col_indices = lhs.col_indices_vec(batch_idx).data();
+    const T* values = lhs.values_vec<T>(batch_idx).data();
+    if (rhs.cols() == 1) {
+      const T* rhs_data = rhs.data();
+      T* output_data = output.data();
+      for (int64_t row = row_begin; row < row_end; ++row) {
+        T sum(0);
+        for (int32 k = row_ptrs(row); k < row_ptrs(row + 1); ++k) {
+          sum += values[k] * rhs_data[col_indices[k]];
+        }
+        output_data[row - row_begin] = sum;
+      }
+      return;
+    }
+    for (int64_t row = row_begin; row < row_end; ++row) {
+      auto output_row = output.row(row - row_begin);
+      output_row.setZero();
+      for (int32 k = row_ptrs(row); k < row_ptrs(row + 1); ++k) {
+        output_row.noalias() += values[k] * rhs.row(col_indices[k]);
+      }
+    }
+  }
+
   // Sparse-Dense Matrix Multiplication between a CSRSparseMatrix (LHS) and a
   // dense Tensor (RHS).
   void SparseDenseMatMulWithoutTransposedLHS(OpKernelContext* ctx,
@@ -302,29 +382,20 @@ class CSRMatMulCPUOp : public CSRMatMulOp<CPUDevice, T> {
     // Parallelize matrix multiplication across batch dimensions and across
     // rows in each batch.
     auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
-    const int32_t num_threads = worker_threads.num_threads;
-    const int64_t block_size =
-        num_lhs_rows / std::max(kMaxShards, kNumShardsPerThread * num_threads);
+    const std::vector<int64_t> shards = BalancedRowShards(
+        lhs, batch_size, num_lhs_rows, worker_threads.num_threads);
     const int64_t num_rhs_rows = rhs.dim_size(rhs.dims() - 2);
     const int64_t num_rhs_cols = rhs.dim_size(rhs.dims() - 1);
     worker_threads.workers->ParallelFor(
-        batch_size * num_lhs_rows /* total */,
+        shards.size() - 1 /* total */,
         thread::ThreadPool::SchedulingParams(
             thread::ThreadPool::SchedulingStrategy::
                 kFixedBlockSize /* strategy */,
-            absl::nullopt /* cost_per_unit */, block_size),
-        [&](int64_t batch_and_row_begin, int64_t batch_and_row_end) {
+            absl::nullopt /* cost_per_unit */, 1 /* block_size */),
+        [&](int64_t shard_begin, int64_t shard_end) {
           HandleBatchAndRowRange(
-              num_lhs_rows, batch_and_row_begin, batch_and_row_end,
+              num_lhs_rows, shards[shard_begin], shards[shard_end],
               [&](int64_t batch_idx, int64_t row_begin, int64_t row_end) {
-                const int64_t num_shard_rows = row_end - row_begin;
-
-                // Define an Eigen::SparseMatrix over the row range:
-                // [row_begin, row_end) of the CSR SparseMatrix A.
-                std::vector<int32> row_ptrs;
-                auto sparse_matrix = GetSparseMatrixRef(
-                    lhs, batch_idx, row_begin, num_shard_rows, &row_ptrs);
-
                 // Map the corresponding rows of the rhs.
                 ConstMatrixMap rhs_map(rhs.flat<T>().data() + batch_idx *
                                                                   num_rhs_rows *
@@ -336,8 +407,9 @@ class CSRMatMulCPUOp : public CSRMatMulOp<CPUDevice, T> {
                     output->flat<T>().data() +
                         batch_idx * num_lhs_rows * num_rhs_cols +
                         row_begin * num_rhs_cols,
-                    num_shard_rows, num_rhs_cols);
-                output_map.noalias() = sparse_matrix * rhs_map;
+                    row_end - row_begin, num_rhs_cols);
+                MultiplyRows(lhs, batch_idx, row_begin, row_end, rhs_map,
+                             output_map);
               });
         });
   }
@@ -376,17 +448,17 @@ class CSRMatMulCPUOp : public CSRMatMulOp<CPUDevice, T> {
 
     // Parallelize matrix multiplication across batch dimensions and across
     // columns of A^T in each batch. These correspond to rows of A.
-    const int64_t block_size =
-        num_lhs_cols / std::max(kMaxShards, kNumShardsPerThread * num_threads);
+    const std::vector<int64_t> shards =
+        BalancedRowShards(lhs, batch_size, num_lhs_cols, num_threads);
     worker_threads.workers->ParallelForWithWorkerId(
-        batch_size * num_lhs_cols /* total */,
+        shards.size() - 1 /* total */,
         thread::ThreadPool::SchedulingParams(
             thread::ThreadPool::SchedulingStrategy::
                 kFixedBlockSize /* strategy */,
-            absl::nullopt /* cost_per_unit */, block_size),
-        [&](int64_t batch_and_row_begin, int64_t batch_and_row_end, int tid) {
+            absl::nullopt /* cost_per_unit */, 1 /* block_size */),
+        [&](int64_t shard_begin, int64_t shard_end, int tid) {
           HandleBatchAndRowRange(
-              num_lhs_cols, batch_and_row_begin, batch_and_row_end,
+              num_lhs_cols, shards[shard_begin], shards[shard_end],
               [&](int64_t batch_idx, int64_t row_begin, int64_t row_end) {
                 const int64_t num_shard_rows = row_end - row_begin;
 
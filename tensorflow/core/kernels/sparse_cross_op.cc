@@ -16,7 +16,9 @@ limitations under the License.
 // Contains OP to generate sparse crosses.
 #include <assert.h>
 
+#include <algorithm>
 #include <limits>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -30,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/fingerprint.h"
@@ -111,7 +114,7 @@ class KeyedSparseTensorColumn : public ColumnInterface<InternalType> {
   std::vector<int64_t> feature_start_indices_;
 };
 
-// InternalType is int64 only when using HashCrosser.
+// InternalType is int64 only when using BatchHashCrosser.
 template <>
 int64_t SparseTensorColumn<int64_t>::Feature(int64_t batch, int64_t n,
                                              bool strong_hash) const {
@@ -217,7 +220,7 @@ class KeyedDenseTensorColumn : public ColumnInterface<InternalType> {
   tensorflow::uint64 key_[2];
 };
 
-// InternalType is int64 only when using HashCrosser.
+// InternalType is int64 only when using BatchHashCrosser.
 template <>
 int64_t DenseTensorColumn<int64_t>::Feature(int64_t batch, int64_t n,
                                             bool strong_hash) const {
@@ -326,60 +329,73 @@ class StringCrosser {
   const tstring k_feature_separator_;
 };
 
-// Generates the sparse crosses as nested hash to avoid string manipulations.
-class HashCrosser {
+// Generates the sparse crosses of a batch as nested hashes, without string
+// manipulations. The features of every column are hashed once per batch, and
+// the hash of a prefix of the columns is shared by all the crosses that start
+// with it, so a feature is not rehashed for every cross it takes part in.
+class BatchHashCrosser {
  public:
-  HashCrosser(
+  // If `hash_key` is set, it is the seed that the first feature is
+  // concatenated to; otherwise the hash starts from the first feature.
+  BatchHashCrosser(
       const std::vector<std::unique_ptr<ColumnInterface<int64_t>>>& columns,
-      const int64_t num_buckets, const uint64 hash_key,
-      const tstring k_feature_separator_unused)
-      : columns_(columns), num_buckets_(num_buckets), hash_key_(hash_key) {}
-
-  int64_t Generate(const int64_t batch_index,
-                   const std::vector<int>& permutation,
-                   bool unused_strong_hash) const {
-    // Do the fingerprint concatenation on uint64.
-    uint64 hashed_output = hash_key_;
-    for (size_t i = 0; i < permutation.size(); ++i) {
-      uint64 hash_i = columns_[i]->Feature(batch_index, permutation[i], false);
-      hashed_output = FingerprintCat64(hashed_output, hash_i);
+      const int64_t num_buckets, const std::optional<uint64> hash_key,
+      const bool strong_hash)
+      : columns_(columns),
+        num_buckets_(num_buckets),
+        hash_key_(hash_key),
+        strong_hash_(strong_hash) {}
+
+  // Writes the crosses of `batch_index` to `values`, in the order in which
+  // ProductIterator enumerates them: the last column varies fastest.
+  void Generate(const int64_t batch_index, int64_t* values) const {
+    const int num_columns = columns_.size();
+    std::vector<std::vector<uint64>> features(num_columns);
+    for (int i = 0; i < num_columns; ++i) {
+      const int64_t count = columns_[i]->FeatureCount(batch_index);
+      // If one column is missing any feature, there won't be any cross.
+      if (count == 0) return;
+      features[i].resize(count);
+      for (int64_t n = 0; n < count; ++n) {
+        features[i][n] = columns_[i]->Feature(batch_index, n, strong_hash_);
+      }
     }
-    // The return value is int64 based on the number of buckets.
-    if (num_buckets_ > 0) {
-      return hashed_output % num_buckets_;
-    } else {
-      // To prevent negative output we take modulo to max int64.
-      return hashed_output % std::numeric_limits<int64_t>::max();
+
+    // prefix[i] is the hash of the current features of columns 0 to i. The
+    // last column is combined directly into the output.
+    const int last = num_columns - 1;
+    gtl::InlinedVector<int64_t, 8> positions(num_columns, 0);
+    gtl::InlinedVector<uint64, 8> prefix(num_columns);
+    const auto combine = [&](int i, uint64 feature) {
+      return i > 0 ? FingerprintCat64(prefix[i - 1], feature) : First(feature);
+    };
+    for (int i = 0; i < last; ++i) prefix[i] = combine(i, features[i][0]);
+
+    while (true) {
+      for (const uint64 feature : features[last]) {
+        *values++ = Bucketize(combine(last, feature));
+      }
+      // Advances the other columns like an odometer.
+      int i = last - 1;
+      while (i >= 0 &&
+             ++positions[i] == static_cast<int64_t>(features[i].size())) {
+        positions[i] = 0;
+        --i;
+      }
+      if (i < 0) return;
+      for (int j = i; j < last; ++j) {
+        prefix[j] = combine(j, features[j][positions[j]]);
+      }
     }
   }
 
  private:
-  const std::vector<std::unique_ptr<ColumnInterface<int64_t>>>& columns_;
-  const int64_t num_buckets_;
-  const uint64 hash_key_;
-};
+  uint64 First(const uint64 feature) const {
+    return hash_key_ ? FingerprintCat64(*hash_key_, feature) : feature;
+  }
 
-// Generates the sparse crosses as nested hash to avoid string manipulations.
-class HashCrosserV2 {
- public:
-  HashCrosserV2(
-      const std::vector<std::unique_ptr<ColumnInterface<int64_t>>>& columns,
-      const int64_t num_buckets, const uint64 hash_key_unused,
-      const tstring k_feature_separator_unused)
-      : columns_(columns), num_buckets_(num_buckets) {}
-
-  int64_t Generate(const int64_t batch_index,
-                   const std::vector<int>& permutation,
-                   bool strong_hash) const {
-    // Do the fingerprint concatenation on uint64.
-    uint64 hashed_output =
-        columns_[0]->Feature(batch_index, permutation[0], strong_hash);
-    for (size_t i = 1; i < permutation.size(); ++i) {
-      uint64 hash_i =
-          columns_[i]->Feature(batch_index, permutation[i], strong_hash);
-      hashed_output = FingerprintCat64(hashed_output, hash_i);
-    }
-    // The return value is int64 based on the number of buckets.
+  // The return value is int64 based on the number of buckets.
+  int64_t Bucketize(const uint64 hashed_output) const {
     if (num_buckets_ > 0) {
       return hashed_output % num_buckets_;
     } else {
@@ -388,9 +404,10 @@ class HashCrosserV2 {
     }
   }
 
- private:
   const std::vector<std::unique_ptr<ColumnInterface<int64_t>>>& columns_;
   const int64_t num_buckets_;
+  const std::optional<uint64> hash_key_;
+  const bool strong_hash_;
 };
 
 // ProductIterator generates cartesian products based on indices.
@@ -442,22 +459,6 @@ class ProductIterator {
   std::vector<int> next_permutation_;
 };
 
-template <bool HASHED_OUTPUT, typename InternalType>
-struct CrossTraits;
-
-template <typename InternalType>
-struct CrossTraits<false, InternalType> {
-  typedef StringCrosser<InternalType> Crosser;
-  typedef StringCrosser<InternalType> CrosserV2;
-  typedef OutputUpdater<tstring> Updater;
-};
-
-template <>
-struct CrossTraits<true, int64_t> {
-  typedef HashCrosser Crosser;
-  typedef HashCrosserV2 CrosserV2;
-  typedef OutputUpdater<int64_t> Updater;
-};
 }  // namespace
 
 // Calculate the batch size from either the shapes input or the dense input.
@@ -736,6 +737,41 @@ Status CreateOutputTensors(
   return absl::OkStatus();
 }
 
+// Fills the preallocated outputs with the hashed crosses of every batch, in
+// parallel over batches. Each batch writes its own range of the outputs.
+void GenerateHashedCrosses(OpKernelContext* context,
+                           const BatchHashCrosser& crosser, int num_columns,
+                           const std::vector<int64_t>& output_start_indices,
+                           Tensor* indices_out, Tensor* values_out) {
+  const int64_t batch_size = output_start_indices.size();
+  const int64_t cross_count_total = values_out->NumElements();
+  auto indices = indices_out->matrix<int64_t>();
+  int64_t* values = values_out->vec<int64_t>().data();
+  auto do_work = [&](int64_t begin, int64_t end) {
+    for (int64_t b = begin; b < end; b++) {
+      const int64_t start = output_start_indices[b];
+      const int64_t limit = b + 1 < batch_size ? output_start_indices[b + 1]
+                                               : cross_count_total;
+      crosser.Generate(b, values + start);
+      for (int64_t i = start; i < limit; ++i) {
+        indices(i, 0) = b;
+        indices(i, 1) = i - start;
+      }
+    }
+  };
+
+  auto* worker_threads = context->device()->tensorflow_cpu_worker_threads();
+  // Every cross costs one fingerprint concatenation, and every batch hashes
+  // each of its features once.
+  const int64_t kCostPerCross = 20;
+  const int64_t kCostPerColumn = 500;
+  const int64_t cost_per_unit =
+      kCostPerCross * (cross_count_total / std::max<int64_t>(batch_size, 1)) +
+      kCostPerColumn * num_columns;
+  Shard(worker_threads->num_threads, worker_threads->workers, batch_size,
+        cost_per_unit, do_work);
+}
+
 template <bool HASHED_OUTPUT, typename InternalType>
 class SparseCrossOp : public OpKernel {
  public:
@@ -769,9 +805,6 @@ class SparseCrossOp : public OpKernel {
         GenerateColumnsFromInput<InternalType>(indices_list_in, values_list_in,
                                                shapes_list_in, dense_list_in);
 
-    const tstring k_feature_separator = "_X_";
-    typename CrossTraits<HASHED_OUTPUT, InternalType>::Crosser crosser(
-        columns, num_buckets_, hash_key_, k_feature_separator);
     Tensor* indices_out;
     Tensor* values_out;
     Tensor* shape_out;
@@ -783,26 +816,36 @@ class SparseCrossOp : public OpKernel {
         CreateOutputTensors(columns, batch_size, context, &indices_out,
                             &values_out, &shape_out, &output_start_indices));
 
-    typename CrossTraits<HASHED_OUTPUT, InternalType>::Updater updater(
-        output_start_indices, indices_out, values_out);
-    auto do_work = [&columns, crosser, updater](int64_t begin, int64_t end) {
-      for (int b = begin; b < end; b++) {
-        ProductIterator<InternalType> product_iterator(columns, b);
-        int64_t cross_count = 0;
-        while (product_iterator.HasNext()) {
-          const auto permutation = product_iterator.Next();
-          updater.Update(b, cross_count,
-                         crosser.Generate(b, permutation, false));
-          cross_count++;
+    if constexpr (HASHED_OUTPUT) {
+      BatchHashCrosser crosser(columns, num_buckets_, hash_key_,
+                               /*strong_hash=*/false);
+      GenerateHashedCrosses(context, crosser, columns.size(),
+                            output_start_indices, indices_out, values_out);
+    } else {
+      const tstring k_feature_separator = "_X_";
+      StringCrosser<InternalType> crosser(columns, num_buckets_, hash_key_,
+                                          k_feature_separator);
+      OutputUpdater<tstring> updater(output_start_indices, indices_out,
+                                     values_out);
+      auto do_work = [&columns, crosser, updater](int64_t begin, int64_t end) {
+        for (int b = begin; b < end; b++) {
+          ProductIterator<InternalType> product_iterator(columns, b);
+          int64_t cross_count = 0;
+          while (product_iterator.HasNext()) {
+            const auto permutation = product_iterator.Next();
+            updater.Update(b, cross_count,
+                           crosser.Generate(b, permutation, false));
+            cross_count++;
+          }
         }
-      }
-    };
+      };
 
-    auto* worker_threads = context->device()->tensorflow_cpu_worker_threads();
-    // TODO(zakaria): optimize kCostPerUnit
-    const int kCostPerUnit = 5000 * indices_list_in.size();
-    Shard(worker_threads->num_threads, worker_threads->workers, batch_size,
-          kCostPerUnit, do_work);
+      auto* worker_threads = context->device()->tensorflow_cpu_worker_threads();
+      // TODO(zakaria): optimize kCostPerUnit
+      const int kCostPerUnit = 5000 * indices_list_in.size();
+      Shard(worker_threads->num_threads, worker_threads->workers, batch_size,
+            kCostPerUnit, do_work);
+    }
   }
 
  private:
@@ -931,29 +974,10 @@ class SparseCrossHashedOp : public OpKernel {
         context,
         CreateOutputTensors(columns, batch_size, context, &indices_out,
                             &values_out, &shape_out, &output_start_indices));
-    const tstring unused_sep;
-    HashCrosserV2 crosser(columns, num_buckets, 0, unused_sep);
-    OutputUpdater<int64_t> updater(output_start_indices, indices_out,
-                                   values_out);
-    auto do_work = [&columns, crosser, updater, strong_hash](int64_t begin,
-                                                             int64_t end) {
-      for (int b = begin; b < end; b++) {
-        ProductIterator<int64_t> product_iterator(columns, b);
-        int64_t cross_count = 0;
-        while (product_iterator.HasNext()) {
-          const auto permutation = product_iterator.Next();
-          updater.Update(b, cross_count,
-                         crosser.Generate(b, permutation, strong_hash));
-          cross_count++;
-        }
-      }
-    };
-
-    auto* worker_threads = context->device()->tensorflow_cpu_worker_threads();
-    // TODO(zakaria): optimize kCostPerUnit
-    const int kCostPerUnit = 5000 * indices_list_in.size();
-    Shard(worker_threads->num_threads, worker_threads->workers, batch_size,
-          kCostPerUnit, do_work);
+    BatchHashCrosser crosser(columns, num_buckets, /*hash_key=*/std::nullopt,
+                             strong_hash);
+    GenerateHashedCrosses(context, crosser, columns.size(),
+                          output_start_indices, indices_out, values_out);
   }
 };
 
@@ -64,10 +64,11 @@ Tensor GetTestTensor(int batch) {
   return t;
 }
 
-Graph* SetupStringSplitGraph(const Tensor& input) {
+Graph* SetupStringSplitGraph(const Tensor& input,
+                             const string& delimiter = " ") {
   Graph* g = new Graph(OpRegistry::Global());
   Tensor delim(DT_STRING, TensorShape({}));
-  delim.flat<tstring>().setConstant(" ");
+  delim.flat<tstring>().setConstant(delimiter);
 
   TF_CHECK_OK(NodeBuilder("string_split_op", "StringSplit")
                   .Input(test::graph::Constant(g, input))
@@ -95,6 +96,25 @@ BENCHMARK(BM_StringSplit)
     ->Arg(128)
     ->Arg(256);
 
+static void BM_StringSplitCharSet(::testing::benchmark::State& state) {
+  const int batch_size = state.range(0);
+
+  Tensor input = GetTestTensor(batch_size);
+  Graph* g = SetupStringSplitGraph(input, " ,.()");
+  test::Benchmark("cpu", g, /*old_benchmark_api*/ false).Run(state);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_StringSplitCharSet)
+    ->UseRealTime()
+    ->Arg(1)
+    ->Arg(8)
+    ->Arg(16)
+    ->Arg(32)
+    ->Arg(64)
+    ->Arg(128)
+    ->Arg(256);
+
 Graph* SetupStringSplitV2Graph(const Tensor& input) {
   Graph* g = new Graph(OpRegistry::Global());
   Tensor sep(DT_STRING, TensorShape({}));
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -44,15 +45,25 @@ class StringToHashBucketOp : public OpKernel {
                                             &output_tensor));
     auto output_flat = output_tensor->flat<int64_t>();
 
-    typedef decltype(input_flat.size()) Index;
-    for (Index i = 0; i < input_flat.size(); ++i) {
-      const uint64 input_hash = hash(input_flat(i));
-      const uint64 bucket_id = input_hash % num_buckets_;
-      // The number of buckets is always in the positive range of int64 so is
-      // the resulting bucket_id. Casting the bucket_id from uint64 to int64 is
-      // safe.
-      output_flat(i) = static_cast<int64_t>(bucket_id);
-    }
+    // Large batches are hashed in parallel. The cost is that of a short
+    // string, which keeps the shards of a typical batch of tokens above the
+    // overhead of scheduling them.
+    static constexpr int64_t kCostPerString = 100;
+    const int64_t num_buckets = num_buckets_;
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          input_flat.size(), kCostPerString,
+          [&input_flat, &output_flat, num_buckets](int64_t begin,
+                                                   int64_t end) {
+            for (int64_t i = begin; i < end; ++i) {
+              const uint64 input_hash = hash(input_flat(i));
+              const uint64 bucket_id = input_hash % num_buckets;
+              // The number of buckets is always in the positive range of int64
+              // so is the resulting bucket_id. Casting the bucket_id from
+              // uint64 to int64 is safe.
+              output_flat(i) = static_cast<int64_t>(bucket_id);
+            }
+          });
   }
 
  private:
@@ -0,0 +1,452 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/resource_variable_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#define EIGEN_USE_GPU
+#include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/bounds_check.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/gather_functor.h"
+#include "tensorflow/core/kernels/scatter_functor.h"
+#include "tensorflow/core/kernels/tiered_embedding_var.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace {
+
+using RowList = absl::Span<const std::pair<int64_t, int64_t>>;
+
+// Moves rows between the host store and the device cache of a
+// TieredEmbeddingVar, and makes the slots of a batch available on the device.
+template <typename Device, typename T>
+struct TieredEmbeddingTransfer;
+
+template <typename T>
+struct TieredEmbeddingTransfer<CPUDevice, T> {
+  static Status WriteBack(OpKernelContext* c, const Tensor& cache,
+                          RowList rows, EmbeddingRowStore* store) {
+    store->WriteRows(static_cast<const char*>(cache.data()), rows);
+    return absl::OkStatus();
+  }
+
+  static Status Fill(OpKernelContext* c, EmbeddingRowStore* store,
+                     RowList rows, Tensor* cache) {
+    store->ReadRows(rows, static_cast<char*>(cache->data()));
+    return absl::OkStatus();
+  }
+
+  static Status CopySlots(OpKernelContext* c, absl::Span<const int64_t> slots,
+                          Tensor* device_slots) {
+    TF_RETURN_IF_ERROR(c->allocate_temp(
+        DT_INT64, TensorShape({static_cast<int64_t>(slots.size())}),
+        device_slots));
+    std::copy(slots.begin(), slots.end(), device_slots->flat<int64_t>().data());
+    return absl::OkStatus();
+  }
+};
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+// Allocates a host tensor that the device can copy from and to directly.
+Status AllocatePinned(OpKernelContext* c, DataType dtype,
+                      const TensorShape& shape, Tensor* host_tensor) {
+  AllocatorAttributes alloc_attr;
+  alloc_attr.set_on_host(true);
+  alloc_attr.set_gpu_compatible(true);
+  return c->allocate_temp(dtype, shape, host_tensor, alloc_attr);
+}
+
+// Copies `host_tensor` into a new device tensor, and keeps `host_tensor`
+// alive until the copy is done.
+Status CopyToDevice(OpKernelContext* c, const Tensor& host_tensor,
+                    Tensor* device_tensor) {
+  TF_RETURN_IF_ERROR(c->allocate_temp(host_tensor.dtype(),
+                                      host_tensor.shape(), device_tensor));
+  if (host_tensor.TotalBytes() == 0) return absl::OkStatus();
+  auto* stream = c->op_device_context()->stream();
+  se::DeviceMemoryBase device_ptr(device_tensor->data(),
+                                  device_tensor->TotalBytes());
+  TF_RETURN_IF_ERROR(stream->Memcpy(&device_ptr, host_tensor.data(),
+                                    host_tensor.TotalBytes()));
+  c->device()->tensorflow_accelerator_device_info()->event_mgr->ThenExecute(
+      stream, [host_tensor] {});
+  return absl::OkStatus();
+}
+
+template <typename T>
+struct TieredEmbeddingTransfer<GPUDevice, T> {
+  static Status WriteBack(OpKernelContext* c, const Tensor& cache,
+                          RowList rows, EmbeddingRowStore* store) {
+    if (rows.empty()) return absl::OkStatus();
+    const int64_t num_rows = rows.size();
+    const int64_t row_size = cache.dim_size(1);
+    std::vector<int64_t> slots;
+    slots.reserve(num_rows);
+    for (const auto& row : rows) slots.push_back(row.second);
+    Tensor device_slots;
+    TF_RETURN_IF_ERROR(CopySlots(c, slots, &device_slots));
+
+    // Gathers the rows on the device, so that they come back in one copy.
+    Tensor device_rows;
+    TF_RETURN_IF_ERROR(c->allocate_temp(
+        cache.dtype(), TensorShape({num_rows, row_size}), &device_rows));
+    const int64_t bad_i = functor::GatherFunctor<GPUDevice, T, int64_t>()(
+        c, cache.shaped<T, 3>({1, cache.dim_size(0), row_size}),
+        std::as_const(device_slots).flat<int64_t>(),
+        device_rows.shaped<T, 3>({1, num_rows, row_size}));
+    if (bad_i >= 0) {
+      return errors::Internal("Invalid cache slot ", slots[bad_i]);
+    }
+    Tensor host_rows;
+    TF_RETURN_IF_ERROR(
+        AllocatePinned(c, cache.dtype(), device_rows.shape(), &host_rows));
+    auto* stream = c->op_device_context()->stream();
+    se::DeviceMemoryBase device_ptr(device_rows.data(),
+                                    device_rows.TotalBytes());
+    TF_RETURN_IF_ERROR(stream->Memcpy(host_rows.data(), device_ptr,
+                                      device_rows.TotalBytes()));
+    TF_RETURN_IF_ERROR(stream->BlockHostUntilDone());
+
+    const char* base = static_cast<const char*>(host_rows.data());
+    const int64_t row_bytes = store->row_bytes();
+    for (int64_t i = 0; i < num_rows; ++i) {
+      std::memcpy(store->row(rows[i].first), base + i * row_bytes, row_bytes);
+    }
+    return absl::OkStatus();
+  }
+
+  static Status Fill(OpKernelContext* c, EmbeddingRowStore* store,
+                     RowList rows, Tensor* cache) {
+    if (rows.empty()) return absl::OkStatus();
+    const int64_t num_rows = rows.size();
+    const int64_t row_size = cache->dim_size(1);
+    // Stages the rows contiguously, so that they go over in one copy.
+    Tensor host_rows;
+    TF_RETURN_IF_ERROR(AllocatePinned(
+        c, cache->dtype(), TensorShape({num_rows, row_size}), &host_rows));
+    char* base = static_cast<char*>(host_rows.data());
+    const int64_t row_bytes = store->row_bytes();
+    std::vector<int64_t> slots;
+    slots.reserve(num_rows);
+    for (int64_t i = 0; i < num_rows; ++i) {
+      std::memcpy(base + i * row_bytes, store->row(rows[i].first), row_bytes);
+      slots.push_back(rows[i].second);
+    }
+    Tensor device_rows;
+    TF_RETURN_IF_ERROR(CopyToDevice(c, host_rows, &device_rows));
+    Tensor device_slots;
+    TF_RETURN_IF_ERROR(CopySlots(c, slots, &device_slots));
+    functor::ScatterFunctor<GPUDevice, T, int64_t,
+                            scatter_op::UpdateOp::ASSIGN>()(
+        c, c->eigen_device<GPUDevice>(), cache->matrix<T>(),
+        std::as_const(device_rows).matrix<T>(),
+        std::as_const(device_slots).flat<int64_t>());
+    return absl::OkStatus();
+  }
+
+  static Status CopySlots(OpKernelContext* c, absl::Span<const int64_t> slots,
+                          Tensor* device_slots) {
+    Tensor host_slots;
+    TF_RETURN_IF_ERROR(AllocatePinned(
+        c, DT_INT64, TensorShape({static_cast<int64_t>(slots.size())}),
+        &host_slots));
+    std::copy(slots.begin(), slots.end(), host_slots.flat<int64_t>().data());
+    return CopyToDevice(c, host_slots, device_slots);
+  }
+};
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+template <typename Index>
+Status GetIds(const Tensor& indices, int64_t num_rows,
+              std::vector<int64_t>* ids) {
+  const auto indices_flat = indices.flat<Index>();
+  ids->resize(indices_flat.size());
+  for (int64_t i = 0; i < indices_flat.size(); ++i) {
+    const Index id = internal::SubtleMustCopy(indices_flat(i));
+    if (!FastBoundsCheck(id, num_rows)) {
+      return errors::InvalidArgument("indices[", i, "] = ", id,
+                                     " is not in [0, ", num_rows, ")");
+    }
+    (*ids)[i] = id;
+  }
+  return absl::OkStatus();
+}
+
+// Brings the rows of `indices` into the device cache of `var`, and returns
+// their slots, both on the host (in `plan`) and on the device.
+template <typename Device, typename T, typename Index>
+Status PrepareRows(OpKernelContext* c, TieredEmbeddingVar* var,
+                   const Tensor& indices, LfuRowCache::Plan* plan,
+                   Tensor** cache, Tensor* device_slots)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(*var->mu()) {
+  if (!var->is_initialized()) {
+    return errors::FailedPrecondition(
+        "Attempting to use an uninitialized tiered embedding variable.");
+  }
+  if (var->dtype() != DataTypeToEnum<T>::v()) {
+    return errors::InvalidArgument(
+        "Trying to access a tiered embedding variable of type ",
+        DataTypeString(var->dtype()), " as ",
+        DataTypeString(DataTypeToEnum<T>::v()));
+  }
+  std::vector<int64_t> ids;
+  TF_RETURN_IF_ERROR(GetIds<Index>(indices, var->num_rows(), &ids));
+  TF_RETURN_IF_ERROR(var->GetCache(c, cache));
+  TF_RETURN_IF_ERROR(var->cache_index()->Admit(ids, plan));
+  using Transfer = TieredEmbeddingTransfer<Device, T>;
+  TF_RETURN_IF_ERROR(
+      Transfer::WriteBack(c, **cache, plan->write_backs, var->store()));
+  TF_RETURN_IF_ERROR(
+      Transfer::Fill(c, var->store(), plan->fills, *cache));
+  return Transfer::CopySlots(c, plan->slots, device_slots);
+}
+
+}  // namespace
+
+class InitializeTieredEmbeddingVarOp : public OpKernel {
+ public:
+  explicit InitializeTieredEmbeddingVarOp(OpKernelConstruction* c)
+      : OpKernel(c) {
+    OP_REQUIRES_OK(c, c->GetAttr("cache_capacity", &cache_capacity_));
+    OP_REQUIRES_OK(c, c->GetAttr("backing_file", &backing_file_));
+  }
+
+  void Compute(OpKernelContext* c) override {
+    core::RefCountPtr<TieredEmbeddingVar> var;
+    OP_REQUIRES_OK(c, LookupOrCreateResource<TieredEmbeddingVar>(
+                          c, HandleFromInput(c, 0), &var,
+                          [](TieredEmbeddingVar** ptr) {
+                            *ptr = new TieredEmbeddingVar;
+                            return absl::OkStatus();
+                          }));
+    mutex_lock ml(*var->mu());
+    OP_REQUIRES_OK(
+        c, var->Initialize(c->input(1), cache_capacity_, backing_file_));
+  }
+
+ private:
+  int64_t cache_capacity_;
+  std::string backing_file_;
+};
+
+template <typename Device, typename T, typename Index>
+class TieredEmbeddingGatherOp : public OpKernel {
+ public:
+  explicit TieredEmbeddingGatherOp(OpKernelConstruction* c) : OpKernel(c) {}
+
+  void Compute(OpKernelContext* c) override {
+    core::RefCountPtr<TieredEmbeddingVar> var;
+    OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &var));
+    const Tensor& indices = c->input(1);
+    // Serving a batch can change which rows are cached, so gathers take the
+    // lock exclusively.
+    mutex_lock ml(*var->mu());
+    LfuRowCache::Plan plan;
+    Tensor* cache = nullptr;
+    Tensor slots;
+    OP_REQUIRES_OK(c, (PrepareRows<Device, T, Index>(c, var.get(), indices,
+                                                     &plan, &cache, &slots)));
+
+    TensorShape result_shape = indices.shape();
+    for (int i = 1; i < var->shape().dims(); ++i) {
+      OP_REQUIRES_OK(
+          c, result_shape.AddDimWithStatus(var->shape().dim_size(i)));
+    }
+    Tensor* out = nullptr;
+    OP_REQUIRES_OK(c, c->allocate_output(0, result_shape, &out));
+    const int64_t num_ids = indices.NumElements();
+    if (num_ids == 0) return;
+
+    const int64_t row_size = var->row_size();
+    const int64_t bad_i = functor::GatherFunctor<Device, T, int64_t>()(
+        c,
+        std::as_const(*cache).shaped<T, 3>({1, cache->dim_size(0), row_size}),
+        std::as_const(slots).flat<int64_t>(),
+        out->shaped<T, 3>({1, num_ids, row_size}));
+    OP_REQUIRES(c, bad_i < 0,
+                errors::Internal("Invalid cache slot ", plan.slots[bad_i]));
+  }
+};
+
+template <typename Device, typename T, typename Index,
+          scatter_op::UpdateOp op>
+class TieredEmbeddingScatterOp : public OpKernel {
+ public:
+  explicit TieredEmbeddingScatterOp(OpKernelConstruction* c) : OpKernel(c) {}
+
+  void Compute(OpKernelContext* c) override {
+    core::RefCountPtr<TieredEmbeddingVar> var;
+    OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &var));
+    const Tensor& indices = c->input(1);
+    const Tensor& updates = c->input(2);
+    mutex_lock ml(*var->mu());
+    OP_REQUIRES(c, var->is_initialized(),
+                errors::FailedPrecondition("Attempting to use an "
+                                           "uninitialized tiered embedding "
+                                           "variable."));
+    TensorShape expected_shape = indices.shape();
+    for (int i = 1; i < var->shape().dims(); ++i) {
+      OP_REQUIRES_OK(
+          c, expected_shape.AddDimWithStatus(var->shape().dim_size(i)));
+    }
+    OP_REQUIRES(c, updates.shape() == expected_shape,
+                errors::InvalidArgument(
+                    "updates must have shape indices.shape + "
+                    "variable.shape[1:] = ",
+                    expected_shape.DebugString(), ", got ",
+                    updates.shape().DebugString()));
+
+    LfuRowCache::Plan plan;
+    Tensor* cache = nullptr;
+    Tensor slots;
+    OP_REQUIRES_OK(c, (PrepareRows<Device, T, Index>(c, var.get(), indices,
+                                                     &plan, &cache, &slots)));
+    const int64_t num_ids = indices.NumElements();
+    if (num_ids == 0) return;
+
+    const int64_t bad_i = functor::ScatterFunctor<Device, T, int64_t, op>()(
+        c, c->eigen_device<Device>(), cache->matrix<T>(),
+        updates.shaped<T, 2>({num_ids, var->row_size()}),
+        std::as_const(slots).flat<int64_t>());
+    OP_REQUIRES(c, bad_i < 0,
+                errors::Internal("Invalid cache slot ", plan.slots[bad_i]));
+    LfuRowCache* cache_index = var->cache_index();
+    for (int64_t slot : plan.slots) cache_index->MarkDirty(slot);
+  }
+};
+
+template <typename Index>
+class TieredEmbeddingPrefetchOp : public OpKernel {
+ public:
+  explicit TieredEmbeddingPrefetchOp(OpKernelConstruction* c) : OpKernel(c) {}
+
+  void Compute(OpKernelContext* c) override {
+    core::RefCountPtr<TieredEmbeddingVar> var;
+    OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &var));
+    mutex_lock ml(*var->mu());
+    OP_REQUIRES(c, var->is_initialized(),
+                errors::FailedPrecondition("Attempting to use an "
+                                           "uninitialized tiered embedding "
+                                           "variable."));
+    std::vector<int64_t> ids;
+    OP_REQUIRES_OK(c, GetIds<Index>(c->input(1), var->num_rows(), &ids));
+    var->Prefetch(std::move(ids));
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("TieredEmbeddingVarHandleOp")
+                            .Device(DEVICE_CPU)
+                            .HostMemory("resource"),
+                        ResourceHandleOp<TieredEmbeddingVar>);
+REGISTER_KERNEL_BUILDER(Name("InitializeTieredEmbeddingVar")
+                            .Device(DEVICE_CPU)
+                            .HostMemory("resource"),
+                        InitializeTieredEmbeddingVarOp);
+
+#define REGISTER_PREFETCH_KERNEL(device, index_type)                  \
+  REGISTER_KERNEL_BUILDER(Name("TieredEmbeddingPrefetch")              \
+                              .Device(DEVICE_##device)                 \
+                              .HostMemory("resource")                  \
+                              .HostMemory("indices")                   \
+                              .TypeConstraint<index_type>("Tindices"), \
+                          TieredEmbeddingPrefetchOp<index_type>)
+
+#define REGISTER_KERNELS_INDEX(device, type, index_type)                    \
+  REGISTER_KERNEL_BUILDER(Name("TieredEmbeddingGather")                     \
+                              .Device(DEVICE_##device)                      \
+                              .HostMemory("resource")                       \
+                              .HostMemory("indices")                        \
+                              .TypeConstraint<type>("dtype")                \
+                              .TypeConstraint<index_type>("Tindices"),      \
+                          TieredEmbeddingGatherOp<device##Device, type,     \
+                                                  index_type>);             \
+  REGISTER_KERNEL_BUILDER(                                                  \
+      Name("TieredEmbeddingScatterUpdate")                                  \
+          .Device(DEVICE_##device)                                          \
+          .HostMemory("resource")                                           \
+          .HostMemory("indices")                                            \
+          .TypeConstraint<type>("dtype")                                    \
+          .TypeConstraint<index_type>("Tindices"),                          \
+      TieredEmbeddingScatterOp<device##Device, type, index_type,            \
+                               scatter_op::UpdateOp::ASSIGN>);              \
+  REGISTER_KERNEL_BUILDER(                                                  \
+      Name("TieredEmbeddingScatterAdd")                                     \
+          .Device(DEVICE_##device)                                          \
+          .HostMemory("resource")                                           \
+          .HostMemory("indices")                                            \
+          .TypeConstraint<type>("dtype")                                    \
+          .TypeConstraint<index_type>("Tindices"),                          \
+      TieredEmbeddingScatterOp<device##Device, type, index_type,            \
+                               scatter_op::UpdateOp::ADD>)
+
+#define REGISTER_KERNELS(device, type)          \
+  REGISTER_KERNELS_INDEX(device, type, int32);  \
+  REGISTER_KERNELS_INDEX(device, type, int64_t)
+
+#define REGISTER_CPU_KERNELS(type) REGISTER_KERNELS(CPU, type)
+TF_CALL_GPU_NUMBER_TYPES(REGISTER_CPU_KERNELS);
+#undef REGISTER_CPU_KERNELS
+REGISTER_PREFETCH_KERNEL(CPU, int32);
+REGISTER_PREFETCH_KERNEL(CPU, int64_t);
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+REGISTER_KERNEL_BUILDER(Name("TieredEmbeddingVarHandleOp")
+                            .Device(DEVICE_GPU)
+                            .HostMemory("resource"),
+                        ResourceHandleOp<TieredEmbeddingVar>);
+// The initial value stays on the host: it goes straight into the store.
+REGISTER_KERNEL_BUILDER(Name("InitializeTieredEmbeddingVar")
+                            .Device(DEVICE_GPU)
+                            .HostMemory("resource")
+                            .HostMemory("value"),
+                        InitializeTieredEmbeddingVarOp);
+
+#define REGISTER_GPU_KERNELS(type) REGISTER_KERNELS(GPU, type)
+TF_CALL_GPU_NUMBER_TYPES(REGISTER_GPU_KERNELS);
+#undef REGISTER_GPU_KERNELS
+REGISTER_PREFETCH_KERNEL(GPU, int32);
+REGISTER_PREFETCH_KERNEL(GPU, int64_t);
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#undef REGISTER_KERNELS
+#undef REGISTER_KERNELS_INDEX
+#undef REGISTER_PREFETCH_KERNEL
+
+}  // namespace tensorflow
@@ -0,0 +1,313 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/tiered_embedding_var.h"
+
+#ifndef PLATFORM_WINDOWS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif  // PLATFORM_WINDOWS
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mem.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Access counts are halved after this many accesses per slot of the cache.
+constexpr int64_t kAgingPeriodPerSlot = 8;
+
+}  // namespace
+
+LfuRowCache::LfuRowCache(int64_t capacity)
+    : capacity_(capacity), slots_(capacity) {
+  free_slots_.reserve(capacity);
+  // Hands out slot 0 first.
+  for (int64_t slot = capacity - 1; slot >= 0; --slot) {
+    free_slots_.push_back(slot);
+  }
+}
+
+Status LfuRowCache::Admit(absl::Span<const int64_t> ids, Plan* plan) {
+  {
+    absl::flat_hash_set<int64_t> distinct(ids.begin(), ids.end());
+    if (static_cast<int64_t>(distinct.size()) > capacity_) {
+      return errors::ResourceExhausted(
+          "A batch of ", distinct.size(),
+          " distinct ids does not fit in a cache of ", capacity_, " rows.");
+    }
+  }
+  plan->slots.resize(ids.size());
+  plan->fills.clear();
+  plan->write_backs.clear();
+
+  // The cached rows of the batch are taken out of `by_count_` until the end
+  // of the batch, so that they cannot be evicted, and the least frequently
+  // used row outside of the batch is always at the front.
+  std::vector<int64_t> batch_slots;
+  for (int64_t id : ids) {
+    auto it = index_.find(id);
+    if (it != index_.end() &&
+        by_count_.erase({slots_[it->second].count, it->second}) > 0) {
+      batch_slots.push_back(it->second);
+    }
+  }
+  for (size_t i = 0; i < ids.size(); ++i) {
+    const int64_t id = ids[i];
+    int64_t slot;
+    auto it = index_.find(id);
+    if (it != index_.end()) {
+      slot = it->second;
+    } else {
+      if (!free_slots_.empty()) {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+      } else {
+        // There is a victim: the batch has at most capacity_ distinct ids,
+        // and this one is not cached yet.
+        auto victim = by_count_.begin();
+        slot = victim->second;
+        by_count_.erase(victim);
+        const Slot& evicted = slots_[slot];
+        index_.erase(evicted.id);
+        if (evicted.dirty) plan->write_backs.emplace_back(evicted.id, slot);
+      }
+      index_.emplace(id, slot);
+      slots_[slot] = Slot{id, 0, false};
+      plan->fills.emplace_back(id, slot);
+      batch_slots.push_back(slot);
+    }
+    uint32_t& count = slots_[slot].count;
+    if (count < std::numeric_limits<uint32_t>::max()) ++count;
+    plan->slots[i] = slot;
+  }
+  for (int64_t slot : batch_slots) {
+    by_count_.emplace(slots_[slot].count, slot);
+  }
+
+  accesses_since_aging_ += ids.size();
+  if (accesses_since_aging_ >= kAgingPeriodPerSlot * capacity_) Age();
+  return absl::OkStatus();
+}
+
+void LfuRowCache::Age() {
+  by_count_.clear();
+  for (int64_t slot = 0; slot < capacity_; ++slot) {
+    Slot& s = slots_[slot];
+    if (s.id < 0) continue;
+    s.count /= 2;
+    by_count_.emplace(s.count, slot);
+  }
+  accesses_since_aging_ = 0;
+}
+
+Status EmbeddingRowStore::Create(int64_t num_rows, int64_t row_bytes,
+                                 const std::string& path,
+                                 std::unique_ptr<EmbeddingRowStore>* store) {
+  const size_t size = static_cast<size_t>(num_rows) * row_bytes;
+  if (path.empty()) {
+    char* base = static_cast<char*>(port::AlignedMalloc(
+        std::max<size_t>(size, 1), Allocator::kAllocatorAlignment));
+    if (base == nullptr) {
+      return errors::ResourceExhausted("Failed to allocate ", size,
+                                       " bytes of host memory for an "
+                                       "embedding table.");
+    }
+    store->reset(new EmbeddingRowStore(base, size, row_bytes,
+                                       /*file_backed=*/false));
+    return absl::OkStatus();
+  }
+#ifdef PLATFORM_WINDOWS
+  return errors::Unimplemented(
+      "File-backed embedding tables are not supported on Windows.");
+#else
+  if (size == 0) {
+    return errors::InvalidArgument("An empty embedding table cannot be "
+                                   "backed by a file.");
+  }
+  const int fd = open(path.c_str(), O_CREAT | O_TRUNC | O_RDWR, 0600);
+  if (fd < 0) {
+    return errors::IOError(strings::StrCat("Creating ", path), errno);
+  }
+  if (ftruncate(fd, size) != 0) {
+    const int error = errno;
+    close(fd);
+    return errors::IOError(strings::StrCat("Resizing ", path), error);
+  }
+  void* base =
+      mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, /*offset=*/0);
+  const int error = errno;
+  close(fd);
+  if (base == MAP_FAILED) {
+    return errors::IOError(strings::StrCat("Mapping ", path), error);
+  }
+  // Rows are accessed in no particular order, so reading ahead of a fault
+  // mostly brings in rows that are not needed.
+  madvise(base, size, MADV_RANDOM);
+  store->reset(new EmbeddingRowStore(static_cast<char*>(base), size,
+                                     row_bytes, /*file_backed=*/true));
+  return absl::OkStatus();
+#endif  // PLATFORM_WINDOWS
+}
+
+EmbeddingRowStore::~EmbeddingRowStore() {
+  if (!file_backed_) {
+    port::AlignedFree(base_);
+    return;
+  }
+#ifndef PLATFORM_WINDOWS
+  if (munmap(base_, size_) != 0) {
+    LOG(WARNING) << "Failed to unmap an embedding table: " << strerror(errno);
+  }
+#endif  // PLATFORM_WINDOWS
+}
+
+void EmbeddingRowStore::WillNeed(absl::Span<const int64_t> ids) {
+#ifndef PLATFORM_WINDOWS
+  if (!file_backed_ || row_bytes_ == 0) return;
+  static const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+  for (int64_t id : ids) {
+    const uintptr_t begin =
+        reinterpret_cast<uintptr_t>(row(id)) / page_size * page_size;
+    const uintptr_t end = reinterpret_cast<uintptr_t>(row(id)) + row_bytes_;
+    madvise(reinterpret_cast<void*>(begin), end - begin, MADV_WILLNEED);
+  }
+#endif  // PLATFORM_WINDOWS
+}
+
+void EmbeddingRowStore::WriteRows(
+    const char* buffer, absl::Span<const std::pair<int64_t, int64_t>> rows) {
+  for (const auto& [id, i] : rows) {
+    std::memcpy(row(id), buffer + i * row_bytes_, row_bytes_);
+  }
+}
+
+void EmbeddingRowStore::ReadRows(
+    absl::Span<const std::pair<int64_t, int64_t>> rows, char* buffer) {
+  for (const auto& [id, i] : rows) {
+    std::memcpy(buffer + i * row_bytes_, row(id), row_bytes_);
+  }
+}
+
+Status TieredEmbeddingVar::Initialize(const Tensor& value,
+                                      int64_t cache_capacity,
+                                      const std::string& backing_file) {
+  if (is_initialized()) {
+    return errors::FailedPrecondition(
+        "The tiered embedding variable is already initialized.");
+  }
+  if (!TensorShapeUtils::IsVectorOrHigher(value.shape())) {
+    return errors::InvalidArgument(
+        "The value of a tiered embedding variable must be at least 1-D, got ",
+        value.shape().DebugString());
+  }
+  if (!DataTypeCanUseMemcpy(value.dtype())) {
+    return errors::InvalidArgument(
+        "Tiered embedding variables do not support ",
+        DataTypeString(value.dtype()));
+  }
+  if (cache_capacity < 1) {
+    return errors::InvalidArgument("cache_capacity must be positive, got ",
+                                   cache_capacity);
+  }
+  const int64_t num_rows = value.dim_size(0);
+  const int64_t row_bytes = num_rows == 0 ? 0 : value.TotalBytes() / num_rows;
+  std::unique_ptr<EmbeddingRowStore> store;
+  TF_RETURN_IF_ERROR(
+      EmbeddingRowStore::Create(num_rows, row_bytes, backing_file, &store));
+  if (num_rows > 0) {
+    std::memcpy(store->row(0), value.data(), value.TotalBytes());
+  }
+
+  dtype_ = value.dtype();
+  shape_ = value.shape();
+  // There is no use for more slots than rows.
+  cache_index_ = std::make_unique<LfuRowCache>(
+      std::min(cache_capacity, std::max<int64_t>(num_rows, 1)));
+  store_ = std::move(store);
+  if (store_->is_file_backed()) {
+    prefetch_pool_ = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "tiered_embedding_prefetch", /*num_threads=*/1);
+  }
+  return absl::OkStatus();
+}
+
+Status TieredEmbeddingVar::GetCache(OpKernelContext* context,
+                                    Tensor** cache) {
+  const std::string& device = context->device()->name();
+  if (!cache_.IsInitialized()) {
+    TF_RETURN_IF_ERROR(context->allocate_temp(
+        dtype_, TensorShape({cache_index_->capacity(), row_size()}), &cache_));
+    cache_device_ = device;
+  } else if (device != cache_device_) {
+    return errors::FailedPrecondition(
+        "The cache of the tiered embedding variable is on ", cache_device_,
+        ", but it is used on ", device);
+  }
+  *cache = &cache_;
+  return absl::OkStatus();
+}
+
+Status TieredEmbeddingVar::AdmitOnHost(OpKernelContext* context,
+                                       absl::Span<const int64_t> ids,
+                                       LfuRowCache::Plan* plan,
+                                       Tensor** cache) {
+  if (context->device()->device_type() != DEVICE_CPU) {
+    return errors::Unimplemented(
+        "Expected a CPU kernel to admit rows into a host cache, got one on ",
+        context->device()->name());
+  }
+  TF_RETURN_IF_ERROR(GetCache(context, cache));
+  TF_RETURN_IF_ERROR(cache_index_->Admit(ids, plan));
+  store_->WriteRows(static_cast<const char*>((*cache)->data()),
+                    plan->write_backs);
+  store_->ReadRows(plan->fills, static_cast<char*>((*cache)->data()));
+  return absl::OkStatus();
+}
+
+void TieredEmbeddingVar::Prefetch(std::vector<int64_t> ids) {
+  if (prefetch_pool_ == nullptr) return;
+  EmbeddingRowStore* store = store_.get();
+  prefetch_pool_->Schedule(
+      [store, ids = std::move(ids)]() { store->WillNeed(ids); });
+}
+
+std::string TieredEmbeddingVar::DebugString() const {
+  tf_shared_lock l(mu_);
+  return absl::StrCat("TieredEmbeddingVar(", DataTypeString(dtype_), ", ",
+                      shape_.DebugString(), ")");
+}
+
+int64_t TieredEmbeddingVar::MemoryUsed() const {
+  tf_shared_lock l(mu_);
+  int64_t bytes = cache_.IsInitialized() ? cache_.AllocatedBytes() : 0;
+  if (store_ != nullptr) bytes += store_->MemoryUsed();
+  return bytes;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,232 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_TIERED_EMBEDDING_VAR_H_
+#define TENSORFLOW_CORE_KERNELS_TIERED_EMBEDDING_VAR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/btree_set.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/resource_base.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+
+// Assigns the rows of an embedding table to the slots of a fixed-size cache,
+// and picks the least frequently used rows to evict when a batch of ids does
+// not fit. Only the bookkeeping lives here: the cached rows themselves are
+// stored by the caller, typically in device memory.
+//
+// Access counts are halved every few multiples of the capacity in accesses,
+// so that rows which were hot a long time ago eventually become evictable.
+//
+// Not thread-safe.
+class LfuRowCache {
+ public:
+  // The cache changes needed to serve a batch of ids.
+  struct Plan {
+    // For every requested id, the slot holding its row.
+    std::vector<int64_t> slots;
+    // Rows to load into the cache, as (id, slot) pairs.
+    std::vector<std::pair<int64_t, int64_t>> fills;
+    // Modified rows to write back before their slot is refilled, as
+    // (id, slot) pairs.
+    std::vector<std::pair<int64_t, int64_t>> write_backs;
+  };
+
+  explicit LfuRowCache(int64_t capacity);
+
+  // Admits the rows of `ids`, which may repeat. Rows of the batch are never
+  // evicted to make room for other rows of the same batch, so the batch must
+  // have at most `capacity()` distinct ids; otherwise returns
+  // ResourceExhausted and leaves the cache unchanged.
+  //
+  // The caller must apply `plan->write_backs` before `plan->fills`.
+  Status Admit(absl::Span<const int64_t> ids, Plan* plan);
+
+  // Records that the row in `slot` was modified, so that it is written back
+  // when it is evicted.
+  void MarkDirty(int64_t slot) { slots_[slot].dirty = true; }
+
+  int64_t capacity() const { return capacity_; }
+  int64_t size() const { return index_.size(); }
+  bool Contains(int64_t id) const { return index_.contains(id); }
+
+ private:
+  struct Slot {
+    int64_t id = -1;
+    uint32_t count = 0;
+    bool dirty = false;
+  };
+
+  // Halves all access counts.
+  void Age();
+
+  const int64_t capacity_;
+  // The slot of every cached id.
+  absl::flat_hash_map<int64_t, int64_t> index_;
+  std::vector<Slot> slots_;
+  std::vector<int64_t> free_slots_;
+  // The occupied slots, by access count. Victims come from the front.
+  absl::btree_set<std::pair<uint32_t, int64_t>> by_count_;
+  int64_t accesses_since_aging_ = 0;
+};
+
+// The authoritative copy of all rows of an embedding table, either in host
+// memory or in a memory-mapped file. A file-backed store lets the table
+// exceed host memory: the operating system pages rows in and out of the file
+// as they are used. The file is scratch space, created (or truncated) when
+// the store is created.
+class EmbeddingRowStore {
+ public:
+  // Creates a store of `num_rows` rows of `row_bytes` bytes each, backed by
+  // the file at `path`, or by host memory if `path` is empty.
+  static Status Create(int64_t num_rows, int64_t row_bytes,
+                       const std::string& path,
+                       std::unique_ptr<EmbeddingRowStore>* store);
+
+  ~EmbeddingRowStore();
+
+  char* row(int64_t id) { return base_ + id * row_bytes_; }
+  int64_t row_bytes() const { return row_bytes_; }
+  bool is_file_backed() const { return file_backed_; }
+
+  // Asks the operating system to start reading the rows of `ids` from the
+  // file, so that a later access does not wait for the disk. Does nothing
+  // for a store in host memory.
+  void WillNeed(absl::Span<const int64_t> ids);
+
+  // Copies rows between the store and a buffer of rows of `row_bytes()`
+  // bytes each. `rows` holds (id, buffer row) pairs.
+  void WriteRows(const char* buffer,
+                 absl::Span<const std::pair<int64_t, int64_t>> rows);
+  void ReadRows(absl::Span<const std::pair<int64_t, int64_t>> rows,
+                char* buffer);
+
+  // Bytes of host memory held by the store. For a file-backed store, this
+  // does not count the pages the operating system keeps resident.
+  size_t MemoryUsed() const { return file_backed_ ? 0 : size_; }
+
+ private:
+  EmbeddingRowStore(char* base, size_t size, int64_t row_bytes,
+                    bool file_backed)
+      : base_(base),
+        size_(size),
+        row_bytes_(row_bytes),
+        file_backed_(file_backed) {}
+
+  char* const base_;
+  const size_t size_;
+  const int64_t row_bytes_;
+  const bool file_backed_;
+};
+
+// An embedding table too large for a single device. All rows live in an
+// EmbeddingRowStore on the host, and the rows in use are cached in a
+// fixed-size tensor on the device that runs the gather and scatter kernels.
+// Each kernel moves the rows its batch is missing between the tiers in one
+// batched copy.
+class TieredEmbeddingVar : public ResourceBase {
+ public:
+  TieredEmbeddingVar() = default;
+
+  TieredEmbeddingVar(const TieredEmbeddingVar&) = delete;
+  TieredEmbeddingVar& operator=(const TieredEmbeddingVar&) = delete;
+
+  mutex* mu() TF_LOCK_RETURNED(mu_) { return &mu_; }
+
+  // Sets the table to `value`, with a device cache of `cache_capacity` rows
+  // and a store backed by `backing_file` (host memory if empty).
+  Status Initialize(const Tensor& value, int64_t cache_capacity,
+                    const std::string& backing_file)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  bool is_initialized() const TF_SHARED_LOCKS_REQUIRED(mu_) {
+    return store_ != nullptr;
+  }
+  DataType dtype() const TF_SHARED_LOCKS_REQUIRED(mu_) { return dtype_; }
+  // The shape of the whole table.
+  const TensorShape& shape() const TF_SHARED_LOCKS_REQUIRED(mu_) {
+    return shape_;
+  }
+  int64_t num_rows() const TF_SHARED_LOCKS_REQUIRED(mu_) {
+    return shape_.dim_size(0);
+  }
+  // The number of elements of each row.
+  int64_t row_size() const TF_SHARED_LOCKS_REQUIRED(mu_) {
+    int64_t size = 1;
+    for (int i = 1; i < shape_.dims(); ++i) size *= shape_.dim_size(i);
+    return size;
+  }
+
+  LfuRowCache* cache_index() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return cache_index_.get();
+  }
+  EmbeddingRowStore* store() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return store_.get();
+  }
+
+  // Returns the device cache, a [cache_capacity, row_size] tensor, and
+  // allocates it on the device of `context` on first use. Fails if the cache
+  // lives on another device.
+  Status GetCache(OpKernelContext* context, Tensor** cache)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Admits the rows of `ids` into a cache in host memory, and moves the
+  // evicted and missing rows between the cache and the store. Returns the
+  // slot of every id in `plan`. Fails unless the cache is, or can be
+  // allocated, on the CPU device of `context`.
+  Status AdmitOnHost(OpKernelContext* context, absl::Span<const int64_t> ids,
+                     LfuRowCache::Plan* plan, Tensor** cache)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Starts paging in the rows of `ids` from a file-backed store on a
+  // background thread, so that the next batch that uses them does not wait
+  // for the disk. Returns immediately.
+  void Prefetch(std::vector<int64_t> ids) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  std::string DebugString() const override;
+  int64_t MemoryUsed() const override;
+
+ private:
+  mutable mutex mu_;
+  DataType dtype_ TF_GUARDED_BY(mu_) = DT_INVALID;
+  TensorShape shape_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<EmbeddingRowStore> store_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<LfuRowCache> cache_index_ TF_GUARDED_BY(mu_);
+  Tensor cache_ TF_GUARDED_BY(mu_);
+  std::string cache_device_ TF_GUARDED_BY(mu_);
+  // Declared after `store_`, so that pending prefetches finish before the
+  // store goes away.
+  std::unique_ptr<thread::ThreadPool> prefetch_pool_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_TIERED_EMBEDDING_VAR_H_
@@ -0,0 +1,151 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/tiered_embedding_var.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+using Pairs = std::vector<std::pair<int64_t, int64_t>>;
+
+TEST(LfuRowCacheTest, FillsFreeSlots) {
+  LfuRowCache cache(4);
+  LfuRowCache::Plan plan;
+  TF_ASSERT_OK(cache.Admit({7, 3, 7}, &plan));
+  EXPECT_EQ(plan.slots, std::vector<int64_t>({0, 1, 0}));
+  EXPECT_EQ(plan.fills, Pairs({{7, 0}, {3, 1}}));
+  EXPECT_TRUE(plan.write_backs.empty());
+  EXPECT_EQ(cache.size(), 2);
+
+  TF_ASSERT_OK(cache.Admit({3, 7}, &plan));
+  EXPECT_EQ(plan.slots, std::vector<int64_t>({1, 0}));
+  EXPECT_TRUE(plan.fills.empty());
+}
+
+TEST(LfuRowCacheTest, EvictsLeastFrequentlyUsed) {
+  LfuRowCache cache(2);
+  LfuRowCache::Plan plan;
+  TF_ASSERT_OK(cache.Admit({1, 1, 1, 2}, &plan));
+  TF_ASSERT_OK(cache.Admit({3}, &plan));
+  EXPECT_EQ(plan.fills, Pairs({{3, 1}}));
+  EXPECT_TRUE(cache.Contains(1));
+  EXPECT_FALSE(cache.Contains(2));
+  EXPECT_TRUE(cache.Contains(3));
+}
+
+TEST(LfuRowCacheTest, KeepsRowsOfTheBatch) {
+  LfuRowCache cache(2);
+  LfuRowCache::Plan plan;
+  TF_ASSERT_OK(cache.Admit({1, 1, 2}, &plan));
+  // 2 is used less than 1, but is part of the batch.
+  TF_ASSERT_OK(cache.Admit({3, 2}, &plan));
+  EXPECT_EQ(plan.slots, std::vector<int64_t>({0, 1}));
+  EXPECT_EQ(plan.fills, Pairs({{3, 0}}));
+  EXPECT_FALSE(cache.Contains(1));
+}
+
+TEST(LfuRowCacheTest, WritesBackDirtyRows) {
+  LfuRowCache cache(1);
+  LfuRowCache::Plan plan;
+  TF_ASSERT_OK(cache.Admit({5}, &plan));
+  TF_ASSERT_OK(cache.Admit({6}, &plan));
+  EXPECT_TRUE(plan.write_backs.empty());
+  cache.MarkDirty(plan.slots[0]);
+  TF_ASSERT_OK(cache.Admit({5}, &plan));
+  EXPECT_EQ(plan.write_backs, Pairs({{6, 0}}));
+  EXPECT_EQ(plan.fills, Pairs({{5, 0}}));
+  // A refilled slot starts out clean.
+  TF_ASSERT_OK(cache.Admit({6}, &plan));
+  EXPECT_TRUE(plan.write_backs.empty());
+}
+
+TEST(LfuRowCacheTest, AgesCounts) {
+  LfuRowCache cache(2);
+  LfuRowCache::Plan plan;
+  TF_ASSERT_OK(cache.Admit(std::vector<int64_t>(100, 1), &plan));
+  // Without aging, 2 would need more than 100 uses to become hotter than 1.
+  for (int i = 0; i < 40; ++i) {
+    TF_ASSERT_OK(cache.Admit({2}, &plan));
+  }
+  TF_ASSERT_OK(cache.Admit({3}, &plan));
+  EXPECT_FALSE(cache.Contains(1));
+  EXPECT_TRUE(cache.Contains(2));
+}
+
+TEST(LfuRowCacheTest, RejectsBatchLargerThanCache) {
+  LfuRowCache cache(2);
+  LfuRowCache::Plan plan;
+  TF_ASSERT_OK(cache.Admit({1}, &plan));
+  EXPECT_TRUE(errors::IsResourceExhausted(cache.Admit({2, 3, 4}, &plan)));
+  EXPECT_EQ(cache.size(), 1);
+  EXPECT_TRUE(cache.Contains(1));
+}
+
+TEST(EmbeddingRowStoreTest, FileBacked) {
+  const std::string path =
+      io::JoinPath(testing::TmpDir(), "embedding_row_store_test");
+  std::unique_ptr<EmbeddingRowStore> store;
+  TF_ASSERT_OK(EmbeddingRowStore::Create(/*num_rows=*/1000,
+                                         /*row_bytes=*/12, path, &store));
+  EXPECT_TRUE(store->is_file_backed());
+  EXPECT_EQ(store->MemoryUsed(), 0u);
+  for (int64_t id = 0; id < 1000; ++id) {
+    std::memcpy(store->row(id), &id, sizeof(id));
+  }
+  store->WillNeed({999, 0, 500});
+  for (int64_t id = 0; id < 1000; ++id) {
+    int64_t value;
+    std::memcpy(&value, store->row(id), sizeof(value));
+    EXPECT_EQ(value, id);
+  }
+}
+
+TEST(TieredEmbeddingVarTest, Initialize) {
+  core::RefCountPtr<TieredEmbeddingVar> var(new TieredEmbeddingVar);
+  mutex_lock l(*var->mu());
+  Tensor value = test::AsTensor<float>({1, 2, 3, 4, 5, 6}, {3, 2});
+  TF_ASSERT_OK(var->Initialize(value, /*cache_capacity=*/8, ""));
+  EXPECT_EQ(var->num_rows(), 3);
+  EXPECT_EQ(var->row_size(), 2);
+  // There are no more slots than rows.
+  EXPECT_EQ(var->cache_index()->capacity(), 3);
+  EXPECT_EQ(reinterpret_cast<float*>(var->store()->row(2))[1], 6);
+  EXPECT_TRUE(errors::IsFailedPrecondition(var->Initialize(value, 8, "")));
+}
+
+TEST(TieredEmbeddingVarTest, RejectsScalars) {
+  core::RefCountPtr<TieredEmbeddingVar> var(new TieredEmbeddingVar);
+  mutex_lock l(*var->mu());
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      var->Initialize(test::AsScalar<float>(1), 8, "")));
+  EXPECT_FALSE(var->is_initialized());
+}
+
+}  // namespace
+}  // namespace tensorflow
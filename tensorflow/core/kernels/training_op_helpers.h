@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_KERNELS_TRAINING_OP_HELPERS_H_
 
 #include <optional>
+#include <type_traits>
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -280,6 +281,25 @@ Status GetInputTensorFromVariable(OpKernelContext* ctx, int input,
   return absl::OkStatus();
 }
 
+// Marks the rows `indices` of the resource variable inputs of a sparse update
+// op, e.g. the variable and the accumulators of a sparse apply op, as touched
+// in those of them that track touched rows (see Var::TrackTouchedRows). Only
+// done on CPU, where `indices` can be read.
+template <typename Device>
+void MarkVariableRowsTouched(OpKernelContext* ctx, const Tensor& indices) {
+  if (!std::is_same<Device, Eigen::ThreadPoolDevice>::value ||
+      !Var::AnyTracksTouchedRows()) {
+    return;
+  }
+  for (int i = 0; i < ctx->num_inputs(); ++i) {
+    if (ctx->input_dtype(i) != DT_RESOURCE) continue;
+    core::RefCountPtr<Var> var;
+    if (LookupResource(ctx, HandleFromInput(ctx, i), &var).ok()) {
+      var->MarkRowsTouched(indices);
+    }
+  }
+}
+
 }  // end namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_KERNELS_TRAINING_OP_HELPERS_H_
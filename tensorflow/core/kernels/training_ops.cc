@@ -1285,6 +1285,7 @@ class SparseApplyAdadeltaOp : public OpKernel {
           epsilon.scalar<T>(), grad.flat_outer_dims<T>(), indices_vec);
     }
 
+    MarkVariableRowsTouched<Device>(ctx, indices);
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
 
@@ -1544,6 +1545,7 @@ class SparseApplyProximalGradientDescentOp : public OpKernel {
       }
     }
 
+    MarkVariableRowsTouched<Device>(ctx, indices);
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
 
@@ -1947,6 +1949,7 @@ class SparseApplyAdagradOp : public OpKernel {
                  lr.scalar<T>(), lr.scalar<T>(), grad.flat_outer_dims<T>(),
                  indices.vec<Tindex>(), inner_dim, update_slots_));
 
+    MarkVariableRowsTouched<Device>(ctx, indices);
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
 
@@ -2080,6 +2083,7 @@ class SparseApplyAdagradV2Op : public OpKernel {
                  lr.scalar<T>(), epsilon.scalar<T>(), grad.flat_outer_dims<T>(),
                  indices.vec<Tindex>(), inner_dim, update_slots_));
 
+    MarkVariableRowsTouched<Device>(ctx, indices);
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
 
@@ -2228,6 +2232,7 @@ class SparseApplyProximalAdagradOp : public OpKernel {
                  lr.scalar<T>(), l1.scalar<T>(), l2.scalar<T>(),
                  grad.flat_outer_dims<T>(), indices.vec<Tindex>(), inner_dim));
 
+    MarkVariableRowsTouched<Device>(ctx, indices);
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
 
@@ -2557,6 +2562,7 @@ class SparseApplyAdagradDAOp : public OpKernel {
       }
     }
 
+    MarkVariableRowsTouched<Device>(ctx, indices);
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
 
@@ -2930,6 +2936,7 @@ class SparseApplyFtrlOp : public OpKernel {
                  lr_power.scalar<T>(), grad.flat_outer_dims<T>(), indices_vec,
                  inner_dim, multiply_linear_by_lr_));
 
+    MarkVariableRowsTouched<Device>(ctx, indices);
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
 
@@ -3250,6 +3257,7 @@ class SparseApplyMomentumOp : public OpKernel {
       }
     }
 
+    MarkVariableRowsTouched<Device>(ctx, indices);
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
 
@@ -3453,6 +3461,7 @@ class SparseApplyKerasMomentumOp : public OpKernel {
             "indices", SliceDebugString(indices.shape(), bad_i), " = ",
             indices_flat(bad_i), " is not in [0, ", var.dim_size(0), ")"));
 
+    MarkVariableRowsTouched<Device>(ctx, indices);
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
 
@@ -4291,6 +4300,7 @@ class SparseApplyRMSPropOp : public OpKernel {
       }
     }
 
+    MarkVariableRowsTouched<Device>(ctx, indices);
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
 
@@ -4433,6 +4443,7 @@ class SparseApplyCenteredRMSPropOp : public OpKernel {
       }
     }
 
+    MarkVariableRowsTouched<Device>(ctx, indices);
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
 
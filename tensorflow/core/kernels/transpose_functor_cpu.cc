@@ -15,11 +15,14 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <complex>
+#include <type_traits>
 
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/nontemporal_store.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/kernels/transpose_functor.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -68,12 +71,96 @@ void TransposeSimple(const CPUDevice& device, const Tensor& in,
   device.parallelFor(in.NumElements(), cost, std::move(transpose_fn));
 }
 
+// Returns the side of the square tiles of TransposeTiled: the largest power of
+// two such that an input and an output tile fit in the L1 cache together.
+template <typename T>
+int64_t TransposeTileSize() {
+  static const int64_t tile_size = [] {
+    const int64_t l1_cache_size = Eigen::l1CacheSize();
+    int64_t tile_size = 8;
+    while (tile_size < 256 &&
+           2 * (2 * tile_size) * (2 * tile_size) * sizeof(T) <=
+               l1_cache_size) {
+      tile_size *= 2;
+    }
+    return tile_size;
+  }();
+  return tile_size;
+}
+
+// Transposes the two innermost dimensions of `in`, after merging the
+// dimensions that stay adjacent, one cache-sized tile at a time. Returns false
+// if `perm` is not such a transpose or `in` is too small to be worth tiling.
+template <typename T>
+bool TransposeTiled(const CPUDevice& device, const Tensor& in,
+                    const gtl::ArraySlice<int32> perm, Tensor* out) {
+  // Below this size the Eigen shuffle stays in cache anyway.
+  constexpr int64_t kMinTiledBytes = 256 << 10;
+  if (in.TotalBytes() < kMinTiledBytes || in.dims() < 2) return false;
+
+  internal::TransposePermsVec new_perm;
+  internal::TransposeDimsVec new_dims(in.dims());
+  internal::ReduceTransposeDimensions(in.shape(), perm, &new_perm, &new_dims);
+  int64_t batch = 1;
+  if (new_perm.size() == 3 && new_perm[0] == 0 && new_perm[1] == 2 &&
+      new_perm[2] == 1) {
+    batch = new_dims[0];
+  } else if (new_perm.size() != 2 || new_perm[0] != 1 || new_perm[1] != 0) {
+    return false;
+  }
+  const int64_t rows = new_dims[new_dims.size() - 2];
+  const int64_t cols = new_dims[new_dims.size() - 1];
+  const int64_t tile_size = TransposeTileSize<T>();
+  if (rows < tile_size || cols < tile_size) return false;
+
+  const T* p = reinterpret_cast<const T*>(in.tensor_data().data());
+  T* q = reinterpret_cast<T*>(const_cast<char*>(out->tensor_data().data()));
+  const int64_t row_tiles = (rows + tile_size - 1) / tile_size;
+  const int64_t col_tiles = (cols + tile_size - 1) / tile_size;
+  const bool nontemporal = internal::UseNonTemporalStores(out->TotalBytes());
+
+  // Every tile reads `tile_size` rows of the input and writes `tile_size`
+  // contiguous rows of the output.
+  auto transpose_fn = [=](int64_t begin, int64_t end) {
+    for (int64_t tile = begin; tile < end; ++tile) {
+      const int64_t b = tile / (row_tiles * col_tiles);
+      const int64_t r0 = (tile / col_tiles) % row_tiles * tile_size;
+      const int64_t c0 = tile % col_tiles * tile_size;
+      const int64_t r1 = std::min(r0 + tile_size, rows);
+      const int64_t c1 = std::min(c0 + tile_size, cols);
+      const T* src = p + b * rows * cols;
+      T* dst = q + b * rows * cols;
+      for (int64_t c = c0; c < c1; ++c) {
+        T* dst_row = dst + c * rows;
+        if (nontemporal) {
+          for (int64_t r = r0; r < r1; ++r) {
+            internal::StoreNonTemporal(dst_row + r, src[r * cols + c]);
+          }
+        } else {
+          for (int64_t r = r0; r < r1; ++r) dst_row[r] = src[r * cols + c];
+        }
+      }
+    }
+    if (nontemporal) internal::NonTemporalStoreFence();
+  };
+  const double tile_bytes = tile_size * tile_size * sizeof(T);
+  Eigen::TensorOpCost cost(/*bytes_loaded=*/tile_bytes,
+                           /*bytes_stored=*/tile_bytes,
+                           /*compute_cycles=*/tile_size * tile_size);
+  device.parallelFor(batch * row_tiles * col_tiles, cost,
+                     std::move(transpose_fn));
+  return true;
+}
+
 }  // namespace
 
 template <typename T, bool conjugate>
 struct Transpose<CPUDevice, T, conjugate> {
   static void run(const CPUDevice& d, const Tensor& in,
                   const gtl::ArraySlice<int32> perm, Tensor* out) {
+    if constexpr (!conjugate && std::is_trivially_copyable_v<T>) {
+      if (TransposeTiled<T>(d, in, perm, out)) return;
+    }
     switch (in.dims()) {
       case 2:
         internal::TransposeUsingEigen<CPUDevice, T, 2>(d, in, perm, conjugate,
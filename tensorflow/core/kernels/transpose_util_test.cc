@@ -13,10 +13,19 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#define EIGEN_USE_THREADS
+
+#include <numeric>
+
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/kernels/transpose_functor.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 
@@ -130,4 +139,97 @@ TEST_F(TransposeUtilTest, NonSingletonDimensionAlignment) {
                                                      {0, 1, 2, 5, 4, 3}));
 }
 
+// Transposes `in` by `perm` one element at a time.
+template <typename T>
+Tensor ReferenceTranspose(const Tensor& in, const std::vector<int32>& perm) {
+  TensorShape out_shape;
+  for (int32 d : perm) out_shape.AddDim(in.dim_size(d));
+  Tensor out(in.dtype(), out_shape);
+  const auto in_flat = in.flat<T>();
+  auto out_flat = out.flat<T>();
+  std::vector<int64_t> index(in.dims(), 0);
+  for (int64_t i = 0; i < in.NumElements(); ++i) {
+    int64_t out_index = 0;
+    for (int d = 0; d < perm.size(); ++d) {
+      out_index = out_index * out_shape.dim_size(d) + index[perm[d]];
+    }
+    out_flat(out_index) = in_flat(i);
+    for (int d = in.dims() - 1; d >= 0 && ++index[d] == in.dim_size(d); --d) {
+      index[d] = 0;
+    }
+  }
+  return out;
+}
+
+template <typename T>
+void TestTranspose(const TensorShape& shape, const std::vector<int32>& perm) {
+  thread::ThreadPool pool(Env::Default(), "transpose", 4);
+  Eigen::ThreadPoolDevice device(pool.AsEigenThreadPool(), 4);
+
+  Tensor in(DataTypeToEnum<T>::v(), shape);
+  auto in_flat = in.flat<T>();
+  for (int64_t i = 0; i < in.NumElements(); ++i) in_flat(i) = T(i % 251);
+  Tensor expected = ReferenceTranspose<T>(in, perm);
+  Tensor out(in.dtype(), expected.shape());
+  TF_ASSERT_OK(DoTranspose(device, in, perm, &out));
+  test::ExpectTensorEqual<T>(out, expected);
+}
+
+// Inputs of at least 256KB whose transpose swaps the two innermost (merged)
+// dimensions are transposed in tiles.
+TEST(TransposeFunctorTest, TiledMatrixTranspose) {
+  TestTranspose<float>({512, 300}, {1, 0});
+  TestTranspose<uint8>({1000, 515}, {1, 0});
+  TestTranspose<double>({257, 300}, {1, 0});
+}
+
+TEST(TransposeFunctorTest, TiledBatchTranspose) {
+  TestTranspose<float>({4, 200, 100}, {0, 2, 1});
+  // NHWC -> NCHW
+  TestTranspose<float>({2, 28, 28, 96}, {0, 3, 1, 2});
+  // NCHW -> NHWC
+  TestTranspose<int16>({2, 96, 28, 28}, {0, 2, 3, 1});
+}
+
+TEST(TransposeFunctorTest, UntiledTranspose) {
+  TestTranspose<float>({8, 7}, {1, 0});
+  TestTranspose<float>({40, 50, 60}, {2, 1, 0});
+}
+
+static void BM_Transpose(::testing::benchmark::State& state,
+                         const TensorShape& shape,
+                         const std::vector<int32>& perm) {
+  const int num_threads = state.range(0);
+  thread::ThreadPool pool(Env::Default(), "transpose", num_threads);
+  Eigen::ThreadPoolDevice device(pool.AsEigenThreadPool(), num_threads);
+
+  Tensor in(DT_FLOAT, shape);
+  in.flat<float>().setRandom();
+  TensorShape out_shape;
+  for (int32 d : perm) out_shape.AddDim(shape.dim_size(d));
+  Tensor out(DT_FLOAT, out_shape);
+
+  for (auto s : state) {
+    TF_CHECK_OK(DoTranspose(device, in, perm, &out));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * 2 *
+                          in.TotalBytes());
+}
+
+static void BM_TransposeMatrix(::testing::benchmark::State& state) {
+  BM_Transpose(state, {4096, 4096}, {1, 0});
+}
+
+static void BM_TransposeNHWCToNCHW(::testing::benchmark::State& state) {
+  BM_Transpose(state, {32, 56, 56, 256}, {0, 3, 1, 2});
+}
+
+static void BM_TransposeNCHWToNHWC(::testing::benchmark::State& state) {
+  BM_Transpose(state, {32, 256, 56, 56}, {0, 2, 3, 1});
+}
+
+BENCHMARK(BM_TransposeMatrix)->UseRealTime()->Arg(1)->Arg(4)->Arg(16);
+BENCHMARK(BM_TransposeNHWCToNCHW)->UseRealTime()->Arg(1)->Arg(4)->Arg(16);
+BENCHMARK(BM_TransposeNCHWToNHWC)->UseRealTime()->Arg(1)->Arg(4)->Arg(16);
+
 }  // namespace tensorflow
@@ -13,9 +13,12 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <functional>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/bounds_check.h"
@@ -26,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace {
@@ -68,6 +72,130 @@ struct UniqueOpHashMap<bfloat16, TIndex> {
   using map_type = std::unordered_map<bfloat16, TIndex>;
 };
 
+// Integer inputs of at least this many elements are uniquified in parallel.
+constexpr int64_t kParallelUniqueMinSize = 1 << 17;
+
+template <typename T>
+constexpr bool kSupportsParallelUnique =
+    std::is_integral_v<T> && !std::is_same_v<T, bool>;
+
+// Uniquifies the integers of `input` on `workers`. The results are the same
+// as inserting the elements into a hash map one by one: `idx` maps every
+// element to its unique value, and the unique values, returned in order, are
+// numbered by their first occurrence.
+//
+// The elements are first scattered into partitions by the high bits of
+// their hash, keeping their relative order, so that every partition can be
+// deduplicated independently. The first occurrences are then numbered by a
+// parallel prefix sum over the input positions.
+template <typename T, typename TIndex>
+std::vector<T> ParallelUnique(thread::ThreadPool* workers,
+                              typename TTypes<T>::ConstFlat input,
+                              typename TTypes<TIndex>::Vec idx) {
+  const int64_t n = input.size();
+  int bits = 1;
+  while ((1 << bits) < 4 * workers->NumThreads()) ++bits;
+  const int num_partitions = 1 << bits;
+  const auto partition_of = [bits](T x) {
+    return static_cast<int>((static_cast<uint64>(x) * 0x9E3779B97F4A7C15ull) >>
+                            (64 - bits));
+  };
+  const int64_t num_chunks = num_partitions;
+  const int64_t chunk_size = (n + num_chunks - 1) / num_chunks;
+  const auto for_each_chunk = [&](std::function<void(int64_t, int64_t,
+                                                     int64_t)> fn) {
+    workers->ParallelFor(num_chunks, chunk_size * 10,
+                         [&](int64_t begin, int64_t end) {
+                           for (int64_t c = begin; c < end; ++c) {
+                             fn(c, std::min(n, c * chunk_size),
+                                std::min(n, (c + 1) * chunk_size));
+                           }
+                         });
+  };
+  const auto for_each_partition = [&](std::function<void(int)> fn) {
+    workers->ParallelFor(num_partitions, n / num_partitions * 50,
+                         [&](int64_t begin, int64_t end) {
+                           for (int64_t p = begin; p < end; ++p) fn(p);
+                         });
+  };
+
+  // Scatters the elements into partitions, chunk by chunk, so that every
+  // partition holds its elements in input order.
+  std::vector<int64_t> offsets(num_chunks * num_partitions, 0);
+  for_each_chunk([&](int64_t c, int64_t begin, int64_t end) {
+    int64_t* counts = &offsets[c * num_partitions];
+    for (int64_t i = begin; i < end; ++i) ++counts[partition_of(input(i))];
+  });
+  std::vector<int64_t> partition_starts(num_partitions + 1);
+  int64_t total = 0;
+  for (int p = 0; p < num_partitions; ++p) {
+    partition_starts[p] = total;
+    for (int64_t c = 0; c < num_chunks; ++c) {
+      const int64_t count = offsets[c * num_partitions + p];
+      offsets[c * num_partitions + p] = total;
+      total += count;
+    }
+  }
+  partition_starts[num_partitions] = total;
+  std::vector<T> values(n);
+  std::vector<int64_t> positions(n);
+  for_each_chunk([&](int64_t c, int64_t begin, int64_t end) {
+    int64_t* next = &offsets[c * num_partitions];
+    for (int64_t i = begin; i < end; ++i) {
+      const int64_t j = next[partition_of(input(i))]++;
+      values[j] = input(i);
+      positions[j] = i;
+    }
+  });
+
+  // Deduplicates every partition, and flags the first occurrences.
+  std::vector<TIndex> local_ids(n);
+  std::vector<std::vector<int64_t>> firsts(num_partitions);
+  std::vector<char> is_first(n, 0);
+  for_each_partition([&](int p) {
+    absl::flat_hash_map<T, TIndex> uniq;
+    uniq.reserve(partition_starts[p + 1] - partition_starts[p]);
+    for (int64_t j = partition_starts[p]; j < partition_starts[p + 1]; ++j) {
+      auto it =
+          uniq.emplace(values[j], static_cast<TIndex>(firsts[p].size()));
+      local_ids[j] = it.first->second;
+      if (it.second) {
+        firsts[p].push_back(positions[j]);
+        is_first[positions[j]] = 1;
+      }
+    }
+  });
+
+  // Numbers the first occurrences in input order.
+  std::vector<int64_t> chunk_starts(num_chunks + 1, 0);
+  for_each_chunk([&](int64_t c, int64_t begin, int64_t end) {
+    chunk_starts[c + 1] =
+        std::count(is_first.begin() + begin, is_first.begin() + end, 1);
+  });
+  for (int64_t c = 0; c < num_chunks; ++c) {
+    chunk_starts[c + 1] += chunk_starts[c];
+  }
+  for_each_chunk([&](int64_t c, int64_t begin, int64_t end) {
+    TIndex id = chunk_starts[c];
+    for (int64_t i = begin; i < end; ++i) {
+      if (is_first[i]) idx(i) = id++;
+    }
+  });
+
+  std::vector<T> uniq(chunk_starts[num_chunks]);
+  for_each_partition([&](int p) {
+    std::vector<TIndex> ids(firsts[p].size());
+    for (size_t k = 0; k < ids.size(); ++k) {
+      ids[k] = idx(firsts[p][k]);
+      uniq[ids[k]] = input(firsts[p][k]);
+    }
+    for (int64_t j = partition_starts[p]; j < partition_starts[p + 1]; ++j) {
+      idx(positions[j]) = ids[local_ids[j]];
+    }
+  });
+  return uniq;
+}
+
 // `UniqueOp` computes the unique elements in the input tensor.
 //
 // * `T` is the element type.
@@ -149,6 +277,24 @@ class UniqueOp : public OpKernel {
       // to them as in the general case.
       auto Tin = input.flat<T>();
       const int64_t N = static_cast<int64_t>(Tin.size());
+      thread::ThreadPool* workers =
+          context->device()->tensorflow_cpu_worker_threads()->workers;
+
+      if constexpr (kSupportsParallelUnique<T>) {
+        if (N >= kParallelUniqueMinSize && workers->NumThreads() > 1) {
+          std::vector<T> uniq =
+              ParallelUnique<T, TIndex>(workers, Tin, idx_vec);
+          uniq_size = static_cast<int64_t>(uniq.size());
+          TensorShape output_shape(input.shape());
+          output_shape.set_dim(axis, uniq_size);
+          Tensor* output = nullptr;
+          OP_REQUIRES_OK(context,
+                         context->allocate_output(0, output_shape, &output));
+          std::copy(uniq.begin(), uniq.end(), output->flat<T>().data());
+          ComputeCounts(context, *idx, uniq_size);
+          return;
+        }
+      }
 
       typename UniqueOpHashMap<T, TIndex>::map_type uniq;
       uniq.reserve(2 * N);
@@ -225,7 +371,15 @@ class UniqueOp : public OpKernel {
       }
     }
 
+    ComputeCounts(context, *idx, uniq_size);
+  }
+
+ private:
+  // Outputs how often every unique value occurs, for UniqueWithCounts.
+  void ComputeCounts(OpKernelContext* context, const Tensor& idx,
+                     int64_t uniq_size) {
     if (num_outputs() > 2) {
+      auto idx_vec = idx.vec<TIndex>();
       Tensor* output = nullptr;
       OP_REQUIRES_OK(context, context->allocate_output(
                                   2, TensorShape({uniq_size}), &output));
@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/public/session_options.h"
 
 namespace tensorflow {
 
@@ -111,6 +112,37 @@ void BM_Unique_INT32_Repeat(::testing::benchmark::State& state) {
                           sizeof(int32));
 }
 
+// Compares the parallel kernel for large integer inputs with the serial
+// kernel, which runs when the device has a single intra-op thread.
+void BM_Unique_INT64_Threads(::testing::benchmark::State& state) {
+  const int dim = state.range(0);
+  const int num_threads = state.range(1);
+
+  Graph* g = new Graph(OpRegistry::Global());
+
+  Tensor input(DT_INT64, TensorShape({dim}));
+  auto input_flat = input.flat<int64_t>();
+  for (int i = 0; i < dim; ++i) {
+    // About one id in four repeats.
+    input_flat(i) = std::rand() % (dim / 4 * 3 + 1);
+  }
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Unique")
+                  .Input(test::graph::Constant(g, input))
+                  .Attr("T", DT_INT64)
+                  .Finalize(g, &node));
+  FixupSourceAndSinkEdges(g);
+
+  SessionOptions options;
+  options.config.set_intra_op_parallelism_threads(num_threads);
+  test::Benchmark("cpu", g, &options, nullptr, nullptr,
+                  "SINGLE_THREADED_EXECUTOR", /*old_benchmark_api*/ false)
+      .Run(state);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * dim *
+                          sizeof(int64_t));
+}
+
 TensorProto GetRandomStringsTensorProto(int dim, int max_str_len) {
   TensorProto tensor_proto;
   tensor_proto.set_dtype(DT_STRING);
@@ -193,6 +225,15 @@ BENCHMARK(BM_Unique_INT32_Repeat)
     ->ArgPair(64 * 1024, 64 * 1024 * 1024)
     ->ArgPair(1024 * 1024, 64 * 1024 * 1024);
 
+BENCHMARK(BM_Unique_INT64_Threads)
+    ->UseRealTime()
+    ->ArgPair(1024 * 1024, 1)
+    ->ArgPair(1024 * 1024, 4)
+    ->ArgPair(1024 * 1024, 16)
+    ->ArgPair(10 * 1024 * 1024, 1)
+    ->ArgPair(10 * 1024 * 1024, 4)
+    ->ArgPair(10 * 1024 * 1024, 16);
+
 BENCHMARK(BM_Unique_STRING)
     ->UseRealTime()
     ->Arg(32)
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/online_softmax_cpu.h"
 #include "tensorflow/core/util/bcast.h"
 #include "tensorflow/core/util/determinism.h"
 #include "tensorflow/core/util/env_var.h"
@@ -100,8 +101,9 @@ class SoftmaxXentWithLogitsOp : public OpKernel {
   }
 };
 
-// Partial specialization for a CPUDevice, that uses the Eigen implementation
-// from XentEigenImpl.
+// Partial specialization for a CPUDevice, that uses the single-pass
+// OnlineSoftmaxCpu for float and double logits and labels of the same shape,
+// and the Eigen implementation from XentEigenImpl otherwise.
 namespace functor {
 template <typename Device, typename T>
 struct XentFunctorBase {
@@ -123,7 +125,31 @@ struct XentFunctorBase {
 };
 
 template <typename T>
-struct XentFunctor<CPUDevice, T> : XentFunctorBase<CPUDevice, T> {};
+struct XentFunctor<CPUDevice, T> : XentFunctorBase<CPUDevice, T> {
+  void operator()(const CPUDevice& d,
+                  const Eigen::DSizes<Eigen::DenseIndex, 2>& shape,
+                  const Eigen::array<Eigen::DenseIndex, 2>& logits_bcast,
+                  const Eigen::array<Eigen::DenseIndex, 2>& labels_bcast,
+                  typename TTypes<T>::ConstMatrix logits,
+                  typename TTypes<T>::ConstMatrix labels,
+                  typename TTypes<T>::Matrix scratch,
+                  typename TTypes<T>::Vec loss,
+                  typename TTypes<T>::Matrix backprop) {
+    if constexpr (IsOnlineSoftmaxType<T>()) {
+      const bool no_broadcast = logits_bcast[0] == 1 &&
+                                logits_bcast[1] == 1 &&
+                                labels_bcast[0] == 1 && labels_bcast[1] == 1;
+      if (no_broadcast) {
+        OnlineSoftmaxCpu<T>::Xent(d, logits.data(), labels.data(), shape[0],
+                                  shape[1], loss.data(), backprop.data());
+        return;
+      }
+    }
+    XentFunctorBase<CPUDevice, T>::operator()(d, shape, logits_bcast,
+                                              labels_bcast, logits, labels,
+                                              scratch, loss, backprop);
+  }
+};
 
 }  // namespace functor
 
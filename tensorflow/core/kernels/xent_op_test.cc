@@ -13,14 +13,123 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#define EIGEN_USE_THREADS
+
 #include "tensorflow/core/kernels/xent_op.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/online_softmax_cpu.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 
+class OnlineSoftmaxCpuTest : public ::testing::Test {
+ protected:
+  OnlineSoftmaxCpuTest()
+      : pool_(Env::Default(), "softmax", 4),
+        device_(pool_.AsEigenThreadPool(), 4) {}
+
+  // Logits spanning a large range, so that later blocks raise the running
+  // maximum.
+  static std::vector<double> Logits(int64_t n) {
+    std::vector<double> values(n);
+    for (int64_t i = 0; i < n; ++i) {
+      values[i] = (i % 997) * 0.05 + i * 1e-4 - 20;
+    }
+    return values;
+  }
+
+  thread::ThreadPool pool_;
+  Eigen::ThreadPoolDevice device_;
+};
+
+// The shapes cover single blocks, row-parallel batches, and few long rows
+// that are split into shards.
+static const std::vector<std::pair<int64_t, int64_t>> kShapes = {
+    {1, 1}, {1, 7}, {100, 3000}, {2, 100000}, {1, 250007}};
+
+TEST_F(OnlineSoftmaxCpuTest, Softmax) {
+  for (const auto& [rows, cols] : kShapes) {
+    std::vector<double> logits = Logits(rows * cols);
+    // Mask out a whole leading block of the first row.
+    for (int64_t c = 0; c < std::min<int64_t>(cols - 1, 3000); ++c) {
+      logits[c] = -std::numeric_limits<double>::infinity();
+    }
+    std::vector<double> softmax(rows * cols), log_softmax(rows * cols);
+    functor::OnlineSoftmaxCpu<double>::Softmax(
+        device_, logits.data(), rows, cols, softmax.data(), /*log=*/false);
+    functor::OnlineSoftmaxCpu<double>::Softmax(
+        device_, logits.data(), rows, cols, log_softmax.data(), /*log=*/true);
+    for (int64_t r = 0; r < rows; ++r) {
+      const double* x = logits.data() + r * cols;
+      double max = -std::numeric_limits<double>::infinity();
+      for (int64_t c = 0; c < cols; ++c) max = std::max(max, x[c]);
+      double sum = 0;
+      for (int64_t c = 0; c < cols; ++c) sum += std::exp(x[c] - max);
+      for (int64_t c = 0; c < cols; ++c) {
+        const int64_t i = r * cols + c;
+        EXPECT_NEAR(softmax[i], std::exp(x[c] - max) / sum, 1e-12)
+            << rows << "x" << cols << " at " << i;
+        if (std::isinf(x[c])) {
+          EXPECT_EQ(log_softmax[i], x[c]);
+        } else {
+          EXPECT_NEAR(log_softmax[i], x[c] - max - std::log(sum), 1e-9)
+              << rows << "x" << cols << " at " << i;
+        }
+      }
+    }
+  }
+}
+
+TEST_F(OnlineSoftmaxCpuTest, SoftmaxInPlace) {
+  std::vector<float> logits = {1, 2, 3, 4};
+  functor::OnlineSoftmaxCpu<float>::Softmax(device_, logits.data(), 1, 4,
+                                            logits.data(), /*log=*/false);
+  const float sum = std::exp(-3.f) + std::exp(-2.f) + std::exp(-1.f) + 1;
+  for (int c = 0; c < 4; ++c) {
+    EXPECT_FLOAT_EQ(logits[c], std::exp(c - 3.f) / sum);
+  }
+}
+
+TEST_F(OnlineSoftmaxCpuTest, Xent) {
+  for (const auto& [rows, cols] : kShapes) {
+    const std::vector<double> logits = Logits(rows * cols);
+    std::vector<double> labels(rows * cols);
+    for (int64_t i = 0; i < rows * cols; ++i) labels[i] = (i % 13) * 0.01;
+    std::vector<double> loss(rows), backprop(rows * cols);
+    functor::OnlineSoftmaxCpu<double>::Xent(device_, logits.data(),
+                                            labels.data(), rows, cols,
+                                            loss.data(), backprop.data());
+    for (int64_t r = 0; r < rows; ++r) {
+      const double* x = logits.data() + r * cols;
+      const double* l = labels.data() + r * cols;
+      double max = -std::numeric_limits<double>::infinity();
+      for (int64_t c = 0; c < cols; ++c) max = std::max(max, x[c]);
+      double sum = 0;
+      for (int64_t c = 0; c < cols; ++c) sum += std::exp(x[c] - max);
+      double expected_loss = 0;
+      for (int64_t c = 0; c < cols; ++c) {
+        expected_loss += l[c] * (std::log(sum) - (x[c] - max));
+        EXPECT_NEAR(backprop[r * cols + c], std::exp(x[c] - max) / sum - l[c],
+                    1e-12)
+            << rows << "x" << cols << " at " << r * cols + c;
+      }
+      EXPECT_NEAR(loss[r], expected_loss, 1e-9 * (1 + std::abs(expected_loss)))
+          << rows << "x" << cols << " row " << r;
+    }
+  }
+}
+
 template <class T>
 static Graph* Xent(int batch_size, int num_classes, DataType type) {
   Graph* g = new Graph(OpRegistry::Global());
@@ -81,4 +190,8 @@ BM_XentDev(64, 100000, gpu, float, DT_FLOAT);
 BM_XentDev_CPU(float, DT_FLOAT);
 BM_XentDev_CPU(bfloat16, DT_BFLOAT16);
 
+/// Small batches of a large vocabulary, where rows are split across threads.
+BM_XentDev(1, 250000, cpu, float, DT_FLOAT);
+BM_XentDev(16, 250000, cpu, float, DT_FLOAT);
+
 }  // end namespace tensorflow
@@ -372,6 +372,48 @@ TEST(ThreadPool, Parallelism) {
   }
 }
 
+// Counts the closures run by the pool named `pool_name`.
+class CountingTaskListener : public ThreadPoolTaskListener {
+ public:
+  explicit CountingTaskListener(const string& pool_name)
+      : pool_name_(pool_name) {}
+
+  void OnTaskRun(const std::string& pool_name, int64_t queue_length,
+                 int64_t wait_nanos, int64_t run_nanos) override {
+    if (pool_name != pool_name_) return;
+    EXPECT_GE(queue_length, 0);
+    EXPECT_GE(wait_nanos, 0);
+    EXPECT_GE(run_nanos, 0);
+    num_tasks_++;
+  }
+
+  int num_tasks() const { return num_tasks_; }
+
+ private:
+  const string pool_name_;
+  std::atomic<int> num_tasks_{0};
+};
+
+TEST(ThreadPool, TaskListener) {
+  CountingTaskListener listener("tf_listener_test");
+  SetThreadPoolTaskListener(&listener);
+  {
+    ThreadPool pool(Env::Default(), "listener_test", 4);
+    for (int i = 0; i < 100; ++i) {
+      pool.Schedule([]() {});
+    }
+  }
+  SetThreadPoolTaskListener(nullptr);
+  EXPECT_EQ(listener.num_tasks(), 100);
+
+  // Closures are not reported once the listener is unset.
+  {
+    ThreadPool pool(Env::Default(), "listener_test", 4);
+    pool.Schedule([]() {});
+  }
+  EXPECT_EQ(listener.num_tasks(), 100);
+}
+
 static void BM_Sequential(::testing::benchmark::State& state) {
   for (auto s : state) {
     state.PauseTiming();
@@ -139,6 +139,11 @@ REGISTER_OP("CollectiveReduceV2")
     .Attr("is_stateless: bool = false")
     .Attr("Nordering_token: int >= 0 = 0")
     .Attr("max_subdivs_per_device: int = -1")
+    .Attr("bucket_key: int = 0")
+    .Attr("bucket_size: int = 0")
+    .Attr("bucket_bytes: int = 0")
+    .Attr("compression: {'none', 'bf16', 'fp16'} = 'none'")
+    .Attr("compression_error_feedback: bool = false")
     .SetIsStateful()
     .SetIsDistributedCommunication()
     .SetShapeFn(shape_inference::UnchangedShape);
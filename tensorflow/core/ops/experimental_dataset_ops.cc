@@ -175,6 +175,9 @@ REGISTER_OP("CompressElement")
     .Input("components: input_types")
     .Output("compressed: variant")
     .Attr("input_types: list(type) >= 1")
+    .Attr("codec: string = ''")
+    .Attr("codec_level: int = -1")
+    .Attr("min_compression_bytes: int = 0")
     .SetShapeFn(shape_inference::ScalarShape);
 
 REGISTER_OP("UncompressElement")
@@ -581,6 +584,32 @@ REGISTER_OP("ExperimentalLatencyStatsDataset")
       return shape_inference::ScalarShape(c);
     });
 
+REGISTER_OP("LengthBucketedPaddedBatchDataset")
+    .Input("input_dataset: variant")
+    .Input("buffer_size: int64")
+    .Input("max_batch_size: int64")
+    .Input("max_batch_tokens: int64")
+    .Input("max_padding_ratio: float")
+    .Input("padded_shapes: N * int64")
+    .Input("padding_values: Toutput_types")
+    .Output("handle: variant")
+    .Attr("Toutput_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .Attr("N: int >= 1")
+    .Attr("metadata: string = ''")
+    .SetTypeConstructor(full_type::VariadicTensorContainer(TFT_DATASET,
+                                                           "Toutput_types"))
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle unused;
+      // buffer_size, max_batch_size, max_batch_tokens, and max_padding_ratio
+      // should be scalars.
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(4), 0, &unused));
+      return shape_inference::ScalarShape(c);
+    });
+
 REGISTER_OP("LMDBDataset")
     .Input("filenames: string")
     .Output("handle: variant")
@@ -1254,6 +1283,7 @@ REGISTER_OP("SnapshotChunkDataset")
     .Attr("output_types: list(type) >= 1")
     .Attr("output_shapes: list(shape) >= 1")
     .Attr("compression: string = ''")
+    .Attr("deterministic: string = 'default'")
     .SetTypeConstructor(full_type::VariadicTensorContainer(TFT_DATASET,
                                                            "output_types"))
     .SetShapeFn([](shape_inference::InferenceContext* c) {
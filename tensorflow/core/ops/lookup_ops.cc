@@ -550,4 +550,34 @@ REGISTER_OP("InitializeTableFromTextFileV2")
       return absl::OkStatus();
     });
 
+REGISTER_OP("SortedFileLookupTable")
+    .Input("filename: string")
+    .Output("table_handle: resource")
+    .Attr("container: string = ''")
+    .Attr("shared_name: string = ''")
+    .Attr("use_node_name_sharing: bool = false")
+    .Attr("key_dtype: {int64, string}")
+    .Attr("value_dtype: {int64, string}")
+    .SetIsStateful()
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle handle;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &handle));
+      c->set_output(0, c->Scalar());
+      return absl::OkStatus();
+    });
+
+REGISTER_OP("WriteSortedLookupTableFile")
+    .Input("filename: string")
+    .Input("keys: Tkeys")
+    .Input("values: Tvalues")
+    .Attr("Tkeys: {int64, string}")
+    .Attr("Tvalues: {int64, string}")
+    .SetIsStateful()
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle handle;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &handle));
+      TF_RETURN_IF_ERROR(c->Merge(c->input(1), c->input(2), &handle));
+      return absl::OkStatus();
+    });
+
 }  // namespace tensorflow
@@ -352,6 +352,34 @@ REGISTER_OP("_UnaryOpsComposition")
 expected to create these operators.
 )doc");
 
+REGISTER_OP("_FusedElementwise")
+    .Input("args: num_args * T")
+    .Output("y: T")
+    .Attr("T: {float, double}")
+    .Attr("num_args: int >= 1")
+    .Attr("fused_ops: list(string)")
+    .Attr("fused_operands: list(int)")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle out = c->input(0);
+      for (int i = 1; i < c->num_inputs(); ++i) {
+        TF_RETURN_IF_ERROR(BroadcastBinaryOpOutputShapeFnHelper(
+            c, out, c->input(i), /*incompatible_shape_error=*/true, &out));
+      }
+      c->set_output(0, out);
+      return absl::OkStatus();
+    })
+    .Doc(R"doc(
+Evaluates an expression DAG of cwise ops over broadcast `args` in one pass.
+
+Values 0..num_args-1 are the arguments, and value num_args+i is the result of
+`fused_ops[i]`. `fused_operands` lists the operand values of every fused op in
+order: one for a unary op, two for a binary op. The result of the last fused op
+is the output.
+
+*NOTE*: Do not invoke this operator directly in Python. Graph rewrite pass is
+expected to create these operators.
+)doc");
+
 #undef UNARY
 #undef UNARY_REAL
 #undef UNARY_COMPLEX
@@ -1010,6 +1038,7 @@ REGISTER_OP("_FusedMatMul")
     // Attributes for the LeakyRelu ---------------- //
     .Attr("leakyrelu_alpha: float = 0.2")
     // --------------------------------------------- //
+    .Attr("is_filter_const: bool = false")
     .SetShapeFn(shape_inference::MatMulShape)
     .Doc(R"doc(
 Performs a MatMul followed by a specified series of operations.
@@ -1029,6 +1058,9 @@ input is specified by `args`.
 and op A produces the _FusedConv2D output. Otherwise, the BiasAdd produces the
 _FusedConv2D output.
 
+`is_filter_const` is true if `b` is a constant. CPU kernels may then prepare `b`
+for the matrix multiplication once and reuse it across executions.
+
 *NOTE*: Do not invoke this operator directly in Python. Grappler is
 expected to create these operators.
 )doc");
@@ -1569,6 +1601,26 @@ REGISTER_OP("SparseSegmentSqrtNGradV2")
     .Attr("Tsegmentids: {int32, int64} = DT_INT32")
     .SetShapeFn(SparseSegmentReductionGradV2ShapeFn);
 
+REGISTER_OP("FusedEmbeddingLookupSparse")
+    .Input("params: T")
+    .Input("ids: Tidx")
+    .Input("segment_ids: Tsegmentids")
+    .Input("num_segments: Tnumsegments")
+    .Input("weights: float")
+    .Output("output: T")
+    .Attr("T: {bfloat16, half, float}")
+    .Attr("Tidx: {int32, int64} = DT_INT32")
+    .Attr("Tnumsegments: {int32, int64} = DT_INT32")
+    .Attr("Tsegmentids: {int32, int64} = DT_INT32")
+    .Attr("combiner: {'sum', 'mean', 'sqrtn'} = 'mean'")
+    .Attr("max_norm: float = -1")
+    .SetShapeFn([](InferenceContext* c) {
+      TF_RETURN_IF_ERROR(SparseSegmentReductionWithNumSegmentsShapeFn(c));
+      ShapeHandle weights_shape;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(4), 1, &weights_shape));
+      return absl::OkStatus();
+    });
+
 REGISTER_OP("All")
     .Input("input: bool")
     .Input("reduction_indices: Tidx")
@@ -496,6 +496,7 @@ REGISTER_OP("_FusedConv2D")
     // Attributes for the LeakyRelu ----------------------------------------- //
     .Attr("leakyrelu_alpha: float = 0.2")
     // ---------------------------------------------------------------------- //
+    .Attr("is_filter_const: bool = false")
     .SetShapeFn(shape_inference::Conv2DShapeWithExplicitPadding)
     .Doc(R"doc(
 Performs a convolution followed by a specified series of operations.
@@ -515,6 +516,9 @@ are specified by `args`.
 A produces the _FusedConv2D output. Otherwise, op X produces the _FusedConv2D
 output.
 
+`is_filter_const` is true if `filter` is a constant. CPU kernels may then
+prepare `filter` for the convolution once and reuse it across executions.
+
 *NOTE*: Do not invoke this operator directly in Python. Grappler is expected to
 create these operators.
 )doc");
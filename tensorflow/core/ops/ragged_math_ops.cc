@@ -23,6 +23,7 @@ using shape_inference::InferenceContext;
 using shape_inference::ShapeHandle;
 
 Status RaggedRangeShapeFn(InferenceContext* c);
+Status RaggedReduceRowsShapeFn(InferenceContext* c);
 
 //==============================================================================
 // Registered Ops
@@ -38,6 +39,15 @@ REGISTER_OP("RaggedRange")
     .Attr("Tsplits: {int32, int64} = DT_INT64")
     .SetShapeFn(RaggedRangeShapeFn);
 
+REGISTER_OP("RaggedReduceRows")
+    .Input("rt_splits: Tsplits")
+    .Input("rt_dense_values: T")
+    .Output("output: T")
+    .Attr("reduction: {'sum', 'prod', 'max', 'min'}")
+    .Attr("T: realnumbertypes")
+    .Attr("Tsplits: {int32, int64} = DT_INT64")
+    .SetShapeFn(RaggedReduceRowsShapeFn);
+
 //==============================================================================
 // Shape Functions
 //==============================================================================
@@ -78,4 +88,22 @@ Status RaggedRangeShapeFn(InferenceContext* c) {
   return absl::OkStatus();
 }
 
+Status RaggedReduceRowsShapeFn(InferenceContext* c) {
+  ShapeHandle splits;
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 1, &splits));
+  ShapeHandle values;
+  TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(1), 1, &values));
+
+  // The output has one row per row of the ragged tensor, and the inner
+  // dimensions of the values.
+  DimensionHandle nrows;
+  TF_RETURN_IF_ERROR(c->Subtract(c->Dim(splits, 0), 1, &nrows));
+  ShapeHandle inner;
+  TF_RETURN_IF_ERROR(c->Subshape(values, 1, &inner));
+  ShapeHandle output;
+  TF_RETURN_IF_ERROR(c->Concatenate(c->Vector(nrows), inner, &output));
+  c->set_output(0, output);
+  return absl::OkStatus();
+}
+
 }  // namespace tensorflow
@@ -410,6 +410,84 @@ REGISTER_OP("ResourceScatterUpdate")
     .Attr("Tindices: {int32, int64}")
     .SetShapeFn(ResourceScatterUpdateShape);
 
+REGISTER_OP("TieredEmbeddingVarHandleOp")
+    .Attr("container: string = ''")
+    .Attr("shared_name: string = ''")
+    .Attr("dtype: type")
+    .Attr("shape: shape")
+    .Output("resource: resource")
+    .SetIsStateful()
+    .SetShapeFn([](InferenceContext* c) {
+      c->set_output(0, c->Scalar());
+      DataType t;
+      TF_RETURN_IF_ERROR(c->GetAttr("dtype", &t));
+      PartialTensorShape p;
+      TF_RETURN_IF_ERROR(c->GetAttr("shape", &p));
+      ShapeHandle s;
+      TF_RETURN_IF_ERROR(c->MakeShapeFromPartialTensorShape(p, &s));
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(s, 1, &s));
+      c->set_output_handle_shapes_and_types(0,
+                                            std::vector<ShapeAndType>{{s, t}});
+      return absl::OkStatus();
+    });
+
+REGISTER_OP("InitializeTieredEmbeddingVar")
+    .Input("resource: resource")
+    .Input("value: dtype")
+    .Attr("dtype: type")
+    .Attr("cache_capacity: int >= 1")
+    .Attr("backing_file: string = ''")
+    .SetShapeFn([](InferenceContext* c) {
+      std::vector<ShapeAndType> handle_shape_and_type;
+      TF_RETURN_IF_ERROR(shape_inference::ValidateVariableResourceHandle(
+          c, &handle_shape_and_type));
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(
+          c->Merge(handle_shape_and_type[0].shape, c->input(1), &unused));
+      return absl::OkStatus();
+    });
+
+REGISTER_OP("TieredEmbeddingGather")
+    .Input("resource: resource")
+    .Input("indices: Tindices")
+    .Output("output: dtype")
+    .Attr("dtype: type")
+    .Attr("Tindices: {int32, int64}")
+    .SetShapeFn([](InferenceContext* c) {
+      std::vector<ShapeAndType> handle_shape_and_type;
+      TF_RETURN_IF_ERROR(shape_inference::ValidateVariableResourceHandle(
+          c, &handle_shape_and_type));
+      ShapeHandle row_shape;
+      TF_RETURN_IF_ERROR(
+          c->Subshape(handle_shape_and_type[0].shape, 1, &row_shape));
+      ShapeHandle out;
+      TF_RETURN_IF_ERROR(c->Concatenate(c->input(1), row_shape, &out));
+      c->set_output(0, out);
+      return absl::OkStatus();
+    });
+
+REGISTER_OP("TieredEmbeddingScatterUpdate")
+    .Input("resource: resource")
+    .Input("indices: Tindices")
+    .Input("updates: dtype")
+    .Attr("dtype: type")
+    .Attr("Tindices: {int32, int64}")
+    .SetShapeFn(ResourceScatterUpdateShape);
+
+REGISTER_OP("TieredEmbeddingScatterAdd")
+    .Input("resource: resource")
+    .Input("indices: Tindices")
+    .Input("updates: dtype")
+    .Attr("dtype: numbertype")
+    .Attr("Tindices: {int32, int64}")
+    .SetShapeFn(ResourceScatterUpdateShape);
+
+REGISTER_OP("TieredEmbeddingPrefetch")
+    .Input("resource: resource")
+    .Input("indices: Tindices")
+    .Attr("Tindices: {int32, int64}")
+    .SetShapeFn(shape_inference::NoOutputs);
+
 REGISTER_OP("MutexV2")
     .Attr("container: string = ''")
     .Attr("shared_name: string = ''")
@@ -28,8 +28,11 @@ limitations under the License.
 
 namespace tensorflow {
 namespace thread {
-using tsl::thread::EigenEnvironment;  // NOLINT
-using tsl::thread::ThreadPool;        // NOLINT
+using tsl::thread::EigenEnvironment;           // NOLINT
+using tsl::thread::GetThreadPoolTaskListener;  // NOLINT
+using tsl::thread::SetThreadPoolTaskListener;  // NOLINT
+using tsl::thread::ThreadPool;                 // NOLINT
+using tsl::thread::ThreadPoolTaskListener;     // NOLINT
 
 }  // namespace thread
 }  // namespace tensorflow
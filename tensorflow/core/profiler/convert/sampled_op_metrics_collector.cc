@@ -0,0 +1,113 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/convert/sampled_op_metrics_collector.h"
+
+#include <memory>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/profiler/convert/op_metrics_db_combiner.h"
+#include "tensorflow/core/profiler/convert/xplane_to_op_metrics_db.h"
+#include "tensorflow/core/profiler/lib/profiler_session.h"
+#include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
+#include "tensorflow/core/profiler/utils/xplane_schema.h"
+#include "tensorflow/core/profiler/utils/xplane_utils.h"
+#include "tsl/profiler/protobuf/profiler_options.pb.h"
+#include "tsl/profiler/protobuf/xplane.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+
+SampledOpMetricsCollector::Step::Step(SampledOpMetricsCollector& collector)
+    : collector_(collector), session_(collector.MaybeStartSession()) {}
+
+SampledOpMetricsCollector::Step::~Step() {
+  if (session_ != nullptr) collector_.FinishSession(std::move(session_));
+}
+
+SampledOpMetricsCollector::SampledOpMetricsCollector(Options options)
+    : options_(std::move(options)),
+      combiner_(std::make_unique<OpMetricsDbCombiner>(&op_metrics_db_)),
+      last_export_time_(absl::Now()) {}
+
+SampledOpMetricsCollector::~SampledOpMetricsCollector() { Flush(); }
+
+std::unique_ptr<tsl::ProfilerSession>
+SampledOpMetricsCollector::MaybeStartSession() {
+  if (options_.sample_every_n_steps <= 0) return nullptr;
+  if (num_steps_.fetch_add(1, std::memory_order_relaxed) %
+          options_.sample_every_n_steps !=
+      0) {
+    return nullptr;
+  }
+
+  tensorflow::ProfileOptions profile_options =
+      tsl::ProfilerSession::DefaultOptions();
+  profile_options.set_host_tracer_level(options_.host_tracer_level);
+  profile_options.set_device_tracer_level(0);
+  profile_options.set_python_tracer_level(0);
+  profile_options.set_include_dataset_ops(false);
+  profile_options.set_enable_hlo_proto(false);
+  std::unique_ptr<tsl::ProfilerSession> session =
+      tsl::ProfilerSession::Create(profile_options);
+  // Creating the session fails if another session is active. The step is
+  // then just not sampled.
+  if (session == nullptr || !session->Status().ok()) return nullptr;
+  return session;
+}
+
+void SampledOpMetricsCollector::FinishSession(
+    std::unique_ptr<tsl::ProfilerSession> session) {
+  XSpace space;
+  absl::Status status = session->CollectData(&space);
+  session.reset();
+  if (!status.ok()) {
+    VLOG(1) << "Failed to collect a sampled step: " << status;
+    return;
+  }
+  const XPlane* host_plane = FindPlaneWithName(space, kHostThreadsPlaneName);
+  if (host_plane == nullptr) return;
+  OpMetricsDb step_db = ConvertHostThreadsXPlaneToOpMetricsDb(*host_plane);
+
+  bool export_now = false;
+  {
+    absl::MutexLock lock(&mu_);
+    combiner_->Combine(step_db);
+    ++num_sampled_steps_;
+    export_now = absl::Now() - last_export_time_ >= options_.export_interval;
+  }
+  if (export_now) Flush();
+}
+
+void SampledOpMetricsCollector::Flush() {
+  OpMetricsDb db;
+  {
+    absl::MutexLock lock(&mu_);
+    last_export_time_ = absl::Now();
+    if (num_sampled_steps_ == 0) return;
+    db = std::move(op_metrics_db_);
+    op_metrics_db_.Clear();
+    combiner_ = std::make_unique<OpMetricsDbCombiner>(&op_metrics_db_);
+    num_sampled_steps_ = 0;
+  }
+  if (options_.exporter) options_.exporter(db);
+}
+
+}  // namespace profiler
+}  // namespace tensorflow
@@ -0,0 +1,115 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PROFILER_CONVERT_SAMPLED_OP_METRICS_COLLECTOR_H_
+#define TENSORFLOW_CORE_PROFILER_CONVERT_SAMPLED_OP_METRICS_COLLECTOR_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "tensorflow/core/profiler/convert/op_metrics_db_combiner.h"
+#include "tensorflow/core/profiler/lib/profiler_session.h"
+#include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+
+// Continuously collects op-level host metrics of a long running process, such
+// as a model server, at a bounded cost.
+//
+// Only one in `sample_every_n_steps` steps is profiled, with a host-only
+// profiler session covering that step. TraceMe events are not recorded outside
+// of the sampled steps, so the other steps only pay for an atomic increment.
+// The op metrics of the sampled steps are aggregated in process and handed to
+// `exporter` every `export_interval`.
+//
+// The profiler is exclusive within a process: steps are not sampled while
+// another profiler session, e.g. an on-demand capture, is active.
+//
+// Usage:
+//   SampledOpMetricsCollector collector(options);
+//   ...
+//   // For every step or request:
+//   SampledOpMetricsCollector::Step step(collector);
+//   RunStep();
+class SampledOpMetricsCollector {
+ public:
+  struct Options {
+    // Profiles one in this many steps. Zero disables sampling.
+    int64_t sample_every_n_steps = 1000;
+    // How often the aggregated metrics are exported.
+    absl::Duration export_interval = absl::Minutes(1);
+    // TraceMe level recorded in sampled steps. 2 includes TF ops.
+    int host_tracer_level = 2;
+    // Receives the op metrics aggregated since the previous export. Called on
+    // the thread finishing a sampled step.
+    std::function<void(const OpMetricsDb&)> exporter;
+  };
+
+  // Profiles the enclosing scope if it is a sampled step.
+  class Step {
+   public:
+    explicit Step(SampledOpMetricsCollector& collector);
+    ~Step();
+
+    Step(const Step&) = delete;
+    Step& operator=(const Step&) = delete;
+
+    // Whether this step is being profiled.
+    bool sampled() const { return session_ != nullptr; }
+
+   private:
+    SampledOpMetricsCollector& collector_;
+    std::unique_ptr<tsl::ProfilerSession> session_;
+  };
+
+  explicit SampledOpMetricsCollector(Options options);
+
+  // Exports the metrics that were not exported yet.
+  ~SampledOpMetricsCollector();
+
+  SampledOpMetricsCollector(const SampledOpMetricsCollector&) = delete;
+  SampledOpMetricsCollector& operator=(const SampledOpMetricsCollector&) =
+      delete;
+
+  // Exports the metrics aggregated since the previous export, if any.
+  void Flush();
+
+ private:
+  // Starts a profiler session if the next step is sampled.
+  std::unique_ptr<tsl::ProfilerSession> MaybeStartSession();
+
+  // Collects the trace of a sampled step, and aggregates its op metrics.
+  void FinishSession(std::unique_ptr<tsl::ProfilerSession> session);
+
+  const Options options_;
+  std::atomic<int64_t> num_steps_{0};
+
+  absl::Mutex mu_;
+  OpMetricsDb op_metrics_db_ ABSL_GUARDED_BY(mu_);
+  std::unique_ptr<OpMetricsDbCombiner> combiner_ ABSL_GUARDED_BY(mu_);
+  int64_t num_sampled_steps_ ABSL_GUARDED_BY(mu_) = 0;
+  absl::Time last_export_time_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace profiler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PROFILER_CONVERT_SAMPLED_OP_METRICS_COLLECTOR_H_
@@ -0,0 +1,94 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/convert/sampled_op_metrics_collector.h"
+
+#include <memory>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/profiler/lib/profiler_session.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+const OpMetrics* FindOpMetrics(const OpMetricsDb& db, absl::string_view name) {
+  for (const OpMetrics& metrics : db.metrics_db()) {
+    if (metrics.name() == name) return &metrics;
+  }
+  return nullptr;
+}
+
+TEST(SampledOpMetricsCollectorTest, AggregatesSampledSteps) {
+  std::vector<OpMetricsDb> exported;
+  SampledOpMetricsCollector::Options options;
+  options.sample_every_n_steps = 2;
+  options.export_interval = absl::InfiniteDuration();
+  options.exporter = [&](const OpMetricsDb& db) { exported.push_back(db); };
+  SampledOpMetricsCollector collector(options);
+
+  for (int i = 0; i < 4; ++i) {
+    SampledOpMetricsCollector::Step step(collector);
+    EXPECT_EQ(step.sampled(), i % 2 == 0);
+    TraceMe trace_me("my_matmul:MatMul");
+  }
+  EXPECT_TRUE(exported.empty());
+
+  collector.Flush();
+  ASSERT_EQ(exported.size(), 1);
+  const OpMetrics* matmul = FindOpMetrics(exported[0], "my_matmul");
+  ASSERT_NE(matmul, nullptr);
+  EXPECT_EQ(matmul->category(), "MatMul");
+  EXPECT_EQ(matmul->occurrences(), 2);
+
+  // Nothing was sampled since the last export.
+  collector.Flush();
+  EXPECT_EQ(exported.size(), 1);
+}
+
+TEST(SampledOpMetricsCollectorTest, ExportsEveryInterval) {
+  int num_exports = 0;
+  SampledOpMetricsCollector::Options options;
+  options.sample_every_n_steps = 1;
+  options.export_interval = absl::ZeroDuration();
+  options.exporter = [&](const OpMetricsDb& db) { ++num_exports; };
+  SampledOpMetricsCollector collector(options);
+
+  for (int i = 0; i < 3; ++i) {
+    SampledOpMetricsCollector::Step step(collector);
+    TraceMe trace_me("my_add:AddV2");
+  }
+  EXPECT_EQ(num_exports, 3);
+}
+
+TEST(SampledOpMetricsCollectorTest, SkipsStepsWhileProfilerIsActive) {
+  SampledOpMetricsCollector::Options options;
+  options.sample_every_n_steps = 1;
+  SampledOpMetricsCollector collector(options);
+
+  std::unique_ptr<tsl::ProfilerSession> session =
+      tsl::ProfilerSession::Create(tsl::ProfilerSession::DefaultOptions());
+  ASSERT_TRUE(session->Status().ok());
+  SampledOpMetricsCollector::Step step(collector);
+  EXPECT_FALSE(step.sampled());
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tensorflow
@@ -14,15 +14,74 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner_cache.h"
 
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/base/casts.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/platform/hash.h"
 
 namespace tensorflow {
 namespace tfrt_stub {
+namespace {
+
+// Returns whether `op_name` is a registered op without state, whose kernels
+// can be shared by different nodes.
+bool IsStatelessOp(absl::string_view op_name) {
+  const OpDef* op_def = nullptr;
+  if (!OpRegistry::Global()->LookUpOpDef(std::string(op_name), &op_def).ok()) {
+    return false;
+  }
+  return !op_def->is_stateful();
+}
+
+std::function<Status(tensorflow::AttrValueMap*)> SpecAttrBuilder(
+    const OpKernelRunnerSpec& spec) {
+  return [&spec](tensorflow::AttrValueMap* attr_value_map) {
+    attr_value_map->insert(spec.attrs.begin(), spec.attrs.end());
+    return OkStatus();
+  };
+}
+
+}  // namespace
+
+bool operator==(const OpKernelRunnerSpec& x, const OpKernelRunnerSpec& y) {
+  if (x.op_name != y.op_name || x.device_name != y.device_name ||
+      x.num_args != y.num_args || x.attrs.size() != y.attrs.size()) {
+    return false;
+  }
+  for (const auto& [name, value] : x.attrs) {
+    auto it = y.attrs.find(name);
+    // False negatives only cost a separate runner, so the cheap comparison of
+    // large tensors is good enough.
+    if (it == y.attrs.end() ||
+        !AreAttrValuesEqual(value, it->second,
+                            /*allow_false_negatives=*/true)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint64_t OpKernelRunnerSpec::HashAttrs(const tensorflow::AttrValueMap& attrs) {
+  // The iteration order of the map is unspecified, so the per attribute hashes
+  // are combined with an order independent sum.
+  uint64_t hash = 0;
+  for (const auto& [name, value] : attrs) {
+    hash += Hash64Combine(Hash64(name), FastAttrValueHash(value));
+  }
+  return hash;
+}
+
+OpKernelRunnerCache::~OpKernelRunnerCache() {
+  OpKernelRunnerCacheRegistry::Global().Unregister(this);
+}
 
 StatusOr<OpKernelRunner*> OpKernelRunnerCache::GetOrCreate(
     tfrt::Location loc, absl::string_view op_name,
@@ -37,7 +96,7 @@ StatusOr<OpKernelRunner*> OpKernelRunnerCache::GetOrCreate(
     auto it = map_.find(key);
     if (it != map_.end()) {
       DCHECK_EQ(it->second->op_kernel()->def().op(), op_name);
-      return it->second.get();
+      return it->second;
     }
   }
 
@@ -46,7 +105,21 @@ StatusOr<OpKernelRunner*> OpKernelRunnerCache::GetOrCreate(
   auto it = map_.find(key);
   if (it != map_.end()) {
     DCHECK_EQ(it->second->op_kernel()->def().op(), op_name);
-    return it->second.get();
+    return it->second;
+  }
+
+  const bool is_stateless = IsStatelessOp(op_name);
+  OpKernelRunnerSpec spec;
+  if (is_stateless) {
+    spec.op_name = std::string(op_name);
+    spec.device_name = std::string(device_name);
+    spec.num_args = num_args;
+    TF_RETURN_IF_ERROR(attr_builder(&spec.attrs));
+    auto shared_it = shared_runners_.find(spec);
+    if (shared_it != shared_runners_.end()) {
+      map_.emplace(key, shared_it->second);
+      return shared_it->second;
+    }
   }
 
   VLOG(1) << "KernelFallbackExecuteCompat creating op " << op_name
@@ -56,18 +129,98 @@ StatusOr<OpKernelRunner*> OpKernelRunnerCache::GetOrCreate(
       op_name, "_", loc.data, "_", absl::bit_cast<uintptr_t>(loc.GetHandler()));
 
   TF_ASSIGN_OR_RETURN(
-      auto runner, OpKernelRunner::Create(
-                       op_name, node_name, device_name, num_args, attr_builder,
-                       device_manager, process_function_library_runtime));
+      auto runner,
+      OpKernelRunner::Create(
+          op_name, node_name, device_name, num_args,
+          is_stateless ? SpecAttrBuilder(spec) : attr_builder, device_manager,
+          process_function_library_runtime));
 
   auto runner_uptr = std::make_unique<OpKernelRunner>(std::move(runner));
 
   auto* runner_ptr = runner_uptr.get();
-  auto r = map_.emplace(key, std::move(runner_uptr)).second;
+  runners_.push_back(std::move(runner_uptr));
+  auto r = map_.emplace(key, runner_ptr).second;
   DCHECK(r);
+  if (is_stateless) shared_runners_.emplace(std::move(spec), runner_ptr);
 
   return runner_ptr;
 }
 
+std::vector<OpKernelRunnerSpec> OpKernelRunnerCache::GetSpecs() const {
+  tf_shared_lock lock(mu_);
+  std::vector<OpKernelRunnerSpec> specs;
+  specs.reserve(shared_runners_.size());
+  for (const auto& [spec, runner] : shared_runners_) specs.push_back(spec);
+  return specs;
+}
+
+void OpKernelRunnerCache::Prewarm(
+    absl::Span<const OpKernelRunnerSpec> specs,
+    const tensorflow::DeviceMgr& device_manager,
+    const tensorflow::ProcessFunctionLibraryRuntime&
+        process_function_library_runtime) {
+  int num_created = 0;
+  for (const auto& spec : specs) {
+    {
+      tf_shared_lock lock(mu_);
+      if (shared_runners_.contains(spec)) continue;
+    }
+
+    // Kernels are constructed outside the lock, so that requests that are
+    // already served by this cache are not blocked by the prewarming.
+    auto runner = OpKernelRunner::Create(
+        spec.op_name, absl::StrCat(spec.op_name, "_prewarmed_", num_created),
+        spec.device_name, spec.num_args, SpecAttrBuilder(spec), device_manager,
+        process_function_library_runtime);
+    if (!runner.ok()) {
+      VLOG(1) << "Failed to prewarm op " << spec.op_name << " on device "
+              << spec.device_name << ": " << runner.status();
+      continue;
+    }
+
+    mutex_lock lock(mu_);
+    if (shared_runners_.contains(spec)) continue;
+    runners_.push_back(std::make_unique<OpKernelRunner>(*std::move(runner)));
+    shared_runners_.emplace(spec, runners_.back().get());
+    ++num_created;
+  }
+  VLOG(1) << "Prewarmed OpKernelRunnerCache with " << num_created << " of "
+          << specs.size() << " ops";
+}
+
+OpKernelRunnerCacheRegistry& OpKernelRunnerCacheRegistry::Global() {
+  static auto* const registry = new OpKernelRunnerCacheRegistry();
+  return *registry;
+}
+
+void OpKernelRunnerCacheRegistry::PrewarmAndRegister(
+    absl::string_view model_name, OpKernelRunnerCache* cache,
+    const tensorflow::DeviceMgr& device_manager,
+    const tensorflow::ProcessFunctionLibraryRuntime&
+        process_function_library_runtime) {
+  DCHECK(cache);
+  std::vector<OpKernelRunnerSpec> specs;
+  {
+    mutex_lock lock(mu_);
+    auto it = caches_.find(model_name);
+    // The previous cache cannot be destroyed while `mu_` is held, as its
+    // destructor unregisters it.
+    if (it != caches_.end() && it->second != cache) {
+      specs = it->second->GetSpecs();
+    }
+  }
+
+  cache->Prewarm(specs, device_manager, process_function_library_runtime);
+
+  mutex_lock lock(mu_);
+  caches_[model_name] = cache;
+}
+
+void OpKernelRunnerCacheRegistry::Unregister(const OpKernelRunnerCache* cache) {
+  mutex_lock lock(mu_);
+  absl::erase_if(caches_,
+                 [cache](const auto& entry) { return entry.second == cache; });
+}
+
 }  // namespace tfrt_stub
 }  // namespace tensorflow
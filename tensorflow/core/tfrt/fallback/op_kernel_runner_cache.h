@@ -15,10 +15,20 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_FALLBACK_OP_KERNEL_RUNNER_CACHE_H_
 #define TENSORFLOW_CORE_TFRT_FALLBACK_OP_KERNEL_RUNNER_CACHE_H_
 
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/process_function_library_runtime.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner.h"
 #include "tfrt/host_context/location.h"  // from @tf_runtime
 
@@ -46,10 +56,39 @@ class OpLocationKey {
   tfrt::Location loc_;
 };
 
+// The content of an op created by OpKernelRunnerCache. Unlike OpLocationKey,
+// it does not depend on where the op is in a program, so it identifies the
+// same op across programs and across versions of a model.
+struct OpKernelRunnerSpec {
+  std::string op_name;
+  std::string device_name;
+  int num_args = 0;
+  // The attributes as given by the attr builder, without the defaults.
+  tensorflow::AttrValueMap attrs;
+
+  template <typename H>
+  friend H AbslHashValue(H h, const OpKernelRunnerSpec& spec) {
+    return H::combine(std::move(h), spec.op_name, spec.device_name,
+                      spec.num_args, HashAttrs(spec.attrs));
+  }
+
+  friend bool operator==(const OpKernelRunnerSpec& x,
+                         const OpKernelRunnerSpec& y);
+
+ private:
+  static uint64_t HashAttrs(const tensorflow::AttrValueMap& attrs);
+};
+
 // OpKernelRunnerCache is similar to OpKernelRunnerTable but thread-safe.
+//
+// Runners of stateless ops are also indexed by their OpKernelRunnerSpec, so
+// the same op at different locations, e.g. in different client graphs, is
+// only created once. That index can be prewarmed with the ops of another
+// cache, see OpKernelRunnerCacheRegistry.
 class OpKernelRunnerCache {
  public:
   OpKernelRunnerCache() = default;
+  ~OpKernelRunnerCache();
 
   StatusOr<OpKernelRunner*> GetOrCreate(
       tfrt::Location loc, absl::string_view op_name,
@@ -59,9 +98,47 @@ class OpKernelRunnerCache {
       const tensorflow::ProcessFunctionLibraryRuntime&
           process_function_library_runtime);
 
+  // Returns the specs of the stateless ops in this cache.
+  std::vector<OpKernelRunnerSpec> GetSpecs() const;
+
+  // Creates the runners for `specs` that are not in this cache yet, so that
+  // the first GetOrCreate() of these ops does not construct kernels. Ops that
+  // fail to be created are skipped; GetOrCreate() reports their errors.
+  void Prewarm(absl::Span<const OpKernelRunnerSpec> specs,
+               const tensorflow::DeviceMgr& device_manager,
+               const tensorflow::ProcessFunctionLibraryRuntime&
+                   process_function_library_runtime);
+
  private:
   mutable mutex mu_;
-  absl::flat_hash_map<OpLocationKey, std::unique_ptr<OpKernelRunner>> map_
+  absl::flat_hash_map<OpLocationKey, OpKernelRunner*> map_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<OpKernelRunnerSpec, OpKernelRunner*> shared_runners_
+      TF_GUARDED_BY(mu_);
+  std::vector<std::unique_ptr<OpKernelRunner>> runners_ TF_GUARDED_BY(mu_);
+};
+
+// Keeps track of the OpKernelRunnerCache of the most recently loaded version
+// of each model, so that the cache of a new version can be prewarmed while
+// the previous version is still serving.
+class OpKernelRunnerCacheRegistry {
+ public:
+  static OpKernelRunnerCacheRegistry& Global();
+
+  // Prewarms `cache` with the stateless ops of the cache registered for
+  // `model_name`, if any, and registers `cache` for `model_name` in its
+  // place. `cache` is unregistered when it is destroyed.
+  void PrewarmAndRegister(absl::string_view model_name,
+                          OpKernelRunnerCache* cache,
+                          const tensorflow::DeviceMgr& device_manager,
+                          const tensorflow::ProcessFunctionLibraryRuntime&
+                              process_function_library_runtime);
+
+  // Unregisters `cache` if it is registered.
+  void Unregister(const OpKernelRunnerCache* cache);
+
+ private:
+  mutex mu_;
+  absl::flat_hash_map<std::string, OpKernelRunnerCache*> caches_
       TF_GUARDED_BY(mu_);
 };
 
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -126,6 +127,74 @@ TEST(OpKernelRunnerTest, OpKernelRunnerCache) {
   EXPECT_EQ(runner->op_kernel()->name(), "TestOp_100_0");
 }
 
+TEST(OpKernelRunnerTest, OpKernelRunnerCacheSharesStatelessOps) {
+  tensorflow::SessionOptions session_options;
+  tensorflow::FunctionDefLibrary fdef_lib;
+  TF_ASSERT_OK_AND_ASSIGN(auto fallback_state,
+                          FallbackState::Create(session_options, fdef_lib));
+
+  OpKernelRunnerCache cache;
+  auto get_or_create = [&](int64_t loc_data) {
+    return cache.GetOrCreate(
+        tfrt::Location(/*handler=*/nullptr, loc_data),
+        /*op_name=*/"TestOp",
+        /*device_name=*/"/job:localhost/replica:0/task:0/device:CPU:0",
+        /*num_args=*/1,
+        /*attr_builder=*/
+        [](tensorflow::AttrValueMap*) { return absl::OkStatus(); },
+        fallback_state->device_manager(),
+        fallback_state->process_function_library_runtime());
+  };
+
+  TF_ASSERT_OK_AND_ASSIGN(auto* runner, get_or_create(100));
+  TF_ASSERT_OK_AND_ASSIGN(auto* other_runner, get_or_create(200));
+
+  EXPECT_EQ(runner, other_runner);
+  EXPECT_EQ(other_runner->op_kernel()->name(), "TestOp_100_0");
+  EXPECT_EQ(cache.GetSpecs().size(), 1);
+}
+
+TEST(OpKernelRunnerTest, OpKernelRunnerCachePrewarm) {
+  tensorflow::SessionOptions session_options;
+  tensorflow::FunctionDefLibrary fdef_lib;
+  TF_ASSERT_OK_AND_ASSIGN(auto previous_fallback_state,
+                          FallbackState::Create(session_options, fdef_lib));
+  TF_ASSERT_OK_AND_ASSIGN(auto fallback_state,
+                          FallbackState::Create(session_options, fdef_lib));
+
+  auto get_or_create = [](OpKernelRunnerCache& cache,
+                          const FallbackState& fallback_state) {
+    return cache.GetOrCreate(
+        tfrt::Location(/*handler=*/nullptr, /*data=*/100),
+        /*op_name=*/"TestOp",
+        /*device_name=*/"/job:localhost/replica:0/task:0/device:CPU:0",
+        /*num_args=*/1,
+        /*attr_builder=*/
+        [](tensorflow::AttrValueMap*) { return absl::OkStatus(); },
+        fallback_state.device_manager(),
+        fallback_state.process_function_library_runtime());
+  };
+
+  OpKernelRunnerCache previous_cache;
+  OpKernelRunnerCacheRegistry::Global().PrewarmAndRegister(
+      "test_model", &previous_cache, previous_fallback_state->device_manager(),
+      previous_fallback_state->process_function_library_runtime());
+  TF_ASSERT_OK(
+      get_or_create(previous_cache, *previous_fallback_state).status());
+
+  OpKernelRunnerCache cache;
+  OpKernelRunnerCacheRegistry::Global().PrewarmAndRegister(
+      "test_model", &cache, fallback_state->device_manager(),
+      fallback_state->process_function_library_runtime());
+  ASSERT_EQ(cache.GetSpecs().size(), 1);
+
+  // The runner is the prewarmed one, created on the devices of the new cache.
+  TF_ASSERT_OK_AND_ASSIGN(auto* runner,
+                          get_or_create(cache, *fallback_state));
+  EXPECT_EQ(runner->op_kernel()->name(), "TestOp_prewarmed_0");
+  EXPECT_EQ(runner->device(), fallback_state->device_manager().HostCPU());
+}
+
 TEST(OpKernelRunnerTest, OpKernelRunState) {
   SessionOptions options;
   auto* device_count = options.config.mutable_device_count();
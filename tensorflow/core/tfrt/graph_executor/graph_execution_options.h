@@ -100,6 +100,18 @@ struct GraphExecutionOptions {
 
   CostAnalysisOptions cost_analysis_options;
 
+  // If positive, GraphExecutor keeps a running average of the latency of each
+  // client graph, and runs the graphs whose average is below this threshold
+  // inline (see `GraphExecutionRunOptions::run_inline`). For cheap graphs,
+  // the hop to the work queue is a large part of the latency.
+  absl::Duration inline_execution_threshold = absl::ZeroDuration();
+
+  // If true and `model_metadata` has a name, the cache of the kernels that
+  // are created on first use is prewarmed at load time with the stateless ops
+  // of the previously loaded version of the same model, so that the first
+  // requests after a version rollout do not pay for kernel construction.
+  bool prewarm_op_kernel_runner_cache = false;
+
   // If true, the MLRT interpreter will be used instead of the BEF executor.
   // This option is experimental.
   bool enable_mlrt = false;
@@ -134,6 +146,11 @@ struct GraphExecutionRunOptions {
   // specified graph is not compiled, the execution will return an error.
   bool disable_compilation = false;
 
+  // If true, the execution starts on the calling thread, which waits for it
+  // anyway, instead of being handed over to the work queue. Asynchronous work
+  // is still scheduled on the work queue.
+  bool run_inline = false;
+
   std::function<void(absl::flat_hash_map<std::string, tensorflow::Tensor>)>
       streamed_output_callback;
 };
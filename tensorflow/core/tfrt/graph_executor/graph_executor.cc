@@ -71,11 +71,13 @@ limitations under the License.
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/public/version.h"
 #include "tensorflow/core/runtime_fallback/kernel/kernel_fallback_compat_request_state.h"
+#include "tensorflow/core/runtime_fallback/kernel/kernel_fallback_execute_compat.h"
 #include "tensorflow/core/runtime_fallback/kernel/kernel_fallback_utils.h"
 #include "tensorflow/core/tfrt/common/metrics.h"
 #include "tensorflow/core/tfrt/fallback/cost_recorder.h"
 #include "tensorflow/core/tfrt/fallback/fallback_state.h"
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner.h"
+#include "tensorflow/core/tfrt/fallback/op_kernel_runner_cache.h"
 #include "tensorflow/core/tfrt/graph_executor/executable_context.h"
 #include "tensorflow/core/tfrt/graph_executor/export_mlir.h"
 #include "tensorflow/core/tfrt/graph_executor/graph_execution_options.h"
@@ -128,6 +130,10 @@ constexpr char kArgumentTypeJoiningDelimiter[] = "^";
 constexpr char kFallbackInitFunction[] = "_tfrt_fallback_init";
 constexpr char kResourceInitFunction[] = "_tfrt_resource_init";
 
+// The number of runs the running average latency of a client graph mostly
+// reflects.
+constexpr int64_t kLatencyAverageWindow = 8;
+
 StepId GetNextStepId() {
   static StepIdGenerator gen;
   return gen.GetNextStepId();
@@ -148,7 +154,7 @@ tensorflow::Status RunMlrtFunction(
     tfrt::ConcurrentWorkQueue& work_queue,
     absl::Span<const tensorflow::Tensor> inputs,
     std::vector<tensorflow::Tensor>* outputs,
-    SyncResourceState* sync_resource_state) {
+    SyncResourceState* sync_resource_state, bool run_inline) {
   DCHECK(function);
   const auto* fallback_request_state =
       request_context->GetDataIfExists<tfd::KernelFallbackCompatRequestState>();
@@ -193,8 +199,12 @@ tensorflow::Status RunMlrtFunction(
 
   // TODO(chky): Set up cancellation.
 
-  work_queue.AddTask(
-      [&execution_context]() { mlrt::Execute(execution_context); });
+  if (run_inline) {
+    mlrt::Execute(execution_context);
+  } else {
+    work_queue.AddTask(
+        [&execution_context]() { mlrt::Execute(execution_context); });
+  }
 
   work_queue.Await(chain);
 
@@ -386,7 +396,8 @@ tensorflow::Status GraphExecutionRunOnFunction(
     return RunMlrtFunction(function, *loaded_executable,
                            request_info->tfrt_request_context,
                            *request_info->request_queue, inputs, outputs,
-                           /*sync_resource_state=*/nullptr);
+                           /*sync_resource_state=*/nullptr,
+                           run_options.run_inline);
   }
 
   DCHECK(func);
@@ -422,15 +433,19 @@ tensorflow::Status GraphExecutionRunOnFunction(
   llvm::SmallVector<tfrt::RCReference<tfrt::AsyncValue>, 4> chain_and_results;
   chain_and_results.resize(func->result_types().size());
 
-  // Hand over the execution to thread pool.
-  std::array<tfrt::RCReference<tfrt::AsyncValue>, 1> executed = {
-      EnqueueWork(exec_ctx, [&]() -> tfrt::Chain {
-        func->Execute(exec_ctx, arguments, chain_and_results);
-        return {};
-      })};
-
-  // Wait for the function execution before checking chain and results.
-  exec_ctx.work_queue().Await(executed);
+  if (run_options.run_inline) {
+    func->Execute(exec_ctx, arguments, chain_and_results);
+  } else {
+    // Hand over the execution to thread pool.
+    std::array<tfrt::RCReference<tfrt::AsyncValue>, 1> executed = {
+        EnqueueWork(exec_ctx, [&]() -> tfrt::Chain {
+          func->Execute(exec_ctx, arguments, chain_and_results);
+          return {};
+        })};
+
+    // Wait for the function execution before checking chain and results.
+    exec_ctx.work_queue().Await(executed);
+  }
 
   // Wait for all results including the side-effect chain. This ensures that all
   // side-effects are visible when SavedModel::Run() returns.
@@ -517,6 +532,16 @@ absl::StatusOr<std::unique_ptr<GraphExecutor>> GraphExecutor::Create(
       auto graph_execution_state,
       TfrtGraphExecutionState::Create(graph_execution_state_options,
                                       std::move(graph_def), *fallback_state));
+  if (options.prewarm_op_kernel_runner_cache &&
+      !options.model_metadata.name().empty()) {
+    auto* runner_cache =
+        resource_context->GetOrCreateResource<OpKernelRunnerCache>(
+            tfd::kOpKernelRunnerCacheResourceName);
+    OpKernelRunnerCacheRegistry::Global().PrewarmAndRegister(
+        options.model_metadata.name(), runner_cache,
+        fallback_state->device_manager(),
+        fallback_state->process_function_library_runtime());
+  }
   return std::make_unique<GraphExecutor>(
       std::move(options), std::move(fallback_state),
       std::move(resource_context), std::move(graph_execution_state),
@@ -631,9 +656,19 @@ tensorflow::Status GraphExecutor::Run(
   CostRecorder* cost_recorder =
       loaded_client_graph.MaybeGetCostRecorder(now, &do_recompilation);
 
+  // Run cheap graphs inline, see `Options::inline_execution_threshold`.
+  std::optional<RunOptions> inline_run_options;
+  if (options_.inline_execution_threshold > absl::ZeroDuration() &&
+      !run_options.run_inline &&
+      loaded_client_graph.IsFasterThan(options_.inline_execution_threshold)) {
+    inline_run_options = run_options;
+    inline_run_options->run_inline = true;
+  }
+
   std::vector<tensorflow::Tensor> flat_outputs;
   TF_RETURN_IF_ERROR(GraphExecutionRunOnFunction(
-      options_, run_options, loaded_client_graph.name(),
+      options_, inline_run_options ? *inline_run_options : run_options,
+      loaded_client_graph.name(),
       loaded_client_graph.symbol_uids(), func, loaded_executable, flat_inputs,
       &flat_outputs, resource_context_.get(),
       &executable_context->resource_context,
@@ -664,6 +699,7 @@ tensorflow::Status GraphExecutor::Run(
   absl::Duration elapsed_duration = end - now;
   loaded_client_graph.latency_sampler()->Add(
       absl::ToDoubleMicroseconds(elapsed_duration));
+  loaded_client_graph.RecordLatency(elapsed_duration);
   return OkStatus();
 }
 
@@ -1148,6 +1184,20 @@ GraphExecutor::LoadedClientGraph::LoadedClientGraph(
   }
 }
 
+void GraphExecutor::LoadedClientGraph::RecordLatency(absl::Duration latency) {
+  const int64_t latency_ns = absl::ToInt64Nanoseconds(latency);
+  const int64_t average_latency_ns =
+      average_latency_ns_.load(std::memory_order_relaxed);
+  // Concurrent updates may overwrite each other, which is fine for an
+  // estimate.
+  average_latency_ns_.store(
+      average_latency_ns < 0
+          ? latency_ns
+          : average_latency_ns +
+                (latency_ns - average_latency_ns) / kLatencyAverageWindow,
+      std::memory_order_relaxed);
+}
+
 void GraphExecutor::LoadedClientGraph::UpdateCostAnalysisData(
     absl::Time now, bool do_recompilation) {
   tensorflow::mutex_lock lock(cost_analysis_data_.mu);
@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_GRAPH_EXECUTOR_GRAPH_EXECUTOR_H_
 #define TENSORFLOW_CORE_TFRT_GRAPH_EXECUTOR_GRAPH_EXECUTOR_H_
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <optional>
@@ -140,7 +142,7 @@ tensorflow::Status RunMlrtFunction(
     tfrt::ConcurrentWorkQueue& work_queue,
     absl::Span<const tensorflow::Tensor> inputs,
     std::vector<tensorflow::Tensor>* outputs,
-    SyncResourceState* sync_resource_state);
+    SyncResourceState* sync_resource_state, bool run_inline = false);
 
 // Loads (if not yet) and runs a subgraph in a graph as per each request.
 class GraphExecutor {
@@ -197,6 +199,17 @@ class GraphExecutor {
     }
     tsl::monitoring::SamplerCell* latency_sampler() { return latency_sampler_; }
 
+    // Adds `latency` to the running average latency of this graph.
+    void RecordLatency(absl::Duration latency);
+    // Whether the running average latency of this graph is known and below
+    // `threshold`.
+    bool IsFasterThan(absl::Duration threshold) const {
+      const int64_t average_latency_ns =
+          average_latency_ns_.load(std::memory_order_relaxed);
+      return average_latency_ns >= 0 &&
+             average_latency_ns < absl::ToInt64Nanoseconds(threshold);
+    }
+
    private:
     std::string name_;
     SymbolUids symbol_uids_;
@@ -235,6 +248,8 @@ class GraphExecutor {
     FunctionLibraryDefinition flib_def_;
     ProcessFunctionLibraryRuntime pflr_;
     tsl::monitoring::SamplerCell* latency_sampler_;
+    // Exponential moving average of the latency, or -1 before the first run.
+    std::atomic<int64_t> average_latency_ns_{-1};
   };
 
   // A subgraph constructed by specifying input/output tensors.
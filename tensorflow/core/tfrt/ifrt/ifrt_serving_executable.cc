@@ -15,9 +15,11 @@ limitations under the License.
 
 #include "tensorflow/core/tfrt/ifrt/ifrt_serving_executable.h"
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -29,7 +31,9 @@ limitations under the License.
 #include "absl/strings/str_cat.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
+#include "mlir/IR/BuiltinOps.h"  // from @llvm-project
 #include "mlir/IR/OwningOpRef.h"  // from @llvm-project
+#include "tensorflow/compiler/mlir/tensorflow/utils/serialize_mlir_module_utils.h"
 #include "tensorflow/compiler/mlir/tfrt/transforms/ifrt/tf2hlo.h"
 #include "tensorflow/compiler/tf2xla/xla_helpers.h"
 #include "xla/hlo/ir/hlo_sharding.h"
@@ -56,6 +60,7 @@ limitations under the License.
 #include "tensorflow/core/tfrt/ifrt/sharding_utils.h"
 #include "tsl/concurrency/ref_count.h"
 #include "tsl/platform/errors.h"
+#include "tsl/platform/fingerprint.h"
 #include "tsl/platform/statusor.h"
 #include "tsl/platform/tstring.h"
 
@@ -143,6 +148,36 @@ absl::StatusOr<std::vector<xla::ifrt::Device*>> GetAssignedDevices(
 
 }  // namespace
 
+std::shared_ptr<IfrtServingExecutable::SharedExecutableBundles>
+IfrtServingExecutable::GetSharedExecutableBundles(
+    mlir::ModuleOp module, absl::string_view signature_name,
+    const xla::ifrt::Client* client) {
+  using ProgramKey =
+      std::tuple<uint64_t, std::string, const xla::ifrt::Client*>;
+  static absl::Mutex mu(absl::kConstInit);
+  static auto* const programs =
+      new absl::flat_hash_map<ProgramKey,
+                              std::weak_ptr<SharedExecutableBundles>>();
+
+  ProgramKey program_key(tsl::Fingerprint64(SerializeMlirModule(module)),
+                         std::string(signature_name), client);
+
+  absl::MutexLock lock(&mu);
+  // Drop the programs that no executable uses anymore.
+  absl::erase_if(*programs,
+                 [](const auto& entry) { return entry.second.expired(); });
+
+  auto& weak_bundles = (*programs)[program_key];
+  if (auto bundles = weak_bundles.lock()) {
+    VLOG(1) << "Sharing the executables of signature " << signature_name
+            << " with a previously loaded identical program";
+    return bundles;
+  }
+  auto bundles = std::make_shared<SharedExecutableBundles>();
+  weak_bundles = bundles;
+  return bundles;
+}
+
 absl::StatusOr<tsl::RCReference<xla::ifrt::Array>>
 IfrtServingExecutable::ConvertTensorToArray(
     const tensorflow::Tensor& tensor, const xla::ifrt::DeviceList& device_list,
@@ -222,10 +257,11 @@ IfrtServingExecutable::LookUpOrCreateExecutable(
   xla::ifrt::Future<absl::StatusOr<CachedExecutableBundle>> future;
 
   {
-    absl::MutexLock lock(&mutex_);
+    absl::MutexLock lock(&executable_bundles_->mutex);
 
-    const auto it = executable_bundles_.find(key);
-    if (it != executable_bundles_.end()) {
+    auto& bundles = executable_bundles_->bundles;
+    const auto it = bundles.find(key);
+    if (it != bundles.end()) {
       return it->second;
     }
 
@@ -234,7 +270,7 @@ IfrtServingExecutable::LookUpOrCreateExecutable(
         absl::StatusOr<CachedExecutableBundle>>::CreatePromise();
     future = xla::ifrt::Future<absl::StatusOr<CachedExecutableBundle>>(promise);
 
-    executable_bundles_.emplace(key, future);
+    bundles.emplace(key, future);
   }
 
   LOG(INFO) << "Cache missed. Building executable";
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_IFRT_IFRT_SERVING_EXECUTABLE_H_
 #define TENSORFLOW_CORE_TFRT_IFRT_IFRT_SERVING_EXECUTABLE_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <utility>
@@ -64,7 +65,9 @@ class IfrtServingExecutable {
         ifrt_client_(std::move(client)),
         thread_pool_(*thread_pool),
         ifrt_loaded_variable_registry_(*ifrt_loaded_variable_registry),
-        shape_representation_fn_(std::move(shape_representation_fn)) {}
+        shape_representation_fn_(std::move(shape_representation_fn)),
+        executable_bundles_(GetSharedExecutableBundles(
+            *module_, signature_name_, ifrt_client_.get())) {}
 
   // Movable but not copyable.
   IfrtServingExecutable(IfrtServingExecutable&& other) = default;
@@ -81,9 +84,11 @@ class IfrtServingExecutable {
       absl::Span<const tensorflow::Tensor> inputs,
       absl::Span<const int> variable_arg_indices);
 
+  // Returns the number of executables compiled for this program, including
+  // those compiled by other IfrtServingExecutables of the same program.
   int num_executables() const {
-    absl::MutexLock lock(&mutex_);
-    return executable_bundles_.size();
+    absl::MutexLock lock(&executable_bundles_->mutex);
+    return executable_bundles_->bundles.size();
   }
 
  private:
@@ -110,6 +115,26 @@ class IfrtServingExecutable {
     tensorflow::tpu::TPUCompileMetadataProto compile_metadata;
   };
 
+  // The executables compiled for a program, shared by all the
+  // IfrtServingExecutables of the same program, signature and client in the
+  // process, e.g. those of several versions or instances of a model, so that
+  // identical programs are compiled once. Executables of the same client are
+  // expected to use the same shape representation function.
+  struct SharedExecutableBundles {
+    absl::Mutex mutex;
+    // A pending compilation is a future that is not ready yet, which the
+    // concurrent requests for the same shapes wait for.
+    absl::flat_hash_map<
+        Key, xla::ifrt::Future<absl::StatusOr<CachedExecutableBundle>>>
+        bundles ABSL_GUARDED_BY(mutex);
+  };
+
+  // Returns the bundles of the program `module`, which are alive for as long
+  // as an IfrtServingExecutable of the program is.
+  static std::shared_ptr<SharedExecutableBundles> GetSharedExecutableBundles(
+      mlir::ModuleOp module, absl::string_view signature_name,
+      const xla::ifrt::Client* client);
+
   std::string model_name_;
   std::string signature_name_;
 
@@ -122,10 +147,7 @@ class IfrtServingExecutable {
   const IfrtLoadedVariableRegistry& ifrt_loaded_variable_registry_;
   tensorflow::XlaHelpers::ShapeRepresentationFn shape_representation_fn_;
 
-  mutable absl::Mutex mutex_;
-  absl::flat_hash_map<Key,
-                      xla::ifrt::Future<absl::StatusOr<CachedExecutableBundle>>>
-      executable_bundles_ ABSL_GUARDED_BY(mutex_);
+  std::shared_ptr<SharedExecutableBundles> executable_bundles_;
 
   absl::StatusOr<tsl::RCReference<xla::ifrt::Array>> ConvertTensorToArray(
       const tensorflow::Tensor& tensor,
@@ -176,6 +176,59 @@ TEST(IfrtServingExecutableTest, MultipleShapes) {
   EXPECT_THAT(outputs2, ElementsAre(TensorEq(expected_out2)));
 }
 
+TEST(IfrtServingExecutableTest, SharesExecutablesOfIdenticalPrograms) {
+  // Create test input module
+  constexpr absl::string_view kDataDirectory =
+      "tensorflow/core/tfrt/ifrt/testdata";
+  std::string mlir_module_path = tensorflow::GetDataDependencyFilepath(
+      absl::StrCat(kDataDirectory, "/executable.mlir"));
+
+  mlir::DialectRegistry registry;
+  mlir::registerAllDialects(registry);
+  mlir::RegisterAllTensorFlowDialects(registry);
+
+  mlir::MLIRContext context(registry);
+
+  // Create contexts required for the compiler execution.
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<xla::ifrt::Client> client,
+                          xla::ifrt::test_util::GetClient());
+
+  mlir::OwningOpRef<mlir::ModuleOp> mlir_module =
+      mlir::parseSourceFile<mlir::ModuleOp>(mlir_module_path, &context);
+  mlir::OwningOpRef<mlir::ModuleOp> other_mlir_module =
+      mlir::parseSourceFile<mlir::ModuleOp>(mlir_module_path, &context);
+
+  ASSERT_TRUE(mlir_module);
+  ASSERT_TRUE(other_mlir_module);
+
+  IfrtLoadedVariableRegistry ifrt_loaded_variable_registry;
+  auto create_executable = [&](mlir::OwningOpRef<mlir::ModuleOp> module) {
+    return std::make_unique<IfrtServingExecutable>(
+        "test", "main", std::move(module), client, &GetThreadPool(),
+        &ifrt_loaded_variable_registry,
+        tensorflow::IdentityShapeRepresentationFn());
+  };
+  auto executable = create_executable(std::move(mlir_module));
+  auto other_executable = create_executable(std::move(other_mlir_module));
+
+  auto x = AsTensor<int32_t>({1, 2, 3}, tensorflow::TensorShape({1, 3}));
+  auto y = AsTensor<int32_t>({1, 2, 3}, tensorflow::TensorShape({3, 1}));
+  std::vector<tensorflow::Tensor> inputs{x, y};
+
+  TF_ASSERT_OK_AND_ASSIGN(auto result,
+                          executable->Execute(absl::MakeSpan(inputs), {}));
+  EXPECT_EQ(other_executable->num_executables(), 1);
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto other_result, other_executable->Execute(absl::MakeSpan(inputs), {}));
+  EXPECT_EQ(executable->num_executables(), 1);
+
+  const auto expected_out =
+      AsTensor<int32_t>({14}, tensorflow::TensorShape({1, 1}));
+  EXPECT_THAT(result, ElementsAre(TensorEq(expected_out)));
+  EXPECT_THAT(other_result, ElementsAre(TensorEq(expected_out)));
+}
+
 TEST(IfrtServingExecutableTest, Spmd) {
   // Create test input module
   constexpr absl::string_view kDataDirectory =
@@ -14,6 +14,11 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/tfrt/mlrt/interpreter/context.h"
 
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/tfrt/mlrt/bytecode/executable.h"
@@ -35,8 +40,17 @@ KernelImplementation KernelRegistry::Get(absl::string_view name) const {
   return map_.at(name);
 }
 
+void KernelRegistry::RegisterSuperinstruction(absl::string_view first,
+                                              absl::string_view second,
+                                              KernelImplementation kernel) {
+  superinstructions_.emplace(
+      std::make_pair(std::string(first), std::string(second)), kernel);
+}
+
 void KernelRegistry::Merge(const KernelRegistry& other) {
   map_.insert(other.map_.begin(), other.map_.end());
+  superinstructions_.insert(other.superinstructions_.begin(),
+                            other.superinstructions_.end());
 }
 
 LoadedExecutable::LoadedExecutable(bc::Executable executable,
@@ -47,9 +61,45 @@ LoadedExecutable::LoadedExecutable(bc::Executable executable,
     kernels_.push_back(kernel_registry.Get(kernel_name));
   }
 
+  // The superinstructions that apply to this executable, keyed by the codes
+  // of the kernels they fuse.
+  absl::flat_hash_map<std::pair<uint32_t, uint32_t>, KernelImplementation>
+      superinstructions;
+  if (!kernel_registry.superinstructions().empty()) {
+    absl::flat_hash_map<absl::string_view, uint32_t> codes;
+    auto kernel_names = executable_.kernel_names();
+    for (uint32_t code = 0; code < kernel_names.size(); ++code) {
+      codes[kernel_names[code].Get()] = code;
+    }
+    for (const auto& [names, kernel] : kernel_registry.superinstructions()) {
+      auto first = codes.find(names.first);
+      auto second = codes.find(names.second);
+      if (first != codes.end() && second != codes.end()) {
+        superinstructions[{first->second, second->second}] = kernel;
+      }
+    }
+  }
+
   functions_.reserve(executable_.functions().size());
+  function_kernels_.reserve(executable_.functions().size());
   for (auto function : executable_.functions()) {
     functions_[function.name().Get()] = function;
+
+    auto kernel_objects = function.kernels();
+    auto& kernels = function_kernels_[kernel_objects.data()];
+    kernels.reserve(kernel_objects.size());
+    for (size_t i = 0; i < kernel_objects.size(); ++i) {
+      const uint32_t code = kernel_objects[i].code();
+      kernels.push_back(kernels_[code]);
+      if (superinstructions.empty() || i + 1 == kernel_objects.size()) {
+        continue;
+      }
+      if (auto superinstruction =
+              superinstructions.find({code, kernel_objects[i + 1].code()});
+          superinstruction != superinstructions.end()) {
+        kernels.back() = superinstruction->second;
+      }
+    }
   }
 }
 
@@ -70,10 +70,34 @@ class KernelRegistry {
     Register<KernelClass>(KernelClass::kName);
   }
 
+  // Registers `kernel` as a superinstruction for the kernel `first` followed
+  // by the kernel `second`. Wherever the two appear in this order in a
+  // function, the interpreter dispatches `kernel` once, with the frame of
+  // `first`, instead of dispatching them one by one. `kernel` must invoke
+  // `first`, and then, if KernelFrame::AdvanceToNextKernel() returns true,
+  // `second`.
+  void RegisterSuperinstruction(absl::string_view first,
+                                absl::string_view second,
+                                KernelImplementation kernel);
+
+  // Registers a superinstruction that inlines `First` and `Second`.
+  template <typename First, typename Second>
+  void RegisterSuperinstruction();
+
+  // Keyed by the names of the kernels they fuse.
+  const absl::flat_hash_map<std::pair<std::string, std::string>,
+                            KernelImplementation>&
+  superinstructions() const {
+    return superinstructions_;
+  }
+
   void Merge(const KernelRegistry& other);
 
  private:
   absl::flat_hash_map<std::string, KernelImplementation> map_;
+  absl::flat_hash_map<std::pair<std::string, std::string>,
+                      KernelImplementation>
+      superinstructions_;
 };
 
 class LoadedExecutable {
@@ -83,6 +107,16 @@ class LoadedExecutable {
 
   absl::Span<const KernelImplementation> kernels() const { return kernels_; }
 
+  // Returns the implementations of the kernels of `function`, in program
+  // order, with superinstructions in place of the first kernel of each fused
+  // pair. `function` must belong to this executable.
+  absl::Span<const KernelImplementation> GetFunctionKernels(
+      bc::Function function) const {
+    auto iter = function_kernels_.find(function.kernels().data());
+    DCHECK(iter != function_kernels_.end());
+    return iter->second;
+  }
+
   bc::Function GetFunction(absl::string_view name) const {
     if (auto iter = functions_.find(name); iter != functions_.end()) {
       return iter->second;
@@ -98,6 +132,9 @@ class LoadedExecutable {
 
   absl::flat_hash_map<std::string, bc::Function> functions_;
   std::vector<KernelImplementation> kernels_;
+  // Keyed by the kernels of the function, which are unique to it.
+  absl::flat_hash_map<const char*, std::vector<KernelImplementation>>
+      function_kernels_;
 };
 
 // A helper structure that holds states for a kernel. Typical usuage is that a
@@ -118,13 +155,7 @@ void UnwindOnError(ExecutionContext& context, int64_t pc);
 
 class FunctionContext {
  public:
-  FunctionContext(bc::Function function, ExecutionContext* execution_context)
-      : pc_(0),
-        registers_(function.num_regs()),
-        function_object_(function),
-        execution_context_(execution_context) {
-    DCHECK(execution_context);
-  }
+  FunctionContext(bc::Function function, ExecutionContext* execution_context);
 
   FunctionContext(const FunctionContext&) = delete;
   FunctionContext& operator=(const FunctionContext&) = delete;
@@ -207,6 +238,7 @@ class FunctionContext {
   std::vector<Value> registers_;
   std::vector<Value*> results_;
   bc::Function function_object_;
+  absl::Span<const KernelImplementation> kernels_;
   KernelContext kernel_context_;
 
   ExecutionContext* execution_context_ = nullptr;
@@ -502,6 +534,17 @@ class ExecutionContext {
                                               int64_t pc);
 };
 
+inline FunctionContext::FunctionContext(bc::Function function,
+                                        ExecutionContext* execution_context)
+    : pc_(0),
+      registers_(function.num_regs()),
+      function_object_(function),
+      kernels_(execution_context->loaded_executable().GetFunctionKernels(
+          function)),
+      execution_context_(execution_context) {
+  DCHECK(execution_context);
+}
+
 class KernelFrame {
  public:
   struct State {
@@ -517,8 +560,13 @@ class KernelFrame {
                     .loaded_executable()
                     .executable()
                     .attributes(),
-                &function_context->execution_context()) {}
+                &function_context->execution_context()) {
+      kernels = function_context->function_object().kernels();
+    }
 
+    // The kernels of the current function, and the index of `kernel` in them.
+    bc::Vector<bc::Kernel> kernels;
+    int64_t pc = 0;
     bc::Kernel kernel;
     absl::Span<Value> regs;
     bc::Span<bc::String> attrs;
@@ -553,6 +601,18 @@ class KernelFrame {
 
   void set_kernel(bc::Kernel kernel) { this->kernel() = kernel; }
 
+  // For superinstructions: if the execution is still running after the first
+  // kernel of the pair, moves this frame to the second one and returns true.
+  bool AdvanceToNextKernel() {
+    if (execution_context().state() != ExecutionContext::State::kRunning) {
+      return false;
+    }
+    ++state_->pc;
+    DCHECK_LT(state_->pc, state_->kernels.size());
+    kernel() = state_->kernels[state_->pc];
+    return true;
+  }
+
  private:
   bc::Kernel& kernel() { return state_->kernel; }
   const bc::Kernel& kernel() const { return state_->kernel; }
@@ -571,6 +631,15 @@ inline void KernelRegistry::Register(absl::string_view name) {
       name, +[](KernelFrame frame) { KernelClass(frame).Invoke(); });
 }
 
+template <typename First, typename Second>
+inline void KernelRegistry::RegisterSuperinstruction() {
+  RegisterSuperinstruction(
+      First::kName, Second::kName, +[](KernelFrame frame) {
+        First(frame).Invoke();
+        if (frame.AdvanceToNextKernel()) Second(frame).Invoke();
+      });
+}
+
 }  // namespace mlrt
 
 #endif  // TENSORFLOW_CORE_TFRT_MLRT_INTERPRETER_CONTEXT_H_
@@ -86,27 +86,24 @@ void Execute(ExecutionContext& ctx) {
 
     int function_stack_index = context.function_stack_.size() - 1;
     FunctionContext* current_function = &context.function_stack_.back();
-    int64_t pc = current_function->pc_;
 
-    auto kernels = context.loaded_executable().kernels();
-
-    auto kernel_object_iter =
-        current_function->function_object().kernels().begin();
-    kernel_object_iter += pc;
+    // The kernel implementations are resolved per function when the
+    // executable is loaded, so that superinstructions can take the place of
+    // kernel pairs.
+    auto kernels = current_function->kernels_;
 
     KernelFrame::State kstate(current_function);
     KernelFrame frame(&kstate);
+    int64_t& pc = kstate.pc;
+    pc = current_function->pc_;
 
     // The main loop for executing kernels in program order. The kernels may set
     // the execution state to break this loop for context-switching or error
-    // handling.
+    // handling. Superinstructions advance `pc` past the kernels they fuse.
     for (; context.state_ == ExecutionContext::State::kRunning; ++pc) {
-      DCHECK(kernel_object_iter <
-             current_function->function_object().kernels().end());
-      bc::Kernel kernel_object = *kernel_object_iter;
-      frame.set_kernel(kernel_object);
-      kernels[kernel_object.code()](frame);
-      ++kernel_object_iter;
+      DCHECK_LT(pc, kernels.size());
+      frame.set_kernel(kstate.kernels[pc]);
+      kernels[pc](frame);
     }
 
     // Update the program counter if we need to break the sequential execution
@@ -202,6 +202,50 @@ TEST(InterpreterTest, SequentialAdd) {
   EXPECT_EQ(result.Get<int32_t>(), 100);
 }
 
+TEST(InterpreterTest, SequentialAddWithSuperinstruction) {
+  auto buffer = CreateSequentialAddExecutable(99);
+
+  bc::Executable executable(buffer.data());
+
+  static int num_fused_adds = 0;
+  num_fused_adds = 0;
+
+  KernelRegistry kernel_registry;
+  RegisterBuiltinKernels(kernel_registry);
+  kernel_registry.Register<AddI32Kernel>();
+  kernel_registry.RegisterSuperinstruction(
+      "add", "add", +[](KernelFrame frame) {
+        ++num_fused_adds;
+        AddI32Kernel(frame).Invoke();
+        if (frame.AdvanceToNextKernel()) AddI32Kernel(frame).Invoke();
+      });
+
+  LoadedExecutable loaded_executable(executable, kernel_registry);
+
+  absl::Notification notification;
+
+  ExecutionContext execution_context(&loaded_executable);
+  execution_context.set_exit_handler([&]() { notification.Notify(); });
+
+  int32_t v = 1;
+  mlrt::Value arg(v);
+  mlrt::Value result;
+
+  auto function = loaded_executable.GetFunction("main");
+  ASSERT_TRUE(function);
+
+  std::vector<uint8_t> last_uses = {true};
+  execution_context.Call(function, last_uses, absl::Span<Value>(&arg, 1),
+                         absl::Span<Value>(&result, 1));
+  Execute(execution_context);
+
+  notification.WaitForNotification();
+
+  EXPECT_EQ(result.Get<int32_t>(), 100);
+  // The first 98 adds run as 49 pairs, and the last one on its own.
+  EXPECT_EQ(num_fused_adds, 49);
+}
+
 TEST(InterpreterTest, SequentialAddAttributes) {
   auto buffer = CreateSequentialAddAttributesExecutable(99);
 
@@ -1030,6 +1030,9 @@ void RegisterTfMlrtKernels(mlrt::KernelRegistry& registry) {
   registry.Register<CreateOp>("tfrt_fallback_sync.createop");
   registry.Register<ExecuteOp>();
   registry.Register<ExecuteOp>("tfrt_fallback_sync.executeop");
+  // Consecutive fallback ops are the most common kernel sequence in serving
+  // programs.
+  registry.RegisterSuperinstruction<ExecuteOp, ExecuteOp>();
   registry.Register<AsyncExecuteOp>();
   registry.Register<AsyncWhileOp>();
   registry.Register<ExecuteOpDevice>();
@@ -20,6 +20,7 @@ limitations under the License.
 #include <memory>
 #include <optional>
 #include <string>
+#include <tuple>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -407,10 +408,139 @@ std::string GetNameFromDevice(const std::string& device) {
   return ret;
 }
 
+// Builds a scalar int32 Const node with `value` on `device`.
+absl::StatusOr<Node*> BuildInt32Const(const std::string& name, int32_t value,
+                                      const std::string& device,
+                                      Graph* graph) {
+  Tensor tensor(DT_INT32, TensorShape({}));
+  tensor.scalar<int32_t>()() = value;
+  return NodeBuilder(name, "Const")
+      .AssignedDevice(device)
+      .Attr("dtype", DT_INT32)
+      .Attr("value", tensor)
+      .Finalize(graph);
+}
+
+// Returns true if the tensors of `dtype` can be coalesced into a TensorList
+// for transfer.
+bool IsCoalescableType(DataType dtype) {
+  return !IsRefType(dtype) && dtype != DT_RESOURCE && dtype != DT_VARIANT;
+}
+
+// For each pair of devices and each data type, coalesces the tensors that
+// flow from one device to the other into a single TensorList, if there are at
+// least `min_num_tensors` of them. The list is filled on the source device and
+// unpacked on the destination device, so that graph partitioning inserts one
+// send/recv pair for it instead of one pair per tensor.
+Status CoalesceCrossDeviceTransfers(int min_num_tensors, Graph* graph) {
+  // A tensor that is consumed on another device, and its consumers there.
+  struct Transfer {
+    const Node* src = nullptr;
+    int src_output = -1;
+    std::vector<const Edge*> edges;
+  };
+  // Keyed by source device, destination device and data type. std::map keeps
+  // the node names deterministic.
+  using TransferKey = std::tuple<std::string, std::string, DataType>;
+  std::map<TransferKey, std::vector<Transfer>> transfers;
+  std::map<TransferKey, absl::flat_hash_map<std::pair<const Node*, int>, int>>
+      transfer_index;
+
+  for (const Edge* edge : graph->edges()) {
+    if (edge->IsControlEdge()) continue;
+    const Node* src = edge->src();
+    const Node* dst = edge->dst();
+    if (!src->IsOp() || !dst->IsOp()) continue;
+    if (src->assigned_device_name() == dst->assigned_device_name()) continue;
+    const DataType dtype = src->output_type(edge->src_output());
+    if (!IsCoalescableType(dtype)) continue;
+    // Transfers that are already explicit in the graph are left alone.
+    if (src->IsSend() || dst->IsRecv()) continue;
+
+    TransferKey key(src->assigned_device_name(), dst->assigned_device_name(),
+                    dtype);
+    auto [it, inserted] = transfer_index[key].insert(
+        {{src, edge->src_output()}, static_cast<int>(transfers[key].size())});
+    if (inserted) {
+      transfers[key].push_back({src, edge->src_output(), {}});
+    }
+    transfers[key][it->second].edges.push_back(edge);
+  }
+
+  int group_id = 0;
+  for (const auto& [key, group] : transfers) {
+    const int num_tensors = group.size();
+    if (num_tensors < std::max(min_num_tensors, 2)) continue;
+    const auto& [src_device, dst_device, dtype] = key;
+    const std::string prefix =
+        absl::StrCat("coalesced_transfer/", group_id++, "/");
+
+    // Fill the list on the source device.
+    TF_ASSIGN_OR_RETURN(
+        Node * src_element_shape,
+        BuildInt32Const(absl::StrCat(prefix, "src_element_shape"), -1,
+                        src_device, graph));
+    TF_ASSIGN_OR_RETURN(
+        Node * num_elements,
+        BuildInt32Const(absl::StrCat(prefix, "num_elements"), num_tensors,
+                        src_device, graph));
+    TF_ASSIGN_OR_RETURN(Node * list,
+                        NodeBuilder(absl::StrCat(prefix, "reserve"),
+                                    "TensorListReserve")
+                            .AssignedDevice(src_device)
+                            .Input(src_element_shape)
+                            .Input(num_elements)
+                            .Attr("element_dtype", dtype)
+                            .Attr("shape_type", DT_INT32)
+                            .Finalize(graph));
+    for (int i = 0; i < num_tensors; ++i) {
+      TF_ASSIGN_OR_RETURN(
+          Node * index, BuildInt32Const(absl::StrCat(prefix, "src_index/", i),
+                                        i, src_device, graph));
+      TF_ASSIGN_OR_RETURN(
+          list, NodeBuilder(absl::StrCat(prefix, "set_item/", i),
+                            "TensorListSetItem")
+                    .AssignedDevice(src_device)
+                    .Input(list)
+                    .Input(index)
+                    .Input(const_cast<Node*>(group[i].src), group[i].src_output)
+                    .Attr("element_dtype", dtype)
+                    .Finalize(graph));
+    }
+
+    // Unpack the list on the destination device, and redirect the consumers
+    // of each tensor to its unpacked copy.
+    TF_ASSIGN_OR_RETURN(
+        Node * dst_element_shape,
+        BuildInt32Const(absl::StrCat(prefix, "dst_element_shape"), -1,
+                        dst_device, graph));
+    for (int i = 0; i < num_tensors; ++i) {
+      TF_ASSIGN_OR_RETURN(
+          Node * index, BuildInt32Const(absl::StrCat(prefix, "dst_index/", i),
+                                        i, dst_device, graph));
+      TF_ASSIGN_OR_RETURN(Node * item,
+                          NodeBuilder(absl::StrCat(prefix, "get_item/", i),
+                                      "TensorListGetItem")
+                              .AssignedDevice(dst_device)
+                              .Input(list)
+                              .Input(index)
+                              .Input(dst_element_shape)
+                              .Attr("element_dtype", dtype)
+                              .Finalize(graph));
+      for (const Edge* edge : group[i].edges) {
+        TF_RETURN_IF_ERROR(
+            graph->UpdateEdge(item, 0, edge->dst(), edge->dst_input()));
+      }
+    }
+  }
+  return OkStatus();
+}
+
 }  // namespace
 
 // This function performs the following steps:
-// 1. Partition the graph and insert send/recv ops on the edges across devices.
+// 1. Partition the graph and insert send/recv ops on the edges across devices,
+//    optionally after coalescing the tensors crossing each pair of devices.
 // 2. For each partition, convert the subgraph to a function and invoke the
 //    function by a PartitionedCallOp, so that these functions can be executed
 //    asynchronousely.
@@ -424,13 +554,18 @@ absl::StatusOr<std::unique_ptr<Graph>> InsertTransferOps(
     const Device* host_device, const std::vector<std::string>& inputs,
     const std::vector<std::string>& outputs,
     const std::vector<std::string>& control_outputs,
-    std::unique_ptr<Graph> graph) {
+    std::unique_ptr<Graph> graph, int min_num_coalesced_transfers) {
   // Skip transfer op insertion if the graph nodes are not assigned to multiple
   // devices.
   if (!HasMultipleDevices(graph.get())) {
     return graph;
   }
 
+  if (min_num_coalesced_transfers > 0) {
+    TF_RETURN_IF_ERROR(
+        CoalesceCrossDeviceTransfers(min_num_coalesced_transfers, graph.get()));
+  }
+
   // Step 1: Partition the graph and insert send/recv ops on the edges across
   // devices.
   auto new_graph = std::make_unique<Graph>(graph->flib_def());
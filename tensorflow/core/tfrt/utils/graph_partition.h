@@ -54,12 +54,18 @@ namespace tfrt_stub {
 //                                    /
 //              PartitionedCall_2 ----
 //
+// If `min_num_coalesced_transfers` is positive, the tensors of the same data
+// type that flow from one device to another are packed into a single
+// TensorList on the source device and unpacked on the destination device,
+// whenever there are at least `min_num_coalesced_transfers` (and at least two)
+// of them. This replaces many small transfers between two devices with one
+// transfer per data type per step.
 absl::StatusOr<std::unique_ptr<Graph>> InsertTransferOps(
     const std::string& graph_func_name, const DeviceSet& device_set,
     const Device* host_device, const std::vector<std::string>& inputs,
     const std::vector<std::string>& outputs,
     const std::vector<std::string>& control_outputs,
-    std::unique_ptr<Graph> graph);
+    std::unique_ptr<Graph> graph, int min_num_coalesced_transfers = 0);
 
 }  // namespace tfrt_stub
 }  // namespace tensorflow
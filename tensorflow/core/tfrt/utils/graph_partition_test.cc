@@ -214,6 +214,60 @@ TEST_F(GraphPartitionTest, InsertTransferOpsWithTwoDevice) {
   }
 }
 
+TEST_F(GraphPartitionTest, InsertTransferOpsCoalescesTransfers) {
+  // Three tensors flow from device0 to device1 and back. With coalescing,
+  // each direction uses a single TensorList transfer.
+  auto graph = std::make_unique<Graph>(OpRegistry::Global());
+  Scope scope = Scope::NewRootScope();
+  Scope scope0 = scope.WithDevice(device0_->name());
+  Scope scope1 = scope.WithDevice(device1_->name());
+
+  auto input = ops::Placeholder(scope0.WithOpName("input"), DT_FLOAT);
+  Output x = ops::Identity(scope0.WithOpName("x"), input);
+  Output y = ops::Neg(scope0.WithOpName("y"), input);
+  Output z = ops::Square(scope0.WithOpName("z"), input);
+  auto on_device1 = ops::IdentityN(scope1.WithOpName("on_device1"), {x, y, z});
+  auto output = ops::IdentityN(scope0.WithOpName("output"), on_device1.output);
+  TF_ASSERT_OK(scope.ToGraph(graph.get()));
+
+  FunctionLibraryDefinition flib_def(OpRegistry::Global());
+  Placer placer(graph.get(), "", &flib_def, &device_set_, device0_);
+  TF_ASSERT_OK(placer.Run());
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Graph> new_graph,
+      InsertTransferOps(/*graph_func_name=*/"test_graph", device_set_, device0_,
+                        /*inputs=*/{"input"},
+                        /*outputs=*/{"output"}, /*control_outputs=*/{},
+                        std::move(graph), /*min_num_coalesced_transfers=*/2));
+
+  GraphDef new_graphdef;
+  new_graph->ToGraphDef(&new_graphdef);
+
+  int num_partitions = 0;
+  for (const FunctionDef& fdef : new_graphdef.library().function()) {
+    if (!fdef.attr().contains("device")) continue;
+    ++num_partitions;
+    int send_count = 0, recv_count = 0, set_item_count = 0, get_item_count = 0;
+    for (const NodeDef& node : fdef.node_def()) {
+      if (node.op() == "_Send") {
+        ++send_count;
+      } else if (node.op() == "_Recv") {
+        ++recv_count;
+      } else if (node.op() == "TensorListSetItem") {
+        ++set_item_count;
+      } else if (node.op() == "TensorListGetItem") {
+        ++get_item_count;
+      }
+    }
+    EXPECT_EQ(send_count, 1);
+    EXPECT_EQ(recv_count, 1);
+    EXPECT_EQ(set_item_count, 3);
+    EXPECT_EQ(get_item_count, 3);
+  }
+  EXPECT_EQ(num_partitions, 2);
+}
+
 }  // anonymous namespace
 }  // namespace tfrt_stub
 }  // namespace tensorflow
@@ -15,6 +15,8 @@ limitations under the License.
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <functional>
 #include <optional>
 #include <utility>
@@ -117,6 +119,80 @@ constexpr uint8 kVarintTag(uint32 tag) { return (tag << 3) | 0; }
 constexpr uint8 kDelimitedTag(uint32 tag) { return (tag << 3) | 2; }
 constexpr uint8 kFixed32Tag(uint32 tag) { return (tag << 3) | 5; }
 
+// The continuation bits of eight bytes of varints loaded as a uint64.
+constexpr uint64_t kVarintContinuationBits = 0x8080808080808080ULL;
+
+// Returns the number of varints in the `size` bytes of a packed field, which
+// is the number of bytes without a continuation bit. Counts eight bytes at a
+// time by summing their inverted continuation bits with a multiplication.
+inline size_t CountPackedVarints(const uint8* data, size_t size) {
+  size_t count = 0;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, data + i, sizeof(word));
+    const uint64_t ends = (~word & kVarintContinuationBits) >> 7;
+    count += (ends * 0x0101010101010101ULL) >> 56;
+  }
+  for (; i < size; ++i) {
+    count += (data[i] & 0x80) == 0;
+  }
+  return count;
+}
+
+// Decodes the varints in the `size` bytes of a packed field into `out`,
+// dropping the values past the first `max_out`. Runs of eight single-byte
+// varints, which are common for ids and small counts, are decoded without
+// looking at the bytes one by one. Returns false if the field is malformed.
+template <typename T>
+inline bool DecodePackedVarints(const uint8* data, size_t size, T* out,
+                                size_t max_out) {
+  const uint8* const end = data + size;
+  size_t index = 0;
+  while (data != end) {
+    if (static_cast<size_t>(end - data) >= sizeof(uint64_t) &&
+        index + 8 <= max_out) {
+      uint64_t word;
+      std::memcpy(&word, data, sizeof(word));
+      if ((word & kVarintContinuationBits) == 0) {
+        for (int i = 0; i < 8; ++i) {
+          out[index + i] = static_cast<T>(data[i]);
+        }
+        data += sizeof(uint64_t);
+        index += 8;
+        continue;
+      }
+    }
+    uint64_t value = 0;
+    uint8 byte;
+    // A varint has at most 10 bytes, the last of which holds the top bit.
+    int shift = 0;
+    do {
+      if (data == end || shift > 63) return false;
+      byte = *data++;
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      shift += 7;
+    } while (byte & 0x80);
+    if (index < max_out) out[index] = static_cast<T>(value);
+    ++index;
+  }
+  return true;
+}
+
+// Reads the `size` > 0 bytes of a packed field from `stream`, setting `data`
+// to the bytes in the buffer of `stream`.
+inline bool ReadPackedField(protobuf::io::CodedInputStream* stream,
+                            uint32 size, const uint8** data) {
+  const void* ptr;
+  int available;
+  if (!stream->GetDirectBufferPointer(&ptr, &available) ||
+      available < static_cast<int64_t>(size)) {
+    return false;
+  }
+  *data = static_cast<const uint8*>(ptr);
+  return stream->Skip(size);
+}
+
 namespace parsed {
 
 // ParseDataType has to be called first, then appropriate ParseZzzzList.
@@ -303,15 +379,21 @@ class Feature {
         if (!stream.ExpectTag(kDelimitedTag(1))) return false;  // packed tag
         uint32 packed_length;
         if (!stream.ReadVarint32(&packed_length)) return false;
-        auto packed_limit = stream.PushLimit(packed_length);
-
-        while (!stream.ExpectAtEnd()) {
-          protobuf_uint64 n;  // There is no API for int64
-          if (!stream.ReadVarint64(&n)) return false;
-          int64_list->push_back(static_cast<int64_t>(n));
+        if (packed_length > 0) {
+          const uint8* packed;
+          if (!ReadPackedField(&stream, packed_length, &packed)) return false;
+          // Resize the output once, and decode the values in place. As for
+          // floats, the resized "vector" can be shorter than requested for a
+          // LimitedArraySlice.
+          const size_t initial_size = int64_list->size();
+          int64_list->resize(initial_size +
+                             CountPackedVarints(packed, packed_length));
+          if (!DecodePackedVarints(packed, packed_length,
+                                   int64_list->data() + initial_size,
+                                   int64_list->size() - initial_size)) {
+            return false;
+          }
         }
-
-        stream.PopLimit(packed_limit);
       } else {  // non-packed
         while (!stream.ExpectAtEnd()) {
           if (!stream.ExpectTag(kVarintTag(1))) return false;
@@ -1924,18 +2006,29 @@ inline int ParseFloatFeature(protobuf::io::CodedInputStream* stream,
           !stream->ReadVarint32(&packed_length)) {
         return -1;
       }
-      auto packed_limit = stream->PushLimit(packed_length);
-      while (!stream->ExpectAtEnd()) {
-        uint32 buffer32;
-        if (!stream->ReadLittleEndian32(&buffer32)) {
+      if (packed_length % sizeof(float) != 0) {
+        return -1;
+      }
+      num_elements = packed_length / sizeof(float);
+      if (out != nullptr && port::kLittleEndian) {
+        // The values are stored as little endian floats, so they can be
+        // copied as is.
+        if (!stream->ReadRaw(out, packed_length)) {
           return -1;
         }
-        if (out != nullptr) {
-          *out++ = absl::bit_cast<float>(buffer32);
+      } else {
+        auto packed_limit = stream->PushLimit(packed_length);
+        while (!stream->ExpectAtEnd()) {
+          uint32 buffer32;
+          if (!stream->ReadLittleEndian32(&buffer32)) {
+            return -1;
+          }
+          if (out != nullptr) {
+            *out++ = absl::bit_cast<float>(buffer32);
+          }
         }
-        num_elements++;
+        stream->PopLimit(packed_limit);
       }
-      stream->PopLimit(packed_limit);
     } else if (peek_tag == kFixed32Tag(1)) {
       while (!stream->ExpectAtEnd()) {
         uint32 buffer32;
@@ -1975,18 +2068,22 @@ inline int ParseInt64Feature(protobuf::io::CodedInputStream* stream,
           !stream->ReadVarint32(&packed_length)) {
         return -1;
       }
-      auto packed_limit = stream->PushLimit(packed_length);
-      while (!stream->ExpectAtEnd()) {
-        protobuf_uint64 n;  // There is no API for int64
-        if (!stream->ReadVarint64(&n)) {
+      if (packed_length > 0) {
+        const uint8* packed;
+        if (!ReadPackedField(stream, packed_length, &packed)) {
           return -1;
         }
-        if (out != nullptr) {
-          *out++ = n;
+        num_elements = CountPackedVarints(packed, packed_length);
+        if (out != nullptr &&
+            !DecodePackedVarints(packed, packed_length, out, num_elements)) {
+          return -1;
+        }
+        // Without an output the packed field is only counted, so check that
+        // it ends with a complete varint.
+        if (packed[packed_length - 1] & 0x80) {
+          return -1;
         }
-        num_elements++;
       }
-      stream->PopLimit(packed_limit);
     } else if (peek_tag == kVarintTag(1)) {
       while (!stream->ExpectAtEnd()) {
         protobuf_uint64 n;  // There is no API for int64
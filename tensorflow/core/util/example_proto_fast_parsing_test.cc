@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
+#include <limits>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -219,6 +220,36 @@ TEST(FastParse, SingleInt64) {
   TestCorrectness(Serialize(example));
 }
 
+TEST(FastParse, LargePackedInt64List) {
+  Example example;
+  Int64List* int64_list =
+      (*example.mutable_features()->mutable_feature())["ids"]
+          .mutable_int64_list();
+  // Mixes runs of single-byte varints with longer ones, and ends with a
+  // partial run of eight bytes.
+  for (int i = 0; i < 1003; ++i) {
+    if (i % 100 < 50) {
+      int64_list->add_value(i % 128);
+    } else if (i % 3 == 0) {
+      int64_list->add_value(-i);
+    } else {
+      int64_list->add_value(
+          static_cast<int64_t>(static_cast<uint64_t>(i) << (i % 57)));
+    }
+  }
+  int64_list->add_value(std::numeric_limits<int64_t>::max());
+  int64_list->add_value(std::numeric_limits<int64_t>::min());
+  TestCorrectness(Serialize(example));
+}
+
+TEST(FastParse, TruncatedPackedInt64List) {
+  Example example;
+  // The packed int64 list ends with a byte that has a continuation bit.
+  EXPECT_FALSE(TestFastParse(
+      "\x0a\x0e\x0a\x0c\x0a\x03\x61\x67\x65\x12\x05\x1a\x03\x0a\x01\x80",
+      &example));
+}
+
 static string ExampleWithSomeFeatures() {
   Example example;
 
@@ -0,0 +1,155 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/core/util/tensor_bundle/async_bundle_writer.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+
+AsyncBundleWriter::AsyncBundleWriter(Env* env, absl::string_view prefix,
+                                     Options options)
+    : env_(env), prefix_(prefix), options_(std::move(options)) {
+  const int num_shards = std::max(options_.num_shards, 1);
+  shards_.resize(num_shards);
+  for (int i = 0; i < num_shards; ++i) {
+    Shard& shard = shards_[i];
+    shard.prefix =
+        num_shards == 1 ? prefix_ : strings::StrCat(prefix_, "_async_", i);
+    shard.writer = std::make_unique<BundleWriter>(env_, shard.prefix,
+                                                  options_.writer_options);
+    shard.thread = std::make_unique<thread::ThreadPool>(
+        env_, "async_bundle_writer", /*num_threads=*/1);
+  }
+}
+
+AsyncBundleWriter::~AsyncBundleWriter() {
+  for (Shard& shard : shards_) shard.thread.reset();
+}
+
+AsyncBundleWriter::Shard* AsyncBundleWriter::PickShard(int64_t bytes) {
+  Shard* shard = &*std::min_element(
+      shards_.begin(), shards_.end(), [](const Shard& a, const Shard& b) {
+        return a.scheduled_bytes < b.scheduled_bytes;
+      });
+  shard->scheduled_bytes += bytes;
+  return shard;
+}
+
+Status AsyncBundleWriter::Add(absl::string_view key, const Tensor& val,
+                              int64_t version) {
+  if (finished_) {
+    return errors::FailedPrecondition("AsyncBundleWriter is finished");
+  }
+  std::string key_string(key);
+  if (version >= 0) {
+    if (!versions_.emplace(key_string, version).second) {
+      return errors::InvalidArgument("Adding duplicate key: ", key);
+    }
+    auto it = options_.base_versions.find(key_string);
+    if (!options_.base_prefix.empty() &&
+        it != options_.base_versions.end() && it->second == version) {
+      ++num_unchanged_tensors_;
+      Shard* shard = PickShard(val.TotalBytes());
+      shard->thread->Schedule([this, shard, key_string]() {
+        AddFromBase(shard, key_string);
+      });
+      return OkStatus();
+    }
+  }
+
+  Tensor snapshot = options_.snapshot_mode == SnapshotMode::kDeepCopy
+                        ? tensor::DeepCopy(val)
+                        : val;
+  Shard* shard = PickShard(val.TotalBytes());
+  shard->thread->Schedule(
+      [shard, key_string = std::move(key_string), snapshot]() {
+        if (!shard->status.ok()) return;
+        shard->status = shard->writer->Add(key_string, snapshot);
+      });
+  return OkStatus();
+}
+
+Status AsyncBundleWriter::AddSlice(absl::string_view full_tensor_key,
+                                   const TensorShape& full_tensor_shape,
+                                   const TensorSlice& slice_spec,
+                                   const Tensor& slice_tensor) {
+  if (finished_) {
+    return errors::FailedPrecondition("AsyncBundleWriter is finished");
+  }
+  Tensor snapshot = options_.snapshot_mode == SnapshotMode::kDeepCopy
+                        ? tensor::DeepCopy(slice_tensor)
+                        : slice_tensor;
+  // MergeBundles() merges the entries of a full tensor whose slices are
+  // spread across shards.
+  Shard* shard = PickShard(slice_tensor.TotalBytes());
+  shard->thread->Schedule([shard, key = std::string(full_tensor_key),
+                           full_tensor_shape, slice_spec, snapshot]() {
+    if (!shard->status.ok()) return;
+    shard->status =
+        shard->writer->AddSlice(key, full_tensor_shape, slice_spec, snapshot);
+  });
+  return OkStatus();
+}
+
+void AsyncBundleWriter::AddFromBase(Shard* shard, const std::string& key) {
+  if (!shard->status.ok()) return;
+  if (shard->base_reader == nullptr) {
+    shard->base_reader =
+        std::make_unique<BundleReader>(env_, options_.base_prefix);
+  }
+  shard->status = shard->base_reader->status();
+  if (!shard->status.ok()) return;
+  Tensor val;
+  shard->status = shard->base_reader->Lookup(key, &val);
+  if (!shard->status.ok()) return;
+  shard->status = shard->writer->Add(key, val);
+}
+
+Status AsyncBundleWriter::Finish() {
+  if (finished_) {
+    return errors::FailedPrecondition("AsyncBundleWriter is finished");
+  }
+  finished_ = true;
+  for (Shard& shard : shards_) {
+    Shard* shard_ptr = &shard;
+    // Finishes the writer even after an error, so that it deletes its files.
+    shard.thread->Schedule([shard_ptr]() {
+      shard_ptr->status.Update(shard_ptr->writer->Finish());
+    });
+  }
+  Status status;
+  for (Shard& shard : shards_) {
+    shard.thread.reset();  // Waits for the writes of the shard.
+    status.Update(shard.status);
+  }
+  if (!status.ok() || shards_.size() == 1) return status;
+
+  std::vector<tstring> prefixes;
+  for (const Shard& shard : shards_) prefixes.emplace_back(shard.prefix);
+  return MergeBundles(env_, prefixes, prefix_);
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,153 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#ifndef TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_ASYNC_BUNDLE_WRITER_H_
+#define TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_ASYNC_BUNDLE_WRITER_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_slice.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+
+// Writes a tensor bundle in the background, so that the caller, e.g. a
+// training loop, is only blocked while the added tensors are snapshotted.
+//
+// The tensors are spread across "num_shards" BundleWriters, each writing its
+// own data file on its own thread. Finish() merges them into a single bundle
+// at "prefix" with MergeBundles().
+//
+// In incremental mode, a tensor added with the same version it had in the
+// previous checkpoint is not snapshotted: its value is restored from the
+// previous checkpoint in the background instead. The bundle stays
+// self-contained, so it can be read, or become the base of the next
+// checkpoint, without the previous one.
+//
+//   AsyncBundleWriter::Options options;
+//   options.base_prefix = previous_prefix;
+//   options.base_versions = previous_writer_versions;
+//   AsyncBundleWriter writer(env, prefix, options);
+//   writer.Add("var", var_tensor, var_version);  // Returns quickly.
+//   ...  // Resumes training.
+//   TF_RETURN_IF_ERROR(writer.Finish());  // Waits for the writes.
+//
+// All threads accessing the same AsyncBundleWriter must synchronize.
+class AsyncBundleWriter {
+ public:
+  enum class SnapshotMode {
+    // Add() copies the tensor.
+    kDeepCopy,
+    // Add() only holds a reference to the buffer of the tensor. This is only
+    // safe if the tensor is not mutated in place while it is shared, e.g.
+    // for resource variables, which copy their buffer before updating it if
+    // it is shared (copy-on-write).
+    kShareBuffer,
+  };
+
+  struct Options {
+    Options() {}
+    BundleWriter::Options writer_options;
+    // The number of data files written in parallel.
+    int num_shards = 1;
+    SnapshotMode snapshot_mode = SnapshotMode::kDeepCopy;
+    // Enables the incremental mode: the prefix of the previous checkpoint,
+    // and the versions its tensors had, as returned by versions() of the
+    // AsyncBundleWriter that wrote it.
+    std::string base_prefix;
+    absl::flat_hash_map<std::string, int64_t> base_versions;
+  };
+
+  AsyncBundleWriter(Env* env, absl::string_view prefix,
+                    Options options = Options());
+
+  // Waits for the background writes. The bundle is only complete if Finish()
+  // returned OK.
+  ~AsyncBundleWriter();
+
+  // Snapshots the tensor "val" and schedules writing it under "key". In
+  // incremental mode, a non-negative "version" identifies the value of the
+  // tensor, e.g. the version of the variable it was read from.
+  //
+  // Errors of the background writes are returned by Finish().
+  Status Add(absl::string_view key, const Tensor& val, int64_t version = -1);
+
+  // Snapshots a slice of a partitioned tensor and schedules writing it, see
+  // BundleWriter::AddSlice().
+  Status AddSlice(absl::string_view full_tensor_key,
+                  const TensorShape& full_tensor_shape,
+                  const TensorSlice& slice_spec, const Tensor& slice_tensor);
+
+  // Waits for the background writes, then finishes the bundle. Can be called
+  // from another thread than the Add() calls, after all of them.
+  Status Finish() TF_MUST_USE_RESULT;
+
+  // The versions of the tensors added with a non-negative version, to be
+  // passed as Options::base_versions of the next checkpoint.
+  const absl::flat_hash_map<std::string, int64_t>& versions() const {
+    return versions_;
+  }
+
+  // The number of tensors restored from the previous checkpoint.
+  int64_t num_unchanged_tensors() const { return num_unchanged_tensors_; }
+
+ private:
+  struct Shard {
+    std::string prefix;
+    std::unique_ptr<BundleWriter> writer;
+    // Reads the previous checkpoint, opened on first use.
+    std::unique_ptr<BundleReader> base_reader;
+    // Runs the writes of the shard in order.
+    std::unique_ptr<thread::ThreadPool> thread;
+    // The bytes scheduled on the shard, to balance the shards.
+    int64_t scheduled_bytes = 0;
+    // Only accessed on the thread of the shard, or once it is joined.
+    Status status;
+  };
+
+  // Returns the shard with the fewest bytes scheduled, and adds "bytes" to
+  // them.
+  Shard* PickShard(int64_t bytes);
+
+  // Restores "key" from the previous checkpoint and adds it to the shard.
+  // Runs on the thread of the shard.
+  void AddFromBase(Shard* shard, const std::string& key);
+
+  Env* const env_;  // Not owned.
+  const std::string prefix_;
+  const Options options_;
+  std::vector<Shard> shards_;
+  absl::flat_hash_map<std::string, int64_t> versions_;
+  int64_t num_unchanged_tensors_ = 0;
+  bool finished_ = false;
+
+  AsyncBundleWriter(const AsyncBundleWriter&) = delete;
+  void operator=(const AsyncBundleWriter&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_ASYNC_BUNDLE_WRITER_H_
@@ -0,0 +1,120 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/core/util/tensor_bundle/async_bundle_writer.h"
+
+#include <string>
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+namespace {
+
+string Prefix(const string& prefix) {
+  return strings::StrCat(testing::TmpDir(), "/", prefix);
+}
+
+Tensor Constant_2x3(float v) {
+  Tensor ret(DT_FLOAT, TensorShape({2, 3}));
+  ret.flat<float>().setConstant(v);
+  return ret;
+}
+
+void Expect(BundleReader* reader, const string& key,
+            const Tensor& expected_val) {
+  Tensor val;
+  TF_ASSERT_OK(reader->Lookup(key, &val));
+  test::ExpectTensorEqual<float>(val, expected_val);
+}
+
+TEST(AsyncBundleWriterTest, WritesShardsInBackground) {
+  AsyncBundleWriter::Options options;
+  options.num_shards = 3;
+  AsyncBundleWriter writer(Env::Default(), Prefix("async"), options);
+  Tensor a = Constant_2x3(1);
+  TF_ASSERT_OK(writer.Add("a", a));
+  // The bundle holds the value of "a" when it was added.
+  a.flat<float>().setConstant(10);
+  TF_ASSERT_OK(writer.Add("b", Constant_2x3(2)));
+  TF_ASSERT_OK(writer.Add("c", Constant_2x3(3)));
+  TF_ASSERT_OK(writer.Add("strings", test::AsTensor<tstring>({"x", "yz"})));
+  TF_ASSERT_OK(writer.AddSlice("partitioned", TensorShape({4, 3}),
+                               TensorSlice::ParseOrDie("0,2:-"),
+                               Constant_2x3(4)));
+  TF_ASSERT_OK(writer.AddSlice("partitioned", TensorShape({4, 3}),
+                               TensorSlice::ParseOrDie("2,2:-"),
+                               Constant_2x3(5)));
+  TF_ASSERT_OK(writer.Finish());
+  EXPECT_FALSE(writer.Add("d", Constant_2x3(6)).ok());
+
+  BundleReader reader(Env::Default(), Prefix("async"));
+  TF_ASSERT_OK(reader.status());
+  Expect(&reader, "a", Constant_2x3(1));
+  Expect(&reader, "b", Constant_2x3(2));
+  Expect(&reader, "c", Constant_2x3(3));
+  Tensor strings;
+  TF_ASSERT_OK(reader.Lookup("strings", &strings));
+  test::ExpectTensorEqual<tstring>(strings,
+                                   test::AsTensor<tstring>({"x", "yz"}));
+  Tensor partitioned(DT_FLOAT, TensorShape({4, 3}));
+  TF_ASSERT_OK(reader.Lookup("partitioned", &partitioned));
+  test::ExpectTensorEqual<float>(
+      partitioned,
+      test::AsTensor<float>({4, 4, 4, 4, 4, 4, 5, 5, 5, 5, 5, 5}, {4, 3}));
+}
+
+TEST(AsyncBundleWriterTest, Incremental) {
+  AsyncBundleWriter base_writer(Env::Default(), Prefix("base"));
+  TF_ASSERT_OK(base_writer.Add("a", Constant_2x3(1), /*version=*/1));
+  TF_ASSERT_OK(base_writer.Add("b", Constant_2x3(2), /*version=*/1));
+  TF_ASSERT_OK(base_writer.Finish());
+
+  AsyncBundleWriter::Options options;
+  options.num_shards = 2;
+  options.base_prefix = Prefix("base");
+  options.base_versions = base_writer.versions();
+  AsyncBundleWriter writer(Env::Default(), Prefix("incremental"), options);
+  // "a" did not change, so the value passed here is not used.
+  TF_ASSERT_OK(writer.Add("a", Constant_2x3(10), /*version=*/1));
+  TF_ASSERT_OK(writer.Add("b", Constant_2x3(20), /*version=*/2));
+  TF_ASSERT_OK(writer.Add("c", Constant_2x3(30), /*version=*/1));
+  EXPECT_FALSE(writer.Add("c", Constant_2x3(30), /*version=*/2).ok());
+  TF_ASSERT_OK(writer.Finish());
+  EXPECT_EQ(writer.num_unchanged_tensors(), 1);
+  EXPECT_EQ(writer.versions().at("b"), 2);
+
+  BundleReader reader(Env::Default(), Prefix("incremental"));
+  TF_ASSERT_OK(reader.status());
+  Expect(&reader, "a", Constant_2x3(1));
+  Expect(&reader, "b", Constant_2x3(20));
+  Expect(&reader, "c", Constant_2x3(30));
+}
+
+TEST(AsyncBundleWriterTest, MissingBaseFails) {
+  AsyncBundleWriter::Options options;
+  options.base_prefix = Prefix("missing_base");
+  options.base_versions = {{"a", 1}};
+  AsyncBundleWriter writer(Env::Default(), Prefix("no_base"), options);
+  TF_ASSERT_OK(writer.Add("a", Constant_2x3(1), /*version=*/1));
+  EXPECT_TRUE(errors::IsNotFound(writer.Finish()));
+}
+
+}  // namespace
+}  // namespace tensorflow
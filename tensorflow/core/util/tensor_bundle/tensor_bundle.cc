@@ -15,13 +15,20 @@ limitations under the License.
 
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdlib>
 #include <cstring>
+#include <deque>
+#include <map>
 #include <memory>
+#include <set>
 #include <utility>
 
 #include "absl/base/call_once.h"
 #include "absl/synchronization/mutex.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -45,6 +52,7 @@ limitations under the License.
 #include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/stringprintf.h"
 #include "tensorflow/core/platform/tstring.h"
@@ -490,6 +498,55 @@ Status BundleWriter::Add(StringPiece key, const Tensor& val) {
   return status_;
 }
 
+Status BundleWriter::AddRowDelta(StringPiece key, const Tensor& val,
+                                 absl::Span<const int64_t> rows) {
+  if (!status_.ok()) return status_;
+  CHECK_NE(key, kHeaderEntryKey);
+  if (val.dims() < 1 || !DataTypeCanUseMemcpy(val.dtype())) {
+    status_ = errors::InvalidArgument(
+        "Row delta of ", key, " needs a tensor of at least one dimension with a"
+        " memcpy-able dtype, got ", DataTypeString(val.dtype()), " ",
+        val.shape().DebugString());
+    return status_;
+  }
+  const int64_t num_rows = val.dim_size(0);
+  for (const int64_t row : rows) {
+    if (row < 0 || row >= num_rows) {
+      status_ = errors::InvalidArgument("Row delta of ", key, ": row ", row,
+                                        " is not in [0, ", num_rows, ")");
+      return status_;
+    }
+  }
+  if (rows.empty()) return OkStatus();
+  const string key_string(key);
+  if (entries_.find(key_string) != entries_.end()) {
+    status_ = errors::InvalidArgument("Adding duplicate key: ", key);
+    return status_;
+  }
+
+  BundleEntryProto* entry = &entries_[key_string];
+  entry->set_dtype(val.dtype());
+  val.shape().AsProto(entry->mutable_shape());
+  entry->set_shard_id(0);
+  entry->set_offset(size_);
+  entry->mutable_delta_rows()->Add(rows.begin(), rows.end());
+
+  // Appends the rows straight from "val", without gathering them first.
+  const size_t row_bytes = val.TotalBytes() / num_rows;
+  const char* data = GetBackingBuffer(val);
+  out_->reset_crc32();
+  for (const int64_t row : rows) {
+    status_ = out_->Append(StringPiece(data + row * row_bytes, row_bytes));
+    if (!status_.ok()) return status_;
+  }
+  const size_t data_bytes_written = rows.size() * row_bytes;
+  entry->set_size(data_bytes_written);
+  entry->set_crc32c(crc32c::Mask(out_->crc32()));
+  size_ += data_bytes_written;
+  status_ = PadAlignment(out_.get(), options_.data_alignment, &size_);
+  return status_;
+}
+
 Status BundleWriter::AddSlice(StringPiece full_tensor_key,
                               const TensorShape& full_tensor_shape,
                               const TensorSlice& slice_spec,
@@ -767,6 +824,66 @@ Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
   return status;
 }
 
+Status CompactRowDeltas(Env* env, StringPiece base_prefix,
+                        absl::Span<const std::string> row_delta_prefixes,
+                        StringPiece output_prefix) {
+  BundleReader::Options options;
+  options.row_delta_prefixes.assign(row_delta_prefixes.begin(),
+                                    row_delta_prefixes.end());
+  BundleReader reader(env, base_prefix, options);
+  TF_RETURN_IF_ERROR(reader.status());
+
+  // Collects the tensors of all bundles, each with its last entry holding it
+  // whole, or with any of its row deltas if only those were added.
+  std::vector<std::string> prefixes = {std::string(base_prefix)};
+  prefixes.insert(prefixes.end(), row_delta_prefixes.begin(),
+                  row_delta_prefixes.end());
+  std::map<std::string, BundleEntryProto> entries;
+  std::set<std::string> slice_keys;
+  for (const std::string& prefix : prefixes) {
+    BundleReader prefix_reader(env, prefix);
+    TF_RETURN_IF_ERROR(prefix_reader.status());
+    prefix_reader.Seek(kHeaderEntryKey);
+    for (prefix_reader.Next(); prefix_reader.Valid(); prefix_reader.Next()) {
+      BundleEntryProto entry;
+      TF_RETURN_IF_ERROR(ParseEntryProto(prefix_reader.key(),
+                                         prefix_reader.value(), &entry));
+      const std::string key(prefix_reader.key());
+      for (const TensorSliceProto& slice : entry.slices()) {
+        slice_keys.insert(
+            checkpoint::EncodeTensorNameSlice(key, TensorSlice(slice)));
+      }
+      if (entry.delta_rows().empty()) {
+        entries[key] = std::move(entry);
+      } else {
+        entries.emplace(key, std::move(entry));
+      }
+    }
+  }
+
+  BundleWriter writer(env, output_prefix);
+  TF_RETURN_IF_ERROR(writer.status());
+  for (const auto& [key, entry] : entries) {
+    if (slice_keys.count(key) > 0) continue;
+    const TensorShape shape(entry.shape());
+    if (entry.slices().empty()) {
+      Tensor val(entry.dtype(), shape);
+      TF_RETURN_IF_ERROR(reader.Lookup(key, &val));
+      TF_RETURN_IF_ERROR(writer.Add(key, val));
+      continue;
+    }
+    for (const TensorSliceProto& slice_proto : entry.slices()) {
+      const TensorSlice slice(slice_proto);
+      TensorShape slice_shape;
+      TF_RETURN_IF_ERROR(slice.SliceTensorShape(shape, &slice_shape));
+      Tensor val(entry.dtype(), slice_shape);
+      TF_RETURN_IF_ERROR(reader.LookupSlice(key, slice, &val));
+      TF_RETURN_IF_ERROR(writer.AddSlice(key, shape, slice, val));
+    }
+  }
+  return writer.Finish();
+}
+
 // Interface for reading a tensor bundle.
 
 BundleReader::BundleReader(
@@ -837,8 +954,69 @@ BundleReader::BundleReader(Env* env, StringPiece prefix, Options options)
   }
   status_ = CheckVersions(header.version(), kTensorBundleVersion,
                           kTensorBundleMinProducer, "Checkpoint", "checkpoint");
+  if (!status_.ok()) return;
+
+  Options row_delta_options;
+  row_delta_options.cache = cache_;
+  for (const std::string& row_delta_prefix : options.row_delta_prefixes) {
+    row_deltas_.push_back(
+        std::make_unique<BundleReader>(env_, row_delta_prefix,
+                                       row_delta_options));
+    status_ = row_deltas_.back()->status();
+    if (!status_.ok()) return;
+  }
 }
 
+// A data file mapped read-only into memory. Referenced by the reader that
+// mapped it and by the tensors backed by it.
+class BundleReader::MappedDataFile : public core::RefCounted {
+ public:
+  explicit MappedDataFile(std::unique_ptr<ReadOnlyMemoryRegion> region)
+      : region_(std::move(region)) {}
+
+  const char* data() const {
+    return static_cast<const char*>(region_->data());
+  }
+  uint64 length() const { return region_->length(); }
+
+  // Returns a tensor backed by the "num_bytes" bytes at "offset".
+  Tensor GetTensor(DataType dtype, const TensorShape& shape, uint64 offset,
+                   size_t num_bytes) {
+    Buffer* buf =
+        new Buffer(this, const_cast<char*>(data()) + offset, num_bytes);
+    Tensor tensor(dtype, shape, buf);
+    buf->Unref();
+    return tensor;
+  }
+
+ private:
+  class Buffer : public TensorBuffer {
+   public:
+    Buffer(MappedDataFile* file, char* data, size_t size)
+        : TensorBuffer(data), file_(file), size_(size) {
+      file_->Ref();
+    }
+    ~Buffer() override { file_->Unref(); }
+
+    size_t size() const override { return size_; }
+    TensorBuffer* root_buffer() override { return this; }
+    void FillAllocationDescription(
+        AllocationDescription* proto) const override {
+      proto->set_requested_bytes(size_);
+      proto->set_allocator_name("MappedTensorBundle");
+    }
+    // The memory belongs to the read-only mapping, so it must not be
+    // forwarded or updated in place.
+    bool OwnsMemory() const override { return false; }
+
+   private:
+    MappedDataFile* const file_;
+    const size_t size_;
+  };
+
+  const std::unique_ptr<ReadOnlyMemoryRegion> region_;
+};
+
 BundleReader::~BundleReader() {
   delete metadata_;
   delete iter_;
@@ -852,6 +1030,9 @@ BundleReader::~BundleReader() {
   for (auto& temp : tensor_slices_) {
     delete temp.second;
   }
+  for (auto& temp : mapped_data_) {
+    if (temp.second != nullptr) temp.second->Unref();
+  }
   data_.clear();
   tensor_slices_.clear();
 }
@@ -878,6 +1059,11 @@ Status BundleReader::GetBundleEntryProto(StringPiece key,
 }
 
 Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
+  if (!entry.delta_rows().empty()) {
+    return errors::FailedPrecondition(
+        "TensorBundle at ", prefix_, " holds a row delta of the tensor, which "
+        "can only be applied to the tensor of an earlier bundle");
+  }
   Tensor* ret = val;
   const TensorShape stored_shape(TensorShape(entry.shape()));
   if (val->NumElements() == 0) {
@@ -1021,6 +1207,11 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
 
 Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   CHECK(val != nullptr);
+  if (!row_deltas_.empty()) return LookupWithRowDeltas(key, val);
+  return LookupInBundle(key, val);
+}
+
+Status BundleReader::LookupInBundle(StringPiece key, Tensor* val) {
   BundleEntryProto entry;
   TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
 
@@ -1033,6 +1224,351 @@ Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   }
 }
 
+Status BundleReader::LookupWithRowDeltas(StringPiece key, Tensor* val) {
+  // Finds the last bundle holding the tensor whole.
+  BundleEntryProto entry;
+  int first_delta = row_deltas_.size();
+  BundleReader* whole = this;
+  for (; first_delta > 0; --first_delta) {
+    BundleReader* row_delta = row_deltas_[first_delta - 1].get();
+    Status s = row_delta->GetBundleEntryProto(key, &entry);
+    if (errors::IsNotFound(s)) continue;
+    TF_RETURN_IF_ERROR(s);
+    if (!entry.slices().empty()) {
+      return errors::Unimplemented("TensorBundle at ", row_delta->prefix_,
+                                   " holds the partitioned tensor ", key,
+                                   ", which can't have row deltas");
+    }
+    if (entry.delta_rows().empty()) {
+      whole = row_delta;
+      break;
+    }
+  }
+  TF_RETURN_IF_ERROR(whole->LookupInBundle(key, val));
+
+  for (int i = first_delta; i < row_deltas_.size(); ++i) {
+    Status s = row_deltas_[i]->GetBundleEntryProto(key, &entry);
+    if (errors::IsNotFound(s)) continue;
+    TF_RETURN_IF_ERROR(s);
+    TF_RETURN_IF_ERROR(row_deltas_[i]->ApplyRowDelta(entry, val));
+  }
+  return OkStatus();
+}
+
+Status BundleReader::ApplyRowDelta(const BundleEntryProto& entry,
+                                   Tensor* val) {
+  const TensorShape shape(entry.shape());
+  if (entry.dtype() != val->dtype() || shape != val->shape()) {
+    return errors::InvalidArgument(
+        "TensorBundle at ", prefix_, " holds a row delta of a ",
+        DataTypeString(entry.dtype()), " ", shape.DebugString(),
+        " tensor, but the tensor to update is ", DataTypeString(val->dtype()),
+        " ", val->shape().DebugString());
+  }
+  if (shape.dims() < 1 || !DataTypeCanUseMemcpy(entry.dtype())) {
+    return errors::DataLoss("TensorBundle at ", prefix_,
+                            " holds an invalid row delta of a ",
+                            DataTypeString(entry.dtype()), " ",
+                            shape.DebugString(), " tensor");
+  }
+
+  // Reads the rows as a tensor of shape [num delta rows] + shape[1:].
+  BundleEntryProto rows_entry = entry;
+  rows_entry.clear_delta_rows();
+  TensorShape rows_shape = shape;
+  rows_shape.set_dim(0, entry.delta_rows_size());
+  rows_shape.AsProto(rows_entry.mutable_shape());
+  Tensor rows(entry.dtype(), rows_shape);
+  TF_RETURN_IF_ERROR(GetValue(rows_entry, &rows));
+
+  const int64_t num_rows = shape.dim_size(0);
+  const size_t row_bytes = num_rows == 0 ? 0 : val->TotalBytes() / num_rows;
+  const char* src = GetBackingBuffer(rows);
+  char* dst = GetBackingBuffer(*val);
+  for (int i = 0; i < entry.delta_rows_size(); ++i) {
+    const int64_t row = entry.delta_rows(i);
+    if (row < 0 || row >= num_rows) {
+      return errors::DataLoss("TensorBundle at ", prefix_, ": row ", row,
+                              " of a row delta is not in [0, ", num_rows,
+                              ")");
+    }
+    if (row_bytes > 0) {
+      std::memcpy(dst + row * row_bytes, src + i * row_bytes, row_bytes);
+    }
+  }
+  return OkStatus();
+}
+
+Status BundleReader::LookupMapped(StringPiece key, Tensor* val,
+                                  bool* is_mapped) {
+  CHECK(val != nullptr);
+  if (is_mapped != nullptr) *is_mapped = false;
+  if (!row_deltas_.empty()) {
+    DataType dtype;
+    TensorShape shape;
+    TF_RETURN_IF_ERROR(LookupDtypeAndShape(key, &dtype, &shape));
+    *val = Tensor(dtype, shape);
+    return Lookup(key, val);
+  }
+  BundleEntryProto entry;
+  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  const TensorShape shape(entry.shape());
+
+  MappedDataFile* mapped = nullptr;
+  if (entry.slices().empty() && entry.delta_rows().empty() &&
+      DataTypeCanUseMemcpy(entry.dtype()) && !need_to_swap_bytes_ &&
+      entry.size() > 0 &&
+      entry.offset() % Allocator::kAllocatorAlignment == 0) {
+    mapped = GetMappedDataFile(entry.shard_id());
+  }
+  if (mapped == nullptr) {
+    *val = Tensor(entry.dtype(), shape);
+    if (entry.slices().empty()) return GetValue(entry, val);
+    return GetSliceValue(key, entry, TensorSlice(shape.dims()), val);
+  }
+
+  const int64_t expected_size =
+      shape.num_elements() * DataTypeSize(entry.dtype());
+  if (entry.size() != expected_size) {
+    return errors::DataLoss("Invalid size in bundle entry: key ", key,
+                            "; stored size ", entry.size(),
+                            "; expected size ", expected_size);
+  }
+  if (entry.offset() + entry.size() > mapped->length()) {
+    return errors::DataLoss("TensorBundle at ", prefix_, " shard ",
+                            entry.shard_id(), " (", mapped->length(),
+                            " bytes): tensor ", key, " at offset ",
+                            entry.offset(), " (", entry.size(),
+                            " bytes) ends past the end of the file");
+  }
+  const uint32 actual_crc32c =
+      crc32c::Value(mapped->data() + entry.offset(), entry.size());
+  if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+    return errors::DataLoss(
+        "TensorBundle at ", prefix_, " shard ", entry.shard_id(), " (",
+        entry.size(), " bytes): Checksum does not match: stored ",
+        strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+        " vs. calculated on the restored bytes ", actual_crc32c);
+  }
+  *val = mapped->GetTensor(entry.dtype(), shape, entry.offset(), entry.size());
+  if (is_mapped != nullptr) *is_mapped = true;
+  return OkStatus();
+}
+
+BundleReader::MappedDataFile* BundleReader::GetMappedDataFile(
+    int32_t shard_id) {
+  auto it = mapped_data_.find(shard_id);
+  if (it != mapped_data_.end()) return it->second;
+  MappedDataFile* mapped = nullptr;
+  const std::string filename = DataFilename(prefix_, shard_id, num_shards_);
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  Status s = env_->NewReadOnlyMemoryRegionFromFile(filename, &region);
+  if (s.ok()) {
+    mapped = new MappedDataFile(std::move(region));
+  } else {
+    VLOG(1) << "Reading " << filename << " without mapping it: " << s;
+  }
+  mapped_data_[shard_id] = mapped;
+  return mapped;
+}
+
+Status BundleReader::LookupBatch(absl::Span<const std::string> keys,
+                                 absl::Span<Tensor* const> vals,
+                                 const LookupBatchOptions& options) {
+  if (keys.size() != vals.size()) {
+    return errors::InvalidArgument("LookupBatch got ", keys.size(),
+                                   " keys but ", vals.size(), " tensors");
+  }
+  if (!row_deltas_.empty()) {
+    for (int i = 0; i < keys.size(); ++i) {
+      TF_RETURN_IF_ERROR(Lookup(keys[i], vals[i]));
+    }
+    return OkStatus();
+  }
+
+  // A tensor read by the batched requests.
+  struct BatchEntry {
+    BundleEntryProto proto;
+    Tensor* val = nullptr;
+    // The number of requests holding part of the tensor that are not done.
+    std::atomic<int> num_pending_reads{0};
+  };
+  // Bytes [offset, offset + size) of a tensor, found at "read_offset" of the
+  // bytes read by a request.
+  struct Piece {
+    BatchEntry* entry;
+    int64_t offset;
+    int64_t read_offset;
+    int64_t size;
+  };
+  // A single read of bytes [offset, offset + size) of a data file.
+  struct Request {
+    int32_t shard_id;
+    int64_t offset;
+    int64_t size;
+    std::vector<Piece> pieces;
+  };
+
+  // Partitioned, string and variant tensors, and empty ones, are looked up
+  // one at a time.
+  std::vector<int> unbatched_indices;
+  std::deque<BatchEntry> entries;
+  for (int i = 0; i < keys.size(); ++i) {
+    CHECK(vals[i] != nullptr);
+    BundleEntryProto proto;
+    TF_RETURN_IF_ERROR(GetBundleEntryProto(keys[i], &proto));
+    if (!proto.slices().empty() || !DataTypeCanUseMemcpy(proto.dtype()) ||
+        proto.size() == 0) {
+      unbatched_indices.push_back(i);
+      continue;
+    }
+    Tensor* val = vals[i];
+    if (val->NumElements() == 0) {
+      *val = Tensor(proto.dtype(), TensorShape(proto.shape()));
+    }
+    if (proto.size() != val->TotalBytes()) {
+      return errors::DataLoss("Invalid size in bundle entry: key ", keys[i],
+                              "; stored size ", proto.size(),
+                              "; expected size ", val->TotalBytes());
+    }
+    entries.emplace_back();
+    entries.back().proto = std::move(proto);
+    entries.back().val = val;
+  }
+
+  std::vector<BatchEntry*> sorted_entries;
+  sorted_entries.reserve(entries.size());
+  for (BatchEntry& entry : entries) sorted_entries.push_back(&entry);
+  absl::c_sort(sorted_entries, [](const BatchEntry* a, const BatchEntry* b) {
+    if (a->proto.shard_id() != b->proto.shard_id()) {
+      return a->proto.shard_id() < b->proto.shard_id();
+    }
+    return a->proto.offset() < b->proto.offset();
+  });
+
+  // Coalesces adjacent tensors into requests of at most "max_read_bytes", and
+  // splits larger tensors into several requests.
+  const int64_t max_read_bytes = std::max<int64_t>(options.max_read_bytes, 1);
+  std::vector<Request> requests;
+  for (BatchEntry* entry : sorted_entries) {
+    const int32_t shard_id = entry->proto.shard_id();
+    const int64_t offset = entry->proto.offset();
+    const int64_t size = entry->proto.size();
+    if (size > max_read_bytes) {
+      for (int64_t chunk = 0; chunk < size; chunk += max_read_bytes) {
+        const int64_t chunk_size = std::min(max_read_bytes, size - chunk);
+        requests.push_back({shard_id,
+                            offset + chunk,
+                            chunk_size,
+                            {{entry, chunk, 0, chunk_size}}});
+      }
+      continue;
+    }
+    if (!requests.empty()) {
+      Request& last = requests.back();
+      const int64_t end = last.offset + last.size;
+      if (last.shard_id == shard_id && offset >= end &&
+          offset - end <= options.max_gap_bytes &&
+          offset + size - last.offset <= max_read_bytes) {
+        last.pieces.push_back({entry, 0, offset - last.offset, size});
+        last.size = offset + size - last.offset;
+        continue;
+      }
+    }
+    requests.push_back({shard_id, offset, size, {{entry, 0, 0, size}}});
+  }
+  for (const Request& request : requests) {
+    for (const Piece& piece : request.pieces) {
+      piece.entry->num_pending_reads.fetch_add(1);
+    }
+  }
+
+  // Validates a tensor once all its bytes are read. This runs on the thread
+  // of the last request holding part of it, so tensors are checksummed in
+  // parallel.
+  auto finish_piece = [this](const Piece& piece) -> Status {
+    BatchEntry* entry = piece.entry;
+    if (entry->num_pending_reads.fetch_sub(1) != 1) return OkStatus();
+    const uint32 actual_crc32c =
+        crc32c::Value(GetBackingBuffer(*entry->val), entry->proto.size());
+    if (crc32c::Unmask(entry->proto.crc32c()) != actual_crc32c) {
+      return errors::DataLoss(
+          "TensorBundle at ", prefix_, " shard ", entry->proto.shard_id(), " (",
+          entry->proto.size(), " bytes): Checksum does not match: stored ",
+          strings::Printf("%08u", crc32c::Unmask(entry->proto.crc32c())),
+          " vs. calculated on the restored bytes ", actual_crc32c);
+    }
+    if (need_to_swap_bytes_) {
+      TF_RETURN_IF_ERROR(ByteSwapTensor(entry->val));
+    }
+    return OkStatus();
+  };
+  auto run_request = [this, &finish_piece](const Request& request) -> Status {
+    RandomAccessFile* file = nullptr;
+    TF_RETURN_IF_ERROR(cache_->GetFile(
+        DataFilename(prefix_, request.shard_id, num_shards_), &file));
+    // A request holding a single tensor, or a part of one, is read directly
+    // into it. Others are staged.
+    std::unique_ptr<char[]> staging;
+    char* scratch;
+    if (request.pieces.size() == 1) {
+      const Piece& piece = request.pieces.front();
+      scratch = GetBackingBuffer(*piece.entry->val) + piece.offset;
+    } else {
+      staging.reset(new char[request.size]);
+      scratch = staging.get();
+    }
+    StringPiece result;
+    TF_RETURN_IF_ERROR(
+        file->Read(request.offset, request.size, &result, scratch));
+    if (result.size() != request.size) {
+      return errors::DataLoss("Requested ", request.size, " bytes but read ",
+                              result.size(), " bytes from shard ",
+                              request.shard_id, " of TensorBundle at ",
+                              prefix_);
+    }
+    for (const Piece& piece : request.pieces) {
+      char* destination = GetBackingBuffer(*piece.entry->val) + piece.offset;
+      const char* source = result.data() + piece.read_offset;
+      if (destination != source) memmove(destination, source, piece.size);
+      TF_RETURN_IF_ERROR(finish_piece(piece));
+    }
+    return OkStatus();
+  };
+
+  absl::Mutex mu;
+  int64_t bytes_in_flight = 0;  // Guarded by mu.
+  Status status;                // Guarded by mu.
+  {
+    thread::ThreadPool pool(env_, "restore_batch",
+                            std::max(options.num_threads, 1));
+    for (const Request& request : requests) {
+      {
+        absl::MutexLock lock(&mu);
+        auto fits_in_budget = [&]() {
+          return bytes_in_flight == 0 ||
+                 bytes_in_flight + request.size <= options.max_bytes_in_flight;
+        };
+        mu.Await(absl::Condition(&fits_in_budget));
+        if (!status.ok()) break;
+        bytes_in_flight += request.size;
+      }
+      pool.Schedule([&mu, &bytes_in_flight, &status, &run_request, &request]() {
+        Status request_status = run_request(request);
+        absl::MutexLock lock(&mu);
+        bytes_in_flight -= request.size;
+        status.Update(request_status);
+      });
+    }
+  }  // Waits for the scheduled requests to finish.
+  TF_RETURN_IF_ERROR(status);
+
+  for (int i : unbatched_indices) {
+    TF_RETURN_IF_ERROR(Lookup(keys[i], vals[i]));
+  }
+  return OkStatus();
+}
+
 Status BundleReader::ReadCurrent(Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
@@ -1066,6 +1602,13 @@ Status BundleReader::LookupTensorSlices(StringPiece key,
 Status BundleReader::LookupSlice(StringPiece full_tensor_key,
                                  const TensorSlice& slice_spec, Tensor* val) {
   CHECK(val != nullptr);
+  for (const auto& row_delta : row_deltas_) {
+    if (row_delta->Contains(full_tensor_key)) {
+      return errors::Unimplemented("TensorBundle at ", row_delta->prefix_,
+                                   " holds a row delta of ", full_tensor_key,
+                                   ", which can't be read in slices");
+    }
+  }
   BundleEntryProto entry;
   TF_RETURN_IF_ERROR(GetBundleEntryProto(full_tensor_key, &entry));
   return GetSliceValue(full_tensor_key, entry, slice_spec, val);
@@ -1196,7 +1739,12 @@ bool BundleReader::Contains(StringPiece key) {
 Status BundleReader::LookupDtypeAndShape(StringPiece key, DataType* dtype,
                                          TensorShape* shape) {
   BundleEntryProto entry;
-  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  Status s = GetBundleEntryProto(key, &entry);
+  // The tensor may have been added after this bundle, by a row delta bundle.
+  for (int i = row_deltas_.size() - 1; errors::IsNotFound(s) && i >= 0; --i) {
+    s = row_deltas_[i]->GetBundleEntryProto(key, &entry);
+  }
+  TF_RETURN_IF_ERROR(s);
   *dtype = entry.dtype();
   *shape = TensorShape(entry.shape());
   return OkStatus();
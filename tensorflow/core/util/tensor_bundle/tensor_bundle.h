@@ -72,6 +72,7 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/functional/function_ref.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_slice.h"
@@ -147,6 +148,18 @@ class BundleWriter {
                   const TensorShape& full_tensor_shape,
                   const TensorSlice& slice_spec, const Tensor& slice_tensor);
 
+  // Adds the rows "rows" of "val" under key "key", as a row delta: the entry
+  // keeps the dtype and shape of the whole "val", lists the rows, and stores
+  // only their values, in that order. Saving the rows a sparse update touched
+  // since the last save makes checkpoints of large embedding tables cheap; a
+  // BundleReader applies the deltas of later bundles to the tensor of an
+  // earlier one (see BundleReader::Options::row_delta_prefixes).
+  //
+  // "val" must have at least one dimension and a memcpy-able dtype, and the
+  // rows must be within its first dimension. Adds nothing if "rows" is empty.
+  Status AddRowDelta(absl::string_view key, const Tensor& val,
+                     absl::Span<const int64_t> rows);
+
   // Finishes the writer and flushes.
   Status Finish() TF_MUST_USE_RESULT;
 
@@ -194,6 +207,16 @@ Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
                     absl::string_view merged_prefix,
                     bool allow_missing_files = false);
 
+// Writes the tensors of the bundle "base_prefix", with the row deltas of the
+// bundles "row_delta_prefixes" applied in order (see
+// BundleReader::Options::row_delta_prefixes), whole into a new bundle
+// "output_prefix", so that restoring it reads no deltas. Leaves the input
+// bundles in place; since it only reads them, it can run in the background
+// while training writes further row delta bundles.
+Status CompactRowDeltas(Env* env, absl::string_view base_prefix,
+                        absl::Span<const std::string> row_delta_prefixes,
+                        absl::string_view output_prefix);
+
 class BundleCache;
 
 // On construction, silently attempts to read the metadata associated with
@@ -212,6 +235,16 @@ class BundleReader {
 
     // For tests only.
     bool enable_multi_threading_for_testing = false;
+
+    // Bundles of row deltas (see BundleWriter::AddRowDelta()) written after
+    // this one, oldest first. Lookup() reads a tensor from the last of these
+    // bundles holding it whole, or from this one, and applies the row deltas
+    // of the later bundles in order, so that restoring the checkpoint of a
+    // parameter server does not need a full save after every step.
+    //
+    // Row deltas are not applied to partitioned tensors, which fail to look
+    // up if a delta bundle holds them.
+    std::vector<std::string> row_delta_prefixes;
   };
   BundleReader(Env* env, absl::string_view prefix, Options options);
 
@@ -264,6 +297,57 @@ class BundleReader {
   // REQUIRES: status().ok()
   Status Lookup(absl::string_view key, Tensor* val) TF_MUST_USE_RESULT;
 
+  struct LookupBatchOptions {
+    // Tensors that are adjacent in a data file are read with a single request
+    // of at most this many bytes. Larger tensors are read in several requests
+    // of this size.
+    int64_t max_read_bytes = 64 << 20;
+    // Adjacent tensors separated by at most this many bytes, e.g. alignment
+    // padding, are still read with a single request.
+    int64_t max_gap_bytes = 64 << 10;
+    // The number of requests issued concurrently.
+    int num_threads = 8;
+    // Bounds the bytes of the requests in flight, and thus the memory used
+    // for staging the reads of several tensors. A request larger than the
+    // budget is issued alone.
+    int64_t max_bytes_in_flight = 512 << 20;
+  };
+
+  // Looks up the tensors keyed by "keys" into "vals", like calling Lookup()
+  // on each of them, but faster for large batches: the tensors are sorted by
+  // file offset, adjacent ones are read with large requests, requests are
+  // issued concurrently across all shards, and checksums are validated in
+  // parallel. Requests holding a single tensor are read directly into it.
+  //
+  // Partitioned, string and variant tensors are read one at a time, after the
+  // others, and so are all of them when the reader has row deltas.
+  //
+  // On error, "vals" may contain nonsense data.
+  // REQUIRES: status().ok() && keys.size() == vals.size()
+  Status LookupBatch(absl::Span<const std::string> keys,
+                     absl::Span<Tensor* const> vals,
+                     const LookupBatchOptions& options) TF_MUST_USE_RESULT;
+
+  // Looks up the full tensor keyed by "key" into a new tensor in "val", like
+  // Lookup(), but without copying it when possible: the tensor buffer then
+  // maps the data file copy-on-write, so its pages are loaded on first access
+  // and shared with the page cache, and with other processes serving the same
+  // checkpoint. The buffer does not own its memory, so kernels updating the
+  // tensor in place copy it first, and it keeps the file mapped after this
+  // reader is destroyed.
+  //
+  // Only tensors stored whole, with a memcpy-able dtype, in the byte order of
+  // this machine, at an offset aligned to Allocator::kAllocatorAlignment, in
+  // a local file are mapped; bundles written with a "data_alignment" of at
+  // least that many bytes align all of them. Other tensors, and all tensors
+  // of a reader with row deltas, are read into a new buffer. Sets
+  // "*is_mapped", if not null, to which of them happened.
+  //
+  // Validates the stored crc32c checksum against the mapped bytes.
+  // REQUIRES: status().ok()
+  Status LookupMapped(absl::string_view key, Tensor* val,
+                      bool* is_mapped = nullptr) TF_MUST_USE_RESULT;
+
   // Looks up the tensor pointed to by the internal iterator.
   //
   // On error, "val" may contain nonsense data.
@@ -322,6 +406,23 @@ class BundleReader {
   Status GetValue(const BundleEntryProto& entry,
                   Tensor* val) TF_MUST_USE_RESULT;
 
+  // Returns the data file of shard "shard_id" mapped into memory, or null if
+  // the file system can't map it.
+  class MappedDataFile;
+  MappedDataFile* GetMappedDataFile(int32_t shard_id);
+
+  // Lookup() without the row deltas.
+  Status LookupInBundle(absl::string_view key, Tensor* val) TF_MUST_USE_RESULT;
+
+  // Lookup() reading the tensor from the last of this bundle and the row delta
+  // bundles holding it whole and applying the row deltas after it.
+  Status LookupWithRowDeltas(absl::string_view key,
+                             Tensor* val) TF_MUST_USE_RESULT;
+
+  // Copies the rows of the row delta "entry" of this bundle into "val".
+  Status ApplyRowDelta(const BundleEntryProto& entry,
+                       Tensor* val) TF_MUST_USE_RESULT;
+
   // Reads the slice described by "slice_spec".  The corresponding full tensor
   // has key "ful_tensor_key" and metadata proto "full_tensor_entry".
   // REQUIRES: full_tensor_entry.slices_size() > 0
@@ -335,6 +436,9 @@ class BundleReader {
   std::unique_ptr<BundleCache> owned_cache_;  // may be null
   BundleCache* cache_;  // Not owned, or owned_cache_.get()
 
+  // Readers of Options::row_delta_prefixes, sharing cache_.
+  std::vector<std::unique_ptr<BundleReader>> row_deltas_;
+
   Status status_;
   RandomAccessFile* metadata_;  // Owned.
   table::Table* table_;
@@ -344,6 +448,10 @@ class BundleReader {
   // Owned InputBuffer objects. cache_ owns the underlying RandomAccessFiles.
   std::unordered_map<int32_t, io::InputBuffer*> data_;
 
+  // Data files mapped by LookupMapped(), or null for those that can't be.
+  // Each holds a reference, shared with the tensors mapping it.
+  std::unordered_map<int32_t, MappedDataFile*> mapped_data_;
+
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
   std::unordered_map<std::string, checkpoint::TensorSliceSet*> tensor_slices_;
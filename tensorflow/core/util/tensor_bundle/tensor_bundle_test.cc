@@ -1061,6 +1061,238 @@ TEST(TensorBundleTest, TruncatedTensorContents) {
   EXPECT_TRUE(errors::IsOutOfRange(reader.Lookup("key", &val)));
 }
 
+TEST(TensorBundleTest, LookupBatch) {
+  Env* env = Env::Default();
+  const std::vector<string> kBundlePrefixes = {Prefix("batch0"),
+                                               Prefix("batch1")};
+  BundleWriter writer0(env, kBundlePrefixes[0]);
+  TF_EXPECT_OK(writer0.Add("a", Constant_2x3<float>(1.)));
+  TF_EXPECT_OK(writer0.Add("b", Constant_2x3<int32>(2)));
+  TF_EXPECT_OK(writer0.Add("large", Constant_100x100<float>(3.)));
+  TF_EXPECT_OK(writer0.Add("c", Constant_2x3<double>(4.)));
+  TF_ASSERT_OK(writer0.Finish());
+  BundleWriter writer1(env, kBundlePrefixes[1]);
+  TF_EXPECT_OK(writer1.Add("d", Constant_2x3<float>(5.)));
+  TF_EXPECT_OK(writer1.Add("empty", Constant<float>(6., TensorShape({0}))));
+  TF_EXPECT_OK(writer1.Add("strings", test::AsTensor<tstring>({"x", "yz"})));
+  TF_ASSERT_OK(writer1.Finish());
+  const string kMerged = Prefix("batch_merged");
+  TF_ASSERT_OK(
+      MergeBundles(env, {kBundlePrefixes[0], kBundlePrefixes[1]}, kMerged));
+
+  BundleReader reader(env, kMerged);
+  TF_ASSERT_OK(reader.status());
+  const std::vector<string> keys = {"d",     "strings", "large", "c",
+                                    "empty", "a",       "b"};
+  // Tensors "a" and "b" are allocated by LookupBatch.
+  std::vector<Tensor> vals = {Tensor(DT_FLOAT, TensorShape({2, 3})),
+                              Tensor(DT_STRING, TensorShape({2})),
+                              Tensor(DT_FLOAT, TensorShape({100, 100})),
+                              Tensor(DT_DOUBLE, TensorShape({2, 3})),
+                              Tensor(DT_FLOAT, TensorShape({0})),
+                              Tensor(),
+                              Tensor()};
+  std::vector<Tensor*> val_ptrs;
+  for (Tensor& val : vals) val_ptrs.push_back(&val);
+
+  // Coalesces the small tensors of each shard, reads "large" in 400 requests
+  // and keeps at most 2 requests in flight.
+  BundleReader::LookupBatchOptions options;
+  options.max_read_bytes = 100;
+  options.max_gap_bytes = 0;
+  options.num_threads = 4;
+  options.max_bytes_in_flight = 200;
+  TF_ASSERT_OK(reader.LookupBatch(keys, val_ptrs, options));
+  test::ExpectTensorEqual<float>(vals[0], Constant_2x3<float>(5.));
+  test::ExpectTensorEqual<tstring>(vals[1],
+                                   test::AsTensor<tstring>({"x", "yz"}));
+  test::ExpectTensorEqual<float>(vals[2], Constant_100x100<float>(3.));
+  test::ExpectTensorEqual<double>(vals[3], Constant_2x3<double>(4.));
+  EXPECT_EQ(vals[4].NumElements(), 0);
+  test::ExpectTensorEqual<float>(vals[5], Constant_2x3<float>(1.));
+  test::ExpectTensorEqual<int32>(vals[6], Constant_2x3<int32>(2));
+
+  Tensor missing;
+  EXPECT_TRUE(errors::IsNotFound(
+      reader.LookupBatch({"missing"}, {&missing}, options)));
+}
+
+TEST(TensorBundleTest, LookupBatchChecksum) {
+  Env* env = Env::Default();
+  BundleWriter writer(env, Prefix("batch_checksum"));
+  TF_EXPECT_OK(writer.Add("a", Constant_2x3<float>(1.)));
+  TF_EXPECT_OK(writer.Add("b", Constant_2x3<float>(2.)));
+  TF_ASSERT_OK(writer.Finish());
+
+  // Corrupts the last byte, which belongs to "b".
+  const string datafile = DataFilename(Prefix("batch_checksum"), 0, 1);
+  string data;
+  TF_ASSERT_OK(ReadFileToString(env, datafile, &data));
+  data.back() = ~data.back();
+  TF_ASSERT_OK(WriteStringToFile(env, datafile, data));
+
+  BundleReader reader(env, Prefix("batch_checksum"));
+  TF_ASSERT_OK(reader.status());
+  Tensor a(DT_FLOAT, TensorShape({2, 3}));
+  Tensor b(DT_FLOAT, TensorShape({2, 3}));
+  Status status = reader.LookupBatch({"a", "b"}, {&a, &b},
+                                     BundleReader::LookupBatchOptions());
+  EXPECT_TRUE(errors::IsDataLoss(status));
+  EXPECT_TRUE(absl::StrContains(status.ToString(), "Checksum does not match"));
+}
+
+TEST(TensorBundleTest, LookupMapped) {
+  Env* env = Env::Default();
+  BundleWriter::Options opts;
+  opts.data_alignment = 64;
+  BundleWriter writer(env, Prefix("mapped"), opts);
+  TF_EXPECT_OK(writer.Add("a", Constant_2x3<float>(1.)));
+  TF_EXPECT_OK(writer.Add("b", Constant_100x100<int32>(2)));
+  TF_EXPECT_OK(writer.Add("strings", test::AsTensor<tstring>({"x", "yz"})));
+  TF_ASSERT_OK(writer.Finish());
+
+  Tensor a;
+  Tensor b;
+  Tensor strings;
+  {
+    BundleReader reader(env, Prefix("mapped"));
+    TF_ASSERT_OK(reader.status());
+    bool is_mapped = false;
+    TF_ASSERT_OK(reader.LookupMapped("a", &a, &is_mapped));
+    EXPECT_TRUE(is_mapped);
+    TF_ASSERT_OK(reader.LookupMapped("b", &b, &is_mapped));
+    EXPECT_TRUE(is_mapped);
+    TF_ASSERT_OK(reader.LookupMapped("strings", &strings, &is_mapped));
+    EXPECT_FALSE(is_mapped);
+    EXPECT_TRUE(errors::IsNotFound(reader.LookupMapped("missing", &a)));
+  }
+  // The mapped tensors outlive the reader, and are never forwarded.
+  test::ExpectTensorEqual<float>(a, Constant_2x3<float>(1.));
+  test::ExpectTensorEqual<int32>(b, Constant_100x100<int32>(2));
+  test::ExpectTensorEqual<tstring>(strings,
+                                   test::AsTensor<tstring>({"x", "yz"}));
+  EXPECT_FALSE(b.RefCountIsOne());
+
+  // Without alignment, only the first tensor is at an aligned offset; the
+  // others are read.
+  BundleWriter unaligned_writer(env, Prefix("unaligned"));
+  TF_EXPECT_OK(unaligned_writer.Add("a", Constant_2x3<float>(1.)));
+  TF_EXPECT_OK(unaligned_writer.Add("b", Constant_2x3<float>(2.)));
+  TF_ASSERT_OK(unaligned_writer.Finish());
+  BundleReader reader(env, Prefix("unaligned"));
+  TF_ASSERT_OK(reader.status());
+  bool is_mapped = false;
+  TF_ASSERT_OK(reader.LookupMapped("b", &b, &is_mapped));
+  EXPECT_FALSE(is_mapped);
+  test::ExpectTensorEqual<float>(b, Constant_2x3<float>(2.));
+}
+
+TEST(TensorBundleTest, LookupMappedChecksum) {
+  Env* env = Env::Default();
+  BundleWriter writer(env, Prefix("mapped_checksum"));
+  TF_EXPECT_OK(writer.Add("a", Constant_2x3<float>(1.)));
+  TF_ASSERT_OK(writer.Finish());
+
+  const string datafile = DataFilename(Prefix("mapped_checksum"), 0, 1);
+  string data;
+  TF_ASSERT_OK(ReadFileToString(env, datafile, &data));
+  data.back() = ~data.back();
+  TF_ASSERT_OK(WriteStringToFile(env, datafile, data));
+
+  BundleReader reader(env, Prefix("mapped_checksum"));
+  TF_ASSERT_OK(reader.status());
+  Tensor a;
+  Status status = reader.LookupMapped("a", &a);
+  EXPECT_TRUE(errors::IsDataLoss(status));
+  EXPECT_TRUE(absl::StrContains(status.ToString(), "Checksum does not match"));
+}
+
+TEST(TensorBundleTest, RowDeltas) {
+  Env* env = Env::Default();
+  BundleWriter base_writer(env, Prefix("row_deltas_base"));
+  TF_EXPECT_OK(base_writer.Add("emb", test::AsTensor<float>(
+                                          {0, 0, 1, 1, 2, 2, 3, 3}, {4, 2})));
+  TF_EXPECT_OK(base_writer.Add("step", test::AsScalar<int64_t>(1)));
+  TF_ASSERT_OK(base_writer.Finish());
+
+  // Rows 3 and 1 of "emb" were updated, then row 1 again and a new tensor.
+  BundleWriter delta_writer(env, Prefix("row_deltas_1"));
+  TF_EXPECT_OK(delta_writer.AddRowDelta(
+      "emb", test::AsTensor<float>({0, 0, 11, 11, 2, 2, 13, 13}, {4, 2}),
+      {3, 1}));
+  TF_EXPECT_OK(delta_writer.Add("step", test::AsScalar<int64_t>(2)));
+  TF_ASSERT_OK(delta_writer.Finish());
+  BundleWriter delta_writer_2(env, Prefix("row_deltas_2"));
+  TF_EXPECT_OK(delta_writer_2.AddRowDelta(
+      "emb", test::AsTensor<float>({0, 0, 21, 21, 2, 2, 13, 13}, {4, 2}),
+      {1}));
+  TF_EXPECT_OK(delta_writer_2.Add("new", Constant_2x3<int32>(5)));
+  TF_ASSERT_OK(delta_writer_2.Finish());
+
+  BundleReader::Options options;
+  options.row_delta_prefixes = {Prefix("row_deltas_1"),
+                                Prefix("row_deltas_2")};
+  BundleReader reader(env, Prefix("row_deltas_base"), options);
+  TF_ASSERT_OK(reader.status());
+  const Tensor expected_emb =
+      test::AsTensor<float>({0, 0, 21, 21, 2, 2, 13, 13}, {4, 2});
+  Expect<float>(&reader, "emb", expected_emb);
+  Expect<int64_t>(&reader, "step", test::AsScalar<int64_t>(2));
+  DataType dtype;
+  TensorShape shape;
+  TF_ASSERT_OK(reader.LookupDtypeAndShape("new", &dtype, &shape));
+  Tensor new_val(dtype, shape);
+  TF_ASSERT_OK(reader.Lookup("new", &new_val));
+  test::ExpectTensorEqual<int32>(new_val, Constant_2x3<int32>(5));
+
+  Tensor mapped_emb;
+  TF_ASSERT_OK(reader.LookupMapped("emb", &mapped_emb));
+  test::ExpectTensorEqual<float>(mapped_emb, expected_emb);
+  Tensor batch_emb(DT_FLOAT, TensorShape({4, 2}));
+  Tensor batch_step(DT_INT64, TensorShape({}));
+  TF_ASSERT_OK(reader.LookupBatch({"emb", "step"}, {&batch_emb, &batch_step},
+                                  BundleReader::LookupBatchOptions()));
+  test::ExpectTensorEqual<float>(batch_emb, expected_emb);
+  test::ExpectTensorEqual<int64_t>(batch_step, test::AsScalar<int64_t>(2));
+
+  // A row delta can't be read without the tensor it applies to.
+  BundleReader delta_reader(env, Prefix("row_deltas_1"));
+  TF_ASSERT_OK(delta_reader.status());
+  Tensor emb(DT_FLOAT, TensorShape({4, 2}));
+  EXPECT_TRUE(errors::IsFailedPrecondition(delta_reader.Lookup("emb", &emb)));
+
+  // Compaction writes the tensors whole.
+  TF_ASSERT_OK(CompactRowDeltas(env, Prefix("row_deltas_base"),
+                                options.row_delta_prefixes,
+                                Prefix("row_deltas_compacted")));
+  BundleReader compacted_reader(env, Prefix("row_deltas_compacted"));
+  TF_ASSERT_OK(compacted_reader.status());
+  Expect<float>(&compacted_reader, "emb", expected_emb);
+  Expect<int64_t>(&compacted_reader, "step", test::AsScalar<int64_t>(2));
+  Expect<int32>(&compacted_reader, "new", Constant_2x3<int32>(5));
+}
+
+TEST(TensorBundleTest, RowDeltaErrors) {
+  Env* env = Env::Default();
+  BundleWriter writer(env, Prefix("row_delta_errors"));
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      writer.AddRowDelta("scalar", test::AsScalar<float>(1), {0})));
+  BundleWriter strings_writer(env, Prefix("row_delta_errors"));
+  EXPECT_TRUE(errors::IsInvalidArgument(strings_writer.AddRowDelta(
+      "strings", test::AsTensor<tstring>({"a", "b"}), {0})));
+  BundleWriter range_writer(env, Prefix("row_delta_errors"));
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      range_writer.AddRowDelta("a", Constant_2x3<float>(1), {2})));
+
+  // No rows, no entry.
+  BundleWriter empty_writer(env, Prefix("row_delta_errors"));
+  TF_EXPECT_OK(empty_writer.AddRowDelta("a", Constant_2x3<float>(1), {}));
+  TF_ASSERT_OK(empty_writer.Finish());
+  BundleReader reader(env, Prefix("row_delta_errors"));
+  TF_ASSERT_OK(reader.status());
+  EXPECT_FALSE(reader.Contains("a"));
+}
+
 TEST(TensorBundleTest, HeaderEntry) {
   {
     BundleWriter writer(Env::Default(), Prefix("b"));
@@ -508,6 +508,22 @@ class DTensorDevice {
       const std::vector<TensorWithLayout*>& typed_inputs,
       const TFE_OpAttrs* attributes);
 
+  // Whether the eager op can be executed directly on the device of a single
+  // device mesh. See FastExecuteSingleDeviceOperation for more details.
+  bool ShouldFastExecuteSingleDeviceOperation(
+      const DTensorOperation& dtensor_operation, const Mesh& mesh,
+      const std::vector<TensorWithLayout*>& typed_inputs);
+
+  // Helper function to execute a eager op on a single device mesh without
+  // MLIR path. All inputs and outputs of such an op have the single device
+  // layout of the mesh, so SPMD expansion would produce the op itself.
+  void FastExecuteSingleDeviceOperation(
+      TFE_Context* context, const DTensorOperation& dtensor_operation,
+      const Mesh& mesh, int num_outputs,
+      const std::vector<TensorWithLayout*>& typed_inputs,
+      const TFE_OpAttrs* attributes, std::vector<TensorHandlePtr>& outputs,
+      TF_Status* status);
+
   // Helper function to execute a eager op without MLIR path.
   // This is a shortcut for performance improvement, especially for variable
   // initialization. Under certain condition
@@ -663,6 +679,7 @@ class DTensorDevice {
   // Statistics
   struct Stats {
     int64_t eager_pure_optimization_hits;
+    int64_t single_device_optimization_hits;
   } stats_;
   // Mesh configs with matching parallel devices.
   //
@@ -1326,6 +1343,8 @@ std::unordered_map<std::string, int> DTensorDevice::GetStats(
       {"function_manager.miss", fm_stats.misses},
       {"function_manager.size", fm_stats.size},
       {"eager_pure_optimization.hit", stats_.eager_pure_optimization_hits},
+      {"single_device_optimization.hit",
+       stats_.single_device_optimization_hits},
       {"device_cache.size", eager_stats.device_cache_size},
       {"kernel_cache.size", eager_stats.kernel_cache_size},
       {"local_rendezvous_cache.active.size",
@@ -2521,6 +2540,18 @@ void DTensorDevice::Execute(const TFE_Op* original_op, int* num_outputs,
     broadcast_results_keep_alive.emplace_back(std::move(tensor_with_layout));
   }
 
+  if (ShouldFastExecuteSingleDeviceOperation(dtensor_operation, mesh.value(),
+                                             typed_inputs)) {
+    {
+      mutex_lock lock(mu_);
+      stats_.single_device_optimization_hits++;
+    }
+    FastExecuteSingleDeviceOperation(context, dtensor_operation, mesh.value(),
+                                     *num_outputs, typed_inputs, attributes,
+                                     outputs, status);
+    return;
+  }
+
   if (ShouldFastExecuteEagerPureOperation(dtensor_operation, mesh.value(),
                                           typed_inputs, attributes)) {
     mutex_lock lock(mu_);
@@ -2598,6 +2629,55 @@ bool DTensorDevice::ShouldFastExecuteEagerPureOperation(
           all_dtype_supported && all_on_default_mesh);
 }
 
+bool DTensorDevice::ShouldFastExecuteSingleDeviceOperation(
+    const DTensorOperation& dtensor_operation, const Mesh& mesh,
+    const std::vector<TensorWithLayout*>& typed_inputs) {
+  // Functions may relayout or copy their tensors to other meshes, and the
+  // DTensor ops only have kernels after SPMD expansion, which only the MLIR
+  // passes handle.
+  if (dtensor_operation.is_func() || IsRelayoutOp(dtensor_operation) ||
+      absl::StartsWith(dtensor_operation.name, "DTensor") ||
+      !mesh.IsSingleDevice() || mesh.is_remote() ||
+      parallel_executor_ != nullptr) {
+    return false;
+  }
+  // A default layout could place the outputs elsewhere.
+  if (default_layout_.has_value()) return false;
+  for (const TensorWithLayout* typed_input : typed_inputs) {
+    const Layout& layout = typed_input->layout();
+    if (!layout.IsSingleDevice() || layout.mesh() != mesh) return false;
+  }
+  return true;
+}
+
+void DTensorDevice::FastExecuteSingleDeviceOperation(
+    TFE_Context* context, const DTensorOperation& dtensor_operation,
+    const Mesh& mesh, int num_outputs,
+    const std::vector<TensorWithLayout*>& typed_inputs,
+    const TFE_OpAttrs* attributes, std::vector<TensorHandlePtr>& outputs,
+    TF_Status* status) {
+  std::vector<TFE_TensorHandle*> single_device_inputs;
+  single_device_inputs.reserve(typed_inputs.size());
+  for (const TensorWithLayout* typed_input : typed_inputs) {
+    single_device_inputs.push_back(typed_input->get_tensor(0));
+  }
+  std::vector<TensorHandlePtr> single_device_outputs(num_outputs);
+  ExecuteSingleDeviceOperation(context, single_device_inputs,
+                               dtensor_operation.name,
+                               std::string{mesh.single_device()}, attributes,
+                               &num_outputs, single_device_outputs, status);
+  if (TF_GetCode(status) != TF_OK) return;
+
+  for (int i = 0; i < num_outputs; ++i) {
+    std::unique_ptr<TensorWithLayout> output_tensor =
+        Broadcast(context, single_device_outputs[i].get(), mesh, status);
+    if (TF_GetCode(status) != TF_OK) return;
+    outputs[i].reset(
+        MakeLayoutTensorHandle(context, std::move(output_tensor), status));
+    if (TF_GetCode(status) != TF_OK) return;
+  }
+}
+
 void DTensorDevice::FastExecuteEagerPureOperation(
     TFE_Context* context, const DTensorOperation& dtensor_operation,
     const Mesh& mesh, int num_inputs, int num_outputs,
@@ -88,6 +88,13 @@ bool EnableMixedPrecisionReduce() {
   return true;
 }
 
+bool EnableCollectiveScheduling() {
+  char* dtensor_enable_collective_scheduling_str =
+      std::getenv("DTENSOR_ENABLE_COLLECTIVE_SCHEDULING");
+  if (dtensor_enable_collective_scheduling_str == nullptr) return false;
+  return true;
+}
+
 bool DoNotFuseReduceScatter() {
   char* dtensor_do_not_fuse_reduce_scatter_str =
       std::getenv("DTENSOR_DO_NOT_FUSE_REDUCE_SCATTER");
@@ -46,6 +46,10 @@ int LayoutPropagationMaxSteps();
 // sufficient reduction group size.
 bool EnableMixedPrecisionReduce();
 
+// Returns whether to move collectives right after the ops computing their
+// inputs, so that communication overlaps with independent computation.
+bool EnableCollectiveScheduling();
+
 // Returns whether *not* to fuse AllReduce + AllScatter into ReduceScatter op,
 // which can be more efficiently implemented.
 bool DoNotFuseReduceScatter();
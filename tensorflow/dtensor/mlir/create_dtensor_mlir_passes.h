@@ -58,6 +58,9 @@ CreateDTensorAllReduceCombineOptimization();
 std::unique_ptr<mlir::OperationPass<mlir::func::FuncOp>>
 CreateDTensorMixedPrecisionReducePass();
 
+std::unique_ptr<mlir::OperationPass<mlir::func::FuncOp>>
+CreateDTensorCollectiveSchedulingPass();
+
 std::unique_ptr<mlir::OperationPass<mlir::func::FuncOp>>
 CreateDTensorSetDefaultSharding();
 
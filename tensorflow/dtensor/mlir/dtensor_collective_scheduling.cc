@@ -0,0 +1,119 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include <iterator>
+#include <memory>
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"  // from @llvm-project
+#include "mlir/IR/Block.h"  // from @llvm-project
+#include "mlir/IR/OpDefinition.h"  // from @llvm-project
+#include "mlir/IR/Operation.h"  // from @llvm-project
+#include "mlir/IR/Value.h"  // from @llvm-project
+#include "mlir/Pass/Pass.h"  // from @llvm-project
+#include "tensorflow/dtensor/mlir/dtensor_mlir_passes.h"
+#include "tensorflow/dtensor/mlir/ir/tf_dtensor.h"
+
+namespace tensorflow {
+namespace dtensor {
+
+namespace {
+#define GEN_PASS_DEF_DTENSORCOLLECTIVESCHEDULING
+#include "tensorflow/dtensor/mlir/dtensor_passes.h.inc"
+
+// Returns true if `op` is a DTensor collective that communicates across
+// devices once lowered.
+bool IsCommunicatingCollective(mlir::Operation* op) {
+  return llvm::isa<mlir::TF::DTensorAllReduceOp,
+                   mlir::TF::DTensorReduceScatterOp,
+                   mlir::TF::DTensorAllGatherOp, mlir::TF::DTensorAllToAllOp>(
+      op);
+}
+
+// Moves every collective in `block` right after the last op of `block` that
+// computes one of its operands. Constant operands, e.g. group assignments, are
+// moved along with the collective. Collectives that end up at the same point
+// keep their relative order, i.e. a collective is never placed before the
+// collectives, or their constant operands, that were scheduled before it.
+//
+// The DTensor collectives are pure, so this only changes the program order.
+// Once lowered, collectives are ordered among each other by the program
+// order, and a collective can only start after the collectives before it.
+// Ordering collectives by the time their inputs are ready lets the
+// communication of one layer start before the computation of the next layer
+// instead of after it. The consumers of a collective are not moved, so they
+// still wait for it as late as before.
+void ScheduleCollectivesEarly(mlir::Block& block) {
+  llvm::SmallVector<mlir::Operation*, 8> collectives;
+  for (mlir::Operation& op : block) {
+    if (IsCommunicatingCollective(&op)) collectives.push_back(&op);
+  }
+
+  llvm::SmallPtrSet<mlir::Operation*, 8> scheduled;
+  for (mlir::Operation* collective : collectives) {
+    mlir::Operation* last_producer = nullptr;
+    llvm::SmallVector<mlir::Operation*, 2> constants;
+    for (mlir::Value operand : collective->getOperands()) {
+      mlir::Operation* producer = operand.getDefiningOp();
+      if (producer == nullptr || producer->getBlock() != &block) continue;
+      if (producer->hasTrait<mlir::OpTrait::ConstantLike>()) {
+        constants.push_back(producer);
+        continue;
+      }
+      if (last_producer == nullptr || last_producer->isBeforeInBlock(producer))
+        last_producer = producer;
+    }
+
+    mlir::Block::iterator insertion_point =
+        last_producer != nullptr ? std::next(last_producer->getIterator())
+                                 : block.begin();
+    while (scheduled.contains(&*insertion_point)) ++insertion_point;
+    if (&*insertion_point != collective) {
+      collective->moveBefore(&block, insertion_point);
+    }
+    for (mlir::Operation* constant : constants) {
+      if (collective->isBeforeInBlock(constant)) {
+        constant->moveBefore(collective);
+      }
+      scheduled.insert(constant);
+    }
+    scheduled.insert(collective);
+  }
+}
+
+// MLIR pass that schedules DTensor collectives as early as their inputs
+// allow, so that communication overlaps with the computation that does not
+// depend on it.
+struct DTensorCollectiveScheduling
+    : public impl::DTensorCollectiveSchedulingBase<
+          DTensorCollectiveScheduling> {
+  void runOnOperation() override {
+    getOperation().walk(
+        [](mlir::Block* block) { ScheduleCollectivesEarly(*block); });
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<mlir::OperationPass<mlir::func::FuncOp>>
+CreateDTensorCollectiveSchedulingPass() {
+  return std::make_unique<DTensorCollectiveScheduling>();
+}
+
+}  // namespace dtensor
+}  // namespace tensorflow
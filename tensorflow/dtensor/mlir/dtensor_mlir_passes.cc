@@ -259,6 +259,13 @@ void CreateDTensorMLIRPass(const mlir::TF::StandardPipelineOptions &options,
         CreateDTensorMixedPrecisionReducePass());
   }
 
+  // Issue collectives as soon as their inputs are ready, so that they overlap
+  // with the computation that does not depend on them.
+  if (EnableCollectiveScheduling()) {
+    pm->addNestedPass<mlir::func::FuncOp>(
+        CreateDTensorCollectiveSchedulingPass());
+  }
+
   // Lower device-agnostic logical AllReduce ops into device-specific physical
   // AllReduce ops.
   //
@@ -0,0 +1,46 @@
+// RUN: dtensor-opt %s -split-input-file -dtensor-collective-scheduling -verify-diagnostics | FileCheck %s
+
+// Check that a DTensorAllReduce is moved right after the op computing its
+// input, before independent computation.
+// CHECK-LABEL: func @main
+func.func @main(%arg0: tensor<4x4xf32>, %arg1: tensor<4x4xf32>) {
+  // CHECK:      %[[GRAD:.*]] = "tf.Mul"(%arg0, %arg0)
+  // CHECK-NEXT: %[[GROUP_ASSIGNMENT:.*]] = "tf.Const"()
+  // CHECK-NEXT: %[[ALL_REDUCE:.*]] = "tf.DTensorAllReduce"(%[[GRAD]], %[[GROUP_ASSIGNMENT]])
+  // CHECK-NEXT: %[[MATMUL:.*]] = "tf.MatMul"(%arg1, %arg1)
+  // CHECK-NEXT: "tf.Add"(%[[ALL_REDUCE]], %[[MATMUL]])
+  %0 = "tf_device.cluster"() ({
+    %1 = "tf.Mul"(%arg0, %arg0) : (tensor<4x4xf32>, tensor<4x4xf32>) -> tensor<4x4xf32>
+    %2 = "tf.MatMul"(%arg1, %arg1) : (tensor<4x4xf32>, tensor<4x4xf32>) -> tensor<4x4xf32>
+    %3 = "tf.Const"() {value = dense<[[0, 1], [2, 3]]> : tensor<2x2xi32>} : () -> tensor<2x2xi32>
+    %4 = "tf.DTensorAllReduce"(%1, %3) {_layout = ["sharding_specs:x,y, mesh:|x=2,y=2|*GPU"], device_type = "GPU", reduce_op = "Add"} : (tensor<4x4xf32>, tensor<2x2xi32>) -> tensor<4x4xf32>
+    %5 = "tf.Add"(%4, %2) : (tensor<4x4xf32>, tensor<4x4xf32>) -> tensor<4x4xf32>
+    "tf_device.return"(%5) : (tensor<4x4xf32>) -> ()
+  }) : () -> tensor<4x4xf32>
+  "func.return"() : () -> ()
+}
+
+// -----
+// Check that collectives hoisted to the same point keep their relative order.
+// CHECK-LABEL: func @main
+func.func @main(%arg0: tensor<4x4xf32>) {
+  // CHECK:      %[[GRAD:.*]] = "tf.Mul"(%arg0, %arg0)
+  // CHECK-NEXT: "tf.Const"()
+  // CHECK-NEXT: %[[ALL_REDUCE_0:.*]] = "tf.DTensorAllReduce"(%[[GRAD]]
+  // CHECK-SAME:   reduce_op = "Add"
+  // CHECK-NEXT: "tf.Const"()
+  // CHECK-NEXT: %[[ALL_REDUCE_1:.*]] = "tf.DTensorAllReduce"(%[[GRAD]]
+  // CHECK-SAME:   reduce_op = "Max"
+  // CHECK-NEXT: "tf.Neg"(%arg0)
+  %0 = "tf_device.cluster"() ({
+    %1 = "tf.Mul"(%arg0, %arg0) : (tensor<4x4xf32>, tensor<4x4xf32>) -> tensor<4x4xf32>
+    %2 = "tf.Neg"(%arg0) : (tensor<4x4xf32>) -> tensor<4x4xf32>
+    %3 = "tf.Const"() {value = dense<[[0, 1], [2, 3]]> : tensor<2x2xi32>} : () -> tensor<2x2xi32>
+    %4 = "tf.DTensorAllReduce"(%1, %3) {_layout = ["sharding_specs:x,y, mesh:|x=2,y=2|*GPU"], device_type = "GPU", reduce_op = "Add"} : (tensor<4x4xf32>, tensor<2x2xi32>) -> tensor<4x4xf32>
+    %5 = "tf.Const"() {value = dense<[[0, 1], [2, 3]]> : tensor<2x2xi32>} : () -> tensor<2x2xi32>
+    %6 = "tf.DTensorAllReduce"(%1, %5) {_layout = ["sharding_specs:x,y, mesh:|x=2,y=2|*GPU"], device_type = "GPU", reduce_op = "Max"} : (tensor<4x4xf32>, tensor<2x2xi32>) -> tensor<4x4xf32>
+    %7 = "tf.AddN"(%2, %4, %6) : (tensor<4x4xf32>, tensor<4x4xf32>, tensor<4x4xf32>) -> tensor<4x4xf32>
+    "tf_device.return"(%7) : (tensor<4x4xf32>) -> ()
+  }) : () -> tensor<4x4xf32>
+  "func.return"() : () -> ()
+}
@@ -326,5 +326,25 @@ class DTensorDeviceCacheTest(test_util.DTensorBaseTest):
       )
 
 
+  def testSingleDeviceMeshEagerOps(self):
+    cpu0_mesh = Mesh.from_device("/job:localhost/replica:0/task:0/device:CPU:0")
+    with api.default_mesh(cpu0_mesh):
+      a = array_ops.ones(shape=(3, 3))
+
+    stats1 = api._dtensor_device()._get_stats()
+
+    with api.default_mesh(cpu0_mesh):
+      b = math_ops.add(a, a)
+
+    stats2 = api._dtensor_device()._get_stats()
+    diff = diff_dicts(stats2, stats1)
+
+    # The op runs directly on the device, without SPMD expansion.
+    self.assertEqual(diff["single_device_optimization.hit"], 1)
+    self.assertEqual(diff["function_manager.size"], 0)
+    self.assertTrue(api.is_dtensor(b))
+    self.assertEqual(api.fetch_layout(b).mesh, cpu0_mesh)
+    self.assertAllEqual(b.numpy(), np.full((3, 3), 2.0))
+
 if __name__ == "__main__":
   test.main()
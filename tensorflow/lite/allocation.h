@@ -95,6 +95,16 @@ class MMAPAllocation : public Allocation {
     return offset_of_buffer_in_file_;
   }
 
+  /// Asks the OS to read the pages of the given range of the allocation
+  /// ahead of their use. Parts of the range outside the allocation are
+  /// ignored.
+  void Prefetch(const void* ptr, size_t num_bytes) const;
+
+  /// Asks the OS to drop the pages of the given range of the allocation from
+  /// memory. They are read back from the file on their next access, so the
+  /// data stays valid. Only pages entirely within the range are dropped.
+  void Release(const void* ptr, size_t num_bytes) const;
+
   static bool IsSupported();
 
  protected:
@@ -52,6 +52,28 @@ TEST(MMAPAllocation, TestValidFile) {
   EXPECT_NE(allocation.base(), nullptr);
 }
 
+TEST(MMAPAllocation, TestPrefetchAndRelease) {
+  if (!MMAPAllocation::IsSupported()) {
+    return;
+  }
+
+  TestErrorReporter error_reporter;
+  MMAPAllocation allocation(
+      "tensorflow/lite/testdata/empty_model.bin", &error_reporter);
+  ASSERT_TRUE(allocation.valid());
+  const char* base = static_cast<const char*>(allocation.base());
+  const std::string contents(base, allocation.bytes());
+
+  allocation.Prefetch(base, allocation.bytes());
+  // Ranges partially outside of the allocation are clamped.
+  allocation.Prefetch(base + 1, allocation.bytes());
+  allocation.Release(base + 1, allocation.bytes());
+  allocation.Release(base, allocation.bytes());
+
+  // Dropped pages are read back from the file.
+  EXPECT_EQ(std::string(base, allocation.bytes()), contents);
+}
+
 #if defined(__linux__)
 TEST(MMAPAllocation, TestInvalidFileDescriptor) {
   if (!MMAPAllocation::IsSupported()) {
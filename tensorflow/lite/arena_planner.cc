@@ -33,6 +33,8 @@ constexpr int32_t kLastActiveNodeUndefined =
     std::numeric_limits<int32_t>::max();
 constexpr int32_t kNodeNotAssigned = std::numeric_limits<int32_t>::max();
 constexpr int32_t kScalarTensorBytes = 4;
+// Number of allocation plans of the whole graph that are kept for reuse.
+constexpr size_t kMaxCachedPlans = 4;
 
 ArenaPlanner::ArenaPlanner(TfLiteContext* context,
                            std::unique_ptr<GraphInfo> graph_info,
@@ -102,6 +104,56 @@ int ArenaPlanner::FindSharedTensor(int tensor_index) {
   return tensor_index;
 }
 
+std::vector<size_t> ArenaPlanner::CreatePlanKey() const {
+  const TfLiteTensor* tensors = graph_info_->tensors();
+  const size_t num_tensors = graph_info_->num_tensors();
+  std::vector<size_t> key;
+  key.reserve(4 * num_tensors);
+  for (size_t i = 0; i < num_tensors; ++i) {
+    key.push_back(tensors[i].bytes);
+    key.push_back(tensors[i].allocation_type);
+    key.push_back(alloc_node_[i]);
+    key.push_back(dealloc_node_[i]);
+  }
+  return key;
+}
+
+bool ArenaPlanner::RestoreCachedPlan(const std::vector<size_t>& key) {
+  auto it = std::find_if(
+      cached_plans_.begin(), cached_plans_.end(),
+      [&key](const CachedPlan& plan) { return plan.key == key; });
+  if (it == cached_plans_.end()) {
+    return false;
+  }
+  std::rotate(cached_plans_.begin(), it, it + 1);
+  const CachedPlan& plan = cached_plans_.front();
+  allocs_ = plan.allocs;
+  actual_tensor_id_ = plan.actual_tensor_id;
+
+  // Each arena gets back the allocs of the tensors it holds.
+  const TfLiteTensor* tensors = graph_info_->tensors();
+  std::vector<ArenaAllocWithUsageInterval> arena_allocs;
+  std::vector<ArenaAllocWithUsageInterval> persistent_allocs;
+  for (size_t i = 0; i < allocs_.size(); ++i) {
+    if (tensors[i].allocation_type == kTfLiteArenaRw) {
+      arena_allocs.push_back(allocs_[i]);
+    } else if (tensors[i].allocation_type == kTfLiteArenaRwPersistent) {
+      persistent_allocs.push_back(allocs_[i]);
+    }
+  }
+  arena_.RestorePlan(arena_allocs);
+  persistent_arena_.RestorePlan(persistent_allocs);
+  return true;
+}
+
+void ArenaPlanner::CachePlan(std::vector<size_t> key) {
+  if (cached_plans_.size() == kMaxCachedPlans) {
+    cached_plans_.pop_back();
+  }
+  cached_plans_.insert(cached_plans_.begin(),
+                       CachedPlan{std::move(key), allocs_, actual_tensor_id_});
+}
+
 bool ArenaPlanner::InputTensorCanBeShared(const TfLiteTensor& input_tensor,
                                           const TfLiteTensor& output_tensor,
                                           int input_id, int output_id,
@@ -205,6 +257,7 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
   // Invalidate any existing data.
   const size_t num_tensors = graph_info_->num_tensors();
   TF_LITE_ENSURE_STATUS(ResetAllocations());
+  cached_plans_.clear();
   // Maybe other verb instead of 'Assigned'
   alloc_node_.assign(num_tensors, kNodeNotAssigned);
   dealloc_node_.assign(num_tensors, kNodeNotAssigned);
@@ -221,7 +274,7 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
       return kTfLiteOk;
     }
     TF_LITE_ENSURE(context_, dealloc_node_[tensor] == kNodeNotAssigned);
-    alloc_node_[tensor] = node;
+    alloc_node_[tensor] = graph_info_->first_concurrent_node(node);
     return kTfLiteOk;
   };
 
@@ -232,7 +285,7 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
       return kTfLiteOk;
     }
     TF_LITE_ENSURE(context_, dealloc_node_[tensor] == kNodeNotAssigned);
-    dealloc_node_[tensor] = node;
+    dealloc_node_[tensor] = graph_info_->last_concurrent_node(node);
     return kTfLiteOk;
   };
 
@@ -352,22 +405,41 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
     TfLiteIntArray* node_temporaries = node.temporaries;
     for (int j = 0; j < node_temporaries->size; ++j) {
       int tensor_index = node_temporaries->data[j];
-      alloc_node_[tensor_index] = i;
+      alloc_node_[tensor_index] = graph_info_->first_concurrent_node(i);
       nodes_to_tensors_[i].insert(tensor_index);
       if (!preserve_all_tensors_) {
-        dealloc_node_[tensor_index] = i;
+        dealloc_node_[tensor_index] = graph_info_->last_concurrent_node(i);
       }
     }
   }
 
+  // Allocations of the whole graph are cached, and reused when the tensors
+  // have the same sizes again.
+  const bool plans_whole_graph = first_node == 0 &&
+                                 num_execution_nodes > 0 &&
+                                 last_node + 1 >= num_execution_nodes;
+  std::vector<size_t> plan_key;
+  bool plan_restored = false;
+  if (plans_whole_graph) {
+    plan_key = CreatePlanKey();
+    plan_restored = RestoreCachedPlan(plan_key);
+  }
+
   std::vector<int32_t> tensors_allocated;
-  TF_LITE_ENSURE_STATUS(
-      CalculateAllocations(first_node, last_node, &tensors_allocated));
+  if (plan_restored) {
+    last_active_node_ = last_node;
+  } else {
+    TF_LITE_ENSURE_STATUS(
+        CalculateAllocations(first_node, last_node, &tensors_allocated));
+    if (plans_whole_graph) {
+      CachePlan(std::move(plan_key));
+    }
+  }
   bool arena_reallocated = false;
   TF_LITE_ENSURE_STATUS(Commit(&arena_reallocated));
 
   TfLiteTensor* tensors = graph_info_->tensors();
-  if (arena_reallocated) {
+  if (arena_reallocated || plan_restored) {
     for (int i = 0; i < static_cast<int>(num_tensors); ++i) {
       TF_LITE_ENSURE_STATUS(ResolveTensorAllocation(i, tensors));
     }
@@ -413,7 +485,13 @@ TfLiteStatus ArenaPlanner::AcquireNonPersistentMemory() {
 }
 
 bool ArenaPlanner::HasNonPersistentMemory() {
-  return has_nonpersistent_memory_;
+  return has_nonpersistent_memory_ && !arena_.IsSharedBufferTaken();
+}
+
+void ArenaPlanner::SetSharedArenaBuffer(
+    std::shared_ptr<SharedArenaBuffer> shared_buffer) {
+  arena_.SetSharedBuffer(std::move(shared_buffer));
+  has_nonpersistent_memory_ = false;
 }
 
 void ArenaPlanner::DumpDebugInfo(const std::vector<int>& execution_plan) const {
@@ -45,6 +45,12 @@ constexpr const int kDefaultArenaAlignment = 64;
 // execution. Since dynamic tensors don't have sizes until after the
 // corresponding operation is executed, this class supports incremental
 // planning.
+//
+// The offsets computed for the whole graph are cached for the last few sets of
+// tensor sizes, so that a model whose inputs alternate between a few shapes
+// reuses the offsets of a shape it has seen instead of computing them again.
+// Since arenas never shrink, this also keeps those shapes from growing the
+// arenas.
 class ArenaPlanner : public MemoryPlanner {
  public:
   // Ownership of 'context' is not taken and it must remain util the
@@ -65,6 +71,13 @@ class ArenaPlanner : public MemoryPlanner {
   TfLiteStatus ReleaseNonPersistentMemory() override;
   TfLiteStatus AcquireNonPersistentMemory() override;
   bool HasNonPersistentMemory() override;
+
+  // Makes the non-persistent arena use `shared_buffer`, which the arenas of
+  // other interpreters that never run at the same time use as well. Must be
+  // called before the allocations are executed. Whenever another arena has
+  // taken the buffer, HasNonPersistentMemory() returns false until
+  // AcquireNonPersistentMemory() takes it back.
+  void SetSharedArenaBuffer(std::shared_ptr<SharedArenaBuffer> shared_buffer);
   void DumpDebugInfo(const std::vector<int>& execution_plan) const override;
   void GetAllocInfo(size_t* arena_size,
                     size_t* arena_persist_size) const override;
@@ -120,6 +133,18 @@ class ArenaPlanner : public MemoryPlanner {
   // Return the index of the tensor owing `tensor_index's` buffer.
   int FindSharedTensor(int tensor_index);
 
+  // Returns the sizes, allocation types and usage intervals of all tensors,
+  // which determine the allocations of the whole graph.
+  std::vector<size_t> CreatePlanKey() const;
+
+  // Restores the allocations cached for `key`, if any, and moves them to the
+  // front of the cache. Returns true if the allocations were restored.
+  bool RestoreCachedPlan(const std::vector<size_t>& key);
+
+  // Caches the current allocations for `key`, evicting the least recently used
+  // ones if the cache is full.
+  void CachePlan(std::vector<size_t> key);
+
   TfLiteContext* context_;
   std::unique_ptr<GraphInfo> graph_info_;
 
@@ -166,6 +191,18 @@ class ArenaPlanner : public MemoryPlanner {
 
   // Store number of references to each tensor.
   std::vector<int> refcounts_;
+
+  // Allocations of the whole graph for one set of tensor sizes.
+  struct CachedPlan {
+    std::vector<size_t> key;
+    std::vector<ArenaAllocWithUsageInterval> allocs;
+    // NOLINTNEXTLINE - absl::flat_hash_map increases binary size by 106kB.
+    std::unordered_map<int32_t, int32_t> actual_tensor_id;
+  };
+
+  // Cached plans, most recently used first. Cleared by PlanAllocations, which
+  // changes the usage intervals and the tensors sharing buffers.
+  std::vector<CachedPlan> cached_plans_;
 };
 
 }  // namespace tflite
@@ -370,6 +370,48 @@ TEST_F(ArenaPlannerTest, AllocsCorrectlyReset) {
   EXPECT_EQ(GetOffset(1), 4);
 }
 
+TEST_F(ArenaPlannerTest, ReusesPlansOfPreviousTensorSizes) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph);
+  std::vector<TfLiteTensor>& tensors = *graph.tensors();
+  // Make the inputs larger than the other tensors, as variable length inputs
+  // would.
+  tensors[0].bytes = 400;
+  tensors[1].bytes = 400;
+  Execute(0, graph.nodes().size() - 1);
+  const std::vector<std::ptrdiff_t> small_offsets = {
+      GetOffset(0), GetOffset(1), GetOffset(2),
+      GetOffset(3), GetOffset(4), GetOffset(5)};
+
+  // Plan for larger tensors, which grows the arena.
+  ResetAllocations();
+  for (int i = 0; i < 6; ++i) tensors[i].bytes *= 4;
+  Execute(0, graph.nodes().size() - 1);
+  const std::intptr_t base_pointer = planner_->BasePointer(kTfLiteArenaRw);
+  size_t arena_size, arena_persist_size;
+  planner_->GetAllocInfo(&arena_size, &arena_persist_size);
+
+  // Going back to the first sizes restores their plan, without reallocating
+  // the arena.
+  ResetAllocations();
+  for (int i = 0; i < 6; ++i) tensors[i].bytes /= 4;
+  Execute(0, graph.nodes().size() - 1);
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(GetOffset(i), small_offsets[i]) << "tensor " << i;
+  }
+  EXPECT_EQ(planner_->BasePointer(kTfLiteArenaRw), base_pointer);
+  size_t new_arena_size;
+  planner_->GetAllocInfo(&new_arena_size, &arena_persist_size);
+  EXPECT_EQ(new_arena_size, arena_size);
+}
+
 TEST_F(ArenaPlannerTest, SimpleGraphInputsPreserved) {
   TestGraph graph({0, 1},
                   {
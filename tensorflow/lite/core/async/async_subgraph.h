@@ -17,10 +17,12 @@ limitations under the License.
 
 #include <atomic>
 #include <map>
+#include <memory>
 #include <vector>
 
 #include "tensorflow/lite/core/async/async_kernel_internal.h"
 #include "tensorflow/lite/core/async/c/types.h"
+#include "tensorflow/lite/core/async/cpu_async_kernel.h"
 #include "tensorflow/lite/core/async/interop/c/types.h"
 #include "tensorflow/lite/core/c/c_api_types.h"
 #include "tensorflow/lite/core/c/common.h"
@@ -34,6 +36,9 @@ class AsyncSubgraphTestPeer;
 
 // AsyncSubgraph class manages to dispatch I/O information and
 // schedule executions to underlying delegate kernels.
+// When the subgraph is not fully delegated to a single backend with an async
+// kernel, it is executed by a CpuAsyncKernel instead, which runs the regular
+// kernels of the subgraph on host memory buffers.
 // TODO(b/191883048): Currently we require either `AllocateTensors` or
 // `EnsureTensorAllocation` called to ensure the backend kernels are prepared.
 // However, we don't need to allocate the CPU memory for input / output tensors.
@@ -151,7 +156,8 @@ class AsyncSubgraph {
   // Returns the opaque TfLiteContext of the subgraph.
   TfLiteOpaqueContext* opaque_context() const;
 
-  // Returns the async backend kernel that delegates the subgraph.
+  // Returns the async backend kernel that delegates the subgraph, or the
+  // CpuAsyncKernel that runs it.
   // NOTE: Since we assume only 1 backend will delegate the model, we cache
   // the async kernel instance. In theory, the subgraph should iterate through
   // execution plan to fetch the individual async kernels and operate
@@ -168,10 +174,13 @@ class AsyncSubgraph {
   std::map<TfLiteIoType, std::vector<const char*>> supported_buffer_types_;
   std::map<TfLiteIoType, std::vector<const char*>> supported_synchronizations_;
 
-  // Currently AsyncSubgraph only support fully delegated by 1 backend case.
-  // Not owned.
+  // The kernel of the backend that fully delegates the subgraph, or the one of
+  // `cpu_async_kernel_`. Not owned.
   mutable TfLiteAsyncKernel* async_kernel_ = nullptr;
   TfLiteOpaqueNode* opaque_node_ = nullptr;
+
+  // Set when no backend kernel executes the subgraph asynchronously.
+  std::unique_ptr<CpuAsyncKernel> cpu_async_kernel_;
 };
 
 }  // namespace async
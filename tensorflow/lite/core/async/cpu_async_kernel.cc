@@ -0,0 +1,313 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/async/cpu_async_kernel.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <mutex>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/core/async/c/types.h"
+#include "tensorflow/lite/core/async/interop/attribute_map_internal.h"
+#include "tensorflow/lite/core/async/interop/c/constants.h"
+#include "tensorflow/lite/core/async/interop/c/types.h"
+#include "tensorflow/lite/core/async/task_internal.h"
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/delegates/utils/async_type_helpers.h"
+#include "tensorflow/lite/delegates/utils/sync_fence.h"
+
+namespace tflite {
+namespace async {
+
+namespace {
+
+bool Contains(const std::vector<const char*>& names, const char* name) {
+  return std::any_of(names.begin(), names.end(), [name](const char* n) {
+    return std::strcmp(n, name) == 0;
+  });
+}
+
+}  // namespace
+
+CpuAsyncKernel::CpuAsyncKernel(Subgraph* subgraph)
+    : subgraph_(subgraph),
+      supported_buffer_types_({kTfLiteBufferTypeHostMemory}),
+      supported_input_synchronizations_(
+          {kTfLiteSyncTypeNoSyncObj, delegates::utils::kSyncTypeSyncFenceFd}),
+      supported_output_synchronizations_({kTfLiteSyncTypeNoSyncObj}) {}
+
+bool CpuAsyncKernel::GetIoType(int tensor_index, TfLiteIoType* io_type) const {
+  const std::vector<int>& inputs = subgraph_->inputs();
+  if (std::find(inputs.begin(), inputs.end(), tensor_index) != inputs.end()) {
+    *io_type = kTfLiteIoTypeInput;
+    return true;
+  }
+  const std::vector<int>& outputs = subgraph_->outputs();
+  if (std::find(outputs.begin(), outputs.end(), tensor_index) !=
+      outputs.end()) {
+    *io_type = kTfLiteIoTypeOutput;
+    return true;
+  }
+  return false;
+}
+
+TfLiteStatus CpuAsyncKernel::RegisterBuffer(TfLiteOpaqueContext* context,
+                                            TfLiteIoType io_type,
+                                            const TfLiteBackendBuffer* buffer,
+                                            const TfLiteAttributeMap* attrs,
+                                            TfLiteBufferHandle handle) {
+  const interop::AttributeMap& attr_map = attrs->impl;
+  const char* buffer_type = nullptr;
+  size_t size = 0;
+  if (!attr_map.GetAttr(kTfLiteBufferAttrKeyResourceTypeName, &buffer_type) ||
+      std::strcmp(buffer_type, kTfLiteBufferTypeHostMemory) != 0 ||
+      !attr_map.GetAttr(kTfLiteBufferAttrKeySize, &size)) {
+    subgraph_->ReportError("Expected a %s buffer with a size attribute.",
+                           kTfLiteBufferTypeHostMemory);
+    return kTfLiteError;
+  }
+  void* data = TfLiteBackendBufferGetPtr(buffer);
+  if (data == nullptr) {
+    subgraph_->ReportError("Buffer %d has no memory.", handle);
+    return kTfLiteError;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  buffers_[handle] = Buffer{static_cast<char*>(data), size};
+  return kTfLiteOk;
+}
+
+TfLiteStatus CpuAsyncKernel::RegisterBufferSlice(
+    TfLiteOpaqueContext* context, TfLiteBufferHandle buffer_pool,
+    const TfLiteAttributeMap* attrs, TfLiteBufferHandle handle) {
+  size_t offset = 0;
+  size_t size = 0;
+  attrs->impl.GetAttr(kTfLiteBufferAttrKeyOffset, &offset);
+  if (!attrs->impl.GetAttr(kTfLiteBufferAttrKeySize, &size)) {
+    subgraph_->ReportError("Buffer slices need a size attribute.");
+    return kTfLiteError;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto pool = buffers_.find(buffer_pool);
+  if (pool == buffers_.end()) {
+    subgraph_->ReportError("Unknown buffer %d.", buffer_pool);
+    return kTfLiteError;
+  }
+  if (offset > pool->second.size || size > pool->second.size - offset) {
+    subgraph_->ReportError("Slice [%zu, %zu) is out of buffer %d of %zu bytes.",
+                           offset, offset + size, buffer_pool,
+                           pool->second.size);
+    return kTfLiteError;
+  }
+  buffers_[handle] = Buffer{pool->second.data + offset, size};
+  return kTfLiteOk;
+}
+
+TfLiteStatus CpuAsyncKernel::UnregisterBuffer(TfLiteOpaqueContext* context,
+                                              TfLiteBufferHandle handle) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (buffers_.erase(handle) == 0) {
+    subgraph_->ReportError("Unknown buffer %d.", handle);
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+const std::vector<const char*>& CpuAsyncKernel::SupportedBufferTypes(
+    TfLiteIoType io_type) const {
+  return supported_buffer_types_;
+}
+
+const std::vector<const char*>& CpuAsyncKernel::SupportedSynchronizations(
+    TfLiteIoType io_type) const {
+  return io_type == kTfLiteIoTypeInput ? supported_input_synchronizations_
+                                       : supported_output_synchronizations_;
+}
+
+bool CpuAsyncKernel::ReconcileRestrictions(
+    const TfLiteOpaqueContext* context, const TfLiteOpaqueNode* node,
+    int tensor_index, const TfLiteAttributeMap* user_provided_attributes,
+    TfLiteAttributeMap* merged, TfLiteAttributeMap* conflict) const {
+  TfLiteIoType io_type;
+  if (!GetIoType(tensor_index, &io_type)) return false;
+  const interop::AttributeMap& user = user_provided_attributes->impl;
+  merged->impl = user;
+  bool ok = true;
+  if (user.IsBufferAttributeMap()) {
+    const char* buffer_type = kTfLiteBufferTypeHostMemory;
+    user.GetAttr(kTfLiteBufferAttrKeyResourceTypeName, &buffer_type);
+    if (!Contains(supported_buffer_types_, buffer_type)) {
+      ok = false;
+      if (conflict != nullptr) {
+        conflict->impl.SetAttr(kTfLiteBufferAttrKeyResourceTypeName,
+                               kTfLiteBufferTypeHostMemory);
+      }
+    }
+    merged->impl.SetAttr(kTfLiteBufferAttrKeyResourceTypeName,
+                         kTfLiteBufferTypeHostMemory);
+    size_t size = 0;
+    user.GetAttr(kTfLiteBufferAttrKeySize, &size);
+    merged->impl.SetAttr(
+        kTfLiteBufferAttrKeySize,
+        std::max(size, subgraph_->tensor(tensor_index)->bytes));
+  } else if (user.IsSyncAttributeMap()) {
+    const char* sync_type = kTfLiteSyncTypeNoSyncObj;
+    user.GetAttr(kTfLiteSynchronizationAttrKeyObjectTypeName, &sync_type);
+    if (!Contains(SupportedSynchronizations(io_type), sync_type)) {
+      ok = false;
+      sync_type = kTfLiteSyncTypeNoSyncObj;
+      if (conflict != nullptr) {
+        conflict->impl.SetAttr(kTfLiteSynchronizationAttrKeyObjectTypeName,
+                               sync_type);
+      }
+    }
+    merged->impl.SetAttr(kTfLiteSynchronizationAttrKeyObjectTypeName,
+                         sync_type);
+  } else {
+    return false;
+  }
+  return ok;
+}
+
+TfLiteStatus CpuAsyncKernel::SetAttributes(TfLiteOpaqueContext* context,
+                                           TfLiteOpaqueNode* node,
+                                           int tensor_index,
+                                           const TfLiteAttributeMap* attrs) {
+  TfLiteIoType io_type;
+  if (!GetIoType(tensor_index, &io_type)) {
+    subgraph_->ReportError("Tensor %d is not an input or output.",
+                           tensor_index);
+    return kTfLiteError;
+  }
+  const interop::AttributeMap& attr_map = attrs->impl;
+  if (attr_map.IsBufferAttributeMap()) {
+    const char* buffer_type = kTfLiteBufferTypeHostMemory;
+    attr_map.GetAttr(kTfLiteBufferAttrKeyResourceTypeName, &buffer_type);
+    size_t size = subgraph_->tensor(tensor_index)->bytes;
+    attr_map.GetAttr(kTfLiteBufferAttrKeySize, &size);
+    if (!Contains(supported_buffer_types_, buffer_type) ||
+        size < subgraph_->tensor(tensor_index)->bytes) {
+      subgraph_->ReportError("Unsupported buffer attributes for tensor %d.",
+                             tensor_index);
+      return kTfLiteError;
+    }
+    return kTfLiteOk;
+  }
+  if (attr_map.IsSyncAttributeMap()) {
+    const char* sync_type = kTfLiteSyncTypeNoSyncObj;
+    attr_map.GetAttr(kTfLiteSynchronizationAttrKeyObjectTypeName, &sync_type);
+    if (!Contains(SupportedSynchronizations(io_type), sync_type)) {
+      subgraph_->ReportError("Unsupported synchronization %s for tensor %d.",
+                             sync_type, tensor_index);
+      return kTfLiteError;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (std::strcmp(sync_type, delegates::utils::kSyncTypeSyncFenceFd) == 0) {
+      fenced_inputs_.insert(tensor_index);
+    } else {
+      fenced_inputs_.erase(tensor_index);
+    }
+    return kTfLiteOk;
+  }
+  return kTfLiteError;
+}
+
+TfLiteStatus CpuAsyncKernel::Prepare(TfLiteOpaqueContext* context,
+                                     TfLiteOpaqueNode* node) {
+  return kTfLiteOk;
+}
+
+TfLiteStatus CpuAsyncKernel::BindBuffers(TfLiteExecutionTask* task) {
+  // Tensors that are switched from the arena to a buffer have to be removed
+  // from the memory plan. Later tasks only move the data pointers.
+  bool needs_allocation = false;
+  auto bind = [&](int tensor_index) {
+    const TfLiteBufferHandle handle = task->task->GetBufferHandle(tensor_index);
+    if (handle == kTfLiteNullBufferHandle) {
+      if (bound_tensors_.count(tensor_index)) {
+        subgraph_->ReportError("Tensor %d needs a buffer.", tensor_index);
+        return kTfLiteError;
+      }
+      return kTfLiteOk;
+    }
+    auto buffer = buffers_.find(handle);
+    if (buffer == buffers_.end()) {
+      subgraph_->ReportError("Unknown buffer %d.", handle);
+      return kTfLiteError;
+    }
+    TfLiteTensor* tensor = subgraph_->tensor(tensor_index);
+    if (buffer->second.size < tensor->bytes) {
+      subgraph_->ReportError(
+          "Buffer %d of %zu bytes is too small for tensor %d of %zu bytes.",
+          handle, buffer->second.size, tensor_index, tensor->bytes);
+      return kTfLiteError;
+    }
+    if (tensor->allocation_type == kTfLiteCustom &&
+        tensor->data.raw == buffer->second.data) {
+      return kTfLiteOk;
+    }
+    needs_allocation |= tensor->allocation_type != kTfLiteCustom;
+    bound_tensors_.insert(tensor_index);
+    return subgraph_->SetCustomAllocationForTensor(
+        tensor_index,
+        TfLiteCustomAllocation{buffer->second.data, buffer->second.size},
+        kTfLiteCustomAllocationFlagsSkipAlignCheck);
+  };
+  for (int tensor_index : subgraph_->inputs()) {
+    TF_LITE_ENSURE_STATUS(bind(tensor_index));
+  }
+  for (int tensor_index : subgraph_->outputs()) {
+    TF_LITE_ENSURE_STATUS(bind(tensor_index));
+  }
+  return needs_allocation ? subgraph_->AllocateTensors() : kTfLiteOk;
+}
+
+TfLiteStatus CpuAsyncKernel::Eval(TfLiteOpaqueContext* context,
+                                  TfLiteOpaqueNode* node,
+                                  TfLiteExecutionTask* task) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<int> fences;
+  for (int tensor_index : fenced_inputs_) {
+    TfLiteSynchronization* sync = task->task->GetSynchronization(tensor_index);
+    if (sync == nullptr) continue;
+    const int* fence =
+        static_cast<const int*>(TfLiteSynchronizationGetPtr(sync));
+    if (fence != nullptr && *fence != -1) {
+      fences.push_back(*fence);
+    }
+  }
+  if (!fences.empty() && !delegates::utils::WaitForAllFds(fences)) {
+    subgraph_->ReportError("Failed to wait for the input fences.");
+    return kTfLiteError;
+  }
+  TF_LITE_ENSURE_STATUS(BindBuffers(task));
+  return subgraph_->Invoke();
+}
+
+TfLiteStatus CpuAsyncKernel::Wait(TfLiteOpaqueContext* context,
+                                  TfLiteExecutionTask* task) {
+  // The execution already finished in Eval.
+  return task->task->Status();
+}
+
+TfLiteStatus CpuAsyncKernel::Finish(TfLiteOpaqueContext* context,
+                                    TfLiteExecutionTask* task) {
+  return kTfLiteOk;
+}
+
+}  // namespace async
+}  // namespace tflite
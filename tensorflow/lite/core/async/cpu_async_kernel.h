@@ -0,0 +1,124 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_CORE_ASYNC_CPU_ASYNC_KERNEL_H_
+#define TENSORFLOW_LITE_CORE_ASYNC_CPU_ASYNC_KERNEL_H_
+
+#include <cstddef>
+#include <map>
+#include <mutex>  // NOLINT(build/c++11)
+#include <set>
+#include <vector>
+
+#include "tensorflow/lite/async/backend_async_kernel_interface.h"
+#include "tensorflow/lite/core/async/c/types.h"
+#include "tensorflow/lite/core/async/interop/c/types.h"
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/subgraph.h"
+
+namespace tflite {
+namespace async {
+
+// Async kernel that runs a whole subgraph with its regular kernels, i.e. the
+// CPU builtin kernels and whichever synchronous delegates (e.g. XNNPACK) were
+// applied to it. AsyncSubgraph uses it when the subgraph is not fully
+// delegated to a single backend that implements an async kernel.
+//
+// Buffers of type `kTfLiteBufferTypeHostMemory` are bound to the input and
+// output tensors of the subgraph as custom allocations, so the kernels read
+// and write them in place instead of copying to and from the arena.
+// Once a tensor has been bound to a buffer, every task must provide a buffer
+// for it.
+//
+// Input tensors accept `kTfLiteSyncTypeNoSyncObj` and sync fence fd
+// synchronizations; the fences are waited on before the subgraph runs. The
+// subgraph runs to completion within `Eval`, so outputs only support
+// `kTfLiteSyncTypeNoSyncObj` and `Wait` just returns the status of the run.
+//
+// The subgraph must have been allocated (AllocateTensors) before the first
+// task is scheduled. Executions of different tasks are serialized.
+class CpuAsyncKernel : public delegates::BackendAsyncKernelInterface {
+ public:
+  // `subgraph` is not owned and must outlive the kernel.
+  explicit CpuAsyncKernel(Subgraph* subgraph);
+
+  TfLiteStatus RegisterBuffer(TfLiteOpaqueContext* context,
+                              TfLiteIoType io_type,
+                              const TfLiteBackendBuffer* buffer,
+                              const TfLiteAttributeMap* attrs,
+                              TfLiteBufferHandle handle) override;
+  TfLiteStatus RegisterBufferSlice(TfLiteOpaqueContext* context,
+                                   TfLiteBufferHandle buffer_pool,
+                                   const TfLiteAttributeMap* attrs,
+                                   TfLiteBufferHandle handle) override;
+  TfLiteStatus UnregisterBuffer(TfLiteOpaqueContext* context,
+                                TfLiteBufferHandle handle) override;
+
+  const std::vector<const char*>& SupportedBufferTypes(
+      TfLiteIoType io_type) const override;
+  const std::vector<const char*>& SupportedSynchronizations(
+      TfLiteIoType io_type) const override;
+
+  bool ReconcileRestrictions(const TfLiteOpaqueContext* context,
+                             const TfLiteOpaqueNode* node, int tensor_index,
+                             const TfLiteAttributeMap* user_provided_attributes,
+                             TfLiteAttributeMap* merged,
+                             TfLiteAttributeMap* conflict) const override;
+  TfLiteStatus SetAttributes(TfLiteOpaqueContext* context,
+                             TfLiteOpaqueNode* node, int tensor_index,
+                             const TfLiteAttributeMap* attrs) override;
+  TfLiteStatus Prepare(TfLiteOpaqueContext* context,
+                       TfLiteOpaqueNode* node) override;
+
+  TfLiteStatus Eval(TfLiteOpaqueContext* context, TfLiteOpaqueNode* node,
+                    TfLiteExecutionTask* task) override;
+  TfLiteStatus Wait(TfLiteOpaqueContext* context,
+                    TfLiteExecutionTask* task) override;
+  TfLiteStatus Finish(TfLiteOpaqueContext* context,
+                      TfLiteExecutionTask* task) override;
+
+ private:
+  struct Buffer {
+    char* data;
+    size_t size;
+  };
+
+  // Returns the I/O type of the tensor, or false if it is neither an input
+  // nor an output of the subgraph.
+  bool GetIoType(int tensor_index, TfLiteIoType* io_type) const;
+
+  // Binds the buffers of `task` to the tensors of the subgraph.
+  TfLiteStatus BindBuffers(TfLiteExecutionTask* task);
+
+  // Not owned.
+  Subgraph* subgraph_;
+
+  std::vector<const char*> supported_buffer_types_;
+  std::vector<const char*> supported_input_synchronizations_;
+  std::vector<const char*> supported_output_synchronizations_;
+
+  // Guards all the members below, and serializes executions.
+  std::mutex mutex_;
+  std::map<TfLiteBufferHandle, Buffer> buffers_;
+  // Input tensors whose synchronizations are sync fence fds.
+  std::set<int> fenced_inputs_;
+  // Tensors that have been bound to a buffer.
+  std::set<int> bound_tensors_;
+};
+
+}  // namespace async
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_CORE_ASYNC_CPU_ASYNC_KERNEL_H_
@@ -0,0 +1,169 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/async/cpu_async_kernel.h"
+
+#include <stdlib.h>
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/async/async_subgraph.h"
+#include "tensorflow/lite/core/async/c/types.h"
+#include "tensorflow/lite/core/async/interop/attribute_map_internal.h"
+#include "tensorflow/lite/core/async/interop/c/constants.h"
+#include "tensorflow/lite/core/async/interop/c/types.h"
+#include "tensorflow/lite/core/async/task_internal.h"
+#include "tensorflow/lite/core/c/builtin_op_data.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/core/kernels/builtin_op_kernels.h"
+
+namespace tflite {
+namespace async {
+namespace {
+
+constexpr size_t kBufferSize = 3 * sizeof(float);
+
+// Runs output = input0 + input1 with the builtin ADD kernel.
+class CpuAsyncKernelTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    interpreter_ = std::make_unique<Interpreter>();
+    interpreter_->AddTensors(3);
+    interpreter_->SetInputs({0, 1});
+    interpreter_->SetOutputs({2});
+    TfLiteQuantizationParams quant;
+    for (int i = 0; i < 3; ++i) {
+      interpreter_->SetTensorParametersReadWrite(i, kTfLiteFloat32, "", {3},
+                                                 quant);
+    }
+    auto* params =
+        static_cast<TfLiteAddParams*>(malloc(sizeof(TfLiteAddParams)));
+    params->activation = kTfLiteActNone;
+    params->pot_scale_int16 = false;
+    interpreter_->AddNodeWithParameters({0, 1}, {2}, nullptr, 0, params,
+                                        ops::builtin::Register_ADD());
+    ASSERT_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+    subgraph_ = std::make_unique<AsyncSubgraph>(interpreter_->subgraph(0));
+  }
+
+  void TearDown() override {
+    for (TfLiteBackendBuffer* buffer : backend_buffers_) {
+      TfLiteBackendBufferDelete(buffer);
+    }
+  }
+
+  TfLiteBufferHandle Register(TfLiteIoType io_type, float* data) {
+    TfLiteBackendBuffer* buffer = TfLiteBackendBufferCreate();
+    backend_buffers_.push_back(buffer);
+    TfLiteBackendBufferSetPtr(buffer, data);
+    TfLiteAttributeMap attrs(kTfLiteAttrMapTypeBuffer);
+    attrs.impl.SetAttr(kTfLiteBufferAttrKeyResourceTypeName,
+                       kTfLiteBufferTypeHostMemory);
+    attrs.impl.SetAttr(kTfLiteBufferAttrKeySize, kBufferSize);
+    TfLiteBufferHandle handle = kTfLiteNullBufferHandle;
+    EXPECT_EQ(subgraph_->RegisterBuffer(io_type, buffer, &attrs, &handle),
+              kTfLiteOk);
+    return handle;
+  }
+
+  std::unique_ptr<Interpreter> interpreter_;
+  std::unique_ptr<AsyncSubgraph> subgraph_;
+  std::vector<TfLiteBackendBuffer*> backend_buffers_;
+};
+
+TEST_F(CpuAsyncKernelTest, SupportedTypes) {
+  ASSERT_EQ(subgraph_->SupportedBufferTypes(kTfLiteIoTypeInput).size(), 1);
+  EXPECT_STREQ(subgraph_->SupportedBufferTypes(kTfLiteIoTypeInput)[0],
+               kTfLiteBufferTypeHostMemory);
+  EXPECT_EQ(subgraph_->SupportedSynchronizations(kTfLiteIoTypeInput).size(), 2);
+  EXPECT_EQ(subgraph_->SupportedSynchronizations(kTfLiteIoTypeOutput).size(),
+            1);
+
+  TfLiteAttributeMap user(kTfLiteAttrMapTypeBuffer);
+  TfLiteAttributeMap merged(kTfLiteAttrMapTypeBuffer);
+  TfLiteAttributeMap conflict(kTfLiteAttrMapTypeBuffer);
+  EXPECT_TRUE(subgraph_->ReconcileRestrictions(0, &user, &merged, &conflict));
+  size_t size = 0;
+  ASSERT_TRUE(merged.impl.GetAttr(kTfLiteBufferAttrKeySize, &size));
+  EXPECT_EQ(size, kBufferSize);
+
+  user.impl.SetAttr(kTfLiteBufferAttrKeyResourceTypeName, "unknown");
+  EXPECT_FALSE(subgraph_->ReconcileRestrictions(0, &user, &merged, &conflict));
+  // Unknown tensors have no buffers.
+  EXPECT_FALSE(subgraph_->ReconcileRestrictions(3, &user, &merged, &conflict));
+}
+
+TEST_F(CpuAsyncKernelTest, InvokeInPlace) {
+  float input0[3] = {1, 2, 3};
+  float input1[3] = {10, 20, 30};
+  float output[2][3] = {};
+  const TfLiteBufferHandle input0_handle =
+      Register(kTfLiteIoTypeInput, input0);
+  const TfLiteBufferHandle input1_handle =
+      Register(kTfLiteIoTypeInput, input1);
+  const TfLiteBufferHandle output_handles[2] = {
+      Register(kTfLiteIoTypeOutput, output[0]),
+      Register(kTfLiteIoTypeOutput, output[1])};
+  ASSERT_EQ(subgraph_->Prepare(), kTfLiteOk);
+
+  for (int run = 0; run < 2; ++run) {
+    input1[0] = run;
+    TfLiteExecutionTask* task = subgraph_->CreateTask();
+    task->task->SetBufferHandle(0, input0_handle);
+    task->task->SetBufferHandle(1, input1_handle);
+    task->task->SetBufferHandle(2, output_handles[run]);
+    ASSERT_EQ(subgraph_->InvokeAsync(task), kTfLiteOk);
+    ASSERT_EQ(subgraph_->Wait(task), kTfLiteOk);
+    ASSERT_EQ(subgraph_->Finish(task), kTfLiteOk);
+
+    // The kernels read and wrote the buffers in place.
+    EXPECT_EQ(interpreter_->tensor(0)->data.f, input0);
+    EXPECT_EQ(interpreter_->tensor(2)->data.f, output[run]);
+    EXPECT_EQ(output[run][0], 1 + run);
+    EXPECT_EQ(output[run][1], 22);
+    EXPECT_EQ(output[run][2], 33);
+  }
+
+  // Once bound, tensors need a buffer in every task.
+  TfLiteExecutionTask* task = subgraph_->CreateTask();
+  task->task->SetBufferHandle(0, input0_handle);
+  task->task->SetBufferHandle(1, input1_handle);
+  EXPECT_EQ(subgraph_->InvokeAsync(task), kTfLiteError);
+  EXPECT_EQ(subgraph_->Wait(task), kTfLiteError);
+  ASSERT_EQ(subgraph_->Finish(task), kTfLiteOk);
+}
+
+TEST_F(CpuAsyncKernelTest, BufferSlices) {
+  float pool[3] = {};
+  const TfLiteBufferHandle pool_handle = Register(kTfLiteIoTypeOutput, pool);
+  // The pool is registered with the size of a single tensor.
+  TfLiteAttributeMap attrs(kTfLiteAttrMapTypeBuffer);
+  attrs.impl.SetAttr(kTfLiteBufferAttrKeyOffset, size_t{0});
+  attrs.impl.SetAttr(kTfLiteBufferAttrKeySize, kBufferSize);
+  TfLiteBufferHandle slice = kTfLiteNullBufferHandle;
+  EXPECT_EQ(subgraph_->RegisterBufferSlice(pool_handle, &attrs, &slice),
+            kTfLiteOk);
+  attrs.impl.SetAttr(kTfLiteBufferAttrKeyOffset, kBufferSize);
+  EXPECT_EQ(subgraph_->RegisterBufferSlice(pool_handle, &attrs, &slice),
+            kTfLiteError);
+  EXPECT_EQ(subgraph_->UnregisterBuffer(pool_handle), kTfLiteOk);
+  EXPECT_EQ(subgraph_->UnregisterBuffer(pool_handle), kTfLiteError);
+}
+
+}  // namespace
+}  // namespace async
+}  // namespace tflite
@@ -17,5 +17,6 @@ limitations under the License.
 extern "C" {
 
 const char kTfLiteSyncTypeNoSyncObj[] = "no_sync_obj";
+const char kTfLiteBufferTypeHostMemory[] = "host_memory";
 
 }  // extern "C"
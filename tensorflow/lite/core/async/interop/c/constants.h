@@ -38,6 +38,15 @@ extern "C" {
 /// output tensor must be ready when AsyncSignatureRunner::Wait returns.
 TFL_CAPI_EXPORT extern const char kTfLiteSyncTypeNoSyncObj[];  // "no_sync_obj"
 
+/// Buffer type name of plain host memory.
+///
+/// The TfLiteBackendBuffer holds a pointer to memory that the CPU can read and
+/// write directly, and the `kTfLiteBufferAttrKeySize` attribute of the buffer
+/// gives its size in bytes. The runtime does not take ownership of the memory,
+/// which must outlive the registration of the buffer.
+TFL_CAPI_EXPORT extern const char
+    kTfLiteBufferTypeHostMemory[];  // "host_memory"
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
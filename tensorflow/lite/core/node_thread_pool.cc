@@ -0,0 +1,113 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/node_thread_pool.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+
+#include "tensorflow/lite/external_cpu_backend_context.h"
+
+namespace tflite {
+namespace {
+
+// The CPU backend context of the pool thread running on this thread, if any.
+thread_local ExternalCpuBackendContext* current_cpu_backend_context = nullptr;
+
+}  // namespace
+
+NodeThreadPool::NodeThreadPool(int num_threads) {
+  cpu_backend_contexts_.reserve(num_threads);
+  threads_.reserve(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    cpu_backend_contexts_.push_back(
+        std::make_unique<ExternalCpuBackendContext>());
+    threads_.emplace_back(&NodeThreadPool::WorkerLoop, this,
+                          cpu_backend_contexts_.back().get());
+  }
+}
+
+NodeThreadPool::~NodeThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  work_available_.notify_all();
+  for (std::thread& thread : threads_) {
+    thread.join();
+  }
+}
+
+void NodeThreadPool::Run(int num_tasks, const std::function<void(int)>& task) {
+  if (num_tasks <= 0) return;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = &task;
+    num_tasks_ = num_tasks;
+    next_task_ = 0;
+    num_tasks_done_ = 0;
+    ++generation_;
+  }
+  work_available_.notify_all();
+  RunTasks();
+  std::unique_lock<std::mutex> lock(mutex_);
+  work_done_.wait(lock, [this] { return num_tasks_done_ == num_tasks_; });
+  task_ = nullptr;
+}
+
+ExternalCpuBackendContext* NodeThreadPool::CurrentThreadCpuBackendContext() {
+  return current_cpu_backend_context;
+}
+
+void NodeThreadPool::WorkerLoop(
+    ExternalCpuBackendContext* cpu_backend_context) {
+  current_cpu_backend_context = cpu_backend_context;
+  int64_t last_generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_available_.wait(lock, [this, last_generation] {
+        return stopping_ || generation_ != last_generation;
+      });
+      if (stopping_) return;
+      last_generation = generation_;
+    }
+    RunTasks();
+  }
+}
+
+void NodeThreadPool::RunTasks() {
+  while (true) {
+    int task_index;
+    const std::function<void(int)>* task;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (next_task_ >= num_tasks_) return;
+      task_index = next_task_++;
+      task = task_;
+    }
+    (*task)(task_index);
+    bool all_done;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      all_done = ++num_tasks_done_ == num_tasks_;
+    }
+    if (all_done) work_done_.notify_one();
+  }
+}
+
+}  // namespace tflite
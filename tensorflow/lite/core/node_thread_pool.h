@@ -0,0 +1,86 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_CORE_NODE_THREAD_POOL_H_
+#define TENSORFLOW_LITE_CORE_NODE_THREAD_POOL_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/external_cpu_backend_context.h"
+
+namespace tflite {
+
+// A fixed set of threads that, together with the calling thread, invokes the
+// nodes of a parallel execution stage of a subgraph.
+//
+// Kernels get their CPU backend context (and with it the ruy and gemmlowp
+// contexts) from the TfLiteContext, and these contexts must not be used by two
+// threads at once. Each thread of the pool therefore owns an
+// ExternalCpuBackendContext, which the subgraph hands out instead of its own
+// while a node runs on that thread. The contexts are initialized lazily by the
+// kernels, with the number of threads of the interpreter at that time.
+//
+// WARNING: This is an experimental API and subject to change.
+class NodeThreadPool {
+ public:
+  // Creates `num_threads` threads in addition to the calling thread.
+  explicit NodeThreadPool(int num_threads);
+  ~NodeThreadPool();
+
+  NodeThreadPool(const NodeThreadPool&) = delete;
+  NodeThreadPool& operator=(const NodeThreadPool&) = delete;
+
+  int num_threads() const { return static_cast<int>(threads_.size()); }
+
+  // Calls `task(i)` for every i in [0, num_tasks) on the threads of the pool
+  // and the calling thread, and returns once all the calls have returned.
+  // Must not be called concurrently.
+  void Run(int num_tasks, const std::function<void(int)>& task);
+
+  // Returns the CPU backend context owned by the calling thread if it is a
+  // thread of a NodeThreadPool, and nullptr otherwise.
+  static ExternalCpuBackendContext* CurrentThreadCpuBackendContext();
+
+ private:
+  void WorkerLoop(ExternalCpuBackendContext* cpu_backend_context);
+
+  // Claims and runs tasks of the current Run call until none are left.
+  void RunTasks();
+
+  std::vector<std::unique_ptr<ExternalCpuBackendContext>>
+      cpu_backend_contexts_;
+  std::vector<std::thread> threads_;
+
+  std::mutex mutex_;
+  std::condition_variable work_available_;
+  std::condition_variable work_done_;
+  // Incremented by every Run call, so that workers can tell a new call from
+  // the one they already worked on.
+  int64_t generation_ = 0;
+  bool stopping_ = false;
+  const std::function<void(int)>* task_ = nullptr;
+  int num_tasks_ = 0;
+  int next_task_ = 0;
+  int num_tasks_done_ = 0;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_CORE_NODE_THREAD_POOL_H_
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/lite/core/signature_runner.h"
 
+#include <algorithm>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/lite/core/c/c_api_types.h"
@@ -50,9 +52,36 @@ const TfLiteTensor* SignatureRunner::output_tensor(
     subgraph_->ReportError("Output name %s was not found", output_name);
     return nullptr;
   }
+  if (outputs_pruned_) {
+    const std::vector<int>& outputs = subgraph_->outputs();
+    if (std::find(outputs.begin(), outputs.end(), it->second) ==
+        outputs.end()) {
+      subgraph_->ReportError("Output %s was pruned", output_name);
+      return nullptr;
+    }
+  }
   return subgraph_->tensor(it->second);
 }
 
+TfLiteStatus SignatureRunner::PruneToOutputs(
+    const std::vector<const char*>& output_names) {
+  std::vector<int> outputs;
+  std::vector<const char*> kept_output_names;
+  for (const char* output_name : output_names) {
+    const auto& it = signature_def_->outputs.find(output_name);
+    if (it == signature_def_->outputs.end()) {
+      subgraph_->ReportError("Output name %s was not found", output_name);
+      return kTfLiteError;
+    }
+    outputs.push_back(it->second);
+    kept_output_names.push_back(it->first.c_str());
+  }
+  TF_LITE_ENSURE_STATUS(subgraph_->PruneToOutputs(std::move(outputs)));
+  output_names_ = std::move(kept_output_names);
+  outputs_pruned_ = true;
+  return kTfLiteOk;
+}
+
 TfLiteStatus SignatureRunner::ResizeInputTensor(
     const char* input_name, const std::vector<int>& new_size) {
   const auto& it = signature_def_->inputs.find(input_name);
@@ -139,6 +139,18 @@ class SignatureRunner {
   TfLiteStatus ResizeInputTensorStrict(const char* input_name,
                                        const std::vector<int>& new_size);
 
+  /// \brief Restricts the signature to the outputs in `output_names`, e.g. to
+  /// run only the encoder of a multi-head model. The nodes that only compute
+  /// the other outputs are neither prepared, allocated nor invoked, which
+  /// lowers the memory and the latency of the signature. The other outputs
+  /// are no longer available: `output_tensor` returns nullptr for them.
+  ///
+  /// Must be called before AllocateTensors(). Each signature has its own
+  /// subgraph and memory arena, so other signatures are not affected, unless
+  /// they share the subgraph of this one.
+  /// \warning This is an experimental API and subject to change. \n
+  TfLiteStatus PruneToOutputs(const std::vector<const char*>& output_names);
+
   /// Updates allocations for all tensors, related to the given signature.
   TfLiteStatus AllocateTensors() { return subgraph_->AllocateTensors(); }
 
@@ -236,6 +248,8 @@ class SignatureRunner {
   std::vector<const char*> input_names_;
   // The list of output tensor names.
   std::vector<const char*> output_names_;
+  // Whether some outputs were pruned by PruneToOutputs().
+  bool outputs_pruned_ = false;
 
   bool allow_buffer_handle_output_ = false;
 };
@@ -23,7 +23,9 @@ limitations under the License.
 #include <cstdlib>
 #include <cstring>
 #include <iterator>
+#include <map>
 #include <memory>
+#include <numeric>
 #include <string>
 #include <unordered_set>
 #include <utility>
@@ -39,7 +41,9 @@ limitations under the License.
 #include "tensorflow/lite/core/api/tensor_utils.h"
 #include "tensorflow/lite/core/c/c_api_types.h"
 #include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/node_thread_pool.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
 #include "tensorflow/lite/graph_info.h"
 #include "tensorflow/lite/memory_planner.h"
 #include "tensorflow/lite/minimal_logging.h"
@@ -241,6 +245,14 @@ class InterpreterInfo : public GraphInfo {
     return subgraph_->variables();
   }
 
+  size_t first_concurrent_node(size_t index) const override {
+    return subgraph_->FirstConcurrentNode(index);
+  }
+
+  size_t last_concurrent_node(size_t index) const override {
+    return subgraph_->LastConcurrentNode(index);
+  }
+
  public:
   Subgraph* subgraph_;
 };
@@ -615,6 +627,14 @@ TfLiteStatus Subgraph::ReplaceNodeSubsetsWithDelegateKernels(
 
 TfLiteExternalContext* Subgraph::GetExternalContext(
     TfLiteExternalContextType type) {
+  // Nodes invoked concurrently by the threads of a NodeThreadPool each use the
+  // CPU backend context of their thread.
+  if (type == kTfLiteCpuBackendContext) {
+    if (ExternalCpuBackendContext* cpu_backend_context =
+            NodeThreadPool::CurrentThreadCpuBackendContext()) {
+      return cpu_backend_context;
+    }
+  }
   if (static_cast<int>(type) >= 0 && type < kTfLiteMaxExternalContexts) {
     return external_contexts_[type];
   }
@@ -830,6 +850,23 @@ TfLiteStatus Subgraph::SetOutputs(std::vector<int> outputs) {
   return kTfLiteOk;
 }
 
+TfLiteStatus Subgraph::PruneToOutputs(std::vector<int> outputs) {
+  TF_LITE_ENSURE_OK(
+      &context_, CheckTensorIndices("outputs", outputs.data(), outputs.size()));
+  if (memory_planner_) {
+    ReportError("PruneToOutputs must be called before AllocateTensors.");
+    return kTfLiteError;
+  }
+  execution_plan_ = GetNodesNeededForOutputs(execution_plan_, outputs);
+  // Keeps the nodes pruned if the delegates are undone.
+  if (!pre_delegation_execution_plan_.empty()) {
+    pre_delegation_execution_plan_ =
+        GetNodesNeededForOutputs(pre_delegation_execution_plan_, outputs);
+  }
+  outputs_ = std::move(outputs);
+  return kTfLiteOk;
+}
+
 TfLiteStatus Subgraph::SetVariables(std::vector<int> variables) {
   TF_LITE_ENSURE_OK(&context_, CheckTensorIndices("variables", variables.data(),
                                                   variables.size()));
@@ -1021,6 +1058,8 @@ TfLiteStatus Subgraph::AllocateTensors() {
   // index that uses the tensor.
   InitializeTensorReleaseMap();
 
+  PlanWeightStreaming();
+
   // Temporary tensors allocated during Prepare for nodes which are subsequently
   // delegated are not required and can be freed.
   if (!pre_delegation_execution_plan_.empty()) {
@@ -1518,12 +1557,23 @@ TfLiteStatus Subgraph::PrepareOpsAndTensors() {
   next_execution_plan_index_to_prepare_ = last_exec_plan_index_prepared + 1;
 
   if (!memory_planner_) {
+    // Nodes can only be reordered once they have all been prepared.
+    if (last_exec_plan_index_prepared + 1 ==
+        static_cast<int>(execution_plan_.size())) {
+      ScheduleParallelStages();
+    }
 #ifdef TFLITE_USE_SIMPLE_MEMORY_PLANNER
     memory_planner_.reset(new SimplePlanner(&context_, CreateGraphInfo()));
 #else
-    memory_planner_ = std::make_unique<ArenaPlanner>(
+    auto arena_planner = std::make_unique<ArenaPlanner>(
         &context_, CreateGraphInfo(), ShouldPreserveAllTensors(),
         kDefaultTensorAlignment, subgraph_index_);
+    // Only the primary subgraph shares its arena, since the subgraphs of
+    // control flow ops run while the memory of their caller is live.
+    if (subgraph_index_ == 0 && options_ && options_->GetSharedArenaBuffer()) {
+      arena_planner->SetSharedArenaBuffer(options_->GetSharedArenaBuffer());
+    }
+    memory_planner_ = std::move(arena_planner);
 #endif
     memory_planner_->PlanAllocations();
   }
@@ -1577,6 +1627,335 @@ TfLiteStatus Subgraph::RemoveUnusedInputs() {
   return kTfLiteOk;
 }
 
+TfLiteStatus Subgraph::EnsureNodeInputsAreReadable(
+    const TfLiteNode& node, const TfLiteRegistration& registration) {
+  for (int i = 0; i < node.inputs->size; ++i) {
+    int tensor_index = node.inputs->data[i];
+    if (tensor_index == kTfLiteOptionalTensor) {
+      continue;
+    }
+    TfLiteTensor* tensor = &tensors_[tensor_index];
+    if (tensor->delegate && tensor->delegate != node.delegate &&
+        tensor->data_is_stale) {
+      TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
+    }
+    if (tensor->data.raw == nullptr && tensor->bytes > 0) {
+      if (registration.builtin_code == kTfLiteBuiltinReshape && i == 1 &&
+          tensor->dims->size != 1) {
+        // In general, having a tensor here with no buffer will be an error.
+        // However, for the reshape operator, the second input tensor is
+        // sometimes only used for the shape, not for the data. Thus, null
+        // buffer is ok in this situation.
+        // The situation where null buffer is not ok for reshape operator is
+        // only when there are 2 inputs given to the node and the one
+        // corresponding to the shape (i == 1) is a vector that contains all
+        // dimensions. See `GetOutputShape()` function in
+        // `tensorflow/lite/kernels/reshape.cc`
+        continue;
+      } else {
+        // In all other cases, we need to return an error as otherwise we will
+        // trigger a null pointer dereference (likely).
+        ReportError("Input tensor %d lacks data", tensor_index);
+        return kTfLiteError;
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
+int Subgraph::MaxNumParallelNodes() const {
+  return options_ ? options_->GetMaxNumParallelNodes() : 1;
+}
+
+int Subgraph::WeightStreamingWindow() const {
+  if (!options_ || options_->GetWeightStreamingWindow() < 1) return 0;
+  if (!allocation_ || allocation_->type() != Allocation::Type::kMMap) {
+    return 0;
+  }
+  return options_->GetWeightStreamingWindow();
+}
+
+void Subgraph::PlanWeightStreaming() {
+  weights_used_by_node_.clear();
+  weights_last_used_by_node_.clear();
+  if (WeightStreamingWindow() == 0) return;
+  const char* model_begin = static_cast<const char*>(allocation_->base());
+  const char* model_end = model_begin + allocation_->bytes();
+
+  weights_used_by_node_.resize(execution_plan_.size());
+  weights_last_used_by_node_.resize(execution_plan_.size());
+  // Tensors may share a buffer of the model, so weights are identified by
+  // their data.
+  std::map<const void*, int> last_use;
+  for (int i = 0; i < execution_plan_.size(); ++i) {
+    const TfLiteNode& node =
+        nodes_and_registration_[execution_plan_[i]].first;
+    for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      const TfLiteTensor& tensor = tensors_[tensor_index];
+      if (tensor.allocation_type != kTfLiteMmapRo || tensor.bytes == 0 ||
+          tensor.data.raw_const < model_begin ||
+          tensor.data.raw_const + tensor.bytes > model_end) {
+        continue;
+      }
+      weights_used_by_node_[i].push_back({tensor.data.raw_const, tensor.bytes});
+      last_use[tensor.data.raw_const] = i;
+    }
+  }
+  for (int i = 0; i < execution_plan_.size(); ++i) {
+    for (const StreamedWeights& weights : weights_used_by_node_[i]) {
+      auto it = last_use.find(weights.data);
+      if (it != last_use.end() && it->second == i) {
+        weights_last_used_by_node_[i].push_back(weights);
+        last_use.erase(it);
+      }
+    }
+  }
+  // Drops the pages that were touched while preparing the nodes.
+  ReleaseWeights(0, execution_plan_.size());
+}
+
+void Subgraph::PrefetchWeights(int end, int* next_execution_plan_index) const {
+  end = std::min<int>(end, weights_used_by_node_.size());
+  const auto* allocation = static_cast<const MMAPAllocation*>(allocation_);
+  for (; *next_execution_plan_index < end; ++*next_execution_plan_index) {
+    for (const StreamedWeights& weights :
+         weights_used_by_node_[*next_execution_plan_index]) {
+      allocation->Prefetch(weights.data, weights.bytes);
+    }
+  }
+}
+
+void Subgraph::ReleaseWeights(int begin, int end) const {
+  const auto* allocation = static_cast<const MMAPAllocation*>(allocation_);
+  for (int i = begin; i < end && i < weights_last_used_by_node_.size(); ++i) {
+    for (const StreamedWeights& weights : weights_last_used_by_node_[i]) {
+      allocation->Release(weights.data, weights.bytes);
+    }
+  }
+}
+
+int Subgraph::FirstConcurrentNode(int execution_plan_index) const {
+  if (execution_plan_index < 0 ||
+      execution_plan_index >= static_cast<int>(parallel_stage_begin_.size())) {
+    return execution_plan_index;
+  }
+  return parallel_stage_begin_[execution_plan_index];
+}
+
+int Subgraph::LastConcurrentNode(int execution_plan_index) const {
+  if (execution_plan_index < 0 ||
+      execution_plan_index >= static_cast<int>(parallel_stage_end_.size())) {
+    return execution_plan_index;
+  }
+  return parallel_stage_end_[execution_plan_index] - 1;
+}
+
+bool Subgraph::MustInvokeAlone(const TfLiteNode& node,
+                               const TfLiteRegistration& registration) const {
+  // Delegate kernels manage their own threads, custom ops may keep state that
+  // is shared between nodes, and control flow ops invoke other subgraphs.
+  if (node.delegate != nullptr ||
+      registration.builtin_code == kTfLiteBuiltinCustom ||
+      registration.builtin_code == kTfLiteBuiltinIf ||
+      registration.builtin_code == kTfLiteBuiltinWhile ||
+      registration.builtin_code == kTfLiteBuiltinCallOnce ||
+      registration.builtin_code == kTfLiteBuiltinStablehloWhile) {
+    return true;
+  }
+  if (node.outputs->size == 0) {
+    return true;
+  }
+  // Variable, resource and variant tensors are read and written by different
+  // nodes, in execution plan order.
+  auto is_stateful = [this](const TfLiteIntArray* tensor_indices) {
+    for (int i = 0; i < tensor_indices->size; ++i) {
+      const int tensor_index = tensor_indices->data[i];
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      const TfLiteTensor& tensor = tensors_[tensor_index];
+      if (tensor.is_variable || tensor.type == kTfLiteResource ||
+          tensor.type == kTfLiteVariant) {
+        return true;
+      }
+    }
+    return false;
+  };
+  return is_stateful(node.inputs) || is_stateful(node.outputs);
+}
+
+void Subgraph::ScheduleParallelStages() {
+  parallel_execution_plan_.clear();
+  parallel_stage_begin_.clear();
+  parallel_stage_end_.clear();
+  const int max_parallel_nodes = MaxNumParallelNodes();
+  if (max_parallel_nodes < 2) {
+    return;
+  }
+
+  // The level of a node is one more than the highest level of the nodes it
+  // depends on, through its inputs or through control edges. A node that must
+  // be invoked alone gets a level above all the nodes before it, and all the
+  // nodes after it get a level above its own.
+  const int num_nodes = execution_plan_.size();
+  std::vector<std::vector<int>> control_dependencies;
+  if (control_edges_ != nullptr) {
+    control_dependencies.resize(nodes_and_registration_.size());
+    for (const ControlEdge& edge : *control_edges_) {
+      if (edge.second >= 0 &&
+          edge.second < static_cast<int>(control_dependencies.size())) {
+        control_dependencies[edge.second].push_back(edge.first);
+      }
+    }
+  }
+  std::vector<int> tensor_levels(tensors_.size(), -1);
+  std::vector<int> node_levels(nodes_and_registration_.size(), -1);
+  std::vector<int> levels(num_nodes);
+  int max_level = -1;
+  int min_level = 0;
+  for (int i = 0; i < num_nodes; ++i) {
+    const int node_index = execution_plan_[i];
+    const TfLiteNode& node = nodes_and_registration_[node_index].first;
+    const TfLiteRegistration& registration =
+        nodes_and_registration_[node_index].second;
+    int level = min_level;
+    if (MustInvokeAlone(node, registration)) {
+      level = max_level + 1;
+      min_level = level + 1;
+    } else {
+      for (int j = 0; j < node.inputs->size; ++j) {
+        const int tensor_index = node.inputs->data[j];
+        if (tensor_index == kTfLiteOptionalTensor) continue;
+        level = std::max(level, tensor_levels[tensor_index] + 1);
+      }
+      if (!control_dependencies.empty()) {
+        for (int dependency : control_dependencies[node_index]) {
+          if (dependency >= 0 &&
+              dependency < static_cast<int>(node_levels.size())) {
+            level = std::max(level, node_levels[dependency] + 1);
+          }
+        }
+      }
+    }
+    for (int j = 0; j < node.outputs->size; ++j) {
+      const int tensor_index = node.outputs->data[j];
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      tensor_levels[tensor_index] = level;
+    }
+    node_levels[node_index] = level;
+    levels[i] = level;
+    max_level = std::max(max_level, level);
+  }
+
+  // Nodes are ordered by level, keeping the order of the execution plan within
+  // a level, and each level is split into stages of at most
+  // `max_parallel_nodes` nodes.
+  std::vector<int> order(num_nodes);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&levels](int a, int b) { return levels[a] < levels[b]; });
+  std::vector<int> plan(num_nodes);
+  std::vector<int> stage_begin(num_nodes);
+  std::vector<int> stage_end(num_nodes);
+  bool has_parallel_stage = false;
+  for (int begin = 0; begin < num_nodes;) {
+    int end = begin + 1;
+    while (end < num_nodes && end - begin < max_parallel_nodes &&
+           levels[order[end]] == levels[order[begin]]) {
+      ++end;
+    }
+    for (int i = begin; i < end; ++i) {
+      plan[i] = execution_plan_[order[i]];
+      stage_begin[i] = begin;
+      stage_end[i] = end;
+    }
+    has_parallel_stage |= end - begin > 1;
+    begin = end;
+  }
+  if (!has_parallel_stage) {
+    return;
+  }
+
+  execution_plan_ = plan;
+  parallel_execution_plan_ = std::move(plan);
+  parallel_stage_begin_ = std::move(stage_begin);
+  parallel_stage_end_ = std::move(stage_end);
+  if (node_thread_pool_ == nullptr ||
+      node_thread_pool_->num_threads() != max_parallel_nodes - 1) {
+    node_thread_pool_ =
+        std::make_unique<NodeThreadPool>(max_parallel_nodes - 1);
+  }
+}
+
+bool Subgraph::CanInvokeInParallel() const {
+  // Dynamic tensors require preparing the nodes that follow them between
+  // invocations, and profilers record one operator at a time.
+  return node_thread_pool_ != nullptr && !parallel_execution_plan_.empty() &&
+         !has_dynamic_tensors_ && profiler_ == nullptr &&
+         next_execution_plan_index_to_prepare_ == execution_plan_.size() &&
+         parallel_execution_plan_ == execution_plan_;
+}
+
+TfLiteStatus Subgraph::InvokeParallelStage(int first_execution_plan_index,
+                                           int end_execution_plan_index) {
+  for (int i = first_execution_plan_index; i < end_execution_plan_index; ++i) {
+    TfLiteNode& node = nodes_and_registration_[execution_plan_[i]].first;
+    const TfLiteRegistration& registration =
+        nodes_and_registration_[execution_plan_[i]].second;
+    TF_LITE_ENSURE_STATUS(EnsureNodeInputsAreReadable(node, registration));
+    MayAllocateOpOutput(&node);
+  }
+
+  if (check_cancelled_func_ != nullptr &&
+      check_cancelled_func_(cancellation_data_)) {
+    ReportError("Client requested cancel during Invoke()");
+    return kTfLiteError;
+  }
+
+  if (continue_invocation_ && !continue_invocation_->test_and_set()) {
+    // `Cancel` is called and cancellation flag is flipped.
+    ReportError("Client requested cancel during Invoke()");
+    return kTfLiteCancelled;
+  }
+
+  EnsureTensorsVectorCapacity();
+  tensor_resized_since_op_invoke_ = false;
+  const int num_nodes = end_execution_plan_index - first_execution_plan_index;
+  std::vector<TfLiteStatus> statuses(num_nodes, kTfLiteOk);
+  node_thread_pool_->Run(num_nodes, [&](int i) {
+    const int node_index = execution_plan_[first_execution_plan_index + i];
+    TfLiteNode& node = nodes_and_registration_[node_index].first;
+    const TfLiteRegistration& registration =
+        nodes_and_registration_[node_index].second;
+#ifdef TF_LITE_TENSORFLOW_PROFILER
+    tensorflow::profiler::TraceMe* trace_op = tflite::OnTfLiteOpInvoke(
+        GetTFLiteOpName(registration), subgraph_index_, node_index);
+#endif  // TF_LITE_TENSORFLOW_PROFILER
+    statuses[i] = OpInvoke(registration, &node);
+#ifdef TF_LITE_TENSORFLOW_PROFILER
+    tflite::OnTfLiteOpInvokeEnd(trace_op);
+#endif  // TF_LITE_TENSORFLOW_PROFILER
+  });
+
+  for (int i = 0; i < num_nodes; ++i) {
+    const int node_index = execution_plan_[first_execution_plan_index + i];
+    const TfLiteNode& node = nodes_and_registration_[node_index].first;
+    if (statuses[i] != kTfLiteOk) {
+      auto err = ReportOpError(&context_, node,
+                               nodes_and_registration_[node_index].second,
+                               node_index, "failed to invoke");
+      return statuses[i] == kTfLiteCancelled ? statuses[i] : err;
+    }
+  }
+  // Release dynamic tensor memory if configured by the user, once no node of
+  // the stage uses it anymore.
+  for (int i = 0; i < num_nodes; ++i) {
+    const int node_index = execution_plan_[first_execution_plan_index + i];
+    MaybeReleaseDynamicTensors(nodes_and_registration_[node_index].first,
+                               node_index);
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus Subgraph::Invoke() {
   auto status = InvokeImpl();
   telemetry::TelemetryReportEvent(&context_, "Invoke", status);
@@ -1602,10 +1981,19 @@ TfLiteStatus Subgraph::InvokeImpl() {
       tflite::OnTfLiteSubgraphInvoke(name_.c_str(), subgraph_index_);
 #endif  // TF_LITE_TENSORFLOW_PROFILER
 
-  // Invocations are always done in node order.
+  // Invocations are always done in node order, except that the nodes of a
+  // parallel execution stage may be invoked concurrently.
   // Note that calling Invoke repeatedly will cause the original memory plan to
   // be reused, unless either ResizeInputTensor() or AllocateTensors() has been
   // called.
+  const bool parallel_stages = CanInvokeInParallel();
+  // When weights are streamed, the weights of the next nodes are read ahead
+  // while a node runs, and dropped after their last use.
+  const bool stream_weights =
+      weights_used_by_node_.size() == execution_plan_.size() &&
+      !weights_used_by_node_.empty();
+  const int weight_streaming_window = WeightStreamingWindow();
+  int next_execution_plan_index_to_prefetch = 0;
   for (int execution_plan_index = 0;
        execution_plan_index < execution_plan_.size(); execution_plan_index++) {
     if (execution_plan_index == next_execution_plan_index_to_prepare_) {
@@ -1613,6 +2001,23 @@ TfLiteStatus Subgraph::InvokeImpl() {
       TF_LITE_ENSURE(&context_, next_execution_plan_index_to_prepare_ >=
                                     execution_plan_index);
     }
+    if (parallel_stages && parallel_stage_end_[execution_plan_index] >
+                               execution_plan_index + 1) {
+      const int stage_end = parallel_stage_end_[execution_plan_index];
+      if (stream_weights) {
+        PrefetchWeights(stage_end + weight_streaming_window,
+                        &next_execution_plan_index_to_prefetch);
+      }
+      TF_LITE_ENSURE_STATUS(
+          InvokeParallelStage(execution_plan_index, stage_end));
+      if (stream_weights) ReleaseWeights(execution_plan_index, stage_end);
+      execution_plan_index = stage_end - 1;
+      continue;
+    }
+    if (stream_weights) {
+      PrefetchWeights(execution_plan_index + 1 + weight_streaming_window,
+                      &next_execution_plan_index_to_prefetch);
+    }
     int node_index = execution_plan_[execution_plan_index];
     TfLiteNode& node = nodes_and_registration_[node_index].first;
     const TfLiteRegistration& registration =
@@ -1636,37 +2041,7 @@ TfLiteStatus Subgraph::InvokeImpl() {
     TFLITE_SCOPED_TAGGED_OPERATOR_PROFILE(
         profile_op ? profiler_.get() : nullptr, op_name, node_index);
 
-    for (int i = 0; i < node.inputs->size; ++i) {
-      int tensor_index = node.inputs->data[i];
-      if (tensor_index == kTfLiteOptionalTensor) {
-        continue;
-      }
-      TfLiteTensor* tensor = &tensors_[tensor_index];
-      if (tensor->delegate && tensor->delegate != node.delegate &&
-          tensor->data_is_stale) {
-        TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
-      }
-      if (tensor->data.raw == nullptr && tensor->bytes > 0) {
-        if (registration.builtin_code == kTfLiteBuiltinReshape && i == 1 &&
-            tensor->dims->size != 1) {
-          // In general, having a tensor here with no buffer will be an error.
-          // However, for the reshape operator, the second input tensor is
-          // sometimes only used for the shape, not for the data. Thus, null
-          // buffer is ok in this situation.
-          // The situation where null buffer is not ok for reshape operator is
-          // only when there are 2 inputs given to the node and the one
-          // corresponding to the shape (i == 1) is a vector that contains all
-          // dimensions. See `GetOutputShape()` function in
-          // `tensorflow/lite/kernels/reshape.cc`
-          continue;
-        } else {
-          // In all other cases, we need to return an error as otherwise we will
-          // trigger a null pointer dereference (likely).
-          ReportError("Input tensor %d lacks data", tensor_index);
-          return kTfLiteError;
-        }
-      }
-    }
+    TF_LITE_ENSURE_STATUS(EnsureNodeInputsAreReadable(node, registration));
     // Allocate dynamic tensors which memory is required to be allocated
     // before executing the node.
     MayAllocateOpOutput(&node);
@@ -1712,6 +2087,9 @@ TfLiteStatus Subgraph::InvokeImpl() {
     }
     // Release dynamic tensor memory if configured by the user.
     MaybeReleaseDynamicTensors(node, node_index);
+    if (stream_weights) {
+      ReleaseWeights(execution_plan_index, execution_plan_index + 1);
+    }
 
 #ifdef TF_LITE_TENSORFLOW_PROFILER
     tflite::OnTfLiteOpInvokeEnd(trace_op);
@@ -1958,6 +2336,55 @@ TfLiteStatus Subgraph::SetExecutionPlan(const std::vector<int>& new_plan) {
   return kTfLiteOk;
 }
 
+std::vector<int> Subgraph::GetNodesNeededForOutputs(
+    const std::vector<int>& plan, const std::vector<int>& outputs) const {
+  std::vector<bool> is_needed(tensors_.size(), false);
+  for (int tensor_index : outputs) {
+    if (tensor_index != kTfLiteOptionalTensor) is_needed[tensor_index] = true;
+  }
+  const auto has_side_effects = [this](const TfLiteNode& node,
+                                       const TfLiteRegistration& registration) {
+    if (node.outputs->size == 0) return true;
+    switch (registration.builtin_code) {
+      case kTfLiteBuiltinCallOnce:
+      case kTfLiteBuiltinIf:
+      case kTfLiteBuiltinWhile:
+      case kTfLiteBuiltinStablehloWhile:
+        return true;
+      default:
+        break;
+    }
+    for (const TfLiteIntArray* tensors : {node.inputs, node.outputs}) {
+      for (int tensor_index : TfLiteIntArrayView(tensors)) {
+        if (tensor_index == kTfLiteOptionalTensor) continue;
+        const TfLiteTensor& tensor = tensors_[tensor_index];
+        if (tensor.is_variable || tensor.type == kTfLiteResource) return true;
+      }
+    }
+    return false;
+  };
+
+  // Walks the plan backwards, so that the consumers of a tensor are visited
+  // before its producer.
+  std::vector<int> needed_nodes;
+  for (auto it = plan.rbegin(); it != plan.rend(); ++it) {
+    const auto& [node, registration] = nodes_and_registration_[*it];
+    bool is_node_needed = has_side_effects(node, registration);
+    for (int tensor_index : TfLiteIntArrayView(node.outputs)) {
+      if (tensor_index != kTfLiteOptionalTensor && is_needed[tensor_index]) {
+        is_node_needed = true;
+      }
+    }
+    if (!is_node_needed) continue;
+    for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+      if (tensor_index != kTfLiteOptionalTensor) is_needed[tensor_index] = true;
+    }
+    needed_nodes.push_back(*it);
+  }
+  std::reverse(needed_nodes.begin(), needed_nodes.end());
+  return needed_nodes;
+}
+
 TfLiteStatus Subgraph::ResizeTensorImpl(TfLiteTensor* tensor,
                                         TfLiteIntArray* new_size) {
   // Note that in theory we could resize kTfLiteArenaRwPersistent tensors too.
@@ -2207,6 +2634,8 @@ void Subgraph::EnsureTensorsVectorCapacity() {
 TfLiteStatus Subgraph::EnsureMemoryAllocations() {
   if (memory_planner_) {
     state_ = kStateUninvokable;
+    // All nodes are prepared again by AllocateTensors below.
+    ScheduleParallelStages();
     TF_LITE_ENSURE_OK(&context_, memory_planner_->PlanAllocations());
   }
   TF_LITE_ENSURE_OK(&context_, AllocateTensors());
@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/core/macros.h"
+#include "tensorflow/lite/core/node_thread_pool.h"
 #include "tensorflow/lite/experimental/resource/initialization_status.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
 #include "tensorflow/lite/graph_info.h"
@@ -100,6 +101,14 @@ class Subgraph {
   // interpreter.
   TfLiteStatus SetOutputs(std::vector<int> outputs);
 
+  // Makes `outputs`, which can be a subset of the outputs, the outputs of the
+  // subgraph and removes from the execution plan the nodes that do not
+  // contribute to them, so that they are neither prepared, allocated nor
+  // invoked. Nodes with side effects, i.e. that have no outputs, use variable
+  // or resource tensors, or invoke other subgraphs, are kept.
+  // Must be called before AllocateTensors().
+  TfLiteStatus PruneToOutputs(std::vector<int> outputs);
+
   // Provide a list of tensor indexes that are variable tensors.
   // Each index is bound check and this modifies the consistent_ flag of the
   // interpreter.
@@ -377,6 +386,14 @@ class Subgraph {
   // Before `AllocateTensors` is called, this will always return true;
   bool HasDynamicTensors() { return has_dynamic_tensors_; }
 
+  // WARNING: This is an experimental API and subject to change.
+  // Returns the first and the last execution plan index of the nodes that may
+  // be invoked concurrently with the node at `execution_plan_index`, which
+  // form its parallel execution stage. See
+  // `InterpreterOptions::SetMaxNumParallelNodes`.
+  int FirstConcurrentNode(int execution_plan_index) const;
+  int LastConcurrentNode(int execution_plan_index) const;
+
   // Assigns (or reassigns) a custom memory allocation for the given tensor.
   // `flags` is a bitmask, see TfLiteCustomAllocationFlags.
   // The runtime does NOT take ownership of the underlying memory.
@@ -471,6 +488,13 @@ class Subgraph {
     return (options_ && (options_->GetDynamicAllocationForLargeTensors() > 0));
   }
 
+  // WARNING: This is an experimental API and subject to change.
+  // True if control flow ops should prepare their subgraphs on their first
+  // invocation, as enabled by `SetLazyControlFlowSubgraphs` API.
+  bool ShouldPrepareControlFlowSubgraphsLazily() const {
+    return (options_ && options_->GetLazyControlFlowSubgraphs());
+  }
+
   // WARNING: This is an experimental API and subject to change.
   // Remove unused inputs of the subgraph. It checks usage of inputs and mark it
   // as kTfLiteOptionalTensor if the input is not used in graph execution.
@@ -640,6 +664,11 @@ class Subgraph {
   // Note: Only used during initialization.
   TfLiteStatus SetExecutionPlan(const std::vector<int>& new_plan);
 
+  // Returns the nodes of `plan`, in order, that `outputs` depend on or that
+  // have side effects. See PruneToOutputs().
+  std::vector<int> GetNodesNeededForOutputs(
+      const std::vector<int>& plan, const std::vector<int>& outputs) const;
+
   // Prevent 'context_' from accessing functions that are only available to
   // delegated kernels. Returns kTfLiteError if the counter violation happens,
   // i.e. if trying to switch to kernel context when it's already at kernel
@@ -668,6 +697,57 @@ class Subgraph {
   // Invoke the operator represented by 'node'.
   TfLiteStatus OpInvoke(const TfLiteRegistration& op_reg, TfLiteNode* node);
 
+  // Makes the inputs of 'node' readable on the CPU, and checks that they have
+  // data.
+  TfLiteStatus EnsureNodeInputsAreReadable(
+      const TfLiteNode& node, const TfLiteRegistration& registration);
+
+  // Returns the maximum number of nodes that may be invoked concurrently, as
+  // set by `InterpreterOptions::SetMaxNumParallelNodes`.
+  int MaxNumParallelNodes() const;
+
+  // Returns the number of nodes whose weights are read ahead, as set by
+  // `InterpreterOptions::SetWeightStreamingWindow`, or 0 if weights are not
+  // streamed.
+  int WeightStreamingWindow() const;
+
+  // Lists the read-only tensors of the memory-mapped model used by each node
+  // of the execution plan, and drops their pages from memory. Does nothing
+  // unless weight streaming is enabled.
+  void PlanWeightStreaming();
+
+  // Reads ahead the weights of the nodes of the execution plan from
+  // `*next_execution_plan_index` up to, but excluding, `end`, and advances
+  // `*next_execution_plan_index` to `end`.
+  void PrefetchWeights(int end, int* next_execution_plan_index) const;
+
+  // Drops the pages of the weights that are last used by the nodes of the
+  // execution plan from `begin` up to, but excluding, `end`.
+  void ReleaseWeights(int begin, int end) const;
+
+  // Returns true if 'node' must not be invoked concurrently with any other
+  // node, because it may have side effects or use state shared with other
+  // nodes.
+  bool MustInvokeAlone(const TfLiteNode& node,
+                       const TfLiteRegistration& registration) const;
+
+  // Groups nodes that don't depend on each other into parallel execution
+  // stages of at most `MaxNumParallelNodes()` nodes, and reorders the
+  // execution plan so that the nodes of each stage are consecutive. Does
+  // nothing unless parallel execution is enabled. Must be called before
+  // planning allocations, since tensors used by a stage must stay allocated
+  // until the whole stage has run.
+  void ScheduleParallelStages();
+
+  // Returns true if the nodes of the parallel execution stages can currently
+  // be invoked concurrently.
+  bool CanInvokeInParallel() const;
+
+  // Invokes the nodes of the parallel execution stage at execution plan
+  // indices [first_execution_plan_index, end_execution_plan_index).
+  TfLiteStatus InvokeParallelStage(int first_execution_plan_index,
+                                   int end_execution_plan_index);
+
   // Call OpPrepare() for as many ops as possible, allocating memory for their
   // tensors. If an op containing dynamic tensors is found, preparation will be
   // postponed until this function is called again. This allows the interpreter
@@ -1054,6 +1134,29 @@ class Subgraph {
 
   std::unique_ptr<MemoryPlanner> memory_planner_;
 
+  // The execution plan that the parallel execution stages were scheduled
+  // for, and for each of its indices, the first and one past the last index of
+  // its stage. Empty unless a stage has more than one node.
+  std::vector<int> parallel_execution_plan_;
+  std::vector<int> parallel_stage_begin_;
+  std::vector<int> parallel_stage_end_;
+
+  // A read-only tensor buffer of the memory-mapped model whose pages are
+  // streamed through memory.
+  struct StreamedWeights {
+    const void* data;
+    size_t bytes;
+  };
+
+  // The weights used by each node of the execution plan, and the weights
+  // whose last use is by each node. Empty unless weights are streamed. See
+  // `InterpreterOptions::SetWeightStreamingWindow`.
+  std::vector<std::vector<StreamedWeights>> weights_used_by_node_;
+  std::vector<std::vector<StreamedWeights>> weights_last_used_by_node_;
+
+  // Threads that invoke the nodes of parallel execution stages.
+  std::unique_ptr<NodeThreadPool> node_thread_pool_;
+
   // Maps tensor index to custom allocation for all applicable tensors.
   std::map<int, TfLiteCustomAllocation> custom_allocations_;
 
@@ -83,6 +83,64 @@ TEST(RemoveUnusedInputs, BypassInputsWithoutOp) {
   ASSERT_EQ(subgraph.inputs(), std::vector<int>({0, -1, 2}));
 }
 
+// Builds a graph where NEG nodes compute 1 = -0, 2 = -1 and 3 = -0, with
+// tensors 2 and 3 as outputs.
+void BuildTwoHeadGraph(Subgraph& subgraph, int num_tensors = 4) {
+  subgraph.AddTensors(num_tensors);
+  for (int i = 0; i < num_tensors; ++i) {
+    subgraph.SetTensorParametersReadWrite(i, kTfLiteFloat32, "", {2},
+                                          TfLiteQuantization());
+  }
+  subgraph.SetInputs({0});
+  subgraph.SetOutputs({2, 3});
+  TfLiteRegistration* neg_op = tflite::ops::builtin::Register_NEG();
+  subgraph.AddNodeWithParameters({0}, {1}, {}, nullptr, 0, nullptr, neg_op);
+  subgraph.AddNodeWithParameters({1}, {2}, {}, nullptr, 0, nullptr, neg_op);
+  subgraph.AddNodeWithParameters({0}, {3}, {}, nullptr, 0, nullptr, neg_op);
+}
+
+TEST(PruneToOutputs, RemovesNodesOfOtherOutputs) {
+  Interpreter interpreter;
+  auto& subgraph = interpreter.primary_subgraph();
+  BuildTwoHeadGraph(subgraph);
+
+  ASSERT_EQ(subgraph.PruneToOutputs({2}), kTfLiteOk);
+  EXPECT_EQ(subgraph.execution_plan(), std::vector<int>({0, 1}));
+  EXPECT_EQ(subgraph.outputs(), std::vector<int>({2}));
+
+  ASSERT_EQ(subgraph.AllocateTensors(), kTfLiteOk);
+  subgraph.tensor(0)->data.f[0] = 1;
+  subgraph.tensor(0)->data.f[1] = -2;
+  ASSERT_EQ(subgraph.Invoke(), kTfLiteOk);
+  EXPECT_THAT(std::vector<float>(subgraph.tensor(2)->data.f,
+                                 subgraph.tensor(2)->data.f + 2),
+              ElementsAreArray({1, -2}));
+}
+
+TEST(PruneToOutputs, KeepsNodesWithSideEffects) {
+  Interpreter interpreter;
+  auto& subgraph = interpreter.primary_subgraph();
+  BuildTwoHeadGraph(subgraph, /*num_tensors=*/5);
+  subgraph.SetTensorParametersReadWrite(4, kTfLiteFloat32, "", {2},
+                                        TfLiteQuantization(),
+                                        /*is_variable=*/true);
+  TfLiteRegistration* neg_op = tflite::ops::builtin::Register_NEG();
+  subgraph.AddNodeWithParameters({3}, {4}, {}, nullptr, 0, nullptr, neg_op);
+
+  ASSERT_EQ(subgraph.PruneToOutputs({2}), kTfLiteOk);
+  EXPECT_EQ(subgraph.execution_plan(), std::vector<int>({0, 1, 2, 3}));
+}
+
+TEST(PruneToOutputs, FailsAfterAllocateTensors) {
+  Interpreter interpreter;
+  auto& subgraph = interpreter.primary_subgraph();
+  BuildTwoHeadGraph(subgraph);
+  ASSERT_EQ(subgraph.AllocateTensors(), kTfLiteOk);
+
+  EXPECT_EQ(subgraph.PruneToOutputs({2}), kTfLiteError);
+  EXPECT_EQ(subgraph.execution_plan(), std::vector<int>({0, 1, 2}));
+}
+
 TEST(GetSubgraphContext, NonConstGetSubgraphContext) {
   Interpreter interpreter;
   auto& subgraph = interpreter.primary_subgraph();
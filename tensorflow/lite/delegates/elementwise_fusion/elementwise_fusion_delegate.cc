@@ -0,0 +1,377 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/delegates/elementwise_fusion/elementwise_fusion_delegate.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/builtin_ops.h"
+#include "tensorflow/lite/core/c/builtin_op_data.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/delegates/utils/simple_delegate.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+
+namespace tflite {
+namespace elementwise_fusion {
+namespace {
+
+// The number of elements each fused op processes at a time. The blocks of the
+// intermediate tensors of a chain stay in L1 between the ops.
+constexpr int kBlockSize = 512;
+
+enum class OpType { kAdd, kSub, kMul, kClamp, kNeg, kAbs };
+
+// A tensor read or written by a fused op. Tensors that are neither inputs nor
+// outputs of the fused node live in a block of the kernel's scratch buffer
+// instead of the arena.
+struct Operand {
+  int tensor_index;
+  // The index of the scratch block holding the tensor, or -1.
+  int scratch_block;
+};
+
+struct FusedOp {
+  OpType type;
+  // The output is clamped to [activation_min, activation_max].
+  float activation_min;
+  float activation_max;
+  int num_inputs;
+  Operand inputs[2];
+  Operand output;
+};
+
+// Fused ops whose outputs have the same number of elements. They are
+// evaluated together, a block of elements at a time.
+struct Loop {
+  int64_t num_elements;
+  std::vector<int> ops;
+};
+
+bool GetFusedActivation(const TfLiteRegistration* registration,
+                        const TfLiteNode* node,
+                        TfLiteFusedActivation* activation) {
+  *activation = kTfLiteActNone;
+  if (node->builtin_data != nullptr) {
+    switch (registration->builtin_code) {
+      case kTfLiteBuiltinAdd:
+        *activation =
+            static_cast<const TfLiteAddParams*>(node->builtin_data)->activation;
+        break;
+      case kTfLiteBuiltinSub:
+        *activation =
+            static_cast<const TfLiteSubParams*>(node->builtin_data)->activation;
+        break;
+      case kTfLiteBuiltinMul:
+        *activation =
+            static_cast<const TfLiteMulParams*>(node->builtin_data)->activation;
+        break;
+      default:
+        break;
+    }
+  }
+  return *activation == kTfLiteActNone || *activation == kTfLiteActRelu ||
+         *activation == kTfLiteActReluN1To1 || *activation == kTfLiteActRelu6;
+}
+
+bool IsFloat32(const TfLiteContext* context, const TfLiteIntArray* tensors) {
+  for (int i = 0; i < tensors->size; ++i) {
+    if (tensors->data[i] == kTfLiteOptionalTensor ||
+        context->tensors[tensors->data[i]].type != kTfLiteFloat32) {
+      return false;
+    }
+  }
+  return true;
+}
+
+class ElementwiseFusionKernel : public SimpleDelegateKernelInterface {
+ public:
+  TfLiteStatus Init(TfLiteContext* context,
+                    const TfLiteDelegateParams* params) override {
+    std::unordered_set<int> fused_node_outputs(
+        params->output_tensors->data,
+        params->output_tensors->data + params->output_tensors->size);
+    std::unordered_map<int, int> scratch_blocks;
+    auto operand = [&scratch_blocks](int tensor_index) {
+      auto it = scratch_blocks.find(tensor_index);
+      return Operand{tensor_index,
+                     it == scratch_blocks.end() ? -1 : it->second};
+    };
+
+    ops_.reserve(params->nodes_to_replace->size);
+    for (int i = 0; i < params->nodes_to_replace->size; ++i) {
+      TfLiteNode* node;
+      TfLiteRegistration* registration;
+      TF_LITE_ENSURE_STATUS(context->GetNodeAndRegistration(
+          context, params->nodes_to_replace->data[i], &node, &registration));
+      FusedOp op;
+      TfLiteFusedActivation activation = kTfLiteActNone;
+      switch (registration->builtin_code) {
+        case kTfLiteBuiltinAdd:
+          op.type = OpType::kAdd;
+          break;
+        case kTfLiteBuiltinSub:
+          op.type = OpType::kSub;
+          break;
+        case kTfLiteBuiltinMul:
+          op.type = OpType::kMul;
+          break;
+        case kTfLiteBuiltinRelu:
+          op.type = OpType::kClamp;
+          activation = kTfLiteActRelu;
+          break;
+        case kTfLiteBuiltinRelu6:
+          op.type = OpType::kClamp;
+          activation = kTfLiteActRelu6;
+          break;
+        case kTfLiteBuiltinReluN1To1:
+          op.type = OpType::kClamp;
+          activation = kTfLiteActReluN1To1;
+          break;
+        case kTfLiteBuiltinNeg:
+          op.type = OpType::kNeg;
+          break;
+        case kTfLiteBuiltinAbs:
+          op.type = OpType::kAbs;
+          break;
+        default:
+          TF_LITE_KERNEL_LOG(context, "Unexpected builtin op %d.",
+                             registration->builtin_code);
+          return kTfLiteError;
+      }
+      if (op.type != OpType::kClamp) {
+        TF_LITE_ENSURE(context,
+                       GetFusedActivation(registration, node, &activation));
+      }
+      CalculateActivationRange(activation, &op.activation_min,
+                               &op.activation_max);
+      op.num_inputs = node->inputs->size;
+      for (int j = 0; j < op.num_inputs; ++j) {
+        op.inputs[j] = operand(node->inputs->data[j]);
+      }
+      const int output = node->outputs->data[0];
+      if (fused_node_outputs.count(output)) {
+        op.output = Operand{output, -1};
+      } else {
+        const int scratch_block = static_cast<int>(scratch_blocks.size());
+        scratch_blocks[output] = scratch_block;
+        op.output = Operand{output, scratch_block};
+      }
+      producers_[output] = static_cast<int>(ops_.size());
+      ops_.push_back(op);
+    }
+    scratch_.resize(scratch_blocks.size() * kBlockSize);
+    return kTfLiteOk;
+  }
+
+  TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) override {
+    // Shapes are propagated through the fused ops, as the intermediate
+    // tensors are not prepared by anyone else.
+    std::vector<const TfLiteIntArray*> output_dims(ops_.size());
+    auto dims = [&](int tensor_index) {
+      auto it = producers_.find(tensor_index);
+      return it == producers_.end() ? context->tensors[tensor_index].dims
+                                    : output_dims[it->second];
+    };
+    loops_.clear();
+    for (int i = 0; i < static_cast<int>(ops_.size()); ++i) {
+      const FusedOp& op = ops_[i];
+      output_dims[i] = dims(op.inputs[0].tensor_index);
+      for (int j = 1; j < op.num_inputs; ++j) {
+        TF_LITE_ENSURE(context, TfLiteIntArrayEqual(
+                                    output_dims[i],
+                                    dims(op.inputs[j].tensor_index)));
+      }
+      if (op.output.scratch_block < 0) {
+        TF_LITE_ENSURE_STATUS(context->ResizeTensor(
+            context, &context->tensors[op.output.tensor_index],
+            TfLiteIntArrayCopy(output_dims[i])));
+      }
+      const int64_t num_elements = NumElements(output_dims[i]);
+      auto loop = std::find_if(
+          loops_.begin(), loops_.end(), [num_elements](const Loop& loop) {
+            return loop.num_elements == num_elements;
+          });
+      if (loop == loops_.end()) {
+        loops_.push_back(Loop{num_elements, {}});
+        loop = loops_.end() - 1;
+      }
+      loop->ops.push_back(i);
+    }
+    return kTfLiteOk;
+  }
+
+  TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) override {
+    for (const Loop& loop : loops_) {
+      for (int64_t begin = 0; begin < loop.num_elements; begin += kBlockSize) {
+        const int size = static_cast<int>(
+            std::min<int64_t>(kBlockSize, loop.num_elements - begin));
+        for (int op_index : loop.ops) {
+          const FusedOp& op = ops_[op_index];
+          const float* input0 = Data(context, op.inputs[0], begin);
+          const float* input1 =
+              op.num_inputs > 1 ? Data(context, op.inputs[1], begin) : nullptr;
+          float* output = Data(context, op.output, begin);
+          EvalBlock(op, input0, input1, output, size);
+        }
+      }
+    }
+    return kTfLiteOk;
+  }
+
+ private:
+  float* Data(TfLiteContext* context, const Operand& operand, int64_t begin) {
+    if (operand.scratch_block >= 0) {
+      return scratch_.data() + operand.scratch_block * kBlockSize;
+    }
+    return context->tensors[operand.tensor_index].data.f + begin;
+  }
+
+  static void EvalBlock(const FusedOp& op, const float* input0,
+                        const float* input1, float* output, int size) {
+    const float min = op.activation_min;
+    const float max = op.activation_max;
+    switch (op.type) {
+      case OpType::kAdd:
+        for (int i = 0; i < size; ++i) {
+          output[i] = std::min(std::max(input0[i] + input1[i], min), max);
+        }
+        break;
+      case OpType::kSub:
+        for (int i = 0; i < size; ++i) {
+          output[i] = std::min(std::max(input0[i] - input1[i], min), max);
+        }
+        break;
+      case OpType::kMul:
+        for (int i = 0; i < size; ++i) {
+          output[i] = std::min(std::max(input0[i] * input1[i], min), max);
+        }
+        break;
+      case OpType::kClamp:
+        for (int i = 0; i < size; ++i) {
+          output[i] = std::min(std::max(input0[i], min), max);
+        }
+        break;
+      case OpType::kNeg:
+        for (int i = 0; i < size; ++i) {
+          output[i] = -input0[i];
+        }
+        break;
+      case OpType::kAbs:
+        for (int i = 0; i < size; ++i) {
+          output[i] = std::abs(input0[i]);
+        }
+        break;
+    }
+  }
+
+  std::vector<FusedOp> ops_;
+  // Maps the output tensors of the fused ops to the index of their op.
+  std::unordered_map<int, int> producers_;
+  std::vector<Loop> loops_;
+  std::vector<float> scratch_;
+};
+
+class ElementwiseFusionDelegate : public SimpleDelegateInterface {
+ public:
+  explicit ElementwiseFusionDelegate(
+      const TfLiteElementwiseFusionDelegateOptions& options)
+      : options_(options) {}
+
+  bool IsNodeSupportedByDelegate(const TfLiteRegistration* registration,
+                                 const TfLiteNode* node,
+                                 TfLiteContext* context) const override {
+    if (node->outputs->size != 1 || !IsFloat32(context, node->inputs) ||
+        !IsFloat32(context, node->outputs)) {
+      return false;
+    }
+    switch (registration->builtin_code) {
+      case kTfLiteBuiltinAdd:
+      case kTfLiteBuiltinSub:
+      case kTfLiteBuiltinMul: {
+        // Broadcasting is left to the builtin kernels.
+        TfLiteFusedActivation activation;
+        return node->inputs->size == 2 &&
+               TfLiteIntArrayEqual(
+                   context->tensors[node->inputs->data[0]].dims,
+                   context->tensors[node->inputs->data[1]].dims) &&
+               GetFusedActivation(registration, node, &activation);
+      }
+      case kTfLiteBuiltinRelu:
+      case kTfLiteBuiltinRelu6:
+      case kTfLiteBuiltinReluN1To1:
+      case kTfLiteBuiltinNeg:
+      case kTfLiteBuiltinAbs:
+        return node->inputs->size == 1;
+      default:
+        return false;
+    }
+  }
+
+  TfLiteStatus Initialize(TfLiteContext* context) override { return kTfLiteOk; }
+
+  const char* Name() const override {
+    static constexpr char kName[] = "ElementwiseFusionDelegate";
+    return kName;
+  }
+
+  std::unique_ptr<SimpleDelegateKernelInterface> CreateDelegateKernelInterface()
+      override {
+    return std::make_unique<ElementwiseFusionKernel>();
+  }
+
+  SimpleDelegateInterface::Options DelegateOptions() const override {
+    SimpleDelegateInterface::Options options;
+    options.min_nodes_per_partition = options_.min_ops_per_fusion;
+    return options;
+  }
+
+ private:
+  const TfLiteElementwiseFusionDelegateOptions options_;
+};
+
+}  // namespace
+}  // namespace elementwise_fusion
+}  // namespace tflite
+
+TfLiteElementwiseFusionDelegateOptions
+TfLiteElementwiseFusionDelegateOptionsDefault() {
+  TfLiteElementwiseFusionDelegateOptions options = {0};
+  // A single op gains nothing from being fused.
+  options.min_ops_per_fusion = 2;
+  return options;
+}
+
+TfLiteDelegate* TfLiteElementwiseFusionDelegateCreate(
+    const TfLiteElementwiseFusionDelegateOptions* options) {
+  auto delegate =
+      std::make_unique<tflite::elementwise_fusion::ElementwiseFusionDelegate>(
+          options ? *options : TfLiteElementwiseFusionDelegateOptionsDefault());
+  // The fused kernel propagates shapes itself, so inputs can be resized after
+  // delegation.
+  return tflite::TfLiteDelegateFactory::CreateSimpleDelegate(
+      std::move(delegate), kTfLiteDelegateFlagsAllowDynamicTensors |
+                               kTfLiteDelegateFlagsRequirePropagatedShapes);
+}
+
+void TfLiteElementwiseFusionDelegateDelete(TfLiteDelegate* delegate) {
+  tflite::TfLiteDelegateFactory::DeleteSimpleDelegate(delegate);
+}
@@ -0,0 +1,69 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_DELEGATES_ELEMENTWISE_FUSION_ELEMENTWISE_FUSION_DELEGATE_H_
+#define TENSORFLOW_LITE_DELEGATES_ELEMENTWISE_FUSION_ELEMENTWISE_FUSION_DELEGATE_H_
+
+#include <memory>
+
+#include "tensorflow/lite/core/c/common.h"
+
+// A delegate that fuses chains of float32 elementwise builtin ops (ADD, SUB
+// and MUL with equal input shapes, RELU, RELU6, RELU_N1_TO_1, NEG and ABS)
+// into a single node. The fused node makes one pass over its inputs, a block
+// of elements at a time, so the intermediate tensors of the chain are never
+// written to memory and are not allocated in the arena.
+//
+// Apply it with Interpreter::ModifyGraphWithDelegate, or return it from the
+// OpResolver::GetDelegateCreators of the resolver given to InterpreterBuilder,
+// before any delegate that would take the same nodes.
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+typedef struct {
+  // The minimum number of ops fused into a single node. Chains that are
+  // shorter are left to the builtin kernels.
+  int min_ops_per_fusion;
+} TfLiteElementwiseFusionDelegateOptions;
+
+// Returns a structure with the default delegate options.
+TfLiteElementwiseFusionDelegateOptions
+TfLiteElementwiseFusionDelegateOptionsDefault();
+
+// Creates a new delegate instance that needs to be destroyed with
+// `TfLiteElementwiseFusionDelegateDelete` when delegate is no longer used by
+// TFLite. When `options` is set to `nullptr`, the default values are used.
+TfLiteDelegate* TfLiteElementwiseFusionDelegateCreate(
+    const TfLiteElementwiseFusionDelegateOptions* options);
+
+// Destroys a delegate created with `TfLiteElementwiseFusionDelegateCreate`.
+void TfLiteElementwiseFusionDelegateDelete(TfLiteDelegate* delegate);
+
+#ifdef __cplusplus
+}
+#endif  // __cplusplus
+
+// A convenient wrapper that returns C++ std::unique_ptr for automatic memory
+// management.
+inline std::unique_ptr<TfLiteDelegate, void (*)(TfLiteDelegate*)>
+TfLiteElementwiseFusionDelegateCreateUnique(
+    const TfLiteElementwiseFusionDelegateOptions* options) {
+  return std::unique_ptr<TfLiteDelegate, void (*)(TfLiteDelegate*)>(
+      TfLiteElementwiseFusionDelegateCreate(options),
+      TfLiteElementwiseFusionDelegateDelete);
+}
+
+#endif  // TENSORFLOW_LITE_DELEGATES_ELEMENTWISE_FUSION_ELEMENTWISE_FUSION_DELEGATE_H_
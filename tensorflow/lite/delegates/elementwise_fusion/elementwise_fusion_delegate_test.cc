@@ -0,0 +1,147 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/delegates/elementwise_fusion/elementwise_fusion_delegate.h"
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/builtin_op_data.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/kernels/builtin_op_kernels.h"
+#include "tensorflow/lite/interpreter.h"
+
+namespace tflite {
+namespace {
+
+// Builds relu(mul(add(input0, input1), input1)), with tensors of `shape`.
+class ElementwiseFusionTest : public ::testing::Test {
+ protected:
+  void BuildChain(const std::vector<int>& shape,
+                  const std::vector<int>& outputs) {
+    interpreter_ = std::make_unique<Interpreter>();
+    ASSERT_EQ(interpreter_->AddTensors(5), kTfLiteOk);
+    ASSERT_EQ(interpreter_->SetInputs({0, 1}), kTfLiteOk);
+    ASSERT_EQ(interpreter_->SetOutputs(outputs), kTfLiteOk);
+    TfLiteQuantizationParams quant;
+    for (int i = 0; i < 5; ++i) {
+      ASSERT_EQ(interpreter_->SetTensorParametersReadWrite(
+                    i, kTfLiteFloat32, "", shape, quant),
+                kTfLiteOk);
+    }
+    auto* add_params =
+        static_cast<TfLiteAddParams*>(malloc(sizeof(TfLiteAddParams)));
+    add_params->activation = kTfLiteActNone;
+    add_params->pot_scale_int16 = false;
+    auto* mul_params =
+        static_cast<TfLiteMulParams*>(malloc(sizeof(TfLiteMulParams)));
+    mul_params->activation = kTfLiteActNone;
+    ASSERT_EQ(interpreter_->AddNodeWithParameters(
+                  {0, 1}, {2}, nullptr, 0, add_params,
+                  ops::builtin::Register_ADD()),
+              kTfLiteOk);
+    ASSERT_EQ(interpreter_->AddNodeWithParameters(
+                  {2, 1}, {3}, nullptr, 0, mul_params,
+                  ops::builtin::Register_MUL()),
+              kTfLiteOk);
+    ASSERT_EQ(interpreter_->AddNodeWithParameters(
+                  {3}, {4}, nullptr, 0, nullptr, ops::builtin::Register_RELU()),
+              kTfLiteOk);
+  }
+
+  // Sets the inputs, invokes the interpreter and checks tensors 2 and 4.
+  void InvokeAndCheck(int num_elements) {
+    float* input0 = interpreter_->typed_tensor<float>(0);
+    float* input1 = interpreter_->typed_tensor<float>(1);
+    for (int i = 0; i < num_elements; ++i) {
+      input0[i] = i % 7 - 3;
+      input1[i] = i % 5 - 2;
+    }
+    ASSERT_EQ(interpreter_->Invoke(), kTfLiteOk);
+    const float* sum = interpreter_->typed_tensor<float>(2);
+    const float* output = interpreter_->typed_tensor<float>(4);
+    for (int i = 0; i < num_elements; ++i) {
+      const float expected_sum = input0[i] + input1[i];
+      if (sum != nullptr) {
+        EXPECT_EQ(sum[i], expected_sum);
+      }
+      EXPECT_EQ(output[i], std::max(expected_sum * input1[i], 0.0f));
+    }
+  }
+
+  std::unique_ptr<Interpreter> interpreter_;
+};
+
+TEST_F(ElementwiseFusionTest, FusesChain) {
+  BuildChain({2, 600}, {4});
+  ASSERT_EQ(interpreter_->ModifyGraphWithDelegate(
+                TfLiteElementwiseFusionDelegateCreateUnique(nullptr)),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter_->execution_plan().size(), 1);
+  const auto* node_and_reg =
+      interpreter_->node_and_registration(interpreter_->execution_plan()[0]);
+  EXPECT_STREQ(node_and_reg->second.custom_name, "ElementwiseFusionDelegate");
+
+  ASSERT_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+  // The intermediate tensors are not allocated.
+  EXPECT_EQ(interpreter_->tensor(2)->data.raw, nullptr);
+  EXPECT_EQ(interpreter_->tensor(3)->data.raw, nullptr);
+  InvokeAndCheck(2 * 600);
+}
+
+TEST_F(ElementwiseFusionTest, KeepsIntermediateOutputs) {
+  BuildChain({100}, {2, 4});
+  ASSERT_EQ(interpreter_->ModifyGraphWithDelegate(
+                TfLiteElementwiseFusionDelegateCreateUnique(nullptr)),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter_->execution_plan().size(), 1);
+  ASSERT_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+  ASSERT_NE(interpreter_->tensor(2)->data.raw, nullptr);
+  InvokeAndCheck(100);
+}
+
+TEST_F(ElementwiseFusionTest, ResizeInputs) {
+  BuildChain({10}, {4});
+  ASSERT_EQ(interpreter_->ModifyGraphWithDelegate(
+                TfLiteElementwiseFusionDelegateCreateUnique(nullptr)),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+  InvokeAndCheck(10);
+
+  ASSERT_EQ(interpreter_->ResizeInputTensor(0, {3, 700}), kTfLiteOk);
+  ASSERT_EQ(interpreter_->ResizeInputTensor(1, {3, 700}), kTfLiteOk);
+  ASSERT_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+  ASSERT_EQ(interpreter_->tensor(4)->dims->size, 2);
+  EXPECT_EQ(interpreter_->tensor(4)->dims->data[1], 700);
+  InvokeAndCheck(3 * 700);
+}
+
+TEST_F(ElementwiseFusionTest, MinOpsPerFusion) {
+  BuildChain({10}, {4});
+  TfLiteElementwiseFusionDelegateOptions options =
+      TfLiteElementwiseFusionDelegateOptionsDefault();
+  options.min_ops_per_fusion = 4;
+  ASSERT_EQ(interpreter_->ModifyGraphWithDelegate(
+                TfLiteElementwiseFusionDelegateCreateUnique(&options)),
+            kTfLiteOk);
+  EXPECT_EQ(interpreter_->execution_plan().size(), 3);
+}
+
+}  // namespace
+}  // namespace tflite
@@ -43,10 +43,10 @@ const tensorflow::Tensor* BufferMap::GetTensorPtr(int tensor_index) const {
 }
 
 void BufferMap::SetFromTfLite(int tensor_index, const TfLiteTensor* tensor,
-                              bool allow_reusing) {
-  TFLITE_CHECK(
-      SetTfTensorFromTfLite(tensor, &id_to_tensor_[tensor_index], allow_reusing)
-          .ok());
+                              bool allow_reusing, bool allow_reusing_arena) {
+  TFLITE_CHECK(SetTfTensorFromTfLite(tensor, &id_to_tensor_[tensor_index],
+                                     allow_reusing, allow_reusing_arena)
+                   .ok());
 }
 
 void BufferMap::SetFromTensorFlow(int tensor_index, tensorflow::Tensor tensor) {
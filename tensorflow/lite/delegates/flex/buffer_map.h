@@ -55,9 +55,12 @@ class BufferMap {
   // Same as above but creates a new tensorflow::Tensor with a copy of the
   // given TfLiteTensor's data. If `allow_reusing=false`, then we explicitly
   // disallow reusing the TF Lite tensor buffer when constructing the new
-  // tensorflow Tensor.
+  // tensorflow Tensor. If `allow_reusing_arena=true`, the buffer of an
+  // arena-allocated tensor is reused as well, and the caller must replace the
+  // tensor before the arena reuses its buffer.
   void SetFromTfLite(int tensor_index, const TfLiteTensor* tensor,
-                     bool allow_reusing = true);
+                     bool allow_reusing = true,
+                     bool allow_reusing_arena = false);
 
  private:
   // Mapping from TL Lite tensor ID to TensorFlow's Tensor. All tensors that
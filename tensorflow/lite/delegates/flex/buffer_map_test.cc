@@ -268,6 +268,27 @@ TEST(BufferMapTest, TensorflowBufferReuse) {
   TfLiteTensorDataFree(&tensor);
 }
 
+TEST(BufferMapTest, ArenaBufferReuse) {
+  alignas(EIGEN_MAX_ALIGN_BYTES) char arena[16];
+  TfLiteTensor tensor;
+  tensor.allocation_type = kTfLiteArenaRw;
+  tensor.data.raw = arena;
+  tensor.bytes = sizeof(arena);
+
+  // Arena buffers are only reused on request.
+  TfLiteTensorBuffer* tensor_buffer = new TfLiteTensorBuffer(&tensor);
+  EXPECT_FALSE(tensor_buffer->BufferReusedFromTfLiteTensor());
+  EXPECT_NE(tensor_buffer->data(), tensor.data.raw);
+  tensor_buffer->Unref();
+
+  TfLiteTensorBuffer* tensor_buffer_reused =
+      new TfLiteTensorBuffer(&tensor, /*allow_reusing=*/true,
+                             /*allow_reusing_arena=*/true);
+  EXPECT_TRUE(tensor_buffer_reused->BufferReusedFromTfLiteTensor());
+  EXPECT_EQ(tensor_buffer_reused->data(), tensor.data.raw);
+  tensor_buffer_reused->Unref();
+}
+
 TEST(BufferMapTest, ExplicitlyDisableBufferReuse) {
   TfLiteTensor tensor;
   tensor.allocation_type = kTfLiteDynamic;
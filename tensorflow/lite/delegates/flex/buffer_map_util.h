@@ -48,9 +48,13 @@ class BaseTfLiteTensorBuffer : public tensorflow::TensorBuffer {
 class TfLiteTensorBuffer : public BaseTfLiteTensorBuffer {
  public:
   // If `allow_reusing=false`, then the tensor buffer won't be reused from the
-  // TfLiteTensor.
+  // TfLiteTensor. Buffers of arena-allocated tensors are only reused if
+  // `allow_reusing_arena=true`, since the arena reuses them for other tensors
+  // and may move them, so the caller must not keep the tensorflow::Tensor
+  // after the TfLite node that owns it returns.
   explicit TfLiteTensorBuffer(const TfLiteTensor* tensor,
-                              bool allow_reusing = true);
+                              bool allow_reusing = true,
+                              bool allow_reusing_arena = false);
 
   ~TfLiteTensorBuffer() override;
 
@@ -72,7 +76,8 @@ class TfLiteTensorBuffer : public BaseTfLiteTensorBuffer {
   // TODO(b/205153246): Also consider reusing memory to avoid copying from
   // tensorflow::Tensor to TfLiteTensor.
   void* MaybeAllocateTensorflowBuffer(const TfLiteTensor* tensor,
-                                      bool allow_reusing) const;
+                                      bool allow_reusing,
+                                      bool allow_reusing_arena) const;
 
  private:
   size_t len_;
@@ -99,10 +104,12 @@ class StringTfLiteTensorBuffer : public BaseTfLiteTensorBuffer {
 
 // Sets the `tensorflow::Tensor` content from `TfLiteTensor` object. If
 // `allow_reusing=false`, then we explicitly disallow reusing the TF Lite
-// tensor buffer when constructing the new tensorflow Tensor.
+// tensor buffer when constructing the new tensorflow Tensor. See
+// `TfLiteTensorBuffer` for `allow_reusing_arena`.
 tensorflow::Status SetTfTensorFromTfLite(const TfLiteTensor* tensor,
                                          tensorflow::Tensor* tf_tensor,
-                                         bool allow_reusing = true);
+                                         bool allow_reusing = true,
+                                         bool allow_reusing_arena = false);
 
 }  // namespace flex
 }  // namespace tflite
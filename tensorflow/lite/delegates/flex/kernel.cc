@@ -26,6 +26,9 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/eager/context.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_def.pb.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
@@ -409,6 +412,10 @@ struct OpData {
       disable_reusing_buffer_tensors;  // A list of input tensor indexes which
                                        // input buffer should not be reused by
                                        // tensorflow::Tensor.
+  // Whether the buffers of arena-allocated inputs can be shared with
+  // TensorFlow during Eval, which is not the case if a stateful op might keep
+  // references to its inputs after Eval.
+  bool reuse_arena_buffers = true;
   OpDataInfo shared_info;
 };
 
@@ -529,6 +536,14 @@ TfLiteStatus DelegateKernel::Init(TfLiteContext* context,
         op_data_->disable_reusing_buffer_tensors.insert(tensor_index);
       }
     }
+
+    const tensorflow::OpDef* op_def = nullptr;
+    if (!tensorflow::OpRegistry::Global()
+             ->LookUpOpDef(node_data.nodedef().op(), &op_def)
+             .ok() ||
+        op_def->is_stateful()) {
+      op_data_->reuse_arena_buffers = false;
+    }
   }
 
   TF_LITE_ENSURE_STATUS(ConvertStatus(context, status));
@@ -727,6 +742,9 @@ static tensorflow::CancellationManager* GetDefaultCancellationManager() {
 TfLiteStatus DelegateKernel::Eval(TfLiteContext* context, TfLiteNode* node) {
   BufferMap* buffer_map = op_data_->shared_info.buffer_map;
 
+  // Inputs whose arena buffer is shared with TensorFlow during this Eval.
+  std::vector<tensorflow::Tensor> arena_inputs;
+
   // Insert a tensor in the buffer map for all inputs that are not constant.
   // Constants were handled in Prepare() already.
   for (auto tensor_index : op_data_->subgraph_inputs) {
@@ -738,7 +756,15 @@ TfLiteStatus DelegateKernel::Eval(TfLiteContext* context, TfLiteNode* node) {
       if (!tensor->data_is_stale || !buffer_map->HasTensor(tensor_index)) {
         buffer_map->SetFromTfLite(
             tensor_index, tensor,
-            !op_data_->disable_reusing_buffer_tensors.count(tensor_index));
+            !op_data_->disable_reusing_buffer_tensors.count(tensor_index),
+            op_data_->reuse_arena_buffers);
+        const tensorflow::Tensor* tf_tensor =
+            buffer_map->GetTensorPtr(tensor_index);
+        if (tensor->allocation_type == kTfLiteArenaRw &&
+            tensor->data.raw != nullptr &&
+            tf_tensor->tensor_data().data() == tensor->data.raw) {
+          arena_inputs.push_back(*tf_tensor);
+        }
       }
     }
   }
@@ -777,6 +803,24 @@ TfLiteStatus DelegateKernel::Eval(TfLiteContext* context, TfLiteNode* node) {
     }
   }
 
+  // Outputs kept in the buffer map outlive this Eval, so they must not share
+  // the arena buffer of an input (e.g. the output of a Reshape), which the
+  // arena reuses for other tensors.
+  if (!arena_inputs.empty()) {
+    for (auto tensor_index : op_data_->subgraph_outputs) {
+      if (!buffer_map->HasTensor(tensor_index)) continue;
+      const tensorflow::Tensor* tf_tensor =
+          buffer_map->GetTensorPtr(tensor_index);
+      for (const tensorflow::Tensor& arena_input : arena_inputs) {
+        if (tf_tensor->SharesBufferWith(arena_input)) {
+          buffer_map->SetFromTensorFlow(
+              tensor_index, tensorflow::tensor::DeepCopy(*tf_tensor));
+          break;
+        }
+      }
+    }
+  }
+
   for (auto tensor_index : op_data_->subgraph_outputs) {
     if (op_data_->shared_info.already_transferred_outputs.count(tensor_index) !=
         0) {
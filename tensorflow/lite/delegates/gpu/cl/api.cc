@@ -38,6 +38,7 @@ limitations under the License.
 #include "tensorflow/lite/delegates/gpu/cl/opencl_wrapper.h"
 #include "tensorflow/lite/delegates/gpu/cl/tensor.h"
 #include "tensorflow/lite/delegates/gpu/cl/tensor_type_util.h"
+#include "tensorflow/lite/delegates/gpu/cl/tuning_cache.h"
 #include "tensorflow/lite/delegates/gpu/common/data_type.h"
 #include "tensorflow/lite/delegates/gpu/common/precision.h"
 #include "tensorflow/lite/delegates/gpu/common/shape.h"
@@ -958,6 +959,12 @@ class InferenceEnvironmentImpl : public InferenceEnvironment {
         CreateProfilingCommandQueue(device, context, &profiling_queue));
     environment_ = Environment(std::move(device), std::move(context),
                                std::move(queue), std::move(profiling_queue));
+    if (!options_.serialized_tuning_cache.empty()) {
+      // Ignore returned error. Cache is discarded.
+      environment_.tuning_cache()
+          ->AddSerializedCache(options_.serialized_tuning_cache)
+          .IgnoreError();
+    }
     return environment_.Init();
   }
 
@@ -1038,6 +1045,13 @@ class InferenceEnvironmentImpl : public InferenceEnvironment {
     return data;
   }
 
+  std::vector<uint8_t> GetSerializedTuningCache() const final {
+    std::vector<uint8_t> data;
+    environment_.tuning_cache()->GetSerializedCache(
+        &data, TuningCache::GetDeviceName(environment_.device().GetInfo()));
+    return data;
+  }
+
   const InferenceEnvironmentProperties& properties() const {
     return properties_;
   }
@@ -105,6 +105,13 @@ class InferenceEnvironment {
   // Returned data is valid only if used on the same device, otherwise it will
   // not be compatible and will be discarded.
   virtual std::vector<uint8_t> GetSerializedBinaryCache() const = 0;
+
+  // Returns opaque binary blob that contains the work group sizes found by
+  // tuning the kernels of the models built in this environment, on GPUs of
+  // the same model as this device. Unlike the binary cache, it stays valid
+  // across driver updates and can be shared with other devices with the same
+  // GPU model, so that they skip tuning.
+  virtual std::vector<uint8_t> GetSerializedTuningCache() const = 0;
 };
 
 struct InferenceEnvironmentOptions {
@@ -129,6 +136,12 @@ struct InferenceEnvironmentOptions {
   // incompatible when GPU driver is updated.
   absl::Span<const uint8_t> serialized_binary_cache;
 
+  // Should contain data returned from
+  // InferenceEnvironment::GetSerializedTuningCache method, possibly on another
+  // device. Invalid data will be discarded, and entries for other GPU models
+  // are ignored.
+  absl::Span<const uint8_t> serialized_tuning_cache;
+
   bool IsGlAware() const {
     return egl_context != EGL_NO_CONTEXT && egl_display != EGL_NO_DISPLAY;
   }
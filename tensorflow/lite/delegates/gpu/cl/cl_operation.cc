@@ -15,7 +15,12 @@ limitations under the License.
 
 #include "tensorflow/lite/delegates/gpu/cl/cl_operation.h"
 
+#include <farmhash.h>
+
 #include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
 
 namespace tflite {
 namespace gpu {
@@ -188,8 +193,24 @@ absl::Status ClOperation::RestoreDeserialized(const ProgramCache& program_cache,
   return absl::OkStatus();
 }
 
+uint64_t ClOperation::GetTuningKey() const {
+  // The kernel code and the shapes of its tensors determine the candidate
+  // work group sizes and their performance.
+  std::string key = absl::StrCat(kernel_fingerprint_);
+  for (const auto* tensors :
+       {&operation_->GetSrcTensors(), &operation_->GetDstTensors()}) {
+    for (const GpuSpatialTensor* tensor : *tensors) {
+      absl::StrAppend(&key, ";", tensor->Batch(), ",", tensor->Width(), ",",
+                      tensor->Height(), ",", tensor->Depth(), ",",
+                      tensor->Channels());
+    }
+  }
+  return ::util::Fingerprint64(key);
+}
+
 absl::Status ClOperation::Tune(TuningType tuning_type, const GpuInfo& gpu_info,
-                               ProfilingCommandQueue* profiling_queue) {
+                               ProfilingCommandQueue* profiling_queue,
+                               TuningCache* tuning_cache) {
   std::vector<GPUOperation::DispatchInfo> possible_dispatches;
   operation_->GetPossibleDispatches(tuning_type, gpu_info, kernel_.info_,
                                     &possible_dispatches);
@@ -200,22 +221,38 @@ absl::Status ClOperation::Tune(TuningType tuning_type, const GpuInfo& gpu_info,
     operation_->work_group_size_ = possible_dispatches[0].work_group_size;
     operation_->RecalculateWorkGroupsCount();
     return absl::OkStatus();
-  } else {
-    std::vector<int3> work_group_sizes(possible_dispatches.size());
-    std::vector<int3> work_groups_counts(possible_dispatches.size());
-    for (int i = 0; i < possible_dispatches.size(); ++i) {
-      work_group_sizes[i] = possible_dispatches[i].work_group_size;
-      work_groups_counts[i] = possible_dispatches[i].work_groups_count;
+  }
+  const uint64_t tuning_key = tuning_cache ? GetTuningKey() : 0;
+  int3 cached_work_group_size;
+  if (tuning_cache && tuning_cache->Find(gpu_info, tuning_type, tuning_key,
+                                         &cached_work_group_size)) {
+    // Entries of other devices or driver versions might not be valid here.
+    for (const auto& dispatch : possible_dispatches) {
+      if (dispatch.work_group_size == cached_work_group_size) {
+        operation_->work_group_size_ = cached_work_group_size;
+        operation_->RecalculateWorkGroupsCount();
+        return absl::OkStatus();
+      }
     }
-    RETURN_IF_ERROR(cl_args_.Bind(kernel_.kernel()));
-    int best_work_group_index;
-    RETURN_IF_ERROR(profiling_queue->GetBestWorkGroupIndex(
-        kernel_, gpu_info, work_groups_counts, work_group_sizes,
-        &best_work_group_index));
-    operation_->work_group_size_ = work_group_sizes[best_work_group_index];
-    operation_->RecalculateWorkGroupsCount();
-    return absl::OkStatus();
   }
+  std::vector<int3> work_group_sizes(possible_dispatches.size());
+  std::vector<int3> work_groups_counts(possible_dispatches.size());
+  for (int i = 0; i < possible_dispatches.size(); ++i) {
+    work_group_sizes[i] = possible_dispatches[i].work_group_size;
+    work_groups_counts[i] = possible_dispatches[i].work_groups_count;
+  }
+  RETURN_IF_ERROR(cl_args_.Bind(kernel_.kernel()));
+  int best_work_group_index;
+  RETURN_IF_ERROR(profiling_queue->GetBestWorkGroupIndex(
+      kernel_, gpu_info, work_groups_counts, work_group_sizes,
+      &best_work_group_index));
+  operation_->work_group_size_ = work_group_sizes[best_work_group_index];
+  operation_->RecalculateWorkGroupsCount();
+  if (tuning_cache) {
+    tuning_cache->Add(gpu_info, tuning_type, tuning_key,
+                      operation_->work_group_size_);
+  }
+  return absl::OkStatus();
 }
 
 }  // namespace cl
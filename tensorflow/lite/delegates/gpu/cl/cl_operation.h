@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/lite/delegates/gpu/cl/cl_kernel.h"
 #include "tensorflow/lite/delegates/gpu/cl/program_cache.h"
 #include "tensorflow/lite/delegates/gpu/cl/tensor.h"
+#include "tensorflow/lite/delegates/gpu/cl/tuning_cache.h"
 #include "tensorflow/lite/delegates/gpu/common/task/gpu_operation.h"
 
 namespace tflite {
@@ -110,8 +111,12 @@ class ClOperation {
                                  operation_->work_group_size_, n, flush_period);
   }
 
+  // Picks the work group size. If `tuning_cache` is set, the size tuned for
+  // this kernel and these tensor shapes on this GPU model is reused when
+  // there is one, and the tuned size is added to it otherwise.
   absl::Status Tune(TuningType tuning_type, const GpuInfo& gpu_info,
-                    ProfilingCommandQueue* profiling_queue);
+                    ProfilingCommandQueue* profiling_queue,
+                    TuningCache* tuning_cache = nullptr);
 
   absl::Status Compile(const CreationContext& creation_context);
 
@@ -128,6 +133,9 @@ class ClOperation {
   }
 
  private:
+  // Returns the key of this operation in a TuningCache.
+  uint64_t GetTuningKey() const;
+
   std::unique_ptr<GPUOperation> operation_;
   CLKernel kernel_;
   uint64_t kernel_fingerprint_;
@@ -357,8 +357,8 @@ absl::Status InferenceContext::InitFromGpuModel(
       tuning_type = TuningType::kFast;
     }
   }
-  RETURN_IF_ERROR(
-      Tune(tuning_type, env->device().GetInfo(), env->profiling_queue()));
+  RETURN_IF_ERROR(Tune(tuning_type, env->device().GetInfo(),
+                       env->profiling_queue(), env->tuning_cache()));
   if (external_mutable_tensors_.empty()) {
     // using recordable queue only when no mutable external tensors
     InitRecordableQueue(env);
@@ -753,7 +753,8 @@ absl::Status InferenceContext::Compile(
 
 absl::Status InferenceContext::Tune(TuningType tuning_type,
                                     const GpuInfo& gpu_info,
-                                    ProfilingCommandQueue* profiling_queue) {
+                                    ProfilingCommandQueue* profiling_queue,
+                                    TuningCache* tuning_cache) {
   // Cache tuned CL operations. Multiple CL operations might share the
   // same kernel but use different inputs, which might require different working
   // group setups. Therefore, we store a vector of tuned cl operations for each
@@ -780,8 +781,8 @@ absl::Status InferenceContext::Tune(TuningType tuning_type,
     if (found_cached_cl_op) {
       continue;
     }
-    RETURN_IF_ERROR(
-        node.cl_operation.Tune(tuning_type, gpu_info, profiling_queue));
+    RETURN_IF_ERROR(node.cl_operation.Tune(tuning_type, gpu_info,
+                                           profiling_queue, tuning_cache));
     tuned_ops[fingerprint].emplace_back(std::cref(node.cl_operation));
   }
   return absl::OkStatus();
@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/lite/delegates/gpu/cl/recordable_queue_builder.h"
 #include "tensorflow/lite/delegates/gpu/cl/serialization_generated.h"
 #include "tensorflow/lite/delegates/gpu/cl/tensor.h"
+#include "tensorflow/lite/delegates/gpu/cl/tuning_cache.h"
 #include "tensorflow/lite/delegates/gpu/common/gpu_model.h"
 #include "tensorflow/lite/delegates/gpu/common/model.h"
 #include "tensorflow/lite/delegates/gpu/common/model_hints.h"
@@ -141,7 +142,8 @@ class InferenceContext {
   void BindMemoryToOperations();
   absl::Status Compile(const CreationContext& creation_context);
   absl::Status Tune(TuningType tuning_type, const GpuInfo& gpu_info,
-                    ProfilingCommandQueue* profiling_queue);
+                    ProfilingCommandQueue* profiling_queue,
+                    TuningCache* tuning_cache);
   absl::Status UpdateParams();
   void PrepareExternal();
 
@@ -0,0 +1,177 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/lite/delegates/gpu/cl/tuning_cache.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "tensorflow/lite/delegates/gpu/common/gpu_info.h"
+#include "tensorflow/lite/delegates/gpu/common/status.h"
+#include "tensorflow/lite/delegates/gpu/common/task/tuning_type.h"
+#include "tensorflow/lite/delegates/gpu/common/types.h"
+
+namespace tflite {
+namespace gpu {
+namespace cl {
+namespace {
+
+// Serialized cache layout, in host byte order:
+//   magic, version, entries count, then for each entry:
+//   device name size, device name, operation key, work group size (x, y, z),
+//   tuning type.
+constexpr char kMagic[4] = {'T', 'G', 'W', 'G'};
+constexpr uint32_t kVersion = 1;
+// Size of an entry with an empty device name.
+constexpr size_t kMinEntrySize =
+    sizeof(uint32_t) + sizeof(uint64_t) + 3 * sizeof(int32_t) + 1;
+
+template <typename T>
+void Append(const T& value, std::vector<uint8_t>* data) {
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+  data->insert(data->end(), bytes, bytes + sizeof(T));
+}
+
+class Reader {
+ public:
+  explicit Reader(absl::Span<const uint8_t> data) : data_(data) {}
+
+  template <typename T>
+  bool Read(T* value) {
+    if (data_.size() < sizeof(T)) return false;
+    std::memcpy(value, data_.data(), sizeof(T));
+    data_.remove_prefix(sizeof(T));
+    return true;
+  }
+
+  bool ReadString(uint32_t size, std::string* value) {
+    if (data_.size() < size) return false;
+    value->assign(reinterpret_cast<const char*>(data_.data()), size);
+    data_.remove_prefix(size);
+    return true;
+  }
+
+ private:
+  absl::Span<const uint8_t> data_;
+};
+
+}  // namespace
+
+std::string TuningCache::GetDeviceName(const GpuInfo& gpu_info) {
+  return gpu_info.opencl_info.device_name;
+}
+
+bool TuningCache::Find(const GpuInfo& gpu_info, TuningType tuning_type,
+                       uint64_t operation_key, int3* work_group_size) const {
+  auto it = entries_.find({GetDeviceName(gpu_info), operation_key});
+  if (it == entries_.end()) return false;
+  if (it->second.tuning_type != tuning_type &&
+      it->second.tuning_type != TuningType::kExhaustive) {
+    return false;
+  }
+  *work_group_size = it->second.work_group_size;
+  return true;
+}
+
+void TuningCache::Add(const GpuInfo& gpu_info, TuningType tuning_type,
+                      uint64_t operation_key, const int3& work_group_size) {
+  Add(GetDeviceName(gpu_info), operation_key, {work_group_size, tuning_type});
+}
+
+void TuningCache::Add(const std::string& device_name, uint64_t operation_key,
+                      const Entry& entry) {
+  auto it = entries_.find({device_name, operation_key});
+  if (it == entries_.end()) {
+    entries_.insert({{device_name, operation_key}, entry});
+  } else if (entry.tuning_type == TuningType::kExhaustive ||
+             it->second.tuning_type != TuningType::kExhaustive) {
+    it->second = entry;
+  }
+}
+
+absl::Status TuningCache::AddSerializedCache(
+    absl::Span<const uint8_t> serialized_cache) {
+  Reader reader(serialized_cache);
+  char magic[sizeof(kMagic)];
+  uint32_t version;
+  uint32_t entries_count;
+  if (!reader.Read(&magic) ||
+      std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 ||
+      !reader.Read(&version) || version != kVersion ||
+      !reader.Read(&entries_count) ||
+      entries_count > serialized_cache.size() / kMinEntrySize) {
+    return absl::InvalidArgumentError("Invalid tuning cache.");
+  }
+  struct NamedEntry {
+    std::string device_name;
+    uint64_t operation_key;
+    Entry entry;
+  };
+  std::vector<NamedEntry> entries(entries_count);
+  for (NamedEntry& named_entry : entries) {
+    uint32_t name_size;
+    uint8_t tuning_type;
+    int3& work_group_size = named_entry.entry.work_group_size;
+    if (!reader.Read(&name_size) ||
+        !reader.ReadString(name_size, &named_entry.device_name) ||
+        !reader.Read(&named_entry.operation_key) ||
+        !reader.Read(&work_group_size.x) || !reader.Read(&work_group_size.y) ||
+        !reader.Read(&work_group_size.z) || !reader.Read(&tuning_type) ||
+        tuning_type > static_cast<uint8_t>(TuningType::kFast)) {
+      return absl::InvalidArgumentError("Tuning cache is corrupted.");
+    }
+    named_entry.entry.tuning_type = static_cast<TuningType>(tuning_type);
+  }
+  for (const NamedEntry& named_entry : entries) {
+    Add(named_entry.device_name, named_entry.operation_key,
+        named_entry.entry);
+  }
+  return absl::OkStatus();
+}
+
+void TuningCache::GetSerializedCache(std::vector<uint8_t>* serialized_cache,
+                                     const std::string& device_name) const {
+  uint32_t entries_count = 0;
+  for (const auto& entry : entries_) {
+    if (device_name.empty() || entry.first.first == device_name) {
+      ++entries_count;
+    }
+  }
+  serialized_cache->insert(serialized_cache->end(), kMagic,
+                           kMagic + sizeof(kMagic));
+  Append(kVersion, serialized_cache);
+  Append(entries_count, serialized_cache);
+  for (const auto& entry : entries_) {
+    if (!device_name.empty() && entry.first.first != device_name) continue;
+    const std::string& name = entry.first.first;
+    Append(static_cast<uint32_t>(name.size()), serialized_cache);
+    serialized_cache->insert(serialized_cache->end(), name.begin(),
+                             name.end());
+    Append(entry.first.second, serialized_cache);
+    Append(entry.second.work_group_size.x, serialized_cache);
+    Append(entry.second.work_group_size.y, serialized_cache);
+    Append(entry.second.work_group_size.z, serialized_cache);
+    Append(static_cast<uint8_t>(entry.second.tuning_type), serialized_cache);
+  }
+}
+
+}  // namespace cl
+}  // namespace gpu
+}  // namespace tflite
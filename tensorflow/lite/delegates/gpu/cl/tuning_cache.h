@@ -0,0 +1,92 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#ifndef TENSORFLOW_LITE_DELEGATES_GPU_CL_TUNING_CACHE_H_
+#define TENSORFLOW_LITE_DELEGATES_GPU_CL_TUNING_CACHE_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "tensorflow/lite/delegates/gpu/common/gpu_info.h"
+#include "tensorflow/lite/delegates/gpu/common/status.h"
+#include "tensorflow/lite/delegates/gpu/common/task/tuning_type.h"
+#include "tensorflow/lite/delegates/gpu/common/types.h"
+
+namespace tflite {
+namespace gpu {
+namespace cl {
+
+// Work group sizes found by tuning operations, per GPU model, so that they
+// can be reused without tuning again, e.g. by later loads of the same model,
+// or by other devices with the same GPU.
+//
+// An operation is identified by a 64-bit key, see ClOperation::Tune. Entries
+// found by exhaustive tuning are used for both tuning types, and are not
+// replaced by entries found by fast tuning.
+class TuningCache {
+ public:
+  TuningCache() = default;
+
+  // Move only
+  TuningCache(TuningCache&& tuning_cache) = default;
+  TuningCache& operator=(TuningCache&& tuning_cache) = default;
+  TuningCache(const TuningCache&) = delete;
+  TuningCache& operator=(const TuningCache&) = delete;
+
+  // Returns the GPU model string that entries are stored under.
+  static std::string GetDeviceName(const GpuInfo& gpu_info);
+
+  // Returns true and sets `work_group_size` if the operation was tuned on
+  // this GPU model with `tuning_type` or exhaustively.
+  bool Find(const GpuInfo& gpu_info, TuningType tuning_type,
+            uint64_t operation_key, int3* work_group_size) const;
+
+  void Add(const GpuInfo& gpu_info, TuningType tuning_type,
+           uint64_t operation_key, const int3& work_group_size);
+
+  int Size() const { return entries_.size(); }
+
+  // Adds the entries of data returned by GetSerializedCache. The cache is
+  // unchanged if the data is invalid.
+  absl::Status AddSerializedCache(absl::Span<const uint8_t> serialized_cache);
+
+  // Appends the entries to `serialized_cache`. If `device_name` is not empty,
+  // only the entries of that GPU model are serialized, e.g. to distribute
+  // them to all devices with that GPU.
+  void GetSerializedCache(std::vector<uint8_t>* serialized_cache,
+                          const std::string& device_name = "") const;
+
+ private:
+  struct Entry {
+    int3 work_group_size;
+    TuningType tuning_type;
+  };
+
+  void Add(const std::string& device_name, uint64_t operation_key,
+           const Entry& entry);
+
+  absl::flat_hash_map<std::pair<std::string, uint64_t>, Entry> entries_;
+};
+
+}  // namespace cl
+}  // namespace gpu
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_DELEGATES_GPU_CL_TUNING_CACHE_H_
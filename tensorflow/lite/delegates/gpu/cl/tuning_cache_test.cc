@@ -0,0 +1,115 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/lite/delegates/gpu/cl/tuning_cache.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/delegates/gpu/common/gpu_info.h"
+#include "tensorflow/lite/delegates/gpu/common/task/tuning_type.h"
+#include "tensorflow/lite/delegates/gpu/common/types.h"
+
+namespace tflite {
+namespace gpu {
+namespace cl {
+namespace {
+
+GpuInfo GetGpuInfo(const std::string& device_name) {
+  GpuInfo gpu_info;
+  gpu_info.opencl_info.device_name = device_name;
+  return gpu_info;
+}
+
+TEST(TuningCacheTest, FindAndAdd) {
+  const GpuInfo gpu_info = GetGpuInfo("Adreno (TM) 740");
+  TuningCache cache;
+  int3 work_group_size;
+  EXPECT_FALSE(
+      cache.Find(gpu_info, TuningType::kFast, 1, &work_group_size));
+
+  cache.Add(gpu_info, TuningType::kFast, 1, int3(8, 4, 1));
+  ASSERT_TRUE(cache.Find(gpu_info, TuningType::kFast, 1, &work_group_size));
+  EXPECT_EQ(work_group_size, int3(8, 4, 1));
+  // Fast tuning results are not used for exhaustive tuning.
+  EXPECT_FALSE(
+      cache.Find(gpu_info, TuningType::kExhaustive, 1, &work_group_size));
+  EXPECT_FALSE(cache.Find(GetGpuInfo("Mali-G715"), TuningType::kFast, 1,
+                          &work_group_size));
+
+  // Exhaustive tuning results replace fast ones and are used for both.
+  cache.Add(gpu_info, TuningType::kExhaustive, 1, int3(16, 2, 1));
+  cache.Add(gpu_info, TuningType::kFast, 1, int3(4, 4, 1));
+  ASSERT_TRUE(cache.Find(gpu_info, TuningType::kFast, 1, &work_group_size));
+  EXPECT_EQ(work_group_size, int3(16, 2, 1));
+  ASSERT_TRUE(
+      cache.Find(gpu_info, TuningType::kExhaustive, 1, &work_group_size));
+  EXPECT_EQ(work_group_size, int3(16, 2, 1));
+  EXPECT_EQ(cache.Size(), 1);
+}
+
+TEST(TuningCacheTest, Serialization) {
+  const GpuInfo adreno = GetGpuInfo("Adreno (TM) 740");
+  const GpuInfo mali = GetGpuInfo("Mali-G715");
+  TuningCache cache;
+  cache.Add(adreno, TuningType::kExhaustive, 1, int3(16, 2, 1));
+  cache.Add(adreno, TuningType::kFast, 2, int3(8, 8, 1));
+  cache.Add(mali, TuningType::kExhaustive, 1, int3(4, 4, 4));
+
+  std::vector<uint8_t> all;
+  cache.GetSerializedCache(&all);
+  TuningCache restored;
+  ASSERT_TRUE(restored.AddSerializedCache(all).ok());
+  EXPECT_EQ(restored.Size(), 3);
+  int3 work_group_size;
+  ASSERT_TRUE(restored.Find(adreno, TuningType::kFast, 2, &work_group_size));
+  EXPECT_EQ(work_group_size, int3(8, 8, 1));
+  ASSERT_TRUE(
+      restored.Find(mali, TuningType::kExhaustive, 1, &work_group_size));
+  EXPECT_EQ(work_group_size, int3(4, 4, 4));
+
+  std::vector<uint8_t> adreno_only;
+  cache.GetSerializedCache(&adreno_only, TuningCache::GetDeviceName(adreno));
+  TuningCache exported;
+  ASSERT_TRUE(exported.AddSerializedCache(adreno_only).ok());
+  EXPECT_EQ(exported.Size(), 2);
+  EXPECT_FALSE(
+      exported.Find(mali, TuningType::kExhaustive, 1, &work_group_size));
+}
+
+TEST(TuningCacheTest, InvalidData) {
+  TuningCache cache;
+  cache.Add(GetGpuInfo("Adreno (TM) 740"), TuningType::kFast, 1,
+            int3(8, 4, 1));
+  std::vector<uint8_t> data;
+  cache.GetSerializedCache(&data);
+
+  TuningCache restored;
+  std::vector<uint8_t> truncated(data.begin(), data.end() - 1);
+  EXPECT_FALSE(restored.AddSerializedCache(truncated).ok());
+  std::vector<uint8_t> bad_magic = data;
+  bad_magic[0] = 'X';
+  EXPECT_FALSE(restored.AddSerializedCache(bad_magic).ok());
+  EXPECT_FALSE(restored.AddSerializedCache({}).ok());
+  EXPECT_EQ(restored.Size(), 0);
+}
+
+}  // namespace
+}  // namespace cl
+}  // namespace gpu
+}  // namespace tflite
@@ -18,18 +18,22 @@ limitations under the License.
 #include <fstream>
 #include <iostream>
 #else
+#include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <sys/file.h>
 #include <unistd.h>
-
-#include <cstring>
 #endif  // defined(_WIN32)
 
 #include <time.h>
 
 #include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <vector>
@@ -44,6 +48,46 @@ namespace {
 
 static const char kDelegatedNodesSuffix[] = "_dnodes";
 
+// Header written before the data of every entry, to detect data that was
+// truncated, corrupted, or written by an incompatible version of this file.
+struct EntryHeader {
+  char magic[4];
+  uint32_t version;
+  uint64_t data_size;
+  uint64_t data_fingerprint;
+};
+
+constexpr char kEntryMagic[4] = {'T', 'F', 'L', 'S'};
+constexpr uint32_t kEntryVersion = 1;
+
+EntryHeader MakeEntryHeader(const char* data, size_t size) {
+  EntryHeader header;
+  std::copy(kEntryMagic, kEntryMagic + sizeof(kEntryMagic), header.magic);
+  header.version = kEntryVersion;
+  header.data_size = size;
+  header.data_fingerprint = ::util::Fingerprint64(data, size);
+  return header;
+}
+
+// Checks the header of the entry read into `contents`, and removes it. Returns
+// false if the entry is not valid.
+bool ValidateAndStripEntryHeader(std::string* contents) {
+  EntryHeader header;
+  if (contents->size() < sizeof(header)) return false;
+  std::memcpy(&header, contents->data(), sizeof(header));
+  if (!std::equal(kEntryMagic, kEntryMagic + sizeof(kEntryMagic),
+                  header.magic) ||
+      header.version != kEntryVersion ||
+      header.data_size != contents->size() - sizeof(header) ||
+      header.data_fingerprint !=
+          ::util::Fingerprint64(contents->data() + sizeof(header),
+                                header.data_size)) {
+    return false;
+  }
+  contents->erase(0, sizeof(header));
+  return true;
+}
+
 // Farmhash Fingerprint
 inline uint64_t CombineFingerprints(uint64_t l, uint64_t h) {
   // Murmur-inspired hashing.
@@ -70,6 +114,50 @@ inline std::string GetFilePath(const std::string& cache_dir,
   return JoinPath(cache_dir, file_name);
 }
 
+// Returns a path that no other write uses, to write the data of an entry to
+// before renaming it to its final path.
+std::string GetTempFilePath(const std::string& cache_dir,
+                            const std::string& model_token,
+                            const uint64_t fingerprint) {
+  static std::atomic<uint64_t> counter{0};
+  std::string file_name = model_token + "_" + std::to_string(fingerprint) +
+                          ".tmp" + std::to_string(time(nullptr)) + "_" +
+                          std::to_string(counter++);
+#if !defined(_WIN32)
+  file_name += "_" + std::to_string(getpid());
+#endif  // !defined(_WIN32)
+  return JoinPath(cache_dir, file_name);
+}
+
+// Returns true if `file_name` is the data or a temporary file of an entry of
+// the model, as named by GetFilePath and GetTempFilePath.
+bool IsEntryFileName(const std::string& file_name,
+                     const std::string& model_token) {
+  const std::string prefix = model_token + "_";
+  if (file_name.compare(0, prefix.size(), prefix) != 0) return false;
+  size_t end = prefix.size();
+  while (end < file_name.size() &&
+         std::isdigit(static_cast<unsigned char>(file_name[end]))) {
+    ++end;
+  }
+  if (end == prefix.size()) return false;
+  const std::string suffix = file_name.substr(end);
+  return suffix == ".bin" || suffix.compare(0, 4, ".tmp") == 0;
+}
+
+#if !defined(_WIN32)
+// Writes all `size` bytes of `data` to `fd`.
+bool WriteAll(int fd, const char* data, size_t size) {
+  while (size > 0) {
+    const ssize_t ret = write(fd, data, size);
+    if (ret <= 0) return false;
+    data += ret;
+    size -= ret;
+  }
+  return true;
+}
+#endif  // !defined(_WIN32)
+
 }  // namespace
 
 std::string StrFingerprint(const void* data, const size_t num_bytes) {
@@ -90,8 +178,8 @@ TfLiteStatus SerializationEntry::SetData(TfLiteContext* context,
   auto filepath = GetFilePath(cache_dir_, model_token_, fingerprint_);
   // Temporary file to write data to.
   const std::string temp_filepath =
-      JoinPath(cache_dir_, (model_token_ + std::to_string(fingerprint_) +
-                            std::to_string(time(nullptr))));
+      GetTempFilePath(cache_dir_, model_token_, fingerprint_);
+  const EntryHeader header = MakeEntryHeader(data, size);
 
 #if defined(_WIN32)
   std::ofstream out_file(temp_filepath.c_str(), std::ios_base::binary);
@@ -100,53 +188,51 @@ TfLiteStatus SerializationEntry::SetData(TfLiteContext* context,
                     temp_filepath.c_str());
     return kTfLiteDelegateDataWriteError;
   }
+  out_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
   out_file.write(data, size);
   out_file.flush();
   out_file.close();
   // rename is an atomic operation in most systems.
   if (rename(temp_filepath.c_str(), filepath.c_str()) < 0) {
     TF_LITE_KERNEL_LOG(context, "Failed to rename to %s", filepath.c_str());
+    std::remove(temp_filepath.c_str());
     return kTfLiteDelegateDataWriteError;
   }
 #else   // !defined(_WIN32)
   // This method only works on unix/POSIX systems.
   const int fd = open(temp_filepath.c_str(),
-                      O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0600);
+                      O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
   if (fd < 0) {
     TF_LITE_KERNEL_LOG(context, "Failed to open for writing: %s",
                        temp_filepath.c_str());
     return kTfLiteDelegateDataWriteError;
   }
-  // Loop until all bytes written.
-  ssize_t len = 0;
-  const char* buf = data;
-  do {
-    ssize_t ret = write(fd, buf, size);
-    if (ret <= 0) {
-      close(fd);
-      TF_LITE_KERNEL_LOG(context, "Failed to write data to: %s, error: %s",
-                         temp_filepath.c_str(), std::strerror(errno));
-      return kTfLiteDelegateDataWriteError;
-    }
-
-    len += ret;
-    buf += ret;
-  } while (len < static_cast<ssize_t>(size));
+  if (!WriteAll(fd, reinterpret_cast<const char*>(&header), sizeof(header)) ||
+      !WriteAll(fd, data, size)) {
+    TF_LITE_KERNEL_LOG(context, "Failed to write data to: %s, error: %s",
+                       temp_filepath.c_str(), std::strerror(errno));
+    close(fd);
+    unlink(temp_filepath.c_str());
+    return kTfLiteDelegateDataWriteError;
+  }
   // Use fsync to ensure data is on disk before renaming temp file.
   if (fsync(fd) < 0) {
-    close(fd);
     TF_LITE_KERNEL_LOG(context, "Could not fsync: %s, error: %s",
                        temp_filepath.c_str(), std::strerror(errno));
+    close(fd);
+    unlink(temp_filepath.c_str());
     return kTfLiteDelegateDataWriteError;
   }
   if (close(fd) < 0) {
     TF_LITE_KERNEL_LOG(context, "Could not close fd: %s, error: %s",
                        temp_filepath.c_str(), std::strerror(errno));
+    unlink(temp_filepath.c_str());
     return kTfLiteDelegateDataWriteError;
   }
   if (rename(temp_filepath.c_str(), filepath.c_str()) < 0) {
     TF_LITE_KERNEL_LOG(context, "Failed to rename to %s, error: %s",
                        filepath.c_str(), std::strerror(errno));
+    unlink(temp_filepath.c_str());
     return kTfLiteDelegateDataWriteError;
   }
 #endif  // defined(_WIN32)
@@ -199,7 +285,7 @@ TfLiteStatus SerializationEntry::GetData(TfLiteContext* context,
     if (bytes_read == 0) {
       // EOF
       close(fd);
-      return kTfLiteOk;
+      break;
     } else if (bytes_read < 0) {
       close(fd);
       TF_LITE_KERNEL_LOG(context, "Error reading %s: %s", filepath.c_str(),
@@ -215,6 +301,15 @@ TfLiteStatus SerializationEntry::GetData(TfLiteContext* context,
                   "Found serialized data for model %s (%d B) at %s",
                   model_token_.c_str(), data->size(), filepath.c_str());
 
+  if (!data->empty() && !ValidateAndStripEntryHeader(data)) {
+    // E.g. written by an older version, or damaged on disk. The entry is
+    // removed, so that it gets written again.
+    TF_LITE_KERNEL_LOG(context, "Invalid serialized data in %s, removing it",
+                       filepath.c_str());
+    data->clear();
+    std::remove(filepath.c_str());
+    return kTfLiteDelegateDataNotFound;
+  }
   if (!data->empty()) {
     TFLITE_LOG(TFLITE_LOG_INFO, "Data found at %s: %d bytes", filepath.c_str(),
                data->size());
@@ -226,6 +321,49 @@ TfLiteStatus SerializationEntry::GetData(TfLiteContext* context,
   }
 }
 
+TfLiteStatus SerializationEntry::RemoveData(TfLiteContext* context) const {
+  const auto filepath = GetFilePath(cache_dir_, model_token_, fingerprint_);
+  if (std::remove(filepath.c_str()) != 0 && errno != ENOENT) {
+    TF_LITE_KERNEL_LOG(context, "Could not remove %s: %s", filepath.c_str(),
+                       std::strerror(errno));
+    return kTfLiteDelegateDataWriteError;
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus Serialization::RemoveAllData(TfLiteContext* context) {
+#if defined(_WIN32)
+  TF_LITE_KERNEL_LOG(context, "Removing all data is not supported on Windows");
+  return kTfLiteError;
+#else   // !defined(_WIN32)
+  DIR* dir = opendir(cache_dir_.c_str());
+  if (dir == nullptr) {
+    if (errno == ENOENT) return kTfLiteOk;
+    TF_LITE_KERNEL_LOG(context, "Could not open %s: %s", cache_dir_.c_str(),
+                       std::strerror(errno));
+    return kTfLiteDelegateDataReadError;
+  }
+  std::vector<std::string> file_names;
+  while (const dirent* entry = readdir(dir)) {
+    if (IsEntryFileName(entry->d_name, model_token_)) {
+      file_names.push_back(entry->d_name);
+    }
+  }
+  closedir(dir);
+
+  TfLiteStatus status = kTfLiteOk;
+  for (const std::string& file_name : file_names) {
+    const std::string filepath = JoinPath(cache_dir_, file_name);
+    if (unlink(filepath.c_str()) < 0 && errno != ENOENT) {
+      TF_LITE_KERNEL_LOG(context, "Could not remove %s: %s", filepath.c_str(),
+                         std::strerror(errno));
+      status = kTfLiteDelegateDataWriteError;
+    }
+  }
+  return status;
+#endif  // defined(_WIN32)
+}
+
 SerializationEntry Serialization::GetEntryImpl(
     const std::string& custom_key, TfLiteContext* context,
     const TfLiteDelegateParams* delegate_params) {
@@ -86,6 +86,11 @@ std::string StrFingerprint(const void* data, const size_t num_bytes);
 // parameters used during initialization via
 // Serialization::GetEntryForDelegate/GetEntryForKernel.
 //
+// Data is stored with a header holding its size and fingerprint, so data that
+// was truncated or corrupted on disk (e.g. by a crash while writing it) is
+// removed and reported as kTfLiteDelegateDataNotFound instead of being
+// returned.
+//
 // NOTE: TFLite cannot guarantee that the read data is always fully valid,
 // especially if the directory is accessible to other applications/processes.
 // It is the delegate's responsibility to validate the retrieved data.
@@ -119,6 +124,14 @@ class SerializationEntry {
   //   kTfLiteError for unexpected error.
   TfLiteStatus GetData(TfLiteContext* context, std::string* data) const;
 
+  // Removes the data corresponding to this key, if any, e.g. after the
+  // delegate failed to use it.
+  //
+  // Returns:
+  //   kTfLiteOk if there is no data left for this key
+  //   kTfLiteDelegateDataWriteError if the data could not be removed.
+  TfLiteStatus RemoveData(TfLiteContext* context) const;
+
   // Non-copyable.
   SerializationEntry(const SerializationEntry&) = delete;
   SerializationEntry& operator=(const SerializationEntry&) = delete;
@@ -170,7 +183,10 @@ class Serialization {
   // `context` into its unique fingerprint.
   //  Should be used to handle data common to all delegate kernels.
   // Delegates can incorporate versions & init arguments in custom_key using
-  // StrFingerprint().
+  // StrFingerprint(). Data that is only valid on one device, like compiled
+  // kernels, should also include the device & driver identifiers, so that it
+  // is not reused when the cache directory moves to another device or the
+  // driver is updated.
   SerializationEntry GetEntryForDelegate(const std::string& custom_key,
                                          TfLiteContext* context) {
     return GetEntryImpl(custom_key, context);
@@ -188,6 +204,17 @@ class Serialization {
     return GetEntryImpl(custom_key, context, partition_params);
   }
 
+  // Removes the data of all entries of the model, e.g. when the model or the
+  // delegate is updated in place and old data should not take space anymore.
+  // Entries of other models in the same directory are kept.
+  //
+  // Returns:
+  //   kTfLiteOk if all the data was removed
+  //   kTfLiteDelegateDataReadError if the directory could not be listed
+  //   kTfLiteDelegateDataWriteError if some data could not be removed
+  //   kTfLiteError if not supported on this platform.
+  TfLiteStatus RemoveAllData(TfLiteContext* context);
+
   // Non-copyable.
   Serialization(const Serialization&) = delete;
   Serialization& operator=(const Serialization&) = delete;
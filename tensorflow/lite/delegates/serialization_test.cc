@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/lite/delegates/serialization.h"
 
 #include <cstdint>
+#include <fstream>
 #include <string>
 #include <vector>
 
@@ -367,6 +368,107 @@ TEST_F(SerializationTest, CachingDelegatedNodes) {
   TfLiteIntArrayFree(empty_nodes_array);
 }
 
+// Returns the path of the file holding the data of `entry`.
+std::string GetEntryFilePath(const std::string& dir,
+                             const std::string& model_token,
+                             const SerializationEntry& entry) {
+  return dir + "/" + model_token + "_" +
+         std::to_string(entry.GetFingerprint()) + ".bin";
+}
+
+TEST_F(SerializationTest, CorruptedDataIsRemoved) {
+  const std::string model_token = "model_corrupted";
+  const std::string test_dir = getSerializationDir();
+  TfLiteContext context = GenerateTfLiteContext(/*num_tensors*/ 30);
+  SerializationParams serialization_params = {model_token.c_str(),
+                                              test_dir.c_str()};
+  Serialization serialization(serialization_params);
+  auto entry = serialization.GetEntryForDelegate("test", &context);
+  const std::string data = "some serialized kernels";
+  const std::string filepath = GetEntryFilePath(test_dir, model_token, entry);
+
+  // Truncated data, e.g. by a crash.
+  ASSERT_EQ(entry.SetData(&context, data.data(), data.size()), kTfLiteOk);
+  {
+    std::ifstream in(filepath, std::ios::binary);
+    std::string contents((std::istreambuf_iterator<char>(in)),
+                         std::istreambuf_iterator<char>());
+    std::ofstream out(filepath, std::ios::binary | std::ios::trunc);
+    out.write(contents.data(), contents.size() - 1);
+  }
+  std::string read_back;
+  EXPECT_EQ(entry.GetData(&context, &read_back), kTfLiteDelegateDataNotFound);
+  EXPECT_TRUE(read_back.empty());
+  EXPECT_FALSE(std::ifstream(filepath).good());
+
+  // Corrupted data.
+  ASSERT_EQ(entry.SetData(&context, data.data(), data.size()), kTfLiteOk);
+  {
+    std::fstream file(filepath,
+                      std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(-1, std::ios::end);
+    file.put('!');
+  }
+  EXPECT_EQ(entry.GetData(&context, &read_back), kTfLiteDelegateDataNotFound);
+  EXPECT_FALSE(std::ifstream(filepath).good());
+
+  // Data without a header.
+  {
+    std::ofstream out(filepath, std::ios::binary);
+    out << data;
+  }
+  EXPECT_EQ(entry.GetData(&context, &read_back), kTfLiteDelegateDataNotFound);
+
+  // Data is written again after being removed.
+  ASSERT_EQ(entry.SetData(&context, data.data(), data.size()), kTfLiteOk);
+  ASSERT_EQ(entry.GetData(&context, &read_back), kTfLiteOk);
+  EXPECT_EQ(read_back, data);
+}
+
+TEST_F(SerializationTest, RemoveData) {
+  const std::string model_token = "model_remove";
+  const std::string other_model_token = "model_remove_other";
+  const std::string test_dir = getSerializationDir();
+  TfLiteContext context = GenerateTfLiteContext(/*num_tensors*/ 30);
+  TfLiteDelegateParams partition = GenerateTfLiteDelegateParams(
+      /*num_nodes=*/2, /*num_input_tensors=*/3, /*num_output_tensors=*/1);
+  SerializationParams serialization_params = {model_token.c_str(),
+                                              test_dir.c_str()};
+  Serialization serialization(serialization_params);
+  SerializationParams other_serialization_params = {other_model_token.c_str(),
+                                                    test_dir.c_str()};
+  Serialization other_serialization(other_serialization_params);
+  const std::string data = "data";
+
+  auto delegate_entry = serialization.GetEntryForDelegate("test", &context);
+  auto kernel_entry =
+      serialization.GetEntryForKernel("test", &context, &partition);
+  auto other_entry = other_serialization.GetEntryForDelegate("test", &context);
+  for (const auto* entry : {&delegate_entry, &kernel_entry, &other_entry}) {
+    ASSERT_EQ(entry->SetData(&context, data.data(), data.size()), kTfLiteOk);
+  }
+
+  std::string read_back;
+  ASSERT_EQ(delegate_entry.RemoveData(&context), kTfLiteOk);
+  EXPECT_EQ(delegate_entry.GetData(&context, &read_back),
+            kTfLiteDelegateDataNotFound);
+  EXPECT_EQ(kernel_entry.GetData(&context, &read_back), kTfLiteOk);
+  // Removing missing data is not an error.
+  EXPECT_EQ(delegate_entry.RemoveData(&context), kTfLiteOk);
+
+#if !defined(_WIN32)
+  ASSERT_EQ(delegate_entry.SetData(&context, data.data(), data.size()),
+            kTfLiteOk);
+  ASSERT_EQ(serialization.RemoveAllData(&context), kTfLiteOk);
+  EXPECT_EQ(delegate_entry.GetData(&context, &read_back),
+            kTfLiteDelegateDataNotFound);
+  EXPECT_EQ(kernel_entry.GetData(&context, &read_back),
+            kTfLiteDelegateDataNotFound);
+  // Entries of other models are kept.
+  EXPECT_EQ(other_entry.GetData(&context, &read_back), kTfLiteOk);
+#endif  // !defined(_WIN32)
+}
+
 }  // namespace
 }  // namespace delegates
 }  // namespace tflite
@@ -0,0 +1,232 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/delegates/utils/latency_partitioner.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+
+namespace tflite {
+namespace delegates {
+namespace {
+
+constexpr char kRunProfileHeader[] =
+    "Operator-wise Profiling Info for Regular Benchmark Runs";
+constexpr char kSubgraphPrefix[] = "Subgraph (index:";
+constexpr char kDelegateInternalPrefix[] = "Delegate internal:";
+constexpr char kDelegateNodePrefix[] = "Delegate/";
+
+bool StartsWith(const std::string& s, const char* prefix) {
+  return s.rfind(prefix, 0) == 0;
+}
+
+// Splits a CSV row of the profile into its fields. Commas in node names are
+// replaced by tabs in the profile, but node types may contain ", ", so the
+// fields are counted from the end of the row.
+std::vector<std::string> SplitRow(const std::string& row) {
+  std::vector<std::string> fields;
+  size_t end = row.size();
+  while (end > 0) {
+    const size_t separator = row.rfind(", ", end - 1);
+    if (separator == std::string::npos) break;
+    fields.push_back(row.substr(separator + 2, end - separator - 2));
+    end = separator;
+  }
+  fields.push_back(row.substr(0, end));
+  return fields;
+}
+
+// Returns the node index at the end of a profile node name, e.g. 3 for
+// "[output]:3", or -1 if there is none.
+int NodeIndexFromName(const std::string& name) {
+  const size_t colon = name.rfind(':');
+  if (colon == std::string::npos || colon + 1 == name.size()) return -1;
+  int index = 0;
+  for (size_t i = colon + 1; i < name.size(); ++i) {
+    if (name[i] < '0' || name[i] > '9') return -1;
+    index = index * 10 + (name[i] - '0');
+  }
+  return index;
+}
+
+}  // namespace
+
+std::vector<int> PartitionByLatency(
+    const std::vector<BackendCostModel>& backends,
+    const std::vector<size_t>& live_bytes, float* total_latency_us) {
+  if (backends.empty() || live_bytes.empty()) return {};
+  const int num_nodes = static_cast<int>(live_bytes.size()) - 1;
+  const int num_backends = static_cast<int>(backends.size());
+  for (const BackendCostModel& backend : backends) {
+    if (backend.node_latency_us.size() != live_bytes.size() - 1) return {};
+  }
+
+  // The cost of moving the tensors live before node `i` from the memory of
+  // backend `from` to the memory of backend `to`, and of starting a partition
+  // on `to`.
+  const auto switch_cost = [&](int from, int to, int i) -> float {
+    if (from == to) return 0;
+    float cost = live_bytes[i] * (backends[from].transfer_us_per_byte +
+                                  backends[to].transfer_us_per_byte);
+    if (to != 0) cost += backends[to].partition_overhead_us;
+    return cost;
+  };
+
+  constexpr float kInfinity = std::numeric_limits<float>::infinity();
+  // latency[b] is the lowest latency of running the nodes so far with the
+  // last one on backend b, and previous[i][b] the backend of node i - 1 on
+  // that path. Before the first node, the inputs are on the CPU.
+  std::vector<float> latency(num_backends, kInfinity);
+  latency[0] = 0;
+  std::vector<std::vector<int>> previous(num_nodes,
+                                         std::vector<int>(num_backends, 0));
+  std::vector<float> next_latency(num_backends);
+  for (int i = 0; i < num_nodes; ++i) {
+    for (int to = 0; to < num_backends; ++to) {
+      next_latency[to] = kInfinity;
+      const float node_latency = backends[to].node_latency_us[i];
+      if (node_latency < 0) continue;
+      for (int from = 0; from < num_backends; ++from) {
+        const float candidate =
+            latency[from] + switch_cost(from, to, i) + node_latency;
+        if (candidate < next_latency[to]) {
+          next_latency[to] = candidate;
+          previous[i][to] = from;
+        }
+      }
+    }
+    latency.swap(next_latency);
+  }
+
+  // The outputs are moved back to the CPU after the last node.
+  int last = -1;
+  float best_latency = kInfinity;
+  for (int b = 0; b < num_backends; ++b) {
+    const float candidate = latency[b] + switch_cost(b, 0, num_nodes);
+    if (candidate < best_latency) {
+      best_latency = candidate;
+      last = b;
+    }
+  }
+  if (last < 0) return {};
+
+  std::vector<int> assignment(num_nodes);
+  for (int i = num_nodes - 1; i >= 0; --i) {
+    assignment[i] = last;
+    last = previous[i][last];
+  }
+  if (total_latency_us) *total_latency_us = best_latency;
+  return assignment;
+}
+
+TfLiteStatus GetLiveBytesBetweenNodes(TfLiteContext* context,
+                                      const TfLiteIntArray* execution_plan,
+                                      std::vector<size_t>* live_bytes) {
+  const int num_nodes = execution_plan->size;
+  const size_t num_tensors = context->tensors_size;
+  // The position in the plan of the node producing each tensor, -1 for the
+  // model inputs, and of the last node reading it, num_nodes for the tensors
+  // no node reads, which are the model outputs.
+  std::vector<int> producer(num_tensors, -1);
+  std::vector<int> last_consumer(num_tensors, -1);
+  for (int i = 0; i < num_nodes; ++i) {
+    TfLiteNode* node;
+    TfLiteRegistration* registration;
+    TF_LITE_ENSURE_STATUS(context->GetNodeAndRegistration(
+        context, execution_plan->data[i], &node, &registration));
+    for (int j = 0; j < node->inputs->size; ++j) {
+      const int tensor = node->inputs->data[j];
+      if (tensor != kTfLiteOptionalTensor) last_consumer[tensor] = i;
+    }
+    for (int j = 0; j < node->outputs->size; ++j) {
+      const int tensor = node->outputs->data[j];
+      if (tensor != kTfLiteOptionalTensor) producer[tensor] = i;
+    }
+  }
+
+  live_bytes->assign(num_nodes + 1, 0);
+  for (size_t t = 0; t < num_tensors; ++t) {
+    const TfLiteTensor& tensor = context->tensors[t];
+    if (tensor.allocation_type == kTfLiteMmapRo) continue;
+    int last = last_consumer[t];
+    if (last < 0) {
+      // Tensors neither read nor written by the plan are not moved.
+      if (producer[t] < 0) continue;
+      last = num_nodes;
+    }
+    // The tensor is live between its producer and its last reader.
+    for (int i = producer[t] + 1; i <= last; ++i) {
+      (*live_bytes)[i] += tensor.bytes;
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus ParseOpProfileCsv(const std::string& csv,
+                               const std::vector<int>& execution_plan,
+                               bool delegate_internal,
+                               std::vector<float>* node_latency_us) {
+  std::unordered_map<int, int> position_of_node;
+  for (int i = 0; i < static_cast<int>(execution_plan.size()); ++i) {
+    position_of_node[execution_plan[i]] = i;
+  }
+  node_latency_us->assign(execution_plan.size(), -1);
+
+  std::istringstream stream(csv);
+  std::string line;
+  bool found_run_profile = false;
+  bool in_section = false;
+  while (std::getline(stream, line)) {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (StartsWith(line, kRunProfileHeader)) {
+      found_run_profile = true;
+      in_section = !delegate_internal;
+      continue;
+    }
+    if (!found_run_profile) continue;
+    if (StartsWith(line, kSubgraphPrefix)) {
+      in_section = false;
+    } else if (StartsWith(line, kDelegateInternalPrefix)) {
+      in_section = delegate_internal;
+    }
+    if (!in_section) continue;
+
+    // node type, first, avg_ms, %, cdf%, mem KB, times called, name
+    const std::vector<std::string> fields = SplitRow(line);
+    if (fields.size() < 8) continue;
+    const std::string& name = fields[0];
+    if (StartsWith(name, kDelegateNodePrefix) != delegate_internal) continue;
+    auto it = position_of_node.find(NodeIndexFromName(name));
+    if (it == position_of_node.end()) continue;
+    float& latency = (*node_latency_us)[it->second];
+    // The first table lists the nodes in run order; later tables repeat them.
+    if (latency >= 0) continue;
+    char* end;
+    const float avg_ms = std::strtof(fields[5].c_str(), &end);
+    if (end == fields[5].c_str()) return kTfLiteError;
+    latency = avg_ms * 1000.0f;
+  }
+  return found_run_profile ? kTfLiteOk : kTfLiteError;
+}
+
+}  // namespace delegates
+}  // namespace tflite
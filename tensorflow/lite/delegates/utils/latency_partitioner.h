@@ -0,0 +1,92 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_DELEGATES_UTILS_LATENCY_PARTITIONER_H_
+#define TENSORFLOW_LITE_DELEGATES_UTILS_LATENCY_PARTITIONER_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+
+namespace tflite {
+namespace delegates {
+
+// The measured costs of running the nodes of a model on one backend, i.e. on
+// the CPU or with one delegate.
+struct BackendCostModel {
+  // The latency in microseconds of each node of the execution plan on this
+  // backend, or a negative value if the backend does not support the node.
+  std::vector<float> node_latency_us;
+  // The fixed cost in microseconds of invoking a partition on this backend,
+  // e.g. of launching a delegate kernel and synchronizing with it.
+  float partition_overhead_us = 0;
+  // The cost in microseconds of moving one byte between the CPU memory and
+  // the memory of this backend, which is 0 for the CPU.
+  float transfer_us_per_byte = 0;
+};
+
+// Assigns each node of an execution plan to one of `backends`, minimizing the
+// estimated end-to-end latency of the model: the sum of the latencies of the
+// nodes on their backends, the overhead of each partition of consecutive
+// nodes on a delegate, and the cost of moving the tensors that are live
+// across the boundaries between partitions of different backends.
+//
+// Backend 0 must be the CPU, where the inputs of the model are and where its
+// outputs are expected. `live_bytes` has one more entry than there are nodes:
+// `live_bytes[i]` is the size in bytes of the tensors that are live between
+// node i - 1 and node i, i.e. the model inputs and the outputs of the nodes
+// before node i that node i or a later node reads, or that are outputs of the
+// model. `live_bytes[0]` is the size of the inputs and `live_bytes.back()` the
+// size of the outputs of the model.
+//
+// Returns the index of the backend of each node, or an empty vector if the
+// inputs are inconsistent or a node is not supported by any backend. If
+// `total_latency_us` is not null, it is set to the estimated latency of the
+// returned assignment.
+//
+// The nodes assigned to a delegate can then be passed to the
+// `GraphPartitionHelper` constructor that takes supported node indices.
+std::vector<int> PartitionByLatency(
+    const std::vector<BackendCostModel>& backends,
+    const std::vector<size_t>& live_bytes, float* total_latency_us = nullptr);
+
+// Computes the `live_bytes` of `PartitionByLatency` for the nodes of
+// `execution_plan` in `context`. Constant tensors are not counted, since they
+// are not moved between backends on every invocation.
+TfLiteStatus GetLiveBytesBetweenNodes(TfLiteContext* context,
+                                      const TfLiteIntArray* execution_plan,
+                                      std::vector<size_t>* live_bytes);
+
+// Reads the average latency of each node of the primary subgraph from an op
+// profile written by `benchmark_model --enable_op_profiling=true
+// --profiling_output_csv_file=<file>`. The profile node names end with the
+// node index, which is looked up in `execution_plan`. If `delegate_internal`
+// is true, the latencies are read from the profile of the delegated nodes
+// reported by the delegate instead of the profile of the TFLite nodes.
+//
+// `node_latency_us` gets one entry per node of `execution_plan`, which is -1
+// for the nodes that are not in the profile, i.e. that the profiled backend
+// did not run.
+TfLiteStatus ParseOpProfileCsv(const std::string& csv,
+                               const std::vector<int>& execution_plan,
+                               bool delegate_internal,
+                               std::vector<float>* node_latency_us);
+
+}  // namespace delegates
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_DELEGATES_UTILS_LATENCY_PARTITIONER_H_
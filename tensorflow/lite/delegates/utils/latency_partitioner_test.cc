@@ -0,0 +1,202 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/delegates/utils/latency_partitioner.h"
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/common.h"
+
+namespace tflite {
+namespace delegates {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::FloatEq;
+using ::testing::IsEmpty;
+
+BackendCostModel Cpu(std::vector<float> node_latency_us) {
+  BackendCostModel cpu;
+  cpu.node_latency_us = std::move(node_latency_us);
+  return cpu;
+}
+
+BackendCostModel Accelerator(std::vector<float> node_latency_us) {
+  BackendCostModel accelerator;
+  accelerator.node_latency_us = std::move(node_latency_us);
+  accelerator.partition_overhead_us = 100;
+  accelerator.transfer_us_per_byte = 0.01;
+  return accelerator;
+}
+
+TEST(PartitionByLatencyTest, DelegatesProfitableRuns) {
+  // Node 2 is not supported by the accelerator, which is faster for the
+  // others but costs 100us per partition plus the transfers.
+  const std::vector<BackendCostModel> backends = {
+      Cpu({500, 500, 50, 100, 20}), Accelerator({100, 100, -1, 100, 10})};
+  const std::vector<size_t> live_bytes = {1000, 1000, 1000, 1000, 1000, 1000};
+  float latency;
+  EXPECT_THAT(PartitionByLatency(backends, live_bytes, &latency),
+              ElementsAre(1, 1, 0, 0, 0));
+  // 10 + 100 + 200 to run nodes 0 and 1 on the accelerator, and 10 to move
+  // the tensors back to the CPU.
+  EXPECT_THAT(latency, FloatEq(320 + 50 + 100 + 20));
+}
+
+TEST(PartitionByLatencyTest, AccountsForTransfers) {
+  const std::vector<BackendCostModel> backends = {
+      Cpu({500, 500, 50, 500, 20}), Accelerator({100, 100, -1, 100, 10})};
+  std::vector<size_t> live_bytes = {1000, 1000, 1000, 1000, 1000, 1000};
+  float latency;
+  EXPECT_THAT(PartitionByLatency(backends, live_bytes, &latency),
+              ElementsAre(1, 1, 0, 1, 1));
+  EXPECT_THAT(latency, FloatEq(320 + 50 + 10 + 100 + 110 + 10));
+
+  // Moving the large tensors live before node 3 costs more than it saves.
+  live_bytes[3] = 100000;
+  EXPECT_THAT(PartitionByLatency(backends, live_bytes, &latency),
+              ElementsAre(1, 1, 0, 0, 0));
+  EXPECT_THAT(latency, FloatEq(320 + 50 + 500 + 20));
+}
+
+TEST(PartitionByLatencyTest, RejectsUnsupportedNodes) {
+  const std::vector<BackendCostModel> backends = {Cpu({10, -1}),
+                                                  Accelerator({-1, 10})};
+  EXPECT_THAT(PartitionByLatency(backends, {1, 1, 1}), ElementsAre(0, 1));
+  const std::vector<BackendCostModel> unsupported = {Cpu({10, -1})};
+  EXPECT_THAT(PartitionByLatency(unsupported, {1, 1, 1}), IsEmpty());
+  EXPECT_THAT(PartitionByLatency(backends, {1, 1}), IsEmpty());
+}
+
+constexpr char kProfile[] = R"(Profiling Info for Benchmark Initialization:
+============================== Run Order ==============================
+node type, first, avg_ms, %, cdf%, mem KB, times called, name
+AllocateTensors, 1.2, 1.2, 100%, 100%, 0, 1, AllocateTensors/0
+
+Operator-wise Profiling Info for Regular Benchmark Runs:
+============================== Run Order ==============================
+node type, first, avg_ms, %, cdf%, mem KB, times called, name
+CONV_2D, 0.5, 0.4, 40%, 40%, 0, 1, [conv]:0
+TfLiteXNNPackDelegate, 0.3, 0.25, 25%, 65%, 0, 1, [add	mul]:3
+SOFTMAX, 0.1, 0.1, 10%, 75%, 0, 1, [softmax]:2
+
+============================== Top by Computation Time ==============
+node type, first, avg_ms, %, cdf%, mem KB, times called, name
+CONV_2D, 0.5, 0.4, 40%, 40%, 0, 1, [conv]:0
+
+============================== Summary by node type ==================
+node type, count, avg_ms, avg %, cdf %, mem KB, times called
+CONV_2D, 1, 0.4, 40%, 40%, 0, 1
+
+Subgraph (index: 1) ============================== Run Order ========
+node type, first, avg_ms, %, cdf%, mem KB, times called, name
+ADD, 0.2, 0.2, 20%, 20%, 0, 1, [while_add]:1
+
+Delegate internal: 
+============================== Run Order ==============================
+node type, first, avg_ms, %, cdf%, mem KB, times called, name
+DelegateOpInvoke, 0.1, 0.125, 50%, 50%, 0, 1, Delegate/Add:1
+DelegateOpInvoke, 0.1, 0.075, 30%, 80%, 0, 1, Delegate/Multiply:4
+)";
+
+TEST(ParseOpProfileCsvTest, ReadsRegularNodes) {
+  std::vector<float> latency;
+  ASSERT_EQ(ParseOpProfileCsv(kProfile, {0, 1, 2}, false, &latency),
+            kTfLiteOk);
+  EXPECT_THAT(latency, ElementsAre(FloatEq(400), -1, FloatEq(100)));
+}
+
+TEST(ParseOpProfileCsvTest, ReadsDelegateInternalNodes) {
+  std::vector<float> latency;
+  ASSERT_EQ(ParseOpProfileCsv(kProfile, {0, 1, 2, 4}, true, &latency),
+            kTfLiteOk);
+  EXPECT_THAT(latency, ElementsAre(-1, FloatEq(125), -1, FloatEq(75)));
+}
+
+TEST(ParseOpProfileCsvTest, RequiresRunProfile) {
+  std::vector<float> latency;
+  EXPECT_EQ(ParseOpProfileCsv("node type, first\n", {0}, false, &latency),
+            kTfLiteError);
+}
+
+// A chain of nodes where node i reads tensor i and writes tensor i + 1, and
+// node 1 also reads the constant tensor 4.
+class LiveBytesTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    tensors_.resize(5);
+    for (int t = 0; t < 5; ++t) {
+      tensors_[t].bytes = 1 << t;
+      tensors_[t].allocation_type = kTfLiteArenaRw;
+    }
+    tensors_[4].allocation_type = kTfLiteMmapRo;
+    for (int i = 0; i < 3; ++i) {
+      nodes_[i].inputs = TfLiteIntArrayCreate(i == 1 ? 2 : 1);
+      nodes_[i].inputs->data[0] = i;
+      if (i == 1) nodes_[i].inputs->data[1] = 4;
+      nodes_[i].outputs = TfLiteIntArrayCreate(1);
+      nodes_[i].outputs->data[0] = i + 1;
+    }
+    context_.tensors = tensors_.data();
+    context_.tensors_size = tensors_.size();
+    context_.impl_ = this;
+    context_.GetNodeAndRegistration =
+        [](TfLiteContext* context, int node_index, TfLiteNode** node,
+           TfLiteRegistration** registration) {
+          auto* test = static_cast<LiveBytesTest*>(context->impl_);
+          *node = &test->nodes_[node_index];
+          *registration = &test->registration_;
+          return kTfLiteOk;
+        };
+  }
+
+  void TearDown() override {
+    for (TfLiteNode& node : nodes_) {
+      TfLiteIntArrayFree(node.inputs);
+      TfLiteIntArrayFree(node.outputs);
+    }
+  }
+
+  TfLiteContext context_ = {};
+  std::vector<TfLiteTensor> tensors_;
+  TfLiteNode nodes_[3] = {};
+  TfLiteRegistration registration_ = {};
+};
+
+TEST_F(LiveBytesTest, CountsTensorsAcrossBoundaries) {
+  TfLiteIntArray* plan = TfLiteIntArrayCreate(3);
+  for (int i = 0; i < 3; ++i) plan->data[i] = i;
+  std::vector<size_t> live_bytes;
+  ASSERT_EQ(GetLiveBytesBetweenNodes(&context_, plan, &live_bytes), kTfLiteOk);
+  EXPECT_THAT(live_bytes, ElementsAre(1, 2, 4, 8));
+
+  // Node 2 also reads the model input.
+  TfLiteIntArrayFree(nodes_[2].inputs);
+  nodes_[2].inputs = TfLiteIntArrayCreate(2);
+  nodes_[2].inputs->data[0] = 2;
+  nodes_[2].inputs->data[1] = 0;
+  ASSERT_EQ(GetLiveBytesBetweenNodes(&context_, plan, &live_bytes), kTfLiteOk);
+  EXPECT_THAT(live_bytes, ElementsAre(1, 3, 5, 8));
+  TfLiteIntArrayFree(plan);
+}
+
+}  // namespace
+}  // namespace delegates
+}  // namespace tflite
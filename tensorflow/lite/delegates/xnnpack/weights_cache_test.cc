@@ -178,6 +178,48 @@ TEST(XNNPACK_WEIGHTS_CACHE, SoftFinalization) {
   ASSERT_EQ(kTfLiteOk, interpreter2->Invoke());
 }
 
+TEST(XNNPACK_WEIGHTS_CACHE, SharedUnpackedWeights) {
+  // FP16 weights are unpacked to FP32 before packing, and the unpacked copy
+  // is shared through the weights cache.
+  std::vector<char> buffer = Conv2DTester().FP16Weights().CreateTfLiteModel();
+  const Model* model = GetModel(buffer.data());
+  DummyOpResolver resolver;
+
+  std::unique_ptr<TfLiteXNNPackDelegateWeightsCache,
+                  decltype(&TfLiteXNNPackDelegateWeightsCacheDelete)>
+      weights_cache(TfLiteXNNPackDelegateWeightsCacheCreate(),
+                    TfLiteXNNPackDelegateWeightsCacheDelete);
+
+  TfLiteXNNPackDelegateOptions delegate_options =
+      TfLiteXNNPackDelegateOptionsDefault();
+  delegate_options.weights_cache = weights_cache.get();
+
+  std::unique_ptr<Interpreter> interpreter1;
+  ASSERT_EQ(kTfLiteOk, InterpreterBuilder(model, resolver)(&interpreter1));
+  ASSERT_EQ(kTfLiteOk, interpreter1->AllocateTensors());
+  std::unique_ptr<TfLiteDelegate, decltype(&TfLiteXNNPackDelegateDelete)>
+      delegate1(TfLiteXNNPackDelegateCreate(&delegate_options),
+                TfLiteXNNPackDelegateDelete);
+  ASSERT_EQ(kTfLiteOk, interpreter1->ModifyGraphWithDelegate(delegate1.get()));
+
+  ASSERT_TRUE(
+      TfLiteXNNPackDelegateWeightsCacheFinalizeSoft(weights_cache.get()));
+
+  std::unique_ptr<Interpreter> interpreter2;
+  ASSERT_EQ(kTfLiteOk, InterpreterBuilder(model, resolver)(&interpreter2));
+  ASSERT_EQ(kTfLiteOk, interpreter2->AllocateTensors());
+  std::unique_ptr<TfLiteDelegate, decltype(&TfLiteXNNPackDelegateDelete)>
+      delegate2(TfLiteXNNPackDelegateCreate(&delegate_options),
+                TfLiteXNNPackDelegateDelete);
+  ASSERT_EQ(kTfLiteOk, interpreter2->ModifyGraphWithDelegate(delegate2.get()));
+
+  // The first delegate may go away; the second one still uses the weights it
+  // unpacked.
+  interpreter1.reset();
+  delegate1.reset();
+  ASSERT_EQ(kTfLiteOk, interpreter2->Invoke());
+}
+
 // Dummy class to use with parameterized test.
 class WeightsCacheTest : public testing::TestWithParam<size_t> {};
 
@@ -26,6 +26,7 @@ limitations under the License.
 #include <memory>
 #include <mutex>
 #include <string>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -48,7 +49,43 @@ limitations under the License.
 #include "tensorflow/lite/schema/schema_generated.h"
 #include "tensorflow/lite/tools/optimize/reduced_precision_support.h"
 
-struct TfLiteXNNPackDelegateWeightsCache;
+// Weights cache shared by XNNPACK delegates. Besides the XNNPACK cache of
+// packed weights, it holds the quasi-static tensors that the delegates unpack
+// from static buffers, e.g. FP16 weights dequantized to FP32. Delegates applied
+// to interpreters of the same model then share these tensors instead of each
+// unpacking a private copy, and XNNPACK packs the same weights for all of
+// them.
+struct TfLiteXNNPackDelegateWeightsCache {
+  // Identifies an unpacked tensor by the data it is unpacked from, the indices
+  // of the tensors it is unpacked from and into, and the unpacking operator.
+  using UnpackedTensorKey = std::tuple<const void*, int, int, int>;
+
+  explicit TfLiteXNNPackDelegateWeightsCache(xnn_weights_cache_t cache)
+      : xnn_weights_cache(cache) {}
+
+  ~TfLiteXNNPackDelegateWeightsCache() {
+    xnn_delete_weights_cache(xnn_weights_cache);
+  }
+
+  // Returns the data unpacked for `key`, or nullptr if it was not unpacked yet.
+  const char* FindUnpackedTensor(const UnpackedTensorKey& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto it = unpacked_tensors.find(key);
+    return it == unpacked_tensors.end() ? nullptr : it->second.get();
+  }
+
+  // Stores `data` as the data unpacked for `key` and returns it, unless another
+  // delegate stored it first, in which case that data is returned.
+  const char* InsertUnpackedTensor(const UnpackedTensorKey& key,
+                                   std::unique_ptr<char[]> data) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return unpacked_tensors.emplace(key, std::move(data)).first->second.get();
+  }
+
+  xnn_weights_cache_t xnn_weights_cache;
+  std::mutex mutex;
+  std::map<UnpackedTensorKey, std::unique_ptr<char[]>> unpacked_tensors;
+};
 
 namespace tflite {
 namespace xnnpack {
@@ -613,7 +650,7 @@ class Delegate {
     if (options_.weights_cache == nullptr) {
       return nullptr;
     } else {
-      return reinterpret_cast<xnn_weights_cache_t>(options_.weights_cache);
+      return options_.weights_cache->xnn_weights_cache;
     }
   }
 
@@ -685,11 +722,12 @@ class Delegate {
   };
 
   // Unpacked data for quasi-static tensors, i.e. tensors produced by
-  // dequantizing or unpacking static buffers.
-  std::vector<char> static_unpacked_data_;
-  // Mapping from a tensor index for a quasi-static tensor to the offset to
-  // its unpacked data within static_unpacked_data_.
-  std::unordered_map<int, size_t> static_unpacked_data_map_;
+  // dequantizing or unpacking static buffers. With a weights cache, the cache
+  // owns the unpacked data instead, and shares it with other delegates.
+  std::vector<std::unique_ptr<char[]>> static_unpacked_data_;
+  // Mapping from a tensor index for a quasi-static tensor to its unpacked
+  // data.
+  std::unordered_map<int, const char*> static_unpacked_data_map_;
   // Set of indices of nodes which unpack static data, e.g. Dequantize
   // operators which convert FP16 static weights to FP32. These nodes are simply
   // ignored in the delegate implementation, because their outputs are
@@ -976,7 +1014,7 @@ class Subgraph {
         // Check for quasi-static data.
         const auto it = delegate.static_unpacked_data_map_.find(t);
         if (it != delegate.static_unpacked_data_map_.end()) {
-          data = delegate.static_unpacked_data_.data() + it->second;
+          data = it->second;
         }
       }
       if (inputs.count(t) != 0) {
@@ -1042,7 +1080,7 @@ class Subgraph {
 
     // Create a set of quasi-static tensors for VisitNode function
     std::unordered_set<int> quasi_static_tensors;
-    for (const std::pair<const int, size_t>& entry :
+    for (const std::pair<const int, const char*>& entry :
          delegate.static_unpacked_data_map_) {
       quasi_static_tensors.insert(entry.first);
     }
@@ -6921,18 +6959,27 @@ TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
       }
     }
 
-    // Align to XNN_EXTRA_BYTES bytes
-    while (static_unpacked_data_.size() % XNN_EXTRA_BYTES != 0) {
-      static_unpacked_data_.push_back(0);
-    }
-    const size_t tensor_offset = static_unpacked_data_.size();
-    static_unpacked_data_.resize(tensor_offset + context->tensors[t].bytes);
-
-    char* unpacked_data = static_unpacked_data_.data() + tensor_offset;
     const char* packed_data =
         static_unpacked_input_it_ != static_unpacked_data_map_.end()
-            ? static_unpacked_data_.data() + static_unpacked_input_it_->second
+            ? static_unpacked_input_it_->second
             : static_cast<const char*>(input_tensor.data.data);
+
+    // Reuse the data unpacked by another delegate sharing the weights cache.
+    const TfLiteXNNPackDelegateWeightsCache::UnpackedTensorKey unpacked_key(
+        packed_data, node->inputs->data[0], t, registration->builtin_code);
+    if (options_.weights_cache != nullptr) {
+      const char* shared_unpacked_data =
+          options_.weights_cache->FindUnpackedTensor(unpacked_key);
+      if (shared_unpacked_data != nullptr) {
+        static_unpacked_data_map_[t] = shared_unpacked_data;
+        continue;
+      }
+    }
+
+    // XNNPACK may read up to XNN_EXTRA_BYTES past the end of the data.
+    std::unique_ptr<char[]> unpacked_buffer(
+        new char[context->tensors[t].bytes + XNN_EXTRA_BYTES]());
+    char* unpacked_data = unpacked_buffer.get();
     switch (registration->builtin_code) {
       case kTfLiteBuiltinDequantize: {
         // Such a condition has been checked when preparing to unpack
@@ -7037,7 +7084,14 @@ TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
         return nullptr;  // Hard error.
     }
 
-    static_unpacked_data_map_[t] = tensor_offset;
+    if (options_.weights_cache != nullptr) {
+      static_unpacked_data_map_[t] =
+          options_.weights_cache->InsertUnpackedTensor(
+              unpacked_key, std::move(unpacked_buffer));
+    } else {
+      static_unpacked_data_map_[t] = unpacked_data;
+      static_unpacked_data_.push_back(std::move(unpacked_buffer));
+    }
   }
 
   // Add nodes that unpack static data consumed by delegated nodes.
@@ -7143,7 +7197,7 @@ TfLiteXNNPackDelegateWeightsCache* TfLiteXNNPackDelegateWeightsCacheCreate() {
   if (xnn_create_weights_cache(&weights_cache) != xnn_status_success) {
     return nullptr;
   }
-  return reinterpret_cast<TfLiteXNNPackDelegateWeightsCache*>(weights_cache);
+  return new TfLiteXNNPackDelegateWeightsCache(weights_cache);
 }
 
 TfLiteXNNPackDelegateWeightsCache*
@@ -7158,22 +7212,20 @@ TfLiteXNNPackDelegateWeightsCacheCreateWithSize(size_t size) {
       xnn_status_success) {
     return nullptr;
   }
-  return reinterpret_cast<TfLiteXNNPackDelegateWeightsCache*>(weights_cache);
+  return new TfLiteXNNPackDelegateWeightsCache(weights_cache);
 }
 
 bool TfLiteXNNPackDelegateWeightsCacheFinalizeSoft(
     TfLiteXNNPackDelegateWeightsCache* cache) {
-  auto weights_cache = reinterpret_cast<xnn_weights_cache_t>(cache);
   xnn_status status = xnn_finalize_weights_cache(
-      weights_cache, xnn_weights_cache_finalization_kind_soft);
+      cache->xnn_weights_cache, xnn_weights_cache_finalization_kind_soft);
   return status == xnn_status_success;
 }
 
 bool TfLiteXNNPackDelegateWeightsCacheFinalizeHard(
     TfLiteXNNPackDelegateWeightsCache* cache) {
-  auto weights_cache = reinterpret_cast<xnn_weights_cache_t>(cache);
   xnn_status status = xnn_finalize_weights_cache(
-      weights_cache, xnn_weights_cache_finalization_kind_hard);
+      cache->xnn_weights_cache, xnn_weights_cache_finalization_kind_hard);
   return status == xnn_status_success;
 }
 
@@ -7182,8 +7234,7 @@ void TfLiteXNNPackDelegateWeightsCacheDelete(
   if (cache == nullptr) {
     return;
   }
-  auto weights_cache = reinterpret_cast<xnn_weights_cache_t>(cache);
-  xnn_delete_weights_cache(weights_cache);
+  delete cache;
   xnn_deinitialize();
 }
 
@@ -63,7 +63,10 @@ typedef struct {
   // - TFLITE_XNNPACK_DELEGATE_FLAG_ENABLE_SUBGRAPH_RESHAPING
   uint32_t flags;
   // Cache for packed weights, can be shared between multiple instances of
-  // delegates.
+  // delegates. Static weights that the delegates unpack before packing them,
+  // such as FP16 or dequantized weights and densified sparse weights, are
+  // shared through the cache as well, so the model they were unpacked from
+  // must outlive the cache.
   struct TfLiteXNNPackDelegateWeightsCache* weights_cache;
   // Deprecated. Use the flags bitfield with the
   // TFLITE_XNNPACK_DELEGATE_FLAG_VARIABLE_OPERATORS mask.
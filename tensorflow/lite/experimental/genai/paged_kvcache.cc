@@ -0,0 +1,262 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/genai/paged_kvcache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+
+namespace tflite {
+namespace genai {
+
+PagedKVCache::PagedKVCache(const Options& options) : options_(options) {
+  const size_t num_entries =
+      static_cast<size_t>(options_.num_blocks) * options_.block_size;
+  const size_t size = num_entries * entry_size();
+  for (Pool* pool : {&keys_, &values_}) {
+    if (options_.storage == Storage::kInt8) {
+      pool->quantized_data.resize(size);
+      pool->scales.resize(num_entries);
+    } else {
+      pool->data.resize(size);
+    }
+  }
+  ref_counts_.resize(options_.num_blocks, 0);
+  // Blocks are allocated from the back, so the first blocks are used first.
+  for (int block = options_.num_blocks - 1; block >= 0; --block) {
+    free_blocks_.push_back(block);
+  }
+}
+
+int PagedKVCache::CreateSequence() {
+  const int id = next_sequence_id_++;
+  sequences_[id] = Sequence();
+  return id;
+}
+
+int PagedKVCache::ForkSequence(int sequence) {
+  auto it = sequences_.find(sequence);
+  if (it == sequences_.end()) return -1;
+  Sequence fork = it->second;
+  for (int block : fork.blocks) {
+    ++ref_counts_[block];
+  }
+  const int id = next_sequence_id_++;
+  sequences_[id] = std::move(fork);
+  return id;
+}
+
+TfLiteStatus PagedKVCache::ReleaseSequence(int sequence) {
+  auto it = sequences_.find(sequence);
+  if (it == sequences_.end()) return kTfLiteError;
+  for (int block : it->second.blocks) {
+    ReleaseBlock(block);
+  }
+  sequences_.erase(it);
+  return kTfLiteOk;
+}
+
+TfLiteStatus PagedKVCache::Append(int sequence, const float* keys,
+                                  const float* values, int num_tokens) {
+  auto it = sequences_.find(sequence);
+  if (it == sequences_.end() || num_tokens < 0) return kTfLiteError;
+  Sequence& seq = it->second;
+  const int block_size = options_.block_size;
+
+  // Checks that there are enough free blocks before changing anything.
+  const int slot = seq.num_tokens % block_size;
+  const bool copy_last_block =
+      slot != 0 && num_tokens > 0 && ref_counts_[seq.blocks.back()] > 1;
+  const int num_new_blocks =
+      (seq.num_tokens + num_tokens + block_size - 1) / block_size -
+      static_cast<int>(seq.blocks.size());
+  if (num_new_blocks + (copy_last_block ? 1 : 0) > NumFreeBlocks()) {
+    return kTfLiteError;
+  }
+
+  if (copy_last_block) {
+    // The partially filled block is shared with another sequence, which
+    // still needs its remaining slots as they are.
+    const int block = AllocateBlock();
+    CopyBlock(seq.blocks.back(), block);
+    ReleaseBlock(seq.blocks.back());
+    seq.blocks.back() = block;
+  }
+  for (int i = 0; i < num_tokens; ++i, ++seq.num_tokens) {
+    const int token_slot = seq.num_tokens % block_size;
+    if (token_slot == 0) seq.blocks.push_back(AllocateBlock());
+    const int block = seq.blocks.back();
+    Write(keys_, block, token_slot, keys + i * entry_size());
+    Write(values_, block, token_slot, values + i * entry_size());
+  }
+  return kTfLiteOk;
+}
+
+int PagedKVCache::NumTokens(int sequence) const {
+  auto it = sequences_.find(sequence);
+  return it == sequences_.end() ? -1 : it->second.num_tokens;
+}
+
+TfLiteStatus PagedKVCache::GetBlockTable(int sequence,
+                                         std::vector<int>* table) const {
+  auto it = sequences_.find(sequence);
+  if (it == sequences_.end()) return kTfLiteError;
+  *table = it->second.blocks;
+  return kTfLiteOk;
+}
+
+void PagedKVCache::ReadKey(int block, int slot, float* output) const {
+  Read(keys_, block, slot, output);
+}
+
+void PagedKVCache::ReadValue(int block, int slot, float* output) const {
+  Read(values_, block, slot, output);
+}
+
+TfLiteStatus PagedKVCache::Attention(int sequence, const float* query,
+                                     float* output) const {
+  auto it = sequences_.find(sequence);
+  if (it == sequences_.end()) return kTfLiteError;
+  const Sequence& seq = it->second;
+  const int head_dim = options_.head_dim;
+  const float scale = 1.0f / std::sqrt(static_cast<float>(head_dim));
+  std::fill(output, output + entry_size(), 0.0f);
+  if (seq.num_tokens == 0) return kTfLiteOk;
+
+  std::vector<float> weights(seq.num_tokens);
+  for (int head = 0; head < options_.num_heads; ++head) {
+    const float* head_query = query + head * head_dim;
+    float max_score = -INFINITY;
+    for (int t = 0; t < seq.num_tokens; ++t) {
+      weights[t] = scale * Dot(keys_, seq.blocks[t / options_.block_size],
+                               t % options_.block_size, head, head_query);
+      max_score = std::max(max_score, weights[t]);
+    }
+    float sum = 0.0f;
+    for (float& weight : weights) {
+      weight = std::exp(weight - max_score);
+      sum += weight;
+    }
+    float* head_output = output + head * head_dim;
+    for (int t = 0; t < seq.num_tokens; ++t) {
+      AddScaled(values_, seq.blocks[t / options_.block_size],
+                t % options_.block_size, head, weights[t] / sum, head_output);
+    }
+  }
+  return kTfLiteOk;
+}
+
+int PagedKVCache::AllocateBlock() {
+  const int block = free_blocks_.back();
+  free_blocks_.pop_back();
+  ref_counts_[block] = 1;
+  return block;
+}
+
+void PagedKVCache::ReleaseBlock(int block) {
+  if (--ref_counts_[block] == 0) free_blocks_.push_back(block);
+}
+
+void PagedKVCache::CopyBlock(int from, int to) {
+  const size_t block_entries = options_.block_size;
+  const size_t block_size = block_entries * entry_size();
+  for (Pool* pool : {&keys_, &values_}) {
+    if (options_.storage == Storage::kInt8) {
+      std::memcpy(pool->quantized_data.data() + to * block_size,
+                  pool->quantized_data.data() + from * block_size, block_size);
+      std::memcpy(pool->scales.data() + to * block_entries,
+                  pool->scales.data() + from * block_entries,
+                  block_entries * sizeof(float));
+    } else {
+      std::memcpy(pool->data.data() + to * block_size,
+                  pool->data.data() + from * block_size,
+                  block_size * sizeof(float));
+    }
+  }
+}
+
+void PagedKVCache::Write(Pool& pool, int block, int slot,
+                         const float* entry) {
+  const size_t index = static_cast<size_t>(block) * options_.block_size + slot;
+  const int size = entry_size();
+  if (options_.storage == Storage::kFloat32) {
+    std::memcpy(pool.data.data() + index * size, entry, size * sizeof(float));
+    return;
+  }
+  // Symmetric quantization with a scale per token.
+  float max_abs = 0.0f;
+  for (int i = 0; i < size; ++i) {
+    max_abs = std::max(max_abs, std::abs(entry[i]));
+  }
+  const float scale = max_abs > 0.0f ? max_abs / 127.0f : 1.0f;
+  pool.scales[index] = scale;
+  int8_t* quantized = pool.quantized_data.data() + index * size;
+  for (int i = 0; i < size; ++i) {
+    quantized[i] = static_cast<int8_t>(
+        std::min(127.0f, std::max(-127.0f, std::round(entry[i] / scale))));
+  }
+}
+
+void PagedKVCache::Read(const Pool& pool, int block, int slot,
+                        float* output) const {
+  const size_t index = static_cast<size_t>(block) * options_.block_size + slot;
+  const int size = entry_size();
+  if (options_.storage == Storage::kFloat32) {
+    std::memcpy(output, pool.data.data() + index * size, size * sizeof(float));
+    return;
+  }
+  const float scale = pool.scales[index];
+  const int8_t* quantized = pool.quantized_data.data() + index * size;
+  for (int i = 0; i < size; ++i) {
+    output[i] = quantized[i] * scale;
+  }
+}
+
+float PagedKVCache::Dot(const Pool& pool, int block, int slot, int head,
+                        const float* query) const {
+  const size_t index = static_cast<size_t>(block) * options_.block_size + slot;
+  const size_t offset = index * entry_size() + head * options_.head_dim;
+  float dot = 0.0f;
+  if (options_.storage == Storage::kFloat32) {
+    const float* entry = pool.data.data() + offset;
+    for (int i = 0; i < options_.head_dim; ++i) dot += query[i] * entry[i];
+    return dot;
+  }
+  const int8_t* entry = pool.quantized_data.data() + offset;
+  for (int i = 0; i < options_.head_dim; ++i) dot += query[i] * entry[i];
+  return dot * pool.scales[index];
+}
+
+void PagedKVCache::AddScaled(const Pool& pool, int block, int slot, int head,
+                             float weight, float* output) const {
+  const size_t index = static_cast<size_t>(block) * options_.block_size + slot;
+  const size_t offset = index * entry_size() + head * options_.head_dim;
+  if (options_.storage == Storage::kFloat32) {
+    const float* entry = pool.data.data() + offset;
+    for (int i = 0; i < options_.head_dim; ++i) output[i] += weight * entry[i];
+    return;
+  }
+  const int8_t* entry = pool.quantized_data.data() + offset;
+  weight *= pool.scales[index];
+  for (int i = 0; i < options_.head_dim; ++i) output[i] += weight * entry[i];
+}
+
+}  // namespace genai
+}  // namespace tflite
@@ -0,0 +1,139 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_GENAI_PAGED_KVCACHE_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_GENAI_PAGED_KVCACHE_H_
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+
+namespace tflite {
+namespace genai {
+
+// A key/value cache for several concurrent sequences that share a fixed pool
+// of blocks, each holding the keys and values of `block_size` tokens.
+//
+// Unlike the KV_CACHE op, which reserves the maximum number of entries for its
+// single sequence, a sequence only holds the blocks it has filled, listed in
+// its block table. Forked sequences share the blocks of their parent (e.g. a
+// common prompt), and a shared block is copied the first time one of the
+// sequences appends to it. Blocks can be stored as int8, with a scale per
+// token, to fit about four times as many tokens in the same memory.
+//
+// The keys and values of a token are [num_heads, head_dim] float arrays.
+//
+// This class is not thread safe.
+class PagedKVCache {
+ public:
+  enum class Storage { kFloat32, kInt8 };
+
+  struct Options {
+    // The number of tokens per block.
+    int block_size = 16;
+    // The number of blocks in the pool, which bounds the memory of the cache.
+    int num_blocks = 0;
+    int num_heads = 0;
+    int head_dim = 0;
+    Storage storage = Storage::kFloat32;
+  };
+
+  explicit PagedKVCache(const Options& options);
+
+  PagedKVCache(const PagedKVCache&) = delete;
+  PagedKVCache& operator=(const PagedKVCache&) = delete;
+
+  // Returns the id of a new, empty sequence.
+  int CreateSequence();
+
+  // Returns the id of a new sequence that starts with the tokens of
+  // `sequence`, sharing its blocks, or -1 if `sequence` does not exist.
+  int ForkSequence(int sequence);
+
+  // Releases the sequence and the blocks no other sequence uses.
+  TfLiteStatus ReleaseSequence(int sequence);
+
+  // Appends the keys and values of `num_tokens` tokens to the sequence. Fails
+  // without changing the cache if there are not enough free blocks.
+  TfLiteStatus Append(int sequence, const float* keys, const float* values,
+                      int num_tokens);
+
+  // Returns the number of tokens of the sequence, or -1 if it does not exist.
+  int NumTokens(int sequence) const;
+
+  // Returns the blocks holding the tokens of the sequence, in order. Token t
+  // is at index t % block_size of block (*table)[t / block_size].
+  TfLiteStatus GetBlockTable(int sequence, std::vector<int>* table) const;
+
+  // Copies the key or value of the token at `slot` of `block` to `output`,
+  // dequantizing it if needed.
+  void ReadKey(int block, int slot, float* output) const;
+  void ReadValue(int block, int slot, float* output) const;
+
+  // Computes the multi-head attention of a [num_heads, head_dim] `query` over
+  // all the tokens of the sequence, reading the cache through its block table,
+  // and writes the [num_heads, head_dim] result to `output`.
+  TfLiteStatus Attention(int sequence, const float* query,
+                         float* output) const;
+
+  int NumFreeBlocks() const { return static_cast<int>(free_blocks_.size()); }
+  const Options& options() const { return options_; }
+
+ private:
+  struct Sequence {
+    std::vector<int> blocks;
+    int num_tokens = 0;
+  };
+
+  // The keys or the values of all blocks.
+  struct Pool {
+    std::vector<float> data;
+    // Used with kInt8 storage.
+    std::vector<int8_t> quantized_data;
+    std::vector<float> scales;
+  };
+
+  int entry_size() const { return options_.num_heads * options_.head_dim; }
+
+  int AllocateBlock();
+  void ReleaseBlock(int block);
+  void CopyBlock(int from, int to);
+
+  void Write(Pool& pool, int block, int slot, const float* entry);
+  void Read(const Pool& pool, int block, int slot, float* output) const;
+  // Returns the dot product of `query` and the entry of head `head` at `slot`
+  // of `block`.
+  float Dot(const Pool& pool, int block, int slot, int head,
+            const float* query) const;
+  // Adds `weight` times the entry of head `head` at `slot` of `block` to
+  // `output`.
+  void AddScaled(const Pool& pool, int block, int slot, int head,
+                 float weight, float* output) const;
+
+  const Options options_;
+  Pool keys_;
+  Pool values_;
+  std::vector<int> ref_counts_;
+  std::vector<int> free_blocks_;
+  std::unordered_map<int, Sequence> sequences_;
+  int next_sequence_id_ = 0;
+};
+
+}  // namespace genai
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_GENAI_PAGED_KVCACHE_H_
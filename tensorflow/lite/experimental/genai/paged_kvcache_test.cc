@@ -0,0 +1,190 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/experimental/genai/paged_kvcache.h"
+
+#include <cmath>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/common.h"
+
+namespace tflite {
+namespace genai {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::FloatNear;
+using ::testing::Pointwise;
+
+PagedKVCache::Options GetOptions(PagedKVCache::Storage storage) {
+  PagedKVCache::Options options;
+  options.block_size = 2;
+  options.num_blocks = 4;
+  options.num_heads = 2;
+  options.head_dim = 2;
+  options.storage = storage;
+  return options;
+}
+
+// Returns the [num_tokens, 2, 2] keys or values of tokens first..first+n-1.
+std::vector<float> Entries(int first, int num_tokens, float sign) {
+  std::vector<float> entries;
+  for (int t = first; t < first + num_tokens; ++t) {
+    for (int i = 0; i < 4; ++i) entries.push_back(sign * (t + 0.25f * i));
+  }
+  return entries;
+}
+
+std::vector<float> ReadKey(const PagedKVCache& cache, int sequence,
+                           int token) {
+  std::vector<int> table;
+  EXPECT_EQ(cache.GetBlockTable(sequence, &table), kTfLiteOk);
+  std::vector<float> key(4);
+  cache.ReadKey(table[token / 2], token % 2, key.data());
+  return key;
+}
+
+TEST(PagedKVCacheTest, AppendAllocatesBlocks) {
+  PagedKVCache cache(GetOptions(PagedKVCache::Storage::kFloat32));
+  const int sequence = cache.CreateSequence();
+  EXPECT_EQ(cache.NumTokens(sequence), 0);
+  EXPECT_EQ(cache.NumFreeBlocks(), 4);
+
+  ASSERT_EQ(cache.Append(sequence, Entries(0, 3, 1).data(),
+                         Entries(0, 3, -1).data(), 3),
+            kTfLiteOk);
+  EXPECT_EQ(cache.NumTokens(sequence), 3);
+  EXPECT_EQ(cache.NumFreeBlocks(), 2);
+  std::vector<int> table;
+  ASSERT_EQ(cache.GetBlockTable(sequence, &table), kTfLiteOk);
+  EXPECT_THAT(table, ElementsAre(0, 1));
+  EXPECT_THAT(ReadKey(cache, sequence, 2), ElementsAre(2, 2.25, 2.5, 2.75));
+  std::vector<float> value(4);
+  cache.ReadValue(table[0], 1, value.data());
+  EXPECT_THAT(value, ElementsAre(-1, -1.25, -1.5, -1.75));
+
+  // Only one block is left for 3 new tokens.
+  ASSERT_EQ(cache.Append(sequence, Entries(3, 3, 1).data(),
+                         Entries(3, 3, -1).data(), 3),
+            kTfLiteOk);
+  EXPECT_EQ(cache.Append(sequence, Entries(6, 3, 1).data(),
+                         Entries(6, 3, -1).data(), 3),
+            kTfLiteError);
+  EXPECT_EQ(cache.NumTokens(sequence), 6);
+
+  EXPECT_EQ(cache.ReleaseSequence(sequence), kTfLiteOk);
+  EXPECT_EQ(cache.NumFreeBlocks(), 4);
+  EXPECT_EQ(cache.ReleaseSequence(sequence), kTfLiteError);
+  EXPECT_EQ(cache.NumTokens(sequence), -1);
+}
+
+TEST(PagedKVCacheTest, ForkSharesPrefix) {
+  PagedKVCache cache(GetOptions(PagedKVCache::Storage::kFloat32));
+  const int prompt = cache.CreateSequence();
+  ASSERT_EQ(cache.Append(prompt, Entries(0, 3, 1).data(),
+                         Entries(0, 3, -1).data(), 3),
+            kTfLiteOk);
+  const int fork = cache.ForkSequence(prompt);
+  ASSERT_GE(fork, 0);
+  EXPECT_EQ(cache.NumTokens(fork), 3);
+  EXPECT_EQ(cache.NumFreeBlocks(), 2);
+  EXPECT_EQ(cache.ForkSequence(100), -1);
+
+  // Appending to the shared, partially filled block copies it.
+  ASSERT_EQ(cache.Append(fork, Entries(10, 1, 1).data(),
+                         Entries(10, 1, -1).data(), 1),
+            kTfLiteOk);
+  EXPECT_EQ(cache.NumFreeBlocks(), 1);
+  std::vector<int> prompt_table;
+  std::vector<int> fork_table;
+  ASSERT_EQ(cache.GetBlockTable(prompt, &prompt_table), kTfLiteOk);
+  ASSERT_EQ(cache.GetBlockTable(fork, &fork_table), kTfLiteOk);
+  EXPECT_EQ(prompt_table[0], fork_table[0]);
+  EXPECT_NE(prompt_table[1], fork_table[1]);
+  EXPECT_THAT(ReadKey(cache, fork, 2), ElementsAre(2, 2.25, 2.5, 2.75));
+  EXPECT_THAT(ReadKey(cache, fork, 3), ElementsAre(10, 10.25, 10.5, 10.75));
+
+  // The prompt still owns its last block, so it appends to it in place.
+  ASSERT_EQ(cache.Append(prompt, Entries(20, 1, 1).data(),
+                         Entries(20, 1, -1).data(), 1),
+            kTfLiteOk);
+  EXPECT_EQ(cache.NumFreeBlocks(), 1);
+  EXPECT_THAT(ReadKey(cache, prompt, 3), ElementsAre(20, 20.25, 20.5, 20.75));
+  EXPECT_THAT(ReadKey(cache, fork, 3), ElementsAre(10, 10.25, 10.5, 10.75));
+
+  // The first block is released with the last sequence using it.
+  EXPECT_EQ(cache.ReleaseSequence(prompt), kTfLiteOk);
+  EXPECT_EQ(cache.NumFreeBlocks(), 2);
+  EXPECT_EQ(cache.ReleaseSequence(fork), kTfLiteOk);
+  EXPECT_EQ(cache.NumFreeBlocks(), 4);
+}
+
+TEST(PagedKVCacheTest, Int8Storage) {
+  PagedKVCache cache(GetOptions(PagedKVCache::Storage::kInt8));
+  const int sequence = cache.CreateSequence();
+  ASSERT_EQ(cache.Append(sequence, Entries(1, 3, 1).data(),
+                         Entries(1, 3, -1).data(), 3),
+            kTfLiteOk);
+  for (int t = 0; t < 3; ++t) {
+    EXPECT_THAT(ReadKey(cache, sequence, t),
+                Pointwise(FloatNear(0.02), Entries(t + 1, 1, 1)));
+  }
+}
+
+TEST(PagedKVCacheTest, Attention) {
+  for (auto storage :
+       {PagedKVCache::Storage::kFloat32, PagedKVCache::Storage::kInt8}) {
+    PagedKVCache cache(GetOptions(storage));
+    const int sequence = cache.CreateSequence();
+    std::vector<float> output(4);
+    const std::vector<float> query = {1, 0, 0, 1};
+    ASSERT_EQ(cache.Attention(sequence, query.data(), output.data()),
+              kTfLiteOk);
+    EXPECT_THAT(output, ElementsAre(0, 0, 0, 0));
+
+    const std::vector<float> keys = {1, 0, 0, 1, 0, 1, 1, 0, 1, 1, 1, 1};
+    const std::vector<float> values = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+    ASSERT_EQ(cache.Append(sequence, keys.data(), values.data(), 3),
+              kTfLiteOk);
+    ASSERT_EQ(cache.Attention(sequence, query.data(), output.data()),
+              kTfLiteOk);
+
+    // Computes the expected result from contiguous keys and values.
+    std::vector<float> expected(4, 0.0f);
+    for (int head = 0; head < 2; ++head) {
+      std::vector<float> weights(3);
+      float sum = 0.0f;
+      for (int t = 0; t < 3; ++t) {
+        const float score = query[head * 2] * keys[t * 4 + head * 2] +
+                            query[head * 2 + 1] * keys[t * 4 + head * 2 + 1];
+        weights[t] = std::exp(score / std::sqrt(2.0f));
+        sum += weights[t];
+      }
+      for (int t = 0; t < 3; ++t) {
+        for (int i = 0; i < 2; ++i) {
+          expected[head * 2 + i] +=
+              weights[t] / sum * values[t * 4 + head * 2 + i];
+        }
+      }
+    }
+    EXPECT_THAT(output, Pointwise(FloatNear(0.05), expected));
+  }
+}
+
+}  // namespace
+}  // namespace genai
+}  // namespace tflite
@@ -70,6 +70,13 @@ class GraphInfo {
 
   // Returns the indices of the variable tensors.
   virtual const std::vector<int>& variables() const = 0;
+
+  // Returns the first and the last execution plan index of the nodes that may
+  // be invoked concurrently with the node at execution plan index `index`.
+  // The tensors used by any of these nodes must stay allocated until all of
+  // them have been invoked.
+  virtual size_t first_concurrent_node(size_t index) const { return index; }
+  virtual size_t last_concurrent_node(size_t index) const { return index; }
 };
 
 // Represents a subset of nodes in a TensorFlow Lite graph.
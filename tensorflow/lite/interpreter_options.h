@@ -19,8 +19,13 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_INTERPRETER_OPTIONS_H_
 #define TENSORFLOW_LITE_INTERPRETER_OPTIONS_H_
 
+#include <memory>
+#include <utility>
+
 namespace tflite {
 
+class SharedArenaBuffer;
+
 /// Options class for `Interpreter`.
 /// WARNING: This is an experimental API and subject to change.
 class InterpreterOptions {
@@ -103,12 +108,115 @@ class InterpreterOptions {
     return experimental_cache_constant_cast_op_;
   }
 
+  // Sets the maximum number of nodes that may be invoked concurrently. Nodes
+  // that don't depend on each other, such as the branches of a multi-tower
+  // model, are then grouped into stages of up to `value` nodes, and the nodes
+  // of a stage are invoked on a pool of `value - 1` threads and the calling
+  // thread. Tensors of the nodes of a stage are kept allocated until the whole
+  // stage has run, so this may increase the arena size. Each concurrently
+  // invoked node gets its own CPU backend context, which uses the number of
+  // threads of the interpreter, so the number of threads should be lowered
+  // accordingly. Values below 2 disable the feature, which is the default.
+  //
+  // Nodes of delegates, custom ops, control flow ops and ops on resource,
+  // variant or variable tensors are always invoked on their own, and the
+  // subgraph runs sequentially while it has dynamic tensors or a profiler.
+  // This must be set before `AllocateTensors`.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  void SetMaxNumParallelNodes(int value) {
+    experimental_max_num_parallel_nodes_ = value;
+  }
+
+  // Returns the maximum number of nodes that may be invoked concurrently.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  int GetMaxNumParallelNodes() const {
+    return experimental_max_num_parallel_nodes_;
+  }
+
+  // Streams the weights of memory-mapped models through memory, so that
+  // models larger than the available RAM can run. While the node at index `i`
+  // of the execution plan runs, the pages of the read-only tensors of nodes
+  // `i + 1` to `i + value` are read ahead, and the pages of read-only
+  // tensors are dropped from memory after the last node that uses them. The
+  // pages touched while preparing the model, e.g. by delegates packing
+  // weights, are dropped by `AllocateTensors`. Peak resident memory for the
+  // weights is then bounded by the weights of `value + 1` consecutive nodes.
+  // Values below 1 disable the feature, which is the default.
+  //
+  // This only applies to models loaded with an `MMAPAllocation`. Dropped pages
+  // are read back from the model file on their next access, so every invoke
+  // reads the weights from storage again.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  void SetWeightStreamingWindow(int value) {
+    experimental_weight_streaming_window_ = value;
+  }
+
+  // Returns the number of nodes whose weights are read ahead when weight
+  // streaming is enabled, or a value below 1 if it is disabled.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  int GetWeightStreamingWindow() const {
+    return experimental_weight_streaming_window_;
+  }
+
+  // Defers the preparation and allocation of the subgraphs of control flow
+  // ops (IF and WHILE) to their first invocation, so that `AllocateTensors`
+  // only prepares the subgraphs on the path from the primary subgraph that
+  // is actually taken, and branches that are never taken are never prepared.
+  // The outputs of these ops then become dynamic tensors, which costs an
+  // extra copy of the outputs on every invocation.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  void SetLazyControlFlowSubgraphs(bool value = true) {
+    experimental_lazy_control_flow_subgraphs_ = value;
+  }
+
+  // Returns true if the subgraphs of control flow ops are prepared on their
+  // first invocation.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  bool GetLazyControlFlowSubgraphs() const {
+    return experimental_lazy_control_flow_subgraphs_;
+  }
+
+  // Makes the non-persistent arena of the primary subgraph use `buffer`,
+  // which other interpreters that never run at the same time as this one
+  // (e.g. models that run one after another on every frame) can use as well.
+  // Their activations then take the memory of the largest of them instead of
+  // the sum.
+  //
+  // Allocating the tensors of an interpreter takes the buffer from the
+  // interpreter that used it before, whose input and output tensors are
+  // invalidated: `AllocateTensors()` must be called again before filling its
+  // inputs and invoking it, and the outputs of an interpreter must be read
+  // before the tensors of another one are allocated. Ignored with the simple
+  // memory planner.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  void SetSharedArenaBuffer(std::shared_ptr<SharedArenaBuffer> buffer) {
+    experimental_shared_arena_buffer_ = std::move(buffer);
+  }
+
+  // Returns the buffer shared with the arenas of other interpreters, if any.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  const std::shared_ptr<SharedArenaBuffer>& GetSharedArenaBuffer() const {
+    return experimental_shared_arena_buffer_;
+  }
+
  private:
   bool experimental_preserve_all_tensors_ = false;
   bool experimental_ensure_dynamic_tensors_are_released_ = false;
   int experimental_optimize_memory_for_large_tensors_ = 0;
   bool experimental_disable_delegate_clustering_ = false;
   bool experimental_cache_constant_cast_op_ = false;
+  int experimental_max_num_parallel_nodes_ = 1;
+  int experimental_weight_streaming_window_ = 0;
+  bool experimental_lazy_control_flow_subgraphs_ = false;
+  std::shared_ptr<SharedArenaBuffer> experimental_shared_arena_buffer_;
 };
 
 }  // namespace tflite
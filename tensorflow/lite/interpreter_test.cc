@@ -1127,6 +1127,59 @@ TEST(BasicInterpreter, ReleaseDynamicTensors) {
   ASSERT_EQ(interpreter.tensor(3)->bytes, sizeof(float) * 6 * 6);
 }
 
+TEST(BasicInterpreter, InvokeIndependentNodesInParallel) {
+  Interpreter interpreter;
+  InterpreterOptions options;
+  options.SetMaxNumParallelNodes(2);
+  interpreter.ApplyOptions(&options);
+  ASSERT_EQ(interpreter.AddTensors(5), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0, 1}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({4}), kTfLiteOk);
+  TfLiteQuantizationParams quantized;
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_EQ(interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "",
+                                                       {3}, quantized),
+              kTfLiteOk);
+  }
+
+  // The two NEG nodes do not depend on each other, the ADD needs both.
+  TfLiteRegistration* neg_op = tflite::ops::builtin::Register_NEG();
+  TfLiteRegistration* add_op = tflite::ops::builtin::Register_ADD();
+  auto* add_params =
+      reinterpret_cast<TfLiteAddParams*>(malloc(sizeof(TfLiteAddParams)));
+  add_params->activation = kTfLiteActNone;
+  add_params->pot_scale_int16 = false;
+  ASSERT_EQ(interpreter.AddNodeWithParameters({0}, {2}, nullptr, 0, nullptr,
+                                              neg_op),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AddNodeWithParameters({2, 3}, {4}, nullptr, 0,
+                                              add_params, add_op),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AddNodeWithParameters({1}, {3}, nullptr, 0, nullptr,
+                                              neg_op),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+  // The NEG nodes are scheduled ahead of the ADD that consumes them.
+  EXPECT_THAT(interpreter.execution_plan(), ElementsAre(0, 2, 1));
+  // Their outputs are live at the same time.
+  EXPECT_NE(interpreter.tensor(2)->data.raw, interpreter.tensor(3)->data.raw);
+
+  for (int run = 0; run < 3; ++run) {
+    float* input0 = interpreter.typed_tensor<float>(0);
+    float* input1 = interpreter.typed_tensor<float>(1);
+    for (int i = 0; i < 3; ++i) {
+      input0[i] = i + run;
+      input1[i] = 10 * i;
+    }
+    ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+    const float* output = interpreter.typed_tensor<float>(4);
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_EQ(output[i], -(i + run) - 10 * i);
+    }
+  }
+}
+
 TEST(InterpreterTensorsCapacityTest, TestWithinHeadroom) {
   Interpreter interpreter;
   ASSERT_EQ(interpreter.AddTensors(Interpreter::kTensorsReservedCapacity),
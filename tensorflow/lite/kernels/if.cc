@@ -108,9 +108,18 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
         subgraph_input->allocation_type = kTfLiteCustom;
       }
     }
-    TF_LITE_ENSURE_OK(context, subgraph->AllocateTensors());
-    op_data->subgraph_has_dynamic_output_tensors |=
-        subgraph->HasDynamicTensors();
+  }
+
+  if (this_subgraph->ShouldPrepareControlFlowSubgraphsLazily()) {
+    // The output shapes are unknown until a branch is prepared, which
+    // Eval_dynamic does for the taken branch only.
+    op_data->subgraph_has_dynamic_output_tensors = true;
+  } else {
+    for (auto* subgraph : {then_subgraph, else_subgraph}) {
+      TF_LITE_ENSURE_OK(context, subgraph->AllocateTensors());
+      op_data->subgraph_has_dynamic_output_tensors |=
+          subgraph->HasDynamicTensors();
+    }
   }
 
   if (!op_data->subgraph_has_dynamic_output_tensors) {
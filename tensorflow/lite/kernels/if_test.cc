@@ -121,6 +121,58 @@ TEST_F(SimpleIfTest, TestIfFalseWithLargeInputsTwice) {
   CheckIntTensor(output, {kNumLargeTensors}, expected2);
 }
 
+// Test IF op with branches that are only prepared when they are taken.
+// The computation is: `cond ? a + b : a * b`.
+class LazyIfTest : public ControlFlowOpTest {
+ protected:
+  void SetUp() override {
+    AddSubgraphs(2);
+    builder_->BuildAddSubgraph(interpreter_->subgraph(1));
+    builder_->BuildMulSubgraph(interpreter_->subgraph(2));
+    builder_->BuildIfSubgraph(&interpreter_->primary_subgraph());
+
+    InterpreterOptions options;
+    options.SetLazyControlFlowSubgraphs();
+    ASSERT_EQ(interpreter_->ApplyOptions(&options), kTfLiteOk);
+    interpreter_->ResizeInputTensor(interpreter_->inputs()[0], {1});
+    interpreter_->ResizeInputTensor(interpreter_->inputs()[1], {2});
+    interpreter_->ResizeInputTensor(interpreter_->inputs()[2], {1, 2});
+    ASSERT_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+
+    FillIntTensor(interpreter_->tensor(interpreter_->inputs()[1]), {5, 7});
+    FillIntTensor(interpreter_->tensor(interpreter_->inputs()[2]), {1, 2});
+  }
+
+  // Returns true if the branch subgraph has not been allocated yet.
+  bool IsUnprepared(int subgraph_index) {
+    Subgraph* subgraph = interpreter_->subgraph(subgraph_index);
+    return subgraph->tensor(subgraph->outputs()[0])->data.raw == nullptr;
+  }
+};
+
+TEST_F(LazyIfTest, TestOnlyTakenBranchIsPrepared) {
+  EXPECT_TRUE(IsUnprepared(1));
+  EXPECT_TRUE(IsUnprepared(2));
+
+  interpreter_->typed_input_tensor<bool>(0)[0] = true;
+  ASSERT_EQ(interpreter_->Invoke(), kTfLiteOk);
+  TfLiteTensor* output = interpreter_->tensor(interpreter_->outputs()[0]);
+  EXPECT_TRUE(IsDynamicTensor(output));
+  CheckIntTensor(output, {1, 2}, {6, 9});
+  EXPECT_TRUE(IsUnprepared(2));
+
+  interpreter_->typed_input_tensor<bool>(0)[0] = false;
+  ASSERT_EQ(interpreter_->Invoke(), kTfLiteOk);
+  output = interpreter_->tensor(interpreter_->outputs()[0]);
+  CheckIntTensor(output, {1, 2}, {5, 14});
+
+  // Second invocation of the prepared branch.
+  FillIntTensor(interpreter_->tensor(interpreter_->inputs()[2]), {2, 3});
+  ASSERT_EQ(interpreter_->Invoke(), kTfLiteOk);
+  output = interpreter_->tensor(interpreter_->outputs()[0]);
+  CheckIntTensor(output, {1, 2}, {10, 21});
+}
+
 // Test IF op using subgraphs with dynamically sized outputs.
 // The computation is: `cond ? a + b : pad(a, b)`.
 class DynamicSubgraphIfTest : public ControlFlowOpTest {
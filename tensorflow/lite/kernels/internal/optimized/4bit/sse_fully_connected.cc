@@ -21,11 +21,19 @@ limitations under the License.
 // NOLINTBEGIN
 #include <tmmintrin.h>
 
+#if defined(__GNUC__)
+#include <immintrin.h>
+// The AVX2 and AVX-512 VNNI kernels are compiled for their instruction sets
+// with function attributes, and only run when the CPU supports them.
+#define FC_4BIT_AVX_DISPATCH
+#endif
+
 #include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <vector>
 
+#include "include/cpuinfo.h"
 #include "tensorflow/lite/kernels/internal/cppmath.h"
 #include "tensorflow/lite/kernels/internal/optimized/4bit/fully_connected_common.h"
 #include "tensorflow/lite/kernels/internal/optimized/4bit/sse_fully_connected_impl.h"
@@ -311,10 +319,10 @@ inline __m128i ReduceInt32x4x4(__m128i a, __m128i b, __m128i c, __m128i d) {
 }
 
 template <int RowsLeft, int RowsRight, int Cols>
-void SseRunKernel(const uint8_t* lhs, const int8_t* rhs, int32_t* dst,
-                  int lhs_layout_rows, int lhs_layout_cols, int rhs_layout_rows,
-                  int rhs_layout_cols, int dst_layout_rows,
-                  int dst_layout_cols) {
+void Ssse3RunKernel(const uint8_t* lhs, const int8_t* rhs, int32_t* dst,
+                    int lhs_layout_rows, int lhs_layout_cols,
+                    int rhs_layout_rows, int rhs_layout_cols,
+                    int dst_layout_rows, int dst_layout_cols) {
   const int start_row = 0;
   const int start_col = 0;
   const int end_row = lhs_layout_rows;
@@ -388,8 +396,183 @@ void SseRunKernel(const uint8_t* lhs, const int8_t* rhs, int32_t* dst,
     }
   }
 }
+
+#ifdef FC_4BIT_AVX_DISPATCH
+// Unpacks the 4bit values of 16 bytes of lhs to 32 int8 values, the upper
+// halves of the bytes first, as the rhs is laid out.
+__attribute__((target("avx2"))) inline __m256i LoadLhsAvx2(
+    const uint8_t* lhs_val) {
+  const __m128i bitmask = _mm_set1_epi8(15);
+  const __m128i lhs_row = _mm_load_si128((const __m128i*)(lhs_val));
+  const __m128i upper = _mm_and_si128(_mm_srli_epi16(lhs_row, 4), bitmask);
+  const __m128i lower = _mm_and_si128(lhs_row, bitmask);
+  return _mm256_inserti128_si256(_mm256_castsi128_si256(upper), lower, 1);
+}
+
+// Reduces the RowsLeft accumulators of each of the RowsRight columns and
+// writes the sums to dst.
+template <int RowsLeft, int RowsRight>
+__attribute__((target("avx2"))) inline void StoreSumsAvx2(
+    const __m256i* accum, int32_t* dst) {
+  static_assert(RowsLeft == 4, "ReduceInt32x4x4 reduces 4 accumulators.");
+  for (int r = 0; r < RowsRight; ++r) {
+    __m128i sums[RowsLeft];
+    for (int l = 0; l < RowsLeft; ++l) {
+      const __m256i acc = accum[r * RowsLeft + l];
+      sums[l] = _mm_add_epi32(_mm256_castsi256_si128(acc),
+                              _mm256_extracti128_si256(acc, 1));
+    }
+    _mm_storeu_si128((__m128i*)(dst + r * 4),
+                     ReduceInt32x4x4(sums[0], sums[1], sums[2], sums[3]));
+  }
+}
+
+// Same as Ssse3RunKernel, with 32 lhs and rhs values per instruction. The lhs
+// values are unsigned 4bit values, so the products of pairs of values fit in
+// int16 and can be summed with _mm256_maddubs_epi16.
+template <int RowsLeft, int RowsRight, int Cols>
+__attribute__((target("avx2"))) void Avx2RunKernel(
+    const uint8_t* lhs, const int8_t* rhs, int32_t* dst, int lhs_layout_rows,
+    int lhs_layout_cols, int rhs_layout_rows, int rhs_layout_cols,
+    int dst_layout_rows, int dst_layout_cols) {
+  const int clamped_end_row = std::min(lhs_layout_rows, dst_layout_cols);
+  const int clamped_end_col = std::min(rhs_layout_rows, dst_layout_rows);
+  const int outer_rows = (clamped_end_row + RowsLeft - 1) / RowsLeft;
+  const int outer_cols = (clamped_end_col + RowsRight - 1) / RowsRight;
+  const int depth = std::min(lhs_layout_cols / Cols, rhs_layout_cols / Cols);
+  const __m256i ones = _mm256_set1_epi16(1);
+  const uintptr_t padding = 15;
+  std::vector<uint8_t> lhs_vec_data((RowsLeft * lhs_layout_cols / 2) + padding);
+  uint8_t* lhs_vec = reinterpret_cast<uint8_t*>(
+      (reinterpret_cast<uintptr_t>(lhs_vec_data.data()) + padding) &
+      ~(padding));
+  for (int i = 0; i < outer_rows; ++i) {
+    const uint8_t* lhs_val_data = lhs + i * RowsLeft * lhs_layout_cols / 2;
+    if (!is_aligned(lhs_val_data, 16)) {
+      memcpy(lhs_vec, lhs_val_data, RowsLeft * lhs_layout_cols / 2);
+      lhs_val_data = lhs_vec;
+    }
+    for (int j = 0; j < outer_cols; ++j) {
+      const uint8_t* lhs_val = lhs_val_data;
+      const int8_t* rhs_val = rhs + j * RowsRight * rhs_layout_cols;
+      __m256i accum[RowsRight * RowsLeft];
+      for (int m = 0; m < (RowsLeft * RowsRight); ++m) {
+        accum[m] = _mm256_setzero_si256();
+      }
+      for (int k = 0; k < depth; ++k) {
+        __m256i lhs_row[RowsLeft];
+        for (int m = 0; m < RowsLeft; ++m) {
+          lhs_row[m] = LoadLhsAvx2(lhs_val);
+          lhs_val += 16;
+        }
+        for (int r = 0; r < RowsRight; ++r) {
+          const __m256i rhs_row =
+              _mm256_loadu_si256((const __m256i*)(rhs_val));
+          rhs_val += 32;
+          for (int l = 0; l < RowsLeft; ++l) {
+            const __m256i sumprod_16x16 =
+                _mm256_maddubs_epi16(lhs_row[l], rhs_row);
+            accum[r * RowsLeft + l] =
+                _mm256_add_epi32(accum[r * RowsLeft + l],
+                                 _mm256_madd_epi16(sumprod_16x16, ones));
+          }
+        }
+      }
+      StoreSumsAvx2<RowsLeft, RowsRight>(accum, dst);
+      dst += RowsRight * 4;
+    }
+  }
+}
+
+// Same as Avx2RunKernel, with the products summed by VPDPBUSD.
+template <int RowsLeft, int RowsRight, int Cols>
+__attribute__((target("avx2,avx512vl,avx512vnni"))) void AvxVnniRunKernel(
+    const uint8_t* lhs, const int8_t* rhs, int32_t* dst, int lhs_layout_rows,
+    int lhs_layout_cols, int rhs_layout_rows, int rhs_layout_cols,
+    int dst_layout_rows, int dst_layout_cols) {
+  const int clamped_end_row = std::min(lhs_layout_rows, dst_layout_cols);
+  const int clamped_end_col = std::min(rhs_layout_rows, dst_layout_rows);
+  const int outer_rows = (clamped_end_row + RowsLeft - 1) / RowsLeft;
+  const int outer_cols = (clamped_end_col + RowsRight - 1) / RowsRight;
+  const int depth = std::min(lhs_layout_cols / Cols, rhs_layout_cols / Cols);
+  const uintptr_t padding = 15;
+  std::vector<uint8_t> lhs_vec_data((RowsLeft * lhs_layout_cols / 2) + padding);
+  uint8_t* lhs_vec = reinterpret_cast<uint8_t*>(
+      (reinterpret_cast<uintptr_t>(lhs_vec_data.data()) + padding) &
+      ~(padding));
+  for (int i = 0; i < outer_rows; ++i) {
+    const uint8_t* lhs_val_data = lhs + i * RowsLeft * lhs_layout_cols / 2;
+    if (!is_aligned(lhs_val_data, 16)) {
+      memcpy(lhs_vec, lhs_val_data, RowsLeft * lhs_layout_cols / 2);
+      lhs_val_data = lhs_vec;
+    }
+    for (int j = 0; j < outer_cols; ++j) {
+      const uint8_t* lhs_val = lhs_val_data;
+      const int8_t* rhs_val = rhs + j * RowsRight * rhs_layout_cols;
+      __m256i accum[RowsRight * RowsLeft];
+      for (int m = 0; m < (RowsLeft * RowsRight); ++m) {
+        accum[m] = _mm256_setzero_si256();
+      }
+      for (int k = 0; k < depth; ++k) {
+        __m256i lhs_row[RowsLeft];
+        for (int m = 0; m < RowsLeft; ++m) {
+          lhs_row[m] = LoadLhsAvx2(lhs_val);
+          lhs_val += 16;
+        }
+        for (int r = 0; r < RowsRight; ++r) {
+          const __m256i rhs_row =
+              _mm256_loadu_si256((const __m256i*)(rhs_val));
+          rhs_val += 32;
+          for (int l = 0; l < RowsLeft; ++l) {
+            accum[r * RowsLeft + l] = _mm256_dpbusd_epi32(
+                accum[r * RowsLeft + l], lhs_row[l], rhs_row);
+          }
+        }
+      }
+      StoreSumsAvx2<RowsLeft, RowsRight>(accum, dst);
+      dst += RowsRight * 4;
+    }
+  }
+}
+
+inline bool HasAvx2() {
+  static const bool has_avx2 = cpuinfo_initialize() && cpuinfo_has_x86_avx2();
+  return has_avx2;
+}
+
+inline bool HasAvxVnni() {
+  static const bool has_avx_vnni = HasAvx2() &&
+                                   cpuinfo_has_x86_avx512vl() &&
+                                   cpuinfo_has_x86_avx512vnni();
+  return has_avx_vnni;
+}
+#endif  // FC_4BIT_AVX_DISPATCH
 // NOLINTEND
 
+template <int RowsLeft, int RowsRight, int Cols>
+void SseRunKernel(const uint8_t* lhs, const int8_t* rhs, int32_t* dst,
+                  int lhs_layout_rows, int lhs_layout_cols, int rhs_layout_rows,
+                  int rhs_layout_cols, int dst_layout_rows,
+                  int dst_layout_cols) {
+#ifdef FC_4BIT_AVX_DISPATCH
+  if (HasAvxVnni()) {
+    AvxVnniRunKernel<RowsLeft, RowsRight, Cols>(
+        lhs, rhs, dst, lhs_layout_rows, lhs_layout_cols, rhs_layout_rows,
+        rhs_layout_cols, dst_layout_rows, dst_layout_cols);
+    return;
+  }
+  if (HasAvx2()) {
+    Avx2RunKernel<RowsLeft, RowsRight, Cols>(
+        lhs, rhs, dst, lhs_layout_rows, lhs_layout_cols, rhs_layout_rows,
+        rhs_layout_cols, dst_layout_rows, dst_layout_cols);
+    return;
+  }
+#endif
+  Ssse3RunKernel<RowsLeft, RowsRight, Cols>(
+      lhs, rhs, dst, lhs_layout_rows, lhs_layout_cols, rhs_layout_rows,
+      rhs_layout_cols, dst_layout_rows, dst_layout_cols);
+}
+
 template void SseUnpack<4, 1>(float* output_ptr, const int32_t* dst,
                               int batch_size, int num_units,
                               const float* scaling_factors,
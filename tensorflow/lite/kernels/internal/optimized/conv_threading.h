@@ -0,0 +1,85 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_CONV_THREADING_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_CONV_THREADING_H_
+
+#include <algorithm>
+#include <cstdint>
+
+#include "tensorflow/lite/kernels/internal/types.h"
+
+namespace tflite {
+namespace optimized_ops {
+
+// How the output of a conv-family kernel is split across threads: each of
+// `thread_count` threads computes a contiguous range of the
+// `thread_dim_size` output units along `thread_dim`, which is 0 (batches) or
+// 1 (rows).
+struct ConvThreadSplit {
+  int thread_dim = 1;
+  int thread_count = 1;
+  int thread_dim_size = 0;
+};
+
+// Chooses how to split the output of a conv-family kernel across at most
+// `max_threads` threads, so that each thread gets at least
+// `min_muls_per_thread` multiplications, where every output element needs
+// `muls_per_output` of them.
+//
+// The output is split along batches or rows, whichever leaves the least work
+// to the most loaded thread; on ties batches are preferred, since each thread
+// then works on whole images with less boundary handling. Threads that would
+// not shorten the run, e.g. the 8th thread for 9 rows, are not used.
+inline ConvThreadSplit PlanConvThreads(const RuntimeShape& output_shape,
+                                       int muls_per_output,
+                                       int min_muls_per_thread,
+                                       int max_threads) {
+  const int64_t num_muls =
+      static_cast<int64_t>(output_shape.FlatSize()) * muls_per_output;
+  const int64_t wanted_threads =
+      num_muls / std::max<int64_t>(1, min_muls_per_thread);
+  const int thread_count = static_cast<int>(
+      std::max<int64_t>(1, std::min<int64_t>(wanted_threads, max_threads)));
+
+  ConvThreadSplit split;
+  const int batches = output_shape.Dims(0);
+  const int rows = output_shape.Dims(1);
+  split.thread_dim_size = rows;
+  if (thread_count == 1 || batches == 0 || rows == 0) return split;
+
+  // The number of batches or rows of the most loaded thread.
+  const auto units_per_thread_along = [thread_count](int size) -> int64_t {
+    const int threads = std::min(thread_count, size);
+    return (size + threads - 1) / threads;
+  };
+  const int64_t batches_per_thread = units_per_thread_along(batches);
+  const int64_t rows_per_thread = units_per_thread_along(rows);
+  int64_t units_per_thread;
+  if (batches_per_thread * rows <= rows_per_thread * batches) {
+    split.thread_dim = 0;
+    split.thread_dim_size = batches;
+    units_per_thread = batches_per_thread;
+  } else {
+    units_per_thread = rows_per_thread;
+  }
+  split.thread_count = static_cast<int>(
+      (split.thread_dim_size + units_per_thread - 1) / units_per_thread);
+  return split;
+}
+
+}  // namespace optimized_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_CONV_THREADING_H_
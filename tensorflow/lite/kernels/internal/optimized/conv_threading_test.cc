@@ -0,0 +1,78 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/kernels/internal/optimized/conv_threading.h"
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/kernels/internal/types.h"
+
+namespace tflite {
+namespace optimized_ops {
+namespace {
+
+TEST(PlanConvThreadsTest, SingleThreadForSmallOutputs) {
+  const ConvThreadSplit split = PlanConvThreads(
+      RuntimeShape({1, 4, 4, 8}), /*muls_per_output=*/9,
+      /*min_muls_per_thread=*/1 << 13, /*max_threads=*/8);
+  EXPECT_EQ(split.thread_count, 1);
+  EXPECT_EQ(split.thread_dim, 1);
+  EXPECT_EQ(split.thread_dim_size, 4);
+}
+
+TEST(PlanConvThreadsTest, SplitsRowsOfSingleBatch) {
+  const ConvThreadSplit split = PlanConvThreads(
+      RuntimeShape({1, 64, 64, 32}), /*muls_per_output=*/9,
+      /*min_muls_per_thread=*/1 << 13, /*max_threads=*/8);
+  EXPECT_EQ(split.thread_count, 8);
+  EXPECT_EQ(split.thread_dim, 1);
+  EXPECT_EQ(split.thread_dim_size, 64);
+}
+
+TEST(PlanConvThreadsTest, PrefersBatchesOnTies) {
+  const ConvThreadSplit split = PlanConvThreads(
+      RuntimeShape({8, 8, 8, 32}), /*muls_per_output=*/9,
+      /*min_muls_per_thread=*/1, /*max_threads=*/4);
+  EXPECT_EQ(split.thread_count, 4);
+  EXPECT_EQ(split.thread_dim, 0);
+  EXPECT_EQ(split.thread_dim_size, 8);
+}
+
+TEST(PlanConvThreadsTest, SplitsAlongBetterBalancedDimension) {
+  // 3 batches leave 5 of 8 threads idle, 16 rows are split evenly.
+  ConvThreadSplit split = PlanConvThreads(
+      RuntimeShape({3, 16, 16, 32}), /*muls_per_output=*/9,
+      /*min_muls_per_thread=*/1, /*max_threads=*/8);
+  EXPECT_EQ(split.thread_count, 8);
+  EXPECT_EQ(split.thread_dim, 1);
+
+  // 8 batches split evenly, 7 rows don't.
+  split = PlanConvThreads(RuntimeShape({8, 7, 7, 32}), /*muls_per_output=*/9,
+                          /*min_muls_per_thread=*/1, /*max_threads=*/8);
+  EXPECT_EQ(split.thread_count, 8);
+  EXPECT_EQ(split.thread_dim, 0);
+}
+
+TEST(PlanConvThreadsTest, SkipsThreadsThatDontShortenTheRun) {
+  // With 8 threads, one thread would get 2 of the 9 rows anyway.
+  const ConvThreadSplit split = PlanConvThreads(
+      RuntimeShape({1, 9, 9, 32}), /*muls_per_output=*/9,
+      /*min_muls_per_thread=*/1, /*max_threads=*/8);
+  EXPECT_EQ(split.thread_count, 5);
+  EXPECT_EQ(split.thread_dim, 1);
+  EXPECT_EQ(split.thread_dim_size, 9);
+}
+
+}  // namespace
+}  // namespace optimized_ops
+}  // namespace tflite
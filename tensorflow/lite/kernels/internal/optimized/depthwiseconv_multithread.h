@@ -19,6 +19,7 @@ limitations under the License.
 
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
+#include "tensorflow/lite/kernels/internal/optimized/conv_threading.h"
 #include "tensorflow/lite/kernels/internal/optimized/cpu_check.h"
 #include "tensorflow/lite/kernels/internal/optimized/depthwiseconv_float.h"
 #include "tensorflow/lite/kernels/internal/optimized/depthwiseconv_uint8.h"
@@ -78,45 +79,6 @@ struct DepthwiseConvWorkerTask : cpu_backend_threadpool::Task {
   int thread_dim_;
 };
 
-inline int HowManyConvThreads(const RuntimeShape& output_shape,
-                              const RuntimeShape& filter_shape) {
-  // How many scalar multiplications are needed to make it worth using one
-  // more thread
-  static constexpr int kMinMulPerThread = 1 << 13;  // 8k
-  const int filter_height = filter_shape.Dims(1);
-  const int filter_width = filter_shape.Dims(2);
-  const int num_muls = output_shape.FlatSize() * filter_height * filter_width;
-  // Try to avoid real runtime divisions if possible by dividing by a
-  // compile-time constant.
-  int thread_count = std::max(1, num_muls / kMinMulPerThread);
-  return thread_count;
-}
-
-inline bool MultithreadAlongBatches(int thread_count, int batches) {
-  TFLITE_DCHECK_GE(thread_count, 2);
-  // If there are fewer batch entries than the number of threads we want to use,
-  // then better do intra-batch-entry multithreading.
-  if (batches < thread_count) {
-    return false;
-  }
-  // If there are at least 2 batch entries to be handed to each thread, then
-  // it's safe to proceed with batch-wise multithreading: each thread will have
-  // approximately equal number of batch entries to handle, so the load
-  // balancing will be reasonable, and the amount to which the load is not
-  // perfectly balanced will be offset by the inherent advantages of
-  // batch-wise multithreading (each thread is more efficient thanks to working
-  // on larger buffers with less boundary-handling overhead).
-  if (batches >= 2 * thread_count) {
-    return true;
-  }
-  // In the limit case were there are at least 1 but not much more than 1
-  // batch entries per thread, it may be a good idea to do per-batch
-  // multithreading if the number of batch entries is a multiple of the number
-  // of threads, so that each thread will have the same number of batch entries
-  // to process.
-  return ((batches % thread_count) == 0);
-}
-
 template <typename T, typename TS>
 inline void DepthwiseConv(const DepthwiseParams& params,
                           const RuntimeShape& input_shape, const T* input_data,
@@ -131,24 +93,27 @@ inline void DepthwiseConv(const DepthwiseParams& params,
   TFLITE_DCHECK_EQ(filter_shape.DimensionsCount(), 4);
   TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
 
-  int thread_count = HowManyConvThreads(output_shape, filter_shape);
-  const int max_threads = cpu_backend_context->max_num_threads();
-  thread_count = std::max(1, std::min(thread_count, max_threads));
+  // How many scalar multiplications are needed to make it worth using one
+  // more thread.
+  static constexpr int kMinMulPerThread = 1 << 13;  // 8k
+  int max_threads = cpu_backend_context->max_num_threads();
 #ifndef TFLITE_WITH_RUY
   // Cap the number of threads to 2 for float path to avoid regression in
   // performance (b/132294857).
   if (std::is_floating_point<T>::value) {
-    thread_count = std::min(thread_count, 2);
+    max_threads = std::min(max_threads, 2);
   }
 #endif
+  const int muls_per_output = filter_shape.Dims(1) * filter_shape.Dims(2);
+  const ConvThreadSplit split = PlanConvThreads(
+      output_shape, muls_per_output, kMinMulPerThread, max_threads);
 
-  const int output_batches = output_shape.Dims(0);
   const int output_height = output_shape.Dims(1);
 
   CpuFlags cpu_flags;
   GetCpuFlags(&cpu_flags);
 
-  if (thread_count == 1) {
+  if (split.thread_count == 1) {
     DepthwiseConvImpl(params, input_shape, input_data, filter_shape,
                       filter_data, bias_shape, bias_data, output_shape,
                       output_data, cpu_flags, /*thread_start=*/0,
@@ -156,27 +121,23 @@ inline void DepthwiseConv(const DepthwiseParams& params,
     return;
   }
 
-  int thread_dim, thread_dim_size;
-  if (MultithreadAlongBatches(thread_count, output_batches)) {
-    thread_dim = 0;
-    thread_dim_size = output_batches;
-  } else {
-    thread_dim = 1;
-    thread_dim_size = output_height;
-  }
+  // Records the split in profiles, e.g. of the benchmark tool.
+  ruy::profiler::ScopeLabel split_label(
+      "DepthwiseConv split (thread_dim=%d, thread_count=%d)", split.thread_dim,
+      split.thread_count);
 
   std::vector<DepthwiseConvWorkerTask<T, TS>> tasks;
   // TODO(b/131746020) don't create new heap allocations every time.
   // At least we make it a single heap allocation by using reserve().
-  tasks.reserve(thread_count);
+  tasks.reserve(split.thread_count);
   int thread_start = 0;
-  for (int i = 0; i < thread_count; ++i) {
-    int thread_end =
-        thread_start + (thread_dim_size - thread_start) / (thread_count - i);
+  for (int i = 0; i < split.thread_count; ++i) {
+    int thread_end = thread_start + (split.thread_dim_size - thread_start) /
+                                        (split.thread_count - i);
     tasks.emplace_back(params, input_shape, input_data, filter_shape,
                        filter_data, bias_shape, bias_data, output_shape,
                        output_data, cpu_flags, thread_start, thread_end,
-                       thread_dim);
+                       split.thread_dim);
     thread_start = thread_end;
   }
   cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
+#include "tensorflow/lite/kernels/internal/optimized/conv_threading.h"
 #include "tensorflow/lite/kernels/internal/optimized/cpu_check.h"
 #include "tensorflow/lite/kernels/internal/optimized/depthwiseconv_3x3_filter_common.h"
 #include "tensorflow/lite/kernels/internal/optimized/depthwiseconv_uint8_3x3_filter.h"
@@ -1952,20 +1953,6 @@ struct DepthwiseConvWorkerTask : cpu_backend_threadpool::Task {
   const CpuBackendContext& cpu_backend_context;
 };
 
-inline int HowManyConvThreads(const RuntimeShape& output_shape,
-                              const RuntimeShape& filter_shape,
-                              int thread_dim) {
-  constexpr int kMinMulPerThread = 8;
-  const int output_units = output_shape.Dims(thread_dim);
-  const int filter_height = filter_shape.Dims(1);
-  const int filter_width = filter_shape.Dims(2);
-  const int num_mul_per_unit =
-      FlatSizeSkipDim(output_shape, thread_dim) * filter_height * filter_width;
-  const int min_units_per_thread = kMinMulPerThread / num_mul_per_unit + 1;
-  int thread_count = output_units / min_units_per_thread;
-  return thread_count;
-}
-
 inline void DepthwiseConvPerChannel(
     const DepthwiseParams& params, const int32* output_multiplier,
     const int32* output_shift, const RuntimeShape& input_shape,
@@ -1978,43 +1965,37 @@ inline void DepthwiseConvPerChannel(
   TFLITE_DCHECK_EQ(filter_shape.DimensionsCount(), 4);
   TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
 
-  const int output_batches = output_shape.Dims(0);
+  // The multiplications of a single output element are worth a thread.
+  constexpr int kMinMulPerThread = 8;
   const int output_rows = output_shape.Dims(1);
-  int thread_count_batch = HowManyConvThreads(output_shape, filter_shape, 0);
-  int thread_count_row = HowManyConvThreads(output_shape, filter_shape, 1);
-  int thread_dim, thread_count, thread_dim_size;
-  if (thread_count_batch > thread_count_row) {
-    thread_dim = 0;
-    thread_dim_size = output_batches;
-    thread_count = thread_count_batch;
-  } else {
-    thread_dim = 1;
-    thread_dim_size = output_rows;
-    thread_count = thread_count_row;
-  }
-
-  const int max_threads = cpu_backend_context->max_num_threads();
-  thread_count = std::max(1, std::min(thread_count, max_threads));
+  const int muls_per_output = filter_shape.Dims(1) * filter_shape.Dims(2);
+  const optimized_ops::ConvThreadSplit split = optimized_ops::PlanConvThreads(
+      output_shape, muls_per_output, kMinMulPerThread,
+      cpu_backend_context->max_num_threads());
 
-  if (thread_count == 1) {
+  if (split.thread_count == 1) {
     DepthwiseConvImpl(params, output_multiplier, output_shift, input_shape,
                       input_data, filter_shape, filter_data, bias_shape,
                       bias_data, output_shape, output_data, /*thread_start=*/0,
                       /*thread_end=*/output_rows, /*thread_dim=*/1,
                       *cpu_backend_context);
   } else {
+    // Records the split in profiles, e.g. of the benchmark tool.
+    ruy::profiler::ScopeLabel split_label(
+        "DepthwiseConvInt8 split (thread_dim=%d, thread_count=%d)",
+        split.thread_dim, split.thread_count);
     std::vector<DepthwiseConvWorkerTask<int8, int32>> tasks;
     // TODO(b/131746020) don't create new heap allocations every time.
     // At least we make it a single heap allocation by using reserve().
-    tasks.reserve(thread_count);
+    tasks.reserve(split.thread_count);
     int thread_start = 0;
-    for (int i = 0; i < thread_count; ++i) {
-      int thread_end =
-          thread_start + (thread_dim_size - thread_start) / (thread_count - i);
+    for (int i = 0; i < split.thread_count; ++i) {
+      int thread_end = thread_start + (split.thread_dim_size - thread_start) /
+                                          (split.thread_count - i);
       tasks.emplace_back(params, output_multiplier, output_shift, input_shape,
                          input_data, filter_shape, filter_data, bias_shape,
                          bias_data, output_shape, output_data, thread_start,
-                         thread_end, thread_dim, *cpu_backend_context);
+                         thread_end, split.thread_dim, *cpu_backend_context);
       thread_start = thread_end;
     }
     cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
@@ -227,7 +227,12 @@ void PortableSparseMatrixBatchVectorMultiplyAccumulate1x4(
   }
 }
 
-void PortableSparseMatrixBatchVectorMultiplyAccumulate1x16(
+namespace {
+
+// Computes the quantized product of an int8 matrix that is sparse with block
+// pattern 1 x kBlockSize and a batch of int8 vectors.
+template <int kBlockSize>
+void SparseMatrixBatchVectorMultiplyAccumulate1xN(
     const int8_t* __restrict__ matrix, const int32_t* __restrict__ segments,
     const int32_t* __restrict__ indices, int m_rows, int m_cols,
     const int8_t* __restrict__ vector, const int32_t* __restrict__ bias_vector,
@@ -236,7 +241,6 @@ void PortableSparseMatrixBatchVectorMultiplyAccumulate1x16(
     const int32_t* per_channel_shift, const int32_t output_offset,
     const int32_t output_activation_min, const int32_t output_activation_max,
     int8_t* __restrict__ result) {
-  const int kBlockSize = 16;
   TFLITE_DCHECK_EQ(m_cols % kBlockSize, 0);
   for (int batch = 0; batch < n_batch; ++batch) {
     const int8_t* matrix_ptr = matrix;
@@ -265,6 +269,40 @@ void PortableSparseMatrixBatchVectorMultiplyAccumulate1x16(
   }
 }
 
+}  // namespace
+
+void PortableSparseMatrixBatchVectorMultiplyAccumulate1x16(
+    const int8_t* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const int8_t* __restrict__ vector, const int32_t* __restrict__ bias_vector,
+    int n_batch, const int32_t input_offset, const int32_t output_multiplier,
+    const int32_t output_shift, const int32_t* per_channel_scale,
+    const int32_t* per_channel_shift, const int32_t output_offset,
+    const int32_t output_activation_min, const int32_t output_activation_max,
+    int8_t* __restrict__ result) {
+  SparseMatrixBatchVectorMultiplyAccumulate1xN<16>(
+      matrix, segments, indices, m_rows, m_cols, vector, bias_vector, n_batch,
+      input_offset, output_multiplier, output_shift, per_channel_scale,
+      per_channel_shift, output_offset, output_activation_min,
+      output_activation_max, result);
+}
+
+void PortableSparseMatrixBatchVectorMultiplyAccumulate1x4(
+    const int8_t* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const int8_t* __restrict__ vector, const int32_t* __restrict__ bias_vector,
+    int n_batch, const int32_t input_offset, const int32_t output_multiplier,
+    const int32_t output_shift, const int32_t* per_channel_scale,
+    const int32_t* per_channel_shift, const int32_t output_offset,
+    const int32_t output_activation_min, const int32_t output_activation_max,
+    int8_t* __restrict__ result) {
+  SparseMatrixBatchVectorMultiplyAccumulate1xN<4>(
+      matrix, segments, indices, m_rows, m_cols, vector, bias_vector, n_batch,
+      input_offset, output_multiplier, output_shift, per_channel_scale,
+      per_channel_shift, output_offset, output_activation_min,
+      output_activation_max, result);
+}
+
 void PortableSparseMatrixBatchVectorMultiplyAccumulate(
     const float* __restrict__ matrix, const uint8_t* __restrict__ ledger,
     int m_rows, int m_cols, const float* __restrict__ vector, int n_batch,
@@ -189,6 +189,8 @@ inline float GetTensorScale(const TfLiteTensor* tensor) {
 //   activation                                 - activation to use.
 //   is_input_all_zeros, is_aux_input_all_zeros - if input vectors are all zero.
 //   use_layer_norm                             - if doing layer norm LSTM.
+//   input_projection                           - optional, the input
+//                                                contributions computed ahead.
 inline void CalculateLstmGateFloat(
     const float* input, const float* input_to_gate_weights,
     const float* aux_input, const float* aux_input_to_gate_weights,
@@ -199,33 +201,40 @@ inline void CalculateLstmGateFloat(
     const int n_output, const int n_cell,
     const TfLiteFusedActivation activation, float* gate,
     const bool is_input_all_zeros, const bool is_aux_input_all_zeros,
-    float* output, bool recurrent_is_diag, CpuBackendContext* context) {
+    float* output, bool recurrent_is_diag, CpuBackendContext* context,
+    const float* input_projection = nullptr) {
   const bool use_peephole = (cell_to_gate_weights != nullptr);
   const bool use_layer_norm = (layer_norm_coefficients != nullptr);
 
-  // Initialize scratch buffers with bias for regular lstm or initialize with
-  // zero for layer norm lstm.
-  if (use_layer_norm) {
-    std::fill_n(gate, n_cell * n_batch, 0.0f);
-  } else {
-    tensor_utils::VectorBatchVectorAssign(gate_bias, n_cell, n_batch, gate);
-  }
-  // For each batch and cell: compute input_weight * input.
-  // Skip if input is all zeros.
   float* accumulation_buffer = gate;
-  if (!is_input_all_zeros) {
-    MatrixBatchVectorMultiplyAccumulate(input_to_gate_weights, input,
-                                        accumulation_buffer, output, n_cell,
-                                        n_input, n_batch, context);
-    std::swap(accumulation_buffer, output);
-  }
-  // For each batch and cell: compute aux_input_weight * aux_input.
-  // Skip if auxiliary input is not available or all zeros.
-  if (!is_aux_input_all_zeros) {
-    MatrixBatchVectorMultiplyAccumulate(aux_input_to_gate_weights, aux_input,
-                                        accumulation_buffer, output, n_cell,
-                                        n_aux_input, n_batch, context);
-    std::swap(accumulation_buffer, output);
+  if (input_projection != nullptr) {
+    // The input contributions, and the bias for regular lstm, were computed
+    // for several steps at once.
+    std::copy_n(input_projection, n_cell * n_batch, gate);
+  } else {
+    // Initialize scratch buffers with bias for regular lstm or initialize
+    // with zero for layer norm lstm.
+    if (use_layer_norm) {
+      std::fill_n(gate, n_cell * n_batch, 0.0f);
+    } else {
+      tensor_utils::VectorBatchVectorAssign(gate_bias, n_cell, n_batch, gate);
+    }
+    // For each batch and cell: compute input_weight * input.
+    // Skip if input is all zeros.
+    if (!is_input_all_zeros) {
+      MatrixBatchVectorMultiplyAccumulate(input_to_gate_weights, input,
+                                          accumulation_buffer, output, n_cell,
+                                          n_input, n_batch, context);
+      std::swap(accumulation_buffer, output);
+    }
+    // For each batch and cell: compute aux_input_weight * aux_input.
+    // Skip if auxiliary input is not available or all zeros.
+    if (!is_aux_input_all_zeros) {
+      MatrixBatchVectorMultiplyAccumulate(aux_input_to_gate_weights, aux_input,
+                                          accumulation_buffer, output, n_cell,
+                                          n_aux_input, n_batch, context);
+      std::swap(accumulation_buffer, output);
+    }
   }
   // For each batch and cell: compute recurrent_weight * output_state.
   if (recurrent_is_diag) {
@@ -255,6 +264,44 @@ inline void CalculateLstmGateFloat(
                                         gate);
 }
 
+// Computes the input contributions to the gates of `n_rows` input vectors,
+// e.g. of several steps of a sequence, with one matrix multiplication per gate
+// instead of one per step:
+//   projection = W_input * input (+ bias, unless layer norm)
+// The projection of gate g (input, forget, cell and output) for row r is at
+// projection + g * gate_stride + r * n_cell. The input gate is skipped for
+// CIFG.
+void CalculateLstmInputProjectionsFloat(
+    const float* input, const float* input_to_input_weights,
+    const float* input_to_forget_weights, const float* input_to_cell_weights,
+    const float* input_to_output_weights, const float* input_gate_bias,
+    const float* forget_gate_bias, const float* cell_gate_bias,
+    const float* output_gate_bias, bool use_layer_norm, int n_rows,
+    int n_input, int n_cell, int gate_stride, float* projection,
+    CpuBackendContext* context) {
+  ruy::profiler::ScopeLabel label("CalculateLstmInputProjectionsFloat");
+  tflite::FullyConnectedParams params;
+  params.float_activation_min = std::numeric_limits<float>::lowest();
+  params.float_activation_max = std::numeric_limits<float>::max();
+  params.lhs_cacheable = true;
+  params.rhs_cacheable = false;
+  const tflite::RuntimeShape weight_shape({n_cell, n_input});
+  const tflite::RuntimeShape input_shape({n_rows, n_input});
+  const tflite::RuntimeShape bias_shape({n_cell});
+  const tflite::RuntimeShape output_shape({n_rows, n_cell});
+  const float* weights[] = {input_to_input_weights, input_to_forget_weights,
+                            input_to_cell_weights, input_to_output_weights};
+  const float* biases[] = {input_gate_bias, forget_gate_bias, cell_gate_bias,
+                           output_gate_bias};
+  for (int gate = 0; gate < 4; ++gate) {
+    if (weights[gate] == nullptr) continue;
+    tflite::optimized_ops::FullyConnected(
+        params, input_shape, input, weight_shape, weights[gate], bias_shape,
+        use_layer_norm ? nullptr : biases[gate], output_shape,
+        projection + gate * gate_stride, context);
+  }
+}
+
 // Updates the LSTM cell state, used by both float and hybrid LSTM versions.
 //
 // Implements the following formula:
@@ -875,6 +922,10 @@ void CalculateLstmOutputInteger8x8_8(
 // for bidirectional LSTMs with merge_outputs. In this case, the batched
 // operations cannot be used since they assume that the batched outputs are
 // contiguous, and we manually loop over the batched outputs.
+//
+// If input_projection_ptr is not null, it holds the input contributions to the
+// gates of this step, as computed by CalculateLstmInputProjectionsFloat, with
+// the gates input_projection_gate_stride apart, and input_ptr is not read.
 // LINT.IfChange
 inline void LstmStepFloat(
     const float* input_ptr, const float* input_to_input_weights_ptr,
@@ -905,7 +956,8 @@ inline void LstmStepFloat(
     float* scratch1, float* scratch2, float* scratch3, float* scratch4,
     float* output_ptr, bool recurrent_to_input_is_diag,
     bool recurrent_to_forget_is_diag, bool recurrent_to_cell_is_diag,
-    bool recurrent_to_output_is_diag, CpuBackendContext* context) {
+    bool recurrent_to_output_is_diag, const float* input_projection_ptr,
+    int input_projection_gate_stride, CpuBackendContext* context) {
   ruy::profiler::ScopeLabel label("LstmStepFloat");
   // Since we have already checked that weights are all there or none, we can
   // check the existence of only one to the get the condition.
@@ -918,12 +970,19 @@ inline void LstmStepFloat(
   float* output_gate_scratch = scratch3;
   float* accumulation_scratch_buffer = scratch4;
 
-  // Check if inputs are all zeros so we can skip some computations.
+  // Check if inputs are all zeros so we can skip some computations. This is
+  // not needed when the input contributions were computed ahead.
   const bool is_input_all_zeros =
+      input_projection_ptr == nullptr &&
       tensor_utils::IsZeroVector(input_ptr, n_batch * n_input);
   const bool is_aux_input_all_zeros =
       (aux_input_ptr == nullptr ||
        tensor_utils::IsZeroVector(aux_input_ptr, n_batch * n_aux_input));
+  const auto gate_projection = [&](int gate) -> const float* {
+    return input_projection_ptr == nullptr
+               ? nullptr
+               : input_projection_ptr + gate * input_projection_gate_stride;
+  };
 
   if (!use_cifg) {
     // Calculate the input gate. (If not CIFG.)
@@ -937,7 +996,7 @@ inline void LstmStepFloat(
         n_input, n_aux_input, n_output, n_cell,
         /*activation=*/kTfLiteActSigmoid, input_gate_scratch,
         is_input_all_zeros, is_aux_input_all_zeros, accumulation_scratch_buffer,
-        recurrent_to_input_is_diag, context);
+        recurrent_to_input_is_diag, contex gate_projection(0));
   }
   // Calculate the forget gate.
   CalculateLstmGateFloat(
@@ -950,7 +1009,7 @@ inline void LstmStepFloat(
       n_input, n_aux_input, n_output, n_cell,
       /*activation=*/kTfLiteActSigmoid, forget_gate_scratch, is_input_all_zeros,
       is_aux_input_all_zeros, accumulation_scratch_buffer,
-      recurrent_to_forget_is_diag, context);
+      recurrent_to_forget_is_diag, contex gate_projection(1));
   // Calculate the cell update gate.
   CalculateLstmGateFloat(
       input_ptr, input_to_cell_weights_ptr, aux_input_ptr,
@@ -962,7 +1021,7 @@ inline void LstmStepFloat(
       cell_gate_bias_ptr, n_batch, n_input, n_aux_input, n_output, n_cell,
       params->activation, cell_gate_scratch, is_input_all_zeros,
       is_aux_input_all_zeros, accumulation_scratch_buffer,
-      recurrent_to_cell_is_diag, context);
+      recurrent_to_cell_is_diag, contex gate_projection(2));
   // Update the cell state.
   UpdateLstmCellFloat(n_batch, n_cell, cell_state_ptr, input_gate_scratch,
                       forget_gate_scratch, cell_gate_scratch, use_cifg,
@@ -978,7 +1037,7 @@ inline void LstmStepFloat(
       n_input, n_aux_input, n_output, n_cell,
       /*activation=*/kTfLiteActSigmoid, output_gate_scratch, is_input_all_zeros,
       is_aux_input_all_zeros, accumulation_scratch_buffer,
-      recurrent_to_output_is_diag, context);
+      recurrent_to_output_is_diag, contex gate_projection(3));
   // Update the output state.
   CalculateLstmOutputFloat(n_batch, n_cell, n_output, cell_state_ptr,
                            output_gate_scratch, params->activation,
@@ -1789,6 +1848,11 @@ inline void LstmStepInteger8x8_8(
 
 }  // namespace
 
+int GetInputProjectionScratchSize(int n_cell, int max_time) {
+  if (max_time <= 1) return 0;
+  return std::min(max_time, kMaxInputProjectionSteps) * 4 * n_cell;
+}
+
 // LINT.IfChange
 TfLiteStatus EvalFloat(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
@@ -1819,7 +1883,7 @@ TfLiteStatus EvalFloat(
     TfLiteTensor* cell_state, TfLiteTensor* output,
     bool recurrent_to_input_is_diag, bool recurrent_to_forget_is_diag,
     bool recurrent_to_cell_is_diag, bool recurrent_to_output_is_diag,
-    CpuBackendContext* context) {
+    CpuBackendContext* context, float* input_projection_scratch) {
   TF_LITE_ASSERT(input->dims->size >= 2 && input->dims->size <= 3);
 
   int max_time, n_batch;
@@ -1864,17 +1928,57 @@ TfLiteStatus EvalFloat(
     accumulation_scratch_buffer = scratch_buffer_ptr + 4 * n_cell * n_batch;
   }
 
+  // The input contributions to the gates of the next `projection_steps` steps
+  // are computed at once, with the gates `projection_gate_stride` apart.
+  const int projection_steps =
+      (input_projection_scratch != nullptr && aux_input == nullptr)
+          ? std::min(max_time, kMaxInputProjectionSteps)
+          : 0;
+  const int projection_gate_stride = projection_steps * n_batch * n_cell;
+  const bool use_layer_norm = (forget_layer_norm_coefficients != nullptr);
+  // Computes the projections of the `n_rows` contiguous inputs at
+  // `input_ptr`.
+  const auto calculate_input_projections = [&](const float* input_ptr,
+                                               int n_rows) {
+    CalculateLstmInputProjectionsFloat(
+        input_ptr, GetTensorData<float>(input_to_input_weights),
+        GetTensorData<float>(input_to_forget_weights),
+        GetTensorData<float>(input_to_cell_weights),
+        GetTensorData<float>(input_to_output_weights),
+        GetTensorData<float>(input_gate_bias),
+        GetTensorData<float>(forget_gate_bias),
+        GetTensorData<float>(cell_gate_bias),
+        GetTensorData<float>(output_gate_bias), use_layer_norm, n_rows,
+        n_input, n_cell, projection_gate_stride, input_projection_scratch,
+        context);
+  };
+
   const int output_batch_leading_dim =
       output->dims->data[output->dims->size - 1];
   if (time_major) {
     // Loop through the sequence.
     const int input_step = n_batch * n_input;
     const int output_step = n_batch * output_batch_leading_dim;
+    int projection_first_step = 0;
     for (int t = 0; t < max_time; t++) {
       // If this is the forward_sequence, step forward, otherwise step
       // backwards.
       const int t_rel = forward_sequence ? t : max_time - t - 1;
       const float* input_ptr = GetTensorData<float>(input) + t_rel * input_step;
+      const float* input_projection_ptr = nullptr;
+      if (projection_steps > 1) {
+        if (t % projection_steps == 0) {
+          const int num_steps = std::min(projection_steps, max_time - t);
+          projection_first_step =
+              forward_sequence ? t : max_time - t - num_steps;
+          calculate_input_projections(
+              GetTensorData<float>(input) + projection_first_step * input_step,
+              num_steps * n_batch);
+        }
+        input_projection_ptr =
+            input_projection_scratch +
+            (t_rel - projection_first_step) * n_batch * n_cell;
+      }
       const float* aux_input_ptr = nullptr;
       if (aux_input) {
         aux_input_ptr = GetTensorData<float>(aux_input) + t_rel * input_step;
@@ -1913,12 +2017,14 @@ TfLiteStatus EvalFloat(
           input_gate_scratch, forget_gate_scratch, cell_gate_scratch,
           output_gate_scratch, accumulation_scratch_buffer, output_ptr,
           recurrent_to_input_is_diag, recurrent_to_forget_is_diag,
-          recurrent_to_cell_is_diag, recurrent_to_output_is_diag, context);
+          recurrent_to_cell_is_diag, recurrent_to_output_is_diag,
+          input_projection_ptr, projection_gate_stride, context);
     }
   } else {
     for (int b = 0; b < n_batch; b++) {
       const int input_step = n_input;
       const int output_step = output_batch_leading_dim;
+      int projection_first_step = 0;
       for (int t = 0; t < max_time; t++) {
         // If this is the forward_sequence, step forward, otherwise step
         // backwards.
@@ -1926,6 +2032,22 @@ TfLiteStatus EvalFloat(
         const int time_offset = b * max_time + t_rel;
         const float* input_ptr =
             GetTensorData<float>(input) + time_offset * input_step;
+        // The steps of a batch are contiguous, so their projections are
+        // computed together.
+        const float* input_projection_ptr = nullptr;
+        if (projection_steps > 1) {
+          if (t % projection_steps == 0) {
+            const int num_steps = std::min(projection_steps, max_time - t);
+            projection_first_step =
+                forward_sequence ? t : max_time - t - num_steps;
+            calculate_input_projections(
+                GetTensorData<float>(input) +
+                    (b * max_time + projection_first_step) * input_step,
+                num_steps);
+          }
+          input_projection_ptr = input_projection_scratch +
+                                 (t_rel - projection_first_step) * n_cell;
+        }
         const float* aux_input_ptr = nullptr;
         if (aux_input) {
           aux_input_ptr =
@@ -1976,7 +2098,8 @@ TfLiteStatus EvalFloat(
             forget_gate_scratch_ptr, cell_gate_scratch_ptr,
             output_gate_scratch_ptr, accumulation_scratch_buffer, output_ptr,
             recurrent_to_input_is_diag, recurrent_to_forget_is_diag,
-            recurrent_to_cell_is_diag, recurrent_to_output_is_diag, context);
+            recurrent_to_cell_is_diag, recurrent_to_output_is_diag,
+            input_projection_ptr, projection_gate_stride, context);
       }
     }
   }
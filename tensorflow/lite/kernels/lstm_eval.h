@@ -95,6 +95,20 @@ struct IntegerLstmParameter {
   int32_t intermediate_zp[12];
 };
 
+// The float LSTM can compute the input contributions to the gates of up to
+// this many steps of a sequence with one matrix multiplication per gate,
+// instead of one per step.
+constexpr int kMaxInputProjectionSteps = 8;
+
+// Returns the number of floats per batch EvalFloat needs in
+// `input_projection_scratch` for a sequence of `max_time` steps, or 0 for a
+// single step.
+int GetInputProjectionScratchSize(int n_cell, int max_time);
+
+// If `input_projection_scratch` is not null, it has room for n_batch times
+// GetInputProjectionScratchSize() floats and the input contributions to the
+// gates are computed for several steps at once. It is not used with an
+// auxiliary input.
 TfLiteStatus EvalFloat(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
     const TfLiteTensor* input_to_forget_weights,
@@ -124,7 +138,7 @@ TfLiteStatus EvalFloat(
     TfLiteTensor* cell_state, TfLiteTensor* output,
     bool recurrent_to_input_is_diag, bool recurrent_to_forget_is_diag,
     bool recurrent_to_cell_is_diag, bool recurrent_to_output_is_diag,
-    CpuBackendContext* context);
+    CpuBackendContext* context, float* input_projection_scratch = nullptr);
 
 TfLiteStatus EvalHybrid(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
@@ -177,6 +177,25 @@ TfLiteStatus EvalWithTypes(TfLiteContext* context, TfLiteNode* node) {
 
   Index<IndexType> batch_index(num_batch_dims);
   Index<IndexType> offset_index(data->num_offset_dims);
+
+  // When the innermost dimension of the result is an offset dimension that
+  // maps to the innermost dimension of the operand, each row of the result is
+  // copied at once from a contiguous row of the operand, and only the other
+  // dimensions of the result are iterated over.
+  const bool contiguous_rows =
+      result_rank > 0 && data->num_offset_dims > 0 &&
+      data->offset_dims[data->num_offset_dims - 1] == result_rank - 1 &&
+      !ArrayContains(data->collapsed_slice_dims,
+                     data->num_collapsed_slice_dims, operand_rank - 1);
+  const int64_t row_size =
+      contiguous_rows ? result_runtime_shape.Dims(result_rank - 1) : 1;
+  std::vector<int> iteration_dims(
+      result_runtime_shape.DimsData(),
+      result_runtime_shape.DimsData() + result_rank);
+  if (contiguous_rows) {
+    iteration_dims.back() = 1;
+  }
+
   do {
     TF_LITE_ENSURE_OK(
         context, SetBatchAndOffsetIndices(result_index, data->offset_dims,
@@ -208,14 +227,14 @@ TfLiteStatus EvalWithTypes(TfLiteContext* context, TfLiteNode* node) {
     IndexType flat_operand_index =
         TensorIndexToFlat(operand_lookup_index.data(),
                           operand_lookup_index.size(), GetTensorShape(operand));
-    DataType looked_up_value = operand_data[flat_operand_index];
-
     DataType* result_data = GetTensorData<DataType>(output);
     IndexType flat_result_index = TensorIndexToFlat(
         result_index.data(), result_index.size(), GetTensorShape(output));
-    result_data[flat_result_index] = looked_up_value;
-  } while (NextIndex(result_rank, result_runtime_shape.DimsData(),
-                     result_index.data()));
+    // The starting index is clipped, so the whole row is within the operand.
+    std::copy(operand_data + flat_operand_index,
+              operand_data + flat_operand_index + row_size,
+              result_data + flat_result_index);
+  } while (NextIndex(result_rank, iteration_dims.data(), result_index.data()));
 
   return TfLiteStatus::kTfLiteOk;
 }
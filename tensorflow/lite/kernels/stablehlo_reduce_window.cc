@@ -309,11 +309,8 @@ void PadCrop(const PadCropData& ctx, const char* input, const char* init_value,
 namespace reduce_window {
 namespace {
 
-// Reduces the elements of a tensor viewed through a strided window.
-//
-// This applies a reduction to a tensor by skipping over elements that are not
-// in the window defined by the given shape and strides. The window is reduced
-// to one element.
+// Reduces the elements of a tensor viewed through strided windows into a row
+// of `size` outputs, whose windows start `input_stride` elements apart.
 //
 // The shape is the shape of the window. The strides are based on the actual
 // tensor and the distance between window elements, counted in elements.
@@ -330,22 +327,34 @@ namespace {
 // └──┘     └──┘
 //  13 14 15 16
 //
-// This is a recursive implementation of the strided reduction.
+// Visiting the window elements in the outer loops and the output row in the
+// inner loop keeps the order in which the elements of each window are reduced,
+// while the inner loop runs over contiguous memory for unit strides, which the
+// compiler vectorizes.
 template <class Op, class Type>
-void StridedReduce(const Type* input, const int64_t* const shape,
-                   const int64_t* const strides, Type& accu, const int rank,
-                   const int depth) {
+void RowReduce(const Type* input, Type* output, const int64_t size,
+               const int64_t input_stride, const int64_t* const shape,
+               const int64_t* const strides, const int rank, const int depth) {
   const int64_t stride = strides[depth];
-  const int64_t size = shape[depth];
+  const int64_t window_size = shape[depth];
   if (depth + 1 == rank) {
     const Op op;
-    for (int64_t i = 0; i < size; ++i) {
-      accu = op(accu, *input);
+    for (int64_t w = 0; w < window_size; ++w) {
+      if (input_stride == 1) {
+        for (int64_t i = 0; i < size; ++i) {
+          output[i] = op(output[i], input[i]);
+        }
+      } else {
+        for (int64_t i = 0; i < size; ++i) {
+          output[i] = op(output[i], input[i * input_stride]);
+        }
+      }
       input += stride;
     }
   } else {
-    for (int64_t i = 0; i < size; ++i) {
-      StridedReduce<Op, Type>(input, shape, strides, accu, rank, depth + 1);
+    for (int64_t w = 0; w < window_size; ++w) {
+      RowReduce<Op, Type>(input, output, size, input_stride, shape, strides,
+                          rank, depth + 1);
       input += stride;
     }
   }
@@ -378,13 +387,13 @@ void ReduceWindowImpl(const Type* input, Type* output,
                       const int64_t* const window_reduce_strides,
                       const Type init, const int rank, const int depth) {
   if (depth + 1 == rank) {
-    for (int32_t dim = 0; dim < output_shape[depth]; ++dim) {
-      *output = init;
-      StridedReduce<Op, Type>(input, window_shape, window_reduce_strides,
-                              *output, rank, /*depth=*/0);
-      input += window_offset_strides[depth];
-      output += output_strides[depth];
-    }
+    // The innermost output dimension is contiguous, so a whole output row is
+    // reduced at once rather than one window at a time.
+    const int64_t size = output_shape[depth];
+    std::fill(output, output + size, init);
+    RowReduce<Op, Type>(input, output, size, window_offset_strides[depth],
+                        window_shape, window_reduce_strides, rank,
+                        /*depth=*/0);
   } else {
     for (int32_t dim = 0; dim < output_shape[depth]; ++dim) {
       ReduceWindowImpl<Op, Type>(input, output, output_shape, output_strides,
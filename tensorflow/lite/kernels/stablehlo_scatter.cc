@@ -94,7 +94,8 @@ static Index<IndexType> GatherIndex(const Index<IndexType>& index,
 
 // Checks if the given index is within the bounds of the provided shape.
 template <typename IndexType>
-static bool IsInBounds(Index<IndexType> index, RuntimeShape shape) {
+static bool IsInBounds(const Index<IndexType>& index,
+                       const RuntimeShape& shape) {
   if (index.size() != shape.DimensionsCount()) {
     return false;
   }
@@ -192,6 +193,42 @@ static TfLiteStatus ApplyComputation(TfLiteTensor* tensor,
   return kTfLiteOk;
 }
 
+// Applies the provided computation to a contiguous row of `size` elements of
+// `output` and `updates`, and stores the results in `output`.
+template <typename DataType>
+static TfLiteStatus ApplyComputationToRow(DataType* output,
+                                          const DataType* updates,
+                                          int64_t size,
+                                          ComputationType computation_type,
+                                          TfLiteContext* context) {
+  switch (computation_type) {
+    case ComputationType::kUpdate:
+      std::copy(updates, updates + size, output);
+      return kTfLiteOk;
+    case ComputationType::kAdd:
+      for (int64_t i = 0; i < size; ++i) output[i] = output[i] + updates[i];
+      return kTfLiteOk;
+    case ComputationType::kMultiply:
+      for (int64_t i = 0; i < size; ++i) output[i] = output[i] * updates[i];
+      return kTfLiteOk;
+    case ComputationType::kMaximum:
+      for (int64_t i = 0; i < size; ++i) {
+        output[i] = std::max(output[i], updates[i]);
+      }
+      return kTfLiteOk;
+    case ComputationType::kMinimum:
+      for (int64_t i = 0; i < size; ++i) {
+        output[i] = std::min(output[i], updates[i]);
+      }
+      return kTfLiteOk;
+    default:
+      TF_LITE_KERNEL_LOG(context,
+                         "Provided kernel in the stablehlo scatter region is "
+                         "not yet supported.");
+      return kTfLiteError;
+  }
+}
+
 // Evaluates this node given the type of the elements in the scatter_indices
 // and the type of the elements in the input/updates tensors.
 template <typename IndexType, typename DataType>
@@ -236,6 +273,25 @@ TfLiteStatus EvalWithTypes(TfLiteContext* context, TfLiteNode* node) {
       data->update_window_dims,
       data->update_window_dims + data->num_update_window_dims);
 
+  // When the innermost dimension of the updates is a window dimension that
+  // maps to the innermost dimension of the input, each row of the updates is
+  // applied to a contiguous row of the output at once, and only the other
+  // dimensions of the updates are iterated over.
+  const bool contiguous_rows =
+      updates_rank > 0 && data->num_update_window_dims > 0 &&
+      data->update_window_dims[data->num_update_window_dims - 1] ==
+          updates_rank - 1 &&
+      !ArrayContains(data->inserted_window_dims,
+                     data->num_inserted_window_dims, input_rank - 1);
+  const int64_t row_size =
+      contiguous_rows ? updates_shape.Dims(updates_rank - 1) : 1;
+  std::vector<int> iteration_dims(updates_shape.DimsData(),
+                                  updates_shape.DimsData() + updates_rank);
+  if (contiguous_rows) {
+    iteration_dims.back() = 1;
+  }
+  DataType* mutable_output_data = GetTensorData<DataType>(output);
+
   do {
     Index<IndexType> update_scatter_index =
         GatherIndex(update_index, update_scatter_dims);
@@ -264,6 +320,39 @@ TfLiteStatus EvalWithTypes(TfLiteContext* context, TfLiteNode* node) {
     Index<IndexType> result_index =
         AddIndices(full_start_index, full_window_index);
 
+    if (contiguous_rows) {
+      const IndexType row_start = result_index.back();
+      if (IsInBounds(result_index, input_shape) &&
+          row_start + row_size <= input_shape.Dims(input_rank - 1)) {
+        TF_LITE_ENSURE_STATUS(ApplyComputationToRow(
+            mutable_output_data +
+                TensorIndexToFlat(result_index.data(), input_rank,
+                                  input_shape),
+            updates_data +
+                TensorIndexToFlat(update_index.data(), updates_rank,
+                                  updates_shape),
+            row_size, op_data->computation_type, context));
+        continue;
+      }
+      // Some updates of the row are out of bounds, and are ignored below.
+      for (int64_t i = 0; i < row_size; ++i) {
+        result_index.back() = row_start + i;
+        update_index.back() = i;
+        if (!IsInBounds(result_index, input_shape)) {
+          continue;
+        }
+        TF_LITE_ENSURE_STATUS(ApplyComputation(
+            output, result_index,
+            output_data[TensorIndexToFlat(result_index.data(), input_rank,
+                                          input_shape)],
+            updates_data[TensorIndexToFlat(update_index.data(), updates_rank,
+                                           updates_shape)],
+            op_data->computation_type, context));
+      }
+      update_index.back() = 0;
+      continue;
+    }
+
     // The spec says, this behaviour is implementation-dependent. We follow the
     // reference interpreter where it ignores the updates that target out of
     // bounds result indices.
@@ -281,7 +370,7 @@ TfLiteStatus EvalWithTypes(TfLiteContext* context, TfLiteNode* node) {
                                            update_value,
                                            op_data->computation_type, context));
   } while (
-      NextIndex(updates_rank, updates_shape.DimsData(), update_index.data()));
+      NextIndex(updates_rank, iteration_dims.data(), update_index.data()));
 
   return TfLiteStatus::kTfLiteOk;
 }
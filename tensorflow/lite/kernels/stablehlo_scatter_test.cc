@@ -271,5 +271,35 @@ TEST(StablehloScatterOpTest, PerformsUpdate) {
   EXPECT_THAT(model.GetOutput<float>(), ElementsAreArray(expected_values));
 }
 
+
+TEST(StablehloScatterOpTest, SkipsOutOfBoundsUpdatesOfRows) {
+  StablehloScatterOpType op_type = StablehloScatterOpType::kAdd;
+
+  TfLiteStablehloScatterParams params = {
+      false,   // indices_are_sorted
+      {1},     // std::vector<update_window_dims>
+      1,       // num_update_window_dims
+      {0},     // std::vector<inserted_window_dims>
+      1,       // num_inserted_window_dims
+      {0, 1},  // std::vector<scatter_dims_to_operand_dims>
+      2,       // num_scatter_dims_to_operand_dims
+      1,       // index_vector_dim
+      false,   // unique_indices
+      1        // update_computation_subgraph_index
+  };
+  StablehloScatterOpModel model(
+      {TensorType_FLOAT32, {2, 4}}, {TensorType_INT64, {2, 2}},
+      {TensorType_FLOAT32, {2, 2}}, params, op_type);
+  model.SetInput<float>({1, 2, 3, 4, 5, 6, 7, 8});
+  // The second row of updates starts at the last column of the input, so
+  // only its first update is applied.
+  model.SetIndices<int64_t>({0, 1, 1, 3});
+  model.SetUpdates<float>({10, 20, 30, 40});
+
+  ASSERT_EQ(model.Invoke(), kTfLiteOk);
+  std::vector<float> expected_values = {1, 12, 23, 4, 5, 6, 7, 38};
+  EXPECT_THAT(model.GetOutput<float>(), ElementsAreArray(expected_values));
+}
+
 }  // namespace
 }  // namespace tflite
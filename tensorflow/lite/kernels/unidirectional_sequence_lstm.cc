@@ -1016,6 +1016,14 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     // accumulation buffer and an extra 16 bytes to avoid internal ruy copies.
     scratch_buffer_size->data[1] = n_cell * 5 + 16;
   }
+  if (input_to_output_weights->type == kTfLiteFloat32) {
+    // Reserving space at the end for the input contributions to the gates of
+    // several steps, which are computed at once.
+    const int max_time =
+        time_major ? input->dims->data[0] : input->dims->data[1];
+    scratch_buffer_size->data[1] +=
+        lstm_eval::GetInputProjectionScratchSize(n_cell, max_time);
+  }
   TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
                                                    scratch_buffer_size));
 
@@ -1366,6 +1374,18 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
       TfLiteTensor* scratch_buffer;
       TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node, kScratchBuffer,
                                                   &scratch_buffer));
+      const int max_time =
+          time_major ? input->dims->data[0] : input->dims->data[1];
+      const int n_batch =
+          time_major ? input->dims->data[1] : input->dims->data[0];
+      const int n_cell = input_to_output_weights->dims->data[0];
+      const int input_projection_size =
+          n_batch * lstm_eval::GetInputProjectionScratchSize(n_cell, max_time);
+      float* input_projection_scratch =
+          input_projection_size > 0
+              ? GetTensorData<float>(scratch_buffer) +
+                    NumElements(scratch_buffer) - input_projection_size
+              : nullptr;
       return lstm_eval::EvalFloat(
           input, input_to_input_weights, input_to_forget_weights,
           input_to_cell_weights, input_to_output_weights,
@@ -1392,7 +1412,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           (recurrent_to_cell_weights->dims->size == 1),
           /*recurrent_to_output_is_diag=*/
           (recurrent_to_output_weights->dims->size == 1),
-          CpuBackendContext::GetFromContext(context));
+          CpuBackendContext::GetFromContext(context), input_projection_scratch);
     }
     case kTfLiteUInt8:
     case kTfLiteInt8: {
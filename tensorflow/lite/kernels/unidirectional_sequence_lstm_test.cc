@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 // Unit test for TFLite Sequential LSTM op.
 
+#include <cmath>
+#include <memory>
 #include <tuple>
 #include <vector>
 
@@ -296,6 +298,99 @@ TEST_F(NoCifgNoPeepholeNoProjectionNoClippingUnidirectionalLstmTest,
                 /*time_major=*/false);
 }
 
+// The input contributions to the gates are computed for several steps at
+// once, so a sequence longer than that is compared with running its steps one
+// at a time.
+TEST_F(NoCifgNoPeepholeNoProjectionNoClippingUnidirectionalLstmTest,
+       LongSequenceMatchesSingleSteps) {
+  const int n_batch = 2;
+  const int n_input = 2;
+  const int n_cell = 4;
+  const int n_output = 4;
+  const int sequence_length = 11;
+
+  const auto make_lstm = [&](int length, bool time_major) {
+    auto lstm = std::make_unique<UnidirectionalLSTMOpModel>(
+        n_batch, n_input, n_cell, n_output, length, time_major,
+        /*use_cifg=*/false, /*use_peephole=*/false,
+        /*use_projection_weights=*/false,
+        /*use_projection_bias=*/false,
+        /*cell_clip=*/0.0, /*proj_clip=*/0.0,
+        std::vector<std::vector<int>>{
+            time_major ? std::vector<int>{length, n_batch, n_input}
+                       : std::vector<int>{n_batch, length, n_input},
+            {n_cell, n_input},
+            {n_cell, n_input},
+            {n_cell, n_input},
+            {n_cell, n_input},
+            {n_cell, n_output},
+            {n_cell, n_output},
+            {n_cell, n_output},
+            {n_cell, n_output},
+            {0},
+            {0},
+            {0},
+            {n_cell},
+            {n_cell},
+            {n_cell},
+            {n_cell},
+            {0, 0},
+            {0},
+            {n_batch, n_output},
+            {n_batch, n_cell},
+        });
+    lstm->SetInputToInputWeights(input_to_input_weights_);
+    lstm->SetInputToCellWeights(input_to_cell_weights_);
+    lstm->SetInputToForgetWeights(input_to_forget_weights_);
+    lstm->SetInputToOutputWeights(input_to_output_weights_);
+    lstm->SetInputGateBias(input_gate_bias_);
+    lstm->SetCellBias(cell_gate_bias_);
+    lstm->SetForgetGateBias(forget_gate_bias_);
+    lstm->SetOutputGateBias(output_gate_bias_);
+    lstm->SetRecurrentToInputWeights(recurrent_to_input_weights_);
+    lstm->SetRecurrentToCellWeights(recurrent_to_cell_weights_);
+    lstm->SetRecurrentToForgetWeights(recurrent_to_forget_weights_);
+    lstm->SetRecurrentToOutputWeights(recurrent_to_output_weights_);
+    return lstm;
+  };
+
+  // The time major input and the outputs of the single steps.
+  const int step_size = n_batch * n_input;
+  std::vector<float> input(sequence_length * step_size);
+  for (size_t i = 0; i < input.size(); ++i) input[i] = std::sin(0.7f * i);
+  auto single_step = make_lstm(/*length=*/1, /*time_major=*/true);
+  std::vector<float> expected;
+  for (int t = 0; t < sequence_length; ++t) {
+    single_step->SetInput(0, input.data() + t * step_size,
+                          input.data() + (t + 1) * step_size);
+    ASSERT_EQ(single_step->Invoke(), kTfLiteOk);
+    const std::vector<float> output = single_step->GetOutput();
+    expected.insert(expected.end(), output.begin(), output.end());
+  }
+
+  auto time_major = make_lstm(sequence_length, /*time_major=*/true);
+  time_major->SetInput(0, input.data(), input.data() + input.size());
+  ASSERT_EQ(time_major->Invoke(), kTfLiteOk);
+  EXPECT_THAT(time_major->GetOutput(),
+              ElementsAreArray(ArrayFloatNear(expected, 1e-5)));
+
+  auto batch_major = make_lstm(sequence_length, /*time_major=*/false);
+  std::vector<float> expected_batch_major;
+  for (int b = 0; b < n_batch; ++b) {
+    for (int t = 0; t < sequence_length; ++t) {
+      const float* step = input.data() + t * step_size + b * n_input;
+      batch_major->SetInput((b * sequence_length + t) * n_input, step,
+                            step + n_input);
+      const auto output = expected.begin() + (t * n_batch + b) * n_output;
+      expected_batch_major.insert(expected_batch_major.end(), output,
+                                  output + n_output);
+    }
+  }
+  ASSERT_EQ(batch_major->Invoke(), kTfLiteOk);
+  EXPECT_THAT(batch_major->GetOutput(),
+              ElementsAreArray(ArrayFloatNear(expected_batch_major, 1e-5)));
+}
+
 TEST_P(NoCifgNoPeepholeNoProjectionNoClippingUnidirectionalLstmTest,
        HybridLstmBlackBoxTestUint8) {
   const int n_batch = 1;
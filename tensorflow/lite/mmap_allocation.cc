@@ -19,7 +19,9 @@ limitations under the License.
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cerrno>
+#include <cstdint>
 
 #include "tensorflow/lite/allocation.h"
 #include "tensorflow/lite/core/api/error_reporter.h"
@@ -40,6 +42,11 @@ size_t GetFdSizeBytes(int fd) {
   return fd_stat.st_size;
 }
 
+size_t GetPageSize() {
+  static const size_t page_size = sysconf(_SC_PAGESIZE);
+  return page_size;
+}
+
 }  // namespace
 
 MMAPAllocation::MMAPAllocation(const char* filename,
@@ -129,6 +136,36 @@ size_t MMAPAllocation::bytes() const { return buffer_size_bytes_; }
 
 bool MMAPAllocation::valid() const { return mmapped_buffer_ != MAP_FAILED; }
 
+void MMAPAllocation::Prefetch(const void* ptr, size_t num_bytes) const {
+  if (!valid()) return;
+  const uintptr_t page_size = GetPageSize();
+  const uintptr_t buffer = reinterpret_cast<uintptr_t>(mmapped_buffer_);
+  const uintptr_t begin =
+      std::max(reinterpret_cast<uintptr_t>(ptr) & ~(page_size - 1), buffer);
+  const uintptr_t end =
+      std::min(reinterpret_cast<uintptr_t>(ptr) + num_bytes,
+               buffer + buffer_size_bytes_ + offset_in_buffer_);
+  if (begin >= end) return;
+  // The advice is only a hint, failures are harmless.
+  madvise(reinterpret_cast<void*>(begin), end - begin, MADV_WILLNEED);
+}
+
+void MMAPAllocation::Release(const void* ptr, size_t num_bytes) const {
+  if (!valid()) return;
+  const uintptr_t page_size = GetPageSize();
+  const uintptr_t buffer = reinterpret_cast<uintptr_t>(mmapped_buffer_);
+  const uintptr_t begin = std::max(
+      (reinterpret_cast<uintptr_t>(ptr) + page_size - 1) & ~(page_size - 1),
+      buffer);
+  const uintptr_t end = std::min(
+      (reinterpret_cast<uintptr_t>(ptr) + num_bytes) & ~(page_size - 1),
+      buffer + buffer_size_bytes_ + offset_in_buffer_);
+  if (begin >= end) return;
+  // The mapping is read-only and backed by the file, so dropped pages are
+  // read back from it on their next access.
+  madvise(reinterpret_cast<void*>(begin), end - begin, MADV_DONTNEED);
+}
+
 bool MMAPAllocation::IsSupported() { return true; }
 
 }  // namespace tflite
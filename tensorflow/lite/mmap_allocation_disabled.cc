@@ -45,6 +45,10 @@ size_t MMAPAllocation::bytes() const { return 0; }
 
 bool MMAPAllocation::valid() const { return false; }
 
+void MMAPAllocation::Prefetch(const void* ptr, size_t num_bytes) const {}
+
+void MMAPAllocation::Release(const void* ptr, size_t num_bytes) const {}
+
 bool MMAPAllocation::IsSupported() { return false; }
 
 }  // namespace tflite
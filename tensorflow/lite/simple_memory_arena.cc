@@ -21,7 +21,9 @@ limitations under the License.
 #include <cstdlib>
 #include <cstring>
 #include <limits>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/lite/core/c/common.h"
@@ -284,7 +286,26 @@ TfLiteStatus SimpleMemoryArena::Allocate(
   return kTfLiteOk;
 }
 
+SimpleMemoryArena::~SimpleMemoryArena() {
+  if (shared_buffer_ && shared_buffer_->IsUsedBy(this)) {
+    shared_buffer_->user_ = nullptr;
+  }
+}
+
 TfLiteStatus SimpleMemoryArena::Commit(bool* arena_reallocated) {
+  if (shared_buffer_) {
+    ResizableAlignedBuffer& buffer = shared_buffer_->buffer_;
+    if (buffer.GetAlignment() % underlying_buffer_.GetAlignment() != 0) {
+      return kTfLiteError;
+    }
+    // The contents of the buffer belong to the arena that used it before, so
+    // all allocs of this arena need to be resolved again when taking it.
+    const bool taken = !shared_buffer_->IsUsedBy(this);
+    shared_buffer_->user_ = this;
+    *arena_reallocated = buffer.Resize(high_water_mark_) || taken;
+    committed_ = true;
+    return kTfLiteOk;
+  }
   // Resize the arena to the high water mark (calculated by Allocate), retaining
   // old contents and alignment in the process. Since Alloc pointers are offset
   // based, they will remain valid in the new memory block.
@@ -293,17 +314,29 @@ TfLiteStatus SimpleMemoryArena::Commit(bool* arena_reallocated) {
   return kTfLiteOk;
 }
 
+void SimpleMemoryArena::RestorePlan(
+    const std::vector<ArenaAllocWithUsageInterval>& allocs) {
+  committed_ = false;
+  high_water_mark_ = 0;
+  active_allocs_.clear();
+  for (const auto& alloc : allocs) {
+    if (alloc.size == 0) continue;
+    active_allocs_.push_back(alloc);
+    high_water_mark_ = std::max(high_water_mark_, alloc.offset + alloc.size);
+  }
+  std::sort(active_allocs_.begin(), active_allocs_.end());
+}
+
 TfLiteStatus SimpleMemoryArena::ResolveAlloc(
     TfLiteContext* context, const ArenaAllocWithUsageInterval& alloc,
     char** output_ptr) {
-  TF_LITE_ENSURE(context, committed_);
+  TF_LITE_ENSURE(context, committed_ && !IsSharedBufferTaken());
   TF_LITE_ENSURE(context, output_ptr != nullptr);
-  TF_LITE_ENSURE(context,
-                 underlying_buffer_.GetSize() >= (alloc.offset + alloc.size));
+  TF_LITE_ENSURE(context, buffer().GetSize() >= (alloc.offset + alloc.size));
   if (alloc.size == 0) {
     *output_ptr = nullptr;
   } else {
-    *output_ptr = underlying_buffer_.GetPtr() + alloc.offset;
+    *output_ptr = buffer().GetPtr() + alloc.offset;
   }
   return kTfLiteOk;
 }
@@ -317,10 +350,21 @@ TfLiteStatus SimpleMemoryArena::ClearPlan() {
 
 TfLiteStatus SimpleMemoryArena::ReleaseBuffer() {
   committed_ = false;
+  if (shared_buffer_) {
+    // Other arenas may still use the shared buffer, so it is only given up.
+    if (shared_buffer_->IsUsedBy(this)) shared_buffer_->user_ = nullptr;
+    return kTfLiteOk;
+  }
   underlying_buffer_.Release();
   return kTfLiteOk;
 }
 
+void SimpleMemoryArena::SetSharedBuffer(
+    std::shared_ptr<SharedArenaBuffer> shared_buffer) {
+  ReleaseBuffer();
+  shared_buffer_ = std::move(shared_buffer);
+}
+
 // Using weak symbols to create a pluggable debugging module.
 TFLITE_ATTRIBUTE_WEAK void DumpArenaInfo(
     const std::string& name, const std::vector<int>& execution_plan,
@@ -329,7 +373,7 @@ TFLITE_ATTRIBUTE_WEAK void DumpArenaInfo(
 
 void SimpleMemoryArena::DumpDebugInfo(
     const std::string& name, const std::vector<int>& execution_plan) const {
-  tflite::DumpArenaInfo(name, execution_plan, underlying_buffer_.GetSize(),
+  tflite::DumpArenaInfo(name, execution_plan, buffer().GetSize(),
                         active_allocs_);
 }
 
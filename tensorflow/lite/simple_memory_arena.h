@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -100,6 +101,40 @@ class ResizableAlignedBuffer {
   int subgraph_index_;
 };
 
+class SimpleMemoryArena;
+
+// A buffer that the non-persistent arenas of several interpreters take turns
+// to use, when the interpreters never run at the same time (e.g. models that
+// run one after another on every frame). The buffer grows to the largest high
+// water mark among them, so their activations take the memory of the largest
+// arena instead of the sum of all of them.
+//
+// Only one arena uses the buffer at a time: committing an arena takes the
+// buffer from the arena that used it before, whose tensors must not be used
+// until that arena is committed again. This class is not thread safe.
+class SharedArenaBuffer {
+ public:
+  explicit SharedArenaBuffer(size_t alignment = 64)
+      : buffer_(alignment, /*subgraph_index=*/0) {}
+
+  SharedArenaBuffer(const SharedArenaBuffer&) = delete;
+  SharedArenaBuffer& operator=(const SharedArenaBuffer&) = delete;
+
+  // Size of the buffer, i.e. the largest high water mark committed so far.
+  size_t GetSize() const { return buffer_.GetSize(); }
+
+  // Returns true if `arena` is the arena currently using the buffer.
+  bool IsUsedBy(const SimpleMemoryArena* arena) const {
+    return arena != nullptr && user_ == arena;
+  }
+
+ private:
+  friend class SimpleMemoryArena;
+
+  ResizableAlignedBuffer buffer_;
+  const SimpleMemoryArena* user_ = nullptr;
+};
+
 // This small class is responsible for allocating, deallocating and reusing
 // dynamic memory from a common underlying buffer. The arena can be used in
 // scenarios when the pattern of memory allocations and deallocations is
@@ -113,6 +148,8 @@ class SimpleMemoryArena {
         underlying_buffer_(arena_alignment, subgraph_index),
         active_allocs_() {}
 
+  ~SimpleMemoryArena();
+
   // Delete all allocs. This should be called when allocating the first node of
   // a subgraph.
   void ResetAllocs();
@@ -142,8 +179,17 @@ class SimpleMemoryArena {
                         int32_t tensor, int32_t first_node, int32_t last_node,
                         ArenaAllocWithUsageInterval* new_alloc);
 
+  // Resizes the underlying buffer to the high water mark. With a shared
+  // buffer, this also takes the buffer from the arena that used it before, and
+  // `arena_reallocated` is then true, since all allocs need to be resolved
+  // again.
   TfLiteStatus Commit(bool* arena_reallocated);
 
+  // Replaces the allocation plan with `allocs`, which must have been scheduled
+  // by Allocate for the same usage intervals. Zero-sized allocs are ignored.
+  // The arena needs to be committed before resolving them.
+  void RestorePlan(const std::vector<ArenaAllocWithUsageInterval>& allocs);
+
   TfLiteStatus ResolveAlloc(TfLiteContext* context,
                             const ArenaAllocWithUsageInterval& alloc,
                             char** output_ptr);
@@ -156,12 +202,26 @@ class SimpleMemoryArena {
   // This releases the underlying buffer but does not clear the allocation plan.
   // Since all associated pointers are invalidated, the arena cannot be used
   // again until Commit() is called & tensor allocations are resolved.
+  // A shared buffer is not freed, since other arenas may still use it.
   TfLiteStatus ReleaseBuffer();
 
-  size_t GetBufferSize() const { return underlying_buffer_.GetSize(); }
+  // Makes the arena use `shared_buffer` instead of a buffer of its own, which
+  // is released. The alignment of `shared_buffer` must be a multiple of the
+  // arena alignment. Passing nullptr makes the arena use its own buffer again.
+  // In both cases, the arena needs to be committed and its allocations
+  // resolved again before it is used.
+  void SetSharedBuffer(std::shared_ptr<SharedArenaBuffer> shared_buffer);
+
+  // Returns true if the arena has a shared buffer that it does not currently
+  // use, e.g. because another arena has taken it since this one was committed.
+  bool IsSharedBufferTaken() const {
+    return shared_buffer_ != nullptr && !shared_buffer_->IsUsedBy(this);
+  }
+
+  size_t GetBufferSize() const { return buffer().GetSize(); }
 
   std::intptr_t BasePointer() const {
-    return reinterpret_cast<std::intptr_t>(underlying_buffer_.GetPtr());
+    return reinterpret_cast<std::intptr_t>(buffer().GetPtr());
   }
 
   // Dumps the memory allocation information of this memory arena (which could
@@ -182,10 +242,15 @@ class SimpleMemoryArena {
                      const std::vector<int>& execution_plan) const;
 
  private:
+  const ResizableAlignedBuffer& buffer() const {
+    return shared_buffer_ ? shared_buffer_->buffer_ : underlying_buffer_;
+  }
+
   bool committed_;
   size_t high_water_mark_;
   ResizableAlignedBuffer underlying_buffer_;
   std::vector<ArenaAllocWithUsageInterval> active_allocs_;
+  std::shared_ptr<SharedArenaBuffer> shared_buffer_;
 };
 
 }  // namespace tflite
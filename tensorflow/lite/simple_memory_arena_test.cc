@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/simple_memory_arena.h"
 
+#include <memory>
+
 #include <gtest/gtest.h>
 #include "tensorflow/lite/core/c/common.h"
 
@@ -367,6 +369,59 @@ TEST_P(BufferAndPlanClearingTest, TestClearBufferAndClearPlan) {
   EXPECT_NE(resolved_ptr, nullptr);
 }
 
+TEST(SimpleMemoryArenaTest, TestSharedBuffer) {
+  TfLiteContext context;
+  context.ReportError = ReportError;
+  auto shared_buffer = std::make_shared<SharedArenaBuffer>(64);
+  SimpleMemoryArena first_arena(64);
+  SimpleMemoryArena second_arena(64);
+  first_arena.SetSharedBuffer(shared_buffer);
+  second_arena.SetSharedBuffer(shared_buffer);
+  ArenaAllocWithUsageInterval first_alloc;
+  ArenaAllocWithUsageInterval second_alloc;
+  first_arena.Allocate(&context, 32, 1024, 0, 0, 1, &first_alloc);
+  second_arena.Allocate(&context, 32, 4096, 0, 0, 1, &second_alloc);
+
+  bool reallocated = false;
+  ASSERT_EQ(first_arena.Commit(&reallocated), kTfLiteOk);
+  EXPECT_TRUE(reallocated);
+  EXPECT_FALSE(first_arena.IsSharedBufferTaken());
+  EXPECT_EQ(shared_buffer->GetSize(), 1024);
+  char* first_ptr = nullptr;
+  ASSERT_EQ(first_arena.ResolveAlloc(&context, first_alloc, &first_ptr),
+            kTfLiteOk);
+
+  // Committing the second arena takes the buffer and grows it to the larger
+  // high water mark.
+  ASSERT_EQ(second_arena.Commit(&reallocated), kTfLiteOk);
+  EXPECT_TRUE(reallocated);
+  EXPECT_TRUE(first_arena.IsSharedBufferTaken());
+  EXPECT_FALSE(second_arena.IsSharedBufferTaken());
+  EXPECT_EQ(shared_buffer->GetSize(), 4096);
+  EXPECT_EQ(first_arena.GetBufferSize(), 4096);
+  ASSERT_NE(first_arena.ResolveAlloc(&context, first_alloc, &first_ptr),
+            kTfLiteOk);
+  char* second_ptr = nullptr;
+  ASSERT_EQ(second_arena.ResolveAlloc(&context, second_alloc, &second_ptr),
+            kTfLiteOk);
+
+  // Taking the buffer back does not grow it, but the allocs of the first
+  // arena need to be resolved again.
+  ASSERT_EQ(first_arena.Commit(&reallocated), kTfLiteOk);
+  EXPECT_TRUE(reallocated);
+  EXPECT_EQ(shared_buffer->GetSize(), 4096);
+  ASSERT_EQ(first_arena.ResolveAlloc(&context, first_alloc, &first_ptr),
+            kTfLiteOk);
+  EXPECT_EQ(first_ptr, second_ptr);
+  ASSERT_EQ(first_arena.Commit(&reallocated), kTfLiteOk);
+  EXPECT_FALSE(reallocated);
+
+  // Releasing an arena gives up the shared buffer without freeing it.
+  ASSERT_EQ(first_arena.ReleaseBuffer(), kTfLiteOk);
+  EXPECT_TRUE(first_arena.IsSharedBufferTaken());
+  EXPECT_EQ(shared_buffer->GetSize(), 4096);
+}
+
 INSTANTIATE_TEST_SUITE_P(BufferAndPlanClearingTest, BufferAndPlanClearingTest,
                          ::testing::Values(true, false));
 
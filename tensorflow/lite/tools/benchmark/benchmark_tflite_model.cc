@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/lite/tools/benchmark/benchmark_tflite_model.h"
 
+#include <algorithm>
+#include <condition_variable>  // NOLINT(build/c++11)
 #include <cstdarg>
 #include <cstdint>
 #include <cstdlib>
@@ -22,13 +24,20 @@ limitations under the License.
 #include <functional>
 #include <iostream>
 #include <memory>
+#include <mutex>  // NOLINT(build/c++11)
 #include <random>
 #include <sstream>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif  // __linux__
+
 #include "absl/base/attributes.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_replace.h"
@@ -45,7 +54,9 @@ limitations under the License.
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/op_resolver.h"
 #include "tensorflow/lite/optional_debug_tools.h"
+#include "tensorflow/lite/profiling/memory_info.h"
 #include "tensorflow/lite/profiling/profile_summary_formatter.h"
+#include "tensorflow/lite/profiling/time.h"
 #include "tensorflow/lite/string_util.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
 #include "tensorflow/lite/tools/benchmark/profiling_listener.h"
@@ -391,6 +402,12 @@ BenchmarkParams BenchmarkTfLiteModel::DefaultParams() {
                           BenchmarkParam::Create<int32_t>(15));
   default_params.AddParam("alloc_type_display_length",
                           BenchmarkParam::Create<int32_t>(18));
+  default_params.AddParam("num_concurrent_interpreters",
+                          BenchmarkParam::Create<int32_t>(1));
+  default_params.AddParam("concurrent_interpreters_share_weights",
+                          BenchmarkParam::Create<bool>(true));
+  default_params.AddParam("concurrent_cpu_affinity",
+                          BenchmarkParam::Create<std::string>(""));
 
   tools::ProvidedDelegateList delegate_providers(&default_params);
   delegate_providers.AddAllDelegateParams();
@@ -488,7 +505,22 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
       CreateFlag<int32_t>(
           "alloc_type_display_length", &params_,
           "The number of characters to show for the tensor's allocation type "
-          "when printing the interpeter's state, defaults to 18.")};
+          "when printing the interpeter's state, defaults to 18."),
+      CreateFlag<int32_t>(
+          "num_concurrent_interpreters", &params_,
+          "If greater than 1, after the regular runs, run this many "
+          "interpreters of the model concurrently, each on its own thread, "
+          "and report their throughput, latency percentiles and memory usage. "
+          "Each thread runs at least --num_runs times and --min_secs seconds."),
+      CreateFlag<bool>(
+          "concurrent_interpreters_share_weights", &params_,
+          "Whether the concurrent interpreters share the model, and thus its "
+          "weights, or each of them loads its own copy."),
+      CreateFlag<std::string>(
+          "concurrent_cpu_affinity", &params_,
+          "A comma-separated list of CPU ids, e.g. 4,5,6,7. Thread i of the "
+          "concurrent benchmark is pinned to the (i % n)-th CPU of the list. "
+          "Only supported on Linux.")};
 
   flags.insert(flags.end(), specific_flags.begin(), specific_flags.end());
 
@@ -543,6 +575,12 @@ void BenchmarkTfLiteModel::LogParams() {
                       "Tensor type display length", verbose);
   LOG_BENCHMARK_PARAM(int32_t, "alloc_type_display_length",
                       "Tensor allocation type display length", verbose);
+  LOG_BENCHMARK_PARAM(int32_t, "num_concurrent_interpreters",
+                      "Number of concurrent interpreters", verbose);
+  LOG_BENCHMARK_PARAM(bool, "concurrent_interpreters_share_weights",
+                      "Concurrent interpreters share weights", verbose);
+  LOG_BENCHMARK_PARAM(std::string, "concurrent_cpu_affinity",
+                      "CPU affinity of concurrent interpreters", verbose);
 
   for (const auto& delegate_provider :
        tools::GetRegisteredDelegateProviders()) {
@@ -559,6 +597,15 @@ TfLiteStatus BenchmarkTfLiteModel::ValidateParams() {
     return kTfLiteError;
   }
 
+  std::vector<int> cpus;
+  if (!util::SplitAndParse(params_.Get<std::string>("concurrent_cpu_affinity"),
+                           ',', &cpus) ||
+      std::any_of(cpus.begin(), cpus.end(), [](int cpu) { return cpu < 0; })) {
+    TFLITE_LOG(ERROR) << "Invalid --concurrent_cpu_affinity: "
+                      << params_.Get<std::string>("concurrent_cpu_affinity");
+    return kTfLiteError;
+  }
+
   return PopulateInputLayerInfo(
       params_.Get<std::string>("input_layer"),
       params_.Get<std::string>("input_layer_shape"),
@@ -695,11 +742,16 @@ TfLiteStatus BenchmarkTfLiteModel::PrepareInputData() {
 }
 
 TfLiteStatus BenchmarkTfLiteModel::ResetInputsAndOutputs() {
-  auto interpreter_inputs = interpreter_->inputs();
+  SetInputs(interpreter_.get());
+  return kTfLiteOk;
+}
+
+void BenchmarkTfLiteModel::SetInputs(Interpreter* interpreter) {
+  auto interpreter_inputs = interpreter->inputs();
   // Set the values of the input tensors from inputs_data_.
   for (int j = 0; j < interpreter_inputs.size(); ++j) {
     int i = interpreter_inputs[j];
-    TfLiteTensor* t = interpreter_->tensor(i);
+    TfLiteTensor* t = interpreter->tensor(i);
     if (t->type == kTfLiteString) {
       if (inputs_data_[j].data) {
         static_cast<DynamicBuffer*>(inputs_data_[j].data.get())
@@ -717,8 +769,6 @@ TfLiteStatus BenchmarkTfLiteModel::ResetInputsAndOutputs() {
                   inputs_data_[j].bytes);
     }
   }
-
-  return kTfLiteOk;
 }
 
 TfLiteStatus BenchmarkTfLiteModel::InitInterpreter() {
@@ -969,6 +1019,236 @@ BenchmarkTfLiteModel::MayCreateProfilingListener() const {
           !params_.Get<std::string>("profiling_output_csv_file").empty())));
 }
 
+TfLiteStatus BenchmarkTfLiteModel::Run() {
+  TF_LITE_ENSURE_STATUS(BenchmarkModel::Run());
+  if (params_.Get<int32_t>("num_concurrent_interpreters") <= 1) {
+    return kTfLiteOk;
+  }
+  if (params_.Get<bool>("dry_run")) {
+    TFLITE_LOG(INFO) << "Skipped the concurrent interpreters for --dry_run.";
+    return kTfLiteOk;
+  }
+  return RunConcurrentInterpreters();
+}
+
+TfLiteStatus BenchmarkTfLiteModel::CreateConcurrentInterpreter(
+    ConcurrentInterpreter* result) {
+  const tflite::FlatBufferModel* model = model_.get();
+  if (!params_.Get<bool>("concurrent_interpreters_share_weights")) {
+    const auto* allocation = model_->allocation();
+    result->model_buffer.assign(static_cast<const char*>(allocation->base()),
+                                allocation->bytes());
+    result->model = tflite::FlatBufferModel::BuildFromBuffer(
+        result->model_buffer.data(), result->model_buffer.size());
+    if (!result->model) {
+      TFLITE_LOG(ERROR) << "Failed to copy the model.";
+      return kTfLiteError;
+    }
+    model = result->model.get();
+  }
+
+  auto resolver = GetOpResolver();
+  InterpreterOptions options;
+  options.SetEnsureDynamicTensorsAreReleased(
+      params_.Get<bool>("release_dynamic_tensors"));
+  options.OptimizeMemoryForLargeTensors(
+      params_.Get<int32_t>("optimize_memory_for_large_tensors"));
+  options.SetDisableDelegateClustering(
+      params_.Get<bool>("disable_delegate_clustering"));
+  options.SetCacheConstantCastOp(
+      params_.Get<bool>("enable_builtin_cast_constant_cache"));
+  tflite::InterpreterBuilder builder(*model, *resolver, &options);
+  if (builder.SetNumThreads(params_.Get<int32_t>("num_threads")) !=
+          kTfLiteOk ||
+      builder(&result->interpreter) != kTfLiteOk || !result->interpreter) {
+    TFLITE_LOG(ERROR) << "Failed to initialize a concurrent interpreter";
+    return kTfLiteError;
+  }
+  Interpreter* interpreter = result->interpreter.get();
+  interpreter->SetAllowFp16PrecisionForFp32(params_.Get<bool>("allow_fp16"));
+
+  auto interpreter_inputs = interpreter->inputs();
+  for (int j = 0; j < inputs_.size(); ++j) {
+    int i = interpreter_inputs[j];
+    if (interpreter->tensor(i)->type != kTfLiteString) {
+      interpreter->ResizeInputTensor(i, inputs_[j].shape);
+    }
+  }
+
+  tools::ProvidedDelegateList delegate_providers(&params_);
+  for (auto& created_delegate : delegate_providers.CreateAllRankedDelegates()) {
+    TfLiteDelegate* delegate = created_delegate.delegate.get();
+    result->delegates.emplace_back(std::move(created_delegate.delegate));
+    if (interpreter->ModifyGraphWithDelegate(delegate) != kTfLiteOk) {
+      TFLITE_LOG(ERROR) << "Failed to apply "
+                        << created_delegate.provider->GetName()
+                        << " delegate to a concurrent interpreter.";
+      return kTfLiteError;
+    }
+  }
+
+  if (interpreter->AllocateTensors() != kTfLiteOk) {
+    TFLITE_LOG(ERROR) << "Failed to allocate tensors!";
+    return kTfLiteError;
+  }
+  SetInputs(interpreter);
+  return kTfLiteOk;
+}
+
+TfLiteStatus BenchmarkTfLiteModel::RunConcurrentInterpreters() {
+  const int num_interpreters =
+      params_.Get<int32_t>("num_concurrent_interpreters");
+  std::vector<int> cpus;
+  util::SplitAndParse(params_.Get<std::string>("concurrent_cpu_affinity"), ',',
+                      &cpus);
+
+  concurrent_run_results_ = ConcurrentRunResults();
+  ConcurrentRunResults& results = concurrent_run_results_;
+  const auto start_mem_usage = profiling::memory::GetMemoryUsage();
+  std::vector<ConcurrentInterpreter> interpreters(num_interpreters);
+  for (auto& interpreter : interpreters) {
+    TF_LITE_ENSURE_STATUS(CreateConcurrentInterpreter(&interpreter));
+  }
+  results.init_mem_usage =
+      profiling::memory::GetMemoryUsage() - start_mem_usage;
+
+  TFLITE_LOG(INFO) << "Running " << num_interpreters
+                   << " interpreters concurrently.";
+  const int32_t warmup_runs = params_.Get<int32_t>("warmup_runs");
+  const int32_t min_num_runs = params_.Get<int32_t>("num_runs");
+  const float min_secs = params_.Get<float>("min_secs");
+  const float max_secs = params_.Get<float>("max_secs");
+
+  // The threads warm up their interpreter, then wait for all the others so
+  // that the measured runs overlap.
+  std::mutex mutex;
+  std::condition_variable cv;
+  int num_ready = 0;
+  int64_t start_us = -1;
+  std::vector<std::vector<int64_t>> latencies_us(num_interpreters);
+  std::vector<int64_t> end_us(num_interpreters);
+  std::vector<TfLiteStatus> statuses(num_interpreters, kTfLiteOk);
+  results.thread_cpus.assign(num_interpreters, -1);
+
+  auto run_interpreter = [&](int index) {
+    Interpreter* interpreter = interpreters[index].interpreter.get();
+    if (!cpus.empty()) {
+      const int cpu = cpus[index % cpus.size()];
+#ifdef __linux__
+      // Threads created by the interpreter, e.g. those of its thread pool,
+      // inherit the affinity of this thread.
+      cpu_set_t cpu_set;
+      CPU_ZERO(&cpu_set);
+      CPU_SET(cpu, &cpu_set);
+      if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) ==
+          0) {
+        results.thread_cpus[index] = cpu;
+      } else {
+        TFLITE_LOG(WARN) << "Failed to pin thread " << index << " to CPU "
+                         << cpu;
+      }
+#endif  // __linux__
+    }
+    for (int run = 0; run < warmup_runs; ++run) {
+      if (interpreter->Invoke() != kTfLiteOk) statuses[index] = kTfLiteError;
+    }
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      if (++num_ready == num_interpreters) {
+        start_us = profiling::time::NowMicros();
+        cv.notify_all();
+      } else {
+        cv.wait(lock, [&] { return num_ready == num_interpreters; });
+      }
+    }
+    const int64_t min_finish_us =
+        start_us + static_cast<int64_t>(min_secs * 1e6);
+    const int64_t max_finish_us =
+        start_us + static_cast<int64_t>(max_secs * 1e6);
+    int64_t now_us = profiling::time::NowMicros();
+    for (int run = 0; (run < min_num_runs || now_us < min_finish_us) &&
+                      now_us <= max_finish_us;
+         ++run) {
+      const int64_t run_start_us = now_us;
+      if (interpreter->Invoke() != kTfLiteOk) statuses[index] = kTfLiteError;
+      now_us = profiling::time::NowMicros();
+      latencies_us[index].push_back(now_us - run_start_us);
+    }
+    end_us[index] = now_us;
+  };
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_interpreters; ++i) {
+    threads.emplace_back(run_interpreter, i);
+  }
+  for (auto& thread : threads) thread.join();
+  results.overall_mem_usage =
+      profiling::memory::GetMemoryUsage() - start_mem_usage;
+  for (int i = 0; i < num_interpreters; ++i) {
+    if (statuses[i] != kTfLiteOk) {
+      TFLITE_LOG(ERROR) << "Concurrent interpreter " << i
+                        << " failed to invoke.";
+      return kTfLiteError;
+    }
+  }
+
+  std::vector<int64_t> all_latencies_us;
+  for (const auto& thread_latencies_us : latencies_us) {
+    results.thread_num_requests.push_back(thread_latencies_us.size());
+    all_latencies_us.insert(all_latencies_us.end(),
+                            thread_latencies_us.begin(),
+                            thread_latencies_us.end());
+  }
+  results.num_requests = all_latencies_us.size();
+  results.wall_time_us =
+      *std::max_element(end_us.begin(), end_us.end()) - start_us;
+  if (results.num_requests > 0) {
+    std::sort(all_latencies_us.begin(), all_latencies_us.end());
+    // The nearest-rank percentile.
+    auto percentile = [&](int p) {
+      const int64_t rank = (results.num_requests * p + 99) / 100;
+      return all_latencies_us[std::max<int64_t>(rank, 1) - 1];
+    };
+    results.latency_p50_us = percentile(50);
+    results.latency_p90_us = percentile(90);
+    results.latency_p99_us = percentile(99);
+    results.requests_per_second =
+        results.num_requests * 1e6 / std::max<int64_t>(results.wall_time_us, 1);
+  }
+
+  TFLITE_LOG(INFO) << "Concurrent interpreters: " << num_interpreters
+                   << ", requests: " << results.num_requests << " in "
+                   << results.wall_time_us / 1e6
+                   << "s, throughput (requests/s): "
+                   << results.requests_per_second;
+  TFLITE_LOG(INFO) << "Request latency in us: p50="
+                   << results.latency_p50_us
+                   << " p90=" << results.latency_p90_us
+                   << " p99=" << results.latency_p99_us;
+  for (int i = 0; i < num_interpreters; ++i) {
+    TFLITE_LOG(INFO) << "Thread " << i << ": "
+                     << results.thread_num_requests[i] << " requests, "
+                     << (results.thread_cpus[i] < 0
+                             ? std::string("not pinned")
+                             : "pinned to CPU " +
+                                   std::to_string(results.thread_cpus[i]));
+  }
+  if (profiling::memory::MemoryUsage::IsSupported()) {
+    TFLITE_LOG(INFO) << "Memory footprint delta of the concurrent "
+                        "interpreters (MB): init="
+                     << results.init_mem_usage.mem_footprint_kb / 1024.0
+                     << " overall="
+                     << results.overall_mem_usage.mem_footprint_kb / 1024.0;
+    const double in_use_mb =
+        static_cast<int64_t>(results.init_mem_usage.in_use_allocated_bytes) /
+        (1024.0 * 1024.0);
+    TFLITE_LOG(INFO) << "Heap in use by the concurrent interpreters (MB): "
+                     << in_use_mb
+                     << ", per interpreter: " << in_use_mb / num_interpreters;
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus BenchmarkTfLiteModel::RunImpl() { return interpreter_->Invoke(); }
 
 }  // namespace benchmark
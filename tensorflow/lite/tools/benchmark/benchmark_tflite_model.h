@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_TFLITE_MODEL_H_
 
 #include <algorithm>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <random>
@@ -25,6 +26,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/lite/core/model.h"
+#include "tensorflow/lite/profiling/memory_info.h"
 #include "tensorflow/lite/profiling/profiler.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_model.h"
 #include "tensorflow/lite/tools/model_loader.h"
@@ -74,6 +76,26 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
     std::string input_file_path;
   };
 
+  // The throughput of several interpreters running the model concurrently,
+  // each on its own thread, see --num_concurrent_interpreters.
+  struct ConcurrentRunResults {
+    int64_t num_requests = 0;
+    int64_t wall_time_us = 0;
+    double requests_per_second = 0;
+    // Percentiles of the latency of a single Invoke, over all interpreters.
+    int64_t latency_p50_us = 0;
+    int64_t latency_p90_us = 0;
+    int64_t latency_p99_us = 0;
+    // The number of requests each thread served, and the CPU it was pinned
+    // to, or -1 if it was not pinned.
+    std::vector<int64_t> thread_num_requests;
+    std::vector<int> thread_cpus;
+    // The memory used by the concurrent interpreters once they are all
+    // initialized, and once they all finished running.
+    profiling::memory::MemoryUsage init_mem_usage;
+    profiling::memory::MemoryUsage overall_mem_usage;
+  };
+
   explicit BenchmarkTfLiteModel(BenchmarkParams params = DefaultParams());
   ~BenchmarkTfLiteModel() override;
 
@@ -83,8 +105,18 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
   uint64_t ComputeInputBytes() override;
   TfLiteStatus Init() override;
   TfLiteStatus RunImpl() override;
+  TfLiteStatus Run(int argc, char** argv) override {
+    return BenchmarkModel::Run(argc, argv);
+  }
+  // Runs the single-stream benchmark, followed by the concurrent one if
+  // --num_concurrent_interpreters is greater than 1.
+  TfLiteStatus Run() override;
   static BenchmarkParams DefaultParams();
 
+  const ConcurrentRunResults& concurrent_run_results() const {
+    return concurrent_run_results_;
+  }
+
  protected:
   TfLiteStatus PrepareInputData() override;
   TfLiteStatus ResetInputsAndOutputs() override;
@@ -115,9 +147,25 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
   std::unique_ptr<tflite::ExternalCpuBackendContext> external_context_;
 
  private:
+  // An interpreter of the concurrent benchmark. Members are destroyed in
+  // reverse order, so the interpreter goes before its delegates and model.
+  struct ConcurrentInterpreter {
+    // Only set when the interpreters do not share the weights of `model_`.
+    std::string model_buffer;
+    std::unique_ptr<tflite::FlatBufferModel> model;
+    std::vector<Interpreter::TfLiteDelegatePtr> delegates;
+    std::unique_ptr<tflite::Interpreter> interpreter;
+  };
+
   utils::InputTensorData CreateRandomTensorData(
       const TfLiteTensor& t, const InputLayerInfo* layer_info);
 
+  // Copies `inputs_data_` into the inputs of `interpreter`.
+  void SetInputs(Interpreter* interpreter);
+
+  TfLiteStatus CreateConcurrentInterpreter(ConcurrentInterpreter* result);
+  TfLiteStatus RunConcurrentInterpreters();
+
   void AddOwnedListener(std::unique_ptr<BenchmarkListener> listener) {
     if (listener == nullptr) return;
     owned_listeners_.emplace_back(std::move(listener));
@@ -130,6 +178,7 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
   // Always TFLITE_LOG the benchmark result.
   BenchmarkLoggingListener log_output_;
   std::unique_ptr<tools::ModelLoader> model_loader_;
+  ConcurrentRunResults concurrent_run_results_;
 };
 
 }  // namespace benchmark
@@ -33,6 +33,10 @@ namespace tflite {
 namespace benchmark {
 namespace {
 
+using ::testing::Each;
+using ::testing::ElementsAre;
+using ::testing::Ge;
+
 static constexpr char kModelPath[] =
     "../tflite_mobilenet_float/"
     "mobilenet_v1_1.0_224.tflite";
@@ -92,6 +96,38 @@ TEST(BenchmarkTfLiteModelTest, ResizeInputWithDelegate) {
   EXPECT_EQ(benchmark.Run(), kTfLiteOk);
 }
 
+TEST(BenchmarkTfLiteModelTest, RunConcurrentInterpreters) {
+  BenchmarkParams params = BenchmarkTfLiteModel::DefaultParams();
+  params.Set<std::string>("graph", kModelPath);
+  params.Set<int>("num_runs", 2);
+  params.Set<int>("warmup_runs", 0);
+  params.Set<float>("min_secs", 0.0f);
+  params.Set<int>("num_threads", 1);
+  params.Set<int>("num_concurrent_interpreters", 3);
+  params.Set<bool>("concurrent_interpreters_share_weights", false);
+  BenchmarkTfLiteModel benchmark = BenchmarkTfLiteModel(std::move(params));
+
+  ASSERT_EQ(benchmark.Run(), kTfLiteOk);
+
+  const auto& results = benchmark.concurrent_run_results();
+  EXPECT_GE(results.num_requests, 6);
+  EXPECT_THAT(results.thread_num_requests, Each(Ge(2)));
+  EXPECT_THAT(results.thread_cpus, ElementsAre(-1, -1, -1));
+  EXPECT_GT(results.requests_per_second, 0);
+  EXPECT_LE(results.latency_p50_us, results.latency_p90_us);
+  EXPECT_LE(results.latency_p90_us, results.latency_p99_us);
+}
+
+TEST(BenchmarkTfLiteModelTest, InvalidConcurrentCpuAffinity) {
+  BenchmarkParams params = BenchmarkTfLiteModel::DefaultParams();
+  params.Set<std::string>("graph", kModelPath);
+  params.Set<int>("num_concurrent_interpreters", 2);
+  params.Set<std::string>("concurrent_cpu_affinity", "0,-1");
+  BenchmarkTfLiteModel benchmark = BenchmarkTfLiteModel(std::move(params));
+
+  EXPECT_EQ(benchmark.Run(), kTfLiteError);
+}
+
 }  // namespace
 }  // namespace benchmark
 }  // namespace tflite
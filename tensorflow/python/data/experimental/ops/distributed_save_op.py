@@ -21,7 +21,11 @@ from tensorflow.python.saved_model import nested_structure_coder
 
 
 # TODO(b/250921378): Add example to docstring and export to TF API.
-def distributed_save(dataset, path, dispatcher_address, compression="AUTO"):
+def distributed_save(dataset,
+                     path,
+                     dispatcher_address,
+                     compression="AUTO",
+                     chunk_store_path=None):
   """Initiates the process of distributedly saving a dataset to disk.
 
   Args:
@@ -34,6 +38,11 @@ def distributed_save(dataset, path, dispatcher_address, compression="AUTO"):
       `dataset` materialization.  If `"AUTO"`, the tf.data runtime decides which
       algorithm to use.  If `"GZIP"` or `"SNAPPY"`, that specific algorithm is
       used.  If `None`, the `dataset` materialization is not compressed.
+    chunk_store_path: (Optional.) A string indicating the directory of a
+      content-addressed chunk store shared by snapshots. If set, chunks are
+      stored there, the snapshot at `path` only refers to them, and chunks
+      with the same contents as chunks already in the store are not stored
+      again. The store must not be deleted while snapshots refer to it.
 
   Returns:
     An operation which when executed performs the distributed save.
@@ -51,6 +60,7 @@ def distributed_save(dataset, path, dispatcher_address, compression="AUTO"):
       element_spec=nested_structure_coder.encode_structure(
           dataset.element_spec).SerializeToString(),
       compression=compression,
+      chunk_store_path=chunk_store_path or "",
   )
 
   return gen_experimental_dataset_ops.distributed_save(
@@ -45,12 +45,17 @@ class AutotuneAlgorithm(enum.Enum):
 
   STAGE_BASED: In each optimization step, this algorithm chooses the worst
   bottleneck parameter and increases its value by 1.
+
+  REGRESSION: Fits a cost model of each parallel transformation to the
+  processing times observed so far, and sets the parameter values predicted to
+  remove the bottlenecks within the CPU and memory budgets.
   """
   DEFAULT = 0
   HILL_CLIMB = 1
   GRADIENT_DESCENT = 2
   MAX_PARALLELISM = 3
   STAGE_BASED = 4
+  REGRESSION = 5
 
   @classmethod
   def _to_proto(cls, obj):
@@ -64,9 +69,12 @@ class AutotuneAlgorithm(enum.Enum):
       return model_pb2.AutotuneAlgorithm.MAX_PARALLELISM
     if obj == cls.STAGE_BASED:
       return model_pb2.AutotuneAlgorithm.STAGE_BASED
+    if obj == cls.REGRESSION:
+      return model_pb2.AutotuneAlgorithm.REGRESSION
     raise ValueError(
         f"Invalid `obj.` Supported values include `DEFAULT`, `HILL_CLIMB` "
-        f"`GRADIENT_DESCENT`, and `STAGE_BASED`. Got {obj.name}.")
+        f"`GRADIENT_DESCENT`, `STAGE_BASED`, and `REGRESSION`. "
+        f"Got {obj.name}.")
 
   @classmethod
   def _from_proto(cls, pb):
@@ -80,9 +88,11 @@ class AutotuneAlgorithm(enum.Enum):
       return cls.MAX_PARALLELISM
     if pb == model_pb2.AutotuneAlgorithm.STAGE_BASED:
       return cls.STAGE_BASED
+    if pb == model_pb2.AutotuneAlgorithm.REGRESSION:
+      return cls.REGRESSION
     raise ValueError(
         f"Invalid `pb.` Supported values include `DEFAULT`, `HILL_CLIMB`, "
-        f"`GRADIENT_DESCENT` and `STAGE_BASED`. Got {pb}.")
+        f"`GRADIENT_DESCENT`, `STAGE_BASED` and `REGRESSION`. Got {pb}.")
 
 
 @tf_export("data.experimental.AutoShardPolicy")
@@ -370,6 +380,16 @@ class OptimizationOptions(options_lib.OptionsBase):
       ),
   )
 
+  autotune_model_path = options_lib.create_option(
+      name="autotune_model_path",
+      ty=str,
+      docstring=
+      "Path to an autotuning model snapshot written by a prior run of the "
+      "input pipeline. If set, the `AUTOTUNE` parallelism and prefetch buffer "
+      "sizes of the pipeline are replaced with the values autotuning settled "
+      "on, so that the pipeline does not have to rediscover them. If None, "
+      "autotuning starts from its defaults.")
+
   map_and_batch_fusion = options_lib.create_option(
       name="map_and_batch_fusion",
       ty=bool,
@@ -427,6 +447,8 @@ class OptimizationOptions(options_lib.OptionsBase):
       pb.inject_prefetch = self.inject_prefetch
     if self.seq_interleave_prefetch is not None:
       pb.seq_interleave_prefetch = self.seq_interleave_prefetch
+    if self.autotune_model_path is not None:
+      pb.autotune_model_path = self.autotune_model_path
     if self.map_and_batch_fusion is not None:
       pb.map_and_batch_fusion = self.map_and_batch_fusion
     if self.map_and_filter_fusion is not None:
@@ -454,6 +476,8 @@ class OptimizationOptions(options_lib.OptionsBase):
       self.inject_prefetch = pb.inject_prefetch
     if pb.WhichOneof("optional_seq_interleave_prefetch") is not None:
       self.seq_interleave_prefetch = pb.seq_interleave_prefetch
+    if pb.WhichOneof("optional_autotune_model_path") is not None:
+      self.autotune_model_path = pb.autotune_model_path
     if pb.WhichOneof("optional_map_and_batch_fusion") is not None:
       self.map_and_batch_fusion = pb.map_and_batch_fusion
     if pb.WhichOneof("optional_map_and_filter_fusion") is not None:
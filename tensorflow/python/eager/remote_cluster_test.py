@@ -21,12 +21,14 @@ from absl.testing import parameterized
 import numpy as np
 
 from tensorflow.core.distributed_runtime.preemption import gen_check_preemption_op
+from tensorflow.core.distributed_runtime.preemption import gen_peer_memory_checkpoint_ops
 from tensorflow.core.protobuf import cluster_pb2
 from tensorflow.core.protobuf import tensorflow_server_pb2
 from tensorflow.python import pywrap_tfe
 from tensorflow.python.eager import context
 from tensorflow.python.eager import def_function
 from tensorflow.python.eager import executor
+from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import errors
 from tensorflow.python.framework import ops
 from tensorflow.python.framework import test_util
@@ -159,6 +161,42 @@ class DynamicClusterTest(test.TestCase, parameterized.TestCase):
             b"type.googleapis.com/tensorflow.distributed_runtime.WorkerPreemption"
         ), preemption_task.encode())
 
+  def testPeerMemoryCheckpoint(self):
+    checkpoint_key = "/job:worker/task:1"
+    with ops.device(self.device_t1):
+      v = variables.Variable([1.0, 2.0])
+      step = variables.Variable(7, dtype=dtypes.int64)
+
+    # Task 2 keeps the state of task 1 in its host memory.
+    with ops.device(self.device_t2):
+      gen_peer_memory_checkpoint_ops.save_to_peer_memory(
+          tensor_names=["v", "step"],
+          tensors=[v.read_value(), step.read_value()],
+          checkpoint_key=checkpoint_key)
+
+    with ops.device(self.device_t1):
+      v.assign([0.0, 0.0])
+      step.assign(0)
+    with ops.device(self.device_t2):
+      restored_v, restored_step = (
+          gen_peer_memory_checkpoint_ops.restore_from_peer_memory(
+              tensor_names=["v", "step"],
+              dtypes=[dtypes.float32, dtypes.int64],
+              checkpoint_key=checkpoint_key))
+    with ops.device(self.device_t1):
+      v.assign(restored_v)
+      step.assign(restored_step)
+    np.testing.assert_array_equal([1.0, 2.0], v.numpy())
+    self.assertEqual(7, step.numpy())
+
+    # Without a checkpoint on the peer, the caller restores from storage.
+    with self.assertRaises(errors.NotFoundError):
+      with ops.device(self.device_t1):
+        gen_peer_memory_checkpoint_ops.restore_from_peer_memory(
+            tensor_names=["v"],
+            dtypes=[dtypes.float32],
+            checkpoint_key=checkpoint_key)
+
   @test_util.run_in_async_and_sync_mode
   def testServerAdded(self):
     """Add a server to cluster, and run remote ops on it."""
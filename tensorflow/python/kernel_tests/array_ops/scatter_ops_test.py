@@ -18,7 +18,6 @@ import numpy as np
 
 from tensorflow.python.framework import constant_op
 from tensorflow.python.framework import dtypes
-from tensorflow.python.framework import errors
 from tensorflow.python.framework import test_util
 from tensorflow.python.ops import ref_variable
 from tensorflow.python.ops import state_ops
@@ -339,19 +338,17 @@ class ScatterTest(test.TestCase):
         indices = np.array([2, 0, 6])
         self.evaluate(op(ref, indices, updates))
 
-  @test_util.run_v1_only("ResrouceVariable has deterministic scatter "
-                         "implementation")
+  @test_util.run_v1_only("Tests the scatter ops with ref inputs")
   @test_util.run_cuda_only
-  def testDeterminismExceptionThrowing(self):
-    v = ref_variable.RefVariable(np.array([1., 2., 3.]))
-    indices = np.array([0, 0, 0])
-    updates = np.array([-3, -4, -5]).astype(np.float32)
-    with test_util.deterministic_ops():
-      with self.assertRaisesRegex(
-          errors.UnimplementedError,
-          "Determinism is not yet supported in GPU implementation of Scatter "
-          "ops"):
-        self.evaluate(state_ops.scatter_update(v, indices, updates))
+  def testDeterministicScatter(self):
+    updates = np.array([-3, -4, -5, 7]).astype(np.float32)
+    indices = np.array([0, 2, 0, 0])
+    for op, expected in ((state_ops.scatter_update, [7., 2., -4.]),
+                         (state_ops.scatter_add, [0., 2., -1.])):
+      with test_util.deterministic_ops():
+        v = ref_variable.RefVariable(np.array([1., 2., 3.]).astype(np.float32))
+        self.evaluate(v.initializer)
+        self.assertAllEqual(self.evaluate(op(v, indices, updates)), expected)
 
 
 
@@ -166,6 +166,18 @@ class UniqueTest(test.TestCase):
     self.assertAllEqual(tf_y, true_y)
     self.assertAllEqual(tf_idx, true_idx)
 
+  def testLargeOrderedByAppearance(self):
+    # Large integer inputs are uniquified in parallel.
+    for dtype in [np.int32, np.int64]:
+      with self.subTest(dtype=dtype):
+        x = np.random.randint(-1000, high=100000, size=300000).astype(dtype)
+        _, first = np.unique(x, return_index=True)
+        true_y = x[np.sort(first)]
+        y, idx = array_ops.unique(x)
+        tf_y, tf_idx = self.evaluate([y, idx])
+        self.assertAllEqual(tf_y, true_y)
+        self.assertAllEqual(tf_y[tf_idx], x)
+
 
 class UniqueWithCountsTest(test.TestCase):
 
@@ -313,6 +325,16 @@ class UniqueWithCountsTest(test.TestCase):
     self.assertAllEqual(tf_idx, true_idx)
     self.assertAllEqual(tf_count, true_count)
 
+  def testLargeOrderedByAppearance(self):
+    x = np.random.randint(0, high=50000, size=300000)
+    _, first, true_count = np.unique(x, return_index=True, return_counts=True)
+    order = np.argsort(first)
+    y, idx, count = array_ops.unique_with_counts(x)
+    tf_y, tf_idx, tf_count = self.evaluate([y, idx, count])
+    self.assertAllEqual(tf_y, x[first[order]])
+    self.assertAllEqual(tf_y[tf_idx], x)
+    self.assertAllEqual(tf_count, true_count[order])
+
 
 if __name__ == '__main__':
   test.main()
@@ -615,6 +615,113 @@ class AllReduceWithSubdivisionsTest(test.TestCase, parameterized.TestCase):
       self.assertAllClose(result, [2.], rtol=1e-5, atol=1e-5)
 
 
+@combinations.generate(
+    combinations.times(
+        combinations.combine(mode='eager', bucket_bytes=[0, 4, 1 << 20]),
+        device_combination))
+class BucketedAllReduceTest(test.TestCase, parameterized.TestCase):
+
+  def setUp(self):
+    _setup_context()
+    super().setUp()
+
+  def testReduce(self, device, communication, bucket_bytes):
+    dev0 = '/device:%s:0' % device
+    dev1 = '/device:%s:1' % device
+    values = [[1.], [2., 3.], [4., 5., 6.]]
+
+    @def_function.function
+    def run_all_reduce():
+      # The members of a bucket must not be ordered with respect to each
+      # other, so no ordering token is passed.
+      results = []
+      for dev in [dev0, dev1]:
+        with ops.device(dev):
+          for i, value in enumerate(values):
+            results.append(
+                CollectiveOpsV2.all_reduce(
+                    constant_op.constant(value),
+                    group_size=2,
+                    group_key=1,
+                    instance_key=10 + i,
+                    communication_hint=communication,
+                    bucket_key=10,
+                    bucket_size=len(values),
+                    bucket_bytes=bucket_bytes))
+      return results
+
+    results = run_all_reduce()
+    for i, result in enumerate(results):
+      expected = [2 * v for v in values[i % len(values)]]
+      self.assertAllClose(result, expected, rtol=1e-5, atol=1e-5)
+
+
+@combinations.generate(
+    combinations.times(
+        combinations.combine(
+            mode='eager',
+            compression=['bf16', 'fp16'],
+            error_feedback=[False, True]), device_combination))
+class CompressedAllReduceTest(test.TestCase, parameterized.TestCase):
+
+  def setUp(self):
+    _setup_context()
+    super().setUp()
+
+  def testReduce(self, device, communication, compression, error_feedback):
+    dev0 = '/device:%s:0' % device
+    dev1 = '/device:%s:1' % device
+    # Small integers survive the compression exactly.
+    values = [float(i) for i in range(64)]
+
+    @def_function.function
+    def run_all_reduce():
+      results = []
+      for dev in [dev0, dev1]:
+        with ops.device(dev):
+          results.append(
+              CollectiveOpsV2.all_reduce(
+                  constant_op.constant(values),
+                  group_size=2,
+                  group_key=1,
+                  instance_key=1,
+                  communication_hint=communication,
+                  compression=compression,
+                  compression_error_feedback=error_feedback))
+      return results
+
+    for _ in range(2):
+      for result in run_all_reduce():
+        self.assertAllEqual(result, [2 * v for v in values])
+
+  def testReplicasAgree(self, device, communication, compression,
+                        error_feedback):
+    dev0 = '/device:%s:0' % device
+    dev1 = '/device:%s:1' % device
+    # Values that the compression rounds.
+    values = [1. + i / 1000. for i in range(64)]
+
+    @def_function.function
+    def run_all_reduce():
+      results = []
+      for dev in [dev0, dev1]:
+        with ops.device(dev):
+          results.append(
+              CollectiveOpsV2.all_reduce(
+                  constant_op.constant(values),
+                  group_size=2,
+                  group_key=1,
+                  instance_key=1,
+                  communication_hint=communication,
+                  compression=compression,
+                  compression_error_feedback=error_feedback))
+      return results
+
+    result0, result1 = run_all_reduce()
+    self.assertAllEqual(result0, result1)
+    self.assertAllClose(result0, [2 * v for v in values], rtol=1e-2, atol=1e-2)
+
+
 @combinations.generate(
     combinations.combine(required_physical_gpus=2, mode='eager'))
 class XlaTest(test.TestCase, parameterized.TestCase):
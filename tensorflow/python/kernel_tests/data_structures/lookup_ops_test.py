@@ -3825,6 +3825,36 @@ class MutableHashTableOpTest(test.TestCase):
     result = self.evaluate(output)
     self.assertAllEqual([3, 1, -1], result)
 
+  def testMutableHashTableLargeBatch(self, is_anonymous):
+    if is_anonymous and not tf2.enabled():
+      self.skipTest(SKIP_ANONYMOUS_IN_TF1_REASON)
+    # Large enough for the batches to be split across threads, with every
+    # key inserted twice.
+    num_keys = 50000
+    keys = np.arange(2 * num_keys, dtype=np.int64) % num_keys
+    values = np.arange(2 * num_keys, dtype=np.int64)
+    table = lookup_ops.MutableHashTable(
+        dtypes.int64,
+        dtypes.int64,
+        -1,
+        experimental_is_anonymous=is_anonymous)
+    self.evaluate(table.insert(keys, values))
+    self.assertAllEqual(num_keys, self.evaluate(table.size()))
+
+    self.evaluate(table.remove(np.arange(0, num_keys, 2, dtype=np.int64)))
+    self.assertAllEqual(num_keys // 2, self.evaluate(table.size()))
+
+    query = np.arange(num_keys + 1, dtype=np.int64)
+    expected = np.where(query % 2 == 1, query + num_keys, -1)
+    expected[-1] = -1
+    self.assertAllEqual(expected, self.evaluate(table.lookup(query)))
+
+    exported_keys, exported_values = self.evaluate(table.export())
+    order = np.argsort(exported_keys)
+    self.assertAllEqual(np.arange(1, num_keys, 2), exported_keys[order])
+    self.assertAllEqual(
+        np.arange(1, num_keys, 2) + num_keys, exported_values[order])
+
   def testMutableHashTableFindHighRank(self, is_anonymous):
     if is_anonymous and not tf2.enabled():
       self.skipTest(SKIP_ANONYMOUS_IN_TF1_REASON)
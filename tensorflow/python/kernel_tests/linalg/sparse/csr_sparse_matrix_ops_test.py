@@ -563,6 +563,31 @@ class CSRSparseMatrixOpsTest(test.TestCase, parameterized.TestCase):
       expected_c_value = a_sparse_mat.dot(b)
       self.assertAllClose(expected_c_value, c_value)
 
+  @test_util.run_in_graph_and_eager_modes
+  def testSparseMatrixMatMulSkewedRows(self):
+    # A few rows hold most of the nonzeros, and many rows are empty, so that
+    # the work is split unevenly across rows.
+    rng = np.random.RandomState(0)
+    a_mats = np.zeros([3, 300, 40], dtype=np.float32)
+    a_mats[:, :4, :] = rng.randn(3, 4, 40)
+    a_mats[:, 100:200:7, :3] = rng.randn(3, 15, 3)
+    for num_cols in [1, 33]:
+      b_mats = rng.randn(3, 40, num_cols).astype(np.float32)
+      a_sm = dense_to_csr_sparse_matrix(a_mats)
+      c = sparse_csr_matrix_ops.sparse_matrix_mat_mul(a_sm, b_mats)
+      self.assertAllClose(
+          np.matmul(a_mats, b_mats), self.evaluate(c), rtol=1e-5, atol=1e-5)
+
+      # The transposed product splits the rows of a the same way.
+      b_mats = rng.randn(3, 300, num_cols).astype(np.float32)
+      c = sparse_csr_matrix_ops.sparse_matrix_mat_mul(
+          a_sm, b_mats, transpose_a=True)
+      self.assertAllClose(
+          np.matmul(np.transpose(a_mats, [0, 2, 1]), b_mats),
+          self.evaluate(c),
+          rtol=1e-5,
+          atol=1e-5)
+
   @test_util.run_in_graph_and_eager_modes
   def testSparseMatrixMatMulConjugateOutput(self):
     for shapes in [[(5, 6), (6, 1)], [(5, 6), (6, 2)]]:
@@ -1523,6 +1548,45 @@ class CSRSparseMatrixOpsBenchmark(test.Benchmark):
                 },
                 min_iters=10)
 
+  def benchmark_sparse_matrix_mat_mul_power_law_cpu(self):
+    # The row degrees of graphs such as social networks or web links follow a
+    # power law: a few rows hold a large share of the nonzeros.
+    num_rows = 100000
+    seed = 42
+    rng = np.random.RandomState(seed)
+    degrees = np.minimum(rng.zipf(1.8, size=num_rows), num_rows)
+    rows = np.repeat(np.arange(num_rows), degrees)
+    cols = rng.randint(num_rows, size=len(rows))
+    w_np = sparse.coo_matrix(
+        (np.ones(len(rows), dtype=np.float32), (rows, cols)),
+        shape=[num_rows, num_rows]).tocsr().tocoo()
+
+    for num_rhs_cols in [1, 64]:
+      for num_threads in [1, 4, 8]:
+        with ops.Graph().as_default(), ops.device(CPU):
+          random_seed.set_random_seed(seed)
+          x = random_ops.random_normal([num_rows, num_rhs_cols],
+                                       dtype=dtypes.float32)
+          w_st = sparse_tensor.SparseTensor(
+              np.stack([w_np.row, w_np.col], axis=1), w_np.data, w_np.shape)
+          w_sm = sparse_csr_matrix_ops.sparse_tensor_to_csr_sparse_matrix(
+              w_st.indices, w_st.values, w_st.dense_shape)
+          xw = sparse_csr_matrix_ops.sparse_matrix_mat_mul(w_sm, x)
+
+          with session.Session(
+              config=config_pb2.ConfigProto(
+                  intra_op_parallelism_threads=num_threads)) as sess:
+            self.run_op_benchmark(
+                sess,
+                xw.op,
+                name="mat_mul_cpu_power_law_W_%d_cols_%d_threads_%d" %
+                (num_rows, num_rhs_cols, num_threads),
+                extras={
+                    "num_nonzero": w_np.nnz,
+                    "max_row_degree": int(np.max(degrees)),
+                },
+                min_iters=10)
+
   def benchmark_sparse_matrix_sparse_matmul(self):
     density = 0.05
     # pylint: disable=g-long-lambda
@@ -858,6 +858,45 @@ class EmbeddingLookupSparseTest(test.TestCase, parameterized.TestCase):
       )
     self.assertLess(err, 1e-5 if dtype == dtypes.float64 else 2e-3)
 
+  @parameterized.parameters(
+      itertools.product(["sum", "mean", "sqrtn"], [True, False], [None, 2.0])
+  )
+  @test_util.run_deprecated_v1
+  def testFusedEmbeddingLookupSparse(self, combiner, ignore_weights, max_norm):
+    vocab_size = 13
+    batch_size = 10
+    sp_ids, sp_weights, _, _, _ = self._RandomIdsAndWeights(
+        batch_size, vocab_size
+    )
+    if ignore_weights:
+      sp_weights = None
+    # Large enough for some rows to be clipped by max_norm.
+    params = constant_op.constant(
+        3 * np.random.rand(vocab_size, 2, 3), dtype=dtypes.float32
+    )
+
+    with self.cached_session():
+      expected = embedding_ops.embedding_lookup_sparse(
+          params, sp_ids, sp_weights, combiner=combiner, max_norm=max_norm
+      )
+      with forward_compat.forward_compatibility_horizon(2024, 4, 16):
+        fused = embedding_ops.embedding_lookup_sparse(
+            params, sp_ids, sp_weights, combiner=combiner, max_norm=max_norm
+        )
+      self.assertEqual(fused.op.type, "FusedEmbeddingLookupSparse")
+      self.assertAllClose(*self.evaluate([expected, fused]))
+
+      xs = [params] if ignore_weights else [params, sp_weights.values]
+      expected_grads = gradients.gradients(expected, xs)
+      fused_grads = gradients.gradients(fused, xs)
+      for expected_grad, fused_grad in zip(expected_grads, fused_grads):
+        self.assertAllClose(
+            *self.evaluate([
+                ops.convert_to_tensor(expected_grad),
+                ops.convert_to_tensor(fused_grad),
+            ])
+        )
+
   @parameterized.parameters(itertools.product([True, False], [True, False]))
   @test_util.run_deprecated_v1
   def testIncompatibleShapes(self, ragged, allow_fast_lookup):
@@ -988,6 +988,37 @@ class SparseCrossHashedOpTest(BaseSparseCrossOpTest):
       all_values_are_different = len(out.values) == len(set(out.values))
       self.assertTrue(all_values_are_different)
 
+  def test_hashed_matches_single_crosses(self):
+    """Tests that every cross of a batch hashes like a cross on its own."""
+    fc1 = ['FC1-F1', 'FC1-F2']
+    fc3 = ['FC3-F1', 'FC3-F2']
+
+    def cross(inputs):
+      inds, vals, shapes = gen_sparse_ops.sparse_cross_hashed(
+          indices=[inp.indices for inp in inputs],
+          values=[inp.values for inp in inputs],
+          shapes=[inp.dense_shape for inp in inputs],
+          dense_inputs=[],
+          num_buckets=0,
+          salt=[137, 173],
+          strong_hash=False)
+      return self.evaluate(sparse_tensor.SparseTensor(inds, vals, shapes))
+
+    with self.cached_session():
+      out = cross([
+          self._sparse_tensor([fc1]),
+          self._sparse_tensor([['FC2-F1']]),
+          self._sparse_tensor([fc3])
+      ])
+      # One batch per cross, in the order the crosses are expected in.
+      singles = cross([
+          self._sparse_tensor([[f] for f in fc1 for _ in fc3]),
+          self._sparse_tensor([['FC2-F1']] * 4),
+          self._sparse_tensor([[f] for _ in fc1 for f in fc3])
+      ])
+      self.assertAllEqual([[0, i] for i in range(4)], out.indices)
+      self.assertAllEqual(singles.values, out.values)
+
   def test_hashed_different_salt(self):
     sp_inp_1 = self._sparse_tensor(
         [['batch1-FC1-F1', 'batch1-FC1-F2', 'batch1-FC1-F3']])
@@ -1890,5 +1890,92 @@ class ResourceVariableOpsTest(test_util.TensorFlowTestCase,
         )
         self.evaluate(result)
 
+
+class TieredEmbeddingVarTest(test_util.TensorFlowTestCase):
+
+  def _create(self, value, cache_capacity, backing_file=""):
+    kwargs = {}
+    if context.executing_eagerly():
+      kwargs["shared_name"] = context.anonymous_name()
+    handle = resource_variable_ops.tiered_embedding_var_handle_op(
+        dtype=dtypes.float32, shape=value.shape, **kwargs)
+    self.evaluate(
+        resource_variable_ops.initialize_tiered_embedding_var(
+            handle, value, cache_capacity=cache_capacity,
+            backing_file=backing_file))
+    return handle
+
+  @test_util.run_in_graph_and_eager_modes
+  def testGatherAndScatter(self):
+    rng = np.random.RandomState(0)
+    expected = rng.uniform(size=[20, 2, 3]).astype(np.float32)
+    handle = self._create(expected, cache_capacity=5)
+    # Batches of up to 5 distinct ids keep evicting rows, including modified
+    # ones.
+    for step in range(30):
+      ids = rng.choice(rng.choice(20, size=5, replace=False), size=6)
+      self.assertAllClose(
+          self.evaluate(
+              resource_variable_ops.tiered_embedding_gather(
+                  handle, ids, dtype=dtypes.float32)), expected[ids])
+      updates = rng.uniform(size=[len(ids), 2, 3]).astype(np.float32)
+      if step % 2:
+        self.evaluate(
+            resource_variable_ops.tiered_embedding_scatter_add(
+                handle, ids, updates))
+        np.add.at(expected, ids, updates)
+      else:
+        # Without duplicates, so that the result does not depend on the
+        # order of the updates.
+        ids, first = np.unique(ids, return_index=True)
+        updates = updates[first]
+        self.evaluate(
+            resource_variable_ops.tiered_embedding_scatter_update(
+                handle, ids, updates))
+        expected[ids] = updates
+    ids = np.array([[0, 1, 2, 3, 4]])
+    self.assertAllClose(
+        self.evaluate(
+            resource_variable_ops.tiered_embedding_gather(
+                handle, ids, dtype=dtypes.float32)), expected[ids])
+
+  @test_util.run_in_graph_and_eager_modes
+  def testFileBacked(self):
+    value = np.arange(4000, dtype=np.float32).reshape([1000, 4])
+    handle = self._create(
+        value, cache_capacity=8,
+        backing_file=os.path.join(self.get_temp_dir(), "embeddings"))
+    self.evaluate(
+        resource_variable_ops.tiered_embedding_prefetch(handle, [999, 3]))
+    self.evaluate(
+        resource_variable_ops.tiered_embedding_scatter_add(
+            handle, [999], np.ones([1, 4], np.float32)))
+    for start in range(0, 40, 8):
+      self.evaluate(
+          resource_variable_ops.tiered_embedding_gather(
+              handle, np.arange(start, start + 8), dtype=dtypes.float32))
+    self.assertAllEqual(
+        self.evaluate(
+            resource_variable_ops.tiered_embedding_gather(
+                handle, [3, 999], dtype=dtypes.float32)),
+        value[[3, 999]] + [[0], [1]])
+
+  @test_util.run_in_graph_and_eager_modes
+  def testErrors(self):
+    handle = self._create(np.zeros([10, 2], np.float32), cache_capacity=2)
+    with self.assertRaises(errors.ResourceExhaustedError):
+      self.evaluate(
+          resource_variable_ops.tiered_embedding_gather(
+              handle, [1, 2, 3], dtype=dtypes.float32))
+    with self.assertRaises(errors.InvalidArgumentError):
+      self.evaluate(
+          resource_variable_ops.tiered_embedding_gather(
+              handle, [10], dtype=dtypes.float32))
+    with self.assertRaises(errors.FailedPreconditionError):
+      self.evaluate(
+          resource_variable_ops.initialize_tiered_embedding_var(
+              handle, np.zeros([10, 2], np.float32), cache_capacity=2))
+
+
 if __name__ == "__main__":
   test.main()
@@ -102,6 +102,11 @@ def all_reduce_v2(t,
                   timeout=0,
                   ordering_token=None,
                   max_subdivs_per_device=-1,
+                  bucket_key=0,
+                  bucket_size=0,
+                  bucket_bytes=0,
+                  compression='none',
+                  compression_error_feedback=False,
                   name=None):
   """Reduces tensors collectively, across devices.
 
@@ -117,8 +122,10 @@ def all_reduce_v2(t,
     final_op: string naming the unary Op to be applied to each fully reduced
       value.  Can be 'Id' for no operation.
     communication_hint: preferred collective communication.  The implementation
-      may fall back to another mechanism.  Options include `auto`, `ring`, and
-      `nccl`.
+      may fall back to another mechanism.  Options include `auto`, `ring`,
+      `nccl` and `hierarchical`. `hierarchical` reduces within each task
+      first, so that only 1/n of the tensor crosses tasks per device, and
+      requires every task to have the same number of devices.
     timeout: a float. If set to a non zero, set a completion timeout to detect
       staleness.  If the timer goes off, a DeadlineExceededError is raised.  The
       timeout value in seconds. This feature is experimental.
@@ -132,6 +139,23 @@ def all_reduce_v2(t,
       parallelize processing of each per-device tensor. Setting to -1 disables
       subdivision and reverts to previous behavior of not sub-dividing tensor.
       Setting to 0 uses sytem defaults.
+    bucket_key: the `instance_key` of the first reduction of the bucket this
+      reduction belongs to. The reductions of a bucket use consecutive
+      instance keys starting at `bucket_key`, and must not depend on each
+      other, e.g. through `ordering_token`.
+    bucket_size: int, the number of reductions in the bucket. Values smaller
+      than 2 disable bucketing. When enabled, the runtime fuses the
+      reductions of the bucket into few larger ones as their inputs become
+      ready.
+    bucket_bytes: int, the number of input bytes after which a fused
+      reduction is launched without waiting for the rest of the bucket. 0
+      fuses the whole bucket into one reduction.
+    compression: one of `none`, `bf16` and `fp16`. For float32 tensors, the
+      ring implementation casts the chunks it transfers to bfloat16 or
+      float16, halving the bytes on the wire at the cost of precision.
+    compression_error_feedback: bool. If true, the rounding error of the
+      compressed partial sums is added back on the next execution of the
+      same `instance_key`. Only applies to `Add` reductions.
     name: name of the Op.
 
   Returns:
@@ -154,6 +178,11 @@ def all_reduce_v2(t,
       is_stateless=False,
       ordering_token=ordering_token,
       max_subdivs_per_device=max_subdivs_per_device,
+      bucket_key=bucket_key,
+      bucket_size=bucket_size,
+      bucket_bytes=bucket_bytes,
+      compression=compression,
+      compression_error_feedback=compression_error_feedback,
       name=name)
 
 
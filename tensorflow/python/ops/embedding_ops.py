@@ -25,9 +25,11 @@ from tensorflow.python.framework import tensor_shape
 from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import array_ops_stack
 from tensorflow.python.ops import clip_ops
+from tensorflow.python.ops import control_flow_util
 # Imports gradient definitions.
 from tensorflow.python.ops import data_flow_grad  # pylint: disable=unused-import
 from tensorflow.python.ops import data_flow_ops
+from tensorflow.python.ops import gen_math_ops
 from tensorflow.python.ops import math_ops
 from tensorflow.python.ops import resource_variable_ops
 from tensorflow.python.ops import sparse_ops
@@ -1052,6 +1054,40 @@ def embedding_lookup_sparse_impl(
       params[0], (core.Tensor, composite_tensor.CompositeTensor)
   ):
     params = [ops.convert_to_tensor(params[0], name="params")]
+  # Gather and combine the embeddings in a single kernel when there is a
+  # single table it supports, instead of materializing the gathered rows. The
+  # kernel has no XLA lowering.
+  if (
+      compat.forward_compatible(2024, 4, 15)
+      and not control_flow_util.GraphOrParentsInXlaContext(
+          ops.get_default_graph())
+      and len(params) == 1
+      and not isinstance(params[0], composite_tensor.CompositeTensor)
+      and params[0].device == segment_ids.device
+      and params[0].dtype in (dtypes.bfloat16, dtypes.float16, dtypes.float32)
+      and (max_norm is None or
+           (isinstance(max_norm, (int, float)) and max_norm > 0))
+  ):
+    embeddings = params[0]
+    if isinstance(embeddings, resource_variable_ops.BaseResourceVariable):
+      embeddings = embeddings.read_value_no_copy()
+    if ignore_weights:
+      weights = array_ops.zeros([0], dtype=dtypes.float32)
+    else:
+      weights = math_ops.cast(sp_weights.values, dtypes.float32)
+    # Like the segment reductions below, produce one row per segment up to
+    # the largest segment id.
+    num_segments = math_ops.maximum(math_ops.reduce_max(segment_ids) + 1, 0)
+    return gen_math_ops.fused_embedding_lookup_sparse(
+        embeddings,
+        ids,
+        segment_ids,
+        num_segments,
+        weights,
+        combiner=combiner,
+        max_norm=-1.0 if max_norm is None else float(max_norm),
+        name=name,
+    )
   # Note that if the params are on a different device (e.g., CPU), we must use
   # embedding_lookup() so that the gather operation is colocated with them.
   if (
@@ -453,6 +453,83 @@ def _SparseSegmentSqrtNWithNumSegmentsGrad(op: ops.Operation, grad):
                                               dim0), None, None, None)
 
 
+@ops.RegisterGradient("FusedEmbeddingLookupSparse")
+def _FusedEmbeddingLookupSparseGrad(op: ops.Operation, grad):
+  """Gradient for FusedEmbeddingLookupSparse."""
+  params, ids, segment_ids, num_segments, weights = op.inputs
+  combiner = op.get_attr("combiner")
+  max_norm = op.get_attr("max_norm")
+  num_ids = array_ops.size(ids)
+  # Empty weights stand for weights of 1.
+  all_weights = array_ops.pad(
+      weights, [[0, num_ids - array_ops.size(weights)]], constant_values=1)
+
+  params_shape = array_ops.shape(params)
+  row_size = math_ops.reduce_prod(params_shape[1:])
+  num_segments = math_ops.cast(num_segments, dtypes.int32)
+  rows = math_ops.cast(array_ops.gather(params, ids), dtypes.float32)
+  rows = array_ops.reshape(rows, [num_ids, row_size])
+  grad = array_ops.reshape(math_ops.cast(grad, dtypes.float32),
+                           [num_segments, row_size])
+  if max_norm > 0:
+    norms = math_ops.sqrt(
+        math_ops.reduce_sum(rows * rows, axis=1, keepdims=True))
+    clipped = norms > max_norm
+    clip_scales = array_ops.where_v2(clipped, max_norm / norms, 1.0)
+    clipped_rows = rows * clip_scales
+  else:
+    clipped_rows = rows
+
+  if combiner == b"sum":
+    inverse_divisors = array_ops.ones([num_ids])
+  else:
+    if combiner == b"mean":
+      divisors = math_ops.unsorted_segment_sum(all_weights, segment_ids,
+                                               num_segments)
+    else:
+      divisors = math_ops.sqrt(
+          math_ops.unsorted_segment_sum(all_weights * all_weights,
+                                        segment_ids, num_segments))
+    inverse_divisors = array_ops.gather(
+        math_ops.div_no_nan(1.0, divisors), segment_ids)
+  # The gradient with respect to weights[j] * clip(params[ids[j]]).
+  grads = (array_ops.gather(grad, segment_ids) *
+           array_ops.expand_dims(inverse_divisors, 1))
+
+  params_grads = grads * array_ops.expand_dims(all_weights, 1)
+  if max_norm > 0:
+    # Clipping scales a row x to max_norm * x / |x|, whose Jacobian is
+    # max_norm / |x| * (I - x x^T / |x|^2).
+    projections = math_ops.reduce_sum(params_grads * rows, axis=1,
+                                      keepdims=True)
+    params_grads = array_ops.where_v2(
+        clipped,
+        clip_scales * (params_grads - rows * projections / (norms * norms)),
+        params_grads)
+  params_grads = math_ops.cast(
+      array_ops.reshape(
+          params_grads, array_ops.concat([[num_ids], params_shape[1:]], 0)),
+      params.dtype)
+
+  weights_grads = math_ops.reduce_sum(grads * clipped_rows, axis=1)
+  if combiner != b"sum":
+    # The divisors depend on the weights as well.
+    outputs = array_ops.reshape(
+        math_ops.cast(op.outputs[0], dtypes.float32),
+        [num_segments, row_size])
+    output_grads = math_ops.reduce_sum(
+        array_ops.gather(grad * outputs, segment_ids), axis=1)
+    if combiner == b"mean":
+      weights_grads -= output_grads * inverse_divisors
+    else:
+      weights_grads -= (
+          output_grads * all_weights * inverse_divisors * inverse_divisors)
+  weights_grads = weights_grads[:array_ops.size(weights)]
+
+  return (indexed_slices_lib.IndexedSlices(params_grads, ids, params_shape),
+          None, None, None, weights_grads)
+
+
 def _SegmentMinOrMaxGrad(op: ops.Operation, grad):
   """ Gradient for SegmentMin and SegmentMax. """
   zeros = array_ops.zeros_like(op.inputs[0], dtype=op.inputs[0].dtype)
@@ -19,6 +19,7 @@ import threading
 
 import numpy as np
 
+from tensorflow.python.eager import context
 from tensorflow.python.eager import def_function
 from tensorflow.python.framework import constant_op
 from tensorflow.python.framework import dtypes
@@ -507,5 +508,108 @@ class TrainingOpsTest(TensorFlowTestCase):
     thread2.join()
 
 
+  def _fusedSparseAdagradNumpy(self, var, accum, lr, epsilon, grad, indices):
+    var, accum = var.copy(), accum.copy()
+    ids, inverse = np.unique(indices, return_inverse=True)
+    summed = np.zeros((len(ids),) + grad.shape[1:], dtype=grad.dtype)
+    np.add.at(summed, inverse, grad)
+    accum[ids] += summed * summed
+    var[ids] -= lr * summed / (np.sqrt(accum[ids]) + epsilon)
+    return var, accum
+
+  @test_util.run_in_graph_and_eager_modes
+  def testResourceFusedSparseApplyAdagrad(self):
+    for dtype, index_type in itertools.product([np.float32, np.float64],
+                                               [np.int32, np.int64]):
+      x = np.arange(30).reshape([10, 3]).astype(dtype)
+      y = np.arange(1, 31).reshape([10, 3]).astype(dtype)
+      lr = np.array(0.01, dtype=dtype)
+      epsilon = np.array(1e-8, dtype=dtype)
+      indices = np.array([7, 2, 7, 0, 7, 2]).astype(index_type)
+      grad = np.arange(18).reshape([6, 3]).astype(dtype)
+      var = resource_variable_ops.ResourceVariable(x)
+      accum = resource_variable_ops.ResourceVariable(y)
+      self.evaluate(variables.global_variables_initializer())
+
+      self.evaluate(
+          gen_training_ops.resource_fused_sparse_apply_adagrad(
+              var.handle, accum.handle, lr, epsilon, grad, indices))
+      expected_var, expected_accum = self._fusedSparseAdagradNumpy(
+          x, y, lr, epsilon, grad, indices)
+      self.assertAllCloseAccordingToType(expected_var, self.evaluate(var))
+      self.assertAllCloseAccordingToType(expected_accum, self.evaluate(accum))
+
+  @test_util.run_in_graph_and_eager_modes
+  def testResourceFusedSparseApplyAdamIsLazy(self):
+    dtype = np.float32
+    x = np.arange(12).reshape([4, 3]).astype(dtype)
+    m0 = np.arange(1, 13).reshape([4, 3]).astype(dtype)
+    v0 = np.arange(13, 25).reshape([4, 3]).astype(dtype)
+    indices = np.array([3, 1, 3])
+    grad = np.arange(9).reshape([3, 3]).astype(dtype)
+    beta1, beta2 = np.array(0.9, dtype), np.array(0.999, dtype)
+    lr, epsilon = np.array(0.001, dtype), np.array(1e-8, dtype)
+    var = resource_variable_ops.ResourceVariable(x)
+    m = resource_variable_ops.ResourceVariable(m0)
+    v = resource_variable_ops.ResourceVariable(v0)
+    self.evaluate(variables.global_variables_initializer())
+
+    self.evaluate(
+        gen_training_ops.resource_fused_sparse_apply_adam(
+            var.handle, m.handle, v.handle, beta1, beta2, lr, beta1, beta2,
+            epsilon, grad, indices))
+    summed = np.stack([grad[1], grad[0] + grad[2]])
+    expected_var, expected_m, expected_v = x.copy(), m0.copy(), v0.copy()
+    (expected_var[[1, 3]], expected_m[[1, 3]],
+     expected_v[[1, 3]]) = self._adamUpdateNumpy(
+         x[[1, 3]], summed, 1, m0[[1, 3]], v0[[1, 3]], lr, beta1, beta2,
+         epsilon)
+    # Rows 0 and 2 have no gradient, so neither they nor their moments change.
+    self.assertAllClose(expected_var, self.evaluate(var))
+    self.assertAllClose(expected_m, self.evaluate(m))
+    self.assertAllClose(expected_v, self.evaluate(v))
+
+  @test_util.run_in_graph_and_eager_modes
+  def testResourceFusedSparseApplyAdagradOnTieredEmbeddings(self):
+    dtype = np.float32
+    x = np.arange(30).reshape([10, 3]).astype(dtype)
+    y = np.arange(1, 31).reshape([10, 3]).astype(dtype)
+    lr = np.array(0.01, dtype=dtype)
+    epsilon = np.array(1e-8, dtype=dtype)
+    handles = []
+    for value in (x, y):
+      kwargs = {}
+      if context.executing_eagerly():
+        kwargs['shared_name'] = context.anonymous_name()
+      handle = resource_variable_ops.tiered_embedding_var_handle_op(
+          dtype=dtypes.float32, shape=value.shape, **kwargs)
+      self.evaluate(
+          resource_variable_ops.initialize_tiered_embedding_var(
+              handle, value, cache_capacity=2))
+      handles.append(handle)
+
+    expected_var, expected_accum = x, y
+    # Each batch evicts the rows of the previous one, modified.
+    for indices in ([7, 2, 7], [0, 5], [2, 7, 2]):
+      grad = np.arange(len(indices) * 3).reshape([-1, 3]).astype(dtype)
+      self.evaluate(
+          gen_training_ops.resource_fused_sparse_apply_adagrad(
+              handles[0], handles[1], lr, epsilon, grad, indices))
+      expected_var, expected_accum = self._fusedSparseAdagradNumpy(
+          expected_var, expected_accum, lr, epsilon, grad,
+          np.array(indices))
+    for ids in ([0, 1], [2, 3], [4, 5], [6, 7], [8, 9]):
+      self.assertAllClose(
+          expected_var[ids],
+          self.evaluate(
+              resource_variable_ops.tiered_embedding_gather(
+                  handles[0], ids, dtype=dtypes.float32)))
+      self.assertAllClose(
+          expected_accum[ids],
+          self.evaluate(
+              resource_variable_ops.tiered_embedding_gather(
+                  handles[1], ids, dtype=dtypes.float32)))
+
+
 if __name__ == '__main__':
   googletest.main()
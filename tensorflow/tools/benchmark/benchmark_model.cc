@@ -72,6 +72,8 @@ void InitializeTensor(const std::vector<float>& initialization_values,
   }
 }
 
+}  // namespace
+
 void CreateTensorsFromInputInfo(
     const std::vector<InputLayerInfo>& inputs,
     std::vector<std::pair<string, tensorflow::Tensor> >* input_tensors) {
@@ -118,6 +120,8 @@ void CreateTensorsFromInputInfo(
   }
 }
 
+namespace {
+
 Status GetOutputShapes(const std::vector<InputLayerInfo>& inputs,
                        const std::set<string>& wanted_shapes, Session* session,
                        std::unordered_map<string, TensorShape>* node_shapes) {
@@ -30,6 +30,11 @@ struct InputLayerInfo {
   std::vector<float> initialization_values;
 };
 
+// Creates the dummy input tensors described by `inputs`, keyed by name.
+void CreateTensorsFromInputInfo(
+    const std::vector<InputLayerInfo>& inputs,
+    std::vector<std::pair<string, tensorflow::Tensor> >* input_tensors);
+
 // Loads a model from disk into a new session.
 Status InitializeSession(int num_threads, const string& graph,
                          std::unique_ptr<Session>* session,
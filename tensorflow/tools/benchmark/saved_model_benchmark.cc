@@ -0,0 +1,559 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// A C++ binary to benchmark a SavedModel signature under load: it reports
+// latency percentiles, throughput, CPU time per request, and a per-op
+// breakdown from the StepStats of traced runs. The same report can be
+// produced for the classic and the TFRT session, and across TF versions.
+//
+// See README.md for usage instructions.
+
+#include "tensorflow/tools/benchmark/saved_model_benchmark.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <ctime>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/cc/saved_model/signature_constants.h"
+#include "tensorflow/cc/saved_model/tag_constants.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/public/version.h"
+#include "tensorflow/core/util/command_line_flags.h"
+#include "tensorflow/core/util/reporter.h"
+
+namespace tensorflow {
+namespace saved_model_benchmark {
+
+namespace {
+
+// Returns the latency at percentile `p` of the sorted `latencies_us`, using
+// the nearest-rank method.
+int64_t Percentile(const std::vector<int64_t>& latencies_us, double p) {
+  const int64_t rank =
+      static_cast<int64_t>(std::ceil(p / 100.0 * latencies_us.size()));
+  const int64_t index = std::min<int64_t>(
+      std::max<int64_t>(rank - 1, 0), latencies_us.size() - 1);
+  return latencies_us[index];
+}
+
+void RecordBenchmarkEntry(const string& output_prefix,
+                          const string& benchmark_name, const string& postfix,
+                          int64_t num_runs, double total_time_s,
+                          double throughput = -1.0) {
+  string name = benchmark_name;
+  if (!postfix.empty()) {
+    strings::StrAppend(&name, "_", postfix);
+  }
+  TestReporter node_reporter(output_prefix, name);
+  TF_QCHECK_OK(node_reporter.Initialize());
+  TF_QCHECK_OK(
+      node_reporter.Benchmark(num_runs, -1.0, total_time_s, throughput));
+  TF_QCHECK_OK(node_reporter.Close());
+}
+
+// Reports `result` along with the properties that identify the setup, so
+// that reports of different TF versions and runtimes can be compared.
+void RecordBenchmarkResult(const string& output_prefix,
+                           const string& benchmark_name, bool use_tfrt,
+                           const LoadOptions& options,
+                           const BenchmarkResult& result) {
+  TestReporter reporter(output_prefix, benchmark_name);
+  TF_QCHECK_OK(reporter.Initialize());
+  TF_QCHECK_OK(reporter.Benchmark(
+      result.num_requests,
+      result.cpu_time_per_request_us * result.num_requests / 1000000.0,
+      result.wall_time_s, result.throughput_qps));
+  TF_QCHECK_OK(reporter.SetProperty("tf_version", TF_VERSION_STRING));
+  TF_QCHECK_OK(reporter.SetProperty("runtime", use_tfrt ? "tfrt" : "classic"));
+  TF_QCHECK_OK(reporter.SetProperty("num_clients",
+                                    static_cast<double>(options.num_clients)));
+  TF_QCHECK_OK(reporter.SetProperty("target_qps", options.target_qps));
+  TF_QCHECK_OK(reporter.AddMetric("mean_latency_us", result.mean_latency_us));
+  TF_QCHECK_OK(reporter.AddMetric("p50_latency_us", result.p50_latency_us));
+  TF_QCHECK_OK(reporter.AddMetric("p90_latency_us", result.p90_latency_us));
+  TF_QCHECK_OK(reporter.AddMetric("p99_latency_us", result.p99_latency_us));
+  TF_QCHECK_OK(reporter.AddMetric("p999_latency_us", result.p999_latency_us));
+  TF_QCHECK_OK(reporter.AddMetric("cpu_time_per_request_us",
+                                  result.cpu_time_per_request_us));
+  TF_QCHECK_OK(reporter.Close());
+}
+
+void LogBenchmarkResult(const string& label, const BenchmarkResult& result) {
+  LOG(INFO) << label << ": " << result.num_requests << " requests in "
+            << result.wall_time_s << "s, " << result.throughput_qps
+            << " QPS, latency in us: mean " << result.mean_latency_us
+            << ", min " << result.min_latency_us << ", p50 "
+            << result.p50_latency_us << ", p90 " << result.p90_latency_us
+            << ", p99 " << result.p99_latency_us << ", p99.9 "
+            << result.p999_latency_us << ", max " << result.max_latency_us
+            << ", CPU time per request in us: "
+            << result.cpu_time_per_request_us;
+}
+
+}  // namespace
+
+Status LoadModel(const string& export_dir,
+                 const std::unordered_set<string>& tags, int num_threads,
+                 bool use_tfrt, SavedModelBundle* bundle) {
+  SessionOptions session_options;
+  ConfigProto& config = session_options.config;
+  if (num_threads > 0) {
+    config.set_intra_op_parallelism_threads(num_threads);
+    config.set_inter_op_parallelism_threads(num_threads);
+  }
+  config.mutable_experimental()->set_use_tfrt(use_tfrt);
+  return LoadSavedModel(session_options, RunOptions(), export_dir, tags,
+                        bundle);
+}
+
+Status GetSignatureInputs(
+    const SignatureDef& signature, int64_t unknown_dim_size,
+    std::vector<benchmark_model::InputLayerInfo>* inputs) {
+  // Iterate in key order so that the inputs are deterministic.
+  std::map<string, TensorInfo> sorted_inputs(signature.inputs().begin(),
+                                             signature.inputs().end());
+  for (const auto& [key, tensor_info] : sorted_inputs) {
+    if (tensor_info.name().empty()) {
+      return errors::Unimplemented("Input '", key,
+                                   "' is not a dense tensor, which is not "
+                                   "supported for synthetic inputs");
+    }
+    if (tensor_info.tensor_shape().unknown_rank()) {
+      return errors::InvalidArgument(
+          "Input '", key, "' has an unknown rank; use --recorded_inputs");
+    }
+    benchmark_model::InputLayerInfo input;
+    input.name = tensor_info.name();
+    input.data_type = tensor_info.dtype();
+    for (const auto& dim : tensor_info.tensor_shape().dim()) {
+      input.shape.AddDim(dim.size() < 0 ? unknown_dim_size : dim.size());
+    }
+    inputs->push_back(std::move(input));
+  }
+  return OkStatus();
+}
+
+std::vector<string> GetSignatureOutputs(const SignatureDef& signature) {
+  std::map<string, TensorInfo> sorted_outputs(signature.outputs().begin(),
+                                              signature.outputs().end());
+  std::vector<string> outputs;
+  for (const auto& [key, tensor_info] : sorted_outputs) {
+    outputs.push_back(tensor_info.name());
+  }
+  return outputs;
+}
+
+Status ReadRecordedInputs(
+    const SignatureDef& signature,
+    const std::vector<string>& recorded_inputs,
+    std::vector<std::pair<string, Tensor>>* input_tensors) {
+  for (const string& recorded_input : recorded_inputs) {
+    std::vector<string> key_and_path = str_util::Split(recorded_input, '=');
+    if (key_and_path.size() != 2) {
+      return errors::InvalidArgument("Expected input_key=path, got '",
+                                     recorded_input, "'");
+    }
+    const string& key = key_and_path[0];
+    auto it = signature.inputs().find(key);
+    if (it == signature.inputs().end()) {
+      return errors::NotFound("Signature has no input '", key, "'");
+    }
+    TensorProto proto;
+    Status s = ReadBinaryProto(Env::Default(), key_and_path[1], &proto);
+    if (!s.ok()) {
+      s = ReadTextProto(Env::Default(), key_and_path[1], &proto);
+    }
+    TF_RETURN_IF_ERROR(s);
+    Tensor tensor;
+    if (!tensor.FromProto(proto)) {
+      return errors::InvalidArgument("Could not parse the tensor of input '",
+                                     key, "' from ", key_and_path[1]);
+    }
+
+    const string& name = it->second.name();
+    auto feed = std::find_if(input_tensors->begin(), input_tensors->end(),
+                             [&name](const std::pair<string, Tensor>& t) {
+                               return t.first == name;
+                             });
+    if (feed != input_tensors->end()) {
+      feed->second = std::move(tensor);
+    } else {
+      input_tensors->push_back({name, std::move(tensor)});
+    }
+  }
+  return OkStatus();
+}
+
+BenchmarkResult SummarizeLatencies(std::vector<int64_t> latencies_us,
+                                   double wall_time_s, double cpu_time_s) {
+  BenchmarkResult result;
+  result.num_requests = latencies_us.size();
+  result.wall_time_s = wall_time_s;
+  if (latencies_us.empty()) return result;
+
+  std::sort(latencies_us.begin(), latencies_us.end());
+  if (wall_time_s > 0) {
+    result.throughput_qps = result.num_requests / wall_time_s;
+  }
+  result.cpu_time_per_request_us = cpu_time_s * 1000000.0 / result.num_requests;
+  double total_us = 0;
+  for (int64_t latency_us : latencies_us) total_us += latency_us;
+  result.mean_latency_us = total_us / result.num_requests;
+  result.min_latency_us = latencies_us.front();
+  result.max_latency_us = latencies_us.back();
+  result.p50_latency_us = Percentile(latencies_us, 50);
+  result.p90_latency_us = Percentile(latencies_us, 90);
+  result.p99_latency_us = Percentile(latencies_us, 99);
+  result.p999_latency_us = Percentile(latencies_us, 99.9);
+  return result;
+}
+
+Status RunLoad(Session* session,
+               const std::vector<std::pair<string, Tensor>>& inputs,
+               const std::vector<string>& outputs, const LoadOptions& options,
+               BenchmarkResult* result) {
+  Env* env = Env::Default();
+  const int num_clients = std::max(options.num_clients, 1);
+  const bool until_max_time = options.num_requests <= 0;
+  if (until_max_time && options.max_time_s <= 0) {
+    return errors::InvalidArgument(
+        "Either the number of requests or the maximum time must be set");
+  }
+
+  mutex mu;
+  std::vector<int64_t> latencies_us;
+  Status status;
+  std::atomic<bool> failed{false};
+  std::atomic<int64_t> next_request{0};
+
+  const std::clock_t start_cpu = std::clock();
+  const int64_t start_us = env->NowMicros();
+  const int64_t deadline_us =
+      options.max_time_s > 0
+          ? start_us + static_cast<int64_t>(options.max_time_s * 1000000)
+          : std::numeric_limits<int64_t>::max();
+  auto more_requests = [&](int64_t request) {
+    return !failed && (until_max_time || request < options.num_requests) &&
+           static_cast<int64_t>(env->NowMicros()) < deadline_us;
+  };
+  auto run_request = [&](int64_t scheduled_us) {
+    std::vector<Tensor> output_tensors;
+    Status s = session->Run(inputs, outputs, {}, &output_tensors);
+    const int64_t latency_us = env->NowMicros() - scheduled_us;
+    mutex_lock l(mu);
+    if (s.ok()) {
+      latencies_us.push_back(latency_us);
+    } else if (status.ok()) {
+      status = s;
+      failed = true;
+    }
+  };
+
+  {
+    thread::ThreadPool pool(env, "saved_model_benchmark", num_clients);
+    if (options.target_qps > 0) {
+      // Open loop: dispatch at the target rate, whether or not the previous
+      // requests have completed.
+      for (int64_t i = 0; more_requests(i); ++i) {
+        const int64_t scheduled_us =
+            start_us + static_cast<int64_t>(i * 1000000 / options.target_qps);
+        const int64_t now_us = env->NowMicros();
+        if (scheduled_us > now_us) {
+          env->SleepForMicroseconds(scheduled_us - now_us);
+        }
+        pool.Schedule([&run_request, scheduled_us] {
+          run_request(scheduled_us);
+        });
+      }
+    } else {
+      // Closed loop: each client issues its next request when the previous
+      // one returned.
+      for (int i = 0; i < num_clients; ++i) {
+        pool.Schedule([&] {
+          while (more_requests(next_request++)) {
+            run_request(env->NowMicros());
+          }
+        });
+      }
+    }
+    // The pool waits for all scheduled requests when it goes out of scope.
+  }
+
+  const double wall_time_s = (env->NowMicros() - start_us) / 1000000.0;
+  const double cpu_time_s =
+      static_cast<double>(std::clock() - start_cpu) / CLOCKS_PER_SEC;
+  mutex_lock l(mu);
+  TF_RETURN_IF_ERROR(status);
+  *result =
+      SummarizeLatencies(std::move(latencies_us), wall_time_s, cpu_time_s);
+  return OkStatus();
+}
+
+Status CollectOpStats(Session* session,
+                      const std::vector<std::pair<string, Tensor>>& inputs,
+                      const std::vector<string>& outputs, int num_runs,
+                      StatSummarizer* stats) {
+  RunOptions run_options;
+  run_options.set_trace_level(RunOptions::FULL_TRACE);
+  for (int i = 0; i < num_runs; ++i) {
+    std::vector<Tensor> output_tensors;
+    RunMetadata run_metadata;
+    TF_RETURN_IF_ERROR(session->Run(run_options, inputs, outputs, {},
+                                    &output_tensors, &run_metadata));
+    if (!run_metadata.has_step_stats()) {
+      return errors::Unimplemented(
+          "The session does not return StepStats for traced runs");
+    }
+    stats->ProcessStepStats(run_metadata.step_stats());
+  }
+  return OkStatus();
+}
+
+int Main(int argc, char** argv, std::function<Status()> initialize_tfrt) {
+  string saved_model_dir = "";
+  string tags_string = kSavedModelTagServe;
+  string signature_key = kDefaultServingSignatureDefKey;
+  int64_t unknown_dim_size = 1;
+  string recorded_inputs_string = "";
+  int num_clients = 1;
+  string target_qps = "0";
+  int64_t max_num_runs = 1000;
+  string max_time = "10.0";
+  int warmup_runs = 1;
+  int stat_runs = 10;
+  int num_threads = -1;
+  bool use_tfrt = false;
+  string benchmark_name = "";
+  string output_prefix = "";
+  bool show_run_order = true;
+  int run_order_limit = 0;
+  bool show_time = true;
+  int time_limit = 10;
+  bool show_memory = true;
+  int memory_limit = 10;
+  bool show_type = true;
+  bool show_summary = true;
+
+  std::vector<Flag> flag_list = {
+      Flag("saved_model_dir", &saved_model_dir, "SavedModel directory"),
+      Flag("tags", &tags_string, "comma-separated MetaGraphDef tags"),
+      Flag("signature", &signature_key, "signature to benchmark"),
+      Flag("unknown_dim_size", &unknown_dim_size,
+           "size of unknown dimensions of synthetic inputs"),
+      Flag("recorded_inputs", &recorded_inputs_string,
+           "comma-separated input_key=path pairs of TensorProto files to feed "
+           "instead of synthetic inputs"),
+      Flag("num_clients", &num_clients,
+           "number of concurrent clients (closed loop), or of dispatch threads "
+           "(open loop)"),
+      Flag("target_qps", &target_qps,
+           "if > 0, issue requests open loop at this rate"),
+      Flag("max_num_runs", &max_num_runs, "number of requests max"),
+      Flag("max_time", &max_time, "length to run max"),
+      Flag("warmup_runs", &warmup_runs, "how many runs to initialize model"),
+      Flag("stat_runs", &stat_runs,
+           "how many traced runs to collect per-op stats from"),
+      Flag("num_threads", &num_threads, "number of threads"),
+      Flag("use_tfrt", &use_tfrt, "whether to load the model with TFRT"),
+      Flag("benchmark_name", &benchmark_name, "benchmark name"),
+      Flag("output_prefix", &output_prefix, "benchmark output prefix"),
+      Flag("show_run_order", &show_run_order,
+           "whether to list stats by run order"),
+      Flag("run_order_limit", &run_order_limit,
+           "how many items to show by run order"),
+      Flag("show_time", &show_time, "whether to list stats by time taken"),
+      Flag("time_limit", &time_limit, "how many items to show by time taken"),
+      Flag("show_memory", &show_memory, "whether to list stats by memory used"),
+      Flag("memory_limit", &memory_limit,
+           "how many items to show by memory used"),
+      Flag("show_type", &show_type, "whether to list stats by op type"),
+      Flag("show_summary", &show_summary,
+           "whether to show a summary of the stats"),
+  };
+  string usage = Flags::Usage(argv[0], flag_list);
+  const bool parse_result = Flags::Parse(&argc, argv, flag_list);
+
+  if (!parse_result || saved_model_dir.empty()) {
+    LOG(ERROR) << usage;
+    return -1;
+  }
+
+  ::tensorflow::port::InitMain(argv[0], &argc, &argv);
+  if (argc > 1) {
+    LOG(ERROR) << "Unknown argument " << argv[1] << "\n" << usage;
+    return -1;
+  }
+
+  LOG(INFO) << "SavedModel: [" << saved_model_dir << "]";
+  LOG(INFO) << "Tags: [" << tags_string << "]";
+  LOG(INFO) << "Signature: [" << signature_key << "]";
+  LOG(INFO) << "Runtime: [" << (use_tfrt ? "tfrt" : "classic") << "]";
+  LOG(INFO) << "Num clients: [" << num_clients << "]";
+  LOG(INFO) << "Target QPS: [" << target_qps << "]";
+  LOG(INFO) << "Num runs: [" << max_num_runs << "]";
+  LOG(INFO) << "Num threads: [" << num_threads << "]";
+  LOG(INFO) << "TF version: [" << TF_VERSION_STRING << "]";
+
+  if (use_tfrt) {
+    if (initialize_tfrt == nullptr) {
+      LOG(ERROR) << "--use_tfrt requires a binary that links the TFRT session";
+      return -1;
+    }
+    Status tfrt_status = initialize_tfrt();
+    if (!tfrt_status.ok()) {
+      LOG(ERROR) << "TFRT initialization failed with " << tfrt_status;
+      return -1;
+    }
+  }
+
+  std::vector<string> tags = str_util::Split(tags_string, ',');
+  SavedModelBundle bundle;
+  const int64_t initialization_start_us = Env::Default()->NowMicros();
+  Status load_status = LoadModel(
+      saved_model_dir, std::unordered_set<string>(tags.begin(), tags.end()),
+      num_threads, use_tfrt, &bundle);
+  const double initialization_time_s =
+      (Env::Default()->NowMicros() - initialization_start_us) / 1000000.0;
+  if (!load_status.ok()) {
+    LOG(ERROR) << "Could not load SavedModel: " << load_status;
+    return -1;
+  }
+  LOG(INFO) << "Loaded SavedModel in " << initialization_time_s << "s";
+
+  auto signature_it = bundle.GetSignatures().find(signature_key);
+  if (signature_it == bundle.GetSignatures().end()) {
+    LOG(ERROR) << "SavedModel has no signature '" << signature_key << "'";
+    return -1;
+  }
+  const SignatureDef& signature = signature_it->second;
+
+  std::vector<benchmark_model::InputLayerInfo> input_infos;
+  std::vector<std::pair<string, Tensor>> inputs;
+  std::vector<string> recorded_inputs =
+      str_util::Split(recorded_inputs_string, ',', str_util::SkipEmpty());
+  Status inputs_status =
+      recorded_inputs.size() == signature.inputs().size()
+          ? OkStatus()
+          : GetSignatureInputs(signature, unknown_dim_size, &input_infos);
+  if (inputs_status.ok()) {
+    benchmark_model::CreateTensorsFromInputInfo(input_infos, &inputs);
+    inputs_status = ReadRecordedInputs(signature, recorded_inputs, &inputs);
+  }
+  if (!inputs_status.ok()) {
+    LOG(ERROR) << "Could not create inputs: " << inputs_status;
+    return -1;
+  }
+  const std::vector<string> outputs = GetSignatureOutputs(signature);
+
+  LoadOptions options;
+  options.num_clients = num_clients;
+  options.target_qps = std::strtod(target_qps.c_str(), nullptr);
+  options.num_requests = max_num_runs;
+  options.max_time_s = std::strtod(max_time.c_str(), nullptr);
+
+  if (warmup_runs > 0) {
+    LoadOptions warmup_options;
+    warmup_options.num_requests = warmup_runs;
+    warmup_options.max_time_s = -1.0;
+    BenchmarkResult warmup_result;
+    Status warmup_status = RunLoad(bundle.session.get(), inputs, outputs,
+                                   warmup_options, &warmup_result);
+    if (!warmup_status.ok()) {
+      LOG(ERROR) << "Warmup failed with " << warmup_status;
+      return -1;
+    }
+    LogBenchmarkResult("Warmup", warmup_result);
+  }
+
+  // Measure without tracing overhead. This is the timing data that can be
+  // compared across versions and runtimes.
+  BenchmarkResult result;
+  Status run_status =
+      RunLoad(bundle.session.get(), inputs, outputs, options, &result);
+  if (!run_status.ok()) {
+    LOG(ERROR) << "Benchmark failed with " << run_status;
+    return -1;
+  }
+  LogBenchmarkResult("Benchmark", result);
+
+  // Run again with tracing to see where the time goes within the graph.
+  StatSummarizerOptions stats_options;
+  stats_options.show_run_order = show_run_order;
+  stats_options.run_order_limit = run_order_limit;
+  stats_options.show_time = show_time;
+  stats_options.time_limit = time_limit;
+  stats_options.show_memory = show_memory;
+  stats_options.memory_limit = memory_limit;
+  stats_options.show_type = show_type;
+  stats_options.show_summary = show_summary;
+  StatSummarizer stats(stats_options);
+  if (stat_runs > 0) {
+    Status stats_status = CollectOpStats(bundle.session.get(), inputs, outputs,
+                                         stat_runs, &stats);
+    if (!stats_status.ok()) {
+      LOG(ERROR) << "Collecting per-op stats failed with " << stats_status;
+      return -1;
+    }
+    stats.PrintStepStats();
+  }
+
+  if (!benchmark_name.empty() && !output_prefix.empty()) {
+    RecordBenchmarkResult(output_prefix, benchmark_name, use_tfrt, options,
+                          result);
+    RecordBenchmarkEntry(output_prefix, benchmark_name, "meta-init", 1,
+                         initialization_time_s);
+    if (stat_runs > 0) {
+      std::map<std::string, int64_t> node_type_map_count;
+      std::map<std::string, int64_t> node_type_map_time;
+      std::map<std::string, int64_t> node_type_map_memory;
+      std::map<std::string, int64_t> node_type_map_times_called;
+      int64_t accumulated_us;
+      stats.ComputeStatsByType(&node_type_map_count, &node_type_map_time,
+                               &node_type_map_memory,
+                               &node_type_map_times_called, &accumulated_us);
+      for (const auto& time : node_type_map_time) {
+        RecordBenchmarkEntry(output_prefix, benchmark_name, time.first,
+                             stat_runs, (time.second * stat_runs) / 1000000.0);
+      }
+    }
+  }
+
+  return 0;
+}
+
+}  // namespace saved_model_benchmark
+}  // namespace tensorflow
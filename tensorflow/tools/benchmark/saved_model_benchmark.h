@@ -0,0 +1,119 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TOOLS_BENCHMARK_SAVED_MODEL_BENCHMARK_H_
+#define TENSORFLOW_TOOLS_BENCHMARK_SAVED_MODEL_BENCHMARK_H_
+
+#include <functional>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/cc/saved_model/loader.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/protobuf/meta_graph.pb.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/core/util/stat_summarizer.h"
+#include "tensorflow/tools/benchmark/benchmark_model.h"
+
+namespace tensorflow {
+namespace saved_model_benchmark {
+
+// How requests are issued to the model.
+struct LoadOptions {
+  // Closed loop: the number of concurrent clients, each of which issues its
+  // next request as soon as the previous one returned. Open loop: the number
+  // of threads the requests are dispatched to.
+  int num_clients = 1;
+  // If > 0, requests are issued open loop at this fixed rate regardless of
+  // completions, and latency is measured from the time a request was
+  // scheduled, so that queueing behind slow requests is included.
+  double target_qps = 0.0;
+  // The number of requests to issue; <= 0 means until `max_time_s`.
+  int64_t num_requests = 1000;
+  // The maximum duration of the run; <= 0 means no limit.
+  double max_time_s = 10.0;
+};
+
+struct BenchmarkResult {
+  int64_t num_requests = 0;
+  double wall_time_s = 0.0;
+  double throughput_qps = 0.0;
+  // Process CPU time, summed over all threads, per request.
+  double cpu_time_per_request_us = 0.0;
+  // Request latencies, in microseconds.
+  double mean_latency_us = 0.0;
+  int64_t min_latency_us = 0;
+  int64_t max_latency_us = 0;
+  int64_t p50_latency_us = 0;
+  int64_t p90_latency_us = 0;
+  int64_t p99_latency_us = 0;
+  int64_t p999_latency_us = 0;
+};
+
+// Loads the SavedModel at `export_dir`. If `use_tfrt` is set, the model is
+// loaded into a TFRT session, which requires the TFRT session to be linked
+// into the binary.
+Status LoadModel(const string& export_dir,
+                 const std::unordered_set<string>& tags, int num_threads,
+                 bool use_tfrt, SavedModelBundle* bundle);
+
+// Describes the inputs of `signature` for synthetic input generation, with
+// unknown dimensions replaced by `unknown_dim_size`.
+Status GetSignatureInputs(const SignatureDef& signature,
+                          int64_t unknown_dim_size,
+                          std::vector<benchmark_model::InputLayerInfo>* inputs);
+
+// Returns the tensor names of the outputs of `signature`.
+std::vector<string> GetSignatureOutputs(const SignatureDef& signature);
+
+// Replaces the feeds of the signature inputs listed in `recorded_inputs`, as
+// "input_key=path" pairs, with the TensorProtos read from those files.
+Status ReadRecordedInputs(
+    const SignatureDef& signature,
+    const std::vector<string>& recorded_inputs,
+    std::vector<std::pair<string, Tensor>>* input_tensors);
+
+// Computes the latency statistics of `latencies_us`, measured over
+// `wall_time_s` and `cpu_time_s`.
+BenchmarkResult SummarizeLatencies(std::vector<int64_t> latencies_us,
+                                   double wall_time_s, double cpu_time_s);
+
+// Drives `session` with `inputs` as described by `options`, and summarizes
+// the request latencies in `result`. Fails with the status of the first
+// failed request, if any.
+Status RunLoad(Session* session,
+               const std::vector<std::pair<string, Tensor>>& inputs,
+               const std::vector<string>& outputs, const LoadOptions& options,
+               BenchmarkResult* result);
+
+// Runs `session` `num_runs` times with full tracing, and adds the StepStats
+// of each run to `stats` for a per-op breakdown.
+Status CollectOpStats(Session* session,
+                      const std::vector<std::pair<string, Tensor>>& inputs,
+                      const std::vector<string>& outputs, int num_runs,
+                      StatSummarizer* stats);
+
+// Handles all setup and argument parsing. `initialize_tfrt`, if set, is called
+// before a model is loaded with --use_tfrt; binaries that link the TFRT
+// session pass it to configure the session factory.
+int Main(int argc, char** argv,
+         std::function<Status()> initialize_tfrt = nullptr);
+
+}  // namespace saved_model_benchmark
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_TOOLS_BENCHMARK_SAVED_MODEL_BENCHMARK_H_
@@ -0,0 +1,166 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tools/benchmark/saved_model_benchmark.h"
+
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/cc/saved_model/tag_constants.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace saved_model_benchmark {
+namespace {
+
+constexpr char kTestData[] = "cc/saved_model/testdata/half_plus_two/00000123";
+constexpr char kSignature[] = "classify_x2_to_y3";
+
+class SavedModelBenchmarkTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    const string export_dir =
+        io::JoinPath(testing::TensorFlowSrcRoot(), kTestData);
+    TF_ASSERT_OK(LoadModel(export_dir, {kSavedModelTagServe},
+                           /*num_threads=*/1, /*use_tfrt=*/false, &bundle_));
+    signature_ = bundle_.GetSignatures().at(kSignature);
+  }
+
+  SavedModelBundle bundle_;
+  SignatureDef signature_;
+};
+
+TEST_F(SavedModelBenchmarkTest, SignatureInputsAndOutputs) {
+  std::vector<benchmark_model::InputLayerInfo> inputs;
+  TF_ASSERT_OK(GetSignatureInputs(signature_, /*unknown_dim_size=*/4, &inputs));
+  ASSERT_EQ(inputs.size(), 1);
+  EXPECT_EQ(inputs[0].name, "x2:0");
+  EXPECT_EQ(inputs[0].data_type, DT_FLOAT);
+  EXPECT_EQ(inputs[0].shape, TensorShape({4, 1}));
+  EXPECT_EQ(GetSignatureOutputs(signature_), std::vector<string>({"y3:0"}));
+}
+
+TEST_F(SavedModelBenchmarkTest, RecordedInputs) {
+  const string path = io::JoinPath(testing::TmpDir(), "recorded_x2.pb");
+  TensorProto proto;
+  test::AsTensor<float>({1, 2}, TensorShape({2, 1}))
+      .AsProtoTensorContent(&proto);
+  TF_ASSERT_OK(WriteBinaryProto(Env::Default(), path, proto));
+
+  std::vector<std::pair<string, Tensor>> inputs;
+  TF_ASSERT_OK(ReadRecordedInputs(signature_, {"inputs=" + path}, &inputs));
+  ASSERT_EQ(inputs.size(), 1);
+  EXPECT_EQ(inputs[0].first, "x2:0");
+  test::ExpectTensorEqual<float>(
+      inputs[0].second, test::AsTensor<float>({1, 2}, TensorShape({2, 1})));
+
+  EXPECT_FALSE(ReadRecordedInputs(signature_, {"x=" + path}, &inputs).ok());
+  EXPECT_FALSE(ReadRecordedInputs(signature_, {path}, &inputs).ok());
+}
+
+TEST_F(SavedModelBenchmarkTest, ClosedLoop) {
+  std::vector<benchmark_model::InputLayerInfo> input_infos;
+  TF_ASSERT_OK(GetSignatureInputs(signature_, 4, &input_infos));
+  std::vector<std::pair<string, Tensor>> inputs;
+  benchmark_model::CreateTensorsFromInputInfo(input_infos, &inputs);
+
+  LoadOptions options;
+  options.num_clients = 2;
+  options.num_requests = 20;
+  options.max_time_s = -1.0;
+  BenchmarkResult result;
+  TF_ASSERT_OK(RunLoad(bundle_.session.get(), inputs,
+                       GetSignatureOutputs(signature_), options, &result));
+  EXPECT_EQ(result.num_requests, 20);
+  EXPECT_GT(result.throughput_qps, 0);
+  EXPECT_LE(result.min_latency_us, result.p50_latency_us);
+  EXPECT_LE(result.p50_latency_us, result.p99_latency_us);
+  EXPECT_LE(result.p99_latency_us, result.max_latency_us);
+}
+
+TEST_F(SavedModelBenchmarkTest, OpenLoop) {
+  std::vector<benchmark_model::InputLayerInfo> input_infos;
+  TF_ASSERT_OK(GetSignatureInputs(signature_, 4, &input_infos));
+  std::vector<std::pair<string, Tensor>> inputs;
+  benchmark_model::CreateTensorsFromInputInfo(input_infos, &inputs);
+
+  LoadOptions options;
+  options.num_clients = 2;
+  options.target_qps = 1000;
+  options.num_requests = 20;
+  options.max_time_s = -1.0;
+  BenchmarkResult result;
+  TF_ASSERT_OK(RunLoad(bundle_.session.get(), inputs,
+                       GetSignatureOutputs(signature_), options, &result));
+  EXPECT_EQ(result.num_requests, 20);
+  // The requests are spread over at least 19 intervals of 1ms.
+  EXPECT_GE(result.wall_time_s, 0.019);
+}
+
+TEST_F(SavedModelBenchmarkTest, FailedRequest) {
+  LoadOptions options;
+  options.num_requests = 5;
+  BenchmarkResult result;
+  // The signature input is not fed.
+  EXPECT_FALSE(RunLoad(bundle_.session.get(), {},
+                       GetSignatureOutputs(signature_), options, &result)
+                   .ok());
+}
+
+TEST_F(SavedModelBenchmarkTest, CollectOpStats) {
+  std::vector<benchmark_model::InputLayerInfo> input_infos;
+  TF_ASSERT_OK(GetSignatureInputs(signature_, 4, &input_infos));
+  std::vector<std::pair<string, Tensor>> inputs;
+  benchmark_model::CreateTensorsFromInputInfo(input_infos, &inputs);
+
+  StatSummarizer stats(StatSummarizerOptions{});
+  TF_ASSERT_OK(CollectOpStats(bundle_.session.get(), inputs,
+                              GetSignatureOutputs(signature_),
+                              /*num_runs=*/2, &stats));
+  EXPECT_FALSE(stats.GetStatsByNodeType().empty());
+}
+
+TEST(SummarizeLatenciesTest, Percentiles) {
+  std::vector<int64_t> latencies_us(100);
+  // 100, 99, ..., 1, so that the latencies must be sorted.
+  std::iota(latencies_us.rbegin(), latencies_us.rend(), 1);
+  BenchmarkResult result = SummarizeLatencies(
+      std::move(latencies_us), /*wall_time_s=*/2.0, /*cpu_time_s=*/0.5);
+  EXPECT_EQ(result.num_requests, 100);
+  EXPECT_DOUBLE_EQ(result.throughput_qps, 50.0);
+  EXPECT_DOUBLE_EQ(result.cpu_time_per_request_us, 5000.0);
+  EXPECT_DOUBLE_EQ(result.mean_latency_us, 50.5);
+  EXPECT_EQ(result.min_latency_us, 1);
+  EXPECT_EQ(result.p50_latency_us, 50);
+  EXPECT_EQ(result.p90_latency_us, 90);
+  EXPECT_EQ(result.p99_latency_us, 99);
+  EXPECT_EQ(result.p999_latency_us, 100);
+  EXPECT_EQ(result.max_latency_us, 100);
+}
+
+TEST(SummarizeLatenciesTest, Empty) {
+  BenchmarkResult result = SummarizeLatencies({}, 1.0, 1.0);
+  EXPECT_EQ(result.num_requests, 0);
+  EXPECT_EQ(result.p99_latency_us, 0);
+}
+
+}  // namespace
+}  // namespace saved_model_benchmark
+}  // namespace tensorflow
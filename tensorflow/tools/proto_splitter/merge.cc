@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/tools/proto_splitter/merge.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -25,11 +26,12 @@ limitations under the License.
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
-#include "riegeli/base/object.h"  // from @riegeli
 #include "riegeli/bytes/fd_reader.h"  // from @riegeli
 #include "riegeli/records/record_reader.h"  // from @riegeli
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/file_system_helper.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/tools/proto_splitter/cc/util.h"
 #include "tensorflow/tools/proto_splitter/chunk.pb.h"
 #include "tsl/platform/errors.h"
@@ -50,10 +52,40 @@ using tsl::protobuf::FieldDescriptor;
 using tsl::protobuf::Message;
 using tsl::protobuf::Reflection;
 
+namespace {
+
+// The maximum number of threads reading the chunks of a chunked proto.
+constexpr size_t kMaxChunkReadThreads = 16;
+
+// Appends the indices of the chunks referenced by `chunked_message` and its
+// chunked fields to `chunk_indices`.
+void CollectChunkIndices(const ChunkedMessage& chunked_message,
+                         std::vector<uint64_t>* chunk_indices) {
+  if (chunked_message.has_chunk_index()) {
+    chunk_indices->push_back(chunked_message.chunk_index());
+  }
+  for (const ChunkedField& chunked_field : chunked_message.chunked_fields()) {
+    CollectChunkIndices(chunked_field.message(), chunk_indices);
+  }
+}
+
+// Moves the chunk at `chunk_index` out of `read_chunks`, so that its memory
+// is handed over to the merged message, or released once it is parsed.
+absl::StatusOr<std::string> TakeChunk(std::vector<std::string>& read_chunks,
+                                      uint64_t chunk_index) {
+  if (chunk_index >= read_chunks.size()) {
+    return absl::NotFoundError(
+        absl::StrCat("Chunk ", chunk_index, " was not read."));
+  }
+  return std::move(read_chunks[chunk_index]);
+}
+
+}  // namespace
+
 absl::Status Merger::Merge(const std::vector<std::unique_ptr<Message>>& chunks,
                            const ChunkedMessage& chunked_message,
                            Message* merged_message) {
-  riegeli::RecordReader<riegeli::FdReader<>> null_reader{riegeli::kClosed};
+  std::vector<std::string> no_read_chunks;
 
   if (chunked_message.has_chunk_index()) {
     // Chunks referenced by fields should be merged into the parent chunk.
@@ -63,8 +95,8 @@ absl::Status Merger::Merge(const std::vector<std::unique_ptr<Message>>& chunks,
   // Use each chunked_field within the chunked_message to merge its
   // corresponding chunk into merged_message.
   for (const auto& chunked_field : chunked_message.chunked_fields()) {
-    absl::Status s = ProcessField(chunked_field, merged_message, {}, chunks,
-                                  null_reader, MergerOp::MERGE);
+    absl::Status s = ProcessField(chunked_field, merged_message,
+                                  no_read_chunks, chunks, MergerOp::MERGE);
     if (!s.ok()) return s;
   }
 
@@ -80,26 +112,20 @@ absl::Status Merger::Read(std::string prefix, Message* merged_message) {
   }
 
   // Create riegeli reader for file.cpb
-  TF_ASSIGN_OR_RETURN(auto reader,
-                      GetRiegeliReader(absl::StrCat(prefix, ".cpb")));
+  const std::string cpb_file = absl::StrCat(prefix, ".cpb");
+  TF_ASSIGN_OR_RETURN(auto reader, GetRiegeliReader(cpb_file));
 
   auto read_metadata = GetChunkMetadata(reader);
+  reader.Close();
   if (!read_metadata.ok()) {
-    reader.Close();
     return absl::FailedPreconditionError(
         absl::StrCat("Couldn't read ChunkMetadata from chunked proto.\n",
                      read_metadata.status().ToString()));
   }
-  ChunkMetadata chunk_metadata = read_metadata.value();
-
-  std::vector<ChunkInfo> chunks_info = std::vector<ChunkInfo>(
-      chunk_metadata.chunks().begin(), chunk_metadata.chunks().end());
 
   // Read the remaining chunks.
   absl::Status s =
-      ReadFields(chunk_metadata.message(), reader, chunks_info, merged_message);
-
-  reader.Close();
+      ReadAndMerge(cpb_file, read_metadata.value(), merged_message);
 
   uint64_t end_time = Env::Default()->NowMicros();
   LOG(INFO) << "Finished reading and merging chunked proto, took "
@@ -120,18 +146,9 @@ absl::Status Merger::ReadPartial(absl::string_view prefix,
                      prefix, ".pb"));
   }
 
-  // Create riegeli reader for file.cpb
-  TF_ASSIGN_OR_RETURN(auto reader,
-                      GetRiegeliReader(absl::StrCat(prefix, ".cpb")));
-
-  std::vector<ChunkInfo> chunks_info = std::vector<ChunkInfo>(
-      chunk_metadata.chunks().begin(), chunk_metadata.chunks().end());
-
-  // Read the remaining chunks.
-  absl::Status s =
-      ReadFields(chunk_metadata.message(), reader, chunks_info, merged_message);
-
-  reader.Close();
+  // Read the chunks of file.cpb.
+  absl::Status s = ReadAndMerge(absl::StrCat(prefix, ".cpb"), chunk_metadata,
+                                merged_message);
 
   uint64_t end_time = Env::Default()->NowMicros();
   LOG(INFO) << "Finished reading and merging chunked proto, took "
@@ -154,16 +171,80 @@ absl::Status Merger::ReadPb(const std::string& pb_file,
   return ret;
 }
 
-absl::Status Merger::ReadFields(
-    const ChunkedMessage& chunked_message,
-    riegeli::RecordReader<riegeli::FdReader<>>& reader,
-    const std::vector<ChunkInfo>& chunks_info,
-    tsl::protobuf::Message* merged_message) {
+absl::Status Merger::ReadAndMerge(const std::string& cpb_file,
+                                  const ChunkMetadata& chunk_metadata,
+                                  Message* merged_message) {
+  std::vector<ChunkInfo> chunks_info = std::vector<ChunkInfo>(
+      chunk_metadata.chunks().begin(), chunk_metadata.chunks().end());
+  std::vector<std::string> read_chunks;
+  TF_RETURN_IF_ERROR(ReadChunks(cpb_file, chunk_metadata.message(),
+                                chunks_info, &read_chunks));
+  return ReadFields(chunk_metadata.message(), read_chunks, merged_message);
+}
+
+absl::Status Merger::ReadChunks(const std::string& cpb_file,
+                                const ChunkedMessage& chunked_message,
+                                const std::vector<ChunkInfo>& chunks_info,
+                                std::vector<std::string>* chunks) {
+  std::vector<uint64_t> chunk_indices;
+  CollectChunkIndices(chunked_message, &chunk_indices);
+  for (uint64_t chunk_index : chunk_indices) {
+    if (chunk_index >= chunks_info.size()) {
+      return absl::FailedPreconditionError(
+          absl::StrCat("Chunk index ", chunk_index, " out of range, the "
+                       "chunked proto has ", chunks_info.size(), " chunks."));
+    }
+  }
+  // Reads in file order, so that each thread mostly reads forward.
+  std::sort(chunk_indices.begin(), chunk_indices.end(),
+            [&chunks_info](uint64_t a, uint64_t b) {
+              return chunks_info[a].offset() < chunks_info[b].offset();
+            });
+  chunks->assign(chunks_info.size(), std::string());
+
+  const int num_threads = static_cast<int>(std::max<size_t>(
+      1, std::min({static_cast<size_t>(port::MaxParallelism()),
+                   kMaxChunkReadThreads, chunk_indices.size()})));
+  std::vector<absl::Status> statuses(num_threads);
+  std::atomic<size_t> next_chunk{0};
+  auto read_worker = [&](int thread) {
+    auto reader = GetRiegeliReader(cpb_file);
+    if (!reader.ok()) {
+      statuses[thread] = reader.status();
+      return;
+    }
+    for (size_t i = next_chunk++; i < chunk_indices.size(); i = next_chunk++) {
+      auto chunk = ReadChunk(*reader, chunks_info[chunk_indices[i]]);
+      if (!chunk.ok()) {
+        statuses[thread] = chunk.status();
+        break;
+      }
+      (*chunks)[chunk_indices[i]] = *std::move(chunk);
+    }
+    reader->Close();
+  };
+  if (num_threads <= 1) {
+    read_worker(0);
+  } else {
+    thread::ThreadPool pool(Env::Default(), "read_chunks", num_threads);
+    for (int thread = 0; thread < num_threads; ++thread) {
+      pool.Schedule([&read_worker, thread]() { read_worker(thread); });
+    }
+  }
+  for (const absl::Status& status : statuses) {
+    TF_RETURN_IF_ERROR(status);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status Merger::ReadFields(const ChunkedMessage& chunked_message,
+                                std::vector<std::string>& read_chunks,
+                                tsl::protobuf::Message* merged_message) {
   if (chunked_message.has_chunk_index()) {
     // Chunks referenced by fields should be merged into the parent chunk.
     TF_ASSIGN_OR_RETURN(
         std::string chunk,
-        ReadChunk(reader, chunks_info[chunked_message.chunk_index()]));
+        TakeChunk(read_chunks, chunked_message.chunk_index()));
     if (!merged_message->MergeFromString(chunk)) {
       return absl::FailedPreconditionError(
           "Couldn't merge chunk into message.");
@@ -212,8 +293,8 @@ absl::Status Merger::ReadFields(
   // Use each chunked_field within the chunked_message to merge its
   // corresponding chunk into merged_message.
   for (const auto& chunked_field : chunked_fields) {
-    absl::Status s = ProcessField(chunked_field, merged_message, chunks_info,
-                                  {}, reader, MergerOp::READ);
+    absl::Status s = ProcessField(chunked_field, merged_message, read_chunks,
+                                  {}, MergerOp::READ);
     if (!s.ok()) return s;
   }
   return absl::OkStatus();
@@ -221,15 +302,14 @@ absl::Status Merger::ReadFields(
 
 absl::Status Merger::ProcessField(
     const ChunkedField& chunked_field, Message* merged_message,
-    const std::vector<ChunkInfo>& chunks_info,
-    const std::vector<std::unique_ptr<Message>>& chunks,
-    riegeli::RecordReader<riegeli::FdReader<>>& reader, MergerOp op) {
+    std::vector<std::string>& read_chunks,
+    const std::vector<std::unique_ptr<Message>>& chunks, MergerOp op) {
   std::string chunk;
   switch (op) {
     case MergerOp::READ: {
       TF_ASSIGN_OR_RETURN(
-          chunk, ReadChunk(reader,
-                           chunks_info[chunked_field.message().chunk_index()]));
+          chunk,
+          TakeChunk(read_chunks, chunked_field.message().chunk_index()));
       break;
     }
     case MergerOp::MERGE: {
@@ -297,7 +377,7 @@ absl::Status Merger::ProcessField(
   if (field_desc->is_repeated()) {
     // field may contain multiple elements
     auto message_callback = [&reflection, &merged_message, &field_index, &op,
-                             &chunks, &chunked_field, &reader, &chunks_info,
+                             &chunks, &chunked_field, &read_chunks,
                              &field_desc]() -> absl::Status {
       for (int _ = reflection->FieldSize(*merged_message, field_desc);
            _ <= field_index; _++) {
@@ -312,7 +392,7 @@ absl::Status Merger::ProcessField(
           break;
         case MergerOp::READ:
           TF_RETURN_IF_ERROR(
-              ReadFields(chunked_field.message(), reader, chunks_info,
+              ReadFields(chunked_field.message(), read_chunks,
                          reflection->MutableRepeatedMessage(
                              merged_message, field_desc, field_index)));
           break;
@@ -321,12 +401,13 @@ absl::Status Merger::ProcessField(
       }
       return absl::OkStatus();
     };
-    TF_RETURN_IF_ERROR(SetRepeatedFieldElement(
-        merged_message, field_desc, field_index, chunk, message_callback));
+    TF_RETURN_IF_ERROR(SetRepeatedFieldElement(merged_message, field_desc,
+                                               field_index, std::move(chunk),
+                                               message_callback));
   } else {
     // regular field
     auto message_callback = [&reflection, &merged_message, &op, &chunks,
-                             &chunked_field, &reader, &chunks_info,
+                             &chunked_field, &read_chunks,
                              &field_desc]() -> absl::Status {
       switch (op) {
         case MergerOp::MERGE:
@@ -336,7 +417,7 @@ absl::Status Merger::ProcessField(
           break;
         case MergerOp::READ:
           TF_RETURN_IF_ERROR(ReadFields(
-              chunked_field.message(), reader, chunks_info,
+              chunked_field.message(), read_chunks,
               reflection->MutableMessage(merged_message, field_desc)));
           break;
         default:
@@ -344,8 +425,8 @@ absl::Status Merger::ProcessField(
       }
       return absl::OkStatus();
     };
-    TF_RETURN_IF_ERROR(
-        SetFieldElement(merged_message, field_desc, chunk, message_callback));
+    TF_RETURN_IF_ERROR(SetFieldElement(merged_message, field_desc,
+                                       std::move(chunk), message_callback));
   }
 
   return absl::OkStatus();
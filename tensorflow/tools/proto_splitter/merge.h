@@ -20,8 +20,6 @@ limitations under the License.
 #include <vector>
 
 #include "absl/status/status.h"
-#include "riegeli/bytes/fd_reader.h"  // from @riegeli
-#include "riegeli/records/record_reader.h"  // from @riegeli
 #include "tensorflow/tools/proto_splitter/chunk.pb.h"
 #include "tsl/platform/protobuf.h"
 
@@ -64,14 +62,29 @@ class Merger {
   static absl::Status ReadPb(const std::string& pb_file,
                              tsl::protobuf::Message* merged_message);
 
+  // Reads the chunks referenced by `chunked_message` from `cpb_file` into
+  // `chunks`, indexed like `chunks_info`. The chunks are read concurrently,
+  // each thread with its own reader, in file order.
+  static absl::Status ReadChunks(
+      const std::string& cpb_file,
+      const ::tensorflow::proto_splitter::ChunkedMessage& chunked_message,
+      const std::vector<::tensorflow::proto_splitter::ChunkInfo>& chunks_info,
+      std::vector<std::string>* chunks);
+
+  // Reads the chunks referenced by `chunk_metadata` from `cpb_file` and
+  // merges them into `merged_message`.
+  static absl::Status ReadAndMerge(
+      const std::string& cpb_file,
+      const ::tensorflow::proto_splitter::ChunkMetadata& chunk_metadata,
+      tsl::protobuf::Message* merged_message);
+
   // Uses metadata contained in `chunked_message` to fill `merged_message` with
-  // data accessed by the `reader` using `chunks_info`.
+  // the data of `read_chunks`, which were read by ReadChunks(). Each chunk is
+  // moved out of `read_chunks` as it is merged, so that large string fields
+  // (e.g. the contents of constant tensors) are not copied.
   static absl::Status ReadFields(
       const ::tensorflow::proto_splitter::ChunkedMessage& chunked_message,
-      riegeli::RecordReader<riegeli::FdReader<>>& reader,
-      const std::vector<::tensorflow::proto_splitter::ChunkInfo>&
-          chunks_info,  // TODO(adamcogdell): this can just be a
-                        // RepeatedPtrField
+      std::vector<std::string>& read_chunks,
       tsl::protobuf::Message* merged_message);
 
   // Processes a single `chunked_field` within a `chunked_message`. If the field
@@ -82,9 +95,9 @@ class Merger {
   static absl::Status ProcessField(
       const ::tensorflow::proto_splitter::ChunkedField& chunked_field,
       tsl::protobuf::Message* merged_message,
-      const std::vector<::tensorflow::proto_splitter::ChunkInfo>& chunks_info,
+      std::vector<std::string>& read_chunks,
       const std::vector<std::unique_ptr<tsl::protobuf::Message>>& chunks,
-      riegeli::RecordReader<riegeli::FdReader<>>& reader, MergerOp op);
+      MergerOp op);
 };
 
 }  // namespace tensorflow::tools::proto_splitter
@@ -173,6 +173,14 @@ class CoordinationServiceStandaloneImpl : public CoordinationServiceInterface {
   void PassBarrier(absl::string_view barrier_id, absl::Status result,
                    BarrierState* barrier)
       TF_EXCLUSIVE_LOCKS_REQUIRED(state_mu_);
+  // Implements BarrierAsync. If the call passes the barrier, the callbacks
+  // of the barrier are moved to `passed_callbacks` instead of run.
+  void BarrierAsyncLocked(
+      const std::string& barrier_id, absl::Duration timeout,
+      const CoordinatedTask& task,
+      const std::vector<CoordinatedTask>& participating_tasks,
+      StatusCallback done, std::vector<StatusCallback>* passed_callbacks)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(state_mu_);
   // Check if participating tasks are specified correctly across barrier calls.
   bool ValidateTaskArgs(
       const std::vector<CoordinatedTask>& tasks_args,
@@ -745,29 +753,32 @@ absl::Status CoordinationServiceStandaloneImpl::RecordHeartbeat(
   const std::string& task_name = GetTaskName(task);
   absl::Status s = absl::OkStatus();
   {
-    mutex_lock l(state_mu_);
-    if (!cluster_state_.contains(task_name)) {
+    // Heartbeats only read the cluster state, and the last heartbeat time has
+    // its own lock, so the heartbeats of many tasks do not serialize.
+    tf_shared_lock l(state_mu_);
+    auto it = cluster_state_.find(task_name);
+    if (it == cluster_state_.end()) {
       return MakeCoordinationError(errors::InvalidArgument(
           "Unexpected heartbeat request from task: ", task_name,
           ". This usually implies an earlier error that caused coordination "
           "service to shut down before the workers disconnect. Check the task "
           "leader's logs for an earlier error to debug the root cause."));
     }
-    if (!cluster_state_[task_name]->GetStatus().ok()) {
-      return cluster_state_[task_name]->GetStatus();
-    } else if (cluster_state_[task_name]->GetState() ==
+    TaskState* task_state = it->second.get();
+    if (!task_state->GetStatus().ok()) {
+      return task_state->GetStatus();
+    } else if (task_state->GetState() ==
                    CoordinatedTaskState::TASKSTATE_DISCONNECTED &&
                // We accept heartbeats for a short grace period to account for
                // the lag time between the service recording the state change
                // and the agent stopping heartbeats.
                Env::Default()->NowMicros() >
-                   cluster_state_[task_name]
-                       ->GetDisconnectedGracePeriodMicros()) {
+                   task_state->GetDisconnectedGracePeriodMicros()) {
       return MakeCoordinationError(errors::InvalidArgument(
           "Task with task_name=", task_name,
           " must be registered before sending heartbeat messages"));
     }
-    s = cluster_state_[task_name]->RecordHeartbeat(incarnation);
+    s = task_state->RecordHeartbeat(incarnation);
   }
 
   // Set and propagate any heartbeat errors.
@@ -1030,7 +1041,25 @@ void CoordinationServiceStandaloneImpl::BarrierAsync(
     StatusCallback done) {
   VLOG(3) << "Task " << GetTaskName(task) << "invoked BarrierAsync("
           << barrier_id << ").";
-  mutex_lock l(state_mu_);
+  // The callbacks of a barrier passed by this call answer the barrier calls
+  // of all participating tasks, so they run once `state_mu_` is released
+  // rather than hold up the calls of other tasks, e.g. heartbeats.
+  std::vector<StatusCallback> passed_callbacks;
+  {
+    mutex_lock l(state_mu_);
+    BarrierAsyncLocked(barrier_id, timeout, task, participating_tasks,
+                       std::move(done), &passed_callbacks);
+  }
+  for (const auto& callback : passed_callbacks) {
+    callback(absl::OkStatus());
+  }
+}
+
+void CoordinationServiceStandaloneImpl::BarrierAsyncLocked(
+    const std::string& barrier_id, absl::Duration timeout,
+    const CoordinatedTask& task,
+    const std::vector<CoordinatedTask>& participating_tasks,
+    StatusCallback done, std::vector<StatusCallback>* passed_callbacks) {
   auto pair = barriers_.try_emplace(barrier_id);
   auto it = pair.first;
   bool inserted = pair.second;
@@ -1144,8 +1173,8 @@ void CoordinationServiceStandaloneImpl::BarrierAsync(
     --barrier->num_pending_tasks;
 
     if (barrier->num_pending_tasks == 0) {
+      passed_callbacks->swap(barrier->done_callbacks);
       PassBarrier(barrier_id, absl::OkStatus(), barrier);
-      return;
     }
   }
 }
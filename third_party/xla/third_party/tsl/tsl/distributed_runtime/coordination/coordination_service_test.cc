@@ -1147,6 +1147,33 @@ TEST_F(CoordinationBarrierTest, PassedBarrierReturnsImmediately) {
   TF_EXPECT_OK(barrier_status_repeat);
 }
 
+TEST_F(CoordinationBarrierTest, PassedBarrierCallbacksCanCallService) {
+  const std::string barrier_id = "barrier_id";
+  absl::Duration timeout = absl::Seconds(5);
+  std::vector<absl::Status> barrier_statuses(3);
+  std::vector<absl::Status> heartbeat_statuses(3);
+  std::vector<absl::Notification> notifications(3);
+
+  // The callbacks run once the service released its lock, so they may call
+  // into the service again.
+  for (int i = 0; i < 3; ++i) {
+    GetCoordinationService()->BarrierAsync(
+        barrier_id, timeout, GetTask(i),
+        /*participating_tasks=*/{}, [&, i](absl::Status s) {
+          barrier_statuses[i] = s;
+          heartbeat_statuses[i] = GetCoordinationService()->RecordHeartbeat(
+              GetTask(i), /*incarnation=*/0);
+          notifications[i].Notify();
+        });
+  }
+
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(notifications[i].HasBeenNotified());
+    TF_EXPECT_OK(barrier_statuses[i]);
+    TF_EXPECT_OK(heartbeat_statuses[i]);
+  }
+}
+
 TEST_F(CoordinationBarrierTest, BarrierFailsIfTaskIsAlreadyInError) {
   const std::string barrier_id = "barrier_id";
   absl::Duration timeout = absl::Seconds(5);
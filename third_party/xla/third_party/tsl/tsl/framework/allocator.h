@@ -88,11 +88,22 @@ struct AllocatorStats {
 
   int64_t largest_free_block_bytes;  // Largest free block's size in heap.
 
+  // The fraction of the free memory held by the allocator that is not part of
+  // its largest free block, i.e. 0 if all the free memory is contiguous, and
+  // close to 1 if it is split into many small blocks.
+  std::optional<double> fragmentation;
+
   // Number of bytes of memory held by the allocator.  This may be higher than
   // bytes_in_use if the allocator holds a pool of memory (e.g. BFCAllocator).
   std::optional<int64_t> pool_bytes;
   std::optional<int64_t> peak_pool_bytes;
 
+  // Number of allocations served from, and not found in, a cache of free
+  // blocks that sits in front of the allocator (e.g. the thread caches of
+  // BFCAllocator).
+  int64_t num_cache_hits;
+  int64_t num_cache_misses;
+
   AllocatorStats()
       : num_allocs(0),
         bytes_in_use(0),
@@ -100,7 +111,9 @@ struct AllocatorStats {
         largest_alloc_size(0),
         bytes_reserved(0),
         peak_bytes_reserved(0),
-        largest_free_block_bytes(0) {}
+        largest_free_block_bytes(0),
+        num_cache_hits(0),
+        num_cache_misses(0) {}
 
   std::string DebugString() const;
 };
@@ -228,6 +241,13 @@ class Allocator {
 
   virtual void SetSafeFrontier(uint64 count) {}
 
+  // If implemented, returns the memory that the allocator holds but does not
+  // use to the system when the allocator is fragmented, so that later
+  // allocations can be served from fewer, larger blocks. Intended to be called
+  // while the allocator is idle, e.g. between steps. Returns the number of
+  // bytes released.
+  virtual size_t Compact() { return 0; }
+
   // For allocator that are stream aware, allow to specify the compute
   // stream this allocator is used for. This can also trigger memory
   // preallocation.
@@ -39,6 +39,19 @@ namespace tsl {
 
 constexpr BFCAllocator::ChunkHandle BFCAllocator::kInvalidChunkHandle;
 
+namespace {
+
+// Returns the thread cache shard of the calling thread. Threads are assigned
+// to shards round-robin, the first time they allocate.
+int ThreadCacheShardIndex(int num_shards) {
+  static std::atomic<int> next_index{0};
+  thread_local const int index =
+      next_index.fetch_add(1, std::memory_order_relaxed);
+  return index % num_shards;
+}
+
+}  // namespace
+
 BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
                            size_t total_memory, const string& name,
                            const Options& opts)
@@ -84,6 +97,22 @@ BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
       CHECK_NE(BinForSize(bin_size * 2), BinFromIndex(b));
     }
   }
+
+  if (opts.thread_cache_max_bytes > 0 && opts.thread_cache_batch_size > 0) {
+    const int num_size_classes =
+        Log2Ceiling64(std::max(opts.thread_cache_max_bytes,
+                               kMinAllocationSize)) -
+        kMinAllocationBits + 1;
+    VLOG(1) << "Enabling thread caches for allocations of up to "
+            << strings::HumanReadableNumBytes(opts.thread_cache_max_bytes)
+            << " in " << name;
+    thread_cache_shards_ = std::vector<ThreadCacheShard>(kNumThreadCacheShards);
+    for (ThreadCacheShard& shard : thread_cache_shards_) {
+      mutex_lock l(shard.mu);
+      shard.free_chunks.resize(num_size_classes);
+    }
+    cached_ptr_shards_ = std::vector<CachedPtrShard>(kNumCachedPtrShards);
+  }
 }
 
 BFCAllocator::~BFCAllocator() {
@@ -259,6 +288,13 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
 void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
                                 const AllocationAttributes& allocation_attr) {
   VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes;
+  if (UseThreadCache(num_bytes, allocation_attr)) {
+    void* ptr = AllocateFromThreadCache(num_bytes);
+    if (ptr != nullptr) {
+      VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes << " " << ptr;
+      return ptr;
+    }
+  }
   void* result = [&] {
     if (!opts_.allow_retry_on_failure || !allocation_attr.retry_on_failure) {
       // If we have globally disabled retry-on-failure and fail to allocate an
@@ -305,6 +341,16 @@ void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
                                           allocation_attr);
     }
   }();
+  if (result == nullptr && !thread_cache_shards_.empty() && num_bytes > 0) {
+    // The thread caches may hold enough free memory.
+    FlushThreadCaches();
+    uint64 freed_by_count = 0;
+    if (allocation_attr.freed_by_func != nullptr) {
+      freed_by_count = (*allocation_attr.freed_by_func)();
+    }
+    result = AllocateRawInternal(unused_alignment, num_bytes,
+                                 /*dump_log_on_failure=*/false, freed_by_count);
+  }
   VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes << " " << result;
   VLOG(4) << "[mem-debug] AllocateRaw," << Name() << "," << num_bytes << ","
           << result << "," << tsl::CurrentStackTrace();
@@ -329,26 +375,7 @@ bool BFCAllocator::DeallocateFreeRegions(size_t rounded_bytes)
 
   // Searching for free regions.
   absl::flat_hash_set<void*> free_region_ptrs;
-  size_t total_free_bytes = 0;
-  for (const AllocationRegion& region : region_manager_.regions()) {
-    ChunkHandle h = region_manager_.get_handle(region.ptr());
-    bool any_use = false;
-    while (h != kInvalidChunkHandle) {
-      const Chunk* c = ChunkFromHandle(h);
-      if (c->in_use()) {
-        any_use = true;
-        break;
-      }
-      h = c->next;
-    }
-
-    if (!any_use) {
-      VLOG(2) << "Found free region with ptr = " << region.ptr();
-      free_region_ptrs.insert(region.ptr());
-      total_free_bytes += region.memory_size();
-    }
-  }
-
+  const size_t total_free_bytes = FindFreeRegions(&free_region_ptrs);
   if (total_free_bytes == 0) {
     return false;
   }
@@ -376,6 +403,65 @@ bool BFCAllocator::DeallocateFreeRegions(size_t rounded_bytes)
   return true;
 }
 
+size_t BFCAllocator::FindFreeRegions(absl::flat_hash_set<void*>* region_ptrs)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
+  size_t total_free_bytes = 0;
+  for (const AllocationRegion& region : region_manager_.regions()) {
+    ChunkHandle h = region_manager_.get_handle(region.ptr());
+    bool any_use = false;
+    while (h != kInvalidChunkHandle) {
+      const Chunk* c = ChunkFromHandle(h);
+      if (c->in_use()) {
+        any_use = true;
+        break;
+      }
+      h = c->next;
+    }
+
+    if (!any_use) {
+      VLOG(2) << "Found free region with ptr = " << region.ptr();
+      region_ptrs->insert(region.ptr());
+      total_free_bytes += region.memory_size();
+    }
+  }
+  return total_free_bytes;
+}
+
+size_t BFCAllocator::LargestFreeChunkLocked() {
+  for (BinNum b = kNumBins - 1; b >= 0; --b) {
+    const Bin* bin = BinFromIndex(b);
+    if (!bin->free_chunks.empty()) {
+      return ChunkFromHandle(*bin->free_chunks.rbegin())->size;
+    }
+  }
+  return 0;
+}
+
+double BFCAllocator::FragmentationLocked() {
+  const int64_t free_bytes = *stats_.pool_bytes - stats_.bytes_in_use;
+  if (free_bytes <= 0) return 0;
+  return 1.0 - static_cast<double>(LargestFreeChunkLocked()) / free_bytes;
+}
+
+size_t BFCAllocator::Compact() {
+  FlushThreadCaches();
+  mutex_lock l(lock_);
+  if (!timestamped_chunks_.empty()) {
+    MergeTimestampedChunks(0);
+  }
+  const double fragmentation = FragmentationLocked();
+  if (fragmentation < opts_.compaction_threshold) return 0;
+  absl::flat_hash_set<void*> free_region_ptrs;
+  const size_t free_region_bytes = FindFreeRegions(&free_region_ptrs);
+  if (free_region_bytes == 0) return 0;
+  VLOG(1) << "Compacting " << Name() << " with fragmentation "
+          << fragmentation << ": releasing " << free_region_ptrs.size()
+          << " free regions of "
+          << strings::HumanReadableNumBytes(free_region_bytes);
+  DeallocateRegions(free_region_ptrs);
+  return free_region_bytes;
+}
+
 void BFCAllocator::DeallocateRegions(
     const absl::flat_hash_set<void*>& region_ptrs)
     TF_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
@@ -684,6 +770,11 @@ void BFCAllocator::DeallocateRaw(void* ptr) {
   VLOG(4) << "[mem-debug] DeallocateRaw," << Name() << ","
           << (ptr ? RequestedSize(ptr) : 0) << "," << ptr << ","
           << tsl::CurrentStackTrace();
+  if (ptr != nullptr && !thread_cache_shards_.empty() &&
+      DeallocateToThreadCache(ptr)) {
+    retry_helper_.NotifyDealloc();
+    return;
+  }
   DeallocateRawInternal(ptr);
   retry_helper_.NotifyDealloc();
 }
@@ -694,7 +785,10 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
     return;
   }
   mutex_lock l(lock_);
+  FreeChunkLocked(ptr);
+}
 
+void BFCAllocator::FreeChunkLocked(void* ptr) {
   // Find the chunk from the ptr.
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle);
@@ -723,6 +817,134 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
   }
 }
 
+bool BFCAllocator::UseThreadCache(
+    size_t num_bytes, const AllocationAttributes& allocation_attr) const {
+  // Reusing a cached chunk would bypass the checks against the timing counter.
+  return !thread_cache_shards_.empty() && num_bytes > 0 &&
+         num_bytes <= opts_.thread_cache_max_bytes &&
+         timing_counter_ == nullptr && allocation_attr.freed_by_func == nullptr;
+}
+
+BFCAllocator::CachedPtrShard& BFCAllocator::CachedPtrShardFor(
+    const void* ptr) {
+  const uintptr_t index =
+      (reinterpret_cast<uintptr_t>(ptr) >> kMinAllocationBits) %
+      kNumCachedPtrShards;
+  return cached_ptr_shards_[index];
+}
+
+void* BFCAllocator::AllocateFromThreadCache(size_t num_bytes) {
+  const int size_class =
+      Log2Ceiling64(std::max(num_bytes, kMinAllocationSize)) -
+      kMinAllocationBits;
+  ThreadCacheShard& shard =
+      thread_cache_shards_[ThreadCacheShardIndex(kNumThreadCacheShards)];
+  {
+    mutex_lock l(shard.mu);
+    std::vector<void*>& free_chunks = shard.free_chunks[size_class];
+    if (!free_chunks.empty()) {
+      void* ptr = free_chunks.back();
+      free_chunks.pop_back();
+      num_cache_hits_.fetch_add(1, std::memory_order_relaxed);
+      return ptr;
+    }
+  }
+  num_cache_misses_.fetch_add(1, std::memory_order_relaxed);
+
+  // Refill the cache with a batch of chunks from the bins.
+  const size_t class_bytes = kMinAllocationSize << size_class;
+  std::vector<void*> batch;
+  batch.reserve(opts_.thread_cache_batch_size);
+  {
+    mutex_lock l(lock_);
+    const BinNum bin_num = BinNumForSize(class_bytes);
+    while (batch.size() < static_cast<size_t>(opts_.thread_cache_batch_size)) {
+      void* ptr = FindChunkPtr(bin_num, class_bytes, class_bytes, 0);
+      if (ptr == nullptr) break;
+      AddTraceMe("MemoryAllocation", ptr);
+      batch.push_back(ptr);
+    }
+  }
+  if (batch.empty()) {
+    // Let the regular path extend the pool.
+    void* ptr = AllocateRawInternal(0, class_bytes,
+                                    /*dump_log_on_failure=*/false, 0);
+    if (ptr == nullptr) {
+      FlushThreadCaches();
+      return nullptr;
+    }
+    batch.push_back(ptr);
+  }
+  for (void* ptr : batch) {
+    CachedPtrShard& ptr_shard = CachedPtrShardFor(ptr);
+    mutex_lock l(ptr_shard.mu);
+    ptr_shard.size_classes[ptr] = size_class;
+  }
+  void* result = batch.back();
+  batch.pop_back();
+  if (!batch.empty()) {
+    mutex_lock l(shard.mu);
+    std::vector<void*>& free_chunks = shard.free_chunks[size_class];
+    free_chunks.insert(free_chunks.end(), batch.begin(), batch.end());
+  }
+  return result;
+}
+
+bool BFCAllocator::DeallocateToThreadCache(void* ptr) {
+  int size_class;
+  {
+    CachedPtrShard& ptr_shard = CachedPtrShardFor(ptr);
+    mutex_lock l(ptr_shard.mu);
+    auto it = ptr_shard.size_classes.find(ptr);
+    if (it == ptr_shard.size_classes.end()) return false;
+    size_class = it->second;
+  }
+  std::vector<void*> to_return;
+  {
+    ThreadCacheShard& shard =
+        thread_cache_shards_[ThreadCacheShardIndex(kNumThreadCacheShards)];
+    mutex_lock l(shard.mu);
+    std::vector<void*>& free_chunks = shard.free_chunks[size_class];
+    free_chunks.push_back(ptr);
+    const size_t batch_size = opts_.thread_cache_batch_size;
+    if (free_chunks.size() >= 2 * batch_size) {
+      // Return the chunks that were cached first.
+      to_return.assign(free_chunks.begin(), free_chunks.begin() + batch_size);
+      free_chunks.erase(free_chunks.begin(), free_chunks.begin() + batch_size);
+    }
+  }
+  if (!to_return.empty()) ReturnThreadCacheChunks(to_return);
+  return true;
+}
+
+void BFCAllocator::ReturnThreadCacheChunks(const std::vector<void*>& ptrs) {
+  for (void* ptr : ptrs) {
+    CachedPtrShard& ptr_shard = CachedPtrShardFor(ptr);
+    mutex_lock l(ptr_shard.mu);
+    ptr_shard.size_classes.erase(ptr);
+  }
+  mutex_lock l(lock_);
+  for (void* ptr : ptrs) {
+    FreeChunkLocked(ptr);
+  }
+}
+
+void BFCAllocator::FlushThreadCaches() {
+  std::vector<void*> ptrs;
+  for (ThreadCacheShard& shard : thread_cache_shards_) {
+    mutex_lock l(shard.mu);
+    for (std::vector<void*>& free_chunks : shard.free_chunks) {
+      ptrs.insert(ptrs.end(), free_chunks.begin(), free_chunks.end());
+      free_chunks.clear();
+    }
+  }
+  if (!ptrs.empty()) {
+    VLOG(2) << "Flushing " << ptrs.size() << " chunks from the thread caches"
+            << " of " << Name();
+    ReturnThreadCacheChunks(ptrs);
+  }
+}
+
 // Merges h1 and h2 when Chunk(h1)->next is h2 and Chunk(h2)->prev is c1.
 // We merge Chunk(h2) into Chunk(h1).
 void BFCAllocator::Merge(BFCAllocator::ChunkHandle h1,
@@ -1207,11 +1429,18 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
 
 absl::optional<AllocatorStats> BFCAllocator::GetStats() {
   mutex_lock l(lock_);
-  return stats_;
+  AllocatorStats stats = stats_;
+  stats.largest_free_block_bytes = LargestFreeChunkLocked();
+  stats.fragmentation = FragmentationLocked();
+  stats.num_cache_hits = num_cache_hits_.load(std::memory_order_relaxed);
+  stats.num_cache_misses = num_cache_misses_.load(std::memory_order_relaxed);
+  return stats;
 }
 
 bool BFCAllocator::ClearStats() {
   mutex_lock l(lock_);
+  num_cache_hits_.store(0, std::memory_order_relaxed);
+  num_cache_misses_.store(0, std::memory_order_relaxed);
   stats_.num_allocs = 0;
   stats_.peak_bytes_in_use = stats_.bytes_in_use;
   stats_.largest_alloc_size = 0;
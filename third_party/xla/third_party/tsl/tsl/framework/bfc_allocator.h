@@ -17,12 +17,14 @@ limitations under the License.
 #define TENSORFLOW_TSL_FRAMEWORK_BFC_ALLOCATOR_H_
 
 #include <array>
+#include <atomic>
 #include <deque>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "tsl/framework/allocator.h"
 #include "tsl/framework/allocator_retry.h"
@@ -68,6 +70,23 @@ class BFCAllocator : public Allocator {
     // Controls when a chunk should be split, if its size exceeds the requested
     // allocation size.
     double fragmentation_fraction = 0;
+
+    // If non-zero, allocations of at most this many bytes are rounded up to a
+    // power of two and served from caches of free chunks, one per size class
+    // in each of a fixed number of shards that threads are spread over. A
+    // cache that is empty takes `thread_cache_batch_size` chunks from the
+    // bins at once, and a cache that holds twice that many returns half of
+    // them, so that most small allocations do not take the allocator lock.
+    //
+    // Cached chunks count as in use in the allocator stats. The caches are not
+    // used with a timing counter or AllocationAttributes::freed_by_func, and
+    // they are flushed before the allocator reports that it is out of memory.
+    size_t thread_cache_max_bytes = 0;
+    int thread_cache_batch_size = 16;
+
+    // `Compact()` only releases memory when the fragmentation of the
+    // allocator, as reported in its stats, is at least this value.
+    double compaction_threshold = 0.5;
   };
   BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator, size_t total_memory,
                const string& name, const Options& opts);
@@ -101,6 +120,11 @@ class BFCAllocator : public Allocator {
 
   void SetSafeFrontier(uint64 count) override;
 
+  // Returns the regions that have no chunk in use to the sub-allocator, even
+  // if garbage collection is disabled. Chunks in use are never moved, so this
+  // does not help with fragmentation inside the regions that remain.
+  size_t Compact() override;
+
   AllocatorMemoryType GetMemoryType() const override;
 
   bool ShouldRecordOpName() const { return true; }
@@ -120,6 +144,52 @@ class BFCAllocator : public Allocator {
 
   void DeallocateRawInternal(void* ptr);
 
+  // Marks the chunk at `ptr` as free, and returns it to its bin.
+  void FreeChunkLocked(void* ptr) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns true if an allocation of `num_bytes` may be served from the thread
+  // caches.
+  bool UseThreadCache(size_t num_bytes,
+                      const AllocationAttributes& allocation_attr) const;
+
+  // Returns a chunk of the size class of `num_bytes` from the thread caches,
+  // refilling them from the bins if needed. Returns nullptr if the bins have
+  // no chunk of that size, after flushing the caches.
+  void* AllocateFromThreadCache(size_t num_bytes);
+
+  // Returns `ptr` to the thread caches. Returns false if `ptr` was not
+  // allocated from them.
+  bool DeallocateToThreadCache(void* ptr);
+
+  // Returns `ptrs`, which belong to the thread caches, to the bins.
+  void ReturnThreadCacheChunks(const std::vector<void*>& ptrs);
+
+  // Returns all the chunks held by the thread caches to the bins.
+  void FlushThreadCaches();
+
+  static constexpr int kNumThreadCacheShards = 32;
+  static constexpr int kNumCachedPtrShards = 64;
+
+  // The free chunks of one shard of the thread caches, by size class.
+  struct ThreadCacheShard {
+    mutex mu;
+    std::vector<std::vector<void*>> free_chunks TF_GUARDED_BY(mu);
+  };
+  // Maps every chunk that belongs to the thread caches, whether it is cached
+  // or in use, to its size class. Sharded by pointer so that deallocations do
+  // not contend with each other.
+  struct CachedPtrShard {
+    mutex mu;
+    absl::flat_hash_map<const void*, int> size_classes TF_GUARDED_BY(mu);
+  };
+  CachedPtrShard& CachedPtrShardFor(const void* ptr);
+
+  // Empty if the thread caches are disabled.
+  std::vector<ThreadCacheShard> thread_cache_shards_;
+  std::vector<CachedPtrShard> cached_ptr_shards_;
+  std::atomic<int64_t> num_cache_hits_{0};
+  std::atomic<int64_t> num_cache_misses_{0};
+
   // Chunks whose freed_at_count is later than the safe frontier value are kept
   // on a special list and not subject to merging immediately upon being freed.
   //
@@ -462,6 +532,17 @@ class BFCAllocator : public Allocator {
   // found and freed; false otherwise.
   bool DeallocateFreeRegions(size_t rounded_bytes);
 
+  // Adds the regions that have no chunk in use to `region_ptrs`, and returns
+  // their total size.
+  size_t FindFreeRegions(absl::flat_hash_set<void*>* region_ptrs)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns the size of the largest chunk in the bins.
+  size_t LargestFreeChunkLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns the value of `AllocatorStats::fragmentation`.
+  double FragmentationLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // Helper function to deallocate regions.
   void DeallocateRegions(const absl::flat_hash_set<void*>& region_ptrs)
       TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
@@ -16,6 +16,7 @@ limitations under the License.
 #include <algorithm>
 #include <atomic>
 
+#include "absl/container/flat_hash_map.h"
 #include "tsl/framework/allocator.h"
 #include "tsl/framework/allocator_registry.h"
 #include "tsl/framework/tracking_allocator.h"
@@ -104,35 +105,79 @@ class CPUAllocator : public Allocator {
                      << "% of free system memory";
       }
       if (p != nullptr) {
-        AddTraceMe("MemoryAllocation", p, num_bytes, alloc_size);
+        AddTraceMe("MemoryAllocation", p, num_bytes, alloc_size, stats_);
       }
+    } else if (p != nullptr && tsl::profiler::TraceMe::Active(
+                                   tsl::profiler::TraceMeLevel::kInfo)) {
+      RecordProfiledAllocation(p, num_bytes);
     }
     return p;
   }
 
   void DeallocateRaw(void* ptr) override {
+    if (num_profiled_allocations_.load(std::memory_order_relaxed) > 0) {
+      RecordProfiledDeallocation(ptr);
+    }
     if (cpu_allocator_collect_stats) {
       const std::size_t alloc_size =
           port::MallocExtension_GetAllocatedSize(ptr);
       mutex_lock l(mu_);
       stats_.bytes_in_use -= alloc_size;
-      AddTraceMe("MemoryDeallocation", ptr, 0, alloc_size);
+      AddTraceMe("MemoryDeallocation", ptr, 0, alloc_size, stats_);
     }
     port::AlignedFree(ptr);
   }
 
+  // Records an allocation made while the profiler is active, when the
+  // allocator does not collect stats. Only these allocations are tracked, so
+  // that the memory timeline of a profile is cheap to produce: when the
+  // profiler is not running, the cost is one TraceMe::Active() check per
+  // allocation and one atomic load per deallocation.
+  void RecordProfiledAllocation(void* ptr, std::size_t num_bytes) {
+    std::size_t alloc_size = port::MallocExtension_GetAllocatedSize(ptr);
+    if (alloc_size == 0) alloc_size = num_bytes;
+    mutex_lock l(mu_);
+    if (profiled_allocations_.empty()) {
+      // No tracked allocation is live, e.g. this is the first allocation of a
+      // new profile, so the peak starts from zero again.
+      profiled_stats_ = AllocatorStats();
+    }
+    profiled_allocations_[ptr] = alloc_size;
+    num_profiled_allocations_.fetch_add(1, std::memory_order_relaxed);
+    ++profiled_stats_.num_allocs;
+    profiled_stats_.bytes_in_use += alloc_size;
+    profiled_stats_.peak_bytes_in_use = std::max<int64_t>(
+        profiled_stats_.peak_bytes_in_use, profiled_stats_.bytes_in_use);
+    profiled_stats_.largest_alloc_size =
+        std::max<int64_t>(profiled_stats_.largest_alloc_size, alloc_size);
+    AddTraceMe("MemoryAllocation", ptr, num_bytes, alloc_size,
+               profiled_stats_);
+  }
+
+  void RecordProfiledDeallocation(void* ptr) {
+    mutex_lock l(mu_);
+    auto it = profiled_allocations_.find(ptr);
+    if (it == profiled_allocations_.end()) return;
+    const std::size_t alloc_size = it->second;
+    profiled_allocations_.erase(it);
+    num_profiled_allocations_.fetch_sub(1, std::memory_order_relaxed);
+    profiled_stats_.bytes_in_use -= alloc_size;
+    AddTraceMe("MemoryDeallocation", ptr, 0, alloc_size, profiled_stats_);
+  }
+
   void AddTraceMe(absl::string_view traceme_name, const void* chunk_ptr,
-                  std::size_t req_bytes, std::size_t alloc_bytes) {
+                  std::size_t req_bytes, std::size_t alloc_bytes,
+                  const AllocatorStats& stats) {
     tsl::profiler::TraceMe::InstantActivity(
-        [this, traceme_name, chunk_ptr, req_bytes,
-         alloc_bytes]() TF_NO_THREAD_SAFETY_ANALYSIS {
+        [this, traceme_name, chunk_ptr, req_bytes, alloc_bytes,
+         &stats]() TF_NO_THREAD_SAFETY_ANALYSIS {
           const auto& annotation =
               tsl::profiler::ScopedMemoryDebugAnnotation::CurrentAnnotation();
           return tsl::profiler::TraceMeEncode(
               traceme_name, {{"allocator_name", Name()},
-                             {"bytes_reserved", stats_.bytes_reserved},
-                             {"bytes_allocated", stats_.bytes_in_use},
-                             {"peak_bytes_in_use", stats_.peak_bytes_in_use},
+                             {"bytes_reserved", stats.bytes_reserved},
+                             {"bytes_allocated", stats.bytes_in_use},
+                             {"peak_bytes_in_use", stats.peak_bytes_in_use},
                              {"requested_bytes", req_bytes},
                              {"allocation_bytes", alloc_bytes},
                              {"addr", reinterpret_cast<uint64>(chunk_ptr)},
@@ -172,6 +217,13 @@ class CPUAllocator : public Allocator {
   mutex mu_;
   AllocatorStats stats_ TF_GUARDED_BY(mu_);
 
+  // Allocations recorded by RecordProfiledAllocation() which have not been
+  // deallocated yet, with their sizes, and their aggregated stats.
+  absl::flat_hash_map<const void*, std::size_t> profiled_allocations_
+      TF_GUARDED_BY(mu_);
+  std::atomic<int64_t> num_profiled_allocations_{0};
+  AllocatorStats profiled_stats_ TF_GUARDED_BY(mu_);
+
   // Use <atomic> for single allocations to avoid mutex contention when
   // statistics are disabled.
   std::atomic<int> single_allocation_warning_count_;
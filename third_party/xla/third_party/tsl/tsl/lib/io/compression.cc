@@ -23,6 +23,7 @@ const char kNone[] = "";
 const char kGzip[] = "GZIP";
 const char kSnappy[] = "SNAPPY";
 const char kZlib[] = "ZLIB";
+const char kZlibBlocks[] = "ZLIB_BLOCKS";
 
 }  // namespace compression
 }  // namespace io
@@ -16,6 +16,8 @@ limitations under the License.
 #include "tsl/lib/io/inputbuffer.h"
 
 #include <algorithm>
+#include <memory>
+#include <utility>
 
 #include "tsl/platform/errors.h"
 #include "tsl/platform/logging.h"
@@ -31,20 +33,73 @@ InputBuffer::InputBuffer(RandomAccessFile* file, size_t buffer_bytes)
       pos_(buf_),
       limit_(buf_) {}
 
-InputBuffer::~InputBuffer() { delete[] buf_; }
+InputBuffer::~InputBuffer() {
+  CancelReadahead();
+  delete[] buf_;
+  delete[] next_buf_;
+}
 
 Status InputBuffer::FillBuffer() {
   StringPiece data;
-  Status s = file_->Read(file_pos_, size_, &data, buf_);
+  Status s;
+  if (readahead_ != nullptr && readahead_->offset == file_pos_) {
+    readahead_->done.WaitForNotification();
+    std::swap(buf_, next_buf_);
+    data = StringPiece(buf_, readahead_->bytes);
+    s = readahead_->status;
+    readahead_.reset();
+  } else {
+    CancelReadahead();
+    s = file_->Read(file_pos_, size_, &data, buf_);
+  }
   if (data.data() != buf_) {
     memmove(buf_, data.data(), data.size());
   }
   pos_ = buf_;
   limit_ = pos_ + data.size();
   file_pos_ += data.size();
+  if (s.ok()) {
+    StartReadahead();
+  }
   return s;
 }
 
+void InputBuffer::StartReadahead() {
+  if (!async_reads_) return;
+  if (next_buf_ == nullptr) {
+    next_buf_ = new char[size_];
+  }
+  auto readahead = std::make_unique<Readahead>();
+  readahead->offset = file_pos_;
+  Readahead* r = readahead.get();
+  char* scratch = next_buf_;
+  Status s = file_->ReadAsync(
+      file_pos_, size_, scratch,
+      [r, scratch](const Status& status, StringPiece data) {
+        if (data.data() != scratch) {
+          memmove(scratch, data.data(), data.size());
+        }
+        r->bytes = data.size();
+        r->status = status;
+        r->done.Notify();
+      });
+  if (errors::IsUnimplemented(s)) {
+    async_reads_ = false;
+    delete[] next_buf_;
+    next_buf_ = nullptr;
+  } else if (s.ok()) {
+    readahead_ = std::move(readahead);
+  }
+  // Otherwise the next FillBuffer() reads the block itself.
+}
+
+void InputBuffer::CancelReadahead() {
+  if (readahead_ != nullptr) {
+    readahead_->done.WaitForNotification();
+    readahead_.reset();
+  }
+}
+
 template <typename T>
 Status InputBuffer::ReadLine(T* result) {
   result->clear();
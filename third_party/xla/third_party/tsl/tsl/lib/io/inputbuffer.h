@@ -16,11 +16,13 @@ limitations under the License.
 #ifndef TENSORFLOW_TSL_LIB_IO_INPUTBUFFER_H_
 #define TENSORFLOW_TSL_LIB_IO_INPUTBUFFER_H_
 
+#include <memory>
 #include <string>
 
 #include "tsl/platform/coding.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/macros.h"
+#include "tsl/platform/notification.h"
 #include "tsl/platform/status.h"
 #include "tsl/platform/types.h"
 
@@ -30,6 +32,9 @@ namespace io {
 // An InputBuffer provides a buffer on top of a RandomAccessFile.
 // A given instance of an InputBuffer is NOT safe for concurrent use
 // by multiple threads
+//
+// If the file supports RandomAccessFile::ReadAsync(), the block after the
+// buffer is read ahead into a second buffer while the first one is consumed.
 class InputBuffer {
  public:
   // Create an InputBuffer for "file" with a buffer size of
@@ -87,6 +92,13 @@ class InputBuffer {
  private:
   Status FillBuffer();
 
+  // Starts reading the block at "file_pos_" into "next_buf_", if the file
+  // supports asynchronous reads.
+  void StartReadahead();
+
+  // Waits for the block being read ahead, if any, and drops it.
+  void CancelReadahead();
+
   // Internal slow-path routine used by ReadVarint32().
   Status ReadVarint32Fallback(uint32* result);
 
@@ -107,6 +119,17 @@ class InputBuffer {
   char* pos_;    // Current position in "buf"
   char* limit_;  // Just past end of valid data in "buf"
 
+  // A block of "size_" bytes being read into "next_buf_".
+  struct Readahead {
+    int64_t offset;
+    Notification done;
+    Status status;
+    size_t bytes = 0;
+  };
+  char* next_buf_ = nullptr;
+  std::unique_ptr<Readahead> readahead_;
+  bool async_reads_ = true;  // Cleared if the file has no ReadAsync()
+
   InputBuffer(const InputBuffer&) = delete;
   void operator=(const InputBuffer&) = delete;
 };
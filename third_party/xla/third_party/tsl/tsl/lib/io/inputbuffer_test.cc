@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tsl/lib/io/inputbuffer.h"
 
+#include <algorithm>
+#include <utility>
 #include <vector>
 
 #include "tsl/lib/core/status_test_util.h"
@@ -30,6 +32,49 @@ limitations under the License.
 namespace tsl {
 namespace {
 
+// A file in memory whose asynchronous reads finish before ReadAsync()
+// returns.
+class AsyncStringFile : public RandomAccessFile {
+ public:
+  explicit AsyncStringFile(string contents) : contents_(std::move(contents)) {}
+
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    ++reads_;
+    return ReadInto(offset, n, result, scratch);
+  }
+
+  Status ReadAsync(uint64 offset, size_t n, char* scratch,
+                   ReadDoneCallback done) const override {
+    ++async_reads_;
+    StringPiece result;
+    Status s = ReadInto(offset, n, &result, scratch);
+    done(s, result);
+    return OkStatus();
+  }
+
+  int reads() const { return reads_; }
+  int async_reads() const { return async_reads_; }
+
+ private:
+  Status ReadInto(uint64 offset, size_t n, StringPiece* result,
+                  char* scratch) const {
+    const size_t available =
+        offset < contents_.size() ? contents_.size() - offset : 0;
+    const size_t bytes = std::min(n, available);
+    memcpy(scratch, contents_.data() + offset, bytes);
+    *result = StringPiece(scratch, bytes);
+    if (bytes < n) {
+      return errors::OutOfRange("EOF");
+    }
+    return OkStatus();
+  }
+
+  const string contents_;
+  mutable int reads_ = 0;
+  mutable int async_reads_ = 0;
+};
+
 static std::vector<int> BufferSizes() {
   return {1,  2,  3,  4,  5,  6,  7,  8,  9,  10,   11,
           12, 13, 14, 15, 16, 17, 18, 19, 20, 65536};
@@ -421,5 +466,56 @@ TEST(InputBuffer, Hint) {
   }
 }
 
+TEST(InputBuffer, AsyncReadahead) {
+  for (auto buf_size : BufferSizes()) {
+    AsyncStringFile file("0123456789");
+    string read;
+    io::InputBuffer in(&file, buf_size);
+
+    TF_CHECK_OK(in.ReadNBytes(3, &read));
+    EXPECT_EQ(read, "012");
+    TF_CHECK_OK(in.ReadNBytes(4, &read));
+    EXPECT_EQ(read, "3456");
+    TF_CHECK_OK(in.Seek(1));
+    TF_CHECK_OK(in.ReadNBytes(2, &read));
+    EXPECT_EQ(read, "12");
+    TF_CHECK_OK(in.Hint(2));
+    TF_CHECK_OK(in.ReadNBytes(5, &read));
+    EXPECT_EQ(read, "34567");
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(5, &read)));
+    EXPECT_EQ(read, "89");
+
+    if (buf_size < 10) {
+      // Blocks after the first are read ahead.
+      EXPECT_GT(file.async_reads(), 0);
+    }
+  }
+}
+
+#if defined(__linux__)
+TEST(InputBuffer, ReadLineThroughIoUring) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  TF_CHECK_OK(
+      WriteStringToFile(env, fname, "line one\nline two\nline three\n"));
+
+  for (auto buf_size : BufferSizes()) {
+    std::unique_ptr<RandomAccessFile> file;
+    TF_CHECK_OK(env->NewRandomAccessFile(strings::StrCat("uring://", fname),
+                                         &file));
+    string line;
+    io::InputBuffer in(file.get(), buf_size);
+    TF_CHECK_OK(in.ReadLine(&line));
+    EXPECT_EQ(line, "line one");
+    TF_CHECK_OK(in.ReadLine(&line));
+    EXPECT_EQ(line, "line two");
+    TF_CHECK_OK(in.ReadLine(&line));
+    EXPECT_EQ(line, "line three");
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadLine(&line)));
+  }
+}
+#endif
+
 }  // namespace
 }  // namespace tsl
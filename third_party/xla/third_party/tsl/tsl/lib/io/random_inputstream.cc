@@ -16,6 +16,7 @@ limitations under the License.
 #include "tsl/lib/io/random_inputstream.h"
 
 #include <memory>
+#include <utility>
 
 namespace tsl {
 namespace io {
@@ -25,6 +26,7 @@ RandomAccessInputStream::RandomAccessInputStream(RandomAccessFile* file,
     : file_(file), owns_file_(owns_file) {}
 
 RandomAccessInputStream::~RandomAccessInputStream() {
+  WaitForReadahead();
   if (owns_file_) {
     delete file_;
   }
@@ -35,21 +37,66 @@ Status RandomAccessInputStream::ReadNBytes(int64_t bytes_to_read,
   if (bytes_to_read < 0) {
     return errors::InvalidArgument("Cannot read negative number of bytes");
   }
-  result->clear();
-  result->resize_uninitialized(bytes_to_read);
-  char* result_buffer = &(*result)[0];
-  StringPiece data;
-  Status s = file_->Read(pos_, bytes_to_read, &data, result_buffer);
-  if (data.data() != result_buffer) {
-    memmove(result_buffer, data.data(), data.size());
+  Status s;
+  WaitForReadahead();
+  if (readahead_.offset == pos_ && readahead_.size == bytes_to_read) {
+    std::swap(*result, readahead_.buffer);
+    result->resize(readahead_.bytes);
+    s = readahead_.status;
+  } else {
+    result->clear();
+    result->resize_uninitialized(bytes_to_read);
+    char* result_buffer = &(*result)[0];
+    StringPiece data;
+    s = file_->Read(pos_, bytes_to_read, &data, result_buffer);
+    if (data.data() != result_buffer) {
+      memmove(result_buffer, data.data(), data.size());
+    }
+    result->resize(data.size());
   }
-  result->resize(data.size());
+  readahead_.offset = -1;
   if (s.ok() || errors::IsOutOfRange(s)) {
-    pos_ += data.size();
+    pos_ += result->size();
+  }
+  if (s.ok() && readahead_enabled_ && bytes_to_read > 0) {
+    StartReadahead(bytes_to_read);
   }
   return s;
 }
 
+void RandomAccessInputStream::StartReadahead(int64_t bytes_to_read) {
+  readahead_.buffer.resize_uninitialized(bytes_to_read);
+  char* scratch = &readahead_.buffer[0];
+  auto done = std::make_unique<Notification>();
+  Readahead* r = &readahead_;
+  Notification* n = done.get();
+  Status s = file_->ReadAsync(
+      pos_, bytes_to_read, scratch,
+      [r, n, scratch](const Status& status, StringPiece data) {
+        if (data.data() != scratch) {
+          memmove(scratch, data.data(), data.size());
+        }
+        r->bytes = data.size();
+        r->status = status;
+        n->Notify();
+      });
+  if (errors::IsUnimplemented(s)) {
+    readahead_enabled_ = false;
+    readahead_.buffer = tstring();
+  } else if (s.ok()) {
+    readahead_.offset = pos_;
+    readahead_.size = bytes_to_read;
+    readahead_.done = std::move(done);
+  }
+}
+
+void RandomAccessInputStream::WaitForReadahead() {
+  if (readahead_.done != nullptr) {
+    readahead_.done->WaitForNotification();
+    readahead_.done.reset();
+  }
+}
+
 #if defined(TF_CORD_SUPPORT)
 Status RandomAccessInputStream::ReadNBytes(int64_t bytes_to_read,
                                            absl::Cord* result) {
@@ -16,9 +16,12 @@ limitations under the License.
 #ifndef TENSORFLOW_TSL_LIB_IO_RANDOM_INPUTSTREAM_H_
 #define TENSORFLOW_TSL_LIB_IO_RANDOM_INPUTSTREAM_H_
 
+#include <memory>
+
 #include "tsl/lib/io/inputstream_interface.h"
 #include "tsl/platform/cord.h"
 #include "tsl/platform/file_system.h"
+#include "tsl/platform/notification.h"
 
 namespace tsl {
 namespace io {
@@ -50,10 +53,36 @@ class RandomAccessInputStream : public InputStreamInterface {
 
   Status Reset() override { return Seek(0); }
 
+  // Makes each ReadNBytes() into a tstring start reading as many bytes after
+  // the ones it returns, if the file supports asynchronous reads. This
+  // overlaps the reads of a sequential reader of fixed size blocks, such as
+  // BufferedInputStream, with the use of the previous block.
+  void EnableReadahead() { readahead_enabled_ = true; }
+
  private:
+  // Starts reading the "bytes_to_read" bytes at "pos_" into the buffer of
+  // "readahead_".
+  void StartReadahead(int64_t bytes_to_read);
+
+  // Waits for the block being read ahead, if any.
+  void WaitForReadahead();
+
   RandomAccessFile* file_;  // Not owned.
   int64_t pos_ = 0;         // Tracks where we are in the file.
   bool owns_file_ = false;
+
+  // A block being read ahead, whose buffer is swapped with the result of the
+  // ReadNBytes() asking for it.
+  struct Readahead {
+    int64_t offset = -1;
+    int64_t size = 0;
+    tstring buffer;
+    std::unique_ptr<Notification> done;
+    Status status;
+    size_t bytes = 0;
+  };
+  bool readahead_enabled_ = false;
+  Readahead readahead_;
 };
 
 }  // namespace io
@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tsl/lib/io/random_inputstream.h"
 
+#include <algorithm>
+#include <utility>
+
 #include "tsl/lib/core/status_test_util.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/test.h"
@@ -23,6 +26,46 @@ namespace tsl {
 namespace io {
 namespace {
 
+// A file in memory whose asynchronous reads finish before ReadAsync()
+// returns.
+class AsyncStringFile : public RandomAccessFile {
+ public:
+  explicit AsyncStringFile(string contents) : contents_(std::move(contents)) {}
+
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    ++reads_;
+    return ReadInto(offset, n, result, scratch);
+  }
+
+  Status ReadAsync(uint64 offset, size_t n, char* scratch,
+                   ReadDoneCallback done) const override {
+    StringPiece result;
+    Status s = ReadInto(offset, n, &result, scratch);
+    done(s, result);
+    return OkStatus();
+  }
+
+  int reads() const { return reads_; }
+
+ private:
+  Status ReadInto(uint64 offset, size_t n, StringPiece* result,
+                  char* scratch) const {
+    const size_t available =
+        offset < contents_.size() ? contents_.size() - offset : 0;
+    const size_t bytes = std::min(n, available);
+    memcpy(scratch, contents_.data() + offset, bytes);
+    *result = StringPiece(scratch, bytes);
+    if (bytes < n) {
+      return errors::OutOfRange("EOF");
+    }
+    return OkStatus();
+  }
+
+  const string contents_;
+  mutable int reads_ = 0;
+};
+
 TEST(RandomInputStream, ReadNBytes) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/random_inputbuffer_test";
@@ -52,6 +95,34 @@ TEST(RandomInputStream, ReadNBytes) {
   EXPECT_EQ(10, in.Tell());
 }
 
+TEST(RandomInputStream, ReadNBytesWithReadahead) {
+  AsyncStringFile file("0123456789");
+  tstring read;
+  RandomAccessInputStream in(&file);
+  in.EnableReadahead();
+  TF_ASSERT_OK(in.ReadNBytes(3, &read));
+  EXPECT_EQ(read, "012");
+  // The next 3 bytes were read ahead.
+  TF_ASSERT_OK(in.ReadNBytes(3, &read));
+  EXPECT_EQ(read, "345");
+  EXPECT_EQ(1, file.reads());
+  // Reads of another size or position do not use the block read ahead.
+  TF_ASSERT_OK(in.ReadNBytes(2, &read));
+  EXPECT_EQ(read, "67");
+  EXPECT_EQ(2, file.reads());
+  TF_ASSERT_OK(in.Seek(1));
+  TF_ASSERT_OK(in.ReadNBytes(2, &read));
+  EXPECT_EQ(read, "12");
+  EXPECT_EQ(3, file.reads());
+  TF_ASSERT_OK(in.ReadNBytes(2, &read));
+  EXPECT_EQ(read, "34");
+  EXPECT_EQ(3, file.reads());
+  TF_ASSERT_OK(in.Seek(8));
+  EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(3, &read)));
+  EXPECT_EQ(read, "89");
+  EXPECT_EQ(10, in.Tell());
+}
+
 #if defined(TF_CORD_SUPPORT)
 TEST(RandomInputStream, ReadNBytesWithCords) {
   Env* env = Env::Default();
@@ -46,6 +46,9 @@ RecordReaderOptions RecordReaderOptions::CreateRecordReaderOptions(
     options.zlib_options = io::ZlibCompressionOptions::GZIP();
   } else if (compression_type == compression::kSnappy) {
     options.compression_type = io::RecordReaderOptions::SNAPPY_COMPRESSION;
+  } else if (compression_type == compression::kZlibBlocks) {
+    options.compression_type = io::RecordReaderOptions::ZLIB_BLOCK_COMPRESSION;
+    options.zlib_options = io::ZlibCompressionOptions::DEFAULT();
   } else if (compression_type != compression::kNone) {
     LOG(ERROR) << "Unsupported compression_type:" << compression_type
                << ". No compression will be used.";
@@ -56,10 +59,13 @@ RecordReaderOptions RecordReaderOptions::CreateRecordReaderOptions(
 
 RecordReader::RecordReader(RandomAccessFile* file,
                            const RecordReaderOptions& options)
-    : options_(options),
-      input_stream_(new RandomAccessInputStream(file)),
-      last_read_failed_(false) {
+    : options_(options), last_read_failed_(false) {
+  auto* random_access_stream = new RandomAccessInputStream(file);
+  input_stream_.reset(random_access_stream);
   if (options.buffer_size > 0) {
+    // Buffered reads are sequential, so the next buffer can be read while
+    // the current one is parsed.
+    random_access_stream->EnableReadahead();
     input_stream_.reset(new BufferedInputStream(input_stream_.release(),
                                                 options.buffer_size, true));
   }
@@ -77,6 +83,10 @@ RecordReader::RecordReader(RandomAccessFile* file,
     input_stream_.reset(
         new SnappyInputStream(input_stream_.release(),
                               options.snappy_options.output_buffer_size, true));
+  } else if (options.compression_type ==
+             RecordReaderOptions::ZLIB_BLOCK_COMPRESSION) {
+    input_stream_.reset(new ZlibBlockInputStream(
+        input_stream_.release(), options.zlib_options, true));
   } else if (options.compression_type == RecordReaderOptions::NONE) {
     // Nothing to do.
   } else {
@@ -22,6 +22,7 @@ limitations under the License.
 #if !defined(IS_SLIM_BUILD)
 #include "tsl/lib/io/snappy/snappy_compression_options.h"
 #include "tsl/lib/io/snappy/snappy_inputstream.h"
+#include "tsl/lib/io/zlib_block_buffers.h"
 #include "tsl/lib/io/zlib_compression_options.h"
 #include "tsl/lib/io/zlib_inputstream.h"
 #endif  // IS_SLIM_BUILD
@@ -37,13 +38,18 @@ struct RecordReaderOptions {
   enum CompressionType {
     NONE = 0,
     ZLIB_COMPRESSION = 1,
-    SNAPPY_COMPRESSION = 2
+    SNAPPY_COMPRESSION = 2,
+    // Independently compressed zlib blocks, which are decompressed in
+    // parallel. See zlib_block_buffers.h.
+    ZLIB_BLOCK_COMPRESSION = 3
   };
   CompressionType compression_type = NONE;
 
   // If buffer_size is non-zero, then all reads must be sequential, and no
   // skipping around is permitted. (Note: this is the same behavior as reading
-  // compressed files.) Consider using SequentialRecordReader.
+  // compressed files.) Consider using SequentialRecordReader. Files that
+  // support RandomAccessFile::ReadAsync() then have the next buffer read
+  // while the current one is used.
   int64_t buffer_size = 0;
 
   static RecordReaderOptions CreateRecordReaderOptions(
@@ -30,6 +30,11 @@ bool IsZlibCompressed(const RecordWriterOptions& options) {
 bool IsSnappyCompressed(const RecordWriterOptions& options) {
   return options.compression_type == RecordWriterOptions::SNAPPY_COMPRESSION;
 }
+
+bool IsZlibBlockCompressed(const RecordWriterOptions& options) {
+  return options.compression_type ==
+         RecordWriterOptions::ZLIB_BLOCK_COMPRESSION;
+}
 }  // namespace
 
 RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
@@ -49,6 +54,9 @@ RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
     options.zlib_options = io::ZlibCompressionOptions::GZIP();
   } else if (compression_type == compression::kSnappy) {
     options.compression_type = io::RecordWriterOptions::SNAPPY_COMPRESSION;
+  } else if (compression_type == compression::kZlibBlocks) {
+    options.compression_type = io::RecordWriterOptions::ZLIB_BLOCK_COMPRESSION;
+    options.zlib_options = io::ZlibCompressionOptions::DEFAULT();
   } else if (compression_type != compression::kNone) {
     LOG(ERROR) << "Unsupported compression_type:" << compression_type
                << ". No compression will be used.";
@@ -79,6 +87,8 @@ RecordWriter::RecordWriter(WritableFile* dest,
     dest_ =
         new SnappyOutputBuffer(dest, options.snappy_options.input_buffer_size,
                                options.snappy_options.output_buffer_size);
+  } else if (IsZlibBlockCompressed(options)) {
+    dest_ = new ZlibBlockOutputBuffer(dest, options.zlib_options);
   } else if (options.compression_type == RecordWriterOptions::NONE) {
     // Nothing to do
   } else {
@@ -112,7 +122,8 @@ Status RecordWriter::WriteRecord(StringPiece data) {
   PopulateFooter(footer, data.data(), data.size());
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(StringPiece(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+  return EndRecord();
 }
 
 #if defined(TF_CORD_SUPPORT)
@@ -132,13 +143,24 @@ Status RecordWriter::WriteRecord(const absl::Cord& data) {
   PopulateFooter(footer, data);
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(StringPiece(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+  return EndRecord();
 }
 #endif
 
+Status RecordWriter::EndRecord() {
+#if !defined(IS_SLIM_BUILD)
+  if (IsZlibBlockCompressed(options_)) {
+    return static_cast<ZlibBlockOutputBuffer*>(dest_)->EndRecord();
+  }
+#endif
+  return OkStatus();
+}
+
 Status RecordWriter::Close() {
   if (dest_ == nullptr) return OkStatus();
-  if (IsZlibCompressed(options_) || IsSnappyCompressed(options_)) {
+  if (IsZlibCompressed(options_) || IsSnappyCompressed(options_) ||
+      IsZlibBlockCompressed(options_)) {
     Status s = dest_->Close();
     delete dest_;
     dest_ = nullptr;
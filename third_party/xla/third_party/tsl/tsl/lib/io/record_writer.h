@@ -23,6 +23,7 @@ limitations under the License.
 #if !defined(IS_SLIM_BUILD)
 #include "tsl/lib/io/snappy/snappy_compression_options.h"
 #include "tsl/lib/io/snappy/snappy_outputbuffer.h"
+#include "tsl/lib/io/zlib_block_buffers.h"
 #include "tsl/lib/io/zlib_compression_options.h"
 #include "tsl/lib/io/zlib_outputbuffer.h"
 #endif  // IS_SLIM_BUILD
@@ -41,7 +42,10 @@ struct RecordWriterOptions {
   enum CompressionType {
     NONE = 0,
     ZLIB_COMPRESSION = 1,
-    SNAPPY_COMPRESSION = 2
+    SNAPPY_COMPRESSION = 2,
+    // Independently compressed zlib blocks of whole records, see
+    // zlib_block_buffers.h.
+    ZLIB_BLOCK_COMPRESSION = 3
   };
   CompressionType compression_type = NONE;
 
@@ -111,6 +115,9 @@ class RecordWriter {
 #endif
 
  private:
+  // Lets block compression end a block after the record just written.
+  Status EndRecord();
+
   WritableFile* dest_;
   RecordWriterOptions options_;
 
@@ -0,0 +1,457 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tsl/lib/io/zlib_block_buffers.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tsl/lib/hash/crc32c.h"
+#include "tsl/platform/coding.h"
+#include "tsl/platform/cpu_info.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/notification.h"
+#include "tsl/platform/raw_coding.h"
+#include "tsl/platform/threadpool.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+constexpr size_t kHeaderSize = 2 * sizeof(uint64) + sizeof(uint32);
+constexpr size_t kCrcSize = sizeof(uint32);
+constexpr size_t kFooterSize = 2 * sizeof(uint64);
+constexpr size_t kIndexEntrySize = 2 * sizeof(uint64);
+
+uint32 MaskedCrc(const char* data, size_t n) {
+  return crc32c::Mask(crc32c::Value(data, n));
+}
+
+// Shared by all buffers, so that files read or written at the same time do
+// not each start threads.
+thread::ThreadPool* ZlibBlockThreadPool() {
+  static thread::ThreadPool* pool = new thread::ThreadPool(
+      Env::Default(), "zlib_blocks", port::MaxParallelism());
+  return pool;
+}
+
+void EncodeHeader(uint64 compressed_size, uint64 uncompressed_size,
+                  char* header) {
+  core::EncodeFixed64(header, compressed_size);
+  core::EncodeFixed64(header + sizeof(uint64), uncompressed_size);
+  core::EncodeFixed32(header + 2 * sizeof(uint64),
+                      MaskedCrc(header, 2 * sizeof(uint64)));
+}
+
+Status DecodeHeader(const char* header, uint64* compressed_size,
+                    uint64* uncompressed_size) {
+  if (core::DecodeFixed32(header + 2 * sizeof(uint64)) !=
+      MaskedCrc(header, 2 * sizeof(uint64))) {
+    return errors::DataLoss("corrupted zlib block header");
+  }
+  *compressed_size = core::DecodeFixed64(header);
+  *uncompressed_size = core::DecodeFixed64(header + sizeof(uint64));
+  return OkStatus();
+}
+
+// zlib takes at most UINT_MAX bytes at a time, so larger blocks are
+// compressed and decompressed in several calls.
+Status Compress(const ZlibCompressionOptions& options, StringPiece input,
+                string* output) {
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  int error = deflateInit2(&stream, options.compression_level,
+                           options.compression_method, options.window_bits,
+                           options.mem_level, options.compression_strategy);
+  if (error != Z_OK) {
+    return errors::Internal("deflateInit2 failed with error ", error);
+  }
+  output->resize(deflateBound(&stream, input.size()));
+  const char* in = input.data();
+  size_t in_left = input.size();
+  char* out = &(*output)[0];
+  size_t out_left = output->size();
+  do {
+    const uInt in_chunk = std::min<size_t>(in_left, UINT_MAX);
+    const uInt out_chunk = std::min<size_t>(out_left, UINT_MAX);
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in));
+    stream.avail_in = in_chunk;
+    stream.next_out = reinterpret_cast<Bytef*>(out);
+    stream.avail_out = out_chunk;
+    error = deflate(&stream, in_chunk == in_left ? Z_FINISH : Z_NO_FLUSH);
+    in += in_chunk - stream.avail_in;
+    in_left -= in_chunk - stream.avail_in;
+    out += out_chunk - stream.avail_out;
+    out_left -= out_chunk - stream.avail_out;
+  } while (error == Z_OK);
+  deflateEnd(&stream);
+  if (error != Z_STREAM_END) {
+    return errors::Internal("deflate failed with error ", error);
+  }
+  output->resize(output->size() - out_left);
+  return OkStatus();
+}
+
+// Checks and decompresses the data of a block followed by its crc.
+Status Decompress(const ZlibCompressionOptions& options, StringPiece block,
+                  uint64 uncompressed_size, string* output) {
+  const size_t compressed_size = block.size() - kCrcSize;
+  if (core::DecodeFixed32(block.data() + compressed_size) !=
+      MaskedCrc(block.data(), compressed_size)) {
+    return errors::DataLoss("zlib block checksum mismatch");
+  }
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  int error = inflateInit2(&stream, options.window_bits);
+  if (error != Z_OK) {
+    return errors::Internal("inflateInit2 failed with error ", error);
+  }
+  output->resize(uncompressed_size);
+  const char* in = block.data();
+  size_t in_left = compressed_size;
+  char* out = &(*output)[0];
+  size_t out_left = output->size();
+  bool progress;
+  do {
+    const uInt in_chunk = std::min<size_t>(in_left, UINT_MAX);
+    const uInt out_chunk = std::min<size_t>(out_left, UINT_MAX);
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in));
+    stream.avail_in = in_chunk;
+    stream.next_out = reinterpret_cast<Bytef*>(out);
+    stream.avail_out = out_chunk;
+    error = inflate(&stream, Z_NO_FLUSH);
+    progress = stream.avail_in < in_chunk || stream.avail_out < out_chunk;
+    in += in_chunk - stream.avail_in;
+    in_left -= in_chunk - stream.avail_in;
+    out += out_chunk - stream.avail_out;
+    out_left -= out_chunk - stream.avail_out;
+  } while (error == Z_OK && progress);
+  inflateEnd(&stream);
+  if (error != Z_STREAM_END || out_left != 0) {
+    return errors::DataLoss("corrupted zlib block");
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
+Status ReadZlibBlockIndex(RandomAccessFile* file, uint64 file_size,
+                          std::vector<ZlibBlockIndexEntry>* index) {
+  index->clear();
+  if (file_size < kHeaderSize + kCrcSize + kFooterSize) {
+    return errors::DataLoss("file too small for a zlib block index");
+  }
+  char footer[kFooterSize];
+  StringPiece result;
+  TF_RETURN_IF_ERROR(
+      file->Read(file_size - kFooterSize, kFooterSize, &result, footer));
+  if (core::DecodeFixed64(result.data() + sizeof(uint64)) !=
+      kZlibBlockFooterMagic) {
+    return errors::DataLoss("no zlib block index footer");
+  }
+  const uint64 index_offset = core::DecodeFixed64(result.data());
+  if (index_offset > file_size - kFooterSize - kHeaderSize - kCrcSize) {
+    return errors::DataLoss("invalid zlib block index offset ",
+                            index_offset);
+  }
+  const size_t size = file_size - kFooterSize - index_offset;
+  std::unique_ptr<char[]> scratch(new char[size]);
+  TF_RETURN_IF_ERROR(file->Read(index_offset, size, &result, scratch.get()));
+  uint64 entries_size, marker;
+  TF_RETURN_IF_ERROR(DecodeHeader(result.data(), &entries_size, &marker));
+  if (marker != kZlibBlockIndexMarker ||
+      entries_size != size - kHeaderSize - kCrcSize ||
+      entries_size % kIndexEntrySize != 0) {
+    return errors::DataLoss("corrupted zlib block index");
+  }
+  const char* entries = result.data() + kHeaderSize;
+  if (core::DecodeFixed32(entries + entries_size) !=
+      MaskedCrc(entries, entries_size)) {
+    return errors::DataLoss("zlib block index checksum mismatch");
+  }
+  for (const char* p = entries; p < entries + entries_size;
+       p += kIndexEntrySize) {
+    index->push_back(
+        {core::DecodeFixed64(p), core::DecodeFixed64(p + sizeof(uint64))});
+  }
+  return OkStatus();
+}
+
+struct ZlibBlockOutputBuffer::Block {
+  string input;
+  uint64 uncompressed_size;
+  string compressed;
+  Status status;
+  Notification done;
+};
+
+ZlibBlockOutputBuffer::ZlibBlockOutputBuffer(
+    WritableFile* file, const ZlibCompressionOptions& zlib_options)
+    : file_(file), zlib_options_(zlib_options) {}
+
+ZlibBlockOutputBuffer::~ZlibBlockOutputBuffer() {
+  if (!closed_) {
+    LOG(WARNING)
+        << "ZlibBlockOutputBuffer::Close() not called. Possible data loss";
+  }
+  for (const auto& block : pending_) {
+    block->done.WaitForNotification();
+  }
+}
+
+Status ZlibBlockOutputBuffer::Append(StringPiece data) {
+  buffer_.append(data.data(), data.size());
+  return OkStatus();
+}
+
+#if defined(TF_CORD_SUPPORT)
+Status ZlibBlockOutputBuffer::Append(const absl::Cord& cord) {
+  for (absl::string_view fragment : cord.Chunks()) {
+    buffer_.append(fragment.data(), fragment.size());
+  }
+  return OkStatus();
+}
+#endif
+
+Status ZlibBlockOutputBuffer::EndRecord() {
+  if (static_cast<int64_t>(buffer_.size()) < zlib_options_.block_size) {
+    return OkStatus();
+  }
+  EndBlock();
+  return WriteBlocks(std::max(zlib_options_.max_pending_blocks, 1));
+}
+
+void ZlibBlockOutputBuffer::EndBlock() {
+  if (buffer_.empty()) return;
+  auto block = std::make_unique<Block>();
+  block->input = std::move(buffer_);
+  block->uncompressed_size = block->input.size();
+  buffer_.clear();
+  Block* b = block.get();
+  const ZlibCompressionOptions* options = &zlib_options_;
+  ZlibBlockThreadPool()->Schedule([b, options] {
+    b->status = Compress(*options, b->input, &b->compressed);
+    b->input = string();
+    b->done.Notify();
+  });
+  pending_.push_back(std::move(block));
+}
+
+Status ZlibBlockOutputBuffer::WriteBlocks(size_t max_pending) {
+  while (!pending_.empty()) {
+    Block* block = pending_.front().get();
+    if (pending_.size() <= max_pending && !block->done.HasBeenNotified()) {
+      break;
+    }
+    block->done.WaitForNotification();
+    TF_RETURN_IF_ERROR(block->status);
+    index_.push_back({file_offset_, uncompressed_offset_});
+    TF_RETURN_IF_ERROR(WriteFrame(block->uncompressed_size, block->compressed));
+    uncompressed_offset_ += block->uncompressed_size;
+    pending_.pop_front();
+  }
+  return OkStatus();
+}
+
+Status ZlibBlockOutputBuffer::WriteFrame(uint64 uncompressed_size,
+                                         StringPiece data) {
+  char header[kHeaderSize];
+  char crc[kCrcSize];
+  EncodeHeader(data.size(), uncompressed_size, header);
+  core::EncodeFixed32(crc, MaskedCrc(data.data(), data.size()));
+  TF_RETURN_IF_ERROR(file_->Append(StringPiece(header, sizeof(header))));
+  TF_RETURN_IF_ERROR(file_->Append(data));
+  TF_RETURN_IF_ERROR(file_->Append(StringPiece(crc, sizeof(crc))));
+  file_offset_ += kHeaderSize + data.size() + kCrcSize;
+  return OkStatus();
+}
+
+Status ZlibBlockOutputBuffer::Flush() {
+  EndBlock();
+  TF_RETURN_IF_ERROR(WriteBlocks(0));
+  return file_->Flush();
+}
+
+Status ZlibBlockOutputBuffer::Name(StringPiece* result) const {
+  return file_->Name(result);
+}
+
+Status ZlibBlockOutputBuffer::Sync() {
+  TF_RETURN_IF_ERROR(Flush());
+  return file_->Sync();
+}
+
+Status ZlibBlockOutputBuffer::Close() {
+  if (closed_) return OkStatus();
+  EndBlock();
+  TF_RETURN_IF_ERROR(WriteBlocks(0));
+  string entries;
+  for (const ZlibBlockIndexEntry& entry : index_) {
+    core::PutFixed64(&entries, entry.offset);
+    core::PutFixed64(&entries, entry.uncompressed_offset);
+  }
+  const uint64 index_offset = file_offset_;
+  TF_RETURN_IF_ERROR(WriteFrame(kZlibBlockIndexMarker, entries));
+  string footer;
+  core::PutFixed64(&footer, index_offset);
+  core::PutFixed64(&footer, kZlibBlockFooterMagic);
+  TF_RETURN_IF_ERROR(file_->Append(footer));
+  closed_ = true;
+  return OkStatus();
+}
+
+struct ZlibBlockInputStream::Block {
+  tstring compressed;  // Followed by its crc
+  uint64 uncompressed_size;
+  string data;
+  Status status;
+  Notification done;
+};
+
+ZlibBlockInputStream::ZlibBlockInputStream(
+    InputStreamInterface* input_stream,
+    const ZlibCompressionOptions& zlib_options, bool owns_input_stream)
+    : input_stream_(input_stream),
+      zlib_options_(zlib_options),
+      owns_input_stream_(owns_input_stream) {}
+
+ZlibBlockInputStream::~ZlibBlockInputStream() {
+  DropBlocks();
+  if (owns_input_stream_) {
+    delete input_stream_;
+  }
+}
+
+void ZlibBlockInputStream::ReadBlocks() {
+  const size_t max_pending = std::max(zlib_options_.max_pending_blocks, 1);
+  while (!input_done_ && pending_.size() < max_pending) {
+    if (block_limit_ >= 0 && blocks_read_ >= block_limit_) {
+      input_done_ = true;
+      break;
+    }
+    tstring header;
+    Status s = input_stream_->ReadNBytes(kHeaderSize, &header);
+    if (errors::IsOutOfRange(s) && header.empty()) {
+      // No index yet: the writer may still be appending blocks, so a later
+      // read tries again.
+      break;
+    }
+    uint64 compressed_size = 0, uncompressed_size = 0;
+    if (s.ok()) {
+      s = DecodeHeader(header.data(), &compressed_size, &uncompressed_size);
+    } else if (errors::IsOutOfRange(s)) {
+      s = errors::DataLoss("truncated zlib block header");
+    }
+    if (s.ok() && uncompressed_size == kZlibBlockIndexMarker) {
+      input_done_ = true;
+      break;
+    }
+    auto block = std::make_unique<Block>();
+    if (s.ok()) {
+      block->uncompressed_size = uncompressed_size;
+      s = input_stream_->ReadNBytes(compressed_size + kCrcSize,
+                                    &block->compressed);
+      if (errors::IsOutOfRange(s)) {
+        s = errors::DataLoss("truncated zlib block");
+      }
+    }
+    if (!s.ok()) {
+      input_status_ = s;
+      input_done_ = true;
+      break;
+    }
+    Block* b = block.get();
+    const ZlibCompressionOptions* options = &zlib_options_;
+    ZlibBlockThreadPool()->Schedule([b, options] {
+      b->status =
+          Decompress(*options, b->compressed, b->uncompressed_size, &b->data);
+      b->compressed = tstring();
+      b->done.Notify();
+    });
+    pending_.push_back(std::move(block));
+    ++blocks_read_;
+  }
+}
+
+Status ZlibBlockInputStream::NextBlock() {
+  current_.reset();
+  pos_ = 0;
+  ReadBlocks();
+  if (pending_.empty()) {
+    if (!input_status_.ok()) return input_status_;
+    return errors::OutOfRange("End of zlib block data");
+  }
+  std::unique_ptr<Block> block = std::move(pending_.front());
+  pending_.pop_front();
+  // Starts on the next block before waiting for this one.
+  ReadBlocks();
+  block->done.WaitForNotification();
+  TF_RETURN_IF_ERROR(block->status);
+  current_ = std::move(block);
+  return OkStatus();
+}
+
+Status ZlibBlockInputStream::ReadNBytes(int64_t bytes_to_read,
+                                        tstring* result) {
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Can't read a negative number of bytes: ",
+                                   bytes_to_read);
+  }
+  result->clear();
+  while (result->size() < static_cast<size_t>(bytes_to_read)) {
+    if (current_ == nullptr || pos_ == current_->data.size()) {
+      TF_RETURN_IF_ERROR(NextBlock());
+    }
+    const size_t n = std::min<size_t>(bytes_to_read - result->size(),
+                                      current_->data.size() - pos_);
+    result->append(current_->data.data() + pos_, n);
+    pos_ += n;
+    bytes_read_ += n;
+  }
+  return OkStatus();
+}
+
+int64_t ZlibBlockInputStream::Tell() const { return bytes_read_; }
+
+Status ZlibBlockInputStream::Reset() {
+  DropBlocks();
+  current_.reset();
+  pos_ = 0;
+  bytes_read_ = 0;
+  blocks_read_ = 0;
+  input_done_ = false;
+  input_status_ = OkStatus();
+  return input_stream_->Reset();
+}
+
+void ZlibBlockInputStream::DropBlocks() {
+  for (const auto& block : pending_) {
+    block->done.WaitForNotification();
+  }
+  pending_.clear();
+}
+
+}  // namespace io
+}  // namespace tsl
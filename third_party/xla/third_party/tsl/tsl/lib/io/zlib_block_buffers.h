@@ -0,0 +1,204 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#ifndef TENSORFLOW_TSL_LIB_IO_ZLIB_BLOCK_BUFFERS_H_
+#define TENSORFLOW_TSL_LIB_IO_ZLIB_BLOCK_BUFFERS_H_
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tsl/lib/io/inputstream_interface.h"
+#include "tsl/lib/io/zlib_compression_options.h"
+#include "tsl/platform/cord.h"
+#include "tsl/platform/file_system.h"
+#include "tsl/platform/status.h"
+#include "tsl/platform/stringpiece.h"
+#include "tsl/platform/types.h"
+
+namespace tsl {
+namespace io {
+
+// Block-framed zlib compression: the data is split into blocks that are
+// compressed independently, so that blocks can be compressed and
+// decompressed in parallel, and a file can be split between readers at
+// block boundaries.
+//
+// Format:
+//   block*
+//   index
+//   footer
+//
+// block:
+//   uint64    length of the compressed data, n
+//   uint64    length of the uncompressed data
+//   uint32    masked crc of the two lengths
+//   byte      compressed data[n], a zlib stream
+//   uint32    masked crc of the compressed data
+//
+// index: a block whose uncompressed length is kZlibBlockIndexMarker, and
+// whose data holds one entry per block:
+//   uint64    offset of the block in the file
+//   uint64    offset of its uncompressed data
+//
+// footer:
+//   uint64    offset of the index in the file
+//   uint64    kZlibBlockFooterMagic
+constexpr uint64 kZlibBlockIndexMarker = ~uint64{0};
+constexpr uint64 kZlibBlockFooterMagic = 0x314b4c425a524654;  // "TFRZBLK1"
+
+// An entry of the index of a block-framed file.
+struct ZlibBlockIndexEntry {
+  uint64 offset;
+  uint64 uncompressed_offset;
+};
+
+// Reads the index of the block-framed `file` of `file_size` bytes.
+Status ReadZlibBlockIndex(RandomAccessFile* file, uint64 file_size,
+                          std::vector<ZlibBlockIndexEntry>* index);
+
+// Writes block-framed zlib data to the start of `file`. Data is buffered
+// until it fills a block at the next EndRecord(), so that blocks hold whole
+// records and readers can start at any block.
+//
+// Blocks are compressed on a shared thread pool, up to
+// `zlib_options.max_pending_blocks` at a time, and written in order.
+//
+// A given instance of a ZlibBlockOutputBuffer is NOT safe for concurrent use
+// by multiple threads.
+class ZlibBlockOutputBuffer : public WritableFile {
+ public:
+  // Does not take ownership of `file`.
+  ZlibBlockOutputBuffer(WritableFile* file,
+                        const ZlibCompressionOptions& zlib_options);
+
+  ~ZlibBlockOutputBuffer() override;
+
+  Status Append(StringPiece data) override;
+
+#if defined(TF_CORD_SUPPORT)
+  Status Append(const absl::Cord& cord) override;
+#endif
+
+  // Ends the current block if it holds at least `zlib_options.block_size`
+  // bytes. Called between records.
+  Status EndRecord();
+
+  // Compresses and writes all buffered data, then flushes `file`.
+  Status Flush() override;
+
+  Status Name(StringPiece* result) const override;
+
+  Status Sync() override;
+
+  // Writes all buffered data and the index. Does not close `file`. This must
+  // be called before the destructor to avoid any data loss.
+  Status Close() override;
+
+ private:
+  struct Block;
+
+  // Starts compressing the buffered data as a block.
+  void EndBlock();
+
+  // Writes the compressed blocks in order, waiting for them until at most
+  // `max_pending` blocks are left.
+  Status WriteBlocks(size_t max_pending);
+
+  // Writes a block with the given data to `file_`.
+  Status WriteFrame(uint64 uncompressed_size, StringPiece data);
+
+  WritableFile* file_;  // Not owned
+  const ZlibCompressionOptions zlib_options_;
+  string buffer_;
+  std::deque<std::unique_ptr<Block>> pending_;
+  uint64 file_offset_ = 0;
+  uint64 uncompressed_offset_ = 0;
+  std::vector<ZlibBlockIndexEntry> index_;
+  bool closed_ = false;
+
+  ZlibBlockOutputBuffer(const ZlibBlockOutputBuffer&) = delete;
+  void operator=(const ZlibBlockOutputBuffer&) = delete;
+};
+
+// Reads the uncompressed data of block-framed zlib data from `input_stream`,
+// which must be positioned at the start of a block.
+//
+// Blocks are read ahead and decompressed on a shared thread pool, up to
+// `zlib_options.max_pending_blocks` at a time.
+//
+// A given instance of a ZlibBlockInputStream is NOT safe for concurrent use
+// by multiple threads.
+class ZlibBlockInputStream : public InputStreamInterface {
+ public:
+  // Takes ownership of `input_stream` iff `owns_input_stream` is true.
+  ZlibBlockInputStream(InputStreamInterface* input_stream,
+                       const ZlibCompressionOptions& zlib_options,
+                       bool owns_input_stream = false);
+
+  ~ZlibBlockInputStream() override;
+
+  // Reads bytes_to_read bytes into *result, overwriting *result. Returns
+  // OUT_OF_RANGE with the bytes that were left at the end of the data.
+  Status ReadNBytes(int64_t bytes_to_read, tstring* result) override;
+
+  int64_t Tell() const override;
+
+  // Goes back to the start of `input_stream`.
+  Status Reset() override;
+
+  // Ends the data after `num_blocks` blocks, e.g. to read the blocks of a
+  // shard from a stream positioned at the first one with
+  // ReadZlibBlockIndex().
+  void SetBlockLimit(int64_t num_blocks) { block_limit_ = num_blocks; }
+
+ private:
+  struct Block;
+
+  // Reads blocks from `input_stream_` and starts decompressing them until
+  // `zlib_options_.max_pending_blocks` are pending or the data ends.
+  void ReadBlocks();
+
+  // Makes the next block current, waiting for its data.
+  Status NextBlock();
+
+  // Waits for the pending blocks and drops them.
+  void DropBlocks();
+
+  InputStreamInterface* input_stream_;
+  const ZlibCompressionOptions zlib_options_;
+  const bool owns_input_stream_;
+  std::deque<std::unique_ptr<Block>> pending_;
+  std::unique_ptr<Block> current_;
+  size_t pos_ = 0;  // Position in the data of `current_`
+  int64_t bytes_read_ = 0;
+  int64_t block_limit_ = -1;  // Unlimited if negative
+  int64_t blocks_read_ = 0;
+  // Set when there are no more blocks to read, with an error if reading
+  // them failed.
+  bool input_done_ = false;
+  Status input_status_;
+
+  ZlibBlockInputStream(const ZlibBlockInputStream&) = delete;
+  void operator=(const ZlibBlockInputStream&) = delete;
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_ZLIB_BLOCK_BUFFERS_H_
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tsl/lib/core/status_test_util.h"
 #include "tsl/lib/io/random_inputstream.h"
+#include "tsl/lib/io/zlib_block_buffers.h"
 #include "tsl/lib/io/zlib_compression_options.h"
 #include "tsl/lib/io/zlib_inputstream.h"
 #include "tsl/lib/io/zlib_outputbuffer.h"
@@ -373,5 +374,112 @@ TEST(ZlibInputStream, TestSoftErrorOnDecompressGzip) {
   TestSoftErrorOnDecompress(CompressionOptions::GZIP());
 }
 
+void WriteZlibBlockFile(Env* env, const string& fname, const string& data,
+                        const CompressionOptions& options) {
+  std::unique_ptr<WritableFile> file_writer;
+  TF_ASSERT_OK(env->NewWritableFile(fname, &file_writer));
+  ZlibBlockOutputBuffer out(file_writer.get(), options);
+  // Appends the data as records of varying sizes.
+  size_t pos = 0;
+  for (size_t n = 1; pos < data.size(); n = n * 3 % 997 + 1) {
+    TF_ASSERT_OK(out.Append(StringPiece(data).substr(pos, n)));
+    TF_ASSERT_OK(out.EndRecord());
+    pos += n;
+  }
+  TF_ASSERT_OK(out.Close());
+  TF_ASSERT_OK(file_writer->Close());
+}
+
+TEST(ZlibBlockBuffers, RoundTrip) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  CompressionOptions options;
+  options.block_size = 1000;
+  options.max_pending_blocks = 3;
+  for (auto copies : NumCopies()) {
+    string data = GenTestString(copies);
+    WriteZlibBlockFile(env, fname, data, options);
+
+    for (auto read_size : InputBufferSizes()) {
+      std::unique_ptr<RandomAccessFile> file_reader;
+      TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+      ZlibBlockInputStream in(new RandomAccessInputStream(file_reader.get()),
+                              options, true);
+      string result;
+      tstring chunk;
+      while (result.size() < data.size()) {
+        const int64_t n = std::min<int64_t>(read_size,
+                                            data.size() - result.size());
+        TF_ASSERT_OK(in.ReadNBytes(n, &chunk));
+        result.append(chunk.data(), chunk.size());
+        EXPECT_EQ(in.Tell(), result.size());
+      }
+      EXPECT_EQ(result, data);
+      EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &chunk)));
+
+      TF_ASSERT_OK(in.Reset());
+      TF_ASSERT_OK(in.ReadNBytes(data.size(), &chunk));
+      EXPECT_EQ(chunk, data);
+    }
+  }
+}
+
+TEST(ZlibBlockBuffers, ReadBlocksFromIndex) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  CompressionOptions options;
+  options.block_size = 1000;
+  string data = GenTestString(50);
+  WriteZlibBlockFile(env, fname, data, options);
+
+  uint64 file_size;
+  TF_ASSERT_OK(env->GetFileSize(fname, &file_size));
+  std::unique_ptr<RandomAccessFile> file_reader;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+  std::vector<ZlibBlockIndexEntry> index;
+  TF_ASSERT_OK(ReadZlibBlockIndex(file_reader.get(), file_size, &index));
+  ASSERT_GT(index.size(), 1);
+
+  // Reads every block on its own, as a reader of one shard of the file would.
+  for (size_t i = 0; i < index.size(); ++i) {
+    const uint64 start = index[i].uncompressed_offset;
+    const uint64 end =
+        i + 1 < index.size() ? index[i + 1].uncompressed_offset : data.size();
+    RandomAccessInputStream* input_stream =
+        new RandomAccessInputStream(file_reader.get());
+    TF_ASSERT_OK(input_stream->Seek(index[i].offset));
+    ZlibBlockInputStream in(input_stream, options, true);
+    in.SetBlockLimit(1);
+    tstring result;
+    TF_ASSERT_OK(in.ReadNBytes(end - start, &result));
+    EXPECT_EQ(result, data.substr(start, end - start));
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &result)));
+  }
+}
+
+TEST(ZlibBlockBuffers, CorruptedBlock) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  CompressionOptions options;
+  options.block_size = 1000;
+  string data = GenTestString(50);
+  WriteZlibBlockFile(env, fname, data, options);
+
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(env, fname, &contents));
+  contents[contents.size() / 2] ^= 0x55;
+  TF_ASSERT_OK(WriteStringToFile(env, fname, contents));
+
+  std::unique_ptr<RandomAccessFile> file_reader;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+  ZlibBlockInputStream in(new RandomAccessInputStream(file_reader.get()),
+                          options, true);
+  tstring result;
+  EXPECT_TRUE(errors::IsDataLoss(in.ReadNBytes(data.size(), &result)));
+}
+
 }  // namespace io
 }  // namespace tsl
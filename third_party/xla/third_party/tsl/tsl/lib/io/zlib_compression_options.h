@@ -117,6 +117,14 @@ class ZlibCompressionOptions {
   //
   // This option is ignored for `ZlibOutputBuffer`.
   bool soft_fail_on_error = false;  // NOLINT
+
+  // Size of the uncompressed blocks written by `ZlibBlockOutputBuffer`, which
+  // only ends blocks between records, so blocks may be larger.
+  int64_t block_size = 1 << 20;
+
+  // Number of blocks that `ZlibBlockOutputBuffer` and `ZlibBlockInputStream`
+  // compress or decompress at the same time.
+  int32 max_pending_blocks = 8;
 };
 
 inline ZlibCompressionOptions ZlibCompressionOptions::DEFAULT() {
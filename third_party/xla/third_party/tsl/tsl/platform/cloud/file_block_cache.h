@@ -56,6 +56,12 @@ class FileBlockCacheStatsInterface {
   /// RecordBlockLoadRequest is called to record the size of a missed block.
   virtual void RecordCacheMissBlockSize(size_t bytes_transferred) = 0;
 
+  /// RecordFileRead is called after each read of `filename` through the
+  /// cache, with the number of blocks it found in the cache and the number it
+  /// had to fetch or wait for, and the time it waited for them.
+  virtual void RecordFileRead(const string& filename, uint64 block_hits,
+                              uint64 block_misses, uint64 wait_micros) {}
+
   virtual ~FileBlockCacheStatsInterface() = default;
 };
 
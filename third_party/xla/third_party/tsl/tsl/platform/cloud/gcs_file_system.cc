@@ -1006,6 +1006,12 @@ GcsFileSystem::GcsFileSystem(
       compose_append_(compose_append),
       additional_header_(additional_header) {}
 
+GcsFileSystem::~GcsFileSystem() {
+  // Waits for the blocks being fetched ahead, which use the other members.
+  mutex_lock l(block_cache_lock_);
+  file_block_cache_.reset();
+}
+
 Status GcsFileSystem::NewRandomAccessFile(
     const string& fname, TransactionToken* token,
     std::unique_ptr<RandomAccessFile>* result) {
@@ -1050,8 +1056,14 @@ Status GcsFileSystem::NewRandomAccessFile(
                                StringPiece* result, char* scratch) {
           *result = StringPiece();
           size_t bytes_transferred;
-          TF_RETURN_IF_ERROR(
-              LoadBufferFromGCS(fname, offset, n, scratch, &bytes_transferred));
+          {
+            // The disabled cache passes reads through to LoadBufferFromGCS,
+            // splitting large ones into concurrent range requests if
+            // enabled.
+            tf_shared_lock l(block_cache_lock_);
+            TF_RETURN_IF_ERROR(file_block_cache_->Read(
+                fname, offset, n, scratch, &bytes_transferred));
+          }
           *result = StringPiece(scratch, bytes_transferred);
           if (bytes_transferred < n) {
             return errors::OutOfRange("EOF reached, ", result->size(),
@@ -1078,13 +1090,22 @@ void GcsFileSystem::ResetFileBlockCache(size_t block_size_bytes,
 // A helper function to build a FileBlockCache for GcsFileSystem.
 std::unique_ptr<FileBlockCache> GcsFileSystem::MakeFileBlockCache(
     size_t block_size, size_t max_bytes, uint64 max_staleness) {
+  RamFileBlockCache::PrefetchOptions prefetch_options;
+  uint64 value;
+  if (GetEnvVar(kReadaheadBlocks, strings::safe_strtou64, &value)) {
+    prefetch_options.max_readahead_blocks = value;
+  }
+  if (GetEnvVar(kParallelReadSize, strings::safe_strtou64, &value)) {
+    prefetch_options.parallel_read_size = value * 1024 * 1024;
+  }
   std::unique_ptr<FileBlockCache> file_block_cache(new RamFileBlockCache(
       block_size, max_bytes, max_staleness,
       [this](const string& filename, size_t offset, size_t n, char* buffer,
              size_t* bytes_transferred) {
         return LoadBufferFromGCS(filename, offset, n, buffer,
                                  bytes_transferred);
-      }));
+      },
+      prefetch_options));
 
   // Check if cache is enabled here to avoid unnecessary mutex contention.
   cache_enabled_ = file_block_cache->IsCacheEnabled();
@@ -62,6 +62,14 @@ constexpr size_t kDefaultMaxCacheSize = 0;
 // will be evicted on the next read.
 constexpr char kMaxStaleness[] = "GCS_READ_CACHE_MAX_STALENESS";
 constexpr uint64 kDefaultMaxStaleness = 0;
+// The environment variable that sets the maximum number of blocks fetched
+// ahead of sequential reads (e.g. TFRecord scans) through the block cache. 0
+// (the default) disables readahead.
+constexpr char kReadaheadBlocks[] = "GCS_READ_CACHE_READAHEAD_BLOCKS";
+// The environment variable that sets the size of the ranges that large reads
+// bypassing the block cache are split into, to fetch them with concurrent
+// requests. Specified in MB. 0 (the default) disables splitting.
+constexpr char kParallelReadSize[] = "GCS_PARALLEL_READ_SIZE_MB";
 
 // Helper function to extract an environment variable and convert it into a
 // value of type T.
@@ -142,6 +150,8 @@ class GcsFileSystem : public FileSystem {
                 std::pair<const string, const string>* additional_header,
                 bool compose_append);
 
+  ~GcsFileSystem() override;
+
   TF_USE_FILESYSTEM_METHODS_WITH_NO_TRANSACTION_SUPPORT;
 
   Status NewRandomAccessFile(
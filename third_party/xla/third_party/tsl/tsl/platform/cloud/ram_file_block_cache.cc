@@ -15,10 +15,14 @@ limitations under the License.
 
 #include "tsl/platform/cloud/ram_file_block_cache.h"
 
+#include <algorithm>
 #include <cstring>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "absl/cleanup/cleanup.h"
+#include "tsl/platform/blocking_counter.h"
 #include "tsl/platform/env.h"
 
 namespace tsl {
@@ -85,10 +89,20 @@ Status RamFileBlockCache::UpdateLRU(const Key& key,
   // in the cache, and our current block is not block size, this likely means
   // we have inconsistent state within the cache. Note: it's possible some
   // incomplete reads may still go undetected.
+  // Blocks fetched ahead past the end of the file are empty, or may still be
+  // being fetched, and are ignored.
   if (block->data.size() < block_size_) {
     Key fmax = std::make_pair(key.first, std::numeric_limits<size_t>::max());
     auto fcmp = block_map_.upper_bound(fmax);
-    if (fcmp != block_map_.begin() && key < (--fcmp)->first) {
+    while (fcmp != block_map_.begin() && key < (--fcmp)->first) {
+      const std::shared_ptr<Block>& later_block = fcmp->second;
+      if (later_block->prefetched) {
+        mutex_lock l(later_block->mu);
+        if (later_block->state != FetchState::FINISHED ||
+            later_block->data.empty()) {
+          continue;
+        }
+      }
       return errors::Internal("Block cache contents are inconsistent.");
     }
   }
@@ -176,6 +190,10 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
   if (!IsCacheEnabled() || (n > max_bytes_)) {
     // The cache is effectively disabled, so we pass the read through to the
     // fetcher without breaking it up into blocks.
+    if (prefetch_pool_ != nullptr && prefetch_options_.parallel_read_size > 0 &&
+        n > prefetch_options_.parallel_read_size) {
+      return ParallelFetch(filename, offset, n, buffer, bytes_transferred);
+    }
     return block_fetcher_(filename, offset, n, buffer, bytes_transferred);
   }
   // Calculate the block-aligned start and end of the read.
@@ -185,6 +203,8 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
     finish += block_size_;
   }
   size_t total_bytes_transferred = 0;
+  size_t end_offset = std::numeric_limits<size_t>::max();
+  FileStats stats;
   // Now iterate through the blocks, reading them one at a time.
   for (size_t pos = start; pos < finish; pos += block_size_) {
     Key key = std::make_pair(filename, pos);
@@ -192,7 +212,21 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
     // LRU iterator for the key and block.
     std::shared_ptr<Block> block = Lookup(key);
     DCHECK(block) << "No block for key " << key.first << "@" << key.second;
-    TF_RETURN_IF_ERROR(MaybeFetch(key, block));
+    bool hit;
+    {
+      mutex_lock l(block->mu);
+      hit = block->state == FetchState::FINISHED;
+    }
+    if (hit) {
+      ++stats.block_hits;
+      TF_RETURN_IF_ERROR(MaybeFetch(key, block));
+    } else {
+      ++stats.block_misses;
+      const uint64 start_micros = env_->NowMicros();
+      TF_RETURN_IF_ERROR(MaybeFetch(key, block));
+      stats.wait_micros += env_->NowMicros() - start_micros;
+    }
+    if (block->prefetched) ++stats.readahead_hits;
     TF_RETURN_IF_ERROR(UpdateLRU(key, block));
     // Copy the relevant portion of the block into the result buffer.
     const auto& data = block->data;
@@ -222,13 +256,103 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
     }
     if (data.size() < block_size_) {
       // The block was a partial block and thus signals EOF at its upper bound.
+      end_offset = pos + data.size();
       break;
     }
   }
   *bytes_transferred = total_bytes_transferred;
+  RecordRead(filename, offset, offset + total_bytes_transferred, finish,
+             end_offset, stats);
   return OkStatus();
 }
 
+Status RamFileBlockCache::ParallelFetch(const string& filename, size_t offset,
+                                        size_t n, char* buffer,
+                                        size_t* bytes_transferred) {
+  const size_t range_size = prefetch_options_.parallel_read_size;
+  const size_t num_ranges = (n + range_size - 1) / range_size;
+  std::vector<Status> statuses(num_ranges);
+  std::vector<size_t> range_bytes_transferred(num_ranges, 0);
+  BlockingCounter counter(num_ranges);
+  for (size_t i = 0; i < num_ranges; ++i) {
+    prefetch_pool_->Schedule([&, i] {
+      const size_t range_offset = i * range_size;
+      statuses[i] = block_fetcher_(
+          filename, offset + range_offset,
+          std::min(range_size, n - range_offset), buffer + range_offset,
+          &range_bytes_transferred[i]);
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  // The bytes transferred are contiguous up to the first partial range, which
+  // ends at the end of the file.
+  *bytes_transferred = 0;
+  for (size_t i = 0; i < num_ranges; ++i) {
+    TF_RETURN_IF_ERROR(statuses[i]);
+    *bytes_transferred += range_bytes_transferred[i];
+    if (range_bytes_transferred[i] < std::min(range_size, n - i * range_size)) {
+      break;
+    }
+  }
+  return OkStatus();
+}
+
+void RamFileBlockCache::RecordRead(const string& filename, size_t offset,
+                                   size_t end, size_t finish,
+                                   size_t end_offset, const FileStats& stats) {
+  if (cache_stats_ != nullptr) {
+    cache_stats_->RecordFileRead(filename, stats.block_hits,
+                                 stats.block_misses, stats.wait_micros);
+  }
+  std::vector<std::pair<Key, std::shared_ptr<Block>>> blocks_to_fetch;
+  {
+    mutex_lock lock(mu_);
+    FileState& state = file_states_[filename];
+    state.stats.block_hits += stats.block_hits;
+    state.stats.block_misses += stats.block_misses;
+    state.stats.readahead_hits += stats.readahead_hits;
+    state.stats.wait_micros += stats.wait_micros;
+    state.end_offset = std::min(state.end_offset, end_offset);
+    if (prefetch_pool_ == nullptr ||
+        prefetch_options_.max_readahead_blocks == 0) {
+      return;
+    }
+    if (offset == state.next_offset) {
+      state.readahead_blocks =
+          std::min(prefetch_options_.max_readahead_blocks,
+                   std::max<size_t>(1, 2 * state.readahead_blocks));
+    } else {
+      state.readahead_blocks = 0;
+    }
+    state.next_offset = end;
+    const size_t readahead_end = std::min(
+        state.end_offset, finish + state.readahead_blocks * block_size_);
+    for (size_t pos = finish; pos < readahead_end; pos += block_size_) {
+      Key key = std::make_pair(filename, pos);
+      if (block_map_.find(key) != block_map_.end()) continue;
+      auto block = std::make_shared<Block>();
+      block->prefetched = true;
+      lru_list_.push_front(key);
+      lra_list_.push_front(key);
+      block->lru_iterator = lru_list_.begin();
+      block->lra_iterator = lra_list_.begin();
+      block->timestamp = env_->NowSeconds();
+      block_map_.emplace(key, block);
+      blocks_to_fetch.emplace_back(std::move(key), std::move(block));
+    }
+    state.stats.readahead_blocks += blocks_to_fetch.size();
+  }
+  for (auto& key_and_block : blocks_to_fetch) {
+    prefetch_pool_->Schedule([this, key_and_block] {
+      // A failed block is fetched again by the next read of it.
+      if (MaybeFetch(key_and_block.first, key_and_block.second).ok()) {
+        UpdateLRU(key_and_block.first, key_and_block.second).IgnoreError();
+      }
+    });
+  }
+}
+
 bool RamFileBlockCache::ValidateAndUpdateFileSignature(const string& filename,
                                                        int64_t file_signature) {
   mutex_lock lock(mu_);
@@ -251,6 +375,13 @@ size_t RamFileBlockCache::CacheSize() const {
   return cache_size_;
 }
 
+RamFileBlockCache::FileStats RamFileBlockCache::GetFileStats(
+    const string& filename) const {
+  mutex_lock lock(mu_);
+  auto it = file_states_.find(filename);
+  return it == file_states_.end() ? FileStats() : it->second.stats;
+}
+
 void RamFileBlockCache::Prune() {
   while (!WaitForNotificationWithTimeout(&stop_pruning_thread_, 1000000)) {
     mutex_lock lock(mu_);
@@ -270,15 +401,22 @@ void RamFileBlockCache::Prune() {
 
 void RamFileBlockCache::Flush() {
   mutex_lock lock(mu_);
+  // Signals the blocks still being read or fetched ahead that they are
+  // removed, like RemoveBlock().
+  for (auto& entry : block_map_) {
+    entry.second->timestamp = 0;
+  }
   block_map_.clear();
   lru_list_.clear();
   lra_list_.clear();
   cache_size_ = 0;
+  file_states_.clear();
 }
 
 void RamFileBlockCache::RemoveFile(const string& filename) {
   mutex_lock lock(mu_);
   RemoveFile_Locked(filename);
+  file_states_.erase(filename);
 }
 
 void RamFileBlockCache::RemoveFile_Locked(const string& filename) {
@@ -17,10 +17,12 @@ limitations under the License.
 #define TENSORFLOW_TSL_PLATFORM_CLOUD_RAM_FILE_BLOCK_CACHE_H_
 
 #include <functional>
+#include <limits>
 #include <list>
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "tsl/platform/cloud/file_block_cache.h"
@@ -30,6 +32,7 @@ limitations under the License.
 #include "tsl/platform/status.h"
 #include "tsl/platform/stringpiece.h"
 #include "tsl/platform/thread_annotations.h"
+#include "tsl/platform/threadpool.h"
 #include "tsl/platform/types.h"
 
 namespace tsl {
@@ -50,22 +53,70 @@ class RamFileBlockCache : public FileBlockCache {
                                size_t* bytes_transferred)>
       BlockFetcher;
 
+  /// Options for fetching blocks ahead of sequential reads, and for splitting
+  /// large reads that bypass the cache.
+  struct PrefetchOptions {
+    /// The maximum number of blocks fetched ahead of a sequential reader of a
+    /// file. The readahead window starts at one block, doubles with every read
+    /// that starts where the previous read of the file ended, and is reset by
+    /// any other read. 0 disables readahead.
+    size_t max_readahead_blocks = 0;
+    /// Reads that bypass the cache and are larger than this many bytes are
+    /// split into ranges of this size, which are fetched concurrently. 0
+    /// disables splitting.
+    size_t parallel_read_size = 0;
+    /// The number of threads fetching blocks ahead and ranges of split reads.
+    int num_threads = 8;
+  };
+
+  /// Per-file statistics of the reads through the cache.
+  struct FileStats {
+    /// The number of blocks read that were already in the cache.
+    uint64 block_hits = 0;
+    /// The number of blocks read that had to be fetched, or were being
+    /// fetched by another thread.
+    uint64 block_misses = 0;
+    /// The number of blocks read that were fetched by readahead, whether
+    /// it had finished or not.
+    uint64 readahead_hits = 0;
+    /// The number of blocks fetched by readahead.
+    uint64 readahead_blocks = 0;
+    /// The total time reads spent waiting for blocks to be fetched.
+    uint64 wait_micros = 0;
+  };
+
   RamFileBlockCache(size_t block_size, size_t max_bytes, uint64 max_staleness,
                     BlockFetcher block_fetcher, Env* env = Env::Default())
+      : RamFileBlockCache(block_size, max_bytes, max_staleness,
+                          std::move(block_fetcher), PrefetchOptions(), env) {}
+
+  RamFileBlockCache(size_t block_size, size_t max_bytes, uint64 max_staleness,
+                    BlockFetcher block_fetcher,
+                    const PrefetchOptions& prefetch_options,
+                    Env* env = Env::Default())
       : block_size_(block_size),
         max_bytes_(max_bytes),
         max_staleness_(max_staleness),
         block_fetcher_(block_fetcher),
+        prefetch_options_(prefetch_options),
         env_(env) {
     if (max_staleness_ > 0) {
       pruning_thread_.reset(env_->StartThread(ThreadOptions(), "TF_prune_FBC",
                                               [this] { Prune(); }));
     }
+    if (prefetch_options_.num_threads > 0 &&
+        ((IsCacheEnabled() && prefetch_options_.max_readahead_blocks > 0) ||
+         prefetch_options_.parallel_read_size > 0)) {
+      prefetch_pool_ = std::make_unique<thread::ThreadPool>(
+          env_, "TF_prefetch_FBC", prefetch_options_.num_threads);
+    }
     VLOG(1) << "GCS file block cache is "
             << (IsCacheEnabled() ? "enabled" : "disabled");
   }
 
   ~RamFileBlockCache() override {
+    // Waits for the blocks being fetched ahead.
+    prefetch_pool_.reset();
     if (pruning_thread_) {
       stop_pruning_thread_.Notify();
       // Destroying pruning_thread_ will block until Prune() receives the above
@@ -99,7 +150,7 @@ class RamFileBlockCache : public FileBlockCache {
                                       int64_t file_signature) override
       TF_LOCKS_EXCLUDED(mu_);
 
-  /// Remove all cached blocks for `filename`.
+  /// Remove all cached blocks for `filename`, and its statistics.
   void RemoveFile(const string& filename) override TF_LOCKS_EXCLUDED(mu_);
 
   /// Remove all cached data.
@@ -113,6 +164,10 @@ class RamFileBlockCache : public FileBlockCache {
   /// The current size (in bytes) of the cache.
   size_t CacheSize() const override TF_LOCKS_EXCLUDED(mu_);
 
+  /// Returns the statistics of the reads of `filename` since it was first
+  /// read, or last removed.
+  FileStats GetFileStats(const string& filename) const TF_LOCKS_EXCLUDED(mu_);
+
   // Returns true if the cache is enabled. If false, the BlockFetcher callback
   // is always executed during Read.
   bool IsCacheEnabled() const override {
@@ -129,6 +184,7 @@ class RamFileBlockCache : public FileBlockCache {
   const uint64 max_staleness_;
   /// The callback to read a block from the underlying filesystem.
   const BlockFetcher block_fetcher_;
+  const PrefetchOptions prefetch_options_;
   /// The Env from which we read timestamps.
   Env* const env_;  // not owned
 
@@ -181,6 +237,19 @@ class RamFileBlockCache : public FileBlockCache {
     FetchState state TF_GUARDED_BY(mu) = FetchState::CREATED;
     /// Wait on cond_var if state is FETCHING.
     condition_variable cond_var;
+    /// Whether the block was inserted by readahead.
+    bool prefetched = false;
+  };
+
+  /// The sequential access tracking and statistics of a file.
+  struct FileState {
+    /// The offset at which the last read of the file ended.
+    size_t next_offset = 0;
+    /// The offset of the end of the file, once a partial block was read.
+    size_t end_offset = std::numeric_limits<size_t>::max();
+    /// The number of blocks to fetch ahead of the next sequential read.
+    size_t readahead_blocks = 0;
+    FileStats stats;
   };
 
   /// \brief The block map type for the file block cache.
@@ -200,6 +269,20 @@ class RamFileBlockCache : public FileBlockCache {
   Status MaybeFetch(const Key& key, const std::shared_ptr<Block>& block)
       TF_LOCKS_EXCLUDED(mu_);
 
+  /// Reads `n` bytes that bypass the cache, splitting them into ranges that
+  /// are fetched concurrently.
+  Status ParallelFetch(const string& filename, size_t offset, size_t n,
+                       char* buffer, size_t* bytes_transferred)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  /// Records the statistics of a read of `filename` from `offset` to `end`,
+  /// and fetches the blocks after the block-aligned offset `finish` ahead if
+  /// the file is being read sequentially. `end_offset` is the end of the
+  /// file, if the read reached it.
+  void RecordRead(const string& filename, size_t offset, size_t end,
+                  size_t finish, size_t end_offset, const FileStats& stats)
+      TF_LOCKS_EXCLUDED(mu_);
+
   /// Trim the block cache to make room for another entry.
   void Trim() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
@@ -243,6 +326,13 @@ class RamFileBlockCache : public FileBlockCache {
 
   // A filename->file_signature map.
   std::map<string, int64_t> file_signature_map_ TF_GUARDED_BY(mu_);
+
+  // A filename->FileState map.
+  std::map<string, FileState> file_states_ TF_GUARDED_BY(mu_);
+
+  /// Fetches blocks ahead and ranges of split reads. Null if neither is
+  /// enabled.
+  std::unique_ptr<thread::ThreadPool> prefetch_pool_;
 };
 
 }  // namespace tsl
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tsl/platform/cloud/ram_file_block_cache.h"
 
 #include <cstring>
+#include <map>
 
 #include "tsl/lib/core/status_test_util.h"
 #include "tsl/platform/blocking_counter.h"
@@ -566,5 +567,104 @@ TEST(RamFileBlockCacheTest, Flush) {
   EXPECT_EQ(calls, 2);
 }
 
+// A fetcher of a `file_size` byte file whose byte i is 'a' + i % 26, counting
+// the requests for each offset in `requests`.
+RamFileBlockCache::BlockFetcher PatternFetcher(
+    size_t file_size, mutex* mu, std::map<size_t, int>* requests) {
+  return [file_size, mu, requests](const string& filename, size_t offset,
+                                   size_t n, char* buffer,
+                                   size_t* bytes_transferred) {
+    {
+      mutex_lock l(*mu);
+      ++(*requests)[offset];
+    }
+    *bytes_transferred = 0;
+    for (size_t i = offset; i < offset + n && i < file_size; ++i) {
+      buffer[(*bytes_transferred)++] = 'a' + i % 26;
+    }
+    return OkStatus();
+  };
+}
+
+TEST(RamFileBlockCacheTest, Readahead) {
+  const size_t file_size = 100;
+  mutex mu;
+  std::map<size_t, int> requests;
+  RamFileBlockCache::PrefetchOptions options;
+  options.max_readahead_blocks = 4;
+  options.num_threads = 2;
+  RamFileBlockCache cache(16, 1000, 0,
+                          PatternFetcher(file_size, &mu, &requests), options);
+  std::vector<char> out;
+  for (size_t offset = 0; offset < file_size; offset += 8) {
+    TF_EXPECT_OK(ReadCache(&cache, "a", offset, 8, &out));
+    ASSERT_EQ(out.size(), std::min<size_t>(8, file_size - offset));
+    for (size_t i = 0; i < out.size(); ++i) {
+      EXPECT_EQ(out[i], 'a' + (offset + i) % 26);
+    }
+  }
+  const RamFileBlockCache::FileStats stats = cache.GetFileStats("a");
+  EXPECT_GT(stats.readahead_blocks, 0);
+  EXPECT_GT(stats.readahead_hits, 0);
+  EXPECT_EQ(stats.block_hits + stats.block_misses, 13);
+
+  // Each block was fetched once, by the reads or ahead of them.
+  mutex_lock l(mu);
+  for (size_t offset = 0; offset < file_size; offset += 16) {
+    EXPECT_EQ(requests[offset], 1) << offset;
+  }
+}
+
+TEST(RamFileBlockCacheTest, RandomReadsAreNotReadAhead) {
+  mutex mu;
+  std::map<size_t, int> requests;
+  RamFileBlockCache::PrefetchOptions options;
+  options.max_readahead_blocks = 4;
+  RamFileBlockCache cache(16, 1000, 0, PatternFetcher(1000, &mu, &requests),
+                          options);
+  std::vector<char> out;
+  for (size_t offset : {320, 160, 640, 480}) {
+    TF_EXPECT_OK(ReadCache(&cache, "a", offset, 8, &out));
+  }
+  EXPECT_EQ(cache.GetFileStats("a").readahead_blocks, 0);
+  mutex_lock l(mu);
+  EXPECT_EQ(requests.size(), 4);
+}
+
+TEST(RamFileBlockCacheTest, ParallelFetch) {
+  mutex mu;
+  std::map<size_t, int> requests;
+  RamFileBlockCache::PrefetchOptions options;
+  options.parallel_read_size = 10;
+  // The cache is disabled, so reads are passed through to the fetcher.
+  RamFileBlockCache cache(0, 0, 0, PatternFetcher(30, &mu, &requests),
+                          options);
+  std::vector<char> out;
+  TF_EXPECT_OK(ReadCache(&cache, "a", 5, 40, &out));
+  ASSERT_EQ(out.size(), 25);
+  for (size_t i = 0; i < out.size(); ++i) {
+    EXPECT_EQ(out[i], 'a' + (5 + i) % 26);
+  }
+  mutex_lock l(mu);
+  EXPECT_EQ(requests,
+            (std::map<size_t, int>{{5, 1}, {15, 1}, {25, 1}, {35, 1}}));
+}
+
+TEST(RamFileBlockCacheTest, FileStats) {
+  mutex mu;
+  std::map<size_t, int> requests;
+  RamFileBlockCache cache(16, 32, 0, PatternFetcher(100, &mu, &requests));
+  std::vector<char> out;
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 16, &out));
+  TF_EXPECT_OK(ReadCache(&cache, "a", 8, 16, &out));
+  RamFileBlockCache::FileStats stats = cache.GetFileStats("a");
+  EXPECT_EQ(stats.block_hits, 1);
+  EXPECT_EQ(stats.block_misses, 2);
+  EXPECT_EQ(stats.readahead_blocks, 0);
+  EXPECT_EQ(cache.GetFileStats("b").block_misses, 0);
+  cache.RemoveFile("a");
+  EXPECT_EQ(cache.GetFileStats("a").block_misses, 0);
+}
+
 }  // namespace
 }  // namespace tsl
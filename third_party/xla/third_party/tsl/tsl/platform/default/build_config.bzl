@@ -673,6 +673,7 @@ def tf_additional_lib_hdrs():
             clean_dep("//tsl/platform/windows:windows_file_system.h"),
         ],
         "//conditions:default": [
+            clean_dep("//tsl/platform/default:io_uring_file_system.h"),
             clean_dep("//tsl/platform/default:posix_file_system.h"),
             clean_dep("//tsl/platform/default:subprocess.h"),
         ],
@@ -0,0 +1,554 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tsl/platform/default/io_uring_file_system.h"
+
+#if defined(TSL_IO_URING_SUPPORTED)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/synchronization/notification.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/mem.h"
+#include "tsl/platform/mutex.h"
+
+namespace tsl {
+
+using ::tsl::errors::IOError;
+
+namespace {
+
+// Number of submission queue entries, which bounds the reads in flight.
+constexpr unsigned kRingEntries = 64;
+
+// Reads are split into chunks that end at multiples of this size in the file.
+constexpr size_t kChunkSize = 128 * 1024;
+
+// Alignment of the offsets, sizes and buffers of O_DIRECT reads.
+constexpr size_t kDirectAlignment = 4096;
+
+bool EnvVarIsTrue(const char* name) {
+  const char* value = getenv(name);
+  return value != nullptr &&
+         (strcmp(value, "1") == 0 || strcasecmp(value, "true") == 0);
+}
+
+// liburing is not a dependency, so the ring is driven with raw syscalls.
+int IoUringSetup(unsigned entries, io_uring_params* params) {
+  return syscall(__NR_io_uring_setup, entries, params);
+}
+
+int IoUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete,
+                 unsigned flags) {
+  return syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags,
+                 nullptr, 0);
+}
+
+int IoUringRegister(int ring_fd, unsigned opcode, void* arg,
+                    unsigned nr_args) {
+  return syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args);
+}
+
+// A read split into chunks, which calls `done` with the first error and the
+// number of bytes read once its last chunk is over.
+class ChunkedRead {
+ public:
+  typedef std::function<void(int error, size_t bytes)> DoneCallback;
+
+  ChunkedRead(size_t n, int num_chunks, DoneCallback done)
+      : valid_(n), pending_(num_chunks), done_(std::move(done)) {}
+
+  // Records that the chunk of `size` bytes at `offset` within the read got
+  // `bytes` of them, failing with `error` if not 0. Deletes the read after
+  // its last chunk.
+  void ChunkDone(size_t offset, size_t size, size_t bytes, int error) {
+    {
+      mutex_lock l(mu_);
+      if (bytes < size) valid_ = std::min(valid_, offset + bytes);
+      if (error_ == 0) error_ = error;
+      if (--pending_ > 0) return;
+    }
+    done_(error_, valid_);
+    delete this;
+  }
+
+ private:
+  mutex mu_;
+  // Bytes before the first chunk that came up short.
+  size_t valid_ TF_GUARDED_BY(mu_);
+  int error_ TF_GUARDED_BY(mu_) = 0;
+  int pending_ TF_GUARDED_BY(mu_);
+  DoneCallback done_;
+};
+
+// The read of one chunk, which has one submission queue entry at a time.
+struct ChunkRead {
+  ChunkedRead* read;
+  int fd;
+  // The chunk of `size` bytes at `offset` in the file goes to `dst`, at
+  // `read_offset` within the read.
+  uint64 offset;
+  size_t size;
+  char* dst;
+  size_t read_offset;
+  // Index of the buffer of an O_DIRECT read, or -1 to read into `dst`.
+  int buffer = -1;
+  // The range of the file read by the I/O, which is aligned for O_DIRECT,
+  // and how much of it has been read.
+  uint64 start;
+  uint64 end;
+  size_t filled = 0;
+};
+
+// A ring shared by all files, whose completions are handled by a thread of
+// its own. At most `capacity_` chunks are in flight, which keeps the
+// completion queue, twice as large as the submission queue, from
+// overflowing.
+class IoUring {
+ public:
+  // Returns the process wide ring, or nullptr if io_uring is unavailable.
+  static IoUring* Get() {
+    static IoUring* ring = [] {
+      auto ring = std::make_unique<IoUring>();
+      absl::Status s = ring->Init(EnvVarIsTrue("TF_IO_URING_DIRECT"));
+      if (!s.ok()) {
+        LOG(WARNING) << "Reading files with pread(), io_uring is unavailable: "
+                     << s;
+        return static_cast<IoUring*>(nullptr);
+      }
+      return ring.release();
+    }();
+    return ring;
+  }
+
+  IoUring() {}
+
+  // Only called when Init() fails: a working ring lives until exit.
+  ~IoUring() {
+    if (buffer_memory_ != nullptr) port::AlignedFree(buffer_memory_);
+    if (sqes_ != MAP_FAILED) munmap(sqes_, sqes_size_);
+    if (ring_ != MAP_FAILED) munmap(ring_, ring_size_);
+    if (ring_fd_ >= 0) close(ring_fd_);
+  }
+
+  // Whether files should be opened with O_DIRECT.
+  bool direct_io() const { return buffer_memory_ != nullptr; }
+
+  // Reads up to `n` bytes at `offset` of `fd` into `dst`, and calls `done`
+  // on the completion thread with the first error and the number of bytes
+  // read. `direct` reads, of a file opened with O_DIRECT, go through the
+  // aligned buffers of the ring.
+  void Read(int fd, bool direct, uint64 offset, size_t n, char* dst,
+            ChunkedRead::DoneCallback done) {
+    if (n == 0) {
+      done(0, 0);
+      return;
+    }
+    std::vector<ChunkRead*> chunks;
+    const uint64 end = offset + n;
+    for (uint64 start = offset; start < end;) {
+      const uint64 chunk_end =
+          std::min<uint64>(end, (start / kChunkSize + 1) * kChunkSize);
+      auto* chunk = new ChunkRead;
+      chunk->fd = fd;
+      chunk->offset = start;
+      chunk->size = chunk_end - start;
+      chunk->dst = dst + (start - offset);
+      chunk->read_offset = start - offset;
+      chunk->start = start;
+      chunk->end = chunk_end;
+      if (direct) {
+        // Both ends stay within the same kChunkSize block of the file, so the
+        // aligned range fits in one buffer.
+        chunk->start = start / kDirectAlignment * kDirectAlignment;
+        chunk->end = (chunk_end + kDirectAlignment - 1) / kDirectAlignment *
+                     kDirectAlignment;
+      }
+      chunks.push_back(chunk);
+      start = chunk_end;
+    }
+    auto* read = new ChunkedRead(n, chunks.size(), std::move(done));
+    for (ChunkRead* chunk : chunks) chunk->read = read;
+
+    // Submits as many chunks as the ring has room for with each syscall.
+    mutex_lock l(mu_);
+    for (size_t next = 0; next < chunks.size();) {
+      while (in_flight_ == capacity_) room_.wait(l);
+      unsigned count = 0;
+      for (; next < chunks.size() && in_flight_ < capacity_; ++next) {
+        ChunkRead* chunk = chunks[next];
+        if (direct) {
+          // There are as many buffers as entries, so one is free.
+          chunk->buffer = free_buffers_.back();
+          free_buffers_.pop_back();
+        }
+        PrepareLocked(chunk);
+        ++in_flight_;
+        ++count;
+      }
+      SubmitLocked(count);
+    }
+  }
+
+ private:
+  absl::Status Init(bool direct) {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring_fd_ = IoUringSetup(kRingEntries, &params);
+    if (ring_fd_ < 0) return IOError("io_uring_setup", errno);
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+      return errors::Unavailable("io_uring needs IORING_FEAT_SINGLE_MMAP");
+    }
+    capacity_ = params.sq_entries;
+
+    ring_size_ = std::max<size_t>(
+        params.sq_off.array + params.sq_entries * sizeof(unsigned),
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+    ring_ = mmap(nullptr, ring_size_, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+    if (ring_ == MAP_FAILED) return IOError("io_uring ring mmap", errno);
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+    if (sqes_ == MAP_FAILED) return IOError("io_uring sqes mmap", errno);
+
+    char* ring = static_cast<char*>(ring_);
+    sq_tail_ = reinterpret_cast<unsigned*>(ring + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned*>(ring + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(ring + params.sq_off.array);
+    cq_head_ = reinterpret_cast<unsigned*>(ring + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(ring + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(ring + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(ring + params.cq_off.cqes);
+
+    // IORING_OP_READ needs Linux 5.6.
+    constexpr int kMaxProbeOps = 256;
+    std::vector<char> probe_memory(
+        sizeof(io_uring_probe) + kMaxProbeOps * sizeof(io_uring_probe_op));
+    auto* probe = reinterpret_cast<io_uring_probe*>(probe_memory.data());
+    if (IoUringRegister(ring_fd_, IORING_REGISTER_PROBE, probe,
+                        kMaxProbeOps) < 0) {
+      return IOError("io_uring probe", errno);
+    }
+    if (probe->last_op < IORING_OP_READ ||
+        !(probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED)) {
+      return errors::Unavailable("io_uring does not support IORING_OP_READ");
+    }
+
+    if (direct) {
+      buffer_memory_ = static_cast<char*>(
+          port::AlignedMalloc(capacity_ * kChunkSize, kDirectAlignment));
+      if (buffer_memory_ == nullptr) {
+        return errors::ResourceExhausted("Cannot allocate io_uring buffers");
+      }
+      std::vector<iovec> buffers(capacity_);
+      for (int i = 0; i < capacity_; ++i) {
+        buffers[i].iov_base = buffer_memory_ + i * kChunkSize;
+        buffers[i].iov_len = kChunkSize;
+        free_buffers_.push_back(i);
+      }
+      // Registered buffers are pinned once instead of for every read. They
+      // count against RLIMIT_MEMLOCK on older kernels, so unregistered
+      // buffers are used if that fails.
+      buffers_registered_ =
+          IoUringRegister(ring_fd_, IORING_REGISTER_BUFFERS, buffers.data(),
+                          buffers.size()) == 0;
+      if (!buffers_registered_) {
+        LOG(WARNING) << "Cannot register io_uring buffers: "
+                     << strerror(errno);
+      }
+    }
+
+    completion_thread_.reset(Env::Default()->StartThread(
+        ThreadOptions(), "tsl_io_uring", [this] { CompletionLoop(); }));
+    return absl::OkStatus();
+  }
+
+  // Queues the next I/O of `chunk`.
+  void PrepareLocked(ChunkRead* chunk) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    const unsigned tail = *sq_tail_;
+    const unsigned index = tail & sq_mask_;
+    io_uring_sqe* sqe = static_cast<io_uring_sqe*>(sqes_) + index;
+    memset(sqe, 0, sizeof(*sqe));
+    char* dst = chunk->buffer < 0
+                    ? chunk->dst
+                    : buffer_memory_ + chunk->buffer * kChunkSize;
+    sqe->opcode = IORING_OP_READ;
+    if (chunk->buffer >= 0 && buffers_registered_) {
+      sqe->opcode = IORING_OP_READ_FIXED;
+      sqe->buf_index = chunk->buffer;
+    }
+    sqe->fd = chunk->fd;
+    sqe->off = chunk->start + chunk->filled;
+    sqe->addr = reinterpret_cast<uint64_t>(dst + chunk->filled);
+    sqe->len = chunk->end - chunk->start - chunk->filled;
+    sqe->user_data = reinterpret_cast<uint64_t>(chunk);
+    sq_array_[index] = index;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  }
+
+  // Submits the last `count` queued entries.
+  void SubmitLocked(unsigned count) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    while (count > 0) {
+      const int submitted = IoUringEnter(ring_fd_, count, 0, 0);
+      if (submitted < 0) {
+        CHECK(errno == EINTR || errno == EAGAIN || errno == EBUSY)
+            << "io_uring_enter failed: " << strerror(errno);
+        continue;
+      }
+      count -= submitted;
+    }
+  }
+
+  void CompletionLoop() {
+    std::vector<std::pair<ChunkRead*, int>> completions;
+    for (;;) {
+      if (IoUringEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS) < 0) {
+        CHECK(errno == EINTR || errno == EAGAIN || errno == EBUSY)
+            << "io_uring_enter failed: " << strerror(errno);
+      }
+      unsigned head = *cq_head_;
+      const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+      for (; head != tail; ++head) {
+        const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+        completions.emplace_back(reinterpret_cast<ChunkRead*>(cqe.user_data),
+                                 cqe.res);
+      }
+      __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+      for (const auto& [chunk, res] : completions) Complete(chunk, res);
+      completions.clear();
+    }
+  }
+
+  void Complete(ChunkRead* chunk, int res) {
+    if (res == -EINTR || res == -EAGAIN) {
+      Resubmit(chunk);
+      return;
+    }
+    if (res > 0) {
+      chunk->filled += res;
+      // An O_DIRECT read that is not a multiple of the alignment hit EOF.
+      const bool at_eof = chunk->buffer >= 0 && res % kDirectAlignment != 0;
+      if (chunk->start + chunk->filled < chunk->end && !at_eof) {
+        Resubmit(chunk);
+        return;
+      }
+    }
+
+    // The chunk is over: it is complete, hit EOF or failed.
+    size_t bytes = chunk->filled;
+    if (chunk->buffer >= 0) {
+      const size_t leading = chunk->offset - chunk->start;
+      bytes = chunk->filled > leading
+                  ? std::min(chunk->filled - leading, chunk->size)
+                  : 0;
+      memcpy(chunk->dst, buffer_memory_ + chunk->buffer * kChunkSize + leading,
+             bytes);
+    }
+    {
+      mutex_lock l(mu_);
+      if (chunk->buffer >= 0) free_buffers_.push_back(chunk->buffer);
+      --in_flight_;
+    }
+    room_.notify_one();
+    chunk->read->ChunkDone(chunk->read_offset, chunk->size, bytes,
+                           res < 0 ? -res : 0);
+    delete chunk;
+  }
+
+  void Resubmit(ChunkRead* chunk) {
+    // The chunk keeps its place among the ones in flight.
+    mutex_lock l(mu_);
+    PrepareLocked(chunk);
+    SubmitLocked(1);
+  }
+
+  int ring_fd_ = -1;
+  void* ring_ = MAP_FAILED;
+  size_t ring_size_ = 0;
+  void* sqes_ = MAP_FAILED;
+  size_t sqes_size_ = 0;
+  unsigned* sq_tail_ = nullptr;
+  unsigned sq_mask_ = 0;
+  unsigned* sq_array_ = nullptr;
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned cq_mask_ = 0;
+  io_uring_cqe* cqes_ = nullptr;
+  int capacity_ = 0;
+
+  // `capacity_` buffers of kChunkSize bytes for O_DIRECT reads, or nullptr.
+  char* buffer_memory_ = nullptr;
+  bool buffers_registered_ = false;
+
+  std::unique_ptr<Thread> completion_thread_;
+
+  mutex mu_;
+  condition_variable room_;
+  int in_flight_ TF_GUARDED_BY(mu_) = 0;
+  std::vector<int> free_buffers_ TF_GUARDED_BY(mu_);
+};
+
+class IoUringRandomAccessFile : public RandomAccessFile {
+ public:
+  IoUringRandomAccessFile(const string& fname, int fd, bool direct,
+                          IoUring* ring)
+      : filename_(fname), fd_(fd), direct_(direct), ring_(ring) {}
+
+  ~IoUringRandomAccessFile() override {
+    // Reads in flight still use the file descriptor.
+    {
+      mutex_lock l(mu_);
+      while (pending_reads_ > 0) reads_done_.wait(l);
+    }
+    if (close(fd_) < 0) {
+      LOG(ERROR) << "close() failed: " << strerror(errno);
+    }
+  }
+
+  absl::Status Name(StringPiece* result) const override {
+    *result = filename_;
+    return absl::OkStatus();
+  }
+
+  absl::Status Read(uint64 offset, size_t n, StringPiece* result,
+                    char* scratch) const override {
+    absl::Notification done;
+    absl::Status status;
+    TF_RETURN_IF_ERROR(ReadAsync(
+        offset, n, scratch,
+        [&done, &status, result](const absl::Status& s, StringPiece data) {
+          status = s;
+          *result = data;
+          done.Notify();
+        }));
+    done.WaitForNotification();
+    return status;
+  }
+
+#if defined(TF_CORD_SUPPORT)
+  absl::Status Read(uint64 offset, size_t n, absl::Cord* cord) const override {
+    if (n == 0) {
+      return absl::OkStatus();
+    }
+    char* scratch = new char[n];
+    StringPiece tmp;
+    absl::Status s = Read(offset, n, &tmp, scratch);
+    cord->Append(absl::MakeCordFromExternal(
+        absl::string_view(scratch, tmp.size()),
+        [scratch](absl::string_view) { delete[] scratch; }));
+    return s;
+  }
+#endif
+
+  // `done` runs on the completion thread of the ring, so it must not block
+  // on other reads.
+  absl::Status ReadAsync(uint64 offset, size_t n, char* scratch,
+                         ReadDoneCallback done) const override {
+    {
+      mutex_lock l(mu_);
+      ++pending_reads_;
+    }
+    ring_->Read(fd_, direct_, offset, n, scratch,
+                [this, n, scratch, done = std::move(done)](int error,
+                                                           size_t bytes) {
+                  absl::Status s;
+                  if (error != 0) {
+                    s = IOError(filename_, error);
+                  } else if (bytes < n) {
+                    s = absl::Status(absl::StatusCode::kOutOfRange,
+                                     "Read less bytes than requested");
+                  }
+                  done(s, StringPiece(scratch, bytes));
+                  mutex_lock l(mu_);
+                  if (--pending_reads_ == 0) reads_done_.notify_all();
+                });
+    return absl::OkStatus();
+  }
+
+ private:
+  const string filename_;
+  const int fd_;
+  const bool direct_;
+  IoUring* const ring_;
+
+  mutable mutex mu_;
+  mutable condition_variable reads_done_;
+  mutable int pending_reads_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace
+
+bool UseIoUringForLocalFiles() {
+  static const bool use_io_uring = EnvVarIsTrue("TF_USE_IO_URING");
+  return use_io_uring;
+}
+
+absl::Status NewIoUringRandomAccessFile(
+    const string& filename, std::unique_ptr<RandomAccessFile>* result) {
+  IoUring* ring = IoUring::Get();
+  if (ring == nullptr) {
+    return errors::Unavailable("io_uring is unavailable");
+  }
+  bool direct = ring->direct_io();
+  int fd = -1;
+  if (direct) {
+    fd = open(filename.c_str(), O_RDONLY | O_DIRECT);
+    // The file system does not support O_DIRECT.
+    if (fd < 0 && errno == EINVAL) direct = false;
+  }
+  if (!direct) {
+    fd = open(filename.c_str(), O_RDONLY);
+  }
+  if (fd < 0) {
+    return IOError(filename, errno);
+  }
+  result->reset(new IoUringRandomAccessFile(filename, fd, direct, ring));
+  return absl::OkStatus();
+}
+
+absl::Status IoUringFileSystem::NewRandomAccessFile(
+    const string& fname, TransactionToken* token,
+    std::unique_ptr<RandomAccessFile>* result) {
+  absl::Status s = NewIoUringRandomAccessFile(TranslateName(fname), result);
+  if (errors::IsUnavailable(s)) {
+    return LocalPosixFileSystem::NewRandomAccessFile(fname, token, result);
+  }
+  return s;
+}
+
+}  // namespace tsl
+
+#endif  // TSL_IO_URING_SUPPORTED
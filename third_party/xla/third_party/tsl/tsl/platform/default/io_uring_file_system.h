@@ -0,0 +1,77 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#ifndef TENSORFLOW_TSL_PLATFORM_DEFAULT_IO_URING_FILE_SYSTEM_H_
+#define TENSORFLOW_TSL_PLATFORM_DEFAULT_IO_URING_FILE_SYSTEM_H_
+
+#if defined(__linux__) && !defined(__ANDROID__)
+#define TSL_IO_URING_SUPPORTED 1
+#endif
+
+#if defined(TSL_IO_URING_SUPPORTED)
+
+#include <memory>
+#include <string>
+
+#include "tsl/platform/default/posix_file_system.h"
+#include "tsl/platform/file_system.h"
+#include "tsl/platform/status.h"
+
+namespace tsl {
+
+// A local file system, registered for "uring://" paths, whose random access
+// files are read through io_uring instead of pread(). Reads larger than a
+// chunk are split into chunks that are submitted together, and ReadAsync()
+// lets a single thread keep many reads in flight, so few threads can keep a
+// fast disk busy.
+//
+// All files share one ring, set up on first use. If the kernel has no
+// io_uring, e.g. when a seccomp filter blocks it, files are read with
+// pread() as by PosixFileSystem.
+//
+// Setting TF_IO_URING_DIRECT=1 opens files with O_DIRECT and reads them into
+// buffers registered with the ring, bypassing the page cache. Files on file
+// systems without O_DIRECT support are opened without it.
+//
+// Setting TF_USE_IO_URING=1 makes PosixFileSystem read local files through
+// io_uring as well.
+class IoUringFileSystem : public LocalPosixFileSystem {
+ public:
+  IoUringFileSystem() {}
+
+  ~IoUringFileSystem() override {}
+
+  TF_USE_FILESYSTEM_METHODS_WITH_NO_TRANSACTION_SUPPORT;
+
+  absl::Status NewRandomAccessFile(
+      const string& filename, TransactionToken* token,
+      std::unique_ptr<RandomAccessFile>* result) override;
+};
+
+// Returns whether TF_USE_IO_URING asks PosixFileSystem to read files
+// through io_uring.
+bool UseIoUringForLocalFiles();
+
+// Opens the local file `filename` for reads through io_uring. Returns
+// UNAVAILABLE if the kernel does not support io_uring.
+absl::Status NewIoUringRandomAccessFile(
+    const string& filename, std::unique_ptr<RandomAccessFile>* result);
+
+}  // namespace tsl
+
+#endif  // TSL_IO_URING_SUPPORTED
+
+#endif  // TENSORFLOW_TSL_PLATFORM_DEFAULT_IO_URING_FILE_SYSTEM_H_
@@ -17,6 +17,9 @@ limitations under the License.
 
 #include <time.h>
 
+#include <atomic>
+#include <chrono>  // NOLINT
+
 #include "nsync_cv.h"       // NOLINT
 #include "nsync_mu.h"       // NOLINT
 #include "nsync_mu_wait.h"  // NOLINT
@@ -36,15 +39,70 @@ static inline nsync::nsync_mu *mu_cast(internal::MuData *mu) {
   return reinterpret_cast<nsync::nsync_mu *>(mu);
 }
 
+namespace {
+
+std::atomic<MutexContentionHook> contention_hook{nullptr};
+
+// Set while the contention hook runs on this thread, so that the hook's own
+// locking is not reported back to it.
+thread_local bool in_contention_hook = false;
+
+#if defined(__GNUC__) || defined(__clang__)
+#define TSL_MUTEX_CALL_SITE() __builtin_return_address(0)
+#else
+#define TSL_MUTEX_CALL_SITE() nullptr
+#endif
+
+// Acquires the mutex with `lock` after `try_lock` failed, and reports the wait
+// to `hook`.
+template <typename LockFn>
+void LockAndReportContention(MutexContentionHook hook, LockFn lock,
+                             const void *call_site) {
+  const auto start = std::chrono::steady_clock::now();
+  lock();
+  if (in_contention_hook) return;
+  const int64_t wait_nanos =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - start)
+          .count();
+  in_contention_hook = true;
+  hook(wait_nanos, call_site);
+  in_contention_hook = false;
+}
+
+}  // namespace
+
+void SetMutexContentionHook(MutexContentionHook hook) {
+  contention_hook.store(hook, std::memory_order_release);
+}
+
 mutex::mutex() { nsync::nsync_mu_init(mu_cast(&mu_)); }
 
-void mutex::lock() { nsync::nsync_mu_lock(mu_cast(&mu_)); }
+void mutex::lock() {
+  MutexContentionHook hook = contention_hook.load(std::memory_order_relaxed);
+  if (hook == nullptr) {
+    nsync::nsync_mu_lock(mu_cast(&mu_));
+  } else if (!nsync::nsync_mu_trylock(mu_cast(&mu_))) {
+    LockAndReportContention(
+        hook, [this] { nsync::nsync_mu_lock(mu_cast(&mu_)); },
+        TSL_MUTEX_CALL_SITE());
+  }
+}
 
 bool mutex::try_lock() { return nsync::nsync_mu_trylock(mu_cast(&mu_)) != 0; };
 
 void mutex::unlock() { nsync::nsync_mu_unlock(mu_cast(&mu_)); }
 
-void mutex::lock_shared() { nsync::nsync_mu_rlock(mu_cast(&mu_)); }
+void mutex::lock_shared() {
+  MutexContentionHook hook = contention_hook.load(std::memory_order_relaxed);
+  if (hook == nullptr) {
+    nsync::nsync_mu_rlock(mu_cast(&mu_));
+  } else if (!nsync::nsync_mu_rtrylock(mu_cast(&mu_))) {
+    LockAndReportContention(
+        hook, [this] { nsync::nsync_mu_rlock(mu_cast(&mu_)); },
+        TSL_MUTEX_CALL_SITE());
+  }
+}
 
 bool mutex::try_lock_shared() {
   return nsync::nsync_mu_rtrylock(mu_cast(&mu_)) != 0;
@@ -29,6 +29,7 @@ limitations under the License.
 #include <time.h>
 #include <unistd.h>
 
+#include "tsl/platform/default/io_uring_file_system.h"
 #include "tsl/platform/default/posix_file_system.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
@@ -226,6 +227,12 @@ absl::Status PosixFileSystem::NewRandomAccessFile(
     const string& fname, TransactionToken* token,
     std::unique_ptr<RandomAccessFile>* result) {
   string translated_fname = TranslateName(fname);
+#if defined(TSL_IO_URING_SUPPORTED)
+  if (UseIoUringForLocalFiles()) {
+    absl::Status s = NewIoUringRandomAccessFile(translated_fname, result);
+    if (!errors::IsUnavailable(s)) return s;
+  }
+#endif
   absl::Status s;
   int fd = open(translated_fname.c_str(), O_RDONLY);
   if (fd < 0) {
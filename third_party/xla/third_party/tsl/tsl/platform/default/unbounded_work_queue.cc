@@ -19,6 +19,7 @@ limitations under the License.
 #include "tsl/platform/env.h"
 #include "tsl/platform/mutex.h"
 #include "tsl/platform/numa.h"
+#include "tsl/platform/threadpool.h"
 
 namespace tsl {
 
@@ -55,8 +56,12 @@ UnboundedWorkQueue::~UnboundedWorkQueue() {
 void UnboundedWorkQueue::Schedule(WorkFunction fn) {
   // Enqueue a work item for the new thread's function, and wake up a
   // cached thread to process it.
+  uint64 enqueue_nanos = 0;
+  if (thread::GetThreadPoolTaskListener() != nullptr) {
+    enqueue_nanos = env_->NowNanos();
+  }
   mutex_lock l(work_queue_mu_);
-  work_queue_.push_back(std::move(fn));
+  work_queue_.push_back({std::move(fn), enqueue_nanos});
   work_queue_cv_.notify_one();
   // NOTE: The queue may be non-empty, so we must account for queued work when
   // considering how many threads are free.
@@ -79,7 +84,8 @@ void UnboundedWorkQueue::PooledThreadFunc() {
   }
 
   while (true) {
-    WorkFunction fn;
+    WorkItem item;
+    int64_t queue_length;
     {
       mutex_lock l(work_queue_mu_);
       ++num_idle_threads_;
@@ -91,12 +97,24 @@ void UnboundedWorkQueue::PooledThreadFunc() {
       if (cancelled_) {
         return;
       }
-      fn = std::move(work_queue_.front());
+      item = std::move(work_queue_.front());
       work_queue_.pop_front();
+      queue_length = work_queue_.size();
       --num_idle_threads_;
     }
 
-    fn();
+    if (item.enqueue_nanos == 0) {
+      item.fn();
+      continue;
+    }
+    const uint64 start_nanos = env_->NowNanos();
+    item.fn();
+    const uint64 end_nanos = env_->NowNanos();
+    if (auto* listener = thread::GetThreadPoolTaskListener()) {
+      listener->OnTaskRun(thread_name_, queue_length,
+                          start_nanos - item.enqueue_nanos,
+                          end_nanos - start_nanos);
+    }
   }
 }
 
@@ -50,6 +50,13 @@ class UnboundedWorkQueue {
  private:
   void PooledThreadFunc();
 
+  struct WorkItem {
+    WorkFunction fn;
+    // Time the item was scheduled, if a thread::ThreadPoolTaskListener was
+    // set then.
+    uint64 enqueue_nanos = 0;
+  };
+
   Env* const env_;  // Not owned.
   const string thread_name_;
   const ThreadOptions thread_options_;
@@ -57,7 +64,7 @@ class UnboundedWorkQueue {
   condition_variable work_queue_cv_ TF_GUARDED_BY(work_queue_mu_);
   size_t num_idle_threads_ TF_GUARDED_BY(work_queue_mu_) = 0;
   bool cancelled_ TF_GUARDED_BY(work_queue_mu_) = false;
-  std::deque<WorkFunction> work_queue_ TF_GUARDED_BY(work_queue_mu_);
+  std::deque<WorkItem> work_queue_ TF_GUARDED_BY(work_queue_mu_);
   mutex thread_pool_mu_;
   std::vector<std::unique_ptr<Thread>> thread_pool_
       TF_GUARDED_BY(thread_pool_mu_);
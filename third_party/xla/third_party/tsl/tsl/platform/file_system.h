@@ -780,6 +780,29 @@ class RandomAccessFile {
   }
 #endif
 
+  /// \brief Called by `ReadAsync()` with the status and result `Read()` would
+  /// have returned.
+  typedef std::function<void(const tsl::Status&, StringPiece)>
+      ReadDoneCallback;
+
+  /// \brief Starts reading up to `n` bytes from the file starting at
+  /// `offset` into `scratch[0..n-1]`, and calls `done` when the read is over.
+  ///
+  /// Lets a single thread keep several reads in flight. `done` may run on
+  /// another thread, possibly before `ReadAsync()` returns, and `scratch`
+  /// must be live until it runs.
+  ///
+  /// Returns `UNIMPLEMENTED` without calling `done` if the file does not
+  /// support asynchronous reads. Otherwise returns OK, and read errors are
+  /// passed to `done`.
+  ///
+  /// Safe for concurrent use by multiple threads.
+  virtual tsl::Status ReadAsync(uint64 offset, size_t n, char* scratch,
+                                ReadDoneCallback done) const {
+    return errors::Unimplemented(
+        "This filesystem does not support ReadAsync()");
+  }
+
  private:
   RandomAccessFile(const RandomAccessFile&) = delete;
   void operator=(const RandomAccessFile&) = delete;
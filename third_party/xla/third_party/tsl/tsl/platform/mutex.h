@@ -267,6 +267,15 @@ inline ConditionResult WaitForMilliseconds(mutex_lock* mu,
   return (s == std::cv_status::timeout) ? kCond_Timeout : kCond_MaybeNotified;
 }
 
+// Called after mutex::lock() or mutex::lock_shared() had to wait for the
+// mutex, with the time waited and the address of the code that called it.
+typedef void (*MutexContentionHook)(int64_t wait_nanos, const void* call_site);
+
+// Enables contention profiling of all mutexes, reporting to `hook`, or
+// disables it if `hook` is null. While profiling, uncontended acquisitions
+// cost an extra try-lock. Contention within `hook` itself is not reported.
+void SetMutexContentionHook(MutexContentionHook hook);
+
 // ------------------------------------------------------------
 // Implementation details follow.   Clients should ignore them.
 
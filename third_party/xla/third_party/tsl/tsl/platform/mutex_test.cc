@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tsl/platform/mutex.h"
 
+#include <atomic>
+
+#include "tsl/platform/env.h"
 #include "tsl/platform/test.h"
 #include "tsl/platform/threadpool.h"
 
@@ -138,5 +141,48 @@ TEST(ConditionVariableTest, WaitWithTruePredicateDoesntBlock) {
   EXPECT_TRUE(static_cast<bool>(lock));
 }
 
+std::atomic<int64_t> num_contentions{0};
+std::atomic<int64_t> max_wait_nanos{0};
+
+void RecordContention(int64_t wait_nanos, const void* call_site) {
+  EXPECT_NE(call_site, nullptr);
+  num_contentions++;
+  int64_t max = max_wait_nanos.load();
+  while (max < wait_nanos &&
+         !max_wait_nanos.compare_exchange_weak(max, wait_nanos)) {
+  }
+}
+
+TEST(MutexContentionHookTest, ReportsContendedLocks) {
+  SetMutexContentionHook(&RecordContention);
+  mutex mu;
+  std::atomic<bool> locking{false};
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 1);
+    mu.lock();
+    pool.Schedule([&mu, &locking] {
+      locking = true;
+      mutex_lock l(mu);
+    });
+    while (!locking) {
+      Env::Default()->SleepForMicroseconds(1000);
+    }
+    Env::Default()->SleepForMicroseconds(50000);
+    mu.unlock();
+  }
+  SetMutexContentionHook(nullptr);
+  EXPECT_GE(num_contentions.load(), 1);
+  EXPECT_GE(max_wait_nanos.load(), 10000000);
+
+  // Uncontended locks are not reported.
+  const int64_t num_reported = num_contentions.load();
+  SetMutexContentionHook(&RecordContention);
+  {
+    mutex_lock l(mu);
+  }
+  SetMutexContentionHook(nullptr);
+  EXPECT_EQ(num_contentions.load(), num_reported);
+}
+
 }  // namespace
 }  // namespace tsl
@@ -17,6 +17,9 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <atomic>
+#include <memory>
+
 #include "absl/types/optional.h"
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tsl/platform/blocking_counter.h"
@@ -44,12 +47,26 @@ namespace tsl {
 
 namespace thread {
 
+namespace {
+std::atomic<ThreadPoolTaskListener*> task_listener{nullptr};
+}  // namespace
+
+void SetThreadPoolTaskListener(ThreadPoolTaskListener* listener) {
+  task_listener.store(listener, std::memory_order_release);
+}
+
+ThreadPoolTaskListener* GetThreadPoolTaskListener() {
+  return task_listener.load(std::memory_order_acquire);
+}
+
 struct EigenEnvironment {
   typedef Thread EnvThread;
   struct TaskImpl {
     std::function<void()> f;
     Context context;
     uint64 trace_id;
+    // Time the task was created, if a ThreadPoolTaskListener was set then.
+    uint64 enqueue_nanos;
   };
   struct Task {
     std::unique_ptr<TaskImpl> f;
@@ -58,10 +75,16 @@ struct EigenEnvironment {
   Env* const env_;
   const ThreadOptions thread_options_;
   const string name_;
+  // The number of tasks that were created with a ThreadPoolTaskListener set
+  // and did not start yet. Shared by the copies of the environment.
+  const std::shared_ptr<std::atomic<int64_t>> num_queued_tasks_;
 
   EigenEnvironment(Env* env, const ThreadOptions& thread_options,
                    const string& name)
-      : env_(env), thread_options_(thread_options), name_(name) {}
+      : env_(env),
+        thread_options_(thread_options),
+        name_(name),
+        num_queued_tasks_(std::make_shared<std::atomic<int64_t>>(0)) {}
 
   EnvThread* CreateThread(std::function<void()> f) {
     return env_->StartThread(thread_options_, name_, [=]() {
@@ -82,11 +105,17 @@ struct EigenEnvironment {
       id = tracing::GetUniqueArg();
       tracing::RecordEvent(tracing::EventCategory::kScheduleClosure, id);
     }
+    uint64 enqueue_nanos = 0;
+    if (task_listener.load(std::memory_order_relaxed) != nullptr) {
+      enqueue_nanos = env_->NowNanos();
+      num_queued_tasks_->fetch_add(1, std::memory_order_relaxed);
+    }
     return Task{
         std::unique_ptr<TaskImpl>(new TaskImpl{
             std::move(f),
             Context(ContextKind::kThread),
             id,
+            enqueue_nanos,
         }),
     };
   }
@@ -95,7 +124,19 @@ struct EigenEnvironment {
     WithContext wc(t.f->context);
     tracing::ScopedRegion region(tracing::EventCategory::kRunClosure,
                                  t.f->trace_id);
+    if (t.f->enqueue_nanos == 0) {
+      t.f->f();
+      return;
+    }
+    const int64_t queue_length =
+        num_queued_tasks_->fetch_sub(1, std::memory_order_relaxed) - 1;
+    const uint64 start_nanos = env_->NowNanos();
     t.f->f();
+    const uint64 end_nanos = env_->NowNanos();
+    if (ThreadPoolTaskListener* listener = GetThreadPoolTaskListener()) {
+      listener->OnTaskRun(name_, queue_length, start_nanos - t.f->enqueue_nanos,
+                          end_nanos - start_nanos);
+    }
   }
 };
 
@@ -16,8 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_TSL_PLATFORM_THREADPOOL_H_
 #define TENSORFLOW_TSL_PLATFORM_THREADPOOL_H_
 
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <string>
 
 #include "absl/types/optional.h"
 #include "tsl/platform/env.h"
@@ -39,6 +41,32 @@ namespace thread {
 
 struct EigenEnvironment;
 
+// Receives the queueing and run time of the closures run by thread pools.
+class ThreadPoolTaskListener {
+ public:
+  virtual ~ThreadPoolTaskListener() = default;
+
+  // Called on the thread that ran a closure of the pool `pool_name`, after it
+  // ran. `queue_length` is the number of closures of the pool that were
+  // waiting for a thread when it started, `wait_nanos` is the time it waited
+  // for a thread, and `run_nanos` is the time it ran.
+  virtual void OnTaskRun(const std::string& pool_name, int64_t queue_length,
+                         int64_t wait_nanos, int64_t run_nanos) = 0;
+
+  // Called when an idle thread of a work stealing pool took a closure from
+  // the queue of another thread. Only reported by pools that can observe it.
+  virtual void OnTaskStolen(const std::string& pool_name) {}
+};
+
+// Sets the listener notified of the closures run by every ThreadPool, or
+// stops the notifications if `listener` is null. Thread pools that are not
+// built on ThreadPool report to GetThreadPoolTaskListener() themselves.
+// `listener` must outlive all pools that may use it.
+void SetThreadPoolTaskListener(ThreadPoolTaskListener* listener);
+
+// Returns the listener set by SetThreadPoolTaskListener(), or null.
+ThreadPoolTaskListener* GetThreadPoolTaskListener();
+
 class ThreadPool {
  public:
   // Scheduling strategies for ParallelFor. The strategy governs how the given
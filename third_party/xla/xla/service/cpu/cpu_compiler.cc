@@ -954,12 +954,12 @@ Status CpuCompiler::RunHloPassesAfterLayoutAssn(
   }();
 
   // Outline ops in the entry computation into calls to subcomputations.
-  if (!is_aot_compile) {
+  if (!is_aot_compile || module->config().intra_op_parallelism_threads() > 1) {
     // Run ParallelTaskAssigner to assign parallel tasks to HLOs in module.
-    // Note this is not run for AOT because it would bring in thread pool
-    // and thread synchronization dependencies which would likely increase
-    // binary size (and most AOT applications are single-threaded).
-    // TODO(b/29630486) Support multi-threaded AOT.
+    // Note this is only run for AOT if asked for with
+    // CpuAotCompilationOptions::intra_op_parallelism, because it brings in
+    // thread pool and thread synchronization dependencies which would likely
+    // increase binary size (and most AOT applications are single-threaded).
     pipeline.AddPass<ParallelTaskAssigner>(
         max_parallelism, ShapeSizeBytesFunction(), target_machine_features);
   }
@@ -1718,6 +1718,8 @@ CpuCompiler::CompileAheadOfTime(std::unique_ptr<HloModuleGroup> module_group,
   for (size_t i = 0; i < modules.size(); ++i) {
     HloModule* module = modules[i].get();
     VLOG(1) << "Compiling ahead-of-time: " << module->name();
+    module->mutable_config().set_intra_op_parallelism_threads(
+        options.intra_op_parallelism());
 
     if (!module->has_schedule()) {
       TF_RETURN_IF_ERROR(
@@ -91,6 +91,12 @@ class CpuAotCompilationOptions : public AotCompilationOptions {
   bool use_mlir_hlo_lowering() const { return use_mlir_hlo_lowering_; }
   void set_use_mlir_hlo_lowering(bool value) { use_mlir_hlo_lowering_ = value; }
 
+  // The number of threads the compiled code may partition an HLO across.
+  // Values above 1 require an intra-op thread pool in the run options of the
+  // compiled function.  0 or 1 means the code runs on the calling thread.
+  int intra_op_parallelism() const { return intra_op_parallelism_; }
+  void set_intra_op_parallelism(int value) { intra_op_parallelism_ = value; }
+
  private:
   const std::string triple_;
   const std::string cpu_name_;
@@ -98,6 +104,7 @@ class CpuAotCompilationOptions : public AotCompilationOptions {
   const std::string entry_point_name_;
   const RelocationModel relocation_model_;
   bool use_mlir_hlo_lowering_ = false;
+  int intra_op_parallelism_ = 0;
 };
 
 class CpuAotCompilationResult : public AotCompilationResult {